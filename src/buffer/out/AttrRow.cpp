@@ -3,16 +3,74 @@
 
 #include "precomp.h"
 #include "AttrRow.hpp"
+#include "HyperlinkStore.hpp"
 
 // Routine Description:
 // - constructor
 // Arguments:
 // - cchRowWidth - the length of the default text attribute
 // - attr - the default text attribute
+// - hyperlinks - the store the hyperlink references of this row are counted in, if any
 // Return Value:
 // - constructed object
-ATTR_ROW::ATTR_ROW(const uint16_t width, const TextAttribute attr) :
-    _data(width, attr) {}
+ATTR_ROW::ATTR_ROW(const uint16_t width, const TextAttribute attr, HyperlinkStore* const hyperlinks) :
+    _data(width, attr),
+    _hyperlinks{ hyperlinks }
+{
+    _Acquire(_data.runs());
+}
+
+ATTR_ROW::~ATTR_ROW()
+{
+    _Release(_data.runs());
+}
+
+ATTR_ROW::ATTR_ROW(const ATTR_ROW& other) :
+    _data{ other._data },
+    _hyperlinks{ other._hyperlinks }
+{
+    _Acquire(_data.runs());
+}
+
+ATTR_ROW& ATTR_ROW::operator=(const ATTR_ROW& other)
+{
+    if (this != &other)
+    {
+        auto data = other._data;
+        _Acquire(data.runs());
+        _Release(_data.runs());
+        _data = std::move(data);
+    }
+    return *this;
+}
+
+ATTR_ROW::ATTR_ROW(ATTR_ROW&& other) noexcept :
+    _data{ std::move(other._data) },
+    _hyperlinks{ other._hyperlinks }
+{
+    // The references were handed over to us. Make sure the source doesn't release them.
+    other._data = rle_vector{};
+}
+
+ATTR_ROW& ATTR_ROW::operator=(ATTR_ROW&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (_hyperlinks != other._hyperlinks)
+        {
+            try
+            {
+                _Acquire(other._data.runs());
+            }
+            CATCH_LOG();
+            other._Release(other._data.runs());
+        }
+        _Release(_data.runs());
+        _data = std::move(other._data);
+        other._data = rle_vector{};
+    }
+    return *this;
+}
 
 // Routine Description:
 // - Sets all properties of the ATTR_ROW to default values
@@ -20,7 +78,7 @@ ATTR_ROW::ATTR_ROW(const uint16_t width, const TextAttribute attr) :
 // - attr - The default text attributes to use on text in this row.
 void ATTR_ROW::Reset(const TextAttribute attr)
 {
-    _data.replace(0, _data.size(), attr);
+    Replace(0, _data.size(), attr);
 }
 
 // Routine Description:
@@ -34,7 +92,23 @@ void ATTR_ROW::Reset(const TextAttribute attr)
 // - <none>, throws exceptions on failures.
 void ATTR_ROW::Resize(const uint16_t newWidth)
 {
-    _data.resize_trailing_extent(newWidth);
+    const auto oldWidth = _data.size();
+    if (!_hyperlinks || !_HasHyperlinks())
+    {
+        _data.resize_trailing_extent(newWidth);
+    }
+    else if (newWidth > oldWidth)
+    {
+        // The last run is extended to fill up the new width.
+        _hyperlinks->Acquire(_data.runs().back().value.GetHyperlinkId(), newWidth - oldWidth);
+        _data.resize_trailing_extent(newWidth);
+    }
+    else
+    {
+        const auto removed = _data.slice(newWidth, oldWidth);
+        _data.resize_trailing_extent(newWidth);
+        _Release(removed.runs());
+    }
 }
 
 // Routine Description:
@@ -50,23 +124,6 @@ TextAttribute ATTR_ROW::GetAttrByColumn(const uint16_t column) const
     return _data.at(column);
 }
 
-// Routine Description:
-// - Finds the hyperlink IDs present in this row and returns them
-// Return value:
-// - The hyperlink IDs present in this row
-std::vector<uint16_t> ATTR_ROW::GetHyperlinks() const
-{
-    std::vector<uint16_t> ids;
-    for (const auto& run : _data.runs())
-    {
-        if (run.value.IsHyperlink())
-        {
-            ids.emplace_back(run.value.GetHyperlinkId());
-        }
-    }
-    return ids;
-}
-
 // Routine Description:
 // - Sets the attributes (colors) of all character positions from the given position through the end of the row.
 // Arguments:
@@ -76,7 +133,7 @@ std::vector<uint16_t> ATTR_ROW::GetHyperlinks() const
 // - <none>
 bool ATTR_ROW::SetAttrToEnd(const uint16_t beginIndex, const TextAttribute attr)
 {
-    _data.replace(gsl::narrow<uint16_t>(beginIndex), _data.size(), attr);
+    Replace(beginIndex, _data.size(), attr);
     return true;
 }
 
@@ -90,7 +147,23 @@ bool ATTR_ROW::SetAttrToEnd(const uint16_t beginIndex, const TextAttribute attr)
 // - <none>
 void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith)
 {
+    if (!_hyperlinks || toBeReplacedAttr.GetHyperlinkId() == replaceWith.GetHyperlinkId())
+    {
+        _data.replace_values(toBeReplacedAttr, replaceWith);
+        return;
+    }
+
+    size_t cells = 0;
+    for (const auto& run : _data.runs())
+    {
+        if (run.value == toBeReplacedAttr)
+        {
+            cells += run.length;
+        }
+    }
+    _hyperlinks->Acquire(replaceWith.GetHyperlinkId(), cells);
     _data.replace_values(toBeReplacedAttr, replaceWith);
+    _hyperlinks->Release(toBeReplacedAttr.GetHyperlinkId(), cells);
 }
 
 // Routine Description:
@@ -105,7 +178,62 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
 // - <none>
 void ATTR_ROW::Replace(const uint16_t beginIndex, const uint16_t endIndex, const TextAttribute& newAttr)
 {
-    _data.replace(beginIndex, endIndex, newAttr);
+    if (!_hyperlinks || (!newAttr.IsHyperlink() && !_HasHyperlinks()))
+    {
+        _data.replace(beginIndex, endIndex, newAttr);
+        return;
+    }
+
+    // The new cells are counted before the replaced ones are released,
+    // so that a hyperlink ID present in both isn't released in between.
+    const auto replaced = _data.slice(beginIndex, endIndex);
+    _hyperlinks->Acquire(newAttr.GetHyperlinkId(), replaced.size());
+    try
+    {
+        _data.replace(beginIndex, endIndex, newAttr);
+    }
+    catch (...)
+    {
+        _hyperlinks->Release(newAttr.GetHyperlinkId(), replaced.size());
+        throw;
+    }
+    _Release(replaced.runs());
+}
+
+// Routine Description:
+// - Copies the attributes of the [sourceBegin, sourceEnd) range of a row into this row,
+//   starting at targetBegin. The runs are spliced in as a whole instead of cell by cell.
+// Arguments:
+// - source - the row to copy the attributes from. May be this very row.
+// - sourceBegin, sourceEnd - the range of columns to copy
+// - targetBegin - the column of this row the range is copied to
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ATTR_ROW::CopyRuns(const ATTR_ROW& source, const uint16_t sourceBegin, const uint16_t sourceEnd, const uint16_t targetBegin)
+{
+    // The slice is taken before anything is replaced, in case the source overlaps the target.
+    const auto copied = source._data.slice(sourceBegin, sourceEnd);
+    const auto targetEnd = gsl::narrow<uint16_t>(targetBegin + copied.size());
+    const gsl::span<const rle_vector::rle_type> runs{ copied.runs() };
+    if (!_hyperlinks)
+    {
+        _data.replace(targetBegin, targetEnd, runs);
+        return;
+    }
+
+    // Just like in Replace(), the copied cells are counted before the replaced ones are released.
+    const auto replaced = _data.slice(targetBegin, targetEnd);
+    _Acquire(copied.runs());
+    try
+    {
+        _data.replace(targetBegin, targetEnd, runs);
+    }
+    catch (...)
+    {
+        _Release(copied.runs());
+        throw;
+    }
+    _Release(replaced.runs());
 }
 
 ATTR_ROW::const_iterator ATTR_ROW::begin() const noexcept
@@ -118,6 +246,15 @@ ATTR_ROW::const_iterator ATTR_ROW::end() const noexcept
     return _data.end();
 }
 
+// Routine Description:
+// - Gives access to the runs of identical attributes this row is made of
+// Return Value:
+// - The runs in order from left to right. Their lengths add up to the width of the row.
+const ATTR_ROW::container& ATTR_ROW::Runs() const noexcept
+{
+    return _data.runs();
+}
+
 ATTR_ROW::const_iterator ATTR_ROW::cbegin() const noexcept
 {
     return _data.cbegin();
@@ -128,6 +265,61 @@ ATTR_ROW::const_iterator ATTR_ROW::cend() const noexcept
     return _data.cend();
 }
 
+// Routine Description:
+// - Tells whether any cell of this row refers to a hyperlink.
+bool ATTR_ROW::_HasHyperlinks() const noexcept
+{
+    return std::any_of(_data.runs().begin(), _data.runs().end(), [](const auto& run) { return run.value.IsHyperlink(); });
+}
+
+// Routine Description:
+// - Counts the cells of the given runs that refer to a hyperlink in our store.
+// Arguments:
+// - runs - the runs that were added to this row
+// Return Value:
+// - <none>, throws exceptions on failures. Nothing is counted in that case.
+void ATTR_ROW::_Acquire(const container& runs)
+{
+    if (!_hyperlinks)
+    {
+        return;
+    }
+
+    auto it = runs.begin();
+    try
+    {
+        for (; it != runs.end(); ++it)
+        {
+            _hyperlinks->Acquire(it->value.GetHyperlinkId(), it->length);
+        }
+    }
+    catch (...)
+    {
+        for (auto acquired = runs.begin(); acquired != it; ++acquired)
+        {
+            _hyperlinks->Release(acquired->value.GetHyperlinkId(), acquired->length);
+        }
+        throw;
+    }
+}
+
+// Routine Description:
+// - Releases the cells of the given runs that refer to a hyperlink from our store.
+// Arguments:
+// - runs - the runs that were removed from this row
+void ATTR_ROW::_Release(const container& runs) noexcept
+{
+    if (!_hyperlinks)
+    {
+        return;
+    }
+
+    for (const auto& run : runs)
+    {
+        _hyperlinks->Release(run.value.GetHyperlinkId(), run.length);
+    }
+}
+
 bool operator==(const ATTR_ROW& a, const ATTR_ROW& b) noexcept
 {
     return a._data == b._data;
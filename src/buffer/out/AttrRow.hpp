@@ -23,30 +23,32 @@ Revision History:
 #include "til/rle.h"
 #include "TextAttribute.hpp"
 
+class HyperlinkStore;
+
 class ATTR_ROW final
 {
     using rle_vector = til::small_rle<TextAttribute, uint16_t, 1>;
 
 public:
     using const_iterator = rle_vector::const_iterator;
+    using container = rle_vector::container;
 
-    ATTR_ROW(uint16_t width, TextAttribute attr);
+    ATTR_ROW(uint16_t width, TextAttribute attr, HyperlinkStore* hyperlinks = nullptr);
 
-    ~ATTR_ROW() = default;
+    ~ATTR_ROW();
 
-    ATTR_ROW(const ATTR_ROW&) = default;
-    ATTR_ROW& operator=(const ATTR_ROW&) = default;
-    ATTR_ROW(ATTR_ROW&&)
-    noexcept = default;
-    ATTR_ROW& operator=(ATTR_ROW&&) noexcept = default;
+    ATTR_ROW(const ATTR_ROW& other);
+    ATTR_ROW& operator=(const ATTR_ROW& other);
+    ATTR_ROW(ATTR_ROW&& other) noexcept;
+    ATTR_ROW& operator=(ATTR_ROW&& other) noexcept;
 
     TextAttribute GetAttrByColumn(uint16_t column) const;
-    std::vector<uint16_t> GetHyperlinks() const;
 
     bool SetAttrToEnd(uint16_t beginIndex, TextAttribute attr);
     void ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith);
     void Resize(uint16_t newWidth);
     void Replace(uint16_t beginIndex, uint16_t endIndex, const TextAttribute& newAttr);
+    void CopyRuns(const ATTR_ROW& source, uint16_t sourceBegin, uint16_t sourceEnd, uint16_t targetBegin);
 
     const_iterator begin() const noexcept;
     const_iterator end() const noexcept;
@@ -54,13 +56,22 @@ public:
     const_iterator cbegin() const noexcept;
     const_iterator cend() const noexcept;
 
+    const container& Runs() const noexcept;
+
     friend bool operator==(const ATTR_ROW& a, const ATTR_ROW& b) noexcept;
     friend class ROW;
 
 private:
     void Reset(const TextAttribute attr);
 
+    bool _HasHyperlinks() const noexcept;
+    void _Acquire(const container& runs);
+    void _Release(const container& runs) noexcept;
+
     rle_vector _data;
+    // The cells of this row that refer to a hyperlink are counted in here, if set.
+    // Assignments keep the store of the destination, as it belongs to the buffer the row lives in.
+    HyperlinkStore* _hyperlinks;
 
 #ifdef UNIT_TESTING
     friend class CommonState;
@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "AttributeRunIterator.hpp"
+
+// Routine Description:
+// - Creates a new iterator over the attribute runs of a row
+// Arguments:
+// - row - the row to walk through
+// - begin - the first column to return. The first run is clipped to start here.
+// - end - the column past the last one to return. The last run is clipped to end here.
+//         Values beyond the width of the row are clamped to it.
+AttributeRunIterator::AttributeRunIterator(const ROW& row, const uint16_t begin, const uint16_t end) :
+    _row{ row },
+    _runs{ row.GetAttrRow().Runs() },
+    _index{ 0 },
+    _runStart{ 0 },
+    _pos{ begin },
+    _end{ gsl::narrow_cast<uint16_t>(std::min<size_t>(end, row.size())) },
+    _run{}
+{
+    // Skip the runs that end before we begin.
+    while (_index < _runs.size() && _runStart + til::at(_runs, _index).length <= _pos)
+    {
+        _runStart = gsl::narrow_cast<uint16_t>(_runStart + til::at(_runs, _index).length);
+        ++_index;
+    }
+    _GenerateRun();
+}
+
+// Routine Description:
+// - Tells if the iterator is still valid (hasn't exceeded the requested columns)
+// Return Value:
+// - True if it is still valid. False if it's past the end.
+AttributeRunIterator::operator bool() const noexcept
+{
+    return _pos < _end && _index < _runs.size();
+}
+
+// Routine Description:
+// - Advances the iterator to the next run of the row
+// Return Value:
+// - Reference to self after movement.
+AttributeRunIterator& AttributeRunIterator::operator++()
+{
+    if (*this)
+    {
+        _runStart = gsl::narrow_cast<uint16_t>(_runStart + til::at(_runs, _index).length);
+        _pos = _run.end;
+        ++_index;
+        _GenerateRun();
+    }
+    return *this;
+}
+
+const AttributeRun& AttributeRunIterator::operator*() const noexcept
+{
+    return _run;
+}
+
+const AttributeRun* AttributeRunIterator::operator->() const noexcept
+{
+    return &_run;
+}
+
+// Routine Description:
+// - Fills the current run with the data of the run at _index, clipped to [_pos, _end)
+void AttributeRunIterator::_GenerateRun()
+{
+    if (!*this)
+    {
+        _run = {};
+        return;
+    }
+
+    const auto& run = til::at(_runs, _index);
+    _run.begin = _pos;
+    _run.end = gsl::narrow_cast<uint16_t>(std::min<size_t>(_runStart + run.length, _end));
+    _run.attr = run.value;
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+    _run.cells = { &*(_row.GetCharRow().cbegin() + _pos), gsl::narrow_cast<size_t>(_run.end - _run.begin) };
+}
@@ -0,0 +1,53 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- AttributeRunIterator.hpp
+
+Abstract:
+- This module walks through a row of the text buffer one run of identical attributes at a time
+- The runs are read straight from the run length encoded ATTR_ROW, so consumers
+  that care about attribute changes don't need to compare TextAttributes cell by cell.
+- It is intended for read-only operations like rendering and exporting text
+--*/
+
+#pragma once
+
+#include "Row.hpp"
+
+struct AttributeRun
+{
+    uint16_t begin; // the first column of the run
+    uint16_t end; // the column past the last one of the run
+    TextAttribute attr;
+    // The cells of the run. Glyphs that don't fit into a single cell are kept
+    // in the row's UnicodeStorage and can be retrieved with CharRow::GlyphAt.
+    gsl::span<const CharRowCell> cells;
+};
+
+class AttributeRunIterator final
+{
+public:
+    AttributeRunIterator(const ROW& row, const uint16_t begin, const uint16_t end);
+
+    operator bool() const noexcept;
+
+    AttributeRunIterator& operator++();
+
+    const AttributeRun& operator*() const noexcept;
+    const AttributeRun* operator->() const noexcept;
+
+private:
+    void _GenerateRun();
+
+    const ROW& _row;
+    const ATTR_ROW::container& _runs;
+    // The index of the current run in _runs and the column it starts at.
+    size_t _index;
+    uint16_t _runStart;
+    // The column the current run is clipped to on the left and the one we stop at.
+    uint16_t _pos;
+    uint16_t _end;
+    AttributeRun _run;
+};
@@ -12,17 +12,16 @@
 // Arguments:
 // - rowWidth - the size (in wchar_t) of the char and attribute rows
 // - pParent - the parent ROW
+// - resource - the memory resource the cells are allocated from
 // Return Value:
 // - instantiated object
-// Note: will through if unable to allocate char/attribute buffers
-#pragma warning(push)
-#pragma warning(disable : 26447) // small_vector's constructor says it can throw but it should not given how we use it.  This suppresses this error for the AuditMode build.
-CharRow::CharRow(size_t rowWidth, ROW* const pParent) noexcept :
-    _data(rowWidth, value_type()),
+// Note: will throw if unable to allocate char/attribute buffers
+CharRow::CharRow(size_t rowWidth, ROW* const pParent, std::pmr::memory_resource* const resource) :
+    _data(rowWidth, value_type(), resource),
+    _unicodeStorage{},
     _pParent{ FAIL_FAST_IF_NULL(pParent) }
 {
 }
-#pragma warning(pop)
 
 // Routine Description:
 // - gets the size of the row, in glyph cells
@@ -47,6 +46,7 @@ void CharRow::Reset() noexcept
     {
         cell.Reset();
     }
+    _unicodeStorage.Clear();
 }
 
 // Routine Description:
@@ -60,7 +60,12 @@ void CharRow::Reset() noexcept
     try
     {
         const value_type insertVals;
+        // Reserve exactly what we need instead of growing geometrically,
+        // as rows are allocated from a pool of fixed size blocks.
+        _data.reserve(newSize);
         _data.resize(newSize, insertVals);
+        // Drop the glyphs of any columns that were cut off.
+        _unicodeStorage.Trim(newSize);
     }
     CATCH_RETURN();
 
@@ -252,12 +257,12 @@ const DelimiterClass CharRow::DelimiterClassAt(const size_t column, const std::w
 
 UnicodeStorage& CharRow::GetUnicodeStorage() noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _unicodeStorage;
 }
 
 const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _unicodeStorage;
 }
 
 // Routine Description:
@@ -265,10 +270,10 @@ const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
 // Arguments:
 // - column - the column to generate the key for
 // Return Value:
-// - the COORD key for data access from UnicodeStorage for the column
-COORD CharRow::GetStorageKey(const size_t column) const noexcept
+// - the key for data access from UnicodeStorage for the column
+UnicodeStorage::key_type CharRow::GetStorageKey(const size_t column) const noexcept
 {
-    return { gsl::narrow<SHORT>(column), _pParent->GetId() };
+    return gsl::narrow<UnicodeStorage::key_type>(column);
 }
 
 // Routine Description:
@@ -27,7 +27,7 @@ Revision History:
 
 class ROW;
 
-enum class DelimiterClass
+enum class DelimiterClass : uint8_t
 {
     ControlChar,
     DelimiterChar,
@@ -49,12 +49,13 @@ class CharRow final
 public:
     using glyph_type = typename wchar_t;
     using value_type = typename CharRowCell;
-    using iterator = typename boost::container::small_vector_base<value_type>::iterator;
-    using const_iterator = typename boost::container::small_vector_base<value_type>::const_iterator;
-    using const_reverse_iterator = typename boost::container::small_vector_base<value_type>::const_reverse_iterator;
+    using container_type = std::pmr::vector<value_type>;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+    using const_reverse_iterator = typename container_type::const_reverse_iterator;
     using reference = typename CharRowCellReference;
 
-    CharRow(size_t rowWidth, ROW* const pParent) noexcept;
+    CharRow(size_t rowWidth, ROW* const pParent, std::pmr::memory_resource* const resource = til::pmr::get_default_resource());
 
     size_t size() const noexcept;
     [[nodiscard]] HRESULT Resize(const size_t newSize) noexcept;
@@ -82,7 +83,7 @@ public:
 
     UnicodeStorage& GetUnicodeStorage() noexcept;
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    COORD GetStorageKey(const size_t column) const noexcept;
+    UnicodeStorage::key_type GetStorageKey(const size_t column) const noexcept;
 
     void UpdateParent(ROW* const pParent);
 
@@ -96,7 +97,12 @@ private:
 
 protected:
     // storage for glyph data and dbcs attributes
-    boost::container::small_vector<value_type, 120> _data;
+    // The cells of all rows of a TextBuffer are carved out of its row pool (see TextBuffer::_rowPool),
+    // so that a buffer with thousands of rows only needs a handful of allocations.
+    container_type _data;
+
+    // storage for the glyphs of this row that don't fit into a single wchar_t
+    UnicodeStorage _unicodeStorage;
 
     // ROW that this CharRow belongs to
     ROW* _pParent;
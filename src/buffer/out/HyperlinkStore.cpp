@@ -0,0 +1,214 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "HyperlinkStore.hpp"
+
+// Routine Description:
+// - Provides the hyperlink ID to be assigned as a text attribute, based on the optional custom id provided
+// Arguments:
+// - uri - the URI of the hyperlink
+// - customId - the user-defined id, may be empty
+// Return Value:
+// - The internal hyperlink ID
+uint16_t HyperlinkStore::GetId(const std::wstring_view uri, const std::wstring_view customId)
+{
+    uint16_t numericId = 0;
+    if (customId.empty())
+    {
+        // no custom id specified, return our internal count
+        numericId = _nextId;
+        ++_nextId;
+    }
+    else
+    {
+        // assign _nextId if the custom id does not already exist
+        std::wstring newId{ customId };
+        // hash the URL and add it to the custom ID - GH#7698
+        newId += L"%" + std::to_wstring(til::hash(uri));
+        const auto result = _customIds.emplace(std::move(newId), _nextId);
+        if (result.second)
+        {
+            // the custom id did not already exist
+            try
+            {
+                _entries[_nextId].customId = &result.first->first;
+            }
+            catch (...)
+            {
+                _customIds.erase(result.first);
+                throw;
+            }
+            ++_nextId;
+        }
+        numericId = result.first->second;
+    }
+    // _nextId could overflow, make sure its not 0
+    if (_nextId == 0)
+    {
+        ++_nextId;
+    }
+    return numericId;
+}
+
+// Routine Description:
+// - Adds or updates the URI of a hyperlink ID
+// Arguments:
+// - id - the hyperlink ID, could be new or old
+// - uri - the URI to associate with it
+void HyperlinkStore::SetUri(const uint16_t id, const std::wstring_view uri)
+{
+    auto& entry = _entries[id];
+    if (entry.uri && *entry.uri == uri)
+    {
+        return;
+    }
+
+    const auto it = _uris.emplace(uri, 0).first;
+    ++it->second;
+    if (entry.uri)
+    {
+        _ReleaseUri(*entry.uri);
+    }
+    entry.uri = &it->first;
+}
+
+// Routine Description:
+// - Retrieves the URI associated with a particular hyperlink ID
+// Arguments:
+// - id - the hyperlink ID
+// Return Value:
+// - The URI. Throws if the ID has no URI.
+const std::wstring& HyperlinkStore::GetUri(const uint16_t id) const
+{
+    const auto uri = _entries.at(id).uri;
+    THROW_HR_IF_NULL(E_INVALIDARG, uri);
+    return *uri;
+}
+
+// Routine Description:
+// - Obtains the custom ID, if there was one, associated with a hyperlink ID
+// Arguments:
+// - id - the hyperlink ID
+// Return Value:
+// - The custom ID if there was one, empty string otherwise
+std::wstring HyperlinkStore::GetCustomId(const uint16_t id) const
+{
+    const auto it = _entries.find(id);
+    if (it == _entries.end() || !it->second.customId)
+    {
+        return {};
+    }
+    return *it->second.customId;
+}
+
+// Routine Description:
+// - Removes a hyperlink ID along with its URI and custom ID, if any.
+// Arguments:
+// - id - the hyperlink ID to be removed
+void HyperlinkStore::Remove(const uint16_t id) noexcept
+{
+    const auto it = _entries.find(id);
+    if (it == _entries.end())
+    {
+        return;
+    }
+
+    const auto& entry = it->second;
+    if (entry.uri)
+    {
+        _ReleaseUri(*entry.uri);
+    }
+    if (entry.customId)
+    {
+        _customIds.erase(_customIds.find(*entry.customId));
+    }
+    _entries.erase(it);
+}
+
+// Routine Description:
+// - Copies the URIs and custom IDs of another store into this one, as well as
+//   the next ID to hand out. The cell counts of this store are kept, as they
+//   belong to the rows of this store's buffer.
+// Arguments:
+// - other - the store to copy from
+void HyperlinkStore::CopyFrom(const HyperlinkStore& other)
+{
+    for (const auto& [id, entry] : other._entries)
+    {
+        if (entry.uri)
+        {
+            SetUri(id, *entry.uri);
+        }
+        if (entry.customId)
+        {
+            const auto it = _customIds.emplace(*entry.customId, id).first;
+            if (it->second == id)
+            {
+                _entries[id].customId = &it->first;
+            }
+        }
+    }
+    _nextId = other._nextId;
+}
+
+// Routine Description:
+// - Records that the given number of cells now refer to a hyperlink ID.
+// Arguments:
+// - id - the hyperlink ID. 0 (no hyperlink) is ignored.
+// - cells - the number of cells
+void HyperlinkStore::Acquire(const uint16_t id, const size_t cells)
+{
+    if (id != 0 && cells != 0)
+    {
+        _entries[id].cells += cells;
+    }
+}
+
+// Routine Description:
+// - Records that the given number of cells no longer refer to a hyperlink ID.
+//   Once no cell refers to it anymore, the ID is removed.
+// Arguments:
+// - id - the hyperlink ID. 0 (no hyperlink) is ignored.
+// - cells - the number of cells
+void HyperlinkStore::Release(const uint16_t id, const size_t cells) noexcept
+{
+    if (id == 0 || cells == 0)
+    {
+        return;
+    }
+
+    const auto it = _entries.find(id);
+    if (it == _entries.end())
+    {
+        return;
+    }
+
+    auto& count = it->second.cells;
+    count -= std::min(count, cells);
+    if (count == 0)
+    {
+        Remove(id);
+    }
+}
+
+// Routine Description:
+// - Returns the number of cells referring to a hyperlink ID.
+size_t HyperlinkStore::CellCount(const uint16_t id) const noexcept
+{
+    const auto it = _entries.find(id);
+    return it == _entries.end() ? 0 : it->second.cells;
+}
+
+// Routine Description:
+// - Drops one use of an interned URI and frees it once no ID uses it anymore.
+// Arguments:
+// - uri - a key of _uris
+void HyperlinkStore::_ReleaseUri(const std::wstring& uri) noexcept
+{
+    const auto it = _uris.find(uri);
+    if (it != _uris.end() && --it->second == 0)
+    {
+        _uris.erase(it);
+    }
+}
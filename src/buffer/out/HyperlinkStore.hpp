@@ -0,0 +1,66 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- HyperlinkStore.hpp
+
+Abstract:
+- Keeps track of the hyperlinks of a TextBuffer: the URI and the optional
+  user defined ID of every hyperlink ID that was handed out to a TextAttribute.
+- Every ATTR_ROW of the buffer reports the cells it assigns to and takes away
+  from a hyperlink ID. Once the last cell referring to an ID is gone, the ID is
+  released together with its URI and custom ID. This way we never have to scan
+  the buffer for remaining references when a row scrolls out of it.
+- URIs are interned. Applications commonly open a new hyperlink ID for every
+  occurrence of the same URI, and all of these IDs share a single copy of it.
+- Not thread-safe. All access to a TextBuffer happens under the console lock.
+--*/
+
+#pragma once
+
+#include <til/hash.h>
+
+class HyperlinkStore final
+{
+public:
+    HyperlinkStore() = default;
+    ~HyperlinkStore() = default;
+
+    HyperlinkStore(const HyperlinkStore&) = delete;
+    HyperlinkStore& operator=(const HyperlinkStore&) = delete;
+    HyperlinkStore(HyperlinkStore&&) = delete;
+    HyperlinkStore& operator=(HyperlinkStore&&) = delete;
+
+    uint16_t GetId(const std::wstring_view uri, const std::wstring_view customId);
+    void SetUri(const uint16_t id, const std::wstring_view uri);
+    const std::wstring& GetUri(const uint16_t id) const;
+    std::wstring GetCustomId(const uint16_t id) const;
+    void Remove(const uint16_t id) noexcept;
+    void CopyFrom(const HyperlinkStore& other);
+
+    void Acquire(const uint16_t id, const size_t cells);
+    void Release(const uint16_t id, const size_t cells) noexcept;
+    size_t CellCount(const uint16_t id) const noexcept;
+
+private:
+    struct Entry
+    {
+        // These point at keys of _uris and _customIds, which don't move around in memory.
+        const std::wstring* uri = nullptr;
+        const std::wstring* customId = nullptr;
+        size_t cells = 0;
+    };
+
+    void _ReleaseUri(const std::wstring& uri) noexcept;
+
+    std::unordered_map<uint16_t, Entry> _entries;
+    // Every distinct URI, along with the number of IDs using it.
+    std::unordered_map<std::wstring, size_t, til::hash_functor<std::wstring>> _uris;
+    std::unordered_map<std::wstring, uint16_t, til::hash_functor<std::wstring>> _customIds;
+    uint16_t _nextId{ 1 };
+
+#ifdef UNIT_TESTING
+    friend class HyperlinkStoreTests;
+#endif
+};
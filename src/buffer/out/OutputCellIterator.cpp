@@ -6,7 +6,7 @@
 #include "OutputCellIterator.hpp"
 
 #include "../../types/inc/convert.hpp"
-#include "../../types/inc/Utf16Parser.hpp"
+#include "../../types/inc/GraphemeParser.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
 #include "../../inc/conattrs.hpp"
 
@@ -398,7 +398,7 @@ OutputCellView OutputCellIterator::s_GenerateView(const std::wstring_view view,
                                                   const TextAttribute attr,
                                                   const TextAttributeBehavior behavior)
 {
-    const auto glyph = Utf16Parser::ParseNext(view);
+    const auto glyph = GraphemeParser::ParseNext(view);
     DbcsAttribute dbcsAttr;
     if (IsGlyphFullWidth(glyph))
     {
@@ -0,0 +1,352 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "PersistedBuffer.hpp"
+#include "textBuffer.hpp"
+#include "unicode.hpp"
+
+static constexpr std::array<char, 4> Magic{ 'W', 'T', 'B', 'F' };
+static constexpr uint32_t Version = 1;
+// Rows are collected in memory and written out in blocks of this size.
+static constexpr size_t WriteSize = 64 * 1024;
+
+struct FileHeader
+{
+    std::array<char, 4> magic;
+    uint32_t version;
+    // The runs are stored as they're laid out in memory, so a file
+    // is only good for builds with the same TextAttribute.
+    uint16_t attributeSize;
+    uint16_t width;
+    uint32_t rowCount;
+    int16_t cursorX;
+    int16_t cursorY;
+};
+
+struct FileFooter
+{
+    uint64_t hyperlinksOffset;
+    uint64_t rowOffsetsOffset;
+};
+
+struct RowHeader
+{
+    uint16_t textLength;
+    uint16_t runCount;
+    uint8_t lineRendition;
+    uint8_t wrapForced;
+};
+
+struct RowRun
+{
+    TextAttribute attr;
+    uint16_t length;
+};
+
+struct HyperlinkHeader
+{
+    uint16_t id;
+    uint16_t uriLength;
+};
+
+static_assert(std::is_trivially_copyable_v<FileHeader>);
+static_assert(std::is_trivially_copyable_v<FileFooter>);
+static_assert(std::is_trivially_copyable_v<RowHeader>);
+static_assert(std::is_trivially_copyable_v<RowRun>);
+static_assert(std::is_trivially_copyable_v<HyperlinkHeader>);
+
+namespace
+{
+    // Appends to a file through a buffer of WriteSize bytes.
+    class FileWriter
+    {
+    public:
+        explicit FileWriter(const HANDLE file) noexcept :
+            _file{ file }
+        {
+        }
+
+        template<typename T>
+        void Append(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            Append(&value, sizeof(value));
+        }
+
+        void Append(const void* const data, const size_t size)
+        {
+            const auto begin = _buffer.size();
+            _buffer.resize(begin + size);
+            memcpy(_buffer.data() + begin, data, size);
+            _offset += size;
+
+            if (_buffer.size() >= WriteSize)
+            {
+                Flush();
+            }
+        }
+
+        uint64_t Offset() const noexcept
+        {
+            return _offset;
+        }
+
+        void Flush()
+        {
+            if (_buffer.empty())
+            {
+                return;
+            }
+
+            DWORD written = 0;
+            THROW_IF_WIN32_BOOL_FALSE(WriteFile(_file, _buffer.data(), gsl::narrow<DWORD>(_buffer.size()), &written, nullptr));
+            THROW_HR_IF(E_UNEXPECTED, written != _buffer.size());
+            _buffer.clear();
+        }
+
+    private:
+        HANDLE _file;
+        std::vector<std::byte> _buffer;
+        uint64_t _offset{ 0 };
+    };
+
+    // Reads from a file that's mapped into memory, and throws
+    // instead of reading beyond its end.
+    class MappedReader
+    {
+    public:
+        MappedReader(const std::byte* const data, const uint64_t size) noexcept :
+            _data{ data },
+            _size{ size }
+        {
+        }
+
+        template<typename T>
+        T Read(const uint64_t offset) const
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            Read(offset, &value, sizeof(value));
+            return value;
+        }
+
+        void Read(const uint64_t offset, void* const target, const size_t size) const
+        {
+            THROW_HR_IF(E_UNEXPECTED, offset > _size || _size - offset < size);
+            memcpy(target, _data + offset, size);
+        }
+
+    private:
+        const std::byte* _data;
+        uint64_t _size;
+    };
+}
+
+// Routine Description:
+// - Saves the contents of the buffer, up to its last non-blank row or the
+//   cursor, whichever is further down. The file is written next to path first
+//   and then moved into place, so that a failure never leaves a partial file.
+// Arguments:
+// - buffer - the buffer to save
+// - path - the file to save it to. It's replaced if it exists.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void PersistedBuffer::Save(const TextBuffer& buffer, const std::wstring_view path)
+{
+    const auto cursorPosition = buffer.GetCursor().GetPosition();
+    const auto lastRow = std::max(buffer.GetLastNonSpaceCharacter().Y, cursorPosition.Y);
+    const auto rowCount = gsl::narrow<uint32_t>(lastRow + 1);
+
+    const std::wstring finalPath{ path };
+    const auto tempPath = finalPath + L".tmp";
+    wil::unique_hfile file{ CreateFileW(tempPath.c_str(),
+                                        GENERIC_WRITE,
+                                        0,
+                                        nullptr,
+                                        CREATE_ALWAYS,
+                                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                        nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+    auto deleteTempFile = wil::scope_exit([&]() noexcept {
+        file.reset();
+        LOG_IF_WIN32_BOOL_FALSE(DeleteFileW(tempPath.c_str()));
+    });
+
+    FileWriter writer{ file.get() };
+
+    FileHeader header{};
+    header.magic = Magic;
+    header.version = Version;
+    header.attributeSize = sizeof(TextAttribute);
+    header.width = gsl::narrow<uint16_t>(buffer.GetSize().Width());
+    header.rowCount = rowCount;
+    header.cursorX = cursorPosition.X;
+    header.cursorY = cursorPosition.Y;
+    writer.Append(header);
+
+    std::vector<uint64_t> rowOffsets;
+    rowOffsets.reserve(rowCount);
+    std::vector<uint16_t> hyperlinkIds;
+
+    for (uint32_t y = 0; y < rowCount; ++y)
+    {
+        const auto& row = buffer.GetRowByOffset(y);
+        auto text = row.GetText();
+        text.erase(text.find_last_not_of(UNICODE_SPACE) + 1);
+        const auto& runs = row.GetAttrRow().Runs();
+
+        RowHeader rowHeader{};
+        rowHeader.textLength = gsl::narrow<uint16_t>(text.size());
+        rowHeader.runCount = gsl::narrow<uint16_t>(runs.size());
+        rowHeader.lineRendition = gsl::narrow_cast<uint8_t>(row.GetLineRendition());
+        rowHeader.wrapForced = row.WasWrapForced();
+
+        rowOffsets.emplace_back(writer.Offset());
+        writer.Append(rowHeader);
+        for (const auto& run : runs)
+        {
+            if (const auto id = run.value.GetHyperlinkId())
+            {
+                hyperlinkIds.emplace_back(id);
+            }
+            writer.Append(RowRun{ run.value, run.length });
+        }
+        writer.Append(text.data(), text.size() * sizeof(wchar_t));
+    }
+
+    std::sort(hyperlinkIds.begin(), hyperlinkIds.end());
+    hyperlinkIds.erase(std::unique(hyperlinkIds.begin(), hyperlinkIds.end()), hyperlinkIds.end());
+
+    FileFooter footer{};
+    footer.hyperlinksOffset = writer.Offset();
+    writer.Append(gsl::narrow<uint32_t>(hyperlinkIds.size()));
+    for (const auto id : hyperlinkIds)
+    {
+        const auto uri = buffer.GetHyperlinkUriFromId(id);
+        writer.Append(HyperlinkHeader{ id, gsl::narrow<uint16_t>(uri.size()) });
+        writer.Append(uri.data(), uri.size() * sizeof(wchar_t));
+    }
+
+    footer.rowOffsetsOffset = writer.Offset();
+    writer.Append(rowOffsets.data(), rowOffsets.size() * sizeof(uint64_t));
+    writer.Append(footer);
+    writer.Flush();
+
+    file.reset();
+    THROW_IF_WIN32_BOOL_FALSE(MoveFileExW(tempPath.c_str(), finalPath.c_str(), MOVEFILE_REPLACE_EXISTING));
+    deleteTempFile.release();
+}
+
+// Routine Description:
+// - Restores the contents that Save() saved into the buffer. It's meant for a
+//   buffer that nothing has been written to yet. If there are more rows than
+//   fit into it, only the newest ones are restored. Rows that were wider than
+//   the buffer are cut off.
+// Arguments:
+// - buffer - the buffer to restore the contents into
+// - path - the file that Save() wrote
+// Return Value:
+// - true if the contents were restored, false if the file doesn't exist.
+//   Throws exceptions on other failures, including files that are corrupt or
+//   of a different version.
+bool PersistedBuffer::Restore(TextBuffer& buffer, const std::wstring_view path)
+{
+    wil::unique_hfile file{ CreateFileW(std::wstring{ path }.c_str(),
+                                        GENERIC_READ,
+                                        FILE_SHARE_READ,
+                                        nullptr,
+                                        OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL,
+                                        nullptr) };
+    if (!file)
+    {
+        const auto error = GetLastError();
+        if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND)
+        {
+            return false;
+        }
+        THROW_WIN32(error);
+    }
+
+    LARGE_INTEGER fileSize{};
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+    const auto size = gsl::narrow<uint64_t>(fileSize.QuadPart);
+    THROW_HR_IF(E_UNEXPECTED, size < sizeof(FileHeader) + sizeof(FileFooter));
+
+    wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+    THROW_LAST_ERROR_IF(!mapping);
+    wil::unique_mapview_ptr<std::byte> view{ static_cast<std::byte*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+    THROW_LAST_ERROR_IF(!view);
+    const MappedReader reader{ view.get(), size };
+
+    const auto header = reader.Read<FileHeader>(0);
+    THROW_HR_IF(E_UNEXPECTED, header.magic != Magic || header.version != Version || header.attributeSize != sizeof(TextAttribute));
+
+    const auto footer = reader.Read<FileFooter>(size - sizeof(FileFooter));
+    THROW_HR_IF(E_UNEXPECTED, footer.rowOffsetsOffset > size - sizeof(FileFooter));
+    THROW_HR_IF(E_UNEXPECTED, size - sizeof(FileFooter) - footer.rowOffsetsOffset != uint64_t{ header.rowCount } * sizeof(uint64_t));
+
+    // The IDs of hyperlinks are only meaningful within the buffer they came from.
+    std::unordered_map<uint16_t, uint16_t> hyperlinkIds;
+    auto offset = footer.hyperlinksOffset;
+    const auto hyperlinkCount = reader.Read<uint32_t>(offset);
+    offset += sizeof(uint32_t);
+    std::wstring uri;
+    for (uint32_t i = 0; i < hyperlinkCount; ++i)
+    {
+        const auto hyperlink = reader.Read<HyperlinkHeader>(offset);
+        offset += sizeof(hyperlink);
+        uri.resize(hyperlink.uriLength);
+        reader.Read(offset, uri.data(), uri.size() * sizeof(wchar_t));
+        offset += uri.size() * sizeof(wchar_t);
+
+        const auto id = buffer.GetHyperlinkId(uri, {});
+        buffer.AddHyperlinkToMap(uri, id);
+        hyperlinkIds.emplace(hyperlink.id, id);
+    }
+
+    const auto width = gsl::narrow_cast<uint16_t>(buffer.GetSize().Width());
+    const auto rowsToRestore = std::min<uint32_t>(header.rowCount, buffer.TotalRowCount());
+    const auto firstRow = header.rowCount - rowsToRestore;
+    std::wstring text;
+
+    for (uint32_t y = 0; y < rowsToRestore; ++y)
+    {
+        auto rowOffset = reader.Read<uint64_t>(footer.rowOffsetsOffset + uint64_t{ firstRow + y } * sizeof(uint64_t));
+        const auto rowHeader = reader.Read<RowHeader>(rowOffset);
+        rowOffset += sizeof(rowHeader);
+        const auto runsOffset = rowOffset;
+        rowOffset += uint64_t{ rowHeader.runCount } * sizeof(RowRun);
+
+        text.resize(rowHeader.textLength);
+        reader.Read(rowOffset, text.data(), text.size() * sizeof(wchar_t));
+        buffer.WriteLine(OutputCellIterator{ text }, { 0, gsl::narrow_cast<SHORT>(y) });
+
+        auto& row = buffer.GetRowByOffset(y);
+        auto& attrRow = row.GetAttrRow();
+        uint16_t column = 0;
+        for (uint16_t i = 0; i < rowHeader.runCount && column < width; ++i)
+        {
+            auto run = reader.Read<RowRun>(runsOffset + uint64_t{ i } * sizeof(RowRun));
+            if (const auto id = run.attr.GetHyperlinkId())
+            {
+                const auto it = hyperlinkIds.find(id);
+                run.attr.SetHyperlinkId(it != hyperlinkIds.end() ? it->second : 0);
+            }
+
+            const auto end = gsl::narrow_cast<uint16_t>(std::min<size_t>(size_t{ column } + run.length, width));
+            attrRow.Replace(column, end, run.attr);
+            column = end;
+        }
+
+        row.SetLineRendition(static_cast<LineRendition>(rowHeader.lineRendition));
+        row.SetWrapForced(rowHeader.wrapForced != 0);
+    }
+
+    const auto lastRestoredRow = rowsToRestore ? static_cast<int>(rowsToRestore) - 1 : 0;
+    const auto cursorX = std::clamp<int>(header.cursorX, 0, width - 1);
+    const auto cursorY = std::clamp<int>(header.cursorY - static_cast<int>(firstRow), 0, lastRestoredRow);
+    buffer.GetCursor().SetPosition({ gsl::narrow_cast<SHORT>(cursorX), gsl::narrow_cast<SHORT>(cursorY) });
+    return true;
+}
@@ -0,0 +1,37 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- PersistedBuffer.hpp
+
+Abstract:
+- Saves the contents of a TextBuffer into a file and restores them from it, so
+  that a session that's brought back after a restart shows what it showed
+  before, even before its connection has started.
+- The file is a versioned binary format, so that saving and restoring are
+  little more than copying memory. All values are little endian:
+  * a FileHeader: the magic "WTBF", the version, the size of a TextAttribute,
+    the width of the buffer, the number of rows and the cursor position
+  * the rows, oldest first. Each of them is a RowHeader, followed by its
+    attribute runs and its text (UTF-16, without trailing whitespace).
+  * the hyperlinks the rows refer to: their number, followed by the ID, the
+    length and the URI (UTF-16) of each of them
+  * the offset of every row, as a uint64_t
+  * a FileFooter with the offsets of the hyperlinks and of the row offsets
+- Saving streams the rows into the file as it goes, so it doesn't need a copy
+  of the buffer in memory. The file is only put in place once it's complete.
+- Restoring maps the file into memory and reads just the newest rows that fit
+  into the buffer, so the pages of any other rows are never read from disk.
+--*/
+
+#pragma once
+
+class TextBuffer;
+
+class PersistedBuffer final
+{
+public:
+    static void Save(const TextBuffer& buffer, const std::wstring_view path);
+    static bool Restore(TextBuffer& buffer, const std::wstring_view path);
+};
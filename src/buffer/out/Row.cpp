@@ -6,6 +6,8 @@
 #include "CharRow.hpp"
 #include "textBuffer.hpp"
 #include "../types/inc/convert.hpp"
+#include "../types/inc/GraphemeParser.hpp"
+#include "../types/inc/GlyphWidth.hpp"
 
 // Routine Description:
 // - constructor
@@ -14,18 +16,38 @@
 // - rowWidth - the width of the row, cell elements
 // - fillAttribute - the default text attribute
 // - pParent - the text buffer that this row belongs to
+// - resource - the memory resource the row's cells are allocated from
 // Return Value:
 // - constructed object
-ROW::ROW(const SHORT rowId, const unsigned short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent) :
+// Note:
+// - The row of a buffer starts out blank and doesn't allocate any cells until it's unpacked.
+//   A buffer holds thousands of rows, most of which are never written to. It unpacks
+//   them once they're retrieved. A row without a buffer gets its cells right away.
+ROW::ROW(const SHORT rowId, const unsigned short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent, std::pmr::memory_resource* const resource) :
     _id{ rowId },
     _rowWidth{ rowWidth },
-    _charRow{ rowWidth, this },
-    _attrRow{ rowWidth, fillAttribute },
+    _charRow{ pParent ? 0u : rowWidth, this, resource },
+    _attrRow{ rowWidth, fillAttribute, pParent ? &pParent->GetHyperlinkStore() : nullptr },
     _lineRendition{ LineRendition::SingleWidth },
     _wrapForced{ false },
     _doubleBytePadded{ false },
-    _pParent{ pParent }
+    _pParent{ pParent },
+    _revision{ 0 }
 {
+    _Touch();
+}
+
+// Routine Description:
+// - Marks the row as modified, by assigning it the next generation of its parent
+//   buffer as its revision. As generations only ever increase, no two rows
+//   of a buffer share the same revision, even after they've been moved around.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ROW::_Touch() noexcept
+{
+    _revision = _pParent ? _pParent->NextGeneration() : _revision + 1;
 }
 
 // Routine Description:
@@ -36,10 +58,20 @@ ROW::ROW(const SHORT rowId, const unsigned short rowWidth, const TextAttribute f
 // - <none>
 bool ROW::Reset(const TextAttribute Attr)
 {
+    _Touch();
     _lineRendition = LineRendition::SingleWidth;
     _wrapForced = false;
     _doubleBytePadded = false;
-    _charRow.Reset();
+    if (IsMaterialized())
+    {
+        _charRow.Reset();
+    }
+    else
+    {
+        // A row without cells can stay that way: it's blank
+        // and will only allocate its cells once it's used.
+        _packed.reset();
+    }
     try
     {
         _attrRow.Reset(Attr);
@@ -60,7 +92,20 @@ bool ROW::Reset(const TextAttribute Attr)
 // - S_OK if successful, otherwise relevant error
 [[nodiscard]] HRESULT ROW::Resize(const unsigned short width)
 {
-    RETURN_IF_FAILED(_charRow.Resize(width));
+    try
+    {
+        if (_packed)
+        {
+            Unpack();
+        }
+    }
+    CATCH_RETURN();
+
+    // A blank row stays blank at any width. It'll allocate as many cells as it needs once it's used.
+    if (IsMaterialized())
+    {
+        RETURN_IF_FAILED(_charRow.Resize(width));
+    }
     try
     {
         _attrRow.Resize(width);
@@ -68,6 +113,7 @@ bool ROW::Reset(const TextAttribute Attr)
     CATCH_RETURN();
 
     _rowWidth = width;
+    _Touch();
 
     return S_OK;
 }
@@ -81,17 +127,489 @@ bool ROW::Reset(const TextAttribute Attr)
 void ROW::ClearColumn(const size_t column)
 {
     THROW_HR_IF(E_INVALIDARG, column >= _charRow.size());
+    _Touch();
     _charRow.ClearCell(column);
 }
 
+// Routine Description:
+// - releases the glyphs of the [begin, end) range of cells that live in the UnicodeStorage.
+//   The cells themselves are left alone, as the caller is about to overwrite them.
+void ROW::_EraseStoredGlyphs(const size_t begin, const size_t end) noexcept
+{
+    auto& storage = GetUnicodeStorage();
+    for (auto i = begin; i < end; ++i)
+    {
+        if (til::at(_charRow._data, i).DbcsAttr().IsGlyphStored())
+        {
+            storage.Erase(_charRow.GetStorageKey(i));
+        }
+    }
+}
+
+// Routine Description:
+// - erases the halves of wide glyphs that were left behind at the edges of the
+//   [begin, end) range after it was overwritten. A VT terminal does the same.
+void ROW::_ClearSplitGlyphs(const size_t begin, const size_t end)
+{
+    const auto& cells = _charRow._data;
+    const auto clear = [&](const size_t column) {
+        _EraseStoredGlyphs(column, column + 1);
+        _charRow.ClearCell(column);
+    };
+
+    if (begin > 0 && til::at(cells, begin - 1).DbcsAttr().IsLeading())
+    {
+        clear(begin - 1);
+    }
+    if (til::at(cells, begin).DbcsAttr().IsTrailing())
+    {
+        clear(begin);
+    }
+    if (til::at(cells, end - 1).DbcsAttr().IsLeading())
+    {
+        clear(end - 1);
+    }
+    if (end < cells.size() && til::at(cells, end).DbcsAttr().IsTrailing())
+    {
+        clear(end);
+    }
+}
+
 UnicodeStorage& ROW::GetUnicodeStorage() noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _charRow.GetUnicodeStorage();
 }
 
 const UnicodeStorage& ROW::GetUnicodeStorage() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _charRow.GetUnicodeStorage();
+}
+
+// Routine Description:
+// - Estimates how much memory this row holds on to, for scrollback memory budgets.
+//   Glyphs in the UnicodeStorage and the overhead of the heap aren't counted.
+// Return Value:
+// - the estimated size of this row in bytes
+size_t ROW::GetMemoryUsage() const noexcept
+{
+    using AttrRun = std::decay_t<decltype(_attrRow._data.runs())>::value_type;
+
+    auto usage = sizeof(ROW);
+    usage += _charRow._data.capacity() * sizeof(CharRow::value_type);
+    usage += _attrRow._data.runs().size() * sizeof(AttrRun);
+    if (_packed)
+    {
+        usage += sizeof(PackedRow);
+        usage += _packed->text.capacity() * sizeof(wchar_t);
+        usage += _packed->dbcsAttributes.capacity() * sizeof(DbcsAttribute);
+        usage += _packed->storedGlyphLengths.capacity() * sizeof(uint16_t);
+        if (_packed->attributes)
+        {
+            usage += _packed->attributes->_data.runs().size() * sizeof(AttrRun);
+        }
+    }
+    return usage;
+}
+
+// Routine Description:
+// - Moves the contents of this row into a compact representation and releases
+//   the cell storage. Glyphs kept in UnicodeStorage are folded into the packed text.
+// - The row must be unpacked before its CharRow or ATTR_ROW may be accessed again.
+//   TextBuffer takes care of this whenever a row is retrieved.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ROW::Pack()
+{
+    // Packed and blank rows don't hold any cells already.
+    if (!IsMaterialized())
+    {
+        return;
+    }
+
+    auto& storage = GetUnicodeStorage();
+    const auto& cells = _charRow._data;
+
+    // Blank cells at the end of the row are implied and don't need to be stored.
+    auto columns = cells.size();
+    while (columns > 0 && cells[columns - 1].IsSpace() && cells[columns - 1].DbcsAttr().IsSingle())
+    {
+        --columns;
+    }
+
+    const auto plainCell = [](const CharRowCell& cell) noexcept {
+        return cell.DbcsAttr().IsSingle() && !cell.DbcsAttr().IsGlyphStored();
+    };
+    const auto plainCells = std::all_of(cells.begin(), cells.begin() + columns, plainCell);
+
+    auto packed = std::make_unique<PackedRow>();
+    packed->text.reserve(columns);
+    if (!plainCells)
+    {
+        packed->dbcsAttributes.reserve(columns);
+    }
+
+    for (size_t i = 0; i < columns; ++i)
+    {
+        const auto& cell = til::at(cells, i);
+        if (cell.DbcsAttr().IsGlyphStored())
+        {
+            const auto& glyph = storage.GetText(_charRow.GetStorageKey(i));
+            packed->text.append(glyph.data(), glyph.size());
+            packed->storedGlyphLengths.emplace_back(gsl::narrow<uint16_t>(glyph.size()));
+        }
+        else
+        {
+            packed->text.push_back(cell.Char());
+        }
+
+        if (!plainCells)
+        {
+            packed->dbcsAttributes.emplace_back(cell.DbcsAttr());
+        }
+    }
+
+    // Everything that could fail has succeeded. Release what we have copied.
+    storage.Clear();
+
+    // A row with a single attribute run stores it inline already.
+    if (_attrRow._data.runs().size() > 1)
+    {
+        const auto fillAttribute = _attrRow.GetAttrByColumn(0);
+        packed->attributes.emplace(std::move(_attrRow));
+        _attrRow = ATTR_ROW{ _rowWidth, fillAttribute };
+    }
+
+    _charRow._data.clear();
+    _charRow._data.shrink_to_fit();
+    _packed = std::move(packed);
+}
+
+// Routine Description:
+// - Restores the cells of a row that was previously packed with ROW::Pack().
+//   A blank row gets its cells allocated, all of them spaces.
+// - Does nothing if the row holds its cells already.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void ROW::Unpack()
+{
+    if (IsMaterialized())
+    {
+        return;
+    }
+
+    auto& cells = _charRow._data;
+
+    // Allocate exactly one row worth of cells, so that the buffer's RowPool can serve them.
+    cells.reserve(_rowWidth);
+    cells.resize(_rowWidth);
+
+    if (!_packed)
+    {
+        return;
+    }
+
+    _UnpackCells(_charRow);
+
+    if (_packed->attributes)
+    {
+        _attrRow = std::move(*_packed->attributes);
+    }
+
+    _packed.reset();
+}
+
+// Routine Description:
+// - Copies this row into the given one, which doesn't belong to a buffer
+//   and is of the same width. A packed or blank row is unpacked into the
+//   copy, while this row is left as it is. See TextBuffer::_GetRowAt.
+// - The copy has the id and the revision of this row.
+// Arguments:
+// - target - the row to copy this one into
+// Return Value:
+// - <none>
+void ROW::CopyTo(ROW& target) const
+{
+    THROW_HR_IF(E_INVALIDARG, target._pParent || !target.IsMaterialized() || target._rowWidth != _rowWidth);
+
+    if (IsMaterialized())
+    {
+        target._charRow._data = _charRow._data;
+        target._charRow._unicodeStorage = _charRow._unicodeStorage;
+    }
+    else
+    {
+        target._charRow.Reset();
+        if (_packed)
+        {
+            _UnpackCells(target._charRow);
+        }
+    }
+
+    target._attrRow = _packed && _packed->attributes ? *_packed->attributes : _attrRow;
+    target._lineRendition = _lineRendition;
+    target._wrapForced = _wrapForced;
+    target._doubleBytePadded = _doubleBytePadded;
+    target._id = _id;
+    target._revision = _revision;
+    target._clearEpoch = _clearEpoch;
+}
+
+// Routine Description:
+// - Restores the cells of this packed row into the given ones, which are all blank.
+// Arguments:
+// - charRow - the cells to restore this row into, either its own or those of a copy
+// Return Value:
+// - <none>
+void ROW::_UnpackCells(CharRow& charRow) const
+{
+    auto& cells = charRow._data;
+    auto& storage = charRow.GetUnicodeStorage();
+    const auto& packed = *_packed;
+
+    auto text = packed.text.cbegin();
+    auto glyphLength = packed.storedGlyphLengths.cbegin();
+    const auto columns = packed.dbcsAttributes.empty() ? packed.text.size() : packed.dbcsAttributes.size();
+
+    for (size_t i = 0; i < columns; ++i)
+    {
+        auto& cell = til::at(cells, i);
+        if (!packed.dbcsAttributes.empty())
+        {
+            cell.DbcsAttr() = til::at(packed.dbcsAttributes, i);
+        }
+
+        if (cell.DbcsAttr().IsGlyphStored())
+        {
+            const auto length = *glyphLength;
+            storage.StoreGlyph(charRow.GetStorageKey(i), { text, text + length });
+            text += length;
+            ++glyphLength;
+        }
+        else
+        {
+            cell.Char() = *text;
+            ++text;
+        }
+    }
+}
+
+// Routine Description:
+// - writes a run of printable ASCII characters (see TextBuffer::MeasurePrintableAscii)
+//   with a single attribute to the row. This is the fast path for the most common
+//   kind of output: unlike WriteCells it doesn't need to inspect every cell for its
+//   attribute and DBCS status, as all of the characters are single cells.
+// Arguments:
+// - chars - the characters to write. They must all be printable ASCII.
+// - index - column in row to start writing at
+// - attr - the attribute to apply to all of the written cells
+// - wrap - change the wrap flag if we filled the last column of the row.
+// Return Value:
+// - the number of characters written, which is limited by the end of the row.
+size_t ROW::WriteAsciiCells(const std::wstring_view chars, const size_t index, const TextAttribute attr, const std::optional<bool> wrap)
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
+
+    _Touch();
+
+    const auto count = std::min(chars.size(), _charRow.size() - index);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Cells are packed to 3 bytes each, so there's no way to copy the
+    // characters in bulk. This loop is branchless though and writes the
+    // default DbcsAttribute (a single, non-stored glyph) with each character.
+    const auto begin = _charRow.begin() + index;
+    std::transform(chars.begin(), chars.begin() + count, begin, [](const wchar_t wch) noexcept {
+        return CharRow::value_type{ wch, DbcsAttribute{} };
+    });
+
+    const auto endIndex = index + count;
+    _attrRow.Replace(gsl::narrow_cast<uint16_t>(index), gsl::narrow_cast<uint16_t>(endIndex), attr);
+
+    if (wrap.has_value() && endIndex == _charRow.size())
+    {
+        SetWrapForced(*wrap);
+    }
+
+    return count;
+}
+
+// Routine Description:
+// - writes text with a single attribute to the row. This produces the same cells as
+//   WriteCells with an OutputCellIterator over the text and attribute, which is the
+//   most common shape of a write, but without going through the iterator: there's no
+//   mode to dispatch on for every cell and no attribute to compare, as all the cells
+//   are known to get the same one.
+// - A wide glyph that doesn't fit into the last column pads the column out instead
+//   and is left in the text for the next row.
+// Arguments:
+// - text - the text to write. On return, it's advanced past the glyphs that were written.
+// - index - column in row to start writing at
+// - attr - the attribute to apply to all of the written cells
+// - wrap - change the wrap flag if we hit the end of the row while writing.
+// Return Value:
+// - the number of cells written, not counting the padding.
+size_t ROW::WriteTextCells(std::wstring_view& text, const size_t index, const TextAttribute attr, const std::optional<bool> wrap)
+{
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
+
+    _Touch();
+
+    const auto width = _charRow.size();
+    auto column = index;
+    auto padded = false;
+    while (!text.empty() && column < width)
+    {
+        const auto glyph = GraphemeParser::ParseNext(text);
+        if (IsGlyphFullWidth(glyph))
+        {
+            if (column + 1 == width)
+            {
+                _charRow.ClearCell(column);
+                SetDoubleBytePadded(true);
+                padded = true;
+                break;
+            }
+
+            DbcsAttribute dbcsAttr;
+            dbcsAttr.SetLeading();
+            _charRow.DbcsAttrAt(column) = dbcsAttr;
+            _charRow.GlyphAt(column) = glyph;
+            dbcsAttr.SetTrailing();
+            _charRow.DbcsAttrAt(column + 1) = dbcsAttr;
+            _charRow.GlyphAt(column + 1) = glyph;
+            column += 2;
+        }
+        else
+        {
+            _charRow.DbcsAttrAt(column) = DbcsAttribute{};
+            _charRow.GlyphAt(column) = glyph;
+            ++column;
+        }
+
+        // Like the iterator, this moves forward by the length of the glyph we got,
+        // which is a whole grapheme cluster, like a letter and its combining marks.
+        text = text.substr(glyph.size());
+    }
+
+    // The padding gets the attribute of the glyph it stands in for.
+    const auto endIndex = padded ? column + 1 : column;
+    if (endIndex == index)
+    {
+        return 0;
+    }
+
+    _attrRow.Replace(gsl::narrow_cast<uint16_t>(index), gsl::narrow_cast<uint16_t>(endIndex), attr);
+
+    if (wrap.has_value() && endIndex == width)
+    {
+        SetWrapForced(*wrap);
+    }
+
+    return column - index;
+}
+
+// Routine Description:
+// - copies the [sourceBegin, sourceEnd) range of cells of a row into this row, starting at
+//   targetBegin. Unlike WriteCells this copies the characters as a single span and splices
+//   in the attribute runs as a whole, which is what makes the VT rectangle operations cheap.
+// - Wide glyphs that are cut in half by the edges of the range are erased to blanks.
+// Arguments:
+// - source - the row to copy from. May be this very row, even if the ranges overlap.
+// - sourceBegin, sourceEnd - the range of columns to copy
+// - targetBegin - the column of this row the range is copied to
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ROW::CopyCells(const ROW& source, const size_t sourceBegin, const size_t sourceEnd, const size_t targetBegin)
+{
+    THROW_HR_IF(E_INVALIDARG, sourceBegin > sourceEnd || sourceEnd > source._charRow.size());
+    const auto count = sourceEnd - sourceBegin;
+    THROW_HR_IF(E_INVALIDARG, targetBegin + count > _charRow.size());
+    if (count == 0)
+    {
+        return;
+    }
+
+    _Touch();
+
+    // Glyphs that don't fit into a single wchar_t are stored by column,
+    // so they have to be moved over separately. They're rare though.
+    const auto& sourceCells = source._charRow._data;
+    std::vector<std::pair<UnicodeStorage::key_type, UnicodeStorage::mapped_type>> glyphs;
+    for (auto i = sourceBegin; i < sourceEnd; ++i)
+    {
+        if (til::at(sourceCells, i).DbcsAttr().IsGlyphStored())
+        {
+            const auto targetKey = _charRow.GetStorageKey(targetBegin + i - sourceBegin);
+            glyphs.emplace_back(targetKey, source.GetUnicodeStorage().GetText(source._charRow.GetStorageKey(i)));
+        }
+    }
+
+    _EraseStoredGlyphs(targetBegin, targetBegin + count);
+
+    // If the source is to the left of an overlapping target, we need to copy backwards.
+    auto& cells = _charRow._data;
+    const auto first = sourceCells.begin() + sourceBegin;
+    const auto last = sourceCells.begin() + sourceEnd;
+    if (&source == this && targetBegin > sourceBegin)
+    {
+        std::copy_backward(first, last, cells.begin() + targetBegin + count);
+    }
+    else
+    {
+        std::copy(first, last, cells.begin() + targetBegin);
+    }
+
+    auto& storage = GetUnicodeStorage();
+    for (const auto& [key, glyph] : glyphs)
+    {
+        storage.StoreGlyph(key, glyph);
+    }
+
+    _attrRow.CopyRuns(source._attrRow,
+                      gsl::narrow_cast<uint16_t>(sourceBegin),
+                      gsl::narrow_cast<uint16_t>(sourceEnd),
+                      gsl::narrow_cast<uint16_t>(targetBegin));
+
+    _ClearSplitGlyphs(targetBegin, targetBegin + count);
+}
+
+// Routine Description:
+// - fills the [begin, end) range of cells of this row with a single character.
+// - Wide glyphs that are cut in half by the edges of the range are erased to blanks.
+// Arguments:
+// - begin, end - the range of columns to fill
+// - fillChar - the character to fill the range with. It must be a single cell wide.
+// - fillAttrs - the attributes to fill the range with, or nullopt to keep the existing ones.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ROW::FillCells(const size_t begin, const size_t end, const wchar_t fillChar, const std::optional<TextAttribute> fillAttrs)
+{
+    THROW_HR_IF(E_INVALIDARG, begin > end || end > _charRow.size());
+    if (begin == end)
+    {
+        return;
+    }
+
+    _Touch();
+
+    _EraseStoredGlyphs(begin, end);
+
+    auto& cells = _charRow._data;
+    std::fill(cells.begin() + begin, cells.begin() + end, CharRow::value_type{ fillChar, DbcsAttribute{} });
+
+    if (fillAttrs)
+    {
+        _attrRow.Replace(gsl::narrow_cast<uint16_t>(begin), gsl::narrow_cast<uint16_t>(end), *fillAttrs);
+    }
+
+    _ClearSplitGlyphs(begin, end);
 }
 
 // Routine Description:
@@ -108,6 +626,8 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
     THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
     THROW_HR_IF(E_INVALIDARG, limitRight.value_or(0) >= _charRow.size());
 
+    _Touch();
+
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(_charRow.size() - 1);
 
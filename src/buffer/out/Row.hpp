@@ -32,28 +32,62 @@ class TextBuffer;
 class ROW final
 {
 public:
-    ROW(const SHORT rowId, const unsigned short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent);
+    ROW(const SHORT rowId, const unsigned short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent, std::pmr::memory_resource* const resource = til::pmr::get_default_resource());
 
     size_t size() const noexcept { return _rowWidth; }
 
-    void SetWrapForced(const bool wrap) noexcept { _wrapForced = wrap; }
+    void SetWrapForced(const bool wrap) noexcept
+    {
+        _Touch();
+        _wrapForced = wrap;
+    }
     bool WasWrapForced() const noexcept { return _wrapForced; }
 
-    void SetDoubleBytePadded(const bool doubleBytePadded) noexcept { _doubleBytePadded = doubleBytePadded; }
+    void SetDoubleBytePadded(const bool doubleBytePadded) noexcept
+    {
+        _Touch();
+        _doubleBytePadded = doubleBytePadded;
+    }
     bool WasDoubleBytePadded() const noexcept { return _doubleBytePadded; }
 
+    // The non-const accessors count as modifications, as we can't tell what the caller does with them.
     const CharRow& GetCharRow() const noexcept { return _charRow; }
-    CharRow& GetCharRow() noexcept { return _charRow; }
+    CharRow& GetCharRow() noexcept
+    {
+        _Touch();
+        return _charRow;
+    }
 
     const ATTR_ROW& GetAttrRow() const noexcept { return _attrRow; }
-    ATTR_ROW& GetAttrRow() noexcept { return _attrRow; }
+    ATTR_ROW& GetAttrRow() noexcept
+    {
+        _Touch();
+        return _attrRow;
+    }
 
     LineRendition GetLineRendition() const noexcept { return _lineRendition; }
-    void SetLineRendition(const LineRendition lineRendition) noexcept { _lineRendition = lineRendition; }
+    void SetLineRendition(const LineRendition lineRendition) noexcept
+    {
+        _Touch();
+        _lineRendition = lineRendition;
+    }
+
+    // The generation of the parent TextBuffer this row was last modified in.
+    uint64_t GetRevision() const noexcept { return _revision; }
+    // Copies of rows that are handed to readers report the revision of their row. See TextBuffer::_GetRowAt.
+    void SetRevision(const uint64_t revision) noexcept { _revision = revision; }
+
+    // The clear epoch of the parent TextBuffer this row is up to date with. See TextBuffer::ClearRowsBelow().
+    uint64_t GetClearEpoch() const noexcept { return _clearEpoch; }
+    void SetClearEpoch(const uint64_t epoch) noexcept { _clearEpoch = epoch; }
 
     SHORT GetId() const noexcept { return _id; }
     void SetId(const SHORT id) noexcept { _id = id; }
 
+    // Rows get moved around within the buffer, which leaves the CharRow pointing at the old location.
+    // Unlike GetCharRow().UpdateParent() this doesn't count as a modification of the row.
+    void UpdateCharRowParent() { _charRow.UpdateParent(this); }
+
     bool Reset(const TextAttribute Attr);
     [[nodiscard]] HRESULT Resize(const unsigned short width);
 
@@ -64,6 +98,20 @@ public:
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
 
     OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const std::optional<bool> wrap = std::nullopt, std::optional<size_t> limitRight = std::nullopt);
+    size_t WriteAsciiCells(const std::wstring_view chars, const size_t index, const TextAttribute attr, const std::optional<bool> wrap = std::nullopt);
+    size_t WriteTextCells(std::wstring_view& text, const size_t index, const TextAttribute attr, const std::optional<bool> wrap = std::nullopt);
+    void CopyCells(const ROW& source, const size_t sourceBegin, const size_t sourceEnd, const size_t targetBegin);
+    void FillCells(const size_t begin, const size_t end, const wchar_t fillChar, const std::optional<TextAttribute> fillAttrs);
+
+    // Rows don't allocate their cells until they're retrieved from the buffer for the first time.
+    // Until then they're blank: every cell is a space with the attribute the row was created or reset with.
+    bool IsMaterialized() const noexcept { return !_charRow._data.empty(); }
+    bool IsBlank() const noexcept { return !IsMaterialized() && !_packed; }
+    bool IsPacked() const noexcept { return _packed != nullptr; }
+    size_t GetMemoryUsage() const noexcept;
+    void Pack();
+    void Unpack();
+    void CopyTo(ROW& target) const;
 
 #ifdef UNIT_TESTING
     friend constexpr bool operator==(const ROW& a, const ROW& b) noexcept;
@@ -71,6 +119,22 @@ public:
 #endif
 
 private:
+    // The compact representation of a row that has scrolled far into the scrollback.
+    // While a row is packed its CharRow holds no cells and its ATTR_ROW holds
+    // just a single run. See ROW::Pack() and ROW::Unpack(). A row that holds
+    // no cells and isn't packed either is blank.
+    struct PackedRow
+    {
+        // The glyphs of all cells up to the last non-blank one, concatenated.
+        std::wstring text;
+        // The DbcsAttribute of each of those cells, unless they're all plain single-width cells.
+        std::vector<DbcsAttribute> dbcsAttributes;
+        // The length of each glyph that used to live in UnicodeStorage, in column order.
+        std::vector<uint16_t> storedGlyphLengths;
+        // The attribute runs of the row, unless the row has only a single one.
+        std::optional<ATTR_ROW> attributes;
+    };
+
     CharRow _charRow;
     ATTR_ROW _attrRow;
     LineRendition _lineRendition;
@@ -81,6 +145,14 @@ private:
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded;
     TextBuffer* _pParent; // non ownership pointer
+    std::unique_ptr<PackedRow> _packed;
+    uint64_t _revision;
+    uint64_t _clearEpoch{ 0 };
+
+    void _Touch() noexcept;
+    void _UnpackCells(CharRow& charRow) const;
+    void _EraseStoredGlyphs(const size_t begin, const size_t end) noexcept;
+    void _ClearSplitGlyphs(const size_t begin, const size_t end);
 };
 
 #ifdef UNIT_TESTING
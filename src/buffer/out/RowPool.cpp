@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "RowPool.hpp"
+
+static constexpr size_t npos = static_cast<size_t>(-1);
+
+// Routine Description:
+// - constructor
+// Arguments:
+// - blockSize - the size in bytes of the allocations we'll serve ourselves
+// - blocksPerChunk - the number of blocks we'll request from upstream at once
+// - upstream - the resource we get chunks and any memory that isn't poolable from
+// Return Value:
+// - constructed object
+RowPool::RowPool(const size_t blockSize, const size_t blocksPerChunk, std::pmr::memory_resource* const upstream) noexcept :
+    _upstream{ upstream },
+    _requestedBlockSize{ blockSize },
+    // Freed blocks store the pointer to the next free block in their first bytes.
+    _blockSize{ (std::max(blockSize, sizeof(void*)) + alignof(void*) - 1) & ~(alignof(void*) - 1) },
+    _blocksPerChunk{ std::max<size_t>(1, blocksPerChunk) },
+    _chunks{},
+    _hint{ 0 }
+{
+}
+
+RowPool::~RowPool()
+{
+    while (!_chunks.empty())
+    {
+        _ReleaseChunk(_chunks.size() - 1);
+    }
+}
+
+// Routine Description:
+// - Returns the number of chunks currently allocated from upstream.
+size_t RowPool::ChunkCount() const noexcept
+{
+    return _chunks.size();
+}
+
+// Routine Description:
+// - Returns the number of blocks that are currently handed out to rows.
+size_t RowPool::BlocksInUse() const noexcept
+{
+    size_t used = 0;
+    for (const auto& chunk : _chunks)
+    {
+        used += chunk.used;
+    }
+    return used;
+}
+
+void* RowPool::do_allocate(const size_t bytes, const size_t alignment)
+{
+    if (!_IsPoolable(bytes, alignment))
+    {
+        return _upstream->allocate(bytes, alignment);
+    }
+
+    const auto hasRoom = [&](const Chunk& chunk) noexcept {
+        return chunk.freeList || chunk.bumpIndex < _blocksPerChunk;
+    };
+
+    // Prefer the chunk we used last, then any chunk with room, and only then grow.
+    if (_hint >= _chunks.size() || !hasRoom(til::at(_chunks, _hint)))
+    {
+        const auto it = std::find_if(_chunks.begin(), _chunks.end(), hasRoom);
+        if (it != _chunks.end())
+        {
+            _hint = gsl::narrow_cast<size_t>(it - _chunks.begin());
+        }
+        else
+        {
+            Chunk chunk;
+            chunk.memory = static_cast<std::byte*>(_upstream->allocate(_blockSize * _blocksPerChunk, alignof(void*)));
+            try
+            {
+                _chunks.emplace_back(chunk);
+            }
+            catch (...)
+            {
+                _upstream->deallocate(chunk.memory, _blockSize * _blocksPerChunk, alignof(void*));
+                throw;
+            }
+            _hint = _chunks.size() - 1;
+        }
+    }
+
+    auto& chunk = til::at(_chunks, _hint);
+    void* block;
+    if (chunk.freeList)
+    {
+        block = chunk.freeList;
+        chunk.freeList = *static_cast<void**>(block);
+    }
+    else
+    {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        block = chunk.memory + chunk.bumpIndex * _blockSize;
+        ++chunk.bumpIndex;
+    }
+    ++chunk.used;
+    return block;
+}
+
+void RowPool::do_deallocate(void* const ptr, const size_t bytes, const size_t alignment)
+{
+    const auto index = _IsPoolable(bytes, alignment) ? _FindChunk(ptr) : npos;
+    if (index == npos)
+    {
+        _upstream->deallocate(ptr, bytes, alignment);
+        return;
+    }
+
+    auto& chunk = til::at(_chunks, index);
+    *static_cast<void**>(ptr) = chunk.freeList;
+    chunk.freeList = ptr;
+    --chunk.used;
+    _hint = index;
+
+    if (chunk.used == 0)
+    {
+        // We keep a single empty chunk around, so that a row being packed
+        // followed by another one being recycled doesn't thrash the heap.
+        const auto otherEmpty = std::find_if(_chunks.begin(), _chunks.end(), [&](const Chunk& other) noexcept {
+            return &other != &chunk && other.used == 0;
+        });
+        if (otherEmpty != _chunks.end())
+        {
+            _ReleaseChunk(index);
+        }
+    }
+}
+
+bool RowPool::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+bool RowPool::_IsPoolable(const size_t bytes, const size_t alignment) const noexcept
+{
+    return bytes == _requestedBlockSize && alignment <= alignof(void*);
+}
+
+// Routine Description:
+// - Finds the chunk the given block was carved out of.
+// Return Value:
+// - the index of the chunk in _chunks or npos if it's not ours
+size_t RowPool::_FindChunk(const void* const ptr) const noexcept
+{
+    const auto contains = [&](const Chunk& chunk) noexcept {
+        const auto p = static_cast<const std::byte*>(ptr);
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        return p >= chunk.memory && p < chunk.memory + _blockSize * _blocksPerChunk;
+    };
+
+    if (_hint < _chunks.size() && contains(til::at(_chunks, _hint)))
+    {
+        return _hint;
+    }
+
+    const auto it = std::find_if(_chunks.begin(), _chunks.end(), contains);
+    return it == _chunks.end() ? npos : gsl::narrow_cast<size_t>(it - _chunks.begin());
+}
+
+void RowPool::_ReleaseChunk(const size_t index) noexcept
+{
+    _upstream->deallocate(til::at(_chunks, index).memory, _blockSize * _blocksPerChunk, alignof(void*));
+    _chunks.erase(_chunks.begin() + index);
+    _hint = 0;
+}
@@ -0,0 +1,68 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RowPool.hpp
+
+Abstract:
+- A memory resource that serves the cell storage of all ROWs of a TextBuffer.
+- Every row of a buffer has the same width and thus requests the same block size.
+  Instead of asking the heap for one small block per row, we carve fixed size
+  blocks out of large chunks.
+- Unlike std::pmr::unsynchronized_pool_resource, chunks that become entirely unused
+  (for instance because their rows got packed into the cold scrollback tier,
+  see ROW::Pack) are given back to the upstream resource.
+- Requests for other block sizes (e.g. after TextBuffer::ResizeTraditional) are
+  forwarded to the upstream resource.
+- Not thread-safe. All access to a TextBuffer happens under the console lock.
+--*/
+
+#pragma once
+
+class RowPool final : public std::pmr::memory_resource
+{
+public:
+    RowPool(const size_t blockSize, const size_t blocksPerChunk, std::pmr::memory_resource* const upstream = til::pmr::get_default_resource()) noexcept;
+    ~RowPool() override;
+
+    RowPool(const RowPool&) = delete;
+    RowPool& operator=(const RowPool&) = delete;
+    RowPool(RowPool&&) = delete;
+    RowPool& operator=(RowPool&&) = delete;
+
+    size_t ChunkCount() const noexcept;
+    size_t BlocksInUse() const noexcept;
+
+private:
+    struct Chunk
+    {
+        std::byte* memory = nullptr;
+        // An intrusive singly linked list of blocks that were given back to us.
+        void* freeList = nullptr;
+        // Blocks at and beyond this index have never been handed out yet.
+        size_t bumpIndex = 0;
+        size_t used = 0;
+    };
+
+    void* do_allocate(const size_t bytes, const size_t alignment) override;
+    void do_deallocate(void* const ptr, const size_t bytes, const size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    bool _IsPoolable(const size_t bytes, const size_t alignment) const noexcept;
+    size_t _FindChunk(const void* const ptr) const noexcept;
+    void _ReleaseChunk(const size_t index) noexcept;
+
+    std::pmr::memory_resource* _upstream;
+    size_t _requestedBlockSize;
+    size_t _blockSize;
+    size_t _blocksPerChunk;
+    std::vector<Chunk> _chunks;
+    // The chunk we allocated from or freed into most recently.
+    // Reusing it keeps the set of chunks in use small and stable.
+    size_t _hint;
+
+#ifdef UNIT_TESTING
+    friend class RowPoolTests;
+#endif
+};
@@ -0,0 +1,349 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "ScrollMarks.hpp"
+
+// Routine Description:
+// - Marks a row. A row can have several marks, but of each category only one.
+// Arguments:
+// - row - the row of the buffer to mark
+// - category - what kind of mark it is
+void ScrollMarks::Add(const size_t row, const ScrollMarkCategory category)
+{
+    if (_Insert(_RowsOf(category), _origin + row))
+    {
+        ++_generation;
+    }
+}
+
+// Routine Description:
+// - Replaces all marks of a category at once, like the results of a new search.
+// - Costs O(m), as the marks of the other categories are kept apart.
+// Arguments:
+// - category - the category of the marks to replace
+// - rows - the rows to mark instead, in ascending order. Duplicates are ignored.
+void ScrollMarks::Replace(const ScrollMarkCategory category, const std::vector<size_t>& rows)
+{
+    auto& marks = _RowsOf(category);
+    marks.clear();
+    for (const auto row : rows)
+    {
+        const auto absolute = _origin + row;
+        if (marks.empty() || marks.back() != absolute)
+        {
+            marks.push_back(absolute);
+        }
+    }
+    ++_generation;
+}
+
+// Routine Description:
+// - Changes the category of the last mark of the given category, like when a
+//   shell reports that the command of the last prompt failed.
+// Arguments:
+// - from - the category of the mark to change
+// - to - its new category
+// Return Value:
+// - true if there was such a mark.
+bool ScrollMarks::ChangeLast(const ScrollMarkCategory from, const ScrollMarkCategory to)
+{
+    auto& source = _RowsOf(from);
+    if (source.empty())
+    {
+        return false;
+    }
+    if (from != to)
+    {
+        _Insert(_RowsOf(to), source.back());
+        source.pop_back();
+    }
+    ++_generation;
+    return true;
+}
+
+// Routine Description:
+// - Removes all marks.
+void ScrollMarks::Clear() noexcept
+{
+    if (Size())
+    {
+        for (auto& marks : _marks)
+        {
+            marks.clear();
+        }
+        ++_generation;
+    }
+}
+
+// Routine Description:
+// - Removes the marks of the given rows, like when they're erased.
+// Arguments:
+// - firstRow - the first row of the buffer to remove the marks of
+// - lastRow - the row past the last one to remove the marks of
+void ScrollMarks::Erase(const size_t firstRow, const size_t lastRow)
+{
+    auto erased = false;
+    for (auto& marks : _marks)
+    {
+        const auto first = _LowerBound(marks, _origin + firstRow);
+        const auto last = _LowerBound(marks, _origin + lastRow);
+        if (first != last)
+        {
+            marks.erase(first, last);
+            erased = true;
+        }
+    }
+    if (erased)
+    {
+        ++_generation;
+    }
+}
+
+// Routine Description:
+// - Follows the buffer as it circles: the given number of rows scrolled out
+//   at the top, and every other row moved up by as many rows.
+// Arguments:
+// - count - the number of rows that scrolled out
+void ScrollMarks::Circle(const size_t count) noexcept
+{
+    _origin += count;
+    if (!Size())
+    {
+        return;
+    }
+    for (auto& marks : _marks)
+    {
+        while (!marks.empty() && marks.front() < _origin)
+        {
+            marks.pop_front();
+        }
+    }
+    ++_generation;
+}
+
+// Routine Description:
+// - Follows TextBuffer::ScrollRows, which rotates the rows: the given rows
+//   move by delta, and the rows they move onto take their place.
+// Arguments:
+// - firstRow - the first row of the buffer that moves
+// - size - the number of rows that move
+// - delta - how far they move. Negative moves them up.
+void ScrollMarks::MoveRows(const size_t firstRow, const size_t size, const ptrdiff_t delta)
+{
+    if (!Size() || size == 0 || delta == 0)
+    {
+        return;
+    }
+
+    // The rotated range is [first, last). The rows in [first, middle) move
+    // down to its end and the ones in [middle, last) move up to its start.
+    const auto distance = gsl::narrow_cast<uint64_t>(delta < 0 ? -delta : delta);
+    const auto source = _origin + firstRow;
+    const auto first = delta < 0 ? source - distance : source;
+    const auto middle = delta < 0 ? source : source + size;
+    const auto last = delta < 0 ? source + size : source + size + distance;
+
+    auto moved = false;
+    for (auto& marks : _marks)
+    {
+        const auto begin = _LowerBound(marks, first);
+        const auto end = _LowerBound(marks, last);
+        if (begin == end)
+        {
+            continue;
+        }
+
+        const auto split = _LowerBound(marks, middle);
+        for (auto it = begin; it != end; ++it)
+        {
+            *it = it < split ? *it + (last - middle) : *it - (middle - first);
+        }
+        std::rotate(begin, split, end);
+        moved = true;
+    }
+    if (moved)
+    {
+        ++_generation;
+    }
+}
+
+// Routine Description:
+// - Returns the marks of the given rows.
+// Arguments:
+// - firstRow - the first row of the buffer to return the marks of
+// - lastRow - the row past the last one to return the marks of
+// Return Value:
+// - The marks, ordered by their row, and the marks of a row by their category.
+std::vector<ScrollMark> ScrollMarks::Get(const size_t firstRow, const size_t lastRow) const
+{
+    std::vector<ScrollMark> marks;
+    for (size_t i = 0; i < CategoryCount; ++i)
+    {
+        const auto& rows = til::at(_marks, i);
+        const auto category = static_cast<ScrollMarkCategory>(i);
+        const auto last = _LowerBound(rows, _origin + lastRow);
+        const auto middle = marks.size();
+        for (auto it = _LowerBound(rows, _origin + firstRow); it != last; ++it)
+        {
+            marks.push_back(ScrollMark{ gsl::narrow_cast<size_t>(*it - _origin), category });
+        }
+        // The categories are merged in their order, so that the marks of a row stay ordered by it.
+        std::inplace_merge(marks.begin(), marks.begin() + middle, marks.end(), [](const ScrollMark& a, const ScrollMark& b) noexcept {
+            return a.row < b.row;
+        });
+    }
+    return marks;
+}
+
+size_t ScrollMarks::Size() const noexcept
+{
+    size_t size = 0;
+    for (const auto& marks : _marks)
+    {
+        size += marks.size();
+    }
+    return size;
+}
+
+// Routine Description:
+// - Returns a counter that changes whenever Get() may return something else,
+//   so that callers can skip their work when nothing changed.
+uint64_t ScrollMarks::GetGeneration() const noexcept
+{
+    return _generation;
+}
+
+// Routine Description:
+// - Finds the closest prompt above the given row. The prompts of failed
+//   commands count too.
+// Arguments:
+// - row - the row of the buffer to start at
+// Return Value:
+// - The row of the prompt, or nothing if there's no prompt above the row.
+std::optional<size_t> ScrollMarks::PreviousPrompt(const size_t row) const noexcept
+{
+    const auto absolute = _origin + row;
+    std::optional<uint64_t> result;
+    for (const auto category : { ScrollMarkCategory::Prompt, ScrollMarkCategory::Error })
+    {
+        const auto& marks = _RowsOf(category);
+        const auto it = _LowerBound(marks, absolute);
+        if (it != marks.begin())
+        {
+            result = std::max(result.value_or(0), *std::prev(it));
+        }
+    }
+    if (!result)
+    {
+        return std::nullopt;
+    }
+    return gsl::narrow_cast<size_t>(*result - _origin);
+}
+
+// Routine Description:
+// - Finds the closest prompt below the given row. The prompts of failed
+//   commands count too.
+// Arguments:
+// - row - the row of the buffer to start at
+// Return Value:
+// - The row of the prompt, or nothing if there's no prompt below the row.
+std::optional<size_t> ScrollMarks::NextPrompt(const size_t row) const noexcept
+{
+    const auto absolute = _origin + row + 1;
+    std::optional<uint64_t> result;
+    for (const auto category : { ScrollMarkCategory::Prompt, ScrollMarkCategory::Error })
+    {
+        const auto& marks = _RowsOf(category);
+        const auto it = _LowerBound(marks, absolute);
+        if (it != marks.end())
+        {
+            result = std::min(result.value_or(UINT64_MAX), *it);
+        }
+    }
+    if (!result)
+    {
+        return std::nullopt;
+    }
+    return gsl::narrow_cast<size_t>(*result - _origin);
+}
+
+// Routine Description:
+// - Finds the output of the command that the given row belongs to: from where
+//   the shell reported that the command was executed up to the next prompt.
+//   If the shell doesn't report that, the output is assumed to start on the
+//   row after the prompt.
+// Arguments:
+// - row - a row of the prompt or the output of the command
+// - lastRow - the row past the last one that has been written to. The output
+//   of the last command ends there.
+// Return Value:
+// - The [first, last) rows of the output, or nothing if the row doesn't
+//   belong to a command, or the command didn't output anything.
+std::optional<std::pair<size_t, size_t>> ScrollMarks::GetCommandOutput(const size_t row, const size_t lastRow) const noexcept
+{
+    const auto prompt = PreviousPrompt(row + 1);
+    if (!prompt)
+    {
+        return std::nullopt;
+    }
+
+    const auto nextPrompt = NextPrompt(*prompt);
+    const auto last = std::min(nextPrompt.value_or(lastRow), lastRow);
+
+    auto first = *prompt + 1;
+    const auto& output = _RowsOf(ScrollMarkCategory::Output);
+    const auto it = _LowerBound(output, _origin + *prompt);
+    if (it != output.end() && *it < _origin + last)
+    {
+        first = gsl::narrow_cast<size_t>(*it - _origin);
+    }
+
+    if (first >= last)
+    {
+        return std::nullopt;
+    }
+    return std::pair{ first, last };
+}
+
+ScrollMarks::Rows::iterator ScrollMarks::_LowerBound(Rows& rows, const uint64_t row) noexcept
+{
+    return std::lower_bound(rows.begin(), rows.end(), row);
+}
+
+ScrollMarks::Rows::const_iterator ScrollMarks::_LowerBound(const Rows& rows, const uint64_t row) noexcept
+{
+    return std::lower_bound(rows.cbegin(), rows.cend(), row);
+}
+
+// Routine Description:
+// - Inserts the row into the sorted rows, unless it's in there already.
+//   Marks are almost always added to the bottom of the buffer, where the
+//   cursor is, so this usually appends.
+// Return Value:
+// - true if the row was inserted.
+bool ScrollMarks::_Insert(Rows& rows, const uint64_t row)
+{
+    if (rows.empty() || rows.back() < row)
+    {
+        rows.push_back(row);
+        return true;
+    }
+    const auto it = _LowerBound(rows, row);
+    if (*it == row)
+    {
+        return false;
+    }
+    rows.insert(it, row);
+    return true;
+}
+
+ScrollMarks::Rows& ScrollMarks::_RowsOf(const ScrollMarkCategory category) noexcept
+{
+    return til::at(_marks, static_cast<size_t>(category));
+}
+
+const ScrollMarks::Rows& ScrollMarks::_RowsOf(const ScrollMarkCategory category) const noexcept
+{
+    return til::at(_marks, static_cast<size_t>(category));
+}
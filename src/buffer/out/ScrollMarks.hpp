@@ -0,0 +1,83 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ScrollMarks.hpp
+
+Abstract:
+- An index of the rows of a TextBuffer that are marked as interesting, like
+  the prompts and failed commands that a shell reports, or search results.
+  It's the data behind marks on the scrollbar, or a minimap of the scrollback,
+  and behind jumping between the commands of a shell.
+- The marks of each category are kept in their own list, sorted by row, and
+  the rows are counted from the first row the buffer ever had. Circling the
+  buffer then only drops the marks that scrolled out at the front, instead of
+  renumbering all of them. Queries take O(log n + the number of marks
+  returned), and finding the prompt before or after a row isn't slowed down
+  by the results of a search, no matter how many there are.
+- Not thread-safe. All access to a TextBuffer happens under the console lock.
+--*/
+
+#pragma once
+
+enum class ScrollMarkCategory : uint8_t
+{
+    Prompt,
+    Error,
+    SearchResult,
+    // Where the output of a command starts (FTCS_COMMAND_EXECUTED).
+    // It's only used to find the output; it's not shown on the scrollbar.
+    Output,
+};
+
+struct ScrollMark
+{
+    // The row of the buffer, as of the time of the query.
+    size_t row;
+    ScrollMarkCategory category;
+
+    bool operator==(const ScrollMark& other) const noexcept
+    {
+        return row == other.row && category == other.category;
+    }
+};
+
+class ScrollMarks final
+{
+public:
+    void Add(const size_t row, const ScrollMarkCategory category);
+    void Replace(const ScrollMarkCategory category, const std::vector<size_t>& rows);
+    bool ChangeLast(const ScrollMarkCategory from, const ScrollMarkCategory to);
+    void Clear() noexcept;
+    void Erase(const size_t firstRow, const size_t lastRow);
+
+    void Circle(const size_t count) noexcept;
+    void MoveRows(const size_t firstRow, const size_t size, const ptrdiff_t delta);
+
+    std::vector<ScrollMark> Get(const size_t firstRow, const size_t lastRow) const;
+    size_t Size() const noexcept;
+    uint64_t GetGeneration() const noexcept;
+
+    std::optional<size_t> PreviousPrompt(const size_t row) const noexcept;
+    std::optional<size_t> NextPrompt(const size_t row) const noexcept;
+    std::optional<std::pair<size_t, size_t>> GetCommandOutput(const size_t row, const size_t lastRow) const noexcept;
+
+private:
+    static constexpr size_t CategoryCount = static_cast<size_t>(ScrollMarkCategory::Output) + 1;
+    using Rows = std::deque<uint64_t>;
+
+    static Rows::iterator _LowerBound(Rows& rows, const uint64_t row) noexcept;
+    static Rows::const_iterator _LowerBound(const Rows& rows, const uint64_t row) noexcept;
+    static bool _Insert(Rows& rows, const uint64_t row);
+
+    Rows& _RowsOf(const ScrollMarkCategory category) noexcept;
+    const Rows& _RowsOf(const ScrollMarkCategory category) const noexcept;
+
+    // The absolute rows of the marks, per category.
+    std::array<Rows, CategoryCount> _marks;
+    // The absolute row that's currently the first row of the buffer.
+    uint64_t _origin{ 0 };
+    // Bumped whenever the marks, or the rows they're on, change.
+    uint64_t _generation{ 0 };
+};
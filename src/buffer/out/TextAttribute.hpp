@@ -31,32 +31,31 @@ class TextAttribute final
 {
 public:
     constexpr TextAttribute() noexcept :
-        _wAttrLegacy{ 0 },
+        _hyperlinkId{ 0 },
         _foreground{},
         _background{},
         _extendedAttrs{ ExtendedAttributes::Normal },
-        _hyperlinkId{ 0 }
+        _metaAttrs{ 0 }
     {
     }
 
+    // If we're given lead/trailing byte information with the legacy color, it's stripped.
     explicit constexpr TextAttribute(const WORD wLegacyAttr) noexcept :
-        _wAttrLegacy{ gsl::narrow_cast<WORD>(wLegacyAttr & META_ATTRS) },
+        _hyperlinkId{ 0 },
         _foreground{ gsl::at(s_legacyForegroundColorMap, wLegacyAttr & FG_ATTRS) },
         _background{ gsl::at(s_legacyBackgroundColorMap, (wLegacyAttr & BG_ATTRS) >> 4) },
         _extendedAttrs{ ExtendedAttributes::Normal },
-        _hyperlinkId{ 0 }
+        _metaAttrs{ _ToMetaAttrs(gsl::narrow_cast<WORD>(wLegacyAttr & ~COMMON_LVB_SBCSDBCS)) }
     {
-        // If we're given lead/trailing byte information with the legacy color, strip it.
-        WI_ClearAllFlags(_wAttrLegacy, COMMON_LVB_SBCSDBCS);
     }
 
     constexpr TextAttribute(const COLORREF rgbForeground,
                             const COLORREF rgbBackground) noexcept :
-        _wAttrLegacy{ 0 },
+        _hyperlinkId{ 0 },
         _foreground{ rgbForeground },
         _background{ rgbBackground },
         _extendedAttrs{ ExtendedAttributes::Normal },
-        _hyperlinkId{ 0 }
+        _metaAttrs{ 0 }
     {
     }
 
@@ -147,7 +146,7 @@ public:
                // hyperlinks have a visual representation
                !IsHyperlink() &&
                // all other attributes do not have a visual representation
-               (_wAttrLegacy & META_ATTRS) == (other._wAttrLegacy & META_ATTRS) &&
+               _metaAttrs == other._metaAttrs &&
                ((checkForeground && _foreground == other._foreground) ||
                 (!checkForeground && _background == other._background)) &&
                _extendedAttrs == other._extendedAttrs &&
@@ -156,18 +155,30 @@ public:
 
     constexpr bool IsAnyGridLineEnabled() const noexcept
     {
-        return WI_IsAnyFlagSet(_wAttrLegacy, COMMON_LVB_GRID_HORIZONTAL | COMMON_LVB_GRID_LVERTICAL | COMMON_LVB_GRID_RVERTICAL | COMMON_LVB_UNDERSCORE);
+        return WI_IsAnyFlagSet(_metaAttrs, _ToMetaAttrs(COMMON_LVB_GRID_HORIZONTAL | COMMON_LVB_GRID_LVERTICAL | COMMON_LVB_GRID_RVERTICAL | COMMON_LVB_UNDERSCORE));
     }
 
 private:
+    // All of the legacy META_ATTRS live in the high byte of a legacy attribute
+    // WORD, so that byte is all we need to store. This keeps the struct at 12 bytes.
+    static constexpr uint8_t _ToMetaAttrs(const WORD legacyAttrs) noexcept
+    {
+        return gsl::narrow_cast<uint8_t>((legacyAttrs & META_ATTRS) >> 8);
+    }
+
+    constexpr WORD _GetLegacyMetaAttrs() const noexcept
+    {
+        return gsl::narrow_cast<WORD>(_metaAttrs << 8);
+    }
+
     static std::array<TextColor, 16> s_legacyForegroundColorMap;
     static std::array<TextColor, 16> s_legacyBackgroundColorMap;
 
-    uint16_t _wAttrLegacy; // sizeof: 2, alignof: 2
     uint16_t _hyperlinkId; // sizeof: 2, alignof: 2
     TextColor _foreground; // sizeof: 4, alignof: 1
     TextColor _background; // sizeof: 4, alignof: 1
     ExtendedAttributes _extendedAttrs; // sizeof: 1, alignof: 1
+    uint8_t _metaAttrs; // sizeof: 1, alignof: 1
 
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
@@ -186,11 +197,11 @@ enum class TextAttributeBehavior
 
 constexpr bool operator==(const TextAttribute& a, const TextAttribute& b) noexcept
 {
-    return a._wAttrLegacy == b._wAttrLegacy &&
+    return a._hyperlinkId == b._hyperlinkId &&
            a._foreground == b._foreground &&
            a._background == b._background &&
            a._extendedAttrs == b._extendedAttrs &&
-           a._hyperlinkId == b._hyperlinkId;
+           a._metaAttrs == b._metaAttrs;
 }
 
 constexpr bool operator!=(const TextAttribute& a, const TextAttribute& b) noexcept
@@ -218,7 +229,7 @@ namespace WEX
                     VerifyOutputTraits<TextColor>::ToString(attr._foreground).GetBuffer(),
                     VerifyOutputTraits<TextColor>::ToString(attr._background).GetBuffer(),
                     attr.IsIntense(),
-                    attr._wAttrLegacy,
+                    attr._GetLegacyMetaAttrs(),
                     static_cast<DWORD>(attr._extendedAttrs));
             }
         };
@@ -18,7 +18,9 @@ UnicodeStorage::UnicodeStorage() noexcept :
 // Note: will throw exception if key is not stored yet
 const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) const
 {
-    return _map.at(key);
+    const auto it = _Find(key);
+    THROW_HR_IF(E_INVALIDARG, it == _map.end() || it->first != key);
+    return it->second;
 }
 
 // Routine Description:
@@ -28,7 +30,15 @@ const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) c
 // - glyph - the glyph data to store
 void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
 {
-    _map.insert_or_assign(key, glyph);
+    const auto it = _Find(key);
+    if (it != _map.end() && it->first == key)
+    {
+        it->second = glyph;
+    }
+    else
+    {
+        _map.emplace(it, key, glyph);
+    }
 }
 
 // Routine Description:
@@ -37,62 +47,45 @@ void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
 // - key - the key to remove
 void UnicodeStorage::Erase(const key_type key) noexcept
 {
-    _map.erase(key);
+    const auto it = _Find(key);
+    if (it != _map.end() && it->first == key)
+    {
+        _map.erase(it);
+    }
 }
 
 // Routine Description:
-// - Remaps all of the stored items to new coordinate positions
-//   based on a bulk rearrangement of row IDs and potential row width resize.
-// Arguments:
-// - rowMap - A map of the old row IDs to the new row IDs.
-// - width - The width of the new row. Remove any items that are beyond the row width.
-//         - Use nullopt if we're not resizing the width of the row, just renumbering the rows.
-void UnicodeStorage::Remap(const std::unordered_map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width)
+// - erases all stored glyphs and releases their memory
+void UnicodeStorage::Clear() noexcept
 {
-    // Make a temporary map to hold all the new row positioning
-    std::unordered_map<key_type, mapped_type> newMap;
+    _map.clear();
+    _map.shrink_to_fit();
+}
 
-    // Walk through every stored item.
-    for (const auto& pair : _map)
+// Routine Description:
+// - Removes any items that are beyond the given row width.
+// Arguments:
+// - width - The new width of the row.
+void UnicodeStorage::Trim(const size_t width) noexcept
+{
+    if (width <= std::numeric_limits<key_type>::max())
     {
-        // Extract the old coordinate position
-        const auto oldCoord = pair.first;
-
-        // Only try to short-circuit based on width if we were told it changed
-        // by being given a new width value.
-        if (width.has_value())
-        {
-            // Get the column ID
-            const auto oldColId = oldCoord.X;
-
-            // If the column index is at/beyond the row width, don't bother copying it to the new map.
-            if (oldColId >= width.value())
-            {
-                continue;
-            }
-        }
-
-        // Get the row ID from the position as that's what we need to remap
-        const auto oldRowId = oldCoord.Y;
-
-        // Use the mapping given to convert the old row ID to the new row ID
-        const auto mapIter = rowMap.find(oldRowId);
-
-        // If there's no mapping to a new row, don't bother copying it to the new map. The row is gone.
-        if (mapIter == rowMap.end())
-        {
-            continue;
-        }
-
-        const auto newRowId = mapIter->second;
-
-        // Generate a new coordinate with the same X as the old one, but a new Y value.
-        const auto newCoord = COORD{ oldCoord.X, newRowId };
-
-        // Put the adjusted coordinate into the map with the original value.
-        newMap.emplace(newCoord, pair.second);
+        _map.erase(_Find(gsl::narrow_cast<key_type>(width)), _map.end());
     }
+}
+
+// Routine Description:
+// - Finds the first item whose key isn't less than the given one.
+std::vector<UnicodeStorage::value_type>::iterator UnicodeStorage::_Find(const key_type key) noexcept
+{
+    return std::lower_bound(_map.begin(), _map.end(), key, [](const value_type& item, const key_type k) noexcept {
+        return item.first < k;
+    });
+}
 
-    // Swap into the stored map, free the temporary when we exit.
-    _map.swap(newMap);
+std::vector<UnicodeStorage::value_type>::const_iterator UnicodeStorage::_Find(const key_type key) const noexcept
+{
+    return std::lower_bound(_map.begin(), _map.end(), key, [](const value_type& item, const key_type k) noexcept {
+        return item.first < k;
+    });
 }
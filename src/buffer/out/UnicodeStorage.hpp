@@ -7,6 +7,8 @@ Module Name:
 
 Abstract:
 - dynamic storage location for glyphs that can't normally fit in the output buffer
+- Every CharRow owns one of these for its own glyphs. It's keyed by column and
+  moves along with the row, so that scrolling the buffer never needs to re-key it.
 
 Author(s):
 - Austin Diviness (AustDi) 02-May-2018
@@ -14,36 +16,12 @@ Author(s):
 
 #pragma once
 
-#include <unordered_map>
 #include <vector>
 
-#include <til/bit.h>
-#include <til/hash.h>
-
-// std::unordered_map needs help to know how to hash a COORD
-namespace std
-{
-    template<>
-    struct hash<COORD>
-    {
-        // Routine Description:
-        // - hashes a coord. coord will be hashed by storing the x and y values consecutively in the lower
-        // bits of a size_t.
-        // Arguments:
-        // - coord - the coord to hash
-        // Return Value:
-        // - the hashed coord
-        constexpr size_t operator()(const COORD& coord) const noexcept
-        {
-            return til::hash(til::bit_cast<uint32_t>(coord));
-        }
-    };
-}
-
 class UnicodeStorage final
 {
 public:
-    using key_type = typename COORD;
+    using key_type = typename uint16_t;
     using mapped_type = typename std::vector<wchar_t>;
 
     UnicodeStorage() noexcept;
@@ -54,10 +32,19 @@ public:
 
     void Erase(const key_type key) noexcept;
 
-    void Remap(const std::unordered_map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width);
+    void Clear() noexcept;
+
+    void Trim(const size_t width) noexcept;
 
 private:
-    std::unordered_map<key_type, mapped_type> _map;
+    using value_type = typename std::pair<key_type, mapped_type>;
+
+    std::vector<value_type>::iterator _Find(const key_type key) noexcept;
+    std::vector<value_type>::const_iterator _Find(const key_type key) const noexcept;
+
+    // Sorted by column. A row rarely holds more than a handful of
+    // these glyphs, so a flat vector is both smaller and faster than a map.
+    std::vector<value_type> _map;
 
 #ifdef UNIT_TESTING
     friend class UnicodeStorageTests;
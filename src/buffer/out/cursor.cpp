@@ -284,6 +284,32 @@ void Cursor::CopyProperties(const Cursor& OtherCursor) noexcept
     _cursorType = OtherCursor._cursorType;
 }
 
+// Routine Description:
+// - Puts the cursor back into the state of a newly constructed one, without
+//   redrawing it. Used when its buffer is recycled, see TextBuffer::Recycle.
+// Arguments:
+// - ulSize - The size of the cursor
+// Return Value:
+// - <none>
+void Cursor::Reset(const ULONG ulSize) noexcept
+{
+    _cPosition = { 0 };
+    _fHasMoved = false;
+    _fIsVisible = true;
+    _fIsOn = true;
+    _fIsDouble = false;
+    _fBlinkingAllowed = true;
+    _fDelay = false;
+    _fIsConversionArea = false;
+    _fIsPopupShown = false;
+    _fDelayedEolWrap = false;
+    _coordDelayedAt = { 0 };
+    _fDeferCursorRedraw = false;
+    _fHaveDeferredCursorRedraw = false;
+    _ulSize = ulSize;
+    _cursorType = CursorType::Legacy;
+}
+
 void Cursor::DelayEOLWrap(const COORD coordDelayedAt) noexcept
 {
     _coordDelayedAt = coordDelayedAt;
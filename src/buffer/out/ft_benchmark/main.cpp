@@ -0,0 +1,354 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "../textBuffer.hpp"
+#include "../search.h"
+#include "../../../renderer/inc/DummyRenderTarget.hpp"
+#include "../../../types/IUiaData.h"
+#include "../../../types/inc/AllocationTracking.hpp"
+
+using namespace Microsoft::Console::Types;
+
+// Measures the cost of the operations of a TextBuffer, one at a time. Every
+// operation is repeated in batches until MinimumDuration and MinimumBatches
+// are reached, and the fastest batch is reported, as that's the one the least
+// disturbed by the rest of the system. All inputs are generated from a fixed
+// seed, so that every run measures the exact same work.
+//
+// Allocations are only counted in builds with allocation tracking
+// (msbuild /p:OpenConsoleAllocationTracking=true).
+
+namespace
+{
+    // Every operation is measured for at least this long...
+    constexpr auto MinimumDuration = std::chrono::milliseconds{ 250 };
+    // ...and in at least this many batches...
+    constexpr size_t MinimumBatches = 5;
+    // ...each of which takes at least this long.
+    constexpr auto MinimumBatchDuration = std::chrono::milliseconds{ 10 };
+
+    constexpr SHORT Width = 120;
+    constexpr SHORT Height = 30;
+    constexpr SHORT HistoryHeight = 9001;
+
+    const TextAttribute DefaultAttributes{ 0x07 };
+
+    // A tiny deterministic PRNG (xorshift), so that every run writes the exact same text.
+    struct Random
+    {
+        uint32_t state = 0x12345678;
+
+        uint32_t operator()(const uint32_t bound) noexcept
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state % bound;
+        }
+    };
+
+    // A single row worth of words, like a line of a log file.
+    std::wstring GenerateAsciiLine(Random& random)
+    {
+        std::wstring line;
+        while (line.size() < static_cast<size_t>(Width))
+        {
+            for (auto length = 2 + random(8); length > 0; --length)
+            {
+                line.push_back(static_cast<wchar_t>(L'a' + random(26)));
+            }
+            line.push_back(L' ');
+        }
+        line.resize(Width);
+        return line;
+    }
+
+    // A single row of cells with a new attribute every few of them, like the output of `ls --color`.
+    std::vector<OutputCell> GenerateSgrLine(Random& random)
+    {
+        std::vector<OutputCell> cells;
+        cells.reserve(Width);
+        auto attr = DefaultAttributes;
+        for (SHORT i = 0; i < Width; ++i)
+        {
+            if (random(4) == 0)
+            {
+                attr.SetForeground(TextColor{ static_cast<BYTE>(random(256)), true });
+                attr.SetIntense(random(2) == 0);
+            }
+            const wchar_t wch = static_cast<wchar_t>(L'a' + random(26));
+            cells.emplace_back(std::wstring_view{ &wch, 1 }, DbcsAttribute{}, attr);
+        }
+        return cells;
+    }
+
+    // A single row of CJK ideographs, every one of which takes up two cells.
+    std::wstring GenerateCjkLine(Random& random)
+    {
+        std::wstring line;
+        for (SHORT i = 0; i < Width / 2; ++i)
+        {
+            // U+4E00 - U+9FFF, CJK Unified Ideographs
+            line.push_back(static_cast<wchar_t>(0x4E00 + random(0x5200)));
+        }
+        return line;
+    }
+
+    // A single row of emoji, which are surrogate pairs in UTF-16 and are stored in the UnicodeStorage.
+    std::wstring GenerateEmojiLine(Random& random)
+    {
+        std::wstring line;
+        for (SHORT i = 0; i < Width / 2; ++i)
+        {
+            // U+1F600 - U+1F64F, Emoticons
+            const auto codepoint = 0x1F600 + random(0x50) - 0x10000;
+            line.push_back(static_cast<wchar_t>(0xD800 + (codepoint >> 10)));
+            line.push_back(static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF)));
+        }
+        return line;
+    }
+
+    // Fills every row of the buffer with text, with a URL on every fourth one.
+    void FillBuffer(TextBuffer& buffer)
+    {
+        Random random;
+        const auto size = buffer.GetSize().Dimensions();
+        for (SHORT y = 0; y < size.Y; ++y)
+        {
+            auto line = GenerateAsciiLine(random);
+            if (y % 4 == 0)
+            {
+                line.replace(10, 35, L"https://example.com/path?query=1234");
+            }
+            line.resize(size.X, L' ');
+            buffer.Write(OutputCellIterator{ line, DefaultAttributes }, { 0, y }, false);
+        }
+        buffer.GetCursor().SetPosition({ 0, gsl::narrow_cast<SHORT>(size.Y - 1) });
+    }
+
+    std::unique_ptr<TextBuffer> MakeBuffer(const COORD size, Microsoft::Console::Render::IRenderTarget& renderTarget)
+    {
+        return std::make_unique<TextBuffer>(size, DefaultAttributes, 12u, renderTarget);
+    }
+
+    // Search only needs to know about the buffer and where its text ends.
+    class BenchmarkUiaData final : public IUiaData
+    {
+    public:
+        explicit BenchmarkUiaData(TextBuffer& buffer) noexcept :
+            _buffer{ buffer } {}
+
+        Viewport GetViewport() noexcept override { return _buffer.GetSize(); }
+        COORD GetTextBufferEndPosition() const noexcept override { return _buffer.GetSize().BottomRightInclusive(); }
+        const TextBuffer& GetTextBuffer() noexcept override { return _buffer; }
+        const FontInfo& GetFontInfo() noexcept override { FAIL_FAST(); }
+        gsl::span<const Viewport> GetSelectionRects() noexcept override { return {}; }
+        void LockConsole() noexcept override {}
+        void UnlockConsole() noexcept override {}
+
+        std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute&) const noexcept override { return {}; }
+        const bool IsSelectionActive() const override { return false; }
+        const bool IsBlockSelection() const override { return false; }
+        void ClearSelection() override {}
+        void SelectNewRegion(const COORD, const COORD) override {}
+        const COORD GetSelectionAnchor() const noexcept override { return {}; }
+        const COORD GetSelectionEnd() const noexcept override { return {}; }
+        void ColorSelection(const COORD, const COORD, const TextAttribute) override {}
+        const bool IsUiaDataInitialized() const noexcept override { return true; }
+
+    private:
+        TextBuffer& _buffer;
+    };
+
+    struct Result
+    {
+        std::chrono::duration<double, std::nano> perOp{};
+        double allocationsPerOp = 0;
+    };
+
+    // Calibrates a batch size that takes at least MinimumBatchDuration and then
+    // runs batches of it until MinimumDuration and MinimumBatches are reached.
+    Result Measure(const std::function<void()>& op)
+    {
+        using clock = std::chrono::steady_clock;
+
+        // Run it once, to warm up the caches and allocate any buffers that are kept around.
+        op();
+
+        size_t batchSize = 1;
+        for (;;)
+        {
+            const auto start = clock::now();
+            for (size_t i = 0; i < batchSize; ++i)
+            {
+                op();
+            }
+            if (clock::now() - start >= MinimumBatchDuration)
+            {
+                break;
+            }
+            batchSize *= 2;
+        }
+
+        Result result;
+        result.perOp = std::chrono::duration<double, std::nano>::max();
+        clock::duration total{ 0 };
+        uint64_t allocations = 0;
+        size_t ops = 0;
+        for (size_t batches = 0; batches < MinimumBatches || total < MinimumDuration; ++batches)
+        {
+            const auto allocationsBefore = Microsoft::Console::AllocationTracking::TotalAllocations();
+            const auto start = clock::now();
+            for (size_t i = 0; i < batchSize; ++i)
+            {
+                op();
+            }
+            const auto duration = clock::now() - start;
+            allocations += Microsoft::Console::AllocationTracking::TotalAllocations() - allocationsBefore;
+            ops += batchSize;
+
+            result.perOp = std::min(result.perOp, std::chrono::duration<double, std::nano>{ duration } / static_cast<double>(batchSize));
+            total += duration;
+        }
+        result.allocationsPerOp = static_cast<double>(allocations) / static_cast<double>(ops);
+        return result;
+    }
+
+    void Report(const std::wstring_view name, const Result& result)
+    {
+#ifdef ALLOCATION_TRACKING_BUILD
+        wprintf(L"%-32.*s %14.1f ns/op %10.2f allocs/op\r\n", gsl::narrow_cast<int>(name.size()), name.data(), result.perOp.count(), result.allocationsPerOp);
+#else
+        wprintf(L"%-32.*s %14.1f ns/op\r\n", gsl::narrow_cast<int>(name.size()), name.data(), result.perOp.count());
+#endif
+    }
+
+    void Run(const std::wstring_view name, const std::function<void()>& op)
+    {
+        Report(name, Measure(op));
+    }
+
+    // A write is a single row.
+    void BenchmarkWrites(DummyRenderTarget& renderTarget)
+    {
+        const auto buffer = MakeBuffer({ Width, Height }, renderTarget);
+        Random random;
+        const auto ascii = GenerateAsciiLine(random);
+        const auto sgr = GenerateSgrLine(random);
+        const auto cjk = GenerateCjkLine(random);
+        const auto emoji = GenerateEmojiLine(random);
+
+        SHORT y = 0;
+        const auto nextRow = [&]() noexcept {
+            y = (y + 1) % Height;
+            return COORD{ 0, y };
+        };
+
+        Run(L"Write ascii", [&]() { buffer->Write(OutputCellIterator{ ascii, DefaultAttributes }, nextRow(), false); });
+        Run(L"WriteText ascii", [&]() { buffer->WriteText(ascii, nextRow(), DefaultAttributes, false); });
+        Run(L"Write sgr", [&]() { buffer->Write(OutputCellIterator{ gsl::make_span(sgr) }, nextRow(), false); });
+        Run(L"Write cjk", [&]() { buffer->Write(OutputCellIterator{ cjk, DefaultAttributes }, nextRow(), false); });
+        Run(L"Write emoji", [&]() { buffer->Write(OutputCellIterator{ emoji, DefaultAttributes }, nextRow(), false); });
+        Run(L"WriteCells sgr", [&]() { buffer->GetRowByOffset(nextRow().Y).WriteCells(OutputCellIterator{ gsl::make_span(sgr) }, 0, false); });
+    }
+
+    void BenchmarkScrolling(DummyRenderTarget& renderTarget)
+    {
+        const auto buffer = MakeBuffer({ Width, HistoryHeight }, renderTarget);
+        FillBuffer(*buffer);
+
+        Run(L"IncrementCircularBuffer", [&]() { buffer->IncrementCircularBuffer(); });
+        // A scroll region the size of a viewport at the bottom of the buffer, like a pager.
+        Run(L"ScrollRows viewport", [&]() { buffer->ScrollRows(HistoryHeight - Height + 1, Height - 1, -1); });
+        Run(L"ScrollRows history", [&]() { buffer->ScrollRows(1, HistoryHeight - 1, -1); });
+    }
+
+    // Every reflow goes from a filled buffer to a new, narrower one.
+    void BenchmarkReflow(DummyRenderTarget& renderTarget)
+    {
+        static constexpr std::array<COORD, 3> sizes{ { { 80, 300 }, { Width, 3000 }, { Width, HistoryHeight } } };
+        for (const auto size : sizes)
+        {
+            const auto oldBuffer = MakeBuffer(size, renderTarget);
+            FillBuffer(*oldBuffer);
+
+            const auto name = fmt::format(L"Reflow {}x{}", size.X, size.Y);
+            Run(name, [&]() {
+                const auto newBuffer = MakeBuffer({ gsl::narrow_cast<SHORT>(size.X * 3 / 4), size.Y }, renderTarget);
+                THROW_IF_FAILED(TextBuffer::Reflow(*oldBuffer, *newBuffer, std::nullopt, std::nullopt));
+            });
+        }
+    }
+
+    // A copy of the whole viewport.
+    void BenchmarkCopy(DummyRenderTarget& renderTarget)
+    {
+        const auto buffer = MakeBuffer({ Width, Height }, renderTarget);
+        FillBuffer(*buffer);
+
+        const auto rects = buffer->GetTextRects({ 0, 0 }, { Width - 1, Height - 1 }, false, true);
+        const auto colors = [](const TextAttribute& attr) {
+            return std::pair<COLORREF, COLORREF>{ attr.IsIntense() ? RGB(255, 255, 255) : RGB(204, 204, 204), RGB(12, 12, 12) };
+        };
+
+        Run(L"GetText", [&]() { buffer->GetText(true, true, rects); });
+        const auto text = buffer->GetText(true, true, rects, colors);
+        Run(L"GetText colors", [&]() { buffer->GetText(true, true, rects, colors); });
+        Run(L"GenHTML", [&]() { TextBuffer::GenHTML(text, 12, L"Cascadia Mono", RGB(12, 12, 12)); });
+    }
+
+    void BenchmarkSearch(DummyRenderTarget& renderTarget)
+    {
+        const auto buffer = MakeBuffer({ Width, HistoryHeight }, renderTarget);
+        FillBuffer(*buffer);
+        BenchmarkUiaData uiaData{ *buffer };
+
+        Run(L"Search snapshot", [&]() { Search::s_TakeSnapshot(uiaData, Search::Sensitivity::CaseInsensitive); });
+        const auto snapshot = Search::s_TakeSnapshot(uiaData, Search::Sensitivity::CaseInsensitive);
+        Run(L"Search find all", [&]() { Search::s_FindAll(snapshot, L"example", nullptr); });
+    }
+
+    // The patterns of the viewport, like the renderer asks for after every change.
+    // The recognizer is added again every time to defeat the cache of the buffer.
+    void BenchmarkPatterns(DummyRenderTarget& renderTarget)
+    {
+        const auto buffer = MakeBuffer({ Width, Height }, renderTarget);
+        FillBuffer(*buffer);
+
+        static constexpr std::wstring_view urlPattern{ LR"(\b(https?|ftp|file)://[-A-Za-z0-9+&@#/%?=~_|$!:,.;]*[A-Za-z0-9+&@#/%=~_|$])" };
+        Run(L"GetPatterns", [&]() {
+            buffer->ClearPatternRecognizers();
+            buffer->AddPatternRecognizer(urlPattern);
+            buffer->GetPatterns(0, Height - 1);
+        });
+    }
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    if (argc > 1)
+    {
+        wprintf(L"Usage: conbufferout.benchmark.exe\r\n");
+        wprintf(L"Measures the operations of a TextBuffer on generated text and reports ns/op for each of them.\r\n");
+        return 0;
+    }
+
+    DummyRenderTarget renderTarget;
+    BenchmarkWrites(renderTarget);
+    BenchmarkScrolling(renderTarget);
+    BenchmarkReflow(renderTarget);
+    BenchmarkCopy(renderTarget);
+    BenchmarkSearch(renderTarget);
+    BenchmarkPatterns(renderTarget);
+
+    return 0;
+}
+catch (...)
+{
+    const auto hr = wil::ResultFromCaughtException();
+    wprintf(L"Failed with 0x%08x\r\n", hr);
+    return hr;
+}
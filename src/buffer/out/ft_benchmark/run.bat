@@ -0,0 +1 @@
+%_NTTREE%\unittests\conbufferout.benchmark.exe %*
\ No newline at end of file
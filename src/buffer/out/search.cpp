@@ -7,7 +7,7 @@
 
 #include "CharRow.hpp"
 #include "textBuffer.hpp"
-#include "../types/inc/Utf16Parser.hpp"
+#include "../types/inc/GraphemeParser.hpp"
 #include "../types/inc/GlyphWidth.hpp"
 
 using namespace Microsoft::Console::Types;
@@ -32,7 +32,6 @@ Search::Search(IUiaData& uiaData,
     _uiaData(uiaData),
     _coordAnchor(s_GetInitialAnchor(uiaData, direction))
 {
-    _coordNext = _coordAnchor;
 }
 
 // Routine Description:
@@ -57,7 +56,31 @@ Search::Search(IUiaData& uiaData,
     _coordAnchor(anchor),
     _uiaData(uiaData)
 {
-    _coordNext = _coordAnchor;
+}
+
+// Routine Description:
+// - Constructs a Search object from matches that were already found with s_FindAll().
+// - The matches may have been found on another thread, against a snapshot of
+//   the buffer. FindNext() then continues from the current selection, as usual.
+// Arguments:
+// - uiaData - The IUiaData type reference, it is for providing selection methods
+// - str - The search term that was found
+// - direction - The direction to search (upward or downward)
+// - sensitivity - Whether or not you care about case
+// - matches - Every match of the search term, ordered by their start position
+Search::Search(IUiaData& uiaData,
+               const std::wstring& str,
+               const Direction direction,
+               const Sensitivity sensitivity,
+               std::vector<std::pair<COORD, COORD>> matches) :
+    _direction(direction),
+    _sensitivity(sensitivity),
+    _needle(s_CreateNeedleFromString(str)),
+    _uiaData(uiaData),
+    _coordAnchor(s_GetInitialAnchor(uiaData, direction)),
+    _matches(std::move(matches))
+{
+    _PickFirstMatch();
 }
 
 // Routine Description
@@ -69,28 +92,45 @@ Search::Search(IUiaData& uiaData,
 // - NOTE: You can FindNext() again after False to go around the buffer again.
 bool Search::FindNext()
 {
-    if (_reachedEnd)
+    if (!_matches)
     {
-        _reachedEnd = false;
+        _BuildIndex();
+    }
+
+    const auto count = _matches->size();
+    if (_matchesReturned == count)
+    {
+        _matchesReturned = 0;
         return false;
     }
 
-    do
+    std::tie(_coordSelStart, _coordSelEnd) = til::at(*_matches, _nextMatch);
+    ++_matchesReturned;
+
+    if (_direction == Direction::Forward)
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
-        {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
-        }
-        else
-        {
-            _UpdateNextPosition();
-        }
+        _nextMatch = (_nextMatch + 1) % count;
+    }
+    else
+    {
+        _nextMatch = (_nextMatch + count - 1) % count;
+    }
 
-    } while (_coordNext != _coordAnchor);
+    return true;
+}
 
-    return false;
+// Routine Description
+// - Locates every instance of the search term within the screen buffer at once.
+// - Doesn't affect the position of FindNext().
+// Return Value:
+// - [start, end] coord positions of all matches, ordered by their start position
+const std::vector<std::pair<COORD, COORD>>& Search::FindAll()
+{
+    if (!_matches)
+    {
+        _BuildIndex();
+    }
+    return *_matches;
 }
 
 // Routine Description:
@@ -178,148 +218,248 @@ COORD Search::s_GetInitialAnchor(IUiaData& uiaData, const Direction direction)
 }
 
 // Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
+// - Provides an abstraction for conditionally applying case sensitivity
 // Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
+// - wch - Character to adjust if necessary
+// - sensitivity - Whether or not you care about case
 // Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const
+// - Adjusted value (or not).
+wchar_t Search::s_ApplySensitivity(const wchar_t wch, const Sensitivity sensitivity) noexcept
 {
-    start = { 0 };
-    end = { 0 };
-
-    COORD bufferPos = pos;
-
-    for (const auto& needleCell : _needle)
+    if (sensitivity == Sensitivity::CaseInsensitive)
     {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _uiaData.GetTextBuffer().GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-        const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
-
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
-        {
-            return false;
-        }
-
-        _IncrementCoord(bufferPos);
+        return ::towlower(wch);
     }
+    else
+    {
+        return wch;
+    }
+}
 
-    _DecrementCoord(bufferPos);
-
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
+// Routine Description:
+// - Finds all matches of the needle in the buffer and picks the one FindNext() returns first.
+void Search::_BuildIndex()
+{
+    if (_needle.empty())
+    {
+        _matches.emplace();
+        return;
+    }
 
-    return true;
+    _matches = s_FindNeedle(s_TakeSnapshot(_uiaData, _sensitivity), _needle, nullptr);
+    _PickFirstMatch();
 }
 
 // Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
+// - Extracts the text of all rows of the buffer into a flat haystack.
+//   Every cell contributes its glyph, including the trailing half of wide
+//   glyphs, just like s_CreateNeedleFromString lays out the needle.
+// - The caller must hold the lock of the buffer, but only for this call.
+//   The snapshot can be searched with s_FindAll() on any thread afterwards.
 // Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
+// - uiaData - The IUiaData type reference, of the buffer to take a snapshot of
+// - sensitivity - Whether or not searches of the snapshot care about case
 // Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept
+// - The snapshot of the buffer.
+Search::Snapshot Search::s_TakeSnapshot(IUiaData& uiaData, const Sensitivity sensitivity)
 {
-    if (one.size() != two.size())
+    Snapshot snapshot;
+    const auto& textBuffer = uiaData.GetTextBuffer();
+    snapshot.lastPosition = uiaData.GetTextBufferEndPosition();
+    snapshot.width = gsl::narrow_cast<size_t>(textBuffer.GetSize().Width());
+    snapshot.sensitivity = sensitivity;
+    const auto width = snapshot.width;
+    const auto height = gsl::narrow_cast<size_t>(snapshot.lastPosition.Y) + 1;
+
+    auto& haystack = snapshot.haystack;
+    auto& rowOffsets = snapshot.rowOffsets;
+    haystack.reserve(width * height);
+    rowOffsets.reserve(height + 1);
+
+    // Reused for every row, as most of them turn out to be regular anyway.
+    std::vector<size_t> cellOffsets;
+    cellOffsets.reserve(width);
+
+    for (size_t y = 0; y < height; ++y)
     {
-        return false;
-    }
+        const auto& charRow = textBuffer.GetRowByOffset(y).GetCharRow();
+        const auto rowOffset = haystack.size();
+        rowOffsets.push_back(rowOffset);
+        cellOffsets.clear();
+        for (size_t x = 0; x < width; ++x)
+        {
+            cellOffsets.push_back(haystack.size() - rowOffset);
+            for (const auto wch : charRow.GlyphAt(x))
+            {
+                haystack.push_back(s_ApplySensitivity(wch, sensitivity));
+            }
+        }
 
-    for (size_t i = 0; i < one.size(); i++)
-    {
-        if (_ApplySensitivity(one.at(i)) != _ApplySensitivity(two.at(i)))
+        if (haystack.size() - rowOffset != width)
         {
-            return false;
+            snapshot.irregularRows.emplace_back(y, cellOffsets);
         }
     }
-
-    return true;
+    rowOffsets.push_back(haystack.size());
+    return snapshot;
 }
 
 // Routine Description:
-// - Provides an abstraction for conditionally applying case sensitivity
-//   based on object construction
+// - Finds the cell of a snapshot that starts at the given offset into its haystack.
 // Arguments:
-// - wch - Character to adjust if necessary
+// - snapshot - The snapshot taken with s_TakeSnapshot()
+// - offset - The offset into the haystack, up to and including its length
 // Return Value:
-// - Adjusted value (or not).
-wchar_t Search::_ApplySensitivity(const wchar_t wch) const noexcept
+// - The index of the cell, counted row by row. The length of the haystack maps
+//   to the cell after the last one. Nothing if the offset is within a cell.
+std::optional<size_t> Search::s_CellAt(const Snapshot& snapshot, const size_t offset)
 {
-    if (_sensitivity == Sensitivity::CaseInsensitive)
+    const auto& rowOffsets = snapshot.rowOffsets;
+    // Every row stores at least one character per cell, so the offsets are strictly increasing.
+    const auto row = std::upper_bound(rowOffsets.cbegin(), rowOffsets.cend(), offset) - 1;
+    const auto y = gsl::narrow_cast<size_t>(row - rowOffsets.cbegin());
+    const auto relative = offset - *row;
+
+    const auto& irregularRows = snapshot.irregularRows;
+    const auto irregular = std::lower_bound(irregularRows.cbegin(), irregularRows.cend(), y, [](const auto& entry, const size_t value) noexcept {
+        return entry.first < value;
+    });
+    if (irregular == irregularRows.cend() || irregular->first != y)
     {
-        return ::towlower(wch);
+        return y * snapshot.width + relative;
     }
-    else
+
+    const auto& cellOffsets = irregular->second;
+    const auto cell = std::lower_bound(cellOffsets.cbegin(), cellOffsets.cend(), relative);
+    if (cell == cellOffsets.cend() || *cell != relative)
     {
-        return wch;
+        return std::nullopt;
     }
+    return y * snapshot.width + gsl::narrow_cast<size_t>(cell - cellOffsets.cbegin());
 }
 
 // Routine Description:
-// - Helper to increment a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to increment one position (will wrap X and Y direction)
-void Search::_IncrementCoord(COORD& coord) const noexcept
+// - Finds all matches of the search term in a snapshot of the buffer.
+// - Instead of comparing the needle cell by cell at every position of the buffer,
+//   the haystack of the snapshot is scanned with a substring searcher.
+// - The haystack is scanned in windows, so that a search that was superseded
+//   can be abandoned early.
+// Arguments:
+// - snapshot - The snapshot taken with s_TakeSnapshot()
+// - str - The search term you want to find (the "needle")
+// - cancelled - If given, is called regularly. The search stops if it returns true.
+// Return Value:
+// - [start, end] coord positions of all matches, ordered by their start position.
+//   Empty if the search was cancelled.
+std::vector<std::pair<COORD, COORD>> Search::s_FindAll(const Snapshot& snapshot,
+                                                       const std::wstring& str,
+                                                       const std::function<bool()>& cancelled)
 {
-    _uiaData.GetTextBuffer().GetSize().IncrementInBoundsCircular(coord);
+    return s_FindNeedle(snapshot, s_CreateNeedleFromString(str), cancelled);
 }
 
 // Routine Description:
-// - Helper to decrement a coordinate in respect to the associated screen buffer
-// Arguments
-// - coord - Updated by function to decrement one position (will wrap X and Y direction)
-void Search::_DecrementCoord(COORD& coord) const noexcept
+// - Like s_FindAll(), for a needle made with s_CreateNeedleFromString().
+std::vector<std::pair<COORD, COORD>> Search::s_FindNeedle(const Snapshot& snapshot,
+                                                          std::wstring needle,
+                                                          const std::function<bool()>& cancelled)
 {
-    _uiaData.GetTextBuffer().GetSize().DecrementInBoundsCircular(coord);
-}
+    // Large enough to make the cost of checking for cancellation negligible,
+    // small enough to give up within a millisecond or so.
+    static constexpr size_t windowSize = 256 * 1024;
 
-// Routine Description:
-// - Helper to update the coordinate position to the next point to be searched
-// Return Value:
-// - True if we haven't reached the end of the buffer. False otherwise.
-void Search::_UpdateNextPosition()
-{
-    if (_direction == Direction::Forward)
-    {
-        _IncrementCoord(_coordNext);
-    }
-    else if (_direction == Direction::Backward)
-    {
-        _DecrementCoord(_coordNext);
-    }
-    else
+    std::vector<std::pair<COORD, COORD>> matches;
+    const auto& haystack = snapshot.haystack;
+    const auto width = snapshot.width;
+    const auto lastPosition = snapshot.lastPosition;
+
+    if (needle.empty() || width == 0)
     {
-        THROW_HR(E_NOTIMPL);
+        return matches;
     }
+    std::transform(needle.begin(), needle.end(), needle.begin(), [&](const wchar_t wch) noexcept {
+        return s_ApplySensitivity(wch, snapshot.sensitivity);
+    });
 
-    // To reduce wrap-around time, if the next position is larger than
-    // the end position of the written text
-    // We put the next position to:
-    // Forward: (0, 0)
-    // Backward: the position of the end of the text buffer
-    const COORD bufferEndPosition = _uiaData.GetTextBufferEndPosition();
+    const auto toCoord = [&](const size_t cell) {
+        return COORD{ gsl::narrow_cast<SHORT>(cell % width), gsl::narrow_cast<SHORT>(cell / width) };
+    };
 
-    if (_coordNext.Y > bufferEndPosition.Y ||
-        (_coordNext.Y == bufferEndPosition.Y && _coordNext.X > bufferEndPosition.X))
+    const std::boyer_moore_horspool_searcher searcher{ needle.begin(), needle.end() };
+    for (auto it = haystack.cbegin(); it != haystack.cend();)
     {
-        if (_direction == Direction::Forward)
+        if (cancelled && cancelled())
         {
-            _coordNext = { 0 };
+            return {};
         }
-        else
+
+        // The window is extended, so that matches that start in it may end past it.
+        const auto remaining = gsl::narrow_cast<size_t>(haystack.cend() - it);
+        const auto windowEnd = it + std::min(remaining, windowSize + needle.size() - 1);
+        const auto [first, last] = searcher(it, windowEnd);
+        if (first == windowEnd)
         {
-            _coordNext = bufferEndPosition;
+            if (windowEnd == haystack.cend())
+            {
+                break;
+            }
+            it = windowEnd - (needle.size() - 1);
+            continue;
         }
+
+        const auto firstOffset = gsl::narrow_cast<size_t>(first - haystack.cbegin());
+        const auto lastOffset = gsl::narrow_cast<size_t>(last - haystack.cbegin());
+
+        // A match only counts if it covers whole cells. The needle "a" mustn't
+        // match the first half of a cell that stores a longer glyph.
+        const auto startCell = s_CellAt(snapshot, firstOffset);
+        const auto endCell = startCell ? s_CellAt(snapshot, lastOffset) : std::nullopt;
+        if (startCell && endCell)
+        {
+            const auto start = toCoord(*startCell);
+            if (start.Y == lastPosition.Y && start.X > lastPosition.X)
+            {
+                break;
+            }
+            matches.emplace_back(start, toCoord(*endCell - 1));
+        }
+
+        // Matches may overlap, so we continue right after the start of this one.
+        it = first + 1;
+    }
+
+    return matches;
+}
+
+// Routine Description:
+// - Picks the match of _matches that FindNext() returns first.
+void Search::_PickFirstMatch()
+{
+    const auto& matches = *_matches;
+    if (matches.empty())
+    {
+        return;
+    }
+
+    // FindNext() starts at the anchor and wraps around the buffer.
+    // Forward: the first match starting at or after the anchor.
+    // Backward: the last match starting at or before the anchor.
+    const auto compare = [](const COORD a, const COORD b) noexcept {
+        return a.Y < b.Y || (a.Y == b.Y && a.X < b.X);
+    };
+    if (_direction == Direction::Forward)
+    {
+        const auto it = std::lower_bound(matches.cbegin(), matches.cend(), _coordAnchor, [&](const auto& match, const COORD anchor) noexcept {
+            return compare(match.first, anchor);
+        });
+        _nextMatch = it == matches.cend() ? 0 : gsl::narrow_cast<size_t>(it - matches.cbegin());
+    }
+    else
+    {
+        const auto it = std::upper_bound(matches.cbegin(), matches.cend(), _coordAnchor, [&](const COORD anchor, const auto& match) noexcept {
+            return compare(anchor, match.first);
+        });
+        _nextMatch = it == matches.cbegin() ? matches.size() - 1 : gsl::narrow_cast<size_t>(it - matches.cbegin()) - 1;
     }
 }
 
@@ -329,18 +469,21 @@ void Search::_UpdateNextPosition()
 // Arguments:
 // - wstr - String that will be our search term
 // Return Value:
-// - Structured text data for comparison to screen buffer text data.
-std::vector<std::vector<wchar_t>> Search::s_CreateNeedleFromString(const std::wstring& wstr)
+// - The text of all cells the search term occupies, concatenated.
+//   Wide glyphs are repeated for their trailing cell, like the buffer reports them.
+std::wstring Search::s_CreateNeedleFromString(const std::wstring& wstr)
 {
-    const auto charData = Utf16Parser::Parse(wstr);
-    std::vector<std::vector<wchar_t>> cells;
-    for (const auto chars : charData)
+    std::wstring cells;
+    cells.reserve(wstr.size());
+    for (std::wstring_view remaining{ wstr }; !remaining.empty();)
     {
-        if (IsGlyphFullWidth(std::wstring_view{ chars.data(), chars.size() }))
+        const auto glyph = GraphemeParser::ParseNext(remaining);
+        if (IsGlyphFullWidth(glyph))
         {
-            cells.emplace_back(chars);
+            cells.append(glyph);
         }
-        cells.emplace_back(chars);
+        cells.append(glyph);
+        remaining = remaining.substr(glyph.size());
     }
     return cells;
 }
@@ -40,6 +40,24 @@ public:
         CaseSensitive
     };
 
+    // The text of a buffer, laid out the way it is searched, so that it can
+    // be searched without holding the lock of the buffer it was taken from.
+    struct Snapshot
+    {
+        std::wstring haystack;
+        // rowOffsets[y] is the offset into the haystack at which row y
+        // starts. The last entry is the length of the haystack.
+        std::vector<size_t> rowOffsets;
+        // Most rows store a single character per cell, so the offset of a
+        // cell is implied by its column. The rows that don't are listed here,
+        // ordered by their row, with the offset of each of their cells
+        // relative to the start of the row.
+        std::vector<std::pair<size_t, std::vector<size_t>>> irregularRows;
+        size_t width = 0;
+        COORD lastPosition = { 0 };
+        Sensitivity sensitivity = Sensitivity::CaseSensitive;
+    };
+
     Search(Microsoft::Console::Types::IUiaData& uiaData,
            const std::wstring& str,
            const Direction dir,
@@ -51,32 +69,47 @@ public:
            const Sensitivity sensitivity,
            const COORD anchor);
 
+    Search(Microsoft::Console::Types::IUiaData& uiaData,
+           const std::wstring& str,
+           const Direction dir,
+           const Sensitivity sensitivity,
+           std::vector<std::pair<COORD, COORD>> matches);
+
+    static Snapshot s_TakeSnapshot(Microsoft::Console::Types::IUiaData& uiaData, const Sensitivity sensitivity);
+    static std::vector<std::pair<COORD, COORD>> s_FindAll(const Snapshot& snapshot,
+                                                          const std::wstring& str,
+                                                          const std::function<bool()>& cancelled);
+
     bool FindNext();
+    const std::vector<std::pair<COORD, COORD>>& FindAll();
     void Select() const;
     void Color(const TextAttribute attr) const;
 
     std::pair<COORD, COORD> GetFoundLocation() const noexcept;
 
 private:
-    wchar_t _ApplySensitivity(const wchar_t wch) const noexcept;
-    bool _FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept;
-    void _UpdateNextPosition();
-
-    void _IncrementCoord(COORD& coord) const noexcept;
-    void _DecrementCoord(COORD& coord) const noexcept;
+    static wchar_t s_ApplySensitivity(const wchar_t wch, const Sensitivity sensitivity) noexcept;
+    static std::optional<size_t> s_CellAt(const Snapshot& snapshot, const size_t offset);
+    static std::vector<std::pair<COORD, COORD>> s_FindNeedle(const Snapshot& snapshot,
+                                                             std::wstring needle,
+                                                             const std::function<bool()>& cancelled);
+    void _BuildIndex();
+    void _PickFirstMatch();
 
     static COORD s_GetInitialAnchor(Microsoft::Console::Types::IUiaData& uiaData, const Direction dir);
 
-    static std::vector<std::vector<wchar_t>> s_CreateNeedleFromString(const std::wstring& wstr);
+    static std::wstring s_CreateNeedleFromString(const std::wstring& wstr);
 
-    bool _reachedEnd = false;
-    COORD _coordNext = { 0 };
+    // Every match in the buffer, ordered by their start position.
+    // Built on the first call to FindNext() or FindAll().
+    std::optional<std::vector<std::pair<COORD, COORD>>> _matches;
+    size_t _nextMatch = 0;
+    size_t _matchesReturned = 0;
     COORD _coordSelStart = { 0 };
     COORD _coordSelEnd = { 0 };
 
     const COORD _coordAnchor;
-    const std::vector<std::vector<wchar_t>> _needle;
+    const std::wstring _needle;
     const Direction _direction;
     const Sensitivity _sensitivity;
     Microsoft::Console::Types::IUiaData& _uiaData;
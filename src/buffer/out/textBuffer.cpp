@@ -8,8 +8,11 @@
 
 #include "../types/inc/utils.hpp"
 #include "../types/inc/convert.hpp"
-#include "../../types/inc/Utf16Parser.hpp"
+#include "../../types/inc/GraphemeParser.hpp"
 #include "../../types/inc/GlyphWidth.hpp"
+#include "../../types/inc/AllocationTracking.hpp"
+
+#include <til/hash.h>
 
 #pragma hdrstop
 
@@ -18,6 +21,12 @@ using namespace Microsoft::Console::Types;
 
 using PointTree = interval_tree::IntervalTree<til::point, size_t>;
 
+// The number of rows each thread keeps copies of, for the rows of a buffer that aren't ready to be read yet. See _GetPreparedCopy.
+static constexpr size_t PreparedRowCount = 64;
+
+// The id of the buffer that was created last. Ids start at 1, so that 0 never matches a buffer.
+static std::atomic<uint64_t> s_lastBufferId{ 0 };
+
 // Routine Description:
 // - Creates a new instance of TextBuffer
 // Arguments:
@@ -35,18 +44,22 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     _firstRow{ 0 },
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
+    _rowPool{ gsl::narrow_cast<size_t>(screenBufferSize.X) * sizeof(CharRowCell), std::min<size_t>(256, gsl::narrow_cast<size_t>(screenBufferSize.Y)) },
     _storage{},
-    _unicodeStorage{},
-    _renderTarget{ renderTarget },
+    _renderTarget{ &renderTarget },
     _size{},
-    _currentHyperlinkId{ 1 },
     _currentPatternId{ 0 }
 {
-    // initialize ROWs
+    _id = ++s_lastBufferId;
+
+    // The current attributes hold on to their hyperlink, see SetCurrentAttributes.
+    _hyperlinks.Acquire(_currentAttributes.GetHyperlinkId(), 1);
+
+    // initialize ROWs. They're blank and don't allocate their cells until they're first retrieved.
     _storage.reserve(static_cast<size_t>(screenBufferSize.Y));
     for (size_t i = 0; i < static_cast<size_t>(screenBufferSize.Y); ++i)
     {
-        _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this);
+        _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this, &_rowPool);
     }
 
     _UpdateSize();
@@ -75,6 +88,27 @@ UINT TextBuffer::TotalRowCount() const noexcept
     return gsl::narrow<UINT>(_storage.size());
 }
 
+// Routine Description:
+// - Returns the generation of the buffer, which changes whenever any of its rows
+//   are modified or moved. Consumers that cache results per row can compare
+//   this against the generation they last looked at, and ROW::GetRevision()
+//   against the same value to find the rows that need to be re-examined.
+// Return Value:
+// - the current generation
+uint64_t TextBuffer::GetGeneration() const noexcept
+{
+    return _generation;
+}
+
+// Routine Description:
+// - Advances the generation of the buffer. This is called by ROWs when they're modified.
+// Return Value:
+// - the new generation
+uint64_t TextBuffer::NextGeneration() noexcept
+{
+    return ++_generation;
+}
+
 // Routine Description:
 // - Retrieves a row from the buffer by its offset from the first row of the text buffer (what corresponds to
 // the top row of the screen buffer)
@@ -88,7 +122,7 @@ const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     const size_t offsetIndex = (_firstRow + index) % totalRows;
-    return _storage.at(offsetIndex);
+    return _GetRowAt(offsetIndex);
 }
 
 // Routine Description:
@@ -104,7 +138,145 @@ ROW& TextBuffer::GetRowByOffset(const size_t index)
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     const size_t offsetIndex = (_firstRow + index) % totalRows;
-    return _storage.at(offsetIndex);
+    return _GetRowAt(offsetIndex);
+}
+
+// Routine Description:
+// - Retrieves a row by its index in _storage, prepared for use. See _PrepareRow.
+// - The caller may modify the row, so it must have the buffer to itself.
+// Arguments:
+// - storageIndex - the index of the row in _storage
+// Return Value:
+// - reference to the requested row. Throws if out of bounds.
+ROW& TextBuffer::_GetRowAt(const size_t storageIndex)
+{
+    auto& row = _storage.at(storageIndex);
+    _PrepareRow(row);
+    return row;
+}
+
+// Routine Description:
+// - Retrieves a row by its index in _storage, the way _PrepareRow would leave it.
+// - Several threads may read the same buffer at once, so readers never change a row.
+//   Rows that aren't ready to be read are copied instead, see _GetPreparedCopy. Only
+//   the writer prepares rows in place, once it retrieves them with the non-const overload.
+// Arguments:
+// - storageIndex - the index of the row in _storage
+// Return Value:
+// - const reference to the requested row. Throws if out of bounds.
+const ROW& TextBuffer::_GetRowAt(const size_t storageIndex) const
+{
+    const auto& row = _storage.at(storageIndex);
+    if (row.IsMaterialized() && row.GetClearEpoch() == _clearEpoch)
+    {
+        return row;
+    }
+    return _GetPreparedCopy(row);
+}
+
+// Routine Description:
+// - Returns a copy of a row of this buffer that's blank, packed or waiting for a
+//   clear, with the contents the row will have once it's prepared.
+// - The copies live in a small cache of the calling thread, keyed by the revision
+//   of the row. A reference to one stays valid until the thread retrieved
+//   PreparedRowCount other rows this way. Readers like the renderer, search and
+//   selection only ever hold on to a row or two at a time.
+// Arguments:
+// - row - a row of this buffer that isn't ready to be read
+// Return Value:
+// - const reference to the copy of the row
+const ROW& TextBuffer::_GetPreparedCopy(const ROW& row) const
+{
+    struct PreparedRow
+    {
+        uint64_t bufferId{ 0 };
+        uint64_t revision{ 0 };
+        uint64_t clearEpoch{ 0 };
+        SHORT id{ 0 };
+        std::unique_ptr<ROW> row;
+    };
+    static thread_local std::array<PreparedRow, PreparedRowCount> s_preparedRows;
+    static thread_local size_t s_nextPreparedRow{ 0 };
+
+    for (const auto& prepared : s_preparedRows)
+    {
+        if (prepared.bufferId == _id &&
+            prepared.revision == row.GetRevision() &&
+            prepared.clearEpoch == _clearEpoch &&
+            prepared.id == row.GetId() &&
+            prepared.row->size() == row.size())
+        {
+            return *prepared.row;
+        }
+    }
+
+    // The ROW objects are reused rather than replaced, so that a reader that
+    // held on to an evicted copy for too long sees the wrong row, rather than freed memory.
+    auto& prepared = til::at(s_preparedRows, s_nextPreparedRow);
+    s_nextPreparedRow = (s_nextPreparedRow + 1) % s_preparedRows.size();
+    prepared.bufferId = 0;
+
+    const auto width = gsl::narrow_cast<unsigned short>(row.size());
+    if (!prepared.row)
+    {
+        prepared.row = std::make_unique<ROW>(row.GetId(), width, _currentAttributes, nullptr);
+    }
+    else if (prepared.row->size() != row.size())
+    {
+        THROW_IF_FAILED(prepared.row->Resize(width));
+    }
+
+    if (row.GetClearEpoch() != _clearEpoch)
+    {
+        // This is _ApplyPendingClear for the copy. The revision tells caches that
+        // looked at the row before it was cleared to look at it again.
+        THROW_HR_IF(E_OUTOFMEMORY, !prepared.row->Reset(_clearAttributes));
+        prepared.row->SetId(row.GetId());
+        prepared.row->SetRevision(_clearGeneration);
+    }
+    else
+    {
+        row.CopyTo(*prepared.row);
+    }
+
+    prepared.bufferId = _id;
+    prepared.revision = row.GetRevision();
+    prepared.clearEpoch = _clearEpoch;
+    prepared.id = row.GetId();
+    return *prepared.row;
+}
+
+// Routine Description:
+// - Unpacks a row if it was packed into the cold scrollback tier.
+//   A row that was cleared by ClearRowsBelow() but hasn't been retrieved since is reset first.
+//   A row that's retrieved for the first time gets its cells allocated. See ROW::IsBlank().
+// - Only the writer does this, as it changes the row. Readers get copies instead, see _GetRowAt.
+// Arguments:
+// - row - a row of this buffer
+void TextBuffer::_PrepareRow(ROW& row)
+{
+    _ApplyPendingClear(row);
+    if (!row.IsMaterialized())
+    {
+        // Blank rows aren't cold. They get used as the cursor moves down onto them for the first time.
+        if (row.IsPacked())
+        {
+            ++_lazilyUnpackedRows;
+        }
+        row.Unpack();
+    }
+}
+
+// Routine Description:
+// - Resets the row if it was cleared by ClearRowsBelow() since it was last retrieved.
+// Arguments:
+// - row - a row of this buffer
+void TextBuffer::_ApplyPendingClear(ROW& row)
+{
+    if (row.GetClearEpoch() != _clearEpoch && row.Reset(_clearAttributes))
+    {
+        row.SetClearEpoch(_clearEpoch);
+    }
 }
 
 // Routine Description:
@@ -185,6 +357,31 @@ TextBufferCellIterator TextBuffer::GetCellDataAt(const COORD at, const Viewport
     return TextBufferCellIterator(*this, at, limit);
 }
 
+// Routine Description:
+// - Retrieves a read-only iterator over the runs of identical attributes
+//   from the given buffer location to the end of its row.
+// Arguments:
+// - at - X,Y position in buffer for the start of the first run
+// Return Value:
+// - Read-only iterator of attribute runs.
+AttributeRunIterator TextBuffer::GetAttributeRunsAt(const COORD at) const
+{
+    return AttributeRunIterator(GetRowByOffset(at.Y), gsl::narrow<uint16_t>(at.X), gsl::narrow<uint16_t>(GetSize().Width()));
+}
+
+// Routine Description:
+// - Retrieves a read-only iterator over the runs of identical attributes
+//   from the given buffer location to the right edge of the given limit.
+// Arguments:
+// - at - X,Y position in buffer for the start of the first run
+// - limit - boundaries for the iterator to operate within. Only its right edge is relevant.
+// Return Value:
+// - Read-only iterator of attribute runs.
+AttributeRunIterator TextBuffer::GetAttributeRunsAt(const COORD at, const Viewport limit) const
+{
+    return AttributeRunIterator(GetRowByOffset(at.Y), gsl::narrow<uint16_t>(at.X), gsl::narrow<uint16_t>(limit.RightExclusive()));
+}
+
 //Routine Description:
 // - Corrects and enforces consistent double byte character state (KAttrs line) within a row of the text buffer.
 // - This will take the given double byte information and check that it will be consistent when inserted into the buffer
@@ -336,6 +533,8 @@ OutputCellIterator TextBuffer::Write(const OutputCellIterator givenIt,
                                      const COORD target,
                                      const std::optional<bool> wrap)
 {
+    TRACK_ALLOCATIONS(Output);
+
     // Make mutable copy so we can walk.
     auto it = givenIt;
 
@@ -360,6 +559,124 @@ OutputCellIterator TextBuffer::Write(const OutputCellIterator givenIt,
     return it;
 }
 
+// Routine Description:
+// - Counts the leading characters of the given text that are printable ASCII
+//   (U+0020 to U+007E). Those are guaranteed to occupy a single cell each, which
+//   allows them to be written with WriteAsciiLine instead of an OutputCellIterator.
+// Arguments:
+// - text - the text to measure
+// Return Value:
+// - the length of the printable ASCII prefix of text
+size_t TextBuffer::MeasurePrintableAscii(const std::wstring_view text) noexcept
+{
+    size_t i = 0;
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+    // This checks 8 characters at a time. The comparisons are signed, which
+    // means that anything at or above U+8000 fails the first one and is thus
+    // correctly considered to be outside of the range as well.
+    const auto lowerBound = _mm_set1_epi16(0x1f);
+    const auto upperBound = _mm_set1_epi16(0x7f);
+    for (; i + 8 <= text.size(); i += 8)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i));
+        const auto inRange = _mm_and_si128(_mm_cmpgt_epi16(chars, lowerBound), _mm_cmplt_epi16(chars, upperBound));
+        const auto mask = _mm_movemask_epi8(inRange);
+        if (mask != 0xffff)
+        {
+            // Each character yields 2 bits in the mask. Find the first one that's not in range.
+            unsigned long index;
+            _BitScanForward(&index, static_cast<unsigned long>(~mask));
+            return i + index / 2;
+        }
+    }
+#endif
+#pragma warning(pop)
+
+    for (; i < text.size(); ++i)
+    {
+        const auto wch = til::at(text, i);
+        if (wch < 0x20 || wch > 0x7e)
+        {
+            break;
+        }
+    }
+    return i;
+}
+
+// Routine Description:
+// - Writes a run of printable ASCII (see MeasurePrintableAscii) with a single attribute
+//   to one line of the output buffer. This is a faster alternative to WriteLine for plain text.
+// Arguments:
+// - chars - The characters to write. They must all be printable ASCII.
+// - target - Coordinate targeted within output buffer
+// - attr - The attribute to write the characters with
+// - wrap - change the wrap flag if we fill the last column of the row.
+// Return Value:
+// - The number of characters written, which is limited by the end of the row.
+size_t TextBuffer::WriteAsciiLine(const std::wstring_view chars,
+                                  const COORD target,
+                                  const TextAttribute attr,
+                                  const std::optional<bool> wrap)
+{
+    TRACK_ALLOCATIONS(Output);
+
+    // If we're not in bounds, exit early.
+    if (!GetSize().IsInBounds(target))
+    {
+        return 0;
+    }
+
+    ROW& row = GetRowByOffset(target.Y);
+    const auto written = row.WriteAsciiCells(chars, target.X, attr, wrap);
+
+    const Viewport paint = Viewport::FromDimensions(target, { gsl::narrow<SHORT>(written), 1 });
+    _NotifyPaint(paint);
+
+    return written;
+}
+
+// Routine Description:
+// - Writes text with a single attribute to the output buffer, continuing on the
+//   next rows until it's all written or we run out of buffer. This is equivalent
+//   to Write with an OutputCellIterator of the text and the attribute (see ROW::WriteTextCells).
+// Arguments:
+// - text - the text to write
+// - target - the row/column to start writing the text to
+// - attr - the attribute to apply to all of the written cells
+// - wrap - change the wrap flag if we hit the end of the row while writing and there's still more data
+// Return Value:
+// - the number of cells written, like OutputCellIterator::GetCellDistance.
+size_t TextBuffer::WriteText(std::wstring_view text,
+                             const COORD target,
+                             const TextAttribute attr,
+                             const std::optional<bool> wrap)
+{
+    TRACK_ALLOCATIONS(Output);
+
+    auto lineTarget = target;
+    const auto size = GetSize();
+    size_t written = 0;
+
+    while (!text.empty() && size.IsInBounds(lineTarget))
+    {
+        ROW& row = GetRowByOffset(lineTarget.Y);
+        const auto cells = row.WriteTextCells(text, lineTarget.X, attr, wrap);
+
+        const Viewport paint = Viewport::FromDimensions(lineTarget, { gsl::narrow<SHORT>(cells), 1 });
+        _NotifyPaint(paint);
+        written += cells;
+
+        lineTarget.X = 0;
+        ++lineTarget.Y;
+    }
+
+    return written;
+}
+
 // Routine Description:
 // - Writes one line of text to the output buffer.
 // Arguments:
@@ -374,6 +691,8 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
                                          const std::optional<bool> wrap,
                                          std::optional<size_t> limitRight)
 {
+    TRACK_ALLOCATIONS(Output);
+
     // If we're not in bounds, exit early.
     if (!GetSize().IsInBounds(target))
     {
@@ -405,6 +724,8 @@ bool TextBuffer::InsertCharacter(const std::wstring_view chars,
                                  const DbcsAttribute dbcsAttribute,
                                  const TextAttribute attr)
 {
+    TRACK_ALLOCATIONS(Output);
+
     // Ensure consistent buffer state for double byte characters based on the character type we're about to insert
     bool fSuccess = _PrepareForDoubleByteSequence(dbcsAttribute);
 
@@ -541,6 +862,8 @@ bool TextBuffer::NewlineCursor()
     }
     else
     {
+        // The row that's now _hotRows above the cursor just went cold.
+        _PackColdRows();
         fSuccess = true;
     }
     return fSuccess;
@@ -554,14 +877,32 @@ bool TextBuffer::NewlineCursor()
 // - true if we successfully incremented the buffer.
 bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
 {
+    return IncrementCircularBuffer(1, inVtMode);
+}
+
+//Routine Description:
+// - Increments the circular buffer by the given number of rows at once.
+// - This is equivalent to calling IncrementCircularBuffer count times, except that
+//   each row is reset only once (even if count exceeds the height of the buffer)
+//   and the renderer is only told once that we circled.
+//Arguments:
+// - count - the number of rows to scroll off the top of the buffer.
+// - inVtMode - set to true in VT mode, so standard erase attributes are used for the new rows.
+//Return Value:
+// - true if we successfully incremented the buffer. On failure, the buffer has been
+//   incremented by the number of rows that could be reset.
+bool TextBuffer::IncrementCircularBuffer(const size_t count, const bool inVtMode)
+{
+    if (count == 0)
+    {
+        return true;
+    }
+
     // FirstRow is at any given point in time the array index in the circular buffer that corresponds
     // to the logical position 0 in the window (cursor coordinates and all other coordinates).
-    _renderTarget.TriggerCircling();
+    _renderTarget->TriggerCircling();
 
-    // Prune hyperlinks to delete obsolete references
-    _PruneHyperlinks();
-
-    // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
+    // Second, clean out the old "first rows" as they will become the "last rows" of the buffer after the circle is performed.
     auto fillAttributes = _currentAttributes;
     if (inVtMode)
     {
@@ -569,20 +910,134 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         // the current background color, but with no meta attributes set.
         fillAttributes.SetStandardErase();
     }
-    const bool fSuccess = _storage.at(_firstRow).Reset(fillAttributes);
-    if (fSuccess)
+
+    // Circling by more than the height of the buffer cycles through the same rows again,
+    // which leaves them just as blank as they are after the first round.
+    const auto height = TotalRowCount();
+    const auto rowsToReset = std::min(count, height);
+    size_t rowsReset = 0;
+    while (rowsReset < rowsToReset)
+    {
+        auto& row = _storage.at((_firstRow + rowsReset) % height);
+        // The reset below mustn't be undone by a pending clear once the row is retrieved.
+        _ApplyPendingClear(row);
+        if (!row.Reset(fillAttributes))
+        {
+            break;
+        }
+        ++rowsReset;
+    }
+    const bool fSuccess = rowsReset == rowsToReset;
+    const auto increment = fSuccess ? count : rowsReset;
+
+    if (increment != 0)
     {
         // Now proceed to increment.
-        // Incrementing it will cause the next line down to become the new "top" of the window (the new "0" in logical coordinates)
-        _firstRow++;
+        // Incrementing it will cause the next lines down to become the new "top" of the window (the new "0" in logical coordinates)
+        // If we pass up the height of the buffer, loop back around.
+        _firstRow = gsl::narrow_cast<SHORT>((_firstRow + increment) % height);
+        _marks.Circle(increment);
+
+        // Every row moved up. The ones that are now _hotRows above the cursor just went cold.
+        NextGeneration();
+        _PackColdRows(std::min(increment, height));
+    }
+    return fSuccess;
+}
+
+// Routine Description:
+// - Enables the cold scrollback tier: rows that are more than hotRows rows above
+//   the cursor get packed into a compact form (see ROW::Pack) that doesn't hold
+//   any cells. They are unpacked lazily once they're retrieved for writing;
+//   readers are handed an unpacked copy instead (see _GetPreparedCopy).
+// Arguments:
+// - hotRows - the number of rows above the cursor to keep unpacked. 0 disables packing.
+void TextBuffer::SetColdScrollbackThreshold(const size_t hotRows)
+{
+    _hotRows = hotRows;
+    CompactScrollback();
+}
 
-        // If we pass up the height of the buffer, loop back to 0.
-        if (_firstRow >= GetSize().Height())
+// Routine Description:
+// - Packs every row in the cold scrollback tier, including the ones that got
+//   unpacked because someone (search, selection, the renderer, ...) looked at them.
+void TextBuffer::CompactScrollback()
+{
+    _lazilyUnpackedRows = 0;
+
+    const auto cursorRow = gsl::narrow_cast<size_t>(GetCursor().GetPosition().Y);
+    if (_hotRows == 0 || cursorRow <= _hotRows)
+    {
+        return;
+    }
+
+    const size_t totalRows = TotalRowCount();
+    for (size_t i = 0; i < cursorRow - _hotRows; ++i)
+    {
+        _storage.at((_firstRow + i) % totalRows).Pack();
+    }
+}
+
+// Routine Description:
+// - Estimates how much memory the rows of this buffer hold on to. See ROW::GetMemoryUsage().
+// Return Value:
+// - the estimated size of all rows in bytes
+size_t TextBuffer::GetMemoryUsage() const noexcept
+{
+    size_t usage = 0;
+    for (const auto& row : _storage)
+    {
+        usage += row.GetMemoryUsage();
+    }
+    return usage;
+}
+
+// Routine Description:
+// - Returns the marks of the rows of this buffer. See ScrollMarks.
+ScrollMarks& TextBuffer::GetScrollMarks() noexcept
+{
+    return _marks;
+}
+
+const ScrollMarks& TextBuffer::GetScrollMarks() const noexcept
+{
+    return _marks;
+}
+
+// Routine Description:
+// - Packs the rows that just crossed the cold scrollback threshold.
+// - Rows that were unpacked again since they went cold are repacked in bulk,
+//   once there are more of them than there are hot rows.
+// - Packing is only an optimization, so failures are merely logged.
+// Arguments:
+// - count - the number of rows that crossed the threshold, i.e. the number of rows the buffer scrolled by
+void TextBuffer::_PackColdRows(const size_t count) noexcept
+{
+    try
+    {
+        if (_hotRows == 0)
         {
-            _firstRow = 0;
+            return;
+        }
+
+        if (_lazilyUnpackedRows > _hotRows)
+        {
+            CompactScrollback();
+            return;
+        }
+
+        const auto cursorRow = gsl::narrow_cast<size_t>(GetCursor().GetPosition().Y);
+        if (cursorRow > _hotRows)
+        {
+            // The rows sitting at and right above the boundary of the cold tier.
+            const auto coldRows = std::min(count, cursorRow - _hotRows);
+            for (size_t i = 1; i <= coldRows; ++i)
+            {
+                _storage.at((_firstRow + cursorRow - _hotRows - i) % TotalRowCount()).Pack();
+            }
         }
     }
-    return fSuccess;
+    CATCH_LOG();
 }
 
 //Routine Description:
@@ -605,9 +1060,14 @@ COORD TextBuffer::GetLastNonSpaceCharacter(std::optional<const Microsoft::Consol
     // Search the given viewport by starting at the bottom.
     coordEndOfText.Y = viewport.BottomInclusive();
 
-    const auto& currRow = GetRowByOffset(coordEndOfText.Y);
+    // Rows that were never written to are blank. Retrieving them would allocate their cells for nothing.
+    const auto measureRight = [&](const SHORT y) {
+        const auto& row = _storage.at((_firstRow + y) % TotalRowCount());
+        return row.IsBlank() ? 0i16 : gsl::narrow<short>(GetRowByOffset(y).GetCharRow().MeasureRight());
+    };
+
     // The X position of the end of the valid text is the Right draw boundary (which is one beyond the final valid character)
-    coordEndOfText.X = gsl::narrow<short>(currRow.GetCharRow().MeasureRight()) - 1;
+    coordEndOfText.X = measureRight(coordEndOfText.Y) - 1;
 
     // If the X coordinate turns out to be -1, the row was empty, we need to search backwards for the real end of text.
     const auto viewportTop = viewport.Top();
@@ -615,10 +1075,9 @@ COORD TextBuffer::GetLastNonSpaceCharacter(std::optional<const Microsoft::Consol
     while (fDoBackUp)
     {
         coordEndOfText.Y--;
-        const auto& backupRow = GetRowByOffset(coordEndOfText.Y);
         // We need to back up to the previous row if this line is empty, AND there are more rows
 
-        coordEndOfText.X = gsl::narrow<short>(backupRow.GetCharRow().MeasureRight()) - 1;
+        coordEndOfText.X = measureRight(coordEndOfText.Y) - 1;
         fDoBackUp = (coordEndOfText.X < 0 && coordEndOfText.Y > viewportTop);
     }
 
@@ -681,6 +1140,21 @@ void TextBuffer::_SetFirstRowIndex(const SHORT FirstRowIndex) noexcept
     _firstRow = FirstRowIndex;
 }
 
+// Routine Description:
+// - Moves the given rows up or down within the buffer, for instance to scroll
+//   the rows within the scrolling margins. The rows that are displaced by them
+//   end up in the space they leave behind.
+// - This never copies any cells. Only the ROW objects are rotated around,
+//   which for each of them is a few pointer swaps: their cells, UnicodeStorage
+//   and attribute runs (and with them the hyperlink references) follow them.
+//   The rotation works on the circular buffer as it is, so it only touches
+//   the affected rows, no matter how large the scrollback is.
+// Arguments:
+// - firstRow - the offset of the first row to move
+// - size - the number of rows to move
+// - delta - how far to move them. Negative values move them up.
+// Return Value:
+// - <none>
 void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT delta)
 {
     // If we don't have to move anything, leave early.
@@ -689,97 +1163,106 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         return;
     }
 
-    // OK. We're about to play games by moving rows around within the deque to
-    // scroll a massive region in a faster way than copying things.
-    // To make this easier, first correct the circular buffer to have the first row be 0 again.
-    if (_firstRow != 0)
-    {
-        // Rotate the buffer to put the first row at the front.
-        std::rotate(_storage.begin(), _storage.begin() + _firstRow, _storage.end());
-
-        // The first row is now at the top.
-        _firstRow = 0;
-    }
-
-    // Rotate just the subsection specified
-    if (delta < 0)
-    {
-        // The layout is like this:
-        // delta is -2, size is 3, firstRow is 5
-        // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3 A. begin + firstRow + delta (because delta is negative)
-        // | 4
-        // | 5 B. begin + firstRow
-        // | 6
-        // | 7
-        // | 8 C. begin + firstRow + size
-        // | 9
-        // | 10
-        // | 11
-        // - end
-        // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
-        // So the final layout will be
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 5
-        // | 6
-        // | 7
-        // | 3
-        // | 4
-        // | 8
-        // | 9
-        // | 10
-        // | 11
-        // - end
-        std::rotate(_storage.begin() + firstRow + delta, _storage.begin() + firstRow, _storage.begin() + firstRow + size);
+    _marks.MoveRows(firstRow, size, delta);
+
+    // The rows in [first, last) are rotated, so that the one at middle ends up at first.
+    // For instance, if size is 3 and delta is -2, the rows [firstRow, firstRow + 3) end up at
+    // [firstRow - 2, firstRow + 1) and the 2 rows above them in the space below.
+    const size_t first = delta < 0 ? firstRow + delta : firstRow;
+    const size_t middle = delta < 0 ? firstRow : firstRow + size;
+    const size_t last = delta < 0 ? firstRow + size : firstRow + size + delta;
+
+    const size_t totalRows = TotalRowCount();
+    const auto storageIndex = [&](const size_t offset) noexcept {
+        return (_firstRow + offset) % totalRows;
+    };
+
+    if (storageIndex(first) + (last - first) <= totalRows)
+    {
+        // The rows are contiguous in _storage, which is the common case.
+        const auto begin = _storage.begin() + storageIndex(first);
+        std::rotate(begin, begin + (middle - first), begin + (last - first));
     }
     else
     {
-        // The layout is like this:
-        // delta is 2, size is 3, firstRow is 5
-        // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3
-        // | 4
-        // | 5 A. begin + firstRow
-        // | 6
-        // | 7
-        // | 8 B. begin + firstRow + size
-        // | 9
-        // | 10 C. begin + firstRow + size + delta
-        // | 11
-        // - end
-        // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
-        // So the final layout will be
-        // --- (storage) ----
-        // | 0 begin
-        // | 1
-        // | 2
-        // | 3
-        // | 4
-        // | 8
-        // | 9
-        // | 5
-        // | 6
-        // | 7
-        // | 10
-        // | 11
-        // - end
-        std::rotate(_storage.begin() + firstRow, _storage.begin() + firstRow + size, _storage.begin() + firstRow + size + delta);
-    }
-
-    // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
-    // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
-    _RefreshRowIDs(std::nullopt);
+        // The rows wrap around the end of _storage. A rotation is the same as
+        // reversing both parts and then the whole, which works on any indices.
+        const auto reverse = [&](size_t begin, size_t end) {
+            for (; begin + 1 < end; ++begin, --end)
+            {
+                std::swap(til::at(_storage, storageIndex(begin)), til::at(_storage, storageIndex(end - 1)));
+            }
+        };
+        reverse(first, middle);
+        reverse(middle, last);
+        reverse(first, last);
+    }
+
+    // Renumber the rows that were moved. Their IDs are their index within _storage.
+    for (auto offset = first; offset < last; ++offset)
+    {
+        const auto index = storageIndex(offset);
+        auto& row = til::at(_storage, index);
+        row.SetId(gsl::narrow_cast<SHORT>(index));
+        row.UpdateCharRowParent();
+    }
+
+    // The rows themselves didn't change, but their offsets did.
+    NextGeneration();
+}
+
+// Routine Description:
+// - Copies a rectangle of cells to another place in the buffer. Each row of the
+//   rectangle is copied as a whole, characters and attribute runs alike (see ROW::CopyCells).
+// - The source and the target may overlap.
+// Arguments:
+// - source - the rectangle to copy. It must be within the buffer.
+// - targetOrigin - the top left corner of the place to copy it to. The target must be within the buffer too.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::CopyRectangle(const Viewport& source, const COORD targetOrigin)
+{
+    const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
+    THROW_HR_IF(E_INVALIDARG, !GetSize().IsInBounds(source) || !GetSize().IsInBounds(target));
+
+    if (source.Origin() == targetOrigin)
+    {
+        return;
+    }
+
+    // If the rectangle moves down, we walk it from the bottom, so that no row
+    // of the source is overwritten before it has been copied.
+    const auto height = source.Height();
+    const auto bottomUp = targetOrigin.Y > source.Top();
+    for (SHORT i = 0; i < height; ++i)
+    {
+        const auto offset = bottomUp ? height - 1 - i : i;
+        const auto& sourceRow = GetRowByOffset(source.Top() + offset);
+        auto& targetRow = GetRowByOffset(targetOrigin.Y + offset);
+        targetRow.CopyCells(sourceRow, source.Left(), source.RightExclusive(), targetOrigin.X);
+    }
+
+    _NotifyPaint(target);
+}
+
+// Routine Description:
+// - Fills a rectangle of the buffer with a single character, one row span at a time.
+// Arguments:
+// - rect - the rectangle to fill. It must be within the buffer.
+// - fillChar - the character to fill it with. It must be a single cell wide.
+// - fillAttrs - the attributes to fill it with, or nullopt to keep the existing ones.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::FillRectangle(const Viewport& rect, const wchar_t fillChar, const std::optional<TextAttribute> fillAttrs)
+{
+    THROW_HR_IF(E_INVALIDARG, !GetSize().IsInBounds(rect));
+
+    for (auto y = rect.Top(); y < rect.BottomExclusive(); ++y)
+    {
+        GetRowByOffset(y).FillCells(rect.Left(), rect.RightExclusive(), fillChar, fillAttrs);
+    }
+
+    _NotifyPaint(rect);
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -799,6 +1282,19 @@ const Cursor& TextBuffer::GetCursor() const noexcept
 
 void TextBuffer::SetCurrentAttributes(const TextAttribute& currentAttributes) noexcept
 {
+    // The hyperlink of the current attributes must not be released while it's
+    // open, even if none of its cells are left in the buffer (e.g. after an erase).
+    const auto newId = currentAttributes.GetHyperlinkId();
+    const auto oldId = _currentAttributes.GetHyperlinkId();
+    if (newId != oldId)
+    {
+        try
+        {
+            _hyperlinks.Acquire(newId, 1);
+        }
+        CATCH_LOG();
+        _hyperlinks.Release(oldId, 1);
+    }
     _currentAttributes = currentAttributes;
 }
 
@@ -877,14 +1373,93 @@ COORD TextBuffer::BufferToScreenPosition(const COORD position) const
 // Routine Description:
 // - Resets the text contents of this buffer with the default character
 //   and the default current color attributes
+// - Like ClearRowsBelow() the rows are only reset once they're retrieved.
 void TextBuffer::Reset()
 {
-    const auto attr = GetCurrentAttributes();
+    _ClearRowsLazily(0, GetCurrentAttributes());
+    _marks.Clear();
+}
 
-    for (auto& row : _storage)
+// Routine Description:
+// - Clears the rows from the given one down to the bottom of the buffer, along with their marks.
+//   This is how the scrollback is erased (ED 3), after the viewport was moved to the top of the buffer.
+// - Resetting every row of a long scrollback takes a noticeable amount of time, so the cleared rows
+//   merely fall behind the clear epoch of the buffer instead and are reset once they're retrieved
+//   (see _PrepareRow and _GetPreparedCopy). The time this takes only depends on the number of rows that are kept.
+// - Rows keep referring to their hyperlinks until they're reset.
+// Arguments:
+// - firstRow - the first row to clear
+// - fillAttributes - the attributes to fill the cleared rows with
+void TextBuffer::ClearRowsBelow(const size_t firstRow, const TextAttribute fillAttributes)
+{
+    const size_t totalRows = TotalRowCount();
+    THROW_HR_IF(E_INVALIDARG, firstRow > totalRows);
+
+    _ClearRowsLazily(firstRow, fillAttributes);
+    _marks.Erase(firstRow, totalRows);
+
+    if (firstRow < totalRows)
+    {
+        const auto width = GetSize().Width();
+        _NotifyPaint(Viewport::FromDimensions({ 0, gsl::narrow<SHORT>(firstRow) }, { width, gsl::narrow<SHORT>(totalRows - firstRow) }));
+    }
+}
+
+// Routine Description:
+// - Advances the clear epoch, which clears all rows from the given one down, and keeps the ones above it.
+// Arguments:
+// - firstRow - the first row to clear
+// - fillAttributes - the attributes the cleared rows are reset to
+void TextBuffer::_ClearRowsLazily(const size_t firstRow, const TextAttribute fillAttributes)
+{
+    const size_t totalRows = TotalRowCount();
+    for (size_t i = 0; i < firstRow; ++i)
     {
-        row.Reset(attr);
+        // The rows we keep might still be waiting for an earlier clear, which
+        // needs to be applied with its own attributes before we move on.
+        auto& row = _storage.at((_firstRow + i) % totalRows);
+        _ApplyPendingClear(row);
+        row.SetClearEpoch(_clearEpoch + 1);
     }
+
+    ++_clearEpoch;
+    _clearAttributes = fillAttributes;
+
+    // The rows we cleared don't know yet, so this is what tells caches to look at them again.
+    _clearGeneration = NextGeneration();
+}
+
+// Routine Description:
+// - Puts the buffer into the state of one that was just constructed with the
+//   given arguments, but keeps its rows and their memory. For a buffer that's
+//   used over and over at the same size, like the alternate screen buffer,
+//   this turns the allocation of a new one into clearing its rows.
+// - The rows keep counting their revisions up, so that caches keyed by the
+//   address of the buffer don't mistake the new contents for the old ones.
+// Arguments:
+// - defaultAttributes - the attributes to fill the buffer with
+// - cursorSize - the size of the cursor
+// - renderTarget - the render target that's notified of changes from now on
+// Return Value:
+// - <none>
+void TextBuffer::Recycle(const TextAttribute defaultAttributes,
+                         const UINT cursorSize,
+                         Microsoft::Console::Render::IRenderTarget& renderTarget)
+{
+    _renderTarget = &renderTarget;
+    SetCurrentAttributes(defaultAttributes);
+    Reset();
+
+    // All rows are blank now, so it doesn't matter which one comes first.
+    _SetFirstRowIndex(0);
+    _RefreshRowIDs(std::nullopt);
+
+    _cursor.Reset(cursorSize);
+    _hotRows = 0;
+    _lazilyUnpackedRows = 0;
+    ClearPatternRecognizers();
+    _delimiterClassCache.clear();
+    _delimiterClassesFor.clear();
 }
 
 // Routine Description:
@@ -918,8 +1493,15 @@ void TextBuffer::Reset()
 
         _SetFirstRowIndex(0);
 
+        // The rows above TopRow are gone, just as if they scrolled out.
+        _marks.Circle(TopRow);
+
         // realloc in the Y direction
         // remove rows if we're shrinking
+        if (_storage.size() > static_cast<size_t>(newSize.Y))
+        {
+            _marks.Erase(newSize.Y, _storage.size());
+        }
         while (_storage.size() > static_cast<size_t>(newSize.Y))
         {
             _storage.pop_back();
@@ -927,30 +1509,19 @@ void TextBuffer::Reset()
         // add rows if we're growing
         while (_storage.size() < static_cast<size_t>(newSize.Y))
         {
-            _storage.emplace_back(static_cast<short>(_storage.size()), newSize.X, attributes, this);
+            _storage.emplace_back(static_cast<short>(_storage.size()), newSize.X, attributes, this, &_rowPool).SetClearEpoch(_clearEpoch);
         }
 
         // Now that we've tampered with the row placement, refresh all the row IDs.
-        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
+        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension.
         _RefreshRowIDs(newSize.X);
 
         // Update the cached size value
         _UpdateSize();
     }
-    CATCH_RETURN();
-
-    return S_OK;
-}
-
-const UnicodeStorage& TextBuffer::GetUnicodeStorage() const noexcept
-{
-    return _unicodeStorage;
-}
+    CATCH_RETURN();
 
-UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
-{
-    return _unicodeStorage;
+    return S_OK;
 }
 
 // Routine Description:
@@ -958,24 +1529,21 @@ UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
 //   by shuffling pointers around.
 // - This will also update parent pointers that are stored in depth within the buffer
 //   (e.g. it will update CharRow parents pointing at Rows that might have been moved around)
-// - Optionally takes a new row width if we're resizing to perform a resize operation and cleanup
-//   any high unicode (UnicodeStorage) runs while we're already looping through the rows.
+// - Optionally takes a new row width if we're resizing to perform a resize operation
+//   while we're already looping through the rows. Each row drops the high unicode
+//   (UnicodeStorage) runs that fall outside of the new width by itself.
 // Arguments:
 // - newRowWidth - Optional new value for the row width.
 void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
 {
-    std::unordered_map<SHORT, SHORT> rowMap;
     SHORT i = 0;
     for (auto& it : _storage)
     {
-        // Build a map so we can update Unicode Storage
-        rowMap.emplace(it.GetId(), i);
-
         // Update the IDs
         it.SetId(i++);
 
         // Also update the char row parent pointers as they can get shuffled up in the rotates.
-        it.GetCharRow().UpdateParent(&it);
+        it.UpdateCharRowParent();
 
         // Resize the rows in the X dimension if we have a new width
         if (newRowWidth.has_value())
@@ -984,14 +1552,11 @@ void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
             THROW_IF_FAILED(it.Resize(newRowWidth.value()));
         }
     }
-
-    // Give the new mapping to Unicode Storage
-    _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
 {
-    _renderTarget.TriggerRedraw(viewport);
+    _renderTarget->TriggerRedraw(viewport);
 }
 
 // Routine Description:
@@ -1023,7 +1588,7 @@ ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
     }
 
     THROW_HR_IF(E_FAIL, Row.GetId() == _firstRow);
-    return _storage.at(prevRowIndex);
+    return _GetRowAt(prevRowIndex);
 }
 
 // Method Description:
@@ -1034,7 +1599,7 @@ ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
 // - This buffer's current render target.
 Microsoft::Console::Render::IRenderTarget& TextBuffer::GetRenderTarget() noexcept
 {
-    return _renderTarget;
+    return *_renderTarget;
 }
 
 // Method Description:
@@ -1047,7 +1612,49 @@ Microsoft::Console::Render::IRenderTarget& TextBuffer::GetRenderTarget() noexcep
 // - the delimiter class for the given char
 const DelimiterClass TextBuffer::_GetDelimiterClassAt(const COORD pos, const std::wstring_view wordDelimiters) const
 {
-    return GetRowByOffset(pos.Y).GetCharRow().DelimiterClassAt(pos.X, wordDelimiters);
+    return til::at(GetDelimiterClasses(pos.Y, wordDelimiters), pos.X);
+}
+
+// Method Description:
+// - Get the delimiter class of every cell of a row
+// - Word navigation (selection, uia) steps through rows cell by cell. The
+//   classes of a row are computed once and cached until the row changes,
+//   so that each of those steps is a lookup, instead of a search through
+//   wordDelimiters.
+// Arguments:
+// - row: the row of the buffer
+// - wordDelimiters: the delimiters defined as a part of the DelimiterClass::DelimiterChar
+// Return Value:
+// - the delimiter class of every cell of the row, valid until the next call
+const std::vector<DelimiterClass>& TextBuffer::GetDelimiterClasses(const size_t row, const std::wstring_view wordDelimiters) const
+{
+    if (wordDelimiters != _delimiterClassesFor)
+    {
+        _delimiterClassCache.clear();
+        _delimiterClassesFor = wordDelimiters;
+    }
+
+    const auto storageIndex = (_firstRow + row) % TotalRowCount();
+    if (_delimiterClassCache.size() >= DelimiterClassCacheRows && !_delimiterClassCache.count(storageIndex))
+    {
+        _delimiterClassCache.clear();
+    }
+
+    // Revisions are unique within a buffer, so rows that were moved around
+    // (see ScrollRows) never match an entry that was made for another row.
+    const auto& bufferRow = _GetRowAt(storageIndex);
+    auto& entry = _delimiterClassCache[storageIndex];
+    if (entry.revision != bufferRow.GetRevision() || entry.classes.size() != bufferRow.size())
+    {
+        const auto& charRow = bufferRow.GetCharRow();
+        entry.classes.resize(bufferRow.size());
+        for (size_t x = 0; x < entry.classes.size(); ++x)
+        {
+            til::at(entry.classes, x) = charRow.DelimiterClassAt(x, wordDelimiters);
+        }
+        entry.revision = bufferRow.GetRevision();
+    }
+    return entry.classes;
 }
 
 // Method Description:
@@ -1161,18 +1768,13 @@ const COORD TextBuffer::_GetWordStartForSelection(const COORD target, const std:
     COORD result = target;
     const auto bufferSize = GetSize();
 
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto& classes = GetDelimiterClasses(result.Y, wordDelimiters);
+    const auto initialDelimiter = til::at(classes, result.X);
 
     // expand left until we hit the left boundary or a different delimiter class
-    while (result.X > bufferSize.Left() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.DecrementInBounds(result);
-    }
-
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
+    while (result.X > bufferSize.Left() && til::at(classes, result.X - 1) == initialDelimiter)
     {
-        // move off of delimiter
-        bufferSize.IncrementInBounds(result);
+        --result.X;
     }
 
     return result;
@@ -1288,69 +1890,18 @@ const COORD TextBuffer::_GetWordEndForSelection(const COORD target, const std::w
     }
 
     COORD result = target;
-    const auto initialDelimiter = _GetDelimiterClassAt(result, wordDelimiters);
+    const auto& classes = GetDelimiterClasses(result.Y, wordDelimiters);
+    const auto initialDelimiter = til::at(classes, result.X);
 
     // expand right until we hit the right boundary or a different delimiter class
-    while (result.X < bufferSize.RightInclusive() && (_GetDelimiterClassAt(result, wordDelimiters) == initialDelimiter))
-    {
-        bufferSize.IncrementInBounds(result);
-    }
-
-    if (_GetDelimiterClassAt(result, wordDelimiters) != initialDelimiter)
+    while (result.X < bufferSize.RightInclusive() && til::at(classes, result.X + 1) == initialDelimiter)
     {
-        // move off of delimiter
-        bufferSize.DecrementInBounds(result);
+        ++result.X;
     }
 
     return result;
 }
 
-void TextBuffer::_PruneHyperlinks()
-{
-    // Check the old first row for hyperlink references
-    // If there are any, search the entire buffer for the same reference
-    // If the buffer does not contain the same reference, we can remove that hyperlink from our map
-    // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
-    // Get all the hyperlink references in the row we're erasing
-    const auto hyperlinks = _storage.at(_firstRow).GetAttrRow().GetHyperlinks();
-
-    if (!hyperlinks.empty())
-    {
-        // Move to unordered set so we can use hashed lookup of IDs instead of linear search.
-        // Only make it an unordered set now because set always heap allocates but vector
-        // doesn't when the set is empty (saving an allocation in the common case of no links.)
-        std::unordered_set<uint16_t> firstRowRefs{ hyperlinks.cbegin(), hyperlinks.cend() };
-
-        const auto total = TotalRowCount();
-        // Loop through all the rows in the buffer except the first row -
-        // we have found all hyperlink references in the first row and put them in refs,
-        // now we need to search the rest of the buffer (i.e. all the rows except the first)
-        // to see if those references are anywhere else
-        for (size_t i = 1; i != total; ++i)
-        {
-            const auto nextRowRefs = GetRowByOffset(i).GetAttrRow().GetHyperlinks();
-            for (auto id : nextRowRefs)
-            {
-                if (firstRowRefs.find(id) != firstRowRefs.end())
-                {
-                    firstRowRefs.erase(id);
-                }
-            }
-            if (firstRowRefs.empty())
-            {
-                // No more hyperlink references left to search for, terminate early
-                break;
-            }
-        }
-
-        // Now delete obsolete references from our map
-        for (auto hyperlinkReference : firstRowRefs)
-        {
-            RemoveHyperlinkFromMap(hyperlinkReference);
-        }
-    }
-}
-
 // Method Description:
 // - Update pos to be the position of the first character of the next word. This is used for accessibility
 // Arguments:
@@ -1555,6 +2106,16 @@ bool TextBuffer::MoveToPreviousGlyph(til::point& pos, std::optional<til::point>
 const std::vector<SMALL_RECT> TextBuffer::GetTextRects(COORD start, COORD end, bool blockSelection, bool bufferCoordinates) const
 {
     std::vector<SMALL_RECT> textRects;
+    GetTextRects(start, end, blockSelection, bufferCoordinates, textRects);
+    return textRects;
+}
+
+// Method Description:
+// - Same as above, but replaces the contents of the given vector with the
+//   rectangles, so that callers can reuse its memory from call to call.
+void TextBuffer::GetTextRects(COORD start, COORD end, bool blockSelection, bool bufferCoordinates, std::vector<SMALL_RECT>& textRects) const
+{
+    textRects.clear();
 
     const auto bufferSize = GetSize();
 
@@ -1596,8 +2157,6 @@ const std::vector<SMALL_RECT> TextBuffer::GetTextRects(COORD start, COORD end, b
         _ExpandTextRow(textRow);
         textRects.emplace_back(textRow);
     }
-
-    return textRects;
 }
 
 // Method Description:
@@ -1666,8 +2225,7 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
     data.text.reserve(rows);
     if (copyTextColor)
     {
-        data.FgAttr.reserve(rows);
-        data.BkAttr.reserve(rows);
+        data.colors.reserve(rows);
     }
 
     // for each row in the selection
@@ -1677,46 +2235,44 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
 
         const Viewport highlight = Viewport::FromInclusive(selectionRects.at(i));
 
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
+        const auto& charRow = GetRowByOffset(iRow).GetCharRow();
 
         // allocate a string buffer
         std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
+        std::vector<ColorRun> selectionColors;
 
         // preallocate to avoid reallocs
         selectionText.reserve(gsl::narrow<size_t>(highlight.Width()) + 2); // + 2 for \r\n if we munged it
-        if (copyTextColor)
-        {
-            selectionFgAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-            selectionBkAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-        }
 
-        // copy char data into the string buffer, skipping trailing bytes
-        while (it)
+        // copy char data into the string buffer one attribute run at a time, skipping trailing bytes
+        for (auto run = GetAttributeRunsAt(highlight.Origin(), highlight); run; ++run)
         {
-            const auto& cell = *it;
-
-            if (!cell.DbcsAttr().IsTrailing())
+            const auto runStart = selectionText.size();
+            for (auto column = run->begin; column < run->end; ++column)
             {
-                const auto chars = cell.Chars();
-                selectionText.append(chars);
-
-                if (copyTextColor)
+                if (!til::at(run->cells, column - run->begin).DbcsAttr().IsTrailing())
                 {
-                    const auto cellData = cell.TextAttr();
-                    const auto [CellFgAttr, CellBkAttr] = GetAttributeColors(cellData);
-                    for (size_t j = 0; j < chars.size(); ++j)
+                    for (const auto wch : charRow.GlyphAt(column))
                     {
-                        selectionFgAttr.push_back(CellFgAttr);
-                        selectionBkAttr.push_back(CellBkAttr);
+                        selectionText.push_back(wch);
                     }
                 }
             }
-#pragma warning(suppress : 26444)
-            // TODO GH 2675: figure out why there's custom construction/destruction happening here
-            it++;
+
+            const auto length = selectionText.size() - runStart;
+            if (copyTextColor && length != 0)
+            {
+                // Different attributes may still map to the same colors.
+                const auto [CellFgAttr, CellBkAttr] = GetAttributeColors(run->attr);
+                if (!selectionColors.empty() && selectionColors.back().fg == CellFgAttr && selectionColors.back().bk == CellBkAttr)
+                {
+                    selectionColors.back().length += length;
+                }
+                else
+                {
+                    selectionColors.push_back({ length, CellFgAttr, CellBkAttr });
+                }
+            }
         }
 
         // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
@@ -1730,10 +2286,9 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
                 while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
                 {
                     selectionText.pop_back();
-                    if (copyTextColor)
+                    if (copyTextColor && --selectionColors.back().length == 0)
                     {
-                        selectionFgAttr.pop_back();
-                        selectionBkAttr.pop_back();
+                        selectionColors.pop_back();
                     }
                 }
             }
@@ -1753,10 +2308,7 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
                 {
                     // can't see CR/LF so just use black FG & BK
                     COLORREF const Blackness = RGB(0x00, 0x00, 0x00);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
+                    selectionColors.push_back({ 2, Blackness, Blackness });
                 }
             }
         }
@@ -1764,8 +2316,8 @@ const TextBuffer::TextAndColor TextBuffer::GetText(const bool includeCRLF,
         data.text.emplace_back(std::move(selectionText));
         if (copyTextColor)
         {
-            data.FgAttr.emplace_back(std::move(selectionFgAttr));
-            data.BkAttr.emplace_back(std::move(selectionBkAttr));
+            selectionColors.shrink_to_fit();
+            data.colors.emplace_back(std::move(selectionColors));
         }
     }
 
@@ -1788,157 +2340,145 @@ std::string TextBuffer::GenHTML(const TextAndColor& rows,
 {
     try
     {
-        std::ostringstream htmlBuilder;
+        // once filled with values, there will be exactly 157 bytes in the clipboard header
+        constexpr size_t ClipboardHeaderSize = 157;
+
+        // We reserve room for the clipboard header up front and fill it in once we know
+        // the offsets of the fragment, instead of concatenating two strings at the end.
+        // The size estimate assumes mostly ASCII text and a generously sized <SPAN> per run.
+        std::string htmlBuilder(ClipboardHeaderSize, '\0');
+        size_t textLength = 0;
+        size_t runCount = 0;
+        for (size_t row = 0; row < rows.text.size(); row++)
+        {
+            textLength += rows.text.at(row).size() + 4;
+            runCount += rows.colors.at(row).size();
+        }
+        htmlBuilder.reserve(ClipboardHeaderSize + 256 + textLength + runCount * 96);
 
         // First we have to add some standard
         // HTML boiler plate required for CF_HTML
         // as part of the HTML Clipboard format
-        const std::string htmlHeader =
-            "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
-        htmlBuilder << htmlHeader;
+        constexpr std::string_view htmlHeader = "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
+        htmlBuilder += htmlHeader;
 
-        htmlBuilder << "<!--StartFragment -->";
+        htmlBuilder += "<!--StartFragment -->";
 
         // apply global style in div element
         {
-            htmlBuilder << "<DIV STYLE=\"";
-            htmlBuilder << "display:inline-block;";
-            htmlBuilder << "white-space:pre;";
-
-            htmlBuilder << "background-color:";
-            htmlBuilder << Utils::ColorToHexString(backgroundColor);
-            htmlBuilder << ";";
-
-            htmlBuilder << "font-family:";
-            htmlBuilder << "'";
-            htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
-            htmlBuilder << "',";
+            htmlBuilder += "<DIV STYLE=\"";
+            htmlBuilder += "display:inline-block;";
+            htmlBuilder += "white-space:pre;";
+
+            htmlBuilder += "background-color:";
+            htmlBuilder += Utils::ColorToHexString(backgroundColor);
+            htmlBuilder += ";";
+
+            htmlBuilder += "font-family:";
+            htmlBuilder += "'";
+            htmlBuilder += ConvertToA(CP_UTF8, fontFaceName);
+            htmlBuilder += "',";
             // even with different font, add monospace as fallback
-            htmlBuilder << "monospace;";
+            htmlBuilder += "monospace;";
 
-            htmlBuilder << "font-size:";
-            htmlBuilder << fontHeightPoints;
-            htmlBuilder << "pt;";
+            htmlBuilder += "font-size:";
+            htmlBuilder += std::to_string(fontHeightPoints);
+            htmlBuilder += "pt;";
 
             // note: MS Word doesn't support padding (in this way at least)
-            htmlBuilder << "padding:";
-            htmlBuilder << 4; // todo: customizable padding
-            htmlBuilder << "px;";
+            htmlBuilder += "padding:";
+            htmlBuilder += "4"; // todo: customizable padding
+            htmlBuilder += "px;";
 
-            htmlBuilder << "\">";
+            htmlBuilder += "\">";
         }
 
-        // copy text and info color from buffer
+        // copy text and info color from buffer, one run of identically colored text at a time
         bool hasWrittenAnyText = false;
         std::optional<COLORREF> fgColor = std::nullopt;
         std::optional<COLORREF> bkColor = std::nullopt;
         for (size_t row = 0; row < rows.text.size(); row++)
         {
-            size_t startOffset = 0;
-
             if (row != 0)
             {
-                htmlBuilder << "<BR>";
+                htmlBuilder += "<BR>";
             }
 
-            for (size_t col = 0; col < rows.text.at(row).length(); col++)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '<':
-                                htmlBuilder << "&lt;";
-                                break;
-                            case '>':
-                                htmlBuilder << "&gt;";
-                                break;
-                            case '&':
-                                htmlBuilder << "&amp;";
-                                break;
-                            default:
-                                htmlBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
-                    }
-                };
+            // do not include \r nor \n as they don't have color attributes
+            // and are not HTML friendly. For line break use '<BR>' instead.
+            const std::wstring_view rowText{ rows.text.at(row) };
+            const auto textEnd = std::min(rowText.find_first_of(L"\r\n"), rowText.size());
 
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
+            size_t offset = 0;
+            for (const auto& run : rows.colors.at(row))
+            {
+                if (offset >= textEnd)
                 {
-                    // do not include \r nor \n as they don't have color attributes
-                    // and are not HTML friendly. For line break use '<BR>' instead.
-                    writeAccumulatedChars(false);
                     break;
                 }
 
-                bool colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
-                {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
+                if (!fgColor.has_value() || run.fg != fgColor.value() || !bkColor.has_value() || run.bk != bkColor.value())
                 {
-                    writeAccumulatedChars(false);
+                    fgColor = run.fg;
+                    bkColor = run.bk;
 
                     if (hasWrittenAnyText)
                     {
-                        htmlBuilder << "</SPAN>";
+                        htmlBuilder += "</SPAN>";
                     }
 
-                    htmlBuilder << "<SPAN STYLE=\"";
-                    htmlBuilder << "color:";
-                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "background-color:";
-                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "\">";
+                    htmlBuilder += "<SPAN STYLE=\"";
+                    htmlBuilder += "color:";
+                    htmlBuilder += Utils::ColorToHexString(fgColor.value());
+                    htmlBuilder += ";";
+                    htmlBuilder += "background-color:";
+                    htmlBuilder += Utils::ColorToHexString(bkColor.value());
+                    htmlBuilder += ";";
+                    htmlBuilder += "\">";
                 }
 
                 hasWrittenAnyText = true;
 
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
+                const auto unescapedText = ConvertToA(CP_UTF8, rowText.substr(offset, std::min(run.length, textEnd - offset)));
+                for (const auto c : unescapedText)
                 {
-                    writeAccumulatedChars(true);
+                    switch (c)
+                    {
+                    case '<':
+                        htmlBuilder += "&lt;";
+                        break;
+                    case '>':
+                        htmlBuilder += "&gt;";
+                        break;
+                    case '&':
+                        htmlBuilder += "&amp;";
+                        break;
+                    default:
+                        htmlBuilder += c;
+                    }
                 }
+
+                offset += run.length;
             }
         }
 
         if (hasWrittenAnyText)
         {
             // last opened span wasn't closed in loop above, so close it now
-            htmlBuilder << "</SPAN>";
+            htmlBuilder += "</SPAN>";
         }
 
-        htmlBuilder << "</DIV>";
+        htmlBuilder += "</DIV>";
 
-        htmlBuilder << "<!--EndFragment -->";
+        htmlBuilder += "<!--EndFragment -->";
 
         constexpr std::string_view HtmlFooter = "</BODY></HTML>";
-        htmlBuilder << HtmlFooter;
-
-        // once filled with values, there will be exactly 157 bytes in the clipboard header
-        constexpr size_t ClipboardHeaderSize = 157;
+        htmlBuilder += HtmlFooter;
 
         // these values are byte offsets from start of clipboard
         const size_t htmlStartPos = ClipboardHeaderSize;
-        const size_t htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
-        const size_t fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
+        const size_t htmlEndPos = htmlBuilder.size();
+        const size_t fragStartPos = ClipboardHeaderSize + htmlHeader.length();
         const size_t fragEndPos = htmlEndPos - HtmlFooter.length();
 
         // header required by HTML 0.9 format
@@ -1952,7 +2492,11 @@ std::string TextBuffer::GenHTML(const TextAndColor& rows,
         clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
         clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
 
-        return clipHeaderBuilder.str() + htmlBuilder.str();
+        const auto clipHeader = clipHeaderBuilder.str();
+        THROW_HR_IF(E_UNEXPECTED, clipHeader.size() != ClipboardHeaderSize);
+        htmlBuilder.replace(0, ClipboardHeaderSize, clipHeader);
+
+        return htmlBuilder;
     }
     catch (...)
     {
@@ -1976,156 +2520,142 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
 {
     try
     {
-        std::ostringstream rtfBuilder;
-
-        // start rtf
-        rtfBuilder << "{";
-
-        // Standard RTF header.
-        // This is similar to the header generated by WordPad.
-        // \ansi - specifies that the ANSI char set is used in the current doc
-        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
-        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
-        // \nouicompat - ?
-        rtfBuilder << "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
-
-        // font table
-        rtfBuilder << "{\\fonttbl{\\f0\\fmodern\\fcharset0 " << ConvertToA(CP_UTF8, fontFaceName) << ";}}";
-
         // map to keep track of colors:
         // keys are colors represented by COLORREF
         // values are indices of the corresponding colors in the color table
         std::unordered_map<COLORREF, int> colorMap;
         int nextColorIndex = 1; // leave 0 for the default color and start from 1.
 
+        const auto appendColor = [](std::string& builder, const COLORREF color) {
+            builder += "\\red";
+            builder += std::to_string(static_cast<int>(GetRValue(color)));
+            builder += "\\green";
+            builder += std::to_string(static_cast<int>(GetGValue(color)));
+            builder += "\\blue";
+            builder += std::to_string(static_cast<int>(GetBValue(color)));
+            builder += ";";
+        };
+
         // RTF color table
-        std::ostringstream colorTableBuilder;
-        colorTableBuilder << "{\\colortbl ;";
-        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(backgroundColor))
-                          << "\\green" << static_cast<int>(GetGValue(backgroundColor))
-                          << "\\blue" << static_cast<int>(GetBValue(backgroundColor))
-                          << ";";
+        std::string colorTableBuilder;
+        colorTableBuilder += "{\\colortbl ;";
+        appendColor(colorTableBuilder, backgroundColor);
         colorMap[backgroundColor] = nextColorIndex++;
 
         // content
-        std::ostringstream contentBuilder;
-        contentBuilder << "\\viewkind4\\uc4";
+        // The size estimate assumes mostly ASCII text and a color change per run.
+        std::string contentBuilder;
+        {
+            size_t textLength = 0;
+            size_t runCount = 0;
+            for (size_t row = 0; row < rows.text.size(); ++row)
+            {
+                textLength += rows.text.at(row).size() + 6;
+                runCount += rows.colors.at(row).size();
+            }
+            contentBuilder.reserve(128 + textLength + runCount * 24);
+        }
+        contentBuilder += "\\viewkind4\\uc4";
 
         // paragraph styles
         // \fs specifies font size in half-points i.e. \fs20 results in a font size
         // of 10 pts. That's why, font size is multiplied by 2 here.
-        contentBuilder << "\\pard\\slmult1\\f0\\fs" << std::to_string(2 * fontHeightPoints)
-                       << "\\highlight1"
-                       << " ";
+        contentBuilder += "\\pard\\slmult1\\f0\\fs";
+        contentBuilder += std::to_string(2 * fontHeightPoints);
+        contentBuilder += "\\highlight1";
+        contentBuilder += " ";
+
+        // Returns the index of the given color in the color table, adding it if necessary.
+        const auto getColorIndex = [&](const COLORREF color) {
+            if (const auto it = colorMap.find(color); it != colorMap.end())
+            {
+                // color already exists in the map, just retrieve the index
+                return it->second;
+            }
+
+            // color not present in the map, so add it
+            appendColor(colorTableBuilder, color);
+            colorMap[color] = nextColorIndex;
+            return nextColorIndex++;
+        };
 
+        // copy text and info color from buffer, one run of identically colored text at a time
         std::optional<COLORREF> fgColor = std::nullopt;
         std::optional<COLORREF> bkColor = std::nullopt;
         for (size_t row = 0; row < rows.text.size(); ++row)
         {
-            size_t startOffset = 0;
-
             if (row != 0)
             {
-                contentBuilder << "\\line "; // new line
+                contentBuilder += "\\line "; // new line
             }
 
-            for (size_t col = 0; col < rows.text.at(row).length(); ++col)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto text = std::wstring_view{ rows.text.at(row) }.substr(startOffset, col - startOffset + includeCurrent);
-                        _AppendRTFText(contentBuilder, text);
-
-                        startOffset = col;
-                    }
-                };
+            // do not include \r nor \n as they don't have color attributes.
+            // For line break use \line instead.
+            const std::wstring_view rowText{ rows.text.at(row) };
+            const auto textEnd = std::min(rowText.find_first_of(L"\r\n"), rowText.size());
 
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
+            size_t offset = 0;
+            for (const auto& run : rows.colors.at(row))
+            {
+                if (offset >= textEnd)
                 {
-                    // do not include \r nor \n as they don't have color attributes.
-                    // For line break use \line instead.
-                    writeAccumulatedChars(false);
                     break;
                 }
 
-                bool colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
+                if (!fgColor.has_value() || run.fg != fgColor.value() || !bkColor.has_value() || run.bk != bkColor.value())
                 {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
-
-                    int bkColorIndex = 0;
-                    if (colorMap.find(bkColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        bkColorIndex = colorMap[bkColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(bkColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(bkColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(bkColor.value()))
-                                          << ";";
-                        colorMap[bkColor.value()] = nextColorIndex;
-                        bkColorIndex = nextColorIndex++;
-                    }
+                    fgColor = run.fg;
+                    bkColor = run.bk;
 
-                    int fgColorIndex = 0;
-                    if (colorMap.find(fgColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        fgColorIndex = colorMap[fgColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(fgColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(fgColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(fgColor.value()))
-                                          << ";";
-                        colorMap[fgColor.value()] = nextColorIndex;
-                        fgColorIndex = nextColorIndex++;
-                    }
+                    const auto bkColorIndex = getColorIndex(bkColor.value());
+                    const auto fgColorIndex = getColorIndex(fgColor.value());
 
-                    contentBuilder << "\\highlight" << bkColorIndex
-                                   << "\\cf" << fgColorIndex
-                                   << " ";
+                    contentBuilder += "\\highlight";
+                    contentBuilder += std::to_string(bkColorIndex);
+                    contentBuilder += "\\cf";
+                    contentBuilder += std::to_string(fgColorIndex);
+                    contentBuilder += " ";
                 }
 
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
-                }
+                _AppendRTFText(contentBuilder, rowText.substr(offset, std::min(run.length, textEnd - offset)));
+
+                offset += run.length;
             }
         }
 
         // end colortbl
-        colorTableBuilder << "}";
+        colorTableBuilder += "}";
+
+        // Standard RTF header.
+        // This is similar to the header generated by WordPad.
+        // \ansi - specifies that the ANSI char set is used in the current doc
+        // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
+        // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
+        // \nouicompat - ?
+        constexpr std::string_view rtfHeader = "{\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
+
+        // font table
+        std::string fontTable = "{\\fonttbl{\\f0\\fmodern\\fcharset0 ";
+        fontTable += ConvertToA(CP_UTF8, fontFaceName);
+        fontTable += ";}}";
+
+        std::string rtfBuilder;
+        rtfBuilder.reserve(rtfHeader.size() + fontTable.size() + colorTableBuilder.size() + contentBuilder.size() + 1);
+
+        // start rtf
+        rtfBuilder += rtfHeader;
+        rtfBuilder += fontTable;
 
         // add color table to the final RTF
-        rtfBuilder << colorTableBuilder.str();
+        rtfBuilder += colorTableBuilder;
 
         // add the text content to the final RTF
-        rtfBuilder << contentBuilder.str();
+        rtfBuilder += contentBuilder;
 
         // end rtf
-        rtfBuilder << "}";
+        rtfBuilder += "}";
 
-        return rtfBuilder.str();
+        return rtfBuilder;
     }
     catch (...)
     {
@@ -2134,7 +2664,7 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
     }
 }
 
-void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text)
+void TextBuffer::_AppendRTFText(std::string& contentBuilder, const std::wstring_view& text)
 {
     for (const auto codeUnit : text)
     {
@@ -2145,16 +2675,19 @@ void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::w
             case L'\\':
             case L'{':
             case L'}':
-                contentBuilder << "\\" << gsl::narrow<char>(codeUnit);
+                contentBuilder += "\\";
+                contentBuilder += gsl::narrow<char>(codeUnit);
                 break;
             default:
-                contentBuilder << gsl::narrow<char>(codeUnit);
+                contentBuilder += gsl::narrow<char>(codeUnit);
             }
         }
         else
         {
             // Windows uses unsigned wchar_t - RTF uses signed ones.
-            contentBuilder << "\\u" << std::to_string(til::bit_cast<int16_t>(codeUnit)) << "?";
+            contentBuilder += "\\u";
+            contentBuilder += std::to_string(til::bit_cast<int16_t>(codeUnit));
+            contentBuilder += "?";
         }
     }
 }
@@ -2173,12 +2706,18 @@ void TextBuffer::_AppendRTFText(std::ostringstream& contentBuilder, const std::w
 // - positionInfo - Optional. The caller can provide a pair of rows in this
 //   parameter and we'll calculate the position of the _end_ of those rows in
 //   the new buffer. The rows's new value is placed back into this parameter.
+// - progress - Optional. Called between chunks of ReflowChunkSize rows. The
+//   caller can use it to report progress or to cancel a reflow that's been
+//   superseded (for instance by another resize) by returning false.
 // Return Value:
-// - S_OK if we successfully copied the contents to the new buffer, otherwise an appropriate HRESULT.
+// - S_OK if we successfully copied the contents to the new buffer,
+//   E_ABORT if the reflow was canceled, otherwise an appropriate HRESULT.
+//   The new buffer is only partially filled on failure and should be discarded.
 HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
                            TextBuffer& newBuffer,
                            const std::optional<Viewport> lastCharacterViewport,
-                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
+                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo,
+                           const ReflowProgressCallback& progress)
 {
     const Cursor& oldCursor = oldBuffer.GetCursor();
     Cursor& newCursor = newBuffer.GetCursor();
@@ -2191,6 +2730,10 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
 
     const short cOldRowsTotal = cOldLastChar.Y + 1;
 
+    // The marks of every old row go to the new row that it starts in.
+    const auto oldMarks = oldBuffer._marks.Get(0, gsl::narrow_cast<size_t>(cOldRowsTotal));
+    auto nextOldMark = oldMarks.cbegin();
+
     COORD cNewCursorPos = { 0 };
     bool fFoundCursorPos = false;
     bool foundOldMutable = false;
@@ -2199,6 +2742,20 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
     // Loop through all the rows of the old buffer and reprint them into the new buffer
     for (short iOldRow = 0; iOldRow < cOldRowsTotal; iOldRow++)
     {
+        // Check in with the caller between chunks of rows, so that a long
+        // scrollback doesn't keep a canceled reflow running to the end.
+        if (progress && iOldRow % ReflowChunkSize == 0)
+        {
+            try
+            {
+                if (!progress(gsl::narrow_cast<size_t>(iOldRow), gsl::narrow_cast<size_t>(cOldRowsTotal)))
+                {
+                    return E_ABORT;
+                }
+            }
+            CATCH_RETURN();
+        }
+
         // Fetch the row and its "right" which is the last printable character.
         const ROW& row = oldBuffer.GetRowByOffset(iOldRow);
         const short cOldColsTotal = oldBuffer.GetLineWidth(iOldRow);
@@ -2214,6 +2771,15 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
             newRow.SetLineRendition(row.GetLineRendition());
         }
 
+        for (; nextOldMark != oldMarks.cend() && nextOldMark->row == gsl::narrow_cast<size_t>(iOldRow); ++nextOldMark)
+        {
+            try
+            {
+                newBuffer._marks.Add(newBufferPos.Y, nextOldMark->category);
+            }
+            CATCH_RETURN();
+        }
+
         // There is a special case here. If the row has a "wrap"
         // flag on it, but the right isn't equal to the width (one
         // index past the final valid index in the row) then there
@@ -2240,8 +2806,10 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
 
         // Loop through every character in the current row (up to
         // the "right" boundary, which is one past the final valid
-        // character)
-        for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
+        // character). The attributes are walked along with an iterator,
+        // as looking each one up by column would rescan the runs every time.
+        auto attrIt = row.GetAttrRow().begin();
+        for (short iOldCol = 0; iOldCol < iRight; iOldCol++, ++attrIt)
         {
             if (iOldCol == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
             {
@@ -2254,7 +2822,7 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
                 // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
                 const auto glyph = row.GetCharRow().GlyphAt(iOldCol);
                 const auto dbcsAttr = row.GetCharRow().DbcsAttrAt(iOldCol);
-                const auto textAttr = row.GetAttrRow().GetAttrByColumn(iOldCol);
+                const auto textAttr = *attrIt;
 
                 if (!newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr))
                 {
@@ -2427,7 +2995,7 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
 // - The hyperlink URI, the hyperlink id (could be new or old)
 void TextBuffer::AddHyperlinkToMap(std::wstring_view uri, uint16_t id)
 {
-    _hyperlinkMap[id] = uri;
+    _hyperlinks.SetUri(id, uri);
 }
 
 // Method Description:
@@ -2438,7 +3006,7 @@ void TextBuffer::AddHyperlinkToMap(std::wstring_view uri, uint16_t id)
 // - The URI
 std::wstring TextBuffer::GetHyperlinkUriFromId(uint16_t id) const
 {
-    return _hyperlinkMap.at(id);
+    return _hyperlinks.GetUri(id);
 }
 
 // Method description:
@@ -2449,33 +3017,7 @@ std::wstring TextBuffer::GetHyperlinkUriFromId(uint16_t id) const
 // - The internal hyperlink ID
 uint16_t TextBuffer::GetHyperlinkId(std::wstring_view uri, std::wstring_view id)
 {
-    uint16_t numericId = 0;
-    if (id.empty())
-    {
-        // no custom id specified, return our internal count
-        numericId = _currentHyperlinkId;
-        ++_currentHyperlinkId;
-    }
-    else
-    {
-        // assign _currentHyperlinkId if the custom id does not already exist
-        std::wstring newId{ id };
-        // hash the URL and add it to the custom ID - GH#7698
-        newId += L"%" + std::to_wstring(til::hash(uri));
-        const auto result = _hyperlinkCustomIdMap.emplace(newId, _currentHyperlinkId);
-        if (result.second)
-        {
-            // the custom id did not already exist
-            ++_currentHyperlinkId;
-        }
-        numericId = (*(result.first)).second;
-    }
-    // _currentHyperlinkId could overflow, make sure its not 0
-    if (_currentHyperlinkId == 0)
-    {
-        ++_currentHyperlinkId;
-    }
-    return numericId;
+    return _hyperlinks.GetId(uri, id);
 }
 
 // Method Description:
@@ -2485,15 +3027,7 @@ uint16_t TextBuffer::GetHyperlinkId(std::wstring_view uri, std::wstring_view id)
 // - The ID of the hyperlink to be removed
 void TextBuffer::RemoveHyperlinkFromMap(uint16_t id) noexcept
 {
-    _hyperlinkMap.erase(id);
-    for (const auto& customIdPair : _hyperlinkCustomIdMap)
-    {
-        if (customIdPair.second == id)
-        {
-            _hyperlinkCustomIdMap.erase(customIdPair.first);
-            break;
-        }
-    }
+    _hyperlinks.Remove(id);
 }
 
 // Method Description:
@@ -2505,14 +3039,7 @@ void TextBuffer::RemoveHyperlinkFromMap(uint16_t id) noexcept
 // - The custom ID if there was one, empty string otherwise
 std::wstring TextBuffer::GetCustomIdFromId(uint16_t id) const
 {
-    for (auto customIdPair : _hyperlinkCustomIdMap)
-    {
-        if (customIdPair.second == id)
-        {
-            return customIdPair.first;
-        }
-    }
-    return {};
+    return _hyperlinks.GetCustomId(id);
 }
 
 // Method Description:
@@ -2522,9 +3049,15 @@ std::wstring TextBuffer::GetCustomIdFromId(uint16_t id) const
 // - The other buffer
 void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
 {
-    _hyperlinkMap = other._hyperlinkMap;
-    _hyperlinkCustomIdMap = other._hyperlinkCustomIdMap;
-    _currentHyperlinkId = other._currentHyperlinkId;
+    _hyperlinks.CopyFrom(other._hyperlinks);
+}
+
+// Method Description:
+// - Gives access to the store that keeps track of the hyperlinks in this buffer.
+//   The rows of this buffer count their references to hyperlinks in there.
+HyperlinkStore& TextBuffer::GetHyperlinkStore() noexcept
+{
+    return _hyperlinks;
 }
 
 // Method Description:
@@ -2538,6 +3071,7 @@ const size_t TextBuffer::AddPatternRecognizer(const std::wstring_view regexStrin
 {
     ++_currentPatternId;
     _idsAndPatterns.emplace(std::make_pair(_currentPatternId, regexString));
+    _patternCache.clear();
     return _currentPatternId;
 }
 
@@ -2547,6 +3081,7 @@ void TextBuffer::ClearPatternRecognizers() noexcept
 {
     _idsAndPatterns.clear();
     _currentPatternId = 0;
+    _patternCache.clear();
 }
 
 // Method Description:
@@ -2557,10 +3092,14 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 {
     _idsAndPatterns = OtherBuffer._idsAndPatterns;
     _currentPatternId = OtherBuffer._currentPatternId;
+    _patternCache.clear();
 }
 
 // Method Description:
 // - Finds patterns within the requested region of the text buffer
+// - Patterns are searched per logical line, so that they can span wrapped rows.
+//   The results are cached per line and only lines containing a row
+//   that changed since the last call are searched again.
 // Arguments:
 // - The firstRow to start searching from
 // - The lastRow to search
@@ -2569,62 +3108,143 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 PointTree TextBuffer::GetPatterns(const size_t firstRow, const size_t lastRow) const
 {
     PointTree::interval_vector intervals;
+    decltype(_patternCache) cache;
+    // Compiling a regex is expensive, so we only do it if there's a line to search.
+    std::vector<std::pair<size_t, std::wregex>> regexes;
 
-    std::wstring concatAll;
     const auto rowSize = GetRowByOffset(0).size();
-    concatAll.reserve(rowSize * (lastRow - firstRow + 1));
+    const auto height = _storage.size();
+    const auto lastLineRow = std::min(lastRow + PatternLookaroundRows, height - 1);
 
-    // to deal with text that spans multiple lines, we will first concatenate
-    // all the text into one string and find the patterns in that string
-    for (auto i = firstRow; i <= lastRow; ++i)
+    // Start with the line the first row is a part of.
+    auto lineStart = firstRow;
+    while (lineStart > 0 && lineStart + PatternLookaroundRows > firstRow && GetRowByOffset(lineStart - 1).WasWrapForced())
     {
-        auto& row = GetRowByOffset(i);
-        concatAll += row.GetText();
+        --lineStart;
     }
 
-    // for each pattern we know of, iterate through the string
-    for (const auto& idAndPattern : _idsAndPatterns)
+    while (lineStart <= lastRow && lineStart < height)
     {
-        std::wregex regexObj{ idAndPattern.second };
+        auto lineEnd = lineStart;
+        while (lineEnd < lastLineRow && GetRowByOffset(lineEnd).WasWrapForced())
+        {
+            ++lineEnd;
+        }
 
-        // search through the run with our regex object
-        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
-        auto words_end = std::wsregex_iterator();
+        std::vector<uint64_t> revisions;
+        revisions.reserve(lineEnd - lineStart + 1);
+        for (auto i = lineStart; i <= lineEnd; ++i)
+        {
+            revisions.emplace_back(GetRowByOffset(i).GetRevision());
+        }
 
-        size_t lenUpToThis = 0;
-        for (auto i = words_begin; i != words_end; ++i)
+        const auto key = (_firstRow + lineStart) % height;
+        PatternCacheEntry entry;
+        if (const auto cached = _patternCache.find(key); cached != _patternCache.end() && cached->second.revisions == revisions)
         {
-            // record the locations -
-            // when we find a match, the prefix is text that is between this
-            // match and the previous match, so we use the size of the prefix
-            // along with the size of the match to determine the locations
-            size_t prefixSize = 0;
-            for (const std::vector<wchar_t> parsedGlyph : Utf16Parser::Parse(i->prefix().str()))
+            entry = std::move(cached->second);
+        }
+        else
+        {
+            // to deal with text that spans multiple lines, we will first concatenate
+            // all the text into one string and find the patterns in that string
+            std::wstring concatAll;
+            concatAll.reserve(rowSize * revisions.size());
+            for (auto i = lineStart; i <= lineEnd; ++i)
             {
-                const std::wstring_view glyph{ parsedGlyph.data(), parsedGlyph.size() };
-                prefixSize += IsGlyphFullWidth(glyph) ? 2 : 1;
+                concatAll += GetRowByOffset(i).GetText();
             }
-            const auto start = lenUpToThis + prefixSize;
-            size_t matchSize = 0;
-            for (const std::vector<wchar_t> parsedGlyph : Utf16Parser::Parse(i->str()))
+
+            if (regexes.empty())
             {
-                const std::wstring_view glyph{ parsedGlyph.data(), parsedGlyph.size() };
-                matchSize += IsGlyphFullWidth(glyph) ? 2 : 1;
+                for (const auto& idAndPattern : _idsAndPatterns)
+                {
+                    regexes.emplace_back(idAndPattern.first, std::wregex{ idAndPattern.second });
+                }
             }
-            const auto end = start + matchSize;
-            lenUpToThis = end;
 
-            const til::point startCoord{ gsl::narrow<SHORT>(start % rowSize), gsl::narrow<SHORT>(start / rowSize) };
-            const til::point endCoord{ gsl::narrow<SHORT>(end % rowSize), gsl::narrow<SHORT>(end / rowSize) };
+            entry.revisions = std::move(revisions);
+            entry.matches = _FindPatterns(concatAll, regexes);
+        }
+
+        for (const auto& [start, end, id] : entry.matches)
+        {
+            const auto startRow = lineStart + start / rowSize;
+            const auto endRow = lineStart + end / rowSize;
+            if (endRow < firstRow || startRow > lastRow)
+            {
+                continue;
+            }
 
-            // store the intervals
             // NOTE: these intervals are relative to the VIEWPORT not the buffer
             // Keeping these relative to the viewport for now because its the renderer
             // that actually uses these locations and the renderer works relative to
             // the viewport
-            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
+            const til::point startCoord{ gsl::narrow<SHORT>(start % rowSize), gsl::narrow<SHORT>(static_cast<ptrdiff_t>(startRow) - static_cast<ptrdiff_t>(firstRow)) };
+            const til::point endCoord{ gsl::narrow<SHORT>(end % rowSize), gsl::narrow<SHORT>(static_cast<ptrdiff_t>(endRow) - static_cast<ptrdiff_t>(firstRow)) };
+            intervals.push_back(PointTree::interval(startCoord, endCoord, id));
         }
+
+        cache.emplace(key, std::move(entry));
+        lineStart = lineEnd + 1;
     }
+
+    // Lines we didn't visit are dropped. They're unlikely to be asked for again unchanged.
+    _patternCache = std::move(cache);
+
     PointTree result(std::move(intervals));
     return result;
 }
+
+// Method Description:
+// - Counts the cells the given text occupies once it's written into the buffer.
+// Arguments:
+// - text - the text to measure
+// Return value:
+// - The number of cells, where every wide grapheme cluster counts twice
+size_t TextBuffer::_GetCellCount(const std::wstring_view text)
+{
+    size_t cells = 0;
+    for (auto remaining = text; !remaining.empty();)
+    {
+        const auto glyph = GraphemeParser::ParseNext(remaining);
+        cells += IsGlyphFullWidth(glyph) ? 2 : 1;
+        remaining = remaining.substr(glyph.size());
+    }
+    return cells;
+}
+
+// Method Description:
+// - Runs all known patterns over the text of a logical line
+// Arguments:
+// - text - the concatenated text of all rows of the line
+// - regexes - the compiled patterns and their IDs
+// Return value:
+// - The [start, end) offsets in cells and the pattern ID of each match
+std::vector<std::tuple<size_t, size_t, size_t>> TextBuffer::_FindPatterns(const std::wstring& text, const std::vector<std::pair<size_t, std::wregex>>& regexes)
+{
+    std::vector<std::tuple<size_t, size_t, size_t>> matches;
+
+    // for each pattern we know of, iterate through the string
+    for (const auto& [id, regexObj] : regexes)
+    {
+        // search through the run with our regex object
+        auto words_begin = std::wsregex_iterator(text.begin(), text.end(), regexObj);
+        auto words_end = std::wsregex_iterator();
+
+        size_t lenUpToThis = 0;
+        for (auto i = words_begin; i != words_end; ++i)
+        {
+            // record the locations -
+            // when we find a match, the prefix is text that is between this
+            // match and the previous match, so we use the size of the prefix
+            // along with the size of the match to determine the locations
+            const auto start = lenUpToThis + _GetCellCount(i->prefix().str());
+            const auto end = start + _GetCellCount(i->str());
+            lenUpToThis = end;
+
+            matches.emplace_back(start, end, id);
+        }
+    }
+    return matches;
+}
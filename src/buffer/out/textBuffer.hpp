@@ -52,13 +52,17 @@ filling in the last row, and updating the screen.
 #include <vector>
 
 #include "cursor.h"
+#include "HyperlinkStore.hpp"
 #include "Row.hpp"
+#include "RowPool.hpp"
+#include "ScrollMarks.hpp"
 #include "TextAttribute.hpp"
 #include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "../buffer/out/textBufferCellIterator.hpp"
 #include "../buffer/out/textBufferTextIterator.hpp"
+#include "../buffer/out/AttributeRunIterator.hpp"
 
 #include "../renderer/inc/IRenderTarget.hpp"
 
@@ -84,6 +88,8 @@ public:
     TextBufferTextIterator GetTextDataAt(const COORD at) const;
     TextBufferTextIterator GetTextLineDataAt(const COORD at) const;
     TextBufferTextIterator GetTextDataAt(const COORD at, const Microsoft::Console::Types::Viewport limit) const;
+    AttributeRunIterator GetAttributeRunsAt(const COORD at) const;
+    AttributeRunIterator GetAttributeRunsAt(const COORD at, const Microsoft::Console::Types::Viewport limit) const;
 
     // Text insertion functions
     OutputCellIterator Write(const OutputCellIterator givenIt);
@@ -92,6 +98,16 @@ public:
                              const COORD target,
                              const std::optional<bool> wrap = true);
 
+    static size_t MeasurePrintableAscii(const std::wstring_view text) noexcept;
+    size_t WriteAsciiLine(const std::wstring_view chars,
+                          const COORD target,
+                          const TextAttribute attr,
+                          const std::optional<bool> wrap = true);
+    size_t WriteText(std::wstring_view text,
+                     const COORD target,
+                     const TextAttribute attr,
+                     const std::optional<bool> wrap = true);
+
     OutputCellIterator WriteLine(const OutputCellIterator givenIt,
                                  const COORD target,
                                  const std::optional<bool> setWrap = std::nullopt,
@@ -104,6 +120,14 @@ public:
 
     // Scroll needs access to this to quickly rotate around the buffer.
     bool IncrementCircularBuffer(const bool inVtMode = false);
+    bool IncrementCircularBuffer(const size_t count, const bool inVtMode);
+
+    void SetColdScrollbackThreshold(const size_t hotRows);
+    void CompactScrollback();
+    size_t GetMemoryUsage() const noexcept;
+
+    ScrollMarks& GetScrollMarks() noexcept;
+    const ScrollMarks& GetScrollMarks() const noexcept;
 
     COORD GetLastNonSpaceCharacter(std::optional<const Microsoft::Console::Types::Viewport> viewOptional = std::nullopt) const;
 
@@ -116,8 +140,15 @@ public:
 
     void ScrollRows(const SHORT firstRow, const SHORT size, const SHORT delta);
 
+    void CopyRectangle(const Microsoft::Console::Types::Viewport& source, const COORD targetOrigin);
+    void FillRectangle(const Microsoft::Console::Types::Viewport& rect, const wchar_t fillChar, const std::optional<TextAttribute> fillAttrs);
+    void ClearRowsBelow(const size_t firstRow, const TextAttribute fillAttributes);
+
     UINT TotalRowCount() const noexcept;
 
+    uint64_t GetGeneration() const noexcept;
+    uint64_t NextGeneration() noexcept;
+
     [[nodiscard]] TextAttribute GetCurrentAttributes() const noexcept;
 
     void SetCurrentAttributes(const TextAttribute& currentAttributes) noexcept;
@@ -133,14 +164,16 @@ public:
     COORD BufferToScreenPosition(const COORD position) const;
 
     void Reset();
+    void Recycle(const TextAttribute defaultAttributes,
+                 const UINT cursorSize,
+                 Microsoft::Console::Render::IRenderTarget& renderTarget);
 
     [[nodiscard]] HRESULT ResizeTraditional(const COORD newSize) noexcept;
 
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    UnicodeStorage& GetUnicodeStorage() noexcept;
 
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget() noexcept;
 
+    const std::vector<DelimiterClass>& GetDelimiterClasses(const size_t row, const std::wstring_view wordDelimiters) const;
     const COORD GetWordStart(const COORD target, const std::wstring_view wordDelimiters, bool accessibilityMode = false, std::optional<til::point> limitOptional = std::nullopt) const;
     const COORD GetWordEnd(const COORD target, const std::wstring_view wordDelimiters, bool accessibilityMode = false, std::optional<til::point> limitOptional = std::nullopt) const;
     bool MoveToNextWord(COORD& pos, const std::wstring_view wordDelimiters, std::optional<til::point> limitOptional = std::nullopt) const;
@@ -152,6 +185,7 @@ public:
     bool MoveToPreviousGlyph(til::point& pos, std::optional<til::point> limitOptional = std::nullopt) const;
 
     const std::vector<SMALL_RECT> GetTextRects(COORD start, COORD end, bool blockSelection, bool bufferCoordinates) const;
+    void GetTextRects(COORD start, COORD end, bool blockSelection, bool bufferCoordinates, std::vector<SMALL_RECT>& textRects) const;
 
     void AddHyperlinkToMap(std::wstring_view uri, uint16_t id);
     std::wstring GetHyperlinkUriFromId(uint16_t id) const;
@@ -159,13 +193,22 @@ public:
     void RemoveHyperlinkFromMap(uint16_t id) noexcept;
     std::wstring GetCustomIdFromId(uint16_t id) const;
     void CopyHyperlinkMaps(const TextBuffer& OtherBuffer);
+    HyperlinkStore& GetHyperlinkStore() noexcept;
+
+    // A span of text with the same colors within a row of TextAndColor.
+    struct ColorRun
+    {
+        size_t length; // in UTF-16 code units
+        COLORREF fg;
+        COLORREF bk;
+    };
 
     class TextAndColor
     {
     public:
         std::vector<std::wstring> text;
-        std::vector<std::vector<COLORREF>> FgAttr;
-        std::vector<std::vector<COLORREF>> BkAttr;
+        // The runs of each row cover its text from start to end. Empty if no colors were requested.
+        std::vector<std::vector<ColorRun>> colors;
     };
 
     const TextAndColor GetText(const bool includeCRLF,
@@ -190,10 +233,16 @@ public:
         short visibleViewportTop{ 0 };
     };
 
+    // Reflow calls this after every ReflowChunkSize rows with the number of rows
+    // reflowed so far and the total. Returning false cancels the reflow.
+    using ReflowProgressCallback = std::function<bool(const size_t rowsDone, const size_t rowsTotal)>;
+    static constexpr size_t ReflowChunkSize{ 256 };
+
     static HRESULT Reflow(TextBuffer& oldBuffer,
                           TextBuffer& newBuffer,
                           const std::optional<Microsoft::Console::Types::Viewport> lastCharacterViewport,
-                          std::optional<std::reference_wrapper<PositionInformation>> positionInfo);
+                          std::optional<std::reference_wrapper<PositionInformation>> positionInfo,
+                          const ReflowProgressCallback& progress = nullptr);
 
     const size_t AddPatternRecognizer(const std::wstring_view regexString);
     void ClearPatternRecognizers() noexcept;
@@ -203,23 +252,55 @@ public:
 private:
     void _UpdateSize();
     Microsoft::Console::Types::Viewport _size;
+
+    // All ROWs of this buffer allocate their cells from this pool instead of the global heap.
+    // It hands out memory in large chunks, so that creating a buffer with a long
+    // scrollback costs a few allocations instead of one per row.
+    // It needs to be declared before _storage, so that it outlives the rows.
+    RowPool _rowPool;
+    // The rows count the cells referring to each hyperlink in here,
+    // so like _rowPool it needs to outlive them.
+    HyperlinkStore _hyperlinks;
     std::vector<ROW> _storage;
     Cursor _cursor;
 
     SHORT _firstRow; // indexes top row (not necessarily 0)
 
+    // Bumped whenever a row is modified or rows are moved around. Every ROW
+    // remembers the generation it was last modified in as its revision.
+    uint64_t _generation{ 0 };
+    // Tells the rows of this buffer apart from those of others in the copies made for readers. See _GetPreparedCopy.
+    uint64_t _id{ 0 };
+
     TextAttribute _currentAttributes;
 
-    // storage location for glyphs that can't fit into the buffer normally
-    UnicodeStorage _unicodeStorage;
+    void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
 
-    std::unordered_map<uint16_t, std::wstring> _hyperlinkMap;
-    std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
-    uint16_t _currentHyperlinkId;
+    ROW& _GetRowAt(const size_t storageIndex);
+    const ROW& _GetRowAt(const size_t storageIndex) const;
+    const ROW& _GetPreparedCopy(const ROW& row) const;
+    void _PrepareRow(ROW& row);
+    void _ApplyPendingClear(ROW& row);
+    void _ClearRowsLazily(const size_t firstRow, const TextAttribute fillAttributes);
+    void _PackColdRows(const size_t count = 1) noexcept;
 
-    void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
+    // Rows more than this many rows above the cursor are packed (see ROW::Pack). 0 disables packing.
+    size_t _hotRows{ 0 };
+    // The number of cold rows that got unpacked again since the last CompactScrollback().
+    size_t _lazilyUnpackedRows{ 0 };
+
+    // Rows whose clear epoch is behind this one were cleared in bulk and
+    // are reset to _clearAttributes once they're retrieved. See ClearRowsBelow().
+    uint64_t _clearEpoch{ 0 };
+    TextAttribute _clearAttributes;
+    // The generation the buffer was in right after the last clear. Copies of cleared rows have this revision.
+    uint64_t _clearGeneration{ 0 };
 
-    Microsoft::Console::Render::IRenderTarget& _renderTarget;
+    // Follows the rows as they're circled, scrolled, resized and reflowed.
+    ScrollMarks _marks;
+
+    // A pointer, so that Recycle() can hand the buffer to another owner.
+    Microsoft::Console::Render::IRenderTarget* _renderTarget;
 
     void _SetFirstRowIndex(const SHORT FirstRowIndex) noexcept;
 
@@ -245,13 +326,48 @@ private:
     const COORD _GetWordEndForAccessibility(const COORD target, const std::wstring_view wordDelimiters, const COORD limit) const;
     const COORD _GetWordEndForSelection(const COORD target, const std::wstring_view wordDelimiters) const;
 
-    void _PruneHyperlinks();
-
-    static void _AppendRTFText(std::ostringstream& contentBuilder, const std::wstring_view& text);
+    static void _AppendRTFText(std::string& contentBuilder, const std::wstring_view& text);
 
     std::unordered_map<size_t, std::wstring> _idsAndPatterns;
     size_t _currentPatternId;
 
+    // The patterns found in a logical (wrapped) line the last time we searched it.
+    struct PatternCacheEntry
+    {
+        // The revisions of the line's rows at that time. If any differs, the line is searched again.
+        std::vector<uint64_t> revisions;
+        // The [start, end) offsets in cells from the start of the line and the pattern ID of each match.
+        std::vector<std::tuple<size_t, size_t, size_t>> matches;
+    };
+
+    // Logical lines are cut off this many rows outside of the requested region,
+    // so that a single huge wrapped line doesn't make every search expensive.
+    static constexpr size_t PatternLookaroundRows{ 16 };
+
+    static std::vector<std::tuple<size_t, size_t, size_t>> _FindPatterns(const std::wstring& text, const std::vector<std::pair<size_t, std::wregex>>& regexes);
+    static size_t _GetCellCount(const std::wstring_view text);
+
+    // Keyed by the storage index of the first row of the line,
+    // which doesn't change when the buffer circles.
+    mutable std::unordered_map<size_t, PatternCacheEntry> _patternCache;
+
+    // The delimiter classes of every cell of the rows that word navigation
+    // visited, for the _delimiterClassesFor delimiters. See GetDelimiterClasses().
+    struct DelimiterClassCacheEntry
+    {
+        // The revision of the row at that time. If it differs, the row is classified again.
+        uint64_t revision;
+        std::vector<DelimiterClass> classes;
+    };
+
+    // Drag selections can visit countless rows of the scrollback.
+    // Beyond this many, we start over instead of keeping all of them.
+    static constexpr size_t DelimiterClassCacheRows{ 4096 };
+
+    // Keyed by the storage index of the row, like _patternCache.
+    mutable std::unordered_map<size_t, DelimiterClassCacheEntry> _delimiterClassCache;
+    mutable std::wstring _delimiterClassesFor;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class UiaTextRangeTests;
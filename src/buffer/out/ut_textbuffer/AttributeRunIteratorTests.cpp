@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../AttributeRunIterator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class AttributeRunIteratorTests
+{
+    TEST_CLASS(AttributeRunIteratorTests);
+
+    static constexpr TextAttribute Gray{ 0x07 };
+    static constexpr TextAttribute Red{ 0x0C };
+
+    TEST_METHOD(YieldsEveryRun)
+    {
+        ROW row{ 0, 10, Gray, nullptr };
+        row.GetAttrRow().Replace(2, 5, Red);
+
+        AttributeRunIterator it{ row, 0, 10 };
+        VERIFY_IS_TRUE(it);
+        VERIFY_ARE_EQUAL(0u, it->begin);
+        VERIFY_ARE_EQUAL(2u, it->end);
+        VERIFY_ARE_EQUAL(Gray, it->attr);
+        VERIFY_ARE_EQUAL(2u, it->cells.size());
+
+        ++it;
+        VERIFY_IS_TRUE(it);
+        VERIFY_ARE_EQUAL(2u, it->begin);
+        VERIFY_ARE_EQUAL(5u, it->end);
+        VERIFY_ARE_EQUAL(Red, it->attr);
+        VERIFY_ARE_EQUAL(3u, it->cells.size());
+
+        ++it;
+        VERIFY_IS_TRUE(it);
+        VERIFY_ARE_EQUAL(5u, it->begin);
+        VERIFY_ARE_EQUAL(10u, it->end);
+        VERIFY_ARE_EQUAL(Gray, it->attr);
+
+        ++it;
+        VERIFY_IS_FALSE(it);
+    }
+
+    TEST_METHOD(ClipsRunsToColumns)
+    {
+        ROW row{ 0, 10, Gray, nullptr };
+        row.GetAttrRow().Replace(2, 5, Red);
+
+        AttributeRunIterator it{ row, 3, 7 };
+        VERIFY_IS_TRUE(it);
+        VERIFY_ARE_EQUAL(3u, it->begin);
+        VERIFY_ARE_EQUAL(5u, it->end);
+        VERIFY_ARE_EQUAL(Red, it->attr);
+
+        ++it;
+        VERIFY_IS_TRUE(it);
+        VERIFY_ARE_EQUAL(5u, it->begin);
+        VERIFY_ARE_EQUAL(7u, it->end);
+        VERIFY_ARE_EQUAL(Gray, it->attr);
+
+        ++it;
+        VERIFY_IS_FALSE(it);
+
+        Log::Comment(L"The end is clamped to the width of the row.");
+        AttributeRunIterator clamped{ row, 6, 100 };
+        VERIFY_IS_TRUE(clamped);
+        VERIFY_ARE_EQUAL(10u, clamped->end);
+
+        Log::Comment(L"An empty range yields no runs.");
+        VERIFY_IS_FALSE((AttributeRunIterator{ row, 4, 4 }));
+    }
+
+    TEST_METHOD(CellsPointIntoTheRow)
+    {
+        ROW row{ 0, 10, Gray, nullptr };
+        row.GetCharRow().GlyphAt(4) = L"x";
+        row.GetAttrRow().Replace(2, 5, Red);
+
+        AttributeRunIterator it{ row, 2, 10 };
+        VERIFY_ARE_EQUAL(L'x', it->cells.at(2).Char());
+        VERIFY_ARE_EQUAL(&*(row.GetCharRow().cbegin() + 2), it->cells.data());
+    }
+};
@@ -0,0 +1,127 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../AttrRow.hpp"
+#include "../HyperlinkStore.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class HyperlinkStoreTests
+{
+    TEST_CLASS(HyperlinkStoreTests);
+
+    static constexpr std::wstring_view url{ L"test.url" };
+    static constexpr std::wstring_view otherUrl{ L"other.url" };
+
+    static TextAttribute _linkAttr(const uint16_t id)
+    {
+        TextAttribute attr{ 0x7f };
+        attr.SetHyperlinkId(id);
+        return attr;
+    }
+
+    TEST_METHOD(CustomIdsMapToTheSameId)
+    {
+        HyperlinkStore store;
+
+        const auto id = store.GetId(url, L"CustomId");
+        VERIFY_ARE_EQUAL(id, store.GetId(url, L"CustomId"));
+        VERIFY_ARE_NOT_EQUAL(id, store.GetId(otherUrl, L"CustomId"));
+        VERIFY_ARE_NOT_EQUAL(id, store.GetId(url, {}));
+        VERIFY_ARE_EQUAL(fmt::format(L"CustomId%{}", til::hash(url)), store.GetCustomId(id));
+    }
+
+    TEST_METHOD(InternsUris)
+    {
+        HyperlinkStore store;
+
+        const auto a = store.GetId(url, {});
+        const auto b = store.GetId(url, {});
+        store.SetUri(a, url);
+        store.SetUri(b, url);
+        VERIFY_ARE_EQUAL(&store.GetUri(a), &store.GetUri(b));
+        VERIFY_ARE_EQUAL(1u, store._uris.size());
+
+        store.Remove(a);
+        VERIFY_ARE_EQUAL(url, store.GetUri(b));
+
+        store.Remove(b);
+        VERIFY_ARE_EQUAL(0u, store._uris.size());
+    }
+
+    TEST_METHOD(ReleasedWithLastCell)
+    {
+        HyperlinkStore store;
+        const TextAttribute plain{ 0x7f };
+
+        const auto id = store.GetId(url, L"CustomId");
+        store.SetUri(id, url);
+
+        ATTR_ROW row{ 80, plain, &store };
+        row.Replace(10, 20, _linkAttr(id));
+        VERIFY_ARE_EQUAL(10u, store.CellCount(id));
+
+        Log::Comment(L"Overwriting part of a link with itself keeps the count exact.");
+        row.Replace(15, 25, _linkAttr(id));
+        VERIFY_ARE_EQUAL(15u, store.CellCount(id));
+
+        row.SetAttrToEnd(12, plain);
+        VERIFY_ARE_EQUAL(2u, store.CellCount(id));
+
+        row.Replace(0, 80, plain);
+        VERIFY_ARE_EQUAL(0u, store.CellCount(id));
+        VERIFY_THROWS(store.GetUri(id), std::exception);
+        VERIFY_IS_TRUE(store.GetCustomId(id).empty());
+        VERIFY_ARE_EQUAL(0u, store._customIds.size());
+    }
+
+    TEST_METHOD(CountsFollowRowEdits)
+    {
+        HyperlinkStore store;
+        const TextAttribute plain{ 0x7f };
+
+        const auto id = store.GetId(url, {});
+        const auto otherId = store.GetId(otherUrl, {});
+        store.SetUri(id, url);
+        store.SetUri(otherId, otherUrl);
+
+        auto row = std::make_unique<ATTR_ROW>(80, plain, &store);
+        row->SetAttrToEnd(70, _linkAttr(id));
+        VERIFY_ARE_EQUAL(10u, store.CellCount(id));
+
+        Log::Comment(L"Growing extends the last run, shrinking cuts it off.");
+        row->Resize(100);
+        VERIFY_ARE_EQUAL(30u, store.CellCount(id));
+        row->Resize(75);
+        VERIFY_ARE_EQUAL(5u, store.CellCount(id));
+
+        row->ReplaceAttrs(_linkAttr(id), _linkAttr(otherId));
+        VERIFY_ARE_EQUAL(5u, store.CellCount(otherId));
+        VERIFY_THROWS(store.GetUri(id), std::exception);
+
+        Log::Comment(L"Copies count their cells, moves take them over.");
+        auto copy = *row;
+        VERIFY_ARE_EQUAL(10u, store.CellCount(otherId));
+        const auto moved = std::move(copy);
+        VERIFY_ARE_EQUAL(10u, store.CellCount(otherId));
+        copy = ATTR_ROW{ 75, plain };
+        VERIFY_ARE_EQUAL(10u, store.CellCount(otherId));
+
+        Log::Comment(L"Assigning a row keeps counting it in the store of the destination.");
+        HyperlinkStore otherStore;
+        ATTR_ROW foreign{ 75, plain, &otherStore };
+        foreign = moved;
+        VERIFY_ARE_EQUAL(10u, store.CellCount(otherId));
+        VERIFY_ARE_EQUAL(5u, otherStore.CellCount(otherId));
+
+        row.reset();
+        VERIFY_ARE_EQUAL(5u, store.CellCount(otherId));
+        VERIFY_ARE_EQUAL(otherUrl, store.GetUri(otherId));
+    }
+};
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../textBuffer.hpp"
+#include "../PersistedBuffer.hpp"
+#include "../../renderer/inc/DummyRenderTarget.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class PersistedBufferTests
+{
+    TEST_CLASS(PersistedBufferTests);
+
+    static constexpr TextAttribute Gray{ 0x07 };
+    static constexpr TextAttribute Red{ 0x0C };
+
+    static DummyRenderTarget target;
+
+    static std::wstring _tempPath()
+    {
+        wchar_t directory[MAX_PATH + 1];
+        const auto length = GetTempPathW(ARRAYSIZE(directory), directory);
+        VERIFY_IS_TRUE(length != 0 && length <= ARRAYSIZE(directory));
+
+        wchar_t path[MAX_PATH];
+        VERIFY_ARE_NOT_EQUAL(0u, GetTempFileNameW(directory, L"wtb", 0, path));
+        // Restore() has to be able to tell a missing file apart from an empty one.
+        VERIFY_WIN32_BOOL_SUCCEEDED(DeleteFileW(path));
+        return path;
+    }
+
+    static std::wstring _rowText(const TextBuffer& buffer, const size_t y)
+    {
+        auto text = buffer.GetRowByOffset(y).GetText();
+        text.erase(text.find_last_not_of(L' ') + 1);
+        return text;
+    }
+
+    TEST_METHOD(RoundTripsContents)
+    {
+        const auto path = _tempPath();
+        auto cleanup = wil::scope_exit([&]() { DeleteFileW(path.c_str()); });
+
+        TextBuffer original{ { 20, 10 }, Gray, 0, target };
+        original.WriteLine(OutputCellIterator{ L"hello" }, { 0, 0 });
+        original.GetRowByOffset(0).GetAttrRow().Replace(1, 4, Red);
+        original.WriteLine(OutputCellIterator{ L"world" }, { 0, 2 });
+        original.GetRowByOffset(2).SetWrapForced(true);
+        original.GetCursor().SetPosition({ 3, 2 });
+        PersistedBuffer::Save(original, path);
+
+        TextBuffer restored{ { 20, 10 }, Gray, 0, target };
+        VERIFY_IS_TRUE(PersistedBuffer::Restore(restored, path));
+
+        VERIFY_ARE_EQUAL(L"hello", _rowText(restored, 0));
+        VERIFY_ARE_EQUAL(L"", _rowText(restored, 1));
+        VERIFY_ARE_EQUAL(L"world", _rowText(restored, 2));
+        VERIFY_IS_TRUE(original.GetRowByOffset(0).GetAttrRow() == restored.GetRowByOffset(0).GetAttrRow());
+        VERIFY_IS_FALSE(restored.GetRowByOffset(0).WasWrapForced());
+        VERIFY_IS_TRUE(restored.GetRowByOffset(2).WasWrapForced());
+        VERIFY_ARE_EQUAL(COORD({ 3, 2 }), restored.GetCursor().GetPosition());
+    }
+
+    TEST_METHOD(RestoresHyperlinks)
+    {
+        const auto path = _tempPath();
+        auto cleanup = wil::scope_exit([&]() { DeleteFileW(path.c_str()); });
+
+        TextBuffer original{ { 20, 10 }, Gray, 0, target };
+        const auto id = original.GetHyperlinkId(L"https://example.com", {});
+        original.AddHyperlinkToMap(L"https://example.com", id);
+        auto link = Red;
+        link.SetHyperlinkId(id);
+        original.WriteLine(OutputCellIterator{ L"link", link }, { 0, 0 });
+        PersistedBuffer::Save(original, path);
+
+        TextBuffer restored{ { 20, 10 }, Gray, 0, target };
+        VERIFY_IS_TRUE(PersistedBuffer::Restore(restored, path));
+
+        const auto attr = restored.GetRowByOffset(0).GetAttrRow().GetAttrByColumn(0);
+        VERIFY_IS_TRUE(attr.IsHyperlink());
+        VERIFY_ARE_EQUAL(L"https://example.com", restored.GetHyperlinkUriFromId(attr.GetHyperlinkId()));
+    }
+
+    TEST_METHOD(KeepsTheNewestRows)
+    {
+        const auto path = _tempPath();
+        auto cleanup = wil::scope_exit([&]() { DeleteFileW(path.c_str()); });
+
+        TextBuffer original{ { 10, 10 }, Gray, 0, target };
+        for (SHORT y = 0; y < 10; ++y)
+        {
+            original.WriteLine(OutputCellIterator{ std::wstring(1, static_cast<wchar_t>(L'0' + y)) }, { 0, y });
+        }
+        original.GetCursor().SetPosition({ 5, 9 });
+        PersistedBuffer::Save(original, path);
+
+        TextBuffer restored{ { 10, 4 }, Gray, 0, target };
+        VERIFY_IS_TRUE(PersistedBuffer::Restore(restored, path));
+
+        VERIFY_ARE_EQUAL(L"6", _rowText(restored, 0));
+        VERIFY_ARE_EQUAL(L"9", _rowText(restored, 3));
+        // The cursor moves up along with the rows it was on.
+        VERIFY_ARE_EQUAL(COORD({ 5, 3 }), restored.GetCursor().GetPosition());
+    }
+
+    TEST_METHOD(IgnoresMissingFiles)
+    {
+        TextBuffer buffer{ { 10, 10 }, Gray, 0, target };
+        VERIFY_IS_FALSE(PersistedBuffer::Restore(buffer, _tempPath()));
+    }
+
+    TEST_METHOD(RejectsCorruptFiles)
+    {
+        const auto path = _tempPath();
+        auto cleanup = wil::scope_exit([&]() { DeleteFileW(path.c_str()); });
+
+        wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        VERIFY_IS_TRUE(file.is_valid());
+        const std::string garbage(64, 'x');
+        DWORD written = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(WriteFile(file.get(), garbage.data(), gsl::narrow<DWORD>(garbage.size()), &written, nullptr));
+        file.reset();
+
+        TextBuffer buffer{ { 10, 10 }, Gray, 0, target };
+        VERIFY_THROWS_SPECIFIC(PersistedBuffer::Restore(buffer, path), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_UNEXPECTED; });
+    }
+};
+
+DummyRenderTarget PersistedBufferTests::target{};
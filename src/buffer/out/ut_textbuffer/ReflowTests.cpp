@@ -851,6 +851,38 @@ class ReflowTests
             _compareTextBufferAgainstTestBuffer(*textBuffer, testBuffer);
         }
     }
+
+    TEST_METHOD(TestReflowProgressAndCancellation)
+    {
+        const COORD oldSize{ 10, 1000 };
+        const COORD newSize{ 5, 2000 };
+        TextBuffer oldBuffer{ oldSize, TextAttribute{ 0x7 }, 0, target };
+        for (short y = 0; y < oldSize.Y; ++y)
+        {
+            oldBuffer.Write(OutputCellIterator{ L"0123456789" }, { 0, y });
+        }
+
+        Log::Comment(L"Progress is reported once per chunk of rows.");
+        std::vector<size_t> reported;
+        {
+            TextBuffer newBuffer{ newSize, TextAttribute{ 0x7 }, 0, target };
+            VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, std::nullopt, [&](const size_t rowsDone, const size_t rowsTotal) {
+                VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(oldSize.Y), rowsTotal);
+                reported.emplace_back(rowsDone);
+                return true;
+            }));
+        }
+        const std::vector<size_t> expected{ 0, 256, 512, 768 };
+        VERIFY_IS_TRUE(expected == reported);
+
+        Log::Comment(L"Returning false cancels the reflow.");
+        {
+            TextBuffer newBuffer{ newSize, TextAttribute{ 0x7 }, 0, target };
+            VERIFY_ARE_EQUAL(E_ABORT, TextBuffer::Reflow(oldBuffer, newBuffer, std::nullopt, std::nullopt, [&](const size_t rowsDone, const size_t) {
+                return rowsDone < TextBuffer::ReflowChunkSize;
+            }));
+        }
+    }
 };
 
 DummyRenderTarget ReflowTests::target{};
@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../RowPool.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class RowPoolTests
+{
+    TEST_CLASS(RowPoolTests);
+
+    TEST_METHOD(CarvesBlocksOutOfChunks)
+    {
+        RowPool pool{ 240, 4 };
+
+        std::vector<void*> blocks;
+        for (auto i = 0; i < 4; ++i)
+        {
+            blocks.emplace_back(pool.allocate(240, alignof(wchar_t)));
+        }
+        VERIFY_ARE_EQUAL(1u, pool.ChunkCount());
+        VERIFY_ARE_EQUAL(4u, pool.BlocksInUse());
+
+        blocks.emplace_back(pool.allocate(240, alignof(wchar_t)));
+        VERIFY_ARE_EQUAL(2u, pool.ChunkCount());
+        VERIFY_ARE_EQUAL(5u, pool.BlocksInUse());
+
+        for (const auto block : blocks)
+        {
+            pool.deallocate(block, 240, alignof(wchar_t));
+        }
+        VERIFY_ARE_EQUAL(0u, pool.BlocksInUse());
+    }
+
+    TEST_METHOD(ReusesFreedBlocks)
+    {
+        RowPool pool{ 240, 4 };
+
+        const auto a = pool.allocate(240, alignof(wchar_t));
+        const auto b = pool.allocate(240, alignof(wchar_t));
+        pool.deallocate(a, 240, alignof(wchar_t));
+
+        const auto c = pool.allocate(240, alignof(wchar_t));
+        VERIFY_ARE_EQUAL(a, c);
+        VERIFY_ARE_EQUAL(1u, pool.ChunkCount());
+
+        pool.deallocate(b, 240, alignof(wchar_t));
+        pool.deallocate(c, 240, alignof(wchar_t));
+    }
+
+    TEST_METHOD(ReleasesEmptyChunks)
+    {
+        RowPool pool{ 240, 2 };
+
+        std::vector<void*> blocks;
+        for (auto i = 0; i < 6; ++i)
+        {
+            blocks.emplace_back(pool.allocate(240, alignof(wchar_t)));
+        }
+        VERIFY_ARE_EQUAL(3u, pool.ChunkCount());
+
+        Log::Comment(L"Emptying the first chunk keeps it around as a spare.");
+        pool.deallocate(blocks.at(0), 240, alignof(wchar_t));
+        pool.deallocate(blocks.at(1), 240, alignof(wchar_t));
+        VERIFY_ARE_EQUAL(3u, pool.ChunkCount());
+
+        Log::Comment(L"Emptying another one gives it back to the upstream resource.");
+        pool.deallocate(blocks.at(2), 240, alignof(wchar_t));
+        pool.deallocate(blocks.at(3), 240, alignof(wchar_t));
+        VERIFY_ARE_EQUAL(2u, pool.ChunkCount());
+        VERIFY_ARE_EQUAL(2u, pool.BlocksInUse());
+
+        pool.deallocate(blocks.at(4), 240, alignof(wchar_t));
+        pool.deallocate(blocks.at(5), 240, alignof(wchar_t));
+        VERIFY_ARE_EQUAL(1u, pool.ChunkCount());
+    }
+
+    TEST_METHOD(ForwardsOtherSizesUpstream)
+    {
+        RowPool pool{ 240, 4 };
+
+        const auto block = pool.allocate(480, alignof(wchar_t));
+        VERIFY_ARE_EQUAL(0u, pool.ChunkCount());
+        VERIFY_ARE_EQUAL(0u, pool.BlocksInUse());
+        pool.deallocate(block, 480, alignof(wchar_t));
+    }
+};
@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../ScrollMarks.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class ScrollMarksTests
+{
+    TEST_CLASS(ScrollMarksTests);
+
+    static std::vector<size_t> _Rows(const ScrollMarks& marks, const size_t firstRow = 0, const size_t lastRow = 1000)
+    {
+        std::vector<size_t> rows;
+        for (const auto& mark : marks.Get(firstRow, lastRow))
+        {
+            rows.push_back(mark.row);
+        }
+        return rows;
+    }
+
+    static std::vector<size_t> _Row(const std::optional<size_t> row)
+    {
+        return row ? std::vector<size_t>{ *row } : std::vector<size_t>{};
+    }
+
+    static std::vector<size_t> _Output(const ScrollMarks& marks, const size_t row, const size_t lastRow)
+    {
+        const auto output = marks.GetCommandOutput(row, lastRow);
+        return output ? std::vector<size_t>{ output->first, output->second } : std::vector<size_t>{};
+    }
+
+    TEST_METHOD(KeepsMarksSorted)
+    {
+        ScrollMarks marks;
+        marks.Add(5, ScrollMarkCategory::Prompt);
+        marks.Add(2, ScrollMarkCategory::Prompt);
+        marks.Add(9, ScrollMarkCategory::Prompt);
+        // Only one mark of every category per row.
+        marks.Add(5, ScrollMarkCategory::Prompt);
+        marks.Add(5, ScrollMarkCategory::SearchResult);
+
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 2, 5, 5, 9 }), _Rows(marks));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 5, 5 }), _Rows(marks, 3, 9));
+    }
+
+    TEST_METHOD(FollowsTheBufferAsItCircles)
+    {
+        ScrollMarks marks;
+        marks.Add(1, ScrollMarkCategory::Prompt);
+        marks.Add(4, ScrollMarkCategory::Prompt);
+        const auto generation = marks.GetGeneration();
+
+        marks.Circle(2);
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 2 }), _Rows(marks));
+        VERIFY_ARE_NOT_EQUAL(generation, marks.GetGeneration());
+
+        // New marks are relative to the new first row.
+        marks.Add(0, ScrollMarkCategory::Prompt);
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 0, 2 }), _Rows(marks));
+    }
+
+    TEST_METHOD(ReplacesCategories)
+    {
+        ScrollMarks marks;
+        marks.Add(3, ScrollMarkCategory::Prompt);
+        marks.Add(7, ScrollMarkCategory::Prompt);
+        marks.Replace(ScrollMarkCategory::SearchResult, { 1, 3, 3, 8 });
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 1, 3, 3, 7, 8 }), _Rows(marks));
+
+        marks.Replace(ScrollMarkCategory::SearchResult, {});
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 3, 7 }), _Rows(marks));
+
+        VERIFY_IS_TRUE(marks.ChangeLast(ScrollMarkCategory::Prompt, ScrollMarkCategory::Error));
+        const auto result = marks.Get(0, 10);
+        VERIFY_ARE_EQUAL(ScrollMarkCategory::Prompt, result.at(0).category);
+        VERIFY_ARE_EQUAL(ScrollMarkCategory::Error, result.at(1).category);
+        VERIFY_IS_FALSE(marks.ChangeLast(ScrollMarkCategory::SearchResult, ScrollMarkCategory::Error));
+    }
+
+    TEST_METHOD(MovesRows)
+    {
+        ScrollMarks marks;
+        for (const size_t row : { 0, 2, 4, 6, 8 })
+        {
+            marks.Add(row, ScrollMarkCategory::Prompt);
+        }
+
+        // Rows 4 to 6 move up by 3, to rows 1 to 3. Rows 1 to 3 take their place.
+        marks.MoveRows(4, 3, -3);
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 0, 1, 3, 5, 8 }), _Rows(marks));
+
+        // Rows 0 to 1 move down by 7, to rows 7 to 8. Rows 2 to 8 move up by 2.
+        marks.MoveRows(0, 2, 7);
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 1, 3, 6, 7, 8 }), _Rows(marks));
+
+        marks.Erase(4, 8);
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 1, 3, 8 }), _Rows(marks));
+    }
+
+    TEST_METHOD(FindsPrompts)
+    {
+        ScrollMarks marks;
+        marks.Add(2, ScrollMarkCategory::Prompt);
+        marks.Add(6, ScrollMarkCategory::Prompt);
+        marks.Add(9, ScrollMarkCategory::Prompt);
+        VERIFY_IS_TRUE(marks.ChangeLast(ScrollMarkCategory::Prompt, ScrollMarkCategory::Error));
+        // Search results in between don't count.
+        marks.Replace(ScrollMarkCategory::SearchResult, { 3, 4, 5, 7, 8 });
+
+        VERIFY_ARE_EQUAL(std::vector<size_t>{}, _Row(marks.PreviousPrompt(2)));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 2 }), _Row(marks.PreviousPrompt(6)));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 9 }), _Row(marks.PreviousPrompt(20)));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 2 }), _Row(marks.NextPrompt(0)));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 9 }), _Row(marks.NextPrompt(6)));
+        VERIFY_ARE_EQUAL(std::vector<size_t>{}, _Row(marks.NextPrompt(9)));
+
+        marks.Circle(3);
+        VERIFY_ARE_EQUAL(std::vector<size_t>{}, _Row(marks.PreviousPrompt(3)));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 3 }), _Row(marks.NextPrompt(0)));
+    }
+
+    TEST_METHOD(FindsCommandOutput)
+    {
+        ScrollMarks marks;
+        // A multi-line prompt, whose command started printing on row 3.
+        marks.Add(1, ScrollMarkCategory::Prompt);
+        marks.Add(3, ScrollMarkCategory::Output);
+        // A prompt without any FTCS_COMMAND_EXECUTED.
+        marks.Add(6, ScrollMarkCategory::Prompt);
+        // A command without any output.
+        marks.Add(8, ScrollMarkCategory::Prompt);
+        marks.Add(9, ScrollMarkCategory::Prompt);
+
+        VERIFY_ARE_EQUAL(std::vector<size_t>{}, _Output(marks, 0, 12));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 3, 6 }), _Output(marks, 1, 12));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 3, 6 }), _Output(marks, 5, 12));
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 7, 8 }), _Output(marks, 6, 12));
+        VERIFY_ARE_EQUAL(std::vector<size_t>{}, _Output(marks, 8, 12));
+        // The output of the last command ends where the buffer was written to.
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 10, 12 }), _Output(marks, 11, 12));
+    }
+};
@@ -18,17 +18,16 @@ class UnicodeStorageTests
     TEST_METHOD(CanOverwriteEmoji)
     {
         UnicodeStorage storage;
-        const COORD coord{ 1, 3 };
+        const UnicodeStorage::key_type column{ 1 };
         const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
         const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
 
         // store initial glyph
-        storage.StoreGlyph(coord, newMoon);
+        storage.StoreGlyph(column, newMoon);
 
         // verify it was stored
-        auto findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& newMoonGlyph = findIt->second;
+        VERIFY_ARE_EQUAL(1u, storage._map.size());
+        const std::vector<wchar_t>& newMoonGlyph = storage.GetText(column);
         VERIFY_ARE_EQUAL(newMoonGlyph.size(), newMoon.size());
         for (size_t i = 0; i < newMoon.size(); ++i)
         {
@@ -36,16 +35,49 @@ class UnicodeStorageTests
         }
 
         // overwrite it
-        storage.StoreGlyph(coord, fullMoon);
+        storage.StoreGlyph(column, fullMoon);
 
         // verify the glyph was overwritten
-        findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& fullMoonGlyph = findIt->second;
+        VERIFY_ARE_EQUAL(1u, storage._map.size());
+        const std::vector<wchar_t>& fullMoonGlyph = storage.GetText(column);
         VERIFY_ARE_EQUAL(fullMoonGlyph.size(), fullMoon.size());
         for (size_t i = 0; i < fullMoon.size(); ++i)
         {
             VERIFY_ARE_EQUAL(fullMoonGlyph.at(i), fullMoon.at(i));
         }
     }
+
+    TEST_METHOD(KeepsGlyphsSortedByColumn)
+    {
+        UnicodeStorage storage;
+        const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
+        const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
+        const std::vector<wchar_t> peach{ 0xD83C, 0xDF51 };
+
+        storage.StoreGlyph(7, fullMoon);
+        storage.StoreGlyph(2, newMoon);
+        storage.StoreGlyph(5, peach);
+
+        VERIFY_ARE_EQUAL(3u, storage._map.size());
+        VERIFY_ARE_EQUAL(2u, storage._map.at(0).first);
+        VERIFY_ARE_EQUAL(5u, storage._map.at(1).first);
+        VERIFY_ARE_EQUAL(7u, storage._map.at(2).first);
+        VERIFY_IS_TRUE(storage.GetText(5) == peach);
+
+        Log::Comment(L"Erasing a column that holds no glyph does nothing.");
+        storage.Erase(3);
+        VERIFY_ARE_EQUAL(3u, storage._map.size());
+
+        storage.Erase(5);
+        VERIFY_ARE_EQUAL(2u, storage._map.size());
+        VERIFY_THROWS(storage.GetText(5), wil::ResultException);
+
+        Log::Comment(L"Trimming drops the glyphs at and beyond the new width.");
+        storage.Trim(7);
+        VERIFY_ARE_EQUAL(1u, storage._map.size());
+        VERIFY_IS_TRUE(storage.GetText(2) == newMoon);
+
+        storage.Clear();
+        VERIFY_IS_TRUE(storage._map.empty());
+    }
 };
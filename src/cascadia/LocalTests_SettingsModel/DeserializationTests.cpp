@@ -73,6 +73,7 @@ namespace SettingsModelLocalTests
         TEST_METHOD(TestValidDefaults);
         TEST_METHOD(TestInheritedCommand);
         TEST_METHOD(LoadFragmentsWithMultipleUpdates);
+        TEST_METHOD(ReloadUnchangedSettings);
 
     private:
         static winrt::com_ptr<implementation::CascadiaSettings> createSettings(const std::string_view& userJSON)
@@ -2012,4 +2013,34 @@ namespace SettingsModelLocalTests
         VERIFY_IS_FALSE(loader.duplicateProfile);
         VERIFY_ARE_EQUAL(3u, loader.userSettings.profiles.size());
     }
+
+    void DeserializationTests::ReloadUnchangedSettings()
+    {
+        static constexpr std::string_view settingsJson{ R"(
+        {
+            "defaultProfile": "{6239a42c-0000-49a3-80bd-e8fdd045185c}",
+            "profiles": [
+                {
+                    "name": "profile0",
+                    "guid": "{6239a42c-0000-49a3-80bd-e8fdd045185c}",
+                    "historySize": 1
+                }
+            ]
+        })" };
+
+        // Loading the same JSON twice reuses the parsed JSON,
+        // but the two settings must still be independent of each other.
+        const auto first = createSettings(settingsJson);
+        const auto second = createSettings(settingsJson);
+
+        first->AllProfiles().GetAt(0).Name(L"renamed");
+        first->AllProfiles().GetAt(0).HistorySize(2);
+
+        VERIFY_ARE_EQUAL(L"profile0", second->AllProfiles().GetAt(0).Name());
+        VERIFY_ARE_EQUAL(1, second->AllProfiles().GetAt(0).HistorySize());
+
+        const auto third = createSettings(settingsJson);
+        VERIFY_ARE_EQUAL(L"profile0", third->AllProfiles().GetAt(0).Name());
+        VERIFY_ARE_EQUAL(1, third->AllProfiles().GetAt(0).HistorySize());
+    }
 }
@@ -52,6 +52,7 @@ namespace SettingsModelLocalTests
         TEST_METHOD(TestMoveTabArgs);
         TEST_METHOD(TestGetKeyBindingForAction);
         TEST_METHOD(KeybindingsWithoutVkey);
+        TEST_METHOD(TestLayeredKeyChordLookup);
     };
 
     void KeyBindingsTests::KeyChords()
@@ -795,4 +796,43 @@ namespace SettingsModelLocalTests
         const auto action = actionMap->GetActionByKeyChord({ VirtualKeyModifiers::Shift, 0, 255 });
         VERIFY_IS_NOT_NULL(action);
     }
+
+    void KeyBindingsTests::TestLayeredKeyChordLookup()
+    {
+        const std::string parentString{ R"([
+            { "command": "copy", "keys": ["ctrl+c"] },
+            { "command": "paste", "keys": ["ctrl+v"] },
+            { "command": "newTab", "keys": ["ctrl+t"] }
+        ])" };
+        const std::string childString{ R"([
+            { "command": "closePane", "keys": ["ctrl+c"] },
+            { "command": "unbound", "keys": ["ctrl+v"] }
+        ])" };
+        const std::string laterString{ R"([ { "command": "closeWindow", "keys": ["ctrl+t"] } ])" };
+
+        const KeyChord ctrlC{ VirtualKeyModifiers::Control, static_cast<int32_t>('C'), 0 };
+        const KeyChord ctrlV{ VirtualKeyModifiers::Control, static_cast<int32_t>('V'), 0 };
+        const KeyChord ctrlT{ VirtualKeyModifiers::Control, static_cast<int32_t>('T'), 0 };
+        const KeyChord ctrlX{ VirtualKeyModifiers::Control, static_cast<int32_t>('X'), 0 };
+
+        const auto parent = winrt::make_self<implementation::ActionMap>();
+        parent->LayerJson(VerifyParseSucceeded(parentString));
+
+        const auto child = winrt::make_self<implementation::ActionMap>();
+        child->LayerJson(VerifyParseSucceeded(childString));
+        child->AddLeastImportantParent(parent);
+
+        Log::Comment(L"The child's bindings take precedence over the ones of its parent");
+        VERIFY_ARE_EQUAL(ShortcutAction::ClosePane, child->GetActionByKeyChord(ctrlC).ActionAndArgs().Action());
+        VERIFY_IS_NULL(child->GetActionByKeyChord(ctrlV));
+        VERIFY_IS_TRUE(child->IsKeyChordExplicitlyUnbound(ctrlV));
+        VERIFY_ARE_EQUAL(ShortcutAction::NewTab, child->GetActionByKeyChord(ctrlT).ActionAndArgs().Action());
+        VERIFY_IS_NULL(child->GetActionByKeyChord(ctrlX));
+        VERIFY_IS_FALSE(child->IsKeyChordExplicitlyUnbound(ctrlX));
+
+        Log::Comment(L"Bindings added after a lookup are found by the next one");
+        child->LayerJson(VerifyParseSucceeded(laterString));
+        VERIFY_ARE_EQUAL(ShortcutAction::CloseWindow, child->GetActionByKeyChord(ctrlT).ActionAndArgs().Action());
+        VERIFY_ARE_EQUAL(ShortcutAction::ClosePane, child->GetActionByKeyChord(ctrlC).ActionAndArgs().Action());
+    }
 }
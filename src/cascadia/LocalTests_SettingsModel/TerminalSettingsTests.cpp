@@ -44,6 +44,7 @@ namespace SettingsModelLocalTests
         TEST_METHOD(MakeSettingsForDefaultProfileThatDoesntExist);
         TEST_METHOD(TestLayerProfileOnColorScheme);
         TEST_METHOD(TestCommandlineToTitlePromotion);
+        TEST_METHOD(TestRendererCalibration);
 
         TEST_CLASS_SETUP(ClassSetup)
         {
@@ -881,4 +882,62 @@ namespace SettingsModelLocalTests
             VERIFY_ARE_EQUAL(L"", settingsStruct.DefaultSettings().StartingTitle());
         }
     }
+
+    void TerminalSettingsTests::TestRendererCalibration()
+    {
+        const auto adapterKey = RendererCalibration::AdapterKey();
+        if (adapterKey.empty())
+        {
+            Log::Result(TestResults::Skipped, L"There's no graphics adapter to calibrate.");
+            return;
+        }
+
+        static constexpr std::string_view settingsString{ R"(
+        {
+            "defaultProfile": "{6239a42c-1111-49a3-80bd-e8fdd045185c}",
+            "profiles": [
+                {
+                    "name" : "profile0",
+                    "guid": "{6239a42c-1111-49a3-80bd-e8fdd045185c}"
+                },
+                {
+                    "name" : "profile1",
+                    "guid": "{6239a42c-2222-49a3-80bd-e8fdd045185c}",
+                    "experimental.useAtlasEngine": false
+                }
+            ]
+        })" };
+        const auto settings = winrt::make_self<implementation::CascadiaSettings>(settingsString);
+        const auto profile0 = settings->FindProfile(::Microsoft::Console::Utils::GuidFromString(L"{6239a42c-1111-49a3-80bd-e8fdd045185c}"));
+        const auto profile1 = settings->FindProfile(::Microsoft::Console::Utils::GuidFromString(L"{6239a42c-2222-49a3-80bd-e8fdd045185c}"));
+
+        auto state = ApplicationState::SharedInstance();
+        const auto previous = state.RendererCalibrations();
+        auto restore = wil::scope_exit([&]() { state.RendererCalibrations(previous); });
+
+        { // No calibration for this adapter -> the defaults
+            const auto calibrations = winrt::single_threaded_map<winrt::hstring, RendererConfiguration>();
+            calibrations.Insert(L"some other adapter", RendererConfiguration::AtlasEngineSoftware);
+            state.RendererCalibrations(calibrations);
+
+            const auto terminalSettings = TerminalSettings::CreateWithProfile(*settings, profile0, nullptr).DefaultSettings();
+            VERIFY_IS_FALSE(terminalSettings.UseAtlasEngine());
+            VERIFY_IS_FALSE(terminalSettings.SoftwareRendering());
+        }
+
+        const auto calibrations = winrt::single_threaded_map<winrt::hstring, RendererConfiguration>();
+        calibrations.Insert(adapterKey, RendererConfiguration::AtlasEngineSoftware);
+        state.RendererCalibrations(calibrations);
+
+        { // The profile didn't pick a renderer -> the calibrated one
+            const auto terminalSettings = TerminalSettings::CreateWithProfile(*settings, profile0, nullptr).DefaultSettings();
+            VERIFY_IS_TRUE(terminalSettings.UseAtlasEngine());
+            VERIFY_IS_TRUE(terminalSettings.SoftwareRendering());
+        }
+        { // The profile picked DxEngine -> that's what it gets, on the GPU
+            const auto terminalSettings = TerminalSettings::CreateWithProfile(*settings, profile1, nullptr).DefaultSettings();
+            VERIFY_IS_FALSE(terminalSettings.UseAtlasEngine());
+            VERIFY_IS_FALSE(terminalSettings.SoftwareRendering());
+        }
+    }
 }
@@ -26,6 +26,7 @@ namespace TerminalAppLocalTests
         TEST_METHOD(VerifyWeight);
         TEST_METHOD(VerifyCompare);
         TEST_METHOD(VerifyCompareIgnoreCase);
+        TEST_METHOD(VerifyUpdateFilter);
     };
 
     void FilteredCommandTests::VerifyHighlighting()
@@ -229,4 +230,35 @@ namespace TerminalAppLocalTests
 
         VERIFY_SUCCEEDED(result);
     }
+
+    void FilteredCommandTests::VerifyUpdateFilter()
+    {
+        auto result = RunOnUIThread([]() {
+            const auto paletteItem{ winrt::make<winrt::TerminalApp::implementation::CommandLinePaletteItem>(L"Split Pane") };
+            const auto filteredCommand = winrt::make_self<winrt::TerminalApp::implementation::FilteredCommand>(paletteItem);
+
+            Log::Comment(L"Testing a filter that matches regardless of its case");
+            filteredCommand->UpdateFilter(L"sP");
+            const auto weight = filteredCommand->Weight();
+            VERIFY_IS_GREATER_THAN(weight, 0);
+            auto segments = filteredCommand->HighlightedName().Segments();
+            VERIFY_ARE_EQUAL(segments.Size(), 4u);
+            VERIFY_ARE_EQUAL(segments.GetAt(0).TextSegment(), L"S");
+            VERIFY_IS_TRUE(segments.GetAt(0).IsHighlighted());
+            VERIFY_ARE_EQUAL(segments.GetAt(1).TextSegment(), L"plit ");
+            VERIFY_IS_FALSE(segments.GetAt(1).IsHighlighted());
+            VERIFY_ARE_EQUAL(segments.GetAt(2).TextSegment(), L"P");
+            VERIFY_IS_TRUE(segments.GetAt(2).IsHighlighted());
+
+            Log::Comment(L"Testing a filter that doesn't match");
+            filteredCommand->UpdateFilter(L"spx");
+            VERIFY_ARE_EQUAL(filteredCommand->Weight(), 0);
+
+            Log::Comment(L"Testing that the previous filter matches again");
+            filteredCommand->UpdateFilter(L"sp");
+            VERIFY_ARE_EQUAL(filteredCommand->Weight(), weight);
+        });
+
+        VERIFY_SUCCEEDED(result);
+    }
 }
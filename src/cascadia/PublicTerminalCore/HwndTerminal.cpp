@@ -16,6 +16,14 @@ using namespace ::Microsoft::Terminal::Core;
 
 static LPCWSTR term_window_class = L"HwndTerminalClass";
 
+// The number of output chunks that may wait for the parse thread, before the thread that sends them has to wait.
+static constexpr uint32_t OutputQueueCapacity = 16;
+
+// The callbacks of the embedding app are invoked on the window thread. These
+// messages carry the ones that are raised on the parse thread over to it.
+static constexpr UINT WM_HWNDTERMINAL_SCROLL_POSITION_CHANGED = WM_USER + 1;
+static constexpr UINT WM_HWNDTERMINAL_WRITE_INPUT = WM_USER + 2;
+
 // This magic flag is "documented" at https://msdn.microsoft.com/en-us/library/windows/desktop/ms646301(v=vs.85).aspx
 // "If the high-order bit is 1, the key is down; otherwise, it is up."
 static constexpr short KeyPressed{ gsl::narrow_cast<short>(0x8000) };
@@ -129,6 +137,20 @@ try
                 terminal->_PasteTextFromClipboard();
             }
             return 0;
+        case WM_HWNDTERMINAL_SCROLL_POSITION_CHANGED:
+        {
+#pragma warning(suppress : 26490) // Win32 APIs can only store void*, have to use reinterpret_cast
+            const std::unique_ptr<std::array<int, 3>> args{ reinterpret_cast<std::array<int, 3>*>(lParam) };
+            terminal->_ScrollPositionChanged(args->at(0), args->at(1), args->at(2));
+            return 0;
+        }
+        case WM_HWNDTERMINAL_WRITE_INPUT:
+        {
+#pragma warning(suppress : 26490) // Win32 APIs can only store void*, have to use reinterpret_cast
+            const std::unique_ptr<std::wstring> input{ reinterpret_cast<std::wstring*>(lParam) };
+            terminal->_WriteTextToConnection(*input);
+            return 0;
+        }
         case WM_DESTROY:
             // Release Terminal's hwnd so Teardown doesn't try to destroy it again
             terminal->_hwnd.release();
@@ -174,6 +196,7 @@ HwndTerminal::HwndTerminal(HWND parentHwnd) :
     _uiaProvider{ nullptr },
     _currentDpi{ USER_DEFAULT_SCREEN_DPI },
     _pfnWriteCallback{ nullptr },
+    _windowThreadId{ GetCurrentThreadId() },
     _multiClickTime{ 500 } // this will be overwritten by the windows system double-click time
 {
     _EnsureStaticInitialization();
@@ -245,6 +268,12 @@ HRESULT HwndTerminal::Initialize()
     _terminal->SetWriteInputCallback([=](std::wstring& input) noexcept { _WriteTextToConnection(input); });
     localPointerToThread->EnablePainting();
 
+    auto [producer, consumer] = til::spsc::channel<std::wstring>(OutputQueueCapacity);
+    _outputProducer = std::make_unique<til::spsc::producer<std::wstring>>(std::move(producer));
+    _parseThread = std::thread{ [this, consumer = std::move(consumer)]() {
+        _ParseOutputThread(consumer);
+    } };
+
     _multiClickTime = std::chrono::milliseconds{ GetDoubleClickTime() };
 
     return S_OK;
@@ -256,6 +285,16 @@ try
     // As a rule, detach resources from the Terminal before shutting them down.
     // This ensures that teardown is reentrant.
 
+    // Dropping the producer ends the parse thread, once it's parsed what's left in the queue.
+    {
+        const std::lock_guard lock{ _outputMutex };
+        _outputProducer.reset();
+    }
+    if (_parseThread.joinable())
+    {
+        _parseThread.join();
+    }
+
     // Shut down the renderer (and therefore the thread) before we implode
     if (auto localRenderEngine{ std::exchange(_renderEngine, nullptr) })
     {
@@ -279,9 +318,52 @@ CATCH_LOG();
 
 void HwndTerminal::RegisterScrollCallback(std::function<void(int, int, int)> callback)
 {
-    _terminal->SetScrollPositionChangedCallback(callback);
+    _pfnScrollCallback = std::move(callback);
+    _terminal->SetScrollPositionChangedCallback([=](const int viewTop, const int viewHeight, const int bufferSize) noexcept {
+        _ScrollPositionChanged(viewTop, viewHeight, bufferSize);
+    });
 }
 
+// Method Description:
+// - Posts the given message to our window, so that it's handled on the window thread.
+//   Messages that are still queued when the window is destroyed are dropped, along with their payload.
+// Arguments:
+// - message: one of the WM_HWNDTERMINAL_* messages
+// - payload: what the message carries, which the window procedure takes ownership of
+template<typename T>
+void HwndTerminal::_PostToWindowThread(const UINT message, std::unique_ptr<T> payload) noexcept
+{
+#pragma warning(suppress : 26490) // Win32 APIs can only store void*, have to use reinterpret_cast
+    if (PostMessageW(_hwnd.get(), message, 0, reinterpret_cast<LPARAM>(payload.get())))
+    {
+        payload.release();
+    }
+}
+
+bool HwndTerminal::_IsOnWindowThread() const noexcept
+{
+    return GetCurrentThreadId() == _windowThreadId;
+}
+
+void HwndTerminal::_ScrollPositionChanged(const int viewTop, const int viewHeight, const int bufferSize) noexcept
+try
+{
+    if (!_pfnScrollCallback)
+    {
+        return;
+    }
+
+    // Output is parsed on the parse thread, which is where this is called when output scrolls.
+    if (!_IsOnWindowThread())
+    {
+        _PostToWindowThread(WM_HWNDTERMINAL_SCROLL_POSITION_CHANGED, std::make_unique<std::array<int, 3>>(std::array<int, 3>{ viewTop, viewHeight, bufferSize }));
+        return;
+    }
+
+    _pfnScrollCallback(viewTop, viewHeight, bufferSize);
+}
+CATCH_LOG();
+
 void HwndTerminal::_WriteTextToConnection(const std::wstring& input) noexcept
 {
     if (!_pfnWriteCallback)
@@ -291,6 +373,13 @@ void HwndTerminal::_WriteTextToConnection(const std::wstring& input) noexcept
 
     try
     {
+        // Responses to queries in the output are written on the parse thread.
+        if (!_IsOnWindowThread())
+        {
+            _PostToWindowThread(WM_HWNDTERMINAL_WRITE_INPUT, std::make_unique<std::wstring>(input));
+            return;
+        }
+
         auto callingText{ wil::make_cotaskmem_string(input.data(), input.size()) };
         _pfnWriteCallback(callingText.release());
     }
@@ -376,9 +465,88 @@ HRESULT HwndTerminal::Refresh(const SIZE windowSize, _Out_ COORD* dimensions)
     return S_OK;
 }
 
+// Method Description:
+// - Queues output for the parse thread. The caller only waits for it to be
+//   parsed if the queue is full. Output is parsed in the order it was sent.
+// Arguments:
+// - data: the output to parse
+// Return Value:
+// - <none>
 void HwndTerminal::SendOutput(std::wstring_view data)
 {
-    _terminal->Write(data);
+    if (data.empty())
+    {
+        return;
+    }
+
+    const std::lock_guard lock{ _outputMutex };
+    if (_outputProducer)
+    {
+        _outputProducer->emplace(data);
+    }
+}
+
+// Method Description:
+// - Like SendOutput(), but for UTF-8. This spares the embedding application
+//   the conversion to UTF-16 that marshalling its output as a string takes.
+//   Characters may be split between two calls.
+// Arguments:
+// - data: the output to parse, in UTF-8
+// Return Value:
+// - <none>
+void HwndTerminal::SendOutputUtf8(std::string_view data)
+{
+    if (data.empty())
+    {
+        return;
+    }
+
+    const std::lock_guard lock{ _outputMutex };
+    if (_outputProducer)
+    {
+        std::wstring text;
+        THROW_IF_FAILED(til::u8u16(data, text, _outputUtf8State));
+        if (!text.empty())
+        {
+            _outputProducer->emplace(std::move(text));
+        }
+    }
+}
+
+// Method Description:
+// - The thread that parses the output sent with SendOutput() and SendOutputUtf8().
+//   Everything that piled up in the queue in the meantime is parsed at once,
+//   with a single acquisition of the terminal lock, just like in ControlCore.
+// Arguments:
+// - queue: the consumer end of the queue
+// Return Value:
+// - <none>
+void HwndTerminal::_ParseOutputThread(const til::spsc::consumer<std::wstring>& queue)
+{
+    std::array<std::wstring, OutputQueueCapacity> chunks;
+    std::array<std::wstring_view, OutputQueueCapacity> views;
+
+    for (;;)
+    {
+        const auto [count, alive] = queue.pop_n(til::spsc::block_initially, chunks.begin(), chunks.size());
+        if (count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                til::at(views, i) = til::at(chunks, i);
+            }
+
+            try
+            {
+                _terminal->Write({ views.data(), count });
+            }
+            CATCH_LOG();
+        }
+        if (!alive)
+        {
+            break;
+        }
+    }
 }
 
 HRESULT _stdcall CreateTerminal(HWND parentHwnd, _Out_ void** hwnd, _Out_ void** terminal)
@@ -429,6 +597,14 @@ void _stdcall TerminalSendOutput(void* terminal, LPCWSTR data)
     publicTerminal->SendOutput(data);
 }
 
+void _stdcall TerminalSendOutputUtf8(void* terminal, const char* data, uint32_t length)
+try
+{
+    const auto publicTerminal = static_cast<HwndTerminal*>(terminal);
+    publicTerminal->SendOutputUtf8({ data, length });
+}
+CATCH_LOG();
+
 /// <summary>
 /// Triggers a terminal resize using the new width and height in pixel.
 /// </summary>
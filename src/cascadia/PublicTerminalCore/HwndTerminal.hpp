@@ -9,6 +9,7 @@
 #include <UIAutomationCore.h>
 #include "../../types/IControlAccessibilityInfo.h"
 #include "../../types/TermControlUiaProvider.hpp"
+#include <til/spsc.h>
 
 using namespace Microsoft::Console::VirtualTerminal;
 
@@ -23,9 +24,14 @@ typedef struct _TerminalTheme
     COLORREF ColorTable[16];
 } TerminalTheme, *LPTerminalTheme;
 
+// The scroll and write callbacks are always invoked on the thread that called CreateTerminal,
+// which owns the terminal's window, even though output is parsed on a thread of its own.
+// The ones that are raised while parsing output are posted to the window and are
+// invoked once its thread gets to them.
 extern "C" {
 __declspec(dllexport) HRESULT _stdcall CreateTerminal(HWND parentHwnd, _Out_ void** hwnd, _Out_ void** terminal);
 __declspec(dllexport) void _stdcall TerminalSendOutput(void* terminal, LPCWSTR data);
+__declspec(dllexport) void _stdcall TerminalSendOutputUtf8(void* terminal, const char* data, uint32_t length);
 __declspec(dllexport) void _stdcall TerminalRegisterScrollCallback(void* terminal, void __stdcall callback(int, int, int));
 __declspec(dllexport) HRESULT _stdcall TerminalTriggerResize(_In_ void* terminal, _In_ short width, _In_ short height, _Out_ COORD* dimensions);
 __declspec(dllexport) HRESULT _stdcall TerminalTriggerResizeWithDimension(_In_ void* terminal, _In_ COORD dimensions, _Out_ SIZE* dimensionsInPixels);
@@ -60,6 +66,7 @@ public:
     HRESULT Initialize();
     void Teardown() noexcept;
     void SendOutput(std::wstring_view data);
+    void SendOutputUtf8(std::string_view data);
     HRESULT Refresh(const SIZE windowSize, _Out_ COORD* dimensions);
     void RegisterScrollCallback(std::function<void(int, int, int)> callback);
     void RegisterWriteCallback(const void _stdcall callback(wchar_t*));
@@ -74,6 +81,8 @@ private:
     FontInfo _actualFont;
     int _currentDpi;
     std::function<void(wchar_t*)> _pfnWriteCallback;
+    std::function<void(int, int, int)> _pfnScrollCallback;
+    DWORD _windowThreadId;
     ::Microsoft::WRL::ComPtr<::Microsoft::Terminal::TermControlUiaProvider> _uiaProvider;
 
     std::unique_ptr<::Microsoft::Terminal::Core::Terminal> _terminal;
@@ -81,6 +90,12 @@ private:
     std::unique_ptr<::Microsoft::Console::Render::Renderer> _renderer;
     std::unique_ptr<::Microsoft::Console::Render::DxEngine> _renderEngine;
 
+    // Output is parsed on _parseThread. See SendOutput().
+    std::mutex _outputMutex; // there's a single producer, but any thread may send output
+    std::unique_ptr<til::spsc::producer<std::wstring>> _outputProducer;
+    til::u8state _outputUtf8State;
+    std::thread _parseThread;
+
     bool _focused{ false };
     bool _uiaProviderInitialized{ false };
 
@@ -108,7 +123,12 @@ private:
     friend void _stdcall TerminalKillFocus(void* terminal);
 
     void _UpdateFont(int newDpi);
+    void _ParseOutputThread(const til::spsc::consumer<std::wstring>& queue);
     void _WriteTextToConnection(const std::wstring& text) noexcept;
+    void _ScrollPositionChanged(const int viewTop, const int viewHeight, const int bufferSize) noexcept;
+    bool _IsOnWindowThread() const noexcept;
+    template<typename T>
+    void _PostToWindowThread(const UINT message, std::unique_ptr<T> payload) noexcept;
     HRESULT _CopyTextToSystemClipboard(const TextBuffer::TextAndColor& rows, bool const fAlsoCopyFormatting);
     HRESULT _CopyToSystemClipboard(std::string stringToCopy, LPCWSTR lpszFormat);
     void _PasteTextFromClipboard() noexcept;
@@ -100,6 +100,10 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
             peasant.HideNotificationIconRequested([this](auto&&, auto&&) { _HideNotificationIconRequestedHandlers(*this, nullptr); });
             peasant.QuitAllRequested({ this, &Monarch::_handleQuitAll });
 
+            // Peasants that were named on the commandline, or that are moving
+            // over from an older monarch, can be found by name right away.
+            _rememberPeasantName(peasant.WindowName(), newPeasantsId);
+
             {
                 std::unique_lock lock{ _peasantsMutex };
                 _peasants[newPeasantsId] = peasant;
@@ -168,6 +172,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         };
 
         _forEachPeasant(callback, onError);
+        DismissStandby();
 
         {
             std::shared_lock lock{ _peasantsMutex };
@@ -211,6 +216,120 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         _WindowClosedHandlers(nullptr, nullptr);
     }
 
+    // Method Description:
+    // - Keeps a standby window process around: one that has already loaded
+    //   XAML and the settings, but doesn't have a window yet. The next
+    //   commandline that asks for a new window is handed to it, instead of
+    //   waiting for the process that proposed it to start up from scratch.
+    // - There's only ever one standby. If there already is one, the new one
+    //   is turned down, and is expected to exit.
+    // - The standby isn't one of our peasants until it's handed a commandline,
+    //   so it doesn't show up in the list of windows in the meantime.
+    // Arguments:
+    // - peasant: the peasant of the standby process. It doesn't have an ID yet.
+    // Return Value:
+    // - true iff we'll use this peasant as the standby.
+    bool Monarch::AddStandby(const Remoting::IPeasant& peasant)
+    {
+        bool accepted = false;
+        {
+            std::lock_guard lock{ _standbyMutex };
+            if (!_standby && !_quitting.load(std::memory_order_acquire))
+            {
+                _standby = peasant;
+                accepted = true;
+            }
+        }
+
+        TraceLoggingWrite(g_hRemotingProvider,
+                          "Monarch_AddStandby",
+                          TraceLoggingBoolean(accepted, "accepted", "true if this is our new standby"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        return accepted;
+    }
+
+    // Method Description:
+    // - Tells the standby window process to exit, if there is one. This is
+    //   used when the standby window gets disabled in the settings.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void Monarch::DismissStandby()
+    {
+        Remoting::IPeasant standby{ nullptr };
+        {
+            std::lock_guard lock{ _standbyMutex };
+            standby = std::exchange(_standby, nullptr);
+        }
+
+        if (standby)
+        {
+            try
+            {
+                standby.Quit();
+            }
+            CATCH_LOG()
+        }
+    }
+
+    // Method Description:
+    // - Hands the given commandline over to the standby window process, which
+    //   will become a new window for it.
+    // - Whether that works or not, the standby is used up. StandbyConsumed is
+    //   raised either way, so that the host can start a new one.
+    // Arguments:
+    // - args: the commandline that needs a new window.
+    // Return Value:
+    // - true iff the standby is now the window for this commandline. If it
+    //   isn't, the process that proposed the commandline needs to create the
+    //   window on its own.
+    bool Monarch::_handOffToStandby(const Remoting::CommandlineArgs& args)
+    {
+        Remoting::IPeasant standby{ nullptr };
+        {
+            std::lock_guard lock{ _standbyMutex };
+            standby = std::exchange(_standby, nullptr);
+        }
+
+        if (!standby)
+        {
+            return false;
+        }
+
+        const auto raiseConsumed = wil::scope_exit([this]() {
+            _StandbyConsumedHandlers(nullptr, nullptr);
+        });
+
+        // AddPeasant doesn't throw if the peasant died. It returns -1 instead.
+        const auto id = AddPeasant(standby);
+        if (id == static_cast<uint64_t>(-1))
+        {
+            return false;
+        }
+
+        try
+        {
+            // The standby treats the first commandline it gets as its initial
+            // one, just like a new window process would.
+            standby.ExecuteCommandline(args);
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            SignalClose(id);
+            return false;
+        }
+
+        TraceLoggingWrite(g_hRemotingProvider,
+                          "Monarch_HandOffToStandby",
+                          TraceLoggingUInt64(id, "peasantID", "the ID the standby was given"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+        return true;
+    }
+
     // Method Description:
     // - Counts the number of living peasants.
     // Arguments:
@@ -306,6 +425,21 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
 
         uint64_t result = 0;
 
+        // Most lookups are for a window that we've already seen with this
+        // name. Confirming that only takes asking that one peasant.
+        {
+            std::unique_lock lock{ _peasantIdsByNameMutex };
+            if (const auto it = _peasantIdsByName.find(std::wstring{ name }); it != _peasantIdsByName.end())
+            {
+                result = it->second;
+            }
+        }
+        if (result != 0 && _isPeasantNamed(result, name))
+        {
+            return result;
+        }
+        result = 0;
+
         const auto callback = [&](const auto& id, const auto& p) {
             auto otherName = p.WindowName();
             if (otherName == name)
@@ -326,6 +460,16 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
 
         _forEachPeasant(callback, onError);
 
+        if (result != 0)
+        {
+            _rememberPeasantName(name, result);
+        }
+        else
+        {
+            std::unique_lock lock{ _peasantIdsByNameMutex };
+            _peasantIdsByName.erase(std::wstring{ name });
+        }
+
         TraceLoggingWrite(g_hRemotingProvider,
                           "Monarch_lookupPeasantIdForName",
                           TraceLoggingWideString(std::wstring{ name }.c_str(), "name", "the name we're looking for"),
@@ -335,6 +479,55 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         return result;
     }
 
+    // Method Description:
+    // - Checks if the given peasant is still alive, and still has the given
+    //   name. Peasants that turn out to be dead are left for
+    //   _lookupPeasantIdForName to clean up.
+    // Arguments:
+    // - peasantID: The ID of the peasant to ask
+    // - name: The window name it's expected to have
+    // Return Value:
+    // - true if the peasant has that name
+    bool Monarch::_isPeasantNamed(uint64_t peasantID, std::wstring_view name)
+    {
+        IPeasant peasant{ nullptr };
+        {
+            std::shared_lock lock{ _peasantsMutex };
+            if (const auto it = _peasants.find(peasantID); it != _peasants.end())
+            {
+                peasant = it->second;
+            }
+        }
+
+        try
+        {
+            return peasant && peasant.WindowName() == name;
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            return false;
+        }
+    }
+
+    // Method Description:
+    // - Records the name of a peasant for the next _lookupPeasantIdForName.
+    // Arguments:
+    // - name: The window name of the peasant. Unnamed peasants are ignored.
+    // - peasantID: The ID of the peasant
+    // Return Value:
+    // - <none>
+    void Monarch::_rememberPeasantName(std::wstring_view name, uint64_t peasantID)
+    {
+        if (name.empty())
+        {
+            return;
+        }
+
+        std::unique_lock lock{ _peasantIdsByNameMutex };
+        _peasantIdsByName.insert_or_assign(std::wstring{ name }, peasantID);
+    }
+
     // Method Description:
     // - Handler for the `Peasant::WindowActivated` event. We'll make a in-proc
     //   copy of the WindowActivatedArgs from the peasant. That way, we won't
@@ -420,15 +613,21 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
     {
         const auto newLastActiveTime = localArgs->ActivatedTime().time_since_epoch().count();
 
-        // * Check all the current lists to look for this peasant.
-        //   remove it from any where it exists.
-        _clearOldMruEntries({ localArgs->PeasantID() });
-
         // * If the current desktop doesn't have a vector, add one.
         const auto desktopGuid{ localArgs->DesktopID() };
 
         {
             std::unique_lock lock{ _mruPeasantsMutex };
+            // * Look for the old entry of this peasant and remove it. There's
+            //   at most one, and we remove it under the same lock that we
+            //   insert the new one with, so that's all we need to look for.
+            const auto peasantID = localArgs->PeasantID();
+            if (const auto it = std::find_if(_mruPeasants.begin(), _mruPeasants.end(), [&](const auto& p) { return p.PeasantID() == peasantID; });
+                it != _mruPeasants.end())
+            {
+                _mruPeasants.erase(it);
+            }
+
             // * Add this args list. By using lower_bound with insert, we can get it
             //   into exactly the right spot, without having to re-sort the whole
             //   array.
@@ -761,6 +960,14 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
                           TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
                           TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 
+        // If there's a standby window process, it can take this commandline.
+        // Windows with a name are still left to the process that proposed
+        // them, as the name is assigned when its peasant is created.
+        if (targetWindowName.empty() && _handOffToStandby(args))
+        {
+            return *winrt::make_self<Remoting::implementation::ProposeCommandlineResult>(false);
+        }
+
         // In this case, no usable ID was provided. Return { true, nullopt }
         auto result = winrt::make_self<Remoting::implementation::ProposeCommandlineResult>(true);
         result->WindowName(targetWindowName);
@@ -1002,27 +1209,70 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         _forEachPeasant(func, onError);
     }
 
+    // How long GetAllWindowLayouts waits for all the peasants to respond.
+    static constexpr auto GetAllWindowLayoutsTimeout = std::chrono::seconds(5);
+
+    // Method Description:
+    // - Request the window layout from the given peasant on a background thread.
+    // Arguments:
+    // - peasant: the peasant to get the window layout from
+    // Return Value:
+    // - the window layout as a json string, once the peasant returned it
+    static IAsyncOperation<winrt::hstring> _getWindowLayoutAsync(Remoting::IPeasant peasant)
+    {
+        co_await winrt::resume_background();
+        co_return peasant.GetWindowLayout();
+    }
+
     // Method Description:
     // - Ask all peasants to return their window layout as json
+    // - Every peasant serializes its layout on its own UI thread, so we ask all
+    //   of them at once instead of one after another. A peasant that didn't
+    //   respond within GetAllWindowLayoutsTimeout is skipped, so that a single
+    //   hung window can't stall quitting all the others.
     // Arguments:
     // - <none>
     // Return Value:
     // - The collection of window layouts from each peasant.
     Windows::Foundation::Collections::IVector<winrt::hstring> Monarch::GetAllWindowLayouts()
     {
-        std::vector<winrt::hstring> vec;
-        auto callback = [&](const auto& /*id*/, const auto& p) {
-            vec.emplace_back(p.GetWindowLayout());
-        };
-        auto onError = [](auto&& id) {
+        const auto onError = [](auto&& id) {
             TraceLoggingWrite(g_hRemotingProvider,
                               "Monarch_GetAllWindowLayouts_Failed",
                               TraceLoggingInt64(id, "peasantID", "The ID of the peasant which we could not get a window layout from"),
                               TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
                               TraceLoggingKeyword(TIL_KEYWORD_TRACE));
         };
+
+        std::vector<std::pair<uint64_t, IAsyncOperation<winrt::hstring>>> requests;
+        auto callback = [&](const auto& id, const auto& p) {
+            requests.emplace_back(id, _getWindowLayoutAsync(p));
+        };
         _forEachPeasant(callback, onError);
 
+        std::vector<winrt::hstring> vec;
+        vec.reserve(requests.size());
+
+        const auto deadline = std::chrono::steady_clock::now() + GetAllWindowLayoutsTimeout;
+        for (const auto& [id, request] : requests)
+        {
+            const auto remaining = std::max(deadline - std::chrono::steady_clock::now(), std::chrono::steady_clock::duration::zero());
+            try
+            {
+                if (request.wait_for(std::chrono::duration_cast<winrt::Windows::Foundation::TimeSpan>(remaining)) == AsyncStatus::Completed)
+                {
+                    vec.emplace_back(request.GetResults());
+                    continue;
+                }
+                request.Cancel();
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION();
+            }
+            onError(id);
+        }
+
         return winrt::single_threaded_vector(std::move(vec));
     }
 }
@@ -60,12 +60,16 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         Windows::Foundation::Collections::IVectorView<winrt::Microsoft::Terminal::Remoting::PeasantInfo> GetPeasantInfos();
         Windows::Foundation::Collections::IVector<winrt::hstring> GetAllWindowLayouts();
 
+        bool AddStandby(const winrt::Microsoft::Terminal::Remoting::IPeasant& peasant);
+        void DismissStandby();
+
         TYPED_EVENT(FindTargetWindowRequested, winrt::Windows::Foundation::IInspectable, winrt::Microsoft::Terminal::Remoting::FindTargetWindowArgs);
         TYPED_EVENT(ShowNotificationIconRequested, winrt::Windows::Foundation::IInspectable, winrt::Windows::Foundation::IInspectable);
         TYPED_EVENT(HideNotificationIconRequested, winrt::Windows::Foundation::IInspectable, winrt::Windows::Foundation::IInspectable);
         TYPED_EVENT(WindowCreated, winrt::Windows::Foundation::IInspectable, winrt::Windows::Foundation::IInspectable);
         TYPED_EVENT(WindowClosed, winrt::Windows::Foundation::IInspectable, winrt::Windows::Foundation::IInspectable);
         TYPED_EVENT(QuitAllRequested, winrt::Windows::Foundation::IInspectable, winrt::Microsoft::Terminal::Remoting::QuitAllRequestedArgs);
+        TYPED_EVENT(StandbyConsumed, winrt::Windows::Foundation::IInspectable, winrt::Windows::Foundation::IInspectable);
 
     private:
         uint64_t _ourPID;
@@ -85,9 +89,26 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         std::shared_mutex _peasantsMutex{};
         std::shared_mutex _mruPeasantsMutex{};
 
+        // A cache of the IDs of the peasants by their last known window name,
+        // so that finding a named window doesn't ask every peasant for its
+        // name. The peasants remain the authority on their names, so every hit
+        // is confirmed with the peasant itself. This mutex is never held
+        // while calling out to a peasant, or while holding the mutexes above.
+        std::unordered_map<std::wstring, uint64_t> _peasantIdsByName;
+        std::mutex _peasantIdsByNameMutex{};
+
+        // A window process that has already loaded everything it needs, but
+        // doesn't have a window yet. See AddStandby. This mutex is never held
+        // while calling out to the standby.
+        winrt::Microsoft::Terminal::Remoting::IPeasant _standby{ nullptr };
+        std::mutex _standbyMutex{};
+
         winrt::Microsoft::Terminal::Remoting::IPeasant _getPeasant(uint64_t peasantID, bool clearMruPeasantOnFailure = true);
         uint64_t _getMostRecentPeasantID(bool limitToCurrentDesktop, const bool ignoreQuakeWindow);
         uint64_t _lookupPeasantIdForName(std::wstring_view name);
+        bool _handOffToStandby(const winrt::Microsoft::Terminal::Remoting::CommandlineArgs& args);
+        bool _isPeasantNamed(uint64_t peasantID, std::wstring_view name);
+        void _rememberPeasantName(std::wstring_view name, uint64_t peasantID);
 
         void _peasantWindowActivated(const winrt::Windows::Foundation::IInspectable& sender,
                                      const winrt::Microsoft::Terminal::Remoting::WindowActivatedArgs& args);
@@ -10,6 +10,7 @@
 
 #include "WindowManager.g.cpp"
 #include "../../types/inc/utils.hpp"
+#include "../../types/inc/StartupTracing.hpp"
 
 using namespace winrt;
 using namespace winrt::Microsoft::Terminal;
@@ -20,7 +21,10 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
 {
     WindowManager::WindowManager()
     {
+        const ::Microsoft::Console::StartupTracing::Scope startupPhase{ ::Microsoft::Console::StartupTracing::Phase::MonarchElection };
+
         _monarchWaitInterrupt.create();
+        _standbyEvent.create();
 
         // Register with COM as a server for the Monarch class
         _registerAsMonarch();
@@ -275,6 +279,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         _monarch.ShowNotificationIconRequested([this](auto&&, auto&&) { _ShowNotificationIconRequestedHandlers(*this, nullptr); });
         _monarch.HideNotificationIconRequested([this](auto&&, auto&&) { _HideNotificationIconRequestedHandlers(*this, nullptr); });
         _monarch.QuitAllRequested({ get_weak(), &WindowManager::_QuitAllRequestedHandlers });
+        _monarch.StandbyConsumed([this](auto&&, auto&&) { _StandbyConsumedHandlers(*this, nullptr); });
 
         _BecameMonarchHandlers(*this, nullptr);
     }
@@ -321,23 +326,124 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
             }
         }
 
-        _peasant.GetWindowLayoutRequested({ get_weak(), &WindowManager::_GetWindowLayoutRequestedHandlers });
-
         TraceLoggingWrite(g_hRemotingProvider,
                           "WindowManager_CreateOurPeasant",
                           TraceLoggingUInt64(_peasant.GetID(), "peasantID", "The ID of our new peasant"),
                           TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
                           TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 
+        _hookUpOurPeasant();
+        return _peasant;
+    }
+
+    void WindowManager::_hookUpOurPeasant()
+    {
+        _peasant.GetWindowLayoutRequested({ get_weak(), &WindowManager::_GetWindowLayoutRequestedHandlers });
+
         // If the peasant asks us to quit we should not try to act in future elections.
         _peasant.QuitRequested([weakThis{ get_weak() }](auto&&, auto&&) {
             if (auto wm = weakThis.get())
             {
                 wm->_monarchWaitInterrupt.SetEvent();
+                wm->_standbyEvent.SetEvent();
             }
         });
+    }
 
-        return _peasant;
+    // Method Description:
+    // - Makes this process the standby window process of the monarch: a
+    //   process that has already started up, so that the next new window
+    //   doesn't have to wait for one to. See Monarch::AddStandby.
+    // - This blocks until the monarch hands us a commandline, tells us to quit,
+    //   or dies. Incoming calls and window messages are still dispatched in the
+    //   meantime.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - true iff we were handed a commandline, and should create a window for
+    //   it, just like after ProposeCommandline. Otherwise this process should
+    //   exit.
+    bool WindowManager::WaitAsStandby()
+    try
+    {
+        _shouldCreateWindow = false;
+
+        // The monarch may have died while we were starting up and left us in
+        // charge. Nobody would ever hand a commandline to this standby then.
+        if (_isKing)
+        {
+            return false;
+        }
+
+        // A standby must never win an election, as the monarch would then be
+        // a process without a window.
+        CoRevokeClassObject(_registrationHostClass);
+        _registrationHostClass = 0;
+
+        _peasant = *winrt::make_self<Remoting::implementation::Peasant>();
+        _hookUpOurPeasant();
+        _peasant.ExecuteCommandlineRequested([weakThis{ get_weak() }](auto&&, auto&&) {
+            if (auto wm = weakThis.get())
+            {
+                wm->_standbyEvent.SetEvent();
+            }
+        });
+
+        if (!_monarch.AddStandby(_peasant))
+        {
+            return false;
+        }
+
+        wil::unique_handle hMonarch{ OpenProcess(SYNCHRONIZE, FALSE, static_cast<DWORD>(_monarch.GetPID())) };
+        THROW_LAST_ERROR_IF_NULL(hMonarch);
+
+        HANDLE waits[]{ _standbyEvent.get(), hMonarch.get() };
+        DWORD index = 0;
+        THROW_IF_FAILED(CoWaitForMultipleHandles(COWAIT_DISPATCH_CALLS | COWAIT_DISPATCH_WINDOW_MESSAGES, INFINITE, ARRAYSIZE(waits), &waits[0], &index));
+
+        // Peasant::ExecuteCommandline stashes the initial args before it
+        // raises the event. If there are none, we were told to quit.
+        if (index != 0 || !_peasant.InitialArgs())
+        {
+            return false;
+        }
+
+        TraceLoggingWrite(g_hRemotingProvider,
+                          "WindowManager_StandbyActivated",
+                          TraceLoggingUInt64(_peasant.GetID(), "peasantID", "The ID the monarch gave our peasant"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+
+        // We're a window like any other now, the monarch has already added our
+        // peasant. That puts us back in the line of succession.
+        _registerAsMonarch();
+        _createPeasantThread();
+        _shouldCreateWindow = true;
+        return true;
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return false;
+    }
+
+    // Method Description:
+    // - Asks the monarch to let go of its standby window process, if it has one.
+    //   Only the monarch should call this.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void WindowManager::DismissStandby()
+    {
+        if (_monarch)
+        {
+            try
+            {
+                _monarch.DismissStandby();
+            }
+            CATCH_LOG()
+        }
     }
 
     // Method Description:
@@ -34,6 +34,8 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
 
         void ProposeCommandline(const winrt::Microsoft::Terminal::Remoting::CommandlineArgs& args);
         bool ShouldCreateWindow();
+        bool WaitAsStandby();
+        void DismissStandby();
 
         winrt::Microsoft::Terminal::Remoting::Peasant CurrentWindow();
         bool IsMonarch();
@@ -59,6 +61,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         TYPED_EVENT(HideNotificationIconRequested, winrt::Windows::Foundation::IInspectable, winrt::Windows::Foundation::IInspectable);
         TYPED_EVENT(QuitAllRequested, winrt::Windows::Foundation::IInspectable, winrt::Microsoft::Terminal::Remoting::QuitAllRequestedArgs);
         TYPED_EVENT(GetWindowLayoutRequested, winrt::Windows::Foundation::IInspectable, winrt::Microsoft::Terminal::Remoting::GetWindowLayoutArgs);
+        TYPED_EVENT(StandbyConsumed, winrt::Windows::Foundation::IInspectable, winrt::Windows::Foundation::IInspectable);
 
     private:
         bool _shouldCreateWindow{ false };
@@ -68,6 +71,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         winrt::Microsoft::Terminal::Remoting::Peasant _peasant{ nullptr };
 
         wil::unique_event _monarchWaitInterrupt;
+        wil::unique_event _standbyEvent;
         std::thread _electionThread;
 
         void _registerAsMonarch();
@@ -76,6 +80,7 @@ namespace winrt::Microsoft::Terminal::Remoting::implementation
         bool _areWeTheKing();
         winrt::Microsoft::Terminal::Remoting::IPeasant _createOurPeasant(std::optional<uint64_t> givenID,
                                                                          const winrt::hstring& givenName);
+        void _hookUpOurPeasant();
 
         bool _performElection();
         void _createPeasantThread();
@@ -266,6 +266,33 @@ namespace winrt::TerminalApp::implementation
         args.Handled(true);
     }
 
+    void TerminalPage::_HandleScrollToPreviousPrompt(const IInspectable& /*sender*/,
+                                                     const ActionEventArgs& args)
+    {
+        if (const auto control{ _GetActiveControl() })
+        {
+            args.Handled(control.ScrollToPrompt(false));
+        }
+    }
+
+    void TerminalPage::_HandleScrollToNextPrompt(const IInspectable& /*sender*/,
+                                                 const ActionEventArgs& args)
+    {
+        if (const auto control{ _GetActiveControl() })
+        {
+            args.Handled(control.ScrollToPrompt(true));
+        }
+    }
+
+    void TerminalPage::_HandleSelectCommandOutput(const IInspectable& /*sender*/,
+                                                  const ActionEventArgs& args)
+    {
+        if (const auto control{ _GetActiveControl() })
+        {
+            args.Handled(control.SelectCommandOutput());
+        }
+    }
+
     void TerminalPage::_HandleFindMatch(const IInspectable& /*sender*/,
                                         const ActionEventArgs& args)
     {
@@ -424,6 +451,24 @@ namespace winrt::TerminalApp::implementation
         args.Handled(res);
     }
 
+    void TerminalPage::_HandleSkipOutput(const IInspectable& /*sender*/,
+                                         const ActionEventArgs& args)
+    {
+        const auto res = _ApplyToActiveControls([](auto& control) {
+            control.SkipOutput();
+        });
+        args.Handled(res);
+    }
+
+    void TerminalPage::_HandleTogglePerformanceOverlay(const IInspectable& /*sender*/,
+                                                       const ActionEventArgs& args)
+    {
+        const auto res = _ApplyToActiveControls([](auto& control) {
+            control.TogglePerformanceOverlay();
+        });
+        args.Handled(res);
+    }
+
     void TerminalPage::_HandleToggleFocusMode(const IInspectable& /*sender*/,
                                               const ActionEventArgs& args)
     {
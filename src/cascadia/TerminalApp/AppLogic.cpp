@@ -302,10 +302,13 @@ namespace winrt::TerminalApp::implementation
         _ApplyLanguageSettingChange();
         _RefreshThemeRoutine();
         _ApplyStartupTaskStateChange();
+        _CalibrateRendererAsync();
 
         auto args = winrt::make_self<SystemMenuChangeArgs>(RS_(L"SettingsMenuItem"), SystemMenuChangeAction::Add, SystemMenuItemHandler(this, &AppLogic::_OpenSettingsUI));
         _SystemMenuChangeRequestedHandlers(*this, *args);
 
+        _created = true;
+
         TraceLoggingWrite(
             g_hTerminalAppProvider,
             "AppCreated",
@@ -1030,6 +1033,61 @@ namespace winrt::TerminalApp::implementation
     }
     CATCH_LOG();
 
+    // Method Description:
+    // - Runs the RendererCalibration, unless it already ran on this graphics
+    //   adapter and driver, and stores the result in the ApplicationState.
+    //   Terminals created after that use it, see TerminalSettings.
+    fire_and_forget AppLogic::_CalibrateRendererAsync()
+    try
+    {
+        // Software rendering applies to every profile, so
+        // if the user picked it, there's nothing to calibrate.
+        if (_settings.GlobalSettings().HasSoftwareRendering())
+        {
+            co_return;
+        }
+
+        // Give the window and its first terminal a head start, so that
+        // neither slows the other down while they're using the GPU.
+        co_await winrt::resume_after(std::chrono::seconds(5));
+
+        const auto adapterKey = RendererCalibration::AdapterKey();
+        if (adapterKey.empty())
+        {
+            co_return;
+        }
+
+        auto state = ApplicationState::SharedInstance();
+        const auto calibrations = state.RendererCalibrations();
+        if (calibrations && calibrations.HasKey(adapterKey))
+        {
+            co_return;
+        }
+
+        const auto configuration = RendererCalibration::Run();
+
+        // The results for other adapters are kept for those who switch between them.
+        auto updated = winrt::single_threaded_map<winrt::hstring, RendererConfiguration>();
+        if (calibrations)
+        {
+            for (const auto& [key, value] : calibrations)
+            {
+                updated.Insert(key, value);
+            }
+        }
+        updated.Insert(adapterKey, configuration);
+        state.RendererCalibrations(updated);
+
+        TraceLoggingWrite(
+            g_hTerminalAppProvider,
+            "RendererCalibrated",
+            TraceLoggingDescription("Event emitted when the fastest renderer for the graphics adapter was determined"),
+            TraceLoggingInt32(static_cast<int32_t>(configuration), "Configuration"),
+            TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
+            TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
+    }
+    CATCH_LOG();
+
     // Method Description:
     // - Reloads the settings from the settings.json file.
     void AppLogic::_ReloadSettings()
@@ -1041,6 +1099,14 @@ namespace winrt::TerminalApp::implementation
         //  - display a loading error
         _settingsLoadedResult = _TryLoadSettings();
 
+        // A standby window process (see AppHost) loads the settings long
+        // before it has any UI. Create() applies whatever we loaded last, and
+        // _OnLoaded displays the errors, if there are any.
+        if (!_created)
+        {
+            return;
+        }
+
         if (FAILED(_settingsLoadedResult))
         {
             const winrt::hstring titleKey = USES_RESOURCE(L"ReloadJsonParseErrorTitle");
@@ -1192,6 +1258,7 @@ namespace winrt::TerminalApp::implementation
             {
                 if (const auto layout = _root->GetWindowLayout())
                 {
+                    _root->PersistBuffers();
                     layout.InitialPosition(pos);
                     const auto state = ApplicationState::SharedInstance();
                     state.PersistedWindowLayouts(winrt::single_threaded_vector<WindowLayout>({ layout }));
@@ -1483,6 +1550,14 @@ namespace winrt::TerminalApp::implementation
         }
     }
 
+    void AppLogic::Minimized(bool newMinimized)
+    {
+        if (_root)
+        {
+            _root->Minimized(newMinimized);
+        }
+    }
+
     bool AppLogic::AlwaysOnTop() const
     {
         return _root ? _root->AlwaysOnTop() : false;
@@ -1538,6 +1613,7 @@ namespace winrt::TerminalApp::implementation
         {
             if (const auto layout = _root->GetWindowLayout())
             {
+                _root->PersistBuffers();
                 layout.InitialPosition(position);
                 return WindowLayout::ToJson(layout);
             }
@@ -1633,6 +1709,17 @@ namespace winrt::TerminalApp::implementation
         return _settings.GlobalSettings().AlwaysShowNotificationIcon();
     }
 
+    bool AppLogic::GetStandbyWindow()
+    {
+        if (!_loadedInitialSettings)
+        {
+            // Load settings if we haven't already
+            LoadSettings();
+        }
+
+        return _settings.GlobalSettings().StandbyWindow();
+    }
+
     bool AppLogic::GetShowTitleInTitlebar()
     {
         return _settings.GlobalSettings().ShowTitleInTitlebar();
@@ -78,6 +78,7 @@ namespace winrt::TerminalApp::implementation
         bool FocusMode() const;
         bool Fullscreen() const;
         void Maximized(bool newMaximized);
+        void Minimized(bool newMinimized);
         bool AlwaysOnTop() const;
 
         bool ShouldUsePersistedLayout();
@@ -119,6 +120,7 @@ namespace winrt::TerminalApp::implementation
 
         bool GetMinimizeToNotificationArea();
         bool GetAlwaysShowNotificationIcon();
+        bool GetStandbyWindow();
         bool GetShowTitleInTitlebar();
 
         winrt::Windows::Foundation::IAsyncOperation<winrt::Windows::UI::Xaml::Controls::ContentDialogResult> ShowDialog(winrt::Windows::UI::Xaml::Controls::ContentDialog dialog);
@@ -147,6 +149,7 @@ namespace winrt::TerminalApp::implementation
         winrt::hstring _settingsLoadExceptionText;
         HRESULT _settingsLoadedResult = S_OK;
         bool _loadedInitialSettings = false;
+        bool _created = false;
 
         uint64_t _numOpenWindows{ 0 };
 
@@ -174,6 +177,7 @@ namespace winrt::TerminalApp::implementation
         void _ApplyLanguageSettingChange() noexcept;
         void _RefreshThemeRoutine();
         fire_and_forget _ApplyStartupTaskStateChange();
+        fire_and_forget _CalibrateRendererAsync();
 
         void _OnLoaded(const IInspectable& sender, const Windows::UI::Xaml::RoutedEventArgs& eventArgs);
 
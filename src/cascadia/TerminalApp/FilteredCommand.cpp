@@ -24,7 +24,8 @@ namespace winrt::TerminalApp::implementation
     FilteredCommand::FilteredCommand(winrt::TerminalApp::PaletteItem const& item) :
         _Item(item),
         _Filter(L""),
-        _Weight(0)
+        _Weight(0),
+        _lowercaseName(_toLower(item.Name()))
     {
         _HighlightedName = _computeHighlightedName();
 
@@ -33,6 +34,7 @@ namespace winrt::TerminalApp::implementation
             auto filteredCommand{ weakThis.get() };
             if (filteredCommand && e.PropertyName() == L"Name")
             {
+                filteredCommand->_lowercaseName = _toLower(filteredCommand->_Item.Name());
                 filteredCommand->HighlightedName(filteredCommand->_computeHighlightedName());
                 filteredCommand->Weight(filteredCommand->_computeWeight());
             }
@@ -46,11 +48,54 @@ namespace winrt::TerminalApp::implementation
         if (filter != _Filter)
         {
             Filter(filter);
+
+            // Most commands don't match the filter at all, and aren't shown by the CommandPalette.
+            // Don't bother building their highlighted segments, which are thrown away again
+            // on the next keystroke. A later UpdateFilter() will recompute them once they match.
+            if (!_matchesFilter(_toLower(filter)))
+            {
+                Weight(0);
+                return;
+            }
+
             HighlightedName(_computeHighlightedName());
             Weight(_computeWeight());
         }
     }
 
+    // Function Description:
+    // - Lowercases the given text according to the user's locale. This doesn't
+    //   change the length of the text, so that its offsets still apply.
+    std::wstring FilteredCommand::_toLower(std::wstring_view text)
+    {
+        std::wstring result{ text };
+        if (!result.empty())
+        {
+            CharLowerBuffW(result.data(), gsl::narrow<DWORD>(result.size()));
+        }
+        return result;
+    }
+
+    // Method Description:
+    // - Returns true if all characters of the filter appear in the item name in
+    //   the same order. This is a much cheaper version of _computeHighlightedName().
+    // Arguments:
+    // - lowercaseFilter: the filter, lowercased with _toLower()
+    bool FilteredCommand::_matchesFilter(std::wstring_view lowercaseFilter) const noexcept
+    {
+        size_t offset = 0;
+        for (const auto searchChar : lowercaseFilter)
+        {
+            offset = _lowercaseName.find(searchChar, offset);
+            if (offset == std::wstring::npos)
+            {
+                return false;
+            }
+            ++offset;
+        }
+        return true;
+    }
+
     // Method Description:
     // - Looks up the filter characters within the item name.
     // Iterating through the filter and the item name it tries to associate the next filter character
@@ -78,9 +123,8 @@ namespace winrt::TerminalApp::implementation
         uint32_t nextOffsetToReport = 0;
         uint32_t currentOffset = 0;
 
-        for (const auto searchChar : _Filter)
+        for (const auto searchChar : _toLower(_Filter))
         {
-            const WCHAR searchCharAsString[] = { searchChar, L'\0' };
             while (true)
             {
                 if (currentOffset == commandName.size())
@@ -94,9 +138,8 @@ namespace winrt::TerminalApp::implementation
                 }
 
                 // GH#9941: search should be locale-aware as well
-                // We use the same comparison method as upon sorting to guarantee consistent behavior
-                const WCHAR currentCharAsString[] = { commandName[currentOffset], L'\0' };
-                auto isCurrentCharMatched = lstrcmpi(searchCharAsString, currentCharAsString) == 0;
+                // Both the name and the filter were lowercased according to the user's locale.
+                auto isCurrentCharMatched = til::at(_lowercaseName, currentOffset) == searchChar;
                 if (isProcessingMatchedSegment != isCurrentCharMatched)
                 {
                     // We reached the end of the region (matched character came after a series of unmatched or vice versa).
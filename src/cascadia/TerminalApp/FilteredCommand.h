@@ -30,8 +30,13 @@ namespace winrt::TerminalApp::implementation
         WINRT_OBSERVABLE_PROPERTY(int, Weight, _PropertyChangedHandlers);
 
     private:
+        static std::wstring _toLower(std::wstring_view text);
+        bool _matchesFilter(std::wstring_view lowercaseFilter) const noexcept;
         winrt::TerminalApp::HighlightedText _computeHighlightedName();
         int _computeWeight();
+
+        // The item name, lowercased once instead of for every filter character and keystroke.
+        std::wstring _lowercaseName;
         Windows::UI::Xaml::Data::INotifyPropertyChanged::PropertyChanged_revoker _itemChangedRevoker;
 
         friend class TerminalAppLocalTests::FilteredCommandTests;
@@ -140,6 +140,7 @@ NewTerminalArgs Pane::GetTerminalArgsForPane() const
     args.TabTitle(controlSettings.StartingTitle());
     args.Commandline(controlSettings.Commandline());
     args.SuppressApplicationTitle(controlSettings.SuppressApplicationTitle());
+    args.SessionId(_control.SessionId());
     if (controlSettings.TabColor() || controlSettings.StartingTabColor())
     {
         til::color c;
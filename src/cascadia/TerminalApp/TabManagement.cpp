@@ -882,6 +882,17 @@ namespace winrt::TerminalApp::implementation
             _tabContent.Children().Clear();
             _tabContent.Children().Append(tab.Content());
 
+            // Only the panes of the selected tab can be seen, so the other
+            // ones don't need to render until they're selected again.
+            // While the window is minimized, not even those. See Minimized().
+            for (const auto& otherTab : _tabs)
+            {
+                if (const auto terminalTab{ _GetTerminalTabImpl(otherTab) })
+                {
+                    terminalTab->SetVisible(otherTab == tab && !_isMinimized);
+                }
+            }
+
             // GH#7409: If the tab switcher is open, then we _don't_ want to
             // automatically focus the new tab here. The tab switcher wants
             // to be able to "preview" the selected tab as the user tabs
@@ -11,9 +11,9 @@
 #include <inc/WindowingBehavior.h>
 #include <LibraryResources.h>
 #include <TerminalCore/ControlKeyStates.hpp>
-#include <til/latch.h>
 
 #include "../../types/inc/utils.hpp"
+#include "../../types/inc/StartupTracing.hpp"
 #include "ColorHelper.h"
 #include "DebugTapConnection.h"
 #include "SettingsTab.h"
@@ -111,6 +111,10 @@ namespace winrt::TerminalApp::implementation
         if (needRefreshUI)
         {
             _RefreshUIForSettingsReload();
+
+            // The settings were reloaded, so the connections that the prewarmed
+            // conhosts were started for were meant for the old profiles.
+            _DiscardPrewarmedConnections();
         }
 
         // Upon settings update we reload the system settings for scrolling as well.
@@ -143,6 +147,8 @@ namespace winrt::TerminalApp::implementation
 
     void TerminalPage::Create()
     {
+        const ::Microsoft::Console::StartupTracing::Scope startupPhase{ ::Microsoft::Console::StartupTracing::Phase::CreatePage };
+
         // Hookup the key bindings
         _HookupKeyBindings(_settings.ActionMap());
 
@@ -530,6 +536,7 @@ namespace winrt::TerminalApp::implementation
                 }
             }
 
+            _PrewarmConnections(_startupActions);
             ProcessStartupActions(_startupActions, true);
 
             // If we were told that the COM server needs to be started to listen for incoming
@@ -541,6 +548,57 @@ namespace winrt::TerminalApp::implementation
         }
     }
 
+    // Routine Description:
+    // - Starts the conhosts for the panes that the given startup actions are
+    //   going to open in the background, so that they're ready by the time
+    //   their connections get started. The first pane doesn't need one, as
+    //   it's started right away.
+    // Arguments:
+    // - actions: the startup actions that are about to be processed
+    // Return Value:
+    // - <none>
+    void TerminalPage::_PrewarmConnections(const Windows::Foundation::Collections::IVector<ActionAndArgs>& actions)
+    {
+        if (!actions)
+        {
+            return;
+        }
+
+        uint32_t panes = 0;
+        for (const auto& action : actions)
+        {
+            if (action.Action() == ShortcutAction::NewTab || action.Action() == ShortcutAction::SplitPane)
+            {
+                ++panes;
+            }
+        }
+
+        if (panes > 1)
+        {
+            try
+            {
+                TerminalConnection::ConptyConnection::PrewarmPseudoConsoles(panes - 1);
+            }
+            CATCH_LOG();
+        }
+    }
+
+    // Routine Description:
+    // - Closes the conhosts that _PrewarmConnections started, but that no
+    //   connection claimed yet.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TerminalPage::_DiscardPrewarmedConnections()
+    {
+        try
+        {
+            TerminalConnection::ConptyConnection::DiscardPrewarmedPseudoConsoles();
+        }
+        CATCH_LOG();
+    }
+
     // Routine Description:
     // - Will start the listener for inbound console handoffs if we have already determined
     //   that we should do so.
@@ -590,6 +648,13 @@ namespace winrt::TerminalApp::implementation
     {
         auto weakThis{ get_weak() };
 
+        // Only the actions the window is created with are part of the startup.
+        std::optional<::Microsoft::Console::StartupTracing::Scope> startupPhase;
+        if (initial)
+        {
+            startupPhase.emplace(::Microsoft::Console::StartupTracing::Phase::StartupActions);
+        }
+
         // Handle it on a subsequent pass of the UI thread.
         co_await winrt::resume_foreground(Dispatcher(), CoreDispatcherPriority::Normal);
 
@@ -1079,6 +1144,13 @@ namespace winrt::TerminalApp::implementation
                                                                                        winrt::guid()));
         }
 
+        else if (connectionType == TerminalConnection::ReplayConnection::ConnectionType())
+        {
+            // The commandline of a replay profile is the path to the recording.
+            connection = TerminalConnection::ReplayConnection();
+            connection.Initialize(TerminalConnection::ReplayConnection::CreateSettings(settings.Commandline(), true));
+        }
+
         else
         {
             // profile is guaranteed to exist here
@@ -1139,6 +1211,45 @@ namespace winrt::TerminalApp::implementation
         return connection;
     }
 
+    // Method Description:
+    // - Wraps the given connection in a RecordingConnection, which records the
+    //   session into a new file in the given directory.
+    // Arguments:
+    // - connection: the connection to record
+    // - directory: the directory for the recording. It's created if necessary.
+    // Return Value:
+    // - The connection to use instead of the given one. If the recording
+    //   can't be created, that's the given connection itself.
+    TerminalConnection::ITerminalConnection TerminalPage::_RecordConnection(const TerminalConnection::ITerminalConnection& connection,
+                                                                            const winrt::hstring& directory)
+    try
+    {
+        // Multiple windows can share this process, so the counter needs to be atomic.
+        static std::atomic<uint32_t> s_recordingCount{ 0 };
+
+        SYSTEMTIME time{};
+        GetLocalTime(&time);
+
+        std::filesystem::path path{ wil::ExpandEnvironmentStringsW<std::wstring>(directory.c_str()) };
+        std::filesystem::create_directories(path);
+        path /= fmt::format(L"{:04}-{:02}-{:02}_{:02}-{:02}-{:02}_{}_{}.wtrec",
+                            time.wYear,
+                            time.wMonth,
+                            time.wDay,
+                            time.wHour,
+                            time.wMinute,
+                            time.wSecond,
+                            GetCurrentProcessId(),
+                            s_recordingCount.fetch_add(1, std::memory_order_relaxed));
+
+        return TerminalConnection::RecordingConnection{ connection, winrt::hstring{ path.wstring() } };
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return connection;
+    }
+
     // Method Description:
     // - Called when the settings button is clicked. Launches a background
     //   thread to open the settings file in the default JSON editor.
@@ -1657,6 +1768,38 @@ namespace winrt::TerminalApp::implementation
         return layout;
     }
 
+    // Method Description:
+    // - Saves the buffer of every pane, so that the panes of the window layout
+    //   that GetWindowLayout() returns show their contents again once the layout
+    //   is restored. Failing to save one of them doesn't keep the others from
+    //   being saved, that pane just starts out empty.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TerminalPage::PersistBuffers()
+    {
+        for (const auto& tab : _tabs)
+        {
+            const auto terminalTab{ _GetTerminalTabImpl(tab) };
+            if (!terminalTab)
+            {
+                continue;
+            }
+
+            terminalTab->GetRootPane()->WalkTree([](const auto& pane) {
+                if (const auto control = pane->GetTerminalControl())
+                {
+                    try
+                    {
+                        control.PersistBuffer(_GetPersistedBufferPath(control.SessionId()));
+                    }
+                    CATCH_LOG();
+                }
+            });
+        }
+    }
+
     // Method Description:
     // - Close the terminal app. If there is more
     //   than one tab opened, show a warning dialog.
@@ -1689,6 +1832,7 @@ namespace winrt::TerminalApp::implementation
             _maintainStateOnTabClose = true;
         }
 
+        _DiscardPrewarmedConnections();
         _RemoveAllTabs();
     }
 
@@ -2416,6 +2560,21 @@ namespace winrt::TerminalApp::implementation
         return term;
     }
 
+    // Method Description:
+    // - Returns the file that the buffer of the pane with the given session ID
+    //   is saved into when the window layout is persisted.
+    // Arguments:
+    // - sessionId: the SessionId of the control of the pane
+    // Return Value:
+    // - the path of the file
+    std::wstring TerminalPage::_GetPersistedBufferPath(const winrt::guid& sessionId)
+    {
+        // They're kept next to the settings, just like the rest of the persisted state.
+        const std::filesystem::path settingsPath{ std::wstring_view{ CascadiaSettings::SettingsPath() } };
+        const auto fileName = fmt::format(L"buffer_{}.bin", ::Microsoft::Console::Utils::GuidToString(sessionId));
+        return (settingsPath.parent_path() / fileName).wstring();
+    }
+
     // Method Description:
     // - Creates a pane and returns a shared_ptr to it
     // - The caller should handle where the pane goes after creation,
@@ -2477,6 +2636,11 @@ namespace winrt::TerminalApp::implementation
             connection.Resize(controlSettings.DefaultSettings().InitialRows(), controlSettings.DefaultSettings().InitialCols());
         }
 
+        if (const auto recordingDirectory{ _settings.GlobalSettings().SessionRecordingDirectory() }; !recordingDirectory.empty())
+        {
+            connection = _RecordConnection(connection, recordingDirectory);
+        }
+
         TerminalConnection::ITerminalConnection debugConnection{ nullptr };
         if (_settings.GlobalSettings().DebugFeaturesEnabled())
         {
@@ -2494,6 +2658,19 @@ namespace winrt::TerminalApp::implementation
         const auto control = _InitControl(controlSettings, connection);
         _RegisterTerminalEvents(control);
 
+        // A pane of a persisted window layout gets its buffer back. Only panes
+        // that actually had their buffer saved keep the ID, so that duplicating
+        // one of them doesn't make two panes save into the same file.
+        if (newTerminalArgs && newTerminalArgs.SessionId() != winrt::guid{})
+        {
+            const auto path = _GetPersistedBufferPath(newTerminalArgs.SessionId());
+            if (std::filesystem::exists(path))
+            {
+                control.SessionId(newTerminalArgs.SessionId());
+                control.RestoreBuffer(path);
+            }
+        }
+
         auto resultPane = std::make_shared<Pane>(profile, control);
 
         if (debugConnection) // this will only be set if global debugging is on and tap is active
@@ -3061,6 +3238,28 @@ namespace winrt::TerminalApp::implementation
         _isMaximized = newMaximized;
     }
 
+    // Method Description:
+    // - Updates the page's state for isMinimized when the window changes externally.
+    //   Nobody can see the panes of a minimized window, so they stop rendering,
+    //   just like those of the tabs that aren't selected.
+    void TerminalPage::Minimized(bool newMinimized)
+    {
+        if (_isMinimized == newMinimized)
+        {
+            return;
+        }
+        _isMinimized = newMinimized;
+
+        const auto focusedTab{ _GetFocusedTab() };
+        for (const auto& tab : _tabs)
+        {
+            if (const auto terminalTab{ _GetTerminalTabImpl(tab) })
+            {
+                terminalTab->SetVisible(!_isMinimized && tab == focusedTab);
+            }
+        }
+    }
+
     // Method Description:
     // - Asks the window to change its maximized state.
     void TerminalPage::RequestSetMaximized(bool newMaximized)
@@ -3077,20 +3276,22 @@ namespace winrt::TerminalApp::implementation
     {
         // We need to be on the UI thread in order for _OpenNewTab to run successfully.
         // HasThreadAccess will return true if we're currently on a UI thread and false otherwise.
-        // When we're on a COM thread, we'll need to dispatch the calls to the UI thread
-        // and wait on it hence the locking mechanism.
+        // When we're on a COM thread, we'll need to dispatch the calls to the UI thread.
+        //
+        // The console client is held up until the handoff returns, so we don't
+        // wait for the tab to be created: the connection already owns the pipes,
+        // and the output of the client waits in them until the control starts
+        // reading. If creating the tab fails, the connection is released and
+        // the pipes break, which ends the client just like a failed handoff.
         if (!Dispatcher().HasThreadAccess())
         {
-            til::latch latch{ 1 };
-            HRESULT finalVal = S_OK;
-
-            Dispatcher().RunAsync(CoreDispatcherPriority::Normal, [&]() {
-                finalVal = _OnNewConnection(connection);
-                latch.count_down();
+            Dispatcher().RunAsync(CoreDispatcherPriority::Normal, [weakThis = get_weak(), connection]() {
+                if (const auto page = weakThis.get())
+                {
+                    LOG_IF_FAILED(page->_OnNewConnection(connection));
+                }
             });
-
-            latch.wait();
-            return finalVal;
+            return S_OK;
         }
 
         try
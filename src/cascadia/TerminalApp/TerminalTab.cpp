@@ -17,6 +17,10 @@ using namespace winrt::Microsoft::Terminal::Control;
 using namespace winrt::Microsoft::Terminal::Settings::Model;
 using namespace winrt::Windows::System;
 
+// The minimum delay between updating the title and progress ring in the tab header,
+// in response to changes of the controls. Each update relayouts the tab row.
+constexpr const auto TabHeaderUpdateInterval = std::chrono::milliseconds(100);
+
 namespace winrt
 {
     namespace MUX = Microsoft::UI::Xaml;
@@ -75,6 +79,20 @@ namespace winrt::TerminalApp::implementation
             _ClosedHandlers(nullptr, nullptr);
         });
 
+        const auto dispatcher = DispatcherQueue::GetForCurrentThread();
+        _updateTitle = std::make_shared<ThrottledFuncTrailing<>>(dispatcher, TabHeaderUpdateInterval, [weakThis = get_weak()]() {
+            if (auto tab{ weakThis.get() })
+            {
+                tab->UpdateTitle();
+            }
+        });
+        _updateProgressState = std::make_shared<ThrottledFuncTrailing<>>(dispatcher, TabHeaderUpdateInterval, [weakThis = get_weak()]() {
+            if (auto tab{ weakThis.get() })
+            {
+                tab->_UpdateProgressState();
+            }
+        });
+
         Content(_rootPane->GetRootElement());
 
         _MakeTabViewItem();
@@ -548,6 +566,7 @@ namespace winrt::TerminalApp::implementation
         // possible that the focus events won't propagate immediately. Updating
         // the focus here will give the same effect though.
         _UpdateActivePane(newPane);
+        _UpdatePaneVisibility();
     }
 
     // Method Description:
@@ -646,6 +665,7 @@ namespace winrt::TerminalApp::implementation
         {
             _UpdateActivePane(focus);
         }
+        _UpdatePaneVisibility();
     }
 
     // Method Description:
@@ -841,7 +861,6 @@ namespace winrt::TerminalApp::implementation
     void TerminalTab::_AttachEventHandlersToControl(const uint32_t paneId, const TermControl& control)
     {
         auto weakThis{ get_weak() };
-        auto dispatcher = TabViewItem().Dispatcher();
         ControlEventTokens events{};
 
         events.titleToken = control.TitleChanged([weakThis](auto&&, auto&&) {
@@ -850,7 +869,7 @@ namespace winrt::TerminalApp::implementation
             {
                 // The title of the control changed, but not necessarily the title of the tab.
                 // Set the tab's text to the active panes' text.
-                tab->UpdateTitle();
+                tab->_updateTitle->Run();
             }
         });
 
@@ -864,12 +883,11 @@ namespace winrt::TerminalApp::implementation
             }
         });
 
-        events.taskbarToken = control.SetTaskbarProgress([dispatcher, weakThis](auto&&, auto &&) -> winrt::fire_and_forget {
-            co_await winrt::resume_foreground(dispatcher);
+        events.taskbarToken = control.SetTaskbarProgress([weakThis](auto&&, auto&&) {
             // Check if Tab's lifetime has expired
             if (auto tab{ weakThis.get() })
             {
-                tab->_UpdateProgressState();
+                tab->_updateProgressState->Run();
             }
         });
 
@@ -1582,6 +1600,7 @@ namespace winrt::TerminalApp::implementation
         _zoomedPane = newFocus;
         _rootPane->Maximize(_zoomedPane);
         Content(_zoomedPane->GetRootElement());
+        _UpdatePaneVisibility();
     }
 
     // Method Description:
@@ -1618,6 +1637,7 @@ namespace winrt::TerminalApp::implementation
         // Update the tab header to show the magnifying glass
         _tabStatus.IsPaneZoomed(true);
         Content(_zoomedPane->GetRootElement());
+        _UpdatePaneVisibility();
     }
     void TerminalTab::ExitZoom()
     {
@@ -1627,6 +1647,52 @@ namespace winrt::TerminalApp::implementation
         // Update the tab header to hide the magnifying glass
         _tabStatus.IsPaneZoomed(false);
         Content(_rootPane->GetRootElement());
+        _UpdatePaneVisibility();
+    }
+
+    // Method Description:
+    // - Tells the panes of this tab whether they can be seen, which is the case
+    //   if this is the selected tab. The panes of other tabs don't render.
+    // Arguments:
+    // - visible: true if this tab is the selected one
+    // Return Value:
+    // - <none>
+    void TerminalTab::SetVisible(const bool visible)
+    {
+        _visible = visible;
+        _UpdatePaneVisibility();
+    }
+
+    // Method Description:
+    // - Lets the controls of all panes know whether they can be seen. While the
+    //   tab is zoomed, only the panes of the zoomed one can.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TerminalTab::_UpdatePaneVisibility()
+    {
+        if (!_rootPane)
+        {
+            return;
+        }
+
+        _rootPane->WalkTree([&](auto pane) {
+            if (const auto control{ pane->GetTerminalControl() })
+            {
+                control.SetVisible(_visible && !_zoomedPane);
+            }
+        });
+
+        if (_visible && _zoomedPane)
+        {
+            _zoomedPane->WalkTree([](auto pane) {
+                if (const auto control{ pane->GetTerminalControl() })
+                {
+                    control.SetVisible(true);
+                }
+            });
+        }
     }
 
     bool TerminalTab::IsZoomed()
@@ -7,6 +7,8 @@
 #include "TabBase.h"
 #include "TerminalTab.g.h"
 
+#include <ThrottledFunc.h>
+
 static constexpr double HeaderRenameBoxWidthDefault{ 165 };
 static constexpr double HeaderRenameBoxWidthTitleLength{ std::numeric_limits<double>::infinity() };
 
@@ -80,6 +82,7 @@ namespace winrt::TerminalApp::implementation
         bool IsZoomed();
         void EnterZoom();
         void ExitZoom();
+        void SetVisible(const bool visible);
 
         std::vector<Microsoft::Terminal::Settings::Model::ActionAndArgs> BuildStartupActions() const override;
 
@@ -117,6 +120,12 @@ namespace winrt::TerminalApp::implementation
         winrt::TerminalApp::TabHeaderControl _headerControl{};
         winrt::TerminalApp::TerminalTabStatus _tabStatus{};
 
+        // The title and progress of a control may change many times a second,
+        // for instance when a shell puts the running command into the title.
+        // These update the tab header for those at most every TabHeaderUpdateInterval.
+        std::shared_ptr<ThrottledFuncTrailing<>> _updateTitle;
+        std::shared_ptr<ThrottledFuncTrailing<>> _updateProgressState;
+
         struct ControlEventTokens
         {
             winrt::event_token titleToken;
@@ -135,6 +144,7 @@ namespace winrt::TerminalApp::implementation
         bool _receivedKeyDown{ false };
         bool _iconHidden{ false };
         bool _changingActivePane{ false };
+        bool _visible{ true };
 
         winrt::hstring _runtimeTabText{};
         bool _inRename{ false };
@@ -161,6 +171,7 @@ namespace winrt::TerminalApp::implementation
         void _AttachEventHandlersToPane(std::shared_ptr<Pane> pane);
 
         void _UpdateActivePane(std::shared_ptr<Pane> pane);
+        void _UpdatePaneVisibility();
 
         winrt::hstring _GetActiveTitle() const;
 
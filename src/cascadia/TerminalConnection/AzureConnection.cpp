@@ -33,11 +33,43 @@ static constexpr int USER_INFO_COLOR = 97; // white - the color of clarifying in
 
 static constexpr winrt::guid AzureConnectionType = { 0xd9fcfdfa, 0xa479, 0x412c, { 0x83, 0xb7, 0xc5, 0x64, 0xe, 0x61, 0xcd, 0x62 } };
 
+// Websocket frames that already arrived are passed on in a single TerminalOutput event, up to this many characters.
+static constexpr size_t OutputCoalesceLimit = 256 * 1024;
+// Once that much output came in at once, the session is busy printing and
+// we wait up to OutputCoalesceWindow for further frames. Interactive output
+// (like the echo of a keystroke) is smaller and is passed on right away.
+static constexpr size_t OutputBulkThreshold = 4 * 1024;
+static constexpr auto OutputCoalesceWindow = std::chrono::milliseconds(8);
+// Typed input is sent at most this long after it was typed, along with everything typed in the meantime.
+static constexpr auto InputBatchLatency = std::chrono::milliseconds(5);
+
 static inline std::wstring _colorize(const unsigned int colorCode, const std::wstring_view text)
 {
     return fmt::format(L"\x1b[{0}m{1}\x1b[m", colorCode, text);
 }
 
+// Waits until the websocket receive completed or the deadline passed, whichever comes first.
+static bool _waitForReceive(const pplx::task<websocket_incoming_message>& task, const std::chrono::steady_clock::time_point deadline)
+{
+    if (task.is_done())
+    {
+        return true;
+    }
+
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0)
+    {
+        return false;
+    }
+
+    // The continuation may run after we stopped waiting, which is why it shares the ownership of the event.
+    const auto done = std::make_shared<wil::unique_event>(wil::EventOptions::ManualReset);
+    task.then([done](pplx::task<websocket_incoming_message>) {
+        done->SetEvent();
+    });
+    return done->wait(gsl::narrow_cast<DWORD>(remaining.count()));
+}
+
 // Takes N resource names, loads the first one as a format string, and then
 // loads all the remaining ones into the %s arguments in the first one after
 // colorizing them in the USER_INPUT_COLOR.
@@ -184,11 +216,12 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         if (_state == AzureState::TermConnected)
         {
             // If we're connected, we don't need to do any fun input shenanigans.
-            websocket_outgoing_message msg;
-            const auto str = winrt::to_string(data);
-            msg.set_utf8_message(str);
-
-            _cloudShellSocket.send(msg).get();
+            // The input is only queued up here. See _SendQueuedInput().
+            {
+                const std::lock_guard lock{ _outgoingMutex };
+                _outgoingInput.append(winrt::to_string(data));
+            }
+            (*_sendQueuedInput)();
             return;
         }
 
@@ -223,6 +256,32 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         }
     }
 
+    // Method description:
+    // - Sends the input that was typed since the last call as a single websocket
+    //   message. WriteInput() calls this through _sendQueuedInput, at most
+    //   InputBatchLatency after the first keystroke, so that typing quickly
+    //   doesn't send a message for every single key. Neither does the UI thread
+    //   have to wait for the websocket anymore.
+    void AzureConnection::_SendQueuedInput()
+    try
+    {
+        // Timer callbacks can overlap. Holding this lock while sending keeps the messages in order.
+        const std::lock_guard sendLock{ _sendMutex };
+
+        websocket_outgoing_message msg;
+        {
+            const std::lock_guard lock{ _outgoingMutex };
+            if (_outgoingInput.empty())
+            {
+                return;
+            }
+            msg.set_utf8_message(std::exchange(_outgoingInput, {}));
+        }
+
+        _cloudShellSocket.send(msg).get();
+    }
+    CATCH_LOG();
+
     // Method description:
     // - ascribes to the ITerminalConnection interface
     // - resizes the terminal
@@ -382,13 +441,17 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 case AzureState::TermConnected:
                 {
                     _transitionToState(ConnectionState::Connected);
+
+                    // A receive that didn't complete before the last coalescing window ended.
+                    std::optional<pplx::task<websocket_incoming_message>> pendingReceive;
+                    std::wstring output;
                     while (true)
                     {
                         // Read from websocket
                         pplx::task<websocket_incoming_message> msgT;
                         try
                         {
-                            msgT = _cloudShellSocket.receive();
+                            msgT = pendingReceive ? *std::exchange(pendingReceive, std::nullopt) : _cloudShellSocket.receive();
                             msgT.wait();
                         }
                         catch (...)
@@ -402,15 +465,36 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                             }
                         }
 
-                        auto msg = msgT.get();
-                        auto msgStringTask = msg.extract_string();
-                        auto msgString = msgStringTask.get();
+                        output = til::u8u16(msgT.get().extract_string().get());
 
-                        // Convert to hstring
-                        const auto hstr = winrt::to_hstring(msgString);
+                        // Every TerminalOutput event costs a parse and an acquisition of the
+                        // terminal lock, so the frames that follow are coalesced into this one.
+                        const auto deadline = std::chrono::steady_clock::now() + OutputCoalesceWindow;
+                        while (output.size() < OutputCoalesceLimit)
+                        {
+                            auto next = _cloudShellSocket.receive();
+                            const auto ready = output.size() >= OutputBulkThreshold ? _waitForReceive(next, deadline) : next.is_done();
+                            if (!ready)
+                            {
+                                pendingReceive = std::move(next);
+                                break;
+                            }
+
+                            try
+                            {
+                                output.append(til::u8u16(next.get().extract_string().get()));
+                            }
+                            catch (...)
+                            {
+                                // The websocket was closed. We pass on what we have,
+                                // and the next iteration handles the closure.
+                                pendingReceive = std::move(next);
+                                break;
+                            }
+                        }
 
                         // Pass the output to our registered event handlers
-                        _TerminalOutputHandlers(hstr);
+                        _TerminalOutputHandlers(output);
                     }
                     return S_OK;
                 }
@@ -738,6 +822,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         const auto connReqTask = _cloudShellSocket.connect(socketUri);
         connReqTask.wait();
 
+        _sendQueuedInput = std::make_unique<til::throttled_func_trailing<>>(InputBatchLatency, [this]() { _SendQueuedInput(); });
         _state = AzureState::TermConnected;
 
         std::wstring queuedUserInput{};
@@ -10,6 +10,7 @@
 #include <cpprest/ws_client.h>
 #include <mutex>
 #include <condition_variable>
+#include <til/throttled_func.h>
 
 #include "ConnectionStateHolder.h"
 #include "AzureClient.h"
@@ -97,6 +98,15 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         web::websockets::client::websocket_client _cloudShellSocket;
 
+        // Input for the websocket, waiting for _SendQueuedInput().
+        std::string _outgoingInput;
+        std::mutex _outgoingMutex;
+        std::mutex _sendMutex;
+        // Destroyed before _cloudShellSocket, which waits for any callback that's still running.
+        std::unique_ptr<til::throttled_func_trailing<>> _sendQueuedInput;
+
+        void _SendQueuedInput();
+
         static std::optional<utility::string_t> _ParsePreferredShellType(const web::json::value& settingsResponse);
     };
 }
@@ -12,6 +12,8 @@
 
 #include "../../types/inc/utils.hpp"
 #include "../../types/inc/Environment.hpp"
+#include "../../types/inc/AllocationTracking.hpp"
+#include "../../types/inc/StartupTracing.hpp"
 #include "LibraryResources.h"
 
 using namespace ::Microsoft::Console;
@@ -20,6 +22,10 @@ using namespace std::string_view_literals;
 // Format is: "DecimalResult (HexadecimalForm)"
 static constexpr auto _errorFormat = L"{0} ({0:#010x})"sv;
 
+// Input is written to the pipe in chunks of up to this many characters, so that
+// a large paste can be cancelled, and isn't converted to UTF-8 all at once.
+static constexpr size_t InputChunkSize = 64 * 1024;
+
 // Notes:
 // There is a number of ways that the Conpty connection can be terminated (voluntarily or not):
 // 1. The connection is Close()d
@@ -38,14 +44,19 @@ static constexpr auto _errorFormat = L"{0} ({0:#010x})"sv;
 namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 {
     // Function Description:
-    // - creates some basic anonymous pipes and passes them to CreatePseudoConsole
+    // - creates the pipes of a new conpty and passes them to CreatePseudoConsole
+    // - The input pipe is an anonymous pipe. Our end of the output pipe is opened
+    //   for overlapped reads, for the shared reader (see _outputReaderEnvironment),
+    //   which anonymous pipes don't support. It's a named pipe with a unique name
+    //   for that reason.
     // Arguments:
     // - size: The size of the conpty to create, in characters.
     // - phInput: Receives the handle to the newly-created anonymous pipe for writing input to the conpty.
-    // - phOutput: Receives the handle to the newly-created anonymous pipe for reading the output of the conpty.
+    // - phOutput: Receives the handle to the newly-created overlapped pipe for reading the output of the conpty.
     // - phPc: Receives a token value to identify this conpty
 #pragma warning(suppress : 26430) // This statement sufficiently checks the out parameters. Analyzer cannot find this.
     static HRESULT _CreatePseudoConsoleAndPipes(const COORD size, const DWORD dwFlags, HANDLE* phInput, HANDLE* phOutput, HPCON* phPC) noexcept
+    try
     {
         RETURN_HR_IF(E_INVALIDARG, phPC == nullptr || phInput == nullptr || phOutput == nullptr);
 
@@ -53,12 +64,160 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         wil::unique_hfile inPipeOurSide, inPipePseudoConsoleSide;
 
         RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(&inPipePseudoConsoleSide, &inPipeOurSide, nullptr, 0));
-        RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(&outPipeOurSide, &outPipePseudoConsoleSide, nullptr, 0));
+        // The output pipe gets a larger buffer than the default, so that conpty can
+        // keep writing the next chunk while we're still busy parsing the last one.
+        constexpr DWORD outPipeSize = 128 * 1024;
+        const auto outPipeName = fmt::format(L"\\\\.\\pipe\\WindowsTerminal.Output.{}", Utils::GuidToString(Utils::CreateGuid()));
+        // FILE_FLAG_FIRST_PIPE_INSTANCE makes sure that nobody else created the pipe before us.
+        outPipeOurSide.reset(CreateNamedPipeW(outPipeName.c_str(),
+                                              PIPE_ACCESS_INBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                              PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                              1,
+                                              0,
+                                              outPipeSize,
+                                              0,
+                                              nullptr));
+        RETURN_LAST_ERROR_IF(!outPipeOurSide);
+        outPipePseudoConsoleSide.reset(CreateFileW(outPipeName.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr));
+        RETURN_LAST_ERROR_IF(!outPipePseudoConsoleSide);
+
         RETURN_IF_FAILED(ConptyCreatePseudoConsole(size, inPipePseudoConsoleSide.get(), outPipePseudoConsoleSide.get(), dwFlags, phPC));
         *phInput = inPipeOurSide.release();
         *phOutput = outPipeOurSide.release();
         return S_OK;
     }
+    CATCH_RETURN()
+
+    // The output of the connections of this process is read on the threads of
+    // this pool, with overlapped reads, instead of on a thread per connection.
+    // A window with a hundred panes would otherwise have a hundred threads that
+    // are blocked in ReadFile most of the time, each with its own stack.
+    // The pool has as many threads as there are cores. Every callback handles a
+    // single read of at most MaximumBufferSize bytes, and only then starts the
+    // next read of its connection. As the completion port queues the reads in
+    // the order in which they complete, connections with a lot of output take
+    // turns, instead of a single one of them keeping the pool busy.
+    //
+    // Just like the pool of prewarmed pseudoconsoles, this is intentionally leaked.
+    static PTP_CALLBACK_ENVIRON _outputReaderEnvironment()
+    {
+        static const auto environment = []() {
+            const auto pool = CreateThreadpool(nullptr);
+            THROW_LAST_ERROR_IF_NULL(pool);
+            SetThreadpoolThreadMaximum(pool, std::max(std::thread::hardware_concurrency(), 2u));
+            LOG_IF_WIN32_BOOL_FALSE(SetThreadpoolThreadMinimum(pool, 1));
+
+            const auto env = new TP_CALLBACK_ENVIRON;
+            InitializeThreadpoolEnvironment(env);
+            SetThreadpoolCallbackPool(env, pool);
+            return env;
+        }();
+        return environment;
+    }
+
+    // Pseudoconsoles that were created ahead of time by PrewarmPseudoConsoles(),
+    // so that the connections of a restored session with many panes don't each
+    // have to wait for a conhost to start up. They're idle until a connection
+    // claims one in Start(), resizes it, and launches its client in it.
+    // The ones that weren't claimed within PrewarmedPseudoConsoleIdleTimeout
+    // are closed again, as are all of them in DiscardPrewarmedPseudoConsoles().
+    //
+    // The pool is intentionally leaked: tearing down a pseudoconsole blocks
+    // until its conhost exited, which we must not do during DLL unload.
+    // The conhosts exit on their own once our ends of their pipes are closed.
+    struct PrewarmedPseudoConsole
+    {
+        wil::unique_hfile inPipe;
+        wil::unique_hfile outPipe;
+        wil::unique_static_pseudoconsole_handle hPC;
+        std::chrono::steady_clock::time_point created;
+    };
+
+    static constexpr DWORD DefaultPseudoConsoleFlags = PSEUDOCONSOLE_RESIZE_QUIRK | PSEUDOCONSOLE_WIN32_INPUT_MODE;
+    static constexpr size_t MaxPrewarmedPseudoConsoles = 8;
+    static constexpr COORD PrewarmedPseudoConsoleSize{ 80, 25 };
+    static constexpr std::chrono::seconds PrewarmedPseudoConsoleIdleTimeout{ 30 };
+
+    static til::shared_mutex<std::vector<PrewarmedPseudoConsole>>& _prewarmedPseudoConsoles()
+    {
+        static auto& pool = *new til::shared_mutex<std::vector<PrewarmedPseudoConsole>>{};
+        return pool;
+    }
+
+    // Function Description:
+    // - Takes a pseudoconsole out of the pool, if there's one.
+    // Return Value:
+    // - The pseudoconsole, or std::nullopt if the pool is empty.
+    static std::optional<PrewarmedPseudoConsole> _claimPrewarmedPseudoConsole()
+    {
+        auto pool = _prewarmedPseudoConsoles().lock();
+        if (pool->empty())
+        {
+            return std::nullopt;
+        }
+        auto entry = std::move(pool->back());
+        pool->pop_back();
+        return entry;
+    }
+
+    static void _discardPrewarmedPseudoConsoles(const bool all) noexcept;
+
+    // Function Description:
+    // - Makes the pool close the pseudoconsoles that have been idle for too long, after the given delay.
+    // Arguments:
+    // - delay: the time until the oldest pseudoconsole in the pool expires
+    static void _schedulePrewarmedPseudoConsoleExpiry(const std::chrono::steady_clock::duration delay) noexcept
+    {
+        // Leaked along with the pool.
+        static const auto timer = CreateThreadpoolTimer(
+            [](PTP_CALLBACK_INSTANCE, PVOID, PTP_TIMER) noexcept {
+                _discardPrewarmedPseudoConsoles(false);
+            },
+            nullptr,
+            nullptr);
+        if (!timer)
+        {
+            LOG_LAST_ERROR();
+            return;
+        }
+
+        // A negative due time is relative to now, in 100ns units.
+        const auto ticks = std::chrono::duration_cast<std::chrono::duration<int64_t, std::ratio<1, 10000000>>>(delay).count();
+        ULARGE_INTEGER dueTime;
+        dueTime.QuadPart = static_cast<ULONGLONG>(-std::max<int64_t>(ticks, 1));
+        FILETIME fileTime{ dueTime.LowPart, dueTime.HighPart };
+        SetThreadpoolTimer(timer, &fileTime, 0, 0);
+    }
+
+    // Function Description:
+    // - Closes the pseudoconsoles in the pool that have been idle for longer than
+    //   PrewarmedPseudoConsoleIdleTimeout, or all of them.
+    // - Closing a pseudoconsole waits for its conhost to exit, so this is only
+    //   ever called on the thread pool.
+    // Arguments:
+    // - all: whether to close the ones that haven't expired yet as well
+    static void _discardPrewarmedPseudoConsoles(const bool all) noexcept
+    try
+    {
+        std::vector<PrewarmedPseudoConsole> discarded;
+        {
+            auto pool = _prewarmedPseudoConsoles().lock();
+            // The pool is in the order the pseudoconsoles were created in, so the oldest ones are in front.
+            const auto now = std::chrono::steady_clock::now();
+            const auto end = all ? pool->end() : std::find_if(pool->begin(), pool->end(), [&](const auto& entry) {
+                return now - entry.created < PrewarmedPseudoConsoleIdleTimeout;
+            });
+            discarded.insert(discarded.end(), std::make_move_iterator(pool->begin()), std::make_move_iterator(end));
+            pool->erase(pool->begin(), end);
+
+            if (!pool->empty())
+            {
+                _schedulePrewarmedPseudoConsoleExpiry(pool->front().created + PrewarmedPseudoConsoleIdleTimeout - now);
+            }
+        }
+        // The discarded pseudoconsoles are closed here, outside of the lock.
+    }
+    CATCH_LOG()
 
     // Function Description:
     // - launches the client application attached to the new pseudoconsole
@@ -208,7 +367,8 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         _initialCols{ 80 },
         _guid{ Utils::CreateGuid() },
         _inPipe{ hIn },
-        _outPipe{ hOut }
+        _outPipe{ hOut },
+        _overlappedOutput{ false } // We don't know how the handed off pipes were opened.
     {
         THROW_IF_FAILED(ConptyPackPseudoConsole(hServerProcess, hRef, hSig, &_hPC));
         _piClient.hProcess = hClientProcess;
@@ -220,6 +380,12 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         CATCH_LOG()
     }
 
+    ConptyConnection::~ConptyConnection()
+    {
+        // Close() stops the input thread already, but the connection might not have been closed.
+        _StopInputThread();
+    }
+
     // Function Description:
     // - Helper function for constructing a ValueSet that we can use to get our settings from.
     Windows::Foundation::Collections::ValueSet ConptyConnection::CreateSettings(const winrt::hstring& cmdline,
@@ -265,6 +431,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             _initialRows = winrt::unbox_value_or<uint32_t>(settings.TryLookup(L"initialRows").try_as<Windows::Foundation::IPropertyValue>(), _initialRows);
             _initialCols = winrt::unbox_value_or<uint32_t>(settings.TryLookup(L"initialCols").try_as<Windows::Foundation::IPropertyValue>(), _initialCols);
             _guid = winrt::unbox_value_or<winrt::guid>(settings.TryLookup(L"guid").try_as<Windows::Foundation::IPropertyValue>(), _guid);
+            _compressOutput = winrt::unbox_value_or<bool>(settings.TryLookup(L"compressOutput").try_as<Windows::Foundation::IPropertyValue>(), _compressOutput);
             _environment = settings.TryLookup(L"environment").try_as<Windows::Foundation::Collections::ValueSet>();
         }
 
@@ -287,6 +454,8 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
     void ConptyConnection::Start()
     try
     {
+        const ::Microsoft::Console::StartupTracing::Scope startupPhase{ ::Microsoft::Console::StartupTracing::Phase::FirstConnection };
+
         _transitionToState(ConnectionState::Connecting);
 
         const COORD dimensions{ gsl::narrow_cast<SHORT>(_initialCols), gsl::narrow_cast<SHORT>(_initialRows) };
@@ -295,7 +464,37 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         // handoff from an already-started PTY process.
         if (!_inPipe)
         {
-            THROW_IF_FAILED(_CreatePseudoConsoleAndPipes(dimensions, PSEUDOCONSOLE_RESIZE_QUIRK | PSEUDOCONSOLE_WIN32_INPUT_MODE, &_inPipe, &_outPipe, &_hPC));
+            DWORD flags = DefaultPseudoConsoleFlags;
+            if (_compressOutput)
+            {
+                // Only ask for compressed output if we're able to decompress it.
+                try
+                {
+                    _decompressor = std::make_unique<::Microsoft::Console::Utils::ConptyCompression::Decompressor>();
+                    flags |= PSEUDOCONSOLE_COMPRESS_OUTPUT;
+                }
+                CATCH_LOG();
+            }
+
+            // Prewarmed pseudoconsoles were all created with the default flags.
+            if (flags == DefaultPseudoConsoleFlags)
+            {
+                if (auto prewarmed = _claimPrewarmedPseudoConsole())
+                {
+                    // If the conhost died in the meantime, we'll just create a new one below.
+                    if (SUCCEEDED_LOG(ConptyResizePseudoConsole(prewarmed->hPC.get(), dimensions)))
+                    {
+                        _inPipe = std::move(prewarmed->inPipe);
+                        _outPipe = std::move(prewarmed->outPipe);
+                        _hPC = std::move(prewarmed->hPC);
+                    }
+                }
+            }
+
+            if (!_hPC)
+            {
+                THROW_IF_FAILED(_CreatePseudoConsoleAndPipes(dimensions, flags, &_inPipe, &_outPipe, &_hPC));
+            }
             THROW_IF_FAILED(_LaunchAttachedClient());
         }
         // But if it was an inbound handoff... attempt to synchronize the size of it with what our connection
@@ -317,17 +516,18 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         _startTime = std::chrono::high_resolution_clock::now();
 
-        // Create our own output handling thread
         // This must be done after the pipes are populated.
         // Each connection needs to make sure to drain the output from its backing host.
-        _hOutputThread.reset(CreateThread(
+        _StartOutputReader();
+
+        _hInputThread.reset(CreateThread(
             nullptr,
             0,
             [](LPVOID lpParameter) noexcept {
                 ConptyConnection* const pInstance = static_cast<ConptyConnection*>(lpParameter);
                 if (pInstance)
                 {
-                    return pInstance->_OutputThread();
+                    return pInstance->_InputThread();
                 }
                 return gsl::narrow_cast<DWORD>(E_INVALIDARG);
             },
@@ -335,9 +535,9 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             0,
             nullptr));
 
-        THROW_LAST_ERROR_IF_NULL(_hOutputThread);
+        THROW_LAST_ERROR_IF_NULL(_hInputThread);
 
-        LOG_IF_FAILED(SetThreadDescription(_hOutputThread.get(), L"ConptyConnection Output Thread"));
+        LOG_IF_FAILED(SetThreadDescription(_hInputThread.get(), L"ConptyConnection Input Thread"));
 
         _clientExitWait.reset(CreateThreadpoolWait(
             [](PTP_CALLBACK_INSTANCE /*callbackInstance*/, PVOID context, PTP_WAIT /*wait*/, TP_WAIT_RESULT /*waitResult*/) noexcept {
@@ -418,10 +618,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         // Close the pseudoconsole and wait for all output to drain.
         _hPC.reset();
-        if (auto localOutputThreadHandle = std::move(_hOutputThread))
-        {
-            LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(localOutputThreadHandle.get(), INFINITE));
-        }
+        _WaitForOutputReader();
 
         _indicateExitWithStatus(exitCode);
 
@@ -436,10 +633,107 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             return;
         }
 
-        // convert from UTF-16LE to UTF-8 as ConPty expects UTF-8
-        // TODO GH#3378 reconcile and unify UTF-8 converters
-        std::string str = winrt::to_string(data);
-        LOG_IF_WIN32_BOOL_FALSE(WriteFile(_inPipe.get(), str.c_str(), (DWORD)str.length(), nullptr, nullptr));
+        // The input thread converts it to UTF-8 and writes it to the pipe.
+        // Until then, the input waits in _pendingInput, which keeps it in order.
+        bool wasEmpty = false;
+        {
+            const std::lock_guard lock{ _inputMutex };
+            wasEmpty = _pendingInput.empty();
+            _pendingInput.append(data);
+        }
+
+        // If there was input pending already, the input thread is about to take it.
+        if (wasEmpty)
+        {
+            _inputCV.notify_one();
+        }
+    }
+
+    // Method Description:
+    // - Writes the input that WriteInput() queued to the pipe of the
+    //   pseudoconsole. WriteFile blocks once the pipe is full, until the client
+    //   reads from it. That's what makes a paste wait for the client, instead
+    //   of the UI thread.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - 0
+    DWORD ConptyConnection::_InputThread()
+    {
+        std::wstring input;
+        std::string utf8;
+        til::u16state u16state;
+
+        for (;;)
+        {
+            {
+                std::unique_lock lock{ _inputMutex };
+                _inputCV.wait(lock, [this]() { return _inputStopping.load(std::memory_order_relaxed) || !_pendingInput.empty(); });
+                if (_inputStopping.load(std::memory_order_relaxed))
+                {
+                    return 0;
+                }
+                // Swapping the strings keeps the capacity of both of them.
+                input.swap(_pendingInput);
+            }
+
+            // Between two chunks, check whether the connection is being closed,
+            // since the client might never read the rest of the paste.
+            for (std::wstring_view rest{ input }; !rest.empty() && !_inputStopping.load(std::memory_order_relaxed);)
+            {
+                const auto chunk = rest.substr(0, InputChunkSize);
+                rest = rest.substr(chunk.size());
+
+                // The state carries surrogate pairs that were split between two chunks over to the next one.
+                if (FAILED_LOG(til::u16u8(chunk, utf8, u16state)))
+                {
+                    break;
+                }
+                if (!WriteFile(_inPipe.get(), utf8.data(), gsl::narrow<DWORD>(utf8.size()), nullptr, nullptr))
+                {
+                    // The pipe breaks when the client exits. The input is of no use to anyone then.
+                    LOG_LAST_ERROR_IF(!_inputStopping.load(std::memory_order_relaxed));
+                    break;
+                }
+            }
+
+            input.clear();
+        }
+    }
+
+    // Method Description:
+    // - Stops the input thread, dropping any input that it didn't write yet.
+    //   Must be called before the input pipe is closed.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ConptyConnection::_StopInputThread() noexcept
+    {
+        if (!_hInputThread)
+        {
+            return;
+        }
+
+        {
+            const std::lock_guard lock{ _inputMutex };
+            _inputStopping.store(true, std::memory_order_relaxed);
+        }
+        _inputCV.notify_one();
+
+        // The thread might be stuck in a WriteFile on a full pipe. It might also be just
+        // about to call it, which is why the cancellation is repeated until it has exited.
+        for (;;)
+        {
+            CancelSynchronousIo(_hInputThread.get());
+            const auto wait = WaitForSingleObject(_hInputThread.get(), 100);
+            if (wait != WAIT_TIMEOUT)
+            {
+                LOG_LAST_ERROR_IF(wait == WAIT_FAILED);
+                break;
+            }
+        }
+        _hInputThread.reset();
     }
 
     void ConptyConnection::Resize(uint32_t rows, uint32_t columns)
@@ -468,6 +762,20 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         }
     }
 
+    // Method Description:
+    // - Hands the output of the pseudoconsole to the given handler, instead of
+    //   raising it as TerminalOutput events. See DirectConnectionOutput.h.
+    // - Waits for the output thread to leave the previous handler, if it's in it.
+    // Arguments:
+    // - handler: the handler to call with the output, or nullptr to go back to
+    //   raising events.
+    // Return Value:
+    // - <none>
+    void ConptyConnection::SetDirectOutputHandler(DirectOutputHandler handler)
+    {
+        *_directOutputHandler.lock() = std::move(handler);
+    }
+
     void ConptyConnection::Close() noexcept
     try
     {
@@ -478,16 +786,14 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
             _hPC.reset(); // tear down the pseudoconsole (this is like clicking X on a console window)
 
+            _StopInputThread(); // it mustn't write into a pipe that's closed
+
             _inPipe.reset(); // break the pipes
             _outPipe.reset();
 
-            if (_hOutputThread)
-            {
-                // Tear down our output thread -- now that the output pipe was closed on the
-                // far side, we can run down our local reader.
-                LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(_hOutputThread.get(), INFINITE));
-                _hOutputThread.reset();
-            }
+            // Tear down our output reader -- now that the output pipe was closed on the
+            // far side, we can run down our local reader.
+            _WaitForOutputReader();
 
             if (_piClient.hProcess)
             {
@@ -533,6 +839,146 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         return commandline.to_hstring();
     }
 
+    // Method Description:
+    // - Starts reading the output of the pseudoconsole. Unless the pipe came
+    //   from a handoff, this happens on the shared reader pool of the process
+    //   (see _outputReaderEnvironment), and it falls back to a thread of its
+    //   own otherwise: reads on pipes that weren't opened for overlapped I/O
+    //   can't be completed on a pool.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ConptyConnection::_StartOutputReader()
+    {
+        _buffer.resize(MinimumBufferSize);
+
+        if (!_overlappedOutput)
+        {
+            _hOutputThread.reset(CreateThread(
+                nullptr,
+                0,
+                [](LPVOID lpParameter) noexcept {
+                    ConptyConnection* const pInstance = static_cast<ConptyConnection*>(lpParameter);
+                    if (pInstance)
+                    {
+                        return pInstance->_OutputThread();
+                    }
+                    return gsl::narrow_cast<DWORD>(E_INVALIDARG);
+                },
+                this,
+                0,
+                nullptr));
+
+            THROW_LAST_ERROR_IF_NULL(_hOutputThread);
+
+            LOG_IF_FAILED(SetThreadDescription(_hOutputThread.get(), L"ConptyConnection Output Thread"));
+            return;
+        }
+
+        _outputIo.reset(CreateThreadpoolIo(
+            _outPipe.get(),
+            [](PTP_CALLBACK_INSTANCE, PVOID context, PVOID, ULONG ioResult, ULONG_PTR bytesTransferred, PTP_IO) noexcept {
+                ConptyConnection* const pInstance = static_cast<ConptyConnection*>(context);
+                if (pInstance)
+                {
+                    pInstance->_OutputCompleted(ioResult, gsl::narrow_cast<DWORD>(bytesTransferred));
+                }
+            },
+            this,
+            _outputReaderEnvironment()));
+
+        THROW_LAST_ERROR_IF_NULL(_outputIo);
+
+        // Only once nothing can fail anymore, or _WaitForOutputReader() would wait for a reader that never started.
+        _outputDrained.create(wil::EventOptions::ManualReset);
+
+        // Keep us alive until the reader stops; the destructor won't wait
+        // for it, and the known exit points _do_.
+        _outputReaderRef = get_strong();
+        if (!_ReadOutput())
+        {
+            _StopOutputReader();
+        }
+    }
+
+    // Method Description:
+    // - Starts the next overlapped read of the output pipe. If it fails right
+    //   away, the failure is handled right here, as no completion is queued
+    //   for it.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - true if a read is pending, false if the reader has to stop.
+    bool ConptyConnection::_ReadOutput() noexcept
+    {
+        for (;;)
+        {
+            StartThreadpoolIo(_outputIo.get());
+            _outputOverlapped = {};
+            // Completions are queued even for reads that complete right away.
+            if (ReadFile(_outPipe.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, &_outputOverlapped))
+            {
+                return true;
+            }
+
+            const auto lastError = GetLastError();
+            if (lastError == ERROR_IO_PENDING)
+            {
+                return true;
+            }
+
+            CancelThreadpoolIo(_outputIo.get());
+            if (!_HandleOutput(lastError, 0))
+            {
+                return false;
+            }
+        }
+    }
+
+    // Method Description:
+    // - Called on the shared reader pool once a read of the output completed.
+    //   Handles it and starts the next one, so that there's only ever a single
+    //   read in flight per connection, which keeps the output in order.
+    // Arguments:
+    // - error: the error code of the read, or ERROR_SUCCESS
+    // - read: the number of bytes that were read into _buffer
+    // Return Value:
+    // - <none>
+    void ConptyConnection::_OutputCompleted(const DWORD error, const DWORD read) noexcept
+    {
+        if (!_HandleOutput(error, read) || !_ReadOutput())
+        {
+            _StopOutputReader();
+        }
+    }
+
+    void ConptyConnection::_StopOutputReader() noexcept
+    {
+        // This might be the last reference to us, so it has to be the last thing we touch.
+        auto strongThis{ std::move(_outputReaderRef) };
+        _outputDrained.SetEvent();
+    }
+
+    // Method Description:
+    // - Waits for the output reader to have handled all of the output, after
+    //   the pipe was broken. Must not be called from the reader itself.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ConptyConnection::_WaitForOutputReader() noexcept
+    {
+        if (auto localOutputThreadHandle = std::move(_hOutputThread))
+        {
+            LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(localOutputThreadHandle.get(), INFINITE));
+        }
+        if (_outputDrained)
+        {
+            _outputDrained.wait();
+        }
+    }
+
     DWORD ConptyConnection::_OutputThread()
     {
         // Keep us alive until the output thread terminates; the destructor
@@ -540,65 +986,134 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         auto strongThis{ get_strong() };
 
         // process the data of the output pipe in a loop
-        while (true)
+        for (;;)
         {
             DWORD read{};
 
             const auto readFail{ !ReadFile(_outPipe.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), &read, nullptr) };
-            if (readFail) // reading failed (we must check this first, because read will also be 0.)
+            // reading failed (we must check this first, because read will also be 0.)
+            if (!_HandleOutput(readFail ? GetLastError() : ERROR_SUCCESS, read))
             {
-                const auto lastError = GetLastError();
-                if (lastError != ERROR_BROKEN_PIPE && !_isStateAtOrBeyond(ConnectionState::Closing))
-                {
-                    // EXIT POINT
-                    _indicateExitWithStatus(HRESULT_FROM_WIN32(lastError)); // print a message
-                    _transitionToState(ConnectionState::Failed);
-                    return gsl::narrow_cast<DWORD>(HRESULT_FROM_WIN32(lastError));
-                }
-                // else we call convertUTF8ChunkToUTF16 with an empty string_view to convert possible remaining partials to U+FFFD
+                return 0;
             }
+        }
+    }
 
-            const HRESULT result{ til::u8u16(std::string_view{ _buffer.data(), read }, _u16Str, _u8State) };
-            if (FAILED(result))
+    // Method Description:
+    // - Handles the result of a single read of the output pipe: decodes it and
+    //   passes it to the output handlers.
+    // Arguments:
+    // - error: the error code of the read, or ERROR_SUCCESS
+    // - read: the number of bytes that were read into _buffer
+    // Return Value:
+    // - true if the pipe should be read again, false if the output ended.
+    bool ConptyConnection::_HandleOutput(const DWORD error, const DWORD read) noexcept
+    try
+    {
+        if (error != ERROR_SUCCESS)
+        {
+            if (error != ERROR_BROKEN_PIPE && !_isStateAtOrBeyond(ConnectionState::Closing))
             {
-                if (_isStateAtOrBeyond(ConnectionState::Closing))
-                {
-                    // This termination was expected.
-                    return 0;
-                }
-
                 // EXIT POINT
-                _indicateExitWithStatus(result); // print a message
+                _indicateExitWithStatus(HRESULT_FROM_WIN32(error)); // print a message
                 _transitionToState(ConnectionState::Failed);
-                return gsl::narrow_cast<DWORD>(result);
+                return false;
             }
+            // else we call convertUTF8ChunkToUTF16 with an empty string_view to convert possible remaining partials to U+FFFD
+        }
+
+        // Everything the output handlers allocate counts towards the connection,
+        // unless it's made in a subsystem's own scope (like the parser's).
+        TRACK_ALLOCATIONS(Connection);
 
-            if (_u16Str.empty())
+        std::string_view output{ _buffer.data(), read };
+        HRESULT result{ S_OK };
+        if (_decompressor)
+        {
+            try
             {
-                return 0;
+                _decompressed.clear();
+                _decompressor->Decompress(output, _decompressed);
+                output = _decompressed;
+            }
+            catch (...)
+            {
+                result = wil::ResultFromCaughtException();
             }
+        }
 
-            if (!_receivedFirstByte)
+        if (SUCCEEDED(result))
+        {
+            result = til::u8u16(output, _u16Str, _u8State);
+        }
+        if (FAILED(result))
+        {
+            if (_isStateAtOrBeyond(ConnectionState::Closing))
             {
-                const auto now = std::chrono::high_resolution_clock::now();
-                const std::chrono::duration<double> delta = now - _startTime;
+                // This termination was expected.
+                return false;
+            }
+
+            // EXIT POINT
+            _indicateExitWithStatus(result); // print a message
+            _transitionToState(ConnectionState::Failed);
+            return false;
+        }
+
+        if (_u16Str.empty())
+        {
+            // A read that failed or hit the end of the pipe ends the output. Otherwise it
+            // only held the start of a compressed frame or of a UTF-8 sequence, and
+            // there's nothing to hand out until the next read delivers the rest of it.
+            return error == ERROR_SUCCESS && read != 0;
+        }
+
+        if (!_receivedFirstByte)
+        {
+            const auto now = std::chrono::high_resolution_clock::now();
+            const std::chrono::duration<double> delta = now - _startTime;
 
 #pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
-                TraceLoggingWrite(g_hTerminalConnectionProvider,
-                                  "ReceivedFirstByte",
-                                  TraceLoggingDescription("An event emitted when the connection receives the first byte"),
-                                  TraceLoggingGuid(_guid, "SessionGuid", "The WT_SESSION's GUID"),
-                                  TraceLoggingFloat64(delta.count(), "Duration"),
-                                  TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
-                                  TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
-                _receivedFirstByte = true;
-            }
+            TraceLoggingWrite(g_hTerminalConnectionProvider,
+                              "ReceivedFirstByte",
+                              TraceLoggingDescription("An event emitted when the connection receives the first byte"),
+                              TraceLoggingGuid(_guid, "SessionGuid", "The WT_SESSION's GUID"),
+                              TraceLoggingFloat64(delta.count(), "Duration"),
+                              TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
+                              TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
+            _receivedFirstByte = true;
+        }
 
-            // Pass the output to our registered event handlers
+        // Pass the output to our registered event handlers,
+        // or without a copy to a control in this process.
+        if (const auto handler = _directOutputHandler.lock_shared(); *handler)
+        {
+            (*handler)(_u16Str);
+        }
+        else
+        {
             _TerminalOutputHandlers(_u16Str);
         }
 
-        return 0;
+        // A full buffer means that more output was already waiting in the pipe,
+        // so the next read can take a larger chunk in one go. Reads return as
+        // soon as any output is available, so this doesn't add any latency.
+        if (read == _buffer.size() && _buffer.size() < MaximumBufferSize)
+        {
+            _buffer.resize(_buffer.size() * 2);
+        }
+
+        return true;
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        if (!_isStateAtOrBeyond(ConnectionState::Closing))
+        {
+            // EXIT POINT
+            _transitionToState(ConnectionState::Failed);
+        }
+        return false;
     }
 
     static winrt::event<NewConnectionHandler> _newConnectionHandlers;
@@ -625,6 +1140,68 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         THROW_IF_FAILED(CTerminalHandoff::s_StopListening());
     }
 
+    // Function Description:
+    // - Starts up to `count` pseudoconsoles in the background, for the connections
+    //   that are about to be started to claim. This hides the startup latency of
+    //   conhost, when many panes are opened at once, e.g. when restoring a session.
+    //   The pool never holds more than MaxPrewarmedPseudoConsoles.
+    // Arguments:
+    // - count: the number of connections that are about to be started
+    void ConptyConnection::PrewarmPseudoConsoles(uint32_t count)
+    {
+        {
+            const auto pool = _prewarmedPseudoConsoles().lock_shared();
+            count = gsl::narrow_cast<uint32_t>(std::min<size_t>(count, MaxPrewarmedPseudoConsoles - std::min(pool->size(), MaxPrewarmedPseudoConsoles)));
+        }
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            // Every conhost is started on its own threadpool thread, since
+            // starting one mostly means waiting for it to be ready.
+            LOG_IF_WIN32_BOOL_FALSE(TrySubmitThreadpoolCallback(
+                [](PTP_CALLBACK_INSTANCE, PVOID) noexcept {
+                    PrewarmedPseudoConsole entry;
+                    if (FAILED_LOG(_CreatePseudoConsoleAndPipes(PrewarmedPseudoConsoleSize, DefaultPseudoConsoleFlags, entry.inPipe.addressof(), entry.outPipe.addressof(), entry.hPC.addressof())))
+                    {
+                        return;
+                    }
+
+                    try
+                    {
+                        auto pool = _prewarmedPseudoConsoles().lock();
+                        if (pool->size() < MaxPrewarmedPseudoConsoles)
+                        {
+                            entry.created = std::chrono::steady_clock::now();
+                            pool->emplace_back(std::move(entry));
+                            // Otherwise the expiry of an older one is already scheduled.
+                            if (pool->size() == 1)
+                            {
+                                _schedulePrewarmedPseudoConsoleExpiry(PrewarmedPseudoConsoleIdleTimeout);
+                            }
+                        }
+                    }
+                    CATCH_LOG();
+                },
+                nullptr,
+                nullptr));
+        }
+    }
+
+    // Function Description:
+    // - Closes the prewarmed pseudoconsoles that no connection claimed yet, because
+    //   the connections they were started for aren't going to be started after all.
+    //   That's the case when the settings changed or the window is closing.
+    void ConptyConnection::DiscardPrewarmedPseudoConsoles()
+    {
+        // Closing them waits for their conhosts to exit, which mustn't block the caller.
+        LOG_IF_WIN32_BOOL_FALSE(TrySubmitThreadpoolCallback(
+            [](PTP_CALLBACK_INSTANCE, PVOID) noexcept {
+                _discardPrewarmedPseudoConsoles(true);
+            },
+            nullptr,
+            nullptr));
+    }
+
     // Function Description:
     // - This function will be called (by C++/WinRT) after the final outstanding reference to
     //   any given connection instance is released.
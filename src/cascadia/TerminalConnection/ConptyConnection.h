@@ -6,7 +6,10 @@
 #include "ConptyConnection.g.h"
 #include "ConnectionStateHolder.h"
 
+#include <condition_variable>
 #include <conpty-static.h>
+#include "../inc/DirectConnectionOutput.h"
+#include "../../types/inc/ConptyCompression.hpp"
 
 namespace wil
 {
@@ -16,7 +19,7 @@ namespace wil
 
 namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 {
-    struct ConptyConnection : ConptyConnectionT<ConptyConnection>, ConnectionStateHolder<ConptyConnection>
+    struct ConptyConnection : ConptyConnectionT<ConptyConnection, IDirectConnectionOutput>, ConnectionStateHolder<ConptyConnection>
     {
         ConptyConnection(const HANDLE hSig,
                          const HANDLE hIn,
@@ -26,6 +29,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                          const HANDLE hClientProcess);
 
         ConptyConnection() noexcept = default;
+        ~ConptyConnection();
         void Initialize(const Windows::Foundation::Collections::ValueSet& settings);
 
         static winrt::fire_and_forget final_release(std::unique_ptr<ConptyConnection> connection);
@@ -36,11 +40,15 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         void Close() noexcept;
         void ClearBuffer();
 
+        void SetDirectOutputHandler(DirectOutputHandler handler) override;
+
         winrt::guid Guid() const noexcept;
         winrt::hstring Commandline() const;
 
         static void StartInboundListener();
         static void StopInboundListener();
+        static void PrewarmPseudoConsoles(uint32_t count);
+        static void DiscardPrewarmedPseudoConsoles();
 
         static winrt::event_token NewConnection(NewConnectionHandler const& handler);
         static void NewConnection(winrt::event_token const& token);
@@ -71,22 +79,58 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         Windows::Foundation::Collections::ValueSet _environment{ nullptr };
         guid _guid{}; // A unique session identifier for connected client
         hstring _clientName{}; // The name of the process hosted by this ConPTY connection (as of launch).
+        bool _compressOutput{ false };
 
         bool _receivedFirstByte{ false };
         std::chrono::high_resolution_clock::time_point _startTime{};
 
         wil::unique_hfile _inPipe; // The pipe for writing input to
         wil::unique_hfile _outPipe; // The pipe for reading output from
-        wil::unique_handle _hOutputThread;
+        bool _overlappedOutput{ true }; // Whether _outPipe was opened for overlapped reads
         wil::unique_process_information _piClient;
         wil::unique_static_pseudoconsole_handle _hPC;
         wil::unique_threadpool_wait _clientExitWait;
 
         til::u8state _u8State{};
         std::wstring _u16Str{};
-        std::array<char, 4096> _buffer{};
+        // Held shared while the output is handed to it. See DirectConnectionOutput.h.
+        til::shared_mutex<DirectOutputHandler> _directOutputHandler;
+        // The output is read into a buffer that starts small, since most sessions
+        // are mostly idle, and grows once reads keep filling it up.
+        static constexpr size_t MinimumBufferSize = 4 * 1024;
+        static constexpr size_t MaximumBufferSize = 128 * 1024;
+        std::vector<char> _buffer;
+        // Only set if we asked the conpty to compress its output. See ConptyCompression.hpp.
+        std::unique_ptr<::Microsoft::Console::Utils::ConptyCompression::Decompressor> _decompressor;
+        std::string _decompressed;
+
+        // The output is read on a pool that all connections of the process
+        // share, unless _outPipe can't be read with overlapped reads.
+        // In that case, it's read on _hOutputThread instead.
+        wil::unique_threadpool_io _outputIo;
+        OVERLAPPED _outputOverlapped{};
+        wil::unique_event _outputDrained; // set once the pool stopped reading
+        winrt::com_ptr<ConptyConnection> _outputReaderRef; // keeps us alive while the pool reads
+        wil::unique_handle _hOutputThread;
 
+        void _StartOutputReader();
+        bool _ReadOutput() noexcept;
+        void _OutputCompleted(const DWORD error, const DWORD read) noexcept;
+        void _StopOutputReader() noexcept;
+        void _WaitForOutputReader() noexcept;
         DWORD _OutputThread();
+        bool _HandleOutput(const DWORD error, const DWORD read) noexcept;
+
+        // Input is written to the pipe on a thread of its own, so that a large
+        // paste doesn't block the UI until the client has read all of it.
+        wil::unique_handle _hInputThread;
+        std::mutex _inputMutex;
+        std::condition_variable _inputCV;
+        std::wstring _pendingInput; // guarded by _inputMutex
+        std::atomic<bool> _inputStopping{ false };
+
+        DWORD _InputThread();
+        void _StopInputThread() noexcept;
     };
 }
 
@@ -0,0 +1,100 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "RecordingConnection.h"
+
+#include "RecordingConnection.g.cpp"
+
+using namespace ::Microsoft::Terminal::TerminalConnection;
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    // Method Description:
+    // - Creates a new recording at the given path and starts recording the
+    //   given connection into it. The file must not exist yet.
+    // - If the file can't be created the connection is still usable, it just
+    //   doesn't record anything.
+    RecordingConnection::RecordingConnection(const ITerminalConnection& connection, const hstring& path) :
+        _wrappedConnection{ connection }
+    {
+        try
+        {
+            *_writer.lock() = std::make_unique<SessionRecording::Writer>(path);
+        }
+        CATCH_LOG();
+
+        _outputRevoker = _wrappedConnection.TerminalOutput(winrt::auto_revoke, { this, &RecordingConnection::_outputHandler });
+        _stateChangedRevoker = _wrappedConnection.StateChanged(winrt::auto_revoke, [this](auto&& /*s*/, auto&& /*e*/) {
+            _StateChangedHandlers(*this, nullptr);
+        });
+    }
+
+    void RecordingConnection::Initialize(const Windows::Foundation::Collections::ValueSet& settings)
+    {
+        _wrappedConnection.Initialize(settings);
+    }
+
+    void RecordingConnection::Start()
+    {
+        _wrappedConnection.Start();
+    }
+
+    void RecordingConnection::WriteInput(hstring const& data)
+    {
+        _record([&](auto& writer) { writer.WriteInput(data); });
+        _wrappedConnection.WriteInput(data);
+    }
+
+    void RecordingConnection::Resize(uint32_t rows, uint32_t columns)
+    {
+        _record([&](auto& writer) { writer.WriteResize(rows, columns); });
+        _wrappedConnection.Resize(rows, columns);
+    }
+
+    void RecordingConnection::Close()
+    {
+        // Closing the wrapped connection drains its remaining output, so
+        // we only need to stop recording once it's done.
+        _wrappedConnection.Close();
+
+        _outputRevoker.revoke();
+        _stateChangedRevoker.revoke();
+
+        // Resetting the writer flushes whatever output is still buffered.
+        _writer.lock()->reset();
+    }
+
+    ConnectionState RecordingConnection::State() const noexcept
+    {
+        return _wrappedConnection.State();
+    }
+
+    // Method Description:
+    // - Calls the given function with the writer, unless recording has stopped.
+    // - If writing fails, for instance because the disk is full, we stop
+    //   recording instead of interrupting the session.
+    template<typename F>
+    void RecordingConnection::_record(F&& func) noexcept
+    {
+        auto writer = _writer.lock();
+        if (*writer)
+        {
+            try
+            {
+                func(**writer);
+            }
+            catch (...)
+            {
+                LOG_CAUGHT_EXCEPTION();
+                writer->reset();
+            }
+        }
+    }
+
+    void RecordingConnection::_outputHandler(const hstring& output)
+    {
+        _record([&](auto& writer) { writer.WriteOutput(output); });
+        _TerminalOutputHandlers(output);
+    }
+}
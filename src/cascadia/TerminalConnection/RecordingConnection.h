@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "RecordingConnection.g.h"
+#include "SessionRecording.h"
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    struct RecordingConnection : RecordingConnectionT<RecordingConnection>
+    {
+        RecordingConnection(const ITerminalConnection& connection, const hstring& path);
+
+        void Initialize(const Windows::Foundation::Collections::ValueSet& settings);
+
+        void Start();
+        void WriteInput(hstring const& data);
+        void Resize(uint32_t rows, uint32_t columns);
+        void Close();
+
+        ConnectionState State() const noexcept;
+
+        WINRT_CALLBACK(TerminalOutput, TerminalOutputHandler);
+        TYPED_EVENT(StateChanged, ITerminalConnection, IInspectable);
+
+    private:
+        template<typename F>
+        void _record(F&& func) noexcept;
+        void _outputHandler(const hstring& output);
+
+        ITerminalConnection _wrappedConnection{ nullptr };
+        ITerminalConnection::TerminalOutput_revoker _outputRevoker;
+        ITerminalConnection::StateChanged_revoker _stateChangedRevoker;
+
+        // The output arrives on the wrapped connection's output thread,
+        // while input and resizes arrive on the UI thread.
+        til::shared_mutex<std::unique_ptr<::Microsoft::Terminal::TerminalConnection::SessionRecording::Writer>> _writer;
+    };
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::factory_implementation
+{
+    BASIC_FACTORY(RecordingConnection);
+}
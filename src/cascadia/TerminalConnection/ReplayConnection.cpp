@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "ReplayConnection.h"
+#include "SessionRecording.h"
+
+#include "ReplayConnection.g.cpp"
+
+#include "LibraryResources.h"
+
+using namespace ::Microsoft::Terminal::TerminalConnection;
+using namespace std::string_view_literals;
+
+// {5c8f4a9e-1d0b-4f7a-9a3e-6b2d7c1e8f40}
+static constexpr winrt::guid ReplayConnectionType = { 0x5c8f4a9e, 0x1d0b, 0x4f7a, { 0x9a, 0x3e, 0x6b, 0x2d, 0x7c, 0x1e, 0x8f, 0x40 } };
+
+static constexpr auto _errorFormat = L"{0} ({0:#010x})"sv;
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    winrt::guid ReplayConnection::ConnectionType() noexcept
+    {
+        return ReplayConnectionType;
+    }
+
+    // Function Description:
+    // - Creates the settings for a ReplayConnection.
+    // Arguments:
+    // - path: the recording to play back
+    // - realTime: if true, the output is played back at the pace it was
+    //   recorded at. Otherwise it's played back as fast as possible.
+    // Return Value:
+    // - A ValueSet for Initialize().
+    Windows::Foundation::Collections::ValueSet ReplayConnection::CreateSettings(const hstring& path, bool realTime)
+    {
+        Windows::Foundation::Collections::ValueSet vs{};
+        vs.Insert(L"path", Windows::Foundation::PropertyValue::CreateString(path));
+        vs.Insert(L"realTime", Windows::Foundation::PropertyValue::CreateBoolean(realTime));
+        return vs;
+    }
+
+    void ReplayConnection::Initialize(const Windows::Foundation::Collections::ValueSet& settings)
+    {
+        if (settings)
+        {
+            _path = winrt::unbox_value_or<winrt::hstring>(settings.TryLookup(L"path").try_as<Windows::Foundation::IPropertyValue>(), _path);
+            _realTime = winrt::unbox_value_or<bool>(settings.TryLookup(L"realTime").try_as<Windows::Foundation::IPropertyValue>(), _realTime);
+        }
+    }
+
+    void ReplayConnection::Start()
+    try
+    {
+        _transitionToState(ConnectionState::Connecting);
+
+        _hReplayThread.reset(CreateThread(
+            nullptr,
+            0,
+            [](LPVOID lpParameter) noexcept {
+                ReplayConnection* const pInstance = static_cast<ReplayConnection*>(lpParameter);
+                if (pInstance)
+                {
+                    return pInstance->_ReplayThread();
+                }
+                return gsl::narrow_cast<DWORD>(E_INVALIDARG);
+            },
+            this,
+            0,
+            nullptr));
+
+        THROW_LAST_ERROR_IF_NULL(_hReplayThread);
+
+        LOG_IF_FAILED(SetThreadDescription(_hReplayThread.get(), L"ReplayConnection Replay Thread"));
+
+        _transitionToState(ConnectionState::Connected);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        _transitionToState(ConnectionState::Failed);
+    }
+
+    // A recording can't react to input or resizes, so both are ignored.
+    void ReplayConnection::WriteInput(hstring const& /*data*/) noexcept
+    {
+    }
+
+    void ReplayConnection::Resize(uint32_t /*rows*/, uint32_t /*columns*/) noexcept
+    {
+    }
+
+    void ReplayConnection::Close() noexcept
+    {
+        if (_transitionToState(ConnectionState::Closing))
+        {
+            _closing.SetEvent();
+
+            if (_hReplayThread)
+            {
+                LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(_hReplayThread.get(), INFINITE));
+                _hReplayThread.reset();
+            }
+
+            _transitionToState(ConnectionState::Closed);
+        }
+    }
+
+    DWORD ReplayConnection::_ReplayThread() noexcept
+    {
+        // Keep us alive until the replay thread terminates; the destructor
+        // won't wait for us, and Close() does.
+        auto strongThis{ get_strong() };
+
+        try
+        {
+            SessionRecording::Reader reader{ _path };
+            SessionRecording::Record record;
+            const auto start = std::chrono::steady_clock::now();
+
+            while (reader.Next(record))
+            {
+                if (record.kind != SessionRecording::RecordKind::Output)
+                {
+                    continue;
+                }
+
+                if (_realTime)
+                {
+                    const auto now = std::chrono::steady_clock::now();
+                    const auto due = start + record.timestamp;
+                    if (due > now)
+                    {
+                        const auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(due - now);
+                        if (_closing.wait(gsl::narrow_cast<DWORD>(std::min<int64_t>(delay.count(), INFINITE - 1))))
+                        {
+                            return 0;
+                        }
+                    }
+                }
+
+                if (_closing.is_signaled())
+                {
+                    return 0;
+                }
+
+                _TerminalOutputHandlers(record.text);
+            }
+
+            _TerminalOutputHandlers(L"\r\n");
+            _TerminalOutputHandlers(RS_(L"ReplayFinished"));
+        }
+        catch (...)
+        {
+            const auto hr = wil::ResultFromCaughtException();
+
+            try
+            {
+                winrt::hstring failureText{ fmt::format(std::wstring_view{ RS_(L"ReplayFailed") },
+                                                        fmt::format(_errorFormat, static_cast<unsigned int>(hr)),
+                                                        _path) };
+                _TerminalOutputHandlers(failureText);
+            }
+            CATCH_LOG();
+
+            _transitionToState(ConnectionState::Failed);
+        }
+
+        return 0;
+    }
+}
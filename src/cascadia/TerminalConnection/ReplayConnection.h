@@ -0,0 +1,41 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "ReplayConnection.g.h"
+#include "ConnectionStateHolder.h"
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
+{
+    struct ReplayConnection : ReplayConnectionT<ReplayConnection>, ConnectionStateHolder<ReplayConnection>
+    {
+        ReplayConnection() noexcept = default;
+
+        static winrt::guid ConnectionType() noexcept;
+        static Windows::Foundation::Collections::ValueSet CreateSettings(const hstring& path, bool realTime);
+
+        void Initialize(const Windows::Foundation::Collections::ValueSet& settings);
+
+        void Start();
+        void WriteInput(hstring const& data) noexcept;
+        void Resize(uint32_t rows, uint32_t columns) noexcept;
+        void Close() noexcept;
+
+        WINRT_CALLBACK(TerminalOutput, TerminalOutputHandler);
+
+    private:
+        DWORD _ReplayThread() noexcept;
+
+        hstring _path;
+        bool _realTime{ true };
+
+        wil::unique_event _closing{ wil::EventOptions::ManualReset };
+        wil::unique_handle _hReplayThread;
+    };
+}
+
+namespace winrt::Microsoft::Terminal::TerminalConnection::factory_implementation
+{
+    BASIC_FACTORY(ReplayConnection);
+}
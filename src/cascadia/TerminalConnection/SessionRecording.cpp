@@ -0,0 +1,240 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "SessionRecording.h"
+
+using namespace Microsoft::Terminal::TerminalConnection::SessionRecording;
+
+// Output is buffered up to this many bytes before it's written to the file.
+// Input and resizes are rare in comparison and are written right away, so
+// that a recording stays useful if the Terminal is closed unexpectedly.
+static constexpr size_t FlushThreshold = 64 * 1024;
+
+static void _appendVarint(std::string& out, uint64_t value)
+{
+    do
+    {
+        auto byte = gsl::narrow_cast<char>(value & 0x7f);
+        value >>= 7;
+        if (value)
+        {
+            byte |= 0x80;
+        }
+        out.push_back(byte);
+    } while (value);
+}
+
+Writer::Writer(const std::wstring_view path) :
+    _lastRecord{ std::chrono::steady_clock::now() }
+{
+    // CREATE_NEW, so that we never append to a file that isn't ours.
+    _file.reset(CreateFileW(std::wstring{ path }.c_str(),
+                            FILE_APPEND_DATA,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            CREATE_NEW,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr));
+    THROW_LAST_ERROR_IF(!_file);
+
+    _buffer.append(Magic);
+    for (auto i = 0; i < 4; ++i)
+    {
+        _buffer.push_back(gsl::narrow_cast<char>((Version >> (8 * i)) & 0xff));
+    }
+    Flush();
+}
+
+Writer::~Writer()
+{
+    try
+    {
+        Flush();
+    }
+    CATCH_LOG();
+}
+
+void Writer::WriteOutput(const std::wstring_view text)
+{
+    _writeText(RecordKind::Output, text);
+    if (_buffer.size() >= FlushThreshold)
+    {
+        Flush();
+    }
+}
+
+void Writer::WriteInput(const std::wstring_view text)
+{
+    _writeText(RecordKind::Input, text);
+    Flush();
+}
+
+void Writer::WriteResize(const uint32_t rows, const uint32_t columns)
+{
+    std::string payload;
+    _appendVarint(payload, rows);
+    _appendVarint(payload, columns);
+
+    _beginRecord(RecordKind::Resize, payload.size());
+    _buffer.append(payload);
+    Flush();
+}
+
+void Writer::Flush()
+{
+    if (_buffer.empty())
+    {
+        return;
+    }
+
+    DWORD written = 0;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(_file.get(), _buffer.data(), gsl::narrow<DWORD>(_buffer.size()), &written, nullptr));
+    _buffer.clear();
+}
+
+void Writer::_writeText(const RecordKind kind, const std::wstring_view text)
+{
+    THROW_IF_FAILED(til::u16u8(text, _utf8));
+    _beginRecord(kind, _utf8.size());
+    _buffer.append(_utf8);
+}
+
+void Writer::_beginRecord(const RecordKind kind, const size_t payloadSize)
+{
+    // Timestamps are stored as the difference to the previous one. Advancing
+    // _lastRecord by exactly that difference ensures that rounding errors don't add up.
+    const auto now = std::chrono::steady_clock::now();
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - _lastRecord);
+    _lastRecord += delta;
+
+    _buffer.push_back(static_cast<char>(kind));
+    _appendVarint(_buffer, gsl::narrow_cast<uint64_t>(delta.count()));
+    _appendVarint(_buffer, payloadSize);
+}
+
+Reader::Reader(const std::wstring_view path)
+{
+    // The file might still be written to, if it's the recording of a session that's still running.
+    wil::unique_hfile file{ CreateFileW(std::wstring{ path }.c_str(),
+                                        GENERIC_READ,
+                                        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                        nullptr,
+                                        OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL,
+                                        nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    LARGE_INTEGER fileSize{};
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+
+    _data.resize(gsl::narrow<size_t>(fileSize.QuadPart));
+    for (size_t read = 0; read < _data.size();)
+    {
+        DWORD bytesRead = 0;
+        const auto chunk = gsl::narrow_cast<DWORD>(std::min<size_t>(_data.size() - read, 1024 * 1024));
+        THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), _data.data() + read, chunk, &bytesRead, nullptr));
+        if (bytesRead == 0)
+        {
+            // The file shrank in the meantime.
+            _data.resize(read);
+            break;
+        }
+        read += bytesRead;
+    }
+
+    constexpr auto headerSize = Magic.size() + sizeof(Version);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BAD_FORMAT), _data.size() < headerSize || std::string_view{ _data }.substr(0, Magic.size()) != Magic);
+
+    uint32_t version = 0;
+    for (auto i = 0; i < 4; ++i)
+    {
+        version |= gsl::narrow_cast<uint32_t>(static_cast<uint8_t>(til::at(_data, Magic.size() + i))) << (8 * i);
+    }
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_BAD_FORMAT), version != Version);
+
+    _offset = headerSize;
+}
+
+// Method Description:
+// - Reads the next record of the recording.
+// - Records of a kind we don't know are skipped, so that newer versions of
+//   the format can add some without breaking older readers.
+// Arguments:
+// - record: receives the record
+// Return Value:
+// - false if there are no more (complete) records.
+bool Reader::Next(Record& record)
+{
+    while (_offset < _data.size())
+    {
+        const auto kind = static_cast<RecordKind>(til::at(_data, _offset));
+        ++_offset;
+
+        uint64_t delta = 0;
+        uint64_t payloadSize = 0;
+        if (!_readVarint(delta) || !_readVarint(payloadSize) || payloadSize > _data.size() - _offset)
+        {
+            // The last record was cut short.
+            _offset = _data.size();
+            return false;
+        }
+
+        _timestamp += std::chrono::microseconds{ delta };
+
+        const std::string_view payload{ _data.data() + _offset, gsl::narrow_cast<size_t>(payloadSize) };
+        _offset += payload.size();
+
+        switch (kind)
+        {
+        case RecordKind::Output:
+        case RecordKind::Input:
+            record.kind = kind;
+            record.timestamp = _timestamp;
+            THROW_IF_FAILED(til::u8u16(payload, record.text));
+            return true;
+        case RecordKind::Resize:
+        {
+            // The varints of the payload are parsed in place. This is safe,
+            // because the payload is entirely within _data.
+            const auto payloadEnd = _offset;
+            _offset -= payload.size();
+            uint64_t rows = 0;
+            uint64_t columns = 0;
+            const auto valid = _readVarint(rows) && _readVarint(columns) && _offset <= payloadEnd;
+            _offset = payloadEnd;
+            if (!valid)
+            {
+                continue;
+            }
+
+            record.kind = kind;
+            record.timestamp = _timestamp;
+            record.text.clear();
+            record.rows = gsl::narrow_cast<uint32_t>(std::min<uint64_t>(rows, UINT32_MAX));
+            record.columns = gsl::narrow_cast<uint32_t>(std::min<uint64_t>(columns, UINT32_MAX));
+            return true;
+        }
+        default:
+            continue;
+        }
+    }
+
+    return false;
+}
+
+bool Reader::_readVarint(uint64_t& value) noexcept
+{
+    value = 0;
+    for (auto shift = 0; shift < 64 && _offset < _data.size(); shift += 7)
+    {
+        const auto byte = static_cast<uint8_t>(til::at(_data, _offset));
+        ++_offset;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,85 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SessionRecording.h
+
+Abstract:
+- Reads and writes session recordings: the output, input and resizes of a
+  connection, each with the time at which it happened. RecordingConnection
+  writes them and ReplayConnection plays them back.
+- A recording is an append-only binary file. It starts with an 8 byte header,
+  the magic "WTRC" followed by the version as a little endian uint32_t.
+  Records follow until the end of the file, each of them made of:
+  * its RecordKind, as a single byte
+  * the microseconds since the previous record (or since the recording was
+    started), as an unsigned LEB128 varint
+  * the length of its payload in bytes, as an unsigned LEB128 varint
+  * the payload: UTF-8 text for Output and Input, and the rows and columns
+    as two varints for Resize
+- If the Terminal exits unexpectedly, the last record might be cut short.
+  The reader stops at the last complete record.
+--*/
+
+#pragma once
+
+namespace Microsoft::Terminal::TerminalConnection::SessionRecording
+{
+    inline constexpr std::string_view Magic{ "WTRC" };
+    inline constexpr uint32_t Version = 1;
+
+    enum class RecordKind : uint8_t
+    {
+        Output = 1,
+        Input = 2,
+        Resize = 3,
+    };
+
+    struct Record
+    {
+        RecordKind kind{};
+        std::chrono::microseconds timestamp{}; // since the start of the recording
+        std::wstring text; // Output and Input
+        uint32_t rows{}; // Resize
+        uint32_t columns{}; // Resize
+    };
+
+    class Writer
+    {
+    public:
+        explicit Writer(const std::wstring_view path);
+        ~Writer();
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        void WriteOutput(const std::wstring_view text);
+        void WriteInput(const std::wstring_view text);
+        void WriteResize(const uint32_t rows, const uint32_t columns);
+        void Flush();
+
+    private:
+        void _writeText(const RecordKind kind, const std::wstring_view text);
+        void _beginRecord(const RecordKind kind, const size_t payloadSize);
+
+        wil::unique_hfile _file;
+        std::string _buffer;
+        std::string _utf8;
+        std::chrono::steady_clock::time_point _lastRecord;
+    };
+
+    class Reader
+    {
+    public:
+        explicit Reader(const std::wstring_view path);
+
+        bool Next(Record& record);
+
+    private:
+        bool _readVarint(uint64_t& value) noexcept;
+
+        std::string _data;
+        size_t _offset{ 0 };
+        std::chrono::microseconds _timestamp{};
+    };
+}
@@ -31,5 +31,6 @@ TRACELOGGING_DECLARE_PROVIDER(g_hTerminalConnectionProvider);
 #include <telemetry/ProjectTelemetry.h>
 
 #include "til.h"
+#include <til/mutex.h>
 
 #include <cppwinrt_utils.h>
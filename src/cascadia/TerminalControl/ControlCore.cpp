@@ -11,6 +11,7 @@
 #include <LibraryResources.h>
 
 #include "EventArgs.h"
+#include "../inc/DirectConnectionOutput.h"
 #include "../../types/inc/GlyphWidth.hpp"
 #include "../../buffer/out/search.h"
 #include "../../renderer/atlas/AtlasEngine.h"
@@ -35,6 +36,35 @@ constexpr const auto TsfRedrawInterval = std::chrono::milliseconds(100);
 // The minimum delay between updating the locations of regex patterns
 constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(500);
 
+// The number of chunks of output that the connection can get ahead of the parser
+// with Feature_DecoupledOutputParsing, before it's blocked.
+constexpr uint32_t OutputQueueCapacity = 16;
+
+// Output is considered to be running away, once more than this many characters
+// arrive within one OutputRateCheckInterval. That's far more than anyone can read.
+constexpr size_t OutputFloodThreshold = 1024 * 1024;
+constexpr const auto OutputRateCheckInterval = std::chrono::milliseconds(250);
+
+// How often the performance overlay is refreshed while it's shown.
+constexpr const auto PerformanceOverlayInterval = std::chrono::milliseconds(500);
+
+// How often a background search is repeated, when output changed the buffer
+// while it ran, before it falls back to searching under the lock.
+constexpr int MaxSearchAttempts = 3;
+
+// The minimum delay between mouse motion reports, about one frame.
+constexpr const auto MouseMotionFlushInterval = std::chrono::milliseconds(8);
+
+// The minimum delay between title and taskbar progress updates, about one frame.
+constexpr const auto TitleUpdateInterval = std::chrono::milliseconds(16);
+
+// How often the memory usage of the buffer is reported to the ScrollbackBudget while output arrives.
+constexpr const auto ScrollbackBudgetInterval = std::chrono::seconds(1);
+
+// How long a control has to be hidden before its renderer releases its resources.
+// Switching back and forth between tabs shouldn't recreate them every time.
+constexpr const auto HiddenTrimDelay = std::chrono::seconds(10);
+
 namespace winrt::Microsoft::Terminal::Control::implementation
 {
     // Helper static function to ensure that all ambiguous-width glyphs are reported as narrow.
@@ -44,6 +74,42 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return false; // glyph is not wide.
     }
 
+    // Helper static function to compare the FontFeatures or FontAxes of two settings.
+    template<typename T>
+    static bool _AreMapsEqual(const winrt::Windows::Foundation::Collections::IMap<winrt::hstring, T>& lhs,
+                              const winrt::Windows::Foundation::Collections::IMap<winrt::hstring, T>& rhs)
+    {
+        const auto lhsSize = lhs ? lhs.Size() : 0;
+        const auto rhsSize = rhs ? rhs.Size() : 0;
+        if (lhsSize != rhsSize)
+        {
+            return false;
+        }
+        if (lhsSize == 0)
+        {
+            return true;
+        }
+        for (const auto& [key, value] : lhs)
+        {
+            if (!rhs.HasKey(key) || rhs.Lookup(key) != value)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Helper static function that returns true if the two settings differ in
+    // anything that requires the renderer to load the font again.
+    static bool _FontSettingsChanged(const ControlSettings& lhs, const ControlSettings& rhs)
+    {
+        return lhs.FontFace() != rhs.FontFace() ||
+               lhs.FontSize() != rhs.FontSize() ||
+               lhs.FontWeight().Weight != rhs.FontWeight().Weight ||
+               !_AreMapsEqual(lhs.FontFeatures(), rhs.FontFeatures()) ||
+               !_AreMapsEqual(lhs.FontAxes(), rhs.FontAxes());
+    }
+
     static bool _EnsureStaticInitialization()
     {
         // use C++11 magic statics to make sure we only do this once.
@@ -69,6 +135,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         _terminal = std::make_unique<::Microsoft::Terminal::Core::Terminal>();
 
+        // The log has to be ready before the first output arrives.
+        _startSessionLog();
+
         // Subscribe to the connection's disconnected event and call our connection closed handlers.
         _connectionStateChangedRevoker = _connection.StateChanged(winrt::auto_revoke, [this](auto&& /*s*/, auto&& /*v*/) {
             _ConnectionStateChangedHandlers(*this, nullptr);
@@ -77,6 +146,37 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // This event is explicitly revoked in the destructor: does not need weak_ref
         _connectionOutputEventToken = _connection.TerminalOutput({ this, &ControlCore::_connectionOutputHandler });
 
+        // Built-in connections can give us their output without turning it into
+        // an hstring first. Like the event, this is explicitly reset in Close().
+        if (const auto directOutput = _connection.try_as<IDirectConnectionOutput>())
+        {
+            if (Feature_DecoupledOutputParsing::IsEnabled())
+            {
+                // The handler is only ever called by the thread that reads the output,
+                // which makes it the single producer of the queue. It's dropped along
+                // with the handler, which ends the parse thread once it's drained the queue.
+                auto [producer, consumer] = til::spsc::channel<std::wstring>(OutputQueueCapacity);
+                directOutput->SetDirectOutputHandler([this, producer = std::make_shared<til::spsc::producer<std::wstring>>(std::move(producer))](const std::wstring_view str) {
+                    if (_sessionLogger)
+                    {
+                        _sessionLogger->Append(str);
+                    }
+                    // Counted before it's queued, so that the consumer can't pop it first.
+                    _outputQueueDepth.fetch_add(1, std::memory_order_relaxed);
+                    producer->emplace(str);
+                });
+                _parseThread = std::thread{ [this, consumer = std::move(consumer)]() {
+                    _parseOutputThread(consumer);
+                } };
+            }
+            else
+            {
+                directOutput->SetDirectOutputHandler([this](const std::wstring_view str) {
+                    _connectionOutputHandler(str);
+                });
+            }
+        }
+
         _terminal->SetWriteInputCallback([this](std::wstring& wstr) {
             _sendInputToConnection(wstr);
         });
@@ -132,6 +232,17 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 }
             });
 
+            // The renderer holds the lock while it calls this, so the snapshot
+            // matches what the frame shows exactly, which is what gets hovered.
+            _renderer->SetFramePaintedCallback([weakThis = get_weak()]() {
+                if (auto strongThis{ weakThis.get() })
+                {
+                    // The previous snapshot is freed once the lambda returns, outside of the lock.
+                    auto targets = strongThis->_terminal->GetHoverTargets();
+                    strongThis->_hoverTargets.lock()->swap(targets);
+                }
+            });
+
             THROW_IF_FAILED(localPointerToThread->Initialize(_renderer.get()));
         }
 
@@ -160,6 +271,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         //   need to hop across the process boundary every time text is output.
         //   We can throttle this to once every 8ms, which will get us out of
         //   the way of the main output & rendering threads.
+        // * _flushMouseMotion: A 1000 Hz mouse with any-event mouse tracking
+        //   enabled would otherwise write a motion report to the connection
+        //   every millisecond. The terminal holds back all but the latest one,
+        //   which we write at most once a frame.
+        // * _checkOutputRate: Measures how much output arrived since it last
+        //   ran. See _checkForOutputFlood().
+        // * _updateTitle, _updateTaskbarProgress: Progress bars of package
+        //   managers and the like set the title or the taskbar progress
+        //   hundreds of times a second. Each event makes the tab and the
+        //   window update their XAML, so we report the latest value at
+        //   most once a frame, and only if it changed.
+        // * _updateScrollbackBudget: Measuring the memory usage of the buffer
+        //   walks all of its rows. Once a second is plenty for a budget.
+        // * _trimHiddenRenderer: Releases the resources of the renderer, once
+        //   the control has been hidden for a while. See SetVisible().
         _tsfTryRedrawCanvas = std::make_shared<ThrottledFuncTrailing<>>(
             _dispatcher,
             TsfRedrawInterval,
@@ -180,6 +306,76 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 }
             });
 
+        _checkOutputRate = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            OutputRateCheckInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_checkForOutputFlood();
+                }
+            });
+
+        _updatePerformanceOverlay = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            PerformanceOverlayInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_refreshPerformanceOverlay();
+                }
+            });
+
+        _flushMouseMotion = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            MouseMotionFlushInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_terminal->FlushPendingMouseMotion();
+                }
+            });
+
+        _updateTitle = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            TitleUpdateInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_raiseTitleChanged();
+                }
+            });
+
+        _updateTaskbarProgress = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            TitleUpdateInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_raiseTaskbarProgressChanged();
+                }
+            });
+
+        _updateScrollbackBudget = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            ScrollbackBudgetInterval,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_reportScrollbackUsage();
+                }
+            });
+
+        _trimHiddenRenderer = std::make_shared<ThrottledFuncTrailing<>>(
+            _dispatcher,
+            HiddenTrimDelay,
+            [weakThis = get_weak()]() {
+                if (auto core{ weakThis.get() }; !core->_IsClosing())
+                {
+                    core->_trimRendererIfHidden();
+                }
+            });
+
         _updateScrollBar = std::make_shared<ThrottledFuncTrailing<Control::ScrollPositionChangedArgs>>(
             _dispatcher,
             ScrollBarUpdateInterval,
@@ -197,6 +393,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         Close();
 
+        // Close() dropped the output handler and with it the producer of the queue.
+        if (_parseThread.joinable())
+        {
+            _parseThread.join();
+        }
+
         if (_renderer)
         {
             _renderer->TriggerTeardown();
@@ -268,6 +470,18 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             _terminal->CreateFromSettings(*_settings, *_renderer);
 
+            if (!_bufferToRestore.empty())
+            {
+                try
+                {
+                    _terminal->RestoreBuffer(_bufferToRestore);
+                }
+                CATCH_LOG();
+                // The file is only good for one restore. It's saved again when the window closes.
+                DeleteFileW(_bufferToRestore.c_str());
+                _bufferToRestore = {};
+            }
+
             // IMPORTANT! Set this callback up sooner than later. If we do it
             // after Enable, then it'll be possible to paint the frame once
             // _before_ the warning handler is set up, and then warnings from
@@ -280,8 +494,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
             _renderEngine->SetRetroTerminalEffect(_settings->RetroTerminalEffect());
             _renderEngine->SetPixelShaderPath(_settings->PixelShaderPath());
+            _renderEngine->SetPixelShaderFrameRate(_settings->PixelShaderFrameRate());
             _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
             _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
+            _renderEngine->SetSharedDeviceRendering(_settings->SharedDeviceRendering());
 
             _updateAntiAliasingMode();
 
@@ -292,6 +508,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             THROW_IF_FAILED(_renderEngine->Enable());
 
             _initializedTerminal = true;
+            _publishCursorPosition();
         } // scope for TerminalLock
 
         // Start the connection outside of lock, because it could
@@ -423,7 +640,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                      const short wheelDelta,
                                      const TerminalInput::MouseButtonState state)
     {
-        return _terminal->SendMouseEvent(viewportPos.to_win32_coord(), uiButton, states, wheelDelta, state);
+        const auto handled = _terminal->SendMouseEvent(viewportPos.to_win32_coord(), uiButton, states, wheelDelta, state);
+        if (_terminal->HasPendingMouseMotion())
+        {
+            _flushMouseMotion->Run();
+        }
+        return handled;
     }
 
     void ControlCore::UserScrollViewport(const int viewTop)
@@ -438,6 +660,20 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _updatePatternLocations->Run();
     }
 
+    // Method Description:
+    // - Sets the fraction of a row that the viewport is scrolled beyond
+    //   ScrollOffset(). The renderer draws the rows shifted by as much, so
+    //   that scrolling by less than a row doesn't jump by whole rows.
+    // Arguments:
+    // - rows: the offset in rows, between 0 and 1
+    // Return Value:
+    // - <none>
+    void ControlCore::SetSmoothScrollOffset(const double rows)
+    {
+        auto lock = _terminal->LockForWriting();
+        _renderer->SetSmoothScrollOffset(gsl::narrow_cast<float>(rows));
+    }
+
     void ControlCore::AdjustOpacity(const double adjustment)
     {
         if (adjustment == 0)
@@ -511,16 +747,220 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _renderer->TriggerRedrawAll();
     }
 
+    // Method Description:
+    // - Shows or hides the performance overlay in the top right corner of the
+    //   viewport. While it's shown, it's refreshed every PerformanceOverlayInterval
+    //   with the rates since the previous refresh: how much output arrived, how
+    //   long it took to parse it, how many frames were painted, how long they
+    //   took and how long they waited for the terminal lock, how many glyphs
+    //   the renderer found in its atlas and how many chunks of output are queued.
+    // - Frames are only timed and output only measured while it's shown.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::TogglePerformanceOverlay()
+    {
+        const auto visible = !_performanceOverlayVisible.load(std::memory_order_relaxed);
+        _performanceOverlayVisible.store(visible, std::memory_order_relaxed);
+        _renderer->SetStatisticsEnabled(visible);
+
+        if (visible)
+        {
+            _performanceSnapshot = _takePerformanceSnapshot();
+            _updatePerformanceOverlay->Run();
+        }
+        else
+        {
+            auto lock = _terminal->LockForWriting();
+            _terminal->SetPerformanceOverlayUnderLock({});
+        }
+    }
+
+    ControlCore::PerformanceSnapshot ControlCore::_takePerformanceSnapshot() const noexcept
+    {
+        PerformanceSnapshot snapshot;
+        snapshot.time = std::chrono::steady_clock::now();
+        snapshot.outputCharacters = _outputCharacters.load(std::memory_order_relaxed);
+        snapshot.parseMicroseconds = _parseMicroseconds.load(std::memory_order_relaxed);
+        snapshot.frames = _renderer->GetStatistics();
+        _renderer->GetGlyphCacheStatistics(snapshot.glyphLookups, snapshot.glyphHits);
+        return snapshot;
+    }
+
+    // Method Description:
+    // - Replaces the text of the performance overlay with the rates since the
+    //   previous refresh, and schedules the next one. See TogglePerformanceOverlay().
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_refreshPerformanceOverlay()
+    {
+        if (!_performanceOverlayVisible.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        const auto snapshot = _takePerformanceSnapshot();
+        const auto& previous = _performanceSnapshot;
+        const auto seconds = std::max(std::chrono::duration<double>(snapshot.time - previous.time).count(), 0.001);
+        const auto frames = snapshot.frames.framesPainted - previous.frames.framesPainted;
+        const auto perFrame = [&](const uint64_t microseconds) {
+            return frames ? microseconds / 1000.0 / frames : 0.0;
+        };
+
+        std::vector<std::wstring> lines;
+        lines.emplace_back(fmt::format(L" Output {:9.0f} chars/s ", (snapshot.outputCharacters - previous.outputCharacters) / seconds));
+        lines.emplace_back(fmt::format(L" Parse  {:9.1f} ms/s ", (snapshot.parseMicroseconds - previous.parseMicroseconds) / 1000.0 / seconds));
+        lines.emplace_back(fmt::format(L" Frames {:9.1f} fps ", frames / seconds));
+        lines.emplace_back(fmt::format(L" Frame  {:9.2f} ms ", perFrame(snapshot.frames.frameMicroseconds - previous.frames.frameMicroseconds)));
+        lines.emplace_back(fmt::format(L" Lock   {:9.2f} ms ", perFrame(snapshot.frames.lockWaitMicroseconds - previous.frames.lockWaitMicroseconds)));
+        if (snapshot.glyphLookups)
+        {
+            const auto lookups = snapshot.glyphLookups - previous.glyphLookups;
+            const auto hits = snapshot.glyphHits - previous.glyphHits;
+            lines.emplace_back(fmt::format(L" Glyphs {:9.1f} % hit ", lookups ? 100.0 * hits / lookups : 100.0));
+        }
+        if (_parseThread.joinable())
+        {
+            lines.emplace_back(fmt::format(L" Queue  {:9} / {} ", _outputQueueDepth.load(std::memory_order_relaxed), OutputQueueCapacity));
+        }
+
+        _performanceSnapshot = snapshot;
+
+        {
+            auto lock = _terminal->LockForWriting();
+            _terminal->SetPerformanceOverlayUnderLock(lines);
+        }
+
+        _updatePerformanceOverlay->Run();
+    }
+
     // Method Description:
     // - Tell TerminalCore to update its knowledge about the locations of visible regex patterns
     // - We should call this (through the throttled function) when something causes the visible
     //   region to change, such as when new text enters the buffer or the viewport is scrolled
     void ControlCore::UpdatePatternLocations()
     {
+        // Hidden controls catch up once they're shown again. See SetVisible().
+        if (!_visible)
+        {
+            return;
+        }
+
         auto lock = _terminal->LockForWriting();
         _terminal->UpdatePatternsUnderLock();
     }
 
+    // Method Description:
+    // - Tells the control whether it can be seen, e.g. whether its tab is the
+    //   selected one. Hidden controls stop painting and looking for patterns,
+    //   but keep track of what changed in the meantime, and catch up with a
+    //   single frame once they're shown again. Once they've been hidden for
+    //   HiddenTrimDelay, their renderer releases its resources, too.
+    // Arguments:
+    // - visible: true if the control can be seen
+    void ControlCore::SetVisible(const bool visible)
+    {
+        if (_visible == visible)
+        {
+            return;
+        }
+        _visible = visible;
+
+        if (_renderer)
+        {
+            _renderer->SetHidden(!visible);
+        }
+
+        if (visible && _initializedTerminal)
+        {
+            _updatePatternLocations->Run();
+        }
+        else if (!visible)
+        {
+            _trimHiddenRenderer->Run();
+        }
+    }
+
+    // Method Description:
+    // - Makes the renderer release its glyph atlas, swap chain buffers and
+    //   scratch buffers, if the control is still hidden. They're recreated by
+    //   the next frame, once the control is shown again.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_trimRendererIfHidden()
+    {
+        if (!_visible && _renderer)
+        {
+            _renderer->TrimResources();
+        }
+    }
+
+    // Method Description:
+    // - Asks the renderer for a downscaled copy of the next frame, for instance
+    //   for the preview of a tab. ThumbnailReady is raised on the render thread
+    //   once the frame has been painted. Hidden controls paint that one frame.
+    // - Capturing a frame stalls the GPU. Callers are expected to ask for
+    //   thumbnails at a low rate, and not for every frame.
+    // Arguments:
+    // - maxWidth, maxHeight: the size in pixels the thumbnail has to fit into.
+    //   The frame is only ever halved, so the thumbnail may be smaller than that.
+    // Return Value:
+    // - false if the renderer can't capture thumbnails.
+    bool ControlCore::RequestThumbnail(const uint32_t maxWidth, const uint32_t maxHeight)
+    {
+        if (!_initializedTerminal)
+        {
+            return false;
+        }
+
+        {
+            auto lock = _terminal->LockForWriting();
+            const til::size maxSize{ gsl::narrow_cast<til::CoordType>(std::min<uint32_t>(maxWidth, INT32_MAX)),
+                                     gsl::narrow_cast<til::CoordType>(std::min<uint32_t>(maxHeight, INT32_MAX)) };
+            const auto hr = _renderEngine->RequestThumbnail(maxSize, [weakThis = get_weak()](::Microsoft::Console::Render::RenderThumbnail&& thumbnail) {
+                if (auto core{ weakThis.get() })
+                {
+                    core->_thumbnailCaptured(std::move(thumbnail));
+                }
+            });
+            if (FAILED(hr))
+            {
+                return false;
+            }
+        }
+
+        _renderer->SetHidden(false);
+        _renderer->NotifyPaintFrame();
+        return true;
+    }
+
+    void ControlCore::_thumbnailCaptured(::Microsoft::Console::Render::RenderThumbnail&& thumbnail)
+    {
+        // A hidden control only painted for the sake of the thumbnail.
+        if (!_visible)
+        {
+            _renderer->SetHidden(true);
+        }
+
+        const auto size = gsl::narrow<uint32_t>(thumbnail.pixels.size() * sizeof(uint32_t));
+        Windows::Storage::Streams::Buffer buffer{ size };
+        memcpy(buffer.data(), thumbnail.pixels.data(), size);
+        buffer.Length(size);
+
+        using namespace Windows::Graphics::Imaging;
+        const auto bitmap = SoftwareBitmap::CreateCopyFromBuffer(buffer,
+                                                                 BitmapPixelFormat::Bgra8,
+                                                                 thumbnail.size.width,
+                                                                 thumbnail.size.height,
+                                                                 BitmapAlphaMode::Premultiplied);
+        _ThumbnailReadyHandlers(*this, winrt::make<ThumbnailReadyEventArgs>(bitmap));
+    }
+
     // Method description:
     // - Updates last hovered cell, renders / removes rendering of hyper-link if required
     // Arguments:
@@ -541,8 +981,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
-        // GH#9618 - lock while we're reading from the terminal, and if we need
-        // to update something, then lock again to write the terminal.
+        // GH#9618 - The hyperlinks are looked up in the snapshot of the last frame,
+        // which doesn't need the terminal lock. The lock is only taken if we need
+        // to update something, which only happens when moving onto or off a link.
 
         _lastHoveredCell = terminalPosition;
         uint16_t newId{ 0u };
@@ -550,9 +991,13 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         decltype(_terminal->GetHyperlinkIntervalFromPosition(COORD{})) newInterval{ std::nullopt };
         if (terminalPosition.has_value())
         {
-            auto lock = _terminal->LockForReading(); // Lock for the duration of our reads.
-            newId = _terminal->GetHyperlinkIdAtPosition(terminalPosition->to_win32_coord());
-            newInterval = _terminal->GetHyperlinkIntervalFromPosition(terminalPosition->to_win32_coord());
+            // Only the pointer is copied under the lock of the snapshot, the rest is immutable.
+            const auto targets = *_hoverTargets.lock_shared();
+            if (targets)
+            {
+                newId = targets->GetHyperlinkIdAtPosition(terminalPosition->to_win32_coord());
+                newInterval = targets->GetHyperlinkIntervalFromPosition(terminalPosition->to_win32_coord());
+            }
         }
 
         // If the hyperlink ID changed or the interval changed, trigger a redraw all
@@ -605,7 +1050,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // - INVARIANT: This method can only be called if the caller DOES NOT HAVE writing lock on the terminal.
     void ControlCore::UpdateSettings(const IControlSettings& settings, const IControlAppearance& newAppearance)
     {
-        _settings = winrt::make_self<implementation::ControlSettings>(settings, newAppearance);
+        const auto oldSettings = std::exchange(_settings, winrt::make_self<implementation::ControlSettings>(settings, newAppearance));
+        // Reloading the settings pushes them to every control, even if nothing
+        // about their font changed. Loading the font again is an expensive
+        // no-op then, which also loses any font size the user zoomed to.
+        const auto fontChanged = !_initializedTerminal || !oldSettings || _FontSettingsChanged(*oldSettings, *_settings);
 
         auto lock = _terminal->LockForWriting();
 
@@ -621,18 +1070,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
 
         // Initialize our font information.
-        const auto fontFace = _settings->FontFace();
-        const short fontHeight = ::base::saturated_cast<short>(_settings->FontSize());
-        const auto fontWeight = _settings->FontWeight();
-        // The font width doesn't terribly matter, we'll only be using the
-        //      height to look it up
-        // The other params here also largely don't matter.
-        //      The family is only used to determine if the font is truetype or
-        //      not, but DX doesn't use that info at all.
-        //      The Codepage is additionally not actually used by the DX engine at all.
-        _actualFont = { fontFace, 0, fontWeight.Weight, { 0, fontHeight }, CP_UTF8, false };
-        _actualFontFaceName = { fontFace };
-        _desiredFont = { _actualFont };
+        if (fontChanged)
+        {
+            const auto fontFace = _settings->FontFace();
+            const short fontHeight = ::base::saturated_cast<short>(_settings->FontSize());
+            const auto fontWeight = _settings->FontWeight();
+            // The font width doesn't terribly matter, we'll only be using the
+            //      height to look it up
+            // The other params here also largely don't matter.
+            //      The family is only used to determine if the font is truetype or
+            //      not, but DX doesn't use that info at all.
+            //      The Codepage is additionally not actually used by the DX engine at all.
+            _actualFont = { fontFace, 0, fontWeight.Weight, { 0, fontHeight }, CP_UTF8, false };
+            _actualFontFaceName = { fontFace };
+            _desiredFont = { _actualFont };
+        }
 
         // Update the terminal core with its new Core settings
         _terminal->UpdateSettings(*_settings);
@@ -646,18 +1098,26 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         _renderEngine->SetForceFullRepaintRendering(_settings->ForceFullRepaintRendering());
         _renderEngine->SetSoftwareRendering(_settings->SoftwareRendering());
+        _renderEngine->SetSharedDeviceRendering(_settings->SharedDeviceRendering());
+        _renderEngine->SetPixelShaderFrameRate(_settings->PixelShaderFrameRate());
         // Inform the renderer of our opacity
         _renderEngine->EnableTransparentBackground(_isBackgroundTransparent());
 
         _updateAntiAliasingMode();
 
+        // The "experimental.scrollbackMemoryBudget" may have changed.
+        _updateScrollbackBudget->Run();
+
         // Refresh our font with the renderer
-        const auto actualFontOldSize = _actualFont.GetSize();
-        _updateFont();
-        const auto actualFontNewSize = _actualFont.GetSize();
-        if (actualFontNewSize != actualFontOldSize)
+        if (fontChanged)
         {
-            _refreshSizeUnderLock();
+            const auto actualFontOldSize = _actualFont.GetSize();
+            _updateFont();
+            const auto actualFontNewSize = _actualFont.GetSize();
+            if (actualFontNewSize != actualFontOldSize)
+            {
+                _refreshSizeUnderLock();
+            }
         }
     }
 
@@ -879,6 +1339,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // If this function succeeds with S_FALSE, then the terminal didn't
         // actually change size. No need to notify the connection of this no-op.
         const HRESULT hr = _terminal->UserResize({ vp.Width(), vp.Height() });
+        ++_bufferGeneration;
+        // The reflow may have moved the cursor, without any output that would've told us.
+        _publishCursorPosition();
         if (SUCCEEDED(hr) && hr != S_FALSE)
         {
             _connection.Resize(vp.Height(), vp.Width());
@@ -891,33 +1354,106 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _panelWidth = width;
         _panelHeight = height;
 
-        auto lock = _terminal->LockForWriting();
-        const auto currentEngineScale = _renderEngine->GetScaling();
+        // If we're still busy reflowing the buffer for a previous size, give
+        // up on that. It would be thrown away right after it's done anyway.
+        _terminal->CancelResize();
 
-        auto scaledWidth = width * currentEngineScale;
-        auto scaledHeight = height * currentEngineScale;
-        _doResizeUnderLock(scaledWidth, scaledHeight);
+        _resizeAsync(width, height);
     }
 
-    void ControlCore::ScaleChanged(const double scale)
+    // Method Description:
+    // - Resizes the buffer on a background thread. Reflowing a buffer with a
+    //   lot of scrollback takes a while, and when a window is resized, all of
+    //   its panes are at once. Since each of them reflows on a thread of its
+    //   own, under the lock of its own Terminal, the resize of the window takes
+    //   as long as the one of its largest pane, instead of all of them in turn.
+    // - Only the latest size matters: if another resize arrives before this
+    //   one got the lock, this one is skipped.
+    // Arguments:
+    // - width, height: the new size of the control, in DIPs
+    // Return Value:
+    // - <none>
+    winrt::fire_and_forget ControlCore::_resizeAsync(const double width, const double height)
     {
-        if (!_renderEngine)
+        const auto generation = ++_resizeGeneration;
+        auto weakThis{ get_weak() };
+
+        co_await winrt::resume_background();
+
+        auto core{ weakThis.get() };
+        if (!core || core->_IsClosing() || core->_resizeGeneration != generation)
         {
-            return;
+            co_return;
         }
 
-        const auto currentEngineScale = _renderEngine->GetScaling();
-        // If we're getting a notification to change to the DPI we already
-        // have, then we're probably just beginning the DPI change. Since
-        // we'll get _another_ event with the real DPI, do nothing here for
-        // now. We'll also skip the next resize in _swapChainSizeChanged.
-        const bool dpiWasUnchanged = currentEngineScale == scale;
-        if (dpiWasUnchanged)
+        try
         {
-            return;
+            auto lock = core->_terminal->LockForWriting();
+            if (core->_resizeGeneration != generation)
+            {
+                co_return;
+            }
+
+            const auto currentEngineScale = core->_renderEngine->GetScaling();
+
+            auto scaledWidth = width * currentEngineScale;
+            auto scaledHeight = height * currentEngineScale;
+            core->_doResizeUnderLock(scaledWidth, scaledHeight);
         }
+        CATCH_LOG();
+    }
 
-        const auto actualFontOldSize = _actualFont.GetSize();
+    // Method Description:
+    // - Resizes only the swap chain, while the control is in the middle of
+    //   being resized. The buffer keeps its size, and is drawn clipped or
+    //   padded, until SizeChanged() is called with the settled size. This
+    //   saves a reflow of the buffer, and of the one of conhost behind the
+    //   connection, for every step of the resize.
+    // Arguments:
+    // - width, height: the new size of the control, in DIPs
+    void ControlCore::SizeChanging(const double width,
+                                   const double height)
+    {
+        // The size changed again, so a reflow for the previously settled size
+        // is outdated. It holds the lock, so give up on it before we wait.
+        _terminal->CancelResize();
+
+        auto lock = _terminal->LockForWriting();
+        const auto currentEngineScale = _renderEngine->GetScaling();
+
+        SIZE size;
+        size.cx = static_cast<long>(width * currentEngineScale);
+        size.cy = static_cast<long>(height * currentEngineScale);
+
+        // See _doResizeUnderLock().
+        if (size.cx < _actualFont.GetSize().X || size.cy < _actualFont.GetSize().Y)
+        {
+            return;
+        }
+
+        THROW_IF_FAILED(_renderEngine->SetWindowSize(size));
+        _renderer->TriggerRedrawAll();
+    }
+
+    void ControlCore::ScaleChanged(const double scale)
+    {
+        if (!_renderEngine)
+        {
+            return;
+        }
+
+        const auto currentEngineScale = _renderEngine->GetScaling();
+        // If we're getting a notification to change to the DPI we already
+        // have, then we're probably just beginning the DPI change. Since
+        // we'll get _another_ event with the real DPI, do nothing here for
+        // now. We'll also skip the next resize in _swapChainSizeChanged.
+        const bool dpiWasUnchanged = currentEngineScale == scale;
+        if (dpiWasUnchanged)
+        {
+            return;
+        }
+
+        const auto actualFontOldSize = _actualFont.GetSize();
 
         auto lock = _terminal->LockForWriting();
         _compositionScale = scale;
@@ -1161,20 +1697,44 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     }
 
     // Method Description:
-    // - Called for the Terminal's TitleChanged callback. This will re-raise
-    //   a new winrt TypedEvent that can be listened to.
-    // - The listeners to this event will re-query the control for the current
-    //   value of Title().
+    // - Called for the Terminal's TitleChanged callback. The TitleChanged
+    //   event is raised by _raiseTitleChanged, at most once a frame.
     // Arguments:
-    // - wstr: the new title of this terminal.
+    // - <unused> the new title of this terminal.
     // Return Value:
     // - <none>
-    void ControlCore::_terminalTitleChanged(std::wstring_view wstr)
+    void ControlCore::_terminalTitleChanged(std::wstring_view /*wstr*/)
     {
         // Since this can only ever be triggered by output from the connection,
         // then the Terminal already has the write lock when calling this
         // callback.
-        _TitleChangedHandlers(*this, winrt::make<TitleChangedEventArgs>(winrt::hstring{ wstr }));
+        _updateTitle->Run();
+    }
+
+    // Method Description:
+    // - Raises a new winrt TypedEvent that can be listened to, if the title
+    //   changed since the last time. Runs on the UI thread.
+    // - The listeners to this event will re-query the control for the current
+    //   value of Title().
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_raiseTitleChanged()
+    {
+        winrt::hstring title;
+        {
+            auto lock = _terminal->LockForReading();
+            const auto current = _terminal->GetConsoleTitle();
+            if (current == std::wstring_view{ _lastReportedTitle })
+            {
+                return;
+            }
+            title = winrt::hstring{ current };
+        }
+
+        _lastReportedTitle = title;
+        _TitleChangedHandlers(*this, winrt::make<TitleChangedEventArgs>(std::move(title)));
     }
 
     // Method Description:
@@ -1227,6 +1787,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // TODO GH#9617: refine locking around pattern tree
         _terminal->ClearPatternTree();
 
+        // The terminal scrolled on its own, which puts the viewport back onto a row.
+        _renderer->SetSmoothScrollOffset(0);
+
         // Start the throttled update of our scrollbar.
         auto update{ winrt::make<ScrollPositionChangedArgs>(viewTop,
                                                             viewHeight,
@@ -1246,16 +1809,123 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     void ControlCore::_terminalCursorPositionChanged()
     {
+        // The terminal calls this under its lock, after it parsed a run of output.
+        _publishCursorPosition();
+
         // When the buffer's cursor moves, start the throttled func to
         // eventually dispatch a CursorPositionChanged event.
         _tsfTryRedrawCanvas->Run();
     }
 
+    // Method Description:
+    // - Publishes the position of the cursor for CursorPosition(), so that
+    //   TSF can place the composition without taking the terminal lock. While
+    //   an IME user types during heavy output, this would otherwise compete
+    //   with the parse thread for the lock on every update of the composition.
+    // - Must be called under the terminal lock.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_publishCursorPosition()
+    {
+        _cursorPosition.store(til::point{ _terminal->GetCursorPosition() }, std::memory_order_relaxed);
+    }
+
     void ControlCore::_terminalTaskbarProgressChanged()
     {
+        _updateTaskbarProgress->Run();
+    }
+
+    // Method Description:
+    // - Raises TaskbarProgressChanged, if the taskbar state or progress
+    //   changed since the last time. Runs on the UI thread.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_raiseTaskbarProgressChanged()
+    {
+        std::pair<size_t, size_t> taskbarProgress;
+        {
+            auto lock = _terminal->LockForReading();
+            taskbarProgress = { _terminal->GetTaskbarState(), _terminal->GetTaskbarProgress() };
+        }
+
+        if (taskbarProgress == _lastReportedTaskbarProgress)
+        {
+            return;
+        }
+
+        _lastReportedTaskbarProgress = taskbarProgress;
         _TaskbarProgressChangedHandlers(*this, nullptr);
     }
 
+    // Method Description:
+    // - Tells the ScrollbackBudget whether this control has focus. The one
+    //   with focus is never asked to pack its scrollback aggressively, and the
+    //   others are asked in the order in which they lost focus.
+    // Arguments:
+    // - focused: whether the control has focus
+    // Return Value:
+    // - <none>
+    void ControlCore::FocusChanged(const bool focused)
+    {
+        if (_focused != focused)
+        {
+            _focused = focused;
+            _updateScrollbackBudget->Run();
+        }
+    }
+
+    // Method Description:
+    // - Reports the memory usage of the buffer to the ScrollbackBudget, if
+    //   there's an "experimental.scrollbackMemoryBudget". We only register with
+    //   it on the first report, so that controls don't take part without a budget.
+    // - The budget may put this control under pressure in return, which makes
+    //   the terminal pack all of its scrollback. See Terminal::SetScrollbackCompaction().
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_reportScrollbackUsage()
+    {
+        const auto budget = gsl::narrow_cast<size_t>(std::max(0, _settings->ScrollbackMemoryBudget())) * 1024 * 1024;
+        if (budget == 0 && _scrollbackBudgetId == 0)
+        {
+            return;
+        }
+
+        auto& scrollbackBudget = ::Microsoft::Terminal::Control::ScrollbackBudget::Instance();
+        if (_scrollbackBudgetId == 0)
+        {
+            // The budget calls us back on the thread of whichever control reported a change.
+            _scrollbackBudgetId = scrollbackBudget.Register([weakThis = get_weak(), dispatcher = _dispatcher](const bool underPressure) {
+                dispatcher.TryEnqueue(DispatcherQueuePriority::Low, [weakThis, underPressure]() {
+                    if (auto core{ weakThis.get() }; core && !core->_IsClosing())
+                    {
+                        {
+                            auto lock = core->_terminal->LockForWriting();
+                            core->_terminal->SetScrollbackCompaction(underPressure);
+                        }
+                        if (underPressure)
+                        {
+                            core->_trimRendererIfHidden();
+                        }
+                    }
+                });
+            });
+        }
+
+        size_t usage = 0;
+        {
+            auto lock = _terminal->LockForReading();
+            usage = _terminal->GetBufferMemoryUsage();
+        }
+
+        scrollbackBudget.Update(_scrollbackBudgetId, usage, _focused, budget);
+    }
+
     bool ControlCore::HasSelection() const
     {
         return _terminal->IsSelectionActive();
@@ -1288,6 +1958,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // Method Description:
     // - Search text in text buffer. This is triggered if the user click
     //   search button or press enter.
+    // - The search runs in the background, see _searchAsync. Starting another
+    //   search, like when the user types the next character of it, cancels
+    //   the one that's still running.
     // Arguments:
     // - text: the text to search
     // - goForward: boolean that represents if the current search direction is forward
@@ -1303,6 +1976,32 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
+        _searchAsync(text, goForward, caseSensitive);
+    }
+
+    // Method Description:
+    // - Finds all matches of the text on a background thread, in a snapshot of
+    //   the buffer, and then selects the next one back on the UI thread.
+    // - The lock is only held to take the snapshot, which is reused by
+    //   further searches until the buffer changes. That way neither the UI
+    //   nor the output are held up by a search through a large scrollback.
+    // - Output that arrives during the search moves the text around. The
+    //   search is then repeated in a fresh snapshot, a few times at most. After
+    //   that, we give up on the background and search under the lock instead.
+    // Arguments:
+    // - text: the text to search
+    // - goForward: boolean that represents if the current search direction is forward
+    // - caseSensitive: boolean that represents if the current search is case sensitive
+    // Return Value:
+    // - <none>
+    winrt::fire_and_forget ControlCore::_searchAsync(const winrt::hstring text,
+                                                     const bool goForward,
+                                                     const bool caseSensitive)
+    {
+        const auto generation = ++_searchGeneration;
+        const auto dispatcher = _dispatcher;
+        auto weakThis{ get_weak() };
+
         const Search::Direction direction = goForward ?
                                                 Search::Direction::Forward :
                                                 Search::Direction::Backward;
@@ -1311,20 +2010,165 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                                     Search::Sensitivity::CaseSensitive :
                                                     Search::Sensitivity::CaseInsensitive;
 
-        ::Search search(*GetUiaData(), text.c_str(), direction, sensitivity);
-        auto lock = _terminal->LockForWriting();
-        const bool foundMatch{ search.FindNext() };
+        const std::wstring needle{ text };
+        std::vector<std::pair<COORD, COORD>> matches;
+        uint64_t bufferGeneration = 0;
+        auto upToDate = false;
+
+        co_await winrt::resume_background();
+
+        for (auto attempt = 0; attempt < MaxSearchAttempts && !upToDate; ++attempt)
+        {
+            auto core{ weakThis.get() };
+            if (!core || core->_IsClosing() || core->_searchGeneration != generation)
+            {
+                co_return;
+            }
+
+            std::shared_ptr<const ::Search::Snapshot> snapshot;
+            std::tie(snapshot, bufferGeneration) = core->_getSearchSnapshot(sensitivity);
+
+            matches = ::Search::s_FindAll(*snapshot, needle, [&]() {
+                return core->_searchGeneration.load(std::memory_order_relaxed) != generation;
+            });
+            upToDate = core->_bufferGeneration == bufferGeneration;
+        }
+
+        co_await winrt::resume_foreground(dispatcher);
+
+        auto core{ weakThis.get() };
+        if (!core || core->_IsClosing() || core->_searchGeneration != generation)
+        {
+            co_return;
+        }
+
+        auto lock = core->_terminal->LockForWriting();
+        std::optional<::Search> search;
+        if (core->_bufferGeneration == bufferGeneration)
+        {
+            search.emplace(*core->GetUiaData(), needle, direction, sensitivity, std::move(matches));
+        }
+        else
+        {
+            search.emplace(*core->GetUiaData(), needle, direction, sensitivity);
+        }
+
+        const bool foundMatch{ search->FindNext() };
+        core->_terminal->SetSearchMarks(search->FindAll());
         if (foundMatch)
         {
-            _terminal->SetBlockSelection(false);
-            search.Select();
-            _renderer->TriggerSelection();
+            core->_terminal->SetBlockSelection(false);
+            search->Select();
+            core->_renderer->TriggerSelection();
         }
+        lock.unlock();
 
         // Raise a FoundMatch event, which the control will use to notify
         // narrator if there was any results in the buffer
         auto foundResults = winrt::make_self<implementation::FoundResultsArgs>(foundMatch);
-        _FoundMatchHandlers(*this, *foundResults);
+        core->_FoundMatchHandlers(*core, *foundResults);
+    }
+
+    // Method Description:
+    // - Removes the marks of the results of the last search, once the search
+    //   box is closed. Also cancels the search, if it's still running.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::ClearSearch()
+    {
+        ++_searchGeneration;
+        auto lock = _terminal->LockForWriting();
+        _terminal->SetSearchMarks({});
+    }
+
+    // Method Description:
+    // - Scrolls the previous or next prompt that the shell reported to the top
+    //   of the viewport.
+    // Arguments:
+    // - goForward: true to scroll to the next prompt, false to the previous one
+    // Return Value:
+    // - false if there's no prompt in that direction.
+    bool ControlCore::ScrollToPrompt(const bool goForward)
+    {
+        _terminal->ClearPatternTree();
+        auto lock = _terminal->LockForWriting();
+        const auto scrolled = _terminal->ScrollToPrompt(goForward);
+        lock.unlock();
+
+        _updatePatternLocations->Run();
+        return scrolled;
+    }
+
+    // Method Description:
+    // - Selects the output of the command the selection starts in, or of the
+    //   last one that finished, if there's no selection.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - false if there's no such command, or it didn't output anything.
+    bool ControlCore::SelectCommandOutput()
+    {
+        auto lock = _terminal->LockForWriting();
+        if (!_terminal->SelectCommandOutput())
+        {
+            return false;
+        }
+        _terminal->SetBlockSelection(false);
+        _renderer->TriggerSelection();
+        return true;
+    }
+
+    // Method Description:
+    // - Returns the marks of the rows of the buffer, for the scrollbar: the
+    //   prompts and failed commands that the shell reported, and the results
+    //   of the last search.
+    // - The marks are kept up to date as the output arrives, so this only
+    //   costs as much as there are marks. Callers can compare
+    //   ScrollMarksGeneration() to skip asking again, when nothing changed.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - The marks, ordered by their row.
+    Windows::Foundation::Collections::IVector<Control::ScrollMark> ControlCore::ScrollMarks()
+    {
+        auto lock = _terminal->LockForReading();
+        const auto marks = _terminal->GetScrollMarks();
+        lock.unlock();
+
+        std::vector<Control::ScrollMark> result;
+        result.reserve(marks.size());
+        for (const auto& mark : marks)
+        {
+            result.push_back(Control::ScrollMark{ gsl::narrow_cast<int32_t>(mark.row), static_cast<Control::ScrollMarkCategory>(mark.category) });
+        }
+        return winrt::single_threaded_vector(std::move(result));
+    }
+
+    uint64_t ControlCore::ScrollMarksGeneration()
+    {
+        auto lock = _terminal->LockForReading();
+        return _terminal->GetScrollMarksGeneration();
+    }
+
+    // Method Description:
+    // - Returns a snapshot of the buffer to search in, taking a new one only if
+    //   the buffer changed since the last one.
+    // Arguments:
+    // - sensitivity: whether the search cares about case
+    // Return Value:
+    // - The snapshot, and the _bufferGeneration it was taken at.
+    std::pair<std::shared_ptr<const ::Search::Snapshot>, uint64_t> ControlCore::_getSearchSnapshot(const ::Search::Sensitivity sensitivity)
+    {
+        auto lock = _terminal->LockForReading();
+        const uint64_t generation = _bufferGeneration;
+        if (!_searchSnapshot || _searchSnapshotGeneration != generation || _searchSnapshot->sensitivity != sensitivity)
+        {
+            _searchSnapshot = std::make_shared<const ::Search::Snapshot>(::Search::s_TakeSnapshot(*GetUiaData(), sensitivity));
+            _searchSnapshotGeneration = generation;
+        }
+        return { _searchSnapshot, generation };
     }
 
     // Method Description:
@@ -1358,11 +2202,22 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (!_IsClosing())
         {
             _closing = true;
+            // Cancel any search that's still running.
+            ++_searchGeneration;
 
             // Stop accepting new output and state changes before we disconnect everything.
             _connection.TerminalOutput(_connectionOutputEventToken);
+            if (const auto directOutput = _connection.try_as<IDirectConnectionOutput>())
+            {
+                directOutput->SetDirectOutputHandler(nullptr);
+            }
             _connectionStateChangedRevoker.revoke();
 
+            if (_scrollbackBudgetId)
+            {
+                ::Microsoft::Terminal::Control::ScrollbackBudget::Instance().Unregister(std::exchange(_scrollbackBudgetId, 0));
+            }
+
             // GH#1996 - Close the connection asynchronously on a background
             // thread.
             // Since TermControl::Close is only ever triggered by the UI, we
@@ -1441,8 +2296,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return { 0, 0 };
         }
 
-        auto lock = _terminal->LockForReading();
-        return til::point{ _terminal->GetCursorPosition() }.to_core_point();
+        // No lock needed. See _publishCursorPosition().
+        return _cursorPosition.load(std::memory_order_relaxed).to_core_point();
     }
 
     // This one's really pushing the boundary of what counts as "encapsulation".
@@ -1511,10 +2366,27 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     void ControlCore::AttachUiaEngine(::Microsoft::Console::Render::IRenderEngine* const pEngine)
     {
+        // The render thread walks the list of engines under this lock.
+        auto lock = _terminal->LockForWriting();
         // _renderer will always exist since it's introduced in the ctor
         _renderer->AddRenderEngine(pEngine);
     }
 
+    // Method Description:
+    // - Stops sending rendering calls to an engine that was attached with
+    //   AttachUiaEngine. The engine must stay alive until the ControlCore is
+    //   destroyed, because a frame that's already being painted might still
+    //   present to it.
+    // Arguments:
+    // - pEngine: the engine to detach
+    // Return Value:
+    // - <none>
+    void ControlCore::DetachUiaEngine(::Microsoft::Console::Render::IRenderEngine* const pEngine)
+    {
+        auto lock = _terminal->LockForWriting();
+        _renderer->RemoveRenderEngine(pEngine);
+    }
+
     bool ControlCore::IsInReadOnlyMode() const
     {
         return _isReadOnly;
@@ -1530,12 +2402,208 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         auto noticeArgs = winrt::make<NoticeEventArgs>(NoticeLevel::Info, RS_(L"TermControlReadOnly"));
         _RaiseNoticeHandlers(*this, std::move(noticeArgs));
     }
-    void ControlCore::_connectionOutputHandler(const hstring& hstr)
+    void ControlCore::_connectionOutputHandler(const std::wstring_view str)
     {
-        _terminal->Write(hstr);
+        // Output that the user skipped is still logged.
+        if (_sessionLogger)
+        {
+            _sessionLogger->Append(str);
+        }
+
+        if (!_trackOutput(str.size()))
+        {
+            return;
+        }
+
+        _writeOutput({ &str, 1 });
+        ++_bufferGeneration;
+        _updateScrollbackBudget->Run();
 
         // Start the throttled update of where our hyperlinks are.
-        _updatePatternLocations->Run();
+        if (!_outputFlooding.load(std::memory_order_relaxed))
+        {
+            _updatePatternLocations->Run();
+        }
+    }
+
+    // Method Description:
+    // - Starts logging the output of the connection, if the profile asks for it
+    //   with "experimental.sessionLogDirectory". Failing to do so doesn't keep
+    //   the session from starting.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_startSessionLog() noexcept
+    try
+    {
+        const auto directory = _settings->SessionLogDirectory();
+        if (directory.empty())
+        {
+            return;
+        }
+
+        ::Microsoft::Terminal::Control::SessionLogger::Options options;
+        options.directory = wil::ExpandEnvironmentStringsW<std::wstring>(directory.c_str());
+        options.format = _settings->SessionLogFormat();
+        options.rotateSize = gsl::narrow_cast<uint64_t>(std::max(0, _settings->SessionLogRotateSize())) * 1024 * 1024;
+        options.rotateInterval = std::chrono::minutes{ std::max(0, _settings->SessionLogRotateInterval()) };
+        _sessionLogger = std::make_unique<::Microsoft::Terminal::Control::SessionLogger>(std::move(options));
+    }
+    CATCH_LOG()
+
+    // Method Description:
+    // - Accounts for output that arrived, for _checkForOutputFlood().
+    // Arguments:
+    // - size: the number of characters that arrived
+    // Return Value:
+    // - false if the user asked to skip the output, and it should be discarded.
+    bool ControlCore::_trackOutput(const size_t size)
+    {
+        // The buffer is about to change. The writer bumps the generation again
+        // once it did, so that searches notice either way. See _getSearchSnapshot().
+        ++_bufferGeneration;
+        _recentOutputSize.fetch_add(size, std::memory_order_relaxed);
+        if (_performanceOverlayVisible.load(std::memory_order_relaxed))
+        {
+            _outputCharacters.fetch_add(size, std::memory_order_relaxed);
+        }
+        _checkOutputRate->Run();
+        return !_skippingOutput.load(std::memory_order_relaxed);
+    }
+
+    // Method Description:
+    // - Parses output of the connection. While the performance overlay is shown,
+    //   the time that takes, including the wait for the terminal lock, is measured.
+    // Arguments:
+    // - strings: the output to parse
+    // Return Value:
+    // - <none>
+    void ControlCore::_writeOutput(const gsl::span<const std::wstring_view> strings)
+    {
+        if (!_performanceOverlayVisible.load(std::memory_order_relaxed))
+        {
+            _terminal->Write(strings);
+            return;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        _terminal->Write(strings);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        _parseMicroseconds.fetch_add(gsl::narrow_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+    }
+
+    // Method Description:
+    // - Called every OutputRateCheckInterval while output is arriving. Once more
+    //   output arrives than anyone could read, like when someone accidentally
+    //   prints a huge log file, painting all of it would only slow down its
+    //   parsing. Until the output calms down again, the display is then updated
+    //   only a few times per second, which limits the accessibility
+    //   notifications just the same, and hyperlinks aren't searched for.
+    // - In the meantime, SkipOutput() can discard the rest of it.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::_checkForOutputFlood()
+    {
+        const auto flooding = _recentOutputSize.exchange(0, std::memory_order_relaxed) >= OutputFloodThreshold;
+        if (flooding)
+        {
+            // Nothing else would trigger us once the output stops. Keep checking.
+            _checkOutputRate->Run();
+        }
+
+        if (flooding == _outputFlooding.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        _outputFlooding.store(flooding, std::memory_order_relaxed);
+
+        if (_renderer)
+        {
+            _renderer->SetThrottled(flooding);
+        }
+
+        if (!flooding)
+        {
+            if (_skippingOutput.exchange(false, std::memory_order_relaxed))
+            {
+                // The output was cut off anywhere, possibly in the middle of a sequence.
+                auto lock = _terminal->LockForWriting();
+                _terminal->ResetParserState();
+            }
+            _updatePatternLocations->Run();
+        }
+    }
+
+    // Method Description:
+    // - Discards the output that's queued up and arrives from now on, until the
+    //   output calms down. Only has an effect while the output is running away.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlCore::SkipOutput()
+    {
+        if (_outputFlooding.load(std::memory_order_relaxed))
+        {
+            _skippingOutput.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // Method Description:
+    // - The body of the parse thread. With Feature_DecoupledOutputParsing, the
+    //   thread that reads the output of the connection only puts it into a
+    //   bounded queue, so that it can go back to reading while we parse. Once the
+    //   queue is full, it waits for us, which pushes back on the connection.
+    // - Everything that piled up in the queue in the meantime is parsed with a
+    //   single acquisition of the terminal lock.
+    // Arguments:
+    // - queue: the consumer end of the queue
+    // Return Value:
+    // - <none>
+    void ControlCore::_parseOutputThread(const til::spsc::consumer<std::wstring>& queue)
+    {
+        std::array<std::wstring, OutputQueueCapacity> chunks;
+        std::array<std::wstring_view, OutputQueueCapacity> views;
+
+        for (;;)
+        {
+            const auto [count, alive] = queue.pop_n(til::spsc::block_initially, chunks.begin(), chunks.size());
+            if (count)
+            {
+                _outputQueueDepth.fetch_sub(count, std::memory_order_relaxed);
+
+                size_t size = 0;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    til::at(views, i) = til::at(chunks, i);
+                    size += til::at(views, i).size();
+                }
+
+                // An exception must not end the thread, or the connection
+                // would block forever once it has filled up the queue.
+                try
+                {
+                    if (_trackOutput(size))
+                    {
+                        _writeOutput({ views.data(), count });
+                        ++_bufferGeneration;
+                        _updateScrollbackBudget->Run();
+                        if (!_outputFlooding.load(std::memory_order_relaxed))
+                        {
+                            _updatePatternLocations->Run();
+                        }
+                    }
+                }
+                CATCH_LOG();
+            }
+            if (!alive)
+            {
+                break;
+            }
+        }
     }
 
     // Method Description:
@@ -1572,29 +2640,38 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     hstring ControlCore::ReadEntireBuffer() const
     {
         auto terminalLock = _terminal->LockForWriting();
+        return hstring{ _terminal->GetRowsText(0, _terminal->GetLastNonSpaceRow()) };
+    }
 
-        const auto& textBuffer = _terminal->GetTextBuffer();
-
-        std::wstringstream ss;
-        const auto lastRow = textBuffer.GetLastNonSpaceCharacter().Y;
-        for (auto rowIndex = 0; rowIndex <= lastRow; rowIndex++)
+    // Method Description:
+    // - Saves the contents of the buffer into the given file, so that a later
+    //   session can bring them back with RestoreBuffer().
+    // Arguments:
+    // - path: the file to save the buffer into
+    // Return Value:
+    // - <none>
+    void ControlCore::PersistBuffer(const hstring& path) const
+    {
+        if (!_initializedTerminal)
         {
-            const auto& row = textBuffer.GetRowByOffset(rowIndex);
-            auto rowText = row.GetText();
-            const auto strEnd = rowText.find_last_not_of(UNICODE_SPACE);
-            if (strEnd != std::string::npos)
-            {
-                rowText.erase(strEnd + 1);
-                ss << rowText;
-            }
-
-            if (!row.WasWrapForced())
-            {
-                ss << UNICODE_CARRIAGERETURN << UNICODE_LINEFEED;
-            }
+            return;
         }
 
-        return hstring(ss.str());
+        auto terminalLock = _terminal->LockForWriting();
+        _terminal->PersistBuffer(path);
+    }
+
+    // Method Description:
+    // - Makes the control show the contents of a buffer that PersistBuffer()
+    //   saved before its connection starts. Must be called before Initialize().
+    //   The file is deleted once it was restored.
+    // Arguments:
+    // - path: the file to restore the buffer from
+    // Return Value:
+    // - <none>
+    void ControlCore::RestoreBuffer(const hstring& path)
+    {
+        _bufferToRestore = path;
     }
 
     // Helper to check if we're on Windows 11 or not. This is used to check if
@@ -17,11 +17,15 @@
 
 #include "ControlCore.g.h"
 #include "ControlSettings.h"
+#include "SessionLogger.h"
+#include "ScrollbackBudget.h"
 #include "../../renderer/base/Renderer.hpp"
 #include "../../cascadia/TerminalCore/Terminal.hpp"
 #include "../buffer/out/search.h"
 
+#include <til/spsc.h>
 #include <til/ticket_lock.h>
+#include <til/mutex.h>
 
 namespace ControlUnitTests
 {
@@ -63,6 +67,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void ColorScheme(const winrt::Microsoft::Terminal::Core::Scheme& scheme);
 
         void SizeChanged(const double width, const double height);
+        void SizeChanging(const double width, const double height);
         void ScaleChanged(const double scale);
         uint64_t SwapChainHandle() const;
 
@@ -82,10 +87,14 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         bool CopySelectionToClipboard(bool singleLine, const Windows::Foundation::IReference<CopyFormat>& formats);
 
         void ToggleShaderEffects();
+        void TogglePerformanceOverlay();
+        void SkipOutput();
         void AdjustOpacity(const double adjustment);
         void ResumeRendering();
 
         void UpdatePatternLocations();
+        void SetVisible(const bool visible);
+        bool RequestThumbnail(const uint32_t maxWidth, const uint32_t maxHeight);
         void SetHoveredCell(Core::Point terminalPosition);
         void ClearHoveredCell();
         winrt::hstring GetHyperlink(const Core::Point position) const;
@@ -127,6 +136,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                             const short wheelDelta,
                             const ::Microsoft::Console::VirtualTerminal::TerminalInput::MouseButtonState state);
         void UserScrollViewport(const int viewTop);
+        void SetSmoothScrollOffset(const double rows);
 
         void ClearBuffer(Control::ClearBufferType clearType);
 
@@ -149,6 +159,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void Search(const winrt::hstring& text,
                     const bool goForward,
                     const bool caseSensitive);
+        void ClearSearch();
+        bool ScrollToPrompt(const bool goForward);
+        bool SelectCommandOutput();
+        Windows::Foundation::Collections::IVector<Control::ScrollMark> ScrollMarks();
+        uint64_t ScrollMarksGeneration();
 
         void LeftClickOnTerminal(const til::point terminalPosition,
                                  const int numberOfClicks,
@@ -158,11 +173,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                  bool& selectionNeedsToBeCopied);
 
         void AttachUiaEngine(::Microsoft::Console::Render::IRenderEngine* const pEngine);
+        void DetachUiaEngine(::Microsoft::Console::Render::IRenderEngine* const pEngine);
+        void FocusChanged(const bool focused);
 
         bool IsInReadOnlyMode() const;
         void ToggleReadOnlyMode();
 
         hstring ReadEntireBuffer() const;
+        void PersistBuffer(const hstring& path) const;
+        void RestoreBuffer(const hstring& path);
 
         static bool IsVintageOpacityAvailable() noexcept;
 
@@ -192,14 +211,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         TYPED_EVENT(TransparencyChanged,       IInspectable, Control::TransparencyChangedEventArgs);
         TYPED_EVENT(ReceivedOutput,            IInspectable, IInspectable);
         TYPED_EVENT(FoundMatch,                IInspectable, Control::FoundResultsArgs);
+        TYPED_EVENT(ThumbnailReady,            IInspectable, Control::ThumbnailReadyEventArgs);
         // clang-format on
 
     private:
         bool _initializedTerminal{ false };
         bool _closing{ false };
+        // Set by RestoreBuffer(). Restored in Initialize(), before the connection starts.
+        hstring _bufferToRestore;
 
         TerminalConnection::ITerminalConnection _connection{ nullptr };
         event_token _connectionOutputEventToken;
+        // Only used with Feature_DecoupledOutputParsing. See _parseOutputThread().
+        std::thread _parseThread;
+        // Only set if the profile logs its sessions. See _startSessionLog().
+        std::unique_ptr<::Microsoft::Terminal::Control::SessionLogger> _sessionLogger;
         TerminalConnection::ITerminalConnection::StateChanged_revoker _connectionStateChangedRevoker;
 
         winrt::com_ptr<ControlSettings> _settings{ nullptr };
@@ -226,8 +252,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         uint16_t _lastHoveredId{ 0 };
 
         bool _isReadOnly{ false };
+        std::atomic<bool> _visible{ true };
 
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _lastHoveredInterval{ std::nullopt };
+        // Published by the render thread after every frame, so that hovering
+        // the mouse doesn't have to take the terminal lock. See Initialize().
+        til::shared_mutex<std::shared_ptr<const ::Microsoft::Terminal::Core::Terminal::HoverTargets>> _hoverTargets;
 
         // These members represent the size of the surface that we should be
         // rendering to.
@@ -238,9 +268,66 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         winrt::Windows::System::DispatcherQueue _dispatcher{ nullptr };
         std::shared_ptr<ThrottledFuncTrailing<>> _tsfTryRedrawCanvas;
         std::shared_ptr<ThrottledFuncTrailing<>> _updatePatternLocations;
+        std::shared_ptr<ThrottledFuncTrailing<>> _flushMouseMotion;
+        std::shared_ptr<ThrottledFuncTrailing<>> _checkOutputRate;
+
+        // The viewport-relative position of the cursor, for TSF. See _publishCursorPosition().
+        std::atomic<til::point> _cursorPosition{};
+
+        // Runaway output. See _checkForOutputFlood().
+        std::atomic<size_t> _recentOutputSize{ 0 };
+        std::atomic<bool> _outputFlooding{ false };
+        std::atomic<bool> _skippingOutput{ false };
+
+        // The performance overlay. See TogglePerformanceOverlay().
+        struct PerformanceSnapshot
+        {
+            std::chrono::steady_clock::time_point time;
+            uint64_t outputCharacters = 0;
+            uint64_t parseMicroseconds = 0;
+            ::Microsoft::Console::Render::RendererTracing::Statistics frames;
+            uint64_t glyphLookups = 0;
+            uint64_t glyphHits = 0;
+        };
+        std::shared_ptr<ThrottledFuncTrailing<>> _updatePerformanceOverlay;
+        std::atomic<bool> _performanceOverlayVisible{ false };
+        std::atomic<uint64_t> _outputCharacters{ 0 };
+        std::atomic<uint64_t> _parseMicroseconds{ 0 };
+        std::atomic<size_t> _outputQueueDepth{ 0 };
+        // Only accessed on the UI thread.
+        PerformanceSnapshot _performanceSnapshot;
+
+        // Searches. See _searchAsync().
+        std::atomic<uint64_t> _searchGeneration{ 0 };
+        std::atomic<uint64_t> _bufferGeneration{ 0 };
+        // Resizes of the buffer. See _resizeAsync().
+        std::atomic<uint64_t> _resizeGeneration{ 0 };
+        // Only accessed under the terminal lock.
+        std::shared_ptr<const ::Search::Snapshot> _searchSnapshot;
+        uint64_t _searchSnapshotGeneration{ 0 };
         std::shared_ptr<ThrottledFuncTrailing<Control::ScrollPositionChangedArgs>> _updateScrollBar;
 
+        // The title and taskbar progress like they were last reported to our listeners.
+        // See _raiseTitleChanged() and _raiseTaskbarProgressChanged(). Only accessed on the UI thread.
+        std::shared_ptr<ThrottledFuncTrailing<>> _updateTitle;
+        std::shared_ptr<ThrottledFuncTrailing<>> _updateTaskbarProgress;
+        winrt::hstring _lastReportedTitle;
+        std::pair<size_t, size_t> _lastReportedTaskbarProgress{};
+
+        // Reports the memory usage of the buffer to the ScrollbackBudget. See _reportScrollbackUsage().
+        // _scrollbackBudgetId and _focused are only accessed on the UI thread.
+        std::shared_ptr<ThrottledFuncTrailing<>> _updateScrollbackBudget;
+        uint64_t _scrollbackBudgetId{ 0 };
+        bool _focused{ false };
+
+        std::shared_ptr<ThrottledFuncTrailing<>> _trimHiddenRenderer;
+
         winrt::fire_and_forget _asyncCloseConnection();
+        winrt::fire_and_forget _resizeAsync(const double width, const double height);
+        winrt::fire_and_forget _searchAsync(const winrt::hstring text,
+                                            const bool goForward,
+                                            const bool caseSensitive);
+        std::pair<std::shared_ptr<const ::Search::Snapshot>, uint64_t> _getSearchSnapshot(const ::Search::Sensitivity sensitivity);
 
         void _setFontSize(int fontSize);
         void _updateFont(const bool initialUpdate = false);
@@ -260,17 +347,30 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                             const int viewHeight,
                                             const int bufferSize);
         void _terminalCursorPositionChanged();
+        void _publishCursorPosition();
         void _terminalTaskbarProgressChanged();
+        void _raiseTitleChanged();
+        void _raiseTaskbarProgressChanged();
+        void _reportScrollbackUsage();
+        void _trimRendererIfHidden();
 #pragma endregion
 
 #pragma region RendererCallbacks
         void _rendererWarning(const HRESULT hr);
+        void _thumbnailCaptured(::Microsoft::Console::Render::RenderThumbnail&& thumbnail);
         void _renderEngineSwapChainChanged();
 #pragma endregion
 
         void _raiseReadOnlyWarning();
         void _updateAntiAliasingMode();
-        void _connectionOutputHandler(const hstring& hstr);
+        void _startSessionLog() noexcept;
+        void _connectionOutputHandler(const std::wstring_view str);
+        void _parseOutputThread(const til::spsc::consumer<std::wstring>& queue);
+        bool _trackOutput(const size_t size);
+        void _writeOutput(const gsl::span<const std::wstring_view> strings);
+        void _checkForOutputFlood();
+        PerformanceSnapshot _takePerformanceSnapshot() const noexcept;
+        void _refreshPerformanceOverlay();
         void _updateHoveredCell(const std::optional<til::point> terminalPosition);
         void _setOpacity(const double opacity);
 
@@ -108,9 +108,11 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     {
         if (_uiaEngine.get())
         {
+            UpdateUiaEngineAttachment();
             THROW_IF_FAILED(_uiaEngine->Enable());
         }
 
+        _core->FocusChanged(true);
         _updateSystemParameterSettings();
     }
 
@@ -119,7 +121,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         if (_uiaEngine.get())
         {
             THROW_IF_FAILED(_uiaEngine->Disable());
+            UpdateUiaEngineAttachment();
         }
+
+        _core->FocusChanged(false);
     }
 
     // Method Description
@@ -486,7 +491,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // underneath us. We wouldn't know - we don't want the overhead of
         // another ScrollPositionChanged handler. If the scrollbar should be
         // somewhere other than where it is currently, then start from that row.
-        const int currentInternalRow = ::base::saturated_cast<int>(::std::round(_internalScrollbarPosition));
+        const int currentInternalRow = ::base::saturated_cast<int>(::std::floor(_internalScrollbarPosition));
         const int currentCoreRow = _core->ScrollOffset();
         const double currentOffset = currentInternalRow == currentCoreRow ?
                                          _internalScrollbarPosition :
@@ -539,10 +544,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // scroll each time the mouse scrolls.
         _internalScrollbarPosition = std::clamp<double>(newValue, 0.0, _core->BufferHeight());
 
-        // If the new scrollbar position, rounded to an int, is at a different
+        // If the new scrollbar position, rounded down to an int, is at a different
         // row, then actually update the scroll position in the core, and raise
         // a ScrollPositionChanged to inform the control.
-        int viewTop = ::base::saturated_cast<int>(::std::round(_internalScrollbarPosition));
+        int viewTop = ::base::saturated_cast<int>(::std::floor(_internalScrollbarPosition));
         if (viewTop != _core->ScrollOffset())
         {
             _core->UserScrollViewport(viewTop);
@@ -553,6 +558,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                                                                   _core->ViewHeight(),
                                                                                   _core->BufferHeight()));
         }
+
+        // The rest of the position is drawn as a fraction of a row, so that scrolling
+        // doesn't jump from row to row. It's 0 once the viewport can't scroll any further.
+        const auto fraction = _internalScrollbarPosition - _core->ScrollOffset();
+        const auto canScrollFurther = _core->ScrollOffset() < _core->BufferHeight() - _core->ViewHeight();
+        _core->SetSmoothScrollOffset(canScrollFurther && fraction > 0 && fraction < 1 ? fraction : 0);
     }
 
     void ControlInteractivity::_hyperlinkHandler(const std::wstring_view uri)
@@ -629,7 +640,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         const auto autoPeer = winrt::make_self<implementation::InteractivityAutomationPeer>(this);
 
         _uiaEngine = std::make_unique<::Microsoft::Console::Render::UiaEngine>(autoPeer.get());
-        _core->AttachUiaEngine(_uiaEngine.get());
+        UpdateUiaEngineAttachment();
         return *autoPeer;
     }
     catch (...)
@@ -643,6 +654,42 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return _core->GetUiaData();
     }
 
+    // Method Description:
+    // - Attaches the UiaEngine to the renderer if any UIA clients are
+    //   listening, and detaches it again once they're gone. Without
+    //   assistive technology running, the renderer doesn't need to compute
+    //   the events of the UiaEngine on every frame, just to throw them away.
+    // - UIA doesn't tell us when clients come and go, so this is checked
+    //   whenever the focus changes, and whenever a client asks the automation
+    //   peer for text.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void ControlInteractivity::UpdateUiaEngineAttachment()
+    {
+        if (!_uiaEngine)
+        {
+            return;
+        }
+
+        const bool listening = UiaClientsAreListening();
+        if (listening == _uiaEngineAttached)
+        {
+            return;
+        }
+
+        if (listening)
+        {
+            _core->AttachUiaEngine(_uiaEngine.get());
+        }
+        else
+        {
+            _core->DetachUiaEngine(_uiaEngine.get());
+        }
+        _uiaEngineAttached = listening;
+    }
+
     // Method Description:
     // - Used by the TermControl to know if it should translate drag-dropped
     //   paths into WSL-friendly paths.
@@ -46,6 +46,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         Control::InteractivityAutomationPeer OnCreateAutomationPeer();
         ::Microsoft::Console::Types::IUiaData* GetUiaData() const;
+        void UpdateUiaEngineAttachment();
 
 #pragma region Input Methods
         void PointerPressed(Control::MouseButtonState buttonState,
@@ -98,6 +99,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // IRenderEngine is accessed when ControlCore calls Renderer::TriggerTeardown.
         // (C++ class members are destroyed in reverse order.)
         std::unique_ptr<::Microsoft::Console::Render::UiaEngine> _uiaEngine;
+        // The _uiaEngine is only attached to the renderer while UIA clients are listening.
+        bool _uiaEngineAttached{ false };
 
         winrt::com_ptr<ControlCore> _core{ nullptr };
         unsigned int _rowsToScroll;
@@ -12,3 +12,4 @@
 #include "RendererWarningArgs.g.cpp"
 #include "TransparencyChangedEventArgs.g.cpp"
 #include "FoundResultsArgs.g.cpp"
+#include "ThumbnailReadyEventArgs.g.cpp"
@@ -12,6 +12,7 @@
 #include "RendererWarningArgs.g.h"
 #include "TransparencyChangedEventArgs.g.h"
 #include "FoundResultsArgs.g.h"
+#include "ThumbnailReadyEventArgs.g.h"
 
 namespace winrt::Microsoft::Terminal::Control::implementation
 {
@@ -145,4 +146,15 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         WINRT_PROPERTY(bool, FoundMatch);
     };
+
+    struct ThumbnailReadyEventArgs : public ThumbnailReadyEventArgsT<ThumbnailReadyEventArgs>
+    {
+    public:
+        ThumbnailReadyEventArgs(const Windows::Graphics::Imaging::SoftwareBitmap& thumbnail) :
+            _Thumbnail(thumbnail)
+        {
+        }
+
+        WINRT_PROPERTY(Windows::Graphics::Imaging::SoftwareBitmap, Thumbnail);
+    };
 }
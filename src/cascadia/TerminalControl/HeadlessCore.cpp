@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "HeadlessCore.h"
+
+#include "../inc/DirectConnectionOutput.h"
+#include "../../types/inc/utils.hpp"
+
+#include "HeadlessCore.g.cpp"
+
+using namespace ::Microsoft::Console::Types;
+using namespace ::Microsoft::Terminal::Core;
+using namespace winrt::Windows::Foundation;
+
+namespace winrt::Microsoft::Terminal::Control::implementation
+{
+    HeadlessCore::HeadlessCore(Core::ICoreSettings settings,
+                               TerminalConnection::ITerminalConnection connection) :
+        _connection{ connection }
+    {
+        _terminal = std::make_unique<::Microsoft::Terminal::Core::Terminal>();
+        _terminal->CreateFromSettings(settings, _renderTarget);
+
+        // Responses to queries, like DSR, go straight back to the connection.
+        _terminal->SetWriteInputCallback([this](std::wstring& wstr) {
+            _connection.WriteInput(wstr);
+        });
+
+        _connectionStateChangedRevoker = _connection.StateChanged(winrt::auto_revoke, [this](auto&& /*s*/, auto&& /*v*/) {
+            _ConnectionStateChangedHandlers(*this, nullptr);
+        });
+
+        // Like the event, the direct output handler is explicitly reset in Close().
+        _connectionOutputEventToken = _connection.TerminalOutput({ this, &HeadlessCore::_connectionOutputHandler });
+        if (const auto directOutput = _connection.try_as<IDirectConnectionOutput>())
+        {
+            directOutput->SetDirectOutputHandler([this](const std::wstring_view str) {
+                _connectionOutputHandler(str);
+            });
+        }
+    }
+
+    HeadlessCore::~HeadlessCore()
+    {
+        Close();
+    }
+
+    // Method Description:
+    // - Starts the connection, sized to the terminal's initial size.
+    void HeadlessCore::Start()
+    {
+        {
+            const auto lock = _terminal->LockForReading();
+            const auto viewport = _terminal->GetViewport();
+            _connection.Resize(viewport.Height(), viewport.Width());
+        }
+        _connection.Start();
+    }
+
+    // Method Description:
+    // - Stops accepting output and closes the connection. Unlike ControlCore,
+    //   which closes it asynchronously to not block the UI, this waits for it.
+    void HeadlessCore::Close()
+    {
+        if (std::exchange(_closing, true))
+        {
+            return;
+        }
+
+        _connection.TerminalOutput(_connectionOutputEventToken);
+        if (const auto directOutput = _connection.try_as<IDirectConnectionOutput>())
+        {
+            directOutput->SetDirectOutputHandler(nullptr);
+        }
+        _connectionStateChangedRevoker.revoke();
+
+        _connection.Close();
+    }
+
+    // Method Description:
+    // - Resizes the terminal and its connection to the given size in characters.
+    void HeadlessCore::Resize(const int32_t rows, const int32_t columns)
+    {
+        const COORD size{ ::Microsoft::Console::Utils::ClampToShortMax(columns, 1),
+                          ::Microsoft::Console::Utils::ClampToShortMax(rows, 1) };
+        {
+            const auto lock = _terminal->LockForWriting();
+            THROW_IF_FAILED(_terminal->UserResize(size));
+        }
+        ++_outputGeneration;
+        _connection.Resize(size.Y, size.X);
+    }
+
+    void HeadlessCore::SendInput(const winrt::hstring& text)
+    {
+        _connection.WriteInput(text);
+    }
+
+    hstring HeadlessCore::Title()
+    {
+        const auto lock = _terminal->LockForReading();
+        return hstring{ _terminal->GetConsoleTitle() };
+    }
+
+    hstring HeadlessCore::WorkingDirectory()
+    {
+        const auto lock = _terminal->LockForReading();
+        return hstring{ _terminal->GetWorkingDirectory() };
+    }
+
+    TerminalConnection::ConnectionState HeadlessCore::ConnectionState() const
+    {
+        return _connection.State();
+    }
+
+    uint64_t HeadlessCore::OutputGeneration() const noexcept
+    {
+        return _outputGeneration.load(std::memory_order_relaxed);
+    }
+
+    // Method Description:
+    // - Returns the text of the entire buffer, up to its last non-blank row.
+    hstring HeadlessCore::ReadEntireBuffer()
+    {
+        const auto lock = _terminal->LockForReading();
+        return hstring{ _terminal->GetRowsText(0, _terminal->GetLastNonSpaceRow()) };
+    }
+
+    // Method Description:
+    // - Returns the text of the rows in the viewport, which is what a
+    //   TermControl would show if it wasn't scrolled up.
+    hstring HeadlessCore::ReadViewport()
+    {
+        const auto lock = _terminal->LockForReading();
+        return hstring{ _terminal->GetRowsText(_terminal->ViewStartIndex(), _terminal->ViewEndIndex()) };
+    }
+
+    void HeadlessCore::_connectionOutputHandler(const std::wstring_view str)
+    {
+        _terminal->Write(str);
+        ++_outputGeneration;
+    }
+}
@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+//
+// Module Name:
+// - HeadlessCore.h
+//
+// Abstract:
+// - This encapsulates a `Terminal` instance and an `ITerminalConnection`, but
+//   unlike ControlCore, nothing that's needed to display it. The buffer is
+//   drawn into a DummyRenderTarget, so there's no render thread and no engine,
+//   and there are no hyperlink pattern updates, selection or UIA either.
+// - Output is parsed on the thread of the connection that produced it.
+
+#pragma once
+
+#include "HeadlessCore.g.h"
+#include "../../renderer/inc/DummyRenderTarget.hpp"
+#include "../../cascadia/TerminalCore/Terminal.hpp"
+
+namespace winrt::Microsoft::Terminal::Control::implementation
+{
+    struct HeadlessCore : HeadlessCoreT<HeadlessCore>
+    {
+    public:
+        HeadlessCore(Core::ICoreSettings settings,
+                     TerminalConnection::ITerminalConnection connection);
+        ~HeadlessCore();
+
+        void Start();
+        void Close();
+
+        void Resize(const int32_t rows, const int32_t columns);
+        void SendInput(const winrt::hstring& text);
+
+        hstring Title();
+        hstring WorkingDirectory();
+        TerminalConnection::ConnectionState ConnectionState() const;
+        uint64_t OutputGeneration() const noexcept;
+
+        hstring ReadEntireBuffer();
+        hstring ReadViewport();
+
+        TYPED_EVENT(ConnectionStateChanged, IInspectable, IInspectable);
+
+    private:
+        DummyRenderTarget _renderTarget;
+        std::unique_ptr<::Microsoft::Terminal::Core::Terminal> _terminal;
+
+        TerminalConnection::ITerminalConnection _connection{ nullptr };
+        event_token _connectionOutputEventToken;
+        TerminalConnection::ITerminalConnection::StateChanged_revoker _connectionStateChangedRevoker;
+
+        std::atomic<uint64_t> _outputGeneration{ 0 };
+        bool _closing{ false };
+
+        void _connectionOutputHandler(const std::wstring_view str);
+    };
+}
+
+namespace winrt::Microsoft::Terminal::Control::factory_implementation
+{
+    BASIC_FACTORY(HeadlessCore);
+}
@@ -70,10 +70,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     //   raise the event. AutomationPeer by itself doesn't hook up to the
     //   eventing mechanism, we need the FrameworkAutomationPeer to do that.
     // Arguments:
-    // - <none>
+    // - changedRegion - <unused> XAML's TextChanged event carries no details
     // Return Value:
     // - <none>
-    void InteractivityAutomationPeer::SignalTextChanged()
+    void InteractivityAutomationPeer::SignalTextChanged(const SMALL_RECT /*changedRegion*/)
     {
         _TextChangedHandlers(*this, nullptr);
     }
@@ -96,6 +96,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 #pragma region ITextProvider
     com_array<XamlAutomation::ITextRangeProvider> InteractivityAutomationPeer::GetSelection()
     {
+        // A client that asks for text is interested in events about it, too.
+        _interactivity->UpdateUiaEngineAttachment();
+
         SAFEARRAY* pReturnVal;
         THROW_IF_FAILED(_uiaProvider->GetSelection(&pReturnVal));
         return WrapArrayOfTextRangeProviders(pReturnVal);
@@ -103,6 +106,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     com_array<XamlAutomation::ITextRangeProvider> InteractivityAutomationPeer::GetVisibleRanges()
     {
+        _interactivity->UpdateUiaEngineAttachment();
+
         SAFEARRAY* pReturnVal;
         THROW_IF_FAILED(_uiaProvider->GetVisibleRanges(&pReturnVal));
         return WrapArrayOfTextRangeProviders(pReturnVal);
@@ -126,6 +131,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     XamlAutomation::ITextRangeProvider InteractivityAutomationPeer::DocumentRange()
     {
+        _interactivity->UpdateUiaEngineAttachment();
+
         UIA::ITextRangeProvider* returnVal;
         THROW_IF_FAILED(_uiaProvider->get_DocumentRange(&returnVal));
         return _CreateXamlUiaTextRange(returnVal);
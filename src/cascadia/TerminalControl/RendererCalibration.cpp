@@ -0,0 +1,179 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "RendererCalibration.h"
+
+#include <DefaultSettings.h>
+#include "../../renderer/atlas/AtlasEngine.h"
+#include "../../renderer/dx/DxRenderer.hpp"
+
+#include "RendererCalibration.g.cpp"
+
+using namespace ::Microsoft::Console::Render;
+using namespace ::Microsoft::Console::Types;
+
+namespace winrt::Microsoft::Terminal::Control::implementation
+{
+    // The size of a typical window, at 96 DPI.
+    static constexpr SIZE sceneSize{ 1280, 720 };
+    // The first frames create the device, the swap chain and the glyph
+    // caches. That's the same for every configuration, so they don't count.
+    static constexpr size_t warmupFrames = 8;
+    static constexpr size_t measuredFrames = 60;
+
+    // Every frame of the scene scrolls in these lines, which exercise what's
+    // expensive to draw: colors and font styles, wide glyphs, emoji that need
+    // a fallback font, box drawing and the various kinds of underlines.
+    static constexpr std::array<std::wstring_view, 3> sceneLines{
+        L"\x1b[0m$ calibrate \x1b[1;31mbold red\x1b[0m \x1b[3;32mitalic green\x1b[0m \x1b[4;34munderlined blue\x1b[0m \x1b[7mreversed\x1b[0m \x1b[9mstruck\x1b[0m\r\n",
+        L"\x1b[38;2;255;128;0mtrue color \x1b[48;5;238mon 256 colors\x1b[0m \x65E5\x672C\x8A9E\x306E\x30C6\x30AD\x30B9\x30C8 \xD83D\xDE80\xD83C\xDF89\x2764\xFE0F \x1b[21mdouble\x1b[0m\r\n",
+        L"\x250C\x2500\x2500\x2500\x252C\x2500\x2500\x2500\x2510 \x2502 1 \x2502 2 \x2502 \x2514\x2500\x2500\x2500\x2534\x2500\x2500\x2500\x2518 \x1b[4:3mcurly\x1b[0m \x1b[53moverlined\x1b[0m e\x301\x308\r\n",
+    };
+
+    // Method Description:
+    // - Paints the scene with the given configuration.
+    // Return Value:
+    // - The time it took to paint the measured frames, or nothing if the
+    //   configuration failed to paint any of them or warned about anything.
+    static std::optional<std::chrono::steady_clock::duration> MeasureScene(const RendererConfiguration configuration)
+    try
+    {
+        ::Microsoft::Terminal::Core::Terminal terminal;
+        auto warned = false;
+
+        std::unique_ptr<IRenderEngine> engine;
+        if (configuration == RendererConfiguration::AtlasEngine || configuration == RendererConfiguration::AtlasEngineSoftware)
+        {
+            engine = std::make_unique<AtlasEngine>();
+        }
+        else
+        {
+            engine = std::make_unique<DxEngine>();
+        }
+
+        // Without a render thread, frames are only painted when we ask for them.
+        Renderer renderer{ terminal.GetRenderSettings(), &terminal, nullptr, 0, nullptr };
+        renderer.AddRenderEngine(engine.get());
+
+        engine->SetWarningCallback([&](const HRESULT) { warned = true; });
+        engine->SetSoftwareRendering(configuration == RendererConfiguration::DxEngineSoftware || configuration == RendererConfiguration::AtlasEngineSoftware);
+
+        FontInfoDesired desiredFont{ DEFAULT_FONT_FACE, 0, DEFAULT_FONT_WEIGHT, { 0, DEFAULT_FONT_SIZE }, CP_UTF8 };
+        FontInfo actualFont{ DEFAULT_FONT_FACE, 0, DEFAULT_FONT_WEIGHT, { 0, DEFAULT_FONT_SIZE }, CP_UTF8, false };
+        THROW_IF_FAILED(engine->UpdateDpi(USER_DEFAULT_SCREEN_DPI));
+        THROW_IF_FAILED(engine->UpdateFont(desiredFont, actualFont));
+        THROW_IF_FAILED(engine->SetWindowSize(sceneSize));
+
+        const auto viewInPixels = Viewport::FromDimensions({ gsl::narrow_cast<short>(sceneSize.cx), gsl::narrow_cast<short>(sceneSize.cy) });
+        terminal.SetFontInfo(actualFont);
+        terminal.Create(engine->GetViewportInCharacters(viewInPixels).Dimensions(), 1000, renderer);
+
+        THROW_IF_FAILED(engine->Enable());
+
+        const auto paintFrame = [&]() {
+            {
+                const auto lock = terminal.LockForWriting();
+                terminal.Write({ sceneLines.data(), sceneLines.size() });
+            }
+            LOG_IF_FAILED(renderer.PaintFrame());
+        };
+
+        for (size_t i = 0; i < warmupFrames; ++i)
+        {
+            paintFrame();
+        }
+
+        const auto before = renderer.GetStatistics();
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < measuredFrames; ++i)
+        {
+            paintFrame();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const auto after = renderer.GetStatistics();
+
+        // Every frame scrolls, so every single one has to be painted.
+        if (warned || after.framesDropped != 0 || after.framesPainted - before.framesPainted != measuredFrames)
+        {
+            return std::nullopt;
+        }
+
+        return end - start;
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return std::nullopt;
+    }
+
+    // Method Description:
+    // - Returns a string that identifies the primary graphics adapter, which is
+    //   the one the engines render on, and the version of its driver. It
+    //   changes along with either, which is what invalidates a calibration.
+    // Return Value:
+    // - The adapter key, or an empty string if there's no adapter.
+    winrt::hstring RendererCalibration::AdapterKey()
+    {
+        // Drivers may be updated while we're running, but we'd only
+        // draw the conclusions from it on the next launch anyway.
+        static const auto key = []() -> winrt::hstring {
+            try
+            {
+                wil::com_ptr<IDXGIFactory1> factory;
+                THROW_IF_FAILED(CreateDXGIFactory1(IID_PPV_ARGS(factory.addressof())));
+
+                wil::com_ptr<IDXGIAdapter1> adapter;
+                THROW_IF_FAILED(factory->EnumAdapters1(0, adapter.addressof()));
+
+                DXGI_ADAPTER_DESC1 desc;
+                THROW_IF_FAILED(adapter->GetDesc1(&desc));
+
+                // The version of the user mode driver is only reported for IDXGIDevice.
+                LARGE_INTEGER driverVersion{};
+                THROW_IF_FAILED(adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion));
+
+                return winrt::hstring{ fmt::format(L"VEN_{:04X}&DEV_{:04X}&SUBSYS_{:08X}&REV_{:02X} {}.{}.{}.{}",
+                                                   desc.VendorId,
+                                                   desc.DeviceId,
+                                                   desc.SubSysId,
+                                                   desc.Revision,
+                                                   HIWORD(driverVersion.HighPart),
+                                                   LOWORD(driverVersion.HighPart),
+                                                   HIWORD(driverVersion.LowPart),
+                                                   LOWORD(driverVersion.LowPart)) };
+            }
+            CATCH_LOG();
+            return {};
+        }();
+        return key;
+    }
+
+    // Method Description:
+    // - Paints the scene with every available configuration, one after another.
+    // Return Value:
+    // - The fastest configuration that painted every frame. If none did,
+    //   that's the DxEngine on the GPU, which is what's used by default.
+    Control::RendererConfiguration RendererCalibration::Run()
+    {
+        std::vector<RendererConfiguration> configurations{ RendererConfiguration::DxEngine, RendererConfiguration::DxEngineSoftware };
+        if (Feature_AtlasEngine::IsEnabled())
+        {
+            configurations.emplace_back(RendererConfiguration::AtlasEngine);
+            configurations.emplace_back(RendererConfiguration::AtlasEngineSoftware);
+        }
+
+        auto fastest = RendererConfiguration::DxEngine;
+        std::optional<std::chrono::steady_clock::duration> fastestDuration;
+        for (const auto configuration : configurations)
+        {
+            const auto duration = MeasureScene(configuration);
+            if (duration && (!fastestDuration || *duration < *fastestDuration))
+            {
+                fastest = configuration;
+                fastestDuration = duration;
+            }
+        }
+        return fastest;
+    }
+}
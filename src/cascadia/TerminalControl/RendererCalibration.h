@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+//
+// Module Name:
+// - RendererCalibration.h
+//
+// Abstract:
+// - Measures how fast each render engine draws on this machine. Every
+//   configuration paints the same scripted scene into a swap chain that's
+//   never displayed, driven by a Renderer without a render thread, and
+//   the one that takes the least time without dropping a frame wins.
+
+#pragma once
+
+#include "RendererCalibration.g.h"
+
+namespace winrt::Microsoft::Terminal::Control::implementation
+{
+    struct RendererCalibration
+    {
+        RendererCalibration() = default;
+
+        static winrt::hstring AdapterKey();
+        static Control::RendererConfiguration Run();
+    };
+}
+
+namespace winrt::Microsoft::Terminal::Control::factory_implementation
+{
+    // C++/WinRT generates a constructor even though one is not specified in the IDL
+    BASIC_FACTORY(RendererCalibration);
+}
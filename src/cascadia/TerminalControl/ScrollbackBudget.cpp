@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "ScrollbackBudget.h"
+
+using namespace Microsoft::Terminal::Control;
+
+ScrollbackBudget& ScrollbackBudget::Instance()
+{
+    // All windows of a process share it, just like they share the memory.
+    static ScrollbackBudget instance;
+    return instance;
+}
+
+uint64_t ScrollbackBudget::Register(PressureCallback callback)
+{
+    const std::lock_guard lock{ _mutex };
+    const auto id = _nextId++;
+    auto& entry = _entries[id];
+    entry.callback = std::move(callback);
+    entry.lastFocused = std::chrono::steady_clock::now();
+    return id;
+}
+
+void ScrollbackBudget::Unregister(const uint64_t id) noexcept
+{
+    // The callback is destroyed outside of the lock, as it may hold the last reference to its control.
+    PressureCallback callback;
+    {
+        const std::lock_guard lock{ _mutex };
+        const auto it = _entries.find(id);
+        if (it == _entries.end())
+        {
+            return;
+        }
+        callback = std::move(it->second.callback);
+        _entries.erase(it);
+    }
+}
+
+// Method Description:
+// - Records the memory usage and focus of a control and then puts controls
+//   under pressure or releases them, as the budget requires. At most one
+//   additional control is put under pressure per call: packing takes a moment
+//   to show in the usage that the controls report.
+// Arguments:
+// - id: the ID returned by Register()
+// - usage: the memory that the buffer of the control uses, in bytes
+// - focused: whether the control has focus
+// - budget: the budget in bytes, or 0 if there's none
+// Return Value:
+// - <none>
+void ScrollbackBudget::Update(const uint64_t id, const size_t usage, const bool focused, const size_t budget) noexcept
+try
+{
+    std::vector<std::pair<PressureCallback, bool>> notifications;
+    {
+        const std::lock_guard lock{ _mutex };
+        const auto it = _entries.find(id);
+        if (it == _entries.end())
+        {
+            return;
+        }
+
+        auto& self = it->second;
+        const auto now = std::chrono::steady_clock::now();
+        self.usage = usage;
+        if (focused || self.focused)
+        {
+            self.lastFocused = now;
+        }
+        self.focused = focused;
+
+        // The control the user is looking at keeps its scrollback quick to get to.
+        if (focused && self.underPressure)
+        {
+            self.underPressure = false;
+            notifications.emplace_back(self.callback, false);
+        }
+
+        size_t total = 0;
+        for (const auto& [_, entry] : _entries)
+        {
+            total += entry.usage;
+        }
+
+        if (budget == 0 || total < budget / 2)
+        {
+            for (auto& [_, entry] : _entries)
+            {
+                if (entry.underPressure)
+                {
+                    entry.underPressure = false;
+                    notifications.emplace_back(entry.callback, false);
+                }
+            }
+        }
+        else if (total > budget)
+        {
+            Entry* coldest = nullptr;
+            for (auto& [_, entry] : _entries)
+            {
+                if (!entry.focused && !entry.underPressure && (!coldest || entry.lastFocused < coldest->lastFocused))
+                {
+                    coldest = &entry;
+                }
+            }
+
+            if (coldest)
+            {
+                coldest->underPressure = true;
+                notifications.emplace_back(coldest->callback, true);
+            }
+        }
+    }
+
+    for (const auto& [callback, underPressure] : notifications)
+    {
+        callback(underPressure);
+    }
+}
+CATCH_LOG()
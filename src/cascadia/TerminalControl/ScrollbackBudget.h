@@ -0,0 +1,56 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ScrollbackBudget.h
+
+Abstract:
+- Keeps the scrollback of all the ControlCores of this process within the
+  "experimental.scrollbackMemoryBudget" global setting. "historySize" only
+  limits each buffer on its own, so without this the memory grows with every
+  pane that's opened.
+- Every ControlCore registers itself and reports how much memory its buffer
+  uses, and whether it has focus, every now and then. Once the total is over
+  the budget, the controls that don't have focus are put under pressure one
+  at a time, starting with the one that had focus the longest time ago. A
+  control under pressure packs all of its scrollback, not just the part
+  that's far away from the viewport (see Terminal::SetScrollbackCompaction).
+- Packing is lossless, so the scrollback that the "historySize" of each
+  profile asks for is always kept. It just takes longer to get to.
+- The pressure is released once the total drops below half of the budget,
+  or as soon as a control gets focus.
+- The callbacks are invoked outside of the lock of the budget, on the thread
+  that reported a change. They're expected to hop to their own thread.
+--*/
+
+#pragma once
+
+namespace Microsoft::Terminal::Control
+{
+    class ScrollbackBudget
+    {
+    public:
+        using PressureCallback = std::function<void(bool underPressure)>;
+
+        static ScrollbackBudget& Instance();
+
+        uint64_t Register(PressureCallback callback);
+        void Unregister(const uint64_t id) noexcept;
+        void Update(const uint64_t id, const size_t usage, const bool focused, const size_t budget) noexcept;
+
+    private:
+        struct Entry
+        {
+            PressureCallback callback;
+            size_t usage{ 0 };
+            bool focused{ false };
+            bool underPressure{ false };
+            std::chrono::steady_clock::time_point lastFocused;
+        };
+
+        std::mutex _mutex;
+        std::unordered_map<uint64_t, Entry> _entries;
+        uint64_t _nextId{ 1 };
+    };
+}
@@ -0,0 +1,337 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "SessionLogger.h"
+
+using namespace Microsoft::Terminal::Control;
+using SessionLogFormat = winrt::Microsoft::Terminal::Control::SessionLogFormat;
+
+// The most output, in characters, that may wait for the logger thread.
+// Anything beyond this is dropped.
+static constexpr size_t QueueCapacity = 4 * 1024 * 1024;
+// Output is written once this many bytes have piled up...
+static constexpr size_t WriteSize = 1024 * 1024;
+// ...or once it's been waiting for this long.
+static constexpr auto FlushInterval = std::chrono::seconds(1);
+
+SessionLogger::SessionLogger(Options options) :
+    _options{ std::move(options) }
+{
+    std::filesystem::create_directories(_options.directory);
+    _writeEvent.create(wil::EventOptions::ManualReset);
+    _openFile();
+    _lastFlush = _fileOpened;
+
+    _thread = std::thread{ [this]() { _run(); } };
+}
+
+SessionLogger::~SessionLogger()
+{
+    {
+        const std::lock_guard lock{ _mutex };
+        _stopping = true;
+    }
+    _cv.notify_one();
+    _thread.join();
+}
+
+// Method Description:
+// - Queues output of the connection for the log. This never waits for the
+//   disk: if the queue is full, the output is dropped and counted instead.
+// Arguments:
+// - text: the output of the connection
+// Return Value:
+// - <none>
+void SessionLogger::Append(const std::wstring_view text) noexcept
+{
+    bool wasEmpty = false;
+    {
+        const std::lock_guard lock{ _mutex };
+        if (_pending.size() + text.size() > QueueCapacity)
+        {
+            _dropped += text.size();
+            return;
+        }
+
+        wasEmpty = _pending.empty();
+        try
+        {
+            _pending.append(text);
+        }
+        catch (...)
+        {
+            _dropped += text.size();
+            return;
+        }
+    }
+
+    // If the queue wasn't empty, the logger thread is already about to take it.
+    if (wasEmpty)
+    {
+        _cv.notify_one();
+    }
+}
+
+void SessionLogger::_run() noexcept
+{
+    for (;;)
+    {
+        uint64_t dropped = 0;
+        bool stopping = false;
+        {
+            std::unique_lock lock{ _mutex };
+            _cv.wait_for(lock, FlushInterval, [this]() { return _stopping || !_pending.empty(); });
+            // Swapping the strings keeps the capacity of both of them,
+            // so that Append() rarely has to allocate under the lock.
+            _incoming.swap(_pending);
+            dropped = std::exchange(_dropped, 0);
+            stopping = _stopping;
+        }
+
+        try
+        {
+            if (dropped)
+            {
+                _appendDroppedNote(dropped);
+            }
+
+            // The queue is processed in slices, so that no single write gets much larger than WriteSize.
+            for (std::wstring_view rest{ _incoming }; !rest.empty();)
+            {
+                const auto slice = rest.substr(0, WriteSize);
+                rest = rest.substr(slice.size());
+                _process(slice);
+                if (_buffer.size() >= WriteSize)
+                {
+                    _flush();
+                }
+            }
+
+            if (stopping || std::chrono::steady_clock::now() - _lastFlush >= FlushInterval)
+            {
+                _flush();
+            }
+
+            _rotateIfNeeded();
+        }
+        CATCH_LOG();
+
+        _incoming.clear();
+
+        if (stopping)
+        {
+            _waitForWrite();
+            return;
+        }
+    }
+}
+
+void SessionLogger::_process(const std::wstring_view text)
+{
+    auto view = text;
+    if (_options.format == SessionLogFormat::PlainText)
+    {
+        _text.clear();
+        _stripControlSequences(text);
+        view = _text;
+    }
+
+    // The state carries surrogate pairs that were split between two slices over to the next one.
+    THROW_IF_FAILED(til::u16u8(view, _utf8, _u16state));
+    _buffer.append(_utf8);
+}
+
+// Method Description:
+// - Appends the text to _text, without any control characters and sequences,
+//   for SessionLogFormat::PlainText. Tabs and line breaks are kept.
+// - This is a much simplified version of the state machine of the VT parser:
+//   it only needs to know where sequences end, not what they mean. The state
+//   is kept in _vtState, as sequences may be split between two calls.
+// Arguments:
+// - text: the output of the connection
+// Return Value:
+// - <none>
+void SessionLogger::_stripControlSequences(const std::wstring_view text)
+{
+    for (const auto ch : text)
+    {
+        switch (_vtState)
+        {
+        case VtState::Ground:
+            if (ch == L'\x1b')
+            {
+                _vtState = VtState::Escape;
+            }
+            else if ((ch >= L' ' && ch != L'\x7f' && (ch < L'\x80' || ch > L'\x9f')) || ch == L'\t' || ch == L'\n' || ch == L'\r')
+            {
+                _text.push_back(ch);
+            }
+            break;
+        case VtState::StringEscape:
+            if (ch == L'\\')
+            {
+                _vtState = VtState::Ground;
+                break;
+            }
+            // Any other character after an ESC aborts the string and starts a new escape sequence.
+            [[fallthrough]];
+        case VtState::Escape:
+            if (ch == L'[')
+            {
+                _vtState = VtState::Csi;
+            }
+            else if (ch == L']' || ch == L'P' || ch == L'X' || ch == L'^' || ch == L'_')
+            {
+                // OSC, DCS, SOS, PM and APC all end with ST (or BEL, for OSC).
+                _vtState = VtState::String;
+            }
+            else if (ch >= L' ' && ch <= L'/')
+            {
+                _vtState = VtState::EscapeIntermediate;
+            }
+            else if (ch != L'\x1b')
+            {
+                _vtState = VtState::Ground;
+            }
+            break;
+        case VtState::EscapeIntermediate:
+            if (ch < L' ' || ch > L'/')
+            {
+                _vtState = ch == L'\x1b' ? VtState::Escape : VtState::Ground;
+            }
+            break;
+        case VtState::Csi:
+            if (ch >= L'@' && ch <= L'~')
+            {
+                _vtState = VtState::Ground;
+            }
+            else if (ch == L'\x1b')
+            {
+                _vtState = VtState::Escape;
+            }
+            break;
+        case VtState::String:
+            if (ch == L'\x07')
+            {
+                _vtState = VtState::Ground;
+            }
+            else if (ch == L'\x1b')
+            {
+                _vtState = VtState::StringEscape;
+            }
+            break;
+        }
+    }
+}
+
+void SessionLogger::_appendDroppedNote(const uint64_t dropped)
+{
+    // The output around the gap doesn't belong together anymore.
+    _vtState = VtState::Ground;
+    _u16state.reset();
+    fmt::format_to(std::back_inserter(_buffer), "\r\n[{} characters of output were not logged, because the disk couldn't keep up]\r\n", dropped);
+}
+
+// Method Description:
+// - Starts writing the buffered output to the file. The write is overlapped,
+//   so that we can prepare the next one in the meantime. Only one write is in
+//   flight at a time, which keeps the output in order.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void SessionLogger::_flush()
+{
+    _lastFlush = std::chrono::steady_clock::now();
+    if (_buffer.empty())
+    {
+        return;
+    }
+
+    _waitForWrite();
+    _writing.swap(_buffer);
+    _buffer.clear();
+
+    const auto size = gsl::narrow<DWORD>(_writing.size());
+    _overlapped = {};
+    _overlapped.Offset = gsl::narrow_cast<DWORD>(_fileOffset);
+    _overlapped.OffsetHigh = gsl::narrow_cast<DWORD>(_fileOffset >> 32);
+    _overlapped.hEvent = _writeEvent.get();
+    if (!WriteFile(_file.get(), _writing.data(), size, nullptr, &_overlapped))
+    {
+        const auto error = GetLastError();
+        THROW_WIN32_IF(error, error != ERROR_IO_PENDING);
+    }
+
+    _writePending = true;
+    _fileOffset += size;
+}
+
+void SessionLogger::_waitForWrite() noexcept
+{
+    if (!_writePending)
+    {
+        return;
+    }
+
+    _writePending = false;
+    DWORD written = 0;
+    LOG_IF_WIN32_BOOL_FALSE(GetOverlappedResult(_file.get(), &_overlapped, &written, TRUE));
+}
+
+void SessionLogger::_rotateIfNeeded()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto tooLarge = _options.rotateSize && _fileOffset >= _options.rotateSize;
+    const auto tooOld = _options.rotateInterval.count() && now - _fileOpened >= _options.rotateInterval;
+    if (!tooLarge && !tooOld)
+    {
+        return;
+    }
+
+    // There's no point in a series of empty files for a session that's idle.
+    if (_fileOffset == 0 && _buffer.empty())
+    {
+        _fileOpened = now;
+        return;
+    }
+
+    _flush();
+    _waitForWrite();
+    _openFile();
+}
+
+void SessionLogger::_openFile()
+{
+    // Multiple windows can share this process, so the counter needs to be atomic.
+    static std::atomic<uint32_t> s_logCount{ 0 };
+
+    SYSTEMTIME time{};
+    GetLocalTime(&time);
+
+    std::filesystem::path path{ _options.directory };
+    path /= fmt::format(L"{:04}-{:02}-{:02}_{:02}-{:02}-{:02}_{}_{}.log",
+                        time.wYear,
+                        time.wMonth,
+                        time.wDay,
+                        time.wHour,
+                        time.wMinute,
+                        time.wSecond,
+                        GetCurrentProcessId(),
+                        s_logCount.fetch_add(1, std::memory_order_relaxed));
+
+    // CREATE_NEW, so that we never write into a file that isn't ours.
+    wil::unique_hfile file{ CreateFileW(path.c_str(),
+                                        GENERIC_WRITE,
+                                        FILE_SHARE_READ,
+                                        nullptr,
+                                        CREATE_NEW,
+                                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED,
+                                        nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    _file = std::move(file);
+    _fileOffset = 0;
+    _fileOpened = std::chrono::steady_clock::now();
+}
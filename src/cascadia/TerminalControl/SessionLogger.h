@@ -0,0 +1,103 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SessionLogger.h
+
+Abstract:
+- Logs the output of a session into files, for the "experimental.sessionLog*"
+  profile settings.
+- Append() is called by the thread that reads the output of the connection.
+  It only copies the output into a bounded queue. Converting it to UTF-8,
+  removing control sequences for SessionLogFormat::PlainText and writing
+  it to disk all happen on a thread of the logger, so neither the UI nor the
+  parse thread ever wait for the disk.
+- The file is written with overlapped writes of up to WriteSize bytes: the
+  next batch is prepared while the previous one is still being written.
+- A slow disk never pushes back on the connection. If the queue is full,
+  the output is dropped instead, and a note with the number of characters
+  that were lost is written into the log in its place.
+- The log is continued in a new file once the current one grows beyond the
+  rotate size or gets older than the rotate interval, if either is set.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+
+namespace ControlUnitTests
+{
+    class SessionLoggerTests;
+};
+
+namespace Microsoft::Terminal::Control
+{
+    class SessionLogger
+    {
+    public:
+        struct Options
+        {
+            std::wstring directory;
+            winrt::Microsoft::Terminal::Control::SessionLogFormat format{ winrt::Microsoft::Terminal::Control::SessionLogFormat::Raw };
+            uint64_t rotateSize{ 0 }; // in bytes, 0 if the size doesn't matter
+            std::chrono::minutes rotateInterval{ 0 }; // 0 if the age doesn't matter
+        };
+
+        explicit SessionLogger(Options options);
+        ~SessionLogger();
+        SessionLogger(const SessionLogger&) = delete;
+        SessionLogger& operator=(const SessionLogger&) = delete;
+
+        void Append(const std::wstring_view text) noexcept;
+
+    private:
+        void _run() noexcept;
+        void _process(const std::wstring_view text);
+        void _stripControlSequences(const std::wstring_view text);
+        void _appendDroppedNote(const uint64_t dropped);
+        void _flush();
+        void _waitForWrite() noexcept;
+        void _rotateIfNeeded();
+        void _openFile();
+
+        Options _options;
+        std::thread _thread;
+
+        // Shared between Append() and the logger thread.
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::wstring _pending;
+        uint64_t _dropped{ 0 };
+        bool _stopping{ false };
+
+        // Only used by the logger thread.
+        std::wstring _incoming;
+        std::wstring _text;
+        std::string _utf8;
+        til::u16state _u16state;
+        std::string _buffer;
+        std::string _writing;
+        wil::unique_hfile _file;
+        wil::unique_event _writeEvent;
+        OVERLAPPED _overlapped{};
+        bool _writePending{ false };
+        uint64_t _fileOffset{ 0 };
+        std::chrono::steady_clock::time_point _fileOpened;
+        std::chrono::steady_clock::time_point _lastFlush;
+
+        // The state of the VT stream, for SessionLogFormat::PlainText.
+        enum class VtState : uint8_t
+        {
+            Ground,
+            Escape,
+            EscapeIntermediate,
+            Csi,
+            String,
+            StringEscape,
+        };
+        VtState _vtState{ VtState::Ground };
+
+        friend class ControlUnitTests::SessionLoggerTests;
+    };
+}
@@ -41,6 +41,14 @@ constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(
 // The minimum delay between emitting warning bells
 constexpr const auto TerminalWarningBellInterval = std::chrono::milliseconds(1000);
 
+// The minimum delay between resizing the swap chain while the control is resized: about one frame.
+constexpr const auto ResizeSwapChainInterval = std::chrono::milliseconds(16);
+
+// How long the size of the control has to stay the same, before the buffer is resized (and thus
+// reflowed) and the connection is told about it. Dragging the window or a splitter would
+// otherwise reflow every pane, and the buffer of conhost behind it, for every mouse move.
+constexpr const auto ResizeBufferSettleInterval = std::chrono::milliseconds(100);
+
 DEFINE_ENUM_FLAG_OPERATORS(winrt::Microsoft::Terminal::Control::CopyFormat);
 
 DEFINE_ENUM_FLAG_OPERATORS(winrt::Microsoft::Terminal::Control::MouseButtonState);
@@ -141,6 +149,22 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                 }
             });
 
+        // While the control is being resized, the swap chain follows its size about once per frame.
+        // In between, the SwapChainPanel simply clips or stretches the previous frame.
+        _resizeSwapChain = std::make_shared<ThrottledFuncTrailing<Windows::Foundation::Size>>(
+            dispatcher,
+            ResizeSwapChainInterval,
+            [weakThis = get_weak()](const auto& newSize) {
+                if (auto control{ weakThis.get() }; !control->_IsClosing())
+                {
+                    control->_core.SizeChanging(newSize.Width, newSize.Height);
+                }
+            });
+
+        // Resizing the buffer is deferred until the size changes settle down. See _ResizeBufferSettled().
+        _resizeBufferTimer.Interval(ResizeBufferSettleInterval);
+        _resizeBufferTimer.Tick({ this, &TermControl::_ResizeBufferSettled });
+
         static constexpr auto AutoScrollUpdateInterval = std::chrono::microseconds(static_cast<int>(1.0 / 30.0 * 1000000));
         _autoScrollTimer.Interval(AutoScrollUpdateInterval);
         _autoScrollTimer.Tick({ this, &TermControl::_UpdateAutoScroll });
@@ -225,6 +249,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
                                              RoutedEventArgs const& /*args*/)
     {
         _searchBox->Visibility(Visibility::Collapsed);
+        _core.ClearSearch();
 
         // Set focus back to terminal control
         this->Focus(FocusState::Programmatic);
@@ -334,6 +359,26 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _core.ToggleShaderEffects();
     }
 
+    void TermControl::TogglePerformanceOverlay()
+    {
+        _core.TogglePerformanceOverlay();
+    }
+
+    void TermControl::SkipOutput()
+    {
+        _core.SkipOutput();
+    }
+
+    bool TermControl::ScrollToPrompt(const bool goForward)
+    {
+        return _core.ScrollToPrompt(goForward);
+    }
+
+    bool TermControl::SelectCommandOutput()
+    {
+        return _core.SelectCommandOutput();
+    }
+
     // Method Description:
     // - Style our UI elements based on the values in our settings, and set up
     //   other control-specific settings. This method will be called whenever
@@ -1637,7 +1682,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
     // Method Description:
     // - Triggered when the swapchain changes size. We use this to resize the
-    //      terminal buffers to match the new visible size.
+    //      terminal buffers to match the new visible size. While the size keeps
+    //      changing, only the swap chain is resized, at most once every
+    //      ResizeSwapChainInterval. The buffer is resized once the size stayed
+    //      the same for ResizeBufferSettleInterval.
     // Arguments:
     // - e: a SizeChangedEventArgs with the new dimensions of the SwapChainPanel
     void TermControl::_SwapChainSizeChanged(winrt::Windows::Foundation::IInspectable const& /*sender*/,
@@ -1648,8 +1696,12 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
-        const auto newSize = e.NewSize();
-        _core.SizeChanged(newSize.Width, newSize.Height);
+        _pendingBufferSize = e.NewSize();
+        _resizeSwapChain->Run(_pendingBufferSize);
+
+        // Restarting the timer pushes the resize of the buffer back, for as long as the size keeps changing.
+        _resizeBufferTimer.Stop();
+        _resizeBufferTimer.Start();
 
         if (_automationPeer)
         {
@@ -1657,6 +1709,21 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - Resizes the buffer, and with it the connection, once the size of the
+    //   control stopped changing for ResizeBufferSettleInterval.
+    // Arguments:
+    // - <unused>
+    void TermControl::_ResizeBufferSettled(Windows::Foundation::IInspectable const& /*sender*/,
+                                           Windows::Foundation::IInspectable const& /*e*/)
+    {
+        _resizeBufferTimer.Stop();
+        if (!_IsClosing())
+        {
+            _core.SizeChanged(_pendingBufferSize.Width, _pendingBufferSize.Height);
+        }
+    }
+
     // Method Description:
     // - Triggered when the swapchain changes DPI. When this happens, we're
     //   going to receive 3 events:
@@ -1829,6 +1896,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             // Disconnect the TSF input control so it doesn't receive EditContext events.
             TSFInputControl().Close();
             _autoScrollTimer.Stop();
+            _resizeBufferTimer.Stop();
 
             _core.Close();
         }
@@ -2597,6 +2665,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _ReadOnlyChangedHandlers(*this, winrt::box_value(_core.IsInReadOnlyMode()));
     }
 
+    // Method Description:
+    // - Tells the control whether it can be seen. Hidden controls don't
+    //   render until they're shown again.
+    // Arguments:
+    // - visible: true if the control can be seen, e.g. its tab is selected
+    void TermControl::SetVisible(const bool visible)
+    {
+        _core.SetVisible(visible);
+    }
+
     // Method Description:
     // - Handle a mouse exited event, specifically clearing last hovered cell
     // and removing selection from hyper link if exists
@@ -2725,6 +2803,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         return _core.ReadEntireBuffer();
     }
 
+    void TermControl::PersistBuffer(const hstring& path) const
+    {
+        _core.PersistBuffer(path);
+    }
+
+    void TermControl::RestoreBuffer(const hstring& path)
+    {
+        _core.RestoreBuffer(path);
+    }
+
     Core::Scheme TermControl::ColorScheme() const noexcept
     {
         return _core.ColorScheme();
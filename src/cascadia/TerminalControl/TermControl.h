@@ -11,6 +11,7 @@
 #include "../../renderer/uia/UiaRenderer.hpp"
 #include "../../cascadia/TerminalCore/Terminal.hpp"
 #include "../buffer/out/search.h"
+#include "../../types/inc/utils.hpp"
 #include "SearchBoxControl.h"
 
 #include "ControlInteractivity.h"
@@ -71,6 +72,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void ClearBuffer(Control::ClearBufferType clearType);
 
         void ToggleShaderEffects();
+        void TogglePerformanceOverlay();
+        void SkipOutput();
+        bool ScrollToPrompt(const bool goForward);
+        bool SelectCommandOutput();
 
         winrt::fire_and_forget RenderEngineSwapChainChanged(IInspectable sender, IInspectable args);
         void _AttachDxgiSwapChainToXaml(HANDLE swapChainHandle);
@@ -100,18 +105,24 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         bool ReadOnly() const noexcept;
         void ToggleReadOnly();
+        void SetVisible(const bool visible);
 
         static Control::MouseButtonState GetPressedMouseButtons(const winrt::Windows::UI::Input::PointerPoint point);
         static unsigned int GetPointerUpdateKind(const winrt::Windows::UI::Input::PointerPoint point);
         static Windows::UI::Xaml::Thickness ParseThicknessFromPadding(const hstring padding);
 
         hstring ReadEntireBuffer() const;
+        void PersistBuffer(const hstring& path) const;
+        void RestoreBuffer(const hstring& path);
 
         winrt::Microsoft::Terminal::Core::Scheme ColorScheme() const noexcept;
         void ColorScheme(const winrt::Microsoft::Terminal::Core::Scheme& scheme) const noexcept;
 
         void AdjustOpacity(const double opacity, const bool relative);
 
+        // Identifies the buffer of this control across restarts. See PersistBuffer().
+        WINRT_PROPERTY(winrt::guid, SessionId, ::Microsoft::Console::Utils::CreateGuid());
+
         // -------------------------------- WinRT Events ---------------------------------
         // clang-format off
         WINRT_CALLBACK(FontSizeChanged, Control::FontSizeChangedEventArgs);
@@ -166,6 +177,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         };
 
         std::shared_ptr<ThrottledFuncTrailing<ScrollBarUpdate>> _updateScrollBar;
+        std::shared_ptr<ThrottledFuncTrailing<Windows::Foundation::Size>> _resizeSwapChain;
+        Windows::UI::Xaml::DispatcherTimer _resizeBufferTimer;
+        Windows::Foundation::Size _pendingBufferSize{};
 
         bool _isInternalScrollBarUpdate;
 
@@ -236,6 +250,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void _SetEndSelectionPointAtCursor(Windows::Foundation::Point const& cursorPosition);
 
         void _SwapChainSizeChanged(Windows::Foundation::IInspectable const& sender, Windows::UI::Xaml::SizeChangedEventArgs const& e);
+        void _ResizeBufferSettled(Windows::Foundation::IInspectable const& sender, Windows::Foundation::IInspectable const& e);
         void _SwapChainScaleChanged(Windows::UI::Xaml::Controls::SwapChainPanel const& sender, Windows::Foundation::IInspectable const& args);
 
         void _TerminalTabColorChanged(const std::optional<til::color> color);
@@ -43,7 +43,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         // be the one to actually raise these automation events, so they go
         // through the UI tree correctly.
         _contentAutomationPeer.SelectionChanged([this](auto&&, auto&&) { SignalSelectionChanged(); });
-        _contentAutomationPeer.TextChanged([this](auto&&, auto&&) { SignalTextChanged(); });
+        _contentAutomationPeer.TextChanged([this](auto&&, auto&&) { SignalTextChanged({}); });
         _contentAutomationPeer.CursorChanged([this](auto&&, auto&&) { SignalCursorChanged(); });
         _contentAutomationPeer.ParentProvider(*this);
     };
@@ -94,10 +94,10 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     // Method Description:
     // - Signals the ui automation client that the terminal's output has changed and should be updated
     // Arguments:
-    // - <none>
+    // - changedRegion - <unused> XAML's TextChanged event carries no details
     // Return Value:
     // - <none>
-    void TermControlAutomationPeer::SignalTextChanged()
+    void TermControlAutomationPeer::SignalTextChanged(const SMALL_RECT /*changedRegion*/)
     {
         UiaTracing::Signal::TextChanged();
         auto dispatcher{ Dispatcher() };
@@ -62,7 +62,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
 #pragma region IUiaEventDispatcher
         void SignalSelectionChanged() override;
-        void SignalTextChanged() override;
+        void SignalTextChanged(const SMALL_RECT changedRegion) override;
         void SignalCursorChanged() override;
 #pragma endregion
 
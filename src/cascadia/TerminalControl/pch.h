@@ -30,6 +30,7 @@
 #include <winrt/Windows.Foundation.Collections.h>
 #include <winrt/Windows.system.h>
 #include <winrt/Windows.Graphics.Display.h>
+#include <winrt/Windows.Graphics.Imaging.h>
 #include <winrt/windows.ui.core.h>
 #include <winrt/Windows.ui.input.h>
 #include <winrt/Windows.UI.ViewManagement.h>
@@ -47,6 +48,7 @@
 #include <winrt/Windows.ui.xaml.markup.h>
 #include <winrt/Windows.ApplicationModel.DataTransfer.h>
 #include <winrt/Windows.Storage.h>
+#include <winrt/Windows.Storage.Streams.h>
 
 #include <winrt/Microsoft.Terminal.TerminalConnection.h>
 #include <winrt/Microsoft.Terminal.Core.h>
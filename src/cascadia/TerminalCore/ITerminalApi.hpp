@@ -5,6 +5,7 @@
 #include "../../terminal/adapter/DispatchTypes.hpp"
 #include "../../terminal/input/terminalInput.hpp"
 #include "../../buffer/out/TextAttribute.hpp"
+#include "../../buffer/out/ScrollMarks.hpp"
 #include "../../renderer/inc/RenderSettings.hpp"
 #include "../../types/inc/Viewport.hpp"
 
@@ -48,6 +49,7 @@ namespace Microsoft::Terminal::Core
 
         virtual void SetInputMode(const ::Microsoft::Console::VirtualTerminal::TerminalInput::Mode mode, const bool enabled) = 0;
         virtual void SetRenderMode(const ::Microsoft::Console::Render::RenderSettings::Mode mode, const bool enabled) = 0;
+        virtual void SetSynchronizedOutput(const bool enabled) = 0;
 
         virtual void EnableXtermBracketedPasteMode(const bool enabled) = 0;
         virtual bool IsXtermBracketedPasteModeEnabled() const = 0;
@@ -62,6 +64,8 @@ namespace Microsoft::Terminal::Core
         virtual void SetTaskbarProgress(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::TaskbarState state, const size_t progress) = 0;
 
         virtual void SetWorkingDirectory(std::wstring_view uri) = 0;
+        virtual void AddScrollMark(const ScrollMarkCategory category) = 0;
+        virtual void MarkLastPromptFailed() = 0;
         virtual std::wstring_view GetWorkingDirectory() = 0;
 
         virtual void PushGraphicsRendition(const ::Microsoft::Console::VirtualTerminal::VTParameters options) = 0;
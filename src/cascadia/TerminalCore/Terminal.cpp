@@ -5,6 +5,7 @@
 #include "Terminal.hpp"
 #include "../../terminal/parser/OutputStateMachineEngine.hpp"
 #include "TerminalDispatch.hpp"
+#include "../../buffer/out/PersistedBuffer.hpp"
 #include "../../inc/unicode.hpp"
 #include "../../types/inc/utils.hpp"
 #include "../../types/inc/colorTable.hpp"
@@ -20,6 +21,10 @@ using namespace Microsoft::Console::VirtualTerminal;
 
 using PointTree = interval_tree::IntervalTree<til::point, size_t>;
 
+// The number of scrollback rows above the viewport which are kept unpacked.
+// Anything older than this is packed into the buffer's cold scrollback tier.
+static constexpr size_t HotScrollbackRows{ 1000 };
+
 static std::wstring _KeyEventsToText(std::deque<std::unique_ptr<IInputEvent>>& inEventsToWrite)
 {
     std::wstring wstr = L"";
@@ -72,6 +77,9 @@ Terminal::Terminal() :
     };
 
     _terminalInput = std::make_unique<TerminalInput>(passAlongInput);
+    // A high-rate mouse produces far more motion reports than are useful to
+    // the application. The control flushes the latest one once per frame.
+    _terminalInput->SetMotionCoalescing(true);
 
     _renderSettings.SetColorAlias(ColorAlias::DefaultForeground, TextColor::DEFAULT_FOREGROUND, RGB(255, 255, 255));
     _renderSettings.SetColorAlias(ColorAlias::DefaultBackground, TextColor::DEFAULT_BACKGROUND, RGB(0, 0, 0));
@@ -86,6 +94,7 @@ void Terminal::Create(COORD viewportSize, SHORT scrollbackLines, IRenderTarget&
     const TextAttribute attr{};
     const UINT cursorSize = 12;
     _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, renderTarget);
+    _buffer->SetColdScrollbackThreshold(_GetHotScrollbackRows(viewportSize.Y));
 }
 
 // Method Description:
@@ -237,6 +246,10 @@ void Terminal::UpdateAppearance(const ICoreAppearance& appearance)
         return S_FALSE;
     }
 
+    // If another resize arrives while we're reflowing, the result of this one
+    // is going to be thrown away anyway. CancelResize() lets us know about that.
+    const auto resizeGeneration = _resizeGeneration.load(std::memory_order_relaxed);
+
     const auto dx = ::base::ClampSub(viewportSize.X, oldDimensions.X);
     const short newBufferHeight = ::base::ClampAdd(viewportSize.Y, _scrollbackLines);
 
@@ -288,16 +301,29 @@ void Terminal::UpdateAppearance(const ICoreAppearance& appearance)
         oldRows.visibleViewportTop = newVisibleTop;
 
         const std::optional<short> oldViewStart{ oldViewportTop };
-        RETURN_IF_FAILED(TextBuffer::Reflow(*_buffer.get(),
-                                            *newTextBuffer.get(),
-                                            _mutableViewport,
-                                            { oldRows }));
+        const auto hr = TextBuffer::Reflow(*_buffer.get(),
+                                           *newTextBuffer.get(),
+                                           _mutableViewport,
+                                           { oldRows },
+                                           [&](const size_t, const size_t) noexcept {
+                                               return _resizeGeneration.load(std::memory_order_relaxed) == resizeGeneration;
+                                           });
+        // A canceled reflow isn't an error. We simply keep the current buffer
+        // until the resize that superseded this one comes around.
+        if (hr == E_ABORT)
+        {
+            return hr;
+        }
+        RETURN_IF_FAILED(hr);
 
         newViewportTop = oldRows.mutableViewportTop;
         newVisibleTop = oldRows.visibleViewportTop;
 
         // Restore the active text attributes
         newTextBuffer->SetCurrentAttributes(oldBufferAttributes);
+
+        // Reflowing unpacked every row of the old buffer. Pack the new one right away.
+        newTextBuffer->SetColdScrollbackThreshold(_GetHotScrollbackRows(viewportSize.Y));
     }
     CATCH_RETURN();
 
@@ -427,14 +453,56 @@ void Terminal::UpdateAppearance(const ICoreAppearance& appearance)
     return S_OK;
 }
 
+// Method Description:
+// - Cancels the reflow of a UserResize that's currently in progress, which then
+//   fails with E_ABORT and leaves the buffer as it was. Unlike everything else
+//   this may be called without holding the lock, which the resize is holding.
+// - Call this when a new size is known, so that resizing the window with a long
+//   scrollback only pays for reflowing the buffer to the final size.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Terminal::CancelResize() noexcept
+{
+    _resizeGeneration.fetch_add(1, std::memory_order_relaxed);
+}
+
 void Terminal::Write(std::wstring_view stringView)
+{
+    Write({ &stringView, 1 });
+}
+
+// Method Description:
+// - Writes several chunks of output, as if they were one, with a single
+//   acquisition of the lock.
+// Arguments:
+// - strings: the chunks of output to parse, in order
+// Return Value:
+// - <none>
+void Terminal::Write(const gsl::span<const std::wstring_view> strings)
 {
     auto lock = LockForWriting();
 
     auto& cursor = _buffer->GetCursor();
     const til::point cursorPosBefore{ cursor.GetPosition() };
 
-    _stateMachine->ProcessString(stringView);
+    // Only the final cursor position of a write is going to be painted, no matter
+    // how often the output moves it around. Likewise, the regions that the output
+    // invalidates are handed to the renderer all at once when the write is done.
+    // The render target outlives the buffer.
+    auto& renderTarget = _buffer->GetRenderTarget();
+    renderTarget.StartDeferCursorRedraw();
+    renderTarget.StartDeferRedraw();
+    auto endDefer = wil::scope_exit([&]() noexcept {
+        renderTarget.EndDeferRedraw();
+        renderTarget.EndDeferCursorRedraw();
+    });
+
+    for (const auto& stringView : strings)
+    {
+        _stateMachine->ProcessString(stringView);
+    }
 
     const til::point cursorPosAfter{ cursor.GetPosition() };
 
@@ -448,12 +516,26 @@ void Terminal::Write(std::wstring_view stringView)
     }
 }
 
+// Method Description:
+// - Forgets about any control sequence the parser is in the middle of. Used
+//   after output was discarded, which may have cut a sequence in half.
+// - The caller must hold the write lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Terminal::ResetParserState() noexcept
+{
+    _stateMachine->ResetState();
+}
+
 void Terminal::WritePastedText(std::wstring_view stringView)
 {
     auto option = ::Microsoft::Console::Utils::FilterOption::CarriageReturnNewline |
                   ::Microsoft::Console::Utils::FilterOption::ControlCodes;
 
     std::wstring filtered = ::Microsoft::Console::Utils::FilterStringForPaste(stringView, option);
+    FlushPendingMouseMotion();
     if (IsXtermBracketedPasteModeEnabled())
     {
         filtered.insert(0, L"\x1b[200~");
@@ -495,6 +577,28 @@ bool Terminal::IsTrackingMouseInput() const noexcept
     return _terminalInput->IsTrackingMouseInput();
 }
 
+// Routine Description:
+// - Relays if a mouse motion report is waiting to be written
+// Parameters:
+// - <none>
+// Return value:
+// - true, if FlushPendingMouseMotion needs to be called
+bool Terminal::HasPendingMouseMotion() const noexcept
+{
+    return _terminalInput->HasPendingMotion();
+}
+
+// Routine Description:
+// - Writes the latest mouse motion report, if it hasn't been written yet
+// Parameters:
+// - <none>
+// Return value:
+// - <none>
+void Terminal::FlushPendingMouseMotion()
+{
+    _terminalInput->FlushPendingMotion();
+}
+
 // Method Description:
 // - Given a coord, get the URI at that location
 // Arguments:
@@ -559,6 +663,87 @@ std::optional<PointTree::interval> Terminal::GetHyperlinkIntervalFromPosition(co
     return std::nullopt;
 }
 
+// Method Description:
+// - Takes a snapshot of the hyperlinks and URL pattern matches within the viewport.
+// - INVARIANT: this function can only be called if the caller has the reading lock on the terminal
+// Return value:
+// - The snapshot, which can be read on any thread, without holding the lock.
+std::shared_ptr<const Terminal::HoverTargets> Terminal::GetHoverTargets() const
+{
+    auto targets = std::make_shared<HoverTargets>();
+    const auto viewport = _GetVisibleViewport();
+    const auto top = _VisibleStartIndex();
+    targets->size = viewport.Dimensions();
+
+    // Hyperlinks are attributes of the cells, which are stored as runs, so only
+    // the rows that actually have any hyperlinks add something to the snapshot.
+    for (SHORT y = 0; y < targets->size.Y; ++y)
+    {
+        SHORT x = 0;
+        for (const auto& run : _buffer->GetRowByOffset(top + y).GetAttrRow().Runs())
+        {
+            const auto right = gsl::narrow_cast<SHORT>(x + run.length);
+            if (const auto id = run.value.GetHyperlinkId())
+            {
+                targets->hyperlinks.push_back({ y, x, right, id });
+            }
+            x = right;
+        }
+    }
+
+    _patternIntervalTree.visit_all([&](const PointTree::interval& interval) {
+        if (interval.value == _hyperlinkPatternId)
+        {
+            targets->patterns.emplace_back(interval);
+        }
+    });
+
+    return targets;
+}
+
+// Method Description:
+// - Gets the hyperlink ID of the text at the given terminal position, like
+//   Terminal::GetHyperlinkIdAtPosition does
+// Arguments:
+// - The position of the text
+// Return value:
+// - The hyperlink ID
+uint16_t Terminal::HoverTargets::GetHyperlinkIdAtPosition(const COORD position) const noexcept
+{
+    // Out of bounds positions are clamped into the viewport, the same way _ConvertToBufferCell() does.
+    const auto x = std::clamp<SHORT>(position.X, 0, std::max<SHORT>(size.X - 1, 0));
+    const auto y = std::clamp<SHORT>(position.Y, 0, std::max<SHORT>(size.Y - 1, 0));
+    for (const auto& run : hyperlinks)
+    {
+        if (run.y == y && x >= run.left && x < run.right)
+        {
+            return run.id;
+        }
+    }
+    return 0;
+}
+
+// Method description:
+// - Given a position in a URI pattern, gets the start and end coordinates of the URI,
+//   like Terminal::GetHyperlinkIntervalFromPosition does
+// Arguments:
+// - The position
+// Return value:
+// - The interval representing the start and end coordinates
+std::optional<PointTree::interval> Terminal::HoverTargets::GetHyperlinkIntervalFromPosition(const COORD position) const noexcept
+{
+    const til::point start{ position };
+    const til::point stop{ position.X + 1, position.Y };
+    for (const auto& interval : patterns)
+    {
+        if (interval.stop >= stop && interval.start <= start)
+        {
+            return interval;
+        }
+    }
+    return std::nullopt;
+}
+
 // Method Description:
 // - Send this particular (non-character) key event to the terminal.
 // - The terminal will translate the key and the modifiers pressed into the
@@ -915,6 +1100,46 @@ int Terminal::ViewEndIndex() const noexcept
     return _mutableViewport.BottomInclusive();
 }
 
+// Method Description:
+// - Returns the text of the given rows as plain text, without their trailing
+//   whitespace. Rows that weren't wrapped are terminated with a CRLF.
+// - The caller must hold the lock.
+// Arguments:
+// - firstRow: the first row to read
+// - lastRow: the last row to read, inclusive
+// Return Value:
+// - the text of the rows
+std::wstring Terminal::GetRowsText(const int firstRow, const int lastRow) const
+{
+    std::wstring text;
+    for (auto rowIndex = firstRow; rowIndex <= lastRow; rowIndex++)
+    {
+        const auto& row = _buffer->GetRowByOffset(rowIndex);
+        auto rowText = row.GetText();
+        const auto strEnd = rowText.find_last_not_of(UNICODE_SPACE);
+        if (strEnd != std::string::npos)
+        {
+            rowText.erase(strEnd + 1);
+            text.append(rowText);
+        }
+
+        if (!row.WasWrapForced())
+        {
+            text.push_back(UNICODE_CARRIAGERETURN);
+            text.push_back(UNICODE_LINEFEED);
+        }
+    }
+    return text;
+}
+
+// Method Description:
+// - Returns the last row of the buffer that isn't blank.
+// - The caller must hold the lock.
+int Terminal::GetLastNonSpaceRow() const
+{
+    return _buffer->GetLastNonSpaceCharacter().Y;
+}
+
 // _VisibleStartIndex is the first visible line of the buffer
 int Terminal::_VisibleStartIndex() const noexcept
 {
@@ -933,6 +1158,17 @@ Viewport Terminal::_GetVisibleViewport() const noexcept
                                     _mutableViewport.Dimensions());
 }
 
+// Method Description:
+// - Returns where the performance overlay is drawn, in buffer coordinates.
+//   It's anchored to the top right corner of the visible viewport.
+Viewport Terminal::_GetOverlayRegion() const noexcept
+{
+    const auto viewport = _GetVisibleViewport();
+    const auto size = _overlayBuffer ? _overlayBuffer->GetSize().Dimensions() : COORD{};
+    const COORD origin{ gsl::narrow_cast<SHORT>(std::max(0, viewport.Width() - size.X)), viewport.Top() };
+    return Viewport::FromDimensions(origin, size);
+}
+
 // Writes a string of text to the buffer, then moves the cursor (and viewport)
 //      in accordance with the written text.
 // This method is our proverbial `WriteCharsLegacy`, and great care should be made to
@@ -949,12 +1185,33 @@ void Terminal::_WriteBuffer(const std::wstring_view& stringView)
     // We can not waste time displaying a cursor event when we know more text is coming right behind it.
     cursor.StartDeferDrawing();
 
+    const auto bufferWidth = _buffer->GetSize().Width();
+
     for (size_t i = 0; i < stringView.size(); i++)
     {
         const auto wch = stringView.at(i);
         const COORD cursorPosBefore = cursor.GetPosition();
         COORD proposedCursorPosition = cursorPosBefore;
 
+        // Plain ASCII text can be written in bulk, up to the end of the current row.
+        // The end of the row (and anything else) is handled one character at a time below.
+        if (cursorPosBefore.X < bufferWidth)
+        {
+            const auto remaining = gsl::narrow_cast<size_t>(bufferWidth - cursorPosBefore.X);
+            const auto run = TextBuffer::MeasurePrintableAscii(stringView.substr(i, remaining));
+            if (run > 1)
+            {
+                const auto written = _buffer->WriteAsciiLine(stringView.substr(i, run), cursorPosBefore, _buffer->GetCurrentAttributes());
+                if (written > 0)
+                {
+                    proposedCursorPosition.X += gsl::narrow<SHORT>(written);
+                    i += written - 1;
+                    _AdjustCursorPosition(proposedCursorPosition);
+                    continue;
+                }
+            }
+        }
+
         // TODO: MSFT 21006766
         // This is not great but I need it demoable. Fix by making a buffer stream writer.
         //
@@ -1018,34 +1275,31 @@ void Terminal::_AdjustCursorPosition(const COORD proposedPosition)
     const auto newRows = std::max(0, proposedCursorPosition.Y - bufferSize.Height() + 1);
     if (proposedCursorPosition.Y >= bufferSize.Height())
     {
-        for (auto dy = 0; dy < newRows; dy++)
-        {
-            _buffer->IncrementCircularBuffer();
-            proposedCursorPosition.Y--;
-            rowsPushedOffTopOfBuffer++;
+        _buffer->IncrementCircularBuffer(gsl::narrow_cast<size_t>(newRows), false);
+        proposedCursorPosition.Y -= gsl::narrow_cast<SHORT>(newRows);
+        rowsPushedOffTopOfBuffer = gsl::narrow_cast<SHORT>(newRows);
 
-            // Update our selection too, so it doesn't move as the buffer is cycled
-            if (_selection)
+        // Update our selection too, so it doesn't move as the buffer is cycled
+        for (auto dy = 0; dy < newRows && _selection; dy++)
+        {
+            // If the start of the selection is above 0, we can reduce both the start and end by 1
+            if (_selection->start.Y > 0)
+            {
+                _selection->start.Y -= 1;
+                _selection->end.Y -= 1;
+            }
+            else
             {
-                // If the start of the selection is above 0, we can reduce both the start and end by 1
-                if (_selection->start.Y > 0)
+                // The start of the selection is at 0, if the end is greater than 0, then only reduce the end
+                if (_selection->end.Y > 0)
                 {
-                    _selection->start.Y -= 1;
+                    _selection->start.X = 0;
                     _selection->end.Y -= 1;
                 }
                 else
                 {
-                    // The start of the selection is at 0, if the end is greater than 0, then only reduce the end
-                    if (_selection->end.Y > 0)
-                    {
-                        _selection->start.X = 0;
-                        _selection->end.Y -= 1;
-                    }
-                    else
-                    {
-                        // Both the start and end of the selection are at 0, clear the selection
-                        _selection.reset();
-                    }
+                    // Both the start and end of the selection are at 0, clear the selection
+                    _selection.reset();
                 }
             }
         }
@@ -1232,6 +1486,55 @@ bool Terminal::IsCursorBlinkingAllowed() const noexcept
     return cursor.IsBlinkingAllowed();
 }
 
+// Method Description:
+// - Replaces the text of the performance overlay, which is drawn on top of the
+//   top right corner of the viewport in reverse video, so that it stands out
+//   from the text underneath it whatever its colors are.
+// - INVARIANT: this function can only be called if the caller has the writing lock on the terminal
+// Arguments:
+// - lines: the lines of the overlay, or none to remove it
+void Terminal::SetPerformanceOverlayUnderLock(const gsl::span<const std::wstring> lines)
+{
+    auto& renderTarget = _buffer->GetRenderTarget();
+
+    // The overlay may get smaller, so whatever it covered so far needs to be repainted too.
+    if (_overlayBuffer)
+    {
+        renderTarget.TriggerRedraw(_GetOverlayRegion());
+    }
+
+    if (lines.empty())
+    {
+        _overlayBuffer.reset();
+        return;
+    }
+
+    size_t width = 0;
+    for (const auto& line : lines)
+    {
+        width = std::max(width, line.size());
+    }
+
+    const COORD size{ gsl::narrow<SHORT>(std::max<size_t>(width, 1)), gsl::narrow<SHORT>(lines.size()) };
+    if (!_overlayBuffer || _overlayBuffer->GetSize().Dimensions() != size)
+    {
+        _overlayBuffer = std::make_unique<TextBuffer>(size, TextAttribute{}, 0, _overlayRenderTarget);
+    }
+
+    TextAttribute attr;
+    attr.SetReverseVideo(true);
+
+    std::wstring padded;
+    for (size_t y = 0; y < lines.size(); ++y)
+    {
+        padded = til::at(lines, y);
+        padded.resize(size.X, L' ');
+        _overlayBuffer->WriteLine(OutputCellIterator{ padded, attr }, { 0, gsl::narrow_cast<SHORT>(y) });
+    }
+
+    renderTarget.TriggerRedraw(_GetOverlayRegion());
+}
+
 // Method Description:
 // - Update our internal knowledge about where regex patterns are on the screen
 // - This is called by TerminalControl (through a throttled function) when the visible
@@ -1256,6 +1559,113 @@ void Terminal::ClearPatternTree() noexcept
     _InvalidatePatternTree(oldTree);
 }
 
+// Method Description:
+// - Returns the marks of all rows of the buffer. They're maintained as output
+//   arrives and the buffer circles, so this only costs as much as there are
+//   marks, no matter how long the scrollback is.
+// - The caller must hold the lock.
+// Return Value:
+// - The marks, ordered by their row. Where the output of commands starts isn't
+//   shown on the scrollbar, so those marks aren't included.
+std::vector<ScrollMark> Terminal::GetScrollMarks() const
+{
+    auto marks = _buffer->GetScrollMarks().Get(0, _buffer->TotalRowCount());
+    marks.erase(std::remove_if(marks.begin(), marks.end(), [](const ScrollMark& mark) noexcept {
+                    return mark.category == ScrollMarkCategory::Output;
+                }),
+                marks.end());
+    return marks;
+}
+
+// Method Description:
+// - Returns a counter that changes whenever GetScrollMarks() may return
+//   something else, like when a mark was added or the buffer circled.
+// - The caller must hold the lock.
+uint64_t Terminal::GetScrollMarksGeneration() const noexcept
+{
+    return _buffer->GetScrollMarks().GetGeneration();
+}
+
+// Method Description:
+// - Replaces the marks of the results of the previous search.
+// - The caller must hold the lock.
+// Arguments:
+// - matches: the [start, end] positions of the results, in buffer coordinates,
+//   ordered by their start. Empty clears the marks.
+// Return Value:
+// - <none>
+void Terminal::SetSearchMarks(const std::vector<std::pair<COORD, COORD>>& matches)
+{
+    std::vector<size_t> rows;
+    rows.reserve(matches.size());
+    for (const auto& match : matches)
+    {
+        rows.push_back(gsl::narrow_cast<size_t>(match.first.Y));
+    }
+    _buffer->GetScrollMarks().Replace(ScrollMarkCategory::SearchResult, rows);
+}
+
+// Method Description:
+// - Scrolls the prompt before or after the top of the viewport to the top of
+//   the viewport. The prompts are found in the marks, so this doesn't depend
+//   on the length of the scrollback.
+// - The caller must hold the lock.
+// Arguments:
+// - forward: true to scroll to the next prompt, false to the previous one
+// Return Value:
+// - false if there's no prompt in that direction.
+bool Terminal::ScrollToPrompt(const bool forward)
+{
+    const auto& marks = _buffer->GetScrollMarks();
+    const auto top = gsl::narrow_cast<size_t>(_VisibleStartIndex());
+    const auto prompt = forward ? marks.NextPrompt(top) : marks.PreviousPrompt(top);
+    if (!prompt)
+    {
+        return false;
+    }
+
+    // Prompts within the last page of the buffer can't be scrolled to the top.
+    _scrollOffset = std::max(0, ViewStartIndex() - gsl::narrow<int>(*prompt));
+    _buffer->GetRenderTarget().TriggerScroll();
+    _NotifyScrollEvent();
+    return true;
+}
+
+// Method Description:
+// - Selects the output of a command, as reported by the shell with FTCS
+//   sequences: the command the selection starts in, or the last one that
+//   finished, if there's no selection.
+// - The caller must hold the lock.
+// Arguments:
+// - <none>
+// Return Value:
+// - false if there's no such command, or it didn't output anything.
+bool Terminal::SelectCommandOutput()
+{
+    const auto cursorRow = gsl::narrow_cast<size_t>(_buffer->GetCursor().GetPosition().Y);
+    // Without a selection, the cursor is usually at the prompt of the next
+    // command, so the last one that finished is the one right above it.
+    size_t row = 0;
+    if (IsSelectionActive())
+    {
+        row = gsl::narrow_cast<size_t>(GetSelectionAnchor().Y);
+    }
+    else if (cursorRow > 0)
+    {
+        row = cursorRow - 1;
+    }
+
+    const auto output = _buffer->GetScrollMarks().GetCommandOutput(row, cursorRow + 1);
+    if (!output)
+    {
+        return false;
+    }
+
+    const auto right = gsl::narrow<short>(_buffer->GetSize().RightInclusive());
+    SelectNewRegion({ 0, gsl::narrow<short>(output->first) }, { right, gsl::narrow<short>(output->second - 1) });
+    return true;
+}
+
 // Method Description:
 // - Returns the tab color
 // If the starting color exits, it's value is preferred
@@ -1282,6 +1692,79 @@ const size_t Microsoft::Terminal::Core::Terminal::GetTaskbarProgress() const noe
     return _taskbarProgress;
 }
 
+// Method Description:
+// - Estimates how much memory the text buffer holds on to. See TextBuffer::GetMemoryUsage().
+// - The caller must hold the lock.
+// Return Value:
+// - the estimated size of the buffer in bytes
+size_t Terminal::GetBufferMemoryUsage() const noexcept
+{
+    return _buffer ? _buffer->GetMemoryUsage() : 0;
+}
+
+// Method Description:
+// - Makes the buffer pack its scrollback more or less eagerly. Aggressively,
+//   only the viewport is kept unpacked, otherwise another HotScrollbackRows
+//   above it, too. Packing doesn't lose anything: packed rows are unpacked
+//   again whenever something looks at them.
+// - The caller must hold the lock.
+// Arguments:
+// - aggressive: whether to pack everything but the viewport
+// Return Value:
+// - <none>
+void Terminal::SetScrollbackCompaction(const bool aggressive)
+{
+    if (_aggressiveScrollbackCompaction == aggressive)
+    {
+        return;
+    }
+
+    _aggressiveScrollbackCompaction = aggressive;
+    if (_buffer)
+    {
+        _buffer->SetColdScrollbackThreshold(_GetHotScrollbackRows(_mutableViewport.Height()));
+    }
+}
+
+// Method Description:
+// - Saves the contents of the buffer into the given file. See PersistedBuffer.
+// - The caller must hold the lock.
+// Arguments:
+// - path: the file to save the buffer into. It's replaced if it exists.
+// Return Value:
+// - <none>
+void Terminal::PersistBuffer(const std::wstring_view path) const
+{
+    PersistedBuffer::Save(*_buffer, path);
+}
+
+// Method Description:
+// - Restores the contents of the buffer from a file that PersistBuffer() saved.
+//   The cursor is then put at the start of the next line, so that whatever
+//   the connection prints afterwards doesn't overwrite what was restored.
+// - The caller must hold the lock.
+// Arguments:
+// - path: the file to restore the buffer from
+// Return Value:
+// - false if there was no such file, true otherwise
+bool Terminal::RestoreBuffer(const std::wstring_view path)
+{
+    if (!PersistedBuffer::Restore(*_buffer, path))
+    {
+        return false;
+    }
+
+    const auto cursorPosition = _buffer->GetCursor().GetPosition();
+    _AdjustCursorPosition({ 0, gsl::narrow<SHORT>(cursorPosition.Y + 1) });
+    _buffer->GetRenderTarget().TriggerRedrawAll();
+    return true;
+}
+
+size_t Terminal::_GetHotScrollbackRows(const SHORT viewportHeight) const noexcept
+{
+    return gsl::narrow_cast<size_t>(viewportHeight) + (_aggressiveScrollbackCompaction ? 0 : HotScrollbackRows);
+}
+
 Scheme Terminal::GetColorScheme() const noexcept
 {
     Scheme s;
@@ -9,6 +9,7 @@
 #include "../../buffer/out/textBuffer.hpp"
 #include "../../types/inc/sgrStack.hpp"
 #include "../../renderer/inc/RenderSettings.hpp"
+#include "../../renderer/inc/DummyRenderTarget.hpp"
 #include "../../terminal/parser/StateMachine.hpp"
 #include "../../terminal/input/terminalInput.hpp"
 
@@ -58,6 +59,27 @@ class Microsoft::Terminal::Core::Terminal final :
     using RenderSettings = Microsoft::Console::Render::RenderSettings;
 
 public:
+    // The hyperlinks and URL pattern matches within the viewport, which are what the mouse
+    // can hover over. They're a copy of what the buffer and the pattern tree held when it
+    // was taken, so they can be hit-tested without holding the lock. See GetHoverTargets().
+    struct HoverTargets
+    {
+        struct HyperlinkRun
+        {
+            SHORT y = 0;
+            SHORT left = 0;
+            SHORT right = 0; // exclusive
+            uint16_t id = 0;
+        };
+
+        COORD size{};
+        std::vector<HyperlinkRun> hyperlinks;
+        std::vector<interval_tree::IntervalTree<til::point, size_t>::interval> patterns;
+
+        uint16_t GetHyperlinkIdAtPosition(const COORD position) const noexcept;
+        std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> GetHyperlinkIntervalFromPosition(const COORD position) const noexcept;
+    };
+
     Terminal();
     ~Terminal(){};
     Terminal(const Terminal&) = default;
@@ -78,6 +100,8 @@ public:
 
     // Write goes through the parser
     void Write(std::wstring_view stringView);
+    void Write(const gsl::span<const std::wstring_view> strings);
+    void ResetParserState() noexcept;
 
     // WritePastedText goes directly to the connection
     void WritePastedText(std::wstring_view stringView);
@@ -90,9 +114,14 @@ public:
     int ViewStartIndex() const noexcept;
     int ViewEndIndex() const noexcept;
 
+    std::wstring GetRowsText(const int firstRow, const int lastRow) const;
+    int GetLastNonSpaceRow() const;
+
     RenderSettings& GetRenderSettings() noexcept { return _renderSettings; };
     const RenderSettings& GetRenderSettings() const noexcept { return _renderSettings; };
 
+    void SetPerformanceOverlayUnderLock(const gsl::span<const std::wstring> lines);
+
 #pragma region ITerminalApi
     // These methods are defined in TerminalApi.cpp
     void PrintString(std::wstring_view stringView) override;
@@ -118,6 +147,7 @@ public:
 
     void SetInputMode(const ::Microsoft::Console::VirtualTerminal::TerminalInput::Mode mode, const bool enabled) override;
     void SetRenderMode(const ::Microsoft::Console::Render::RenderSettings::Mode mode, const bool enabled) override;
+    void SetSynchronizedOutput(const bool enabled) override;
 
     void EnableXtermBracketedPasteMode(const bool enabled) override;
     bool IsXtermBracketedPasteModeEnabled() const override;
@@ -132,6 +162,8 @@ public:
     void SetTaskbarProgress(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::TaskbarState state, const size_t progress) override;
     void SetWorkingDirectory(std::wstring_view uri) override;
     std::wstring_view GetWorkingDirectory() override;
+    void AddScrollMark(const ScrollMarkCategory category) override;
+    void MarkLastPromptFailed() override;
 
     void PushGraphicsRendition(const ::Microsoft::Console::VirtualTerminal::VTParameters options) override;
     void PopGraphicsRendition() override;
@@ -145,15 +177,19 @@ public:
     bool SendCharEvent(const wchar_t ch, const WORD scanCode, const ControlKeyStates states) override;
 
     [[nodiscard]] HRESULT UserResize(const COORD viewportSize) noexcept override;
+    void CancelResize() noexcept;
     void UserScrollViewport(const int viewTop) override;
     int GetScrollOffset() noexcept override;
 
     void TrySnapOnInput() override;
     bool IsTrackingMouseInput() const noexcept;
+    bool HasPendingMouseMotion() const noexcept;
+    void FlushPendingMouseMotion();
 
     std::wstring GetHyperlinkAtPosition(const COORD position);
     uint16_t GetHyperlinkIdAtPosition(const COORD position);
     std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> GetHyperlinkIntervalFromPosition(const COORD position);
+    std::shared_ptr<const HoverTargets> GetHoverTargets() const;
 #pragma endregion
 
 #pragma region IBaseData(base to IRenderData and IUiaData)
@@ -175,16 +211,16 @@ public:
     ULONG GetCursorPixelWidth() const noexcept override;
     CursorType GetCursorStyle() const noexcept override;
     bool IsCursorDoubleWidth() const override;
-    const std::vector<Microsoft::Console::Render::RenderOverlay> GetOverlays() const noexcept override;
+    gsl::span<const Microsoft::Console::Render::RenderOverlay> GetOverlays() const noexcept override;
     const bool IsGridLineDrawingAllowed() noexcept override;
     const std::wstring GetHyperlinkUri(uint16_t id) const noexcept override;
     const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept override;
-    const std::vector<size_t> GetPatternId(const COORD location) const noexcept override;
+    gsl::span<const size_t> GetPatternId(const COORD location) const noexcept override;
 #pragma endregion
 
 #pragma region IUiaData
     std::pair<COLORREF, COLORREF> GetAttributeColors(const TextAttribute& attr) const noexcept override;
-    std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
+    gsl::span<const Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
     const bool IsSelectionActive() const noexcept override;
     const bool IsBlockSelection() const noexcept override;
     void ClearSelection() override;
@@ -212,6 +248,12 @@ public:
     void UpdatePatternsUnderLock() noexcept;
     void ClearPatternTree() noexcept;
 
+    std::vector<ScrollMark> GetScrollMarks() const;
+    uint64_t GetScrollMarksGeneration() const noexcept;
+    bool ScrollToPrompt(const bool forward);
+    bool SelectCommandOutput();
+    void SetSearchMarks(const std::vector<std::pair<COORD, COORD>>& matches);
+
     const std::optional<til::color> GetTabColor() const noexcept;
 
     winrt::Microsoft::Terminal::Core::Scheme GetColorScheme() const noexcept;
@@ -220,6 +262,12 @@ public:
     const size_t GetTaskbarState() const noexcept;
     const size_t GetTaskbarProgress() const noexcept;
 
+    size_t GetBufferMemoryUsage() const noexcept;
+    void SetScrollbackCompaction(const bool aggressive);
+
+    void PersistBuffer(const std::wstring_view path) const;
+    bool RestoreBuffer(const std::wstring_view path);
+
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
     enum class SelectionDirection
@@ -321,7 +369,15 @@ private:
     //      encapsulated, such that a Terminal can have both a main and alt buffer.
     std::unique_ptr<TextBuffer> _buffer;
     Microsoft::Console::Types::Viewport _mutableViewport;
+    // If set, only the viewport is kept unpacked. See SetScrollbackCompaction().
+    bool _aggressiveScrollbackCompaction{ false };
+
+    // The text of the performance overlay, if it's shown. See SetPerformanceOverlayUnderLock().
+    DummyRenderTarget _overlayRenderTarget;
+    std::unique_ptr<TextBuffer> _overlayBuffer;
     SHORT _scrollbackLines;
+    // Incremented by CancelResize to abandon the reflow of a UserResize that's in progress.
+    std::atomic<size_t> _resizeGeneration{ 0 };
 
     // _scrollOffset is the number of lines above the viewport that are currently visible
     // If _scrollOffset is 0, then the visible region of the buffer is the viewport.
@@ -340,6 +396,12 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+
+    // Reused from call to call, so that the renderer's queries don't allocate. See IRenderData.
+    std::vector<SMALL_RECT> _selectionLines;
+    std::vector<Microsoft::Console::Types::Viewport> _selectionRects;
+    mutable std::vector<Microsoft::Console::Render::RenderOverlay> _overlays;
+    mutable std::vector<size_t> _patternIds;
     void _InvalidatePatternTree(interval_tree::IntervalTree<til::point, size_t>& tree);
     void _InvalidateFromCoords(const COORD start, const COORD end);
 
@@ -364,6 +426,7 @@ private:
 
     Microsoft::Console::Types::Viewport _GetMutableViewport() const noexcept;
     Microsoft::Console::Types::Viewport _GetVisibleViewport() const noexcept;
+    Microsoft::Console::Types::Viewport _GetOverlayRegion() const noexcept;
 
     void _WriteBuffer(const std::wstring_view& stringView);
 
@@ -373,6 +436,8 @@ private:
 
     void _NotifyTerminalCursorPositionChanged() noexcept;
 
+    size_t _GetHotScrollbackRows(const SHORT viewportHeight) const noexcept;
+
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
     std::vector<SMALL_RECT> _GetSelectionRects() const noexcept;
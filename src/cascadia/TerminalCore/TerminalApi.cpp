@@ -252,10 +252,10 @@ bool Terminal::EraseInDisplay(const DispatchTypes::EraseType eraseType)
 
         // Increment the circular buffer only if the new location of the viewport would be 'below' the buffer
         const short delta = (sNewTop + _mutableViewport.Height()) - (_buffer->GetSize().Height());
-        for (auto i = 0; i < delta; i++)
+        if (delta > 0)
         {
-            _buffer->IncrementCircularBuffer();
-            sNewTop--;
+            _buffer->IncrementCircularBuffer(gsl::narrow_cast<size_t>(delta), false);
+            sNewTop -= delta;
         }
 
         newWin.Top = sNewTop;
@@ -270,13 +270,9 @@ bool Terminal::EraseInDisplay(const DispatchTypes::EraseType eraseType)
         _buffer->ScrollRows(scrollFromPos.Y, _mutableViewport.Height(), -scrollFromPos.Y);
 
         // Since we only did a rotation, the text that was in the scrollback is now _below_ where we are going to move the viewport
-        // and we have to make sure we erase that text
-        const auto eraseStart = _mutableViewport.Height();
-        const auto eraseEnd = _buffer->GetLastNonSpaceCharacter(_mutableViewport).Y;
-        for (SHORT i = eraseStart; i <= eraseEnd; i++)
-        {
-            _buffer->GetRowByOffset(i).Reset(_buffer->GetCurrentAttributes());
-        }
+        // and we have to make sure we erase that text, along with the marks that moved down with it.
+        // ClearRowsBelow only takes as long as the viewport is tall, no matter how long the scrollback is.
+        _buffer->ClearRowsBelow(gsl::narrow_cast<size_t>(_mutableViewport.Height()), _buffer->GetCurrentAttributes());
 
         // Reset the scroll offset now because there's nothing for the user to 'scroll' to
         _scrollOffset = 0;
@@ -419,6 +415,11 @@ void Terminal::SetRenderMode(const RenderSettings::Mode mode, const bool enabled
     _buffer->GetRenderTarget().TriggerRedrawAll();
 }
 
+void Terminal::SetSynchronizedOutput(const bool enabled)
+{
+    _buffer->GetRenderTarget().SetSynchronizedOutput(enabled);
+}
+
 void Terminal::EnableXtermBracketedPasteMode(const bool enabled)
 {
     _bracketedPasteMode = enabled;
@@ -545,6 +546,28 @@ std::wstring_view Terminal::GetWorkingDirectory()
     return _workingDirectory;
 }
 
+// Method Description:
+// - Marks the row of the cursor, like when the shell is about to print a prompt.
+// Arguments:
+// - category: what kind of mark it is
+// Return Value:
+// - <none>
+void Terminal::AddScrollMark(const ScrollMarkCategory category)
+{
+    _buffer->GetScrollMarks().Add(_buffer->GetCursor().GetPosition().Y, category);
+}
+
+// Method Description:
+// - Marks the last prompt as the prompt of a command that failed.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Terminal::MarkLastPromptFailed()
+{
+    _buffer->GetScrollMarks().ChangeLast(ScrollMarkCategory::Prompt, ScrollMarkCategory::Error);
+}
+
 // Method Description:
 // - Saves the current text attributes to an internal stack.
 // Arguments:
@@ -432,6 +432,19 @@ bool TerminalDispatch::EnableXtermBracketedPasteMode(const bool enabled)
     return true;
 }
 
+//Routine Description:
+// Synchronized Output - while enabled, the application is in the middle of an
+//      update of the screen, which the renderer presents at once when it's complete.
+//Arguments:
+// - enabled - true at the start of an update, false at its end.
+// Return value:
+// - True.
+bool TerminalDispatch::EnableSynchronizedOutput(const bool enabled)
+{
+    _terminalApi.SetSynchronizedOutput(enabled);
+    return true;
+}
+
 bool TerminalDispatch::SetMode(const DispatchTypes::ModeParams param)
 {
     return _ModeParamsHelper(param, true);
@@ -545,6 +558,47 @@ bool TerminalDispatch::DoConEmuAction(const std::wstring_view string)
     return false;
 }
 
+// Method Description:
+// - Performs a FinalTerm action, with which shells report the parts of their
+//   prompts and commands ("FTCS", also known as shell integration).
+// - We mark the rows of prompts, and the prompts of commands that failed,
+//   which the control can show on its scrollbar. See ScrollMarks.
+// Arguments:
+// - string: contains the parameters that define which action we do
+// Return Value:
+// - true if the action is supported
+bool TerminalDispatch::DoFinalTermAction(const std::wstring_view string)
+{
+    const auto parts = Utils::SplitString(string, L';');
+    if (parts.size() < 1 || til::at(parts, 0).size() != 1)
+    {
+        return false;
+    }
+
+    switch (til::at(parts, 0).front())
+    {
+    case L'A': // FTCS_PROMPT
+        _terminalApi.AddScrollMark(ScrollMarkCategory::Prompt);
+        return true;
+    case L'B': // FTCS_COMMAND_START
+        return true;
+    case L'C': // FTCS_COMMAND_EXECUTED
+        _terminalApi.AddScrollMark(ScrollMarkCategory::Output);
+        return true;
+    case L'D': // FTCS_COMMAND_FINISHED, optionally followed by the exit code
+    {
+        unsigned int exitCode = 0;
+        if (parts.size() >= 2 && Utils::StringToUint(til::at(parts, 1), exitCode) && exitCode != 0)
+        {
+            _terminalApi.MarkLastPromptFailed();
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
 // Routine Description:
 // - Support routine for routing private mode parameters to be set/reset as flags
 // Arguments:
@@ -591,6 +645,9 @@ bool TerminalDispatch::_ModeParamsHelper(const DispatchTypes::ModeParams param,
     case DispatchTypes::ModeParams::XTERM_BracketedPasteMode:
         success = EnableXtermBracketedPasteMode(enable);
         break;
+    case DispatchTypes::ModeParams::SO_SynchronizedOutput:
+        success = EnableSynchronizedOutput(enable);
+        break;
     case DispatchTypes::ModeParams::W32IM_Win32InputMode:
         success = EnableWin32InputMode(enable);
         break;
@@ -717,6 +774,9 @@ bool TerminalDispatch::HardReset()
     EnableSGRExtendedMouseMode(false);
     EnableAnyEventMouseMode(false);
 
+    // An update that's still in progress won't ever be completed.
+    EnableSynchronizedOutput(false);
+
     // Delete all current tab stops and reapply
     _ResetTabStops();
 
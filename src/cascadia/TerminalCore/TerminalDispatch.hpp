@@ -71,6 +71,7 @@ public:
     bool EnableAnyEventMouseMode(const bool enabled) override; // ?1003
     bool EnableAlternateScroll(const bool enabled) override; // ?1007
     bool EnableXtermBracketedPasteMode(const bool enabled) override; // ?2004
+    bool EnableSynchronizedOutput(const bool enabled) override; // ?2026
 
     bool SetMode(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::ModeParams /*param*/) override; // DECSET
     bool ResetMode(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::ModeParams /*param*/) override; // DECRST
@@ -80,6 +81,8 @@ public:
 
     bool DoConEmuAction(const std::wstring_view string) override;
 
+    bool DoFinalTermAction(const std::wstring_view string) override;
+
 private:
     ::Microsoft::Terminal::Core::ITerminalApi& _terminalApi;
 
@@ -78,8 +78,24 @@ bool Terminal::IsCursorDoubleWidth() const
     return IsGlyphFullWidth(*it);
 }
 
-const std::vector<RenderOverlay> Terminal::GetOverlays() const noexcept
+gsl::span<const RenderOverlay> Terminal::GetOverlays() const noexcept
+try
+{
+    _overlays.clear();
+
+    if (_overlayBuffer)
+    {
+        // Overlays are positioned relative to the visible viewport.
+        const auto region = _GetOverlayRegion();
+        const COORD origin{ region.Left(), 0 };
+        _overlays.emplace_back(RenderOverlay{ *_overlayBuffer, origin, _overlayBuffer->GetSize() });
+    }
+
+    return _overlays;
+}
+catch (...)
 {
+    LOG_CAUGHT_EXCEPTION();
     return {};
 }
 
@@ -103,24 +119,22 @@ const std::wstring Microsoft::Terminal::Core::Terminal::GetHyperlinkCustomId(uin
 // Arguments:
 // - The location
 // Return value:
-// - The pattern IDs of the location
-const std::vector<size_t> Terminal::GetPatternId(const COORD location) const noexcept
+// - The pattern IDs of the location, valid until the next call
+gsl::span<const size_t> Terminal::GetPatternId(const COORD location) const noexcept
+try
 {
+    _patternIds.clear();
+
     // Look through our interval tree for this location
-    const auto intervals = _patternIntervalTree.findOverlapping(til::point{ location.X + 1, location.Y }, til::point{ location });
-    if (intervals.size() == 0)
-    {
-        return {};
-    }
-    else
-    {
-        std::vector<size_t> result{};
-        for (const auto& interval : intervals)
-        {
-            result.emplace_back(interval.value);
-        }
-        return result;
-    }
+    _patternIntervalTree.visit_overlapping(til::point{ location.X + 1, location.Y }, til::point{ location }, [&](const auto& interval) {
+        _patternIds.emplace_back(interval.value);
+    });
+
+    return _patternIds;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
     return {};
 }
 
@@ -129,17 +143,21 @@ std::pair<COLORREF, COLORREF> Terminal::GetAttributeColors(const TextAttribute&
     return _renderSettings.GetAttributeColors(attr);
 }
 
-std::vector<Microsoft::Console::Types::Viewport> Terminal::GetSelectionRects() noexcept
+gsl::span<const Microsoft::Console::Types::Viewport> Terminal::GetSelectionRects() noexcept
 try
 {
-    std::vector<Viewport> result;
+    _selectionRects.clear();
 
-    for (const auto& lineRect : _GetSelectionRects())
+    if (IsSelectionActive())
     {
-        result.emplace_back(Viewport::FromInclusive(lineRect));
+        _buffer->GetTextRects(_selection->start, _selection->end, _blockSelection, false, _selectionLines);
+        for (const auto& lineRect : _selectionLines)
+        {
+            _selectionRects.emplace_back(Viewport::FromInclusive(lineRect));
+        }
     }
 
-    return result;
+    return _selectionRects;
 }
 catch (...)
 {
@@ -39,6 +39,9 @@ static constexpr std::string_view ScrollUpKey{ "scrollUp" };
 static constexpr std::string_view ScrollUpPageKey{ "scrollUpPage" };
 static constexpr std::string_view ScrollToTopKey{ "scrollToTop" };
 static constexpr std::string_view ScrollToBottomKey{ "scrollToBottom" };
+static constexpr std::string_view ScrollToPreviousPromptKey{ "scrollToPreviousPrompt" };
+static constexpr std::string_view ScrollToNextPromptKey{ "scrollToNextPrompt" };
+static constexpr std::string_view SelectCommandOutputKey{ "selectCommandOutput" };
 static constexpr std::string_view SendInputKey{ "sendInput" };
 static constexpr std::string_view SetColorSchemeKey{ "setColorScheme" };
 static constexpr std::string_view SetTabColorKey{ "setTabColor" };
@@ -75,6 +78,8 @@ static constexpr std::string_view MultipleActionsKey{ "multipleActions" };
 static constexpr std::string_view QuitKey{ "quit" };
 static constexpr std::string_view AdjustOpacityKey{ "adjustOpacity" };
 static constexpr std::string_view RestoreLastClosedKey{ "restoreLastClosed" };
+static constexpr std::string_view SkipOutputKey{ "skipOutput" };
+static constexpr std::string_view TogglePerformanceOverlayKey{ "togglePerformanceOverlay" };
 
 static constexpr std::string_view ActionKey{ "action" };
 
@@ -351,6 +356,9 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
                 { ShortcutAction::ScrollUpPage, RS_(L"ScrollUpPageCommandKey") },
                 { ShortcutAction::ScrollToTop, RS_(L"ScrollToTopCommandKey") },
                 { ShortcutAction::ScrollToBottom, RS_(L"ScrollToBottomCommandKey") },
+                { ShortcutAction::ScrollToPreviousPrompt, RS_(L"ScrollToPreviousPromptCommandKey") },
+                { ShortcutAction::ScrollToNextPrompt, RS_(L"ScrollToNextPromptCommandKey") },
+                { ShortcutAction::SelectCommandOutput, RS_(L"SelectCommandOutputCommandKey") },
                 { ShortcutAction::SendInput, L"" },
                 { ShortcutAction::SetColorScheme, L"" },
                 { ShortcutAction::SetTabColor, RS_(L"ResetTabColorCommandKey") },
@@ -386,6 +394,8 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
                 { ShortcutAction::Quit, RS_(L"QuitCommandKey") },
                 { ShortcutAction::AdjustOpacity, L"" }, // Intentionally omitted, must be generated by GenerateName
                 { ShortcutAction::RestoreLastClosed, RS_(L"RestoreLastClosedCommandKey") },
+                { ShortcutAction::SkipOutput, RS_(L"SkipOutputCommandKey") },
+                { ShortcutAction::TogglePerformanceOverlay, RS_(L"TogglePerformanceOverlayCommandKey") },
             };
         }();
 
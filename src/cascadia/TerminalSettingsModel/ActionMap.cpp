@@ -434,6 +434,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         _NameMapCache = nullptr;
         _GlobalHotkeysCache = nullptr;
         _KeyBindingMapCache = nullptr;
+        *_ResolvedKeyChordCache.lock() = std::nullopt;
 
         // Handle nested commands
         const auto cmdImpl{ get_self<Command>(cmd) };
@@ -631,7 +632,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             const auto conflictingCmdImpl{ get_self<implementation::Command>(conflictingCmd) };
             conflictingCmdImpl->EraseKey(keys);
         }
-        else if (const auto& conflictingCmd{ GetActionByKeyChord(keys) })
+        else if (const auto& conflictingCmd{ _GetActionByKeyChordInternal(keys).value_or(nullptr) })
         {
             // Collision with ancestor: The key chord was already in use, but by an action in another layer
             //
@@ -701,7 +702,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         // We use the fact that the ..Internal call returns nullptr for explicitly unbound
         // key chords, and nullopt for keychord that are not bound - it allows us to distinguish
         // between unbound and lack of binding.
-        return _GetActionByKeyChordInternal(keys) == nullptr;
+        return _GetResolvedActionByKeyChord(keys) == nullptr;
     }
 
     // Method Description:
@@ -713,7 +714,66 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
     // - nullptr if the key chord doesn't exist
     Model::Command ActionMap::GetActionByKeyChord(Control::KeyChord const& keys) const
     {
-        return _GetActionByKeyChordInternal(keys).value_or(nullptr);
+        return _GetResolvedActionByKeyChord(keys).value_or(nullptr);
+    }
+
+    // Method Description:
+    // - Same as _GetActionByKeyChordInternal, but looks the key chord up in
+    //   a flattened copy of the key maps of all layers, instead of walking
+    //   through them. The copy is built on first use.
+    // Arguments:
+    // - keys: the key chord of the command to search for
+    // Return Value:
+    // - the command with the given key chord
+    // - nullptr if the key chord is explicitly unbound
+    // - nullopt if it isn't bound
+    std::optional<Model::Command> ActionMap::_GetResolvedActionByKeyChord(const Control::KeyChord& keys) const
+    {
+        {
+            const auto cache = _ResolvedKeyChordCache.lock_shared();
+            if (cache->has_value())
+            {
+                const auto& resolvedKeyChords = cache->value();
+                const auto it = resolvedKeyChords.find(keys);
+                return it != resolvedKeyChords.end() ? it->second : std::nullopt;
+            }
+        }
+
+        // The map is built outside of the lock, so that other windows don't
+        // have to wait for us. If they build it too, the first one wins.
+        std::unordered_map<Control::KeyChord, std::optional<Model::Command>, KeyChordHash, KeyChordEquality> resolvedKeyChords;
+        _PopulateResolvedKeyChordMap(resolvedKeyChords);
+
+        auto cache = _ResolvedKeyChordCache.lock();
+        if (!cache->has_value())
+        {
+            *cache = std::move(resolvedKeyChords);
+        }
+        const auto it = (*cache)->find(keys);
+        return it != (*cache)->end() ? it->second : std::nullopt;
+    }
+
+    // Method Description:
+    // - Adds the key chords of our _KeyMap and those of our parents to the map.
+    //   Key chords that are in there already came from a layer closer to the
+    //   top, which has precedence, just like in _GetActionByKeyChordInternal.
+    // Arguments:
+    // - resolvedKeyChords: the map we're populating
+    void ActionMap::_PopulateResolvedKeyChordMap(std::unordered_map<Control::KeyChord, std::optional<Model::Command>, KeyChordHash, KeyChordEquality>& resolvedKeyChords) const
+    {
+        for (const auto& [keys, actionID] : _KeyMap)
+        {
+            if (resolvedKeyChords.find(keys) == resolvedKeyChords.end())
+            {
+                resolvedKeyChords.emplace(keys, _GetActionByID(actionID));
+            }
+        }
+
+        assert(_parents.size() <= 1);
+        for (const auto& parent : _parents)
+        {
+            parent->_PopulateResolvedKeyChordMap(resolvedKeyChords);
+        }
     }
 
     // Method Description:
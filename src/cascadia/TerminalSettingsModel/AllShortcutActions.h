@@ -47,6 +47,9 @@
     ON_ALL_ACTIONS(ScrollDownPage)         \
     ON_ALL_ACTIONS(ScrollToTop)            \
     ON_ALL_ACTIONS(ScrollToBottom)         \
+    ON_ALL_ACTIONS(ScrollToPreviousPrompt) \
+    ON_ALL_ACTIONS(ScrollToNextPrompt)     \
+    ON_ALL_ACTIONS(SelectCommandOutput)    \
     ON_ALL_ACTIONS(ResizePane)             \
     ON_ALL_ACTIONS(MoveFocus)              \
     ON_ALL_ACTIONS(MovePane)               \
@@ -88,7 +91,9 @@
     ON_ALL_ACTIONS(MultipleActions)        \
     ON_ALL_ACTIONS(Quit)                   \
     ON_ALL_ACTIONS(AdjustOpacity)          \
-    ON_ALL_ACTIONS(RestoreLastClosed)
+    ON_ALL_ACTIONS(RestoreLastClosed)      \
+    ON_ALL_ACTIONS(SkipOutput)             \
+    ON_ALL_ACTIONS(TogglePerformanceOverlay)
 
 #define ALL_SHORTCUT_ACTIONS_WITH_ARGS             \
     ON_ALL_ACTIONS_WITH_ARGS(AdjustFontSize)       \
@@ -204,10 +204,31 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 
     // Serialized this ApplicationState (in `context`) into the state.json at _path.
     // * Errors are only logged.
-    // * _state->_writeScheduled is set to false, signaling our
-    //   setters that _synchronize() needs to be called again.
+    // * Only the files holding fields that were modified since the last call
+    //   are written. Most updates only touch a single Shared or Local field,
+    //   and there's no need to re-read state.json, or to rewrite the window
+    //   layouts, if a recent command was added while elevated.
     void ApplicationState::_write() const noexcept
-    try
+    {
+        const auto dirty = std::exchange(_state.lock()->dirty, FileSource{});
+        if (!dirty)
+        {
+            return;
+        }
+
+        try
+        {
+            _writeDirty(dirty);
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            // Try again with the next modification.
+            _state.lock()->dirty |= dirty;
+        }
+    }
+
+    void ApplicationState::_writeDirty(const FileSource dirty) const
     {
         Json::StreamWriterBuilder wbuilder;
 
@@ -223,10 +244,20 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         // round-trip the Local properties for the unelevated instances
         // untouched in state.json
         //
-        // After that's done, we'll write our Local properties into
-        // elevated-state.json.
+        // Our Local properties are written into elevated-state.json on
+        // their own, and only if any of them changed.
         if (::Microsoft::Console::Utils::IsElevated())
         {
+            if (WI_IsFlagSet(dirty, FileSource::Local))
+            {
+                // Write our Local properties back to elevated-state.json
+                _writeLocalContents(Json::writeString(wbuilder, ToJson(FileSource::Local)));
+            }
+            if (WI_IsFlagClear(dirty, FileSource::Shared))
+            {
+                return;
+            }
+
             std::string errs;
             std::unique_ptr<Json::CharReader> reader{ Json::CharReaderBuilder::CharReaderBuilder().newCharReader() };
             Json::Value root;
@@ -245,9 +276,6 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             // Layer our shared properties on top of the blob from state.json,
             // and write it back out.
             _writeSharedContents(Json::writeString(wbuilder, _toJsonWithBlob(root, FileSource::Shared)));
-
-            // Finally, write our Local properties back to elevated-state.json
-            _writeLocalContents(Json::writeString(wbuilder, ToJson(FileSource::Local)));
         }
         else
         {
@@ -255,7 +283,6 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             _writeLocalContents(Json::writeString(wbuilder, ToJson(FileSource::Local | FileSource::Shared)));
         }
     }
-    CATCH_LOG()
 
     // Returns the application-global ApplicationState object.
     Microsoft::Terminal::Settings::Model::ApplicationState ApplicationState::SharedInstance()
@@ -328,6 +355,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         {                                                        \
             auto state = _state.lock();                          \
             state->name.emplace(value);                          \
+            state->dirty |= source;                              \
         }                                                        \
                                                                  \
         _throttler();                                            \
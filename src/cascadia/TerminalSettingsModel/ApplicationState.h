@@ -39,7 +39,8 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
     X(FileSource::Local, Windows::Foundation::Collections::IVector<Model::WindowLayout>, PersistedWindowLayouts, "persistedWindowLayouts")                                \
     X(FileSource::Shared, Windows::Foundation::Collections::IVector<hstring>, RecentCommands, "recentCommands")                                                           \
     X(FileSource::Shared, Windows::Foundation::Collections::IVector<winrt::Microsoft::Terminal::Settings::Model::InfoBarMessage>, DismissedMessages, "dismissedMessages") \
-    X(FileSource::Local, Windows::Foundation::Collections::IVector<hstring>, AllowedCommandlines, "allowedCommandlines")
+    X(FileSource::Local, Windows::Foundation::Collections::IVector<hstring>, AllowedCommandlines, "allowedCommandlines")                                                  \
+    X(FileSource::Shared, Windows::Foundation::Collections::IMap<hstring, winrt::Microsoft::Terminal::Control::RendererConfiguration>, RendererCalibrations, "rendererCalibrations")
 
     struct WindowLayout : WindowLayoutT<WindowLayout>
     {
@@ -84,6 +85,9 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 #define MTSM_APPLICATION_STATE_GEN(source, type, name, key, ...) std::optional<type> name{ __VA_ARGS__ };
             MTSM_APPLICATION_STATE_FIELDS(MTSM_APPLICATION_STATE_GEN)
 #undef MTSM_APPLICATION_STATE_GEN
+
+            // The sources of the fields that were modified since the last _write().
+            FileSource dirty{};
         };
         til::shared_mutex<state_t> _state;
         std::filesystem::path _sharedPath;
@@ -91,6 +95,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         til::throttled_func_trailing<> _throttler;
 
         void _write() const noexcept;
+        void _writeDirty(const FileSource dirty) const;
         void _read() const noexcept;
 
         Json::Value _toJsonWithBlob(Json::Value& root, FileSource parseSource) const noexcept;
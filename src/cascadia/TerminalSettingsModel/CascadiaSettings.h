@@ -19,6 +19,8 @@ Author(s):
 
 #include "CascadiaSettings.g.h"
 
+#include <future>
+
 #include "GlobalAppSettings.h"
 #include "Profile.h"
 
@@ -56,6 +58,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         void GenerateProfiles();
         void ApplyRuntimeInitialSettings();
         void MergeInboxIntoUserSettings();
+        void StartFindingFragments();
         void FindFragmentsAndMergeIntoUserSettings();
         void MergeFragmentIntoUserSettings(const winrt::hstring& source, const std::string_view& content);
         void FinalizeLayering();
@@ -68,15 +71,22 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
     private:
         struct JsonSettings
         {
-            Json::Value root;
+            std::shared_ptr<const Json::Value> root;
             const Json::Value& colorSchemes;
             const Json::Value& profileDefaults;
             const Json::Value& profilesList;
         };
 
+        struct Fragment
+        {
+            winrt::hstring source;
+            std::string content;
+        };
+
         static std::pair<size_t, size_t> _lineAndColumnFromPosition(const std::string_view& string, const size_t position);
         static void _rethrowSerializationExceptionWithLocationInfo(const JsonUtils::DeserializationError& e, const std::string_view& settingsString);
         static Json::Value _parseJSON(const std::string_view& content);
+        static std::shared_ptr<const Json::Value> _parseJSONCached(const std::string_view& content);
         static const Json::Value& _getJSONValue(const Json::Value& json, const std::string_view& key) noexcept;
         gsl::span<const winrt::com_ptr<implementation::Profile>> _getNonUserOriginProfiles() const;
         void _parse(const OriginTag origin, const winrt::hstring& source, const std::string_view& content, ParsedSettings& settings);
@@ -85,9 +95,12 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         static winrt::com_ptr<implementation::Profile> _parseProfile(const OriginTag origin, const winrt::hstring& source, const Json::Value& profileJson);
         void _appendProfile(winrt::com_ptr<Profile>&& profile, const winrt::guid& guid, ParsedSettings& settings);
         static void _addParentProfile(const winrt::com_ptr<implementation::Profile>& profile, ParsedSettings& settings);
-        void _executeGenerator(const IDynamicProfileGenerator& generator);
+        static std::vector<winrt::com_ptr<implementation::Profile>> _executeGenerator(const IDynamicProfileGenerator& generator, const std::unordered_set<std::wstring_view>& ignoredNamespaces);
+        static std::vector<Fragment> _findFragments(const std::unordered_set<std::wstring_view>& ignoredNamespaces);
 
         std::unordered_set<std::wstring_view> _ignoredNamespaces;
+        // See StartFindingFragments().
+        std::future<std::vector<Fragment>> _fragments;
         // See _getNonUserOriginProfiles().
         size_t _userProfileCount = 0;
     };
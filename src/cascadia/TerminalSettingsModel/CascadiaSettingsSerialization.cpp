@@ -26,9 +26,11 @@
 #include "ApplicationState.h"
 #include "DefaultTerminal.h"
 #include "FileUtils.h"
+#include "../../types/inc/StartupTracing.hpp"
 
 using namespace winrt::Microsoft::Terminal::Settings;
 using namespace winrt::Microsoft::Terminal::Settings::Model::implementation;
+namespace StartupTracing = ::Microsoft::Console::StartupTracing;
 
 static constexpr std::wstring_view SettingsFilename{ L"settings.json" };
 static constexpr std::wstring_view DefaultsFilename{ L"defaults.json" };
@@ -44,6 +46,14 @@ static constexpr std::wstring_view FragmentsPath{ L"\\Microsoft\\Windows Termina
 
 static constexpr std::wstring_view AppExtensionHostName{ L"com.microsoft.windows.terminal.settings" };
 
+// The number of parsed JSON documents kept around by SettingsLoader::_parseJSONCached.
+// That's enough for defaults.json, settings.json and a few fragments.
+static constexpr size_t ParsedJSONCacheSize{ 8 };
+
+// How long SettingsLoader::GenerateProfiles waits for a generator that already produced
+// profiles during an earlier load. After that it uses those profiles instead.
+static constexpr auto GeneratorTimeout{ std::chrono::seconds(2) };
+
 // make sure this matches defaults.json.
 static constexpr winrt::guid DEFAULT_WINDOWS_POWERSHELL_GUID{ 0x61c54bbd, 0xc2c6, 0x5271, { 0x96, 0xe7, 0x00, 0x9a, 0x87, 0xff, 0x44, 0xbf } };
 static constexpr winrt::guid DEFAULT_COMMAND_PROMPT_GUID{ 0x0caa0dad, 0x35be, 0x5f56, { 0xa8, 0xff, 0xaf, 0xce, 0xee, 0xaa, 0x61, 0x01 } };
@@ -132,12 +142,92 @@ SettingsLoader::SettingsLoader(const std::string_view& userJSON, const std::stri
 
 // Generate dynamic profiles and add them to the list of "inbox" profiles
 // (meaning profiles specified by the application rather by the user).
+//
+// The generators are independent of each other and spend most of their time waiting
+// for the registry, the file system or COM servers, which is why they run concurrently.
+// Their profiles are appended in a fixed order however, so that it doesn't depend on timing.
+//
+// A generator that gets stuck (for instance on the Visual Studio setup configuration)
+// shouldn't hold up every settings reload. Once a generator produced profiles, later loads
+// only wait GeneratorTimeout for it and otherwise use its last profiles. It keeps running
+// in the background, and the next load will pick up its results.
 void SettingsLoader::GenerateProfiles()
 {
-    _executeGenerator(PowershellCoreProfileGenerator{});
-    _executeGenerator(WslDistroGenerator{});
-    _executeGenerator(AzureCloudShellGenerator{});
-    _executeGenerator(VisualStudioGenerator{});
+    using GeneratedProfiles = std::vector<winrt::com_ptr<Profile>>;
+
+    // These outlive the loader, because a generator might still be running after we returned.
+    static const PowershellCoreProfileGenerator powershellCoreGenerator;
+    static const WslDistroGenerator wslGenerator;
+    static const AzureCloudShellGenerator azureGenerator;
+    static const VisualStudioGenerator visualStudioGenerator;
+    static const std::array<const IDynamicProfileGenerator*, 4> generators{ &powershellCoreGenerator, &wslGenerator, &azureGenerator, &visualStudioGenerator };
+    static constexpr auto generatorCount = std::tuple_size_v<decltype(generators)>;
+
+    struct GeneratorState
+    {
+        // The currently running generator, if any.
+        std::shared_future<GeneratedProfiles> pending;
+        // The profiles of the last run that finished.
+        std::optional<GeneratedProfiles> last;
+    };
+    static std::mutex mutex;
+    static std::array<GeneratorState, generatorCount> states;
+
+    const auto run = [](const size_t index, std::promise<GeneratedProfiles> promise) -> winrt::fire_and_forget {
+        co_await winrt::resume_background();
+        StartupTracing::Scope startupPhase{ StartupTracing::Phase::ProfileGenerator, generators[index]->GetNamespace() };
+        auto profiles = _executeGenerator(*generators[index], {});
+        startupPhase.Stop();
+        {
+            const std::lock_guard lock{ mutex };
+            states[index].pending = {};
+            states[index].last = profiles;
+        }
+        promise.set_value(std::move(profiles));
+    };
+
+    std::array<std::shared_future<GeneratedProfiles>, generatorCount> results;
+    std::array<std::optional<GeneratedProfiles>, generatorCount> fallbacks;
+    {
+        const std::lock_guard lock{ mutex };
+        for (size_t i = 0; i < generatorCount; ++i)
+        {
+            if (_ignoredNamespaces.count(generators[i]->GetNamespace()))
+            {
+                continue;
+            }
+
+            auto& state = states[i];
+            // A generator that timed out during an earlier load might still be
+            // running. There's no point in starting it a second time.
+            if (!state.pending.valid())
+            {
+                std::promise<GeneratedProfiles> promise;
+                state.pending = promise.get_future().share();
+                run(i, std::move(promise));
+            }
+            results[i] = state.pending;
+            fallbacks[i] = state.last;
+        }
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + GeneratorTimeout;
+    for (size_t i = 0; i < generatorCount; ++i)
+    {
+        const auto& result = results[i];
+        if (!result.valid())
+        {
+            continue;
+        }
+
+        const auto& profiles = !fallbacks[i] || result.wait_until(deadline) == std::future_status::ready ? result.get() : *fallbacks[i];
+
+        // The profiles are shared with other loads, but loading modifies them, so we need our own copies.
+        for (const auto& profile : profiles)
+        {
+            inboxSettings.profiles.emplace_back(profile->CopySettings());
+        }
+    }
 }
 
 // A new settings.json gets a special treatment:
@@ -187,6 +277,16 @@ void SettingsLoader::MergeInboxIntoUserSettings()
     }
 }
 
+// Finding fragments only depends on the "disabledProfileSources" of the user settings.
+// Call this method right after constructing the loader to read them from disk
+// while the dynamic profiles are generated. See FindFragmentsAndMergeIntoUserSettings.
+void SettingsLoader::StartFindingFragments()
+{
+    _fragments = std::async(std::launch::async, [ignoredNamespaces = _ignoredNamespaces]() {
+        return _findFragments(ignoredNamespaces);
+    });
+}
+
 // Searches AppData/ProgramData and app extension directories for settings JSON files.
 // If such JSON files are found, they're read and their contents added to .userSettings.
 //
@@ -196,17 +296,36 @@ void SettingsLoader::MergeInboxIntoUserSettings()
 // Additionally the GUID in "updates" will conflict with existing GUIDs in .inboxSettings.
 void SettingsLoader::FindFragmentsAndMergeIntoUserSettings()
 {
+    const auto fragments = _fragments.valid() ? _fragments.get() : _findFragments(_ignoredNamespaces);
+
     ParsedSettings fragmentSettings;
+    for (const auto& fragment : fragments)
+    {
+        try
+        {
+            _parseFragment(fragment.source, fragment.content, fragmentSettings);
+        }
+        CATCH_LOG();
+    }
+}
+
+// Reads all fragments from disk in the order they need to be merged in.
+// This function is safe to call from any thread.
+std::vector<SettingsLoader::Fragment> SettingsLoader::_findFragments(const std::unordered_set<std::wstring_view>& ignoredNamespaces)
+{
+    // The app extension catalog is a COM server.
+    const auto coInit = wil::CoInitializeEx(COINIT_MULTITHREADED);
+
+    std::vector<Fragment> fragments;
 
-    const auto parseAndLayerFragmentFiles = [&](const std::filesystem::path& path, const winrt::hstring& source) {
+    const auto readFragmentFiles = [&](const std::filesystem::path& path, const winrt::hstring& source) {
         for (const auto& fragmentExt : std::filesystem::directory_iterator{ path })
         {
             if (fragmentExt.path().extension() == jsonExtension)
             {
                 try
                 {
-                    const auto content = ReadUTF8File(fragmentExt.path());
-                    _parseFragment(source, content, fragmentSettings);
+                    fragments.emplace_back(Fragment{ source, ReadUTF8File(fragmentExt.path()) });
                 }
                 CATCH_LOG();
             }
@@ -227,9 +346,9 @@ void SettingsLoader::FindFragmentsAndMergeIntoUserSettings()
                 const auto filename = fragmentExtFolder.path().filename();
                 const auto& source = filename.native();
 
-                if (!_ignoredNamespaces.count(std::wstring_view{ source }) && fragmentExtFolder.is_directory())
+                if (!ignoredNamespaces.count(std::wstring_view{ source }) && fragmentExtFolder.is_directory())
                 {
-                    parseAndLayerFragmentFiles(fragmentExtFolder.path(), winrt::hstring{ source });
+                    readFragmentFiles(fragmentExtFolder.path(), winrt::hstring{ source });
                 }
             }
         }
@@ -243,7 +362,7 @@ void SettingsLoader::FindFragmentsAndMergeIntoUserSettings()
     for (const auto& ext : extensions)
     {
         const auto packageName = ext.Package().Id().FamilyName();
-        if (_ignoredNamespaces.count(std::wstring_view{ packageName }))
+        if (ignoredNamespaces.count(std::wstring_view{ packageName }))
         {
             continue;
         }
@@ -264,9 +383,11 @@ void SettingsLoader::FindFragmentsAndMergeIntoUserSettings()
 
         if (std::filesystem::is_directory(path))
         {
-            parseAndLayerFragmentFiles(path, packageName);
+            readFragmentFiles(path, packageName);
         }
     }
+
+    return fragments;
 }
 
 // See FindFragmentsAndMergeIntoUserSettings.
@@ -398,6 +519,43 @@ Json::Value SettingsLoader::_parseJSON(const std::string_view& content)
     return json;
 }
 
+// Like _parseJSON, but reuses the result of an earlier call with the same content.
+// Every settings reload parses defaults.json, and most of the time it finds settings.json
+// and the fragments unchanged as well. The returned tree is shared and must not be modified.
+std::shared_ptr<const Json::Value> SettingsLoader::_parseJSONCached(const std::string_view& content)
+{
+    struct CacheEntry
+    {
+        std::string content;
+        std::shared_ptr<const Json::Value> root;
+    };
+
+    static std::mutex mutex;
+    static std::deque<CacheEntry> cache;
+
+    {
+        const std::lock_guard lock{ mutex };
+        const auto it = std::find_if(cache.begin(), cache.end(), [&](const auto& entry) { return entry.content == content; });
+        if (it != cache.end())
+        {
+            auto root = it->root;
+            // Keep the most recently used entries at the front.
+            std::rotate(cache.begin(), it, it + 1);
+            return root;
+        }
+    }
+
+    std::shared_ptr<const Json::Value> root = std::make_shared<Json::Value>(content.empty() ? Json::Value{ Json::ValueType::objectValue } : _parseJSON(content));
+
+    const std::lock_guard lock{ mutex };
+    cache.emplace_front(CacheEntry{ std::string{ content }, root });
+    if (cache.size() > ParsedJSONCacheSize)
+    {
+        cache.pop_back();
+    }
+    return root;
+}
+
 // A helper method similar to Json::Value::operator[], but compatible with std::string_view.
 const Json::Value& SettingsLoader::_getJSONValue(const Json::Value& json, const std::string_view& key) noexcept
 {
@@ -434,7 +592,7 @@ void SettingsLoader::_parse(const OriginTag origin, const winrt::hstring& source
     settings.clear();
 
     {
-        settings.globals = GlobalAppSettings::FromJson(json.root);
+        settings.globals = GlobalAppSettings::FromJson(*json.root);
 
         for (const auto& schemeJson : json.colorSchemes)
         {
@@ -541,9 +699,9 @@ void SettingsLoader::_parseFragment(const winrt::hstring& source, const std::str
 
 SettingsLoader::JsonSettings SettingsLoader::_parseJson(const std::string_view& content)
 {
-    auto root = content.empty() ? Json::Value{ Json::ValueType::objectValue } : _parseJSON(content);
-    const auto& colorSchemes = _getJSONValue(root, SchemesKey);
-    const auto& profilesObject = _getJSONValue(root, ProfilesKey);
+    auto root = _parseJSONCached(content);
+    const auto& colorSchemes = _getJSONValue(*root, SchemesKey);
+    const auto& profilesObject = _getJSONValue(*root, ProfilesKey);
     const auto& profileDefaults = _getJSONValue(profilesObject, DefaultSettingsKey);
     const auto& profilesList = profilesObject.isArray() ? profilesObject : _getJSONValue(profilesObject, ProfilesListKey);
     return JsonSettings{ std::move(root), colorSchemes, profileDefaults, profilesList };
@@ -613,36 +771,40 @@ void SettingsLoader::_addParentProfile(const winrt::com_ptr<implementation::Prof
     }
 }
 
-// As the name implies it executes a generator.
-// Generated profiles are added to .inboxSettings. Used by GenerateProfiles().
-void SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator)
+// As the name implies it executes a generator and returns the profiles it generated.
+// Used by GenerateProfiles(), which calls it from a background thread.
+std::vector<winrt::com_ptr<Profile>> SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator, const std::unordered_set<std::wstring_view>& ignoredNamespaces)
 {
+    std::vector<winrt::com_ptr<Profile>> profiles;
+
     const auto generatorNamespace = generator.GetNamespace();
-    if (_ignoredNamespaces.count(generatorNamespace))
+    if (ignoredNamespaces.count(generatorNamespace))
     {
-        return;
+        return profiles;
     }
 
-    const auto previousSize = inboxSettings.profiles.size();
-
     try
     {
-        generator.GenerateProfiles(inboxSettings.profiles);
+        // Some of the generators talk to COM servers, like the Visual Studio setup configuration.
+        const auto coInit = wil::CoInitializeEx(COINIT_MULTITHREADED);
+        generator.GenerateProfiles(profiles);
     }
     CATCH_LOG_MSG("Dynamic Profile Namespace: \"%.*s\"", gsl::narrow<int>(generatorNamespace.size()), generatorNamespace.data())
 
     // If the generator produced some profiles we're going to give them default attributes.
     // By setting the Origin/Source/etc. here, we deduplicate some code and ensure they aren't missing accidentally.
-    if (inboxSettings.profiles.size() > previousSize)
+    if (!profiles.empty())
     {
         const winrt::hstring source{ generatorNamespace };
 
-        for (const auto& profile : gsl::span(inboxSettings.profiles).subspan(previousSize))
+        for (const auto& profile : profiles)
         {
             profile->Origin(OriginTag::Generated);
             profile->Source(source);
         }
     }
+
+    return profiles;
 }
 
 // Method Description:
@@ -660,6 +822,8 @@ void SettingsLoader::_executeGenerator(const IDynamicProfileGenerator& generator
 Model::CascadiaSettings CascadiaSettings::LoadAll()
 try
 {
+    const StartupTracing::Scope startupPhase{ StartupTracing::Phase::LoadSettings };
+
     const auto settingsString = ReadUTF8FileIfExists(_settingsPath()).value_or(std::string{});
     const auto firstTimeSetup = settingsString.empty();
 
@@ -679,6 +843,10 @@ try
 
     SettingsLoader loader{ settingsStringView, DefaultJson };
 
+    // Reading the fragments from disk doesn't depend on any of the following steps,
+    // so let's do it while the dynamic profiles are being generated.
+    loader.StartFindingFragments();
+
     // Generate dynamic profiles and add them as parents of user profiles.
     // That way the user profiles will get appropriate defaults from the generators (like icons and such).
     loader.GenerateProfiles();
@@ -156,21 +156,21 @@ winrt::Microsoft::Terminal::Core::Scheme ColorScheme::ToCoreScheme() const noexc
     coreScheme.Background = Background();
     coreScheme.CursorColor = CursorColor();
     coreScheme.SelectionBackground = SelectionBackground();
-    coreScheme.Black = Table()[0];
-    coreScheme.Red = Table()[1];
-    coreScheme.Green = Table()[2];
-    coreScheme.Yellow = Table()[3];
-    coreScheme.Blue = Table()[4];
-    coreScheme.Purple = Table()[5];
-    coreScheme.Cyan = Table()[6];
-    coreScheme.White = Table()[7];
-    coreScheme.BrightBlack = Table()[8];
-    coreScheme.BrightRed = Table()[9];
-    coreScheme.BrightGreen = Table()[10];
-    coreScheme.BrightYellow = Table()[11];
-    coreScheme.BrightBlue = Table()[12];
-    coreScheme.BrightPurple = Table()[13];
-    coreScheme.BrightCyan = Table()[14];
-    coreScheme.BrightWhite = Table()[15];
+    coreScheme.Black = til::at(_table, 0);
+    coreScheme.Red = til::at(_table, 1);
+    coreScheme.Green = til::at(_table, 2);
+    coreScheme.Yellow = til::at(_table, 3);
+    coreScheme.Blue = til::at(_table, 4);
+    coreScheme.Purple = til::at(_table, 5);
+    coreScheme.Cyan = til::at(_table, 6);
+    coreScheme.White = til::at(_table, 7);
+    coreScheme.BrightBlack = til::at(_table, 8);
+    coreScheme.BrightRed = til::at(_table, 9);
+    coreScheme.BrightGreen = til::at(_table, 10);
+    coreScheme.BrightYellow = til::at(_table, 11);
+    coreScheme.BrightBlue = til::at(_table, 12);
+    coreScheme.BrightPurple = til::at(_table, 13);
+    coreScheme.BrightCyan = til::at(_table, 14);
+    coreScheme.BrightWhite = til::at(_table, 15);
     return coreScheme;
 }
@@ -49,6 +49,8 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         winrt::Microsoft::Terminal::Core::Scheme ToCoreScheme() const noexcept;
 
         com_array<Core::Color> Table() const noexcept;
+        // Like Table(), but without copying the table into a com_array.
+        const std::array<Core::Color, COLOR_TABLE_SIZE>& TableView() const noexcept { return _table; }
         void SetColorTableEntry(uint8_t index, const Core::Color& value) noexcept;
 
         WINRT_PROPERTY(winrt::hstring, Name);
@@ -24,7 +24,7 @@ namespace til
     template<typename T>
     struct hash_trait<winrt::Windows::Foundation::IReference<T>>
     {
-        constexpr void operator()(hasher& h, const winrt::Windows::Foundation::IReference<T>& v) const noexcept
+        void operator()(hasher& h, const winrt::Windows::Foundation::IReference<T>& v) const noexcept
         {
             if (v)
             {
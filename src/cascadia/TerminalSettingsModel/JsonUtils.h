@@ -60,6 +60,16 @@ namespace Microsoft::Terminal::Settings::Model::JsonUtils
             const std::string_view zeroCopyString{ begin, gsl::narrow_cast<size_t>(end - begin) };
             return zeroCopyString;
         }
+
+        // Function Description:
+        // - Returns a string_view to the name of the member an object iterator
+        //   points to, without copying it into a std::string like name() does.
+        inline const std::string_view GetMemberNameView(const Json::ValueConstIterator& it)
+        {
+            const char* end{ nullptr };
+            const char* begin{ it.memberName(&end) };
+            return { begin, gsl::narrow_cast<size_t>(end - begin) };
+        }
     }
 
     template<typename T>
@@ -456,7 +466,9 @@ namespace Microsoft::Terminal::Settings::Model::JsonUtils
             {
                 return winrt::hstring{};
             }
-            return winrt::hstring{ til::u8u16(Detail::GetStringView(json)) };
+            // to_hstring converts straight into the hstring's buffer,
+            // instead of going through an intermediate std::wstring.
+            return winrt::to_hstring(Detail::GetStringView(json));
         }
 
         Json::Value ToJson(const winrt::hstring& val)
@@ -522,7 +534,7 @@ namespace Microsoft::Terminal::Settings::Model::JsonUtils
             ConversionTrait<T> trait;
             for (auto it = json.begin(), end = json.end(); it != end; ++it)
             {
-                GetValue(*it, val[winrt::to_hstring(it.name())], trait);
+                GetValue(*it, val[winrt::to_hstring(Detail::GetMemberNameView(it))], trait);
             }
 
             return winrt::single_threaded_map<winrt::hstring, T>(std::move(val));
@@ -549,9 +561,12 @@ namespace Microsoft::Terminal::Settings::Model::JsonUtils
         {
             Json::Value json{ Json::objectValue };
 
-            for (const auto& [k, v] : val)
+            if (val)
             {
-                SetValueForKey(json, til::u16u8(k), v);
+                for (const auto& [k, v] : val)
+                {
+                    SetValueForKey(json, til::u16u8(k), v);
+                }
             }
 
             return json;
@@ -689,7 +704,16 @@ namespace Microsoft::Terminal::Settings::Model::JsonUtils
     {
         GUID FromJson(const Json::Value& json)
         {
-            return ::Microsoft::Console::Utils::GuidFromString(til::u8u16(Detail::GetStringView(json)).c_str());
+            // Profiles and actions are full of GUIDs. CanConvert ensures that
+            // they're 38 ASCII characters, which we can widen on the stack.
+            const auto string{ Detail::GetStringView(json) };
+            std::array<wchar_t, 39> buffer{};
+            if (string.size() >= buffer.size())
+            {
+                return ::Microsoft::Console::Utils::GuidFromString(til::u8u16(string).c_str());
+            }
+            std::copy(string.begin(), string.end(), buffer.begin());
+            return ::Microsoft::Console::Utils::GuidFromString(buffer.data());
         }
 
         bool CanConvert(const Json::Value& json)
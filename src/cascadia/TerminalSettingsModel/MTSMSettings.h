@@ -26,6 +26,9 @@ Author(s):
     X(bool, FocusFollowMouse, "focusFollowMouse", false)                                                                                                   \
     X(bool, ForceFullRepaintRendering, "experimental.rendering.forceFullRepaint", false)                                                                   \
     X(bool, SoftwareRendering, "experimental.rendering.software", false)                                                                                   \
+    X(bool, SharedDeviceRendering, "experimental.rendering.sharedDevice", false)                                                                           \
+    X(int32_t, PixelShaderFrameRate, "experimental.rendering.pixelShaderFrameRate", 0)                                                                     \
+    X(int32_t, ScrollbackMemoryBudget, "experimental.scrollbackMemoryBudget", 0)                                                                           \
     X(bool, ForceVTInput, "experimental.input.forceVT", false)                                                                                             \
     X(bool, TrimBlockSelection, "trimBlockSelection", false)                                                                                               \
     X(bool, DetectURLs, "experimental.detectURLs", true)                                                                                                   \
@@ -55,8 +58,10 @@ Author(s):
     X(Model::WindowingMode, WindowingBehavior, "windowingBehavior", Model::WindowingMode::UseNew)                                                          \
     X(bool, MinimizeToNotificationArea, "minimizeToNotificationArea", false)                                                                               \
     X(bool, AlwaysShowNotificationIcon, "alwaysShowNotificationIcon", false)                                                                               \
+    X(bool, StandbyWindow, "experimental.standbyWindow", false)                                                                                            \
     X(winrt::Windows::Foundation::Collections::IVector<winrt::hstring>, DisabledProfileSources, "disabledProfileSources", nullptr)                         \
     X(bool, ShowAdminShield, "showAdminShield", true)                                                                                                      \
+    X(hstring, SessionRecordingDirectory, "experimental.sessionRecordingDirectory", L"")                                                                   \
     X(bool, TrimPaste, "trimPaste", true)
 
 #define MTSM_PROFILE_SETTINGS(X)                                                                                                                               \
@@ -75,6 +80,10 @@ Author(s):
     X(hstring, TabTitle, "tabTitle")                                                                                                                           \
     X(Model::BellStyle, BellStyle, "bellStyle", BellStyle::Audible)                                                                                            \
     X(bool, UseAtlasEngine, "experimental.useAtlasEngine", false)                                                                                              \
+    X(hstring, SessionLogDirectory, "experimental.sessionLogDirectory", L"")                                                                                   \
+    X(Microsoft::Terminal::Control::SessionLogFormat, SessionLogFormat, "experimental.sessionLogFormat", Microsoft::Terminal::Control::SessionLogFormat::Raw)  \
+    X(int32_t, SessionLogRotateSize, "experimental.sessionLogRotateSize", 0)                                                                                   \
+    X(int32_t, SessionLogRotateInterval, "experimental.sessionLogRotateInterval", 0)                                                                           \
     X(Windows::Foundation::Collections::IVector<winrt::hstring>, BellSound, "bellSound", nullptr)                                                              \
     X(bool, Elevate, "elevate", false)
 
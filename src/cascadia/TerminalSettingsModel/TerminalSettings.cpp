@@ -3,6 +3,10 @@
 
 #include "pch.h"
 #include "TerminalSettings.h"
+#include "ColorScheme.h"
+#include "Profile.h"
+#include "GlobalAppSettings.h"
+#include "ApplicationState.h"
 #include "../../types/inc/colorTable.hpp"
 
 #include "TerminalSettings.g.cpp"
@@ -70,6 +74,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         const auto globals = appSettings.GlobalSettings();
         settings->_ApplyProfileSettings(profile);
         settings->_ApplyGlobalSettings(globals);
+        settings->_ApplyRendererCalibration(profile, globals);
         settings->_ApplyAppearanceSettings(profile.DefaultAppearance(), globals.ColorSchemes());
 
         Model::TerminalSettings child{ nullptr };
@@ -258,6 +263,11 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 
         _AntialiasingMode = profile.AntialiasingMode();
 
+        _SessionLogDirectory = profile.SessionLogDirectory();
+        _SessionLogFormat = profile.SessionLogFormat();
+        _SessionLogRotateSize = profile.SessionLogRotateSize();
+        _SessionLogRotateInterval = profile.SessionLogRotateInterval();
+
         if (profile.TabColor())
         {
             const til::color colorRef{ profile.TabColor().Value() };
@@ -283,11 +293,52 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         _FocusFollowMouse = globalSettings.FocusFollowMouse();
         _ForceFullRepaintRendering = globalSettings.ForceFullRepaintRendering();
         _SoftwareRendering = globalSettings.SoftwareRendering();
+        _SharedDeviceRendering = globalSettings.SharedDeviceRendering();
+        _PixelShaderFrameRate = globalSettings.PixelShaderFrameRate();
+        _ScrollbackMemoryBudget = globalSettings.ScrollbackMemoryBudget();
         _ForceVTInput = globalSettings.ForceVTInput();
         _TrimBlockSelection = globalSettings.TrimBlockSelection();
         _DetectURLs = globalSettings.DetectURLs();
     }
 
+    // Method Description:
+    // - Unless the user picked a renderer themselves, this uses the one that the
+    //   RendererCalibration found to be the fastest on the current graphics
+    //   adapter. Until it ran on that adapter, the default renderer is kept.
+    // - A choice of either the engine or software rendering counts for both,
+    //   since the calibration only measured them together.
+    // Arguments:
+    // - profile: the profile that may have picked the engine
+    // - globalSettings: the globals that may have picked software rendering
+    // Return Value:
+    // - <none>
+    void TerminalSettings::_ApplyRendererCalibration(const Model::Profile& profile, const Model::GlobalAppSettings& globalSettings)
+    {
+        const auto profileImpl = winrt::get_self<implementation::Profile>(profile);
+        const auto globalsImpl = winrt::get_self<implementation::GlobalAppSettings>(globalSettings);
+        if (profileImpl->HasUseAtlasEngine() || profileImpl->UseAtlasEngineOverrideSource() ||
+            globalsImpl->HasSoftwareRendering() || globalsImpl->SoftwareRenderingOverrideSource())
+        {
+            return;
+        }
+
+        const auto calibrations = ApplicationState::SharedInstance().RendererCalibrations();
+        if (!calibrations || calibrations.Size() == 0)
+        {
+            return;
+        }
+
+        const auto adapterKey = RendererCalibration::AdapterKey();
+        if (adapterKey.empty() || !calibrations.HasKey(adapterKey))
+        {
+            return;
+        }
+
+        const auto configuration = calibrations.Lookup(adapterKey);
+        _UseAtlasEngine = configuration == RendererConfiguration::AtlasEngine || configuration == RendererConfiguration::AtlasEngineSoftware;
+        _SoftwareRendering = configuration == RendererConfiguration::DxEngineSoftware || configuration == RendererConfiguration::AtlasEngineSoftware;
+    }
+
     // Method Description:
     // - Apply a given ColorScheme's values to the TerminalSettings object.
     //      Sets the foreground, background, and color table of the settings object.
@@ -316,18 +367,21 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
             _SelectionBackground = til::color{ scheme.SelectionBackground() };
             _CursorColor = til::color{ scheme.CursorColor() };
 
-            const auto table = scheme.Table();
-            std::array<winrt::Microsoft::Terminal::Core::Color, COLOR_TABLE_SIZE> colorTable{};
-            std::transform(table.cbegin(), table.cend(), colorTable.begin(), [](auto&& color) {
-                return static_cast<winrt::Microsoft::Terminal::Core::Color>(til::color{ color });
-            });
-            ColorTable(colorTable);
+            // This is called for every profile and every appearance, so we
+            // copy the table directly, instead of through a com_array.
+            ColorTable(winrt::get_self<implementation::ColorScheme>(scheme)->TableView());
         }
     }
 
     winrt::Microsoft::Terminal::Core::Color TerminalSettings::GetColorTableEntry(int32_t index) noexcept
     {
-        return ColorTable().at(index);
+        // The control asks for each of the entries, so avoid copying
+        // the entire table for every single one of them.
+        if (const auto span = _getColorTableImpl(); span.size() > 0)
+        {
+            return span[index];
+        }
+        return static_cast<winrt::Microsoft::Terminal::Core::Color>(CampbellColorTable()[index]);
     }
 
     void TerminalSettings::ColorTable(std::array<winrt::Microsoft::Terminal::Core::Color, 16> colors)
@@ -145,9 +145,17 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
 
         INHERITABLE_SETTING(Model::TerminalSettings, Microsoft::Terminal::Control::TextAntialiasingMode, AntialiasingMode, Microsoft::Terminal::Control::TextAntialiasingMode::Grayscale);
 
+        INHERITABLE_SETTING(Model::TerminalSettings, hstring, SessionLogDirectory);
+        INHERITABLE_SETTING(Model::TerminalSettings, Microsoft::Terminal::Control::SessionLogFormat, SessionLogFormat, Microsoft::Terminal::Control::SessionLogFormat::Raw);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, SessionLogRotateSize, 0);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, SessionLogRotateInterval, 0);
+
         INHERITABLE_SETTING(Model::TerminalSettings, bool, RetroTerminalEffect, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, ForceFullRepaintRendering, false);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, SoftwareRendering, false);
+        INHERITABLE_SETTING(Model::TerminalSettings, bool, SharedDeviceRendering, false);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, PixelShaderFrameRate, 0);
+        INHERITABLE_SETTING(Model::TerminalSettings, int32_t, ScrollbackMemoryBudget, 0);
         INHERITABLE_SETTING(Model::TerminalSettings, bool, ForceVTInput, false);
 
         INHERITABLE_SETTING(Model::TerminalSettings, hstring, PixelShaderPath);
@@ -160,6 +168,7 @@ namespace winrt::Microsoft::Terminal::Settings::Model::implementation
         void _ApplyProfileSettings(const Model::Profile& profile);
 
         void _ApplyGlobalSettings(const Model::GlobalAppSettings& globalSettings) noexcept;
+        void _ApplyRendererCalibration(const Model::Profile& profile, const Model::GlobalAppSettings& globalSettings);
         void _ApplyAppearanceSettings(const Microsoft::Terminal::Settings::Model::IAppearanceConfig& appearance,
                                       const Windows::Foundation::Collections::IMapView<hstring, Microsoft::Terminal::Settings::Model::ColorScheme>& schemes);
 
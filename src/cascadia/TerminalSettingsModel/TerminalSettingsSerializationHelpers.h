@@ -104,6 +104,14 @@ JSON_ENUM_MAPPER(::winrt::Microsoft::Terminal::Control::TextAntialiasingMode)
     };
 };
 
+JSON_ENUM_MAPPER(::winrt::Microsoft::Terminal::Control::SessionLogFormat)
+{
+    static constexpr std::array<pair_type, 2> mappings = {
+        pair_type{ "raw", ValueType::Raw },
+        pair_type{ "plainText", ValueType::PlainText }
+    };
+};
+
 // Type Description:
 // - Helper for converting a user-specified closeOnExit value to its corresponding enum
 JSON_ENUM_MAPPER(::winrt::Microsoft::Terminal::Settings::Model::CloseOnExitMode)
@@ -546,3 +554,13 @@ JSON_ENUM_MAPPER(::winrt::Microsoft::Terminal::Settings::Model::InfoBarMessage)
         pair_type{ "setAsDefault", ValueType::SetAsDefault },
     };
 };
+
+JSON_ENUM_MAPPER(::winrt::Microsoft::Terminal::Control::RendererConfiguration)
+{
+    JSON_MAPPINGS(4) = {
+        pair_type{ "dxEngine", ValueType::DxEngine },
+        pair_type{ "dxEngineSoftware", ValueType::DxEngineSoftware },
+        pair_type{ "atlasEngine", ValueType::AtlasEngine },
+        pair_type{ "atlasEngineSoftware", ValueType::AtlasEngineSoftware },
+    };
+};
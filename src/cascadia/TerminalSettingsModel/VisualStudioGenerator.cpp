@@ -3,18 +3,154 @@
 
 #include "pch.h"
 #include "DynamicProfileUtils.h"
+#include "FileUtils.h"
 #include "VisualStudioGenerator.h"
 #include "VsDevCmdGenerator.h"
 #include "VsDevShellGenerator.h"
 
+#include <shlobj.h>
+
 using namespace winrt::Microsoft::Terminal::Settings::Model;
 
+static constexpr std::wstring_view CacheFileName{ L"visualStudioProfiles.json" };
+static constexpr std::wstring_view InstancesPath{ L"\\Microsoft\\VisualStudio\\Packages\\_Instances" };
+static constexpr std::wstring_view InstanceStateFileName{ L"state.json" };
+// Bump this whenever the generated profiles change, so that older caches are ignored.
+static constexpr int CacheVersion{ 1 };
+
+static constexpr std::string_view CacheKeyKey{ "key" };
+static constexpr std::string_view CacheProfilesKey{ "profiles" };
+
+// Function Description:
+// - Querying the Visual Studio setup configuration is slow, but its answer only changes
+//   when an instance is installed, modified or removed. The installer rewrites the
+//   state.json of an instance whenever that happens, which makes their timestamps
+//   a key for the profiles generated from them, that's cheap to compute.
+// Return Value:
+// - The key, or an empty string if there aren't any instances or they can't be enumerated.
+static std::string getInstancesKey()
+{
+    wil::unique_cotaskmem_string programData;
+    THROW_IF_FAILED(SHGetKnownFolderPath(FOLDERID_ProgramData, 0, nullptr, &programData));
+
+    std::wstring path{ programData.get() };
+    path.append(InstancesPath);
+
+    std::error_code ec;
+    std::vector<std::string> instances;
+    for (const auto& instance : std::filesystem::directory_iterator{ path, ec })
+    {
+        const auto writeTime = std::filesystem::last_write_time(instance.path() / InstanceStateFileName, ec);
+        if (ec)
+        {
+            return {};
+        }
+        instances.emplace_back(fmt::format("{}={};", til::u16u8(instance.path().filename().native()), writeTime.time_since_epoch().count()));
+    }
+
+    if (ec || instances.empty())
+    {
+        return {};
+    }
+
+    // The order of the directory entries isn't guaranteed.
+    std::sort(instances.begin(), instances.end());
+
+    auto key = fmt::format("{};", CacheVersion);
+    for (const auto& instance : instances)
+    {
+        key.append(instance);
+    }
+    return key;
+}
+
+static std::filesystem::path getCachePath()
+{
+    return GetBaseSettingsPath() / CacheFileName;
+}
+
+// Function Description:
+// - Appends the profiles of the last run to `profiles`, if they were generated for the same instances.
+// Return Value:
+// - true if the cached profiles were used.
+static bool loadCachedProfiles(const std::string_view key, std::vector<winrt::com_ptr<implementation::Profile>>& profiles)
+try
+{
+    const auto content = ReadUTF8FileIfExists(getCachePath());
+    if (!content)
+    {
+        return false;
+    }
+
+    Json::Value json;
+    std::string errs;
+    const std::unique_ptr<Json::CharReader> reader{ Json::CharReaderBuilder::CharReaderBuilder().newCharReader() };
+    if (!reader->parse(content->data(), content->data() + content->size(), &json, &errs) || json[JsonKey(CacheKeyKey)].asString() != key)
+    {
+        return false;
+    }
+
+    std::vector<winrt::com_ptr<implementation::Profile>> cached;
+    for (const auto& profileJson : json[JsonKey(CacheProfilesKey)])
+    {
+        cached.emplace_back(implementation::Profile::FromJson(profileJson));
+    }
+
+    profiles.insert(profiles.end(), std::make_move_iterator(cached.begin()), std::make_move_iterator(cached.end()));
+    return true;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return false;
+}
+
+static void storeCachedProfiles(const std::string_view key, const gsl::span<const winrt::com_ptr<implementation::Profile>> profiles)
+try
+{
+    Json::Value json{ Json::objectValue };
+    json[JsonKey(CacheKeyKey)] = std::string{ key };
+
+    auto& profilesJson = json[JsonKey(CacheProfilesKey)] = Json::Value{ Json::arrayValue };
+    for (const auto& profile : profiles)
+    {
+        profilesJson.append(profile->ToJson());
+    }
+
+    Json::StreamWriterBuilder wbuilder;
+    WriteUTF8FileAtomic(getCachePath(), Json::writeString(wbuilder, json));
+}
+CATCH_LOG()
+
 std::wstring_view VisualStudioGenerator::GetNamespace() const noexcept
 {
     return std::wstring_view{ L"Windows.Terminal.VisualStudio" };
 }
 
 void VisualStudioGenerator::GenerateProfiles(std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const
+{
+    std::string key;
+    try
+    {
+        key = getInstancesKey();
+    }
+    CATCH_LOG();
+
+    if (!key.empty() && loadCachedProfiles(key, profiles))
+    {
+        return;
+    }
+
+    const auto previousSize = profiles.size();
+    _generateProfiles(profiles);
+
+    if (!key.empty())
+    {
+        storeCachedProfiles(key, gsl::span(profiles).subspan(previousSize));
+    }
+}
+
+void VisualStudioGenerator::_generateProfiles(std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const
 {
     const auto instances = VsSetupConfiguration::QueryInstances();
 
@@ -34,5 +34,8 @@ namespace winrt::Microsoft::Terminal::Settings::Model
         public:
             virtual void GenerateProfiles(const VsSetupConfiguration::VsSetupInstance& instance, bool hidden, std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const = 0;
         };
+
+    private:
+        void _generateProfiles(std::vector<winrt::com_ptr<implementation::Profile>>& profiles) const;
     };
 };
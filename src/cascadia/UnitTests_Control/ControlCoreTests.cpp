@@ -4,6 +4,8 @@
 #include "pch.h"
 #include "../TerminalControl/EventArgs.h"
 #include "../TerminalControl/ControlCore.h"
+#include "../TerminalControl/HeadlessCore.h"
+#include "../TerminalControl/ScrollbackBudget.h"
 #include "MockControlSettings.h"
 #include "MockConnection.h"
 #include "../UnitTests_TerminalCore/TestUtils.h"
@@ -32,11 +34,16 @@ namespace ControlUnitTests
         TEST_METHOD(TestFreeAfterClose);
 
         TEST_METHOD(TestFontInitializedInCtor);
+        TEST_METHOD(TestUpdateSettingsKeepsAdjustedFont);
 
         TEST_METHOD(TestClearScrollback);
         TEST_METHOD(TestClearScreen);
         TEST_METHOD(TestClearAll);
 
+        TEST_METHOD(TestHeadlessCore);
+
+        TEST_METHOD(TestScrollbackBudget);
+
         TEST_CLASS_SETUP(ModuleSetup)
         {
             winrt::init_apartment(winrt::apartment_type::single_threaded);
@@ -223,6 +230,30 @@ namespace ControlUnitTests
         VERIFY_ARE_EQUAL(L"Impact", std::wstring_view{ core->_actualFont.GetFaceName() });
     }
 
+    void ControlCoreTests::TestUpdateSettingsKeepsAdjustedFont()
+    {
+        auto [settings, conn] = _createSettingsAndConnection();
+
+        auto core = createCore(*settings, *conn);
+        VERIFY_IS_NOT_NULL(core);
+        _standardInit(core);
+
+        const auto initialSize = core->_desiredFont.GetEngineSize().Y;
+        core->AdjustFontSize(2);
+        VERIFY_ARE_EQUAL(initialSize + 2, core->_desiredFont.GetEngineSize().Y);
+
+        Log::Comment(L"Reloading settings that don't touch the font keeps the zoomed font");
+        settings->HistorySize(settings->HistorySize() + 1);
+        core->UpdateSettings(*settings, *settings);
+        VERIFY_ARE_EQUAL(initialSize + 2, core->_desiredFont.GetEngineSize().Y);
+
+        Log::Comment(L"Changing the font resets it to the new settings");
+        settings->FontFace(L"Impact");
+        core->UpdateSettings(*settings, *settings);
+        VERIFY_ARE_EQUAL(L"Impact", std::wstring_view{ core->_actualFont.GetFaceName() });
+        VERIFY_ARE_EQUAL(initialSize, core->_desiredFont.GetEngineSize().Y);
+    }
+
     void ControlCoreTests::TestClearScrollback()
     {
         auto [settings, conn] = _createSettingsAndConnection();
@@ -341,4 +372,76 @@ namespace ControlUnitTests
         // The ConptyRoundtripTests test the actual clearing of the contents.
     }
 
+    void ControlCoreTests::TestHeadlessCore()
+    {
+        auto [settings, conn] = _createSettingsAndConnection();
+
+        Log::Comment(L"Create HeadlessCore object");
+        auto core = winrt::make_self<Control::implementation::HeadlessCore>(*settings, *conn);
+        VERIFY_IS_NOT_NULL(core);
+        core->Start();
+
+        VERIFY_ARE_EQUAL(0u, core->OutputGeneration());
+        VERIFY_ARE_EQUAL(L"", core->ReadEntireBuffer());
+
+        // The MockConnection echoes the input back as output.
+        Log::Comment(L"Write some output");
+        core->SendInput(L"Foo\r\n");
+        core->SendInput(L"Bar");
+        VERIFY_ARE_EQUAL(2u, core->OutputGeneration());
+        VERIFY_ARE_EQUAL(L"Foo\r\nBar\r\n", core->ReadEntireBuffer());
+
+        Log::Comment(L"Scroll the first row out of the 30 row viewport");
+        std::wstring expectedViewport{ L"Bar\r\n" };
+        for (auto i = 0; i < 29; ++i)
+        {
+            core->SendInput(L"\r\n");
+            expectedViewport.append(L"\r\n");
+        }
+        VERIFY_ARE_EQUAL(L"Foo\r\nBar\r\n", core->ReadEntireBuffer());
+        VERIFY_ARE_EQUAL(expectedViewport, std::wstring{ core->ReadViewport() });
+
+        core->Close();
+    }
+
+    void ControlCoreTests::TestScrollbackBudget()
+    {
+        // A budget of its own, so that no other test can interfere with it.
+        ::Microsoft::Terminal::Control::ScrollbackBudget budget;
+
+        std::vector<bool> focusedPressure;
+        std::vector<bool> backgroundPressure;
+        const auto focusedId = budget.Register([&](const bool underPressure) { focusedPressure.push_back(underPressure); });
+        const auto backgroundId = budget.Register([&](const bool underPressure) { backgroundPressure.push_back(underPressure); });
+
+        Log::Comment(L"Stay within the budget");
+        budget.Update(focusedId, 60, true, 100);
+        budget.Update(backgroundId, 30, false, 100);
+        VERIFY_ARE_EQUAL(0u, backgroundPressure.size());
+
+        Log::Comment(L"Exceed the budget. Only the control without focus is put under pressure, and only once");
+        budget.Update(backgroundId, 50, false, 100);
+        budget.Update(focusedId, 80, true, 100);
+        VERIFY_ARE_EQUAL(0u, focusedPressure.size());
+        VERIFY_ARE_EQUAL(std::vector<bool>{ true }, backgroundPressure);
+
+        Log::Comment(L"Dropping below the budget isn't enough to release the pressure");
+        budget.Update(backgroundId, 10, false, 100);
+        VERIFY_ARE_EQUAL(1u, backgroundPressure.size());
+
+        Log::Comment(L"Dropping below half of the budget is");
+        budget.Update(focusedId, 30, true, 100);
+        VERIFY_ARE_EQUAL((std::vector<bool>{ true, false }), backgroundPressure);
+
+        Log::Comment(L"Getting focus releases the pressure right away");
+        budget.Update(backgroundId, 90, false, 100);
+        VERIFY_ARE_EQUAL(3u, backgroundPressure.size());
+        budget.Update(backgroundId, 90, true, 100);
+        VERIFY_ARE_EQUAL((std::vector<bool>{ true, false, true, false }), backgroundPressure);
+
+        Log::Comment(L"Unregistered controls don't count anymore");
+        budget.Unregister(backgroundId);
+        budget.Update(focusedId, 30, false, 100);
+        VERIFY_ARE_EQUAL(0u, focusedPressure.size());
+    }
 }
@@ -470,12 +470,12 @@ namespace ControlUnitTests
         Control::MouseButtonState state{};
 
         interactivity->MouseWheel(modifiers, delta, mousePos, state); // 1/5
-        VERIFY_ARE_EQUAL(21, core->ScrollOffset());
+        VERIFY_ARE_EQUAL(20, core->ScrollOffset());
 
-        Log::Comment(L"Scroll up 4 more times. Once we're at 3/5 scrolls, "
-                     L"we'll round the internal scrollbar position to scrolling to the next row.");
+        Log::Comment(L"Scroll up 4 more times. The viewport is already partially "
+                     L"scrolled onto the previous row, and the rest is drawn smoothly.");
         interactivity->MouseWheel(modifiers, delta, mousePos, state); // 2/5
-        VERIFY_ARE_EQUAL(21, core->ScrollOffset());
+        VERIFY_ARE_EQUAL(20, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, delta, mousePos, state); // 3/5
         VERIFY_ARE_EQUAL(20, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, delta, mousePos, state); // 4/5
@@ -492,27 +492,27 @@ namespace ControlUnitTests
         interactivity->MouseWheel(modifiers, -delta, mousePos, state); // 2/5
         VERIFY_ARE_EQUAL(5, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, -delta, mousePos, state); // 3/5
-        VERIFY_ARE_EQUAL(6, core->ScrollOffset());
+        VERIFY_ARE_EQUAL(5, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, -delta, mousePos, state); // 4/5
-        VERIFY_ARE_EQUAL(6, core->ScrollOffset());
+        VERIFY_ARE_EQUAL(5, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, -delta, mousePos, state); // 5/5
         VERIFY_ARE_EQUAL(6, core->ScrollOffset());
 
         Log::Comment(L"Jump to the bottom.");
         interactivity->UpdateScrollbar(21);
         VERIFY_ARE_EQUAL(21, core->ScrollOffset());
-        Log::Comment(L"Scroll a bit, then emit a line of text. We should reset our internal scroll position.");
-        interactivity->MouseWheel(modifiers, delta, mousePos, state); // 1/5
+        Log::Comment(L"Scroll down a bit, which can't go any further, then emit a line of text. We should reset our internal scroll position.");
+        interactivity->MouseWheel(modifiers, -delta, mousePos, state); // 1/5
         VERIFY_ARE_EQUAL(21, core->ScrollOffset());
-        interactivity->MouseWheel(modifiers, delta, mousePos, state); // 2/5
+        interactivity->MouseWheel(modifiers, -delta, mousePos, state); // 2/5
         VERIFY_ARE_EQUAL(21, core->ScrollOffset());
 
         conn->WriteInput(L"Foo\r\n");
         VERIFY_ARE_EQUAL(22, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, delta, mousePos, state); // 1/5
-        VERIFY_ARE_EQUAL(22, core->ScrollOffset());
+        VERIFY_ARE_EQUAL(21, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, delta, mousePos, state); // 2/5
-        VERIFY_ARE_EQUAL(22, core->ScrollOffset());
+        VERIFY_ARE_EQUAL(21, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, delta, mousePos, state); // 3/5
         VERIFY_ARE_EQUAL(21, core->ScrollOffset());
         interactivity->MouseWheel(modifiers, delta, mousePos, state); // 4/5
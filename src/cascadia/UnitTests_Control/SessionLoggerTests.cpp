@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "../TerminalControl/SessionLogger.h"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace WEX::Common;
+
+using namespace Microsoft::Terminal::Control;
+using SessionLogFormat = winrt::Microsoft::Terminal::Control::SessionLogFormat;
+
+namespace ControlUnitTests
+{
+    class SessionLoggerTests
+    {
+        BEGIN_TEST_CLASS(SessionLoggerTests)
+            TEST_CLASS_PROPERTY(L"TestTimeout", L"0:0:10") // 10s timeout
+        END_TEST_CLASS()
+
+        TEST_METHOD(TestStripsCsi);
+        TEST_METHOD(TestStripsOscTerminatedByBel);
+        TEST_METHOD(TestStripsOscTerminatedByST);
+        TEST_METHOD(TestStripsSequenceSplitAcrossWrites);
+        TEST_METHOD(TestPlainTextLog);
+
+        TEST_METHOD_SETUP(MethodSetup)
+        {
+            wchar_t directory[MAX_PATH + 1];
+            THROW_LAST_ERROR_IF(GetTempPathW(ARRAYSIZE(directory), directory) == 0);
+            _directory = fmt::format(L"{}SessionLoggerTests-{}", directory, GetCurrentProcessId());
+            std::filesystem::remove_all(_directory);
+            return true;
+        }
+
+        TEST_METHOD_CLEANUP(MethodCleanup)
+        {
+            std::error_code ec;
+            std::filesystem::remove_all(_directory, ec);
+            return true;
+        }
+
+        std::unique_ptr<SessionLogger> _newLogger(const SessionLogFormat format) const
+        {
+            return std::make_unique<SessionLogger>(SessionLogger::Options{ _directory, format });
+        }
+
+        // The logger thread only ever touches the state machine for queued
+        // output. Nothing is appended here, so calling it directly is safe.
+        static std::wstring _strip(SessionLogger& logger, const std::wstring_view text)
+        {
+            logger._text.clear();
+            logger._stripControlSequences(text);
+            return logger._text;
+        }
+
+        std::wstring _directory;
+    };
+
+    void SessionLoggerTests::TestStripsCsi()
+    {
+        const auto logger = _newLogger(SessionLogFormat::PlainText);
+
+        VERIFY_ARE_EQUAL(L"red plain", _strip(*logger, L"\x1b[31mred\x1b[m plain"));
+        Log::Comment(L"Parameters, intermediates and private markers are all part of the sequence.");
+        VERIFY_ARE_EQUAL(L"ab", _strip(*logger, L"a\x1b[?25h\x1b[38;2;1;2;3m\x1b[2 qb"));
+        Log::Comment(L"Tabs and line breaks are kept, other C0 and C1 controls aren't.");
+        VERIFY_ARE_EQUAL(L"a\tb\r\nc", _strip(*logger, L"a\tb\a\r\n\x08\x9b" L"c"));
+    }
+
+    void SessionLoggerTests::TestStripsOscTerminatedByBel()
+    {
+        const auto logger = _newLogger(SessionLogFormat::PlainText);
+
+        VERIFY_ARE_EQUAL(L"before after", _strip(*logger, L"before \x1b]0;a [title]\aafter"));
+        Log::Comment(L"A hyperlink keeps its text, but not its target.");
+        VERIFY_ARE_EQUAL(L"link", _strip(*logger, L"\x1b]8;;https://example.com\alink\x1b]8;;\a"));
+    }
+
+    void SessionLoggerTests::TestStripsOscTerminatedByST()
+    {
+        const auto logger = _newLogger(SessionLogFormat::PlainText);
+
+        VERIFY_ARE_EQUAL(L"before after", _strip(*logger, L"before \x1b]0;title\x1b\\after"));
+        Log::Comment(L"DCS strings end with ST, too.");
+        VERIFY_ARE_EQUAL(L"ab", _strip(*logger, L"a\x1bP1$r0m\x1b\\b"));
+        Log::Comment(L"An ESC that isn't followed by a backslash aborts the string and starts a new sequence.");
+        VERIFY_ARE_EQUAL(L"ab", _strip(*logger, L"a\x1b]0;title\x1b[31mb"));
+    }
+
+    void SessionLoggerTests::TestStripsSequenceSplitAcrossWrites()
+    {
+        const auto logger = _newLogger(SessionLogFormat::PlainText);
+
+        Log::Comment(L"A CSI that's split right after the ESC.");
+        VERIFY_ARE_EQUAL(L"a", _strip(*logger, L"a\x1b"));
+        VERIFY_ARE_EQUAL(L"b", _strip(*logger, L"[1;31mb"));
+
+        Log::Comment(L"A CSI that's split within its parameters.");
+        VERIFY_ARE_EQUAL(L"c", _strip(*logger, L"c\x1b[38;5"));
+        VERIFY_ARE_EQUAL(L"d", _strip(*logger, L";238md"));
+
+        Log::Comment(L"An OSC whose ST is split between the ESC and the backslash.");
+        VERIFY_ARE_EQUAL(L"e", _strip(*logger, L"e\x1b]0;title\x1b"));
+        VERIFY_ARE_EQUAL(L"f", _strip(*logger, L"\\f"));
+    }
+
+    void SessionLoggerTests::TestPlainTextLog()
+    {
+        {
+            const auto logger = _newLogger(SessionLogFormat::PlainText);
+            logger->Append(L"\x1b]0;title\a\x1b[1mcaf\xE9\x1b[m\r\n");
+            logger->Append(L"\x1b[");
+            logger->Append(L"32m\xD83D\xDE00\x1b[m");
+            // The rest of the output is flushed when the logger is destroyed.
+        }
+
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::directory_iterator{ _directory })
+        {
+            files.emplace_back(entry.path());
+        }
+        VERIFY_ARE_EQUAL(1u, files.size());
+
+        std::ifstream file{ files[0], std::ios::binary };
+        const std::string content{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+        VERIFY_ARE_EQUAL("caf\xC3\xA9\r\n\xF0\x9F\x98\x80", content);
+    }
+}
@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "../TerminalConnection/SessionRecording.h"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace WEX::Common;
+using namespace std::string_view_literals;
+
+using namespace Microsoft::Terminal::TerminalConnection::SessionRecording;
+
+namespace ControlUnitTests
+{
+    class SessionRecordingTests
+    {
+        BEGIN_TEST_CLASS(SessionRecordingTests)
+            TEST_CLASS_PROPERTY(L"TestTimeout", L"0:0:10") // 10s timeout
+        END_TEST_CLASS()
+
+        TEST_METHOD(TestRoundTrip);
+        TEST_METHOD(TestTruncatedRecording);
+        TEST_METHOD(TestCorruptedHeader);
+        TEST_METHOD(TestUnknownAndMalformedRecordsAreSkipped);
+
+        TEST_METHOD_CLEANUP(MethodCleanup)
+        {
+            for (const auto& path : _paths)
+            {
+                DeleteFileW(path.c_str());
+            }
+            _paths.clear();
+            return true;
+        }
+
+        std::wstring _newPath()
+        {
+            wchar_t directory[MAX_PATH + 1];
+            THROW_LAST_ERROR_IF(GetTempPathW(ARRAYSIZE(directory), directory) == 0);
+            auto path = fmt::format(L"{}SessionRecordingTests-{}-{}.wtrc", directory, GetCurrentProcessId(), _paths.size());
+            // A leftover of an earlier run would make the Writer fail.
+            DeleteFileW(path.c_str());
+            _paths.emplace_back(path);
+            return path;
+        }
+
+        static std::string _readFile(const std::wstring& path)
+        {
+            wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            THROW_LAST_ERROR_IF(!file);
+
+            std::string data(GetFileSize(file.get(), nullptr), '\0');
+            DWORD read = 0;
+            THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), data.data(), gsl::narrow<DWORD>(data.size()), &read, nullptr));
+            data.resize(read);
+            return data;
+        }
+
+        static void _writeFile(const std::wstring& path, const std::string_view data)
+        {
+            wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            THROW_LAST_ERROR_IF(!file);
+
+            DWORD written = 0;
+            THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), data.data(), gsl::narrow<DWORD>(data.size()), &written, nullptr));
+        }
+
+        static std::string _header()
+        {
+            std::string header{ Magic };
+            header.append({ static_cast<char>(Version), '\0', '\0', '\0' });
+            return header;
+        }
+
+        std::vector<std::wstring> _paths;
+    };
+
+    void SessionRecordingTests::TestRoundTrip()
+    {
+        const auto path = _newPath();
+        {
+            Writer writer{ path };
+            writer.WriteOutput(L"\x1b[31mcaf\xE9 \xD83D\xDE00\x1b[m\r\n");
+            writer.WriteInput(L"exit\r");
+            writer.WriteResize(30, 120);
+            writer.WriteOutput(L"");
+            // The last output is flushed when the writer is destroyed.
+        }
+
+        Reader reader{ path };
+        Record record;
+
+        VERIFY_IS_TRUE(reader.Next(record));
+        VERIFY_IS_TRUE(RecordKind::Output == record.kind);
+        VERIFY_ARE_EQUAL(L"\x1b[31mcaf\xE9 \xD83D\xDE00\x1b[m\r\n", record.text);
+        auto previousTimestamp = record.timestamp;
+
+        VERIFY_IS_TRUE(reader.Next(record));
+        VERIFY_IS_TRUE(RecordKind::Input == record.kind);
+        VERIFY_ARE_EQUAL(L"exit\r", record.text);
+        VERIFY_IS_TRUE(record.timestamp >= previousTimestamp);
+        previousTimestamp = record.timestamp;
+
+        VERIFY_IS_TRUE(reader.Next(record));
+        VERIFY_IS_TRUE(RecordKind::Resize == record.kind);
+        VERIFY_ARE_EQUAL(30u, record.rows);
+        VERIFY_ARE_EQUAL(120u, record.columns);
+        VERIFY_IS_TRUE(record.timestamp >= previousTimestamp);
+
+        VERIFY_IS_TRUE(reader.Next(record));
+        VERIFY_IS_TRUE(RecordKind::Output == record.kind);
+        VERIFY_ARE_EQUAL(L"", record.text);
+
+        VERIFY_IS_FALSE(reader.Next(record));
+    }
+
+    void SessionRecordingTests::TestTruncatedRecording()
+    {
+        const auto path = _newPath();
+        {
+            Writer writer{ path };
+            writer.WriteOutput(L"first");
+            writer.WriteOutput(L"second");
+        }
+
+        Log::Comment(L"A recording that was cut short in the middle of its last record is read up to the record before.");
+        const auto data = _readFile(path);
+        const auto truncatedPath = _newPath();
+        _writeFile(truncatedPath, std::string_view{ data }.substr(0, data.size() - 3));
+
+        Reader reader{ truncatedPath };
+        Record record;
+        VERIFY_IS_TRUE(reader.Next(record));
+        VERIFY_ARE_EQUAL(L"first", record.text);
+        VERIFY_IS_FALSE(reader.Next(record));
+        VERIFY_IS_FALSE(reader.Next(record));
+
+        Log::Comment(L"The same goes for a record that was cut short within its varints.");
+        const auto header = _header();
+        _writeFile(truncatedPath, header + "\x01\x80");
+        Reader headerOnlyReader{ truncatedPath };
+        VERIFY_IS_FALSE(headerOnlyReader.Next(record));
+    }
+
+    void SessionRecordingTests::TestCorruptedHeader()
+    {
+        const auto path = _newPath();
+        const auto header = _header();
+
+        Log::Comment(L"A file that isn't a recording is rejected.");
+        _writeFile(path, "WTRX\x01\x00\x00\x00"sv);
+        VERIFY_THROWS(Reader{ path }, wil::ResultException);
+
+        Log::Comment(L"So is a recording of a version we don't know.");
+        _writeFile(path, std::string{ Magic }.append("\x02\x00\x00\x00"sv));
+        VERIFY_THROWS(Reader{ path }, wil::ResultException);
+
+        Log::Comment(L"And a file that's shorter than the header.");
+        _writeFile(path, header.substr(0, header.size() - 1));
+        VERIFY_THROWS(Reader{ path }, wil::ResultException);
+
+        Log::Comment(L"A header without any records is an empty recording.");
+        _writeFile(path, header);
+        Reader reader{ path };
+        Record record;
+        VERIFY_IS_FALSE(reader.Next(record));
+    }
+
+    void SessionRecordingTests::TestUnknownAndMalformedRecordsAreSkipped()
+    {
+        const auto path = _newPath();
+
+        auto data = _header();
+        // A record of a kind from a newer version of the format, 2us in.
+        data.append("\x09\x02\x02xx", 5);
+        // A resize whose payload ends in the middle of a varint, 3us later.
+        data.append("\x03\x03\x01\x80", 4);
+        // An output record, 5us later.
+        data.append("\x01\x05\x02hi", 5);
+        _writeFile(path, data);
+
+        Reader reader{ path };
+        Record record;
+        VERIFY_IS_TRUE(reader.Next(record));
+        VERIFY_IS_TRUE(RecordKind::Output == record.kind);
+        VERIFY_ARE_EQUAL(L"hi", record.text);
+        // The skipped records still count towards the timestamp.
+        VERIFY_IS_TRUE(std::chrono::microseconds{ 10 } == record.timestamp);
+        VERIFY_IS_FALSE(reader.Next(record));
+    }
+}
@@ -111,6 +111,8 @@ namespace RemotingUnitTests
         TEST_METHOD(ProposeCommandlineCurrentWindow);
         TEST_METHOD(ProposeCommandlineNonExistentWindow);
         TEST_METHOD(ProposeCommandlineDeadWindow);
+        TEST_METHOD(ProposeCommandlineToStandby);
+        TEST_METHOD(ProposeCommandlineToDeadStandby);
 
         TEST_METHOD(MostRecentWindowSameDesktops);
         TEST_METHOD(MostRecentWindowDifferentDesktops);
@@ -145,6 +147,8 @@ namespace RemotingUnitTests
 
         TEST_METHOD(TestSummonAfterWindowClose);
 
+        TEST_METHOD(TestGetAllWindowLayouts);
+
         TEST_CLASS_SETUP(ClassSetup)
         {
             return true;
@@ -625,6 +629,73 @@ namespace RemotingUnitTests
         }
     }
 
+    void RemotingTests::ProposeCommandlineToStandby()
+    {
+        Log::Comment(L"Test that a commandline for a new window is handed to the standby window process");
+
+        const auto monarch0PID = 12345u;
+        auto m0 = make_private<Remoting::implementation::Monarch>(monarch0PID);
+        m0->FindTargetWindowRequested(&RemotingTests::_findTargetWindowHelper);
+
+        auto consumed = 0;
+        m0->StandbyConsumed([&](auto&&, auto&&) { consumed++; });
+
+        Log::Comment(L"Add a standby");
+        const auto standbyPID = 23456u;
+        auto standby = make_private<Remoting::implementation::Peasant>(standbyPID);
+        auto dispatched = false;
+        standby->ExecuteCommandlineRequested([&](auto&&, const Remoting::CommandlineArgs& cmdlineArgs) {
+            Log::Comment(L"Commandline dispatched to the standby");
+            VERIFY_ARE_EQUAL(L"-1", cmdlineArgs.Commandline().at(0));
+            dispatched = true;
+        });
+        VERIFY_IS_TRUE(m0->AddStandby(*standby));
+        VERIFY_ARE_EQUAL(0u, m0->GetNumberOfPeasants(), L"The standby isn't a window yet");
+
+        Log::Comment(L"There's only ever one standby");
+        auto otherStandby = make_private<Remoting::implementation::Peasant>(34567u);
+        VERIFY_IS_FALSE(m0->AddStandby(*otherStandby));
+
+        std::vector<winrt::hstring> args{ L"-1" };
+        Remoting::CommandlineArgs eventArgs{ { args }, { L"" } };
+
+        auto result = m0->ProposeCommandline(eventArgs);
+        VERIFY_ARE_EQUAL(false, result.ShouldCreateWindow());
+        VERIFY_IS_TRUE(dispatched);
+        VERIFY_ARE_EQUAL(1, consumed);
+        VERIFY_ARE_EQUAL(1u, m0->GetNumberOfPeasants());
+        VERIFY_ARE_EQUAL(1u, standby->GetID());
+        VERIFY_IS_NOT_NULL(standby->InitialArgs());
+
+        Log::Comment(L"The standby was used up, the next new window creates its own");
+        result = m0->ProposeCommandline(eventArgs);
+        VERIFY_ARE_EQUAL(true, result.ShouldCreateWindow());
+        VERIFY_ARE_EQUAL(1, consumed);
+    }
+
+    void RemotingTests::ProposeCommandlineToDeadStandby()
+    {
+        Log::Comment(L"Test that a commandline for a new window isn't lost when the standby died");
+
+        const auto monarch0PID = 12345u;
+        auto m0 = make_private<Remoting::implementation::Monarch>(monarch0PID);
+        m0->FindTargetWindowRequested(&RemotingTests::_findTargetWindowHelper);
+
+        auto consumed = 0;
+        m0->StandbyConsumed([&](auto&&, auto&&) { consumed++; });
+
+        VERIFY_IS_TRUE(m0->AddStandby(winrt::make<DeadPeasant>()));
+
+        std::vector<winrt::hstring> args{ L"-1" };
+        Remoting::CommandlineArgs eventArgs{ { args }, { L"" } };
+
+        auto result = m0->ProposeCommandline(eventArgs);
+        VERIFY_ARE_EQUAL(true, result.ShouldCreateWindow());
+        VERIFY_ARE_EQUAL(false, (bool)result.Id());
+        VERIFY_ARE_EQUAL(1, consumed, L"We should ask for a new standby");
+        VERIFY_ARE_EQUAL(0u, m0->GetNumberOfPeasants());
+    }
+
     // TODO:projects/5
     //
     // In order to test WindowingBehaviorUseExisting, we'll have to
@@ -2522,4 +2593,42 @@ namespace RemotingUnitTests
         VERIFY_IS_TRUE(args.FoundMatch());
     }
 
+    void RemotingTests::TestGetAllWindowLayouts()
+    {
+        Log::Comment(L"Test that the monarch collects the layouts of all the"
+                     L" peasants, and skips the ones that died.");
+
+        constexpr auto monarch0PID = 12345u;
+        constexpr auto peasant1PID = 23456u;
+        constexpr auto peasant2PID = 34567u;
+        constexpr auto peasant3PID = 45678u;
+
+        auto m0 = make_private<Remoting::implementation::Monarch>(monarch0PID);
+        auto p1 = make_private<Remoting::implementation::Peasant>(peasant1PID);
+        auto p2 = make_private<Remoting::implementation::Peasant>(peasant2PID);
+        auto p3 = make_private<Remoting::implementation::Peasant>(peasant3PID);
+
+        m0->AddPeasant(*p1);
+        m0->AddPeasant(*p2);
+        m0->AddPeasant(*p3);
+        VERIFY_ARE_EQUAL(3u, m0->_peasants.size());
+
+        p1->GetWindowLayoutRequested([](auto&&, const Remoting::GetWindowLayoutArgs& args) {
+            args.WindowLayoutJson(L"one");
+        });
+        p2->GetWindowLayoutRequested([](auto&&, const Remoting::GetWindowLayoutArgs& args) {
+            args.WindowLayoutJson(L"two");
+        });
+
+        _killPeasant(m0, p3->GetID());
+
+        const auto layouts = m0->GetAllWindowLayouts();
+        VERIFY_ARE_EQUAL(2u, layouts.Size());
+
+        std::vector<winrt::hstring> sorted{ layouts.GetAt(0), layouts.GetAt(1) };
+        std::sort(sorted.begin(), sorted.end());
+        VERIFY_ARE_EQUAL(L"one", sorted.at(0));
+        VERIFY_ARE_EQUAL(L"two", sorted.at(1));
+    }
+
 }
@@ -43,6 +43,11 @@ namespace
         virtual void TriggerRedraw(const Microsoft::Console::Types::Viewport&){};
         virtual void TriggerRedraw(const COORD* const){};
         virtual void TriggerRedrawCursor(const COORD* const){};
+        virtual void StartDeferCursorRedraw() noexcept {};
+        virtual void EndDeferCursorRedraw() noexcept {};
+        virtual void StartDeferRedraw() noexcept {};
+        virtual void EndDeferRedraw() noexcept {};
+        virtual void SetSynchronizedOutput(const bool) noexcept {};
         virtual void TriggerRedrawAll(){};
         virtual void TriggerTeardown() noexcept {};
         virtual void TriggerSelection(){};
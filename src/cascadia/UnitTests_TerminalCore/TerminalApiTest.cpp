@@ -38,9 +38,11 @@ namespace TerminalCoreUnitTests
         TEST_METHOD(AddHyperlink);
         TEST_METHOD(AddHyperlinkCustomId);
         TEST_METHOD(AddHyperlinkCustomIdDifferentUri);
+        TEST_METHOD(HoverTargetsMatchTheBuffer);
 
         TEST_METHOD(SetTaskbarProgress);
         TEST_METHOD(SetWorkingDirectory);
+        TEST_METHOD(MarkPromptsAndFailedCommands);
     };
 };
 
@@ -342,6 +344,47 @@ void TerminalCoreUnitTests::TerminalApiTest::AddHyperlinkCustomIdDifferentUri()
     VERIFY_ARE_NOT_EQUAL(oldAttributes.GetHyperlinkId(), tbi.GetCurrentAttributes().GetHyperlinkId());
 }
 
+void TerminalCoreUnitTests::TerminalApiTest::HoverTargetsMatchTheBuffer()
+{
+    Terminal term;
+    DummyRenderTarget emptyRT;
+    term.Create({ 40, 10 }, 0, emptyRT);
+
+    auto& stateMachine = *(term._stateMachine);
+    term._hyperlinkPatternId = term._buffer->AddPatternRecognizer(L"https://[a-z.]+");
+
+    // An OSC 8 hyperlink on the first row and a URL that's only detected by the pattern on the second one.
+    stateMachine.ProcessString(L"ab\x1b]8;;test.url\x1b\\link\x1b]8;;\x1b\\cd\r\n");
+    stateMachine.ProcessString(L"see https://example.com here");
+    term.UpdatePatternsUnderLock();
+
+    const auto targets = term.GetHoverTargets();
+    VERIFY_ARE_EQUAL(1u, targets->hyperlinks.size());
+    VERIFY_ARE_EQUAL(1u, targets->patterns.size());
+
+    // The snapshot has to give the same answers as the terminal itself, including out of bounds.
+    for (SHORT y = -1; y <= 10; ++y)
+    {
+        for (SHORT x = -1; x <= 40; ++x)
+        {
+            const COORD pos{ x, y };
+            VERIFY_ARE_EQUAL(term.GetHyperlinkIdAtPosition(pos), targets->GetHyperlinkIdAtPosition(pos));
+            VERIFY_IS_TRUE(term.GetHyperlinkIntervalFromPosition(pos) == targets->GetHyperlinkIntervalFromPosition(pos));
+        }
+    }
+
+    VERIFY_ARE_NOT_EQUAL(0, targets->GetHyperlinkIdAtPosition({ 2, 0 }));
+    VERIFY_ARE_EQUAL(0, targets->GetHyperlinkIdAtPosition({ 6, 0 }));
+    VERIFY_IS_TRUE(targets->GetHyperlinkIntervalFromPosition({ 10, 1 }).has_value());
+    VERIFY_IS_FALSE(targets->GetHyperlinkIntervalFromPosition({ 2, 1 }).has_value());
+
+    // It's a snapshot: Later output doesn't change it.
+    stateMachine.ProcessString(L"\x1b[H\x1b[2J");
+    term.UpdatePatternsUnderLock();
+    VERIFY_ARE_NOT_EQUAL(0, targets->GetHyperlinkIdAtPosition({ 2, 0 }));
+    VERIFY_ARE_EQUAL(0, term.GetHoverTargets()->GetHyperlinkIdAtPosition({ 2, 0 }));
+}
+
 void TerminalCoreUnitTests::TerminalApiTest::SetTaskbarProgress()
 {
     Terminal term;
@@ -468,3 +511,29 @@ void TerminalCoreUnitTests::TerminalApiTest::SetWorkingDirectory()
     stateMachine.ProcessString(L"\x1b]9;9;\"\"\"\"\x1b\\");
     VERIFY_ARE_EQUAL(term.GetWorkingDirectory(), L"\"\"");
 }
+
+void TerminalCoreUnitTests::TerminalApiTest::MarkPromptsAndFailedCommands()
+{
+    Terminal term;
+    DummyRenderTarget emptyRT;
+    term.Create({ 100, 5 }, 3, emptyRT);
+
+    auto& stateMachine = *(term._stateMachine);
+
+    stateMachine.ProcessString(L"\x1b]133;A\x1b\\$ \x1b]133;B\x1b\\true\r\n\x1b]133;C\x1b\\\x1b]133;D;0\x1b\\");
+    stateMachine.ProcessString(L"\x1b]133;A\x1b\\$ \x1b]133;B\x1b\\false\r\n\x1b]133;C\x1b\\\x1b]133;D;1\x1b\\");
+
+    auto marks = term.GetScrollMarks();
+    VERIFY_ARE_EQUAL(size_t{ 2 }, marks.size());
+    VERIFY_ARE_EQUAL(size_t{ 0 }, marks.at(0).row);
+    VERIFY_ARE_EQUAL(ScrollMarkCategory::Prompt, marks.at(0).category);
+    VERIFY_ARE_EQUAL(size_t{ 1 }, marks.at(1).row);
+    VERIFY_ARE_EQUAL(ScrollMarkCategory::Error, marks.at(1).category);
+
+    Log::Comment(L"The marks follow their rows as the buffer circles.");
+    stateMachine.ProcessString(L"\r\n\r\n\r\n\r\n\r\n\r\n");
+    marks = term.GetScrollMarks();
+    VERIFY_ARE_EQUAL(size_t{ 1 }, marks.size());
+    VERIFY_ARE_EQUAL(size_t{ 0 }, marks.at(0).row);
+    VERIFY_ARE_EQUAL(ScrollMarkCategory::Error, marks.at(0).category);
+}
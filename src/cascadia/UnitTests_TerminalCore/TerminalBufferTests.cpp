@@ -20,6 +20,36 @@ using namespace WEX::TestExecution;
 namespace TerminalCoreUnitTests
 {
     class TerminalBufferTests;
+
+    // Calls the given function whenever a buffer circles, which
+    // lets a test interrupt a reflow at a predictable point.
+    class CirclingRenderTarget final : public Microsoft::Console::Render::IRenderTarget
+    {
+    public:
+        std::function<void()> circled;
+
+        void TriggerRedraw(const Microsoft::Console::Types::Viewport& /*region*/) override {}
+        void TriggerRedraw(const COORD* const /*pcoord*/) override {}
+        void TriggerRedrawCursor(const COORD* const /*pcoord*/) override {}
+        void StartDeferCursorRedraw() noexcept override {}
+        void EndDeferCursorRedraw() noexcept override {}
+        void StartDeferRedraw() noexcept override {}
+        void EndDeferRedraw() noexcept override {}
+        void SetSynchronizedOutput(const bool /*enabled*/) noexcept override {}
+        void TriggerRedrawAll() override {}
+        void TriggerTeardown() noexcept override {}
+        void TriggerSelection() override {}
+        void TriggerScroll() override {}
+        void TriggerScroll(const COORD* const /*pcoordDelta*/) override {}
+        void TriggerCircling() override
+        {
+            if (circled)
+            {
+                circled();
+            }
+        }
+        void TriggerTitleChange() override {}
+    };
 };
 using namespace TerminalCoreUnitTests;
 
@@ -53,6 +83,8 @@ class TerminalCoreUnitTests::TerminalBufferTests final
 
     TEST_METHOD(TestCursorNotifications);
 
+    TEST_METHOD(CancelResizeDuringReflow);
+
     TEST_METHOD_SETUP(MethodSetup)
     {
         // STEP 1: Set up the Terminal
@@ -634,3 +666,35 @@ void TerminalBufferTests::TestCursorNotifications()
     VERIFY_ARE_EQUAL(0, expectedCallbacks);
     VERIFY_IS_TRUE(callbackWasCalled);
 }
+
+void TerminalBufferTests::CancelResizeDuringReflow()
+{
+    // Lines that fill a row of the old buffer wrap onto two rows of the new
+    // one, so the new buffer circles half way into the reflow, after more
+    // than one chunk of rows. That's where the next resize arrives.
+    static constexpr SHORT oldWidth = 20;
+    static constexpr SHORT newWidth = oldWidth / 2;
+    static constexpr SHORT height = 10;
+    static constexpr SHORT historyLength = 1000;
+
+    CirclingRenderTarget renderTarget;
+    Terminal terminal;
+    terminal.Create({ oldWidth, height }, historyLength, renderTarget);
+    for (auto i = 0; i < height + historyLength - 1; ++i)
+    {
+        terminal.Write(L"01234567890123456789\r\n");
+    }
+
+    Log::Comment(L"A resize that's canceled while it reflows keeps the current buffer.");
+    renderTarget.circled = [&]() { terminal.CancelResize(); };
+    VERIFY_ARE_EQUAL(E_ABORT, terminal.UserResize({ newWidth, height }));
+    VERIFY_ARE_EQUAL(oldWidth, terminal.GetViewport().Width());
+    VERIFY_ARE_EQUAL(oldWidth, terminal.GetTextBuffer().GetSize().Width());
+    VERIFY_ARE_EQUAL(L"01234567890123456789", terminal.GetTextBuffer().GetRowByOffset(0).GetText());
+
+    Log::Comment(L"The resize that superseded it goes through.");
+    renderTarget.circled = nullptr;
+    VERIFY_SUCCEEDED(terminal.UserResize({ newWidth, height }));
+    VERIFY_ARE_EQUAL(newWidth, terminal.GetViewport().Width());
+    VERIFY_ARE_EQUAL(newWidth, terminal.GetTextBuffer().GetSize().Width());
+}
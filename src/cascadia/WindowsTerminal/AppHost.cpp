@@ -6,6 +6,7 @@
 #include "../types/inc/Viewport.hpp"
 #include "../types/inc/utils.hpp"
 #include "../types/inc/User32Utils.hpp"
+#include "../types/inc/StartupTracing.hpp"
 #include "../WinRTUtils/inc/WtExeUtils.h"
 #include "resource.h"
 #include "VirtualDesktopUtils.h"
@@ -26,21 +27,30 @@ using namespace std::chrono_literals;
 // "If the high-order bit is 1, the key is down; otherwise, it is up."
 static constexpr short KeyPressed{ gsl::narrow_cast<short>(0x8000) };
 
+// The commandline with which the monarch starts a standby window process. See
+// AppHost::_UpdateStandbyWindow.
+static constexpr std::wstring_view StandbyWindowArg{ L"--standby-window" };
+
 AppHost::AppHost() noexcept :
-    _app{},
+    _app{ nullptr }, // don't make one yet, see _EnsureApp
     _windowManager{},
     _logic{ nullptr }, // don't make one, we're going to take a ref on app's
     _window{ nullptr },
     _getWindowLayoutThrottler{} // this will get set if we become the monarch
 {
-    _logic = _app.Logic(); // get a ref to app's logic
-
     // Inform the WindowManager that it can use us to find the target window for
     // a set of commandline args. This needs to be done before
     // _HandleCommandlineArgs, because WE might end up being the monarch. That
     // would mean we'd need to be responsible for looking that up.
     _windowManager.FindTargetWindowRequested({ this, &AppHost::_FindTargetWindow });
 
+    // If we're the monarch, we're definitely going to need the app to find
+    // the target window of our own commandline.
+    if (_windowManager.IsMonarch())
+    {
+        _EnsureApp();
+    }
+
     // If there were commandline args to our process, try and process them here.
     // Do this before AppLogic::Create, otherwise this will have no effect.
     //
@@ -128,8 +138,31 @@ AppHost::~AppHost()
     _revokers = {};
 
     _window = nullptr;
-    _app.Close();
-    _app = nullptr;
+    if (_app)
+    {
+        _app.Close();
+        _app = nullptr;
+    }
+}
+
+// Method Description:
+// - Creates the Terminal App, and with it the XAML application, if we haven't
+//   already. This is deferred until we know that this process is going to be a
+//   window. A `wt -w 0 nt` that's handed off to an existing window only needs
+//   to ask the monarch, and can exit without ever loading XAML or the settings.
+// - This must be called on the main thread.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void AppHost::_EnsureApp()
+{
+    if (!_app)
+    {
+        const ::Microsoft::Console::StartupTracing::Scope startupPhase{ ::Microsoft::Console::StartupTracing::Phase::CreateApp };
+        _app = winrt::TerminalApp::App{};
+        _logic = _app.Logic(); // get a ref to app's logic
+    }
 }
 
 bool AppHost::OnDirectKeyEvent(const uint32_t vkey, const uint8_t scanCode, const bool down)
@@ -204,19 +237,48 @@ void AppHost::_HandleCommandlineArgs()
     _buildArgsFromCommandline(args);
     std::wstring cwd{ wil::GetCurrentDirectoryW<std::wstring>() };
 
-    Remoting::CommandlineArgs eventArgs{ { args }, { cwd } };
-    _windowManager.ProposeCommandline(eventArgs);
+    const auto isStandby = args.size() == 2 && args[1] == StandbyWindowArg;
+    if (isStandby)
+    {
+        // Get everything out of the way that doesn't depend on the
+        // commandline, then wait for the monarch to hand us one.
+        _EnsureApp();
+        _logic.LoadSettings();
+        _shouldCreateWindow = _windowManager.WaitAsStandby();
+
+        // We were started in the background (see _UpdateStandbyWindow), but
+        // now somebody is waiting for our window.
+        if (_shouldCreateWindow)
+        {
+            LOG_IF_WIN32_BOOL_FALSE(SetPriorityClass(GetCurrentProcess(), NORMAL_PRIORITY_CLASS));
+        }
+    }
+    else
+    {
+        Remoting::CommandlineArgs eventArgs{ { args }, { cwd } };
+        _windowManager.ProposeCommandline(eventArgs);
+
+        _shouldCreateWindow = _windowManager.ShouldCreateWindow();
+    }
 
-    _shouldCreateWindow = _windowManager.ShouldCreateWindow();
     if (!_shouldCreateWindow)
     {
         return;
     }
 
+    _EnsureApp();
+
     if (auto peasant{ _windowManager.CurrentWindow() })
     {
         if (auto args{ peasant.InitialArgs() })
         {
+            // The standby was started by the monarch, in its directory. The
+            // commandline is relative to the directory of whoever proposed it.
+            if (isStandby)
+            {
+                LOG_IF_WIN32_BOOL_FALSE(SetCurrentDirectoryW(args.CurrentDirectory().c_str()));
+            }
+
             const auto result = _logic.SetStartupCommandline(args.Commandline());
             const auto message = _logic.ParseCommandlineMessage();
             if (!message.empty())
@@ -386,6 +448,13 @@ void AppHost::Initialize()
         }
     });
 
+    _window->MinimizeChanged([this](bool newMinimize) {
+        if (_logic)
+        {
+            _logic.Minimized(newMinimize);
+        }
+    });
+
     _logic.Create();
 
     _revokers.TitleChanged = _logic.TitleChanged(winrt::auto_revoke, { this, &AppHost::AppTitleChanged });
@@ -868,6 +937,14 @@ winrt::Windows::Foundation::IAsyncOperation<winrt::hstring> AppHost::_GetWindowL
 void AppHost::_FindTargetWindow(const winrt::Windows::Foundation::IInspectable& /*sender*/,
                                 const Remoting::FindTargetWindowArgs& args)
 {
+    // We're the monarch, but haven't created the app yet. This can only be a
+    // commandline from another process racing our own startup. Leave the
+    // result at its default, and let it create a new window.
+    if (!_logic)
+    {
+        return;
+    }
+
     const auto targetWindow = _logic.FindTargetWindow(args.Args().Commandline());
     args.ResultTargetWindow(targetWindow.WindowId());
     args.ResultTargetWindowName(targetWindow.WindowName());
@@ -931,6 +1008,11 @@ void AppHost::_BecomeMonarch(const winrt::Windows::Foundation::IInspectable& /*s
         _logic.SetNumberOfOpenWindows(_windowManager.GetNumberOfPeasants());
     });
 
+    // The monarch starts a new standby window process whenever the last one
+    // was used up.
+    _revokers.StandbyConsumed = _windowManager.StandbyConsumed(winrt::auto_revoke, { this, &AppHost::_StandbyConsumed });
+    _UpdateStandbyWindow();
+
     // These events are coming from peasants that become or un-become quake windows.
     _revokers.ShowNotificationIconRequested = _windowManager.ShowNotificationIconRequested(winrt::auto_revoke, { this, &AppHost::_ShowNotificationIconRequested });
     _revokers.HideNotificationIconRequested = _windowManager.HideNotificationIconRequested(winrt::auto_revoke, { this, &AppHost::_HideNotificationIconRequested });
@@ -948,6 +1030,77 @@ void AppHost::_BecomeMonarch(const winrt::Windows::Foundation::IInspectable& /*s
     }
 }
 
+// Method Description:
+// - Starts or dismisses the standby window process of the monarch, depending on
+//   the "experimental.standbyWindow" setting. The standby is a window process
+//   that has already loaded XAML and the settings, without a window. The next
+//   commandline that asks for a new window is handed to it, which saves that
+//   window the whole startup of a process (see Monarch::AddStandby).
+// - Only the monarch keeps a standby.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void AppHost::_UpdateStandbyWindow()
+{
+    if (!_windowManager.IsMonarch())
+    {
+        return;
+    }
+
+    const auto wanted = _logic.GetStandbyWindow();
+    if (!wanted && _standbyWindowStarted)
+    {
+        _standbyWindowStarted = false;
+        _windowManager.DismissStandby();
+    }
+    else if (wanted && !_standbyWindowStarted)
+    {
+        const auto exePath{ wil::GetModuleFileNameW<std::wstring>(nullptr) };
+        auto commandline{ fmt::format(L"\"{}\" {}", exePath, StandbyWindowArg) };
+
+        STARTUPINFOW si{};
+        si.cb = sizeof(si);
+        wil::unique_process_information pi;
+
+        // The standby starts up below normal priority, so that it doesn't slow
+        // down the windows that are starting up right now, like our own. It
+        // registers itself with us once it's ready. If it fails to start, we'll
+        // try again the next time the settings change.
+        const auto started = CreateProcessW(exePath.c_str(),
+                                            commandline.data(),
+                                            nullptr, // lpProcessAttributes
+                                            nullptr, // lpThreadAttributes
+                                            false, // bInheritHandles
+                                            DETACHED_PROCESS | CREATE_UNICODE_ENVIRONMENT | BELOW_NORMAL_PRIORITY_CLASS, // doCreationFlags
+                                            nullptr, // lpEnvironment
+                                            nullptr, // lpStartingDirectory
+                                            &si, // lpStartupInfo
+                                            &pi // lpProcessInformation
+                                            );
+        LOG_LAST_ERROR_IF(!started);
+        _standbyWindowStarted = started != FALSE;
+    }
+}
+
+// Method Description:
+// - Called by the monarch when our standby window process was handed a
+//   commandline (or died trying). Starts the next one.
+// - This is raised on whichever thread proposed the commandline, so we'll hop
+//   to the UI thread first.
+// Arguments:
+// - <unused>
+// Return Value:
+// - <none>
+winrt::fire_and_forget AppHost::_StandbyConsumed(const winrt::Windows::Foundation::IInspectable /*sender*/,
+                                                 const winrt::Windows::Foundation::IInspectable /*args*/)
+{
+    co_await winrt::resume_foreground(_logic.GetRoot().Dispatcher());
+
+    _standbyWindowStarted = false;
+    _UpdateStandbyWindow();
+}
+
 winrt::Windows::Foundation::IAsyncAction AppHost::_SaveWindowLayouts()
 {
     // Make sure we run on a background thread to not block anything.
@@ -1327,6 +1480,8 @@ void AppHost::_HandleSettingsChanged(const winrt::Windows::Foundation::IInspecta
         }
     }
 
+    _UpdateStandbyWindow();
+
     _window->SetMinimizeToNotificationAreaBehavior(_logic.GetMinimizeToNotificationArea());
 }
 
@@ -31,11 +31,13 @@ private:
 
     bool _shouldCreateWindow{ false };
     bool _useNonClientArea{ false };
+    bool _standbyWindowStarted{ false };
 
     std::optional<til::throttled_func_trailing<>> _getWindowLayoutThrottler;
     winrt::Windows::Foundation::IAsyncAction _SaveWindowLayouts();
     winrt::fire_and_forget _SaveWindowLayoutsRepeat();
 
+    void _EnsureApp();
     void _HandleCommandlineArgs();
     winrt::Microsoft::Terminal::Settings::Model::LaunchPosition _GetWindowLaunchPosition();
 
@@ -68,6 +70,9 @@ private:
 
     void _BecomeMonarch(const winrt::Windows::Foundation::IInspectable& sender,
                         const winrt::Windows::Foundation::IInspectable& args);
+    void _UpdateStandbyWindow();
+    winrt::fire_and_forget _StandbyConsumed(const winrt::Windows::Foundation::IInspectable sender,
+                                            const winrt::Windows::Foundation::IInspectable args);
     void _GlobalHotkeyPressed(const long hotkeyIndex);
     void _HandleSummon(const winrt::Windows::Foundation::IInspectable& sender,
                        const winrt::Microsoft::Terminal::Remoting::SummonWindowBehavior& args);
@@ -160,5 +165,6 @@ private:
         winrt::Microsoft::Terminal::Remoting::WindowManager::ShowNotificationIconRequested_revoker ShowNotificationIconRequested;
         winrt::Microsoft::Terminal::Remoting::WindowManager::HideNotificationIconRequested_revoker HideNotificationIconRequested;
         winrt::Microsoft::Terminal::Remoting::WindowManager::QuitAllRequested_revoker QuitAllRequested;
+        winrt::Microsoft::Terminal::Remoting::WindowManager::StandbyConsumed_revoker StandbyConsumed;
     } _revokers{};
 };
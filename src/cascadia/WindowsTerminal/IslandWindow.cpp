@@ -474,6 +474,11 @@ long IslandWindow::_calculateTotalSize(const bool isWidth, const long clientSize
             _MaximizeChangedHandlers(wparam == SIZE_MAXIMIZED);
         }
 
+        if (wparam == SIZE_RESTORED || wparam == SIZE_MAXIMIZED || wparam == SIZE_MINIMIZED)
+        {
+            _MinimizeChangedHandlers(wparam == SIZE_MINIMIZED);
+        }
+
         if (wparam == SIZE_MINIMIZED && _isQuakeWindow)
         {
             ShowWindow(GetHandle(), SW_HIDE);
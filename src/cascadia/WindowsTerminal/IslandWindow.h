@@ -74,6 +74,7 @@ public:
     WINRT_CALLBACK(NotifyReAddNotificationIcon, winrt::delegate<void()>);
     WINRT_CALLBACK(ShouldExitFullscreen, winrt::delegate<void()>);
     WINRT_CALLBACK(MaximizeChanged, winrt::delegate<void(bool)>);
+    WINRT_CALLBACK(MinimizeChanged, winrt::delegate<void(bool)>);
 
     WINRT_CALLBACK(WindowMoved, winrt::delegate<void()>);
 
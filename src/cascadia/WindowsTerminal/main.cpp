@@ -5,6 +5,7 @@
 #include "AppHost.h"
 #include "resource.h"
 #include "../types/inc/User32Utils.hpp"
+#include "../types/inc/StartupTracing.hpp"
 #include <WilErrorReporting.h>
 
 using namespace winrt;
@@ -136,7 +137,9 @@ int __stdcall wWinMain(HINSTANCE, HINSTANCE, LPWSTR, int)
     // Create the AppHost object, which will create both the window and the
     // Terminal App. This MUST BE constructed before the Xaml manager as TermApp
     // provides an implementation of Windows.UI.Xaml.Application.
+    ::Microsoft::Console::StartupTracing::Scope appHostPhase{ ::Microsoft::Console::StartupTracing::Phase::AppHost };
     AppHost host;
+    appHostPhase.Stop();
     if (!host.HasWindow())
     {
         // If we were told to not have a window, exit early. Make sure to use
@@ -117,6 +117,29 @@ namespace Microsoft.Terminal.Wpf
             }
         }
 
+        /// <summary>
+        /// Sends UTF-8 encoded output to the terminal, without converting it to a string first.
+        /// </summary>
+        /// <param name="buffer">The output, in UTF-8. Characters may be split between two calls.</param>
+        /// <param name="count">The number of bytes of the buffer to send.</param>
+        internal void SendOutputUtf8(byte[] buffer, int count)
+        {
+            if (buffer == null)
+            {
+                throw new ArgumentNullException(nameof(buffer));
+            }
+
+            if (count < 0 || count > buffer.Length)
+            {
+                throw new ArgumentOutOfRangeException(nameof(count));
+            }
+
+            if (this.terminal != IntPtr.Zero)
+            {
+                NativeMethods.TerminalSendOutputUtf8(this.terminal, buffer, (uint)count);
+            }
+        }
+
         /// <summary>
         /// Manually invoke a scroll of the terminal buffer.
         /// </summary>
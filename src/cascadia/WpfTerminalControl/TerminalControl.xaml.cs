@@ -101,6 +101,18 @@ namespace Microsoft.Terminal.Wpf
             }
         }
 
+        /// <summary>
+        /// Writes UTF-8 encoded output into the terminal, as if it came from the connection.
+        /// This is faster than raising <see cref="ITerminalConnection.TerminalOutput"/>,
+        /// as the output doesn't need to be converted to a string.
+        /// </summary>
+        /// <param name="buffer">The output, in UTF-8. Characters may be split between two calls.</param>
+        /// <param name="count">The number of bytes of the buffer to write.</param>
+        public void WriteOutputUtf8(byte[] buffer, int count)
+        {
+            this.termContainer.SendOutputUtf8(buffer, count);
+        }
+
         /// <summary>
         /// Gets the selected text in the terminal, clearing the selection. Otherwise returns an empty string.
         /// </summary>
@@ -67,4 +67,11 @@
     X(winrt::Microsoft::Terminal::Control::TextAntialiasingMode, AntialiasingMode, winrt::Microsoft::Terminal::Control::TextAntialiasingMode::Grayscale) \
     X(bool, ForceFullRepaintRendering, false)                                                                                                            \
     X(bool, SoftwareRendering, false)                                                                                                                    \
-    X(bool, UseAtlasEngine, false)
+    X(bool, SharedDeviceRendering, false)                                                                                                                \
+    X(int32_t, PixelShaderFrameRate, 0)                                                                                                                  \
+    X(int32_t, ScrollbackMemoryBudget, 0)                                                                                                                \
+    X(bool, UseAtlasEngine, false)                                                                                                                       \
+    X(winrt::hstring, SessionLogDirectory)                                                                                                               \
+    X(winrt::Microsoft::Terminal::Control::SessionLogFormat, SessionLogFormat, winrt::Microsoft::Terminal::Control::SessionLogFormat::Raw)               \
+    X(int32_t, SessionLogRotateSize, 0)                                                                                                                  \
+    X(int32_t, SessionLogRotateInterval, 0)
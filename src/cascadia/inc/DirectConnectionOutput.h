@@ -0,0 +1,32 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- DirectConnectionOutput.h
+
+Abstract:
+- The TerminalOutput event of an ITerminalConnection turns every chunk of
+  output into an hstring, which is allocated and copied once per chunk.
+- Connections that are built into the Terminal can implement this interface
+  next to ITerminalConnection. A control in the same process then receives
+  their output as a view of the connection's own buffer instead.
+- Third party connections keep using the TerminalOutput event.
+--*/
+
+#pragma once
+
+#include <functional>
+#include <string_view>
+
+// The handler is called on the thread that reads the output of the connection.
+// The text is only valid for the duration of the call.
+using DirectOutputHandler = std::function<void(std::wstring_view)>;
+
+struct __declspec(uuid("bc291197-eaac-4c17-98e1-0578cf573a31")) IDirectConnectionOutput : ::IUnknown
+{
+    // While a handler is set, the output is given to it instead of being
+    // raised as a TerminalOutput event. Once this returns, the previous
+    // handler isn't going to be called anymore.
+    virtual void SetDirectOutputHandler(DirectOutputHandler handler) = 0;
+};
@@ -21,6 +21,12 @@ const std::wstring_view ConsoleArguments::HEIGHT_ARG = L"--height";
 const std::wstring_view ConsoleArguments::INHERIT_CURSOR_ARG = L"--inheritcursor";
 const std::wstring_view ConsoleArguments::RESIZE_QUIRK = L"--resizeQuirk";
 const std::wstring_view ConsoleArguments::WIN32_INPUT_MODE = L"--win32input";
+const std::wstring_view ConsoleArguments::LATENCY_BUDGET_ARG = L"--latencyBudget";
+const std::wstring_view ConsoleArguments::PASSTHROUGH_ARG = L"--passthrough";
+const std::wstring_view ConsoleArguments::FRAME_DIFF_ARG = L"--frameDiff";
+const std::wstring_view ConsoleArguments::REPEAT_CHARACTERS_ARG = L"--repeatCharacters";
+const std::wstring_view ConsoleArguments::COMPRESS_OUTPUT_ARG = L"--compressOutput";
+const std::wstring_view ConsoleArguments::OVERLAPPED_SIGNAL_ARG = L"--overlappedSignal";
 const std::wstring_view ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring_view ConsoleArguments::FEATURE_PTY_ARG = L"pty";
 const std::wstring_view ConsoleArguments::COM_SERVER_ARG = L"-Embedding";
@@ -480,6 +486,14 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
         {
             hr = s_GetArgumentValue(args, i, &_height);
         }
+        else if (arg == LATENCY_BUDGET_ARG)
+        {
+            hr = s_GetArgumentValue(args, i, &_latencyBudget);
+            if (SUCCEEDED(hr) && _latencyBudget < 0)
+            {
+                hr = E_INVALIDARG;
+            }
+        }
         else if (arg == FEATURE_ARG)
         {
             hr = s_HandleFeatureValue(args, i);
@@ -508,6 +522,36 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == PASSTHROUGH_ARG)
+        {
+            _passthrough = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
+        else if (arg == FRAME_DIFF_ARG)
+        {
+            _frameDiff = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
+        else if (arg == REPEAT_CHARACTERS_ARG)
+        {
+            _repeatCharacters = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
+        else if (arg == COMPRESS_OUTPUT_ARG)
+        {
+            _compressOutput = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
+        else if (arg == OVERLAPPED_SIGNAL_ARG)
+        {
+            _overlappedSignal = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -663,6 +707,30 @@ bool ConsoleArguments::IsWin32InputModeEnabled() const
 {
     return _win32InputMode;
 }
+short ConsoleArguments::GetLatencyBudget() const
+{
+    return _latencyBudget;
+}
+bool ConsoleArguments::IsPassthroughModeEnabled() const
+{
+    return _passthrough;
+}
+bool ConsoleArguments::IsFrameDiffEnabled() const
+{
+    return _frameDiff;
+}
+bool ConsoleArguments::IsRepeatCharactersEnabled() const
+{
+    return _repeatCharacters;
+}
+bool ConsoleArguments::IsOutputCompressionEnabled() const
+{
+    return _compressOutput;
+}
+bool ConsoleArguments::IsSignalHandleOverlapped() const
+{
+    return _overlappedSignal;
+}
 
 #ifdef UNIT_TESTING
 // Method Description:
@@ -55,6 +55,12 @@ public:
     bool GetInheritCursor() const;
     bool IsResizeQuirkEnabled() const;
     bool IsWin32InputModeEnabled() const;
+    short GetLatencyBudget() const;
+    bool IsPassthroughModeEnabled() const;
+    bool IsFrameDiffEnabled() const;
+    bool IsRepeatCharactersEnabled() const;
+    bool IsOutputCompressionEnabled() const;
+    bool IsSignalHandleOverlapped() const;
 
 #ifdef UNIT_TESTING
     void EnableConptyModeForTests();
@@ -74,6 +80,12 @@ public:
     static const std::wstring_view INHERIT_CURSOR_ARG;
     static const std::wstring_view RESIZE_QUIRK;
     static const std::wstring_view WIN32_INPUT_MODE;
+    static const std::wstring_view LATENCY_BUDGET_ARG;
+    static const std::wstring_view PASSTHROUGH_ARG;
+    static const std::wstring_view FRAME_DIFF_ARG;
+    static const std::wstring_view REPEAT_CHARACTERS_ARG;
+    static const std::wstring_view COMPRESS_OUTPUT_ARG;
+    static const std::wstring_view OVERLAPPED_SIGNAL_ARG;
     static const std::wstring_view FEATURE_ARG;
     static const std::wstring_view FEATURE_PTY_ARG;
     static const std::wstring_view COM_SERVER_ARG;
@@ -140,6 +152,14 @@ private:
     bool _inheritCursor;
     bool _resizeQuirk{ false };
     bool _win32InputMode{ false };
+    // In milliseconds. 0 keeps the regular frame pacing of the VT renderer.
+    short _latencyBudget{ 0 };
+    bool _passthrough{ false };
+    bool _frameDiff{ false };
+    bool _repeatCharacters{ false };
+    bool _compressOutput{ false };
+    // Whether the signal pipe was opened for overlapped reads.
+    bool _overlappedSignal{ false };
 
     [[nodiscard]] HRESULT _GetClientCommandline(_Inout_ std::vector<std::wstring>& args,
                                                 const size_t index,
@@ -17,12 +17,15 @@ using namespace Microsoft::Console::VirtualTerminal;
 // - Creates the PTY Signal Input Thread.
 // Arguments:
 // - hPipe - a handle to the file representing the read end of the VT pipe.
-PtySignalInputThread::PtySignalInputThread(wil::unique_hfile hPipe) :
+// - overlapped - true if hPipe was opened with FILE_FLAG_OVERLAPPED, in which
+//      case it's read on the thread pool rather than on a thread of our own.
+PtySignalInputThread::PtySignalInputThread(wil::unique_hfile hPipe, const bool overlapped) :
     _hFile{ std::move(hPipe) },
     _hThread{},
     _pConApi{ std::make_unique<ConhostInternalGetSet>(ServiceLocator::LocateGlobals().getConsoleInformation()) },
     _dwThreadId{ 0 },
-    _consoleConnected{ false }
+    _consoleConnected{ false },
+    _overlapped{ overlapped }
 {
     THROW_HR_IF(E_HANDLE, _hFile.get() == INVALID_HANDLE_VALUE);
     THROW_HR_IF_NULL(E_INVALIDARG, _pConApi.get());
@@ -30,6 +33,24 @@ PtySignalInputThread::PtySignalInputThread(wil::unique_hfile hPipe) :
 
 PtySignalInputThread::~PtySignalInputThread()
 {
+    if (_io)
+    {
+        {
+            // _ReadAsync checks _stopping under the same lock,
+            // so no read can be started once we've set it.
+            const std::lock_guard lock{ _readLock };
+            _stopping = true;
+            CancelIoEx(_hFile.get(), &_readOverlapped);
+        }
+
+        // The read that's in flight has to be done before _readBuffer goes away,
+        // and so do the callbacks that may still be handling a completion.
+        DWORD read = 0;
+        GetOverlappedResult(_hFile.get(), &_readOverlapped, &read, TRUE);
+        WaitForThreadpoolIoCallbacks(_io.get(), FALSE);
+        _io.reset();
+    }
+
     // Manually terminate our thread during unittesting. Otherwise, the test
     //      will finish, but TAEF will not manually kill the test.
 #ifdef UNIT_TESTING
@@ -83,40 +104,218 @@ void PtySignalInputThread::ConnectConsole() noexcept
         {
         case PtySignal::ClearBuffer:
         {
-            LockConsole();
-            auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+            _HandleClearBuffer();
+            break;
+        }
+        case PtySignal::ResizeWindow:
+        {
+            ResizeWindowData resizeMsg = { 0 };
+            if (!_GetData(&resizeMsg, sizeof(resizeMsg)))
+            {
+                return S_OK;
+            }
+            _HandleResizeWindow(resizeMsg);
+            break;
+        }
+        case PtySignal::Message:
+        {
+            MessageHeader header{};
+            if (!_GetData(&header, sizeof(header)))
+            {
+                return S_OK;
+            }
 
-            // If the client app hasn't yet connected, stash the new size in the launchArgs.
-            // We'll later use the value in launchArgs to set up the console buffer
-            // We must be under lock here to ensure that someone else doesn't come in
-            // and set with `ConnectConsole` while we're looking and modifying this.
-            if (_consoleConnected)
+            // The size is the only thing we have to trust to stay in sync
+            // with the pipe, so a nonsensical one means it's corrupted.
+            THROW_HR_IF(E_UNEXPECTED, header.size > MaxMessageSize);
+            std::vector<BYTE> payload(header.size);
+            if (!payload.empty() && !_GetData(payload.data(), header.size))
             {
-                _DoClearBuffer();
+                return S_OK;
             }
+
+            _HandleMessage(header, payload);
             break;
         }
-        case PtySignal::ResizeWindow:
+        default:
         {
-            ResizeWindowData resizeMsg = { 0 };
-            _GetData(&resizeMsg, sizeof(resizeMsg));
+            THROW_HR(E_UNEXPECTED);
+        }
+        }
+    }
+    return S_OK;
+}
+
+void CALLBACK PtySignalInputThread::s_ReadCompleted(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context, PVOID /*overlapped*/, ULONG result, ULONG_PTR bytesTransferred, PTP_IO /*io*/) noexcept
+{
+    static_cast<PtySignalInputThread*>(context)->_ReadCompleted(result, bytesTransferred);
+}
+
+// Method Description:
+// - Starts the next overlapped read of the signal pipe. Its completion is
+//   handled by _ReadCompleted on the thread pool. Only one read is ever in
+//   flight, so the signals are handled in order. Once the destructor started
+//   to tear the pipe down, no read is started anymore.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void PtySignalInputThread::_ReadAsync() noexcept
+{
+    DWORD lastError = NO_ERROR;
+    {
+        const std::lock_guard lock{ _readLock };
+        if (_stopping)
+        {
+            return;
+        }
+
+        StartThreadpoolIo(_io.get());
+        _readOverlapped = {};
+        if (ReadFile(_hFile.get(), _readBuffer.data(), ReadSize, nullptr, &_readOverlapped))
+        {
+            return;
+        }
+
+        lastError = GetLastError();
+        if (lastError == ERROR_IO_PENDING)
+        {
+            return;
+        }
+
+        // No completion will be queued for a read that failed right away.
+        CancelThreadpoolIo(_io.get());
+    }
+
+    // This is handled outside of the lock, because it may start the next read.
+    _ReadCompleted(lastError, 0);
+}
+
+// Method Description:
+// - Handles the completion of an overlapped read of the signal pipe: all the
+//   signals that have been read in full are handled, and the start of one
+//   that's incomplete is kept for the next read.
+// - Just like for the synchronous thread, a broken pipe means that the
+//   terminal is gone and we shut down. Any other error would leave us out of
+//   sync with the pipe, so we log it and shut down as well.
+// Arguments:
+// - result - The Win32 error code of the read
+// - bytesTransferred - The number of bytes that were read into _readBuffer
+// Return Value:
+// - <none>
+void PtySignalInputThread::_ReadCompleted(const ULONG result, const ULONG_PTR bytesTransferred) noexcept
+{
+    {
+        // A read that's cancelled by the destructor completes with an error,
+        // which mustn't be mistaken for the terminal going away.
+        const std::lock_guard lock{ _readLock };
+        if (_stopping)
+        {
+            return;
+        }
+    }
 
-            LockConsole();
-            auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+    if (result != NO_ERROR)
+    {
+        // Closing the server end of a named pipe may also leave it disconnected.
+        if (result != ERROR_BROKEN_PIPE && result != ERROR_PIPE_NOT_CONNECTED)
+        {
+            LOG_WIN32(result);
+        }
+        _Shutdown();
+        return;
+    }
 
-            // If the client app hasn't yet connected, stash the new size in the launchArgs.
-            // We'll later use the value in launchArgs to set up the console buffer
-            // We must be under lock here to ensure that someone else doesn't come in
-            // and set with `ConnectConsole` while we're looking and modifying this.
-            if (!_consoleConnected)
+    try
+    {
+        _ProcessRead(_readBuffer.data(), bytesTransferred);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        _Shutdown();
+        return;
+    }
+
+    _ReadAsync();
+}
+
+// Method Description:
+// - Appends the bytes of a read to the ones of the signal that's still
+//   incomplete, handles all the signals that are complete now, and keeps the
+//   start of the next one around.
+// Arguments:
+// - data - The bytes that have been read from the pipe
+// - size - The number of bytes in data
+// Return Value:
+// - <none>
+void PtySignalInputThread::_ProcessRead(const BYTE* const data, const size_t size)
+{
+    _pending.insert(_pending.end(), data, data + size);
+    const auto consumed = _DispatchPending(_pending.data(), _pending.size());
+    _pending.erase(_pending.begin(), _pending.begin() + consumed);
+}
+
+// Method Description:
+// - Handles all the signals in the given bytes that are complete.
+// Arguments:
+// - data - The bytes read from the pipe that haven't been handled yet
+// - size - The number of bytes in data
+// Return Value:
+// - The number of bytes that were handled. The rest is the start of a signal
+//   that we need more bytes for.
+size_t PtySignalInputThread::_DispatchPending(const BYTE* const data, const size_t size)
+{
+    size_t offset = 0;
+    while (size - offset >= sizeof(PtySignal))
+    {
+        const auto signal = data + offset;
+        const auto available = size - offset - sizeof(PtySignal);
+
+        PtySignal signalId;
+        memcpy(&signalId, signal, sizeof(signalId));
+        const auto body = signal + sizeof(signalId);
+
+        switch (signalId)
+        {
+        case PtySignal::ClearBuffer:
+        {
+            _HandleClearBuffer();
+            offset += sizeof(signalId);
+            break;
+        }
+        case PtySignal::ResizeWindow:
+        {
+            ResizeWindowData resizeMsg{};
+            if (available < sizeof(resizeMsg))
+            {
+                return offset;
+            }
+            memcpy(&resizeMsg, body, sizeof(resizeMsg));
+            _HandleResizeWindow(resizeMsg);
+            offset += sizeof(signalId) + sizeof(resizeMsg);
+            break;
+        }
+        case PtySignal::Message:
+        {
+            MessageHeader header{};
+            if (available < sizeof(header))
             {
-                _earlyResize = resizeMsg;
+                return offset;
             }
-            else
+            memcpy(&header, body, sizeof(header));
+
+            // See _InputThread.
+            THROW_HR_IF(E_UNEXPECTED, header.size > MaxMessageSize);
+            if (available - sizeof(header) < header.size)
             {
-                _DoResizeWindow(resizeMsg);
+                return offset;
             }
 
+            const auto payloadStart = body + sizeof(header);
+            const std::vector<BYTE> payload(payloadStart, payloadStart + header.size);
+            _HandleMessage(header, payload);
+            offset += sizeof(signalId) + sizeof(header) + header.size;
             break;
         }
         default:
@@ -125,7 +324,53 @@ void PtySignalInputThread::ConnectConsole() noexcept
         }
         }
     }
-    return S_OK;
+    return offset;
+}
+
+void PtySignalInputThread::_HandleClearBuffer()
+{
+    LockConsole();
+    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+    // If the client app hasn't yet connected, there's no buffer to clear yet.
+    // We must be under lock here to ensure that someone else doesn't come in
+    // and set with `ConnectConsole` while we're looking and modifying this.
+    if (_consoleConnected)
+    {
+        _DoClearBuffer();
+    }
+}
+
+void PtySignalInputThread::_HandleResizeWindow(const ResizeWindowData& data)
+{
+    LockConsole();
+    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+    // If the client app hasn't yet connected, stash the new size in the launchArgs.
+    // We'll later use the value in launchArgs to set up the console buffer
+    // We must be under lock here to ensure that someone else doesn't come in
+    // and set with `ConnectConsole` while we're looking and modifying this.
+    if (!_consoleConnected)
+    {
+        _earlyResize = data;
+    }
+    else
+    {
+        _DoResizeWindow(data);
+    }
+}
+
+void PtySignalInputThread::_HandleMessage(const MessageHeader& header, const std::vector<BYTE>& payload)
+{
+    LockConsole();
+    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+    // Messages refer to the state of the buffer, and are meaningless
+    // before a client has connected.
+    if (_consoleConnected)
+    {
+        _DoMessage(header, payload);
+    }
 }
 
 // Method Description:
@@ -147,6 +392,51 @@ void PtySignalInputThread::_DoClearBuffer()
     _pConApi->ClearBuffer();
 }
 
+// Method Description:
+// - Dispatches a message received with the Message signal. Messages we don't
+//   know about (i.e. ones introduced by later versions) are ignored. Fields
+//   appended to a payload by later versions are ignored as well, while
+//   payloads that are too short for us are dropped.
+// Arguments:
+// - header - The header of the message
+// - payload - The payload of the message, header.size bytes long
+// Return Value:
+// - <none>
+void PtySignalInputThread::_DoMessage(const MessageHeader& header, const std::vector<BYTE>& payload)
+{
+    switch (header.type)
+    {
+    case PtyMessage::RepaintRegion:
+    {
+        RepaintRegionData data{};
+        if (payload.size() >= sizeof(data))
+        {
+            memcpy(&data, payload.data(), sizeof(data));
+            _DoRepaintRegion(data);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Method Description:
+// - Paints the given region of the viewport again, in full. Terminals use
+//   this to resynchronize a part of the screen (for instance after they
+//   reflowed it themselves), without clearing and repainting all of it.
+// Arguments:
+// - data - Packet information containing the region to repaint
+// Return Value:
+// - <none>
+void PtySignalInputThread::_DoRepaintRegion(const RepaintRegionData& data)
+{
+    if (auto* const pVtIo = ServiceLocator::LocateGlobals().getConsoleInformation().GetVtIo())
+    {
+        pVtIo->RepaintRegion({ data.left, data.top, data.right, data.bottom });
+    }
+}
+
 // Method Description:
 // - Retrieves bytes from the file stream and exits or throws errors should the pipe state
 //   be compromised.
@@ -154,7 +444,8 @@ void PtySignalInputThread::_DoClearBuffer()
 // - pBuffer - Buffer to fill with data.
 // - cbBuffer - Count of bytes in the given buffer.
 // Return Value:
-// - True if data was retrieved successfully. False otherwise.
+// - True if data was retrieved successfully. False if the pipe was broken or
+//   ran dry, in which case we've started to shut down and pBuffer is garbage.
 bool PtySignalInputThread::_GetData(_Out_writes_bytes_(cbBuffer) void* const pBuffer,
                                     const DWORD cbBuffer)
 {
@@ -169,6 +460,7 @@ bool PtySignalInputThread::_GetData(_Out_writes_bytes_(cbBuffer) void* const pBu
         if (lastError == ERROR_BROKEN_PIPE)
         {
             _Shutdown();
+            return false;
         }
         else
         {
@@ -178,6 +470,7 @@ bool PtySignalInputThread::_GetData(_Out_writes_bytes_(cbBuffer) void* const pBu
     else if (dwRead != cbBuffer)
     {
         _Shutdown();
+        return false;
     }
 
     return true;
@@ -189,6 +482,14 @@ bool PtySignalInputThread::_GetData(_Out_writes_bytes_(cbBuffer) void* const pBu
 {
     RETURN_LAST_ERROR_IF(!_hFile);
 
+    if (_overlapped)
+    {
+        _io.reset(CreateThreadpoolIo(_hFile.get(), s_ReadCompleted, this, nullptr));
+        RETURN_LAST_ERROR_IF_NULL(_io);
+        _ReadAsync();
+        return S_OK;
+    }
+
     HANDLE hThread = nullptr;
     // 0 is the right value, https://blogs.msdn.microsoft.com/oldnewthing/20040223-00/?p=40503
     DWORD dwThreadId = 0;
@@ -8,6 +8,9 @@ Module Name:
 Abstract:
 - Defines methods that wrap the thread that will wait for Pty Signals
   if a Pty server (VT server) is running.
+- If the terminal opened the signal pipe for overlapped reads (see
+  --overlappedSignal), the signals are read on the thread pool of the process
+  instead, so that conhost doesn't need a thread that blocks on the pipe.
 
 Author(s):
 - Mike Griese (migrie) 15 Aug 2017
@@ -25,7 +28,7 @@ namespace Microsoft::Console
     class PtySignalInputThread final
     {
     public:
-        PtySignalInputThread(_In_ wil::unique_hfile hPipe);
+        PtySignalInputThread(_In_ wil::unique_hfile hPipe, const bool overlapped = false);
         ~PtySignalInputThread();
 
         [[nodiscard]] HRESULT Start() noexcept;
@@ -38,10 +41,15 @@ namespace Microsoft::Console
         void ConnectConsole() noexcept;
 
     private:
+#ifdef UNIT_TESTING
+        friend class PtySignalInputThreadTests;
+#endif
+
         enum class PtySignal : unsigned short
         {
             ClearBuffer = 2,
-            ResizeWindow = 8
+            ResizeWindow = 8,
+            Message = 16
         };
 
         struct ResizeWindowData
@@ -50,10 +58,51 @@ namespace Microsoft::Console
             unsigned short sy;
         };
 
+        // A Message signal is followed by a MessageHeader and `size` bytes of
+        // payload. Payloads only ever grow by appending fields, and messages
+        // we don't know are skipped, so that a terminal can talk to both older
+        // and newer conhosts. See PTY_SIGNAL_MESSAGE in winconpty.h.
+        enum class PtyMessage : unsigned short
+        {
+            RepaintRegion = 1
+        };
+
+        struct MessageHeader
+        {
+            unsigned short version;
+            PtyMessage type;
+            unsigned long size;
+        };
+
+        // The viewport-relative, inclusive region the terminal would like painted again.
+        struct RepaintRegionData
+        {
+            short left;
+            short top;
+            short right;
+            short bottom;
+        };
+
+        static constexpr unsigned short MessageVersion = 1;
+        static constexpr unsigned long MaxMessageSize = 64 * 1024;
+
+        // The most bytes requested from the pipe by a single overlapped read.
+        static constexpr DWORD ReadSize = 4096;
+
         [[nodiscard]] HRESULT _InputThread();
         bool _GetData(_Out_writes_bytes_(cbBuffer) void* const pBuffer, const DWORD cbBuffer);
+        static void CALLBACK s_ReadCompleted(PTP_CALLBACK_INSTANCE instance, PVOID context, PVOID overlapped, ULONG result, ULONG_PTR bytesTransferred, PTP_IO io) noexcept;
+        void _ReadAsync() noexcept;
+        void _ReadCompleted(const ULONG result, const ULONG_PTR bytesTransferred) noexcept;
+        void _ProcessRead(const BYTE* const data, const size_t size);
+        size_t _DispatchPending(const BYTE* const data, const size_t size);
+        void _HandleClearBuffer();
+        void _HandleResizeWindow(const ResizeWindowData& data);
+        void _HandleMessage(const MessageHeader& header, const std::vector<BYTE>& payload);
         void _DoResizeWindow(const ResizeWindowData& data);
         void _DoClearBuffer();
+        void _DoMessage(const MessageHeader& header, const std::vector<BYTE>& payload);
+        void _DoRepaintRegion(const RepaintRegionData& data);
         void _Shutdown();
 
         wil::unique_hfile _hFile;
@@ -61,6 +110,17 @@ namespace Microsoft::Console
         DWORD _dwThreadId;
         bool _consoleConnected;
         std::optional<ResizeWindowData> _earlyResize;
+
+        // Only used if the pipe is overlapped.
+        bool _overlapped;
+        // Guards _stopping against a completion that's about to start the next read.
+        // _stopping is only ever accessed under this lock.
+        std::mutex _readLock;
+        bool _stopping{ false };
+        wil::unique_threadpool_io _io;
+        OVERLAPPED _readOverlapped{};
+        std::array<BYTE, ReadSize> _readBuffer{};
+        std::vector<BYTE> _pending; // the start of a signal that hasn't been read in full yet
         std::unique_ptr<Microsoft::Console::VirtualTerminal::ConGetSet> _pConApi;
     };
 }
@@ -41,6 +41,54 @@ void ScreenBufferRenderTarget::TriggerRedrawCursor(const COORD* const pcoord)
     }
 }
 
+// Deferring isn't limited to the active buffer, so that a deferral started
+// before switching to or from the alternate buffer is still ended correctly.
+void ScreenBufferRenderTarget::StartDeferCursorRedraw() noexcept
+{
+    auto* pRenderer = ServiceLocator::LocateGlobals().pRender;
+    if (pRenderer != nullptr)
+    {
+        pRenderer->StartDeferCursorRedraw();
+    }
+}
+
+void ScreenBufferRenderTarget::EndDeferCursorRedraw() noexcept
+{
+    auto* pRenderer = ServiceLocator::LocateGlobals().pRender;
+    if (pRenderer != nullptr)
+    {
+        pRenderer->EndDeferCursorRedraw();
+    }
+}
+
+void ScreenBufferRenderTarget::StartDeferRedraw() noexcept
+{
+    auto* pRenderer = ServiceLocator::LocateGlobals().pRender;
+    if (pRenderer != nullptr)
+    {
+        pRenderer->StartDeferRedraw();
+    }
+}
+
+void ScreenBufferRenderTarget::EndDeferRedraw() noexcept
+{
+    auto* pRenderer = ServiceLocator::LocateGlobals().pRender;
+    if (pRenderer != nullptr)
+    {
+        pRenderer->EndDeferRedraw();
+    }
+}
+
+// Like deferring cursor redraws, a synchronized update outlasts switching buffers.
+void ScreenBufferRenderTarget::SetSynchronizedOutput(const bool enabled) noexcept
+{
+    auto* pRenderer = ServiceLocator::LocateGlobals().pRender;
+    if (pRenderer != nullptr)
+    {
+        pRenderer->SetSynchronizedOutput(enabled);
+    }
+}
+
 void ScreenBufferRenderTarget::TriggerRedrawAll()
 {
     auto* pRenderer = ServiceLocator::LocateGlobals().pRender;
@@ -72,14 +72,13 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 
     try
     {
-        std::wstring wstr{};
-        auto hr = til::u8u16(u8Str, wstr, _u8State);
+        auto hr = til::u8u16(u8Str, _wstr, _u8State);
         // If we hit a parsing error, eat it. It's bad utf-8, we can't do anything with it.
         if (FAILED(hr))
         {
             return S_FALSE;
         }
-        _pInputStateMachine->ProcessString(wstr);
+        _pInputStateMachine->ProcessString(_wstr);
     }
     CATCH_RETURN();
 
@@ -108,9 +107,35 @@ DWORD WINAPI VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    char buffer[256];
+    if (_buffer.empty())
+    {
+        _buffer.resize(MinimumBufferSize);
+    }
+
     DWORD dwRead = 0;
-    bool fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
+    bool fSuccess = !!ReadFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), &dwRead, nullptr);
+
+    // If the read filled the buffer, we're likely in the middle of a paste.
+    // Whatever else is already waiting in the pipe gets read right away as
+    // well, so that it's parsed and written to the input buffer in one go,
+    // instead of in one lock/parse/write round trip per small read.
+    DWORD dwAvailable = 0;
+    if (fSuccess &&
+        dwRead == _buffer.size() &&
+        PeekNamedPipe(_hFile.get(), nullptr, 0, nullptr, &dwAvailable, nullptr) &&
+        dwAvailable != 0)
+    {
+        _buffer.resize(std::min<size_t>(std::max(_buffer.size() * 2, dwRead + size_t{ dwAvailable }), MaximumBufferSize));
+
+        // If this read fails, the input we already have is still processed.
+        // The next read will run into the same error and handle it.
+        DWORD dwReadMore = 0;
+        const auto toRead = std::min<size_t>(_buffer.size() - dwRead, dwAvailable);
+        if (ReadFile(_hFile.get(), _buffer.data() + dwRead, gsl::narrow_cast<DWORD>(toRead), &dwReadMore, nullptr))
+        {
+            dwRead += dwReadMore;
+        }
+    }
 
     // If we failed to read because the terminal broke our pipe (usually due
     //      to dying itself), close gracefully with ERROR_BROKEN_PIPE.
@@ -123,7 +148,7 @@ void VtInputThread::DoReadInput(const bool throwOnFail)
         return;
     }
 
-    HRESULT hr = _HandleRunInput({ buffer, gsl::narrow_cast<size_t>(dwRead) });
+    HRESULT hr = _HandleRunInput({ _buffer.data(), gsl::narrow_cast<size_t>(dwRead) });
     if (FAILED(hr))
     {
         if (throwOnFail)
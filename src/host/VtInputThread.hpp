@@ -40,5 +40,12 @@ namespace Microsoft::Console
 
         std::unique_ptr<Microsoft::Console::VirtualTerminal::StateMachine> _pInputStateMachine;
         til::u8state _u8State;
+
+        // Input is read into a buffer that starts small, since it's mostly
+        // typing, and grows while pastes keep filling it up.
+        static constexpr size_t MinimumBufferSize = 256;
+        static constexpr size_t MaximumBufferSize = 64 * 1024;
+        std::vector<char> _buffer;
+        std::wstring _wstr;
     };
 }
@@ -71,6 +71,12 @@ VtIo::VtIo() :
     _lookingForCursorPosition = pArgs->GetInheritCursor();
     _resizeQuirk = pArgs->IsResizeQuirkEnabled();
     _win32InputMode = pArgs->IsWin32InputModeEnabled();
+    _latencyBudget = std::chrono::milliseconds{ pArgs->GetLatencyBudget() };
+    _passthroughMode = pArgs->IsPassthroughModeEnabled();
+    _frameDiff = pArgs->IsFrameDiffEnabled();
+    _repeatCharacters = pArgs->IsRepeatCharactersEnabled();
+    _compressOutput = pArgs->IsOutputCompressionEnabled();
+    _overlappedSignal = pArgs->IsSignalHandleOverlapped();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
@@ -175,6 +181,14 @@ VtIo::VtIo() :
             {
                 _pVtRenderEngine->SetTerminalOwner(this);
                 _pVtRenderEngine->SetResizeQuirk(_resizeQuirk);
+                _pVtRenderEngine->SetLatencyBudget(_latencyBudget);
+                _pVtRenderEngine->SetFrameDiff(_frameDiff);
+                _pVtRenderEngine->SetRepeatCharacters(_repeatCharacters);
+                if (_compressOutput)
+                {
+                    // Without compression, the terminal just gets the output as is.
+                    LOG_IF_FAILED(_pVtRenderEngine->EnableOutputCompression());
+                }
             }
         }
     }
@@ -286,7 +300,7 @@ bool VtIo::IsUsingVt() const
     {
         try
         {
-            _pPtySignalInputThread = std::make_unique<PtySignalInputThread>(std::move(_hSignal));
+            _pPtySignalInputThread = std::make_unique<PtySignalInputThread>(std::move(_hSignal), _overlappedSignal);
 
             // Start it if it was successfully created.
             RETURN_IF_FAILED(_pPtySignalInputThread->Start());
@@ -458,6 +472,128 @@ bool VtIo::IsResizeQuirkEnabled() const
     return _resizeQuirk;
 }
 
+// Method Description:
+// - Returns true if we were started with the `--passthrough` flag. In that
+//   mode, the output of clients that write VT is forwarded to the terminal as
+//   is, instead of being rendered again from our buffer. We still process it,
+//   so that our buffer stays in sync for the console APIs that read from it.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff passthrough mode is enabled.
+bool VtIo::IsPassthroughModeEnabled() const noexcept
+{
+    return _passthroughMode && _pVtRenderEngine;
+}
+
+// Method Description:
+// - Returns true while we're processing output that's being passed through.
+//   Replies to queries (like DSR) are written by the terminal then, so we
+//   mustn't write our own.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we're between BeginPassthrough and EndPassthrough.
+bool VtIo::IsInPassthrough() const noexcept
+{
+    return _inPassthrough;
+}
+
+// Method Description:
+// - Called before processing a string that's going to be passed through to the
+//   terminal. Whatever changes are still waiting to be rendered were made
+//   before this string was written, so they're painted right away. After
+//   that, the vt renderer ignores changes until EndPassthrough is called.
+// - The console lock must be held.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtIo::BeginPassthrough() noexcept
+try
+{
+    if (auto* const pRender = ServiceLocator::LocateGlobals().pRender)
+    {
+        LOG_IF_FAILED(pRender->PaintFrame());
+    }
+    _pVtRenderEngine->BeginPassthrough();
+    _inPassthrough = true;
+}
+CATCH_LOG()
+
+// Method Description:
+// - Called once the string has been processed, to write it to the terminal.
+//   See BeginPassthrough.
+// Arguments:
+// - str - the string that was processed
+// Return Value:
+// - <none>
+void VtIo::EndPassthrough(const std::wstring_view str) noexcept
+try
+{
+    _inPassthrough = false;
+
+    auto& g = ServiceLocator::LocateGlobals();
+    // Catch up with any viewport movement that we haven't been told about
+    // yet. The terminal has already scrolled, so the vt renderer ignores it.
+    if (g.pRender)
+    {
+        g.pRender->TriggerScroll();
+    }
+
+    const auto& screenInfo = g.getConsoleInformation().GetActiveOutputBuffer();
+    const auto& textBuffer = screenInfo.GetTextBuffer();
+    auto cursor = textBuffer.GetCursor().GetPosition();
+    screenInfo.GetViewport().ConvertToOrigin(&cursor);
+
+    LOG_IF_FAILED(_pVtRenderEngine->EndPassthrough(str, cursor, textBuffer.GetCurrentAttributes()));
+}
+CATCH_LOG()
+
+// Method Description:
+// - Called when the client starts or ends a synchronized update (DECSET 2026),
+//   so that the vt renderer brackets the frame that contains it for the terminal.
+// Arguments:
+// - enabled - true at the start of an update, false at its end.
+// Return Value:
+// - <none>
+void VtIo::SetSynchronizedOutput(const bool enabled) noexcept
+{
+    if (_pVtRenderEngine)
+    {
+        _pVtRenderEngine->SetSynchronizedOutput(enabled);
+    }
+}
+
+// Method Description:
+// - Paints the given region of the viewport again, because the terminal asked
+//   us to. The terminal might not display what we've sent any longer, so
+//   nothing in the region is skipped for having been sent before.
+// - The console lock must be held.
+// Arguments:
+// - region - the inclusive region to repaint, relative to the viewport
+// Return Value:
+// - <none>
+void VtIo::RepaintRegion(const SMALL_RECT region) noexcept
+try
+{
+    auto* const pRender = ServiceLocator::LocateGlobals().pRender;
+    if (!_pVtRenderEngine || !pRender || region.Left > region.Right || region.Top > region.Bottom)
+    {
+        return;
+    }
+
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto viewport = gci.GetActiveOutputBuffer().GetViewport();
+    const auto dirty = Viewport::Intersect(viewport, viewport.ConvertFromOrigin(Viewport::FromInclusive(region)));
+    if (dirty.IsValid())
+    {
+        _pVtRenderEngine->ForgetSentCells();
+        pRender->TriggerRedraw(dirty);
+    }
+}
+CATCH_LOG()
+
 // Method Description:
 // - Manually tell the renderer that it should emit a "Erase Scrollback"
 //   sequence to the connected terminal. We need to do this in certain cases
@@ -48,6 +48,14 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool IsResizeQuirkEnabled() const;
 
+        bool IsPassthroughModeEnabled() const noexcept;
+        bool IsInPassthrough() const noexcept;
+        void BeginPassthrough() noexcept;
+        void EndPassthrough(const std::wstring_view str) noexcept;
+        void SetSynchronizedOutput(const bool enabled) noexcept;
+
+        void RepaintRegion(const SMALL_RECT region) noexcept;
+
         [[nodiscard]] HRESULT ManuallyClearScrollback() const noexcept;
 
     private:
@@ -66,6 +74,13 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _resizeQuirk{ false };
         bool _win32InputMode{ false };
+        std::chrono::milliseconds _latencyBudget{ 0 };
+        bool _passthroughMode{ false };
+        bool _frameDiff{ false };
+        bool _repeatCharacters{ false };
+        bool _compressOutput{ false };
+        bool _overlappedSignal{ false };
+        bool _inPassthrough{ false };
 
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
         std::unique_ptr<Microsoft::Console::VtInputThread> _pVtInputThread;
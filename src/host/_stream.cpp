@@ -140,12 +140,12 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         //      new rows at the bottom.
         // If we do this, then the viewport is now one line higher than it used
         //      to be, so it needs to move down by one less line.
-        for (auto i = 0; i < newRows; i++)
+        if (newRows > 0)
         {
-            screenInfo.GetTextBuffer().IncrementCircularBuffer();
-            moveToYPosition--;
-            newViewTop--;
-            scrollRect.Top--;
+            screenInfo.GetTextBuffer().IncrementCircularBuffer(gsl::narrow_cast<size_t>(newRows), false);
+            moveToYPosition -= newRows;
+            newViewTop -= newRows;
+            scrollRect.Top -= newRows;
         }
 
         const COORD newPostMarginsOrigin = { 0, moveToYPosition };
@@ -390,6 +390,25 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         wchar_t* LocalBufPtr = LocalBuffer;
         while (*pcb < BufferSize && i < LOCAL_BUFFER_SIZE && XPosition < coordScreenBufferSize.X)
         {
+            // Most of the output of legacy clients is plain ASCII text. The run of it up to the
+            // next control character (or the end of the row) is found with a vectorized scan
+            // and collected all at once, instead of looking at its characters one by one.
+            const auto maxRun = std::min({ (BufferSize - *pcb) / sizeof(WCHAR),
+                                           LOCAL_BUFFER_SIZE - i,
+                                           gsl::narrow_cast<size_t>(coordScreenBufferSize.X - XPosition) });
+            if (const auto run = TextBuffer::MeasurePrintableAscii({ lpString, maxRun }))
+            {
+                std::copy_n(lpString, run, LocalBufPtr);
+                LocalBufPtr += run;
+                XPosition += gsl::narrow_cast<SHORT>(run);
+                i += run;
+                pwchBuffer += run;
+                lpString += run;
+                pwchRealUnicode += run;
+                *pcb += run * sizeof(WCHAR);
+                continue;
+            }
+
 #pragma prefast(suppress : 26019, "Buffer is taken in multiples of 2. Validation is ok.")
             const wchar_t Char = *lpString;
             // WCL-NOTE: We believe RealUnicodeChar to be identical to Char, because we believe pwchRealUnicode
@@ -553,8 +572,17 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
             }
 
             // line was wrapped if we're writing up to the end of the current row
-            OutputCellIterator it(std::wstring_view(LocalBuffer, i), Attributes);
-            const auto itEnd = screenInfo.Write(it);
+            const std::wstring_view text{ LocalBuffer, i };
+            size_t cellsWritten;
+            // Most output is plain ASCII, which can be written without inspecting every single cell.
+            if (TextBuffer::MeasurePrintableAscii(text) == text.size())
+            {
+                cellsWritten = textBuffer.WriteAsciiLine(text, CursorPosition, Attributes);
+            }
+            else
+            {
+                cellsWritten = textBuffer.WriteText(text, CursorPosition, Attributes);
+            }
 
             // Notify accessibility
             if (screenInfo.HasAccessibilityEventing())
@@ -564,7 +592,7 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
 
             // The number of "spaces" or "cells" we have consumed needs to be reported and stored for later
             // when/if we need to erase the command line.
-            TempNumSpaces += itEnd.GetCellDistance(it);
+            TempNumSpaces += cellsWritten;
             // WCL-NOTE: We are using the "estimated" X position delta instead of the actual delta from
             // WCL-NOTE: the iterator. It is not clear why. If they differ, the cursor ends up in the
             // WCL-NOTE: wrong place (typically inside another character).
@@ -814,10 +842,22 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
             pwchBuffer++;
             CursorPosition.X = 0;
             CursorPosition.Y = cursor.GetPosition().Y;
+
+            // A CR that's followed by a LF, like at the end of every line of "text\r\n", is
+            // handled along with the LF, so that the cursor is only adjusted once for both.
+            if (*pcb + sizeof(WCHAR) < BufferSize && lpString[1] == UNICODE_LINEFEED)
+            {
+                *pcb += sizeof(WCHAR);
+                lpString++;
+                pwchRealUnicode++;
+                goto LineFeed;
+            }
+
             Status = AdjustCursorPosition(screenInfo, CursorPosition, (dwFlags & WC_KEEP_CURSOR_VISIBLE) != 0, psScrollY);
             break;
         }
         case UNICODE_LINEFEED:
+        LineFeed:
         {
             // move cursor to the next line.
             pwchBuffer++;
@@ -830,13 +870,34 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
                 CursorPosition.X = 0;
             }
 
-            CursorPosition.Y = (SHORT)(cursor.GetPosition().Y + 1);
+            // Consecutive line feeds move the cursor (and scroll the viewport) all at once. This
+            // stops at the end of the buffer, where every further line feed has to circle it.
+            // With margins, the contents of the margins would have to be scrolled instead.
+            SHORT lineFeeds = 1;
+            if (!screenInfo.AreMarginsSet())
+            {
+                const auto maxLineFeeds = coordScreenBufferSize.Y - cursor.GetPosition().Y;
+                while (lineFeeds < maxLineFeeds &&
+                       *pcb + (lineFeeds + 1) * sizeof(WCHAR) <= BufferSize &&
+                       lpString[lineFeeds] == UNICODE_LINEFEED)
+                {
+                    lineFeeds++;
+                }
+            }
 
+            // since we explicitly just moved down, clear the wrap status on the rows we just came from
+            for (SHORT row = 0; row < lineFeeds; row++)
             {
-                // since we explicitly just moved down a row, clear the wrap status on the row we just came from
-                textBuffer.GetRowByOffset(cursor.GetPosition().Y).SetWrapForced(false);
+                textBuffer.GetRowByOffset(cursor.GetPosition().Y + row).SetWrapForced(false);
             }
 
+            // All line feeds but the last one are consumed here. The last one is consumed below.
+            pwchBuffer += lineFeeds - 1;
+            lpString += lineFeeds - 1;
+            pwchRealUnicode += lineFeeds - 1;
+            *pcb += (lineFeeds - 1) * sizeof(WCHAR);
+
+            CursorPosition.Y = (SHORT)(cursor.GetPosition().Y + lineFeeds);
             Status = AdjustCursorPosition(screenInfo, CursorPosition, (dwFlags & WC_KEEP_CURSOR_VISIBLE) != 0, psScrollY);
             break;
         }
@@ -972,6 +1033,39 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
                 StateMachine& machine = screenInfo.GetStateMachine();
                 size_t const cch = BufferSize / sizeof(WCHAR);
 
+                // In passthrough mode the terminal receives the string as is once
+                // we're done with it. We only process it to keep our buffer in sync.
+                CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+                auto* const pVtIo = gci.IsInVtIoMode() && screenInfo.IsActiveScreenBuffer() ? gci.GetVtIo() : nullptr;
+                const bool passthrough = pVtIo && pVtIo->IsPassthroughModeEnabled();
+                if (passthrough)
+                {
+                    pVtIo->BeginPassthrough();
+                }
+                // This is declared before endDefer, so that the deferred cursor
+                // redraw is still ignored by the vt renderer.
+                auto endPassthrough = wil::scope_exit([&]() noexcept {
+                    if (passthrough)
+                    {
+                        pVtIo->EndPassthrough({ pwchRealUnicode, cch });
+                    }
+                });
+
+                // A single write usually contains a whole batch of cursor movements
+                // (e.g. an app redrawing its screen), but only the final cursor position
+                // is going to be painted. The renderer outlives any of the screen buffers.
+                auto* const pRender = ServiceLocator::LocateGlobals().pRender;
+                if (pRender)
+                {
+                    pRender->StartDeferCursorRedraw();
+                }
+                auto endDefer = wil::scope_exit([&]() noexcept {
+                    if (pRender)
+                    {
+                        pRender->EndDeferCursorRedraw();
+                    }
+                });
+
                 machine.ProcessString({ pwchRealUnicode, cch });
                 *pcb += BufferSize;
             }
@@ -1136,9 +1230,15 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
         const auto codepage{ consoleInfo.OutputCP };
         auto leadByteCaptured{ false };
         auto leadByteConsumed{ false };
-        std::wstring wstr{};
+        auto asciiOnly{ false };
         static til::u8state u8State{};
 
+        // Like u8State this is protected by the console lock. It's reused
+        // so that we don't allocate a new string for every write.
+        // WriteData makes a copy of it, should we need to wait.
+        static std::wstring wstr{};
+        wstr.clear();
+
         // Convert our input parameters to Unicode
         if (codepage == CP_UTF8)
         {
@@ -1198,6 +1298,20 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
 
             screenInfo.WriteConsoleDbcsLeadByte[0] = 0;
 
+            // Most legacy applications write nothing but ASCII. In codepages that leave ASCII
+            // as it is, we widen the leading run of it ourselves and MultiByteToWideChar
+            // only needs to be called for whatever follows. Without a stored lead byte the
+            // input starts at a character boundary, so the rest still starts at one too.
+            int asciiLength{};
+            if (!leadByteConsumed && IsAsciiCompatibleCodePage(codepage))
+            {
+                asciiLength = til::details::u8u16_ascii(mbPtr, mbPtrLength, wcPtr);
+                asciiOnly = asciiLength == mbPtrLength;
+                mbPtr += asciiLength;
+                wcPtr += asciiLength;
+                mbPtrLength -= asciiLength;
+            }
+
             // if the last byte in mbPtr is a lead byte for the current code page,
             // save it for the next time this function is called and we can piece it
             // back together then
@@ -1218,7 +1332,7 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
                 mbPtrLength = sizeof(wchar_t) * MultiByteToWideChar(codepage, 0, mbPtr, mbPtrLength, wcPtr, mbPtrLength);
             }
 
-            wstr.resize((dbcsLength + mbPtrLength) / sizeof(wchar_t));
+            wstr.resize(asciiLength + (dbcsLength + mbPtrLength) / sizeof(wchar_t));
         }
 
         // Hold the specific version of the waiter locally so we can tinker with it if we have to store additional context.
@@ -1238,11 +1352,19 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
                 size_t mbBufferRead{};
 
                 // Start by counting the number of A bytes we used in printing our W string to the screen.
-                try
+                // For pure ASCII that's just as many as the characters we printed.
+                if (asciiOnly)
                 {
-                    mbBufferRead = GetALengthFromW(codepage, { wstr.data(), wcBufferWritten });
+                    mbBufferRead = wcBufferWritten;
+                }
+                else
+                {
+                    try
+                    {
+                        mbBufferRead = GetALengthFromW(codepage, { wstr.data(), wcBufferWritten });
+                    }
+                    CATCH_LOG();
                 }
-                CATCH_LOG();
 
                 // If we captured a byte off the string this time around up above, it means we didn't feed
                 // it into the WriteConsoleW above, and therefore its consumption isn't accounted for
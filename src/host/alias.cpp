@@ -49,6 +49,31 @@ std::unordered_map<std::wstring,
                    case_insensitive_equality>
     g_aliasData;
 
+// An alias with its target parsed ahead of time. The fixed macros ($L, $G, $B and $T)
+// are already replaced in the literal text, which leaves only the argument macros
+// ($1-$9 and $*) to be substituted when the alias is used.
+struct CompiledAlias
+{
+    struct Argument
+    {
+        size_t offset; // The position in literals that the argument goes to.
+        wchar_t macro; // L'1'-L'9' or L'*'
+    };
+
+    std::wstring name; // Case folded.
+    std::wstring literals;
+    std::vector<Argument> arguments;
+    size_t lineCount = 0;
+};
+
+// The aliases of each exe, sorted by name. They're compiled when they're first
+// looked up and dropped whenever the aliases of the exe change.
+std::unordered_map<std::wstring,
+                   std::vector<CompiledAlias>,
+                   case_insensitive_hash,
+                   case_insensitive_equality>
+    g_compiledAliasData;
+
 // Routine Description:
 // - Adds a command line alias to the global set.
 // - Converts and calls the W version of this function.
@@ -116,6 +141,8 @@ std::unordered_map<std::wstring,
             // Map will auto-create each level as necessary
             g_aliasData[exeNameString][sourceString] = targetString;
         }
+
+        g_compiledAliasData.erase(exeNameString);
     }
     CATCH_RETURN();
 
@@ -422,6 +449,7 @@ void Alias::s_ClearCmdExeAliases()
     if (exeIter != g_aliasData.end())
     {
         exeIter->second.clear();
+        g_compiledAliasData.erase(exeIter->first);
     }
 }
 
@@ -821,44 +849,46 @@ void Alias::s_ClearCmdExeAliases()
 // - Trims leading spaces off of a string
 // Arguments:
 // - str - String to trim
-void Alias::s_TrimLeadingSpaces(std::wstring& str)
+void Alias::s_TrimLeadingSpaces(std::wstring_view& str) noexcept
 {
-    // Erase from the beginning of the string up until the first
+    // Skip from the beginning of the string up until the first
     // character found that is not a space.
-    str.erase(str.begin(),
-              std::find_if(str.begin(), str.end(), [](wchar_t ch) { return !std::iswspace(ch); }));
+    const auto firstNonSpace = std::find_if(str.begin(), str.end(), [](wchar_t ch) { return !std::iswspace(ch); });
+    str.remove_prefix(firstNonSpace - str.begin());
 }
 
 // Routine Description:
 // - Trims trailing \r\n off of a string
 // Arguments:
 // - str - String to trim
-void Alias::s_TrimTrailingCrLf(std::wstring& str)
+void Alias::s_TrimTrailingCrLf(std::wstring_view& str) noexcept
 {
     const auto trailingCrLfPos = str.find_last_of(UNICODE_CARRIAGERETURN);
-    if (std::wstring::npos != trailingCrLfPos)
+    if (std::wstring_view::npos != trailingCrLfPos)
     {
-        str.erase(trailingCrLfPos);
+        str = str.substr(0, trailingCrLfPos);
     }
 }
 
 // Routine Description:
-// - Tokenizes a string into a collection using space as a separator
+// - Tokenizes a string using space as a separator
 // Arguments:
 // - str - String to tokenize
+// - tokens - Receives the first MaxTokens tokens, which point into str
 // Return Value:
-// - Collection of tokenized strings
-std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
+// - The number of tokens stored in tokens
+size_t Alias::s_Tokenize(const std::wstring_view str,
+                         std::array<std::wstring_view, MaxTokens>& tokens) noexcept
 {
-    std::deque<std::wstring> result;
+    size_t count = 0;
 
     size_t prevIndex = 0;
     auto spaceIndex = str.find(L' ');
-    while (std::wstring::npos != spaceIndex)
+    while (std::wstring_view::npos != spaceIndex && count < tokens.size() - 1)
     {
         const auto length = spaceIndex - prevIndex;
 
-        result.emplace_back(str.substr(prevIndex, length));
+        til::at(tokens, count++) = str.substr(prevIndex, length);
 
         spaceIndex++;
         prevIndex = spaceIndex;
@@ -866,10 +896,11 @@ std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
         spaceIndex = str.find(L' ', spaceIndex);
     }
 
-    // Place the final one into the set.
-    result.emplace_back(str.substr(prevIndex));
+    // Place the final one into the set. Any further tokens are never
+    // referred to, so it doesn't matter that they aren't split off.
+    til::at(tokens, count++) = str.substr(prevIndex, spaceIndex == std::wstring_view::npos ? std::wstring_view::npos : spaceIndex - prevIndex);
 
-    return result;
+    return count;
 }
 
 // Routine Description:
@@ -879,20 +910,19 @@ std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
 // - str - String to split into just args
 // Return Value:
 // - Only the arguments part of the string or empty if there are no arguments.
-std::wstring Alias::s_GetArgString(const std::wstring& str)
+std::wstring_view Alias::s_GetArgString(const std::wstring_view str) noexcept
 {
-    std::wstring result;
     auto firstSpace = str.find_first_of(L' ');
-    if (std::wstring::npos != firstSpace)
+    if (std::wstring_view::npos != firstSpace)
     {
         firstSpace++;
         if (firstSpace < str.size())
         {
-            result = str.substr(firstSpace);
+            return str.substr(firstSpace);
         }
     }
 
-    return result;
+    return {};
 }
 
 // Routine Description:
@@ -907,7 +937,7 @@ std::wstring Alias::s_GetArgString(const std::wstring& str)
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::deque<std::wstring>& tokens)
+                                         const gsl::span<const std::wstring_view> tokens)
 {
     if (ch >= L'1' && ch <= L'9')
     {
@@ -916,7 +946,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 
         if (index < tokens.size() && index > 0)
         {
-            appendToStr.append(tokens[index]);
+            appendToStr.append(til::at(tokens, index));
         }
 
         return true;
@@ -937,7 +967,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::wstring fullArgString)
+                                         const std::wstring_view fullArgString)
 {
     if (L'*' == ch)
     {
@@ -1049,58 +1079,46 @@ void Alias::s_AppendCrLf(std::wstring& appendToStr,
 }
 
 // Routine Description:
-// - Searches through the given string for macros and replaces them
-//   with the matching action
+// - Parses the target of an alias into its literal text and the argument macros
+//   that need to be substituted into it whenever the alias is used.
 // Arguments:
-// - str - On input, the string to search. On output, the string is replaced.
-// - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
-// - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - alias - The name of the alias
+// - target - The text the alias expands to
 // Return Value:
-// - The number of commands in the final string (line feeds, CRLFs)
-size_t Alias::s_ReplaceMacros(std::wstring& str,
-                              const std::deque<std::wstring>& tokens,
-                              const std::wstring& fullArgString)
+// - The compiled alias
+CompiledAlias Alias::s_CompileAlias(const std::wstring_view alias,
+                                    const std::wstring_view target)
 {
-    size_t lineCount = 0;
-    std::wstring finalText;
+    CompiledAlias compiled;
+    compiled.name = alias;
+    std::transform(compiled.name.begin(), compiled.name.end(), compiled.name.begin(), towlower);
+
+    auto& literals = compiled.literals;
+    literals.reserve(target.size() + 2);
 
     // The target text may contain substitution macros indicated by $.
-    // Walk through and substitute them as appropriate.
-    for (auto ch = str.cbegin(); ch < str.cend(); ch++)
+    // Walk through and substitute the ones that don't depend on the arguments.
+    for (auto ch = target.cbegin(); ch < target.cend(); ch++)
     {
         if (L'$' == *ch)
         {
             // Attempt to read ahead by one character.
             const auto chNext = ch + 1;
 
-            if (chNext < str.cend())
+            if (chNext < target.cend())
             {
-                auto isProcessed = s_TryReplaceNumberedArgMacro(*chNext, finalText, tokens);
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceWildcardArgMacro(*chNext, finalText, fullArgString);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceInputRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceOutputRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
+                if ((*chNext >= L'1' && *chNext <= L'9') || L'*' == *chNext)
                 {
-                    isProcessed = s_TryReplacePipeRedirMacro(*chNext, finalText);
+                    compiled.arguments.push_back({ literals.size(), *chNext });
                 }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceNextCommandMacro(*chNext, finalText, lineCount);
-                }
-                if (!isProcessed)
+                else if (!s_TryReplaceInputRedirMacro(*chNext, literals) &&
+                         !s_TryReplaceOutputRedirMacro(*chNext, literals) &&
+                         !s_TryReplacePipeRedirMacro(*chNext, literals) &&
+                         !s_TryReplaceNextCommandMacro(*chNext, literals, compiled.lineCount))
                 {
                     // If nothing matches, just push these two characters in.
-                    finalText.push_back(*ch);
-                    finalText.push_back(*chNext);
+                    literals.push_back(*ch);
+                    literals.push_back(*chNext);
                 }
 
                 // Since we read ahead and used that character,
@@ -1110,93 +1128,148 @@ size_t Alias::s_ReplaceMacros(std::wstring& str,
             else
             {
                 // If no read-ahead, just push this character and be done.
-                finalText.push_back(*ch);
+                literals.push_back(*ch);
             }
         }
         else
         {
             // If it didn't match the macro specifier $, push the character.
-            finalText.push_back(*ch);
+            literals.push_back(*ch);
         }
     }
 
     // We always terminate with a CRLF to symbolize end of command.
-    s_AppendCrLf(finalText, lineCount);
+    s_AppendCrLf(literals, compiled.lineCount);
+
+    return compiled;
+}
+
+// Routine Description:
+// - Looks up an alias of the given exe, compiling the aliases of the exe first
+//   if they changed since the last lookup.
+// Arguments:
+// - exeName - The name of the EXE that has aliases associated
+// - alias - The name of the alias, in any case
+// Return Value:
+// - The alias or nullptr if there is none
+const CompiledAlias* Alias::s_FindAlias(const std::wstring& exeName,
+                                        const std::wstring_view alias)
+{
+    auto compiledIter = g_compiledAliasData.find(exeName);
+    if (compiledIter == g_compiledAliasData.end())
+    {
+        const auto exeIter = g_aliasData.find(exeName);
+        if (exeIter == g_aliasData.end())
+        {
+            return nullptr;
+        }
+
+        std::vector<CompiledAlias> compiled;
+        compiled.reserve(exeIter->second.size());
+        for (const auto& [source, target] : exeIter->second)
+        {
+            if (!target.empty())
+            {
+                compiled.emplace_back(s_CompileAlias(source, target));
+            }
+        }
+        std::sort(compiled.begin(), compiled.end(), [](const auto& lhs, const auto& rhs) { return lhs.name < rhs.name; });
+
+        compiledIter = g_compiledAliasData.emplace(exeIter->first, std::move(compiled)).first;
+    }
 
-    // Give back the final text and count.
-    str.swap(finalText);
-    return lineCount;
+    // The names are already case folded, so folding them again is a no-op.
+    // This compares the alias without having to make a folded copy of it.
+    const auto less = [](const wchar_t lhs, const wchar_t rhs) { return towlower(lhs) < towlower(rhs); };
+    const auto equal = [](const wchar_t lhs, const wchar_t rhs) { return towlower(lhs) == towlower(rhs); };
+
+    const auto& aliases = compiledIter->second;
+    const auto it = std::lower_bound(aliases.begin(), aliases.end(), alias, [&](const CompiledAlias& compiled, const std::wstring_view name) {
+        return std::lexicographical_compare(compiled.name.begin(), compiled.name.end(), name.begin(), name.end(), less);
+    });
+    if (it == aliases.end() ||
+        !std::equal(it->name.begin(), it->name.end(), alias.begin(), alias.end(), equal))
+    {
+        return nullptr;
+    }
+    return &*it;
 }
 
 // Routine Description:
 // - Takes the source text and searches it for an alias belonging to exe name's list.
+//   If there is one, its expansion is written to the given string.
 // Arguments:
 // - sourceText - The string to search for an alias
 // - exeName - The name of the EXE that has aliases associated
+// - expansion - On output, the processed data if we found a matching alias.
+//   Its buffer is reused, so that callers can keep it around between calls.
 // - lineCount - Number of lines worth of text processed.
 // Return Value:
-// - If we found a matching alias, this will be the processed data
-//   and lineCount is updated to the new number of lines.
-// - If we didn't match and process an alias, return an empty string.
-std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
-                                        const std::wstring& exeName,
-                                        size_t& lineCount)
+// - True if we found a matching alias, and expansion and lineCount were updated.
+bool Alias::s_MatchAndExpandAlias(const std::wstring_view sourceText,
+                                  const std::wstring& exeName,
+                                  std::wstring& expansion,
+                                  size_t& lineCount)
 {
-    // Copy source text into a local for manipulation.
-    std::wstring sourceCopy(sourceText);
+    auto source = sourceText;
 
-    // Trim trailing \r\n off of sourceCopy if it has one.
-    s_TrimTrailingCrLf(sourceCopy);
+    // Trim trailing \r\n off of source if it has one.
+    s_TrimTrailingCrLf(source);
 
-    // Trim leading spaces off of sourceCopy if it has any.
-    s_TrimLeadingSpaces(sourceCopy);
+    // Trim leading spaces off of source if it has any.
+    s_TrimLeadingSpaces(source);
 
-    // Check if we have an EXE in the list that matches the request first.
-    auto exeIter = g_aliasData.find(exeName);
-    if (exeIter == g_aliasData.end())
-    {
-        // We found no data for this exe. Give back an empty string.
-        return std::wstring();
-    }
+    // Tokenize the text by spaces. The first token is the alias.
+    std::array<std::wstring_view, MaxTokens> tokens;
+    const auto tokenCount = s_Tokenize(source, tokens);
 
-    auto exeList = exeIter->second;
-    if (exeList.size() == 0)
+    const auto alias = s_FindAlias(exeName, til::at(tokens, 0));
+    if (!alias)
     {
-        // If there's no match, give back an empty string.
-        return std::wstring();
+        return false;
     }
 
-    // Tokenize the text by spaces
-    const auto tokens = s_Tokenize(sourceCopy);
+    // Get the string of all parameters as a shorthand for $*.
+    const auto allParams = s_GetArgString(source);
+    const gsl::span<const std::wstring_view> arguments{ tokens.data(), tokenCount };
 
-    // If there are no tokens, return an empty string
-    if (tokens.size() == 0)
+    // The final text is the literal text with the arguments inserted into it.
+    expansion.clear();
+    size_t literalStart = 0;
+    for (const auto& argument : alias->arguments)
     {
-        return std::wstring();
+        expansion.append(alias->literals, literalStart, argument.offset - literalStart);
+        if (!s_TryReplaceNumberedArgMacro(argument.macro, expansion, arguments))
+        {
+            s_TryReplaceWildcardArgMacro(argument.macro, expansion, allParams);
+        }
+        literalStart = argument.offset;
     }
+    expansion.append(alias->literals, literalStart);
 
-    // Find alias. If there isn't one, return an empty string
-    const auto alias = tokens.front();
-    const auto aliasIter = exeList.find(alias);
-    if (aliasIter == exeList.end())
-    {
-        // We found no alias pair with this name. Give back an empty string.
-        return std::wstring();
-    }
+    lineCount = alias->lineCount;
+    return true;
+}
 
-    const auto target = aliasIter->second;
-    if (target.size() == 0)
+// Routine Description:
+// - Takes the source text and searches it for an alias belonging to exe name's list.
+// Arguments:
+// - sourceText - The string to search for an alias
+// - exeName - The name of the EXE that has aliases associated
+// - lineCount - Number of lines worth of text processed.
+// Return Value:
+// - If we found a matching alias, this will be the processed data
+//   and lineCount is updated to the new number of lines.
+// - If we didn't match and process an alias, return an empty string.
+std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
+                                        const std::wstring& exeName,
+                                        size_t& lineCount)
+{
+    std::wstring finalText;
+    if (!s_MatchAndExpandAlias(sourceText, exeName, finalText, lineCount))
     {
         return std::wstring();
     }
-
-    // Get the string of all parameters as a shorthand for $* later.
-    const auto allParams = s_GetArgString(sourceCopy);
-
-    // The final text will be the target but with macros replaced.
-    std::wstring finalText(target);
-    lineCount = s_ReplaceMacros(finalText, tokens, allParams);
-
     return finalText;
 }
 
@@ -1223,13 +1296,13 @@ void Alias::s_MatchAndCopyAliasLegacy(_In_reads_bytes_(cbSource) PCWCH pwchSourc
 {
     try
     {
-        std::wstring sourceText(pwchSource, cbSource / sizeof(WCHAR));
+        // Aliases are matched while the console is locked, for every line of a cooked read.
+        // Reusing the buffer of the expansion keeps that from allocating.
+        static std::wstring targetText;
         size_t lineCount = lines;
 
-        const auto targetText = s_MatchAndCopyAlias(sourceText, exeName, lineCount);
-
-        // Only return data if the reply was non-empty (we had a match).
-        if (!targetText.empty())
+        // Only return data if we had a match.
+        if (s_MatchAndExpandAlias({ pwchSource, cbSource / sizeof(WCHAR) }, exeName, targetText, lineCount))
         {
             const auto cchTargetSize = cbTargetSize / sizeof(wchar_t);
 
@@ -1259,11 +1332,13 @@ void Alias::s_TestAddAlias(std::wstring& exe,
                            std::wstring& target)
 {
     g_aliasData[exe][alias] = target;
+    g_compiledAliasData.erase(exe);
 }
 
 void Alias::s_TestClearAliases()
 {
     g_aliasData.clear();
+    g_compiledAliasData.clear();
 }
 
 #endif
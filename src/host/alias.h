@@ -11,6 +11,8 @@ Abstract:
 --*/
 #pragma once
 
+struct CompiledAlias;
+
 class Alias
 {
 public:
@@ -29,20 +31,30 @@ public:
                                             size_t& lineCount);
 
 private:
-    static void s_TrimLeadingSpaces(std::wstring& str);
-    static void s_TrimTrailingCrLf(std::wstring& str);
-    static std::deque<std::wstring> s_Tokenize(const std::wstring& str);
-    static std::wstring s_GetArgString(const std::wstring& str);
-    static size_t s_ReplaceMacros(std::wstring& str,
-                                  const std::deque<std::wstring>& tokens,
-                                  const std::wstring& fullArgString);
+    // The alias itself and the arguments that $1-$9 can refer to.
+    static constexpr size_t MaxTokens = 10;
+
+    static bool s_MatchAndExpandAlias(const std::wstring_view sourceText,
+                                      const std::wstring& exeName,
+                                      std::wstring& expansion,
+                                      size_t& lineCount);
+    static const CompiledAlias* s_FindAlias(const std::wstring& exeName,
+                                            const std::wstring_view alias);
+    static CompiledAlias s_CompileAlias(const std::wstring_view alias,
+                                        const std::wstring_view target);
+
+    static void s_TrimLeadingSpaces(std::wstring_view& str) noexcept;
+    static void s_TrimTrailingCrLf(std::wstring_view& str) noexcept;
+    static size_t s_Tokenize(const std::wstring_view str,
+                             std::array<std::wstring_view, MaxTokens>& tokens) noexcept;
+    static std::wstring_view s_GetArgString(const std::wstring_view str) noexcept;
 
     static bool s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::deque<std::wstring>& tokens);
+                                             const gsl::span<const std::wstring_view> tokens);
     static bool s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::wstring fullArgString);
+                                             const std::wstring_view fullArgString);
 
     static bool s_TryReplaceInputRedirMacro(const wchar_t ch,
                                             std::wstring& appendToStr);
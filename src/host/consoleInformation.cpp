@@ -4,6 +4,7 @@
 #include "precomp.h"
 #include <intsafe.h>
 
+#include "getset.h"
 #include "misc.h"
 #include "output.h"
 #include "srvinit.h"
@@ -11,6 +12,7 @@
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../types/inc/convert.hpp"
 
+#include <til/seqlock.h>
 #include <til/ticket_lock.h>
 
 using Microsoft::Console::Interactivity::ServiceLocator;
@@ -59,6 +61,48 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
 static thread_local ULONG recursionCount = 0;
 static til::ticket_lock lock;
 
+// Read-only APIs like GetConsoleScreenBufferInfoEx are answered from apiSnapshot instead
+// of waiting for the lock while someone else holds it, as long as the snapshot reflects the
+// state of the console as of the last time the lock was released. lockGeneration counts these releases. It starts
+// at 1, so that the initial, empty snapshot is never mistaken for a valid one.
+// The snapshot is only updated while readers keep asking for it (snapshotWanted),
+// so that a console that isn't polled doesn't pay for it on every release.
+static std::atomic<uint64_t> lockGeneration{ 1 };
+static std::atomic<bool> snapshotWanted{ false };
+static til::seqlock<ConsoleApiSnapshot> apiSnapshot;
+
+// Routine Description:
+// - Updates apiSnapshot, if a reader asked for it, right before the lock is released.
+// - The console lock must be held.
+static void PublishApiSnapshot() noexcept
+try
+{
+    if (!snapshotWanted.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    snapshotWanted.store(false, std::memory_order_relaxed);
+
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (!gci.HasActiveOutputBuffer() || !gci.pInputBuffer)
+    {
+        return;
+    }
+
+    const auto& activeBuffer = gci.GetActiveOutputBuffer().GetActiveBuffer();
+
+    ConsoleApiSnapshot snapshot{};
+    snapshot.generation = lockGeneration.load(std::memory_order_relaxed) + 1;
+    snapshot.mainBuffer = &activeBuffer.GetMainBuffer();
+    snapshot.activeBuffer = &activeBuffer;
+    snapshot.inputBuffer = gci.pInputBuffer;
+    snapshot.inputMode = DoSrvGetConsoleInputMode(*gci.pInputBuffer);
+    snapshot.outputMode = activeBuffer.OutputMode;
+    DoSrvGetConsoleScreenBufferInfo(activeBuffer, snapshot.screenBufferInfo);
+    apiSnapshot.store(snapshot);
+}
+CATCH_LOG()
+
 bool CONSOLE_INFORMATION::IsConsoleLocked()
 {
     return recursionCount != 0;
@@ -79,11 +123,20 @@ void CONSOLE_INFORMATION::LockConsole()
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::UnlockConsole()
 {
+    // This is done before decrementing recursionCount, as the snapshot
+    // is gathered with functions that lock the console recursively.
+    if (recursionCount == 1)
+    {
+        PublishApiSnapshot();
+    }
+
     // See description of recursionCount a few lines above.
     const auto rc = --recursionCount;
     FAIL_FAST_IF(rc == ULONG_MAX);
     if (rc == 0)
     {
+        // Only ever written to under the lock.
+        lockGeneration.store(lockGeneration.load(std::memory_order_relaxed) + 1, std::memory_order_release);
         lock.unlock();
     }
 }
@@ -93,6 +146,36 @@ ULONG CONSOLE_INFORMATION::GetCSRecursionCount()
     return recursionCount;
 }
 
+// Routine Description:
+// - Gets the state most often queried by read-only APIs without waiting for the console lock.
+// - This only succeeds if another thread holds the lock and nothing released the lock since the
+//   snapshot was taken. The snapshot is then exactly what the caller would've seen had it waited
+//   for whoever holds the lock right now. The caller needs to check that it applies to its buffer.
+// - If the lock is free, taking it is cheap and callers see the current state instead.
+//   It also always fails on threads that hold the lock, as they may have changed the state already.
+// Arguments:
+// - snapshot - Receives the snapshot
+// Return Value:
+// - true if the snapshot is valid and can be used in place of the current state.
+bool CONSOLE_INFORMATION::TryGetApiSnapshot(ConsoleApiSnapshot& snapshot) noexcept
+{
+    // Readers keep asking for the snapshot to be updated, even if the current one is valid,
+    // so that it's up to date the next time they poll, too. Failing readers take the lock,
+    // which refreshes the snapshot when they release it.
+    if (!snapshotWanted.load(std::memory_order_relaxed))
+    {
+        snapshotWanted.store(true, std::memory_order_relaxed);
+    }
+
+    if (recursionCount != 0 || !lock.is_contended())
+    {
+        return false;
+    }
+
+    const auto generation = lockGeneration.load(std::memory_order_acquire);
+    return apiSnapshot.try_load(snapshot) && snapshot.generation == generation;
+}
+
 // Routine Description:
 // - This routine allocates and initialized a console and its associated
 //   data - input buffer and screen buffer.
@@ -162,24 +162,30 @@ _Ret_range_(0, cbAnsi)
                                 _Out_ std::unique_ptr<IInputEvent>& partialEvent)
 {
     const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    PWCHAR const TmpUni = new (std::nothrow) WCHAR[cchUnicode];
-    if (TmpUni == nullptr)
-    {
-        return 0;
-    }
-
-    memcpy(TmpUni, pwchUnicode, cchUnicode * sizeof(WCHAR));
+    const auto asciiCompatible = IsAsciiCompatibleCodePage(gci.CP);
 
     BYTE AsciiDbcs[2];
     AsciiDbcs[1] = 0;
 
-    ULONG i, j;
-    for (i = 0, j = 0; i < cchUnicode && j < cbAnsi; i++, j++)
+    ULONG i = 0, j = 0;
+
+    // Most of what's read is ASCII. In codepages that leave ASCII as it is, we narrow
+    // the leading run of it ourselves instead of calling ConvertToOem for each character.
+    if (asciiCompatible)
     {
-        if (IsGlyphFullWidth(TmpUni[i]))
+        i = j = gsl::narrow_cast<ULONG>(til::details::u16u8_ascii(pwchUnicode, gsl::narrow_cast<int>(std::min(cchUnicode, cbAnsi)), pchAnsi));
+    }
+
+    for (; i < cchUnicode && j < cbAnsi; i++, j++)
+    {
+        if (asciiCompatible && pwchUnicode[i] < 0x80)
+        {
+            pchAnsi[j] = static_cast<char>(pwchUnicode[i]);
+        }
+        else if (IsGlyphFullWidth(pwchUnicode[i]))
         {
             ULONG const NumBytes = sizeof(AsciiDbcs);
-            ConvertToOem(gci.CP, &TmpUni[i], 1, (LPSTR)&AsciiDbcs[0], NumBytes);
+            ConvertToOem(gci.CP, &pwchUnicode[i], 1, (LPSTR)&AsciiDbcs[0], NumBytes);
             if (IsDBCSLeadByteConsole(AsciiDbcs[0], &gci.CPInfo))
             {
                 if (j < cbAnsi - 1)
@@ -203,7 +209,7 @@ _Ret_range_(0, cbAnsi)
         }
         else
         {
-            ConvertToOem(gci.CP, &TmpUni[i], 1, &pchAnsi[j], 1);
+            ConvertToOem(gci.CP, &pwchUnicode[i], 1, &pchAnsi[j], 1);
         }
     }
 
@@ -224,6 +230,5 @@ _Ret_range_(0, cbAnsi)
         }
     }
 
-    delete[] TmpUni;
     return j;
 }
@@ -742,7 +742,6 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 {
     try
     {
-        const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         const auto& storageBuffer = context.GetActiveBuffer();
         const auto storageSize = storageBuffer.GetBufferSize().Dimensions();
 
@@ -781,40 +780,31 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
         const auto sourcePoint = clippedRequestRectangle.Origin();
 
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        COORD targetPos = { 0 };
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
-
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backing store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        // Copy the clipped request a row span at a time. Each row of it lands at the target
+        // point's column of the corresponding row of the user's buffer, and each run of
+        // identical attributes is only converted to legacy attributes once.
+        // We always make sure that we're writing inside the user's buffer (before the end).
+        const auto& textBuffer = storageBuffer.GetTextBuffer();
+        const auto sourceEnd = gsl::narrow_cast<uint16_t>(clippedRequestRectangle.RightExclusive());
+        for (SHORT y = 0; y < clippedRequestRectangle.Height(); ++y)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
+            auto targetIndex = gsl::narrow_cast<size_t>(targetPoint.Y + y) * targetSize.X + targetPoint.X;
+            const auto& row = textBuffer.GetRowByOffset(sourcePoint.Y + y);
+            for (AttributeRunIterator run{ row, gsl::narrow_cast<uint16_t>(sourcePoint.X), sourceEnd }; run && targetIndex < targetBuffer.size(); ++run)
             {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                sourceIter++;
-            }
-
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            targetIter++;
+                const auto legacyAttributes = run->attr.GetLegacyAttributes();
+                for (const auto& cell : run->cells)
+                {
+                    if (targetIndex >= targetBuffer.size())
+                    {
+                        break;
+                    }
 
-            // Increment the target
-            targetPos.X++;
-            if (targetPos.X >= targetSize.X)
-            {
-                targetPos.X = 0;
-                targetPos.Y++;
+                    // Glyphs that don't fit into a single wchar_t can't be represented in a CHAR_INFO.
+                    auto& charInfo = til::at(targetBuffer, targetIndex++);
+                    charInfo.Char.UnicodeChar = cell.DbcsAttr().IsGlyphStored() ? UNICODE_REPLACEMENT : cell.Char();
+                    charInfo.Attributes = legacyAttributes | cell.DbcsAttr().GeneratePublicApiAttributeFormat();
+                }
             }
         }
 
@@ -872,6 +862,58 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     CATCH_RETURN();
 }
 
+// Routine Description:
+// - Finds the cells of a row that a write of the given cells would actually change.
+//   Blits of whole rectangles (e.g. from double-buffering TUIs) tend to rewrite
+//   mostly the same content, and skipping the unchanged cells saves both the write
+//   and the invalidation of the row.
+// Arguments:
+// - row - The row of the buffer that's about to be written to
+// - column - The column the write starts at
+// - charInfos - The cells that are about to be written
+// Return Value:
+// - The range [begin, end) of charInfos that differs from the row. It's empty if nothing changed.
+static std::pair<size_t, size_t> _FindChangedCells(const ROW& row,
+                                                   const size_t column,
+                                                   const gsl::span<const CHAR_INFO> charInfos)
+{
+    const auto& charRow = row.GetCharRow();
+    const auto rowWidth = charRow.size();
+
+    // ROW::WriteCells pads out trailing bytes written to the first column and leading
+    // bytes written to the last one, which shifts or drops cells. Leave those to a full write.
+    if ((column == 0 && WI_IsFlagSet(charInfos.front().Attributes, COMMON_LVB_TRAILING_BYTE)) ||
+        (column + charInfos.size() == rowWidth && WI_IsFlagSet(charInfos.back().Attributes, COMMON_LVB_LEADING_BYTE)))
+    {
+        return { 0, charInfos.size() };
+    }
+
+    auto begin = charInfos.size();
+    size_t end = 0;
+
+    auto attrIt = row.GetAttrRow().begin();
+    attrIt += gsl::narrow_cast<ptrdiff_t>(column);
+
+    for (size_t i = 0; i < charInfos.size(); ++i, ++attrIt)
+    {
+        const auto& charInfo = til::at(charInfos, i);
+        const auto& dbcsAttr = charRow.DbcsAttrAt(column + i);
+
+        // This mirrors how OutputCellIterator turns a CHAR_INFO into a cell.
+        const auto unchanged = dbcsAttr.IsLeading() == WI_IsFlagSet(charInfo.Attributes, COMMON_LVB_LEADING_BYTE) &&
+                               dbcsAttr.IsTrailing() == (WI_IsFlagClear(charInfo.Attributes, COMMON_LVB_LEADING_BYTE) && WI_IsFlagSet(charInfo.Attributes, COMMON_LVB_TRAILING_BYTE)) &&
+                               std::wstring_view{ charRow.GlyphAt(column + i) } == std::wstring_view{ &charInfo.Char.UnicodeChar, 1 } &&
+                               *attrIt == TextAttribute{ charInfo.Attributes };
+        if (!unchanged)
+        {
+            begin = std::min(begin, i);
+            end = i + 1;
+        }
+    }
+
+    return { std::min(begin, end), end };
+}
+
 [[nodiscard]] static HRESULT _WriteConsoleOutputWImplHelper(SCREEN_INFORMATION& context,
                                                             gsl::span<CHAR_INFO> buffer,
                                                             const Viewport& requestRectangle,
@@ -965,9 +1007,17 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             // Convert to a CHAR_INFO view to fit into the iterator
             const auto charInfos = gsl::span<const CHAR_INFO>(subspan.data(), subspan.size());
 
+            // Only write (and thus invalidate) the cells that actually change.
+            const auto& row = std::as_const(storageBuffer.GetTextBuffer()).GetRowByOffset(target.Y);
+            const auto [begin, end] = _FindChangedCells(row, gsl::narrow_cast<size_t>(target.X), charInfos);
+            if (begin == end)
+            {
+                continue;
+            }
+
             // Make the iterator and write to the target position.
-            OutputCellIterator it(charInfos);
-            storageBuffer.Write(it, target);
+            OutputCellIterator it(charInfos.subspan(begin, end - begin));
+            storageBuffer.Write(it, { gsl::narrow_cast<SHORT>(target.X + begin), target.Y });
         }
 
         // Since we've managed to write part of the request, return the clamped part that we actually used.
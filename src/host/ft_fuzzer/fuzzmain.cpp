@@ -11,8 +11,22 @@
 #include "../../server/IoThread.h"
 #include "../_stream.h"
 #include "../getset.h"
+#include "../../types/inc/AllocationTracking.hpp"
 #include <til/u8u16convert.h>
 
+// The performance mode (see doc/fuzzing.md) feeds every input twice: once
+// repeated until it's at least MinimumUnitLength characters long, and once
+// more ScaleFactor times that. Processing the latter should cost about
+// ScaleFactor times as much. If it costs more than Tolerance times that,
+// the output path is super-linear in the input and the harness aborts.
+static constexpr size_t MinimumUnitLength = 1024;
+static constexpr size_t ScaleFactor = 8;
+static constexpr size_t Tolerance = 4;
+// Below this, the timings are too short to be told apart from noise.
+static constexpr auto MinimumTime = std::chrono::milliseconds(100);
+
+static bool g_performanceMode = false;
+
 struct NullDeviceComm : public IDeviceComm
 {
     HRESULT SetServerInformation(CD_IO_SERVER_INFORMATION* const) const override
@@ -103,6 +117,7 @@ struct NullDeviceComm : public IDeviceComm
 extern "C" __declspec(dllexport) HRESULT RunConhost()
 {
     Microsoft::Console::Interactivity::ServiceLocator::LocateGlobals().hInstance = wil::GetModuleInstanceHandle();
+    g_performanceMode = GetEnvironmentVariableW(L"OPENCONSOLE_FUZZ_PERFORMANCE", nullptr, 0) != 0;
 
     // passing stdin/stdout lets us drive this like conpty (!!) and test the VT renderer (!!)
     // but for now we want to drive it like conhost
@@ -127,23 +142,96 @@ int main(int /*argc*/, char** /*argv*/)
     return 0;
 }
 
-extern "C" __declspec(dllexport) int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+// Writes the text to the active output buffer, through the StateMachine, the AdaptDispatch and the TextBuffer.
+static void WriteToConsole(const std::wstring_view text)
 {
     auto& gci = Microsoft::Console::Interactivity::ServiceLocator::LocateGlobals().getConsoleInformation();
 
-    const auto u16String{ til::u8u16(std::string_view{ reinterpret_cast<const char*>(data), size }) };
     SHORT scrollY{};
-    size_t sizeInBytes{ u16String.size() * 2 };
+    size_t sizeInBytes{ text.size() * 2 };
     gci.LockConsole();
     auto u = wil::scope_exit([&]() { gci.UnlockConsole(); });
     (void)WriteCharsLegacy(gci.GetActiveOutputBuffer(),
-                           u16String.data(),
-                           u16String.data(),
-                           u16String.data(),
+                           text.data(),
+                           text.data(),
+                           text.data(),
                            &sizeInBytes,
                            nullptr,
                            0,
                            WC_PRINTABLE_CONTROL_CHARS | WC_DESTRUCTIVE_BACKSPACE | WC_KEEP_CURSOR_VISIBLE,
                            &scrollY);
+}
+
+struct WriteCost
+{
+    std::chrono::steady_clock::duration time{};
+    uint64_t allocations = 0;
+};
+
+static WriteCost MeasureWrite(const std::wstring_view text)
+{
+    const auto allocations = Microsoft::Console::AllocationTracking::TotalAllocations();
+    const auto start = std::chrono::steady_clock::now();
+    WriteToConsole(text);
+    return { std::chrono::steady_clock::now() - start, Microsoft::Console::AllocationTracking::TotalAllocations() - allocations };
+}
+
+static std::wstring Repeat(const std::wstring_view text, const size_t count)
+{
+    std::wstring result;
+    result.reserve(text.size() * count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        result.append(text);
+    }
+    return result;
+}
+
+// Aborts if processing the input doesn't scale linearly with its length.
+// libFuzzer treats that like any other crash, which means that it saves the
+// input and can minimize it with -minimize_crash=1.
+static void CheckScaling(const std::wstring_view text)
+{
+    if (text.empty())
+    {
+        return;
+    }
+
+    // The second write continues where the first one left off. That's on purpose:
+    // an OSC string that never ends, for instance, keeps growing that way.
+    const auto unit = Repeat(text, (MinimumUnitLength + text.size() - 1) / text.size());
+    const auto small = MeasureWrite(unit);
+    const auto large = MeasureWrite(Repeat(unit, ScaleFactor));
+
+    const auto slow = large.time > MinimumTime && large.time > small.time * (ScaleFactor * Tolerance);
+    // An input that doesn't allocate at all mustn't start allocating a few times either.
+    const auto allocating = large.allocations > (small.allocations + 1) * (ScaleFactor * Tolerance);
+    if (slow || allocating)
+    {
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        fprintf(stderr,
+                "Super-linear output: %zu characters took %lldus and %llu allocations, %zu times as many took %lldus and %llu allocations\n",
+                unit.size(),
+                duration_cast<microseconds>(small.time).count(),
+                small.allocations,
+                ScaleFactor,
+                duration_cast<microseconds>(large.time).count(),
+                large.allocations);
+        abort();
+    }
+}
+
+extern "C" __declspec(dllexport) int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    const auto u16String{ til::u8u16(std::string_view{ reinterpret_cast<const char*>(data), size }) };
+    if (g_performanceMode)
+    {
+        CheckScaling(u16String);
+    }
+    else
+    {
+        WriteToConsole(u16String);
+    }
     return 0;
 }
@@ -32,6 +32,29 @@
 using namespace Microsoft::Console::Types;
 using namespace Microsoft::Console::Interactivity;
 
+// Routine Description:
+// - Computes the console input mode that GetConsoleMode reports for an input buffer.
+// - The console lock must be held.
+// Arguments:
+// - context - The input buffer concerned
+// Return Value:
+// - The mode flags set
+ULONG DoSrvGetConsoleInputMode(const InputBuffer& context)
+{
+    const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto mode = context.InputMode;
+
+    if (WI_IsFlagSet(gci.Flags, CONSOLE_USE_PRIVATE_FLAGS))
+    {
+        WI_SetFlag(mode, ENABLE_EXTENDED_FLAGS);
+        WI_SetFlagIf(mode, ENABLE_INSERT_MODE, gci.GetInsertMode());
+        WI_SetFlagIf(mode, ENABLE_QUICK_EDIT_MODE, WI_IsFlagSet(gci.Flags, CONSOLE_QUICK_EDIT_MODE));
+        WI_SetFlagIf(mode, ENABLE_AUTO_POSITION, WI_IsFlagSet(gci.Flags, CONSOLE_AUTO_POSITION));
+    }
+
+    return mode;
+}
+
 // Routine Description:
 // - Retrieves the console input mode (settings that apply when manipulating the input buffer)
 // Arguments:
@@ -42,19 +65,18 @@ void ApiRoutines::GetConsoleInputModeImpl(InputBuffer& context, ULONG& mode) noe
     try
     {
         Telemetry::Instance().LogApiCall(Telemetry::ApiCall::GetConsoleMode);
-        const CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-        LockConsole();
-        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
-
-        mode = context.InputMode;
 
-        if (WI_IsFlagSet(gci.Flags, CONSOLE_USE_PRIVATE_FLAGS))
+        ConsoleApiSnapshot snapshot;
+        if (CONSOLE_INFORMATION::TryGetApiSnapshot(snapshot) && snapshot.inputBuffer == &context)
         {
-            WI_SetFlag(mode, ENABLE_EXTENDED_FLAGS);
-            WI_SetFlagIf(mode, ENABLE_INSERT_MODE, gci.GetInsertMode());
-            WI_SetFlagIf(mode, ENABLE_QUICK_EDIT_MODE, WI_IsFlagSet(gci.Flags, CONSOLE_QUICK_EDIT_MODE));
-            WI_SetFlagIf(mode, ENABLE_AUTO_POSITION, WI_IsFlagSet(gci.Flags, CONSOLE_AUTO_POSITION));
+            mode = snapshot.inputMode;
+            return;
         }
+
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+        mode = DoSrvGetConsoleInputMode(context);
     }
     CATCH_LOG();
 }
@@ -68,6 +90,13 @@ void ApiRoutines::GetConsoleOutputModeImpl(SCREEN_INFORMATION& context, ULONG& m
 {
     try
     {
+        ConsoleApiSnapshot snapshot;
+        if (CONSOLE_INFORMATION::TryGetApiSnapshot(snapshot) && (snapshot.mainBuffer == &context || snapshot.activeBuffer == &context))
+        {
+            mode = snapshot.outputMode;
+            return;
+        }
+
         LockConsole();
         auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
@@ -98,6 +127,41 @@ void ApiRoutines::GetConsoleOutputModeImpl(SCREEN_INFORMATION& context, ULONG& m
     CATCH_RETURN();
 }
 
+// Routine Description:
+// - Fills in the metadata that GetConsoleScreenBufferInfoEx reports for an output buffer.
+// - The console lock must be held.
+// Arguments:
+// - context - The output buffer concerned
+// - data - Receives structure filled with metadata about the output buffer. The size isn't touched.
+void DoSrvGetConsoleScreenBufferInfo(const SCREEN_INFORMATION& context, CONSOLE_SCREEN_BUFFER_INFOEX& data)
+{
+    data.bFullscreenSupported = FALSE; // traditional full screen with the driver support is no longer supported.
+    // see MSFT: 19918103
+    // Make sure to use the active buffer here. There are clients that will
+    //      use WINDOW_SIZE_EVENTs as a signal to then query the console
+    //      with GetConsoleScreenBufferInfoEx to get the actual viewport
+    //      size.
+    // If they're in the alt buffer, then when they query in that way, the
+    //      value they'll get is the main buffer's size, which isn't updated
+    //      until we switch back to it.
+    context.GetActiveBuffer().GetScreenBufferInformation(&data.dwSize,
+                                                         &data.dwCursorPosition,
+                                                         &data.srWindow,
+                                                         &data.wAttributes,
+                                                         &data.dwMaximumWindowSize,
+                                                         &data.wPopupAttributes,
+                                                         data.ColorTable);
+
+    // Callers of this function expect to receive an exclusive rect, not an
+    // inclusive one. The driver will mangle this value for us
+    // - For GetConsoleScreenBufferInfoEx, it will re-decrement these values
+    //   to return an inclusive rect.
+    // - For GetConsoleScreenBufferInfo, it will leave these values
+    //   untouched, returning an exclusive rect.
+    data.srWindow.Right += 1;
+    data.srWindow.Bottom += 1;
+}
+
 // Routine Description:
 // - Retrieves metadata associated with the output buffer (size, default colors, etc.)
 // Arguments:
@@ -108,34 +172,20 @@ void ApiRoutines::GetConsoleScreenBufferInfoExImpl(const SCREEN_INFORMATION& con
 {
     try
     {
+        // Monitoring tools poll this a lot. Don't make them wait for the lock, if nothing changed since it was last released.
+        ConsoleApiSnapshot snapshot;
+        if (CONSOLE_INFORMATION::TryGetApiSnapshot(snapshot) && (snapshot.mainBuffer == &context || snapshot.activeBuffer == &context))
+        {
+            const auto size = data.cbSize;
+            data = snapshot.screenBufferInfo;
+            data.cbSize = size;
+            return;
+        }
+
         LockConsole();
         auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
-        data.bFullscreenSupported = FALSE; // traditional full screen with the driver support is no longer supported.
-        // see MSFT: 19918103
-        // Make sure to use the active buffer here. There are clients that will
-        //      use WINDOW_SIZE_EVENTs as a signal to then query the console
-        //      with GetConsoleScreenBufferInfoEx to get the actual viewport
-        //      size.
-        // If they're in the alt buffer, then when they query in that way, the
-        //      value they'll get is the main buffer's size, which isn't updated
-        //      until we switch back to it.
-        context.GetActiveBuffer().GetScreenBufferInformation(&data.dwSize,
-                                                             &data.dwCursorPosition,
-                                                             &data.srWindow,
-                                                             &data.wAttributes,
-                                                             &data.dwMaximumWindowSize,
-                                                             &data.wPopupAttributes,
-                                                             data.ColorTable);
-
-        // Callers of this function expect to receive an exclusive rect, not an
-        // inclusive one. The driver will mangle this value for us
-        // - For GetConsoleScreenBufferInfoEx, it will re-decrement these values
-        //   to return an inclusive rect.
-        // - For GetConsoleScreenBufferInfo, it will leave these values
-        //   untouched, returning an exclusive rect.
-        data.srWindow.Right += 1;
-        data.srWindow.Bottom += 1;
+        DoSrvGetConsoleScreenBufferInfo(context, data);
     }
     CATCH_LOG();
 }
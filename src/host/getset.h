@@ -17,5 +17,8 @@ Revision History:
 #pragma once
 #include "../inc/conattrs.hpp"
 class SCREEN_INFORMATION;
+class InputBuffer;
 
+ULONG DoSrvGetConsoleInputMode(const InputBuffer& context);
+void DoSrvGetConsoleScreenBufferInfo(const SCREEN_INFORMATION& context, CONSOLE_SCREEN_BUFFER_INFOEX& data);
 [[nodiscard]] HRESULT DoSrvSetConsoleOutputCodePage(const unsigned int codepage);
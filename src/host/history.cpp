@@ -28,6 +28,8 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 // "least recently used" state. Doing many rearrangement operations with
 // a list will maintain the iterator pointers as valid to the elements
 // (where other collections like deque do not.)
+// The rearrangements splice the elements, instead of copying them, so that
+// the histories (and the pointers that cooked reads hold to them) stay put.
 // If CommandHistory::s_Allocate and friends stop shuffling elements
 // for maintaining LRU, then this datatype can be changed.
 std::list<CommandHistory> CommandHistory::s_historyLists;
@@ -82,6 +84,15 @@ bool CommandHistory::IsAppNameMatch(const std::wstring_view other) const
     return std::equal(_appName.cbegin(), _appName.cend(), other.cbegin(), other.cend(), CaseInsensitiveEquality);
 }
 
+// Routine Description:
+// - Folds the case of the given command, the same way CaseInsensitiveEquality does.
+std::wstring CommandHistory::_Fold(const std::wstring_view command)
+{
+    std::wstring folded{ command };
+    std::transform(folded.begin(), folded.end(), folded.begin(), [](const wchar_t wch) { return gsl::narrow_cast<wchar_t>(::towlower(wch)); });
+    return folded;
+}
+
 // Routine Description:
 // - This routine is called when escape is entered or a command is added.
 void CommandHistory::_Reset()
@@ -125,6 +136,7 @@ void CommandHistory::_Reset()
             if ((SHORT)_commands.size() == _maxCommands)
             {
                 _commands.erase(_commands.cbegin());
+                _foldedCommands.erase(_foldedCommands.cbegin());
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
                 --LastDisplayed;
@@ -139,6 +151,7 @@ void CommandHistory::_Reset()
             {
                 _commands.emplace_back(newCommand);
             }
+            _foldedCommands.emplace_back(_Fold(_commands.back()));
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -249,6 +262,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 void CommandHistory::Empty()
 {
     _commands.clear();
+    _foldedCommands.clear();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -282,14 +296,9 @@ void CommandHistory::Realloc(const size_t commands)
         return;
     }
 
-    const auto oldCommands = _commands;
-    const auto newNumberOfCommands = gsl::narrow<SHORT>(std::min(_commands.size(), commands));
-
-    _commands.clear();
-    for (SHORT i = 0; i < newNumberOfCommands; i++)
-    {
-        _commands.emplace_back(oldCommands[i]);
-    }
+    const auto newNumberOfCommands = std::min(_commands.size(), commands);
+    _commands.resize(newNumberOfCommands);
+    _foldedCommands.resize(newNumberOfCommands);
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = gsl::narrow<SHORT>(_commands.size()) - 1;
@@ -302,12 +311,8 @@ void CommandHistory::s_ReallocExeToFront(const std::wstring_view appName, const
     {
         if (WI_IsFlagSet(it->Flags, CLE_ALLOCATED) && it->IsAppNameMatch(appName))
         {
-            CommandHistory backup = *it;
-            backup.Realloc(commands);
-
-            s_historyLists.erase(it);
-            s_historyLists.push_front(backup);
-
+            it->Realloc(commands);
+            s_historyLists.splice(s_historyLists.begin(), s_historyLists, it);
             return;
         }
     }
@@ -341,19 +346,18 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     // Reuse a history buffer.  The buffer must be !CLE_ALLOCATED.
     // If possible, the buffer should have the same app name.
-    std::optional<CommandHistory> BestCandidate;
+    auto BestCandidate = s_historyLists.end();
     bool SameApp = false;
 
-    for (auto it = s_historyLists.cbegin(); it != s_historyLists.cend(); it++)
+    for (auto it = s_historyLists.begin(); it != s_historyLists.end(); it++)
     {
         if (WI_IsFlagClear(it->Flags, CLE_ALLOCATED))
         {
             // use LRU history buffer with same app name
             if (it->IsAppNameMatch(appName))
             {
-                BestCandidate = *it;
+                BestCandidate = it;
                 SameApp = true;
-                s_historyLists.erase(it);
                 break;
             }
         }
@@ -372,26 +376,26 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         History._processHandle = processHandle;
         return &s_historyLists.emplace_front(History);
     }
-    else if (!BestCandidate.has_value() && s_historyLists.size() > 0)
+    else if (BestCandidate == s_historyLists.end() && s_historyLists.size() > 0)
     {
         // If we have no candidate already and we need one, take the LRU (which is the back/last one) which isn't allocated.
-        for (auto it = s_historyLists.crbegin(); it != s_historyLists.crend(); it++)
+        for (auto it = s_historyLists.rbegin(); it != s_historyLists.rend(); it++)
         {
             if (WI_IsFlagClear(it->Flags, CLE_ALLOCATED))
             {
-                BestCandidate = *it;
-                s_historyLists.erase(std::next(it).base()); // trickery to turn reverse iterator into forward iterator for erase.
+                BestCandidate = std::next(it).base(); // trickery to turn reverse iterator into forward iterator.
                 break;
             }
         }
     }
 
     // If the app name doesn't match, copy in the new app name and free the old commands.
-    if (BestCandidate.has_value())
+    if (BestCandidate != s_historyLists.end())
     {
         if (!SameApp)
         {
             BestCandidate->_commands.clear();
+            BestCandidate->_foldedCommands.clear();
             BestCandidate->LastDisplayed = -1;
             BestCandidate->_appName = appName;
         }
@@ -399,7 +403,8 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
         BestCandidate->_processHandle = processHandle;
         WI_SetFlag(BestCandidate->Flags, CLE_ALLOCATED);
 
-        return &s_historyLists.emplace_front(BestCandidate.value());
+        s_historyLists.splice(s_historyLists.begin(), s_historyLists, BestCandidate);
+        return &*BestCandidate;
     }
 
     return nullptr;
@@ -472,6 +477,8 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
     {
         const auto str = _commands.at(iDel);
 
+        _foldedCommands.erase(_foldedCommands.cbegin() + iDel);
+
         if (iDel < iLast)
         {
             _commands.erase(_commands.cbegin() + iDel);
@@ -529,16 +536,13 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 
     try
     {
+        const auto foldedCommand = _Fold(givenCommand);
         for (size_t i = 0; i < _commands.size(); i++)
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
+            const std::wstring_view storedCommand{ _foldedCommands.at(indexFound) };
+            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (foldedCommand.size() <= storedCommand.size())) || (foldedCommand.size() == storedCommand.size()))
             {
-                if (std::equal(storedCommand.begin(),
-                               storedCommand.begin() + givenCommand.size(),
-                               givenCommand.begin(),
-                               givenCommand.end(),
-                               CaseInsensitiveEquality))
+                if (storedCommand.substr(0, foldedCommand.size()) == foldedCommand)
                 {
                     return true;
                 }
@@ -567,6 +571,7 @@ void CommandHistory::s_ClearHistoryListStorage()
 void CommandHistory::Swap(const short indexA, const short indexB)
 {
     std::swap(_commands.at(indexA), _commands.at(indexB));
+    std::swap(_foldedCommands.at(indexA), _foldedCommands.at(indexB));
 }
 
 // Routine Description:
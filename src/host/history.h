@@ -83,7 +83,12 @@ private:
     void _Dec(SHORT& ind) const;
     void _Inc(SHORT& ind) const;
 
+    static std::wstring _Fold(const std::wstring_view command);
+
     std::vector<std::wstring> _commands;
+    // The case folded copies of _commands, in the same order. Prefix searches
+    // compare against these, instead of folding every stored command again.
+    std::vector<std::wstring> _foldedCommands;
     SHORT _maxCommands;
 
     std::wstring _appName;
@@ -92,24 +92,11 @@ static void _CopyRectangle(SCREEN_INFORMATION& screenInfo,
         }
     }
 
-    // 2. We can move any other scenario in-place without copying. We just have to carefully
-    //    choose which direction we walk through filling up the target so it doesn't accidentally
-    //    erase the source material before it can be copied/moved to the new location.
-    {
-        const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
-
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
-
-        do
-        {
-            const auto data = OutputCell(*screenInfo.GetCellDataAt(sourcePos));
-            screenInfo.Write(OutputCellIterator({ &data, 1 }), targetPos);
-
-            source.WalkInBounds(sourcePos, walkDirection);
-        } while (target.WalkInBounds(targetPos, walkDirection));
-    }
+    // 2. We can move any other scenario in-place without copying. Each row span of the
+    //    source is moved into the target row as a whole, characters and attribute runs
+    //    alike. The rows are walked in the direction that keeps the source from being
+    //    overwritten before it has been moved, and ROW::CopyCells does the same within a row.
+    screenInfo.GetTextBuffer().CopyRectangle(source, targetOrigin);
 }
 
 // Routine Description:
@@ -131,39 +118,43 @@ std::vector<WORD> ReadOutputAttributes(const SCREEN_INFORMATION& screenInfo,
     }
 
     // Short circuit, if reading out of bounds, leave early.
-    if (!screenInfo.GetBufferSize().IsInBounds(coordRead))
+    const auto bufferSize = screenInfo.GetBufferSize();
+    if (!bufferSize.IsInBounds(coordRead))
     {
         return {};
     }
 
-    // Get iterator to the position we should start reading at.
-    auto it = screenInfo.GetCellDataAt(coordRead);
-    // Count up the number of cells we've attempted to read.
-    ULONG amountRead = 0;
+    const auto& textBuffer = screenInfo.GetTextBuffer();
     // Prepare the return value string.
     std::vector<WORD> retVal;
-    // Reserve the number of cells. If we have >U+FFFF, it will auto-grow later and that's OK.
     retVal.reserve(amountToRead);
 
-    // While we haven't read enough cells yet and the iterator is still valid (hasn't reached end of buffer)
-    while (amountRead < amountToRead && it)
+    // Read a row span at a time until we've read enough cells or reached the end of the buffer.
+    // Each run of identical attributes only has to be converted to legacy attributes once.
+    for (auto pos = coordRead; retVal.size() < amountToRead && pos.Y < bufferSize.Height(); pos.X = 0, ++pos.Y)
     {
-        const auto legacyAttributes = it->TextAttr().GetLegacyAttributes();
-
-        // If the first thing we read is trailing, pad with a space.
-        // OR If the last thing we read is leading, pad with a space.
-        if ((amountRead == 0 && it->DbcsAttr().IsTrailing()) ||
-            (amountRead == (amountToRead - 1) && it->DbcsAttr().IsLeading()))
-        {
-            retVal.push_back(legacyAttributes);
-        }
-        else
+        const auto& row = textBuffer.GetRowByOffset(pos.Y);
+        const auto end = std::min<size_t>(bufferSize.Width(), pos.X + (amountToRead - retVal.size()));
+        for (AttributeRunIterator run{ row, gsl::narrow_cast<uint16_t>(pos.X), gsl::narrow_cast<uint16_t>(end) }; run; ++run)
         {
-            retVal.push_back(legacyAttributes | it->DbcsAttr().GeneratePublicApiAttributeFormat());
+            const auto legacyAttributes = run->attr.GetLegacyAttributes();
+            for (const auto& cell : run->cells)
+            {
+                retVal.push_back(legacyAttributes | cell.DbcsAttr().GeneratePublicApiAttributeFormat());
+            }
         }
+    }
 
-        amountRead++;
-        it++;
+    // If the first thing we read is trailing, it's padding.
+    // OR If the last thing we read is leading, it's padding.
+    constexpr WORD dbcsFlags = COMMON_LVB_LEADING_BYTE | COMMON_LVB_TRAILING_BYTE;
+    if (!retVal.empty() && WI_IsFlagSet(retVal.front(), COMMON_LVB_TRAILING_BYTE))
+    {
+        WI_ClearAllFlags(retVal.front(), dbcsFlags);
+    }
+    if (retVal.size() == amountToRead && WI_IsFlagSet(retVal.back(), COMMON_LVB_LEADING_BYTE))
+    {
+        WI_ClearAllFlags(retVal.back(), dbcsFlags);
     }
 
     return retVal;
@@ -188,42 +179,57 @@ std::wstring ReadOutputStringW(const SCREEN_INFORMATION& screenInfo,
     }
 
     // Short circuit, if reading out of bounds, leave early.
-    if (!screenInfo.GetBufferSize().IsInBounds(coordRead))
+    const auto bufferSize = screenInfo.GetBufferSize();
+    if (!bufferSize.IsInBounds(coordRead))
     {
         return {};
     }
 
-    // Get iterator to the position we should start reading at.
-    auto it = screenInfo.GetCellDataAt(coordRead);
+    const auto& textBuffer = screenInfo.GetTextBuffer();
 
     // Count up the number of cells we've attempted to read.
-    ULONG amountRead = 0;
+    size_t amountRead = 0;
 
     // Prepare the return value string.
     std::wstring retVal;
     retVal.reserve(amountToRead); // Reserve the number of cells. If we have >U+FFFF, it will auto-grow later and that's OK.
 
-    // While we haven't read enough cells yet and the iterator is still valid (hasn't reached end of buffer)
-    while (amountRead < amountToRead && it)
+    // Read a row span at a time until we've read enough cells or reached the end of the buffer.
+    for (auto pos = coordRead; amountRead < amountToRead && pos.Y < bufferSize.Height(); pos.X = 0, ++pos.Y)
     {
-        // If the first thing we read is trailing, pad with a space.
-        // OR If the last thing we read is leading, pad with a space.
-        if ((amountRead == 0 && it->DbcsAttr().IsTrailing()) ||
-            (amountRead == (amountToRead - 1) && it->DbcsAttr().IsLeading()))
-        {
-            retVal += UNICODE_SPACE;
-        }
-        else
+        const auto& row = textBuffer.GetRowByOffset(pos.Y);
+        const auto& charRow = row.GetCharRow();
+        const auto end = std::min<size_t>(bufferSize.Width(), pos.X + (amountToRead - amountRead));
+        for (AttributeRunIterator run{ row, gsl::narrow_cast<uint16_t>(pos.X), gsl::narrow_cast<uint16_t>(end) }; run; ++run)
         {
-            // Otherwise, add anything that isn't a trailing cell. (Trailings are duplicate copies of the leading.)
-            if (!it->DbcsAttr().IsTrailing())
+            for (size_t i = 0; i < run->cells.size(); ++i, ++amountRead)
             {
-                retVal += it->Chars();
+                const auto& cell = til::at(run->cells, i);
+                const auto dbcsAttr = cell.DbcsAttr();
+
+                // If the first thing we read is trailing, pad with a space.
+                // OR If the last thing we read is leading, pad with a space.
+                if ((amountRead == 0 && dbcsAttr.IsTrailing()) ||
+                    (amountRead == (amountToRead - 1) && dbcsAttr.IsLeading()))
+                {
+                    retVal += UNICODE_SPACE;
+                }
+                // Otherwise, add anything that isn't a trailing cell. (Trailings are duplicate copies of the leading.)
+                else if (!dbcsAttr.IsTrailing())
+                {
+                    // Only glyphs that don't fit into a single wchar_t have to be looked up in the row's storage.
+                    if (dbcsAttr.IsGlyphStored())
+                    {
+                        const auto glyph = charRow.GlyphAt(run->begin + i);
+                        retVal.append(glyph.begin(), glyph.end());
+                    }
+                    else
+                    {
+                        retVal += cell.Char();
+                    }
+                }
             }
         }
-
-        amountRead++;
-        it++;
     }
 
     return retVal;
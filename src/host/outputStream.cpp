@@ -165,9 +165,32 @@ SHORT ConhostInternalGetSet::GetLineWidth(const size_t row) const
 // - <none>
 void ConhostInternalGetSet::WriteInput(std::deque<std::unique_ptr<IInputEvent>>& events, size_t& eventsWritten)
 {
+    // The terminal replies to the queries in output that's passed through to
+    // it, and its replies already reach the client through the input pipe.
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (gci.IsInVtIoMode() && gci.GetVtIo()->IsInPassthrough())
+    {
+        eventsWritten = 0;
+        return;
+    }
+
     eventsWritten = _io.GetActiveInputBuffer()->Write(events);
 }
 
+// Routine Description:
+// - Writes input records to the input buffer as they are, without creating an
+//   IInputEvent for each of them. This is how the VT input thread hands over
+//   the keys and mouse events it batched up while parsing its input.
+// Arguments:
+// - records - the input records to be appended to the input buffer
+// - eventsWritten - on output, the number of events written
+// Return Value:
+// - <none>
+void ConhostInternalGetSet::WriteInputRecords(const gsl::span<const INPUT_RECORD> records, size_t& eventsWritten)
+{
+    eventsWritten = _io.GetActiveInputBuffer()->Write(records);
+}
+
 // Routine Description:
 // - Connects the SetWindowInfo API call directly into our Driver Message servicing call inside Conhost.exe
 // Arguments:
@@ -253,6 +276,35 @@ void ConhostInternalGetSet::SetRenderMode(const RenderSettings::Mode mode, const
     }
 }
 
+// Routine Description:
+// - Starts or ends a synchronized update of the screen (DECSET 2026), during
+//   which the renderer holds back its frames. In conpty, the vt renderer also
+//   brackets the frame that contains the update for the connected terminal.
+// Arguments:
+// - enabled - true at the start of an update, false at its end.
+// Return Value:
+// - <none>
+void ConhostInternalGetSet::SetSynchronizedOutput(const bool enabled)
+{
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    // In passthrough mode the sequence reaches the terminal as is, and
+    // nothing is painted in between that would have to be held back.
+    if (gci.IsInVtIoMode() && gci.GetVtIo()->IsPassthroughModeEnabled())
+    {
+        return;
+    }
+
+    if (g.pRender)
+    {
+        g.pRender->SetSynchronizedOutput(enabled);
+    }
+    if (gci.IsInVtIoMode())
+    {
+        gci.GetVtIo()->SetSynchronizedOutput(enabled);
+    }
+}
+
 // Routine Description:
 // - Sets the ENABLE_WRAP_AT_EOL_OUTPUT mode. This controls whether the cursor moves
 //     to the beginning of the next row when it reaches the end of the current row.
@@ -836,6 +888,90 @@ void ConhostInternalGetSet::ScrollRegion(const SMALL_RECT scrollRect,
     ::ScrollRegion(screenInfo, scrollRect, clipRect, destinationOrigin, UNICODE_SPACE, fillAttrs);
 }
 
+// Routine Description:
+// - Copies a rectangle of the screen buffer to another position, leaving the
+//      source as it is. Unlike ScrollRegion, this copies whole row spans at once.
+// Arguments:
+// - source - The rectangle to copy (inclusive). It's clipped to the buffer.
+// - targetOrigin - Upper left corner of the target rectangle.
+// Return value:
+// - <none>
+void ConhostInternalGetSet::CopyRectangle(const SMALL_RECT source, const COORD targetOrigin)
+{
+    auto& screenInfo = _io.GetActiveOutputBuffer();
+    const auto bufferSize = screenInfo.GetBufferSize();
+
+    // Clip the source to the buffer, and then to the space that's left for the target.
+    auto clipped = Viewport::Intersect(bufferSize, Viewport::FromInclusive(source));
+    const auto target = Viewport::Intersect(bufferSize, Viewport::FromDimensions(targetOrigin, clipped.Dimensions()));
+    if (target.Origin() != targetOrigin || target.Width() <= 0 || target.Height() <= 0)
+    {
+        return;
+    }
+    clipped = Viewport::FromDimensions(clipped.Origin(), target.Dimensions());
+
+    screenInfo.GetTextBuffer().CopyRectangle(clipped, targetOrigin);
+
+    // Notify accessibility
+    if (screenInfo.HasAccessibilityEventing())
+    {
+        screenInfo.NotifyAccessibilityEventing(target.Left(), target.Top(), target.RightInclusive(), target.BottomInclusive());
+    }
+}
+
+// Routine Description:
+// - Fills a rectangle of the screen buffer with a single character.
+// Arguments:
+// - fillRect - The rectangle to fill (inclusive). It's clipped to the buffer.
+// - fillChar - Character to fill the rectangle with.
+// - fillAttrs - The attributes to fill the rectangle with, or nullopt to keep the existing ones.
+// Return value:
+// - <none>
+void ConhostInternalGetSet::FillRectangle(const SMALL_RECT fillRect,
+                                          const wchar_t fillChar,
+                                          const std::optional<TextAttribute> fillAttrs)
+{
+    auto& screenInfo = _io.GetActiveOutputBuffer();
+    const auto rect = Viewport::Intersect(screenInfo.GetBufferSize(), Viewport::FromInclusive(fillRect));
+    if (rect.Width() <= 0 || rect.Height() <= 0)
+    {
+        return;
+    }
+
+    screenInfo.GetTextBuffer().FillRectangle(rect, fillChar, fillAttrs);
+
+    // Notify accessibility
+    if (screenInfo.HasAccessibilityEventing())
+    {
+        screenInfo.NotifyAccessibilityEventing(rect.Left(), rect.Top(), rect.RightInclusive(), rect.BottomInclusive());
+    }
+}
+
+// Routine Description:
+// - Clears all rows of the screen buffer from the given one down, with the default attributes.
+//   Unlike FillRegion, this doesn't take longer the more rows there are to clear.
+// Arguments:
+// - startRow - The first row to clear.
+// Return value:
+// - <none>
+void ConhostInternalGetSet::ClearRowsBelow(const size_t startRow)
+{
+    auto& screenInfo = _io.GetActiveOutputBuffer();
+    const auto bufferSize = screenInfo.GetBufferSize();
+    if (startRow >= gsl::narrow_cast<size_t>(bufferSize.Height()))
+    {
+        return;
+    }
+
+    screenInfo.GetTextBuffer().ClearRowsBelow(startRow, TextAttribute{});
+
+    // Notify accessibility
+    if (screenInfo.HasAccessibilityEventing())
+    {
+        screenInfo.NotifyAccessibilityEventing(0, gsl::narrow<SHORT>(startRow), bufferSize.RightInclusive(), bufferSize.BottomInclusive());
+    }
+}
+
 // Routine Description:
 // - Checks if the InputBuffer is willing to accept VT Input directly
 //   IsVtInputEnabled is an internal-only "API" call that the vt commands can execute,
@@ -44,6 +44,7 @@ public:
     SHORT GetLineWidth(const size_t row) const override;
 
     void WriteInput(std::deque<std::unique_ptr<IInputEvent>>& events, size_t& eventsWritten) override;
+    void WriteInputRecords(const gsl::span<const INPUT_RECORD> records, size_t& eventsWritten) override;
 
     void SetWindowInfo(bool const absolute, const SMALL_RECT& window) override;
 
@@ -51,6 +52,7 @@ public:
     void SetParserMode(const Microsoft::Console::VirtualTerminal::StateMachine::Mode mode, const bool enabled) override;
     bool GetParserMode(const Microsoft::Console::VirtualTerminal::StateMachine::Mode mode) const override;
     void SetRenderMode(const RenderSettings::Mode mode, const bool enabled) override;
+    void SetSynchronizedOutput(const bool enabled) override;
 
     void SetAutoWrapMode(const bool wrapAtEOL) override;
 
@@ -107,6 +109,12 @@ public:
                       const COORD destinationOrigin,
                       const bool standardFillAttrs) override;
 
+    void CopyRectangle(const SMALL_RECT source, const COORD targetOrigin) override;
+    void FillRectangle(const SMALL_RECT fillRect,
+                       const wchar_t fillChar,
+                       const std::optional<TextAttribute> fillAttrs) override;
+    void ClearRowsBelow(const size_t startRow) override;
+
     bool IsVtInputEnabled() const override;
 
     void AddHyperlink(const std::wstring_view uri, const std::wstring_view params) const override;
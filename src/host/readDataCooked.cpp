@@ -493,6 +493,20 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
         return false;
     }
 
+    // Echoing a character inserted into the middle of the line means redrawing the rest of
+    // the line. When a whole batch of them is inserted, like when text is pasted, that's
+    // done once for all of them, after the batch (see _flushPendingEcho). Everything else
+    // needs the screen to be up to date first.
+    const bool deferEcho = _echoInput && !AtEol() && wch >= L' ' && wch != EXTKEY_ERASE_PREV_WORD;
+    if (!deferEcho)
+    {
+        _flushPendingEcho();
+    }
+    else if (!_pendingEchoPosition)
+    {
+        _pendingEchoPosition = _currentPosition;
+    }
+
     if (_ctrlWakeupMask != 0 && wch < L' ' && (_ctrlWakeupMask & (1 << wch)))
     {
         *_bufPtr = wch;
@@ -664,7 +678,7 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
             {
                 bool fBisect = false;
 
-                if (_echoInput)
+                if (_echoInput && !deferEcho)
                 {
                     if (CheckBisectProcessW(_screenInfo,
                                             _backupLimit,
@@ -689,7 +703,7 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
                 _currentPosition += 1;
 
                 // calculate new cursor position
-                if (_echoInput)
+                if (_echoInput && !deferEcho)
                 {
                     NumSpaces = RetrieveNumberOfSpaces(_originalCursorPosition.X,
                                                        _backupLimit,
@@ -700,7 +714,7 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
             }
         }
 
-        if (_echoInput && CallWrite)
+        if (_echoInput && CallWrite && !deferEcho)
         {
             COORD CursorPosition;
 
@@ -956,6 +970,8 @@ void COOKED_READ_DATA::SavePendingInput(const size_t index, const bool multiline
 
         if (commandLineEditingKeys)
         {
+            _flushPendingEcho();
+
             // TODO: this is super weird for command line popups only
             _unicode = isUnicode;
 
@@ -989,9 +1005,101 @@ void COOKED_READ_DATA::SavePendingInput(const size_t index, const bool multiline
             }
         }
     }
+
+    // Whether we're done or waiting for more input, the screen has to show what was typed.
+    _flushPendingEcho();
     return Status;
 }
 
+// Routine Description:
+// - Echoes the characters that ProcessInput inserted into the middle of the line since
+//   the last call. Only the line from the first of them onwards changed, so only that
+//   part of it is redrawn, instead of deleting and redrawing the whole line for each
+//   of them.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void COOKED_READ_DATA::_flushPendingEcho()
+{
+    if (!_pendingEchoPosition)
+    {
+        return;
+    }
+
+    const auto position = *_pendingEchoPosition;
+    _pendingEchoPosition.reset();
+
+    const SHORT sScreenBufferSizeX = _screenInfo.GetBufferSize().Width();
+    size_t visibleCharCount = RetrieveTotalNumberOfSpaces(_originalCursorPosition.X, _backupLimit, position);
+
+    SHORT ScrollY = 0;
+    const auto writeChars = [&](wchar_t* const start, const size_t length) {
+        size_t NumToWrite = length * sizeof(WCHAR);
+        size_t NumSpaces = 0;
+        ScrollY = 0;
+        const auto status = WriteCharsLegacy(_screenInfo,
+                                             _backupLimit,
+                                             start,
+                                             start,
+                                             &NumToWrite,
+                                             &NumSpaces,
+                                             _originalCursorPosition.X,
+                                             WC_DESTRUCTIVE_BACKSPACE | WC_PRINTABLE_CONTROL_CHARS,
+                                             &ScrollY);
+        if (!NT_SUCCESS(status))
+        {
+            RIPMSG1(RIP_WARNING, "WriteCharsLegacy failed 0x%x", status);
+            return false;
+        }
+        _originalCursorPosition.Y += ScrollY;
+        visibleCharCount += NumSpaces;
+        return true;
+    };
+
+    // Write the changed part of the line up to the insertion point, which is where the
+    // cursor belongs...
+    if (!writeChars(_backupLimit + position, _currentPosition - position))
+    {
+        return;
+    }
+    COORD CursorPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
+
+    // ...and then the remainder of the line.
+    if (!writeChars(_bufPtr, _bytesRead / sizeof(WCHAR) - _currentPosition))
+    {
+        return;
+    }
+    CursorPosition.Y += ScrollY;
+
+    // Overwriting wide characters with narrow ones makes the line shorter.
+    if (visibleCharCount < _visibleCharCount)
+    {
+        try
+        {
+            _screenInfo.Write(OutputCellIterator(UNICODE_SPACE, _visibleCharCount - visibleCharCount),
+                              _screenInfo.GetTextBuffer().GetCursor().GetPosition());
+        }
+        CATCH_LOG();
+    }
+    _visibleCharCount = visibleCharCount;
+
+    if (CheckBisectProcessW(_screenInfo,
+                            _backupLimit,
+                            _currentPosition + 1,
+                            sScreenBufferSizeX - _originalCursorPosition.X,
+                            _originalCursorPosition.X,
+                            TRUE))
+    {
+        if (CursorPosition.X == (sScreenBufferSizeX - 1))
+        {
+            CursorPosition.X++;
+        }
+    }
+
+    LOG_IF_NTSTATUS_FAILED(AdjustCursorPosition(_screenInfo, CursorPosition, TRUE, nullptr));
+}
+
 // Routine Description:
 // - handles any tasks that need to be completed after the read input loop finishes
 // Arguments:
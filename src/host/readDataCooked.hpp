@@ -158,7 +158,13 @@ private:
 
     ConsoleProcessHandle* const _clientProcess;
 
+    // The position of the first character that ProcessInput inserted into the middle of the
+    // line without echoing it yet. The screen cursor is still where that character went.
+    std::optional<size_t> _pendingEchoPosition;
+
     [[nodiscard]] NTSTATUS _readCharInputLoop(const bool isUnicode, size_t& numBytes) noexcept;
 
+    void _flushPendingEcho();
+
     [[nodiscard]] NTSTATUS _handlePostCharInputLoop(const bool isUnicode, size_t& numBytes, ULONG& controlKeyState) noexcept;
 };
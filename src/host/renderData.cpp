@@ -64,21 +64,22 @@ const FontInfo& RenderData::GetFontInfo() noexcept
 // - Retrieves one rectangle per line describing the area of the viewport
 //   that should be highlighted in some way to represent a user-interactive selection
 // Return Value:
-// - Vector of Viewports describing the area selected
-std::vector<Viewport> RenderData::GetSelectionRects() noexcept
+// - Viewports describing the area selected, valid until the next call
+gsl::span<const Viewport> RenderData::GetSelectionRects() noexcept
 {
-    std::vector<Viewport> result;
+    _selectionRects.clear();
 
     try
     {
-        for (const auto& select : Selection::Instance().GetSelectionRects())
+        Selection::Instance().GetSelectionRects(_selectionLines);
+        for (const auto& select : _selectionLines)
         {
-            result.emplace_back(Viewport::FromInclusive(select));
+            _selectionRects.emplace_back(Viewport::FromInclusive(select));
         }
     }
     CATCH_LOG();
 
-    return result;
+    return _selectionRects;
 }
 
 // Method Description:
@@ -208,10 +209,10 @@ ULONG RenderData::GetCursorPixelWidth() const noexcept
 // - Overlays are drawn from first to last
 //  (the highest overlay should be given last)
 // Return Value:
-// - Iterable set of overlays
-const std::vector<Microsoft::Console::Render::RenderOverlay> RenderData::GetOverlays() const noexcept
+// - Iterable set of overlays, valid until the next call
+gsl::span<const Microsoft::Console::Render::RenderOverlay> RenderData::GetOverlays() const noexcept
 {
-    std::vector<Microsoft::Console::Render::RenderOverlay> overlays;
+    _overlays.clear();
 
     try
     {
@@ -235,13 +236,13 @@ const std::vector<Microsoft::Console::Render::RenderOverlay> RenderData::GetOver
                 // (e.g. 0,0 is the origin of the text buffer above, not the placement within the visible viewport)
                 const auto used = Viewport::FromInclusive(composition.GetAreaBufferInfo().rcViewCaWindow);
 
-                overlays.emplace_back(Microsoft::Console::Render::RenderOverlay{ textBuffer, origin, used });
+                _overlays.emplace_back(Microsoft::Console::Render::RenderOverlay{ textBuffer, origin, used });
             }
         }
     }
     CATCH_LOG();
 
-    return overlays;
+    return _overlays;
 }
 
 // Method Description:
@@ -324,7 +325,7 @@ const std::wstring RenderData::GetHyperlinkCustomId(uint16_t id) const noexcept
 }
 
 // For now, we ignore regex patterns in conhost
-const std::vector<size_t> RenderData::GetPatternId(const COORD /*location*/) const noexcept
+gsl::span<const size_t> RenderData::GetPatternId(const COORD /*location*/) const noexcept
 {
     return {};
 }
@@ -29,7 +29,7 @@ public:
     const TextBuffer& GetTextBuffer() noexcept override;
     const FontInfo& GetFontInfo() noexcept override;
 
-    std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
+    gsl::span<const Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
 
     void LockConsole() noexcept override;
     void UnlockConsole() noexcept override;
@@ -44,7 +44,7 @@ public:
     ULONG GetCursorPixelWidth() const noexcept override;
     bool IsCursorDoubleWidth() const override;
 
-    const std::vector<Microsoft::Console::Render::RenderOverlay> GetOverlays() const noexcept override;
+    gsl::span<const Microsoft::Console::Render::RenderOverlay> GetOverlays() const noexcept override;
 
     const bool IsGridLineDrawingAllowed() noexcept override;
 
@@ -53,7 +53,7 @@ public:
     const std::wstring GetHyperlinkUri(uint16_t id) const noexcept override;
     const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept override;
 
-    const std::vector<size_t> GetPatternId(const COORD location) const noexcept override;
+    gsl::span<const size_t> GetPatternId(const COORD location) const noexcept override;
 #pragma endregion
 
 #pragma region IUiaData
@@ -67,4 +67,10 @@ public:
     void ColorSelection(const COORD coordSelectionStart, const COORD coordSelectionEnd, const TextAttribute attr);
     const bool IsUiaDataInitialized() const noexcept override { return true; }
 #pragma endregion
+
+private:
+    // Reused from call to call, so that querying them doesn't allocate. See IRenderData.
+    std::vector<SMALL_RECT> _selectionLines;
+    std::vector<Microsoft::Console::Types::Viewport> _selectionRects;
+    mutable std::vector<Microsoft::Console::Render::RenderOverlay> _overlays;
 };
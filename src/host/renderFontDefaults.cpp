@@ -7,10 +7,7 @@
 
 #pragma hdrstop
 
-RenderFontDefaults::RenderFontDefaults()
-{
-    LOG_IF_NTSTATUS_FAILED(TrueTypeFontList::s_Initialize());
-}
+RenderFontDefaults::RenderFontDefaults() = default;
 
 RenderFontDefaults::~RenderFontDefaults()
 {
@@ -21,6 +18,13 @@ RenderFontDefaults::~RenderFontDefaults()
                                                                              std::wstring& outFaceName)
 try
 {
+    // The list of TrueType fonts is read from the registry on first use only:
+    // it's only needed if the font is the default TrueType font placeholder,
+    // which most consoles (and all pseudoconsoles) never ask for.
+    std::call_once(_trueTypeFontListLoaded, []() {
+        LOG_IF_NTSTATUS_FAILED(TrueTypeFontList::s_Initialize());
+    });
+
     // GH#3123: Propagate font length changes up through Settings and propsheet
     wchar_t faceName[LF_FACESIZE]{ 0 };
     NTSTATUS status = TrueTypeFontList::s_SearchByCodePage(codePage, faceName, ARRAYSIZE(faceName));
@@ -24,4 +24,7 @@ public:
 
     [[nodiscard]] HRESULT RetrieveDefaultFontNameForCodepage(const unsigned int codePage,
                                                              std::wstring& outFaceName);
+
+private:
+    std::once_flag _trueTypeFontListLoaded;
 };
@@ -89,6 +89,8 @@ SCREEN_INFORMATION::~SCREEN_INFORMATION()
 // - coordWindowSize - the initial size of screen buffer's window (in rows/columns)
 // - nFont - the initial font to generate text with.
 // - dwScreenBufferSize - the initial size of the screen buffer (in rows/columns).
+// - recycledTextBuffer - optionally, a text buffer that's no longer in use, which
+//      is reset and reused instead of allocating a new one, if it has the right size.
 // Return Value:
 [[nodiscard]] NTSTATUS SCREEN_INFORMATION::CreateInstance(_In_ COORD coordWindowSize,
                                                           const FontInfo fontInfo,
@@ -96,7 +98,8 @@ SCREEN_INFORMATION::~SCREEN_INFORMATION()
                                                           const TextAttribute defaultAttributes,
                                                           const TextAttribute popupAttributes,
                                                           const UINT uiCursorSize,
-                                                          _Outptr_ SCREEN_INFORMATION** const ppScreen)
+                                                          _Outptr_ SCREEN_INFORMATION** const ppScreen,
+                                                          std::unique_ptr<TextBuffer> recycledTextBuffer)
 {
     *ppScreen = nullptr;
 
@@ -117,10 +120,18 @@ SCREEN_INFORMATION::~SCREEN_INFORMATION()
         pScreen->UpdateBottom();
 
         // Set up text buffer
-        pScreen->_textBuffer = std::make_unique<TextBuffer>(coordScreenBufferSize,
-                                                            defaultAttributes,
-                                                            uiCursorSize,
-                                                            pScreen->_renderTarget);
+        if (recycledTextBuffer && recycledTextBuffer->GetSize().Dimensions() == coordScreenBufferSize)
+        {
+            recycledTextBuffer->Recycle(defaultAttributes, uiCursorSize, pScreen->_renderTarget);
+            pScreen->_textBuffer = std::move(recycledTextBuffer);
+        }
+        else
+        {
+            pScreen->_textBuffer = std::make_unique<TextBuffer>(coordScreenBufferSize,
+                                                                defaultAttributes,
+                                                                uiCursorSize,
+                                                                pScreen->_renderTarget);
+        }
 
         const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         pScreen->_textBuffer->GetCursor().SetType(gci.GetCursorType());
@@ -1855,6 +1866,8 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
 // - Instantiates a new buffer to be used as an alternate buffer. This buffer
 //     does not have a driver handle associated with it and shares a state
 //     machine with the main buffer it belongs to.
+// - The text buffer of the previous alternate buffer is reused if the size of
+//     the viewport didn't change since, see UseMainScreenBuffer.
 // TODO: MSFT:19817348 Don't create alt screenbuffer's via an out SCREEN_INFORMATION**
 // Parameters:
 // - ppsiNewScreenBuffer - a pointer to receive the newly created buffer.
@@ -1878,7 +1891,8 @@ const SCREEN_INFORMATION& SCREEN_INFORMATION::GetMainBuffer() const
                                                          initAttributes,
                                                          GetPopupAttributes(),
                                                          Cursor::CURSOR_SMALL_SIZE,
-                                                         ppsiNewScreenBuffer);
+                                                         ppsiNewScreenBuffer,
+                                                         std::move(GetMainBuffer()._recycledAltTextBuffer));
     if (NT_SUCCESS(Status))
     {
         // Update the alt buffer's cursor style, visibility, and position to match our own.
@@ -1987,6 +2001,11 @@ void SCREEN_INFORMATION::UseMainScreenBuffer()
         mainCursor.SetIsVisible(altCursor.IsVisible());
         mainCursor.SetBlinkingAllowed(altCursor.IsBlinkingAllowed());
 
+        // Applications like pagers and editors switch back and forth all the time.
+        // Keep the alt buffer's text buffer around, so that the next one doesn't
+        // have to allocate all of its rows again.
+        psiMain->_recycledAltTextBuffer = std::move(psiAlt->_textBuffer);
+
         s_RemoveScreenBuffer(psiAlt); // this will also delete the alt buffer
         // deleting the alt buffer will give the GetSet back to its main
 
@@ -2227,10 +2246,10 @@ void SCREEN_INFORMATION::SetViewport(const Viewport& newViewport,
     oldViewport.ConvertToOrigin(&relativeCursor);
 
     short delta = (sNewTop + _viewport.Height()) - (GetBufferSize().Height());
-    for (auto i = 0; i < delta; i++)
+    if (delta > 0)
     {
-        _textBuffer->IncrementCircularBuffer();
-        sNewTop--;
+        _textBuffer->IncrementCircularBuffer(gsl::narrow_cast<size_t>(delta), false);
+        sNewTop -= delta;
     }
 
     const COORD coordNewOrigin = { 0, sNewTop };
@@ -2271,10 +2290,10 @@ void SCREEN_INFORMATION::SetViewport(const Viewport& newViewport,
     const Viewport oldViewport = _viewport;
 
     short delta = (sNewTop + _viewport.Height()) - (GetBufferSize().Height());
-    for (auto i = 0; i < delta; i++)
+    if (delta > 0)
     {
-        _textBuffer->IncrementCircularBuffer();
-        sNewTop--;
+        _textBuffer->IncrementCircularBuffer(gsl::narrow_cast<size_t>(delta), false);
+        sNewTop -= delta;
     }
 
     const COORD coordNewOrigin = { 0, sNewTop };
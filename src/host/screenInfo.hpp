@@ -65,7 +65,8 @@ public:
                                                  const TextAttribute defaultAttributes,
                                                  const TextAttribute popupAttributes,
                                                  const UINT uiCursorSize,
-                                                 _Outptr_ SCREEN_INFORMATION** const ppScreen);
+                                                 _Outptr_ SCREEN_INFORMATION** const ppScreen,
+                                                 std::unique_ptr<TextBuffer> recycledTextBuffer = nullptr);
 
     ~SCREEN_INFORMATION();
 
@@ -283,6 +284,7 @@ private:
 
     SCREEN_INFORMATION* _psiAlternateBuffer; // The VT "Alternate" screen buffer.
     SCREEN_INFORMATION* _psiMainBuffer; // A pointer to the main buffer, if this is the alternate buffer.
+    std::unique_ptr<TextBuffer> _recycledAltTextBuffer; // The text buffer of the last alternate buffer, for the next one.
 
     RECT _rcAltSavedClientNew;
     RECT _rcAltSavedClientOld;
@@ -43,9 +43,21 @@ Selection& Selection::Instance()
 // - Throws exceptions for out of memory issues
 std::vector<SMALL_RECT> Selection::GetSelectionRects() const
 {
+    std::vector<SMALL_RECT> rects;
+    GetSelectionRects(rects);
+    return rects;
+}
+
+// Routine Description:
+// - Same as above, but replaces the contents of the given vector with the
+//   rectangles, so that callers can reuse its memory from call to call.
+void Selection::GetSelectionRects(std::vector<SMALL_RECT>& rects) const
+{
+    rects.clear();
+
     if (!_fSelectionVisible)
     {
-        return std::vector<SMALL_RECT>();
+        return;
     }
 
     const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -58,7 +70,7 @@ std::vector<SMALL_RECT> Selection::GetSelectionRects() const
     endSelectionAnchor.Y = (_coordSelectionAnchor.Y == _srSelectionRect.Top) ? _srSelectionRect.Bottom : _srSelectionRect.Top;
 
     const auto blockSelection = !IsLineSelection();
-    return screenInfo.GetTextBuffer().GetTextRects(_coordSelectionAnchor, endSelectionAnchor, blockSelection, false);
+    screenInfo.GetTextBuffer().GetTextRects(_coordSelectionAnchor, endSelectionAnchor, blockSelection, false, rects);
 }
 
 // Routine Description:
@@ -29,6 +29,7 @@ public:
     ~Selection() = default;
 
     std::vector<SMALL_RECT> GetSelectionRects() const;
+    void GetSelectionRects(std::vector<SMALL_RECT>& rects) const;
 
     void ShowSelection();
     void HideSelection();
@@ -71,6 +71,21 @@ Revision History:
 class COOKED_READ_DATA;
 class CommandHistory;
 
+// The state that's queried the most by read-only APIs, as of the last time the console
+// lock was released. See CONSOLE_INFORMATION::TryGetApiSnapshot.
+struct ConsoleApiSnapshot
+{
+    uint64_t generation;
+    // The snapshot applies to these objects only.
+    const SCREEN_INFORMATION* mainBuffer;
+    const SCREEN_INFORMATION* activeBuffer;
+    const InputBuffer* inputBuffer;
+
+    ULONG inputMode;
+    ULONG outputMode;
+    CONSOLE_SCREEN_BUFFER_INFOEX screenBufferInfo;
+};
+
 class CONSOLE_INFORMATION :
     public Settings,
     public Microsoft::Console::IIoProvider
@@ -106,6 +121,7 @@ public:
     static void UnlockConsole();
     static bool IsConsoleLocked();
     static ULONG GetCSRecursionCount();
+    static bool TryGetApiSnapshot(ConsoleApiSnapshot& snapshot) noexcept;
 
     Microsoft::Console::VirtualTerminal::VtIo* GetVtIo();
 
@@ -367,6 +367,29 @@ class AliasTests
         VERIFY_ARE_EQUAL(dwLinesExpected, dwLines, L"Line count be updated to 1.");
     }
 
+    TEST_METHOD(TestMatchAndCopyAfterAliasChanges)
+    {
+        std::wstring exe(L"exe.exe");
+        std::wstring source(L"Source");
+        std::wstring target(L"first $1");
+        Alias::s_TestAddAlias(exe, source, target);
+
+        size_t lineCount = 0;
+        VERIFY_ARE_EQUAL(String(L"first one\r\n"), String(Alias::s_MatchAndCopyAlias(L"SOURCE one", exe, lineCount).c_str()));
+        VERIFY_ARE_EQUAL(size_t{ 1 }, lineCount);
+
+        // Changing the alias must not leave the previous expansion around.
+        target = L"second $1$t$*";
+        Alias::s_TestAddAlias(exe, source, target);
+
+        VERIFY_ARE_EQUAL(String(L"second one\r\none two\r\n"), String(Alias::s_MatchAndCopyAlias(L"source one two", exe, lineCount).c_str()));
+        VERIFY_ARE_EQUAL(size_t{ 2 }, lineCount);
+
+        // Aliases that merely share a prefix with the input don't match.
+        VERIFY_IS_TRUE(Alias::s_MatchAndCopyAlias(L"Sourc one", exe, lineCount).empty());
+        VERIFY_IS_TRUE(Alias::s_MatchAndCopyAlias(L"Sources one", exe, lineCount).empty());
+    }
+
     TEST_METHOD(TrimTrailing)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
@@ -385,9 +408,10 @@ class AliasTests
         _ReplacePercentWithCRLF(target);
         _ReplacePercentWithCRLF(expected);
 
-        Alias::s_TrimTrailingCrLf(target);
+        std::wstring_view actual{ target };
+        Alias::s_TrimTrailingCrLf(actual);
 
-        VERIFY_ARE_EQUAL(String(expected.data()), String(target.data()));
+        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data(), gsl::narrow<int>(actual.size())));
     }
 
     TEST_METHOD(Tokenize)
@@ -398,29 +422,43 @@ class AliasTests
         tokensExpected.emplace_back(L"two");
         tokensExpected.emplace_back(L"three");
 
-        auto tokensActual = Alias::s_Tokenize(tokenStr);
+        std::array<std::wstring_view, Alias::MaxTokens> tokensActual;
+        const auto count = Alias::s_Tokenize(tokenStr, tokensActual);
 
-        VERIFY_ARE_EQUAL(tokensExpected.size(), tokensActual.size());
+        VERIFY_ARE_EQUAL(tokensExpected.size(), count);
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data(), gsl::narrow<int>(tokensActual[i].size())));
         }
     }
 
+    TEST_METHOD(TokenizeTooMany)
+    {
+        std::wstring tokenStr(L"0 1 2 3 4 5 6 7 8 9 10 11");
+
+        std::array<std::wstring_view, Alias::MaxTokens> tokensActual;
+        const auto count = Alias::s_Tokenize(tokenStr, tokensActual);
+
+        // Only the alias and $1-$9 can be referred to, so the rest is dropped.
+        VERIFY_ARE_EQUAL(Alias::MaxTokens, count);
+        VERIFY_ARE_EQUAL(String(L"9"), String(tokensActual[9].data(), gsl::narrow<int>(tokensActual[9].size())));
+    }
+
     TEST_METHOD(TokenizeNothing)
     {
         std::wstring tokenStr(L"alias");
         std::deque<std::wstring> tokensExpected;
         tokensExpected.emplace_back(tokenStr);
 
-        auto tokensActual = Alias::s_Tokenize(tokenStr);
+        std::array<std::wstring_view, Alias::MaxTokens> tokensActual;
+        const auto count = Alias::s_Tokenize(tokenStr, tokensActual);
 
-        VERIFY_ARE_EQUAL(tokensExpected.size(), tokensActual.size());
+        VERIFY_ARE_EQUAL(tokensExpected.size(), count);
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data(), gsl::narrow<int>(tokensActual[i].size())));
         }
     }
 
@@ -438,9 +476,9 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        std::wstring actual = Alias::s_GetArgString(target);
+        const auto actual = Alias::s_GetArgString(target);
 
-        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
+        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data(), gsl::narrow<int>(actual.size())));
     }
 
     TEST_METHOD(NumberedArgMacro)
@@ -466,7 +504,7 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        std::deque<std::wstring> tokens;
+        std::vector<std::wstring_view> tokens;
         tokens.emplace_back(L"alias");
         tokens.emplace_back(L"one");
         tokens.emplace_back(L"two");
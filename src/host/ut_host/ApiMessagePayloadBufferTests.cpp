@@ -0,0 +1,159 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../server/ApiMessage.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class ApiMessagePayloadBufferTests
+{
+    TEST_CLASS(ApiMessagePayloadBufferTests);
+
+    TEST_METHOD(PrepareResizesToThePayload);
+    TEST_METHOD(CapacityIsReusedAcrossMessages);
+    TEST_METHOD(SmallPayloadsStayInline);
+    TEST_METHOD(ShrinksOnceTheHighWaterMarkStaysLow);
+    TEST_METHOD(CopiedMessagePointsAtItsOwnPayload);
+
+    static constexpr size_t InlineCapacity = 128;
+    static constexpr size_t LargePayload = ApiMessagePayloadBuffer::ShrinkThreshold * 4;
+
+    static size_t _capacity(const ApiMessagePayloadBuffer& buffer) noexcept
+    {
+        return buffer._storage.capacity();
+    }
+
+    // Whether the payload lives in the small buffer within the object, rather than on the heap.
+    static bool _isInline(ApiMessagePayloadBuffer& buffer) noexcept
+    {
+        const auto begin = reinterpret_cast<const BYTE*>(&buffer);
+        const auto end = begin + sizeof(buffer);
+        return buffer.data() >= begin && buffer.data() < end;
+    }
+};
+
+void ApiMessagePayloadBufferTests::PrepareResizesToThePayload()
+{
+    ApiMessagePayloadBuffer buffer;
+    VERIFY_ARE_EQUAL(0u, buffer.size());
+
+    auto payload = buffer.Prepare(10);
+    VERIFY_ARE_EQUAL(buffer.data(), payload);
+    VERIFY_ARE_EQUAL(10u, buffer.size());
+
+    payload = buffer.Prepare(LargePayload);
+    VERIFY_ARE_EQUAL(buffer.data(), payload);
+    VERIFY_ARE_EQUAL(LargePayload, buffer.size());
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(_capacity(buffer), LargePayload);
+
+    Log::Comment(L"A smaller payload shrinks the size, but not the capacity.");
+    buffer.Prepare(5);
+    VERIFY_ARE_EQUAL(5u, buffer.size());
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(_capacity(buffer), LargePayload);
+
+    buffer.Reset();
+    VERIFY_ARE_EQUAL(0u, buffer.size());
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(_capacity(buffer), LargePayload);
+}
+
+void ApiMessagePayloadBufferTests::CapacityIsReusedAcrossMessages()
+{
+    ApiMessagePayloadBuffer buffer;
+    const auto storage = buffer.Prepare(LargePayload);
+    buffer.Reset();
+
+    Log::Comment(L"Messages of any size up to the largest one so far use the same storage, without allocating.");
+    for (const size_t size : { LargePayload, size_t{ 1 }, LargePayload / 2, InlineCapacity + 1, size_t{ 0 }, LargePayload })
+    {
+        VERIFY_ARE_EQUAL(storage, buffer.Prepare(size));
+        VERIFY_ARE_EQUAL(size, buffer.size());
+        buffer.Reset();
+    }
+
+    Log::Comment(L"A payload larger than any before moves to bigger storage.");
+    buffer.Prepare(LargePayload * 2);
+    VERIFY_ARE_EQUAL(LargePayload * 2, buffer.size());
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(_capacity(buffer), LargePayload * 2);
+}
+
+void ApiMessagePayloadBufferTests::SmallPayloadsStayInline()
+{
+    ApiMessagePayloadBuffer buffer;
+
+    Log::Comment(L"Payloads up to the inline capacity don't allocate at all.");
+    buffer.Prepare(1);
+    VERIFY_IS_TRUE(_isInline(buffer));
+    buffer.Prepare(InlineCapacity);
+    VERIFY_IS_TRUE(_isInline(buffer));
+    VERIFY_ARE_EQUAL(InlineCapacity, _capacity(buffer));
+
+    Log::Comment(L"One more byte moves the payload to the heap.");
+    const auto heap = buffer.Prepare(InlineCapacity + 1);
+    VERIFY_IS_FALSE(_isInline(buffer));
+    VERIFY_ARE_EQUAL(InlineCapacity + 1, buffer.size());
+
+    Log::Comment(L"It stays there for smaller payloads, as the capacity is kept around.");
+    VERIFY_ARE_EQUAL(heap, buffer.Prepare(InlineCapacity));
+    VERIFY_ARE_EQUAL(heap, buffer.Prepare(1));
+    VERIFY_IS_FALSE(_isInline(buffer));
+}
+
+void ApiMessagePayloadBufferTests::ShrinksOnceTheHighWaterMarkStaysLow()
+{
+    ApiMessagePayloadBuffer buffer;
+    buffer.Prepare(LargePayload);
+
+    Log::Comment(L"The interval that saw the large payload doesn't shrink the buffer.");
+    for (uint32_t i = 1; i < ApiMessagePayloadBuffer::ShrinkInterval; ++i)
+    {
+        buffer.Prepare(16);
+    }
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(_capacity(buffer), LargePayload);
+
+    Log::Comment(L"A payload of more than half the capacity in every interval keeps it from shrinking as well.");
+    const auto halfCapacity = _capacity(buffer) / 2;
+    for (uint32_t i = 0; i < ApiMessagePayloadBuffer::ShrinkInterval; ++i)
+    {
+        buffer.Prepare(i == 0 ? halfCapacity + 1 : 16);
+    }
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(_capacity(buffer), LargePayload);
+
+    Log::Comment(L"A whole interval of small payloads does.");
+    for (uint32_t i = 0; i < ApiMessagePayloadBuffer::ShrinkInterval - 1; ++i)
+    {
+        buffer.Prepare(16);
+    }
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(_capacity(buffer), LargePayload);
+    buffer.Prepare(16);
+    VERIFY_IS_LESS_THAN(_capacity(buffer), LargePayload);
+    VERIFY_ARE_EQUAL(16u, buffer.size());
+}
+
+void ApiMessagePayloadBufferTests::CopiedMessagePointsAtItsOwnPayload()
+{
+    for (const size_t size : { InlineCapacity, InlineCapacity + 1 })
+    {
+        Log::Comment(NoThrowString().Format(L"A payload of %zu bytes", size));
+
+        CONSOLE_API_MSG message;
+        const auto input = message._inputBuffer.Prepare(size);
+        std::iota(input, input + size, BYTE{ 0 });
+        message.State.InputBuffer = input;
+        message.State.InputBufferSize = gsl::narrow<ULONG>(size);
+
+        // Messages are copied when a call has to wait for input, for instance.
+        // An inline payload lives within the message, so the copy has to point at its own.
+        CONSOLE_API_MSG copy{ message };
+        VERIFY_ARE_NOT_EQUAL(message.State.InputBuffer, copy.State.InputBuffer);
+        VERIFY_ARE_EQUAL(static_cast<void*>(copy._inputBuffer.data()), copy.State.InputBuffer);
+        VERIFY_ARE_EQUAL(size, copy._inputBuffer.size());
+        VERIFY_ARE_EQUAL(0, memcmp(input, copy.State.InputBuffer, size));
+        VERIFY_IS_NULL(copy.State.OutputBuffer);
+    }
+}
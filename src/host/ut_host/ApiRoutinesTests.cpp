@@ -439,6 +439,123 @@ class ApiRoutinesTests
         }
     }
 
+    // Writes the given chunks with WriteConsoleA into the second row of the buffer, and what
+    // MultiByteToWideChar makes of all of them with WriteConsoleW into the first row. That's
+    // how WriteConsoleA handled every codepage before it got its ASCII fast path.
+    void _VerifyWriteConsoleAMatchesW(const UINT codepage, const std::initializer_list<std::string_view> chunks)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        auto& textBuffer = si.GetTextBuffer();
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        gci.OutputCP = codepage;
+        SetConsoleCPInfo(TRUE);
+
+        std::string text;
+        for (const auto chunk : chunks)
+        {
+            text.append(chunk);
+        }
+        std::wstring expected(text.size(), L'\0');
+        expected.resize(MultiByteToWideChar(codepage, 0, text.data(), gsl::narrow<int>(text.size()), expected.data(), gsl::narrow<int>(expected.size())));
+        VERIFY_IS_FALSE(expected.empty());
+
+        std::unique_ptr<IWaitRoutine> waiter;
+        size_t read = 0;
+        textBuffer.GetCursor().SetPosition({ 0, 0 });
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleWImpl(si, expected, read, false, waiter));
+        VERIFY_ARE_EQUAL(expected.size(), read);
+        const auto expectedEnd = textBuffer.GetCursor().GetPosition().X;
+
+        Log::Comment(L"Every chunk counts all of its bytes as written, including a lead byte held back for the next one.");
+        textBuffer.GetCursor().SetPosition({ 0, 1 });
+        for (const auto chunk : chunks)
+        {
+            VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleAImpl(si, chunk, read, false, waiter));
+            VERIFY_IS_NULL(waiter.get());
+            VERIFY_ARE_EQUAL(chunk.size(), read);
+        }
+
+        VERIFY_ARE_EQUAL(textBuffer.GetRowByOffset(0).GetText(), textBuffer.GetRowByOffset(1).GetText());
+        VERIFY_ARE_EQUAL(expectedEnd, textBuffer.GetCursor().GetPosition().X);
+    }
+
+    // Converts text the way ReadConsoleA does, and verifies that
+    // it's the same as what WideCharToMultiByte makes of it.
+    void _VerifyTranslateUnicodeToOemMatchesWideCharToMultiByte(const UINT codepage, const std::wstring_view text)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        gci.CP = codepage;
+        SetConsoleCPInfo(FALSE);
+
+        std::string expected(text.size() * 2, '\0');
+        expected.resize(WideCharToMultiByte(codepage, 0, text.data(), gsl::narrow<int>(text.size()), expected.data(), gsl::narrow<int>(expected.size()), nullptr, nullptr));
+        VERIFY_IS_FALSE(expected.empty());
+
+        std::string actual(expected.size(), '\0');
+        std::unique_ptr<IInputEvent> partialEvent;
+        const auto written = TranslateUnicodeToOem(text.data(), gsl::narrow<ULONG>(text.size()), actual.data(), gsl::narrow<ULONG>(actual.size()), partialEvent);
+        VERIFY_ARE_EQUAL(expected.size(), written);
+        VERIFY_ARE_EQUAL(expected, actual);
+        VERIFY_IS_NULL(partialEvent.get());
+    }
+
+    TEST_METHOD(ApiAnsiFastPathPureAscii)
+    {
+        _VerifyWriteConsoleAMatchesW(CP_USA, { "Hello, World!" });
+        _VerifyTranslateUnicodeToOemMatchesWideCharToMultiByte(CP_USA, L"Hello, World!");
+
+        Log::Comment(L"Control characters are part of the ASCII run, and WriteConsoleW still processes them.");
+        _VerifyWriteConsoleAMatchesW(CP_USA, { "tab\tstop\bs" });
+    }
+
+    TEST_METHOD(ApiAnsiFastPathMixedAscii)
+    {
+        Log::Comment(L"0x82 is an e with an acute accent in codepage 437.");
+        _VerifyWriteConsoleAMatchesW(CP_USA, { "caf\x82 au lait" });
+        _VerifyTranslateUnicodeToOemMatchesWideCharToMultiByte(CP_USA, L"caf\xe9 au lait");
+
+        Log::Comment(L"ASCII that follows a DBCS character isn't mistaken for its trail byte.");
+        _VerifyWriteConsoleAMatchesW(CP_JAPANESE, { "J\x82\xa0 ab\x82\xa2" });
+        _VerifyTranslateUnicodeToOemMatchesWideCharToMultiByte(CP_JAPANESE, L"J\x3042 ab\x3044");
+    }
+
+    TEST_METHOD(ApiAnsiFastPathTrailingLeadByte)
+    {
+        Log::Comment(L"A lead byte at the end of a write is joined with the first byte of the next one.");
+        _VerifyWriteConsoleAMatchesW(CP_JAPANESE, { "Text \x82", "\xa0 more" });
+        _VerifyWriteConsoleAMatchesW(CP_JAPANESE, { "\x82", "\xa0", "abc" });
+
+        Log::Comment(L"A DBCS character that doesn't fit into a read leaves its trail byte for the next one.");
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        gci.CP = CP_JAPANESE;
+        SetConsoleCPInfo(FALSE);
+
+        const std::wstring_view text{ L"J\x3042" };
+        char buffer[2]{};
+        std::unique_ptr<IInputEvent> partialEvent;
+        VERIFY_ARE_EQUAL(2u, TranslateUnicodeToOem(text.data(), gsl::narrow<ULONG>(text.size()), &buffer[0], ARRAYSIZE(buffer), partialEvent));
+        VERIFY_ARE_EQUAL('J', buffer[0]);
+        VERIFY_ARE_EQUAL('\x82', buffer[1]);
+        VERIFY_IS_NOT_NULL(partialEvent.get());
+        VERIFY_ARE_EQUAL(L'\xa0', static_cast<const KeyEvent*>(partialEvent.get())->GetCharData());
+    }
+
+    TEST_METHOD(ApiAnsiFastPathNonDefaultCodePage)
+    {
+        Log::Comment(L"Codepage 1251 is Cyrillic, 0xC0 and beyond are its letters.");
+        _VerifyWriteConsoleAMatchesW(1251, { "Hi \xcf\xf0\xe8\xe2\xe5\xf2!" });
+        _VerifyTranslateUnicodeToOemMatchesWideCharToMultiByte(1251, L"Hi \x041f\x0440\x0438\x0432\x0435\x0442!");
+
+        Log::Comment(L"The same bytes mean something else in codepage 1252.");
+        _VerifyWriteConsoleAMatchesW(1252, { "Hi \xcf\xf0\xe8\xe2\xe5\xf2!" });
+        _VerifyTranslateUnicodeToOemMatchesWideCharToMultiByte(1252, L"na\xefve caf\xe9");
+    }
+
     TEST_METHOD(ApiWriteConsoleW)
     {
         BEGIN_TEST_METHOD_PROPERTIES()
@@ -887,4 +1004,46 @@ class ApiRoutinesTests
 
         ValidateComplexScreen(si, background, fill, scrollRect, Viewport::FromInclusive(scroll), destination, clipViewport);
     }
+
+    TEST_METHOD(ApiWriteConsoleOutputWSkipsUnchangedCells)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        const auto& textBuffer = std::as_const(si.GetTextBuffer());
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        CHAR_INFO background;
+        background.Char.UnicodeChar = L'Z';
+        background.Attributes = FOREGROUND_GREEN;
+
+        std::vector<CHAR_INFO> cells(10 * 3, background);
+        const auto rectangle = Viewport::FromDimensions({ 0, 0 }, { 10, 3 });
+        Viewport written;
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, cells, rectangle, written));
+        VERIFY_ARE_EQUAL(rectangle, written);
+
+        const auto revision0 = textBuffer.GetRowByOffset(0).GetRevision();
+        const auto revision1 = textBuffer.GetRowByOffset(1).GetRevision();
+
+        Log::Comment(L"Blit the same rectangle again, with a single changed cell in the second row.");
+        cells.at(10 + 4).Char.UnicodeChar = L'A';
+        cells.at(10 + 4).Attributes = FOREGROUND_RED;
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, cells, rectangle, written));
+        VERIFY_ARE_EQUAL(rectangle, written);
+
+        Log::Comment(L"The unchanged row mustn't have been written to.");
+        VERIFY_ARE_EQUAL(revision0, textBuffer.GetRowByOffset(0).GetRevision());
+        VERIFY_ARE_NOT_EQUAL(revision1, textBuffer.GetRowByOffset(1).GetRevision());
+
+        for (SHORT y = 0; y < 3; ++y)
+        {
+            for (SHORT x = 0; x < 10; ++x)
+            {
+                const auto expected = cells.at(y * 10 + x);
+                VERIFY_ARE_EQUAL(expected, gci.AsCharInfo(*si.GetCellDataAt({ x, y })));
+            }
+        }
+    }
 };
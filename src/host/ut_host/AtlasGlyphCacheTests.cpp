@@ -0,0 +1,256 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+// AtlasEngine.h relies on the precompiled header of the atlas project for this.
+#include <til/hash.h>
+
+#include "../../renderer/atlas/AtlasEngine.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class Microsoft::Console::Render::AtlasGlyphCacheTests
+{
+    TEST_CLASS(AtlasGlyphCacheTests);
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        wchar_t directory[MAX_PATH + 1];
+        THROW_LAST_ERROR_IF(GetTempPathW(ARRAYSIZE(directory), directory) == 0);
+        _path = fmt::format(L"{}AtlasGlyphCacheTests-{}.bin", directory, GetCurrentProcessId());
+        std::filesystem::remove(_path);
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        std::error_code ec;
+        std::filesystem::remove(_path, ec);
+        return true;
+    }
+
+    TEST_METHOD(SavedGlyphsAreLoaded);
+    TEST_METHOD(MissingFileIsIgnored);
+    TEST_METHOD(TruncatedFileIsRejected);
+    TEST_METHOD(BadMagicOrVersionIsRejected);
+    TEST_METHOD(DifferentFileKeyIsRejected);
+    TEST_METHOD(OversizeCountsAreRejected);
+    TEST_METHOD(OversizeFileIsRejected);
+
+    using SharedGlyphCache = AtlasEngine::SharedGlyphCache;
+    using AtlasKey = AtlasEngine::AtlasKey;
+    using FileHeader = SharedGlyphCache::FileHeader;
+    using FileGlyph = SharedGlyphCache::FileGlyph;
+    using u8 = AtlasEngine::u8;
+    using u16 = AtlasEngine::u16;
+    using u32 = AtlasEngine::u32;
+
+    // The file key of a real cache holds binary data as well, see _rasterizeWarmupGlyphs().
+    const std::wstring _fileKey{ L"Cascadia Mono\0\x1234\x5678", 16 };
+    std::filesystem::path _path;
+
+    static AtlasKey _key(const std::wstring_view chars, const u16 cellCount = 1)
+    {
+        return AtlasKey{ { 0, 0, 0, cellCount }, gsl::narrow<u16>(chars.size()), chars.data() };
+    }
+
+    static std::vector<u8> _pixels(const size_t count, const u8 first)
+    {
+        std::vector<u8> pixels(count);
+        std::iota(pixels.begin(), pixels.end(), first);
+        return pixels;
+    }
+
+    static void _insert(SharedGlyphCache& cache, const AtlasKey& key, const std::vector<u8>& pixels)
+    {
+        cache.insert(key, AtlasEngine::Buffer<u8>{ pixels.data(), pixels.size() });
+    }
+
+    static void _verifyPixels(const SharedGlyphCache& cache, const AtlasKey& key, const std::vector<u8>& expected)
+    {
+        const auto pixels = cache.find(key);
+        VERIFY_ARE_EQUAL(expected.size(), pixels.size());
+        VERIFY_IS_TRUE(std::equal(expected.begin(), expected.end(), pixels.begin()));
+    }
+
+    // Returns the contents of a file that save() wrote for a few glyphs.
+    // One of them has an odd number of pixels, which makes save() pad them.
+    std::string _savedFile() const
+    {
+        SharedGlyphCache cache;
+        _insert(cache, _key(L"a"), _pixels(6, 1));
+        _insert(cache, _key(L"b"), _pixels(5, 2));
+        _insert(cache, _key(L"\xD83D\xDE00", 2), _pixels(8, 3));
+        cache.save(_path, _fileKey);
+
+        std::ifstream file{ _path, std::ios::binary };
+        return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    }
+
+    void _writeFile(const std::string_view data) const
+    {
+        std::ofstream file{ _path, std::ios::binary | std::ios::trunc };
+        file.write(data.data(), data.size());
+    }
+
+    template<typename T>
+    static void _patch(std::string& data, const size_t offset, const T value)
+    {
+        VERIFY_IS_LESS_THAN_OR_EQUAL(offset + sizeof(value), data.size());
+        memcpy(data.data() + offset, &value, sizeof(value));
+    }
+
+    size_t _firstGlyphOffset() const noexcept
+    {
+        return sizeof(FileHeader) + _fileKey.size() * sizeof(wchar_t);
+    }
+
+    // A damaged file mustn't add any of its glyphs to the cache, nor remove the ones already in it.
+    void _verifyRejected(const std::string_view data, const std::wstring_view fileKey = {}) const
+    {
+        _writeFile(data);
+
+        SharedGlyphCache cache;
+        _insert(cache, _key(L"z"), _pixels(4, 0));
+        VERIFY_IS_FALSE(cache.load(_path, fileKey.empty() ? _fileKey : std::wstring{ fileKey }));
+        VERIFY_ARE_EQUAL(1u, cache._glyphs.size());
+        _verifyPixels(cache, _key(L"z"), _pixels(4, 0));
+    }
+};
+
+using namespace Microsoft::Console::Render;
+
+void AtlasGlyphCacheTests::SavedGlyphsAreLoaded()
+{
+    _writeFile(_savedFile());
+
+    SharedGlyphCache cache;
+    VERIFY_IS_TRUE(cache.load(_path, _fileKey));
+    VERIFY_ARE_EQUAL(3u, cache._glyphs.size());
+    _verifyPixels(cache, _key(L"a"), _pixels(6, 1));
+    _verifyPixels(cache, _key(L"b"), _pixels(5, 2));
+    _verifyPixels(cache, _key(L"\xD83D\xDE00", 2), _pixels(8, 3));
+
+    Log::Comment(L"Glyphs that are already in the cache are kept as they are.");
+    VERIFY_IS_TRUE(cache.load(_path, _fileKey));
+    VERIFY_ARE_EQUAL(3u, cache._glyphs.size());
+}
+
+void AtlasGlyphCacheTests::MissingFileIsIgnored()
+{
+    SharedGlyphCache cache;
+    VERIFY_IS_FALSE(cache.load(_path, _fileKey));
+    VERIFY_IS_TRUE(cache._glyphs.empty());
+}
+
+void AtlasGlyphCacheTests::TruncatedFileIsRejected()
+{
+    const auto data = _savedFile();
+    const auto firstGlyph = _firstGlyphOffset();
+
+    const std::array<size_t, 8> lengths{
+        0,
+        1,
+        sizeof(FileHeader) - 1, // within the header
+        sizeof(FileHeader), // just the header
+        firstGlyph - 1, // within the file key
+        firstGlyph + sizeof(FileGlyph) - 1, // within the first glyph's header
+        firstGlyph + sizeof(FileGlyph) + 1, // within the first glyph's characters
+        data.size() - 1, // within the last glyph's pixels or their padding
+    };
+    for (const auto length : lengths)
+    {
+        Log::Comment(NoThrowString().Format(L"%zu of %zu bytes", length, data.size()));
+        _verifyRejected(std::string_view{ data }.substr(0, length));
+    }
+}
+
+void AtlasGlyphCacheTests::BadMagicOrVersionIsRejected()
+{
+    const auto data = _savedFile();
+
+    {
+        auto damaged = data;
+        _patch(damaged, offsetof(FileHeader, magic), SharedGlyphCache::fileMagic ^ 1);
+        _verifyRejected(damaged);
+    }
+    {
+        Log::Comment(L"Files of earlier and later versions are ignored, as their layout may differ.");
+        auto damaged = data;
+        _patch(damaged, offsetof(FileHeader, version), SharedGlyphCache::fileVersion + 1);
+        _verifyRejected(damaged);
+        _patch(damaged, offsetof(FileHeader, version), SharedGlyphCache::fileVersion - 1);
+        _verifyRejected(damaged);
+    }
+}
+
+void AtlasGlyphCacheTests::DifferentFileKeyIsRejected()
+{
+    const auto data = _savedFile();
+
+    Log::Comment(L"The file of a font whose files changed since, or whose name happens to have the same hash.");
+    auto otherKey = _fileKey;
+    otherKey.back() ^= 1;
+    _verifyRejected(data, otherKey);
+    _verifyRejected(data, _fileKey + L"x");
+    _verifyRejected(data, std::wstring_view{ _fileKey }.substr(0, _fileKey.size() - 1));
+}
+
+void AtlasGlyphCacheTests::OversizeCountsAreRejected()
+{
+    const auto data = _savedFile();
+    const auto firstGlyph = _firstGlyphOffset();
+
+    Log::Comment(L"Key lengths that don't match the file key, up to the largest one.");
+    for (const auto keyLength : { gsl::narrow<u32>(_fileKey.size() + 1), UINT32_MAX })
+    {
+        auto damaged = data;
+        _patch(damaged, offsetof(FileHeader, keyLength), keyLength);
+        _verifyRejected(damaged);
+    }
+
+    Log::Comment(L"More glyphs than there are, or than a cache may hold.");
+    for (const auto glyphCount : { u32{ 4 }, gsl::narrow<u32>(SharedGlyphCache::maxGlyphs + 1), UINT32_MAX })
+    {
+        auto damaged = data;
+        _patch(damaged, offsetof(FileHeader, glyphCount), glyphCount);
+        _verifyRejected(damaged);
+    }
+
+    Log::Comment(L"Characters and pixels that would reach past the end of the file.");
+    for (const auto charCount : { u16{ 0 }, u16{ 0xffff } })
+    {
+        auto damaged = data;
+        _patch(damaged, firstGlyph + offsetof(FileGlyph, charCount), charCount);
+        _verifyRejected(damaged);
+    }
+    for (const auto pixelCount : { gsl::narrow<u32>(data.size()), UINT32_MAX - 1, UINT32_MAX })
+    {
+        auto damaged = data;
+        _patch(damaged, firstGlyph + offsetof(FileGlyph, pixelCount), pixelCount);
+        _verifyRejected(damaged);
+    }
+
+    Log::Comment(L"A glyph without any cells.");
+    {
+        auto damaged = data;
+        _patch(damaged, firstGlyph + offsetof(FileGlyph, attributes), u16{ 0 });
+        _verifyRejected(damaged);
+    }
+}
+
+void AtlasGlyphCacheTests::OversizeFileIsRejected()
+{
+    Log::Comment(L"A file with a valid start that's larger than any cache is ignored without reading it.");
+    _writeFile(_savedFile());
+    std::filesystem::resize_file(_path, 64 * 1024 * 1024 + 1);
+
+    SharedGlyphCache cache;
+    VERIFY_IS_FALSE(cache.load(_path, _fileKey));
+    VERIFY_IS_TRUE(cache._glyphs.empty());
+}
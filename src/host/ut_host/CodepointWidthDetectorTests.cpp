@@ -74,6 +74,23 @@ class CodepointWidthDetectorTests
         }
     }
 
+    TEST_METHOD(CanGetWidthsAtRangeBoundaries)
+    {
+        // The lookup only searches the ranges overlapping the 256 codepoint page
+        // the codepoint is in. Test the edges of ranges that span several pages.
+        CodepointWidthDetector widthDetector;
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector._lookupGlyphWidth(L"\x10FF"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector._lookupGlyphWidth(L"\x1100"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector._lookupGlyphWidth(L"\x115F"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector._lookupGlyphWidth(L"\x1160"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector._lookupGlyphWidth(L"\xD840\xDC00")); // U+20000
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector._lookupGlyphWidth(L"\xD87F\xDC00")); // U+2FC00
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector._lookupGlyphWidth(L"\xD87F\xDFFD")); // U+2FFFD
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector._lookupGlyphWidth(L"\xD87F\xDFFE")); // U+2FFFE
+        VERIFY_ARE_EQUAL(CodepointWidth::Ambiguous, widthDetector._lookupGlyphWidth(L"\xDBFF\xDFFD")); // U+10FFFD
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector._lookupGlyphWidth(L"\xDBFF\xDFFF")); // U+10FFFF
+    }
+
     TEST_METHOD(AmbiguousCache)
     {
         // Set up a detector with fallback.
@@ -91,7 +108,7 @@ class CodepointWidthDetectorTests
 
         // Cached item should match what we expect
         const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous, it->first);
+        VERIFY_ARE_EQUAL(0x414u, it->first);
         VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), it->second);
 
         // Cache should empty when font changes.
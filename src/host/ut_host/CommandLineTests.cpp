@@ -406,6 +406,41 @@ class CommandLineTests
         VerifyPromptText(cookedReadData, L"\x1a"); // ctrl-z
     }
 
+    TEST_METHOD(EchoesInsertionsIntoTheMiddleOfTheLineOnce)
+    {
+        auto buffer = std::make_unique<wchar_t[]>(PROMPT_SIZE);
+        VERIFY_IS_NOT_NULL(buffer.get());
+
+        auto& consoleInfo = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& screenInfo = consoleInfo.GetActiveOutputBuffer();
+        auto& cursor = screenInfo.GetTextBuffer().GetCursor();
+        auto& cookedReadData = consoleInfo.CookedReadData();
+        InitCookedReadData(cookedReadData, nullptr, buffer.get(), PROMPT_SIZE);
+        cookedReadData._insertMode = true;
+
+        cursor.SetPosition({ 0, 0 });
+        VERIFY_ARE_EQUAL(3u, cookedReadData.Write(L"wld"));
+        MoveCursor(cookedReadData, 1);
+        cursor.SetPosition({ 1, 0 });
+
+        Log::Comment(L"Characters inserted into the middle of the line aren't echoed right away.");
+        NTSTATUS status = STATUS_SUCCESS;
+        for (const auto wch : std::wstring_view{ L"orl" })
+        {
+            VERIFY_IS_FALSE(cookedReadData.ProcessInput(wch, 0, status));
+            VERIFY_NT_SUCCESS(status);
+        }
+        VerifyPromptText(cookedReadData, L"world");
+        VERIFY_ARE_EQUAL(std::wstring{ L"wld" }, screenInfo.GetTextBuffer().GetRowByOffset(0).GetText().substr(0, 3));
+        VERIFY_ARE_EQUAL(COORD{ 1, 0 }, cursor.GetPosition());
+
+        Log::Comment(L"They're all echoed at once, and the cursor is moved behind them.");
+        cookedReadData._flushPendingEcho();
+        VERIFY_ARE_EQUAL(std::wstring{ L"world" }, screenInfo.GetTextBuffer().GetRowByOffset(0).GetText().substr(0, 5));
+        VERIFY_ARE_EQUAL(COORD{ 4, 0 }, cursor.GetPosition());
+        VERIFY_ARE_EQUAL(5u, cookedReadData.VisibleCharCount());
+    }
+
     TEST_METHOD(CanDeleteCommandHistory)
     {
         auto buffer = std::make_unique<wchar_t[]>(PROMPT_SIZE);
@@ -89,6 +89,7 @@ class ConptyOutputTests
                                                                initialViewport);
         auto pfn = std::bind(&ConptyOutputTests::_writeCallback, this, std::placeholders::_1, std::placeholders::_2);
         vtRenderEngine->SetTestCallback(pfn);
+        _pVtRenderEngine = vtRenderEngine.get();
 
         g.pRender->AddRenderEngine(vtRenderEngine.get());
         gci.GetActiveOutputBuffer().SetTerminalConnection(vtRenderEngine.get());
@@ -121,12 +122,16 @@ class ConptyOutputTests
     TEST_METHOD(WriteAFewSimpleLines);
     TEST_METHOD(InvalidateUntilOneBeforeEnd);
     TEST_METHOD(SetConsoleTitleWithControlChars);
+    TEST_METHOD(PassthroughWritesOutputVerbatim);
+    TEST_METHOD(SynchronizedOutputIsPresentedAtOnce);
+    TEST_METHOD(FrameDiffSkipsUnchangedSpans);
 
 private:
     bool _writeCallback(const char* const pch, size_t const cch);
     void _flushFirstFrame();
     std::deque<std::string> expectedOutput;
     std::unique_ptr<CommonState> m_state;
+    VtEngine* _pVtRenderEngine{ nullptr };
 };
 
 bool ConptyOutputTests::_writeCallback(const char* const pch, size_t const cch)
@@ -400,3 +405,101 @@ void ConptyOutputTests::SetConsoleTitleWithControlChars()
 
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 }
+
+void ConptyOutputTests::SynchronizedOutputIsPresentedAtOnce()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Frames aren't painted in the middle of a synchronized update. The frame "
+        L"that contains the update is bracketed in the same sequences for the terminal."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    _flushFirstFrame();
+
+    sm.ProcessString(L"\x1b[?2026hHello");
+    // Nothing is expected yet: the update isn't complete.
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    sm.ProcessString(L" World\x1b[?2026l");
+    expectedOutput.push_back("\x1b[?2026h");
+    expectedOutput.push_back("Hello World");
+    expectedOutput.push_back("\x1b[?2026l");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+}
+
+void ConptyOutputTests::PassthroughWritesOutputVerbatim()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Pass some output through to the terminal. It should be written as is, "
+        L"while our buffer is still updated, and not be rendered again."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+    auto& tb = si.GetTextBuffer();
+    auto& vtIo = *gci.GetVtIo();
+
+    _flushFirstFrame();
+
+    const std::wstring_view output{ L"\x1b[31mHello\x1b[2;3HWorld" };
+    expectedOutput.push_back("\x1b[31mHello\x1b[2;3HWorld");
+
+    vtIo.BeginPassthrough();
+    sm.ProcessString(output);
+    vtIo.EndPassthrough(output);
+
+    {
+        auto iter = tb.GetCellDataAt({ 0, 0 });
+        VERIFY_ARE_EQUAL(L"H", (iter++)->Chars());
+        VERIFY_ARE_EQUAL(L"e", (iter++)->Chars());
+    }
+    {
+        auto iter = tb.GetCellDataAt({ 2, 1 });
+        VERIFY_ARE_EQUAL(L"W", (iter++)->Chars());
+        VERIFY_ARE_EQUAL(L"o", (iter++)->Chars());
+    }
+    VERIFY_ARE_EQUAL(COORD({ 7, 1 }), tb.GetCursor().GetPosition());
+
+    Log::Comment(L"The terminal already has all of this, so the next frame is empty.");
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+}
+
+void ConptyOutputTests::FrameDiffSkipsUnchangedSpans()
+{
+    Log::Comment(NoThrowString().Format(
+        L"With frame diffing, rewriting text that the terminal already "
+        L"displays shouldn't emit anything."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    _pVtRenderEngine->SetFrameDiff(true);
+    _flushFirstFrame();
+
+    sm.ProcessString(L"AAA");
+    sm.ProcessString(L"\x1b[2;1H");
+    sm.ProcessString(L"BBB");
+
+    expectedOutput.push_back("AAA");
+    expectedOutput.push_back("\r\n");
+    expectedOutput.push_back("BBB");
+
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+    Log::Comment(L"Write the same text again. The frame should be empty.");
+    sm.ProcessString(L"\x1b[1;1H");
+    sm.ProcessString(L"AAA");
+    sm.ProcessString(L"\x1b[2;1H");
+    sm.ProcessString(L"BBB");
+
+    VERIFY_SUCCEEDED(renderer.PaintFrame());
+}
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../../types/inc/GraphemeParser.hpp"
+#include "../../types/inc/CodepointWidthDetector.hpp"
+#include "../../inc/unicode.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class GraphemeParserTests
+{
+    TEST_CLASS(GraphemeParserTests);
+
+    // Splits the text into all of its clusters.
+    static std::vector<std::wstring> _split(std::wstring_view text)
+    {
+        std::vector<std::wstring> clusters;
+        while (!text.empty())
+        {
+            const auto cluster = GraphemeParser::ParseNext(text);
+            clusters.emplace_back(cluster);
+            text = text.substr(cluster.size());
+        }
+        return clusters;
+    }
+
+    TEST_METHOD(KeepsAsciiApart)
+    {
+        const std::vector<std::wstring> expected{ L"a", L"b", L" ", L"\t", L"~" };
+        VERIFY_ARE_EQUAL(expected, _split(L"ab \t~"));
+    }
+
+    TEST_METHOD(KeepsCarriageReturnAndLineFeedTogether)
+    {
+        const std::vector<std::wstring> expected{ L"\r\n", L"\n", L"\r", L"a" };
+        VERIFY_ARE_EQUAL(expected, _split(L"\r\n\n\ra"));
+
+        // Controls never take any combining marks.
+        const std::vector<std::wstring> controls{ L"\r", L"\x301" };
+        VERIFY_ARE_EQUAL(controls, _split(L"\r\x301"));
+    }
+
+    TEST_METHOD(KeepsCombiningMarksWithTheirBase)
+    {
+        // e + combining acute accent + combining diaeresis, followed by x
+        const std::vector<std::wstring> expected{ L"e\x301\x308", L"x" };
+        VERIFY_ARE_EQUAL(expected, _split(L"e\x301\x308x"));
+
+        // A spacing mark belongs to its base, too, like the vowel sign i of ki (कि).
+        const std::vector<std::wstring> devanagari{ L"\x915\x93F", L"\x915" };
+        VERIFY_ARE_EQUAL(devanagari, _split(L"\x915\x93F\x915"));
+    }
+
+    TEST_METHOD(PairsRegionalIndicators)
+    {
+        const std::wstring de{ L"\xD83C\xDDE9\xD83C\xDDEA" }; // 🇩🇪
+        const std::wstring fr{ L"\xD83C\xDDEB\xD83C\xDDF7" }; // 🇫🇷
+        const std::wstring f{ L"\xD83C\xDDEB" };
+
+        const std::vector<std::wstring> expected{ de, fr };
+        VERIFY_ARE_EQUAL(expected, _split(de + fr));
+
+        // An odd one out stands on its own.
+        const std::vector<std::wstring> odd{ de, f };
+        VERIFY_ARE_EQUAL(odd, _split(de + f));
+    }
+
+    TEST_METHOD(KeepsEmojiSequencesTogether)
+    {
+        const std::wstring family{ L"\xD83D\xDC68\x200D\xD83D\xDC69\x200D\xD83D\xDC67" }; // 👨‍👩‍👧
+        const std::wstring thumbsUp{ L"\xD83D\xDC4D\xD83C\xDFFD" }; // 👍🏽 (medium skin tone)
+        const std::wstring heart{ L"\x2764\xFE0F" }; // ❤️
+
+        const std::vector<std::wstring> expected{ family, thumbsUp, heart, L"a" };
+        VERIFY_ARE_EQUAL(expected, _split(family + thumbsUp + heart + L"a"));
+
+        // A ZWJ only joins emoji with each other, not letters.
+        const std::vector<std::wstring> letters{ L"a\x200D", L"b" };
+        VERIFY_ARE_EQUAL(letters, _split(L"a\x200D" L"b"));
+    }
+
+    TEST_METHOD(KeepsHangulSyllablesTogether)
+    {
+        // Conjoining jamos: L + V + T
+        const std::vector<std::wstring> jamos{ L"\x1100\x1161\x11A8", L"\x1100" };
+        VERIFY_ARE_EQUAL(jamos, _split(L"\x1100\x1161\x11A8\x1100"));
+
+        // A precomposed LV syllable (가) takes a trailing T, but no other syllable.
+        const std::vector<std::wstring> syllables{ L"\xAC00\x11A8", L"\xAC00", L"\xAC01" };
+        VERIFY_ARE_EQUAL(syllables, _split(L"\xAC00\x11A8\xAC00\xAC01"));
+
+        VERIFY_IS_TRUE(GraphemeClusterBreak::LV == GraphemeParser::GetBreakProperty(0xAC00));
+        VERIFY_IS_TRUE(GraphemeClusterBreak::LVT == GraphemeParser::GetBreakProperty(0xAC01));
+    }
+
+    TEST_METHOD(ReplacesUnpairedSurrogates)
+    {
+        for (const std::wstring_view text : { L"", L"\xD800", L"\xDC00", L"\xD800" L"a", L"\xDC00\xD800" })
+        {
+            const auto cluster = GraphemeParser::ParseNext(text);
+            VERIFY_ARE_EQUAL(1u, cluster.size());
+            VERIFY_ARE_EQUAL(UNICODE_REPLACEMENT, cluster.front());
+        }
+
+        // A base character takes no unpaired surrogate along with it either.
+        const std::vector<std::wstring> expected{ L"a", L"\xFFFD", L"b" };
+        VERIFY_ARE_EQUAL(expected, _split(L"a\xDC00" L"b"));
+    }
+
+    TEST_METHOD(MeasuresClustersByTheirFirstCodepoint)
+    {
+        CodepointWidthDetector widthDetector;
+
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector.GetWidth(L"e\x301"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector.GetWidth(L"\x4E00\x301"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector.GetWidth(L"\xD83D\xDC4D\xD83C\xDFFD"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector.GetWidth(L"\x1100\x1161\x11A8"));
+
+        // An emoji presentation selector turns a narrow symbol into a wide emoji.
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector.GetWidth(L"\x2764"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector.GetWidth(L"\x2764\xFE0F"));
+    }
+};
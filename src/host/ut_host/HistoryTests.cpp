@@ -242,6 +242,53 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
     }
 
+    TEST_METHOD(FindMatchingCommandByPrefix)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+
+        VERIFY_SUCCEEDED(history->Add(L"dir /w", false));
+        VERIFY_SUCCEEDED(history->Add(L"cd ..", false));
+        VERIFY_SUCCEEDED(history->Add(L"DIR /P", false));
+        VERIFY_SUCCEEDED(history->Add(L"ipconfig", false));
+
+        Log::Comment(L"The most recent command before the starting index that starts with the prefix is found, ignoring case.");
+        SHORT index = 0;
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"Dir", 3, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(2i16, index);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 2, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(0i16, index);
+
+        Log::Comment(L"Exact matches need the whole command.");
+        VERIFY_IS_FALSE(history->FindMatchingCommand(L"cd", 3, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"CD ..", 3, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(1i16, index);
+
+        Log::Comment(L"Removing and swapping commands keeps the search in sync.");
+        history->Swap(0, 1);
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir /w", 2, index, CommandHistory::MatchOptions::JustLooking | CommandHistory::MatchOptions::ExactMatch));
+        VERIFY_ARE_EQUAL(1i16, index);
+        VERIFY_ARE_EQUAL(std::wstring{ L"dir /w" }, history->Remove(1));
+        VERIFY_IS_TRUE(history->FindMatchingCommand(L"dir", 2, index, CommandHistory::MatchOptions::JustLooking));
+        VERIFY_ARE_EQUAL(1i16, index);
+    }
+
+    TEST_METHOD(ReallocExeToFrontKeepsHistory)
+    {
+        auto first = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        auto second = CommandHistory::s_Allocate(_manyApps[1], _MakeHandle(1));
+        VERIFY_IS_NOT_NULL(first);
+        VERIFY_IS_NOT_NULL(second);
+        VERIFY_SUCCEEDED(first->Add(L"dir", false));
+
+        CommandHistory::s_ReallocExeToFront(_manyApps[0], s_BufferSize * 2);
+
+        Log::Comment(L"The history is moved to the front of the list, not copied there.");
+        VERIFY_ARE_EQUAL(first, &CommandHistory::s_historyLists.front());
+        VERIFY_ARE_EQUAL(first, CommandHistory::s_FindByExe(_manyApps[0]));
+        VERIFY_ARE_EQUAL(1u, first->GetNumberOfCommands());
+    }
+
 private:
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
@@ -0,0 +1,161 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../server/ProcessList.h"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+class ProcessListTests
+{
+    TEST_CLASS(ProcessListTests);
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        // The list may only be changed under the console lock.
+        ServiceLocator::LocateGlobals().getConsoleInformation().LockConsole();
+        _list = std::make_unique<ConsoleProcessList>();
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        // Anything a test left behind is freed, so that the next one starts out empty.
+        while (const auto process = _list->GetFirstProcess())
+        {
+            _list->FreeProcessData(process);
+        }
+        _list.reset();
+        ServiceLocator::LocateGlobals().getConsoleInformation().UnlockConsole();
+        return true;
+    }
+
+    // These IDs don't belong to any running process, so opening them fails
+    // and the handles are left empty. The list doesn't need more than that.
+    static constexpr DWORD FirstProcessId = 0xFFFF0000;
+
+    ConsoleProcessHandle* _add(const DWORD processId, const ULONG groupId = 0)
+    {
+        ConsoleProcessHandle* process = nullptr;
+        VERIFY_SUCCEEDED(_list->AllocProcessData(processId, 0, groupId, nullptr, &process));
+        VERIFY_IS_NOT_NULL(process);
+        return process;
+    }
+
+    std::vector<DWORD> _getProcessIds() const
+    {
+        std::vector<DWORD> processIds(16);
+        auto count = processIds.size();
+        VERIFY_SUCCEEDED(_list->GetProcessList(processIds.data(), &count));
+        processIds.resize(count);
+        return processIds;
+    }
+
+    std::unique_ptr<ConsoleProcessList> _list;
+
+    TEST_METHOD(AddedProcessesAreFoundById)
+    {
+        const auto first = _add(FirstProcessId);
+        const auto second = _add(FirstProcessId + 1);
+        const auto third = _add(FirstProcessId + 2);
+
+        VERIFY_IS_FALSE(_list->IsEmpty());
+        VERIFY_ARE_EQUAL(first, _list->FindProcessInList(FirstProcessId));
+        VERIFY_ARE_EQUAL(second, _list->FindProcessInList(FirstProcessId + 1));
+        VERIFY_ARE_EQUAL(third, _list->FindProcessInList(FirstProcessId + 2));
+        VERIFY_IS_NULL(_list->FindProcessInList(FirstProcessId + 3));
+
+        Log::Comment(L"The index doesn't change the order GetConsoleProcessList reports: newest to oldest.");
+        const std::vector<DWORD> expected{ FirstProcessId + 2, FirstProcessId + 1, FirstProcessId };
+        VERIFY_ARE_EQUAL(expected, _getProcessIds());
+        VERIFY_ARE_EQUAL(third, _list->GetFirstProcess());
+    }
+
+    TEST_METHOD(AddingAKnownProcessReturnsItsHandle)
+    {
+        const auto process = _add(FirstProcessId);
+        const auto parent = _add(FirstProcessId + 1);
+
+        Log::Comment(L"Connecting the same process twice is refused.");
+        ConsoleProcessHandle* duplicate = nullptr;
+        VERIFY_ARE_EQUAL(E_FAIL, _list->AllocProcessData(FirstProcessId, 0, 0, nullptr, &duplicate));
+        VERIFY_IS_NULL(duplicate);
+
+        Log::Comment(L"With a parent, as for GenerateConsoleCtrlEvent, the existing handle is returned instead.");
+        VERIFY_SUCCEEDED(_list->AllocProcessData(FirstProcessId, 0, 0, parent, &duplicate));
+        VERIFY_ARE_EQUAL(process, duplicate);
+
+        const std::vector<DWORD> expected{ FirstProcessId + 1, FirstProcessId };
+        VERIFY_ARE_EQUAL(expected, _getProcessIds());
+    }
+
+    TEST_METHOD(RemovedProcessesAreNotFound)
+    {
+        const auto first = _add(FirstProcessId);
+        const auto second = _add(FirstProcessId + 1);
+        const auto third = _add(FirstProcessId + 2);
+
+        Log::Comment(L"Removing a process from the middle of the list leaves the others where they are.");
+        _list->FreeProcessData(second);
+        VERIFY_IS_NULL(_list->FindProcessInList(FirstProcessId + 1));
+        VERIFY_ARE_EQUAL(first, _list->FindProcessInList(FirstProcessId));
+        VERIFY_ARE_EQUAL(third, _list->FindProcessInList(FirstProcessId + 2));
+
+        const std::vector<DWORD> expected{ FirstProcessId + 2, FirstProcessId };
+        VERIFY_ARE_EQUAL(expected, _getProcessIds());
+
+        Log::Comment(L"Removing the newest and the oldest one empties the list.");
+        _list->FreeProcessData(third);
+        _list->FreeProcessData(first);
+        VERIFY_IS_TRUE(_list->IsEmpty());
+        VERIFY_IS_NULL(_list->FindProcessInList(FirstProcessId));
+        VERIFY_IS_NULL(_list->FindProcessInList(FirstProcessId + 2));
+        VERIFY_IS_NULL(_list->GetFirstProcess());
+    }
+
+    TEST_METHOD(RemovedProcessIdCanBeAddedAgain)
+    {
+        _add(FirstProcessId);
+        const auto reused = _add(FirstProcessId + 1);
+        _list->FreeProcessData(reused);
+
+        Log::Comment(L"Process IDs get reused. A new process with the ID of a removed one is a new entry, at the front.");
+        const auto process = _add(FirstProcessId + 1);
+        VERIFY_ARE_EQUAL(process, _list->FindProcessInList(FirstProcessId + 1));
+
+        const std::vector<DWORD> expected{ FirstProcessId + 1, FirstProcessId };
+        VERIFY_ARE_EQUAL(expected, _getProcessIds());
+    }
+
+    TEST_METHOD(RootAndGroupLookupsFollowRemovals)
+    {
+        const auto first = _add(FirstProcessId, 1);
+        const auto second = _add(FirstProcessId + 1, 2);
+        const auto third = _add(FirstProcessId + 2, 2);
+
+        Log::Comment(L"The root process isn't in the index, it's found by its flag.");
+        VERIFY_IS_NULL(_list->FindProcessInList(ConsoleProcessList::ROOT_PROCESS_ID));
+        second->fRootProcess = true;
+        VERIFY_ARE_EQUAL(second, _list->FindProcessInList(ConsoleProcessList::ROOT_PROCESS_ID));
+
+        Log::Comment(L"Looking up by group ID finds the newest process of the group.");
+        VERIFY_ARE_EQUAL(first, _list->FindProcessByGroupId(1));
+        VERIFY_ARE_EQUAL(third, _list->FindProcessByGroupId(2));
+        VERIFY_IS_NULL(_list->FindProcessByGroupId(3));
+
+        Log::Comment(L"After the root process is removed, neither lookup finds it anymore.");
+        _list->FreeProcessData(second);
+        VERIFY_IS_NULL(_list->FindProcessInList(ConsoleProcessList::ROOT_PROCESS_ID));
+        _list->FreeProcessData(third);
+        VERIFY_IS_NULL(_list->FindProcessByGroupId(2));
+        VERIFY_ARE_EQUAL(first, _list->FindProcessByGroupId(1));
+    }
+};
@@ -0,0 +1,219 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../PtySignalInputThread.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class Microsoft::Console::PtySignalInputThreadTests
+{
+    BEGIN_TEST_CLASS(PtySignalInputThreadTests)
+        TEST_CLASS_PROPERTY(L"IsolationLevel", L"Class")
+    END_TEST_CLASS()
+
+    TEST_METHOD(SplitHeader);
+    TEST_METHOD(SplitPayload);
+    TEST_METHOD(OneByteAtATime);
+    TEST_METHOD(SeveralMessagesInOneRead);
+    TEST_METHOD(UnknownMessageTypeIsSkipped);
+    TEST_METHOD(OversizeMessageIsRejected);
+    TEST_METHOD(NewerVersionIsFramedBySize);
+
+    using PtySignal = PtySignalInputThread::PtySignal;
+    using PtyMessage = PtySignalInputThread::PtyMessage;
+
+    // The thread is never started, so nothing is ever read from the pipe.
+    // The signals are fed to it with _ProcessRead instead, the way
+    // _ReadCompleted does for every overlapped read that completes.
+    static std::unique_ptr<PtySignalInputThread> _newThread()
+    {
+        wil::unique_hfile readPipe;
+        wil::unique_hfile writePipe;
+        THROW_IF_WIN32_BOOL_FALSE(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 0));
+        return std::make_unique<PtySignalInputThread>(std::move(readPipe));
+    }
+
+    template<typename T>
+    static void _append(std::vector<BYTE>& bytes, const T& value)
+    {
+        const auto begin = reinterpret_cast<const BYTE*>(&value);
+        bytes.insert(bytes.end(), begin, begin + sizeof(value));
+    }
+
+    static void _appendResize(std::vector<BYTE>& bytes, const unsigned short sx, const unsigned short sy)
+    {
+        _append(bytes, PtySignal::ResizeWindow);
+        _append(bytes, PtySignalInputThread::ResizeWindowData{ sx, sy });
+    }
+
+    static void _appendMessage(std::vector<BYTE>& bytes, const unsigned short version, const PtyMessage type, const std::vector<BYTE>& payload)
+    {
+        _append(bytes, PtySignal::Message);
+        _append(bytes, PtySignalInputThread::MessageHeader{ version, type, gsl::narrow<unsigned long>(payload.size()) });
+        bytes.insert(bytes.end(), payload.begin(), payload.end());
+    }
+
+    static std::vector<BYTE> _repaintRegionPayload()
+    {
+        std::vector<BYTE> payload;
+        _append(payload, PtySignalInputThread::RepaintRegionData{ 1, 2, 3, 4 });
+        return payload;
+    }
+
+    // Signals that come in before a client connected only ever record the
+    // last resize, so a trailing resize shows that everything in front of it
+    // was framed correctly.
+    static void _verifyEarlyResize(const PtySignalInputThread& thread, const unsigned short sx, const unsigned short sy)
+    {
+        VERIFY_IS_TRUE(thread._earlyResize.has_value());
+        VERIFY_ARE_EQUAL(sx, thread._earlyResize->sx);
+        VERIFY_ARE_EQUAL(sy, thread._earlyResize->sy);
+    }
+};
+
+using namespace Microsoft::Console;
+
+void PtySignalInputThreadTests::SplitHeader()
+{
+    const auto thread = _newThread();
+
+    std::vector<BYTE> bytes;
+    _appendMessage(bytes, PtySignalInputThread::MessageVersion, PtyMessage::RepaintRegion, _repaintRegionPayload());
+    _appendResize(bytes, 80, 25);
+
+    Log::Comment(L"The signal and the first half of the header are kept until the rest arrives.");
+    const size_t split = sizeof(PtySignal) + sizeof(PtySignalInputThread::MessageHeader) / 2;
+    thread->_ProcessRead(bytes.data(), split);
+    VERIFY_ARE_EQUAL(split, thread->_pending.size());
+    VERIFY_IS_FALSE(thread->_earlyResize.has_value());
+
+    thread->_ProcessRead(bytes.data() + split, bytes.size() - split);
+    VERIFY_IS_TRUE(thread->_pending.empty());
+    _verifyEarlyResize(*thread, 80, 25);
+}
+
+void PtySignalInputThreadTests::SplitPayload()
+{
+    const auto thread = _newThread();
+
+    std::vector<BYTE> bytes;
+    _appendMessage(bytes, PtySignalInputThread::MessageVersion, PtyMessage::RepaintRegion, _repaintRegionPayload());
+    _appendResize(bytes, 80, 25);
+
+    Log::Comment(L"A message isn't handled before its payload arrived in full.");
+    const size_t split = sizeof(PtySignal) + sizeof(PtySignalInputThread::MessageHeader) + 3;
+    thread->_ProcessRead(bytes.data(), split);
+    VERIFY_ARE_EQUAL(split, thread->_pending.size());
+    VERIFY_IS_FALSE(thread->_earlyResize.has_value());
+
+    thread->_ProcessRead(bytes.data() + split, bytes.size() - split);
+    VERIFY_IS_TRUE(thread->_pending.empty());
+    _verifyEarlyResize(*thread, 80, 25);
+}
+
+void PtySignalInputThreadTests::OneByteAtATime()
+{
+    const auto thread = _newThread();
+
+    std::vector<BYTE> bytes;
+    _appendResize(bytes, 10, 20);
+    _append(bytes, PtySignal::ClearBuffer);
+    _appendMessage(bytes, PtySignalInputThread::MessageVersion, PtyMessage::RepaintRegion, _repaintRegionPayload());
+    _appendResize(bytes, 80, 25);
+
+    for (const auto b : bytes)
+    {
+        thread->_ProcessRead(&b, 1);
+    }
+
+    VERIFY_IS_TRUE(thread->_pending.empty());
+    _verifyEarlyResize(*thread, 80, 25);
+}
+
+void PtySignalInputThreadTests::SeveralMessagesInOneRead()
+{
+    const auto thread = _newThread();
+
+    std::vector<BYTE> bytes;
+    _append(bytes, PtySignal::ClearBuffer);
+    _appendMessage(bytes, PtySignalInputThread::MessageVersion, PtyMessage::RepaintRegion, _repaintRegionPayload());
+    _appendResize(bytes, 10, 20);
+    _appendMessage(bytes, PtySignalInputThread::MessageVersion, PtyMessage::RepaintRegion, {});
+    _appendResize(bytes, 80, 25);
+
+    thread->_ProcessRead(bytes.data(), bytes.size());
+    VERIFY_IS_TRUE(thread->_pending.empty());
+    _verifyEarlyResize(*thread, 80, 25);
+}
+
+void PtySignalInputThreadTests::UnknownMessageTypeIsSkipped()
+{
+    const auto thread = _newThread();
+    // Messages are only looked at once a client connected. ConnectConsole()
+    // isn't used, because it would apply the early resize to the buffer.
+    thread->_consoleConnected = true;
+
+    std::vector<BYTE> bytes;
+    _appendMessage(bytes, PtySignalInputThread::MessageVersion, static_cast<PtyMessage>(0x7fff), std::vector<BYTE>(100, 0xff));
+    _append(bytes, PtySignal::ResizeWindow);
+
+    Log::Comment(L"The unknown message is skipped as a whole, and only the start of the next signal is kept.");
+    thread->_ProcessRead(bytes.data(), bytes.size());
+    VERIFY_ARE_EQUAL(sizeof(PtySignal), thread->_pending.size());
+}
+
+void PtySignalInputThreadTests::OversizeMessageIsRejected()
+{
+    {
+        const auto thread = _newThread();
+
+        std::vector<BYTE> bytes;
+        _append(bytes, PtySignal::Message);
+        _append(bytes, PtySignalInputThread::MessageHeader{ PtySignalInputThread::MessageVersion, PtyMessage::RepaintRegion, PtySignalInputThread::MaxMessageSize + 1 });
+
+        Log::Comment(L"The size is rejected as soon as the header is in, without waiting for the payload.");
+        VERIFY_THROWS(thread->_ProcessRead(bytes.data(), bytes.size()), wil::ResultException);
+    }
+    {
+        const auto thread = _newThread();
+
+        std::vector<BYTE> bytes;
+        _append(bytes, PtySignal::Message);
+        _append(bytes, PtySignalInputThread::MessageHeader{ PtySignalInputThread::MessageVersion, PtyMessage::RepaintRegion, ULONG_MAX });
+
+        Log::Comment(L"A size that'd overflow the offset is rejected as well.");
+        VERIFY_THROWS(thread->_ProcessRead(bytes.data(), bytes.size()), wil::ResultException);
+    }
+    {
+        const auto thread = _newThread();
+
+        std::vector<BYTE> bytes;
+        _append(bytes, static_cast<PtySignal>(0x7fff));
+
+        Log::Comment(L"Unlike messages, unknown signals can't be skipped.");
+        VERIFY_THROWS(thread->_ProcessRead(bytes.data(), bytes.size()), wil::ResultException);
+    }
+}
+
+void PtySignalInputThreadTests::NewerVersionIsFramedBySize()
+{
+    const auto thread = _newThread();
+
+    Log::Comment(L"A later version may append fields to a payload, which are skipped along with it.");
+    auto payload = _repaintRegionPayload();
+    payload.insert(payload.end(), 6, 0xff);
+
+    std::vector<BYTE> bytes;
+    _appendMessage(bytes, PtySignalInputThread::MessageVersion + 1, PtyMessage::RepaintRegion, payload);
+    _appendResize(bytes, 80, 25);
+
+    thread->_ProcessRead(bytes.data(), bytes.size());
+    VERIFY_IS_TRUE(thread->_pending.empty());
+    _verifyEarlyResize(*thread, 80, 25);
+}
@@ -12,6 +12,7 @@
 #include "input.h"
 #include "getset.h"
 #include "_stream.h" // For WriteCharsLegacy
+#include "output.h"
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../../inc/conattrs.hpp"
@@ -144,6 +145,7 @@ class ScreenBufferTests
     TEST_METHOD(TestAltBufferCursorState);
     TEST_METHOD(TestAltBufferVtDispatching);
     TEST_METHOD(TestAltBufferRIS);
+    TEST_METHOD(TestAltBufferRecycling);
 
     TEST_METHOD(SetDefaultsIndividuallyBothDefault);
     TEST_METHOD(SetDefaultsTogether);
@@ -152,6 +154,8 @@ class ScreenBufferTests
 
     TEST_METHOD(BackspaceDefaultAttrs);
     TEST_METHOD(BackspaceDefaultAttrsWriteCharsLegacy);
+    TEST_METHOD(WriteCharsLegacyTextRunsAndLineFeeds);
+    TEST_METHOD(ReadOutputAcrossRowsWithPadding);
 
     TEST_METHOD(BackspaceDefaultAttrsInPrompt);
 
@@ -2237,6 +2241,39 @@ void ScreenBufferTests::TestAltBufferRIS()
     VERIFY_IS_FALSE(gci.GetActiveOutputBuffer()._IsAltBuffer());
 }
 
+void ScreenBufferTests::TestAltBufferRecycling()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.LockConsole(); // Lock must be taken to manipulate buffer.
+    auto unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+    StateMachine& stateMachine = si.GetStateMachine();
+
+    Log::Comment(L"Switch to the alt buffer and fill its first row with double-width X's");
+    stateMachine.ProcessString(L"\x1b[?1049h");
+    VERIFY_IS_TRUE(gci.GetActiveOutputBuffer()._IsAltBuffer());
+    const auto firstTextBuffer = &gci.GetActiveOutputBuffer().GetTextBuffer();
+    stateMachine.ProcessString(L"\x1b#6\x1b[1;31mXXX\x1b[m");
+    VERIFY_ARE_EQUAL(L"X", firstTextBuffer->GetCellDataAt({ 0, 0 })->Chars());
+    VERIFY_IS_TRUE(firstTextBuffer->IsDoubleWidthLine(0));
+
+    Log::Comment(L"Switch back to the main buffer and to a new alt buffer");
+    stateMachine.ProcessString(L"\x1b[?1049l");
+    VERIFY_IS_FALSE(gci.GetActiveOutputBuffer()._IsAltBuffer());
+    stateMachine.ProcessString(L"\x1b[?1049h");
+    VERIFY_IS_TRUE(gci.GetActiveOutputBuffer()._IsAltBuffer());
+
+    Log::Comment(L"The new alt buffer reuses the text buffer of the first one, but it's blank");
+    const auto& secondTextBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+    VERIFY_ARE_EQUAL(firstTextBuffer, &secondTextBuffer);
+    VERIFY_ARE_EQUAL(L" ", secondTextBuffer.GetCellDataAt({ 0, 0 })->Chars());
+    VERIFY_IS_FALSE(secondTextBuffer.IsDoubleWidthLine(0));
+
+    stateMachine.ProcessString(L"\x1b[?1049l");
+    VERIFY_IS_FALSE(gci.GetActiveOutputBuffer()._IsAltBuffer());
+}
+
 void ScreenBufferTests::SetDefaultsIndividuallyBothDefault()
 {
     // Tests MSFT:19828103
@@ -2619,6 +2656,71 @@ void ScreenBufferTests::BackspaceDefaultAttrsWriteCharsLegacy()
     VERIFY_ARE_EQUAL(magenta, renderSettings.GetAttributeColors(attrB).second);
 }
 
+void ScreenBufferTests::WriteCharsLegacyTextRunsAndLineFeeds()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    const TextBuffer& tbi = si.GetTextBuffer();
+    Cursor& cursor = si.GetTextBuffer().GetCursor();
+
+    VERIFY_SUCCEEDED(si.SetViewportOrigin(true, COORD({ 0, 0 }), true));
+    cursor.SetPosition({ 0, 0 });
+
+    Log::Comment(L"Write text runs separated by CRLFs and consecutive LFs, "
+                 L"with a tab and a control character in between.");
+    const auto str = L"abc\r\n\n\ndef\tg\r\nh\x01i";
+    auto numBytes = wcslen(str) * sizeof(wchar_t);
+    size_t numSpaces = 0;
+    VERIFY_SUCCESS_NTSTATUS(WriteCharsLegacy(si, str, str, str, &numBytes, &numSpaces, 0, 0, nullptr));
+    VERIFY_ARE_EQUAL(wcslen(str) * sizeof(wchar_t), numBytes);
+
+    VERIFY_ARE_EQUAL(COORD({ 3, 4 }), cursor.GetPosition());
+
+    VERIFY_ARE_EQUAL(L"a", tbi.GetCellDataAt({ 0, 0 })->Chars());
+    VERIFY_ARE_EQUAL(L"c", tbi.GetCellDataAt({ 2, 0 })->Chars());
+    VERIFY_ARE_EQUAL(L" ", tbi.GetCellDataAt({ 0, 1 })->Chars());
+    VERIFY_ARE_EQUAL(L" ", tbi.GetCellDataAt({ 0, 2 })->Chars());
+    VERIFY_ARE_EQUAL(L"d", tbi.GetCellDataAt({ 0, 3 })->Chars());
+    VERIFY_ARE_EQUAL(L" ", tbi.GetCellDataAt({ 3, 3 })->Chars());
+    VERIFY_ARE_EQUAL(L"g", tbi.GetCellDataAt({ 8, 3 })->Chars());
+    VERIFY_ARE_EQUAL(L"h", tbi.GetCellDataAt({ 0, 4 })->Chars());
+    VERIFY_ARE_EQUAL(L"i", tbi.GetCellDataAt({ 2, 4 })->Chars());
+
+    for (SHORT row = 0; row < 4; row++)
+    {
+        VERIFY_IS_FALSE(tbi.GetRowByOffset(row).WasWrapForced());
+    }
+}
+
+void ScreenBufferTests::ReadOutputAcrossRowsWithPadding()
+{
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    const auto width = si.GetBufferSize().Width();
+
+    const TextAttribute red{ FOREGROUND_RED };
+    const TextAttribute blue{ FOREGROUND_BLUE };
+    si.Write(OutputCellIterator(L"\x3044", red), { width - 2, 0 });
+    si.Write(OutputCellIterator(L"a\x3042", red), { 0, 1 });
+    si.Write(OutputCellIterator(L"b", blue), { 3, 1 });
+
+    Log::Comment(L"A read that starts on a trailing half pads it and continues on the next row.");
+    VERIFY_ARE_EQUAL(L" a\x3042b", ReadOutputStringW(si, { width - 1, 0 }, 5));
+    const std::vector<WORD> expectedAttributes{
+        FOREGROUND_RED,
+        FOREGROUND_RED,
+        FOREGROUND_RED | COMMON_LVB_LEADING_BYTE,
+        FOREGROUND_RED | COMMON_LVB_TRAILING_BYTE,
+        FOREGROUND_BLUE,
+    };
+    VERIFY_IS_TRUE(expectedAttributes == ReadOutputAttributes(si, { width - 1, 0 }, 5));
+
+    Log::Comment(L"A read that ends on a leading half pads it.");
+    VERIFY_ARE_EQUAL(L"a ", ReadOutputStringW(si, { 0, 1 }, 2));
+    VERIFY_IS_TRUE((std::vector<WORD>{ FOREGROUND_RED, FOREGROUND_RED }) == ReadOutputAttributes(si, { 0, 1 }, 2));
+    VERIFY_ARE_EQUAL(L"a\x3042", ReadOutputStringW(si, { 0, 1 }, 3));
+}
+
 void ScreenBufferTests::BackspaceDefaultAttrsInPrompt()
 {
     // Tests MSFT:19853701 - when you edit the prompt line at a bash prompt,
@@ -156,4 +156,112 @@ class SearchTests
         Search s(gci.renderData, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(FindAll)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search s(gci.renderData, L"\x304d", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        const auto& matches = s.FindAll();
+        VERIFY_ARE_EQUAL(4u, matches.size());
+        for (SHORT y = 0; y < 4; ++y)
+        {
+            VERIFY_ARE_EQUAL((COORD{ 5, y }), matches.at(y).first);
+            VERIFY_ARE_EQUAL((COORD{ 6, y }), matches.at(y).second);
+        }
+
+        Log::Comment(L"FindAll() doesn't move the position of FindNext().");
+        COORD coordStartExpected = { 5, 0 };
+        DoFoundChecks(s, coordStartExpected, 1);
+    }
+
+    TEST_METHOD(ForwardWrapsAroundFromAnchor)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search s(gci.renderData, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, { 1, 1 });
+        for (const SHORT y : std::array<SHORT, 4>{ 2, 3, 0, 1 })
+        {
+            VERIFY_IS_TRUE(s.FindNext());
+            VERIFY_ARE_EQUAL((COORD{ 0, y }), s._coordSelStart);
+        }
+        VERIFY_IS_FALSE(s.FindNext());
+
+        Log::Comment(L"Searching again goes around the buffer once more.");
+        VERIFY_IS_TRUE(s.FindNext());
+        VERIFY_ARE_EQUAL((COORD{ 0, 2 }), s._coordSelStart);
+    }
+
+    TEST_METHOD(FindAllInSnapshot)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        const auto snapshot = Search::s_TakeSnapshot(gci.renderData, Search::Sensitivity::CaseInsensitive);
+        auto matches = Search::s_FindAll(snapshot, L"ab", nullptr);
+
+        Search reference(gci.renderData, L"ab", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive);
+        VERIFY_ARE_EQUAL(reference.FindAll().size(), matches.size());
+        for (size_t i = 0; i < matches.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(reference.FindAll().at(i).first, matches.at(i).first);
+            VERIFY_ARE_EQUAL(reference.FindAll().at(i).second, matches.at(i).second);
+        }
+
+        Log::Comment(L"A Search made from the matches continues like any other.");
+        Search s(gci.renderData, L"ab", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive, std::move(matches));
+        COORD coordStartExpected = { 0 };
+        DoFoundChecks(s, coordStartExpected, 1);
+    }
+
+    TEST_METHOD(FindAllInSnapshotWithSurrogatePairs)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+
+        // Row 1 reads "ABかかCききDE😀xy", where the emoji stores two characters in each of its cells.
+        textBuffer.Write(OutputCellIterator{ L"\xD83D\xDE00xy" }, { 9, 1 });
+
+        const auto snapshot = Search::s_TakeSnapshot(gci.renderData, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(1u, snapshot.irregularRows.size());
+        VERIFY_ARE_EQUAL(1u, snapshot.irregularRows.at(0).first);
+
+        Log::Comment(L"Matches after the emoji are still found in the right cells.");
+        auto matches = Search::s_FindAll(snapshot, L"xy", nullptr);
+        VERIFY_ARE_EQUAL(1u, matches.size());
+        VERIFY_ARE_EQUAL((COORD{ 11, 1 }), matches.at(0).first);
+        VERIFY_ARE_EQUAL((COORD{ 12, 1 }), matches.at(0).second);
+
+        Log::Comment(L"The emoji itself covers both of its cells.");
+        matches = Search::s_FindAll(snapshot, L"\xD83D\xDE00", nullptr);
+        VERIFY_ARE_EQUAL(1u, matches.size());
+        VERIFY_ARE_EQUAL((COORD{ 9, 1 }), matches.at(0).first);
+        VERIFY_ARE_EQUAL((COORD{ 10, 1 }), matches.at(0).second);
+
+        Log::Comment(L"Half of a cell is never a match.");
+        VERIFY_IS_TRUE(Search::s_FindAll(snapshot, L"\xDE00x", nullptr).empty());
+
+        Log::Comment(L"The rows before and after the emoji are unaffected.");
+        matches = Search::s_FindAll(snapshot, L"DE", nullptr);
+        VERIFY_ARE_EQUAL(4u, matches.size());
+        for (SHORT y = 0; y < 4; ++y)
+        {
+            VERIFY_ARE_EQUAL((COORD{ 7, y }), matches.at(y).first);
+            VERIFY_ARE_EQUAL((COORD{ 8, y }), matches.at(y).second);
+        }
+    }
+
+    TEST_METHOD(CancelledFindAll)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        const auto snapshot = Search::s_TakeSnapshot(gci.renderData, Search::Sensitivity::CaseSensitive);
+        auto calls = 0;
+        const auto matches = Search::s_FindAll(snapshot, L"AB", [&]() {
+            ++calls;
+            return true;
+        });
+
+        VERIFY_ARE_EQUAL(1, calls);
+        VERIFY_IS_TRUE(matches.empty());
+    }
 };
@@ -17,6 +17,9 @@
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../renderer/inc/DummyRenderTarget.hpp"
 
+#include <til/hash.h>
+#include <thread>
+
 using namespace Microsoft::Console::Types;
 using namespace Microsoft::Console::Interactivity;
 using namespace Microsoft::Console::VirtualTerminal;
@@ -106,6 +109,7 @@ class TextBufferTests
     TEST_METHOD(TestSetWrapOnCurrentRow);
 
     TEST_METHOD(TestIncrementCircularBuffer);
+    TEST_METHOD(TestIncrementCircularBufferByMany);
 
     TEST_METHOD(TestMixedRgbAndLegacyForeground);
     TEST_METHOD(TestMixedRgbAndLegacyBackground);
@@ -140,6 +144,8 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollRowsAcrossCircularBufferEnd);
+    TEST_METHOD(ClearRowsBelowLazily);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
@@ -151,6 +157,7 @@ class TextBufferTests
     void WriteLinesToBuffer(const std::vector<std::wstring>& text, TextBuffer& buffer);
     TEST_METHOD(GetWordBoundaries);
     TEST_METHOD(MoveByWord);
+    TEST_METHOD(WordBoundariesFollowChanges);
     TEST_METHOD(GetGlyphBoundaries);
 
     TEST_METHOD(GetTextRects);
@@ -158,6 +165,23 @@ class TextBufferTests
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
+    TEST_METHOD(HyperlinkReleasedWhenOverwritten);
+
+    TEST_METHOD(PackColdScrollback);
+    TEST_METHOD(ConcurrentReadersLeaveColdRowsPacked);
+    TEST_METHOD(RowsAreMaterializedLazily);
+
+    TEST_METHOD(CopyAndFillRectangles);
+
+    TEST_METHOD(RowRevisions);
+
+    TEST_METHOD(MeasurePrintableAscii);
+    TEST_METHOD(WriteAsciiLine);
+    TEST_METHOD(WriteTextMatchesIterator);
+
+    TEST_METHOD(GetPatternsCachedPerLine);
+
+    TEST_METHOD(GetTextColorRuns);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -358,7 +382,7 @@ void TextBufferTests::TestCopyProperties()
     std::unique_ptr<TextBuffer> testTextBuffer = std::make_unique<TextBuffer>(otherTbi.GetSize().Dimensions(),
                                                                               otherTbi._currentAttributes,
                                                                               12,
-                                                                              otherTbi._renderTarget);
+                                                                              otherTbi.GetRenderTarget());
     VERIFY_IS_NOT_NULL(testTextBuffer.get());
 
     // set initial mapping values
@@ -636,6 +660,41 @@ void TextBufferTests::TestIncrementCircularBuffer()
     }
 }
 
+void TextBufferTests::TestIncrementCircularBufferByMany()
+{
+    const COORD bufferSize{ 10, 8 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+
+    for (const size_t count : { 3u, 8u, 13u })
+    {
+        Log::Comment(NoThrowString().Format(L"Incrementing by %zu rows", count));
+
+        TextBuffer single{ bufferSize, attr, cursorSize, _renderTarget };
+        TextBuffer bulk{ bufferSize, attr, cursorSize, _renderTarget };
+        for (SHORT y = 0; y < bufferSize.Y; ++y)
+        {
+            const auto text = std::wstring(1, gsl::narrow_cast<wchar_t>(L'A' + y));
+            single.Write(OutputCellIterator{ text }, { 0, y });
+            bulk.Write(OutputCellIterator{ text }, { 0, y });
+        }
+        single._firstRow = 5;
+        bulk._firstRow = 5;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            VERIFY_IS_TRUE(single.IncrementCircularBuffer());
+        }
+        VERIFY_IS_TRUE(bulk.IncrementCircularBuffer(count, false));
+
+        VERIFY_ARE_EQUAL(single._firstRow, bulk._firstRow);
+        for (SHORT y = 0; y < bufferSize.Y; ++y)
+        {
+            VERIFY_ARE_EQUAL(single.GetRowByOffset(y).GetText(), bulk.GetRowByOffset(y).GetText());
+        }
+    }
+}
+
 void TextBufferTests::TestMixedRgbAndLegacyForeground()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -1922,6 +1981,70 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// This tests that scrolling a range of rows that wraps around the end of the
+// circular buffer moves only those rows and keeps their IDs in sync with their storage.
+void TextBufferTests::ScrollRowsAcrossCircularBufferEnd()
+{
+    const COORD bufferSize{ 10, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, _renderTarget };
+    buffer._SetFirstRowIndex(7);
+
+    for (SHORT i = 0; i < 6; ++i)
+    {
+        buffer.Write(OutputCellIterator{ std::wstring(1, gsl::narrow_cast<wchar_t>(L'0' + i)) }, { 0, i });
+    }
+
+    // The rows at the offsets 2 to 4 move up by one. They're stored at the indices 9, 0 and 1.
+    buffer.ScrollRows(2, 3, -1);
+
+    const std::wstring_view expected{ L"023415" };
+    for (SHORT i = 0; i < 6; ++i)
+    {
+        const auto& row = buffer.GetRowByOffset(i);
+        VERIFY_ARE_EQUAL(til::at(expected, i), row.GetText().front());
+        VERIFY_ARE_EQUAL((7 + i) % 10, row.GetId());
+    }
+    VERIFY_ARE_EQUAL(7, buffer.GetFirstRowIndex());
+}
+
+void TextBufferTests::ClearRowsBelowLazily()
+{
+    const COORD bufferSize{ 10, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    const TextAttribute red{ 0x0c };
+    const TextAttribute blue{ 0x09 };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, _renderTarget };
+    buffer._SetFirstRowIndex(7);
+
+    for (SHORT i = 0; i < bufferSize.Y; ++i)
+    {
+        buffer.Write(OutputCellIterator{ std::wstring(1, gsl::narrow_cast<wchar_t>(L'0' + i)) }, { 0, i });
+    }
+
+    buffer.ClearRowsBelow(3, red);
+
+    Log::Comment(L"The cleared rows are only reset once they're retrieved.");
+    VERIFY_ARE_EQUAL(L'5', buffer._storage.at((7 + 5) % 10).GetText().front());
+    for (SHORT i = 0; i < bufferSize.Y; ++i)
+    {
+        const auto& row = buffer.GetRowByOffset(i);
+        VERIFY_ARE_EQUAL(i < 3 ? gsl::narrow_cast<wchar_t>(L'0' + i) : L' ', row.GetText().front());
+        VERIFY_ARE_EQUAL(i < 3 ? attr : red, row.GetAttrRow().GetAttrByColumn(0));
+    }
+
+    Log::Comment(L"A row that scrolls in at the bottom isn't cleared again once it's retrieved.");
+    buffer.ClearRowsBelow(1, blue);
+    VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+    buffer.Write(OutputCellIterator{ L"x" }, { 0, 9 });
+    VERIFY_ARE_EQUAL(L' ', buffer.GetRowByOffset(0).GetText().front());
+    VERIFY_ARE_EQUAL(blue, buffer.GetRowByOffset(0).GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(L'x', buffer.GetRowByOffset(9).GetText().front());
+    VERIFY_ARE_EQUAL(attr, buffer.GetRowByOffset(9).GetAttrRow().GetAttrByColumn(1));
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -1947,14 +2070,17 @@ void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetUnicodeStorage()._map.size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the row of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X, bufferSize.Y - 1 };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    for (const auto& row : _buffer->_storage)
+    {
+        VERIFY_IS_TRUE(row.GetUnicodeStorage()._map.empty(), L"The storage of all remaining rows should be empty.");
+    }
 }
 
 // This tests that columns removed from the buffer while resizing traditionally will also drop the high unicode
@@ -1982,14 +2108,14 @@ void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->_storage[pos.Y].GetUnicodeStorage()._map.size(), L"There should be one item in the row's storage.");
 
     // Perform resize to trim off the column of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X - 1, bufferSize.Y };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_IS_TRUE(_buffer->_storage[pos.Y].GetUnicodeStorage()._map.empty(), L"The row's storage should now be empty.");
 }
 
 void TextBufferTests::TestBurrito()
@@ -2016,31 +2142,31 @@ void TextBufferTests::TestBurrito()
 void TextBufferTests::TestAppendRTFText()
 {
     {
-        std::ostringstream contentStream;
+        std::string contentStream;
         const auto ascii = L"This is some Ascii \\ {}";
         TextBuffer::_AppendRTFText(contentStream, ascii);
-        VERIFY_ARE_EQUAL("This is some Ascii \\\\ \\{\\}", contentStream.str());
+        VERIFY_ARE_EQUAL("This is some Ascii \\\\ \\{\\}", contentStream);
     }
     {
-        std::ostringstream contentStream;
+        std::string contentStream;
         // "Low code units: á é í ó ú ⮁ ⮂" in UTF-16
         const auto lowCodeUnits = L"Low code units: \x00E1 \x00E9 \x00ED \x00F3 \x00FA \x2B81 \x2B82";
         TextBuffer::_AppendRTFText(contentStream, lowCodeUnits);
-        VERIFY_ARE_EQUAL("Low code units: \\u225? \\u233? \\u237? \\u243? \\u250? \\u11137? \\u11138?", contentStream.str());
+        VERIFY_ARE_EQUAL("Low code units: \\u225? \\u233? \\u237? \\u243? \\u250? \\u11137? \\u11138?", contentStream);
     }
     {
-        std::ostringstream contentStream;
+        std::string contentStream;
         // "High code units: ꞵ ꞷ" in UTF-16
         const auto highCodeUnits = L"High code units: \xA7B5 \xA7B7";
         TextBuffer::_AppendRTFText(contentStream, highCodeUnits);
-        VERIFY_ARE_EQUAL("High code units: \\u-22603? \\u-22601?", contentStream.str());
+        VERIFY_ARE_EQUAL("High code units: \\u-22603? \\u-22601?", contentStream);
     }
     {
-        std::ostringstream contentStream;
+        std::string contentStream;
         // "Surrogates: 🍦 👾 👀" in UTF-16
         const auto surrogates = L"Surrogates: \xD83C\xDF66 \xD83D\xDC7E \xD83D\xDC40";
         TextBuffer::_AppendRTFText(contentStream, surrogates);
-        VERIFY_ARE_EQUAL("Surrogates: \\u-10180?\\u-8346? \\u-10179?\\u-9090? \\u-10179?\\u-9152?", contentStream.str());
+        VERIFY_ARE_EQUAL("Surrogates: \\u-10180?\\u-8346? \\u-10179?\\u-9090? \\u-10179?\\u-9152?", contentStream);
     }
 }
 
@@ -2176,6 +2302,30 @@ void TextBufferTests::GetWordBoundaries()
     }
 }
 
+void TextBufferTests::WordBoundariesFollowChanges()
+{
+    COORD bufferSize{ 80, 10 };
+    UINT cursorSize = 12;
+    TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    WriteLinesToBuffer({ L"word other" }, *_buffer);
+    VERIFY_ARE_EQUAL((COORD{ 3, 0 }), _buffer->GetWordEnd({ 0, 0 }, L" "));
+    VERIFY_ARE_EQUAL((COORD{ 0, 0 }), _buffer->GetWordEnd({ 0, 0 }, L"o"));
+
+    Log::Comment(L"The cached delimiter classes of a row are dropped once it's modified.");
+    WriteLinesToBuffer({ L"wordy other" }, *_buffer);
+    VERIFY_ARE_EQUAL((COORD{ 4, 0 }), _buffer->GetWordEnd({ 0, 0 }, L" "));
+    VERIFY_ARE_EQUAL((COORD{ 0, 0 }), _buffer->GetWordStart({ 3, 0 }, L" "));
+
+    VERIFY_ARE_EQUAL((COORD{ 79, 1 }), _buffer->GetWordEnd({ 0, 1 }, L" "));
+
+    Log::Comment(L"...and they don't get mixed up when rows move around.");
+    _buffer->ScrollRows(0, 1, 1);
+    VERIFY_ARE_EQUAL((COORD{ 79, 0 }), _buffer->GetWordEnd({ 0, 0 }, L" "));
+    VERIFY_ARE_EQUAL((COORD{ 4, 1 }), _buffer->GetWordEnd({ 0, 1 }, L" "));
+}
+
 void TextBufferTests::MoveByWord()
 {
     COORD bufferSize{ 80, 9001 };
@@ -2660,13 +2810,15 @@ void TextBufferTests::HyperlinkTrim()
     const auto finalOtherCustomId = fmt::format(L"{}%{}", otherCustomId, til::hash(otherUrl));
 
     // The hyperlink reference that was only in the first row should be deleted from the map
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkMap.find(id), _buffer->_hyperlinkMap.end());
+    VERIFY_THROWS(_buffer->GetHyperlinkUriFromId(id), std::exception);
     // Since there was a custom id, that should be deleted as well
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap.find(finalCustomId), _buffer->_hyperlinkCustomIdMap.end());
+    VERIFY_ARE_EQUAL(L"", _buffer->GetCustomIdFromId(id));
+    VERIFY_ARE_NOT_EQUAL(id, _buffer->GetHyperlinkId(url, customId));
 
     // The other hyperlink reference should not be deleted
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkMap[otherId], otherUrl);
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalOtherCustomId], otherId);
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(otherId), otherUrl);
+    VERIFY_ARE_EQUAL(_buffer->GetCustomIdFromId(otherId), finalOtherCustomId);
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkId(otherUrl, otherCustomId), otherId);
 }
 
 // This tests that when we increment the circular buffer, non-obsolete hyperlink references
@@ -2701,5 +2853,422 @@ void TextBufferTests::NoHyperlinkTrim()
 
     // The hyperlink reference should not be deleted from the map since it is still present in the buffer
     VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalCustomId], id);
+    VERIFY_ARE_EQUAL(_buffer->GetCustomIdFromId(id), finalCustomId);
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkId(url, customId), id);
+}
+
+// This tests that a hyperlink is released as soon as its last cell is overwritten,
+// unless it's still part of the current attributes.
+void TextBufferTests::HyperlinkReleasedWhenOverwritten()
+{
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    static constexpr std::wstring_view url{ L"test.url" };
+    static constexpr std::wstring_view otherUrl{ L"other.url" };
+
+    const auto id = _buffer->GetHyperlinkId(url, {});
+    const auto otherId = _buffer->GetHyperlinkId(otherUrl, {});
+    _buffer->AddHyperlinkToMap(url, id);
+    _buffer->AddHyperlinkToMap(otherUrl, otherId);
+
+    TextAttribute linkAttr{ 0x7f };
+    linkAttr.SetHyperlinkId(id);
+    TextAttribute otherLinkAttr{ 0x7f };
+    otherLinkAttr.SetHyperlinkId(otherId);
+
+    auto& row = _buffer->GetRowByOffset(3);
+    row.GetAttrRow().Replace(10, 20, linkAttr);
+    row.GetAttrRow().Replace(30, 40, otherLinkAttr);
+    VERIFY_ARE_EQUAL(10u, _buffer->GetHyperlinkStore().CellCount(id));
+
+    Log::Comment(L"Copying a row counts its cells again.");
+    {
+        const auto copy = row.GetAttrRow();
+        VERIFY_ARE_EQUAL(20u, _buffer->GetHyperlinkStore().CellCount(id));
+    }
+    VERIFY_ARE_EQUAL(10u, _buffer->GetHyperlinkStore().CellCount(id));
+
+    Log::Comment(L"The second link is still open when its cells get erased.");
+    _buffer->SetCurrentAttributes(otherLinkAttr);
+    row.Reset(attr);
+    VERIFY_THROWS(_buffer->GetHyperlinkUriFromId(id), std::exception);
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(otherId), otherUrl);
+
+    Log::Comment(L"Closing it releases it.");
+    _buffer->SetCurrentAttributes(attr);
+    VERIFY_THROWS(_buffer->GetHyperlinkUriFromId(otherId), std::exception);
+}
+
+// This tests that rows in the cold scrollback tier are packed
+// and that unpacking them restores their text and attributes.
+void TextBufferTests::PackColdScrollback()
+{
+    const COORD bufferSize{ 20, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    static constexpr std::wstring_view hello{ L"Hello " };
+    static constexpr std::wstring_view world{ L"W\xD83D\xDE00rld" };
+    const TextAttribute worldAttr{ 0x1e };
+    _buffer->Write(OutputCellIterator{ hello, attr }, { 0, 1 });
+    _buffer->Write(OutputCellIterator{ world, worldAttr }, { gsl::narrow<SHORT>(hello.size()), 1 });
+    const auto expectedText = _buffer->GetRowByOffset(1).GetText();
+    const auto expectedAttr = _buffer->GetRowByOffset(1).GetAttrRow().GetAttrByColumn(hello.size());
+
+    // Rows that were never retrieved don't hold any cells to begin with.
+    for (size_t i = 0; i < _buffer->TotalRowCount(); ++i)
+    {
+        _buffer->GetRowByOffset(i);
+    }
+
+    _buffer->GetCursor().SetYPosition(9);
+    _buffer->SetColdScrollbackThreshold(3);
+
+    Log::Comment(L"Every row more than 3 rows above the cursor should be packed.");
+    for (size_t i = 0; i < _buffer->_storage.size(); ++i)
+    {
+        VERIFY_ARE_EQUAL(i < 6, _buffer->_storage.at(i).IsPacked());
+    }
+
+    Log::Comment(L"Retrieving a cold row should unpack it with its contents intact.");
+    const auto& row = _buffer->GetRowByOffset(1);
+    VERIFY_IS_FALSE(row.IsPacked());
+    VERIFY_ARE_EQUAL(expectedText, row.GetText());
+    VERIFY_ARE_EQUAL(attr, row.GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(expectedAttr, row.GetAttrRow().GetAttrByColumn(hello.size()));
+    VERIFY_ARE_EQUAL(worldAttr, expectedAttr);
+
+    Log::Comment(L"Incrementing the circular buffer should pack the row that just went cold.");
+    _buffer->IncrementCircularBuffer();
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(0).GetText() == expectedText);
+    VERIFY_IS_TRUE(_buffer->_storage.at(6).IsPacked());
+}
+
+// This tests that threads which read the same buffer at once
+// can retrieve cold rows without stepping on each other,
+// and that reading a row never unpacks it in the buffer.
+void TextBufferTests::ConcurrentReadersLeaveColdRowsPacked()
+{
+    const COORD bufferSize{ 20, 200 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    std::vector<std::wstring> expectedTexts;
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        _buffer->Write(OutputCellIterator{ fmt::format(L"Row {}", y), attr }, { 0, y });
+        expectedTexts.emplace_back(_buffer->GetRowByOffset(y).GetText());
+    }
+
+    _buffer->GetCursor().SetYPosition(bufferSize.Y - 1);
+    _buffer->SetColdScrollbackThreshold(3);
+    VERIFY_IS_TRUE(_buffer->_storage.at(0).IsPacked());
+
+    Log::Comment(L"Every reader should see the contents of every row.");
+    const TextBuffer& buffer = *_buffer;
+    std::array<size_t, 4> mismatches{};
+    std::vector<std::thread> readers;
+    for (auto& readerMismatches : mismatches)
+    {
+        readers.emplace_back([&]() {
+            for (size_t y = 0; y < expectedTexts.size(); ++y)
+            {
+                if (buffer.GetRowByOffset(y).GetText() != til::at(expectedTexts, y))
+                {
+                    ++readerMismatches;
+                }
+            }
+        });
+    }
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+
+    for (const auto readerMismatches : mismatches)
+    {
+        VERIFY_ARE_EQUAL(0u, readerMismatches);
+    }
+    VERIFY_IS_TRUE(_buffer->_storage.at(0).IsPacked());
+}
+
+// This tests that a new buffer doesn't allocate the cells of its rows
+// until they're retrieved, and that they're blank until then.
+void TextBufferTests::RowsAreMaterializedLazily()
+{
+    const COORD bufferSize{ 20, 9001 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    Log::Comment(L"None of the rows hold any cells.");
+    VERIFY_ARE_EQUAL(0u, _buffer->_rowPool.BlocksInUse());
+    VERIFY_IS_TRUE(std::all_of(_buffer->_storage.begin(), _buffer->_storage.end(), [](const ROW& row) { return row.IsBlank(); }));
+
+    Log::Comment(L"Finding the end of the text doesn't change that.");
+    _buffer->Write(OutputCellIterator{ L"Hello", attr }, { 0, 2 });
+    const auto end = _buffer->GetLastNonSpaceCharacter();
+    VERIFY_ARE_EQUAL(4, end.X);
+    VERIFY_ARE_EQUAL(2, end.Y);
+    VERIFY_ARE_EQUAL(1u, _buffer->_rowPool.BlocksInUse());
+
+    Log::Comment(L"A row that's retrieved is blank and holds the attribute it was created with.");
+    const auto& row = _buffer->GetRowByOffset(5000);
+    VERIFY_IS_TRUE(row.IsMaterialized());
+    VERIFY_ARE_EQUAL(20u, row.GetCharRow().size());
+    VERIFY_IS_FALSE(row.GetCharRow().ContainsText());
+    VERIFY_ARE_EQUAL(attr, row.GetAttrRow().GetAttrByColumn(19));
+    VERIFY_ARE_EQUAL(2u, _buffer->_rowPool.BlocksInUse());
+
+    Log::Comment(L"Resizing the buffer doesn't materialize its blank rows either.");
+    VERIFY_SUCCEEDED(_buffer->ResizeTraditional({ 30, 9001 }));
+    VERIFY_IS_TRUE(_buffer->_storage.at(6000).IsBlank());
+    VERIFY_ARE_EQUAL(30u, _buffer->GetRowByOffset(6000).GetCharRow().size());
+}
+
+// This tests that rows get a new revision whenever they're modified and
+// that the buffer's generation moves whenever anything in it changes.
+void TextBufferTests::RowRevisions()
+{
+    const COORD bufferSize{ 20, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    const auto& buffer = *_buffer;
+
+    Log::Comment(L"Every row starts out with a distinct revision.");
+    for (size_t i = 1; i < buffer.TotalRowCount(); ++i)
+    {
+        VERIFY_ARE_NOT_EQUAL(buffer.GetRowByOffset(i - 1).GetRevision(), buffer.GetRowByOffset(i).GetRevision());
+    }
+
+    Log::Comment(L"Writing to a row gives only that row a new revision.");
+    auto generation = buffer.GetGeneration();
+    const auto untouchedRevision = buffer.GetRowByOffset(4).GetRevision();
+    _buffer->Write(OutputCellIterator{ L"Hello", attr }, { 0, 3 });
+    VERIFY_IS_GREATER_THAN(buffer.GetGeneration(), generation);
+    VERIFY_IS_GREATER_THAN(buffer.GetRowByOffset(3).GetRevision(), generation);
+    VERIFY_ARE_EQUAL(untouchedRevision, buffer.GetRowByOffset(4).GetRevision());
+
+    Log::Comment(L"Moving rows around advances the generation.");
+    generation = buffer.GetGeneration();
+    _buffer->ScrollRows(3, 2, 1);
+    VERIFY_IS_GREATER_THAN(buffer.GetGeneration(), generation);
+    VERIFY_ARE_EQUAL(untouchedRevision, buffer.GetRowByOffset(5).GetRevision());
+
+    generation = buffer.GetGeneration();
+    _buffer->IncrementCircularBuffer();
+    VERIFY_IS_GREATER_THAN(buffer.GetGeneration(), generation);
+    VERIFY_IS_GREATER_THAN(buffer.GetRowByOffset(9).GetRevision(), generation);
+}
+
+void TextBufferTests::MeasurePrintableAscii()
+{
+    VERIFY_ARE_EQUAL(0u, TextBuffer::MeasurePrintableAscii(L""));
+    VERIFY_ARE_EQUAL(5u, TextBuffer::MeasurePrintableAscii(L"Hello"));
+    VERIFY_ARE_EQUAL(26u, TextBuffer::MeasurePrintableAscii(L"The quick brown fox jumps!"));
+    VERIFY_ARE_EQUAL(0u, TextBuffer::MeasurePrintableAscii(L"\tindented"));
+
+    // Test each position within and beyond the first vector's worth of characters.
+    for (size_t i = 0; i < 20; ++i)
+    {
+        for (const auto wch : { L'\x1f', L'\x7f', L'\xe9', L'\x3042', L'\xD83D', L'\xffff' })
+        {
+            std::wstring text(20, L'a');
+            text[i] = wch;
+            VERIFY_ARE_EQUAL(i, TextBuffer::MeasurePrintableAscii(text));
+        }
+    }
+}
+
+void TextBufferTests::WriteAsciiLine()
+{
+    const COORD bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    Log::Comment(L"Overwrite a wide glyph and verify that the write is clipped to the end of the row.");
+    _buffer->Write(OutputCellIterator{ L"\x3042\x3044", attr }, { 4, 0 });
+    const TextAttribute red{ 0x0c };
+    VERIFY_ARE_EQUAL(7u, _buffer->WriteAsciiLine(L"0123456789", { 3, 0 }, red));
+
+    const auto& row = _buffer->GetRowByOffset(0);
+    VERIFY_IS_TRUE(row.GetText() == L"   0123456");
+    for (size_t i = 3; i < 10; ++i)
+    {
+        VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(i).IsSingle());
+        VERIFY_ARE_EQUAL(red, row.GetAttrRow().GetAttrByColumn(i));
+    }
+    VERIFY_ARE_EQUAL(attr, row.GetAttrRow().GetAttrByColumn(2));
+    VERIFY_IS_TRUE(row.WasWrapForced());
+
+    Log::Comment(L"A write that doesn't reach the end of the row leaves the wrap flag alone.");
+    VERIFY_ARE_EQUAL(2u, _buffer->WriteAsciiLine(L"ab", { 0, 1 }, red));
+    VERIFY_IS_FALSE(_buffer->GetRowByOffset(1).WasWrapForced());
+    VERIFY_ARE_EQUAL(0u, _buffer->WriteAsciiLine(L"ab", { 0, 3 }, red));
+}
+
+void TextBufferTests::WriteTextMatchesIterator()
+{
+    const COORD bufferSize{ 9, 6 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    const TextAttribute red{ 0x0c };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    Log::Comment(L"Wide glyphs, a surrogate pair and a wide glyph that has to be padded out at the end of the row.");
+    const std::wstring_view text{ L"a\x3042b\x3044c\x3046\xD83D\xDE00d" };
+
+    const auto it = OutputCellIterator{ text, red };
+    const auto expected = _buffer->Write(it, { 1, 0 }).GetCellDistance(it);
+    VERIFY_ARE_EQUAL(expected, _buffer->WriteText(text, { 1, 3 }, red));
+
+    for (SHORT y = 0; y < 3; ++y)
+    {
+        const auto& expectedRow = _buffer->GetRowByOffset(y);
+        const auto& actualRow = _buffer->GetRowByOffset(y + 3);
+        VERIFY_ARE_EQUAL(expectedRow.WasWrapForced(), actualRow.WasWrapForced());
+        VERIFY_ARE_EQUAL(expectedRow.WasDoubleBytePadded(), actualRow.WasDoubleBytePadded());
+        VERIFY_ARE_EQUAL(expectedRow.GetText(), actualRow.GetText());
+        for (size_t x = 0; x < gsl::narrow_cast<size_t>(bufferSize.X); ++x)
+        {
+            VERIFY_ARE_EQUAL(expectedRow.GetCharRow().DbcsAttrAt(x), actualRow.GetCharRow().DbcsAttrAt(x));
+            VERIFY_ARE_EQUAL(expectedRow.GetAttrRow().GetAttrByColumn(x), actualRow.GetAttrRow().GetAttrByColumn(x));
+        }
+    }
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(3).WasDoubleBytePadded());
+}
+
+void TextBufferTests::GetPatternsCachedPerLine()
+{
+    const COORD bufferSize{ 20, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    const auto id = _buffer->AddPatternRecognizer(L"x+");
+
+    _buffer->Write(OutputCellIterator{ L"xx", attr }, { 0, 1 });
+    _buffer->Write(OutputCellIterator{ L"abcdefghijklmnopqxxx", attr }, { 0, 3 });
+    _buffer->GetRowByOffset(3).SetWrapForced(true);
+    _buffer->Write(OutputCellIterator{ L"xx", attr }, { 0, 4 });
+
+    auto tree = _buffer->GetPatterns(0, 9);
+    VERIFY_ARE_EQUAL(1u, tree.findOverlapping(til::point{ 1, 1 }, til::point{ 0, 1 }).size());
+
+    Log::Comment(L"A match can span the rows of a wrapped line.");
+    const auto wrapped = tree.findOverlapping(til::point{ 1, 4 }, til::point{ 0, 4 });
+    VERIFY_ARE_EQUAL(1u, wrapped.size());
+    VERIFY_ARE_EQUAL(til::point(17, 3), wrapped.at(0).start);
+    VERIFY_ARE_EQUAL(til::point(2, 4), wrapped.at(0).stop);
+    VERIFY_ARE_EQUAL(id, wrapped.at(0).value);
+
+    Log::Comment(L"Only lines with modified rows are searched again.");
+    const auto wrappedMatches = _buffer->_patternCache.at(3).matches.data();
+    _buffer->Write(OutputCellIterator{ L"ab", attr }, { 0, 1 });
+    tree = _buffer->GetPatterns(0, 9);
+    VERIFY_ARE_EQUAL(0u, tree.findOverlapping(til::point{ 1, 1 }, til::point{ 0, 1 }).size());
+    VERIFY_ARE_EQUAL(wrappedMatches, _buffer->_patternCache.at(3).matches.data());
+
+    Log::Comment(L"Results are relative to the first requested row, even if the line starts above it.");
+    tree = _buffer->GetPatterns(4, 9);
+    VERIFY_ARE_EQUAL(1u, tree.findOverlapping(til::point{ 1, 0 }, til::point{ 0, 0 }).size());
+}
+
+void TextBufferTests::GetTextColorRuns()
+{
+    const COORD bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+    const TextAttribute red{ 0x0C };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    _buffer->Write(OutputCellIterator{ L"ab<d", red }, { 0, 0 });
+    _buffer->Write(OutputCellIterator{ L"efg", attr }, { 4, 0 });
+    _buffer->Write(OutputCellIterator{ L"hi", attr }, { 0, 1 });
+
+    const auto getColors = [](const TextAttribute& attr) {
+        return std::pair<COLORREF, COLORREF>{ attr.GetLegacyAttributes(), 0 };
+    };
+    const auto textRects = _buffer->GetTextRects({ 0, 0 }, { 9, 1 }, false, false);
+    const auto data = _buffer->GetText(true, true, textRects, getColors);
+
+    Log::Comment(L"Cells with the same colors are merged into a single run.");
+    VERIFY_IS_TRUE(data.text.at(0) == L"ab<defg\r\n");
+    VERIFY_ARE_EQUAL(3u, data.colors.at(0).size());
+    VERIFY_ARE_EQUAL(4u, data.colors.at(0).at(0).length);
+    VERIFY_ARE_EQUAL(0x0Cu, data.colors.at(0).at(0).fg);
+    VERIFY_ARE_EQUAL(3u, data.colors.at(0).at(1).length);
+    VERIFY_ARE_EQUAL(0x07u, data.colors.at(0).at(1).fg);
+    VERIFY_ARE_EQUAL(2u, data.colors.at(0).at(2).length);
+
+    Log::Comment(L"Trimming trailing whitespace shortens the last run.");
+    VERIFY_IS_TRUE(data.text.at(1) == L"hi");
+    VERIFY_ARE_EQUAL(1u, data.colors.at(1).size());
+    VERIFY_ARE_EQUAL(2u, data.colors.at(1).at(0).length);
+
+    Log::Comment(L"The exporters emit one span per run.");
+    const auto html = TextBuffer::GenHTML(data, 12, L"Consolas", 0);
+    VERIFY_IS_TRUE(html.find("ab&lt;d</SPAN><SPAN STYLE=\"color:#070000;background-color:#000000;\">efg<BR>hi</SPAN>") != std::string::npos);
+    VERIFY_IS_TRUE(html.find("EndHTML:" + fmt::format("{:010}", html.size())) != std::string::npos);
+
+    const auto rtf = TextBuffer::GenRTF(data, 12, L"Consolas", 0);
+    VERIFY_IS_TRUE(rtf.find("\\highlight1\\cf2 ab<d\\highlight1\\cf3 efg\\line hi}") != std::string::npos);
+}
+
+void TextBufferTests::CopyAndFillRectangles()
+{
+    const COORD bufferSize{ 10, 8 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    TextBuffer buffer{ bufferSize, attr, cursorSize, _renderTarget };
+
+    // This is the burrito emoji: 🌯
+    // It's encoded in UTF-16, as needed by the buffer.
+    const std::wstring burrito{ L"\xD83C\xDF2F" };
+
+    TextAttribute red{ 0x7f };
+    red.SetForeground(TextColor{ RGB(255, 0, 0) });
+    buffer.Write(OutputCellIterator{ L"abc\x30ab" }, { 0, 0 });
+    buffer.Write(OutputCellIterator{ burrito }, { 7, 0 });
+    buffer.Write(OutputCellIterator{ L"gh", red }, { 0, 1 });
+
+    Log::Comment(L"Characters and attributes are copied, including wide glyphs.");
+    buffer.CopyRectangle(Viewport::FromDimensions({ 0, 0 }, { 5, 2 }), { 4, 4 });
+    VERIFY_ARE_EQUAL(L"    abc\x30ab ", buffer.GetRowByOffset(4).GetText());
+    VERIFY_ARE_EQUAL(L"    gh    ", buffer.GetRowByOffset(5).GetText());
+    VERIFY_ARE_EQUAL(attr, buffer.GetRowByOffset(5).GetAttrRow().GetAttrByColumn(3));
+    VERIFY_ARE_EQUAL(red, buffer.GetRowByOffset(5).GetAttrRow().GetAttrByColumn(4));
+    VERIFY_ARE_EQUAL(red, buffer.GetRowByOffset(5).GetAttrRow().GetAttrByColumn(5));
+    VERIFY_ARE_EQUAL(attr, buffer.GetRowByOffset(5).GetAttrRow().GetAttrByColumn(6));
+
+    Log::Comment(L"Glyphs that live in the UnicodeStorage are copied too.");
+    buffer.CopyRectangle(Viewport::FromDimensions({ 6, 0 }, { 4, 1 }), { 0, 6 });
+    VERIFY_ARE_EQUAL(L" " + burrito + L"       ", buffer.GetRowByOffset(6).GetText());
+
+    Log::Comment(L"Halves of wide glyphs at the edges are erased.");
+    buffer.CopyRectangle(Viewport::FromDimensions({ 4, 0 }, { 2, 1 }), { 0, 7 });
+    VERIFY_ARE_EQUAL(L"          ", buffer.GetRowByOffset(7).GetText());
+
+    Log::Comment(L"The source may overlap the target.");
+    buffer.CopyRectangle(Viewport::FromDimensions({ 0, 1 }, { 4, 1 }), { 2, 1 });
+    VERIFY_ARE_EQUAL(L"ghgh      ", buffer.GetRowByOffset(1).GetText());
+    VERIFY_ARE_EQUAL(red, buffer.GetRowByOffset(1).GetAttrRow().GetAttrByColumn(3));
+    VERIFY_ARE_EQUAL(attr, buffer.GetRowByOffset(1).GetAttrRow().GetAttrByColumn(4));
+
+    Log::Comment(L"A fill without attributes keeps them, and erases the other half of a wide glyph.");
+    buffer.FillRectangle(Viewport::FromDimensions({ 3, 0 }, { 1, 1 }), L'-', std::nullopt);
+    VERIFY_ARE_EQUAL(L"abc-   " + burrito + L" ", buffer.GetRowByOffset(0).GetText());
+
+    Log::Comment(L"A fill with attributes applies them to the whole rectangle.");
+    buffer.FillRectangle(Viewport::FromDimensions({ 0, 2 }, { 3, 2 }), L'x', red);
+    VERIFY_ARE_EQUAL(L"xxx       ", buffer.GetRowByOffset(2).GetText());
+    VERIFY_ARE_EQUAL(L"xxx       ", buffer.GetRowByOffset(3).GetText());
+    VERIFY_ARE_EQUAL(red, buffer.GetRowByOffset(3).GetAttrRow().GetAttrByColumn(2));
+    VERIFY_ARE_EQUAL(attr, buffer.GetRowByOffset(3).GetAttrRow().GetAttrByColumn(3));
 }
@@ -277,9 +277,9 @@ public:
         FAIL_FAST_HR(E_NOTIMPL);
     }
 
-    std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override
+    gsl::span<const Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override
     {
-        return std::vector<Microsoft::Console::Types::Viewport>{};
+        return {};
     }
 
     void LockConsole() noexcept override
@@ -330,9 +330,9 @@ public:
         return false;
     }
 
-    const std::vector<RenderOverlay> GetOverlays() const noexcept override
+    gsl::span<const RenderOverlay> GetOverlays() const noexcept override
     {
-        return std::vector<RenderOverlay>{};
+        return {};
     }
 
     const bool IsGridLineDrawingAllowed() noexcept override
@@ -392,7 +392,7 @@ public:
         return {};
     }
 
-    const std::vector<size_t> GetPatternId(const COORD /*location*/) const noexcept
+    gsl::span<const size_t> GetPatternId(const COORD /*location*/) const noexcept
     {
         return {};
     }
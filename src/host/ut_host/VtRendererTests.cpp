@@ -78,6 +78,9 @@ class Microsoft::Console::Render::VtRendererTest
     TEST_METHOD(FormattedString);
 
     TEST_METHOD(TestWrapping);
+    TEST_METHOD(TestRepeatCharacters);
+
+    TEST_METHOD(TestWriterThread);
 
     TEST_METHOD(TestResize);
 
@@ -872,8 +875,8 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Foreground and Retain Rendition----");
     textAttributes.SetDefaultForeground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    // Resetting the foreground on its own is shorter than a SGR reset followed by the rendition.
+    qExpectedInput.push_back("\x1b[39m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, renderSettings, &renderData, false, false));
 
     Log::Comment(L"----Set Green Background----");
@@ -883,8 +886,7 @@ void VtRendererTest::Xterm256TestAttributesAcrossReset()
 
     Log::Comment(L"----Reset Default Background and Retain Rendition----");
     textAttributes.SetDefaultBackground();
-    qExpectedInput.push_back("\x1b[m");
-    qExpectedInput.push_back(renditionSequence.str());
+    qExpectedInput.push_back("\x1b[49m");
     VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(textAttributes, renderSettings, &renderData, false, false));
 
     VerifyExpectedInputsDrained();
@@ -1427,6 +1429,73 @@ void VtRendererTest::TestWrapping()
     });
 }
 
+void VtRendererTest::TestRepeatCharacters()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), SetUpViewport());
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    engine->SetRepeatCharacters(true);
+
+    VerifyFirstPaint(*engine);
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Make sure the cursor is at 0,0"));
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 0 }));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Runs that are longer than a REP sequence are repeated, shorter ones are written as is."));
+        qExpectedInput.push_back("a-");
+        qExpectedInput.push_back("\x1b[19b");
+        qExpectedInput.push_back("b====c");
+
+        const std::wstring line = L"a" + std::wstring(20, L'-') + L"b====c";
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(std::wstring_view{ &line[i], 1 }, 1u);
+        }
+
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false, false));
+    });
+}
+
+void VtRendererTest::TestWriterThread()
+{
+    wil::unique_hfile readPipe;
+    wil::unique_hfile writePipe;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(readPipe.addressof(), writePipe.addressof(), nullptr, 0));
+
+    auto engine = std::make_unique<Xterm256Engine>(std::move(writePipe), SetUpViewport());
+
+    Log::Comment(L"Flushed output is written to the pipe by the writer thread, in order.");
+    VERIFY_SUCCEEDED(engine->WriteTerminalUtf8("first"));
+    VERIFY_SUCCEEDED(engine->_Flush());
+    VERIFY_SUCCEEDED(engine->WriteTerminalUtf8("second"));
+    VERIFY_SUCCEEDED(engine->_Flush());
+
+    const std::string_view expected{ "firstsecond" };
+    std::string actual(expected.size(), '\0');
+    for (size_t read = 0; read < actual.size();)
+    {
+        DWORD bytesRead = 0;
+        VERIFY_WIN32_BOOL_SUCCEEDED(ReadFile(readPipe.get(), actual.data() + read, gsl::narrow<DWORD>(actual.size() - read), &bytesRead, nullptr));
+        read += bytesRead;
+    }
+    VERIFY_IS_TRUE(expected == actual);
+
+    Log::Comment(L"Once the terminal goes away, the next flush reports the broken pipe.");
+    readPipe.reset();
+    VERIFY_SUCCEEDED(engine->WriteTerminalUtf8("lost"));
+    VERIFY_SUCCEEDED(engine->_Flush());
+    VERIFY_FAILED(engine->_WaitForWriter(0));
+    VERIFY_FAILED(engine->_Flush());
+}
+
 void VtRendererTest::TestResize()
 {
     Viewport view = SetUpViewport();
@@ -269,7 +269,21 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 // If we don't have cached runs, rebuild.
                 if (!_runs.has_value())
                 {
-                    _runs.emplace(begin(), end());
+                    // Fast path for full invalidations (scrolling, resizing, etc.): Every row is a
+                    // single run, and all() tested the bits a block at a time instead of one by one.
+                    if (!_bits.empty() && all())
+                    {
+                        auto& runs = _runs.emplace();
+                        runs.reserve(gsl::narrow_cast<size_t>(_sz.height));
+                        for (CoordType row = 0; row < _sz.height; ++row)
+                        {
+                            runs.emplace_back(0, row, _sz.width, row + 1);
+                        }
+                    }
+                    else
+                    {
+                        _runs.emplace(begin(), end());
+                    }
                 }
 
                 // Return the runs.
@@ -362,10 +376,15 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 THROW_HR_IF(E_INVALIDARG, !_rc.contains(rc));
                 _runs.reset(); // reset cached runs on any non-const method
 
-                for (auto row = rc.top; row < rc.bottom; ++row)
-                {
-                    _bits.set(_rc.index_of(til::point{ rc.left, row }), rc.width(), true);
-                }
+                _set(rc, true);
+            }
+
+            void reset(const til::rect& rc)
+            {
+                THROW_HR_IF(E_INVALIDARG, !_rc.contains(rc));
+                _runs.reset(); // reset cached runs on any non-const method
+
+                _set(rc, false);
             }
 
             void set_all() noexcept
@@ -435,7 +454,9 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             constexpr bool one() const noexcept
             {
-                return _bits.count() == 1;
+                // Unlike count(), this stops at the second set bit.
+                const auto first = _bits.find_first();
+                return first != _bits.npos && _bits.find_next(first) == _bits.npos;
             }
 
             constexpr bool any() const noexcept
@@ -474,6 +495,27 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             }
 
         private:
+            void _set(const til::rect& rc, bool value)
+            {
+                if (rc.empty())
+                {
+                    return;
+                }
+
+                // Rows spanning the entire width are contiguous in _bits,
+                // so they can be set with a single call, a block at a time.
+                if (rc.left == 0 && rc.right == _sz.width)
+                {
+                    _bits.set(_rc.index_of<size_t>(rc.origin()), rc.size().area<size_t>(), value);
+                    return;
+                }
+
+                for (auto row = rc.top; row < rc.bottom; ++row)
+                {
+                    _bits.set(_rc.index_of(til::point{ rc.left, row }), rc.width(), value);
+                }
+            }
+
             void translate_y(ptrdiff_t delta_y, bool fill)
             {
                 if (delta_y == 0)
@@ -3,55 +3,161 @@
 
 #pragma once
 
+#include <intrin.h>
+
 namespace til
 {
     template<typename T>
     struct hash_trait;
 
+    // hasher is based on wyhash (final version 4, public domain, https://github.com/wangyi-fudan/wyhash).
+    // It consumes 16 bytes per 64x64->128-bit multiplication, which makes it several times faster than
+    // FNV-1a (which consumes 1 byte per multiplication) for anything but the shortest inputs, while
+    // passing SMHasher. Its state is 64 bits wide on all architectures, so the hash of some data is
+    // the same in 32-bit builds, apart from being truncated to size_t by finalize().
+    //
+    // Every write() mixes the given bytes into the state as a whole. Hashing a value with one call
+    // to write() thus produces a different hash than hashing its parts with several calls.
     struct hasher
     {
-        explicit constexpr hasher(size_t state = FNV_offset_basis) noexcept :
+        explicit constexpr hasher(size_t state = 0) noexcept :
             _hash{ state } {}
 
         template<typename T>
-        constexpr void write(const T& v) noexcept
+        void write(const T& v) noexcept
         {
             hash_trait<T>{}(*this, v);
         }
 
         template<typename T, typename = std::enable_if_t<std::has_unique_object_representations_v<T>>>
-        constexpr void write(const T* data, size_t count) noexcept
+        void write(const T* data, size_t count) noexcept
         {
 #pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
             write(reinterpret_cast<const uint8_t*>(data), sizeof(T) * count);
         }
 
 #pragma warning(suppress : 26429) // Symbol 'data' is never tested for nullness, it can be marked as not_null (f.23).
-        constexpr void write(const uint8_t* data, size_t count) noexcept
+        void write(const uint8_t* data, size_t count) noexcept
         {
-            for (size_t i = 0; i < count; ++i)
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+            auto p = data;
+            auto seed = _hash ^ _wymix(_hash ^ secret0, secret1);
+            uint64_t a = 0;
+            uint64_t b = 0;
+
+            if (count <= 16)
             {
-#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
-                _hash ^= static_cast<size_t>(data[i]);
-                _hash *= FNV_prime;
+                if (count >= 4)
+                {
+                    // Reads bytes [0,8) and [count-8,count) as two overlapping pairs of 32-bit words.
+                    const auto offset = (count >> 3) << 2;
+                    a = (_read32(p) << 32) | _read32(p + offset);
+                    b = (_read32(p + count - 4) << 32) | _read32(p + count - 4 - offset);
+                }
+                else if (count > 0)
+                {
+                    a = _read3(p, count);
+                }
             }
+            else
+            {
+                auto i = count;
+                if (i > 48)
+                {
+                    // Three independent lanes keep the multipliers of modern CPUs busy.
+                    auto seed1 = seed;
+                    auto seed2 = seed;
+                    do
+                    {
+                        seed = _wymix(_read64(p) ^ secret1, _read64(p + 8) ^ seed);
+                        seed1 = _wymix(_read64(p + 16) ^ secret2, _read64(p + 24) ^ seed1);
+                        seed2 = _wymix(_read64(p + 32) ^ secret3, _read64(p + 40) ^ seed2);
+                        p += 48;
+                        i -= 48;
+                    } while (i > 48);
+                    seed ^= seed1 ^ seed2;
+                }
+                while (i > 16)
+                {
+                    seed = _wymix(_read64(p) ^ secret1, _read64(p + 8) ^ seed);
+                    i -= 16;
+                    p += 16;
+                }
+                a = _read64(p + i - 16);
+                b = _read64(p + i - 8);
+            }
+
+            a ^= secret1;
+            b ^= seed;
+            _wymum(a, b);
+            _hash = _wymix(a ^ secret0 ^ count, b ^ secret1);
+#pragma warning(pop)
         }
 
         constexpr size_t finalize() const noexcept
         {
-            return _hash;
+            return static_cast<size_t>(_hash);
         }
 
     private:
-#if defined(_WIN64)
-        static constexpr size_t FNV_offset_basis = 14695981039346656037ULL;
-        static constexpr size_t FNV_prime = 1099511628211ULL;
+        static constexpr uint64_t secret0 = 0xa0761d6478bd642fULL;
+        static constexpr uint64_t secret1 = 0xe7037ed1a0b428dbULL;
+        static constexpr uint64_t secret2 = 0x8ebc6af09c88c6e3ULL;
+        static constexpr uint64_t secret3 = 0x589965cc75374cc3ULL;
+
+        static void _wymum(uint64_t& a, uint64_t& b) noexcept
+        {
+#if defined(_M_X64) || defined(_M_ARM64)
+            const auto lo = a * b;
+            const auto hi = __umulh(a, b);
 #else
-        static constexpr size_t FNV_offset_basis = 2166136261U;
-        static constexpr size_t FNV_prime = 16777619U;
+            const auto ha = a >> 32;
+            const auto hb = b >> 32;
+            const auto la = static_cast<uint32_t>(a);
+            const auto lb = static_cast<uint32_t>(b);
+            const auto rh = ha * hb;
+            const auto rm0 = ha * lb;
+            const auto rm1 = hb * la;
+            const auto rl = la * uint64_t{ lb };
+            const auto t = rl + (rm0 << 32);
+            auto c = static_cast<uint64_t>(t < rl);
+            const auto lo = t + (rm1 << 32);
+            c += static_cast<uint64_t>(lo < t);
+            const auto hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
 #endif
+            a = lo;
+            b = hi;
+        }
+
+        static uint64_t _wymix(uint64_t a, uint64_t b) noexcept
+        {
+            _wymum(a, b);
+            return a ^ b;
+        }
+
+        static uint64_t _read64(const uint8_t* p) noexcept
+        {
+            uint64_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        static uint64_t _read32(const uint8_t* p) noexcept
+        {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        // Reads 1 to 3 bytes.
+        static uint64_t _read3(const uint8_t* p, size_t count) noexcept
+        {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+            return (uint64_t{ p[0] } << 16) | (uint64_t{ p[count >> 1] } << 8) | p[count - 1];
+        }
 
-        size_t _hash = FNV_offset_basis;
+        uint64_t _hash = 0;
     };
 
     namespace details
@@ -59,7 +165,7 @@ namespace til
         template<typename T, bool enable>
         struct conditionally_enabled_hash_trait
         {
-            constexpr void operator()(hasher& h, const T& v) const noexcept
+            void operator()(hasher& h, const T& v) const noexcept
             {
 #pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
                 h.write(reinterpret_cast<const uint8_t*>(&v), sizeof(T));
@@ -85,7 +191,7 @@ namespace til
     template<>
     struct hash_trait<float>
     {
-        constexpr void operator()(hasher& h, float v) const noexcept
+        void operator()(hasher& h, float v) const noexcept
         {
             v = v == 0.0f ? 0.0f : v; // map -0 to 0
 #pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
@@ -96,7 +202,7 @@ namespace til
     template<>
     struct hash_trait<double>
     {
-        constexpr void operator()(hasher& h, double v) const noexcept
+        void operator()(hasher& h, double v) const noexcept
         {
             v = v == 0.0 ? 0.0 : v; // map -0 to 0
 #pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
@@ -107,7 +213,7 @@ namespace til
     template<typename T, typename CharTraits, typename Allocator>
     struct hash_trait<std::basic_string<T, CharTraits, Allocator>>
     {
-        constexpr void operator()(hasher& h, const std::basic_string<T, CharTraits, Allocator>& v) const noexcept
+        void operator()(hasher& h, const std::basic_string<T, CharTraits, Allocator>& v) const noexcept
         {
 #pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
             h.write(reinterpret_cast<const uint8_t*>(v.data()), sizeof(T) * v.size());
@@ -117,7 +223,7 @@ namespace til
     template<typename T, typename CharTraits>
     struct hash_trait<std::basic_string_view<T, CharTraits>>
     {
-        constexpr void operator()(hasher& h, const std::basic_string_view<T, CharTraits>& v) const noexcept
+        void operator()(hasher& h, const std::basic_string_view<T, CharTraits>& v) const noexcept
         {
 #pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
             h.write(reinterpret_cast<const uint8_t*>(v.data()), sizeof(T) * v.size());
@@ -150,10 +256,21 @@ namespace til
     }
 
     template<typename T, typename = std::enable_if_t<!(std::is_integral_v<T> || std::is_enum_v<T>)>>
-    constexpr size_t hash(const T& v) noexcept
+    size_t hash(const T& v) noexcept
     {
         hasher h;
         h.write(v);
         return h.finalize();
     }
+
+    // Makes til::hash() usable as the Hash of std::unordered_map and std::unordered_set,
+    // for instance std::unordered_map<std::wstring, int, til::hash_functor<std::wstring>>.
+    template<typename T>
+    struct hash_functor
+    {
+        size_t operator()(const T& v) const noexcept
+        {
+            return hash(v);
+        }
+    };
 }
@@ -70,4 +70,129 @@ namespace til::pmr
         return std::pmr::get_default_resource();
     }
 #endif
+
+    // An arena for temporaries that are all thrown away at the same time, like the ones of a frame.
+    // Allocating bumps a pointer and deallocating does nothing, until reset() frees everything at once.
+    //
+    // Unlike std::pmr::monotonic_buffer_resource::release(), reset() keeps the memory around. If the
+    // last cycle needed more than one block, they're replaced by a single block that's as large as
+    // all of them together. Once the arena has seen its largest cycle it thus never allocates again.
+    //
+    // Not thread-safe, just like std::pmr::monotonic_buffer_resource.
+    class arena final : public std::pmr::memory_resource
+    {
+    public:
+        explicit arena(std::pmr::memory_resource* upstream = get_default_resource()) noexcept :
+            _upstream{ upstream }
+        {
+        }
+
+        ~arena() override
+        {
+            _releaseBlocks();
+        }
+
+        arena(const arena&) = delete;
+        arena& operator=(const arena&) = delete;
+        arena(arena&&) = delete;
+        arena& operator=(arena&&) = delete;
+
+        // Frees all allocations. Any memory allocated from this arena must not be used anymore.
+        void reset() noexcept
+        {
+            if (_blocks && _blocks->next)
+            {
+                size_t capacity = 0;
+                for (auto b = _blocks; b; b = b->next)
+                {
+                    capacity += b->capacity;
+                }
+
+                _releaseBlocks();
+                try
+                {
+                    _allocateBlock(capacity);
+                }
+                catch (...)
+                {
+                    // The next allocation will simply try again.
+                }
+            }
+
+            if (_blocks)
+            {
+                _cursor = _blocks->begin();
+                _end = _cursor + _blocks->capacity;
+            }
+        }
+
+    private:
+        // Each block starts with this header, which is followed by its capacity in bytes.
+        struct alignas(std::max_align_t) block
+        {
+            block* next;
+            size_t capacity;
+
+            uintptr_t begin() const noexcept
+            {
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+                return reinterpret_cast<uintptr_t>(this) + sizeof(block);
+            }
+        };
+
+        static constexpr size_t minimumBlockSize = 4096 - sizeof(block);
+
+        void* do_allocate(const size_t bytes, const size_t align) override
+        {
+            auto ptr = (_cursor + align - 1) & ~(uintptr_t{ align } - 1);
+            if (!_blocks || ptr > _end || bytes > _end - ptr)
+            {
+                // The blocks double in size, so that a large cycle only needs a few of them.
+                const auto previous = _blocks ? _blocks->capacity : 0;
+                _allocateBlock(std::max({ minimumBlockSize, previous * 2, bytes + align }));
+                ptr = (_cursor + align - 1) & ~(uintptr_t{ align } - 1);
+            }
+
+            _cursor = ptr + bytes;
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+            return reinterpret_cast<void*>(ptr);
+        }
+
+        void do_deallocate(void* const, const size_t, const size_t) noexcept override
+        {
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        void _allocateBlock(const size_t capacity)
+        {
+            const auto b = static_cast<block*>(_upstream->allocate(sizeof(block) + capacity, alignof(block)));
+            b->next = _blocks;
+            b->capacity = capacity;
+            _blocks = b;
+            _cursor = b->begin();
+            _end = _cursor + capacity;
+        }
+
+        void _releaseBlocks() noexcept
+        {
+            for (auto b = _blocks; b;)
+            {
+                const auto next = b->next;
+                _upstream->deallocate(b, sizeof(block) + b->capacity, alignof(block));
+                b = next;
+            }
+            _blocks = nullptr;
+            _cursor = 0;
+            _end = 0;
+        }
+
+        std::pmr::memory_resource* _upstream;
+        block* _blocks = nullptr;
+        uintptr_t _cursor = 0;
+        uintptr_t _end = 0;
+    };
 }
@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+namespace til
+{
+    // seqlock publishes a small, trivially copyable value from a writer to any number
+    // of readers, without the readers ever taking a lock or blocking the writer.
+    //
+    // The writer bumps a sequence number to an odd value before modifying the value
+    // and back to an even one afterwards. A reader copies the value out and checks that
+    // the sequence number was the same even number before and after doing so.
+    // If it wasn't, the copy might be torn and try_load() returns false.
+    //
+    // store() isn't synchronized against itself: Concurrent writers need to be
+    // serialized by the caller, for instance by only calling it under a lock.
+    template<typename T>
+    class seqlock
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "seqlock copies the value with memcpy");
+
+    public:
+        void store(const T& value) noexcept
+        {
+            const auto sequence = _sequence.load(std::memory_order_relaxed);
+            _sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            memcpy(&_value, &value, sizeof(T));
+            _sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        [[nodiscard]] bool try_load(T& value) const noexcept
+        {
+            const auto sequence = _sequence.load(std::memory_order_acquire);
+            if (sequence & 1)
+            {
+                return false;
+            }
+
+            memcpy(&value, &_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return _sequence.load(std::memory_order_relaxed) == sequence;
+        }
+
+    private:
+        std::atomic<uint32_t> _sequence{ 0 };
+        T _value{};
+    };
+}
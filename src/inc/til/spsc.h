@@ -260,22 +260,22 @@ namespace til::spsc
 
             acquisition producer_acquire(size_type slots, bool blocking) noexcept
             {
-                return acquire(_producer, _consumer, revolution_flag, slots, blocking);
+                return acquire(_producer, _consumer, _consumerWaiting, revolution_flag, slots, blocking);
             }
 
             void producer_release(acquisition acquisition) noexcept
             {
-                release(_producer, acquisition);
+                release(_producer, _producerWaiting, acquisition);
             }
 
             acquisition consumer_acquire(size_type slots, bool blocking) noexcept
             {
-                return acquire(_consumer, _producer, 0, slots, blocking);
+                return acquire(_consumer, _producer, _producerWaiting, 0, slots, blocking);
             }
 
             void consumer_release(acquisition acquisition) noexcept
             {
-                release(_consumer, acquisition);
+                release(_consumer, _consumerWaiting, acquisition);
             }
 
             T* data() const noexcept
@@ -305,7 +305,7 @@ namespace til::spsc
             }
 
             // NOTE: waitMask MUST be either 0 (consumer) or revolution_flag (producer).
-            acquisition acquire(atomic_size_type& mine, atomic_size_type& theirs, size_type waitMask, size_type slots, bool blocking) noexcept
+            acquisition acquire(atomic_size_type& mine, atomic_size_type& theirs, std::atomic<bool>& theirsWaiting, size_type waitMask, size_type slots, bool blocking) noexcept
             {
                 size_type myPos = mine.load(std::memory_order_relaxed);
                 size_type theirPos;
@@ -328,7 +328,17 @@ namespace til::spsc
                         };
                     }
 
-                    theirs.wait(theirPos, std::memory_order_relaxed);
+                    // Announce that we're about to wait, so that release() on the other side knows to wake us up.
+                    // This, and the position being read again after it, pair up with the store of the
+                    // position and the read of this flag in release(): Both are sequentially consistent,
+                    // so either we see the new position, or release() sees the flag.
+                    theirsWaiting.store(true, std::memory_order_seq_cst);
+                    theirPos = theirs.load(std::memory_order_seq_cst);
+                    if ((myPos ^ theirPos) == waitMask)
+                    {
+                        theirs.wait(theirPos, std::memory_order_relaxed);
+                    }
+                    theirsWaiting.store(false, std::memory_order_relaxed);
                 }
 
                 // If the other side's position contains a drop flag, as a X -> we need to...
@@ -375,11 +385,18 @@ namespace til::spsc
                 };
             }
 
-            void release(atomic_size_type& mine, acquisition acquisition) noexcept
+            void release(atomic_size_type& mine, std::atomic<bool>& mineWaiting, acquisition acquisition) noexcept
             {
-                // This release write synchronizes with the acquire read in acquire().
-                mine.store(acquisition.next, std::memory_order_release);
-                mine.notify_one();
+                // This write synchronizes with the acquire read in acquire().
+                // It's sequentially consistent for the sake of the waiting flag. See acquire().
+                mine.store(acquisition.next, std::memory_order_seq_cst);
+
+                // Waking up the other side is a syscall. Most of the time it isn't waiting
+                // (it's busy processing what we gave it before), and we can skip that.
+                if (mineWaiting.load(std::memory_order_seq_cst))
+                {
+                    mine.notify_one();
+                }
             }
 
             T* const _data;
@@ -389,6 +406,10 @@ namespace til::spsc
 
             atomic_size_type _producer;
             atomic_size_type _consumer;
+
+            // True while the other side is (about to be) blocked waiting for _producer / _consumer to change.
+            std::atomic<bool> _producerWaiting{ false };
+            std::atomic<bool> _consumerWaiting{ false };
         };
 
         inline void validate_size(size_t v)
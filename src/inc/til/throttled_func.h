@@ -7,6 +7,17 @@ namespace til
 {
     namespace details
     {
+        // Returns how much later than `delay` the timer of a throttled function may fire, for use
+        // as the window length of SetThreadpoolTimerEx. The thread pool coalesces the expirations
+        // of all timers whose windows overlap into a single wakeup, which matters with the dozens
+        // of throttled functions that a window with many panes has.
+        template<typename Rep, typename Period>
+        constexpr DWORD throttled_func_window(std::chrono::duration<Rep, Period> delay) noexcept
+        {
+            const auto window = std::chrono::duration_cast<std::chrono::milliseconds>(delay).count() / 4;
+            return window > 0 ? static_cast<DWORD>(window) : 0;
+        }
+
         template<typename... Args>
         class throttled_func_storage
         {
@@ -98,6 +109,7 @@ namespace til
         //
         // After `func` was invoked the state is reset and this cycle is repeated again.
         throttled_func(filetime_duration delay, function func) :
+            _window{ details::throttled_func_window(delay) },
             _func{ std::move(func) },
             _timer{ _createTimer() }
         {
@@ -172,7 +184,7 @@ namespace til
                 _func();
             }
 
-            SetThreadpoolTimerEx(_timer.get(), &_delay, 0, 0);
+            SetThreadpoolTimerEx(_timer.get(), &_delay, 0, _window);
         }
 
         void _trailing_edge()
@@ -195,6 +207,7 @@ namespace til
         }
 
         FILETIME _delay;
+        DWORD _window;
         function _func;
         wil::unique_threadpool_timer _timer;
         details::throttled_func_storage<Args...> _storage;
@@ -21,11 +21,23 @@ namespace til
     {
         void lock() noexcept
         {
-            const auto ticket = _next_ticket.fetch_add(1, std::memory_order_relaxed);
+            // This and the loads of _now_serving are sequentially consistent for the sake of unlock(). See there.
+            const auto ticket = _next_ticket.fetch_add(1, std::memory_order_seq_cst);
+
+            // The lock is mostly held for short amounts of time, like the renderer reading a
+            // few rows. Spinning for a bit before going to sleep avoids the two context switches.
+            for (auto spins = 0; spins < spin_count; ++spins)
+            {
+                if (_now_serving.load(std::memory_order_seq_cst) == ticket)
+                {
+                    return;
+                }
+                YieldProcessor();
+            }
 
             for (;;)
             {
-                const auto current = _now_serving.load(std::memory_order_acquire);
+                const auto current = _now_serving.load(std::memory_order_seq_cst);
                 if (current == ticket)
                 {
                     break;
@@ -37,11 +49,28 @@ namespace til
 
         void unlock() noexcept
         {
-            _now_serving.fetch_add(1, std::memory_order_release);
-            til::atomic_notify_all(_now_serving);
+            const auto serving = _now_serving.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+            // Waking up waiters is a syscall. We can skip it if no one has taken a ticket
+            // since the one we just finished serving, which is the uncontended case.
+            // Both this and the fetch_add() in lock() are sequentially consistent, so that
+            // either we see the other thread's ticket, or it sees the new _now_serving.
+            if (_next_ticket.load(std::memory_order_seq_cst) != serving)
+            {
+                til::atomic_notify_all(_now_serving);
+            }
+        }
+
+        // Returns whether any thread holds or waits for the lock right now.
+        // This is only a hint, as the answer may change right after it's given.
+        [[nodiscard]] bool is_contended() const noexcept
+        {
+            return _next_ticket.load(std::memory_order_relaxed) != _now_serving.load(std::memory_order_relaxed);
         }
 
     private:
+        static constexpr int spin_count = 64;
+
         // You may be inclined to add alignas(std::hardware_destructive_interference_size)
         // here to force the two atomics on separate cache lines, but I suggest to carefully
         // benchmark such a change. Since this ticket_lock is primarily used to synchronize
@@ -13,7 +13,9 @@ Tests have been made in order to investigate whether or not own algorithms
 could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
 Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+functions MultiByteToWideChar and WideCharToMultiByte. Only the leading run
+of ASCII characters, which is all there is to most VT output, is converted
+with SSE2 before handing the remainder to them.
 
 Author(s):
 - Steffen Illhardt (german-one), Leonard Hecker (lhecker) 2020-2021
@@ -47,6 +49,122 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         }
     };
 
+    namespace details
+    {
+#pragma warning(push)
+#pragma warning(disable : 26429 26481 26490) // use not_null, pointer arithmetic, reinterpret_cast
+        // Routine Description:
+        // - Converts the leading run of ASCII characters of a UTF-8 string to UTF-16.
+        // Arguments:
+        // - in - UTF-8 string to be converted
+        // - len - length of `in`
+        // - out - buffer for at least `len` UTF-16 code units
+        // Return Value:
+        // - the number of characters converted
+        inline int u8u16_ascii(const char* in, const int len, wchar_t* out) noexcept
+        {
+            int i = 0;
+#if _M_AMD64
+            // Any byte with the high bit set ends the ASCII run.
+            const auto zero = _mm_setzero_si128();
+            for (; i + 16 <= len; i += 16)
+            {
+                const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                if (_mm_movemask_epi8(chars) != 0)
+                {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(chars, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(chars, zero));
+            }
+#endif
+            for (; i < len && static_cast<uint8_t>(in[i]) < 0x80; ++i)
+            {
+                out[i] = static_cast<wchar_t>(in[i]);
+            }
+            return i;
+        }
+
+        // Routine Description:
+        // - Converts the leading run of ASCII characters of a UTF-16 string to UTF-8.
+        // Arguments:
+        // - in - UTF-16 string to be converted
+        // - len - length of `in`
+        // - out - buffer for at least `len` UTF-8 code units
+        // Return Value:
+        // - the number of characters converted
+        inline int u16u8_ascii(const wchar_t* in, const int len, char* out) noexcept
+        {
+            int i = 0;
+#if _M_AMD64
+            // Any code unit with bits outside of 0x7F set ends the ASCII run.
+            const auto zero = _mm_setzero_si128();
+            const auto nonAscii = _mm_set1_epi16(static_cast<short>(0xff80));
+            for (; i + 16 <= len; i += 16)
+            {
+                const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                const auto hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+                const auto isAscii = _mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(lo, hi), nonAscii), zero);
+                if (_mm_movemask_epi8(isAscii) != 0xffff)
+                {
+                    break;
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(lo, hi));
+            }
+#endif
+            for (; i < len && in[i] < 0x80; ++i)
+            {
+                out[i] = static_cast<char>(in[i]);
+            }
+            return i;
+        }
+
+        // Routine Description:
+        // - Converts a UTF-8 string consisting of complete code points to UTF-16.
+        // Arguments:
+        // - Same as MultiByteToWideChar.
+        // Return Value:
+        // - the number of UTF-16 code units written, or 0 if the conversion failed
+        inline int u8u16_convert(const char* in, const int len, wchar_t* out, const int capa) noexcept
+        {
+            const auto ascii = u8u16_ascii(in, std::min(len, capa), out);
+            if (ascii == len)
+            {
+                return ascii;
+            }
+            // The output is full. Don't pass a size of 0, which asks MultiByteToWideChar for the required size.
+            if (ascii == capa)
+            {
+                return 0;
+            }
+            const auto converted = MultiByteToWideChar(CP_UTF8, 0UL, in + ascii, len - ascii, out + ascii, capa - ascii);
+            return converted ? ascii + converted : 0;
+        }
+
+        // Routine Description:
+        // - Converts a UTF-16 string consisting of complete code points to UTF-8.
+        // Arguments:
+        // - Same as WideCharToMultiByte.
+        // Return Value:
+        // - the number of UTF-8 code units written, or 0 if the conversion failed
+        inline int u16u8_convert(const wchar_t* in, const int len, char* out, const int capa) noexcept
+        {
+            const auto ascii = u16u8_ascii(in, std::min(len, capa), out);
+            if (ascii == len)
+            {
+                return ascii;
+            }
+            // The output is full. Don't pass a size of 0, which asks WideCharToMultiByte for the required size.
+            if (ascii == capa)
+            {
+                return 0;
+            }
+            const auto converted = WideCharToMultiByte(CP_UTF8, 0UL, in + ascii, len - ascii, out + ascii, capa - ascii, nullptr, nullptr);
+            return converted ? ascii + converted : 0;
+        }
+#pragma warning(pop)
+    }
+
     // Routine Description:
     // - Takes a UTF-8 string and performs the conversion to UTF-16. NOTE: The function relies on getting complete UTF-8 characters at the string boundaries.
     // Arguments:
@@ -70,7 +188,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
             out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(CP_UTF8, 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
+            const int lengthOut = details::u8u16_convert(in.data(), lengthRequired, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -158,7 +276,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len8)
             {
-                const auto convLen{ MultiByteToWideChar(CP_UTF8, 0UL, cursor8, len8, out.data() + len16, capa16) };
+                const auto convLen{ details::u8u16_convert(cursor8, len8, out.data() + len16, capa16) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len16 += convLen;
@@ -197,7 +315,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // Thus, the worst ratio of UTF-16 code units to UTF-8 code units is 1 to 3.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthIn) || !base::CheckMul(lengthIn, 3).AssignIfValid(&lengthRequired));
             out.resize(gsl::narrow_cast<size_t>(lengthRequired)); // avoid to call WideCharToMultiByte twice only to get the required size
-            const int lengthOut = WideCharToMultiByte(CP_UTF8, 0ul, in.data(), lengthIn, out.data(), lengthRequired, nullptr, nullptr);
+            const int lengthOut = details::u16u8_convert(in.data(), lengthIn, out.data(), lengthRequired);
             out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
             return lengthOut == 0 ? E_UNEXPECTED : S_OK;
@@ -259,7 +377,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
 
             if (len16)
             {
-                const auto convLen{ WideCharToMultiByte(CP_UTF8, 0UL, cursor16, len16, out.data() + len8, capa8, nullptr, nullptr) };
+                const auto convLen{ details::u16u8_convert(cursor16, len16, out.data() + len8, capa8) };
                 RETURN_HR_IF(E_UNEXPECTED, !convLen);
 
                 len8 += convLen;
@@ -46,6 +46,28 @@ static CodepointWidth GetQuickCharWidthLegacyForNumpadEventSynthesis(const wchar
 
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToKeyEvents(const wchar_t wch,
                                                                                          const unsigned int codepage)
+{
+    std::vector<INPUT_RECORD> records;
+    CharToKeyEvents(wch, codepage, records);
+    return ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into the INPUT_RECORDs of the key events that type it,
+//   either using the keyboard or using alt + numpad
+// - this is the allocation free variant used to convert whole strings, like
+//   pasted text, where a heap allocated KeyEvent per record would dominate
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to use for alt + numpad input
+// - keyEvents - the records are appended to this vector
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::CharToKeyEvents(const wchar_t wch,
+                                                        const unsigned int codepage,
+                                                        std::vector<INPUT_RECORD>& keyEvents)
 {
     const short invalidKey = -1;
     short keyState = VkKeyScanW(wch);
@@ -65,13 +87,14 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
                 // It wasn't alphanumeric or determined to be wide by the old algorithm
                 // if VkKeyScanW fails (char is not in kbd layout), we must
                 // emulate the key being input through the numpad
-                return SynthesizeNumpadEvents(wch, codepage);
+                SynthesizeNumpadEvents(wch, codepage, keyEvents);
+                return;
             }
         }
         keyState = 0; // SynthesizeKeyboardEvents would rather get 0 than -1
     }
 
-    return SynthesizeKeyboardEvents(wch, keyState);
+    SynthesizeKeyboardEvents(wch, keyState, keyEvents);
 }
 
 // Routine Description:
@@ -84,33 +107,52 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::CharToK
 // Note:
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::vector<INPUT_RECORD> records;
+    SynthesizeKeyboardEvents(wch, keyState, records);
+    return ToKeyEvents(records);
+}
+
+// Routine Description:
+// - appends the INPUT_RECORDs of a series of key events that type the given
+// wchar_t using the keyboard
+// Arguments:
+// - wch - the wchar_t to convert
+// - keyState - the result of VkKeyScanW for wch
+// - keyEvents - the records are appended to this vector
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::SynthesizeKeyboardEvents(const wchar_t wch, const short keyState, std::vector<INPUT_RECORD>& keyEvents)
 {
     const byte modifierState = HIBYTE(keyState);
 
     bool altGrSet = false;
     bool shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
 
     // add modifier key event if necessary
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
         altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        keyEvents.push_back(KeyEvent{ true,
+                                      1ui16,
+                                      static_cast<WORD>(VK_MENU),
+                                      altScanCode,
+                                      UNICODE_NULL,
+                                      (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED) }
+                                .ToInputRecord());
     }
     else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
         shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        keyEvents.push_back(KeyEvent{ true,
+                                      1ui16,
+                                      static_cast<WORD>(VK_SHIFT),
+                                      leftShiftScanCode,
+                                      UNICODE_NULL,
+                                      SHIFT_PRESSED }
+                                .ToInputRecord());
     }
 
     const auto vk = LOBYTE(keyState);
@@ -132,31 +174,31 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    keyEvents.push_back(keyEvent.ToInputRecord());
     keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    keyEvents.push_back(keyEvent.ToInputRecord());
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        keyEvents.push_back(KeyEvent{ false,
+                                      1ui16,
+                                      static_cast<WORD>(VK_MENU),
+                                      altScanCode,
+                                      UNICODE_NULL,
+                                      ENHANCED_KEY }
+                                .ToInputRecord());
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        keyEvents.push_back(KeyEvent{ false,
+                                      1ui16,
+                                      static_cast<WORD>(VK_SHIFT),
+                                      leftShiftScanCode,
+                                      UNICODE_NULL,
+                                      0 }
+                                .ToInputRecord());
     }
-
-    return keyEvents;
 }
 
 // Routine Description:
@@ -171,15 +213,32 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    std::vector<INPUT_RECORD> records;
+    SynthesizeNumpadEvents(wch, codepage, records);
+    return ToKeyEvents(records);
+}
 
+// Routine Description:
+// - appends the INPUT_RECORDs of a series of key events that type the given
+// wchar_t using Alt + numpad
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage to convert wch to, which determines the digits
+// - keyEvents - the records are appended to this vector
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void Microsoft::Console::Interactivity::SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage, std::vector<INPUT_RECORD>& keyEvents)
+{
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
+    keyEvents.push_back(KeyEvent{ true,
+                                  1ui16,
+                                  static_cast<WORD>(VK_MENU),
+                                  altScanCode,
+                                  UNICODE_NULL,
+                                  LEFT_ALT_PRESSED }
+                            .ToInputRecord());
 
     std::wstring wstr{ wch };
     const auto convertedChars = ConvertToA(codepage, wstr);
@@ -206,27 +265,46 @@ std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::Synthes
             const WORD virtualKey = ch - '0' + VK_NUMPAD0;
             const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
 
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            keyEvents.push_back(KeyEvent{ true,
+                                          1ui16,
+                                          virtualKey,
+                                          virtualScanCode,
+                                          UNICODE_NULL,
+                                          LEFT_ALT_PRESSED }
+                                    .ToInputRecord());
+            keyEvents.push_back(KeyEvent{ false,
+                                          1ui16,
+                                          virtualKey,
+                                          virtualScanCode,
+                                          UNICODE_NULL,
+                                          LEFT_ALT_PRESSED }
+                                    .ToInputRecord());
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
+    keyEvents.push_back(KeyEvent{ false,
+                                  1ui16,
+                                  static_cast<WORD>(VK_MENU),
+                                  altScanCode,
+                                  wch,
+                                  0 }
+                            .ToInputRecord());
+}
+
+// Routine Description:
+// - converts the key event records produced by the functions above back into
+// heap allocated KeyEvents, for the callers that still consume those
+// Arguments:
+// - records - the key event records to convert
+// Return Value:
+// - deque of KeyEvents equivalent to the records
+std::deque<std::unique_ptr<KeyEvent>> Microsoft::Console::Interactivity::ToKeyEvents(const gsl::span<const INPUT_RECORD> records)
+{
+    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    for (const auto& record : records)
+    {
+        keyEvents.push_back(std::make_unique<KeyEvent>(record.Event.KeyEvent));
+    }
     return keyEvents;
 }
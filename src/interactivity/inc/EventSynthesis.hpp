@@ -16,14 +16,20 @@ Author:
 #pragma once
 #include <deque>
 #include <memory>
+#include <vector>
 #include "../../types/inc/IInputEvent.hpp"
 
 namespace Microsoft::Console::Interactivity
 {
     std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch, const unsigned int codepage);
+    void CharToKeyEvents(const wchar_t wch, const unsigned int codepage, std::vector<INPUT_RECORD>& keyEvents);
 
     std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch,
                                                                    const short keyState);
+    void SynthesizeKeyboardEvents(const wchar_t wch, const short keyState, std::vector<INPUT_RECORD>& keyEvents);
 
     std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage);
+    void SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage, std::vector<INPUT_RECORD>& keyEvents);
+
+    std::deque<std::unique_ptr<KeyEvent>> ToKeyEvents(const gsl::span<const INPUT_RECORD> records);
 }
@@ -108,7 +108,7 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents = TextToKeyEvents(pData, cchData);
+        const auto inEvents = TextToKeyEvents(pData, cchData);
         gci.pInputBuffer->Write(inEvents);
     }
     catch (...)
@@ -128,15 +128,22 @@ void Clipboard::StringPaste(_In_reads_(cchData) const wchar_t* const pData,
 // - pData - the text to convert
 // - cchData - the size of pData, in wchars
 // Return Value:
-// - deque of KeyEvents that represent the string passed in
+// - the records of the KeyEvents that represent the string passed in. Large
+//   pastes produce several records per character, so these are kept by value
+//   instead of allocating an event object for each one of them.
 // Note:
 // - will throw exception on error
-std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
-                                                                    const size_t cchData)
+std::vector<INPUT_RECORD> Clipboard::TextToKeyEvents(_In_reads_(cchData) const wchar_t* const pData,
+                                                     const size_t cchData)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, pData);
 
-    std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+    const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
+    const auto vtInputMode = IsInVirtualTerminalInputMode();
+
+    // Most characters are a key down and a key up.
+    std::vector<INPUT_RECORD> keyEvents;
+    keyEvents.reserve(cchData * 2);
 
     for (size_t i = 0; i < cchData; ++i)
     {
@@ -169,18 +176,12 @@ std::deque<std::unique_ptr<IInputEvent>> Clipboard::TextToKeyEvents(_In_reads_(c
         // This change doesn't break pasting text into any of those applications
         //      with CR/LF (Windows) line endings either. That apparently always
         //      worked right.
-        if (IsInVirtualTerminalInputMode() && currentChar == UNICODE_LINEFEED)
+        if (vtInputMode && currentChar == UNICODE_LINEFEED)
         {
             currentChar = UNICODE_CARRIAGERETURN;
         }
 
-        const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().OutputCP;
-        std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(currentChar, codepage);
-        while (!convertedEvents.empty())
-        {
-            keyEvents.push_back(std::move(convertedEvents.front()));
-            convertedEvents.pop_front();
-        }
+        CharToKeyEvents(currentChar, codepage, keyEvents);
     }
     return keyEvents;
 }
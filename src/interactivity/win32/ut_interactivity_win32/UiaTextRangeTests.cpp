@@ -1498,6 +1498,31 @@ class UiaTextRangeTests
         VERIFY_ARE_EQUAL(L"M", std::wstring_view{ text });
     }
 
+    TEST_METHOD(WordMovementSeesBufferChanges)
+    {
+        // Word boundaries are cached per row. Changing a row must invalidate them.
+        _pTextBuffer->Write({ L"My name is Carlos" }, origin.to_win32_coord());
+
+        Microsoft::WRL::ComPtr<UiaTextRange> utr;
+        THROW_IF_FAILED(Microsoft::WRL::MakeAndInitialize<UiaTextRange>(&utr, _pUiaData, &_dummyProvider, origin.to_win32_coord(), origin.to_win32_coord()));
+
+        int moveAmt;
+        THROW_IF_FAILED(utr->Move(TextUnit::TextUnit_Word, 1, &moveAmt));
+        VERIFY_ARE_EQUAL(1, moveAmt);
+        VERIFY_ARE_EQUAL((COORD{ 3, 0 }), utr->_start);
+
+        THROW_IF_FAILED(utr->Move(TextUnit::TextUnit_Word, -1, &moveAmt));
+        VERIFY_ARE_EQUAL(-1, moveAmt);
+        VERIFY_ARE_EQUAL(origin.to_win32_coord(), utr->_start);
+
+        // Joins the first two words into one.
+        _pTextBuffer->Write({ L"MyXname" }, origin.to_win32_coord());
+
+        THROW_IF_FAILED(utr->Move(TextUnit::TextUnit_Word, 1, &moveAmt));
+        VERIFY_ARE_EQUAL(1, moveAmt);
+        VERIFY_ARE_EQUAL((COORD{ 8, 0 }), utr->_start);
+    }
+
     TEST_METHOD(ScrollIntoView)
     {
         const auto viewportSize{ _pUiaData->GetViewport() };
@@ -788,6 +788,12 @@ void Window::_HandleWindowPosChanged(const LPARAM lParam)
         _UpdateSystemMetrics();
     }
 
+    // Let the renderer back off while nobody can see what it paints.
+    if (const auto pRender = ServiceLocator::LocateGlobals().pRender)
+    {
+        pRender->SetOccluded(IsIconic(hWnd) != FALSE);
+    }
+
     // This message is sent as the result of someone calling SetWindowPos(). We use it here to set/clear the
     // CONSOLE_IS_ICONIC bit appropriately. doing so in the WM_SIZE handler is incorrect because the WM_SIZE
     // comes after the WM_ERASEBKGND during SetWindowPos() processing, and the WM_ERASEBKGND needs to know if
@@ -50,19 +50,7 @@ constexpr HRESULT vec2_narrow(U x, U y, AtlasEngine::vec2<T>& out) noexcept
 
 [[nodiscard]] HRESULT AtlasEngine::InvalidateCursor(const SMALL_RECT* const psrRegion) noexcept
 {
-    //assert(psrRegion->Left <= psrRegion->Right && psrRegion->Left >= 0 && psrRegion->Right <= _api.cellCount.x);
-    //assert(psrRegion->Top <= psrRegion->Bottom && psrRegion->Top >= 0 && psrRegion->Bottom <= _api.cellCount.y);
-
-    const auto left = gsl::narrow_cast<u16>(psrRegion->Left);
-    const auto top = gsl::narrow_cast<u16>(psrRegion->Top);
-    const auto right = gsl::narrow_cast<u16>(psrRegion->Right);
-    const auto bottom = gsl::narrow_cast<u16>(psrRegion->Bottom);
-
-    // BeginPaint() protects against invalid out of bounds numbers.
-    _api.invalidatedCursorArea.left = std::min(_api.invalidatedCursorArea.left, left);
-    _api.invalidatedCursorArea.top = std::min(_api.invalidatedCursorArea.top, top);
-    _api.invalidatedCursorArea.right = std::max(_api.invalidatedCursorArea.right, right);
-    _api.invalidatedCursorArea.bottom = std::max(_api.invalidatedCursorArea.bottom, bottom);
+    // The cursor is an overlay that doesn't depend on the cells underneath. See PrepareRenderInfo().
     return S_OK;
 }
 
@@ -80,14 +68,7 @@ constexpr HRESULT vec2_narrow(U x, U y, AtlasEngine::vec2<T>& out) noexcept
 
 [[nodiscard]] HRESULT AtlasEngine::InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept
 {
-    for (const auto& rect : rectangles)
-    {
-        // BeginPaint() protects against invalid out of bounds numbers.
-        // TODO: rect can contain invalid out of bounds coordinates when the selection is being
-        // dragged outside of the viewport (and the window begins scrolling automatically).
-        _api.invalidatedRows.x = gsl::narrow_cast<u16>(std::min<int>(_api.invalidatedRows.x, std::max<int>(0, rect.Top)));
-        _api.invalidatedRows.y = gsl::narrow_cast<u16>(std::max<int>(_api.invalidatedRows.y, std::max<int>(0, rect.Bottom)));
-    }
+    // The selection is an overlay that doesn't depend on the cells underneath. See PrepareRenderInfo().
     return S_OK;
 }
 
@@ -105,9 +86,6 @@ constexpr HRESULT vec2_narrow(U x, U y, AtlasEngine::vec2<T>& out) noexcept
     // a InvalidateScroll() refer to the new viewport after the scroll.
     // --> We need to shift the current invalidation rectangles as well.
 
-    _api.invalidatedCursorArea.top = gsl::narrow_cast<u16>(clamp<int>(_api.invalidatedCursorArea.top + delta, u16min, u16max));
-    _api.invalidatedCursorArea.bottom = gsl::narrow_cast<u16>(clamp<int>(_api.invalidatedCursorArea.bottom + delta, u16min, u16max));
-
     if (delta < 0)
     {
         _api.invalidatedRows.x = gsl::narrow_cast<u16>(clamp<int>(_api.invalidatedRows.x + delta, u16min, u16max));
@@ -284,6 +262,13 @@ HRESULT AtlasEngine::Enable() noexcept
     return static_cast<float>(_api.dpi) / static_cast<float>(USER_DEFAULT_SCREEN_DPI);
 }
 
+[[nodiscard]] HRESULT AtlasEngine::GetGlyphCacheStatistics(uint64_t& lookups, uint64_t& hits) const noexcept
+{
+    lookups = _sr.glyphLookups.load(std::memory_order_relaxed);
+    hits = _sr.glyphHits.load(std::memory_order_relaxed);
+    return S_OK;
+}
+
 [[nodiscard]] HANDLE AtlasEngine::GetSwapChainHandle()
 {
     if (WI_IsFlagSet(_api.invalidations, ApiInvalidations::Device))
@@ -320,6 +305,14 @@ void AtlasEngine::SetAntialiasingMode(const D2D1_TEXT_ANTIALIAS_MODE antialiasin
     }
 }
 
+[[nodiscard]] HRESULT AtlasEngine::RequestThumbnail(const til::size maxSize, std::function<void(RenderThumbnail&&)> pfn) noexcept
+{
+    RETURN_HR_IF(E_INVALIDARG, maxSize.width <= 0 || maxSize.height <= 0 || !pfn);
+    _api.thumbnailSize = maxSize;
+    _api.thumbnailCallback = std::move(pfn);
+    return S_OK;
+}
+
 void AtlasEngine::SetCallback(std::function<void()> pfn) noexcept
 {
     _api.swapChainChangedCallback = std::move(pfn);
@@ -331,8 +324,11 @@ void AtlasEngine::EnableTransparentBackground(const bool isTransparent) noexcept
     if (_api.backgroundOpaqueMixin != mixin)
     {
         _api.backgroundOpaqueMixin = mixin;
+        const auto antialiasingMode = _api.realizedAntialiasingMode;
         _resolveAntialiasingMode();
         WI_SetFlag(_api.invalidations, ApiInvalidations::SwapChain);
+        // The format of the text atlas depends on the antialiasing mode. See _textAtlasFormat().
+        WI_SetFlagIf(_api.invalidations, ApiInvalidations::Font, _api.realizedAntialiasingMode != antialiasingMode);
     }
 }
 
@@ -372,6 +368,26 @@ void AtlasEngine::SetSoftwareRendering(bool enable) noexcept
 {
 }
 
+void AtlasEngine::SetSharedDeviceRendering(bool enable) noexcept
+{
+    if (_api.sharedDevice != enable)
+    {
+        _api.sharedDevice = enable;
+        WI_SetFlag(_api.invalidations, ApiInvalidations::Device);
+    }
+}
+
+// Smooth scrolling: the viewport is scrolled by the given fraction of a row
+// beyond its top row. The rows are drawn shifted up by as many pixels, which
+// only requires an update of the constant buffer. The row below the viewport,
+// which is thereby scrolled partially into view, is kept in an additional row
+// of cells that the Renderer paints while the offset isn't 0.
+[[nodiscard]] HRESULT AtlasEngine::SetSmoothScrollOffset(const float rows) noexcept
+{
+    _api.smoothScrollOffset = clamp(rows, 0.0f, 1.0f);
+    return S_OK;
+}
+
 void AtlasEngine::SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept
 {
     _api.warningCallback = std::move(pfn);
@@ -389,7 +405,7 @@ void AtlasEngine::SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept
     if (_api.sizeInPixel != newSize && newSize != u16x2{})
     {
         _api.sizeInPixel = newSize;
-        _api.cellCount = _api.sizeInPixel / _api.fontMetrics.cellSize;
+        _resolveCellCount();
         WI_SetFlag(_api.invalidations, ApiInvalidations::Size);
     }
 
@@ -400,6 +416,66 @@ void AtlasEngine::ToggleShaderEffects() noexcept
 {
 }
 
+// Releases the glyph atlas, the cell buffers and the scratch buffers, which
+// grow to the largest size they were ever needed at, and shrinks the swap
+// chain to a single pixel. The next StartPaint() recreates all of it, as if
+// the size and the font had changed. The glyphs are copied back from the
+// SharedGlyphCache instead of being rasterized again.
+// This touches _r and is thus only called on the render thread, under the
+// console lock. See Renderer::TrimResourcesNow().
+void AtlasEngine::TrimResources() noexcept
+try
+{
+    if (!_r.device)
+    {
+        return;
+    }
+
+    const auto lock = _lockSharedDevice(_api.sharedDevice || _r.sharedDevice);
+
+    // See _recreateFontDependentResources().
+    _r.atlases = {};
+    _r.glyphs = {};
+    _r.glyphQueue = {};
+    _api.fontFallbackCache = {};
+    _api.shapedTextCache = {};
+
+    // See _recreateSizeDependentResources(). Resetting _r.cellCount makes it reallocate these.
+    _r.cells = {};
+    _r.cellCount = {};
+    _r.cellBuffer.reset();
+    _r.cellView.reset();
+    _r.cellBufferBack.reset();
+    _r.cellViewBack.reset();
+    _r.selectionBuffer.reset();
+    _r.selectionView.reset();
+    _r.selectionRows = {};
+    _r.selectionRowsNext = {};
+    _api.bufferLine = {};
+    _api.bufferLineColumn = {};
+    _api.bufferLineMetadata = {};
+    _api.bufferLines = {};
+    _api.bufferLineCount = 0;
+    _api.textAnalysisScratch = {};
+
+    // _recreateSizeDependentResources() only resizes the swap chain if there's a
+    // _r.renderTargetView, which is why we create one for the shrunken buffer, too.
+    if (_r.renderTargetView)
+    {
+        _r.renderTargetView.reset();
+        _r.deviceContext->ClearState();
+        _r.deviceContext->Flush();
+        THROW_IF_FAILED(_r.swapChain->ResizeBuffers(0, 1, 1, DXGI_FORMAT_UNKNOWN, DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT));
+
+        wil::com_ptr<ID3D11Texture2D> buffer;
+        THROW_IF_FAILED(_r.swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), buffer.put_void()));
+        THROW_IF_FAILED(_r.device->CreateRenderTargetView(buffer.get(), nullptr, _r.renderTargetView.put()));
+    }
+
+    WI_SetAllFlags(_api.invalidations, ApiInvalidations::Size | ApiInvalidations::Font);
+}
+CATCH_LOG()
+
 [[nodiscard]] HRESULT AtlasEngine::UpdateFont(const FontInfoDesired& fontInfoDesired, FontInfo& fontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes) noexcept
 try
 {
@@ -486,7 +562,7 @@ try
 
     if (previousCellSize != _api.fontMetrics.cellSize)
     {
-        _api.cellCount = _api.sizeInPixel / _api.fontMetrics.cellSize;
+        _resolveCellCount();
         WI_SetFlag(_api.invalidations, ApiInvalidations::Size);
     }
 
@@ -510,6 +586,13 @@ void AtlasEngine::_resolveAntialiasingMode() noexcept
     _api.realizedAntialiasingMode = forceGrayscaleAA ? D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE : _api.antialiasingMode;
 }
 
+void AtlasEngine::_resolveCellCount() noexcept
+{
+    _api.cellCount = _api.sizeInPixel / _api.fontMetrics.cellSize;
+    // The additional row below the viewport. See SetSmoothScrollOffset().
+    _api.cellCount.y++;
+}
+
 void AtlasEngine::_resolveFontMetrics(const FontInfoDesired& fontInfoDesired, FontInfo& fontInfo, FontMetrics* fontMetrics) const
 {
     auto requestedFaceName = fontInfoDesired.GetFaceName().c_str();
@@ -187,6 +187,9 @@ AtlasEngine::AtlasEngine()
         _sr.textAnalyzer = textAnalyzer.query<IDWriteTextAnalyzer1>();
     }
 
+    _sr.textAnalysisWork.reset(CreateThreadpoolWork(&_analyzeBufferLinesCallback, this, nullptr));
+    THROW_LAST_ERROR_IF(!_sr.textAnalysisWork);
+
     _sr.isWindows10OrGreater = IsWindows10OrGreater();
 
 #ifndef NDEBUG
@@ -211,6 +214,9 @@ AtlasEngine::AtlasEngine()
 [[nodiscard]] HRESULT AtlasEngine::StartPaint() noexcept
 try
 {
+    // Recreating any of our resources below uses the immediate context.
+    const auto lock = _lockSharedDevice(_api.sharedDevice || _r.sharedDevice);
+
     if (_api.hwnd)
     {
         RECT rect;
@@ -224,6 +230,13 @@ try
         }
     }
 
+    // The capture happens in Present(), which can't access _api.
+    if (_api.thumbnailCallback)
+    {
+        _r.thumbnailSize = _api.thumbnailSize;
+        _r.thumbnailCallback = std::exchange(_api.thumbnailCallback, nullptr);
+    }
+
     // It's important that we invalidate here instead of in Present() with the rest.
     // Other functions, those called before Present(), might depend on _r fields.
     // But most of the time _invalidations will be ::none, making this very cheap.
@@ -301,22 +314,23 @@ try
     }
 #endif
 
+    // Colors that aren't on screen anymore are never removed from the palette.
+    // Instead it's rebuilt from scratch by repainting everything, long before it's full.
+    if (_r.palette.size() >= paletteResetThreshold)
+    {
+        _resetPalette();
+        _api.invalidatedRows = invalidatedRowsAll;
+    }
+
     if (_api.invalidatedRows == invalidatedRowsAll)
     {
         // Skip all the partial updates, since we redraw everything anyways.
-        _api.invalidatedCursorArea = invalidatedAreaNone;
         _api.invalidatedRows = { 0, _api.cellCount.y };
         _api.scrollOffset = 0;
     }
     else
     {
         // Clamp invalidation rects into valid value ranges.
-        {
-            _api.invalidatedCursorArea.left = std::min(_api.invalidatedCursorArea.left, _api.cellCount.x);
-            _api.invalidatedCursorArea.top = std::min(_api.invalidatedCursorArea.top, _api.cellCount.y);
-            _api.invalidatedCursorArea.right = clamp(_api.invalidatedCursorArea.right, _api.invalidatedCursorArea.left, _api.cellCount.x);
-            _api.invalidatedCursorArea.bottom = clamp(_api.invalidatedCursorArea.bottom, _api.invalidatedCursorArea.top, _api.cellCount.y);
-        }
         {
             _api.invalidatedRows.x = std::min(_api.invalidatedRows.x, _api.cellCount.y);
             _api.invalidatedRows.y = clamp(_api.invalidatedRows.y, _api.invalidatedRows.x, _api.cellCount.y);
@@ -361,9 +375,23 @@ try
             }
 
             memmove(dst, src, count * sizeof(Cell));
+
+            // Present() repeats the scroll on the GPU, instead of uploading all the rows we just moved.
+            // If the last scroll never made it there, we have to upload everything after all.
+            if (_r.cellScrollOffset != 0)
+            {
+                _r.cellScrollOffset = 0;
+                _markCellRowsDirty(0, _api.cellCount.y);
+            }
+            else
+            {
+                _r.cellScrollOffset = _api.scrollOffset;
+            }
         }
     }
 
+    _markCellRowsDirty(_api.invalidatedRows.x, _api.invalidatedRows.y);
+
     _api.dirtyRect = til::rect{
         0,
         _api.invalidatedRows.x,
@@ -382,9 +410,9 @@ CATCH_RETURN()
 [[nodiscard]] HRESULT AtlasEngine::EndPaint() noexcept
 try
 {
-    _flushBufferLine();
+    _flushBufferLines();
 
-    _api.invalidatedCursorArea = invalidatedAreaNone;
+    _r.glyphGeneration++;
     _api.invalidatedRows = invalidatedRowsNone;
     _api.scrollOffset = 0;
     return S_OK;
@@ -393,7 +421,8 @@ CATCH_RETURN()
 
 [[nodiscard]] bool AtlasEngine::RequiresContinuousRedraw() noexcept
 {
-    return continuousRedraw;
+    // The next Present() can't be relied upon to rasterize all of these. See _processGlyphQueue().
+    return continuousRedraw || _r.glyphQueue.size() > glyphQueueMinimumPerFrame;
 }
 
 void AtlasEngine::WaitUntilCanRender() noexcept
@@ -426,18 +455,102 @@ void AtlasEngine::WaitUntilCanRender() noexcept
     return S_OK;
 }
 
+// The cursor and the selection are drawn by the pixel shader on top of the cells,
+// instead of being flags of the cells they cover. This way a blinking cursor or
+// a selection that's being dragged doesn't invalidate any rows: Present() only
+// has to update the constant buffer or the selection rows and draw the frame.
 [[nodiscard]] HRESULT AtlasEngine::PrepareRenderInfo(const RenderFrameInfo& info) noexcept
+try
 {
+    u16r cursorRect{};
+    if (info.cursorInfo && info.cursorInfo->isOn)
+    {
+        const auto& options = *info.cursorInfo;
+        const CachedCursorOptions cachedOptions{
+            gsl::narrow_cast<u32>(options.fUseColor ? options.cursorColor | 0xff000000 : INVALID_COLOR),
+            gsl::narrow_cast<u16>(options.cursorType),
+            gsl::narrow_cast<u8>(options.ulCursorHeightPercent),
+        };
+        if (_r.cursorOptions != cachedOptions)
+        {
+            _r.cursorOptions = cachedOptions;
+            WI_SetAllFlags(_r.invalidations, RenderInvalidations::Cursor | RenderInvalidations::ConstBuffer);
+        }
+
+        const auto point = options.coordCursor;
+        // TODO: options.coordCursor can contain invalid out of bounds coordinates when
+        // the window is being resized and the cursor is on the last line of the viewport.
+        cursorRect.left = gsl::narrow_cast<u16>(clamp<int>(point.X, 0, _r.cellCount.x - 1));
+        cursorRect.top = gsl::narrow_cast<u16>(clamp<int>(point.Y, 0, _r.cellCount.y - 1));
+        cursorRect.right = gsl::narrow_cast<u16>(cursorRect.left + 1 + (options.fIsDoubleWidth & (options.cursorType != CursorType::VerticalBar)));
+        cursorRect.bottom = cursorRect.top + 1;
+    }
+    if (_r.cursorRect != cursorRect)
+    {
+        _r.cursorRect = cursorRect;
+        WI_SetFlag(_r.invalidations, RenderInvalidations::ConstBuffer);
+    }
+
+    // Scrolling by less than a row doesn't change any of the cells, only where they're drawn.
+    if (const auto scrollOffsetY = gsl::narrow_cast<u16>(std::lroundf(_api.smoothScrollOffset * _r.cellSize.y)); _r.scrollOffsetY != scrollOffsetY)
+    {
+        _r.scrollOffsetY = scrollOffsetY;
+        WI_SetFlag(_r.invalidations, RenderInvalidations::ConstBuffer);
+    }
+
+    // Each row of the selection is stored as the range of columns it covers, which is
+    // all the shader needs. The rectangles can contain out of bounds coordinates when
+    // the selection is being dragged outside of the viewport, which is why they're clamped.
+    auto& rows = _r.selectionRowsNext;
+    rows.assign(_r.cellCount.y, 0);
+    for (const auto& rect : info.selectionRects)
+    {
+        const auto left = clamp<int>(rect.Left, 0, _r.cellCount.x);
+        const auto right = clamp<int>(rect.Right, left, _r.cellCount.x);
+        const auto top = clamp<int>(rect.Top, 0, _r.cellCount.y);
+        const auto bottom = clamp<int>(rect.Bottom, top, _r.cellCount.y);
+        if (left == right)
+        {
+            continue;
+        }
+
+        for (auto y = top; y < bottom; ++y)
+        {
+            auto& row = rows[y];
+            auto rowLeft = left;
+            auto rowRight = right;
+            if (row)
+            {
+                rowLeft = std::min<int>(rowLeft, row & 0xffff);
+                rowRight = std::max<int>(rowRight, row >> 16);
+            }
+            row = gsl::narrow_cast<u32>(rowLeft) | gsl::narrow_cast<u32>(rowRight) << 16;
+        }
+    }
+    if (rows != _r.selectionRows)
+    {
+        _r.selectionRows.swap(rows);
+        WI_SetFlag(_r.invalidations, RenderInvalidations::Selection);
+    }
+
     return S_OK;
 }
+CATCH_RETURN()
 
 [[nodiscard]] HRESULT AtlasEngine::ResetLineTransform() noexcept
 {
+    WI_ClearAllFlags(_api.flags, CellFlags::LineRendition);
     return S_OK;
 }
 
+// Rows with a line rendition (DECDWL/DECDHL) are painted into their cells just like any
+// other row, at the regular size of their glyphs. Only the pixel shader scales them up,
+// so that they share the glyphs of the atlas with every other row instead of filling
+// it with glyphs rasterized at twice their size.
 [[nodiscard]] HRESULT AtlasEngine::PrepareLineTransform(const LineRendition lineRendition, const size_t targetRow, const size_t viewportLeft) noexcept
 {
+    const auto flags = static_cast<CellFlags>(gsl::narrow_cast<u16>(static_cast<int>(lineRendition) << 3));
+    WI_UpdateFlagsInMask(_api.flags, CellFlags::LineRendition, flags);
     return S_OK;
 }
 
@@ -454,7 +567,7 @@ try
 
     if (_api.lastPaintBufferLineCoord.y != y)
     {
-        _flushBufferLine();
+        _queueBufferLine();
     }
 
     _api.lastPaintBufferLineCoord = { x, y };
@@ -508,59 +621,16 @@ try
 CATCH_RETURN()
 
 [[nodiscard]] HRESULT AtlasEngine::PaintSelection(SMALL_RECT rect) noexcept
-try
 {
-    // Unfortunately there's no step after Renderer::_PaintBufferOutput that
-    // would inform us that it's done with the last AtlasEngine::PaintBufferLine.
-    // As such we got to call _flushBufferLine() here just to be sure.
-    _flushBufferLine();
-    _setCellFlags(rect, CellFlags::Selected, CellFlags::Selected);
+    // The selection was already picked up by PrepareRenderInfo().
     return S_OK;
 }
-CATCH_RETURN()
 
 [[nodiscard]] HRESULT AtlasEngine::PaintCursor(const CursorOptions& options) noexcept
-try
 {
-    // Unfortunately there's no step after Renderer::_PaintBufferOutput that
-    // would inform us that it's done with the last AtlasEngine::PaintBufferLine.
-    // As such we got to call _flushBufferLine() here just to be sure.
-    _flushBufferLine();
-
-    {
-        const CachedCursorOptions cachedOptions{
-            gsl::narrow_cast<u32>(options.fUseColor ? options.cursorColor | 0xff000000 : INVALID_COLOR),
-            gsl::narrow_cast<u16>(options.cursorType),
-            gsl::narrow_cast<u8>(options.ulCursorHeightPercent),
-        };
-        if (_r.cursorOptions != cachedOptions)
-        {
-            _r.cursorOptions = cachedOptions;
-            WI_SetFlag(_r.invalidations, RenderInvalidations::Cursor);
-        }
-    }
-
-    // Clear the previous cursor
-    if (_api.invalidatedCursorArea.non_empty())
-    {
-        _setCellFlags(til::bit_cast<SMALL_RECT>(_api.invalidatedCursorArea), CellFlags::Cursor, CellFlags::None);
-    }
-
-    if (options.isOn)
-    {
-        const auto point = options.coordCursor;
-        // TODO: options.coordCursor can contain invalid out of bounds coordinates when
-        // the window is being resized and the cursor is on the last line of the viewport.
-        const auto x = gsl::narrow_cast<SHORT>(std::min<int>(point.X, _r.cellCount.x - 1));
-        const auto y = gsl::narrow_cast<SHORT>(std::min<int>(point.Y, _r.cellCount.y - 1));
-        const SHORT right = x + 1 + (options.fIsDoubleWidth & (options.cursorType != CursorType::VerticalBar));
-        const SHORT bottom = y + 1;
-        _setCellFlags({ x, y, right, bottom }, CellFlags::Cursor, CellFlags::Cursor);
-    }
-
+    // The cursor was already picked up by PrepareRenderInfo().
     return S_OK;
 }
-CATCH_RETURN()
 
 [[nodiscard]] HRESULT AtlasEngine::UpdateDrawingBrushes(const TextAttribute& textAttributes, const RenderSettings& renderSettings, const gsl::not_null<IRenderData*> /*pData*/, const bool usingSoftFont, const bool isSettingDefaultBrushes) noexcept
 try
@@ -592,12 +662,13 @@ try
 
         if (_api.attributes != attributes)
         {
-            _flushBufferLine();
+            _queueBufferLine();
         }
 
         _api.currentColor = newColors;
         _api.attributes = attributes;
-        _api.flags = flags;
+        // The line rendition belongs to the row, not the text attributes.
+        _api.flags = flags | (_api.flags & CellFlags::LineRendition);
     }
     else if (textAttributes.BackgroundIsDefault() && bg != _r.backgroundColor)
     {
@@ -672,9 +743,51 @@ void AtlasEngine::_createResources()
 #endif // NDEBUG
 
     // D3D device setup (basically a D3D class factory)
+    if (_api.sharedDevice)
     {
-        wil::com_ptr<ID3D11DeviceContext> deviceContext;
+        // The immediate context of the shared device is used by several render threads.
+        _r.sharedDevice = _getSharedDevice(deviceFlags & ~D3D11_CREATE_DEVICE_SINGLETHREADED);
+        _r.device = _r.sharedDevice->device;
+        _r.deviceContext = _r.sharedDevice->deviceContext;
+    }
+    else
+    {
+        std::tie(_r.device, _r.deviceContext) = _createDevice(deviceFlags);
+    }
+
+#ifndef NDEBUG
+    // D3D debug messages
+    if (deviceFlags & D3D11_CREATE_DEVICE_DEBUG)
+    {
+        const auto infoQueue = _r.device.query<ID3D11InfoQueue>();
+        for (const auto severity : std::array{ D3D11_MESSAGE_SEVERITY_CORRUPTION, D3D11_MESSAGE_SEVERITY_ERROR, D3D11_MESSAGE_SEVERITY_WARNING })
+        {
+            infoQueue->SetBreakOnSeverity(severity, true);
+        }
+    }
+#endif // NDEBUG
+
+    // Our constant buffer will never get resized
+    {
+        D3D11_BUFFER_DESC desc{};
+        desc.ByteWidth = sizeof(ConstBuffer);
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        THROW_IF_FAILED(_r.device->CreateBuffer(&desc, nullptr, _r.constantBuffer.put()));
+    }
+
+    THROW_IF_FAILED(_r.device->CreateVertexShader(&shader_vs[0], sizeof(shader_vs), nullptr, _r.vertexShader.put()));
+    THROW_IF_FAILED(_r.device->CreatePixelShader(&shader_ps[0], sizeof(shader_ps), nullptr, _r.pixelShader.put()));
 
+    WI_ClearFlag(_api.invalidations, ApiInvalidations::Device);
+    WI_SetAllFlags(_api.invalidations, ApiInvalidations::SwapChain);
+}
+
+std::pair<wil::com_ptr<ID3D11Device>, wil::com_ptr<ID3D11DeviceContext1>> AtlasEngine::_createDevice(UINT deviceFlags)
+{
+    wil::com_ptr<ID3D11Device> device;
+    wil::com_ptr<ID3D11DeviceContext> deviceContext;
+    {
         // Why D3D11_CREATE_DEVICE_PREVENT_INTERNAL_THREADING_OPTIMIZATIONS:
         // This flag prevents the driver from creating a large thread pool for things like shader computations
         // that would be advantageous for games. For us this has only a minimal performance benefit,
@@ -701,7 +814,7 @@ void AtlasEngine::_createResources()
                 /* pFeatureLevels */ featureLevels.data(),
                 /* FeatureLevels */ gsl::narrow_cast<UINT>(featureLevels.size()),
                 /* SDKVersion */ D3D11_SDK_VERSION,
-                /* ppDevice */ _r.device.put(),
+                /* ppDevice */ device.put(),
                 /* pFeatureLevel */ nullptr,
                 /* ppImmediateContext */ deviceContext.put());
             if (SUCCEEDED(hr))
@@ -710,36 +823,34 @@ void AtlasEngine::_createResources()
             }
         }
         THROW_IF_FAILED(hr);
-
-        _r.deviceContext = deviceContext.query<ID3D11DeviceContext1>();
     }
+    return { std::move(device), deviceContext.query<ID3D11DeviceContext1>() };
+}
 
-#ifndef NDEBUG
-    // D3D debug messages
-    if (deviceFlags & D3D11_CREATE_DEVICE_DEBUG)
-    {
-        const auto infoQueue = _r.device.query<ID3D11InfoQueue>();
-        for (const auto severity : std::array{ D3D11_MESSAGE_SEVERITY_CORRUPTION, D3D11_MESSAGE_SEVERITY_ERROR, D3D11_MESSAGE_SEVERITY_WARNING })
-        {
-            infoQueue->SetBreakOnSeverity(severity, true);
-        }
-    }
-#endif // NDEBUG
+// Returns the SharedDevice, creating it if no instance uses it at the moment or if it was
+// removed. It's released along with the last instance that uses it. The caller must hold
+// _lockSharedDevice(), which also protects the instance below.
+std::shared_ptr<AtlasEngine::SharedDevice> AtlasEngine::_getSharedDevice(UINT deviceFlags)
+{
+    static std::weak_ptr<SharedDevice> instance;
 
-    // Our constant buffer will never get resized
+    auto shared = instance.lock();
+    if (!shared || shared->device->GetDeviceRemovedReason() != S_OK)
     {
-        D3D11_BUFFER_DESC desc{};
-        desc.ByteWidth = sizeof(ConstBuffer);
-        desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        THROW_IF_FAILED(_r.device->CreateBuffer(&desc, nullptr, _r.constantBuffer.put()));
+        shared = std::make_shared<SharedDevice>();
+        std::tie(shared->device, shared->deviceContext) = _createDevice(deviceFlags);
+        instance = shared;
     }
+    return shared;
+}
 
-    THROW_IF_FAILED(_r.device->CreateVertexShader(&shader_vs[0], sizeof(shader_vs), nullptr, _r.vertexShader.put()));
-    THROW_IF_FAILED(_r.device->CreatePixelShader(&shader_ps[0], sizeof(shader_ps), nullptr, _r.pixelShader.put()));
-
-    WI_ClearFlag(_api.invalidations, ApiInvalidations::Device);
-    WI_SetAllFlags(_api.invalidations, ApiInvalidations::SwapChain);
+// The render threads of all instances that use the SharedDevice hold this lock while they use its
+// immediate context. Since every one of them leaves its own state on the context, Present() binds
+// all of it again for each frame. If `shared` is false, the returned lock is empty.
+std::unique_lock<std::mutex> AtlasEngine::_lockSharedDevice(bool shared)
+{
+    static std::mutex mutex;
+    return shared ? std::unique_lock{ mutex } : std::unique_lock<std::mutex>{};
 }
 
 void AtlasEngine::_releaseSwapChain()
@@ -861,17 +972,8 @@ void AtlasEngine::_recreateSizeDependentResources()
         THROW_IF_FAILED(_r.device->CreateRenderTargetView(buffer.get(), nullptr, _r.renderTargetView.put()));
     }
 
-    // Tell D3D which parts of the render target will be visible.
-    // Everything outside of the viewport will be black.
-    //
-    // In the future this should cover the entire _api.sizeInPixel.x/_api.sizeInPixel.y.
-    // The pixel shader should draw the remaining content in the configured background color.
-    {
-        D3D11_VIEWPORT viewport{};
-        viewport.Width = static_cast<float>(_api.sizeInPixel.x);
-        viewport.Height = static_cast<float>(_api.sizeInPixel.y);
-        _r.deviceContext->RSSetViewports(1, &viewport);
-    }
+    // The viewport is set by _setShaderResources() below.
+    _r.sizeInPixel = _api.sizeInPixel;
 
     if (_api.cellCount != _r.cellCount)
     {
@@ -891,6 +993,7 @@ void AtlasEngine::_recreateSizeDependentResources()
         // (40x on AMD Zen1-3, which have a rep movsb performance issue. MSFT:33358259.)
         _r.cells = Buffer<Cell, 32>{ totalCellCount };
         _r.cellCount = _api.cellCount;
+        _r.dirtyCellRows = invalidatedRowsAll;
 
         // .clear() doesn't free the memory of these buffers.
         // This code allows them to shrink again.
@@ -898,24 +1001,52 @@ void AtlasEngine::_recreateSizeDependentResources()
         _api.bufferLine.reserve(projectedTextSize);
         _api.bufferLineColumn.reserve(projectedTextSize + 1);
         _api.bufferLineMetadata = Buffer<BufferLineMetadata>{ _api.cellCount.x };
-        _api.analysisResults = {};
+        _api.bufferLines = {};
+        _api.bufferLineCount = 0;
 
-        _api.clusterMap = Buffer<u16>{ projectedTextSize };
-        _api.textProps = Buffer<DWRITE_SHAPING_TEXT_PROPERTIES>{ projectedTextSize };
-        _api.glyphIndices = Buffer<u16>{ projectedGlyphSize };
-        _api.glyphProps = Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES>{ projectedGlyphSize };
-        _api.glyphAdvances = Buffer<f32>{ projectedGlyphSize };
-        _api.glyphOffsets = Buffer<DWRITE_GLYPH_OFFSET>{ projectedGlyphSize };
+        // _flushBufferLines() uses up to one set of scratch buffers per CPU core.
+        static constexpr size_t maxTextAnalysisThreads = 8;
+        _api.textAnalysisScratch.resize(std::clamp<size_t>(std::thread::hardware_concurrency(), 1, maxTextAnalysisThreads));
+        for (auto& scratch : _api.textAnalysisScratch)
+        {
+            scratch.analysisResults = {};
+            scratch.clusterMap = Buffer<u16>{ projectedTextSize };
+            scratch.textProps = Buffer<DWRITE_SHAPING_TEXT_PROPERTIES>{ projectedTextSize };
+            scratch.glyphIndices = Buffer<u16>{ projectedGlyphSize };
+            scratch.glyphProps = Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES>{ projectedGlyphSize };
+            scratch.glyphAdvances = Buffer<f32>{ projectedGlyphSize };
+            scratch.glyphOffsets = Buffer<DWRITE_GLYPH_OFFSET>{ projectedGlyphSize };
+        }
 
         D3D11_BUFFER_DESC desc;
         desc.ByteWidth = gsl::narrow<u32>(totalCellCount * sizeof(Cell)); // totalCellCount can theoretically be UINT32_MAX!
-        desc.Usage = D3D11_USAGE_DYNAMIC;
+        // Not D3D11_USAGE_DYNAMIC, because Present() only updates the rows that changed.
+        desc.Usage = D3D11_USAGE_DEFAULT;
         desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.CPUAccessFlags = 0;
         desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
         desc.StructureByteStride = sizeof(Cell);
         THROW_IF_FAILED(_r.device->CreateBuffer(&desc, nullptr, _r.cellBuffer.put()));
         THROW_IF_FAILED(_r.device->CreateShaderResourceView(_r.cellBuffer.get(), nullptr, _r.cellView.put()));
+        THROW_IF_FAILED(_r.device->CreateBuffer(&desc, nullptr, _r.cellBufferBack.put()));
+        THROW_IF_FAILED(_r.device->CreateShaderResourceView(_r.cellBufferBack.get(), nullptr, _r.cellViewBack.put()));
+        _r.cellScrollOffset = 0;
+
+        // The palette never resizes, but it's reset along with the cells referring to it.
+        if (!_r.paletteBuffer)
+        {
+            desc.ByteWidth = gsl::narrow_cast<u32>(paletteCapacity * sizeof(u32));
+            desc.StructureByteStride = sizeof(u32);
+            THROW_IF_FAILED(_r.device->CreateBuffer(&desc, nullptr, _r.paletteBuffer.put()));
+            THROW_IF_FAILED(_r.device->CreateShaderResourceView(_r.paletteBuffer.get(), nullptr, _r.paletteView.put()));
+        }
+        _resetPalette();
+
+        desc.ByteWidth = gsl::narrow_cast<u32>(_api.cellCount.y * sizeof(u32));
+        desc.StructureByteStride = sizeof(u32);
+        THROW_IF_FAILED(_r.device->CreateBuffer(&desc, nullptr, _r.selectionBuffer.put()));
+        THROW_IF_FAILED(_r.device->CreateShaderResourceView(_r.selectionBuffer.get(), nullptr, _r.selectionView.put()));
+        _r.selectionRows.assign(_api.cellCount.y, 0);
     }
 
     // We have called _r.deviceContext->ClearState() in the beginning and lost all D3D state.
@@ -923,7 +1054,7 @@ void AtlasEngine::_recreateSizeDependentResources()
     _setShaderResources();
 
     WI_ClearFlag(_api.invalidations, ApiInvalidations::Size);
-    WI_SetAllFlags(_r.invalidations, RenderInvalidations::ConstBuffer);
+    WI_SetAllFlags(_r.invalidations, RenderInvalidations::ConstBuffer | RenderInvalidations::Selection);
 }
 
 void AtlasEngine::_recreateFontDependentResources()
@@ -931,10 +1062,7 @@ void AtlasEngine::_recreateFontDependentResources()
     {
         // We're likely resizing the atlas anyways and can
         // thus also release any of these buffers prematurely.
-        _r.d2dRenderTarget.reset(); // depends on _r.atlasScratchpad
-        _r.atlasScratchpad.reset();
-        _r.atlasView.reset();
-        _r.atlasBuffer.reset();
+        _r.atlases = {};
     }
 
     // D3D
@@ -942,6 +1070,7 @@ void AtlasEngine::_recreateFontDependentResources()
         // TODO: Consider using IDXGIAdapter3::QueryVideoMemoryInfo() and IDXGIAdapter3::RegisterVideoMemoryBudgetChangeNotificationEvent()
         // That way we can make better to use of a user's available video memory.
 
+        // The color atlas, which has the most bytes per pixel, determines the limit of both.
         static constexpr size_t sizePerPixel = 4;
         static constexpr size_t sizeLimit = D3D10_REQ_RESOURCE_SIZE_IN_MEGABYTES * 1024 * 1024;
         const size_t dimensionLimit = _r.device->GetFeatureLevel() >= D3D_FEATURE_LEVEL_11_0 ? D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION : D3D10_REQ_TEXTURE2D_U_OR_V_DIMENSION;
@@ -951,7 +1080,9 @@ void AtlasEngine::_recreateFontDependentResources()
         const auto pixelsPerCellRow = xLimit * csy;
         const auto yLimitDueToDimension = (dimensionLimit / csy) * csy;
         const auto yLimitDueToSize = ((sizeLimit / sizePerPixel) / pixelsPerCellRow) * csy;
-        const auto yLimit = std::min(yLimitDueToDimension, yLimitDueToSize);
+        // Cell::tileIndex is a u16, which limits the atlas to maxAtlasTiles tiles.
+        const auto yLimitDueToTileIndex = (maxAtlasTiles / (xLimit / csx)) * csy;
+        const auto yLimit = std::min({ yLimitDueToDimension, yLimitDueToSize, yLimitDueToTileIndex });
         const auto scaling = GetScaling();
 
         _r.cellSizeDIP.x = static_cast<float>(_api.fontMetrics.cellSize.x) / scaling;
@@ -960,15 +1091,45 @@ void AtlasEngine::_recreateFontDependentResources()
         _r.cellCount = _api.cellCount;
         // x/yLimit are strictly smaller than dimensionLimit, which is smaller than a u16.
         _r.atlasSizeInPixelLimit = u16x2{ gsl::narrow_cast<u16>(xLimit), gsl::narrow_cast<u16>(yLimit) };
-        _r.atlasSizeInPixel = { 0, 0 };
-        // The first Cell at {0, 0} is always our cursor texture.
+        _r.atlasTilesPerRow = gsl::narrow_cast<u32>(xLimit / csx);
+        _r.atlases[textAtlas].format = _textAtlasFormat(_api.realizedAntialiasingMode);
+        _r.atlases[colorAtlas].format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        // The first Cell at {0, 0} of the text atlas is always our cursor texture.
         // --> The first glyph starts at {1, 0}.
-        _r.atlasPosition.x = _api.fontMetrics.cellSize.x;
-        _r.atlasPosition.y = 0;
+        _r.atlases[textAtlas].position.x = _api.fontMetrics.cellSize.x;
 
+        _api.fontFallbackCache.clear();
+        _api.shapedTextCache.clear();
         _r.glyphs = {};
         _r.glyphQueue = {};
         _r.glyphQueue.reserve(64);
+
+        // Everything that affects how _drawGlyphs() rasterizes a glyph has to be part of the signature.
+        // The gamma and contrast are left out, as they're the same system-wide settings for all engines.
+        std::wstring signature{ _api.fontMetrics.fontName.get() };
+        const auto append = [&](const auto& value) {
+            static_assert(sizeof(value) % sizeof(wchar_t) == 0);
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+            signature.append(reinterpret_cast<const wchar_t*>(&value), sizeof(value) / sizeof(wchar_t));
+        };
+        signature.push_back(L'\0');
+        append(_api.fontMetrics.fontSizeInDIP);
+        append(_api.fontMetrics.baselineInDIP);
+        append(_api.fontMetrics.cellSize);
+        append(_api.fontMetrics.fontWeight);
+        append(_api.dpi);
+        append(u16{ _api.realizedAntialiasingMode });
+        for (const auto& feature : _api.fontFeatures)
+        {
+            append(feature);
+        }
+        for (const auto& axis : _api.fontAxisValues)
+        {
+            append(axis);
+        }
+
+        _r.glyphCache = SharedGlyphCache::get(signature);
+        _r.glyphReadbackCapacity = gsl::narrow_cast<u16>(std::min<size_t>(64, xLimit / csx));
     }
     // D3D specifically for UpdateDpi()
     // This compensates for the built in scaling factor in a XAML SwapChainPanel (CompositionScaleX/Y).
@@ -1064,6 +1225,26 @@ void AtlasEngine::_recreateFontDependentResources()
         }
     }
 
+    if constexpr (glyphWarmup)
+    {
+        GlyphWarmup warmup;
+        warmup.glyphCache = _r.glyphCache;
+        warmup.dwriteFactory = _sr.dwriteFactory;
+        for (auto italic = 0; italic < 2; ++italic)
+        {
+            for (auto bold = 0; bold < 2; ++bold)
+            {
+                warmup.textFormats[italic][bold] = _r.textFormats[italic][bold];
+            }
+        }
+        warmup.typography = _r.typography;
+        warmup.cellSizeDIP = _r.cellSizeDIP;
+        warmup.cellSize = _r.cellSize;
+        warmup.dpi = _r.dpi;
+        warmup.antialiasingMode = _api.realizedAntialiasingMode;
+        _warmupGlyphCache(std::move(warmup));
+    }
+
     WI_ClearFlag(_api.invalidations, ApiInvalidations::Font);
     WI_SetAllFlags(_r.invalidations, RenderInvalidations::Cursor | RenderInvalidations::ConstBuffer);
 }
@@ -1085,65 +1266,618 @@ AtlasEngine::Cell* AtlasEngine::_getCell(u16 x, u16 y) noexcept
     return _r.cells.data() + static_cast<size_t>(_r.cellCount.x) * y + x;
 }
 
-void AtlasEngine::_setCellFlags(SMALL_RECT coords, CellFlags mask, CellFlags bits) noexcept
+void AtlasEngine::_markCellRowsDirty(u16 top, u16 bottom) noexcept
+{
+    _r.dirtyCellRows.x = std::min(_r.dirtyCellRows.x, top);
+    _r.dirtyCellRows.y = std::max(_r.dirtyCellRows.y, bottom);
+}
+
+// Text glyphs only need their coverage, which takes a single channel, unless they're drawn
+// with ClearType, which needs one for each subpixel. DXGI has no format with just 3 channels.
+DXGI_FORMAT AtlasEngine::_textAtlasFormat(u8 antialiasingMode) noexcept
+{
+    return antialiasingMode == D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE ? DXGI_FORMAT_B8G8R8A8_UNORM : DXGI_FORMAT_A8_UNORM;
+}
+
+AtlasEngine::u32 AtlasEngine::_bytesPerPixel(DXGI_FORMAT format) noexcept
+{
+    return format == DXGI_FORMAT_A8_UNORM ? 1 : 4;
+}
+
+// Returns the index of the atlas in _r.atlases that the tiles of a glyph with the given flags are in.
+size_t AtlasEngine::_atlasIndex(CellFlags flags) noexcept
+{
+    return WI_IsFlagSet(flags, CellFlags::ColoredGlyph) ? colorAtlas : textAtlas;
+}
+
+AtlasEngine::u16 AtlasEngine::_allocateAtlasTile(size_t atlasIndex) noexcept
+{
+    auto& atlas = _r.atlases[atlasIndex];
+
+    // All tiles are the size of a cell, which makes the atlas a simple grid: Until the
+    // atlas is full, tiles are allocated one after the other, like in a shelf packer.
+    // Afterwards the tiles of the glyphs that haven't been used for the longest time are recycled.
+    const auto atlasFull = atlas.position.y >= _r.atlasSizeInPixelLimit.y;
+
+    if (atlasFull && atlas.freeTiles.empty())
+    {
+        _evictAtlasTiles(atlasIndex);
+    }
+
+    if (!atlas.freeTiles.empty())
+    {
+        const auto ret = atlas.freeTiles.back();
+        atlas.freeTiles.pop_back();
+        return ret;
+    }
+
+    if (atlasFull)
+    {
+        // There are more distinct glyphs on screen than fit into the atlas.
+        showOOMWarning();
+        return 1;
+    }
+
+    const auto ret = gsl::narrow_cast<u16>(atlas.position.y / _r.cellSize.y * _r.atlasTilesPerRow + atlas.position.x / _r.cellSize.x);
+
+    atlas.position.x += _r.cellSize.x;
+    if (atlas.position.x >= _r.atlasSizeInPixelLimit.x)
+    {
+        atlas.position.x = 0;
+        atlas.position.y += _r.cellSize.y;
+    }
+
+    return ret;
+}
+
+// Returns the position of the tile in the atlas texture in pixels.
+// This is the inverse of what the shader does with Cell::tileIndex.
+AtlasEngine::u16x2 AtlasEngine::_tilePosition(u16 tile) const noexcept
 {
-    assert(coords.Left <= coords.Right);
-    assert(coords.Top <= coords.Bottom);
-    assert(coords.Right <= _r.cellCount.x);
-    assert(coords.Bottom <= _r.cellCount.y);
+    return {
+        gsl::narrow_cast<u16>(tile % _r.atlasTilesPerRow * _r.cellSize.x),
+        gsl::narrow_cast<u16>(tile / _r.atlasTilesPerRow * _r.cellSize.y),
+    };
+}
 
-    const auto filter = ~mask;
-    const auto width = static_cast<size_t>(coords.Right) - coords.Left;
-    const auto height = static_cast<size_t>(coords.Bottom) - coords.Top;
-    const auto stride = static_cast<size_t>(_r.cellCount.x);
-    auto row = _r.cells.data() + static_cast<size_t>(_r.cellCount.x) * coords.Top + coords.Left;
-    const auto end = row + height * stride;
+// Returns the index of the color in _r.palette, which Present() uploads to the GPU.
+// The cells only store these indices, which halves their size compared to storing
+// the colors directly. Almost all cells use one of a handful of colors, which is
+// why a tiny direct-mapped memo in front of the hash map catches most lookups.
+AtlasEngine::u16 AtlasEngine::_paletteIndex(u32 color)
+{
+    auto& memo = _r.paletteMemo[(color * 0x9E3779B1u) >> 26];
+    if (_r.palette[memo] == color)
+    {
+        return memo;
+    }
 
-    for (; row != end; row += stride)
+    const auto [it, inserted] = _r.paletteIndices.emplace(color, gsl::narrow_cast<u16>(_r.palette.size()));
+    if (inserted)
     {
-        const auto dataEnd = row + width;
-        for (auto data = row; data != dataEnd; ++data)
+        if (_r.palette.size() >= paletteCapacity)
         {
-            const auto current = data->flags;
-            data->flags = (current & filter) | bits;
+            // StartPaint() resets the palette long before this happens,
+            // unless a single frame uses more colors than that.
+            _r.paletteIndices.erase(it);
+            return 0;
         }
+        _r.palette.emplace_back(color);
     }
+
+    memo = it->second;
+    return it->second;
 }
 
-AtlasEngine::u16x2 AtlasEngine::_allocateAtlasTile() noexcept
+// Forgets all colors in the palette. All cells refer to invalid colors afterwards
+// and the caller needs to ensure that all of them get repainted.
+void AtlasEngine::_resetPalette() noexcept
 {
-    const auto ret = _r.atlasPosition;
+    _r.palette.clear();
+    _r.paletteIndices.clear();
+    // This keeps palette[memo] valid for all entries of paletteMemo.
+    // The color is never looked up, as it's transparent and the memo starts out as 0.
+    _r.palette.emplace_back(0);
+    _r.paletteIndices.emplace(0, u16{ 0 });
+    _r.paletteMemo = {};
+    _r.paletteUploaded = 0;
+}
 
-    _r.atlasPosition.x += _r.cellSize.x;
-    if (_r.atlasPosition.x >= _r.atlasSizeInPixelLimit.x)
+// Frees up a quarter of the atlas, once it has reached its maximum size, by removing the
+// glyphs that were painted the longest time ago. Their tiles are then reused in place by
+// _allocateAtlasTile(). Glyphs that are still on screen are kept, even if they're old,
+// as rows that aren't repainted still refer to them. So are the ones of the current frame.
+void AtlasEngine::_evictAtlasTiles(size_t atlasIndex) noexcept
+try
+{
+    auto& atlas = _r.atlases[atlasIndex];
+    const size_t tileCount = _r.atlasTilesPerRow * (_r.atlasSizeInPixelLimit.y / _r.cellSize.y);
+
+    std::vector<bool> visible(tileCount);
+    for (size_t i = 0; i < _r.cells.size(); ++i)
     {
-        _r.atlasPosition.x = 0;
-        _r.atlasPosition.y += _r.cellSize.y;
-        if (_r.atlasPosition.y >= _r.atlasSizeInPixelLimit.y)
+        const auto& cell = _r.cells[i];
+        if (_atlasIndex(cell.flags) == atlasIndex)
         {
-            _r.atlasPosition.x = _r.cellSize.x;
-            _r.atlasPosition.y = 0;
-            showOOMWarning();
+            visible[cell.tileIndex] = true;
         }
     }
 
-    return ret;
+    // _processGlyphQueue() might not have gotten to all of the glyphs of the previous frames yet.
+    std::unordered_set<const AtlasValue*> queued;
+    for (const auto& item : _r.glyphQueue)
+    {
+        queued.emplace(item.value);
+    }
+
+    std::vector<decltype(_r.glyphs)::iterator> candidates;
+    for (auto it = _r.glyphs.begin(); it != _r.glyphs.end(); ++it)
+    {
+        // Glyphs without a glyph don't own any tiles.
+        const auto flags = it->second.data()->flags;
+        if (it->second.lastUsed == _r.glyphGeneration || queued.count(&it->second) || WI_IsFlagSet(flags, CellFlags::NoGlyph) || _atlasIndex(flags) != atlasIndex)
+        {
+            continue;
+        }
+
+        const auto tiles = &it->second.data()->tiles[0];
+        const auto cellCount = it->first.data()->attributes.cellCount;
+        if (std::none_of(tiles, tiles + cellCount, [&](const u16 tile) { return visible[tile]; }))
+        {
+            candidates.emplace_back(it);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs->second.lastUsed < rhs->second.lastUsed;
+    });
+
+    const auto target = tileCount / 4;
+    for (const auto& it : candidates)
+    {
+        if (atlas.freeTiles.size() >= target)
+        {
+            break;
+        }
+
+        const auto tiles = &it->second.data()->tiles[0];
+        atlas.freeTiles.insert(atlas.freeTiles.end(), tiles, tiles + it->first.data()->attributes.cellCount);
+        _r.glyphs.erase(it);
+    }
+
+    // The pending readbacks might refer to glyphs we just removed.
+    atlas.glyphReadbackQueue.clear();
+    atlas.glyphReadbackUsed = 0;
+}
+CATCH_LOG()
+
+// Returns the position in line.text where the cell after the one at pos starts.
+// All characters of a cell, like a character and its combining marks, share the same column.
+AtlasEngine::u32 AtlasEngine::_nextBufferLineCell(const BufferLine& line, u32 pos) noexcept
+{
+    const auto size = gsl::narrow_cast<u32>(line.text.size());
+    const auto column = line.columns[pos];
+    for (++pos; pos < size && line.columns[pos] == column; ++pos)
+    {
+    }
+    return pos;
+}
+
+const std::wstring& AtlasEngine::_fontFallbackKey(const BufferLine& line, TextAnalysisScratch& scratch, u32 pos1, u32 pos2)
+{
+    // The fallback depends on the weight and style (and with them on the font axes).
+    auto& key = scratch.fontFallbackKey;
+    key.assign(1, static_cast<wchar_t>(line.attributes.bold | line.attributes.italic << 1));
+    key.append(line.text.data() + pos1, pos2 - pos1);
+    return key;
+}
+
+const std::wstring& AtlasEngine::_shapedTextKey(const BufferLine& line, TextAnalysisScratch& scratch, IDWriteFontFace* fontFace, const TextAnalyzerResult& analysis)
+{
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    const auto address = reinterpret_cast<uintptr_t>(fontFace);
+    auto& key = scratch.shapedTextKey;
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    key.assign(reinterpret_cast<const wchar_t*>(&address), sizeof(address) / sizeof(wchar_t));
+    key.push_back(static_cast<wchar_t>(analysis.script));
+    key.push_back(static_cast<wchar_t>(analysis.shapes | analysis.bidiLevel << 8));
+    key.append(line.text.data() + analysis.textPosition, analysis.textLength);
+    return key;
+}
+
+// IDWriteFontFallback::MapCharacters() is far too slow to call for every line we paint.
+// Its results are thus cached for every cell, which is the unit the text buffer stores text in anyways.
+// This returns the end of the longest run of cells starting at idx that were all mapped
+// to the same font face before (which is returned in mappedFontFace), or idx otherwise.
+AtlasEngine::u32 AtlasEngine::_mapCharactersFromCache(const BufferLine& line, TextAnalysisScratch& scratch, u32 idx, wil::com_ptr<IDWriteFontFace>& mappedFontFace) const
+{
+    if (idx != 0 && line.columns[idx] == line.columns[idx - 1])
+    {
+        return idx;
+    }
+
+    const auto size = gsl::narrow_cast<u32>(line.text.size());
+    auto end = idx;
+
+    while (end < size)
+    {
+        const auto cellEnd = _nextBufferLineCell(line, end);
+        const auto it = _api.fontFallbackCache.find(_fontFallbackKey(line, scratch, end, cellEnd));
+        if (it == _api.fontFallbackCache.end() || (end != idx && it->second != mappedFontFace))
+        {
+            break;
+        }
+        if (end == idx)
+        {
+            mappedFontFace = it->second;
+        }
+        end = cellEnd;
+    }
+
+    return end;
+}
+
+// The entries are only added to the cache by _flushBufferLines(), as other threads might be reading it.
+void AtlasEngine::_cacheMappedCharacters(const BufferLine& line, TextAnalysisScratch& scratch, u32 idx, u32 end, const wil::com_ptr<IDWriteFontFace>& mappedFontFace)
+{
+    // Only whole cells are cached, as their mapping could depend on the characters around them otherwise.
+    auto pos = idx;
+    if (pos != 0 && line.columns[pos] == line.columns[pos - 1])
+    {
+        pos = _nextBufferLineCell(line, pos);
+    }
+
+    while (pos < end)
+    {
+        const auto cellEnd = _nextBufferLineCell(line, pos);
+        if (cellEnd > end)
+        {
+            break;
+        }
+        scratch.newFontFallbacks.emplace_back(_fontFallbackKey(line, scratch, pos, cellEnd), mappedFontFace);
+        pos = cellEnd;
+    }
+}
+
+std::shared_ptr<AtlasEngine::SharedGlyphCache> AtlasEngine::SharedGlyphCache::get(const std::wstring& signature)
+{
+    // The caches are only kept alive by the engines that use them.
+    static std::mutex mutex;
+    static std::unordered_map<std::wstring, std::weak_ptr<SharedGlyphCache>> caches;
+
+    const std::lock_guard guard{ mutex };
+
+    for (auto it = caches.begin(); it != caches.end();)
+    {
+        it = it->second.expired() ? caches.erase(it) : std::next(it);
+    }
+
+    auto& weak = caches[signature];
+    auto cache = weak.lock();
+    if (!cache)
+    {
+        cache = std::make_shared<SharedGlyphCache>();
+        cache->_signature = signature;
+        weak = cache;
+    }
+    return cache;
+}
+
+gsl::span<const AtlasEngine::u8> AtlasEngine::SharedGlyphCache::find(const AtlasKey& key) const
+{
+    // Elements are never removed and unordered_map never moves them,
+    // which is why the returned pixels stay valid without holding the lock.
+    const std::shared_lock guard{ _mutex };
+    const auto it = _glyphs.find(key);
+    return it != _glyphs.end() ? gsl::span<const u8>{ it->second.data(), it->second.size() } : gsl::span<const u8>{};
+}
+
+void AtlasEngine::SharedGlyphCache::insert(const AtlasKey& key, Buffer<u8>&& pixels)
+{
+    const std::unique_lock guard{ _mutex };
+    if (_glyphs.size() < maxGlyphs)
+    {
+        _glyphs.emplace(key, std::move(pixels));
+    }
 }
 
-void AtlasEngine::_flushBufferLine()
+// Adds the glyphs of a file written by save() to the cache, unless they're already in it.
+// Returns false if the file doesn't exist, belongs to a different fileKey or is damaged,
+// in which case the cache is left untouched. The pixels of each glyph are taken as they are:
+// _drawGlyphs() checks their size before it uploads them.
+bool AtlasEngine::SharedGlyphCache::load(const std::filesystem::path& path, const std::wstring& fileKey)
+{
+    wil::unique_hfile file{ CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    if (!file)
+    {
+        const auto error = GetLastError();
+        if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND)
+        {
+            return false;
+        }
+        THROW_WIN32(error);
+    }
+
+    // maxGlyphs glyphs of far larger cells than anyone uses still fit into this.
+    static constexpr LONGLONG maxFileSize = 64 * 1024 * 1024;
+    LARGE_INTEGER fileSize{};
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+    if (fileSize.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader)) || fileSize.QuadPart > maxFileSize)
+    {
+        return false;
+    }
+
+    Buffer<u8> data{ static_cast<size_t>(fileSize.QuadPart) };
+    DWORD read = 0;
+    THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), data.data(), gsl::narrow_cast<DWORD>(data.size()), &read, nullptr));
+    file.reset();
+
+    gsl::span<const u8> remaining{ data.data(), read };
+    const auto take = [&](size_t size) noexcept -> const u8* {
+        if (size > remaining.size())
+        {
+            return nullptr;
+        }
+        const auto ptr = remaining.data();
+        remaining = remaining.subspan(size);
+        return ptr;
+    };
+
+    FileHeader header{};
+    if (const auto ptr = take(sizeof(header)))
+    {
+        memcpy(&header, ptr, sizeof(header));
+    }
+    if (header.magic != fileMagic || header.version != fileVersion || header.keyLength != fileKey.size() || header.glyphCount > maxGlyphs)
+    {
+        return false;
+    }
+
+    const auto keySize = fileKey.size() * sizeof(wchar_t);
+    const auto key = take(keySize);
+    if (!key || memcmp(key, fileKey.data(), keySize) != 0)
+    {
+        return false;
+    }
+
+    std::vector<std::pair<AtlasKey, Buffer<u8>>> glyphs;
+    glyphs.reserve(header.glyphCount);
+
+    for (u32 i = 0; i < header.glyphCount; ++i)
+    {
+        FileGlyph glyph{};
+        const auto ptr = take(sizeof(glyph));
+        if (!ptr)
+        {
+            return false;
+        }
+        memcpy(&glyph, ptr, sizeof(glyph));
+
+        // The pixels are padded to an even size, which keeps the characters of the next glyph aligned.
+        // The pixel count is checked before it's rounded up, which could overflow with a 32-bit size_t.
+        const auto chars = take(static_cast<size_t>(glyph.charCount) * sizeof(wchar_t));
+        const auto pixels = glyph.pixelCount <= remaining.size() ? take((static_cast<size_t>(glyph.pixelCount) + 1) & ~size_t{ 1 }) : nullptr;
+        if (!chars || !pixels || !glyph.charCount || !glyph.attributes.cellCount)
+        {
+            return false;
+        }
+
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+        glyphs.emplace_back(AtlasKey{ glyph.attributes, glyph.charCount, reinterpret_cast<const wchar_t*>(chars) }, Buffer<u8>{ pixels, glyph.pixelCount });
+    }
+
+    const std::unique_lock guard{ _mutex };
+    for (auto& [glyphKey, pixels] : glyphs)
+    {
+        if (_glyphs.size() >= maxGlyphs)
+        {
+            break;
+        }
+        _glyphs.emplace(std::move(glyphKey), std::move(pixels));
+    }
+    return true;
+}
+
+// Writes all glyphs of the cache into the given file for load().
+// The file is written under a temporary name first and then moved into place,
+// so that another process that calls load() at the same time never sees half of it.
+void AtlasEngine::SharedGlyphCache::save(const std::filesystem::path& path, const std::wstring& fileKey) const
+{
+    std::string data;
+    const auto write = [&](const void* ptr, size_t size) {
+        data.append(static_cast<const char*>(ptr), size);
+    };
+
+    {
+        const std::shared_lock guard{ _mutex };
+
+        const FileHeader header{ fileMagic, fileVersion, gsl::narrow<u32>(fileKey.size()), gsl::narrow<u32>(_glyphs.size()) };
+        write(&header, sizeof(header));
+        write(fileKey.data(), fileKey.size() * sizeof(wchar_t));
+
+        for (const auto& [key, pixels] : _glyphs)
+        {
+            const auto k = key.data();
+            auto attributes = k->attributes;
+            attributes.inlined = 0;
+            const FileGlyph glyph{ attributes, k->charCount, gsl::narrow<u32>(pixels.size()) };
+            write(&glyph, sizeof(glyph));
+            write(&k->chars[0], static_cast<size_t>(k->charCount) * sizeof(wchar_t));
+            write(pixels.data(), pixels.size());
+            if (pixels.size() & 1)
+            {
+                data.push_back('\0');
+            }
+        }
+    }
+
+    auto tempPath = path;
+    tempPath += L"." + std::to_wstring(GetCurrentProcessId()) + L".tmp";
+
+    wil::unique_hfile file{ CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+    auto cleanup = wil::scope_exit([&]() noexcept {
+        DeleteFileW(tempPath.c_str());
+    });
+
+    DWORD written = 0;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(file.get(), data.data(), gsl::narrow<DWORD>(data.size()), &written, nullptr));
+    file.reset();
+
+    THROW_IF_WIN32_BOOL_FALSE(MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING));
+    cleanup.release();
+}
+
+// Hands the line assembled by PaintBufferLine() over to _flushBufferLines().
+void AtlasEngine::_queueBufferLine()
 {
     if (_api.bufferLine.empty())
     {
         return;
     }
 
+    // This would seriously blow us up otherwise.
+    Expects(_api.bufferLineColumn.size() == _api.bufferLine.size() + 1);
+
+    if (_api.bufferLineCount == _api.bufferLines.size())
+    {
+        _api.bufferLines.emplace_back();
+    }
+
+    auto& line = _api.bufferLines[_api.bufferLineCount];
+
+    // Swapping the vectors keeps their memory around for the lines to come.
+    line.text.swap(_api.bufferLine);
+    line.columns.swap(_api.bufferLineColumn);
+    _api.bufferLine.clear();
+    _api.bufferLineColumn.clear();
+
+    // bufferLineMetadata is reused by the next row, which is why we need a copy of it.
+    const auto x1 = line.columns.front();
+    const auto x2 = line.columns.back();
+    Expects(x1 <= x2 && x2 <= _api.bufferLineMetadata.size());
+    line.metadata.assign(_api.bufferLineMetadata.data() + x1, _api.bufferLineMetadata.data() + x2);
+    line.attributes = _api.attributes;
+    line.row = _api.lastPaintBufferLineCoord.y;
+
+    _api.bufferLineCount++;
+}
+
+// Segments the lines queued up by _queueBufferLine() into glyphs.
+// This is the most expensive part of painting a frame by far. As the lines are independent of
+// each other, larger frames are analyzed by the thread pool, while this thread merges the results.
+void AtlasEngine::_flushBufferLines()
+{
+    _queueBufferLine();
+
+    const auto count = _api.bufferLineCount;
+    if (!count)
+    {
+        return;
+    }
+
     const auto cleanup = wil::scope_exit([this]() noexcept {
-        _api.bufferLine.clear();
-        _api.bufferLineColumn.clear();
+        _api.bufferLineCount = 0;
     });
 
-    // This would seriously blow us up otherwise.
-    Expects(_api.bufferLineColumn.size() == _api.bufferLine.size() + 1);
+    // Waking up a thread for just a few lines costs more than it saves.
+    static constexpr size_t minLinesPerThread = 8;
+    const auto threads = std::clamp<size_t>(count / minLinesPerThread, 1, _api.textAnalysisScratch.size());
+
+    _api.bufferLineAnalysisNext.store(0, std::memory_order_relaxed);
+    _api.textAnalysisScratchNext.store(0, std::memory_order_relaxed);
+    _api.bufferLineAnalysisResult.store(S_OK, std::memory_order_relaxed);
+
+    // SubmitThreadpoolWork() is a release barrier for the stores above.
+    for (size_t i = 1; i < threads; ++i)
+    {
+        SubmitThreadpoolWork(_sr.textAnalysisWork.get());
+    }
+    _analyzeBufferLines();
+    if (threads > 1)
+    {
+        WaitForThreadpoolWorkCallbacks(_sr.textAnalysisWork.get(), FALSE);
+    }
+
+    // Only this thread may modify the caches, as the other ones are done now.
+    for (auto& scratch : _api.textAnalysisScratch)
+    {
+        // Text that's full of different characters or runs shouldn't grow the caches endlessly.
+        static constexpr size_t maxFontFallbackCacheSize = 4096;
+        static constexpr size_t maxShapedTextCacheSize = 1024;
+
+        for (auto& [key, fontFace] : scratch.newFontFallbacks)
+        {
+            if (_api.fontFallbackCache.size() >= maxFontFallbackCacheSize)
+            {
+                _api.fontFallbackCache.clear();
+            }
+            _api.fontFallbackCache.emplace(std::move(key), std::move(fontFace));
+        }
+        for (auto& [key, shapedText] : scratch.newShapedTexts)
+        {
+            if (_api.shapedTextCache.size() >= maxShapedTextCacheSize)
+            {
+                _api.shapedTextCache.clear();
+            }
+            _api.shapedTextCache.emplace(std::move(key), std::move(shapedText));
+        }
+
+        scratch.newFontFallbacks.clear();
+        scratch.newShapedTexts.clear();
+    }
+
+    THROW_IF_FAILED(_api.bufferLineAnalysisResult.load(std::memory_order_relaxed));
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& line = _api.bufferLines[i];
+        for (const auto& run : line.glyphRuns)
+        {
+            _emplaceGlyph(line, run.fontFace, run.pos1, run.pos2);
+        }
+        line.glyphRuns.clear();
+        line.fontFaces.clear();
+    }
+}
+
+void CALLBACK AtlasEngine::_analyzeBufferLinesCallback(PTP_CALLBACK_INSTANCE instance, void* context, PTP_WORK work) noexcept
+{
+    static_cast<AtlasEngine*>(context)->_analyzeBufferLines();
+}
+
+// Analyzes queued up lines until there are none left. This runs on the render
+// thread and the thread pool at the same time, which is why it may only read
+// from _api, apart from the lines it analyzes and its own scratch buffers.
+void AtlasEngine::_analyzeBufferLines() noexcept
+{
+    auto& scratch = _api.textAnalysisScratch[_api.textAnalysisScratchNext.fetch_add(1, std::memory_order_relaxed)];
+
+    for (;;)
+    {
+        const auto idx = _api.bufferLineAnalysisNext.fetch_add(1, std::memory_order_relaxed);
+        if (idx >= _api.bufferLineCount || FAILED(_api.bufferLineAnalysisResult.load(std::memory_order_relaxed)))
+        {
+            break;
+        }
+
+        try
+        {
+            _analyzeBufferLine(_api.bufferLines[idx], scratch);
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            _api.bufferLineAnalysisResult.store(wil::ResultFromCaughtException(), std::memory_order_relaxed);
+        }
+    }
+}
+
+// Fills line.glyphRuns with the glyphs the text of the line consists of.
+void AtlasEngine::_analyzeBufferLine(BufferLine& line, TextAnalysisScratch& scratch) const
+{
+    line.glyphRuns.clear();
+    line.fontFaces.clear();
 
     // NOTE:
     // This entire function is one huge hack to see if it works.
@@ -1152,7 +1886,7 @@ void AtlasEngine::_flushBufferLine()
     //
     // # What do we want?
     //
-    // Segment a line of text (_api.bufferLine) into unicode "clusters".
+    // Segment a line of text (line.text) into unicode "clusters".
     // Each cluster is one "whole" glyph with diacritics, ligatures, zero width joiners
     // and whatever else, that should be cached as a whole in our texture atlas.
     //
@@ -1178,10 +1912,10 @@ void AtlasEngine::_flushBufferLine()
     //
     // Font fallback with IDWriteFontFallback::MapCharacters is very slow.
 
-    const auto textFormat = _getTextFormat(_api.attributes.bold, _api.attributes.italic);
-    const auto& textFormatAxis = _getTextFormatAxis(_api.attributes.bold, _api.attributes.italic);
+    const auto textFormat = _getTextFormat(line.attributes.bold, line.attributes.italic);
+    const auto& textFormatAxis = _getTextFormatAxis(line.attributes.bold, line.attributes.italic);
 
-    TextAnalyzer atlasAnalyzer{ _api.bufferLine, _api.analysisResults };
+    TextAnalyzer atlasAnalyzer{ line.text, scratch.analysisResults };
 
     wil::com_ptr<IDWriteFontCollection> fontCollection;
     THROW_IF_FAILED(textFormat->GetFontCollection(fontCollection.addressof()));
@@ -1189,75 +1923,80 @@ void AtlasEngine::_flushBufferLine()
     wil::com_ptr<IDWriteFontFace> mappedFontFace;
 
 #pragma warning(suppress : 26494) // Variable 'mappedEnd' is uninitialized. Always initialize an object (type.5).
-    for (u32 idx = 0, mappedEnd; idx < _api.bufferLine.size(); idx = mappedEnd)
+    for (u32 idx = 0, mappedEnd; idx < line.text.size(); idx = mappedEnd)
     {
         if (_sr.systemFontFallback)
         {
-            float scale = 1.0f;
-            u32 mappedLength = 0;
-
-            if (textFormatAxis)
+            mappedEnd = _mapCharactersFromCache(line, scratch, idx, mappedFontFace);
+            if (mappedEnd == idx)
             {
-                wil::com_ptr<IDWriteFontFace5> fontFace5;
-                THROW_IF_FAILED(_sr.systemFontFallback.query<IDWriteFontFallback1>()->MapCharacters(
-                    /* analysisSource */ &atlasAnalyzer,
-                    /* textPosition */ idx,
-                    /* textLength */ gsl::narrow_cast<u32>(_api.bufferLine.size()) - idx,
-                    /* baseFontCollection */ fontCollection.get(),
-                    /* baseFamilyName */ _api.fontMetrics.fontName.get(),
-                    /* fontAxisValues */ textFormatAxis.data(),
-                    /* fontAxisValueCount */ gsl::narrow_cast<u32>(textFormatAxis.size()),
-                    /* mappedLength */ &mappedLength,
-                    /* scale */ &scale,
-                    /* mappedFontFace */ fontFace5.put()));
-                mappedFontFace = std::move(fontFace5);
-            }
-            else
-            {
-                const auto baseWeight = _api.attributes.bold ? DWRITE_FONT_WEIGHT_BOLD : static_cast<DWRITE_FONT_WEIGHT>(_api.fontMetrics.fontWeight);
-                const auto baseStyle = _api.attributes.italic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
-                wil::com_ptr<IDWriteFont> font;
+                float scale = 1.0f;
+                u32 mappedLength = 0;
 
-                THROW_IF_FAILED(_sr.systemFontFallback->MapCharacters(
-                    /* analysisSource     */ &atlasAnalyzer,
-                    /* textPosition       */ idx,
-                    /* textLength         */ gsl::narrow_cast<u32>(_api.bufferLine.size()) - idx,
-                    /* baseFontCollection */ fontCollection.get(),
-                    /* baseFamilyName     */ _api.fontMetrics.fontName.get(),
-                    /* baseWeight         */ baseWeight,
-                    /* baseStyle          */ baseStyle,
-                    /* baseStretch        */ DWRITE_FONT_STRETCH_NORMAL,
-                    /* mappedLength       */ &mappedLength,
-                    /* mappedFont         */ font.addressof(),
-                    /* scale              */ &scale));
-
-                mappedFontFace.reset();
-                if (font)
+                if (textFormatAxis)
                 {
-                    THROW_IF_FAILED(font->CreateFontFace(mappedFontFace.addressof()));
+                    wil::com_ptr<IDWriteFontFace5> fontFace5;
+                    THROW_IF_FAILED(_sr.systemFontFallback.query<IDWriteFontFallback1>()->MapCharacters(
+                        /* analysisSource */ &atlasAnalyzer,
+                        /* textPosition */ idx,
+                        /* textLength */ gsl::narrow_cast<u32>(line.text.size()) - idx,
+                        /* baseFontCollection */ fontCollection.get(),
+                        /* baseFamilyName */ _api.fontMetrics.fontName.get(),
+                        /* fontAxisValues */ textFormatAxis.data(),
+                        /* fontAxisValueCount */ gsl::narrow_cast<u32>(textFormatAxis.size()),
+                        /* mappedLength */ &mappedLength,
+                        /* scale */ &scale,
+                        /* mappedFontFace */ fontFace5.put()));
+                    mappedFontFace = std::move(fontFace5);
+                }
+                else
+                {
+                    const auto baseWeight = line.attributes.bold ? DWRITE_FONT_WEIGHT_BOLD : static_cast<DWRITE_FONT_WEIGHT>(_api.fontMetrics.fontWeight);
+                    const auto baseStyle = line.attributes.italic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
+                    wil::com_ptr<IDWriteFont> font;
+
+                    THROW_IF_FAILED(_sr.systemFontFallback->MapCharacters(
+                        /* analysisSource     */ &atlasAnalyzer,
+                        /* textPosition       */ idx,
+                        /* textLength         */ gsl::narrow_cast<u32>(line.text.size()) - idx,
+                        /* baseFontCollection */ fontCollection.get(),
+                        /* baseFamilyName     */ _api.fontMetrics.fontName.get(),
+                        /* baseWeight         */ baseWeight,
+                        /* baseStyle          */ baseStyle,
+                        /* baseStretch        */ DWRITE_FONT_STRETCH_NORMAL,
+                        /* mappedLength       */ &mappedLength,
+                        /* mappedFont         */ font.addressof(),
+                        /* scale              */ &scale));
+
+                    mappedFontFace.reset();
+                    if (font)
+                    {
+                        THROW_IF_FAILED(font->CreateFontFace(mappedFontFace.addressof()));
+                    }
                 }
-            }
 
-            mappedEnd = idx + mappedLength;
+                mappedEnd = idx + mappedLength;
+                _cacheMappedCharacters(line, scratch, idx, mappedEnd, mappedFontFace);
+            }
 
             if (!mappedFontFace)
             {
                 // Task: Replace all characters in this range with unicode replacement characters.
                 // Input (where "n" is a narrow and "ww" is a wide character):
-                //    _api.bufferLine       = "nwwnnw"
-                //    _api.bufferLineColumn = {0, 1, 1, 2, 3, 4, 4, 5}
-                //                             n  w  w  n  n  w  w
+                //    line.text    = "nwwnnw"
+                //    line.columns = {0, 1, 1, 2, 3, 4, 4, 5}
+                //                    n  w  w  n  n  w  w
                 // Solution:
-                //   Iterate through bufferLineColumn until the value changes, because this indicates we passed over a
+                //   Iterate through line.columns until the value changes, because this indicates we passed over a
                 //   complete (narrow or wide) cell. To do so we'll use col1 (previous column) and col2 (next column).
-                //   Then we emit a replacement character by telling _emplaceGlyph that this range has no font face.
+                //   Then we emit a replacement character by giving this range no font face.
                 auto pos1 = idx;
-                auto col1 = _api.bufferLineColumn[pos1];
+                auto col1 = line.columns[pos1];
                 for (auto pos2 = idx + 1; pos2 <= mappedEnd; ++pos2)
                 {
-                    if (const auto col2 = _api.bufferLineColumn[pos2]; col1 != col2)
+                    if (const auto col2 = line.columns[pos2]; col1 != col2)
                     {
-                        _emplaceGlyph(nullptr, pos1, pos2);
+                        line.glyphRuns.emplace_back(GlyphRun{ nullptr, pos1, pos2 });
                         pos1 = pos2;
                         col1 = col2;
                     }
@@ -1270,8 +2009,8 @@ void AtlasEngine::_flushBufferLine()
         {
             if (!mappedFontFace)
             {
-                const auto baseWeight = _api.attributes.bold ? DWRITE_FONT_WEIGHT_BOLD : static_cast<DWRITE_FONT_WEIGHT>(_api.fontMetrics.fontWeight);
-                const auto baseStyle = _api.attributes.italic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
+                const auto baseWeight = line.attributes.bold ? DWRITE_FONT_WEIGHT_BOLD : static_cast<DWRITE_FONT_WEIGHT>(_api.fontMetrics.fontWeight);
+                const auto baseStyle = line.attributes.italic ? DWRITE_FONT_STYLE_ITALIC : DWRITE_FONT_STYLE_NORMAL;
 
                 wil::com_ptr<IDWriteFontFamily> fontFamily;
                 THROW_IF_FAILED(fontCollection->GetFontFamily(0, fontFamily.addressof()));
@@ -1282,30 +2021,50 @@ void AtlasEngine::_flushBufferLine()
                 THROW_IF_FAILED(font->CreateFontFace(mappedFontFace.put()));
             }
 
-            mappedEnd = gsl::narrow_cast<u32>(_api.bufferLine.size());
+            mappedEnd = gsl::narrow_cast<u32>(line.text.size());
+        }
+
+        // The caches might drop the font face before _flushBufferLines() gets to the glyph runs.
+        if (line.fontFaces.empty() || line.fontFaces.back() != mappedFontFace)
+        {
+            line.fontFaces.emplace_back(mappedFontFace);
         }
 
         // We can reuse idx here, as it'll be reset to "idx = mappedEnd" in the outer loop anyways.
         for (u32 complexityLength = 0; idx < mappedEnd; idx += complexityLength)
         {
             BOOL isTextSimple;
-            THROW_IF_FAILED(_sr.textAnalyzer->GetTextComplexity(_api.bufferLine.data() + idx, mappedEnd - idx, mappedFontFace.get(), &isTextSimple, &complexityLength, _api.glyphIndices.data()));
+            THROW_IF_FAILED(_sr.textAnalyzer->GetTextComplexity(line.text.data() + idx, mappedEnd - idx, mappedFontFace.get(), &isTextSimple, &complexityLength, scratch.glyphIndices.data()));
 
             if (isTextSimple)
             {
-                for (size_t i = 0; i < complexityLength; ++i)
+                for (u32 i = 0; i < complexityLength; ++i)
                 {
-                    _emplaceGlyph(mappedFontFace.get(), idx + i, idx + i + 1u);
+                    line.glyphRuns.emplace_back(GlyphRun{ mappedFontFace.get(), idx + i, idx + i + 1 });
                 }
             }
             else
             {
-                _api.analysisResults.clear();
+                scratch.analysisResults.clear();
                 THROW_IF_FAILED(_sr.textAnalyzer->AnalyzeScript(&atlasAnalyzer, idx, complexityLength, &atlasAnalyzer));
                 //_sr.textAnalyzer->AnalyzeBidi(&atlasAnalyzer, idx, complexityLength, &atlasAnalyzer);
 
-                for (const auto& a : _api.analysisResults)
+                for (const auto& a : scratch.analysisResults)
                 {
+                    // Prompts, status lines and the like repeat the same runs of text all the time.
+                    // As we only need the cluster boundaries, we can skip shaping those entirely.
+                    const auto& shapedTextKey = _shapedTextKey(line, scratch, mappedFontFace.get(), a);
+                    if (const auto it = _api.shapedTextCache.find(shapedTextKey); it != _api.shapedTextCache.end())
+                    {
+                        u32 beg = 0;
+                        for (const auto end : it->second.clusterEnds)
+                        {
+                            line.glyphRuns.emplace_back(GlyphRun{ mappedFontFace.get(), a.textPosition + beg, a.textPosition + end });
+                            beg = end;
+                        }
+                        continue;
+                    }
+
                     DWRITE_SCRIPT_ANALYSIS scriptAnalysis{ a.script, static_cast<DWRITE_SCRIPT_SHAPES>(a.shapes) };
                     u32 actualGlyphCount = 0;
 
@@ -1329,16 +2088,16 @@ void AtlasEngine::_flushBufferLine()
                         featureRanges = 1;
                     }
 
-                    if (_api.clusterMap.size() < a.textLength)
+                    if (scratch.clusterMap.size() < a.textLength)
                     {
-                        _api.clusterMap = Buffer<u16>{ a.textLength };
-                        _api.textProps = Buffer<DWRITE_SHAPING_TEXT_PROPERTIES>{ a.textLength };
+                        scratch.clusterMap = Buffer<u16>{ a.textLength };
+                        scratch.textProps = Buffer<DWRITE_SHAPING_TEXT_PROPERTIES>{ a.textLength };
                     }
 
                     for (auto retry = 0;;)
                     {
                         const auto hr = _sr.textAnalyzer->GetGlyphs(
-                            /* textString          */ _api.bufferLine.data() + a.textPosition,
+                            /* textString          */ line.text.data() + a.textPosition,
                             /* textLength          */ a.textLength,
                             /* fontFace            */ mappedFontFace.get(),
                             /* isSideways          */ false,
@@ -1349,22 +2108,22 @@ void AtlasEngine::_flushBufferLine()
                             /* features            */ &features,
                             /* featureRangeLengths */ &featureRangeLengths,
                             /* featureRanges       */ featureRanges,
-                            /* maxGlyphCount       */ gsl::narrow_cast<u32>(_api.glyphProps.size()),
-                            /* clusterMap          */ _api.clusterMap.data(),
-                            /* textProps           */ _api.textProps.data(),
-                            /* glyphIndices        */ _api.glyphIndices.data(),
-                            /* glyphProps          */ _api.glyphProps.data(),
+                            /* maxGlyphCount       */ gsl::narrow_cast<u32>(scratch.glyphProps.size()),
+                            /* clusterMap          */ scratch.clusterMap.data(),
+                            /* textProps           */ scratch.textProps.data(),
+                            /* glyphIndices        */ scratch.glyphIndices.data(),
+                            /* glyphProps          */ scratch.glyphProps.data(),
                             /* actualGlyphCount    */ &actualGlyphCount);
 
                         if (hr == HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER) && ++retry < 8)
                         {
                             // Grow factor 1.5x.
-                            auto size = _api.glyphProps.size();
+                            auto size = scratch.glyphProps.size();
                             size = size + (size >> 1);
                             // Overflow check.
-                            Expects(size > _api.glyphProps.size());
-                            _api.glyphIndices = Buffer<u16>{ size };
-                            _api.glyphProps = Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES>(size);
+                            Expects(size > scratch.glyphProps.size());
+                            scratch.glyphIndices = Buffer<u16>{ size };
+                            scratch.glyphProps = Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES>(size);
                             continue;
                         }
 
@@ -1372,24 +2131,24 @@ void AtlasEngine::_flushBufferLine()
                         break;
                     }
 
-                    if (_api.glyphAdvances.size() < actualGlyphCount)
+                    if (scratch.glyphAdvances.size() < actualGlyphCount)
                     {
                         // Grow the buffer by at least 1.5x and at least of `actualGlyphCount` items.
                         // The 1.5x growth ensures we don't reallocate every time we need 1 more slot.
-                        auto size = _api.glyphAdvances.size();
+                        auto size = scratch.glyphAdvances.size();
                         size = size + (size >> 1);
                         size = std::max<size_t>(size, actualGlyphCount);
-                        _api.glyphAdvances = Buffer<f32>{ size };
-                        _api.glyphOffsets = Buffer<DWRITE_GLYPH_OFFSET>{ size };
+                        scratch.glyphAdvances = Buffer<f32>{ size };
+                        scratch.glyphOffsets = Buffer<DWRITE_GLYPH_OFFSET>{ size };
                     }
 
                     THROW_IF_FAILED(_sr.textAnalyzer->GetGlyphPlacements(
-                        /* textString          */ _api.bufferLine.data() + a.textPosition,
-                        /* clusterMap          */ _api.clusterMap.data(),
-                        /* textProps           */ _api.textProps.data(),
+                        /* textString          */ line.text.data() + a.textPosition,
+                        /* clusterMap          */ scratch.clusterMap.data(),
+                        /* textProps           */ scratch.textProps.data(),
                         /* textLength          */ a.textLength,
-                        /* glyphIndices        */ _api.glyphIndices.data(),
-                        /* glyphProps          */ _api.glyphProps.data(),
+                        /* glyphIndices        */ scratch.glyphIndices.data(),
+                        /* glyphProps          */ scratch.glyphProps.data(),
                         /* glyphCount          */ actualGlyphCount,
                         /* fontFace            */ mappedFontFace.get(),
                         /* fontEmSize          */ _api.fontMetrics.fontSizeInDIP,
@@ -1400,50 +2159,59 @@ void AtlasEngine::_flushBufferLine()
                         /* features            */ &features,
                         /* featureRangeLengths */ &featureRangeLengths,
                         /* featureRanges       */ featureRanges,
-                        /* glyphAdvances       */ _api.glyphAdvances.data(),
-                        /* glyphOffsets        */ _api.glyphOffsets.data()));
+                        /* glyphAdvances       */ scratch.glyphAdvances.data(),
+                        /* glyphOffsets        */ scratch.glyphOffsets.data()));
 
-                    _api.textProps[a.textLength - 1].canBreakShapingAfter = 1;
+                    scratch.textProps[a.textLength - 1].canBreakShapingAfter = 1;
 
-                    size_t beg = 0;
-                    for (size_t i = 0; i < a.textLength; ++i)
+                    ShapedText shapedText{ mappedFontFace, {} };
+                    u32 beg = 0;
+                    for (u32 i = 0; i < a.textLength; ++i)
                     {
-                        if (_api.textProps[i].canBreakShapingAfter)
+                        if (scratch.textProps[i].canBreakShapingAfter)
                         {
-                            _emplaceGlyph(mappedFontFace.get(), a.textPosition + beg, a.textPosition + i + 1);
+                            line.glyphRuns.emplace_back(GlyphRun{ mappedFontFace.get(), a.textPosition + beg, a.textPosition + i + 1 });
+                            shapedText.clusterEnds.emplace_back(i + 1);
                             beg = i + 1;
                         }
                     }
+
+                    scratch.newShapedTexts.emplace_back(shapedTextKey, std::move(shapedText));
                 }
             }
         }
     }
 }
 
-void AtlasEngine::_emplaceGlyph(IDWriteFontFace* fontFace, size_t bufferPos1, size_t bufferPos2)
+void AtlasEngine::_emplaceGlyph(const BufferLine& line, IDWriteFontFace* fontFace, size_t bufferPos1, size_t bufferPos2)
 {
     static constexpr auto replacement = L'\uFFFD';
 
     // This would seriously blow us up otherwise.
-    Expects(bufferPos1 < bufferPos2 && bufferPos2 <= _api.bufferLine.size());
+    Expects(bufferPos1 < bufferPos2 && bufferPos2 <= line.text.size());
 
-    const auto chars = fontFace ? &_api.bufferLine[bufferPos1] : &replacement;
+    const auto chars = fontFace ? &line.text[bufferPos1] : &replacement;
     const auto charCount = fontFace ? bufferPos2 - bufferPos1 : 1;
 
-    // _flushBufferLine() ensures that bufferLineColumn.size() > bufferLine.size().
-    const auto x1 = _api.bufferLineColumn[bufferPos1];
-    const auto x2 = _api.bufferLineColumn[bufferPos2];
+    // _queueBufferLine() ensures that columns.size() > text.size().
+    const auto x1 = line.columns[bufferPos1];
+    const auto x2 = line.columns[bufferPos2];
 
-    Expects(x1 < x2 && x2 <= _api.cellCount.x);
+    Expects(x1 < x2 && x2 <= _api.cellCount.x && line.row < _api.cellCount.y);
 
     const u16 cellCount = x2 - x1;
 
-    auto attributes = _api.attributes;
+    auto attributes = line.attributes;
     attributes.cellCount = cellCount;
 
     const auto [it, inserted] = _r.glyphs.emplace(std::piecewise_construct, std::forward_as_tuple(attributes, gsl::narrow<u16>(charCount), chars), std::forward_as_tuple());
     const auto& key = it->first;
     auto& value = it->second;
+    value.lastUsed = _r.glyphGeneration;
+
+    // There's only one writer, so there's no need for an atomic read-modify-write.
+    _sr.glyphLookups.store(_sr.glyphLookups.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _sr.glyphHits.store(_sr.glyphHits.load(std::memory_order_relaxed) + !inserted, std::memory_order_relaxed);
 
     if (inserted)
     {
@@ -1473,27 +2241,39 @@ void AtlasEngine::_emplaceGlyph(IDWriteFontFace* fontFace, size_t bufferPos1, si
             WI_SetFlagIf(flags, CellFlags::ColoredGlyph, fontFace2 && fontFace2->IsColorFont());
         }
 
-        const auto coords = value.initialize(flags, cellCount);
+        // Whitespace is the most common "glyph" by far. It doesn't need to be rasterized, nor take up
+        // space in the atlas, and the shader can skip sampling the atlas for it. Decorations like
+        // underlines are drawn by the shader anyways and stay unaffected by this.
+        const auto noGlyph = fontFace && std::all_of(chars, chars + charCount, [](wchar_t ch) { return ch == L' '; });
+        WI_SetFlagIf(flags, CellFlags::NoGlyph, noGlyph);
+
+        const auto atlasIndex = _atlasIndex(flags);
+        const auto tiles = value.initialize(flags, cellCount);
         for (u16 i = 0; i < cellCount; ++i)
         {
-            coords[i] = _allocateAtlasTile();
+            tiles[i] = noGlyph ? u16{ 0 } : _allocateAtlasTile(atlasIndex);
         }
 
-        _r.glyphQueue.push_back(AtlasQueueItem{ &key, &value });
-        _r.maxEncounteredCellCount = std::max(_r.maxEncounteredCellCount, cellCount);
+        if (!noGlyph)
+        {
+            _r.glyphQueue.push_back(AtlasQueueItem{ &key, &value });
+            _r.maxEncounteredCellCount = std::max(_r.maxEncounteredCellCount, cellCount);
+        }
     }
 
     const auto valueData = value.data();
-    const auto coords = &valueData->coords[0];
-    const auto data = _getCell(x1, _api.lastPaintBufferLineCoord.y);
+    const auto tiles = &valueData->tiles[0];
+    const auto data = _getCell(x1, line.row);
+    const auto metadata = &line.metadata[static_cast<size_t>(x1) - line.columns.front()];
+    _markCellRowsDirty(line.row, gsl::narrow_cast<u16>(line.row + 1));
 
     for (u32 i = 0; i < cellCount; ++i)
     {
-        data[i].tileIndex = coords[i];
+        data[i].tileIndex = tiles[i];
         // We should apply the column color and flags from each column (instead
         // of copying them from the x1) so that ligatures can appear in multiple
         // colors with different line styles.
-        data[i].flags = valueData->flags | _api.bufferLineMetadata[static_cast<size_t>(x1) + i].flags;
-        data[i].color = _api.bufferLineMetadata[static_cast<size_t>(x1) + i].colors;
+        data[i].flags = valueData->flags | metadata[i].flags;
+        data[i].color = { _paletteIndex(metadata[i].colors.x), _paletteIndex(metadata[i].colors.y) };
     }
 }
@@ -58,10 +58,12 @@ namespace Microsoft::Console::Render
         HRESULT Enable() noexcept override;
         [[nodiscard]] bool GetRetroTerminalEffect() const noexcept override;
         [[nodiscard]] float GetScaling() const noexcept override;
+        [[nodiscard]] HRESULT GetGlyphCacheStatistics(uint64_t& lookups, uint64_t& hits) const noexcept override;
         [[nodiscard]] HANDLE GetSwapChainHandle() override;
         [[nodiscard]] Types::Viewport GetViewportInCharacters(const Types::Viewport& viewInPixels) const noexcept override;
         [[nodiscard]] Types::Viewport GetViewportInPixels(const Types::Viewport& viewInCharacters) const noexcept override;
         // DxRenderer - setter
+        [[nodiscard]] HRESULT RequestThumbnail(til::size maxSize, std::function<void(RenderThumbnail&&)> pfn) noexcept override;
         void SetAntialiasingMode(D2D1_TEXT_ANTIALIAS_MODE antialiasingMode) noexcept override;
         void SetCallback(std::function<void()> pfn) noexcept override;
         void EnableTransparentBackground(const bool isTransparent) noexcept override;
@@ -71,9 +73,12 @@ namespace Microsoft::Console::Render
         void SetRetroTerminalEffect(bool enable) noexcept override;
         void SetSelectionBackground(COLORREF color, float alpha = 0.5f) noexcept override;
         void SetSoftwareRendering(bool enable) noexcept override;
+        void SetSharedDeviceRendering(bool enable) noexcept override;
+        [[nodiscard]] HRESULT SetSmoothScrollOffset(float rows) noexcept override;
         void SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept override;
         [[nodiscard]] HRESULT SetWindowSize(SIZE pixels) noexcept override;
         void ToggleShaderEffects() noexcept override;
+        void TrimResources() noexcept override;
         [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& pfiFontInfoDesired, FontInfo& fiFontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes) noexcept override;
         void UpdateHyperlinkHoveredId(uint16_t hoveredId) noexcept override;
 
@@ -150,6 +155,7 @@ namespace Microsoft::Console::Render
 
         using u32 = uint32_t;
         using u32x2 = vec2<u32>;
+        using u32x4 = vec4<u32>;
 
         using i32 = int32_t;
 
@@ -390,36 +396,39 @@ namespace Microsoft::Console::Render
         // If you change this be sure to copy it over to shader_ps.hlsl.
         //
         // clang-format off
-        enum class CellFlags : u32
+        enum class CellFlags : u16
         {
-            None            = 0x00000000,
-            Inlined         = 0x00000001,
-
-            ColoredGlyph    = 0x00000002,
-
-            Cursor          = 0x00000008,
-            Selected        = 0x00000010,
-
-            BorderLeft      = 0x00000020,
-            BorderTop       = 0x00000040,
-            BorderRight     = 0x00000080,
-            BorderBottom    = 0x00000100,
-            Underline       = 0x00000200,
-            UnderlineDotted = 0x00000400,
-            UnderlineDouble = 0x00000800,
-            Strikethrough   = 0x00001000,
+            None            = 0x0000,
+            Inlined         = 0x0001,
+
+            ColoredGlyph    = 0x0002,
+            NoGlyph         = 0x0004,
+
+            // The LineRendition of the row, shifted left by 3. The shader
+            // only reads it from the first cell of each row.
+            LineRendition   = 0x0018,
+
+            BorderLeft      = 0x0020,
+            BorderTop       = 0x0040,
+            BorderRight     = 0x0080,
+            BorderBottom    = 0x0100,
+            Underline       = 0x0200,
+            UnderlineDotted = 0x0400,
+            UnderlineDouble = 0x0800,
+            Strikethrough   = 0x1000,
         };
         // clang-format on
-        ATLAS_FLAG_OPS(CellFlags, u32)
+        ATLAS_FLAG_OPS(CellFlags, u16)
 
-        // This structure is shared with the GPU shader and needs to follow certain alignment rules.
-        // You can generally assume that only u32 or types of that alignment are allowed.
+        // This structure is shared with the GPU shader, which reads it as 2 uints.
+        // Remember that the GPU reads it for every single pixel: The smaller it is the better.
         struct Cell
         {
-            alignas(u32) u16x2 tileIndex;
-            alignas(u32) CellFlags flags = CellFlags::None;
-            u32x2 color;
+            u16 tileIndex = 0; // a tile of the text or color atlas (see CellFlags::ColoredGlyph), in rows of _r.atlasTilesPerRow tiles
+            CellFlags flags = CellFlags::None;
+            u16x2 color; // indices into _r.palette, x: foreground, y: background
         };
+        static_assert(sizeof(Cell) == 8);
 
         struct AtlasKeyAttributes
         {
@@ -458,8 +467,10 @@ namespace Microsoft::Console::Render
             size_t hash() const noexcept
             {
                 const auto d = data();
+                til::hasher h;
 #pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
-                return std::_Fnv1a_append_bytes(std::_FNV_offset_basis, reinterpret_cast<const u8*>(d), dataSize(d->charCount));
+                h.write(reinterpret_cast<const u8*>(d), dataSize(d->charCount));
+                return h.finalize();
             }
 
             bool operator==(const AtlasKey& rhs) const noexcept
@@ -493,20 +504,20 @@ namespace Microsoft::Console::Render
         struct AtlasValueData
         {
             CellFlags flags = CellFlags::None;
-            u16x2 coords[7];
+            u16 tiles[14];
         };
 
         struct AtlasValue
         {
             constexpr AtlasValue() = default;
 
-            u16x2* initialize(CellFlags flags, u16 cellCount)
+            u16* initialize(CellFlags flags, u16 cellCount)
             {
                 const auto size = dataSize(cellCount);
                 const auto data = _data.initialize(size);
                 WI_SetFlagIf(flags, CellFlags::Inlined, _data.would_inline(size));
                 data->flags = flags;
-                return &data->coords[0];
+                return &data->tiles[0];
             }
 
             const AtlasValueData* data() const noexcept
@@ -514,12 +525,15 @@ namespace Microsoft::Console::Render
                 return _data.data();
             }
 
+            // The _r.glyphGeneration this glyph was last painted in. See _evictAtlasTiles().
+            u32 lastUsed = 0;
+
         private:
             SmallObjectOptimizer<AtlasValueData> _data;
 
-            static constexpr size_t dataSize(u16 coordCount) noexcept
+            static constexpr size_t dataSize(u16 tileCount) noexcept
             {
-                return sizeof(AtlasValueData) - sizeof(AtlasValueData::coords) + static_cast<size_t>(coordCount) * sizeof(AtlasValueData::coords[0]);
+                return sizeof(AtlasValueData) - sizeof(AtlasValueData::tiles) + static_cast<size_t>(tileCount) * sizeof(AtlasValueData::tiles[0]);
             }
         };
 
@@ -529,6 +543,120 @@ namespace Microsoft::Console::Render
             const AtlasValue* value;
         };
 
+        // Glyphs rasterized by one AtlasEngine are shared with all the others in the process that use
+        // the same font, DPI and antialiasing mode. The atlas textures can't be shared themselves, as they
+        // belong to the D3D device of each engine, which is single-threaded and owned by its render thread.
+        // Instead the tiles are kept as pixels in system memory (in the format of the atlas they belong to,
+        // all cells of a glyph side by side), so that a new tab can upload them into its atlas instead of
+        // rasterizing them again.
+        // The warmup thread also keeps a copy of them on disk, so that the next launch of the process
+        // doesn't have to rasterize them either. See _rasterizeWarmupGlyphs().
+        class SharedGlyphCache
+        {
+        public:
+            static std::shared_ptr<SharedGlyphCache> get(const std::wstring& signature);
+
+            const std::wstring& signature() const noexcept
+            {
+                return _signature;
+            }
+
+            gsl::span<const u8> find(const AtlasKey& key) const;
+            void insert(const AtlasKey& key, Buffer<u8>&& pixels);
+            bool load(const std::filesystem::path& path, const std::wstring& fileKey);
+            void save(const std::filesystem::path& path, const std::wstring& fileKey) const;
+
+            // Returns true only for the first caller. See _warmupGlyphCache().
+            bool tryBeginWarmup() noexcept
+            {
+                return !_warmedUp.exchange(true, std::memory_order_relaxed);
+            }
+
+        private:
+            // Glyphs beyond this are no longer shared, so that a process that
+            // displays lots of different text doesn't grow the cache endlessly.
+            static constexpr size_t maxGlyphs = 4096;
+
+            // The file starts with a FileHeader, followed by the fileKey (UTF-16) and the glyphs.
+            // Each glyph is a FileGlyph, followed by its characters and its pixels.
+            // The magic is "WTGC". The version has to be incremented whenever the layout changes.
+            static constexpr u32 fileMagic = 0x43475457;
+            static constexpr u32 fileVersion = 1;
+
+            struct FileHeader
+            {
+                u32 magic;
+                u32 version;
+                u32 keyLength;
+                u32 glyphCount;
+            };
+
+            struct FileGlyph
+            {
+                AtlasKeyAttributes attributes;
+                u16 charCount;
+                u32 pixelCount;
+            };
+
+            std::wstring _signature;
+            mutable std::shared_mutex _mutex;
+            std::unordered_map<AtlasKey, Buffer<u8>, AtlasKeyHasher> _glyphs;
+            std::atomic<bool> _warmedUp{ false };
+
+#ifdef UNIT_TESTING
+            friend class AtlasGlyphCacheTests;
+#endif
+        };
+
+        // Everything _rasterizeWarmupGlyphs() needs to draw glyphs the same way _drawGlyphs() does.
+        struct GlyphWarmup
+        {
+            std::shared_ptr<SharedGlyphCache> glyphCache;
+            wil::com_ptr<IDWriteFactory1> dwriteFactory;
+            wil::com_ptr<IDWriteTextFormat> textFormats[2][2];
+            wil::com_ptr<IDWriteTypography> typography;
+            f32x2 cellSizeDIP;
+            u16x2 cellSize;
+            u16 dpi = 0;
+            u8 antialiasingMode = 0;
+        };
+
+        // The result of shaping a run of text with GetGlyphs(), as far as we use it.
+        struct ShapedText
+        {
+            // Keeps the font face alive, because its address is part of the key.
+            wil::com_ptr<IDWriteFontFace> fontFace;
+            // The offsets, relative to the start of the run, that its clusters end at.
+            std::vector<u32> clusterEnds;
+        };
+
+        struct GlyphReadbackItem
+        {
+            const AtlasKey* key;
+            u16 offset; // in cells
+            u16 cellCount;
+        };
+
+        // Most glyphs only consist of their coverage, which is why they're kept apart from the colored ones,
+        // in an atlas with just as many channels as the antialiasing mode needs. See _textAtlasFormat().
+        // Each atlas has its own scratchpad in the same format, as textures can only be copied between
+        // compatible formats, and its own D2D render target, whose antialiasing mode never changes.
+        struct GlyphAtlas
+        {
+            DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN; // invalidated by ApiInvalidations::Font
+            wil::com_ptr<ID3D11Texture2D> buffer;
+            wil::com_ptr<ID3D11ShaderResourceView> view;
+            wil::com_ptr<ID3D11Texture2D> scratchpad;
+            wil::com_ptr<ID2D1RenderTarget> d2dRenderTarget; // depends on scratchpad
+            wil::com_ptr<ID2D1Brush> brush; // depends on d2dRenderTarget
+            u16x2 sizeInPixel; // invalidated by ApiInvalidations::Font
+            u16x2 position; // where _allocateAtlasTile() allocates the next tile
+            std::vector<u16> freeTiles; // tiles recycled by _evictAtlasTiles(), invalidated by ApiInvalidations::Font
+            wil::com_ptr<ID3D11Texture2D> glyphReadback; // invalidated by ApiInvalidations::Font
+            std::vector<GlyphReadbackItem> glyphReadbackQueue;
+            u16 glyphReadbackUsed = 0;
+        };
+
         struct CachedCursorOptions
         {
             u32 cursorColor = INVALID_COLOR;
@@ -544,6 +672,49 @@ namespace Microsoft::Console::Render
             CellFlags flags = CellFlags::None;
         };
 
+        // A run of text in a BufferLine and the font face it maps to, or nullptr for a replacement character.
+        struct GlyphRun
+        {
+            IDWriteFontFace* fontFace = nullptr;
+            u32 pos1 = 0;
+            u32 pos2 = 0;
+        };
+
+        // A line of text assembled by PaintBufferLine(), which is yet to be segmented into glyphs.
+        struct BufferLine
+        {
+            std::vector<wchar_t> text;
+            // The column of each character in text, followed by the column the line ends at.
+            std::vector<u16> columns;
+            // The colors and flags of the columns the line covers, starting at columns.front().
+            std::vector<BufferLineMetadata> metadata;
+            AtlasKeyAttributes attributes{};
+            u16 row = 0;
+
+            // The results of _analyzeBufferLine(). fontFaces keeps the faces in glyphRuns alive.
+            std::vector<GlyphRun> glyphRuns;
+            std::vector<wil::com_ptr<IDWriteFontFace>> fontFaces;
+        };
+
+        // The scratch buffers that segmenting a BufferLine requires.
+        // Each thread that analyzes lines has its own. See _flushBufferLines().
+        struct TextAnalysisScratch
+        {
+            std::vector<TextAnalyzerResult> analysisResults;
+            Buffer<u16> clusterMap;
+            Buffer<DWRITE_SHAPING_TEXT_PROPERTIES> textProps;
+            Buffer<u16> glyphIndices;
+            Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps;
+            Buffer<f32> glyphAdvances;
+            Buffer<DWRITE_GLYPH_OFFSET> glyphOffsets;
+            std::wstring fontFallbackKey;
+            std::wstring shapedTextKey;
+            // The caches are read-only while lines are being analyzed.
+            // New entries are collected here and merged on the render thread.
+            std::vector<std::pair<std::wstring, wil::com_ptr<IDWriteFontFace>>> newFontFallbacks;
+            std::vector<std::pair<std::wstring, ShapedText>> newShapedTexts;
+        };
+
         // NOTE: D3D constant buffers sizes must be a multiple of 16 bytes.
         struct alignas(16) ConstBuffer
         {
@@ -564,6 +735,9 @@ namespace Microsoft::Console::Render
             alignas(sizeof(u32)) u32 cursorColor = 0;
             alignas(sizeof(u32)) u32 selectionColor = 0;
             alignas(sizeof(u32)) u32 useClearType = 0;
+            alignas(sizeof(u32)) u32 atlasTilesPerRow = 0;
+            alignas(sizeof(u32x4)) u32x4 cursorRect; // left, top, right, bottom in cells
+            alignas(sizeof(u32)) u32 scrollOffsetY = 0; // in pixels, see SetSmoothScrollOffset()
 #pragma warning(suppress : 4324) // 'ConstBuffer': structure was padded due to alignment specifier
         };
 
@@ -586,6 +760,7 @@ namespace Microsoft::Console::Render
             None = 0,
             Cursor = 1 << 0,
             ConstBuffer = 1 << 1,
+            Selection = 1 << 2,
         };
         ATLAS_FLAG_OPS(RenderInvalidations, u8)
 
@@ -598,8 +773,20 @@ namespace Microsoft::Console::Render
             return std::max(min, std::min(max, val));
         }
 
+        // The D3D device of all instances with SetSharedDeviceRendering(true) in this process,
+        // so that many panes don't each create one. Its immediate context is used by the render
+        // threads of all of them, which is why they hold _lockSharedDevice() while using it.
+        struct SharedDevice
+        {
+            wil::com_ptr<ID3D11Device> device;
+            wil::com_ptr<ID3D11DeviceContext1> deviceContext;
+        };
+
         // AtlasEngine.cpp
         [[nodiscard]] HRESULT _handleException(const wil::ResultException& exception) noexcept;
+        static std::pair<wil::com_ptr<ID3D11Device>, wil::com_ptr<ID3D11DeviceContext1>> _createDevice(UINT deviceFlags);
+        static std::shared_ptr<SharedDevice> _getSharedDevice(UINT deviceFlags);
+        static std::unique_lock<std::mutex> _lockSharedDevice(bool shared);
         __declspec(noinline) void _createResources();
         void _releaseSwapChain();
         __declspec(noinline) void _createSwapChain();
@@ -608,34 +795,79 @@ namespace Microsoft::Console::Render
         IDWriteTextFormat* _getTextFormat(bool bold, bool italic) const noexcept;
         const Buffer<DWRITE_FONT_AXIS_VALUE>& _getTextFormatAxis(bool bold, bool italic) const noexcept;
         Cell* _getCell(u16 x, u16 y) noexcept;
-        void _setCellFlags(SMALL_RECT coords, CellFlags mask, CellFlags bits) noexcept;
-        u16x2 _allocateAtlasTile() noexcept;
-        void _flushBufferLine();
-        void _emplaceGlyph(IDWriteFontFace* fontFace, size_t bufferPos1, size_t bufferPos2);
+        void _markCellRowsDirty(u16 top, u16 bottom) noexcept;
+        static DXGI_FORMAT _textAtlasFormat(u8 antialiasingMode) noexcept;
+        static u32 _bytesPerPixel(DXGI_FORMAT format) noexcept;
+        static size_t _atlasIndex(CellFlags flags) noexcept;
+        u16 _allocateAtlasTile(size_t atlasIndex) noexcept;
+        u16x2 _tilePosition(u16 tile) const noexcept;
+        u16 _paletteIndex(u32 color);
+        void _resetPalette() noexcept;
+        void _evictAtlasTiles(size_t atlasIndex) noexcept;
+        void _queueBufferLine();
+        void _flushBufferLines();
+        static void CALLBACK _analyzeBufferLinesCallback(PTP_CALLBACK_INSTANCE instance, void* context, PTP_WORK work) noexcept;
+        void _analyzeBufferLines() noexcept;
+        void _analyzeBufferLine(BufferLine& line, TextAnalysisScratch& scratch) const;
+        static u32 _nextBufferLineCell(const BufferLine& line, u32 pos) noexcept;
+        static const std::wstring& _fontFallbackKey(const BufferLine& line, TextAnalysisScratch& scratch, u32 pos1, u32 pos2);
+        u32 _mapCharactersFromCache(const BufferLine& line, TextAnalysisScratch& scratch, u32 idx, wil::com_ptr<IDWriteFontFace>& mappedFontFace) const;
+        static void _cacheMappedCharacters(const BufferLine& line, TextAnalysisScratch& scratch, u32 idx, u32 end, const wil::com_ptr<IDWriteFontFace>& mappedFontFace);
+        static const std::wstring& _shapedTextKey(const BufferLine& line, TextAnalysisScratch& scratch, IDWriteFontFace* fontFace, const TextAnalyzerResult& analysis);
+        void _emplaceGlyph(const BufferLine& line, IDWriteFontFace* fontFace, size_t bufferPos1, size_t bufferPos2);
 
         // AtlasEngine.api.cpp
         void _resolveAntialiasingMode() noexcept;
+        void _resolveCellCount() noexcept;
         void _resolveFontMetrics(const FontInfoDesired& fontInfoDesired, FontInfo& fontInfo, FontMetrics* fontMetrics = nullptr) const;
 
         // AtlasEngine.r.cpp
         void _setShaderResources() const;
         void _updateConstantBuffer() const noexcept;
         void _adjustAtlasSize();
+        void _resizeAtlas(GlyphAtlas& atlas);
         void _reserveScratchpadSize(u16 minWidth);
         void _processGlyphQueue();
-        void _drawGlyph(const AtlasQueueItem& item) const;
+        void _drawGlyphs(const AtlasQueueItem* items, size_t count);
+        void _drawGlyphsIntoAtlas(size_t atlasIndex, const AtlasQueueItem* const* slots, u32 slotCount);
+        void _uploadGlyph(size_t atlasIndex, const u8* pixels, const u16* tiles, u32 cellCount) const noexcept;
+        static void _warmupGlyphCache(GlyphWarmup&& warmup);
+        static void _rasterizeWarmupGlyphs(const GlyphWarmup& warmup);
+        static void _appendFontFileIdentity(std::wstring& fileKey, IDWriteFontFace* fontFace);
+        static std::filesystem::path _glyphCacheFilePath(const std::wstring& fileKey);
+        void _queueGlyphReadback(size_t atlasIndex, const AtlasKey* key, u16 cellCount, u32 scratchpadSlot);
+        void _flushGlyphReadback();
         void _drawCursor();
-        void _copyScratchpadTile(uint32_t scratchpadIndex, u16x2 target, uint32_t copyFlags = 0) const noexcept;
+        void _captureThumbnail();
+        void _copyScratchpadTile(size_t atlasIndex, uint32_t scratchpadIndex, uint32_t scratchpadSlot, u16x2 target, uint32_t copyFlags = 0) const noexcept;
 
         static constexpr bool debugGlyphGenerationPerformance = false;
         static constexpr bool debugGeneralPerformance = false || debugGlyphGenerationPerformance;
         static constexpr bool continuousRedraw = false || debugGeneralPerformance;
+        // Rasterize the most common glyphs in the background whenever the font changes. See _warmupGlyphCache().
+        static constexpr bool glyphWarmup = true && !debugGlyphGenerationPerformance;
+
+        // Cells refer to atlas tiles and colors with u16 indices.
+        static constexpr size_t maxAtlasTiles = 0x10000;
+        // The indices of _r.atlases. The cursor is always drawn into the first tile of the text atlas.
+        static constexpr size_t textAtlas = 0;
+        static constexpr size_t colorAtlas = 1;
+        static constexpr size_t paletteCapacity = 0x10000;
+        // StartPaint() rebuilds the palette from the colors on screen once it's this full.
+        static constexpr size_t paletteResetThreshold = paletteCapacity / 4 * 3;
+
+        // The scratchpad has room for this many glyphs, which are all drawn with a single BeginDraw()/EndDraw().
+        static constexpr u32 scratchpadSlots = 16;
+        // A screen full of new glyphs (after a font change for instance) takes a long time to rasterize.
+        // _processGlyphQueue() spreads them over several frames once it has drawn at least
+        // glyphQueueMinimumPerFrame of them, which suffices for typing and regular output.
+        static constexpr size_t glyphQueueMinimumPerFrame = 4 * scratchpadSlots;
+        static constexpr std::chrono::milliseconds glyphQueueTimeBudget{ 10 };
 
         static constexpr u16 u16min = 0x0000;
         static constexpr u16 u16max = 0xffff;
         static constexpr i16 i16min = -0x8000;
         static constexpr i16 i16max = 0x7fff;
-        static constexpr u16r invalidatedAreaNone = { u16max, u16max, u16min, u16min };
         static constexpr u16x2 invalidatedRowsNone{ u16max, u16min };
         static constexpr u16x2 invalidatedRowsAll{ u16min, u16max };
 
@@ -645,7 +877,13 @@ namespace Microsoft::Console::Render
             wil::com_ptr<IDWriteFactory1> dwriteFactory;
             wil::com_ptr<IDWriteFontFallback> systemFontFallback;
             wil::com_ptr<IDWriteTextAnalyzer1> textAnalyzer;
+            // Analyzes the lines of larger frames in parallel. See _flushBufferLines().
+            wil::unique_threadpool_work textAnalysisWork;
             bool isWindows10OrGreater = true;
+            // How many glyphs _emplaceGlyph() looked up and how many of them were already in the atlas.
+            // Only the render thread writes them, GetGlyphCacheStatistics() reads them from any thread.
+            std::atomic<uint64_t> glyphLookups{ 0 };
+            std::atomic<uint64_t> glyphHits{ 0 };
 
 #ifndef NDEBUG
             std::filesystem::path sourceDirectory;
@@ -657,6 +895,7 @@ namespace Microsoft::Console::Render
         struct Resources
         {
             // D3D resources
+            std::shared_ptr<SharedDevice> sharedDevice; // only set if device and deviceContext belong to it
             wil::com_ptr<ID3D11Device> device;
             wil::com_ptr<ID3D11DeviceContext1> deviceContext;
             wil::com_ptr<IDXGISwapChain1> swapChain;
@@ -667,21 +906,34 @@ namespace Microsoft::Console::Render
             wil::com_ptr<ID3D11Buffer> constantBuffer;
             wil::com_ptr<ID3D11Buffer> cellBuffer;
             wil::com_ptr<ID3D11ShaderResourceView> cellView;
+            // The target of the copy that scrolls the cells on the GPU. It's swapped with cellBuffer afterwards.
+            wil::com_ptr<ID3D11Buffer> cellBufferBack;
+            wil::com_ptr<ID3D11ShaderResourceView> cellViewBack;
+            wil::com_ptr<ID3D11Buffer> paletteBuffer;
+            wil::com_ptr<ID3D11ShaderResourceView> paletteView;
+            // The range of columns of each row that's selected, as u16x2. See PrepareRenderInfo().
+            wil::com_ptr<ID3D11Buffer> selectionBuffer;
+            wil::com_ptr<ID3D11ShaderResourceView> selectionView;
 
             // D2D resources
-            wil::com_ptr<ID3D11Texture2D> atlasBuffer;
-            wil::com_ptr<ID3D11ShaderResourceView> atlasView;
-            wil::com_ptr<ID3D11Texture2D> atlasScratchpad;
-            wil::com_ptr<ID2D1RenderTarget> d2dRenderTarget;
-            wil::com_ptr<ID2D1Brush> brush;
+            std::array<GlyphAtlas, 2> atlases; // see textAtlas and colorAtlas
             wil::com_ptr<IDWriteTextFormat> textFormats[2][2];
             Buffer<DWRITE_FONT_AXIS_VALUE> textFormatAxes[2][2];
             wil::com_ptr<IDWriteTypography> typography;
 
             Buffer<Cell, 32> cells; // invalidated by ApiInvalidations::Size
+            u16x2 dirtyCellRows = invalidatedRowsAll; // the rows of cells Present() needs to upload, x is "top" and y "bottom"
+            i16 cellScrollOffset = 0; // the rows Present() needs to scroll the cell buffer by, before uploading the dirty ones
+            // The colors the cells refer to. See _paletteIndex().
+            std::vector<u32> palette; // invalidated by ApiInvalidations::Size
+            std::unordered_map<u32, u16> paletteIndices;
+            std::array<u16, 64> paletteMemo{};
+            size_t paletteUploaded = 0; // the colors at the start of the palette that Present() uploaded already
             f32x2 cellSizeDIP; // invalidated by ApiInvalidations::Font, caches _api.cellSize but in DIP
             u16x2 cellSize; // invalidated by ApiInvalidations::Font, caches _api.cellSize
             u16x2 cellCount; // invalidated by ApiInvalidations::Font|Size, caches _api.cellCount
+            u16 scrollOffsetY = 0; // caches _api.smoothScrollOffset but in pixels
+            u16x2 sizeInPixel; // invalidated by ApiInvalidations::Size, caches _api.sizeInPixel
             u16 underlinePos = 0;
             u16 strikethroughPos = 0;
             u16 lineThickness = 0;
@@ -689,10 +941,13 @@ namespace Microsoft::Console::Render
             u16 maxEncounteredCellCount = 0;
             u16 scratchpadCellWidth = 0;
             u16x2 atlasSizeInPixelLimit; // invalidated by ApiInvalidations::Font
-            u16x2 atlasSizeInPixel; // invalidated by ApiInvalidations::Font
-            u16x2 atlasPosition;
+            u32 atlasTilesPerRow = 0; // invalidated by ApiInvalidations::Font
             std::unordered_map<AtlasKey, AtlasValue, AtlasKeyHasher> glyphs;
+            u32 glyphGeneration = 0; // incremented by every EndPaint()
             std::vector<AtlasQueueItem> glyphQueue;
+            // The glyphs rasterized by this engine, which are shared once the GPU is done with them.
+            std::shared_ptr<SharedGlyphCache> glyphCache; // invalidated by ApiInvalidations::Font
+            u16 glyphReadbackCapacity = 0; // in cells, invalidated by ApiInvalidations::Font
 
             f32 gamma = 0;
             f32 cleartypeEnhancedContrast = 0;
@@ -700,7 +955,14 @@ namespace Microsoft::Console::Render
             u32 backgroundColor = 0xff000000;
             u32 selectionColor = 0x7fffffff;
 
+            // Set by StartPaint() if the frame is to be captured, see RequestThumbnail().
+            std::function<void(RenderThumbnail&&)> thumbnailCallback;
+            til::size thumbnailSize;
+
             CachedCursorOptions cursorOptions;
+            u16r cursorRect; // the cells the cursor covers, empty if it's off
+            std::vector<u32> selectionRows; // invalidated by ApiInvalidations::Size, uploaded into selectionBuffer
+            std::vector<u32> selectionRowsNext; // the scratch buffer PrepareRenderInfo() compares selectionRows with
             RenderInvalidations invalidations = RenderInvalidations::None;
 
 #ifndef NDEBUG
@@ -719,18 +981,23 @@ namespace Microsoft::Console::Render
             std::vector<wchar_t> bufferLine;
             std::vector<u16> bufferLineColumn;
             Buffer<BufferLineMetadata> bufferLineMetadata;
-            std::vector<TextAnalyzerResult> analysisResults;
-            Buffer<u16> clusterMap;
-            Buffer<DWRITE_SHAPING_TEXT_PROPERTIES> textProps;
-            Buffer<u16> glyphIndices;
-            Buffer<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps;
-            Buffer<f32> glyphAdvances;
-            Buffer<DWRITE_GLYPH_OFFSET> glyphOffsets;
+            // The lines queued up by _queueBufferLine(). Only the first bufferLineCount are in use.
+            std::vector<BufferLine> bufferLines;
+            size_t bufferLineCount = 0;
+            std::vector<TextAnalysisScratch> textAnalysisScratch;
+            // _analyzeBufferLines() hands out the lines and scratch buffers with these.
+            std::atomic<size_t> bufferLineAnalysisNext{ 0 };
+            std::atomic<size_t> textAnalysisScratchNext{ 0 };
+            std::atomic<HRESULT> bufferLineAnalysisResult{ S_OK };
+            // The font faces MapCharacters() resolved the text of a cell to. See _mapCharactersFromCache().
+            std::unordered_map<std::wstring, wil::com_ptr<IDWriteFontFace>> fontFallbackCache; // cleared on ApiInvalidations::Font
+            // The text runs we shaped before, keyed by font face, script and text. See _analyzeBufferLine().
+            std::unordered_map<std::wstring, ShapedText> shapedTextCache; // cleared on ApiInvalidations::Font
             std::vector<DWRITE_FONT_FEATURE> fontFeatures; // changes are flagged as ApiInvalidations::Font|Size
             std::vector<DWRITE_FONT_AXIS_VALUE> fontAxisValues; // changes are flagged as ApiInvalidations::Font|Size
             FontMetrics fontMetrics; // changes are flagged as ApiInvalidations::Font|Size
 
-            u16x2 cellCount; // caches `sizeInPixel / cellSize`
+            u16x2 cellCount; // caches `sizeInPixel / cellSize`, plus the row below the viewport (see SetSmoothScrollOffset())
             u16x2 sizeInPixel; // changes are flagged as ApiInvalidations::Size
 
             // UpdateDrawingBrushes()
@@ -743,27 +1010,36 @@ namespace Microsoft::Console::Render
             u32 selectionColor = 0x7fffffff;
             // UpdateHyperlinkHoveredId()
             u16 hyperlinkHoveredId = 0;
+            // SetSmoothScrollOffset()
+            f32 smoothScrollOffset = 0;
             bool bufferLineWasHyperlinked = false;
 
             // dirtyRect is a computed value based on invalidatedRows.
             til::rect dirtyRect;
             // These "invalidation" fields are reset in EndPaint()
-            u16r invalidatedCursorArea = invalidatedAreaNone;
             u16x2 invalidatedRows = invalidatedRowsNone; // x is treated as "top" and y as "bottom"
             i16 scrollOffset = 0;
 
             std::function<void(HRESULT)> warningCallback;
             std::function<void()> swapChainChangedCallback;
+            // RequestThumbnail()
+            std::function<void(RenderThumbnail&&)> thumbnailCallback;
+            til::size thumbnailSize;
             wil::unique_handle swapChainHandle;
             HWND hwnd = nullptr;
             u16 dpi = USER_DEFAULT_SCREEN_DPI; // changes are flagged as ApiInvalidations::Font|Size
             u8 antialiasingMode = D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE; // changes are flagged as ApiInvalidations::Font
             u8 realizedAntialiasingMode = D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE; // caches antialiasingMode, depends on antialiasingMode and backgroundOpaqueMixin, see _resolveAntialiasingMode
+            bool sharedDevice = false; // changes are flagged as ApiInvalidations::Device
 
             ApiInvalidations invalidations = ApiInvalidations::Device;
         } _api;
 
 #undef ATLAS_POD_OPS
 #undef ATLAS_FLAG_OPS
+
+#ifdef UNIT_TESTING
+        friend class AtlasGlyphCacheTests;
+#endif
     };
 }
@@ -30,8 +30,14 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT AtlasEngine::Present() noexcept
 try
 {
+    // Everything below uses the immediate context, up to and including the Present() of the swap chain.
+    // The waitable object ensures that it doesn't block, which is the only reason we can
+    // hold the lock during it, without delaying the frames of the other instances.
+    const auto lock = _lockSharedDevice(_r.sharedDevice != nullptr);
+
     _adjustAtlasSize();
     _reserveScratchpadSize(_r.maxEncounteredCellCount);
+    _flushGlyphReadback();
     _processGlyphQueue();
 
     if (WI_IsFlagSet(_r.invalidations, RenderInvalidations::Cursor))
@@ -47,13 +53,75 @@ try
         WI_ClearFlag(_r.invalidations, RenderInvalidations::ConstBuffer);
     }
 
+    if (WI_IsFlagSet(_r.invalidations, RenderInvalidations::Selection))
     {
-#pragma warning(suppress : 26494) // Variable 'mapped' is uninitialized. Always initialize an object (type.5).
-        D3D11_MAPPED_SUBRESOURCE mapped;
-        THROW_IF_FAILED(_r.deviceContext->Map(_r.cellBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped));
-        assert(mapped.RowPitch >= _r.cells.size() * sizeof(Cell));
-        memcpy(mapped.pData, _r.cells.data(), _r.cells.size() * sizeof(Cell));
-        _r.deviceContext->Unmap(_r.cellBuffer.get(), 0);
+        _r.deviceContext->UpdateSubresource(_r.selectionBuffer.get(), 0, nullptr, _r.selectionRows.data(), 0, 0);
+        WI_ClearFlag(_r.invalidations, RenderInvalidations::Selection);
+    }
+
+    // The cells painted this frame might refer to colors that were added to the palette.
+    if (_r.paletteUploaded < _r.palette.size())
+    {
+        D3D11_BOX box;
+        box.left = gsl::narrow_cast<UINT>(_r.paletteUploaded * sizeof(u32));
+        box.top = 0;
+        box.front = 0;
+        box.right = gsl::narrow_cast<UINT>(_r.palette.size() * sizeof(u32));
+        box.bottom = 1;
+        box.back = 1;
+        _r.deviceContext->UpdateSubresource(_r.paletteBuffer.get(), 0, &box, _r.palette.data() + _r.paletteUploaded, 0, 0);
+        _r.paletteUploaded = _r.palette.size();
+    }
+
+    // Typing a single character shouldn't upload megabytes of cells on large displays.
+    // --> Only upload the rows that changed since the last frame.
+    {
+        const auto rowSize = static_cast<UINT>(_r.cellCount.x * sizeof(Cell));
+        const auto top = std::min(_r.dirtyCellRows.x, _r.cellCount.y);
+        const auto bottom = std::min(_r.dirtyCellRows.y, _r.cellCount.y);
+
+        // Scrolling moved all rows in _r.cells, but only the ones that scrolled into view are dirty.
+        // A buffer can't be copied onto itself if the source and destination overlap, which is why
+        // the rows are copied into the back buffer, which then becomes the one the shader reads from.
+        if (const auto offset = std::exchange(_r.cellScrollOffset, 0); offset != 0 && (top != 0 || bottom != _r.cellCount.y))
+        {
+            const u32 distance = std::abs(offset);
+            const u32 rows = _r.cellCount.y - distance;
+            const u32 srcRow = offset < 0 ? distance : 0;
+            const u32 dstRow = offset < 0 ? 0 : distance;
+
+            D3D11_BOX box;
+            box.left = srcRow * rowSize;
+            box.top = 0;
+            box.front = 0;
+            box.right = (srcRow + rows) * rowSize;
+            box.bottom = 1;
+            box.back = 1;
+            _r.deviceContext->CopySubresourceRegion(_r.cellBufferBack.get(), 0, dstRow * rowSize, 0, 0, _r.cellBuffer.get(), 0, &box);
+
+            _r.cellBuffer.swap(_r.cellBufferBack);
+            _r.cellView.swap(_r.cellViewBack);
+            _r.deviceContext->PSSetShaderResources(0, 1, _r.cellView.addressof());
+        }
+
+        if (top < bottom)
+        {
+            D3D11_BOX box;
+            box.left = top * rowSize;
+            box.top = 0;
+            box.front = 0;
+            box.right = bottom * rowSize;
+            box.bottom = 1;
+            box.back = 1;
+            _r.deviceContext->UpdateSubresource(_r.cellBuffer.get(), 0, &box, _r.cells.data() + static_cast<size_t>(_r.cellCount.x) * top, 0, 0);
+        }
+        _r.dirtyCellRows = invalidatedRowsNone;
+    }
+
+    // The other instances sharing our device have bound their own state since our last frame.
+    if (_r.sharedDevice)
+    {
+        _setShaderResources();
     }
 
     // After Present calls, the back buffer needs to explicitly be
@@ -61,6 +129,17 @@ try
     _r.deviceContext->OMSetRenderTargets(1, _r.renderTargetView.addressof(), nullptr);
     _r.deviceContext->Draw(3, 0);
 
+    if (_r.thumbnailCallback)
+    {
+        // A thumbnail that failed isn't worth losing the frame over.
+        try
+        {
+            _captureThumbnail();
+        }
+        CATCH_LOG();
+        _r.thumbnailCallback = nullptr;
+    }
+
     // See documentation for IDXGISwapChain2::GetFrameLatencyWaitableObject method:
     // > For every frame it renders, the app should wait on this handle before starting any rendering operations.
     // > Note that this requirement includes the first frame the app renders with the swap chain.
@@ -92,6 +171,85 @@ CATCH_RETURN()
 
 #pragma endregion
 
+// Reads back the frame that was just drawn into the back buffer for RequestThumbnail().
+// The GPU does the downscaling, by generating the mip chain of a copy of the back buffer,
+// and we only read back the largest mip level that fits into _r.thumbnailSize.
+// Reading back from the GPU stalls the pipeline, which is why callers should only
+// ask for thumbnails every once in a while, instead of for every frame.
+void AtlasEngine::_captureThumbnail()
+{
+    wil::com_ptr<ID3D11Texture2D> backBuffer;
+    THROW_IF_FAILED(_r.swapChain->GetBuffer(0, __uuidof(backBuffer), backBuffer.put_void()));
+
+    D3D11_TEXTURE2D_DESC desc{};
+    backBuffer->GetDesc(&desc);
+
+    UINT level = 0;
+    auto width = desc.Width;
+    auto height = desc.Height;
+    while ((width > gsl::narrow_cast<UINT>(_r.thumbnailSize.width) || height > gsl::narrow_cast<UINT>(_r.thumbnailSize.height)) && (width > 1 || height > 1))
+    {
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        ++level;
+    }
+
+    auto source = backBuffer;
+    if (level != 0)
+    {
+        D3D11_TEXTURE2D_DESC mipDesc{};
+        mipDesc.Width = desc.Width;
+        mipDesc.Height = desc.Height;
+        mipDesc.MipLevels = level + 1;
+        mipDesc.ArraySize = 1;
+        mipDesc.Format = desc.Format;
+        mipDesc.SampleDesc = { 1, 0 };
+        mipDesc.Usage = D3D11_USAGE_DEFAULT;
+        mipDesc.BindFlags = D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE;
+        mipDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+        wil::com_ptr<ID3D11Texture2D> mipTexture;
+        wil::com_ptr<ID3D11ShaderResourceView> mipView;
+        THROW_IF_FAILED(_r.device->CreateTexture2D(&mipDesc, nullptr, mipTexture.put()));
+        THROW_IF_FAILED(_r.device->CreateShaderResourceView(mipTexture.get(), nullptr, mipView.put()));
+
+        _r.deviceContext->CopySubresourceRegion(mipTexture.get(), 0, 0, 0, 0, backBuffer.get(), 0, nullptr);
+        _r.deviceContext->GenerateMips(mipView.get());
+        source = std::move(mipTexture);
+    }
+
+    D3D11_TEXTURE2D_DESC stagingDesc{};
+    stagingDesc.Width = width;
+    stagingDesc.Height = height;
+    stagingDesc.MipLevels = 1;
+    stagingDesc.ArraySize = 1;
+    stagingDesc.Format = desc.Format;
+    stagingDesc.SampleDesc = { 1, 0 };
+    stagingDesc.Usage = D3D11_USAGE_STAGING;
+    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    wil::com_ptr<ID3D11Texture2D> staging;
+    THROW_IF_FAILED(_r.device->CreateTexture2D(&stagingDesc, nullptr, staging.put()));
+    _r.deviceContext->CopySubresourceRegion(staging.get(), 0, 0, 0, 0, source.get(), level, nullptr);
+
+    RenderThumbnail thumbnail;
+    thumbnail.size = { gsl::narrow_cast<til::CoordType>(width), gsl::narrow_cast<til::CoordType>(height) };
+    thumbnail.pixels.resize(static_cast<size_t>(width) * height);
+
+    {
+#pragma warning(suppress : 26494) // Variable 'mapped' is uninitialized. Always initialize an object (type.5).
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        THROW_IF_FAILED(_r.deviceContext->Map(staging.get(), 0, D3D11_MAP_READ, 0, &mapped));
+        for (UINT y = 0; y < height; ++y)
+        {
+            memcpy(thumbnail.pixels.data() + static_cast<size_t>(y) * width, static_cast<const char*>(mapped.pData) + static_cast<size_t>(y) * mapped.RowPitch, width * sizeof(uint32_t));
+        }
+        _r.deviceContext->Unmap(staging.get(), 0);
+    }
+
+    _r.thumbnailCallback(std::move(thumbnail));
+}
+
 void AtlasEngine::_setShaderResources() const
 {
     _r.deviceContext->VSSetShader(_r.vertexShader.get(), nullptr, 0);
@@ -107,8 +265,18 @@ void AtlasEngine::_setShaderResources() const
 
     _r.deviceContext->PSSetConstantBuffers(0, 1, _r.constantBuffer.addressof());
 
-    const std::array resources{ _r.cellView.get(), _r.atlasView.get() };
+    const std::array resources{ _r.cellView.get(), _r.atlases[textAtlas].view.get(), _r.paletteView.get(), _r.selectionView.get(), _r.atlases[colorAtlas].view.get() };
     _r.deviceContext->PSSetShaderResources(0, gsl::narrow_cast<UINT>(resources.size()), resources.data());
+
+    // Tell D3D which parts of the render target will be visible.
+    // Everything outside of the viewport will be black.
+    //
+    // In the future this should cover the entire _api.sizeInPixel.x/_api.sizeInPixel.y.
+    // The pixel shader should draw the remaining content in the configured background color.
+    D3D11_VIEWPORT viewport{};
+    viewport.Width = static_cast<float>(_r.sizeInPixel.x);
+    viewport.Height = static_cast<float>(_r.sizeInPixel.y);
+    _r.deviceContext->RSSetViewports(1, &viewport);
 }
 
 void AtlasEngine::_updateConstantBuffer() const noexcept
@@ -119,7 +287,8 @@ void AtlasEngine::_updateConstantBuffer() const noexcept
     data.viewport.x = 0;
     data.viewport.y = 0;
     data.viewport.z = static_cast<float>(_r.cellCount.x * _r.cellSize.x);
-    data.viewport.w = static_cast<float>(_r.cellCount.y * _r.cellSize.y);
+    // The last row of cells is below the viewport and only shifted into view by scrollOffsetY.
+    data.viewport.w = static_cast<float>((_r.cellCount.y - 1) * _r.cellSize.y);
     DWrite_GetGammaRatios(_r.gamma, data.gammaRatios);
     data.enhancedContrast = useClearType ? _r.cleartypeEnhancedContrast : _r.grayscaleEnhancedContrast;
     data.cellCountX = _r.cellCount.x;
@@ -133,21 +302,57 @@ void AtlasEngine::_updateConstantBuffer() const noexcept
     data.cursorColor = _r.cursorOptions.cursorColor;
     data.selectionColor = _r.selectionColor;
     data.useClearType = useClearType;
+    data.atlasTilesPerRow = _r.atlasTilesPerRow;
+    data.cursorRect.x = _r.cursorRect.left;
+    data.cursorRect.y = _r.cursorRect.top;
+    data.cursorRect.z = _r.cursorRect.right;
+    data.cursorRect.w = _r.cursorRect.bottom;
+    data.scrollOffsetY = _r.scrollOffsetY;
 #pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function '...' which may throw exceptions (f.6).
     _r.deviceContext->UpdateSubresource(_r.constantBuffer.get(), 0, nullptr, &data, 0, 0);
 }
 
 void AtlasEngine::_adjustAtlasSize()
 {
-    if (_r.atlasPosition.y < _r.atlasSizeInPixel.y && _r.atlasPosition.x < _r.atlasSizeInPixel.x)
+    auto resized = false;
+
+    for (size_t atlasIndex = 0; atlasIndex < _r.atlases.size(); ++atlasIndex)
     {
-        return;
+        auto& atlas = _r.atlases[atlasIndex];
+
+        if (atlas.position.y < atlas.sizeInPixel.y && atlas.position.x < atlas.sizeInPixel.x)
+        {
+            continue;
+        }
+        // Once the atlas can't grow anymore, _allocateAtlasTile() recycles tiles instead.
+        if (atlas.sizeInPixel == _r.atlasSizeInPixelLimit)
+        {
+            continue;
+        }
+        // The color atlas is only created once it has a tile. Most sessions never need it. The
+        // shader doesn't either: It only samples the color atlas for cells with CellFlags::ColoredGlyph.
+        if (atlas.position == u16x2{})
+        {
+            continue;
+        }
+
+        _resizeAtlas(atlas);
+        resized = true;
     }
 
+    if (resized)
+    {
+        _setShaderResources();
+    }
+}
+
+// Grows the atlas to fit the tiles that _allocateAtlasTile() handed out so far.
+void AtlasEngine::_resizeAtlas(GlyphAtlas& atlas)
+{
     const u32 limitX = _r.atlasSizeInPixelLimit.x;
     const u32 limitY = _r.atlasSizeInPixelLimit.y;
-    const u32 posX = _r.atlasPosition.x;
-    const u32 posY = _r.atlasPosition.y;
+    const u32 posX = atlas.position.x;
+    const u32 posY = atlas.position.y;
     const u32 cellX = _r.cellSize.x;
     const u32 cellY = _r.cellSize.y;
     const auto perCellArea = cellX * cellY;
@@ -160,7 +365,7 @@ void AtlasEngine::_adjustAtlasSize()
     //   |XXXXX↖        |
     //   |      |       |
     //   +------|-------+
-    // This is where _r.atlasPosition points at.
+    // This is where atlas.position points at.
     //
     // Each X is a glyph texture tile that's occupied.
     // We can compute the area of pixels consumed by adding the first
@@ -200,34 +405,34 @@ void AtlasEngine::_adjustAtlasSize()
         desc.Height = height;
         desc.MipLevels = 1;
         desc.ArraySize = 1;
-        desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        desc.Format = atlas.format;
         desc.SampleDesc = { 1, 0 };
         desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
         THROW_IF_FAILED(_r.device->CreateTexture2D(&desc, nullptr, atlasBuffer.addressof()));
         THROW_IF_FAILED(_r.device->CreateShaderResourceView(atlasBuffer.get(), nullptr, atlasView.addressof()));
     }
 
-    // If a _r.atlasBuffer already existed, we can copy its glyphs
+    // If an atlas.buffer already existed, we can copy its glyphs
     // over to the new texture without re-rendering everything.
-    const auto copyFromExisting = _r.atlasSizeInPixel != u16x2{};
+    const auto copyFromExisting = atlas.sizeInPixel != u16x2{};
     if (copyFromExisting)
     {
         D3D11_BOX box;
         box.left = 0;
         box.top = 0;
         box.front = 0;
-        box.right = _r.atlasSizeInPixel.x;
-        box.bottom = _r.atlasSizeInPixel.y;
+        box.right = atlas.sizeInPixel.x;
+        box.bottom = atlas.sizeInPixel.y;
         box.back = 1;
-        _r.deviceContext->CopySubresourceRegion1(atlasBuffer.get(), 0, 0, 0, 0, _r.atlasBuffer.get(), 0, &box, D3D11_COPY_NO_OVERWRITE);
+        _r.deviceContext->CopySubresourceRegion1(atlasBuffer.get(), 0, 0, 0, 0, atlas.buffer.get(), 0, &box, D3D11_COPY_NO_OVERWRITE);
     }
 
-    _r.atlasSizeInPixel = u16x2{ width, height };
-    _r.atlasBuffer = std::move(atlasBuffer);
-    _r.atlasView = std::move(atlasView);
-    _setShaderResources();
+    atlas.sizeInPixel = u16x2{ width, height };
+    atlas.buffer = std::move(atlasBuffer);
+    atlas.view = std::move(atlasView);
 
-    WI_SetFlagIf(_r.invalidations, RenderInvalidations::Cursor, !copyFromExisting);
+    // The cursor lives in the first tile of the text atlas.
+    WI_SetFlagIf(_r.invalidations, RenderInvalidations::Cursor, !copyFromExisting && &atlas == &_r.atlases[textAtlas]);
 }
 
 void AtlasEngine::_reserveScratchpadSize(u16 minWidth)
@@ -243,47 +448,56 @@ void AtlasEngine::_reserveScratchpadSize(u16 minWidth)
     // * current size * 1.5
     const auto newWidth = std::max<UINT>(std::max<UINT>(2, minWidth), _r.scratchpadCellWidth + (_r.scratchpadCellWidth >> 1));
 
-    _r.d2dRenderTarget.reset();
-    _r.atlasScratchpad.reset();
+    wil::com_ptr<IDWriteRenderingParams1> renderingParams;
+    DWrite_GetRenderParams(_sr.dwriteFactory.get(), &_r.gamma, &_r.cleartypeEnhancedContrast, &_r.grayscaleEnhancedContrast, renderingParams.addressof());
 
+    for (size_t atlasIndex = 0; atlasIndex < _r.atlases.size(); ++atlasIndex)
     {
-        D3D11_TEXTURE2D_DESC desc{};
-        desc.Width = _r.cellSize.x * newWidth;
-        desc.Height = _r.cellSize.y;
-        desc.MipLevels = 1;
-        desc.ArraySize = 1;
-        desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
-        desc.SampleDesc = { 1, 0 };
-        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-        THROW_IF_FAILED(_r.device->CreateTexture2D(&desc, nullptr, _r.atlasScratchpad.put()));
-    }
-    {
-        const auto surface = _r.atlasScratchpad.query<IDXGISurface>();
+        auto& atlas = _r.atlases[atlasIndex];
 
-        wil::com_ptr<IDWriteRenderingParams1> renderingParams;
-        DWrite_GetRenderParams(_sr.dwriteFactory.get(), &_r.gamma, &_r.cleartypeEnhancedContrast, &_r.grayscaleEnhancedContrast, renderingParams.addressof());
+        atlas.brush.reset();
+        atlas.d2dRenderTarget.reset();
+        atlas.scratchpad.reset();
 
-        D2D1_RENDER_TARGET_PROPERTIES props{};
-        props.type = D2D1_RENDER_TARGET_TYPE_DEFAULT;
-        props.pixelFormat = { DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED };
-        props.dpiX = static_cast<float>(_r.dpi);
-        props.dpiY = static_cast<float>(_r.dpi);
-        THROW_IF_FAILED(_sr.d2dFactory->CreateDxgiSurfaceRenderTarget(surface.get(), &props, _r.d2dRenderTarget.put()));
+        {
+            D3D11_TEXTURE2D_DESC desc{};
+            desc.Width = _r.cellSize.x * newWidth;
+            desc.Height = _r.cellSize.y * scratchpadSlots;
+            desc.MipLevels = 1;
+            desc.ArraySize = 1;
+            desc.Format = atlas.format;
+            desc.SampleDesc = { 1, 0 };
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+            THROW_IF_FAILED(_r.device->CreateTexture2D(&desc, nullptr, atlas.scratchpad.put()));
+        }
+        {
+            const auto surface = atlas.scratchpad.query<IDXGISurface>();
 
-        // We don't really use D2D for anything except DWrite, but it
-        // can't hurt to ensure that everything it does is pixel aligned.
-        _r.d2dRenderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
-        // In case _api.realizedAntialiasingMode is D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE we'll
-        // continuously adjust it in AtlasEngine::_drawGlyph. See _drawGlyph.
-        _r.d2dRenderTarget->SetTextAntialiasMode(static_cast<D2D1_TEXT_ANTIALIAS_MODE>(_api.realizedAntialiasingMode));
-        // Ensure that D2D uses the exact same gamma as our shader uses.
-        _r.d2dRenderTarget->SetTextRenderingParams(renderingParams.get());
-    }
-    {
-        static constexpr D2D1_COLOR_F color{ 1, 1, 1, 1 };
-        wil::com_ptr<ID2D1SolidColorBrush> brush;
-        THROW_IF_FAILED(_r.d2dRenderTarget->CreateSolidColorBrush(&color, nullptr, brush.addressof()));
-        _r.brush = brush.query<ID2D1Brush>();
+            D2D1_RENDER_TARGET_PROPERTIES props{};
+            props.type = D2D1_RENDER_TARGET_TYPE_DEFAULT;
+            props.pixelFormat = { atlas.format, D2D1_ALPHA_MODE_PREMULTIPLIED };
+            props.dpiX = static_cast<float>(_r.dpi);
+            props.dpiY = static_cast<float>(_r.dpi);
+            THROW_IF_FAILED(_sr.d2dFactory->CreateDxgiSurfaceRenderTarget(surface.get(), &props, atlas.d2dRenderTarget.put()));
+
+            // We don't really use D2D for anything except DWrite, but it
+            // can't hurt to ensure that everything it does is pixel aligned.
+            atlas.d2dRenderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+            // Colored glyphs cannot be drawn in linear gamma.
+            // That's why we're simply alpha-blending them in the shader.
+            // In order for this to work correctly we have to prevent them from being drawn
+            // with ClearType, because we would then lack the alpha channel for the glyphs.
+            const auto antialiasingMode = atlasIndex == colorAtlas ? D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE : static_cast<D2D1_TEXT_ANTIALIAS_MODE>(_api.realizedAntialiasingMode);
+            atlas.d2dRenderTarget->SetTextAntialiasMode(antialiasingMode);
+            // Ensure that D2D uses the exact same gamma as our shader uses.
+            atlas.d2dRenderTarget->SetTextRenderingParams(renderingParams.get());
+        }
+        {
+            static constexpr D2D1_COLOR_F color{ 1, 1, 1, 1 };
+            wil::com_ptr<ID2D1SolidColorBrush> brush;
+            THROW_IF_FAILED(atlas.d2dRenderTarget->CreateSolidColorBrush(&color, nullptr, brush.addressof()));
+            atlas.brush = brush.query<ID2D1Brush>();
+        }
     }
 
     _r.scratchpadCellWidth = _r.maxEncounteredCellCount;
@@ -297,64 +511,563 @@ void AtlasEngine::_processGlyphQueue()
         return;
     }
 
-    for (const auto& pair : _r.glyphQueue)
+    // Each atlas is drawn into with its own BeginDraw()/EndDraw(). Drawing colored glyphs
+    // last means that there's at most one batch per frame that needs both of them.
+    std::stable_partition(_r.glyphQueue.begin(), _r.glyphQueue.end(), [](const AtlasQueueItem& item) noexcept {
+        return WI_IsFlagClear(item.value->data()->flags, CellFlags::ColoredGlyph);
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto count = _r.glyphQueue.size();
+    size_t processed = 0;
+
+    while (processed < count)
     {
-        _drawGlyph(pair);
+        // Whatever doesn't fit into our time budget is drawn during the next frames.
+        // The glyphs show up empty until then. RequiresContinuousRedraw() ensures there's a next frame.
+        if (processed >= glyphQueueMinimumPerFrame && std::chrono::steady_clock::now() - start >= glyphQueueTimeBudget)
+        {
+            break;
+        }
+
+        const auto batch = std::min<size_t>(count - processed, scratchpadSlots);
+        _drawGlyphs(_r.glyphQueue.data() + processed, batch);
+        processed += batch;
     }
 
-    _r.glyphQueue.clear();
+    _r.glyphQueue.erase(_r.glyphQueue.begin(), _r.glyphQueue.begin() + processed);
 }
 
-void AtlasEngine::_drawGlyph(const AtlasQueueItem& item) const
+// Rasterizes up to scratchpadSlots glyphs, each into its own row of the scratchpad of its atlas.
+// The glyphs of each atlas are drawn in a single BeginDraw()/EndDraw() pair, because EndDraw() flushes
+// D2D's command queue to the GPU, which is by far the most expensive part of drawing a glyph.
+void AtlasEngine::_drawGlyphs(const AtlasQueueItem* items, size_t count)
 {
-    const auto key = item.key->data();
-    const auto value = item.value->data();
-    const auto coords = &value->coords[0];
-    const auto charsLength = key->charCount;
-    const auto cells = static_cast<u32>(key->attributes.cellCount);
-    const auto textFormat = _getTextFormat(key->attributes.bold, key->attributes.italic);
-    const auto coloredGlyph = WI_IsFlagSet(value->flags, CellFlags::ColoredGlyph);
+    std::array<std::array<const AtlasQueueItem*, scratchpadSlots>, 2> slots{};
+    std::array<u32, 2> slotCounts{};
 
-    // See D2DFactory::DrawText
-    wil::com_ptr<IDWriteTextLayout> textLayout;
-    THROW_IF_FAILED(_sr.dwriteFactory->CreateTextLayout(&key->chars[0], charsLength, textFormat, cells * _r.cellSizeDIP.x, _r.cellSizeDIP.y, textLayout.addressof()));
-    if (_r.typography)
+    for (size_t i = 0; i < count; ++i)
     {
-        textLayout->SetTypography(_r.typography.get(), { 0, charsLength });
-    }
+        const auto& item = items[i];
+        const auto atlasIndex = _atlasIndex(item.value->data()->flags);
 
-    auto options = D2D1_DRAW_TEXT_OPTIONS_NONE;
-    // D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT enables a bunch of internal machinery
-    // which doesn't have to run if we know we can't use it anyways in the shader.
-    WI_SetFlagIf(options, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT, coloredGlyph);
+        // Another engine (or the previous launch, see SharedGlyphCache::load()) might have already rasterized this glyph for us.
+        // A glyph from disk might belong into the other atlas though, if a font changed in between.
+        if (_r.glyphCache)
+        {
+            const auto cellCount = item.key->data()->attributes.cellCount;
+            const auto pixels = _r.glyphCache->find(*item.key);
+            if (!pixels.empty() && pixels.size() == size_t{ cellCount } * _r.cellSize.x * _r.cellSize.y * _bytesPerPixel(_r.atlases[atlasIndex].format))
+            {
+                _uploadGlyph(atlasIndex, pixels.data(), &item.value->data()->tiles[0], cellCount);
+                continue;
+            }
+        }
 
-    // Colored glyphs cannot be drawn in linear gamma.
-    // That's why we're simply alpha-blending them in the shader.
-    // In order for this to work correctly we have to prevent them from being drawn
-    // with ClearType, because we would then lack the alpha channel for the glyphs.
-    if (_api.realizedAntialiasingMode == D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE)
+        slots.at(atlasIndex).at(slotCounts[atlasIndex]++) = &item;
+    }
+
+    for (size_t atlasIndex = 0; atlasIndex < slots.size(); ++atlasIndex)
     {
-        _r.d2dRenderTarget->SetTextAntialiasMode(coloredGlyph ? D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE : D2D1_TEXT_ANTIALIAS_MODE_CLEARTYPE);
+        if (slotCounts[atlasIndex])
+        {
+            _drawGlyphsIntoAtlas(atlasIndex, slots[atlasIndex].data(), slotCounts[atlasIndex]);
+        }
     }
+}
 
-    _r.d2dRenderTarget->BeginDraw();
+void AtlasEngine::_drawGlyphsIntoAtlas(size_t atlasIndex, const AtlasQueueItem* const* slots, u32 slotCount)
+{
+    const auto& atlas = _r.atlases[atlasIndex];
+    const auto coloredGlyphs = atlasIndex == colorAtlas;
+
+    atlas.d2dRenderTarget->BeginDraw();
     // We could call
-    //   _r.d2dRenderTarget->PushAxisAlignedClip(&rect, D2D1_ANTIALIAS_MODE_ALIASED);
+    //   atlas.d2dRenderTarget->PushAxisAlignedClip(&rect, D2D1_ANTIALIAS_MODE_ALIASED);
     // now to reduce the surface that needs to be cleared, but this decreases
     // performance by 10% (tested using debugGlyphGenerationPerformance).
-    _r.d2dRenderTarget->Clear();
-    _r.d2dRenderTarget->DrawTextLayout({}, textLayout.get(), _r.brush.get(), options);
-    THROW_IF_FAILED(_r.d2dRenderTarget->EndDraw());
+    atlas.d2dRenderTarget->Clear();
+
+    for (u32 slot = 0; slot < slotCount; ++slot)
+    {
+        const auto key = slots[slot]->key->data();
+        const auto charsLength = key->charCount;
+        const auto cells = static_cast<u32>(key->attributes.cellCount);
+        const auto textFormat = _getTextFormat(key->attributes.bold, key->attributes.italic);
+
+        // See D2DFactory::DrawText
+        wil::com_ptr<IDWriteTextLayout> textLayout;
+        THROW_IF_FAILED(_sr.dwriteFactory->CreateTextLayout(&key->chars[0], charsLength, textFormat, cells * _r.cellSizeDIP.x, _r.cellSizeDIP.y, textLayout.addressof()));
+        if (_r.typography)
+        {
+            textLayout->SetTypography(_r.typography.get(), { 0, charsLength });
+        }
 
-    for (uint32_t i = 0; i < cells; ++i)
+        auto options = D2D1_DRAW_TEXT_OPTIONS_NONE;
+        // D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT enables a bunch of internal machinery
+        // which doesn't have to run if we know we can't use it anyways in the shader.
+        WI_SetFlagIf(options, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT, coloredGlyphs);
+
+        // Glyphs may overhang their cells, but mustn't bleed into the slots of their neighbors.
+        const auto top = static_cast<f32>(slot) * _r.cellSizeDIP.y;
+        const D2D1_RECT_F clip{ 0, top, static_cast<f32>(cells) * _r.cellSizeDIP.x, top + _r.cellSizeDIP.y };
+        atlas.d2dRenderTarget->PushAxisAlignedClip(&clip, D2D1_ANTIALIAS_MODE_ALIASED);
+        atlas.d2dRenderTarget->DrawTextLayout({ 0, top }, textLayout.get(), atlas.brush.get(), options);
+        atlas.d2dRenderTarget->PopAxisAlignedClip();
+    }
+
+    THROW_IF_FAILED(atlas.d2dRenderTarget->EndDraw());
+
+    for (u32 slot = 0; slot < slotCount; ++slot)
+    {
+        const auto& item = *slots[slot];
+        const auto tiles = &item.value->data()->tiles[0];
+        const auto cells = item.key->data()->attributes.cellCount;
+
+        for (u32 i = 0; i < cells; ++i)
+        {
+            // Specifying NO_OVERWRITE means that the system can assume that existing references to the surface that
+            // may be in flight on the GPU will not be affected by the update, so the copy can proceed immediately
+            // (avoiding either a batch flush or the system maintaining multiple copies of the resource behind the scenes).
+            //
+            // Since our shader only draws whatever is in the atlas, and since we don't replace glyph tiles that are in use,
+            // we can safely (?) tell the GPU that we don't overwrite parts of our atlas that are in use.
+            _copyScratchpadTile(atlasIndex, i, slot, _tilePosition(tiles[i]), D3D11_COPY_NO_OVERWRITE);
+        }
+
+        _queueGlyphReadback(atlasIndex, item.key, cells, slot);
+    }
+}
+
+// Rasterizes the most common glyphs into the glyph cache on a thread pool thread, as soon as a font was set.
+// New tabs and font size changes then find most of their glyphs in the cache instead of drawing them in their first frames.
+void AtlasEngine::_warmupGlyphCache(GlyphWarmup&& warmup)
+{
+    if (!warmup.glyphCache->tryBeginWarmup())
     {
-        // Specifying NO_OVERWRITE means that the system can assume that existing references to the surface that
-        // may be in flight on the GPU will not be affected by the update, so the copy can proceed immediately
-        // (avoiding either a batch flush or the system maintaining multiple copies of the resource behind the scenes).
-        //
-        // Since our shader only draws whatever is in the atlas, and since we don't replace glyph tiles that are in use,
-        // we can safely (?) tell the GPU that we don't overwrite parts of our atlas that are in use.
-        _copyScratchpadTile(i, coords[i], D3D11_COPY_NO_OVERWRITE);
+        return;
+    }
+
+    auto context = std::make_unique<GlyphWarmup>(std::move(warmup));
+    const auto callback = [](PTP_CALLBACK_INSTANCE, void* context) noexcept {
+        const std::unique_ptr<GlyphWarmup> warmup{ static_cast<GlyphWarmup*>(context) };
+        try
+        {
+            _rasterizeWarmupGlyphs(*warmup);
+        }
+        CATCH_LOG();
+    };
+
+    if (TrySubmitThreadpoolCallback(callback, context.get(), nullptr))
+    {
+        context.release();
+    }
+    else
+    {
+        LOG_LAST_ERROR();
+    }
+}
+
+// This draws the glyphs exactly like _drawGlyphs() does. It has its own D3D device and
+// D2D render target however, as neither of ours may be used outside of the render thread.
+// The glyphs are first loaded from the file that the previous launch saved. Only the ones that are
+// still missing are drawn, after which the file is updated with everything that's in the cache.
+void AtlasEngine::_rasterizeWarmupGlyphs(const GlyphWarmup& warmup)
+{
+    // Printable ASCII and the box drawing characters.
+    static constexpr std::array ranges{ std::pair<u32, u32>{ 0x20, 0x7e }, std::pair<u32, u32>{ 0x2500, 0x257f } };
+    static constexpr size_t glyphsPerRow = 16;
+
+    std::vector<u32> codepoints;
+    for (const auto& [first, last] : ranges)
+    {
+        for (auto ch = first; ch <= last; ++ch)
+        {
+            codepoints.emplace_back(ch);
+        }
+    }
+
+    wil::com_ptr<IDWriteRenderingParams1> renderingParams;
+    f32 gamma = 0, cleartypeEnhancedContrast = 0, grayscaleEnhancedContrast = 0;
+    DWrite_GetRenderParams(warmup.dwriteFactory.get(), &gamma, &cleartypeEnhancedContrast, &grayscaleEnhancedContrast, renderingParams.addressof());
+
+    // The signature of the cache only describes the font by its name, which is enough within a process.
+    // Across launches the font files might have been updated and the system-wide rendering parameters changed.
+    auto fileKey = warmup.glyphCache->signature();
+    const auto append = [&](const auto& value) {
+        static_assert(sizeof(value) % sizeof(wchar_t) == 0);
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+        fileKey.append(reinterpret_cast<const wchar_t*>(&value), sizeof(value) / sizeof(wchar_t));
+    };
+    append(gamma);
+    append(cleartypeEnhancedContrast);
+    append(grayscaleEnhancedContrast);
+
+    // Regular, bold and italic. See AtlasKeyAttributes.
+    static constexpr std::array faces{ std::pair{ false, false }, std::pair{ true, false }, std::pair{ false, true } };
+    // The characters of each face that the font itself contains.
+    std::array<std::vector<wchar_t>, faces.size()> candidates;
+    std::vector<u16> glyphIndices(codepoints.size());
+
+    for (size_t face = 0; face < faces.size(); ++face)
+    {
+        const auto& [bold, italic] = faces[face];
+        const auto& textFormat = warmup.textFormats[italic][bold];
+
+        // Characters that fall back to other fonts might be drawn differently by _drawGlyphs(),
+        // for instance if that's a color font. Only the ones the font itself contains are drawn.
+        wil::com_ptr<IDWriteFontCollection> fontCollection;
+        THROW_IF_FAILED(textFormat->GetFontCollection(fontCollection.addressof()));
+        std::wstring familyName(textFormat->GetFontFamilyNameLength() + 1, L'\0');
+        THROW_IF_FAILED(textFormat->GetFontFamilyName(familyName.data(), gsl::narrow_cast<u32>(familyName.size())));
+        u32 familyIndex = 0;
+        BOOL familyExists = FALSE;
+        THROW_IF_FAILED(fontCollection->FindFamilyName(familyName.c_str(), &familyIndex, &familyExists));
+        if (!familyExists)
+        {
+            continue;
+        }
+        wil::com_ptr<IDWriteFontFamily> fontFamily;
+        THROW_IF_FAILED(fontCollection->GetFontFamily(familyIndex, fontFamily.addressof()));
+        wil::com_ptr<IDWriteFont> font;
+        THROW_IF_FAILED(fontFamily->GetFirstMatchingFont(textFormat->GetFontWeight(), textFormat->GetFontStretch(), textFormat->GetFontStyle(), font.addressof()));
+        wil::com_ptr<IDWriteFontFace> fontFace;
+        THROW_IF_FAILED(font->CreateFontFace(fontFace.addressof()));
+        if (const auto fontFace2 = fontFace.try_query<IDWriteFontFace2>(); fontFace2 && fontFace2->IsColorFont())
+        {
+            continue;
+        }
+        _appendFontFileIdentity(fileKey, fontFace.get());
+        THROW_IF_FAILED(fontFace->GetGlyphIndicesW(codepoints.data(), gsl::narrow_cast<u32>(codepoints.size()), glyphIndices.data()));
+
+        for (size_t i = 0; i < codepoints.size(); ++i)
+        {
+            if (glyphIndices[i])
+            {
+                candidates[face].emplace_back(static_cast<wchar_t>(codepoints[i]));
+            }
+        }
+    }
+
+    std::filesystem::path path;
+    try
+    {
+        path = _glyphCacheFilePath(fileKey);
+        warmup.glyphCache->load(path, fileKey);
+    }
+    CATCH_LOG();
+
+    // The characters of each face that are still missing.
+    std::array<std::vector<wchar_t>, faces.size()> missing;
+    auto missingAny = false;
+    for (size_t face = 0; face < faces.size(); ++face)
+    {
+        const auto& [bold, italic] = faces[face];
+        for (const auto ch : candidates[face])
+        {
+            if (warmup.glyphCache->find(AtlasKey{ { 0, bold, italic, 1 }, 1, &ch }).empty())
+            {
+                missing[face].emplace_back(ch);
+                missingAny = true;
+            }
+        }
+    }
+
+    // Creating a D3D device takes longer than loading the file, which is why it's skipped if possible.
+    if (!missingAny)
+    {
+        return;
+    }
+
+    wil::com_ptr<ID3D11Device> device;
+    wil::com_ptr<ID3D11DeviceContext> deviceContext;
+    {
+        static constexpr std::array driverTypes{ D3D_DRIVER_TYPE_HARDWARE, D3D_DRIVER_TYPE_WARP };
+        HRESULT hr = S_OK;
+        for (const auto driverType : driverTypes)
+        {
+            hr = D3D11CreateDevice(nullptr, driverType, nullptr, D3D11_CREATE_DEVICE_SINGLETHREADED | D3D11_CREATE_DEVICE_BGRA_SUPPORT, nullptr, 0, D3D11_SDK_VERSION, device.put(), nullptr, deviceContext.put());
+            if (SUCCEEDED(hr))
+            {
+                break;
+            }
+        }
+        THROW_IF_FAILED(hr);
+    }
+
+    wil::com_ptr<ID2D1Factory> d2dFactory;
+    THROW_IF_FAILED(D2D1CreateFactory(D2D1_FACTORY_TYPE_SINGLE_THREADED, d2dFactory.addressof()));
+
+    // Only glyphs of fonts without colors are drawn, which all belong into the text atlas.
+    const auto format = _textAtlasFormat(warmup.antialiasingMode);
+    const size_t bytesPerPixel = _bytesPerPixel(format);
+    const size_t cellX = warmup.cellSize.x;
+    const size_t cellY = warmup.cellSize.y;
+    const auto rows = (codepoints.size() + glyphsPerRow - 1) / glyphsPerRow;
+
+    D3D11_TEXTURE2D_DESC desc{};
+    desc.Width = gsl::narrow<UINT>(cellX * glyphsPerRow);
+    desc.Height = gsl::narrow<UINT>(cellY * rows);
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = format;
+    desc.SampleDesc = { 1, 0 };
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+    wil::com_ptr<ID3D11Texture2D> texture;
+    THROW_IF_FAILED(device->CreateTexture2D(&desc, nullptr, texture.addressof()));
+
+    desc.BindFlags = 0;
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    wil::com_ptr<ID3D11Texture2D> staging;
+    THROW_IF_FAILED(device->CreateTexture2D(&desc, nullptr, staging.addressof()));
+
+    D2D1_RENDER_TARGET_PROPERTIES props{};
+    props.type = D2D1_RENDER_TARGET_TYPE_DEFAULT;
+    props.pixelFormat = { format, D2D1_ALPHA_MODE_PREMULTIPLIED };
+    props.dpiX = static_cast<float>(warmup.dpi);
+    props.dpiY = static_cast<float>(warmup.dpi);
+    wil::com_ptr<ID2D1RenderTarget> renderTarget;
+    THROW_IF_FAILED(d2dFactory->CreateDxgiSurfaceRenderTarget(texture.query<IDXGISurface>().get(), &props, renderTarget.addressof()));
+    renderTarget->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+    renderTarget->SetTextAntialiasMode(static_cast<D2D1_TEXT_ANTIALIAS_MODE>(warmup.antialiasingMode));
+    renderTarget->SetTextRenderingParams(renderingParams.get());
+
+    static constexpr D2D1_COLOR_F color{ 1, 1, 1, 1 };
+    wil::com_ptr<ID2D1SolidColorBrush> brush;
+    THROW_IF_FAILED(renderTarget->CreateSolidColorBrush(&color, nullptr, brush.addressof()));
+
+    for (size_t face = 0; face < faces.size(); ++face)
+    {
+        const auto& [bold, italic] = faces[face];
+        const auto& textFormat = warmup.textFormats[italic][bold];
+        const auto& drawn = missing[face];
+
+        if (drawn.empty())
+        {
+            continue;
+        }
+
+        renderTarget->BeginDraw();
+        renderTarget->Clear();
+
+        for (size_t slot = 0; slot < drawn.size(); ++slot)
+        {
+            wil::com_ptr<IDWriteTextLayout> textLayout;
+            THROW_IF_FAILED(warmup.dwriteFactory->CreateTextLayout(&drawn[slot], 1, textFormat.get(), warmup.cellSizeDIP.x, warmup.cellSizeDIP.y, textLayout.addressof()));
+            if (warmup.typography)
+            {
+                textLayout->SetTypography(warmup.typography.get(), { 0, 1 });
+            }
+
+            const auto left = static_cast<f32>(slot % glyphsPerRow) * warmup.cellSizeDIP.x;
+            const auto top = static_cast<f32>(slot / glyphsPerRow) * warmup.cellSizeDIP.y;
+            const D2D1_RECT_F clip{ left, top, left + warmup.cellSizeDIP.x, top + warmup.cellSizeDIP.y };
+            renderTarget->PushAxisAlignedClip(&clip, D2D1_ANTIALIAS_MODE_ALIASED);
+            renderTarget->DrawTextLayout({ left, top }, textLayout.get(), brush.get(), D2D1_DRAW_TEXT_OPTIONS_NONE);
+            renderTarget->PopAxisAlignedClip();
+        }
+
+        THROW_IF_FAILED(renderTarget->EndDraw());
+
+        // Unlike the render thread we can simply wait for the GPU here.
+        deviceContext->CopyResource(staging.get(), texture.get());
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        THROW_IF_FAILED(deviceContext->Map(staging.get(), 0, D3D11_MAP_READ, 0, &mapped));
+        const auto unmap = wil::scope_exit([&]() noexcept {
+            deviceContext->Unmap(staging.get(), 0);
+        });
+
+        for (size_t slot = 0; slot < drawn.size(); ++slot)
+        {
+            const auto x = slot % glyphsPerRow * cellX;
+            const auto y = slot / glyphsPerRow * cellY;
+            const auto rowSize = cellX * bytesPerPixel;
+            Buffer<u8> pixels{ rowSize * cellY };
+            for (size_t row = 0; row < cellY; ++row)
+            {
+                const auto src = static_cast<const u8*>(mapped.pData) + (y + row) * mapped.RowPitch + x * bytesPerPixel;
+                memcpy(pixels.data() + row * rowSize, src, rowSize);
+            }
+            warmup.glyphCache->insert(AtlasKey{ { 0, bold, italic, 1 }, 1, &drawn[slot] }, std::move(pixels));
+        }
+    }
+
+    if (!path.empty())
+    {
+        warmup.glyphCache->save(path, fileKey);
+    }
+}
+
+// Appends what identifies the files of the given font face across launches: the path and the
+// time of the last change of a local font file. Fonts from other loaders, like the ones that are
+// part of a package, are identified by their reference key, which is all DirectWrite offers.
+void AtlasEngine::_appendFontFileIdentity(std::wstring& fileKey, IDWriteFontFace* fontFace)
+{
+    u32 fileCount = 0;
+    THROW_IF_FAILED(fontFace->GetFiles(&fileCount, nullptr));
+    std::vector<wil::com_ptr<IDWriteFontFile>> files(fileCount);
+    // wil::com_ptr has the same layout as the raw pointer it holds.
+    static_assert(sizeof(wil::com_ptr<IDWriteFontFile>) == sizeof(IDWriteFontFile*));
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    THROW_IF_FAILED(fontFace->GetFiles(&fileCount, reinterpret_cast<IDWriteFontFile**>(files.data())));
+
+    fileKey.push_back(L'\0');
+    for (const auto& file : files)
+    {
+        const void* referenceKey = nullptr;
+        u32 referenceKeySize = 0;
+        THROW_IF_FAILED(file->GetReferenceKey(&referenceKey, &referenceKeySize));
+        wil::com_ptr<IDWriteFontFileLoader> loader;
+        THROW_IF_FAILED(file->GetLoader(loader.addressof()));
+
+        if (const auto localLoader = loader.try_query<IDWriteLocalFontFileLoader>())
+        {
+            u32 pathLength = 0;
+            THROW_IF_FAILED(localLoader->GetFilePathLengthFromKey(referenceKey, referenceKeySize, &pathLength));
+            std::wstring filePath(pathLength + 1, L'\0');
+            THROW_IF_FAILED(localLoader->GetFilePathFromKey(referenceKey, referenceKeySize, filePath.data(), pathLength + 1));
+            FILETIME lastWriteTime{};
+            THROW_IF_FAILED(localLoader->GetLastWriteTimeFromKey(referenceKey, referenceKeySize, &lastWriteTime));
+
+            fileKey.append(filePath);
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+            fileKey.append(reinterpret_cast<const wchar_t*>(&lastWriteTime), sizeof(lastWriteTime) / sizeof(wchar_t));
+        }
+        else
+        {
+            const auto offset = fileKey.size();
+            fileKey.resize(offset + (referenceKeySize + 1) / sizeof(wchar_t) + 1);
+            memcpy(fileKey.data() + offset, referenceKey, referenceKeySize);
+        }
+    }
+
+    const auto index = fontFace->GetIndex();
+    const auto simulations = static_cast<u32>(fontFace->GetSimulations());
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    fileKey.append(reinterpret_cast<const wchar_t*>(&index), sizeof(index) / sizeof(wchar_t));
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    fileKey.append(reinterpret_cast<const wchar_t*>(&simulations), sizeof(simulations) / sizeof(wchar_t));
+}
+
+// The glyph caches are kept in the temporary directory, as they can be thrown away at any time.
+// The name of a file is the hash of its fileKey. Collisions are harmless, because the file
+// contains the whole fileKey, which SharedGlyphCache::load() compares with the expected one.
+std::filesystem::path AtlasEngine::_glyphCacheFilePath(const std::wstring& fileKey)
+{
+    auto directory = std::filesystem::temp_directory_path() / L"AtlasEngine";
+    if (!CreateDirectoryW(directory.c_str(), nullptr))
+    {
+        THROW_LAST_ERROR_IF(GetLastError() != ERROR_ALREADY_EXISTS);
+    }
+
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    const auto hash = std::_Fnv1a_append_bytes(std::_FNV_offset_basis, reinterpret_cast<const u8*>(fileKey.data()), fileKey.size() * sizeof(wchar_t));
+    wchar_t name[32];
+    swprintf_s(name, L"glyphs_%016llx.bin", static_cast<unsigned long long>(hash));
+    return directory / name;
+}
+
+void AtlasEngine::_uploadGlyph(size_t atlasIndex, const u8* pixels, const u16* tiles, u32 cellCount) const noexcept
+{
+    const auto& atlas = _r.atlases[atlasIndex];
+    const size_t tileRowSize = _r.cellSize.x * _bytesPerPixel(atlas.format);
+    const auto rowPitch = cellCount * tileRowSize;
+
+    for (u32 i = 0; i < cellCount; ++i)
+    {
+        const auto position = _tilePosition(tiles[i]);
+        D3D11_BOX box;
+        box.left = position.x;
+        box.top = position.y;
+        box.front = 0;
+        box.right = box.left + _r.cellSize.x;
+        box.bottom = box.top + _r.cellSize.y;
+        box.back = 1;
+#pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function '...' which may throw exceptions (f.6).
+        _r.deviceContext->UpdateSubresource(atlas.buffer.get(), 0, &box, pixels + i * tileRowSize, gsl::narrow_cast<UINT>(rowPitch), 0);
+    }
+}
+
+// Copies the glyph that was just rasterized into the given slot of the scratchpad into a staging texture.
+// It's only read back by _flushGlyphReadback() during the next frame, once the GPU is done,
+// because mapping it right away would stall us until the GPU caught up with us.
+// Glyphs that don't fit into the staging texture simply aren't shared.
+void AtlasEngine::_queueGlyphReadback(size_t atlasIndex, const AtlasKey* key, u16 cellCount, u32 scratchpadSlot)
+{
+    auto& atlas = _r.atlases[atlasIndex];
+
+    if (!_r.glyphCache || atlas.glyphReadbackUsed + cellCount > _r.glyphReadbackCapacity)
+    {
+        return;
+    }
+
+    if (!atlas.glyphReadback)
+    {
+        D3D11_TEXTURE2D_DESC desc{};
+        desc.Width = _r.cellSize.x * _r.glyphReadbackCapacity;
+        desc.Height = _r.cellSize.y;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = atlas.format;
+        desc.SampleDesc = { 1, 0 };
+        desc.Usage = D3D11_USAGE_STAGING;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+        THROW_IF_FAILED(_r.device->CreateTexture2D(&desc, nullptr, atlas.glyphReadback.put()));
+    }
+
+    D3D11_BOX box;
+    box.left = 0;
+    box.top = scratchpadSlot * _r.cellSize.y;
+    box.front = 0;
+    box.right = cellCount * _r.cellSize.x;
+    box.bottom = box.top + _r.cellSize.y;
+    box.back = 1;
+    _r.deviceContext->CopySubresourceRegion(atlas.glyphReadback.get(), 0, atlas.glyphReadbackUsed * _r.cellSize.x, 0, 0, atlas.scratchpad.get(), 0, &box);
+
+    atlas.glyphReadbackQueue.emplace_back(GlyphReadbackItem{ key, atlas.glyphReadbackUsed, cellCount });
+    atlas.glyphReadbackUsed += cellCount;
+}
+
+void AtlasEngine::_flushGlyphReadback()
+{
+    for (auto& atlas : _r.atlases)
+    {
+        if (atlas.glyphReadbackQueue.empty())
+        {
+            continue;
+        }
+
+#pragma warning(suppress : 26494) // Variable 'mapped' is uninitialized. Always initialize an object (type.5).
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        const auto hr = _r.deviceContext->Map(atlas.glyphReadback.get(), 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped);
+        if (hr == DXGI_ERROR_WAS_STILL_DRAWING)
+        {
+            continue;
+        }
+        THROW_IF_FAILED(hr);
+
+        const auto unmap = wil::scope_exit([&]() noexcept {
+            _r.deviceContext->Unmap(atlas.glyphReadback.get(), 0);
+        });
+
+        const size_t tileRowSize = _r.cellSize.x * _bytesPerPixel(atlas.format);
+        const size_t cellHeight = _r.cellSize.y;
+
+        for (const auto& item : atlas.glyphReadbackQueue)
+        {
+            const auto rowSize = item.cellCount * tileRowSize;
+            Buffer<u8> pixels{ rowSize * cellHeight };
+            for (size_t y = 0; y < cellHeight; ++y)
+            {
+                const auto src = static_cast<const u8*>(mapped.pData) + y * mapped.RowPitch + item.offset * tileRowSize;
+                memcpy(pixels.data() + y * rowSize, src, rowSize);
+            }
+            _r.glyphCache->insert(*item.key, std::move(pixels));
+        }
+
+        atlas.glyphReadbackQueue.clear();
+        atlas.glyphReadbackUsed = 0;
     }
 }
 
@@ -400,39 +1113,41 @@ void AtlasEngine::_drawCursor()
         break;
     }
 
-    _r.d2dRenderTarget->BeginDraw();
-    _r.d2dRenderTarget->Clear();
+    const auto& atlas = _r.atlases[textAtlas];
+    atlas.d2dRenderTarget->BeginDraw();
+    atlas.d2dRenderTarget->Clear();
 
     if (cursorType == CursorType::EmptyBox)
     {
-        _r.d2dRenderTarget->DrawRectangle(&rect, _r.brush.get(), lineWidth);
+        atlas.d2dRenderTarget->DrawRectangle(&rect, atlas.brush.get(), lineWidth);
     }
     else
     {
-        _r.d2dRenderTarget->FillRectangle(&rect, _r.brush.get());
+        atlas.d2dRenderTarget->FillRectangle(&rect, atlas.brush.get());
     }
 
     if (cursorType == CursorType::DoubleUnderscore)
     {
         rect.top -= 2.0f;
         rect.bottom -= 2.0f;
-        _r.d2dRenderTarget->FillRectangle(&rect, _r.brush.get());
+        atlas.d2dRenderTarget->FillRectangle(&rect, atlas.brush.get());
     }
 
-    THROW_IF_FAILED(_r.d2dRenderTarget->EndDraw());
+    THROW_IF_FAILED(atlas.d2dRenderTarget->EndDraw());
 
-    _copyScratchpadTile(0, {});
+    _copyScratchpadTile(textAtlas, 0, 0, {});
 }
 
-void AtlasEngine::_copyScratchpadTile(uint32_t scratchpadIndex, u16x2 target, uint32_t copyFlags) const noexcept
+void AtlasEngine::_copyScratchpadTile(size_t atlasIndex, uint32_t scratchpadIndex, uint32_t scratchpadSlot, u16x2 target, uint32_t copyFlags) const noexcept
 {
+    const auto& atlas = _r.atlases[atlasIndex];
     D3D11_BOX box;
     box.left = scratchpadIndex * _r.cellSize.x;
-    box.top = 0;
+    box.top = scratchpadSlot * _r.cellSize.y;
     box.front = 0;
     box.right = box.left + _r.cellSize.x;
-    box.bottom = _r.cellSize.y;
+    box.bottom = box.top + _r.cellSize.y;
     box.back = 1;
 #pragma warning(suppress : 26447) // The function is declared 'noexcept' but calls function '...' which may throw exceptions (f.6).
-    _r.deviceContext->CopySubresourceRegion1(_r.atlasBuffer.get(), 0, target.x, target.y, 0, _r.atlasScratchpad.get(), 0, &box, copyFlags);
+    _r.deviceContext->CopySubresourceRegion1(atlas.buffer.get(), 0, target.x, target.y, 0, atlas.scratchpad.get(), 0, &box, copyFlags);
 }
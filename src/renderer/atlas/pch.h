@@ -7,9 +7,13 @@
 #define WIN32_LEAN_AND_MEAN
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
+#include <mutex>
 #include <optional>
 #include <sstream>
+#include <shared_mutex>
 #include <string_view>
 #include <thread>
 #include <unordered_map>
@@ -30,6 +34,7 @@
 #include <gsl/span>
 #include <wil/com.h>
 #include <wil/filesystem.h>
+#include <wil/resource.h>
 #include <wil/result_macros.h>
 #include <wil/stl.h>
 #include <wil/win32_helpers.h>
@@ -50,3 +55,4 @@
 
 #include <til.h>
 #include <til/bit.h>
+#include <til/hash.h>
@@ -12,9 +12,10 @@
 #define CellFlags_Inlined         0x00000001
 
 #define CellFlags_ColoredGlyph    0x00000002
+#define CellFlags_NoGlyph         0x00000004
 
-#define CellFlags_Cursor          0x00000008
-#define CellFlags_Selected        0x00000010
+// A LineRendition shifted left by 3, see below.
+#define CellFlags_LineRendition   0x00000018
 
 #define CellFlags_BorderLeft      0x00000020
 #define CellFlags_BorderTop       0x00000040
@@ -24,16 +25,21 @@
 #define CellFlags_UnderlineDotted 0x00000400
 #define CellFlags_UnderlineDouble 0x00000800
 #define CellFlags_Strikethrough   0x00001000
+
+// These are shared with the LineRendition enum.
+#define LineRendition_SingleWidth        0
+#define LineRendition_DoubleWidth        1
+#define LineRendition_DoubleHeightTop    2
+#define LineRendition_DoubleHeightBottom 3
 // clang-format on
 
 // According to Nvidia's "Understanding Structured Buffer Performance" guide
-// one should aim for structures with sizes divisible by 128 bits (16 bytes).
+// one should aim for structures with sizes that divide 128 bits (16 bytes).
 // This prevents elements from spanning cache lines.
 struct Cell
 {
-    uint glyphPos;
-    uint flags;
-    uint2 color; // x: foreground, y: background
+    uint tileIndexAndFlags; // low: index of the atlas tile, high: CellFlags
+    uint colorIndices; // indices into the palette, low: foreground, high: background
 };
 
 cbuffer ConstBuffer : register(b0)
@@ -49,9 +55,18 @@ cbuffer ConstBuffer : register(b0)
     uint cursorColor;
     uint selectionColor;
     uint useClearType;
+    uint atlasTilesPerRow;
+    uint4 cursorRect; // left, top, right, bottom in cells
+    uint scrollOffsetY; // in pixels, for smooth scrolling
 };
 StructuredBuffer<Cell> cells : register(t0);
+// The text atlas is A8 (just the coverage in .a), unless it holds ClearType glyphs (the coverage of each subpixel in .rgb).
 Texture2D<float4> glyphs : register(t1);
+StructuredBuffer<uint> palette : register(t2);
+// The range of columns of each row that's selected, low: left, high: right (exclusive).
+StructuredBuffer<uint> selection : register(t3);
+// The tiles of cells with CellFlags_ColoredGlyph are in this atlas instead, as premultiplied BGRA.
+Texture2D<float4> colorGlyphs : register(t4);
 
 float4 decodeRGBA(uint i)
 {
@@ -89,63 +104,100 @@ float4 main(float4 pos: SV_Position): SV_Target
     // for instance run your new code and compare it with the old.
 
     uint2 viewportPos = pos.xy - viewport.xy;
+    // While smooth scrolling, the rows are shifted up and the one below the viewport becomes partially visible.
+    viewportPos.y += scrollOffsetY;
     uint2 cellIndex = viewportPos / cellSize;
     uint2 cellPos = viewportPos % cellSize;
-    Cell cell = cells[cellIndex.y * cellCountX + cellIndex.x];
+    // The cursor and the selection are overlays, which aren't stored in the cells.
+    // That way a blinking cursor or a changing selection only has to update a few constants.
+    // The selection is given in the columns of the screen, unlike anything else (see below).
+    uint2 selectionRange = decodeU16x2(selection[cellIndex.y]);
+    bool isSelected = cellIndex.x >= selectionRange.x && cellIndex.x < selectionRange.y;
+
+    // Rows with a line rendition hold regular-size glyphs in the first half of their cells,
+    // which are scaled up here: every pixel of a glyph covers 2 (or 2x2) pixels on the screen.
+    // The cursor is never drawn at double height, just like in the other renderers.
+    uint rowStart = cellIndex.y * cellCountX;
+    uint lineRendition = (decodeU16x2(cells[rowStart].tileIndexAndFlags).y & CellFlags_LineRendition) >> 3;
+    uint2 cursorPos = cellPos;
+    [branch] if (lineRendition != LineRendition_SingleWidth)
+    {
+        viewportPos.x /= 2;
+        cellIndex.x = viewportPos.x / cellSize.x;
+        cellPos.x = viewportPos.x % cellSize.x;
+        cursorPos.x = cellPos.x;
+        if (lineRendition != LineRendition_DoubleWidth)
+        {
+            cellPos.y = (cellPos.y + (lineRendition == LineRendition_DoubleHeightBottom ? cellSize.y : 0)) / 2;
+        }
+    }
+
+    Cell cell = cells[rowStart + cellIndex.x];
+    uint2 tileIndexAndFlags = decodeU16x2(cell.tileIndexAndFlags);
+    uint2 colorIndices = decodeU16x2(cell.colorIndices);
+    uint flags = tileIndexAndFlags.y;
+    bool isCursor = all(cellIndex >= cursorRect.xy) && all(cellIndex < cursorRect.zw);
 
     // Layer 0:
     // The cell's background color
-    float4 color = decodeRGBA(cell.color.y);
-    float4 fg = decodeRGBA(cell.color.x);
+    float4 color = decodeRGBA(palette[colorIndices.y]);
+    float4 fg = decodeRGBA(palette[colorIndices.x]);
 
     // Layer 1 (optional):
     // Colored cursors are drawn "in between" the background color and the text of a cell.
-    if ((cell.flags & CellFlags_Cursor) && cursorColor != INVALID_COLOR)
+    if (isCursor && cursorColor != INVALID_COLOR)
     {
         // The cursor texture is stored at the top-left-most glyph cell.
         // Cursor pixels are either entirely transparent or opaque.
         // --> We can just use .a as a mask to flip cursor pixels on or off.
-        color = alphaBlendPremultiplied(color, decodeRGBA(cursorColor) * glyphs[cellPos].a);
+        color = alphaBlendPremultiplied(color, decodeRGBA(cursorColor) * glyphs[cursorPos].a);
     }
 
     // Layer 2:
     // Step 1: Underlines
-    if ((cell.flags & CellFlags_Underline) && cellPos.y >= underlinePos.x && cellPos.y < underlinePos.y)
+    if ((flags & CellFlags_Underline) && cellPos.y >= underlinePos.x && cellPos.y < underlinePos.y)
     {
         color = alphaBlendPremultiplied(color, fg);
     }
-    if ((cell.flags & CellFlags_UnderlineDotted) && cellPos.y >= underlinePos.x && cellPos.y < underlinePos.y && (viewportPos.x / (underlinePos.y - underlinePos.x) & 3) == 0)
+    if ((flags & CellFlags_UnderlineDotted) && cellPos.y >= underlinePos.x && cellPos.y < underlinePos.y && (viewportPos.x / (underlinePos.y - underlinePos.x) & 3) == 0)
     {
         color = alphaBlendPremultiplied(color, fg);
     }
     // Step 2: The cell's glyph, potentially drawn in the foreground color
+    // Whitespace doesn't have one, which saves us from sampling the atlas for most of the screen.
+    [branch] if (!(flags & CellFlags_NoGlyph))
     {
-        float4 glyph = glyphs[decodeU16x2(cell.glyphPos) + cellPos];
+        uint2 tilePos = uint2(tileIndexAndFlags.x % atlasTilesPerRow, tileIndexAndFlags.x / atlasTilesPerRow) * cellSize;
 
-        if (cell.flags & CellFlags_ColoredGlyph)
-        {
-            color = alphaBlendPremultiplied(color, glyph);
-        }
-        else if (useClearType)
+        [branch] if (flags & CellFlags_ColoredGlyph)
         {
-            color = DWrite_CleartypeBlend(gammaRatios, enhancedContrast, false, color, fg, glyph);
+            color = alphaBlendPremultiplied(color, colorGlyphs[tilePos + cellPos]);
         }
         else
         {
-            color = alphaBlendPremultiplied(color, DWrite_GrayscaleBlend(gammaRatios, enhancedContrast, false, fg, glyph.a));
+            float4 glyph = glyphs[tilePos + cellPos];
+
+            if (useClearType)
+            {
+                color = DWrite_CleartypeBlend(gammaRatios, enhancedContrast, false, color, fg, glyph);
+            }
+            else
+            {
+                color = alphaBlendPremultiplied(color, DWrite_GrayscaleBlend(gammaRatios, enhancedContrast, false, fg, glyph.a));
+            }
         }
     }
     // Step 3: Lines, but not "under"lines
-    if ((cell.flags & CellFlags_Strikethrough) && cellPos.y >= strikethroughPos.x && cellPos.y < strikethroughPos.y)
+    if ((flags & CellFlags_Strikethrough) && cellPos.y >= strikethroughPos.x && cellPos.y < strikethroughPos.y)
     {
         color = alphaBlendPremultiplied(color, fg);
     }
 
     // Layer 3 (optional):
     // Uncolored cursors are used as a mask that inverts the cells color.
-    [branch] if (cell.flags & CellFlags_Cursor)
+    [branch] if (isCursor)
     {
-        [flatten] if (cursorColor == INVALID_COLOR && glyphs[cellPos].a != 0)
+        [flatten] if (cursorColor == INVALID_COLOR && glyphs[cursorPos].a != 0)
         {
             color = float4(1 - color.rgb, 1);
         }
@@ -153,7 +205,7 @@ float4 main(float4 pos: SV_Position): SV_Target
 
     // Layer 4:
     // The current selection is drawn semi-transparent on top.
-    if (cell.flags & CellFlags_Selected)
+    if (isSelected)
     {
         color = alphaBlendPremultiplied(color, decodeRGBA(selectionColor));
     }
@@ -87,22 +87,48 @@ FontResource::FontResource(const gsl::span<const uint16_t> bitPattern,
 {
 }
 
+// Routine Description:
+// - Checks whether this font was constructed from the given pattern, in which
+//   case there's no need to replace it (along with the fonts cached for it).
+// Arguments:
+// - bitPattern - An array of scanlines representing all the glyphs in the font.
+// - sourceSize - The cell size for an individual glyph.
+// - centeringHint - The horizontal extent that glyphs are offset from center.
+// Return Value:
+// - true if the pattern and its attributes are the same.
+bool FontResource::HasPattern(const gsl::span<const uint16_t> bitPattern,
+                              const til::size sourceSize,
+                              const size_t centeringHint) const noexcept
+{
+    return _sourceSize == sourceSize &&
+           _centeringHint == centeringHint &&
+           std::equal(_bitPattern.begin(), _bitPattern.end(), bitPattern.begin(), bitPattern.end());
+}
+
 void FontResource::SetTargetSize(const til::size targetSize)
 {
-    if (_targetSize != targetSize)
-    {
-        _targetSize = targetSize;
-        _fontHandle = nullptr;
-    }
+    _targetSize = targetSize;
 }
 
 FontResource::operator HFONT()
 {
-    if (!_fontHandle && !_bitPattern.empty())
+    if (_bitPattern.empty())
+    {
+        return nullptr;
+    }
+
+    const auto it = std::find_if(_scaledFonts.begin(), _scaledFonts.end(), [&](const auto& font) {
+        return font.targetSize == _targetSize;
+    });
+    if (it != _scaledFonts.end())
+    {
+        std::rotate(_scaledFonts.begin(), it, it + 1);
+    }
+    else
     {
         _regenerateFont();
     }
-    return _fontHandle.get();
+    return _scaledFonts.front().fontHandle.get();
 }
 
 void FontResource::_regenerateFont()
@@ -152,9 +178,12 @@ void FontResource::_regenerateFont()
     auto fontResourceSpan = gsl::span<byte>(fontResourceBuffer);
     _resizeBitPattern(fontResourceSpan.subspan(fontResource.dfBitsOffset));
 
+    ScaledFont scaledFont;
+    scaledFont.targetSize = _targetSize;
+
     DWORD fontCount = 0;
-    _resourceHandle.reset(AddFontMemResourceEx(&fontResource, fontResourceSize, nullptr, &fontCount));
-    LOG_HR_IF_NULL(E_FAIL, _resourceHandle.get());
+    scaledFont.resourceHandle.reset(AddFontMemResourceEx(&fontResource, fontResourceSize, nullptr, &fontCount));
+    LOG_HR_IF_NULL(E_FAIL, scaledFont.resourceHandle.get());
 
     // Once the resource has been registered, we should be able to create the
     // font by using the same name and attributes as were set in the resource.
@@ -165,8 +194,16 @@ void FontResource::_regenerateFont()
     logFont.lfOutPrecision = OUT_RASTER_PRECIS;
     logFont.lfPitchAndFamily = fontResource.dfPitchAndFamily;
     strcpy_s(logFont.lfFaceName, fontResource.szFaceName);
-    _fontHandle.reset(CreateFontIndirectA(&logFont));
-    LOG_HR_IF_NULL(E_FAIL, _fontHandle.get());
+    scaledFont.fontHandle.reset(CreateFontIndirectA(&logFont));
+    LOG_HR_IF_NULL(E_FAIL, scaledFont.fontHandle.get());
+
+    // The least recently used font is evicted to make room. Callers must only
+    // request a font while none of the ones returned earlier are selected.
+    if (_scaledFonts.size() >= MAX_SCALED_FONTS)
+    {
+        _scaledFonts.pop_back();
+    }
+    _scaledFonts.insert(_scaledFonts.begin(), std::move(scaledFont));
 }
 
 void FontResource::_resizeBitPattern(gsl::span<byte> targetBuffer)
@@ -72,8 +72,15 @@ HRESULT RenderEngineBase::PrepareLineTransform(const LineRendition /*lineRenditi
 
 // Method Description:
 // - Blocks until the engine is able to render without blocking.
+// - Frames that are requested back to back are throttled a bit (~60 FPS),
+//   which coalesces bulk output and improves throughput. But the first frame
+//   after the render loop went idle is most likely the echo of a keystroke,
+//   which is painted right away instead.
 void RenderEngineBase::WaitUntilCanRender() noexcept
 {
-    // Throttle the render loop a bit by default (~60 FPS), improving throughput.
-    Sleep(8);
+    if (std::chrono::steady_clock::now() - _lastFrameStart < _idleThreshold)
+    {
+        Sleep(8);
+    }
+    _lastFrameStart = std::chrono::steady_clock::now();
 }
@@ -33,12 +33,18 @@ RenderSettings::RenderSettings() noexcept
 // - enabled - Set to true to enable the mode, false to disable it.
 void RenderSettings::SetRenderMode(const Mode mode, const bool enabled) noexcept
 {
+    const auto wasEnabled = _renderMode.test(mode);
     _renderMode.set(mode, enabled);
     // If blinking is disabled, make sure blinking content is not faint.
     if (mode == Mode::BlinkAllowed && !enabled)
     {
         _blinkShouldBeFaint = false;
     }
+    // The adjusted colors aren't kept up to date while they aren't used. See MakeAdjustedColorArray.
+    if (mode == Mode::DistinguishableColors && enabled && !wasEnabled)
+    {
+        MakeAdjustedColorArray();
+    }
 }
 
 // Routine Description:
@@ -73,6 +79,12 @@ void RenderSettings::ResetColorTable() noexcept
 //   color pair to the adjusted foreground for that color pair
 void RenderSettings::MakeAdjustedColorArray() noexcept
 {
+    // This is expensive and only needed if the mode is on. SetRenderMode calls us once it's turned on.
+    if (!Feature_AdjustIndistinguishableText::IsEnabled() || !GetRenderMode(Mode::DistinguishableColors))
+    {
+        return;
+    }
+
     // The color table has 16 colors, but the adjusted color table needs to be 18
     // to include the default background and default foreground colors
     std::array<COLORREF, 18> colorTableWithDefaults;
@@ -80,18 +92,19 @@ void RenderSettings::MakeAdjustedColorArray() noexcept
     colorTableWithDefaults[AdjustedFgIndex] = GetColorAlias(ColorAlias::DefaultForeground);
     colorTableWithDefaults[AdjustedBgIndex] = GetColorAlias(ColorAlias::DefaultBackground);
 
-    for (auto fgIndex = 0; fgIndex < 18; ++fgIndex)
+    // Convert each background to Lab once, instead of once for every foreground.
+    for (auto bgIndex = 0; bgIndex < 18; ++bgIndex)
     {
-        const auto fg = til::at(colorTableWithDefaults, fgIndex);
-        for (auto bgIndex = 0; bgIndex < 18; ++bgIndex)
+        const ColorFix bg{ til::at(colorTableWithDefaults, bgIndex) };
+        for (auto fgIndex = 0; fgIndex < 18; ++fgIndex)
         {
+            const auto fg = til::at(colorTableWithDefaults, fgIndex);
             if (fgIndex == bgIndex)
             {
                 _adjustedForegroundColors[bgIndex][fgIndex] = fg;
             }
             else
             {
-                const auto bg = til::at(colorTableWithDefaults, bgIndex);
                 _adjustedForegroundColors[bgIndex][fgIndex] = ColorFix::GetPerceivableColor(fg, bg);
             }
         }
@@ -4,6 +4,9 @@
 #include "precomp.h"
 #include "renderer.hpp"
 
+#include "../../types/inc/AllocationTracking.hpp"
+#include "../../types/inc/StartupTracing.hpp"
+
 #pragma hdrstop
 
 using namespace Microsoft::Console::Render;
@@ -14,6 +17,8 @@ using PointTree = interval_tree::IntervalTree<til::point, size_t>;
 static constexpr auto maxRetriesForRenderEngine = 3;
 // The renderer will wait this number of milliseconds * how many tries have elapsed before trying again.
 static constexpr auto renderBackoffBaseTimeMilliseconds{ 150 };
+// Frames are held back for no longer than this while an application is in the middle of a synchronized update.
+static constexpr auto synchronizedOutputTimeout = std::chrono::milliseconds(RenderThread::SynchronizedOutputTimeoutMilliseconds);
 
 #define FOREACH_ENGINE(var)   \
     for (auto var : _engines) \
@@ -59,65 +64,208 @@ Renderer::~Renderer()
 
 // Routine Description:
 // - Walks through the console data structures to compose a new frame based on the data that has changed since last call and outputs it to the connected rendering engine.
+// - All engines paint the same state of the console under a single acquisition of the console lock,
+//   and present their frame once it's released. That way, no engine holds the lock while another one
+//   is presenting (which may block on the display, or on the pipe of a terminal).
 // Arguments:
 // - <none>
 // Return Value:
 // - HRESULT S_OK, GDI error, Safe Math error, or state/argument errors.
 [[nodiscard]] HRESULT Renderer::PaintFrame()
 {
-    FOREACH_ENGINE(pEngine)
+    TRACK_ALLOCATIONS(Render);
+
+    if (_destructing)
+    {
+        return S_FALSE;
+    }
+
+    const StartupTracing::Scope startupPhase{ StartupTracing::Phase::FirstFrame };
+
+    // Engines may be added or removed while we paint (see RemoveRenderEngine),
+    // so this frame is painted for a copy of the list, taken under the lock.
+    decltype(_engines) engines{};
+    std::array<HRESULT, std::tuple_size_v<decltype(_engines)>> results{};
+    const auto engineCount = _PaintFrameForEngines(engines, results, true);
+
+    for (size_t i = 0; i < engineCount; ++i)
     {
+        const auto pEngine = til::at(engines, i);
+        auto hr = til::at(results, i);
+
+        // Engines that aren't ready to paint get to retry on their own.
         auto tries = maxRetriesForRenderEngine;
-        while (tries > 0)
+        while (E_PENDING == hr)
         {
-            if (_destructing)
-            {
-                return S_FALSE;
-            }
+            _tracing.TraceFrameDropped(pEngine, hr);
 
-            const auto hr = _PaintFrameForEngine(pEngine);
-            if (E_PENDING == hr)
+            if (--tries == 0)
             {
-                if (--tries == 0)
+                // Stop trying.
+                if (_pThread)
                 {
-                    // Stop trying.
                     _pThread->DisablePainting();
-                    if (_pfnRendererEnteredErrorState)
-                    {
-                        _pfnRendererEnteredErrorState();
-                    }
-                    // If there's no callback, we still don't want to FAIL_FAST: the renderer going black
-                    // isn't near as bad as the entire application aborting. We're a component. We shouldn't
-                    // abort applications that host us.
-                    return S_FALSE;
                 }
+                if (_pfnRendererEnteredErrorState)
+                {
+                    _pfnRendererEnteredErrorState();
+                }
+                // If there's no callback, we still don't want to FAIL_FAST: the renderer going black
+                // isn't near as bad as the entire application aborting. We're a component. We shouldn't
+                // abort applications that host us.
+                return S_FALSE;
+            }
+
+            // Add a bit of backoff.
+            // Sleep 150ms, 300ms, 450ms before failing out and disabling the renderer.
+            Sleep(renderBackoffBaseTimeMilliseconds * (maxRetriesForRenderEngine - tries));
 
-                // Add a bit of backoff.
-                // Sleep 150ms, 300ms, 450ms before failing out and disabling the renderer.
-                Sleep(renderBackoffBaseTimeMilliseconds * (maxRetriesForRenderEngine - tries));
-                continue;
+            if (_destructing)
+            {
+                return S_FALSE;
             }
-            LOG_IF_FAILED(hr);
-            break;
+
+            hr = _PaintFrameForEngine(pEngine);
+        }
+
+        if (FAILED(hr))
+        {
+            _tracing.TraceFrameDropped(pEngine, hr);
         }
+        LOG_IF_FAILED(hr);
     }
 
     return S_OK;
 }
 
 [[nodiscard]] HRESULT Renderer::_PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept
-try
 {
     FAIL_FAST_IF_NULL(pEngine); // This is a programming error. Fail fast.
 
+    auto engine = pEngine;
+    auto hr = S_OK;
+    _PaintFrameForEngines({ &engine, 1 }, { &hr, 1 }, false);
+    return hr;
+}
+
+// Routine Description:
+// - Paints a frame for each of the given engines under the console lock,
+//   and presents them after releasing it.
+// Arguments:
+// - engines - the engines to paint a frame for. With allEngines, it receives the
+//   registered engines instead, and has to have room for all of them. They're copied
+//   under the lock, which is also what RemoveRenderEngine modifies them under.
+// - results - receives the result of painting the frame for each of the engines
+// - allEngines - whether the frame is painted for all registered engines
+// Return Value:
+// - The number of engines the frame was painted for.
+size_t Renderer::_PaintFrameForEngines(gsl::span<IRenderEngine*> engines, gsl::span<HRESULT> results, const bool allEngines) noexcept
+try
+{
+    _tracing.BeginFrame();
+
     _pData->LockConsole();
     auto unlock = wil::scope_exit([&]() {
         _pData->UnlockConsole();
     });
 
+    if (allEngines)
+    {
+        size_t count = 0;
+        while (count < _engines.size() && til::at(_engines, count))
+        {
+            til::at(engines, count) = til::at(_engines, count);
+            ++count;
+        }
+        engines = engines.first(count);
+        results = results.first(count);
+    }
+
+    _tracing.EndPhase(RendererTracing::Phase::LockWait);
+
+    // The state of a synchronized update is held under the lock, so once it's
+    // complete, the frame is guaranteed to contain all of it. The thread waits
+    // for the update to end before painting, but it might've gotten here just
+    // before it started. Everything that's invalid stays so for the next frame.
+    if (_synchronizedOutput && std::chrono::steady_clock::now() < _synchronizedOutputDeadline)
+    {
+        std::fill(results.begin(), results.end(), S_FALSE);
+        unlock.reset();
+        NotifyPaintFrame();
+        return engines.size();
+    }
+
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
+    auto paintedAny = false;
+    for (size_t i = 0; i < engines.size(); ++i)
+    {
+        til::at(results, i) = _PaintFrameLocked(til::at(engines, i));
+        paintedAny |= til::at(results, i) == S_OK;
+    }
+
+    if (paintedAny && _pfnFramePainted)
+    {
+        try
+        {
+            _pfnFramePainted();
+        }
+        CATCH_LOG();
+    }
+
+    // Force scope exit unlock to let go of global lock so other threads can run
+    unlock.reset();
+
+    // Trigger out-of-lock presentation for renderers that can support it
+    auto painted = false;
+    _tracing.BeginPhase();
+    for (size_t i = 0; i < engines.size(); ++i)
+    {
+        // S_FALSE means that there was nothing to paint.
+        auto& hr = til::at(results, i);
+        if (S_OK == hr)
+        {
+            hr = til::at(engines, i)->Present();
+            painted = true;
+        }
+    }
+    _tracing.EndPhase(RendererTracing::Phase::Present);
+
+    if (painted)
+    {
+        _tracing.EndFrame(engines.size() == 1 ? til::at(engines, 0) : nullptr);
+    }
+
+    return engines.size();
+}
+catch (...)
+{
+    const auto hr = wil::ResultFromCaughtException();
+    std::fill(results.begin(), results.end(), hr);
+    return engines.size();
+}
+
+// Routine Description:
+// - Paints a frame for the given engine. The console lock must be held.
+// Arguments:
+// - pEngine - the engine to paint a frame for
+// Return Value:
+// - S_OK if the frame has to be presented, S_FALSE if there was nothing to paint.
+[[nodiscard]] HRESULT Renderer::_PaintFrameLocked(_In_ IRenderEngine* const pEngine) noexcept
+try
+{
+    // Engines that support smooth scrolling get the row below the viewport, which is
+    // scrolled partially into view. Since TriggerRedraw() only invalidates what's within
+    // the viewport, that row is repainted every frame. It's usually cached anyways.
+    const auto smoothScrolling = SUCCEEDED(pEngine->SetSmoothScrollOffset(_smoothScrollOffset)) && _smoothScrollOffset != 0;
+    if (smoothScrolling)
+    {
+        const auto view = _pData->GetViewport();
+        const SMALL_RECT rowBelowViewport{ 0, view.Height(), view.Width(), gsl::narrow_cast<SHORT>(view.Height() + 1) };
+        LOG_IF_FAILED(pEngine->Invalidate(&rowBelowViewport));
+    }
+
     // Try to start painting a frame
     HRESULT const hr = pEngine->StartPaint();
     RETURN_IF_FAILED(hr);
@@ -127,7 +275,7 @@ try
     //      engine won't know that.
     if (S_FALSE == hr)
     {
-        return S_OK;
+        return S_FALSE;
     }
 
     auto endPaint = wil::scope_exit([&]() {
@@ -151,34 +299,37 @@ try
     // C. Prepare the engine with additional information before we start drawing.
     RETURN_IF_FAILED(_PrepareRenderInfo(pEngine));
 
+    _tracing.TraceDirtyArea(pEngine);
+    _tracing.BeginPhase();
+
     // 1. Paint Background
     RETURN_IF_FAILED(_PaintBackground(pEngine));
+    _tracing.EndPhase(RendererTracing::Phase::Background);
 
     // 2. Paint Rows of Text
-    _PaintBufferOutput(pEngine);
+    _PaintBufferOutput(pEngine, smoothScrolling);
 
     // 3. Paint overlays that reside above the text buffer
     _PaintOverlays(pEngine);
+    _tracing.EndPhase(RendererTracing::Phase::BufferOutput);
 
     // 4. Paint Selection
     _PaintSelection(pEngine);
+    _tracing.EndPhase(RendererTracing::Phase::Selection);
 
     // 5. Paint Cursor
     _PaintCursor(pEngine);
+    _tracing.EndPhase(RendererTracing::Phase::Cursor);
 
     // 6. Paint window title
     RETURN_IF_FAILED(_PaintTitle(pEngine));
+    _tracing.BeginPhase();
 
-    // Force scope exit end paint to finish up collecting information and possibly painting
+    // Force scope exit end paint to finish up collecting information and possibly painting.
+    // Most engines do the actual drawing in EndPaint, so it's counted towards presenting.
     endPaint.reset();
+    _tracing.EndPhase(RendererTracing::Phase::Present);
 
-    // Force scope exit unlock to let go of global lock so other threads can run
-    unlock.reset();
-
-    // Trigger out-of-lock presentation for renderers that can support it
-    RETURN_IF_FAILED(pEngine->Present());
-
-    // As we leave the scope, EndPaint will be called (declared above)
     return S_OK;
 }
 CATCH_RETURN()
@@ -232,9 +383,20 @@ void Renderer::TriggerRedraw(const Viewport& region)
         }
     }
 
+    // The revision of a row doesn't change if just the patterns in it did.
+    _InvalidateCachedLines(srUpdateRegion.Top, srUpdateRegion.Bottom);
+
     if (view.TrimToViewport(&srUpdateRegion))
     {
         view.ConvertToOrigin(&srUpdateRegion);
+
+        // The bitmap only matches the viewport if it was set up for it when the deferral started.
+        if (_redrawDeferDepth && _deferredRedraw.size() == til::size{ view.Dimensions() })
+        {
+            _deferredRedraw.set(til::rect{ srUpdateRegion.Left, srUpdateRegion.Top, srUpdateRegion.Right, srUpdateRegion.Bottom });
+            return;
+        }
+
         FOREACH_ENGINE(pEngine)
         {
             LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
@@ -266,6 +428,12 @@ void Renderer::TriggerRedraw(const COORD* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 {
+    if (_cursorRedrawDeferDepth)
+    {
+        (_deferredCursorFrom ? _deferredCursorTo : _deferredCursorFrom) = *pcoord;
+        return;
+    }
+
     // We first need to make sure the cursor position is within the buffer,
     // otherwise testing for a double width character can throw an exception.
     const auto& buffer = _pData->GetTextBuffer();
@@ -297,6 +465,161 @@ void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
     }
 }
 
+// Routine Description:
+// - Defers cursor redraws until the matching EndDeferCursorRedraw call.
+// - A redraw of an app like vim or less moves the cursor around for every line
+//   it updates, but nothing is painted until the output has been processed,
+//   so only the position the cursor was painted at and the one it ends up at
+//   need to be invalidated. Deferrals can be nested.
+// - Must be called under the console lock, like the other Trigger methods.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::StartDeferCursorRedraw() noexcept
+{
+    ++_cursorRedrawDeferDepth;
+}
+
+// Routine Description:
+// - Ends a deferral started by StartDeferCursorRedraw. Once the outermost one
+//   ends, the cursor is redrawn at the positions it was deferred at.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::EndDeferCursorRedraw() noexcept
+{
+    if (_cursorRedrawDeferDepth == 0 || --_cursorRedrawDeferDepth != 0)
+    {
+        return;
+    }
+
+    const auto from = std::exchange(_deferredCursorFrom, std::nullopt);
+    const auto to = std::exchange(_deferredCursorTo, std::nullopt);
+    try
+    {
+        if (from)
+        {
+            TriggerRedrawCursor(&*from);
+        }
+        if (to && (to->X != from->X || to->Y != from->Y))
+        {
+            TriggerRedrawCursor(&*to);
+        }
+    }
+    CATCH_LOG();
+}
+
+// Routine Description:
+// - Defers region redraws until the matching EndDeferRedraw call.
+// - Processing output invalidates a small region for almost every character or
+//   sequence. Instead of handing each of them to every engine, they're collected
+//   in a bitmap and handed over once per row when the deferral ends. Scrolling
+//   and circling hand them over early, since they move what's been invalidated.
+//   Deferrals can be nested.
+// - Must be called under the console lock, like the other Trigger methods.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::StartDeferRedraw() noexcept
+{
+    if (_redrawDeferDepth++ == 0)
+    {
+        // If this fails, the size won't match the viewport and TriggerRedraw won't defer anything.
+        try
+        {
+            _deferredRedraw.resize(til::size{ _viewport.Dimensions() });
+            _deferredRedraw.reset_all();
+        }
+        CATCH_LOG();
+    }
+}
+
+// Routine Description:
+// - Ends a deferral started by StartDeferRedraw. Once the outermost one ends,
+//   the regions that were invalidated in the meantime are redrawn.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::EndDeferRedraw() noexcept
+{
+    if (_redrawDeferDepth == 0 || --_redrawDeferDepth != 0)
+    {
+        return;
+    }
+
+    _FlushDeferredRedraw();
+}
+
+void Renderer::_FlushDeferredRedraw() noexcept
+{
+    if (!_deferredRedraw.any())
+    {
+        return;
+    }
+
+    try
+    {
+        for (const auto& run : _deferredRedraw.runs())
+        {
+            const SMALL_RECT srUpdateRegion{
+                gsl::narrow_cast<SHORT>(run.left),
+                gsl::narrow_cast<SHORT>(run.top),
+                gsl::narrow_cast<SHORT>(run.right),
+                gsl::narrow_cast<SHORT>(run.bottom),
+            };
+            FOREACH_ENGINE(pEngine)
+            {
+                LOG_IF_FAILED(pEngine->Invalidate(&srUpdateRegion));
+            }
+        }
+    }
+    CATCH_LOG();
+
+    _deferredRedraw.reset_all();
+    NotifyPaintFrame();
+}
+
+// Routine Description:
+// - Starts or ends a synchronized update (DECSET 2026). Applications bracket
+//   their updates of the screen with it, so that they can be presented at once,
+//   instead of painting frames of a half-drawn screen in the meantime.
+// - Frames are held back for no longer than synchronizedOutputTimeout, so that
+//   an application that never ends its update can't freeze the screen.
+// - Must be called under the console lock.
+// Arguments:
+// - enabled - true at the start of an update, false at its end.
+// Return Value:
+// - <none>
+void Renderer::SetSynchronizedOutput(const bool enabled) noexcept
+{
+    if (_synchronizedOutput == enabled)
+    {
+        return;
+    }
+
+    _synchronizedOutput = enabled;
+    if (enabled)
+    {
+        _synchronizedOutputDeadline = std::chrono::steady_clock::now() + synchronizedOutputTimeout;
+    }
+
+    // If we're running in the unittests, we might not have a render thread.
+    if (_pThread)
+    {
+        _pThread->SetSynchronizedOutput(enabled);
+    }
+
+    // Present whatever the update invalidated.
+    if (!enabled)
+    {
+        NotifyPaintFrame();
+    }
+}
+
 // Routine Description:
 // - Called when something that changes the output state has occurred and the entire frame is now potentially invalid.
 // - NOTE: Use sparingly. Try to reduce the refresh region where possible. Only use when a global state change has occurred.
@@ -306,6 +629,11 @@ void Renderer::TriggerRedrawCursor(const COORD* const pcoord)
 // - <none>
 void Renderer::TriggerRedrawAll()
 {
+    // This is how we're told that the buffer was replaced, among others.
+    _lineCache.clear();
+    // Everything is going to be redrawn anyways.
+    _deferredRedraw.reset_all();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateAll());
@@ -351,7 +679,7 @@ void Renderer::TriggerSelection()
     try
     {
         // Get selection rectangles
-        auto rects = _GetSelectionRects();
+        const auto& rects = _GetSelectionRects();
 
         // Restrict all previous selection rectangles to inside the current viewport bounds
         for (auto& sr : _previousSelection)
@@ -375,7 +703,9 @@ void Renderer::TriggerSelection()
             LOG_IF_FAILED(pEngine->InvalidateSelection(rects));
         }
 
-        _previousSelection = std::move(rects);
+        // The current selection becomes the previous one. Swapping the two
+        // keeps both vectors' capacity for the next call.
+        _previousSelection.swap(_selectionRects);
 
         NotifyPaintFrame();
     }
@@ -411,9 +741,36 @@ bool Renderer::_CheckViewportAndScroll()
     }
 
     _ScrollPreviousSelection(til::point{ coordDelta });
+    _InvalidateOverlays();
     return true;
 }
 
+// Routine Description:
+// - Invalidates the area covered by the overlays. Overlays are anchored to
+//   the viewport and not to the buffer, so they need to be repainted whenever
+//   the engines scroll the contents of the viewport underneath them.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::_InvalidateOverlays()
+{
+    for (const auto& overlay : _pData->GetOverlays())
+    {
+        // Engines are invalidated with exclusive rectangles relative to the viewport.
+        auto srOverlay = overlay.region.ToExclusive();
+        srOverlay.Left += overlay.origin.X;
+        srOverlay.Right += overlay.origin.X;
+        srOverlay.Top += overlay.origin.Y;
+        srOverlay.Bottom += overlay.origin.Y;
+
+        FOREACH_ENGINE(pEngine)
+        {
+            LOG_IF_FAILED(pEngine->Invalidate(&srOverlay));
+        }
+    }
+}
+
 // Routine Description:
 // - Called when a scroll operation has occurred by manipulating the viewport.
 // - This is a special case as calling out scrolls explicitly drastically improves performance.
@@ -423,6 +780,9 @@ bool Renderer::_CheckViewportAndScroll()
 // - <none>
 void Renderer::TriggerScroll()
 {
+    // The deferred regions are relative to the viewport before it moved.
+    _FlushDeferredRedraw();
+
     if (_CheckViewportAndScroll())
     {
         NotifyPaintFrame();
@@ -440,12 +800,16 @@ void Renderer::TriggerScroll()
 // - <none>
 void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 {
+    // The engines need to scroll the deferred regions along with everything else.
+    _FlushDeferredRedraw();
+
     FOREACH_ENGINE(pEngine)
     {
         LOG_IF_FAILED(pEngine->InvalidateScroll(pcoordDelta));
     }
 
     _ScrollPreviousSelection(til::point{ *pcoordDelta });
+    _InvalidateOverlays();
 
     NotifyPaintFrame();
 }
@@ -459,7 +823,10 @@ void Renderer::TriggerScroll(const COORD* const pcoordDelta)
 // - <none>
 void Renderer::TriggerCircling()
 {
-    const auto rects = _GetSelectionRects();
+    // An engine might paint right away, and it should paint what's actually invalid.
+    _FlushDeferredRedraw();
+
+    const auto& rects = _GetSelectionRects();
 
     FOREACH_ENGINE(pEngine)
     {
@@ -540,6 +907,8 @@ void Renderer::UpdateSoftFont(const gsl::span<const uint16_t> bitPattern, const
     // match, and those code points will be treated the same as everything else.
     const auto softFontCharCount = cellSize.cy ? bitPattern.size() / cellSize.cy : 0;
     _lastSoftFontChar = _firstSoftFontChar + softFontCharCount - 1;
+    // Which glyphs are soft font glyphs is part of the cached lines.
+    _lineCache.clear();
 
     FOREACH_ENGINE(pEngine)
     {
@@ -626,6 +995,104 @@ void Renderer::EnablePainting()
     _pThread->EnablePainting();
 }
 
+// Routine Description:
+// - Tells the render thread whether the window is minimized or otherwise
+//   hidden, in which case it paints far less often.
+// Arguments:
+// - occluded - true if nothing we paint can be seen
+// Return Value:
+// - <none>
+void Renderer::SetOccluded(const bool occluded) noexcept
+{
+    // If we're running in the unittests, we might not have a render thread.
+    if (_pThread)
+    {
+        _pThread->SetOccluded(occluded);
+    }
+}
+
+// Routine Description:
+// - Tells the render thread whether what it paints is hidden altogether, like
+//   the panes of a tab that isn't selected. Hidden renderers don't paint until
+//   they're shown again, which paints everything that changed in the meantime.
+// Arguments:
+// - hidden - true if the renderer shouldn't paint
+// Return Value:
+// - <none>
+void Renderer::SetHidden(const bool hidden) noexcept
+{
+    // If we're running in the unittests, we might not have a render thread.
+    if (_pThread)
+    {
+        _pThread->SetHidden(hidden);
+    }
+}
+
+// Routine Description:
+// - Tells the render thread to paint only every now and then, like while
+//   it's occluded, even though what it paints can be seen. Used while there's
+//   so much output that painting all of it would only slow down its parsing.
+// Arguments:
+// - throttled - true if the renderer should paint less often
+// Return Value:
+// - <none>
+void Renderer::SetThrottled(const bool throttled) noexcept
+{
+    // If we're running in the unittests, we might not have a render thread.
+    if (_pThread)
+    {
+        _pThread->SetThrottled(throttled);
+    }
+}
+
+// Routine Description:
+// - Asks the render thread to release what the renderer and its engines only
+//   keep around to paint faster, like glyph atlases and scratch buffers. Meant
+//   for renderers that nobody can see, for instance while they're hidden.
+//   The next frame recreates all of it.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::TrimResources() noexcept
+{
+    // If we're running in the unittests, we might not have a render thread.
+    if (_pThread)
+    {
+        _pThread->RequestTrim();
+    }
+}
+
+// Routine Description:
+// - Releases what the renderer and its engines only keep around to paint faster.
+//   Only the render thread calls this, once TrimResources() asked it to, so
+//   that the engines can't be in the middle of presenting a frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Renderer::TrimResourcesNow() noexcept
+{
+    _pData->LockConsole();
+    auto unlock = wil::scope_exit([&]() {
+        _pData->UnlockConsole();
+    });
+
+    // .clear() doesn't free the memory of these.
+    _clusterBuffer = {};
+    _lineCache = {};
+    _selectionRects = {};
+    _runPatternIds = {};
+
+    for (const auto pEngine : _engines)
+    {
+        if (pEngine)
+        {
+            pEngine->TrimResources();
+        }
+    }
+}
+
 // Routine Description:
 // - Waits for the current paint operation to complete, if any, up to the specified timeout.
 // - Resets an event in the render thread that precludes it from advancing, thus disabling rendering.
@@ -658,12 +1125,18 @@ void Renderer::WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs)
 // - <none>
 // Return Value:
 // - <none>
-void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
+void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine, const bool includeRowBelowViewport)
 {
     // This is the subsection of the entire screen buffer that is currently being presented.
     // It can move left/right or top/bottom depending on how the viewport is scrolled
     // relative to the entire buffer.
-    const auto view = _pData->GetViewport();
+    auto view = _pData->GetViewport();
+
+    // While smooth scrolling, the row below the viewport is partially visible, if there's one.
+    if (includeRowBelowViewport && view.BottomExclusive() < _pData->GetTextBuffer().GetSize().BottomExclusive())
+    {
+        view = Viewport::FromDimensions(view.Origin(), view.Width(), gsl::narrow_cast<short>(view.Height() + 1));
+    }
 
     // This is effectively the number of cells on the visible screen that need to be redrawn.
     // The origin is always 0, 0 because it represents the screen itself, not the underlying buffer.
@@ -716,8 +1189,9 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // of the backing buffer to fill in line 1 of the screen.
             const auto screenPosition = bufferLine.Origin() - COORD{ 0, view.Top() };
 
-            // Retrieve the cell information iterator limited to just this line we want to redraw.
-            auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
+            // Retrieve the clusters and attribute runs of just this line we want to redraw.
+            // They're only computed again if the row was modified since we last painted it.
+            const auto& line = _GetCachedLine(buffer, bufferLine, screenPosition);
 
             // Calculate if two things are true:
             // 1. this row wrapped
@@ -730,7 +1204,7 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             LOG_IF_FAILED(pEngine->PrepareLineTransform(lineRendition, screenPosition.Y, view.Left()));
 
             // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenPosition, lineWrapped);
+            _PaintBufferOutputHelper(pEngine, line, lineWrapped);
         }
     }
 }
@@ -741,46 +1215,105 @@ static bool _IsAllSpaces(const std::wstring_view v)
     return v.find_first_not_of(L' ') == decltype(v)::npos;
 }
 
-void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
-                                        const COORD target,
-                                        const bool lineWrapped)
+// Routine Description:
+// - Returns the clusters and attribute runs of the given line, walking the buffer only
+//   if the line isn't cached yet, or if its row was modified since it was cached.
+// Arguments:
+// - buffer - the text buffer the line belongs to
+// - bufferLine - the buffer cells to return, which are all within a single row
+// - target - the screen position the first of the cells is painted at
+// Return Value:
+// - The cached line. It's valid until the next call.
+const Renderer::CachedLine& Renderer::_GetCachedLine(const TextBuffer& buffer, const Viewport& bufferLine, const COORD target)
+{
+    const auto revision = buffer.GetRowByOffset(bufferLine.Top()).GetRevision();
+    const auto globalInvert = _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed);
+    const auto bufferRect = bufferLine.ToInclusive();
+
+    const auto index = gsl::narrow_cast<size_t>(std::max<SHORT>(target.Y, 0));
+    if (index >= _lineCache.size())
+    {
+        _lineCache.resize(index + 1);
+    }
+
+    auto& line = til::at(_lineCache, index);
+    if (line.valid &&
+        line.buffer == &buffer &&
+        line.revision == revision &&
+        line.bufferLine == bufferRect &&
+        line.target == target &&
+        line.globalInvert == globalInvert)
+    {
+        return line;
+    }
+
+    line.valid = false;
+    line.buffer = &buffer;
+    line.revision = revision;
+    line.bufferLine = bufferRect;
+    line.target = target;
+    line.globalInvert = globalInvert;
+    line.text.clear();
+    line.clusters.clear();
+    line.runs.clear();
+
+    _CacheBufferLine(line, buffer.GetCellDataAt(bufferLine.Origin(), bufferLine));
+
+    line.valid = true;
+    return line;
+}
+
+// Routine Description:
+// - Forgets the cached lines of the given buffer rows, whose revision doesn't
+//   change if only the patterns that were detected in them did.
+// Arguments:
+// - top - the first buffer row to forget
+// - bottom - the buffer row after the last one to forget
+// Return Value:
+// - <none>
+void Renderer::_InvalidateCachedLines(const SHORT top, const SHORT bottom) noexcept
 {
-    auto globalInvert{ _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed) };
+    for (auto& line : _lineCache)
+    {
+        if (line.bufferLine.Top >= top && line.bufferLine.Top < bottom)
+        {
+            line.valid = false;
+        }
+    }
+}
+
+void Renderer::_CacheBufferLine(CachedLine& line, TextBufferCellIterator it)
+{
+    const auto globalInvert = line.globalInvert;
 
     // If we have valid data, let's figure out how to draw it.
     if (it)
     {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
         size_t cols = 0;
 
         // Retrieve the first color.
         auto color = it->TextAttr();
-        // Retrieve the first pattern id
-        auto patternIds = _pData->GetPatternId(target);
+        // Retrieve the first pattern id. The span is only valid until the next
+        // call to GetPatternId, so it's copied into storage of our own.
+        const auto firstPatternIds = _pData->GetPatternId(line.target);
+        _runPatternIds.assign(firstPatternIds.begin(), firstPatternIds.end());
         // Determine whether we're using a soft font.
         auto usingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
 
         // And hold the point where we should start drawing.
-        auto screenPoint = target;
+        auto screenPoint = line.target;
 
         // This outer loop will continue until we reach the end of the text we are trying to draw.
         while (it)
         {
+            auto& run = line.runs.emplace_back();
+
             // Hold onto the current run color right here for the length of the outer loop.
             // We'll be changing the persistent one as we run through the inner loops to detect
             // when a run changes, but we will still need to know this color at the bottom
             // when we go to draw gridlines for the length of the run.
-            const auto currentRunColor = color;
-
-            // Hold onto the current pattern id as well
-            const auto currentPatternId = patternIds;
-
-            // Update the drawing brushes with our color and font usage.
-            THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, usingSoftFont, false));
+            run.attr = color;
+            run.usingSoftFont = usingSoftFont;
 
             // Advance the point by however many columns we've just outputted and reset the accumulator.
             screenPoint.X += gsl::narrow<SHORT>(cols);
@@ -789,15 +1322,8 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // Hold onto the start of this run iterator and the target location where we started
             // in case we need to do some special work to paint the line drawing characters.
             const auto currentRunItStart = it;
-            const auto currentRunTargetStart = screenPoint;
-
-            // Ensure that our cluster vector is clear.
-            _clusterBuffer.clear();
-
-            // Reset our flag to know when we're in the special circumstance
-            // of attempting to draw only the right-half of a two-column character
-            // as the first item in our run.
-            bool trimLeft = false;
+            run.gridLineTarget = screenPoint;
+            run.firstCluster = line.clusters.size();
 
             // Run contains wide character (>1 columns)
             bool containsWideCharacter = false;
@@ -810,7 +1336,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 COORD thisPoint{ gsl::narrow<SHORT>(screenPoint.X + cols), screenPoint.Y };
                 const auto thisPointPatterns = _pData->GetPatternId(thisPoint);
                 const auto thisUsingSoftFont = s_IsSoftFontChar(it->Chars(), _firstSoftFontChar, _lastSoftFontChar);
-                const auto changedPatternOrFont = patternIds != thisPointPatterns || usingSoftFont != thisUsingSoftFont;
+                const auto changedPatternOrFont = !std::equal(_runPatternIds.begin(), _runPatternIds.end(), thisPointPatterns.begin(), thisPointPatterns.end()) || usingSoftFont != thisUsingSoftFont;
                 if (color != it->TextAttr() || changedPatternOrFont)
                 {
                     auto newAttr{ it->TextAttr() };
@@ -819,7 +1345,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                     if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert) || changedPatternOrFont)
                     {
                         color = newAttr;
-                        patternIds = thisPointPatterns;
+                        _runPatternIds.assign(thisPointPatterns.begin(), thisPointPatterns.end());
                         usingSoftFont = thisUsingSoftFont;
                         break; // vend this run
                     }
@@ -831,12 +1357,12 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
                 // If we're on the first cluster to be added and it's marked as "trailing"
                 // (a.k.a. the right half of a two column character), then we need some special handling.
-                if (_clusterBuffer.empty() && it->DbcsAttr().IsTrailing())
+                if (line.clusters.size() == run.firstCluster && it->DbcsAttr().IsTrailing())
                 {
                     // Move left to the one so the whole character can be struck correctly.
                     --screenPoint.X;
                     // And tell the next function to trim off the left half of it.
-                    trimLeft = true;
+                    run.trimLeft = true;
                     // And add one to the number of columns we expect it to take as we insert it.
                     ++columnCount;
                 }
@@ -847,48 +1373,80 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                 }
 
                 // Advance the cluster and column counts.
-                _clusterBuffer.emplace_back(it->Chars(), columnCount);
+                // The text is copied, so that the line stays valid even if the buffer's storage moves.
+                const auto chars = it->Chars();
+                line.clusters.push_back({ line.text.size(), chars.size(), columnCount });
+                line.text.append(chars);
                 it += std::max<size_t>(it->Columns(), 1); // prevent infinite loop for no visible columns
                 cols += columnCount;
 
             } while (it);
 
-            // Do the painting.
-            THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, trimLeft, lineWrapped));
-
-            // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
-            // We're only allowed to draw the grid lines under certain circumstances.
-            if (_pData->IsGridLineDrawingAllowed())
+            run.target = screenPoint;
+            run.columns = cols;
+            run.clusterCount = line.clusters.size() - run.firstCluster;
+
+            // See GH: 803
+            // If we found a wide character while we looped above, it's possible we skipped over the right half
+            // attribute that could have contained different line information than the left half.
+            // We need to go through the iterators again to ensure we get the lines associated with each
+            // exact column. The code above will condense two-column characters into one, but it is possible
+            // (like with the IME) that the line drawing characters will vary from the left to right half
+            // of a wider character.
+            if (containsWideCharacter)
             {
-                // See GH: 803
-                // If we found a wide character while we looped above, it's possible we skipped over the right half
-                // attribute that could have contained different line information than the left half.
-                if (containsWideCharacter)
+                auto lineIt = currentRunItStart;
+                run.columnAttrs.reserve(cols);
+                for (auto colsPainted = 0u; colsPainted < cols; ++colsPainted, ++lineIt)
                 {
-                    // Start from the original position in this run.
-                    auto lineIt = currentRunItStart;
-                    // Start from the original target in this run.
-                    auto lineTarget = currentRunTargetStart;
-
-                    // We need to go through the iterators again to ensure we get the lines associated with each
-                    // exact column. The code above will condense two-column characters into one, but it is possible
-                    // (like with the IME) that the line drawing characters will vary from the left to right half
-                    // of a wider character.
-                    // We could theoretically pre-pass for this in the loop above to be more efficient about walking
-                    // the iterator, but I fear it would make the code even more confusing than it already is.
-                    // Do that in the future if some WPR trace points you to this spot as super bad.
-                    for (auto colsPainted = 0u; colsPainted < cols; ++colsPainted, ++lineIt, ++lineTarget.X)
-                    {
-                        auto lines = lineIt->TextAttr();
-                        _PaintBufferOutputGridLineHelper(pEngine, lines, 1, lineTarget);
-                    }
+                    run.columnAttrs.emplace_back(lineIt->TextAttr());
                 }
-                else
+            }
+        }
+    }
+}
+
+void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
+                                        const CachedLine& line,
+                                        const bool lineWrapped)
+{
+    const std::wstring_view text{ line.text };
+
+    for (const auto& run : line.runs)
+    {
+        // Update the drawing brushes with our color and font usage.
+        THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, run.attr, run.usingSoftFont, false));
+
+        // Ensure that our cluster vector is clear.
+        _clusterBuffer.clear();
+        for (size_t i = run.firstCluster; i < run.firstCluster + run.clusterCount; ++i)
+        {
+            const auto& cluster = til::at(line.clusters, i);
+            _clusterBuffer.emplace_back(text.substr(cluster.offset, cluster.length), cluster.columns);
+        }
+
+        // Do the painting.
+        THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, run.target, run.trimLeft, lineWrapped));
+
+        // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
+        // We're only allowed to draw the grid lines under certain circumstances.
+        if (_pData->IsGridLineDrawingAllowed())
+        {
+            if (!run.columnAttrs.empty())
+            {
+                // The halves of wide characters may have different lines, so draw them column by column.
+                auto lineTarget = run.gridLineTarget;
+                for (const auto& attr : run.columnAttrs)
                 {
-                    // If nothing exciting is going on, draw the lines in bulk.
-                    _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, cols, screenPoint);
+                    _PaintBufferOutputGridLineHelper(pEngine, attr, 1, lineTarget);
+                    ++lineTarget.X;
                 }
             }
+            else
+            {
+                // If nothing exciting is going on, draw the lines in bulk.
+                _PaintBufferOutputGridLineHelper(pEngine, run.attr, run.columns, run.target);
+            }
         }
     }
 }
@@ -974,7 +1532,7 @@ void Renderer::_PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngin
         if (_hoveredInterval->start <= coordTargetTil &&
             coordTargetTil <= _hoveredInterval->stop)
         {
-            if (_pData->GetPatternId(coordTarget).size() > 0)
+            if (!_pData->GetPatternId(coordTarget).empty())
             {
                 lines.set(IRenderEngine::GridLines::Underline);
             }
@@ -1085,6 +1643,8 @@ void Renderer::_PaintCursor(_In_ IRenderEngine* const pEngine)
 {
     RenderFrameInfo info;
     info.cursorInfo = _GetCursorInfo();
+    info.renderData = _pData;
+    info.selectionRects = _GetSelectionRects();
     return pEngine->PrepareRenderInfo(info);
 }
 
@@ -1136,7 +1696,12 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
 
                     auto it = overlay.buffer.GetCellLineDataAt(source);
 
-                    _PaintBufferOutputHelper(&engine, it, target, false);
+                    // Overlays change all the time, so they aren't cached.
+                    CachedLine line;
+                    line.target = target;
+                    line.globalInvert = _renderSettings.GetRenderMode(RenderSettings::Mode::ScreenReversed);
+                    _CacheBufferLine(line, it);
+                    _PaintBufferOutputHelper(&engine, line, false);
                 }
             }
         }
@@ -1156,9 +1721,7 @@ void Renderer::_PaintOverlays(_In_ IRenderEngine* const pEngine)
 {
     try
     {
-        const auto overlays = _pData->GetOverlays();
-
-        for (const auto& overlay : overlays)
+        for (const auto& overlay : _pData->GetOverlays())
         {
             _PaintOverlay(*pEngine, overlay);
         }
@@ -1180,7 +1743,7 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
         LOG_IF_FAILED(pEngine->GetDirtyArea(dirtyAreas));
 
         // Get selection rectangles
-        const auto rectangles = _GetSelectionRects();
+        const auto& rectangles = _GetSelectionRects();
         for (auto rect : rectangles)
         {
             for (auto& dirtyRect : dirtyAreas)
@@ -1238,14 +1801,16 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
 // - Helper to determine the selected region of the buffer.
 // Return Value:
 // - A vector of rectangles representing the regions to select, line by line.
-std::vector<SMALL_RECT> Renderer::_GetSelectionRects() const
+//   It's reused by the next call, so it's only valid until then.
+const std::vector<SMALL_RECT>& Renderer::_GetSelectionRects()
 {
     const auto& buffer = _pData->GetTextBuffer();
-    auto rects = _pData->GetSelectionRects();
+    const auto rects = _pData->GetSelectionRects();
     // Adjust rectangles to viewport
     Viewport view = _pData->GetViewport();
 
-    std::vector<SMALL_RECT> result;
+    auto& result = _selectionRects;
+    result.clear();
     result.reserve(rects.size());
 
     for (auto rect : rects)
@@ -1319,6 +1884,27 @@ void Renderer::AddRenderEngine(_In_ IRenderEngine* const pEngine)
     THROW_HR_MSG(E_UNEXPECTED, "engines array is full");
 }
 
+// Method Description:
+// - Removes a render engine that was added with AddRenderEngine. Future
+//      rendering calls won't be sent to it anymore.
+// - Must be called under the console lock. A frame that's already being
+//      painted might still present to the engine, so the caller has to keep
+//      it alive after removing it.
+// Arguments:
+// - pEngine: The render engine to be removed
+// Return Value:
+// - <none>
+void Renderer::RemoveRenderEngine(_In_ IRenderEngine* const pEngine) noexcept
+{
+    const auto it = std::find(_engines.begin(), _engines.end(), pEngine);
+    if (it != _engines.end())
+    {
+        // The engines are kept at the front of the array, without gaps.
+        std::move(it + 1, _engines.end(), it);
+        _engines.back() = nullptr;
+    }
+}
+
 // Method Description:
 // - Registers a callback that will be called when this renderer gives up.
 //   An application consuming a renderer can use this to display auxiliary Retry UI
@@ -1331,6 +1917,20 @@ void Renderer::SetRendererEnteredErrorStateCallback(std::function<void()> pfn)
     _pfnRendererEnteredErrorState = std::move(pfn);
 }
 
+// Method Description:
+// - Registers a callback that will be called after each frame that painted anything,
+//   while the console lock is still being held. An application can use this to take
+//   a snapshot of what's on the screen, which other threads can then read without
+//   having to take the lock themselves.
+// Arguments:
+// - pfn: the callback
+// Return Value:
+// - <none>
+void Renderer::SetFramePaintedCallback(std::function<void()> pfn)
+{
+    _pfnFramePainted = std::move(pfn);
+}
+
 // Method Description:
 // - Attempts to restart the renderer.
 void Renderer::ResetErrorStateAndResume()
@@ -1344,6 +1944,65 @@ void Renderer::UpdateLastHoveredInterval(const std::optional<PointTree::interval
     _hoveredInterval = newInterval;
 }
 
+// Method Description:
+// - Sets the fraction of a row that the viewport is scrolled beyond its top row,
+//   for smooth scrolling with precision touchpads and the like. Engines that
+//   support it draw the viewport shifted up by as much, together with the row
+//   below it. The others keep drawing it row by row. The console lock must be held.
+// Arguments:
+// - rows: the offset in rows, between 0 and 1
+// Return Value:
+// - <none>
+void Renderer::SetSmoothScrollOffset(const float rows) noexcept
+{
+    if (_smoothScrollOffset != rows)
+    {
+        _smoothScrollOffset = rows;
+        NotifyPaintFrame();
+    }
+}
+
+// Method Description:
+// - Enables or disables accumulating the timing of the frames we paint.
+//   See RendererTracing::SetStatisticsEnabled.
+void Renderer::SetStatisticsEnabled(const bool enabled) noexcept
+{
+    _tracing.SetStatisticsEnabled(enabled);
+}
+
+// Method Description:
+// - Returns the frame statistics accumulated so far. May be called from any thread.
+RendererTracing::Statistics Renderer::GetStatistics() const noexcept
+{
+    return _tracing.GetStatistics();
+}
+
+// Method Description:
+// - Sums up the glyph cache lookups and hits of the engines that keep track of them.
+// Arguments:
+// - lookups - receives the number of glyphs the engines looked up so far
+// - hits - receives how many of them were already cached
+// Return Value:
+// - true if any of our engines keeps track of its glyph cache, false otherwise.
+bool Renderer::GetGlyphCacheStatistics(uint64_t& lookups, uint64_t& hits) const noexcept
+{
+    auto supported = false;
+    lookups = 0;
+    hits = 0;
+    FOREACH_ENGINE(pEngine)
+    {
+        uint64_t engineLookups = 0;
+        uint64_t engineHits = 0;
+        if (SUCCEEDED(pEngine->GetGlyphCacheStatistics(engineLookups, engineHits)))
+        {
+            lookups += engineLookups;
+            hits += engineHits;
+            supported = true;
+        }
+    }
+    return supported;
+}
+
 // Method Description:
 // - Blocks until the engines are able to render without blocking.
 void Renderer::WaitUntilCanRender()
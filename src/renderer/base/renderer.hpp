@@ -20,6 +20,7 @@ Author(s):
 #include "../inc/RenderSettings.hpp"
 
 #include "thread.hpp"
+#include "tracing.hpp"
 
 #include "../../buffer/out/textBuffer.hpp"
 #include "../../buffer/out/CharRow.hpp"
@@ -44,6 +45,11 @@ namespace Microsoft::Console::Render
         void TriggerRedraw(const Microsoft::Console::Types::Viewport& region) override;
         void TriggerRedraw(const COORD* const pcoord) override;
         void TriggerRedrawCursor(const COORD* const pcoord) override;
+        void StartDeferCursorRedraw() noexcept override;
+        void EndDeferCursorRedraw() noexcept override;
+        void StartDeferRedraw() noexcept override;
+        void EndDeferRedraw() noexcept override;
+        void SetSynchronizedOutput(const bool enabled) noexcept override;
         void TriggerRedrawAll() override;
         void TriggerTeardown() noexcept override;
 
@@ -69,25 +75,80 @@ namespace Microsoft::Console::Render
         bool IsGlyphWideByFont(const std::wstring_view glyph);
 
         void EnablePainting();
+        void SetOccluded(const bool occluded) noexcept;
+        void SetHidden(const bool hidden) noexcept;
+        void SetThrottled(const bool throttled) noexcept;
+        void TrimResources() noexcept;
+        void TrimResourcesNow() noexcept;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs);
         void WaitUntilCanRender();
 
         void AddRenderEngine(_In_ IRenderEngine* const pEngine);
+        void RemoveRenderEngine(_In_ IRenderEngine* const pEngine) noexcept;
 
         void SetRendererEnteredErrorStateCallback(std::function<void()> pfn);
+        void SetFramePaintedCallback(std::function<void()> pfn);
         void ResetErrorStateAndResume();
 
         void UpdateLastHoveredInterval(const std::optional<interval_tree::IntervalTree<til::point, size_t>::interval>& newInterval);
+        void SetSmoothScrollOffset(const float rows) noexcept;
+
+        void SetStatisticsEnabled(const bool enabled) noexcept;
+        RendererTracing::Statistics GetStatistics() const noexcept;
+        bool GetGlyphCacheStatistics(uint64_t& lookups, uint64_t& hits) const noexcept;
 
     private:
         static IRenderEngine::GridLineSet s_GetGridlines(const TextAttribute& textAttribute) noexcept;
         static bool s_IsSoftFontChar(const std::wstring_view& v, const size_t firstSoftFontChar, const size_t lastSoftFontChar);
 
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
+        size_t _PaintFrameForEngines(gsl::span<IRenderEngine*> engines, gsl::span<HRESULT> results, const bool allEngines) noexcept;
+        [[nodiscard]] HRESULT _PaintFrameLocked(_In_ IRenderEngine* const pEngine) noexcept;
         bool _CheckViewportAndScroll();
+        void _InvalidateOverlays();
         [[nodiscard]] HRESULT _PaintBackground(_In_ IRenderEngine* const pEngine);
-        void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
-        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, TextBufferCellIterator it, const COORD target, const bool lineWrapped);
+        void _PaintBufferOutput(_In_ IRenderEngine* const pEngine, const bool includeRowBelowViewport);
+        // The clusters and attribute runs of a line of the buffer, as painted by _PaintBufferOutput.
+        // They're reused for as long as the revision of the row is the same, so that the lines that
+        // engines repaint without them having changed (e.g. next to the cursor, or because another
+        // engine painted them in the same frame) don't have to be walked again.
+        struct CachedCluster
+        {
+            size_t offset;
+            size_t length;
+            size_t columns;
+        };
+        struct CachedRun
+        {
+            TextAttribute attr;
+            bool usingSoftFont = false;
+            bool trimLeft = false;
+            COORD target{};
+            COORD gridLineTarget{};
+            size_t columns = 0;
+            size_t firstCluster = 0;
+            size_t clusterCount = 0;
+            // The attributes of every column, if the run contains wide glyphs, whose halves may have different gridlines.
+            std::vector<TextAttribute> columnAttrs;
+        };
+        struct CachedLine
+        {
+            const TextBuffer* buffer = nullptr;
+            uint64_t revision = 0;
+            SMALL_RECT bufferLine{};
+            COORD target{};
+            bool globalInvert = false;
+            bool valid = false;
+            std::wstring text;
+            std::vector<CachedCluster> clusters;
+            std::vector<CachedRun> runs;
+        };
+
+        const CachedLine& _GetCachedLine(const TextBuffer& buffer, const Microsoft::Console::Types::Viewport& bufferLine, const COORD target);
+        void _InvalidateCachedLines(const SHORT top, const SHORT bottom) noexcept;
+        void _FlushDeferredRedraw() noexcept;
+        void _CacheBufferLine(CachedLine& line, TextBufferCellIterator it);
+        void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine, const CachedLine& line, const bool lineWrapped);
         void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine, const TextAttribute textAttribute, const size_t cchLine, const COORD coordTarget);
         void _PaintSelection(_In_ IRenderEngine* const pEngine);
         void _PaintCursor(_In_ IRenderEngine* const pEngine);
@@ -95,7 +156,7 @@ namespace Microsoft::Console::Render
         void _PaintOverlay(IRenderEngine& engine, const RenderOverlay& overlay);
         [[nodiscard]] HRESULT _UpdateDrawingBrushes(_In_ IRenderEngine* const pEngine, const TextAttribute attr, const bool usingSoftFont, const bool isSettingDefaultBrushes);
         [[nodiscard]] HRESULT _PerformScrolling(_In_ IRenderEngine* const pEngine);
-        std::vector<SMALL_RECT> _GetSelectionRects() const;
+        const std::vector<SMALL_RECT>& _GetSelectionRects();
         void _ScrollPreviousSelection(const til::point delta);
         [[nodiscard]] HRESULT _PaintTitle(IRenderEngine* const pEngine);
         [[nodiscard]] std::optional<CursorOptions> _GetCursorInfo();
@@ -110,9 +171,30 @@ namespace Microsoft::Console::Render
         std::optional<interval_tree::IntervalTree<til::point, size_t>::interval> _hoveredInterval;
         Microsoft::Console::Types::Viewport _viewport;
         std::vector<Cluster> _clusterBuffer;
+        std::vector<CachedLine> _lineCache;
         std::vector<SMALL_RECT> _previousSelection;
+        // Scratch storage that's reused from frame to frame, so that painting doesn't allocate.
+        std::vector<SMALL_RECT> _selectionRects;
+        std::vector<size_t> _runPatternIds;
         std::function<void()> _pfnRendererEnteredErrorState;
+        std::function<void()> _pfnFramePainted;
+        RendererTracing _tracing;
         bool _destructing = false;
+        // While cursor redraws are deferred, only the first and the last position
+        // the cursor was at need to be invalidated once the deferral ends.
+        size_t _cursorRedrawDeferDepth = 0;
+        std::optional<COORD> _deferredCursorFrom;
+        std::optional<COORD> _deferredCursorTo;
+        // While redraws are deferred, the invalidated regions are collected here, relative
+        // to the origin of _viewport, and handed to the engines once the deferral ends.
+        size_t _redrawDeferDepth = 0;
+        til::bitmap _deferredRedraw;
+        // While an application is in the middle of a synchronized update (DECSET 2026),
+        // frames are held back until it's complete, or until the deadline passed.
+        bool _synchronizedOutput = false;
+        std::chrono::steady_clock::time_point _synchronizedOutputDeadline;
+        // The fraction of a row that the viewport is scrolled beyond its top row. See SetSmoothScrollOffset().
+        float _smoothScrollOffset = 0;
 
 #ifdef UNIT_TESTING
         friend class ConptyOutputTests;
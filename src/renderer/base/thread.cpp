@@ -10,15 +10,25 @@
 
 using namespace Microsoft::Console::Render;
 
+// While the window is occluded or the renderer is throttled, frames are painted at most this often.
+static constexpr DWORD occludedFrameIntervalMilliseconds = 250;
+
 RenderThread::RenderThread() :
     _pRenderer(nullptr),
     _hThread(nullptr),
     _hEvent(nullptr),
     _hPaintCompletedEvent(nullptr),
+    _hVisibleEvent(nullptr),
+    _hSynchronizedOutputEvent(nullptr),
+    _hTrimEvent(nullptr),
     _fKeepRunning(true),
     _hPaintEnabledEvent(nullptr),
     _fNextFrameRequested(false),
-    _fWaiting(false)
+    _fWaiting(false),
+    _fOccluded(false),
+    _fHidden(false),
+    _fThrottled(false),
+    _fTrimRequested(false)
 {
 }
 
@@ -27,7 +37,11 @@ RenderThread::~RenderThread()
     if (_hThread)
     {
         _fKeepRunning = false; // stop loop after final run
-        EnablePainting(); // if we want to get the last frame out, we need to make sure it's enabled
+        SetEvent(_hPaintEnabledEvent); // if we want to get the last frame out, we need to make sure it's enabled
+        _fHidden = false; // and that we don't hold it back either
+        _fThrottled = false;
+        SetOccluded(false);
+        SetSynchronizedOutput(false);
         SignalObjectAndWait(_hEvent, _hThread, INFINITE, FALSE); // signal final paint and wait for thread to finish.
 
         CloseHandle(_hThread);
@@ -51,23 +65,41 @@ RenderThread::~RenderThread()
         CloseHandle(_hPaintCompletedEvent);
         _hPaintCompletedEvent = nullptr;
     }
+
+    if (_hVisibleEvent)
+    {
+        CloseHandle(_hVisibleEvent);
+        _hVisibleEvent = nullptr;
+    }
+
+    if (_hSynchronizedOutputEvent)
+    {
+        CloseHandle(_hSynchronizedOutputEvent);
+        _hSynchronizedOutputEvent = nullptr;
+    }
+
+    if (_hTrimEvent)
+    {
+        CloseHandle(_hTrimEvent);
+        _hTrimEvent = nullptr;
+    }
 }
 
 // Method Description:
-// - Create all of the Events we'll need, and the actual thread we'll be doing
-//      work on.
+// - Create all of the Events we'll need. The actual thread we'll be doing
+//      work on is only created once painting is enabled for the first time.
 // Arguments:
 // - pRendererParent: the Renderer that owns this thread, and which we should
 //      trigger frames for.
 // Return Value:
 // - S_OK if we succeeded, else an HRESULT corresponding to a failure to create
-//      an Event or Thread.
+//      an Event.
 [[nodiscard]] HRESULT RenderThread::Initialize(Renderer* const pRendererParent) noexcept
 {
     _pRenderer = pRendererParent;
 
     HRESULT hr = S_OK;
-    // Create event before thread as thread will start immediately.
+    // Create events before the thread as the thread will start immediately.
     if (SUCCEEDED(hr))
     {
         HANDLE hEvent = CreateEventW(nullptr, // non-inheritable security attributes
@@ -122,35 +154,94 @@ RenderThread::~RenderThread()
 
     if (SUCCEEDED(hr))
     {
-        HANDLE hThread = CreateThread(nullptr, // non-inheritable security attributes
-                                      0, // use default stack size
-                                      s_ThreadProc,
-                                      this,
-                                      0, // create immediately
-                                      nullptr // we don't need the thread ID
-        );
+        HANDLE hVisibleEvent = CreateEventW(nullptr,
+                                            TRUE, // manual reset event
+                                            TRUE, // initially signaled
+                                            nullptr);
 
-        if (hThread == nullptr)
+        if (hVisibleEvent == nullptr)
         {
             hr = HRESULT_FROM_WIN32(GetLastError());
         }
         else
         {
-            _hThread = hThread;
+            _hVisibleEvent = hVisibleEvent;
+        }
+    }
 
-            // SetThreadDescription only works on 1607 and higher. If we cannot find it,
-            // then it's no big deal. Just skip setting the description.
-            auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), SetThreadDescription);
-            if (func)
-            {
-                LOG_IF_FAILED(func(hThread, L"Rendering Output Thread"));
-            }
+    if (SUCCEEDED(hr))
+    {
+        HANDLE hSynchronizedOutputEvent = CreateEventW(nullptr,
+                                                       TRUE, // manual reset event
+                                                       TRUE, // initially signaled
+                                                       nullptr);
+
+        if (hSynchronizedOutputEvent == nullptr)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        else
+        {
+            _hSynchronizedOutputEvent = hSynchronizedOutputEvent;
+        }
+    }
+
+    if (SUCCEEDED(hr))
+    {
+        HANDLE hTrimEvent = CreateEventW(nullptr,
+                                         FALSE, // auto reset event
+                                         FALSE, // initially unsignaled
+                                         nullptr);
+
+        if (hTrimEvent == nullptr)
+        {
+            hr = HRESULT_FROM_WIN32(GetLastError());
+        }
+        else
+        {
+            _hTrimEvent = hTrimEvent;
         }
     }
 
     return hr;
 }
 
+// Method Description:
+// - Creates the thread we'll be doing work on.
+// - Until painting is enabled the thread would do nothing but wait. Terminals
+//   in background tabs, which don't get a swap chain before they're first
+//   shown, thus don't cost a thread until then.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RenderThread::_CreateThread() noexcept
+{
+    HANDLE hThread = CreateThread(nullptr, // non-inheritable security attributes
+                                  0, // use default stack size
+                                  s_ThreadProc,
+                                  this,
+                                  0, // create immediately
+                                  nullptr // we don't need the thread ID
+    );
+
+    if (hThread == nullptr)
+    {
+        LOG_LAST_ERROR();
+        return;
+    }
+
+    _hThread = hThread;
+
+    // SetThreadDescription only works on 1607 and higher. If we cannot find it,
+    // then it's no big deal. Just skip setting the description.
+    auto func = GetProcAddressByFunctionDeclaration(GetModuleHandleW(L"kernel32.dll"), SetThreadDescription);
+    if (func)
+    {
+        LOG_IF_FAILED(func(hThread, L"Rendering Output Thread"));
+    }
+}
+
 DWORD WINAPI RenderThread::s_ThreadProc(_In_ LPVOID lpParameter)
 {
     RenderThread* const pContext = static_cast<RenderThread*>(lpParameter);
@@ -208,6 +299,34 @@ DWORD WINAPI RenderThread::_ThreadProc()
             ResetEvent(_hEvent);
         }
 
+        // Nobody can see what we paint while the window is minimized or
+        // occluded. We still paint every now and then, so that the title and
+        // the accessibility tree don't go stale, but there's no need to keep
+        // up with the output. Returns immediately while we're visible.
+        // Throttled renderers are visible, but get the same treatment while
+        // there's more output than anyone could read.
+        // Hidden renderers (e.g. those of background tabs) don't paint at all.
+        // The engines keep accumulating what's invalid in the meantime, so that
+        // it's all painted in a single frame once the renderer is shown again.
+        // Until then, we release the resources of the renderer whenever we're
+        // asked to (see Renderer::TrimResources()). That happens here on the
+        // render thread, so that it can't race with presenting a frame.
+        const std::array<HANDLE, 2> visibleOrTrim{ _hVisibleEvent, _hTrimEvent };
+        while (WaitForMultipleObjects(gsl::narrow_cast<DWORD>(visibleOrTrim.size()),
+                                      visibleOrTrim.data(),
+                                      FALSE,
+                                      _fHidden.load(std::memory_order_relaxed) ? INFINITE : occludedFrameIntervalMilliseconds) == WAIT_OBJECT_0 + 1)
+        {
+            if (_fTrimRequested.exchange(false, std::memory_order_acq_rel))
+            {
+                _pRenderer->TrimResourcesNow();
+            }
+        }
+
+        // While an application is in the middle of a synchronized update,
+        // whatever we'd paint is only half of it. Returns immediately otherwise.
+        WaitForSingleObject(_hSynchronizedOutputEvent, SynchronizedOutputTimeoutMilliseconds);
+
         ResetEvent(_hPaintCompletedEvent);
 
         _pRenderer->WaitUntilCanRender();
@@ -233,6 +352,7 @@ void RenderThread::NotifyPaint() noexcept
 
 void RenderThread::EnablePainting() noexcept
 {
+    std::call_once(_threadCreated, [this]() noexcept { _CreateThread(); });
     SetEvent(_hPaintEnabledEvent);
 }
 
@@ -241,6 +361,64 @@ void RenderThread::DisablePainting() noexcept
     ResetEvent(_hPaintEnabledEvent);
 }
 
+void RenderThread::SetOccluded(const bool occluded) noexcept
+{
+    _fOccluded.store(occluded, std::memory_order_relaxed);
+    _UpdateVisibility();
+}
+
+void RenderThread::SetHidden(const bool hidden) noexcept
+{
+    _fHidden.store(hidden, std::memory_order_relaxed);
+    _UpdateVisibility();
+}
+
+void RenderThread::SetThrottled(const bool throttled) noexcept
+{
+    _fThrottled.store(throttled, std::memory_order_relaxed);
+    _UpdateVisibility();
+}
+
+// Method Description:
+// - Makes the thread call Renderer::TrimResourcesNow() while it waits to be
+//   shown again. Requests made while the renderer is visible are handled
+//   once it's hidden or occluded, if ever.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RenderThread::RequestTrim() noexcept
+{
+    _fTrimRequested.store(true, std::memory_order_release);
+    SetEvent(_hTrimEvent);
+    // A thread that has nothing to paint waits for the next frame, not for visibility.
+    NotifyPaint();
+}
+
+void RenderThread::SetSynchronizedOutput(const bool enabled) noexcept
+{
+    if (enabled)
+    {
+        ResetEvent(_hSynchronizedOutputEvent);
+    }
+    else
+    {
+        SetEvent(_hSynchronizedOutputEvent);
+    }
+}
+
+void RenderThread::_UpdateVisibility() noexcept
+{
+    if (_fOccluded.load(std::memory_order_relaxed) || _fHidden.load(std::memory_order_relaxed) || _fThrottled.load(std::memory_order_relaxed))
+    {
+        ResetEvent(_hVisibleEvent);
+    }
+    else
+    {
+        SetEvent(_hVisibleEvent);
+    }
+}
+
 void RenderThread::WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) noexcept
 {
     // When rendering takes place via DirectX, and a console application
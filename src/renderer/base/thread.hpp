@@ -21,6 +21,9 @@ namespace Microsoft::Console::Render
     class RenderThread
     {
     public:
+        // While an application is in the middle of a synchronized update, frames are held back for at most this long.
+        static constexpr DWORD SynchronizedOutputTimeoutMilliseconds = 100;
+
         RenderThread();
         ~RenderThread();
 
@@ -29,22 +32,39 @@ namespace Microsoft::Console::Render
         void NotifyPaint() noexcept;
         void EnablePainting() noexcept;
         void DisablePainting() noexcept;
+        void SetOccluded(const bool occluded) noexcept;
+        void SetHidden(const bool hidden) noexcept;
+        void SetThrottled(const bool throttled) noexcept;
+        void RequestTrim() noexcept;
+        void SetSynchronizedOutput(const bool enabled) noexcept;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) noexcept;
 
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
+        void _CreateThread() noexcept;
 
+        // The thread is only created once painting is first enabled. See EnablePainting().
+        std::once_flag _threadCreated;
         HANDLE _hThread;
         HANDLE _hEvent;
 
         HANDLE _hPaintEnabledEvent;
         HANDLE _hPaintCompletedEvent;
+        HANDLE _hVisibleEvent;
+        HANDLE _hSynchronizedOutputEvent;
+        HANDLE _hTrimEvent;
 
         Renderer* _pRenderer; // Non-ownership pointer
 
         bool _fKeepRunning;
         std::atomic<bool> _fNextFrameRequested;
         std::atomic<bool> _fWaiting;
+        std::atomic<bool> _fOccluded;
+        std::atomic<bool> _fHidden;
+        std::atomic<bool> _fThrottled;
+        std::atomic<bool> _fTrimRequested;
+
+        void _UpdateVisibility() noexcept;
     };
 }
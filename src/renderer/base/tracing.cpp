@@ -0,0 +1,218 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "tracing.hpp"
+
+#include "../inc/IRenderEngine.hpp"
+
+#pragma warning(suppress : 26477) // We don't control tracelogging macros
+TRACELOGGING_DEFINE_PROVIDER(g_hConsoleRendererTraceProvider,
+                             "Microsoft.Windows.Console.Render.Renderer",
+                             // tl:{1c6501c2-0f7b-5e84-d32b-f9e45f9b839a}
+                             (0x1c6501c2, 0x0f7b, 0x5e84, 0xd3, 0x2b, 0xf9, 0xe4, 0x5f, 0x9b, 0x83, 0x9a));
+
+using namespace Microsoft::Console::Render;
+
+// Several renderers share the provider in the Terminal (one per pane),
+// but it may only be registered once.
+std::atomic<size_t> RendererTracing::_registrations{ 0 };
+
+RendererTracing::RendererTracing() noexcept
+{
+#ifndef UNIT_TESTING
+    if (_registrations.fetch_add(1) == 0)
+    {
+        TraceLoggingRegister(g_hConsoleRendererTraceProvider);
+    }
+#endif
+}
+
+RendererTracing::~RendererTracing()
+{
+#ifndef UNIT_TESTING
+    if (_registrations.fetch_sub(1) == 1)
+    {
+        TraceLoggingUnregister(g_hConsoleRendererTraceProvider);
+    }
+#endif
+}
+
+// Routine Description:
+// - Starts timing a frame, if anyone is listening or statistics are enabled.
+//   Must be called before the console lock is acquired, so that the time spent
+//   waiting for it is included.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RendererTracing::BeginFrame() noexcept
+{
+    _active = _statisticsEnabled.load(std::memory_order_relaxed) ||
+              TraceLoggingProviderEnabled(g_hConsoleRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+    if (_active)
+    {
+        _frameStart = clock::now();
+        _phaseStart = _frameStart;
+        _phases.fill({});
+        _dirtyCells = 0;
+    }
+}
+
+// Routine Description:
+// - Starts timing the next phase. Only needed if the work since the previous
+//   phase ended, like updating the brushes or painting the title, shouldn't be
+//   attributed to the next one.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void RendererTracing::BeginPhase() noexcept
+{
+    if (_active)
+    {
+        _phaseStart = clock::now();
+    }
+}
+
+// Routine Description:
+// - Attributes the time since the previous phase ended to `phase`.
+// Arguments:
+// - phase - the phase that just ended
+// Return Value:
+// - <none>
+void RendererTracing::EndPhase(const Phase phase) noexcept
+{
+    if (_active)
+    {
+        const auto now = clock::now();
+        til::at(_phases, static_cast<size_t>(phase)) += now - _phaseStart;
+        _phaseStart = now;
+    }
+}
+
+// Routine Description:
+// - Records how many cells the engine is going to repaint in this frame.
+// Arguments:
+// - pEngine - the engine that's painting the frame
+// Return Value:
+// - <none>
+void RendererTracing::TraceDirtyArea(IRenderEngine* const pEngine) noexcept
+{
+    if (_active)
+    {
+        gsl::span<const til::rect> dirtyAreas;
+        if (SUCCEEDED(pEngine->GetDirtyArea(dirtyAreas)))
+        {
+            for (const auto& rect : dirtyAreas)
+            {
+                _dirtyCells += rect.width() * rect.height();
+            }
+        }
+    }
+}
+
+// Routine Description:
+// - Emits the timing of the frame that was just painted, and adds it to the
+//   statistics if they're enabled.
+// Arguments:
+// - pEngine - the engine that painted the frame, or nullptr if all of them did
+// Return Value:
+// - <none>
+void RendererTracing::EndFrame(const IRenderEngine* const pEngine) noexcept
+{
+    // There's only one writer, so there's no need for an atomic read-modify-write.
+    const auto framesPainted = _framesPainted.load(std::memory_order_relaxed) + 1;
+    _framesPainted.store(framesPainted, std::memory_order_relaxed);
+
+    if (!_active)
+    {
+        return;
+    }
+    _active = false;
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    const auto us = [&](const Phase phase) {
+        return gsl::narrow_cast<uint64_t>(duration_cast<microseconds>(til::at(_phases, static_cast<size_t>(phase))).count());
+    };
+    const auto total = gsl::narrow_cast<uint64_t>(duration_cast<microseconds>(clock::now() - _frameStart).count());
+
+    if (_statisticsEnabled.load(std::memory_order_relaxed))
+    {
+        _frameMicroseconds.store(_frameMicroseconds.load(std::memory_order_relaxed) + total, std::memory_order_relaxed);
+        _lockWaitMicroseconds.store(_lockWaitMicroseconds.load(std::memory_order_relaxed) + us(Phase::LockWait), std::memory_order_relaxed);
+    }
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+    TraceLoggingWrite(g_hConsoleRendererTraceProvider,
+                      "PaintFrame",
+                      TraceLoggingDescription("Timing of a frame painted by the renderer, in microseconds"),
+                      TraceLoggingPointer(pEngine, "Engine"),
+                      TraceLoggingUInt64(total, "Total"),
+                      TraceLoggingUInt64(us(Phase::LockWait), "LockWait"),
+                      TraceLoggingUInt64(us(Phase::Background), "Background"),
+                      TraceLoggingUInt64(us(Phase::BufferOutput), "BufferOutput"),
+                      TraceLoggingUInt64(us(Phase::Selection), "Selection"),
+                      TraceLoggingUInt64(us(Phase::Cursor), "Cursor"),
+                      TraceLoggingUInt64(us(Phase::Present), "Present"),
+                      TraceLoggingInt32(_dirtyCells, "DirtyCells"),
+                      TraceLoggingUInt64(framesPainted, "FramesPainted"),
+                      TraceLoggingUInt64(_framesDropped.load(std::memory_order_relaxed), "FramesDropped"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
+
+// Routine Description:
+// - Records that an engine failed to paint a frame.
+// Arguments:
+// - pEngine - the engine that failed to paint the frame
+// - hr - the reason it failed
+// Return Value:
+// - <none>
+void RendererTracing::TraceFrameDropped(const IRenderEngine* const pEngine, const HRESULT hr) noexcept
+{
+    const auto framesDropped = _framesDropped.load(std::memory_order_relaxed) + 1;
+    _framesDropped.store(framesDropped, std::memory_order_relaxed);
+    _active = false;
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+    TraceLoggingWrite(g_hConsoleRendererTraceProvider,
+                      "FrameDropped",
+                      TraceLoggingDescription("A frame the renderer failed to paint"),
+                      TraceLoggingPointer(pEngine, "Engine"),
+                      TraceLoggingHResult(hr, "Result"),
+                      TraceLoggingUInt64(framesDropped, "FramesDropped"),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
+
+// Routine Description:
+// - Enables or disables accumulating the timing of frames into the statistics.
+//   While enabled, every frame is timed, as if someone was listening.
+// Arguments:
+// - enabled - whether the frames painted from now on should be accumulated
+// Return Value:
+// - <none>
+void RendererTracing::SetStatisticsEnabled(const bool enabled) noexcept
+{
+    _statisticsEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+// Routine Description:
+// - Returns the statistics accumulated so far. Callers are expected to
+//   compute rates from the difference between two snapshots.
+// - May be called from any thread.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of frames painted and dropped, and the time spent on them.
+RendererTracing::Statistics RendererTracing::GetStatistics() const noexcept
+{
+    Statistics statistics;
+    statistics.framesPainted = _framesPainted.load(std::memory_order_relaxed);
+    statistics.framesDropped = _framesDropped.load(std::memory_order_relaxed);
+    statistics.frameMicroseconds = _frameMicroseconds.load(std::memory_order_relaxed);
+    statistics.lockWaitMicroseconds = _lockWaitMicroseconds.load(std::memory_order_relaxed);
+    return statistics;
+}
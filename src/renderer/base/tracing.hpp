@@ -0,0 +1,84 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- tracing.hpp
+
+Abstract:
+- This module records the timing of the frames painted by the Renderer to ETW,
+  to tell apart time spent waiting for the console lock, drawing and presenting.
+- Frames are only timed while a session listens to the provider with
+  TIL_KEYWORD_TRACE at the verbose level, so there's no cost otherwise.
+- Alternatively, the timing can be accumulated into Statistics, which can be
+  read from any thread, for instance to display it in a performance overlay.
+--*/
+
+#pragma once
+
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
+
+TRACELOGGING_DECLARE_PROVIDER(g_hConsoleRendererTraceProvider);
+
+namespace Microsoft::Console::Render
+{
+    class IRenderEngine;
+
+    class RendererTracing final
+    {
+    public:
+        enum class Phase : size_t
+        {
+            LockWait,
+            Background,
+            BufferOutput,
+            Selection,
+            Cursor,
+            Present,
+            Count
+        };
+
+        struct Statistics
+        {
+            uint64_t framesPainted = 0;
+            uint64_t framesDropped = 0;
+            // The sum over all frames painted while statistics were enabled.
+            uint64_t frameMicroseconds = 0;
+            uint64_t lockWaitMicroseconds = 0;
+        };
+
+        RendererTracing() noexcept;
+        ~RendererTracing();
+        RendererTracing(const RendererTracing&) = delete;
+        RendererTracing& operator=(const RendererTracing&) = delete;
+
+        void BeginFrame() noexcept;
+        void BeginPhase() noexcept;
+        void EndPhase(const Phase phase) noexcept;
+        void TraceDirtyArea(IRenderEngine* const pEngine) noexcept;
+        void EndFrame(const IRenderEngine* const pEngine) noexcept;
+        void TraceFrameDropped(const IRenderEngine* const pEngine, const HRESULT hr) noexcept;
+
+        void SetStatisticsEnabled(const bool enabled) noexcept;
+        Statistics GetStatistics() const noexcept;
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        static std::atomic<size_t> _registrations;
+
+        bool _active = false;
+        clock::time_point _frameStart;
+        clock::time_point _phaseStart;
+        std::array<clock::duration, static_cast<size_t>(Phase::Count)> _phases{};
+        til::CoordType _dirtyCells = 0;
+
+        // These are written by the painting thread only, but may be read by any, see GetStatistics().
+        std::atomic<bool> _statisticsEnabled{ false };
+        std::atomic<uint64_t> _framesPainted{ 0 };
+        std::atomic<uint64_t> _framesDropped{ 0 };
+        std::atomic<uint64_t> _frameMicroseconds{ 0 };
+        std::atomic<uint64_t> _lockWaitMicroseconds{ 0 };
+    };
+}
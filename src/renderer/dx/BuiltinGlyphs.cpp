@@ -0,0 +1,267 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "BuiltinGlyphs.h"
+
+using namespace Microsoft::Console::Render;
+
+namespace
+{
+    // The 4 arms of a box drawing character, 2 bits each.
+    constexpr uint8_t Light = 1;
+    constexpr uint8_t Heavy = 2;
+    constexpr uint8_t Double = 3;
+
+    constexpr uint8_t lines(uint8_t left, uint8_t up, uint8_t right, uint8_t down) noexcept
+    {
+        return gsl::narrow_cast<uint8_t>(left | up << 2 | right << 4 | down << 6);
+    }
+
+    // The arms of U+2500-U+257F or 0 for characters that are left to the font.
+    // Dashed lines, diagonals and rounded corners look better the way the font
+    // designer drew them, as do double lines, whose joints are intricate.
+    constexpr std::array<uint8_t, 128> boxDrawingLines{
+        lines(1, 0, 1, 0), lines(2, 0, 2, 0), lines(0, 1, 0, 1), lines(0, 2, 0, 2), 0, 0, 0, 0, // U+2500
+        0, 0, 0, 0, lines(0, 0, 1, 1), lines(0, 0, 2, 1), lines(0, 0, 1, 2), lines(0, 0, 2, 2), // U+2508
+        lines(1, 0, 0, 1), lines(2, 0, 0, 1), lines(1, 0, 0, 2), lines(2, 0, 0, 2), lines(0, 1, 1, 0), lines(0, 1, 2, 0), lines(0, 2, 1, 0), lines(0, 2, 2, 0), // U+2510
+        lines(1, 1, 0, 0), lines(2, 1, 0, 0), lines(1, 2, 0, 0), lines(2, 2, 0, 0), lines(0, 1, 1, 1), lines(0, 1, 2, 1), lines(0, 2, 1, 1), lines(0, 1, 1, 2), // U+2518
+        lines(0, 2, 1, 2), lines(0, 2, 2, 1), lines(0, 1, 2, 2), lines(0, 2, 2, 2), lines(1, 1, 0, 1), lines(2, 1, 0, 1), lines(1, 2, 0, 1), lines(1, 1, 0, 2), // U+2520
+        lines(1, 2, 0, 2), lines(2, 2, 0, 1), lines(2, 1, 0, 2), lines(2, 2, 0, 2), lines(1, 0, 1, 1), lines(2, 0, 1, 1), lines(1, 0, 2, 1), lines(2, 0, 2, 1), // U+2528
+        lines(1, 0, 1, 2), lines(2, 0, 1, 2), lines(1, 0, 2, 2), lines(2, 0, 2, 2), lines(1, 1, 1, 0), lines(2, 1, 1, 0), lines(1, 1, 2, 0), lines(2, 1, 2, 0), // U+2530
+        lines(1, 2, 1, 0), lines(2, 2, 1, 0), lines(1, 2, 2, 0), lines(2, 2, 2, 0), lines(1, 1, 1, 1), lines(2, 1, 1, 1), lines(1, 1, 2, 1), lines(2, 1, 2, 1), // U+2538
+        lines(1, 2, 1, 1), lines(1, 1, 1, 2), lines(1, 2, 1, 2), lines(2, 2, 1, 1), lines(1, 2, 2, 1), lines(2, 1, 1, 2), lines(1, 1, 2, 2), lines(2, 2, 2, 1), // U+2540
+        lines(2, 1, 2, 2), lines(2, 2, 1, 2), lines(1, 2, 2, 2), lines(2, 2, 2, 2), 0, 0, 0, 0, // U+2548
+        lines(3, 0, 3, 0), lines(0, 3, 0, 3), 0, 0, 0, 0, 0, 0, // U+2550
+        0, 0, 0, 0, 0, 0, 0, 0, // U+2558
+        0, 0, 0, 0, 0, 0, 0, 0, // U+2560
+        0, 0, 0, 0, 0, 0, 0, 0, // U+2568
+        0, 0, 0, 0, lines(1, 0, 0, 0), lines(0, 1, 0, 0), lines(0, 0, 1, 0), lines(0, 0, 0, 1), // U+2570
+        lines(2, 0, 0, 0), lines(0, 2, 0, 0), lines(0, 0, 2, 0), lines(0, 0, 0, 2), lines(1, 0, 2, 0), lines(0, 1, 0, 2), lines(2, 0, 1, 0), lines(0, 2, 0, 1), // U+2578
+    };
+
+    constexpr wchar_t boxDrawingFirst = 0x2500;
+    constexpr wchar_t blockElementsFirst = 0x2580;
+    constexpr wchar_t blockElementsLast = 0x259F;
+
+    // Where a line of the given thickness starts, if it's centered in a cell of the given size.
+    // Rounding this the same way for every cell is what makes the lines of adjacent cells line up.
+    constexpr int lineStart(int size, int thickness) noexcept
+    {
+        return (size - thickness) / 2;
+    }
+
+    void fillRect(ID2D1RenderTarget* renderTarget, ID2D1Brush* brush, const D2D1_RECT_F& rect, float left, float top, float right, float bottom) noexcept
+    {
+        renderTarget->FillRectangle({ rect.left + left, rect.top + top, rect.left + right, rect.top + bottom }, brush);
+    }
+
+    void drawBoxDrawing(ID2D1RenderTarget* renderTarget, ID2D1Brush* brush, const D2D1_RECT_F& rect, int width, int height, uint8_t arms) noexcept
+    {
+        // Light lines are as thick as the font's strokes roughly are, which is about
+        // an eighth of the cell's width. Heavy lines are twice as thick.
+        const auto light = std::max(1, static_cast<int>(std::lround(width / 8.0f)));
+        const auto thickness = [=](uint8_t line) noexcept {
+            return line == Light ? light : line == Heavy ? 2 * light : 3 * light;
+        };
+
+        const uint8_t left = arms & 3;
+        const uint8_t up = arms >> 2 & 3;
+        const uint8_t right = arms >> 4 & 3;
+        const uint8_t down = arms >> 6 & 3;
+
+        // The horizontal arms extend across the vertical ones and vice versa,
+        // so that the joints are filled in, while the arms of a lone "╴" end in the center.
+        const auto vertical = std::max(up, down);
+        const auto horizontal = std::max(left, right);
+        const auto verticalStart = vertical ? lineStart(width, thickness(vertical)) : width / 2;
+        const auto verticalEnd = vertical ? verticalStart + thickness(vertical) : width / 2;
+        const auto horizontalStart = horizontal ? lineStart(height, thickness(horizontal)) : height / 2;
+        const auto horizontalEnd = horizontal ? horizontalStart + thickness(horizontal) : height / 2;
+
+        // A double line is two light lines, a light line apart.
+        const auto drawHorizontal = [&](uint8_t line, int x1, int x2) {
+            const auto t = thickness(line);
+            const auto y = lineStart(height, t);
+            if (line == Double)
+            {
+                fillRect(renderTarget, brush, rect, static_cast<float>(x1), static_cast<float>(y), static_cast<float>(x2), static_cast<float>(y + light));
+                fillRect(renderTarget, brush, rect, static_cast<float>(x1), static_cast<float>(y + 2 * light), static_cast<float>(x2), static_cast<float>(y + t));
+            }
+            else
+            {
+                fillRect(renderTarget, brush, rect, static_cast<float>(x1), static_cast<float>(y), static_cast<float>(x2), static_cast<float>(y + t));
+            }
+        };
+        const auto drawVertical = [&](uint8_t line, int y1, int y2) {
+            const auto t = thickness(line);
+            const auto x = lineStart(width, t);
+            if (line == Double)
+            {
+                fillRect(renderTarget, brush, rect, static_cast<float>(x), static_cast<float>(y1), static_cast<float>(x + light), static_cast<float>(y2));
+                fillRect(renderTarget, brush, rect, static_cast<float>(x + 2 * light), static_cast<float>(y1), static_cast<float>(x + t), static_cast<float>(y2));
+            }
+            else
+            {
+                fillRect(renderTarget, brush, rect, static_cast<float>(x), static_cast<float>(y1), static_cast<float>(x + t), static_cast<float>(y2));
+            }
+        };
+
+        // Arms of the same kind on opposite sides are drawn as a single rectangle.
+        if (left && left == right)
+        {
+            drawHorizontal(left, 0, width);
+        }
+        else
+        {
+            if (left)
+            {
+                drawHorizontal(left, 0, verticalEnd);
+            }
+            if (right)
+            {
+                drawHorizontal(right, verticalStart, width);
+            }
+        }
+
+        if (up && up == down)
+        {
+            drawVertical(up, 0, height);
+        }
+        else
+        {
+            if (up)
+            {
+                drawVertical(up, 0, horizontalEnd);
+            }
+            if (down)
+            {
+                drawVertical(down, horizontalStart, height);
+            }
+        }
+    }
+
+    void drawBlockElement(ID2D1RenderTarget* renderTarget, ID2D1Brush* brush, const D2D1_RECT_F& rect, int width, int height, wchar_t ch) noexcept
+    {
+        const auto w = static_cast<float>(width);
+        const auto h = static_cast<float>(height);
+        // The eighths are rounded to whole pixels, so that adjacent blocks don't overlap or leave gaps.
+        const auto eighthX = [=](int n) noexcept { return std::round(w * n / 8.0f); };
+        const auto eighthY = [=](int n) noexcept { return std::round(h * n / 8.0f); };
+        const auto halfX = eighthX(4);
+        const auto halfY = eighthY(4);
+
+        switch (ch)
+        {
+        case 0x2580: // ▀ upper half block
+            fillRect(renderTarget, brush, rect, 0, 0, w, halfY);
+            return;
+        case 0x2588: // █ full block
+            fillRect(renderTarget, brush, rect, 0, 0, w, h);
+            return;
+        case 0x2590: // ▐ right half block
+            fillRect(renderTarget, brush, rect, halfX, 0, w, h);
+            return;
+        case 0x2591: // ░ light shade
+        case 0x2592: // ▒ medium shade
+        case 0x2593: // ▓ dark shade
+        {
+            const auto opacity = brush->GetOpacity();
+            brush->SetOpacity(opacity * (ch - 0x2590) / 4.0f);
+            fillRect(renderTarget, brush, rect, 0, 0, w, h);
+            brush->SetOpacity(opacity);
+            return;
+        }
+        case 0x2594: // ▔ upper one eighth block
+            fillRect(renderTarget, brush, rect, 0, 0, w, eighthY(1));
+            return;
+        case 0x2595: // ▕ right one eighth block
+            fillRect(renderTarget, brush, rect, eighthX(7), 0, w, h);
+            return;
+        default:
+            break;
+        }
+
+        if (ch >= 0x2581 && ch <= 0x2587)
+        {
+            // ▁▂▃▄▅▆▇ lower one eighth up to seven eighths block
+            fillRect(renderTarget, brush, rect, 0, eighthY(0x2588 - ch), w, h);
+            return;
+        }
+        if (ch >= 0x2589 && ch <= 0x258F)
+        {
+            // ▉▊▋▌▍▎▏ left seven eighths down to one eighth block
+            fillRect(renderTarget, brush, rect, 0, 0, eighthX(0x2590 - ch), h);
+            return;
+        }
+
+        // ▖▗▘▙▚▛▜▝▞▟ quadrants, in order: upper left, upper right, lower left, lower right.
+        static constexpr std::array<uint8_t, 10> quadrants{ 0b0100, 0b1000, 0b0001, 0b1101, 0b1001, 0b0111, 0b1011, 0b0010, 0b0110, 0b1110 };
+        const auto mask = til::at(quadrants, ch - 0x2596);
+        if (mask & 0b0001)
+        {
+            fillRect(renderTarget, brush, rect, 0, 0, halfX, halfY);
+        }
+        if (mask & 0b0010)
+        {
+            fillRect(renderTarget, brush, rect, halfX, 0, w, halfY);
+        }
+        if (mask & 0b0100)
+        {
+            fillRect(renderTarget, brush, rect, 0, halfY, halfX, h);
+        }
+        if (mask & 0b1000)
+        {
+            fillRect(renderTarget, brush, rect, halfX, halfY, w, h);
+        }
+    }
+}
+
+// Routine Description:
+// - Returns whether DrawBuiltinGlyph() knows how to draw the given character.
+// Arguments:
+// - ch - The character to check
+// Return Value:
+// - true if the character will be drawn without the font
+[[nodiscard]] bool BuiltinGlyphs::IsBuiltinGlyph(wchar_t ch) noexcept
+{
+    if (ch >= blockElementsFirst && ch <= blockElementsLast)
+    {
+        return true;
+    }
+    if (ch >= boxDrawingFirst && ch < blockElementsFirst)
+    {
+        return til::at(boxDrawingLines, ch - boxDrawingFirst) != 0;
+    }
+    return false;
+}
+
+// Routine Description:
+// - Draws a character for which IsBuiltinGlyph() returned true.
+// Arguments:
+// - renderTarget - The target to draw into
+// - brush - The brush to draw with, usually the foreground color
+// - rect - The cell(s) the character occupies, in pixels
+// - ch - The character to draw
+void BuiltinGlyphs::DrawBuiltinGlyph(ID2D1RenderTarget* renderTarget, ID2D1Brush* brush, const D2D1_RECT_F& rect, wchar_t ch) noexcept
+{
+    const auto width = static_cast<int>(std::lround(rect.right - rect.left));
+    const auto height = static_cast<int>(std::lround(rect.bottom - rect.top));
+    if (width <= 0 || height <= 0)
+    {
+        return;
+    }
+
+    // The lines need to be aligned with the pixel grid to look crisp.
+    const D2D1_RECT_F snapped{ std::round(rect.left), std::round(rect.top), std::round(rect.right), std::round(rect.bottom) };
+
+    if (ch >= blockElementsFirst && ch <= blockElementsLast)
+    {
+        drawBlockElement(renderTarget, brush, snapped, width, height, ch);
+    }
+    else if (ch >= boxDrawingFirst && ch < blockElementsFirst)
+    {
+        drawBoxDrawing(renderTarget, brush, snapped, width, height, til::at(boxDrawingLines, ch - boxDrawingFirst));
+    }
+}
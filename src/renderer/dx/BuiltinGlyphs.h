@@ -0,0 +1,16 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <d2d1.h>
+
+namespace Microsoft::Console::Render::BuiltinGlyphs
+{
+    // Box drawing characters (U+2500-U+257F) made up of straight lines and all
+    // block elements (U+2580-U+259F) are drawn as rectangles snapped to the pixel
+    // grid instead of using the font. This is both a lot faster than drawing
+    // their outlines and ensures that they connect seamlessly at any cell size.
+    [[nodiscard]] bool IsBuiltinGlyph(wchar_t ch) noexcept;
+    void DrawBuiltinGlyph(ID2D1RenderTarget* renderTarget, ID2D1Brush* brush, const D2D1_RECT_F& rect, wchar_t ch) noexcept;
+}
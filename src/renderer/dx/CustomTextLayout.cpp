@@ -11,6 +11,7 @@
 #include <VersionHelpers.h>
 
 #include "BoxDrawingEffect.h"
+#include "BuiltinGlyphs.h"
 
 using namespace Microsoft::Console::Render;
 
@@ -18,8 +19,10 @@ using namespace Microsoft::Console::Render;
 // - Creates a CustomTextLayout object for calculating which glyphs should be placed and where
 // Arguments:
 // - dxFontRenderData - The DirectWrite font render data for our layout
-CustomTextLayout::CustomTextLayout(gsl::not_null<DxFontRenderData*> const fontRenderData) :
+// - frameArena - The resource the temporaries of shaping a run are allocated from
+CustomTextLayout::CustomTextLayout(gsl::not_null<DxFontRenderData*> const fontRenderData, std::pmr::memory_resource* const frameArena) :
     _fontRenderData{ fontRenderData },
+    _frameArena{ frameArena },
     _formatInUse{ fontRenderData->DefaultTextFormat().Get() },
     _fontInUse{ fontRenderData->DefaultFontFace().Get() },
     _numberSubstitution{},
@@ -103,9 +106,7 @@ CATCH_RETURN()
     _formatInUse = _fontRenderData->DefaultTextFormat().Get();
     _fontInUse = _fontRenderData->DefaultFontFace().Get();
 
-    RETURN_IF_FAILED(_AnalyzeTextComplexity());
-    RETURN_IF_FAILED(_AnalyzeRuns());
-    RETURN_IF_FAILED(_ShapeGlyphRuns());
+    RETURN_IF_FAILED(_AnalyzeAndShapeGlyphRuns());
 
     const auto totalAdvance = std::accumulate(_glyphAdvances.cbegin(), _glyphAdvances.cend(), 0.0f);
 
@@ -162,9 +163,7 @@ try
     _formatInUse = _fontRenderData->TextFormatWithAttribute(weight, style, stretch).Get();
     _fontInUse = _fontRenderData->FontFaceWithAttribute(weight, style, stretch).Get();
 
-    RETURN_IF_FAILED(_AnalyzeTextComplexity());
-    RETURN_IF_FAILED(_AnalyzeRuns());
-    RETURN_IF_FAILED(_ShapeGlyphRuns());
+    RETURN_IF_FAILED(_AnalyzeAndShapeGlyphRuns());
     RETURN_IF_FAILED(_CorrectGlyphRuns());
     // Correcting box drawing has to come after both font fallback and
     // the glyph run advance correction (which will apply a font size scaling factor).
@@ -177,6 +176,47 @@ try
 }
 CATCH_RETURN()
 
+// Routine Description:
+// - Analyzes and shapes the text into glyph runs. See _AnalyzeTextComplexity(), _AnalyzeRuns()
+//   and _ShapeGlyphRuns() for details.
+// - Lines are often redrawn without having changed, for instance when the cursor blinks.
+//   The results are thus cached in the font render data and reused for the same text and font.
+// Arguments:
+// - <none> - Uses internal state
+// Return Value:
+// - S_OK or suitable DirectWrite or STL error code
+[[nodiscard]] HRESULT CustomTextLayout::_AnalyzeAndShapeGlyphRuns() noexcept
+try
+{
+    if (const auto cached = _fontRenderData->FindShapedGlyphRuns(_fontInUse, _text))
+    {
+        _isEntireTextSimple = cached->isEntireTextSimple;
+        _runs = cached->runs;
+        _numberSubstitution = cached->numberSubstitution;
+        _glyphOffsets = cached->glyphOffsets;
+        _glyphClusters = cached->glyphClusters;
+        _glyphIndices = cached->glyphIndices;
+        _glyphAdvances = cached->glyphAdvances;
+        return S_OK;
+    }
+
+    RETURN_IF_FAILED(_AnalyzeTextComplexity());
+    RETURN_IF_FAILED(_AnalyzeRuns());
+    RETURN_IF_FAILED(_ShapeGlyphRuns());
+
+    auto shapedGlyphRuns = std::make_shared<ShapedGlyphRuns>();
+    shapedGlyphRuns->isEntireTextSimple = _isEntireTextSimple;
+    shapedGlyphRuns->runs = _runs;
+    shapedGlyphRuns->numberSubstitution = _numberSubstitution;
+    shapedGlyphRuns->glyphOffsets = _glyphOffsets;
+    shapedGlyphRuns->glyphClusters = _glyphClusters;
+    shapedGlyphRuns->glyphIndices = _glyphIndices;
+    shapedGlyphRuns->glyphAdvances = _glyphAdvances;
+    _fontRenderData->InsertShapedGlyphRuns(_fontInUse, _text, std::move(shapedGlyphRuns));
+    return S_OK;
+}
+CATCH_RETURN()
+
 // Routine Description:
 // - Uses the internal text information and the analyzers/font information from construction
 //   to determine the complexity of the text. If the text is determined to be entirely simple,
@@ -400,8 +440,8 @@ CATCH_RETURN()
             return S_OK;
         }
 
-        std::vector<DWRITE_SHAPING_TEXT_PROPERTIES> textProps(textLength);
-        std::vector<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps(maxGlyphCount);
+        std::pmr::vector<DWRITE_SHAPING_TEXT_PROPERTIES> textProps(textLength, _frameArena);
+        std::pmr::vector<DWRITE_SHAPING_GLYPH_PROPERTIES> glyphProps(maxGlyphCount, _frameArena);
 
         // Get the features to apply to the font
         const auto& features = _fontRenderData->DefaultFontFeatures();
@@ -1465,8 +1505,10 @@ try
         // If we found one, keep looking forward until we find NOT a box drawing character.
         else
         {
-            // Find the last box drawing character.
-            const auto lastBox = std::find_if(firstBox, str.cend(), [](wchar_t wch) { return !_IsBoxDrawingCharacter(wch); });
+            // Find the last box drawing character. Characters that CustomTextRenderer draws itself
+            // go into runs of their own, as it can then skip drawing their glyphs entirely.
+            const auto builtin = BuiltinGlyphs::IsBuiltinGlyph(*firstBox);
+            const auto lastBox = std::find_if(firstBox, str.cend(), [=](wchar_t wch) { return !_IsBoxDrawingCharacter(wch) || BuiltinGlyphs::IsBuiltinGlyph(wch) != builtin; });
 
             // Skip distance is how far we had to move forward to find a box.
             const auto firstBoxDistance = std::distance(str.cbegin(), firstBox);
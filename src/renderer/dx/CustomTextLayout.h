@@ -21,7 +21,7 @@ namespace Microsoft::Console::Render
     public:
         // Based on the Windows 7 SDK sample at https://github.com/pauldotknopf/WindowsSDK7-Samples/tree/master/multimedia/DirectWrite/CustomLayout
 
-        CustomTextLayout(gsl::not_null<DxFontRenderData*> const fontRenderData);
+        CustomTextLayout(gsl::not_null<DxFontRenderData*> const fontRenderData, std::pmr::memory_resource* const frameArena = til::pmr::get_default_resource());
 
         [[nodiscard]] HRESULT STDMETHODCALLTYPE AppendClusters(const gsl::span<const ::Microsoft::Console::Render::Cluster> clusters);
 
@@ -131,6 +131,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT STDMETHODCALLTYPE _AnalyzeBoxDrawing(gsl::not_null<IDWriteTextAnalysisSource*> const source, UINT32 textPosition, UINT32 textLength);
         [[nodiscard]] HRESULT STDMETHODCALLTYPE _SetBoxEffect(UINT32 textPosition, UINT32 textLength);
 
+        [[nodiscard]] HRESULT _AnalyzeAndShapeGlyphRuns() noexcept;
         [[nodiscard]] HRESULT _AnalyzeTextComplexity() noexcept;
         [[nodiscard]] HRESULT _AnalyzeRuns() noexcept;
         [[nodiscard]] HRESULT _ShapeGlyphRuns() noexcept;
@@ -152,6 +153,9 @@ namespace Microsoft::Console::Render
         // DirectWrite font render data
         DxFontRenderData* _fontRenderData;
 
+        // The temporaries of a single call are allocated from this. See DxEngine::EndPaint().
+        std::pmr::memory_resource* _frameArena = til::pmr::get_default_resource();
+
         // DirectWrite text formats
         IDWriteTextFormat* _formatInUse;
 
@@ -206,6 +210,8 @@ namespace Microsoft::Console::Render
         // These are used to further break the runs apart and adjust the font size so glyphs fit inside the cells.
         std::vector<ScaleCorrection> _glyphScaleCorrections;
 
+        friend struct ShapedGlyphRuns;
+
 #ifdef UNIT_TESTING
     public:
         CustomTextLayout() = default;
@@ -213,4 +219,17 @@ namespace Microsoft::Console::Render
         friend class CustomTextLayoutTests;
 #endif
     };
+
+    // The state CustomTextLayout is left in by _AnalyzeTextComplexity(), _AnalyzeRuns() and _ShapeGlyphRuns().
+    // DxFontRenderData caches it, as analyzing and shaping the same text over and over again is costly.
+    struct ShapedGlyphRuns
+    {
+        bool isEntireTextSimple = false;
+        std::vector<CustomTextLayout::LinkedRun> runs;
+        ::Microsoft::WRL::ComPtr<IDWriteNumberSubstitution> numberSubstitution;
+        std::vector<DWRITE_GLYPH_OFFSET> glyphOffsets;
+        std::vector<UINT16> glyphClusters;
+        std::vector<UINT16> glyphIndices;
+        std::vector<float> glyphAdvances;
+    };
 }
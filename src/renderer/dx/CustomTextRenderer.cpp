@@ -6,6 +6,7 @@
 #include "CustomTextRenderer.h"
 
 #include "../../inc/DefaultSettings.h"
+#include "BuiltinGlyphs.h"
 
 #include <wrl.h>
 #include <wrl/client.h>
@@ -592,10 +593,16 @@ CATCH_RETURN()
     }
     // Now go onto drawing the text.
 
-    // First check if we want a color font and try to extract color emoji first.
     // Color emoji are only available on Windows 10+
     static const bool s_isWindows10OrGreater = IsWindows10OrGreater();
-    if (WI_IsFlagSet(drawingContext->options, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT) && s_isWindows10OrGreater)
+
+    // Box drawing characters and block elements don't need the font at all.
+    if (_IsBuiltinGlyphRun(glyphRun, glyphRunDescription))
+    {
+        _DrawBuiltinGlyphRun(drawingContext, origin, glyphRun, glyphRunDescription);
+    }
+    // Otherwise check if we want a color font and try to extract color emoji first.
+    else if (WI_IsFlagSet(drawingContext->options, D2D1_DRAW_TEXT_OPTIONS_ENABLE_COLOR_FONT) && s_isWindows10OrGreater)
     {
         ::Microsoft::WRL::ComPtr<ID2D1DeviceContext4> d2dContext4;
         RETURN_IF_FAILED(d2dContext.As(&d2dContext4));
@@ -799,6 +806,55 @@ CATCH_RETURN()
     return S_OK;
 }
 
+// Routine Description:
+// - Checks whether all characters of a glyph run can be drawn by BuiltinGlyphs.
+//   CustomTextLayout puts those into runs of their own.
+// Arguments:
+// - glyphRun - The glyphs to draw
+// - glyphRunDescription - The text the glyphs represent
+// Return Value:
+// - true if _DrawBuiltinGlyphRun() should be used to draw the run
+[[nodiscard]] bool CustomTextRenderer::_IsBuiltinGlyphRun(_In_ const DWRITE_GLYPH_RUN* glyphRun,
+                                                         _In_opt_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription) noexcept
+{
+    // Box drawing characters map 1:1 to their glyphs, and are never right-to-left.
+    if (!glyphRunDescription || !glyphRunDescription->string || glyphRun->glyphCount != glyphRunDescription->stringLength || WI_IsFlagSet(glyphRun->bidiLevel, 1))
+    {
+        return false;
+    }
+
+    // CustomTextLayout passes the entire text along with the position of the run in it.
+    const std::wstring_view text{ glyphRunDescription->string + glyphRunDescription->textPosition, glyphRunDescription->stringLength };
+    return !text.empty() && std::all_of(text.begin(), text.end(), BuiltinGlyphs::IsBuiltinGlyph);
+}
+
+// Routine Description:
+// - Draws a run of box drawing characters and block elements as rectangles,
+//   bypassing the font. See BuiltinGlyphs.
+// Arguments:
+// - clientDrawingContext - Our drawing context
+// - origin - The top left corner of the run
+// - glyphRun - The glyphs to draw, for their advances
+// - glyphRunDescription - The text the glyphs represent
+void CustomTextRenderer::_DrawBuiltinGlyphRun(DrawingContext* clientDrawingContext,
+                                              D2D1_POINT_2F origin,
+                                              _In_ const DWRITE_GLYPH_RUN* glyphRun,
+                                              _In_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription) noexcept
+{
+    const auto text = glyphRunDescription->string + glyphRunDescription->textPosition;
+    auto x = origin.x;
+
+    for (UINT32 i = 0; i < glyphRun->glyphCount; ++i)
+    {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        const auto advance = glyphRun->glyphAdvances[i];
+        const D2D1_RECT_F rect{ x, origin.y, x + advance, origin.y + clientDrawingContext->cellSize.height };
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+        BuiltinGlyphs::DrawBuiltinGlyph(clientDrawingContext->renderTarget, clientDrawingContext->foregroundBrush, rect, text[i]);
+        x += advance;
+    }
+}
+
 [[nodiscard]] HRESULT CustomTextRenderer::_DrawBoxRunManually(DrawingContext* clientDrawingContext,
                                                               D2D1_POINT_2F baselineOrigin,
                                                               DWRITE_MEASURING_MODE /*measuringMode*/,
@@ -126,6 +126,14 @@ namespace Microsoft::Console::Render
                                                  ID2D1Brush* brush,
                                                  _In_opt_ IUnknown* clientDrawingEffect);
 
+        [[nodiscard]] static bool _IsBuiltinGlyphRun(_In_ const DWRITE_GLYPH_RUN* glyphRun,
+                                                     _In_opt_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription) noexcept;
+
+        static void _DrawBuiltinGlyphRun(DrawingContext* clientDrawingContext,
+                                         D2D1_POINT_2F origin,
+                                         _In_ const DWRITE_GLYPH_RUN* glyphRun,
+                                         _In_ const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription) noexcept;
+
         [[nodiscard]] HRESULT _DrawBoxRunManually(DrawingContext* clientDrawingContext,
                                                   D2D1_POINT_2F baselineOrigin,
                                                   DWRITE_MEASURING_MODE measuringMode,
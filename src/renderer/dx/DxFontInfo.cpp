@@ -13,6 +13,47 @@ static constexpr std::wstring_view FALLBACK_FONT_FACES[] = { L"Consolas", L"Luci
 
 using namespace Microsoft::Console::Render;
 
+// Every pane and window resolves its font and builds the collection of the fonts
+// sitting next to our binary, which costs tens of milliseconds each time. Since
+// they mostly ask for the same font, the results are shared by all DxFontInfo in
+// the process and released along with the last one that used them.
+struct DxFontInfo::FontCache
+{
+    // The requested family name, weight, style, stretch and locale.
+    using Key = std::tuple<std::wstring, DWRITE_FONT_WEIGHT, DWRITE_FONT_STYLE, DWRITE_FONT_STRETCH, std::wstring>;
+
+    // What ResolveFontFaceWithFallback() found for a Key.
+    struct Face
+    {
+        ::Microsoft::WRL::ComPtr<IDWriteFontFace1> fontFace;
+        ::Microsoft::WRL::ComPtr<IDWriteFontCollection> nearbyCollection;
+        std::wstring familyName;
+        DWRITE_FONT_WEIGHT weight;
+        DWRITE_FONT_STYLE style;
+        DWRITE_FONT_STRETCH stretch;
+        std::wstring localeName;
+    };
+
+    static std::shared_ptr<FontCache> Get()
+    {
+        static std::mutex instanceMutex;
+        static std::weak_ptr<FontCache> instance;
+
+        const std::scoped_lock lock{ instanceMutex };
+        auto cache = instance.lock();
+        if (!cache)
+        {
+            cache = std::make_shared<FontCache>();
+            instance = cache;
+        }
+        return cache;
+    }
+
+    std::mutex mutex;
+    std::map<Key, Face> faces;
+    ::Microsoft::WRL::ComPtr<IDWriteFontCollection> nearbyCollection;
+};
+
 DxFontInfo::DxFontInfo() noexcept :
     _familyName(),
     _weight(DWRITE_FONT_WEIGHT_NORMAL),
@@ -114,6 +155,8 @@ void DxFontInfo::SetFromEngine(const std::wstring_view familyName,
 
 // Routine Description:
 // - Attempts to locate the font given, but then begins falling back if we cannot find it.
+// - Fonts that were found without falling back are remembered for all instances, so that
+//   resolving the same font again doesn't need to ask DirectWrite.
 // - We'll try to fall back to Consolas with the given weight/stretch/style first,
 //   then try Consolas again with normal weight/stretch/style,
 //   and if nothing works, then we'll throw an error.
@@ -125,6 +168,28 @@ void DxFontInfo::SetFromEngine(const std::wstring_view familyName,
 [[nodiscard]] Microsoft::WRL::ComPtr<IDWriteFontFace1> DxFontInfo::ResolveFontFaceWithFallback(gsl::not_null<IDWriteFactory1*> dwriteFactory,
                                                                                                std::wstring& localeName)
 {
+    if (!_cache)
+    {
+        _cache = FontCache::Get();
+    }
+
+    FontCache::Key key{ _familyName, _weight, _style, _stretch, localeName };
+    {
+        const std::scoped_lock lock{ _cache->mutex };
+        if (const auto it = _cache->faces.find(key); it != _cache->faces.end())
+        {
+            const auto& cached = it->second;
+            _familyName = cached.familyName;
+            _weight = cached.weight;
+            _style = cached.style;
+            _stretch = cached.stretch;
+            _nearbyCollection = cached.nearbyCollection;
+            _didFallback = false;
+            localeName = cached.localeName;
+            return cached.fontFace;
+        }
+    }
+
     // First attempt to find exactly what the user asked for.
     _didFallback = false;
     Microsoft::WRL::ComPtr<IDWriteFontFace1> face{ nullptr };
@@ -204,6 +269,13 @@ void DxFontInfo::SetFromEngine(const std::wstring_view familyName,
 
     THROW_HR_IF_NULL(E_FAIL, face);
 
+    // Falling back isn't remembered, so that we find the requested font as soon as it's installed.
+    if (!_didFallback)
+    {
+        const std::scoped_lock lock{ _cache->mutex };
+        _cache->faces.insert_or_assign(std::move(key), FontCache::Face{ face, _nearbyCollection, _familyName, _weight, _style, _stretch, localeName });
+    }
+
     return face;
 }
 
@@ -331,6 +403,7 @@ void DxFontInfo::SetFromEngine(const std::wstring_view familyName,
 // Routine Description:
 // - Creates a DirectWrite font collection of font files that are sitting next to the running
 //   binary (in the same directory as the EXE).
+// - The collection is built once and shared by all instances through the FontCache.
 // Arguments:
 // - dwriteFactory - The DWrite factory to use
 // Return Value:
@@ -342,6 +415,13 @@ void DxFontInfo::SetFromEngine(const std::wstring_view familyName,
         return _nearbyCollection.Get();
     }
 
+    const std::scoped_lock lock{ _cache->mutex };
+    if (_cache->nearbyCollection)
+    {
+        _nearbyCollection = _cache->nearbyCollection;
+        return _nearbyCollection.Get();
+    }
+
     // The convenience interfaces for loading fonts from files
     // are only available on Windows 10+.
     ::Microsoft::WRL::ComPtr<IDWriteFactory6> factory6;
@@ -375,6 +455,7 @@ void DxFontInfo::SetFromEngine(const std::wstring_view familyName,
     ::Microsoft::WRL::ComPtr<IDWriteFontCollection1> fontCollection;
     THROW_IF_FAILED(factory6->CreateFontCollectionFromFontSet(fontSet.Get(), &fontCollection));
 
+    _cache->nearbyCollection = fontCollection;
     _nearbyCollection = fontCollection;
     return _nearbyCollection.Get();
 }
@@ -52,6 +52,8 @@ namespace Microsoft::Console::Render
                                                                                              std::wstring& localeName);
 
     private:
+        struct FontCache;
+
         [[nodiscard]] ::Microsoft::WRL::ComPtr<IDWriteFontFace1> _FindFontFace(gsl::not_null<IDWriteFactory1*> dwriteFactory,
                                                                                std::wstring& localeName,
                                                                                const bool withNearbyLookup);
@@ -63,6 +65,9 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] static std::vector<std::filesystem::path> s_GetNearbyFonts();
 
+        // Shared by all instances, for as long as any of them uses it.
+        std::shared_ptr<FontCache> _cache;
+
         ::Microsoft::WRL::ComPtr<IDWriteFontCollection> _nearbyCollection;
 
         // The font name we should be looking for
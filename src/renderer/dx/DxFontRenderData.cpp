@@ -8,6 +8,7 @@
 #include "unicode.hpp"
 
 #include <VersionHelpers.h>
+#include <til/hash.h>
 
 static constexpr float POINTS_PER_INCH = 72.0f;
 static constexpr std::wstring_view FALLBACK_FONT_FACES[] = { L"Consolas", L"Lucida Console", L"Courier New" };
@@ -191,6 +192,7 @@ DxFontRenderData::DxFontRenderData(::Microsoft::WRL::ComPtr<IDWriteFactory1> dwr
         _userLocaleName.clear();
         _textFormatMap.clear();
         _fontFaceMap.clear();
+        _shapedGlyphRuns.clear();
         _boxDrawingEffect.Reset();
 
         // Initialize the default font info and build everything from here.
@@ -478,6 +480,51 @@ void DxFontRenderData::InhibitUserWeight(bool inhibitUserWeight) noexcept
     _inhibitUserWeight = inhibitUserWeight;
 }
 
+// Routine Description:
+// - Looks up the glyph runs CustomTextLayout produced for the given text and font face
+//   during a previous layout, so that unchanged lines don't need to be analyzed again.
+// Arguments:
+// - fontFace - The font face the text was shaped with
+// - text - The text that was shaped
+// Return Value:
+// - The cached glyph runs or nullptr if there are none
+[[nodiscard]] std::shared_ptr<const ShapedGlyphRuns> DxFontRenderData::FindShapedGlyphRuns(IDWriteFontFace1* fontFace, std::wstring_view text)
+{
+    // The font fallback depends on the user's weight axis, unless it's inhibited.
+    _shapedGlyphRunsKey.fontFace = fontFace;
+    _shapedGlyphRunsKey.inhibitUserWeight = _inhibitUserWeight;
+    _shapedGlyphRunsKey.text.assign(text);
+
+    const auto it = _shapedGlyphRuns.find(_shapedGlyphRunsKey);
+    return it != _shapedGlyphRuns.end() ? it->second : nullptr;
+}
+
+// Routine Description:
+// - Remembers the glyph runs CustomTextLayout produced for the given text and font face.
+// - The cache is bounded and starts over once it's full.
+// Arguments:
+// - fontFace - The font face the text was shaped with
+// - text - The text that was shaped
+// - shapedGlyphRuns - The analysis and shaping results
+void DxFontRenderData::InsertShapedGlyphRuns(IDWriteFontFace1* fontFace, std::wstring_view text, std::shared_ptr<const ShapedGlyphRuns> shapedGlyphRuns)
+{
+    if (_shapedGlyphRuns.size() >= _maxShapedGlyphRuns)
+    {
+        _shapedGlyphRuns.clear();
+    }
+
+    _shapedGlyphRuns.insert_or_assign(ShapedGlyphRunsKey{ fontFace, _inhibitUserWeight, std::wstring{ text } }, std::move(shapedGlyphRuns));
+}
+
+size_t DxFontRenderData::ShapedGlyphRunsKeyHasher::operator()(const ShapedGlyphRunsKey& key) const noexcept
+{
+    til::hasher h;
+    h.write(key.fontFace);
+    h.write(key.inhibitUserWeight);
+    h.write(key.text);
+    return h.finalize();
+}
+
 // Routine Description:
 // - Returns whether the set italic in the font axes
 // Return Value:
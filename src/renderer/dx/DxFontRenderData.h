@@ -26,6 +26,9 @@ namespace Microsoft::Console::Render
     };
     DEFINE_ENUM_FLAG_OPERATORS(AxisTagPresence);
 
+    // The results of analyzing and shaping a text with CustomTextLayout. See CustomTextLayout.h.
+    struct ShapedGlyphRuns;
+
     class DxFontRenderData
     {
     public:
@@ -97,9 +100,33 @@ namespace Microsoft::Console::Render
                                                           const DWRITE_FONT_STYLE fontStyle,
                                                           IDWriteTextFormat3* format);
 
+        // Text that was already analyzed and shaped with the given font face, cached across layouts and frames.
+        [[nodiscard]] std::shared_ptr<const ShapedGlyphRuns> FindShapedGlyphRuns(IDWriteFontFace1* fontFace, std::wstring_view text);
+        void InsertShapedGlyphRuns(IDWriteFontFace1* fontFace, std::wstring_view text, std::shared_ptr<const ShapedGlyphRuns> shapedGlyphRuns);
+
     private:
         using FontAttributeMapKey = uint32_t;
 
+        struct ShapedGlyphRunsKey
+        {
+            IDWriteFontFace1* fontFace = nullptr;
+            bool inhibitUserWeight = false;
+            std::wstring text;
+
+            bool operator==(const ShapedGlyphRunsKey& rhs) const noexcept
+            {
+                return fontFace == rhs.fontFace && inhibitUserWeight == rhs.inhibitUserWeight && text == rhs.text;
+            }
+        };
+
+        struct ShapedGlyphRunsKeyHasher
+        {
+            size_t operator()(const ShapedGlyphRunsKey& key) const noexcept;
+        };
+
+        // The cache is cleared once it's full. Anything that's still on screen gets re-added on the next frame.
+        static constexpr size_t _maxShapedGlyphRuns = 1024;
+
         bool _inhibitUserWeight{ false };
         bool _didUserSetItalic{ false };
         bool _didUserSetFeatures{ false };
@@ -126,6 +153,8 @@ namespace Microsoft::Console::Render
 
         std::unordered_map<FontAttributeMapKey, ::Microsoft::WRL::ComPtr<IDWriteTextFormat>> _textFormatMap;
         std::unordered_map<FontAttributeMapKey, ::Microsoft::WRL::ComPtr<IDWriteFontFace1>> _fontFaceMap;
+        std::unordered_map<ShapedGlyphRunsKey, std::shared_ptr<const ShapedGlyphRuns>, ShapedGlyphRunsKeyHasher> _shapedGlyphRuns;
+        ShapedGlyphRunsKey _shapedGlyphRunsKey;
 
         ::Microsoft::WRL::ComPtr<IBoxDrawingEffect> _boxDrawingEffect;
         ::Microsoft::WRL::ComPtr<IDWriteFontFallback> _systemFontFallback;
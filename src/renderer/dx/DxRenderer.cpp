@@ -374,6 +374,19 @@ HRESULT DxEngine::_SetupTerminalEffects()
         return exceptionHr;
     }
 
+    // Shaders that don't read Time look the same on every frame, which is why they only have to
+    // run for frames that changed. The swap chain keeps the result on screen in the meantime.
+    // If we can't tell, we have to assume the shader animates.
+    _pixelShaderUsesTime = true;
+    ::Microsoft::WRL::ComPtr<ID3D11ShaderReflection> reflection;
+    if (SUCCEEDED(D3DReflect(pixelBlob->GetBufferPointer(), pixelBlob->GetBufferSize(), IID_PPV_ARGS(&reflection))))
+    {
+        // For variables that don't exist, GetVariableByName() returns a placeholder whose GetDesc() fails.
+        D3D11_SHADER_VARIABLE_DESC timeDesc{};
+        const auto time = reflection->GetVariableByName("Time");
+        _pixelShaderUsesTime = time && SUCCEEDED(time->GetDesc(&timeDesc)) && WI_IsFlagSet(timeDesc.uFlags, D3D_SVF_USED);
+    }
+
     RETURN_IF_FAILED(_d3dDevice->CreateVertexShader(
         vertexBlob->GetBufferPointer(),
         vertexBlob->GetBufferSize(),
@@ -677,6 +690,8 @@ try
             const HRESULT asResult = _dxgiSwapChain.As(&swapChain2);
             if (SUCCEEDED(asResult))
             {
+                // The default latency of 3 frames would let us render ahead of the display.
+                LOG_IF_FAILED(swapChain2->SetMaximumFrameLatency(1));
                 _swapChainFrameLatencyWaitableObject = wil::unique_handle{ swapChain2->GetFrameLatencyWaitableObject() };
             }
             else
@@ -1012,6 +1027,21 @@ try
 }
 CATCH_LOG()
 
+// Routine Description:
+// - Limits how often shaders that use Time are redrawn. See WaitUntilCanRender().
+// Arguments:
+// - framesPerSecond - the maximum frame rate, or 0 for no limit other than the display's.
+// Return Value:
+// - <none>
+void DxEngine::SetPixelShaderFrameRate(const int framesPerSecond) noexcept
+{
+    _pixelShaderFrameInterval = std::chrono::steady_clock::duration::zero();
+    if (framesPerSecond > 0)
+    {
+        _pixelShaderFrameInterval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds{ 1 }) / framesPerSecond;
+    }
+}
+
 void DxEngine::SetForceFullRepaintRendering(bool enable) noexcept
 try
 {
@@ -1364,6 +1394,9 @@ try
 {
     RETURN_HR_IF(E_INVALIDARG, !_isPainting); // invalid to end paint when we're not painting
 
+    // All of the frame's text has been drawn by now.
+    _frameArena.reset();
+
     HRESULT hr = S_OK;
 
     if (_haveDeviceResources)
@@ -1467,25 +1500,21 @@ CATCH_RETURN()
 }
 
 // Method Description:
-// - When the shaders are on, say that we need to keep redrawing every
-//   possible frame in case they have some smooth action on every frame tick.
-//   It is presumed that if you're using shaders, you're not about performance...
+// - When a shader that uses Time is on, say that we need to keep redrawing
+//   every possible frame, since it has some smooth action on every frame tick.
+//   It is presumed that if you're using such shaders, you're not about performance...
 //   You're instead about OOH SHINY. And that's OK. But returning true here is 100%
-//   a perf detriment.
+//   a perf detriment, which is why it can be limited with SetPixelShaderFrameRate().
 [[nodiscard]] bool DxEngine::RequiresContinuousRedraw() noexcept
 {
-    // We're only going to request continuous redraw if someone is using
-    // a pixel shader from a path because we cannot tell if those are using the
-    // time parameter or not.
-    // And if they are using time, they probably need it to tick continuously.
-    //
-    // By contrast, the in-built retro effect does NOT need it,
-    // so let's not tick for it and save some amount of performance.
+    // Whether the shader reads Time is determined when it's compiled. Shaders
+    // that don't, like the in-built retro effect, look the same every frame,
+    // so let's not tick for them and save some amount of performance.
     //
     // Finally... if we're not using effects at all... let the render thread
     // go to sleep. It deserves it. That thread works hard. Also it sleeping
     // saves battery power and all sorts of related perf things.
-    return _terminalEffectsEnabled && !_pixelShaderPath.empty();
+    return _HasTerminalEffects() && _pixelShaderLoaded && _pixelShaderUsesTime;
 }
 
 // Method Description:
@@ -1493,14 +1522,29 @@ CATCH_RETURN()
 // - See https://docs.microsoft.com/en-us/windows/uwp/gaming/reduce-latency-with-dxgi-1-3-swap-chains.
 void DxEngine::WaitUntilCanRender() noexcept
 {
-    // Throttle the DxEngine a bit down to ~60 FPS.
-    // This improves throughput for rendering complex or colored text.
-    Sleep(8);
+    // Shaders that use Time are redrawn continuously, but not more often than the user allows.
+    // Since those shaders post-process every frame anyways, this limits all of our frames.
+    if (_pixelShaderFrameInterval.count() && RequiresContinuousRedraw())
+    {
+        const auto remaining = _lastPixelShaderFrame + _pixelShaderFrameInterval - std::chrono::steady_clock::now();
+        if (remaining.count() > 0)
+        {
+            Sleep(gsl::narrow_cast<DWORD>(std::chrono::duration_cast<std::chrono::milliseconds>(remaining).count()));
+        }
+    }
 
+    // The frame latency waitable object aligns our frames with the refresh of
+    // the display, which throttles us just enough to improve the throughput
+    // for rendering complex or colored text. It's signaled right away after
+    // we've been idle, so that keystroke echoes aren't delayed.
     if (_swapChainFrameLatencyWaitableObject)
     {
         WaitForSingleObjectEx(_swapChainFrameLatencyWaitableObject.get(), 100, true);
     }
+    else
+    {
+        RenderEngineBase::WaitUntilCanRender();
+    }
 }
 
 // Routine Description:
@@ -1516,6 +1560,7 @@ void DxEngine::WaitUntilCanRender() noexcept
     {
         if (_HasTerminalEffects() && _pixelShaderLoaded)
         {
+            _lastPixelShaderFrame = std::chrono::steady_clock::now();
             const HRESULT hr2 = _PaintTerminalEffects();
             if (FAILED(hr2))
             {
@@ -2005,7 +2050,7 @@ try
     RETURN_IF_FAILED(_fontRenderData->UpdateFont(pfiFontInfoDesired, fiFontInfo, _dpi, features, axes));
 
     // Prepare the text layout.
-    _customLayout = WRL::Make<CustomTextLayout>(_fontRenderData.get());
+    _customLayout = WRL::Make<CustomTextLayout>(_fontRenderData.get(), &_frameArena);
 
     return S_OK;
 }
@@ -65,6 +65,7 @@ namespace Microsoft::Console::Render
         void SetRetroTerminalEffect(bool enable) noexcept override;
 
         void SetPixelShaderPath(std::wstring_view value) noexcept override;
+        void SetPixelShaderFrameRate(const int framesPerSecond) noexcept override;
 
         void SetForceFullRepaintRendering(bool enable) noexcept override;
 
@@ -173,6 +174,8 @@ namespace Microsoft::Console::Render
         bool _firstFrame;
         std::pmr::unsynchronized_pool_resource _pool;
         til::pmr::bitmap _invalidMap;
+        // Temporaries that only live until the end of the frame. It's reset by EndPaint().
+        til::pmr::arena _frameArena;
         til::point _invalidScroll;
         bool _allInvalid;
 
@@ -238,6 +241,11 @@ namespace Microsoft::Console::Render
         //  Allows user to load a pixel shader from a few presets or from a file path
         std::wstring _pixelShaderPath;
         bool _pixelShaderLoaded{ false };
+        // Whether the loaded shader reads Time, which makes it animate even if nothing else changed.
+        bool _pixelShaderUsesTime{ false };
+        // The minimum time between two frames of a shader that uses Time, or zero if there's no limit.
+        std::chrono::steady_clock::duration _pixelShaderFrameInterval{};
+        std::chrono::steady_clock::time_point _lastPixelShaderFrame;
 
         std::chrono::steady_clock::time_point _shaderStartTime;
 
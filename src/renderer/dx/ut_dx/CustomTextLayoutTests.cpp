@@ -97,4 +97,30 @@ class Microsoft::Console::Render::CustomTextLayoutTests
         VERIFY_ARE_EQUAL(1u, layout._runs.at(1).glyphStart);
         VERIFY_ARE_EQUAL(3u, layout._runs.at(1).glyphCount);
     }
+
+    TEST_METHOD(CachesShapedGlyphRunsPerTextAndFont)
+    {
+        DxFontRenderData fontRenderData{ nullptr };
+
+        // The font faces are only used as keys and never dereferenced.
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+        const auto regular = reinterpret_cast<IDWriteFontFace1*>(uintptr_t{ 0x1000 });
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+        const auto bold = reinterpret_cast<IDWriteFontFace1*>(uintptr_t{ 0x2000 });
+
+        auto shaped = std::make_shared<ShapedGlyphRuns>();
+        shaped->glyphIndices = { 1, 2, 3 };
+        fontRenderData.InsertShapedGlyphRuns(regular, L"abc", shaped);
+
+        const auto hit = fontRenderData.FindShapedGlyphRuns(regular, L"abc");
+        VERIFY_IS_NOT_NULL(hit.get());
+        VERIFY_ARE_EQUAL(3u, hit->glyphIndices.size());
+
+        VERIFY_IS_NULL(fontRenderData.FindShapedGlyphRuns(regular, L"abd").get());
+        VERIFY_IS_NULL(fontRenderData.FindShapedGlyphRuns(bold, L"abc").get());
+
+        // The bold variant of a font is shaped without the user's weight axis.
+        fontRenderData.InhibitUserWeight(true);
+        VERIFY_IS_NULL(fontRenderData.FindShapedGlyphRuns(regular, L"abc").get());
+    }
 };
@@ -103,9 +103,6 @@ namespace Microsoft::Console::Render
         TEXTMETRICW _tmFontMetrics;
         FontResource _softFont;
 
-        static const size_t s_cPolyTextCache = 80;
-        POLYTEXTW _pPolyText[s_cPolyTextCache];
-        size_t _cPolyText;
         [[nodiscard]] HRESULT _FlushBufferLines() noexcept;
 
         std::vector<RECT> cursorInvertRects;
@@ -145,6 +142,16 @@ namespace Microsoft::Console::Render
             Soft
         };
         FontType _lastFontType;
+        void _SelectFontType(const FontType fontType) noexcept;
+
+        // The text PaintBufferLine() queued up for _FlushBufferLines(), along with the DC state to draw it with.
+        struct PolyTextEntry
+        {
+            POLYTEXTW polyText;
+            COLORREF foreground;
+            COLORREF background;
+            FontType fontType;
+        };
 
         XFORM _currentLineTransform;
         LineRendition _currentLineRendition;
@@ -155,6 +162,7 @@ namespace Microsoft::Console::Render
         std::pmr::unsynchronized_pool_resource _pool;
         std::pmr::vector<std::pmr::wstring> _polyStrings;
         std::pmr::vector<std::pmr::basic_string<int>> _polyWidths;
+        std::pmr::vector<PolyTextEntry> _polyTexts;
 
         [[nodiscard]] HRESULT _InvalidCombine(const RECT* const prc) noexcept;
         [[nodiscard]] HRESULT _InvalidOffset(const POINT* const ppt) noexcept;
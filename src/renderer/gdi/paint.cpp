@@ -31,7 +31,9 @@ using namespace Microsoft::Console::Render;
     RETURN_HR_IF(S_FALSE, (!IsWindowVisible(_hwndTargetWindow) && !_titleChanged));
 
     // At the beginning of a new frame, we have 0 lines ready for painting in PolyTextOut
-    _cPolyText = 0;
+    _polyTexts.clear();
+    _polyStrings.clear();
+    _polyWidths.clear();
 
     // Prepare our in-memory bitmap for double-buffered composition.
     RETURN_IF_FAILED(_PrepareMemoryBitmap(_hwndTargetWindow));
@@ -326,8 +328,6 @@ using namespace Microsoft::Console::Render;
         POINT ptDraw = { 0 };
         RETURN_IF_FAILED(_ScaleByFont(&coord, &ptDraw));
 
-        const auto pPolyTextLine = &_pPolyText[_cPolyText];
-
         auto& polyString = _polyStrings.emplace_back();
         polyString.reserve(cchLine);
 
@@ -401,27 +401,25 @@ using namespace Microsoft::Console::Render;
         const auto topOffset = _currentLineRendition == LineRendition::DoubleHeightBottom ? halfHeight : 0;
         const auto bottomOffset = _currentLineRendition == LineRendition::DoubleHeightTop ? halfHeight : 0;
 
-        pPolyTextLine->lpstr = polyString.data();
-        pPolyTextLine->n = gsl::narrow<UINT>(polyString.size());
-        pPolyTextLine->x = ptDraw.x;
-        pPolyTextLine->y = ptDraw.y;
-        pPolyTextLine->uiFlags = ETO_OPAQUE | ETO_CLIPPED;
-        pPolyTextLine->rcl.left = pPolyTextLine->x;
-        pPolyTextLine->rcl.top = pPolyTextLine->y + topOffset;
-        pPolyTextLine->rcl.right = pPolyTextLine->rcl.left + (SHORT)cchCharWidths;
-        pPolyTextLine->rcl.bottom = pPolyTextLine->y + coordFontSize.Y - bottomOffset;
-        pPolyTextLine->pdx = polyWidth.data();
+        // lpstr and pdx are filled in by _FlushBufferLines(), as the strings
+        // may still move around while _polyStrings and _polyWidths grow.
+        auto& entry = _polyTexts.emplace_back();
+        auto& polyText = entry.polyText;
+        polyText.n = gsl::narrow<UINT>(polyString.size());
+        polyText.x = ptDraw.x;
+        polyText.y = ptDraw.y;
+        polyText.uiFlags = ETO_OPAQUE | ETO_CLIPPED;
+        polyText.rcl.left = polyText.x;
+        polyText.rcl.top = polyText.y + topOffset;
+        polyText.rcl.right = polyText.rcl.left + (SHORT)cchCharWidths;
+        polyText.rcl.bottom = polyText.y + coordFontSize.Y - bottomOffset;
+        entry.foreground = _lastFg;
+        entry.background = _lastBg;
+        entry.fontType = _lastFontType;
 
         if (trimLeft)
         {
-            pPolyTextLine->rcl.left += coordFontSize.X;
-        }
-
-        _cPolyText++;
-
-        if (_cPolyText >= s_cPolyTextCache)
-        {
-            LOG_IF_FAILED(_FlushBufferLines());
+            polyText.rcl.left += coordFontSize.X;
         }
 
         return S_OK;
@@ -431,20 +429,57 @@ using namespace Microsoft::Console::Render;
 
 // Routine Description:
 // - Flushes any buffer lines in the PolyTextOut cache by drawing them and freeing the strings.
+// - The lines are drawn grouped by their font and colors, so that the DC only
+//   needs to be switched over once per group instead of once per run of text.
+//   Since every line is clipped to its own cells, the order they're drawn in
+//   doesn't matter otherwise. Afterwards the DC is restored to the state the
+//   last UpdateDrawingBrushes call left it in.
 // - See also: PaintBufferLine
 // Arguments:
 // - <none>
 // Return Value:
 // - S_OK or E_FAIL if GDI failed.
 [[nodiscard]] HRESULT GdiEngine::_FlushBufferLines() noexcept
+try
 {
     HRESULT hr = S_OK;
 
-    if (_cPolyText > 0)
+    if (!_polyTexts.empty())
     {
-        for (size_t i = 0; i != _cPolyText; ++i)
+        for (size_t i = 0; i != _polyTexts.size(); ++i)
         {
-            const auto& t = _pPolyText[i];
+            auto& t = til::at(_polyTexts, i).polyText;
+            t.lpstr = til::at(_polyStrings, i).data();
+            t.pdx = til::at(_polyWidths, i).data();
+        }
+
+        std::stable_sort(_polyTexts.begin(), _polyTexts.end(), [](const PolyTextEntry& a, const PolyTextEntry& b) noexcept {
+            return std::tie(a.fontType, a.foreground, a.background) < std::tie(b.fontType, b.foreground, b.background);
+        });
+
+        auto fg = _lastFg;
+        auto bg = _lastBg;
+        auto fontType = _lastFontType;
+
+        for (const auto& entry : _polyTexts)
+        {
+            if (entry.foreground != fg)
+            {
+                SetTextColor(_hdcMemoryContext, entry.foreground);
+                fg = entry.foreground;
+            }
+            if (entry.background != bg)
+            {
+                SetBkColor(_hdcMemoryContext, entry.background);
+                bg = entry.background;
+            }
+            if (entry.fontType != fontType)
+            {
+                _SelectFontType(entry.fontType);
+                fontType = entry.fontType;
+            }
+
+            const auto& t = entry.polyText;
             if (!ExtTextOutW(_hdcMemoryContext, t.x, t.y, t.uiFlags, &t.rcl, t.lpstr, t.n, t.pdx))
             {
                 hr = E_FAIL;
@@ -452,16 +487,27 @@ using namespace Microsoft::Console::Render;
             }
         }
 
+        if (fg != _lastFg)
+        {
+            SetTextColor(_hdcMemoryContext, _lastFg);
+        }
+        if (bg != _lastBg)
+        {
+            SetBkColor(_hdcMemoryContext, _lastBg);
+        }
+        if (fontType != _lastFontType)
+        {
+            _SelectFontType(_lastFontType);
+        }
+
+        _polyTexts.clear();
         _polyStrings.clear();
         _polyWidths.clear();
-
-        ZeroMemory(_pPolyText, sizeof(_pPolyText));
-
-        _cPolyText = 0;
     }
 
     RETURN_HR(hr);
 }
+CATCH_RETURN()
 
 // Routine Description:
 // - Draws up to one line worth of grid lines on top of characters.
@@ -25,7 +25,6 @@ GdiEngine::GdiEngine() :
 #endif
     _iCurrentDpi(s_iBaseDpi),
     _hbitmapMemorySurface(nullptr),
-    _cPolyText(0),
     _fInvalidRectUsed(false),
     _lastFg(INVALID_COLOR),
     _lastBg(INVALID_COLOR),
@@ -38,9 +37,9 @@ GdiEngine::GdiEngine() :
     _hfontItalic(nullptr),
     _pool{ til::pmr::get_default_resource() }, // It's important the pool is first so it can be given to the others on construction.
     _polyStrings{ &_pool },
-    _polyWidths{ &_pool }
+    _polyWidths{ &_pool },
+    _polyTexts{ &_pool }
 {
-    ZeroMemory(_pPolyText, sizeof(POLYTEXTW) * s_cPolyTextCache);
     _rcInvalid = { 0 };
     _szInvalidScroll = { 0 };
     _szMemorySurface = { 0 };
@@ -79,14 +78,6 @@ GdiEngine::GdiEngine() :
 // - <none>
 GdiEngine::~GdiEngine()
 {
-    for (size_t iPoly = 0; iPoly < _cPolyText; iPoly++)
-    {
-        if (_pPolyText[iPoly].lpstr != nullptr)
-        {
-            delete[] _pPolyText[iPoly].lpstr;
-        }
-    }
-
     if (_hbitmapMemorySurface != nullptr)
     {
         LOG_HR_IF(E_FAIL, !(DeleteObject(_hbitmapMemorySurface)));
@@ -281,7 +272,9 @@ GdiEngine::~GdiEngine()
                                                       const bool usingSoftFont,
                                                       const bool isSettingDefaultBrushes) noexcept
 {
-    RETURN_IF_FAILED(_FlushBufferLines());
+    // The text that was already queued up remembers the colors and font it needs
+    // to be drawn with, which is why the buffer lines don't need to be flushed here.
+    // See _FlushBufferLines().
 
     RETURN_HR_IF_NULL(HRESULT_FROM_WIN32(ERROR_INVALID_STATE), _hdcMemoryContext);
 
@@ -313,25 +306,36 @@ GdiEngine::~GdiEngine()
     const auto fontType = usingSoftFont ? FontType::Soft : usingItalicFont ? FontType::Italic : FontType::Default;
     if (fontType != _lastFontType)
     {
-        switch (fontType)
-        {
-        case FontType::Soft:
-            SelectFont(_hdcMemoryContext, _softFont);
-            break;
-        case FontType::Italic:
-            SelectFont(_hdcMemoryContext, _hfontItalic);
-            break;
-        case FontType::Default:
-        default:
-            SelectFont(_hdcMemoryContext, _hfont);
-            break;
-        }
+        _SelectFontType(fontType);
         _lastFontType = fontType;
     }
 
     return S_OK;
 }
 
+// Routine Description:
+// - Selects the font variant or soft font for the given font type into the memory DC.
+// Arguments:
+// - fontType - The type of font to select
+// Return Value:
+// - <none>
+void GdiEngine::_SelectFontType(const FontType fontType) noexcept
+{
+    switch (fontType)
+    {
+    case FontType::Soft:
+        SelectFont(_hdcMemoryContext, _softFont);
+        break;
+    case FontType::Italic:
+        SelectFont(_hdcMemoryContext, _hfontItalic);
+        break;
+    case FontType::Default:
+    default:
+        SelectFont(_hdcMemoryContext, _hfont);
+        break;
+    }
+}
+
 // Routine Description:
 // - This method will update the active font on the current device context
 // - NOTE: It is left up to the underling rendering system to choose the nearest font. Please ask for the font dimensions if they are required using the interface. Do not use the size you requested with this structure.
@@ -342,6 +346,9 @@ GdiEngine::~GdiEngine()
 // - S_OK if set successfully or relevant GDI error via HRESULT.
 [[nodiscard]] HRESULT GdiEngine::UpdateFont(const FontInfoDesired& FontDesired, _Out_ FontInfo& Font) noexcept
 {
+    // The queued up text refers to the fonts we're about to replace.
+    LOG_IF_FAILED(_FlushBufferLines());
+
     wil::unique_hfont hFont, hFontItalic;
     RETURN_IF_FAILED(_GetProposedFont(FontDesired, Font, _iCurrentDpi, hFont, hFontItalic));
 
@@ -456,6 +463,16 @@ GdiEngine::~GdiEngine()
                                                 const SIZE cellSize,
                                                 const size_t centeringHint) noexcept
 {
+    // Apps tend to download the same font again whenever they start up. The
+    // existing font (and the sizes it was already rasterized for) can be kept.
+    if (_softFont.HasPattern(bitPattern, til::size{ cellSize }, centeringHint))
+    {
+        return S_OK;
+    }
+
+    // The queued up text might still refer to the soft font we're about to replace.
+    LOG_IF_FAILED(_FlushBufferLines());
+
     // If the soft font is currently selected, replace it with the default font.
     if (_lastFontType == FontType::Soft)
     {
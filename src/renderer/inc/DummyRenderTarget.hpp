@@ -24,6 +24,11 @@ public:
     void TriggerRedraw(const Microsoft::Console::Types::Viewport& /*region*/) override {}
     void TriggerRedraw(const COORD* const /*pcoord*/) override {}
     void TriggerRedrawCursor(const COORD* const /*pcoord*/) override {}
+    void StartDeferCursorRedraw() noexcept override {}
+    void EndDeferCursorRedraw() noexcept override {}
+    void StartDeferRedraw() noexcept override {}
+    void EndDeferRedraw() noexcept override {}
+    void SetSynchronizedOutput(const bool /*enabled*/) noexcept override {}
     void TriggerRedrawAll() override {}
     void TriggerTeardown() noexcept override {}
     void TriggerSelection() override {}
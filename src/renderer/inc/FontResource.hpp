@@ -7,6 +7,10 @@ Module Name:
 
 Abstract:
 - This manages the construction of in-memory font resources for the VT soft fonts.
+- The glyphs are rasterized separately for every target size, which is costly,
+  so the fonts for the most recently used sizes are kept around. That way
+  resizing, zooming, or moving between monitors with different DPIs doesn't
+  repeat the work every time the font size returns to an earlier value.
 --*/
 
 #pragma once
@@ -28,10 +32,23 @@ namespace Microsoft::Console::Render
         FontResource() = default;
         ~FontResource() = default;
         FontResource& operator=(FontResource&&) = default;
+        bool HasPattern(const gsl::span<const uint16_t> bitPattern,
+                        const til::size sourceSize,
+                        const size_t centeringHint) const noexcept;
         void SetTargetSize(const til::size targetSize);
         operator HFONT();
 
     private:
+        struct ScaledFont
+        {
+            til::size targetSize;
+            wil::unique_hfontresource resourceHandle;
+            wil::unique_hfont fontHandle;
+        };
+
+        // The number of target sizes for which the generated fonts are kept.
+        static constexpr size_t MAX_SCALED_FONTS = 4;
+
         void _regenerateFont();
         void _resizeBitPattern(gsl::span<byte> targetBuffer);
 
@@ -39,7 +56,7 @@ namespace Microsoft::Console::Render
         til::size _sourceSize;
         til::size _targetSize;
         size_t _centeringHint{ 0 };
-        wil::unique_hfontresource _resourceHandle;
-        wil::unique_hfont _fontHandle;
+        // The most recently used font is at the front.
+        std::vector<ScaledFont> _scaledFonts;
     };
 }
@@ -54,7 +54,9 @@ namespace Microsoft::Console::Render
         virtual ULONG GetCursorPixelWidth() const noexcept = 0;
         virtual bool IsCursorDoubleWidth() const = 0;
 
-        virtual const std::vector<RenderOverlay> GetOverlays() const noexcept = 0;
+        // Like GetSelectionRects(), GetOverlays() and GetPatternId() return storage owned by the
+        // implementation. It's only valid until the next call, and only while the console is locked.
+        virtual gsl::span<const RenderOverlay> GetOverlays() const noexcept = 0;
 
         virtual const bool IsGridLineDrawingAllowed() noexcept = 0;
         virtual const std::wstring_view GetConsoleTitle() const noexcept = 0;
@@ -62,7 +64,7 @@ namespace Microsoft::Console::Render
         virtual const std::wstring GetHyperlinkUri(uint16_t id) const noexcept = 0;
         virtual const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept = 0;
 
-        virtual const std::vector<size_t> GetPatternId(const COORD location) const noexcept = 0;
+        virtual gsl::span<const size_t> GetPatternId(const COORD location) const noexcept = 0;
 
     protected:
         IRenderData() = default;
@@ -30,6 +30,20 @@ namespace Microsoft::Console::Render
     struct RenderFrameInfo
     {
         std::optional<CursorOptions> cursorInfo;
+        // The data the frame is rendered from, for engines that need more
+        // than the dirty areas to decide what to paint.
+        IRenderData* renderData{ nullptr };
+        // The selection, relative to the viewport (exclusive and not clamped to it),
+        // for engines that draw it independently of the dirty areas.
+        gsl::span<const SMALL_RECT> selectionRects;
+    };
+
+    // A downscaled copy of a frame, see IRenderEngine::RequestThumbnail().
+    struct RenderThumbnail
+    {
+        til::size size;
+        // Premultiplied BGRA pixels, row by row, without any padding.
+        std::vector<uint32_t> pixels;
     };
 
     class __declspec(novtable) IRenderEngine
@@ -95,6 +109,7 @@ namespace Microsoft::Console::Render
         virtual HRESULT Enable() noexcept { return S_OK; }
         virtual [[nodiscard]] bool GetRetroTerminalEffect() const noexcept { return false; }
         virtual [[nodiscard]] float GetScaling() const noexcept { return 1; }
+        virtual [[nodiscard]] HRESULT GetGlyphCacheStatistics(uint64_t& lookups, uint64_t& hits) const noexcept { return E_NOTIMPL; }
 #pragma warning(suppress : 26440) // Function '...' can be declared 'noexcept' (f.6).
         virtual [[nodiscard]] HANDLE GetSwapChainHandle()
         {
@@ -103,18 +118,23 @@ namespace Microsoft::Console::Render
         virtual [[nodiscard]] Types::Viewport GetViewportInCharacters(const Types::Viewport& viewInPixels) const noexcept { return Types::Viewport::Empty(); }
         virtual [[nodiscard]] Types::Viewport GetViewportInPixels(const Types::Viewport& viewInCharacters) const noexcept { return Types::Viewport::Empty(); }
         // DxRenderer - setter
+        virtual [[nodiscard]] HRESULT RequestThumbnail(const til::size maxSize, std::function<void(RenderThumbnail&&)> pfn) noexcept { return E_NOTIMPL; }
         virtual void SetAntialiasingMode(const D2D1_TEXT_ANTIALIAS_MODE antialiasingMode) noexcept {}
         virtual void SetCallback(std::function<void()> pfn) noexcept {}
         virtual void EnableTransparentBackground(const bool isTransparent) noexcept {}
         virtual void SetForceFullRepaintRendering(bool enable) noexcept {}
         virtual [[nodiscard]] HRESULT SetHwnd(const HWND hwnd) noexcept { return E_NOTIMPL; }
         virtual void SetPixelShaderPath(std::wstring_view value) noexcept {}
+        virtual void SetPixelShaderFrameRate(const int framesPerSecond) noexcept {}
         virtual void SetRetroTerminalEffect(bool enable) noexcept {}
         virtual void SetSelectionBackground(const COLORREF color, const float alpha = 0.5f) noexcept {}
         virtual void SetSoftwareRendering(bool enable) noexcept {}
+        virtual void SetSharedDeviceRendering(bool enable) noexcept {}
+        virtual [[nodiscard]] HRESULT SetSmoothScrollOffset(const float rows) noexcept { return E_NOTIMPL; }
         virtual void SetWarningCallback(std::function<void(HRESULT)> pfn) noexcept {}
         virtual [[nodiscard]] HRESULT SetWindowSize(const SIZE pixels) noexcept { return E_NOTIMPL; }
         virtual void ToggleShaderEffects() noexcept {}
+        virtual void TrimResources() noexcept {}
         virtual [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& pfiFontInfoDesired, FontInfo& fiFontInfo, const std::unordered_map<std::wstring_view, uint32_t>& features, const std::unordered_map<std::wstring_view, float>& axes) noexcept { return E_NOTIMPL; }
         virtual void UpdateHyperlinkHoveredId(const uint16_t hoveredId) noexcept {}
     };
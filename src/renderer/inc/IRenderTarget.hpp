@@ -36,6 +36,11 @@ namespace Microsoft::Console::Render
         virtual void TriggerRedraw(const Microsoft::Console::Types::Viewport& region) = 0;
         virtual void TriggerRedraw(const COORD* const pcoord) = 0;
         virtual void TriggerRedrawCursor(const COORD* const pcoord) = 0;
+        virtual void StartDeferCursorRedraw() noexcept = 0;
+        virtual void EndDeferCursorRedraw() noexcept = 0;
+        virtual void StartDeferRedraw() noexcept = 0;
+        virtual void EndDeferRedraw() noexcept = 0;
+        virtual void SetSynchronizedOutput(const bool enabled) noexcept = 0;
 
         virtual void TriggerRedrawAll() = 0;
         virtual void TriggerTeardown() noexcept = 0;
@@ -58,6 +58,11 @@ namespace Microsoft::Console::Render
 
         bool _titleChanged;
         std::wstring _lastFrameTitle;
+
+    private:
+        // A frame that starts this long after the last one did isn't throttled.
+        static constexpr std::chrono::milliseconds _idleThreshold{ 32 };
+        std::chrono::steady_clock::time_point _lastFrameStart{};
     };
 
     inline Microsoft::Console::Render::RenderEngineBase::~RenderEngineBase() {}
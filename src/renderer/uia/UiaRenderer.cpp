@@ -10,6 +10,16 @@
 using namespace Microsoft::Console::Render;
 using namespace Microsoft::Console::Types;
 
+static constexpr SMALL_RECT _UnionRegions(const SMALL_RECT& a, const SMALL_RECT& b) noexcept
+{
+    return {
+        std::min(a.Left, b.Left),
+        std::min(a.Top, b.Top),
+        std::max(a.Right, b.Right),
+        std::max(a.Bottom, b.Bottom),
+    };
+}
+
 // Routine Description:
 // - Constructs a UIA engine for console text
 //   which primarily notifies automation clients of any activity
@@ -22,6 +32,10 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
     _isEnabled{ true },
     _prevSelection{},
     _prevCursorRegion{},
+    _changedRegion{},
+    _viewport{},
+    _signaledCursorRegion{},
+    _signalPendingEvents{ _eventLatency, [this]() { _SignalPendingEvents(); } },
     RenderEngineBase()
 {
 }
@@ -47,6 +61,9 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
 [[nodiscard]] HRESULT UiaEngine::Disable() noexcept
 {
     _isEnabled = false;
+
+    // Another engine is taking over. Its client isn't interested in our events.
+    *_pendingEvents.lock() = {};
     return S_OK;
 }
 
@@ -57,8 +74,11 @@ UiaEngine::UiaEngine(IUiaEventDispatcher* dispatcher) :
 // - psrRegion - Character region (SMALL_RECT) that has been changed
 // Return Value:
 // - S_OK, else an appropriate HRESULT for failing to allocate or write.
-[[nodiscard]] HRESULT UiaEngine::Invalidate(const SMALL_RECT* const /*psrRegion*/) noexcept
+[[nodiscard]] HRESULT UiaEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
 {
+    RETURN_HR_IF_NULL(E_INVALIDARG, psrRegion);
+
+    _changedRegion = _textBufferChanged ? _UnionRegions(_changedRegion, *psrRegion) : *psrRegion;
     _textBufferChanged = true;
     return S_OK;
 }
@@ -164,6 +184,7 @@ CATCH_RETURN();
 // - S_OK, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT UiaEngine::InvalidateAll() noexcept
 {
+    _changedRegion = { 0, 0, _viewport.Right - _viewport.Left, _viewport.Bottom - _viewport.Top };
     _textBufferChanged = true;
     return S_OK;
 }
@@ -217,7 +238,9 @@ CATCH_RETURN();
 }
 
 // Routine Description:
-// - Ends batch drawing and notifies automation clients of updated regions
+// - Ends batch drawing and schedules notifying automation clients of updated regions.
+// - The changes of all frames painted within _eventLatency are merged,
+//   so that the client receives at most one event of each kind per period.
 // Arguments:
 // - <none>
 // Return Value:
@@ -227,8 +250,60 @@ CATCH_RETURN();
     RETURN_HR_IF(S_FALSE, !_isEnabled);
     RETURN_HR_IF(E_INVALIDARG, !_isPainting); // invalid to end paint when we're not painting
 
+    {
+        const auto pending = _pendingEvents.lock();
+        pending->selectionChanged |= _selectionChanged;
+        if (_textBufferChanged)
+        {
+            pending->changedRegion = pending->textBufferChanged ? _UnionRegions(pending->changedRegion, _changedRegion) : _changedRegion;
+            pending->textBufferChanged = true;
+        }
+        if (_cursorChanged)
+        {
+            pending->cursorRegion = _prevCursorRegion;
+            pending->cursorChanged = true;
+        }
+    }
+
+    try
+    {
+        _signalPendingEvents();
+    }
+    CATCH_LOG();
+
+    _selectionChanged = false;
+    _textBufferChanged = false;
+    _cursorChanged = false;
+    _isPainting = false;
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Fires the UIA events that accumulated since the last time this was called.
+// - Called on a threadpool thread once _eventLatency has passed since the first EndPaint().
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void UiaEngine::_SignalPendingEvents()
+{
+    PendingEvents events;
+    {
+        const auto pending = _pendingEvents.lock();
+        events = std::exchange(*pending, {});
+    }
+
+    // The cursor may have moved back to where the client last saw it,
+    // in which case there's nothing new to be told about.
+    const auto cursorChanged = events.cursorChanged && events.cursorRegion != _signaledCursorRegion;
+    if (cursorChanged)
+    {
+        _signaledCursorRegion = events.cursorRegion;
+    }
+
     // Fire UIA Events here
-    if (_selectionChanged)
+    if (events.selectionChanged)
     {
         try
         {
@@ -236,15 +311,15 @@ CATCH_RETURN();
         }
         CATCH_LOG();
     }
-    if (_textBufferChanged)
+    if (events.textBufferChanged)
     {
         try
         {
-            _dispatcher->SignalTextChanged();
+            _dispatcher->SignalTextChanged(events.changedRegion);
         }
         CATCH_LOG();
     }
-    if (_cursorChanged)
+    if (cursorChanged)
     {
         try
         {
@@ -252,13 +327,6 @@ CATCH_RETURN();
         }
         CATCH_LOG();
     }
-
-    _selectionChanged = false;
-    _textBufferChanged = false;
-    _cursorChanged = false;
-    _isPainting = false;
-
-    return S_OK;
 }
 
 // RenderEngineBase defines a WaitUntilCanRender() that sleeps for 8ms to throttle rendering.
@@ -415,9 +483,10 @@ void UiaEngine::WaitUntilCanRender() noexcept
 // - srNewViewport - The bounds of the new viewport.
 // Return Value:
 // - HRESULT S_OK
-[[nodiscard]] HRESULT UiaEngine::UpdateViewport(const SMALL_RECT /*srNewViewport*/) noexcept
+[[nodiscard]] HRESULT UiaEngine::UpdateViewport(const SMALL_RECT srNewViewport) noexcept
 {
-    return S_FALSE;
+    _viewport = srNewViewport;
+    return S_OK;
 }
 
 // Routine Description:
@@ -8,6 +8,8 @@ Module Name:
 Abstract:
 - This is the definition of the UIA specific implementation of the renderer
 - It keeps track of what regions of the display have changed and notifies automation clients.
+- The notifications are coalesced and rate limited, so that a flood of output (like a
+  fast build) results in a steady trickle of events instead of one event per frame.
 
 Author(s):
 - Carlos Zamora (CaZamor) Sep-2019
@@ -20,6 +22,9 @@ Author(s):
 #include "../../types/IUiaEventDispatcher.h"
 #include "../../types/inc/Viewport.hpp"
 
+#include <til/mutex.h>
+#include <til/throttled_func.h>
+
 namespace Microsoft::Console::Render
 {
     class UiaEngine final : public RenderEngineBase
@@ -65,6 +70,20 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept override;
 
     private:
+        // The events of all frames painted within this timespan are merged into one of each kind.
+        static constexpr auto _eventLatency = std::chrono::milliseconds(50);
+
+        struct PendingEvents
+        {
+            bool selectionChanged = false;
+            bool textBufferChanged = false;
+            bool cursorChanged = false;
+            SMALL_RECT changedRegion{};
+            SMALL_RECT cursorRegion{};
+        };
+
+        void _SignalPendingEvents();
+
         bool _isEnabled;
         bool _isPainting;
         bool _selectionChanged;
@@ -75,5 +94,14 @@ namespace Microsoft::Console::Render
 
         std::vector<SMALL_RECT> _prevSelection;
         SMALL_RECT _prevCursorRegion;
+        SMALL_RECT _changedRegion;
+        SMALL_RECT _viewport;
+
+        // Only accessed by _SignalPendingEvents().
+        SMALL_RECT _signaledCursorRegion;
+
+        til::shared_mutex<PendingEvents> _pendingEvents;
+        // Must be destroyed first, as it waits for outstanding _SignalPendingEvents() calls.
+        til::throttled_func_trailing<> _signalPendingEvents;
     };
 }
@@ -44,6 +44,29 @@ using namespace Microsoft::Console::Render;
     return _Write("\x1b[?25l");
 }
 
+// Method Description:
+// - Formats and writes a sequence to start a synchronized update, which the
+//      terminal presents at once when it's complete.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_BeginSynchronizedUpdate() noexcept
+{
+    return _Write("\x1b[?2026h");
+}
+
+// Method Description:
+// - Formats and writes a sequence to end a synchronized update.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_EndSynchronizedUpdate() noexcept
+{
+    return _Write("\x1b[?2026l");
+}
+
 // Method Description:
 // - Formats and writes a sequence to show the cursor.
 // Arguments:
@@ -86,6 +109,18 @@ using namespace Microsoft::Console::Render;
     return _WriteFormatted(FMT_COMPILE("\x1b[{}X"), chars);
 }
 
+// Method Description:
+// - Formats and writes a sequence to repeat the last graphic character that
+//      was written a number of times (REP).
+// Arguments:
+// - count: the number of times to repeat the character
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_RepeatCharacter(const size_t count) noexcept
+{
+    return _WriteFormatted(FMT_COMPILE("\x1b[{}b"), count);
+}
+
 // Method Description:
 // - Moves the cursor forward (right) a number of characters.
 // Arguments:
@@ -106,6 +141,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_ClearScreen() noexcept
 {
+    _InvalidateSentCells();
     return _Write("\x1b[2J");
 }
 
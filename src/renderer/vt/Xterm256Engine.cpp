@@ -32,6 +32,8 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
                                                            const bool /*usingSoftFont*/,
                                                            const bool /*isSettingDefaultBrushes*/) noexcept
 {
+    _paintAttributes = textAttributes;
+
     RETURN_IF_FAILED(VtEngine::_RgbUpdateDrawingBrushes(textAttributes));
 
     RETURN_IF_FAILED(_UpdateHyperlinkAttr(textAttributes, pData));
@@ -140,6 +140,8 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
                                                         const bool /*usingSoftFont*/,
                                                         const bool /*isSettingDefaultBrushes*/) noexcept
 {
+    _paintAttributes = textAttributes;
+
     // The base xterm mode only knows about 16 colors
     RETURN_IF_FAILED(VtEngine::_16ColorUpdateDrawingBrushes(textAttributes));
 
@@ -392,6 +394,9 @@ try
     _wrappedRow = oldWrappedRow;
     _delayedEolWrap = oldDelayedEolWrap;
 
+    // The terminal moved everything we've sent along with the viewport.
+    _ScrollSentCells(0, gsl::narrow_cast<short>(_lastViewport.Height() - 1), dy);
+
     // Shift our internal tracker of the last text position according to how
     // much we've scrolled. If we manually scroll the buffer right now, by
     // moving the cursor to the bottom row of the viewport and emitting a
@@ -463,6 +468,12 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT XtermEngine::InvalidateScroll(const COORD* const pcoordDelta) noexcept
 try
 {
+    // During passthrough the terminal scrolls along with us.
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
     const til::point delta{ *pcoordDelta };
 
     if (delta != til::point{ 0, 0 })
@@ -499,9 +510,20 @@ CATCH_RETURN();
                                                    const bool /*trimLeft*/,
                                                    const bool lineWrapped) noexcept
 {
-    return _fUseAsciiOnly ?
-               VtEngine::_PaintAsciiBufferLine(clusters, coord) :
-               VtEngine::_PaintUtf8BufferLine(clusters, coord, lineWrapped);
+    if (_frameDiff && _IsSpanUnchanged(clusters, coord, lineWrapped))
+    {
+        return S_OK;
+    }
+
+    RETURN_IF_FAILED(_fUseAsciiOnly ?
+                         VtEngine::_PaintAsciiBufferLine(clusters, coord) :
+                         VtEngine::_PaintUtf8BufferLine(clusters, coord, lineWrapped));
+
+    if (_frameDiff)
+    {
+        _RecordSentSpan(clusters, coord);
+    }
+    return S_OK;
 }
 
 // Method Description:
@@ -513,6 +535,16 @@ CATCH_RETURN();
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // During passthrough the whole string is written once it has been
+    // processed, including whatever the StateMachine decides to pass on.
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
+    // We don't know what the string does to the terminal's contents.
+    _InvalidateSentCells();
+
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
@@ -530,6 +562,23 @@ CATCH_RETURN();
     return _Flush();
 }
 
+// Method Description:
+// - Ends passing the client's output through to the terminal. See
+//   VtEngine::EndPassthrough. Whether the terminal's cursor is visible is
+//   unknown afterwards, so the next frame (re)sets it.
+// Arguments:
+// - str - the client's output
+// - cursor - the position of the cursor after processing it, relative to the viewport
+// - attributes - the current attributes after processing it
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to write.
+[[nodiscard]] HRESULT XtermEngine::EndPassthrough(const std::wstring_view str, const COORD cursor, const TextAttribute& attributes) noexcept
+{
+    _lastCursorIsVisible = Tribool::Invalid;
+    _needToDisableCursor = false;
+    return VtEngine::EndPassthrough(str, cursor, attributes);
+}
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 // Arguments:
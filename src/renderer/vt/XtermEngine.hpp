@@ -52,6 +52,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept override;
 
         [[nodiscard]] HRESULT WriteTerminalW(const std::wstring_view str) noexcept override;
+        [[nodiscard]] HRESULT EndPassthrough(const std::wstring_view str, const COORD cursor, const TextAttribute& attributes) noexcept override;
 
     protected:
         // I'm using a non-class enum here, so that the values
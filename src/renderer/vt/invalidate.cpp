@@ -49,6 +49,11 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
 try
 {
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
     const til::rect rect{ Viewport::FromExclusive(*psrRegion).ToInclusive() };
     _trace.TraceInvalidate(rect);
     _invalidMap.set(rect);
@@ -64,6 +69,11 @@ CATCH_RETURN();
 // - S_OK
 [[nodiscard]] HRESULT VtEngine::InvalidateCursor(const SMALL_RECT* const psrRegion) noexcept
 {
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
     // If we just inherited the cursor, we're going to get an InvalidateCursor
     //      for both where the old cursor was, and where the new cursor is
     //      (the inherited location). (See Cursor.cpp:Cursor::SetPosition)
@@ -91,12 +101,38 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateAll() noexcept
 try
 {
+    if (_inPassthrough)
+    {
+        return S_OK;
+    }
+
     _trace.TraceInvalidateAll(til::rect{ _lastViewport.ToOrigin().ToInclusive() });
     _invalidMap.set_all();
     return S_OK;
 }
 CATCH_RETURN();
 
+// Method Description:
+// - Notifies us that the title has changed. During passthrough the terminal
+//      has received the sequence that changed it, so we just remember that
+//      it's up to date.
+// Arguments:
+// - proposedTitle - the new title
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT VtEngine::InvalidateTitle(const std::wstring_view proposedTitle) noexcept
+try
+{
+    if (_inPassthrough)
+    {
+        _lastFrameTitle = proposedTitle;
+        return S_OK;
+    }
+
+    return RenderEngineBase::InvalidateTitle(proposedTitle);
+}
+CATCH_RETURN();
+
 // Method Description:
 // - Notifies us that we're about to circle the buffer, giving us a chance to
 //      force a repaint before the buffer contents are lost. The VT renderer
@@ -108,7 +144,8 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
 {
     // If we're in the middle of a resize request, don't try to immediately start a frame.
-    if (_inResizeRequest)
+    // During passthrough the terminal already has everything that's about to be lost.
+    if (_inResizeRequest || _inPassthrough)
     {
         *pForcePaint = false;
     }
@@ -137,5 +174,13 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
 {
     *pForcePaint = true;
+
+    // The process exits once the last frame is painted. Make sure that
+    // all the output so far, and that of the last frame, actually gets written.
+    _flushSynchronously = true;
+    if (_writerThread.joinable())
+    {
+        LOG_IF_FAILED(_WaitForWriter(0));
+    }
     return S_OK;
 }
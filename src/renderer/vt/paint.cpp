@@ -6,6 +6,7 @@
 #include "vtrenderer.hpp"
 #include "../../inc/conattrs.hpp"
 #include "../../types/inc/convert.hpp"
+#include "../../buffer/out/textBuffer.hpp"
 
 #pragma hdrstop
 using namespace Microsoft::Console::Render;
@@ -39,6 +40,13 @@ using namespace Microsoft::Console::Types;
                            _cursorMoved,
                            _wrappedRow);
 
+    if (!_quickReturn && _synchronizeNextFrame)
+    {
+        _synchronizeNextFrame = false;
+        _inSynchronizedFrame = true;
+        RETURN_IF_FAILED(_BeginSynchronizedUpdate());
+    }
+
     return _quickReturn ? S_FALSE : S_OK;
 }
 
@@ -82,6 +90,12 @@ using namespace Microsoft::Console::Types;
         RETURN_IF_FAILED(_MoveCursor(_deferredCursorPos));
     }
 
+    if (_inSynchronizedFrame)
+    {
+        _inSynchronizedFrame = false;
+        RETURN_IF_FAILED(_EndSynchronizedUpdate());
+    }
+
     RETURN_IF_FAILED(_Flush());
 
     return S_OK;
@@ -195,8 +209,9 @@ using namespace Microsoft::Console::Types;
     auto lastFg = _lastTextAttributes.GetForeground();
     auto lastBg = _lastTextAttributes.GetBackground();
 
-    // If both the FG and BG should be the defaults, emit a SGR reset.
-    if (fg.IsDefault() && bg.IsDefault() && !(lastFg.IsDefault() && lastBg.IsDefault()))
+    // If both the FG and BG should be the defaults, emit a SGR reset,
+    // unless resetting them individually takes fewer characters.
+    if (fg.IsDefault() && bg.IsDefault() && !(lastFg.IsDefault() && lastBg.IsDefault()) && _IsGraphicsResetShorter(textAttributes))
     {
         // SGR Reset will clear all attributes (except hyperlink ID) - which means
         // we cannot reset _lastTextAttributes by simply doing
@@ -255,6 +270,64 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Routine Description:
+// - Decides whether a SGR reset is cheaper than resetting the colors on their
+//      own, when both colors change to the defaults. The reset also turns off
+//      all the rendition attributes, which is what we want for those that are
+//      turned off anyway, but those that stay on have to be turned on again.
+//      The lengths are those of the sequences Xterm256Engine writes.
+// Arguments:
+// - textAttributes: Text attributes that are about to be used.
+// Return Value:
+// - true if a reset followed by the rendition attributes is shorter.
+bool VtEngine::_IsGraphicsResetShorter(const TextAttribute& textAttributes) const noexcept
+{
+    const auto& last = _lastTextAttributes;
+
+    // ESC [ m, followed by an ESC [ n m for every rendition attribute that's on.
+    size_t resetLength = 3;
+    resetLength += textAttributes.IsIntense() ? 4 : 0;
+    resetLength += textAttributes.IsFaint() ? 4 : 0;
+    resetLength += textAttributes.IsUnderlined() ? 4 : 0;
+    resetLength += textAttributes.IsDoublyUnderlined() ? 5 : 0;
+    resetLength += textAttributes.IsOverlined() ? 5 : 0;
+    resetLength += textAttributes.IsItalic() ? 4 : 0;
+    resetLength += textAttributes.IsBlinking() ? 4 : 0;
+    resetLength += textAttributes.IsInvisible() ? 4 : 0;
+    resetLength += textAttributes.IsCrossedOut() ? 4 : 0;
+    resetLength += textAttributes.IsReverseVideo() ? 4 : 0;
+
+    // ESC [ 39 m and ESC [ 49 m, followed by the changes of the rendition attributes.
+    size_t explicitLength = 0;
+    explicitLength += last.GetForeground().IsDefault() ? 0 : 5;
+    explicitLength += last.GetBackground().IsDefault() ? 0 : 5;
+
+    // Intense and faint are turned off together, and so are the two underline styles.
+    // Whichever of them stays on needs to be turned on again.
+    const auto pairLength = [](const bool lastA, const bool a, const size_t aLength, const bool lastB, const bool b, const size_t bLength) noexcept -> size_t {
+        if ((lastA && !a) || (lastB && !b))
+        {
+            return 5 + (a ? aLength : 0) + (b ? bLength : 0);
+        }
+        return (a && !lastA ? aLength : 0) + (b && !lastB ? bLength : 0);
+    };
+    explicitLength += pairLength(last.IsIntense(), textAttributes.IsIntense(), 4, last.IsFaint(), textAttributes.IsFaint(), 4);
+    explicitLength += pairLength(last.IsUnderlined(), textAttributes.IsUnderlined(), 4, last.IsDoublyUnderlined(), textAttributes.IsDoublyUnderlined(), 5);
+
+    // The other ones are turned on and off on their own.
+    const auto toggleLength = [](const bool lastOn, const bool on, const size_t onLength) noexcept -> size_t {
+        return lastOn == on ? 0 : (on ? onLength : 5);
+    };
+    explicitLength += toggleLength(last.IsOverlined(), textAttributes.IsOverlined(), 5);
+    explicitLength += toggleLength(last.IsItalic(), textAttributes.IsItalic(), 4);
+    explicitLength += toggleLength(last.IsBlinking(), textAttributes.IsBlinking(), 4);
+    explicitLength += toggleLength(last.IsInvisible(), textAttributes.IsInvisible(), 4);
+    explicitLength += toggleLength(last.IsCrossedOut(), textAttributes.IsCrossedOut(), 4);
+    explicitLength += toggleLength(last.IsReverseVideo(), textAttributes.IsReverseVideo(), 4);
+
+    return resetLength <= explicitLength;
+}
+
 // Routine Description:
 // - Write a VT sequence to change the current colors of text. It will try to
 //      find ANSI colors that are nearest to the input colors, and write those
@@ -490,7 +563,14 @@ using namespace Microsoft::Console::Types;
     RETURN_IF_FAILED(_MoveCursor(coord));
 
     // Write the actual text string
-    RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8({ _bufferLine.data(), cchActual }));
+    if (_repeatCharacters)
+    {
+        RETURN_IF_FAILED(_WriteBufferLineWithRepeats(clusters, cchActual));
+    }
+    else
+    {
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8({ _bufferLine.data(), cchActual }));
+    }
 
     // GH#4415, GH#5181
     // If the renderer told us that this was a wrapped line, then mark
@@ -590,6 +670,66 @@ using namespace Microsoft::Console::Types;
     return S_OK;
 }
 
+// Method Description:
+// - Writes the beginning of _bufferLine, which holds the text of the given
+//      clusters, just like _WriteTerminalUtf8 would. A run of the same
+//      character that's longer than a REP sequence is written as the character
+//      followed by a REP sequence for the rest of the run instead.
+// - REP repeats the last graphic character, not the last cluster, so only
+//      clusters made of a single UTF-16 code unit can be repeated.
+// - Runs of spaces in the middle of the line are written like this as well.
+//      The spaces at the end of the line are left to ECH and EL.
+// Arguments:
+// - clusters: the clusters the text in _bufferLine was made of
+// - cch: the number of characters of _bufferLine to write
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_WriteBufferLineWithRepeats(gsl::span<const Cluster> const clusters, const size_t cch) noexcept
+{
+    const std::wstring_view line{ _bufferLine.data(), cch };
+    size_t written = 0;
+    size_t offset = 0;
+    for (auto it = clusters.begin(); it != clusters.end() && offset < line.size();)
+    {
+        const auto text = it->GetText();
+        const auto repeatable = text.size() == 1 && !IS_HIGH_SURROGATE(text.front()) && !IS_LOW_SURROGATE(text.front());
+
+        auto runEnd = std::next(it);
+        while (repeatable && runEnd != clusters.end() && runEnd->GetText() == text)
+        {
+            ++runEnd;
+        }
+
+        const auto runLength = std::min(gsl::narrow_cast<size_t>(std::distance(it, runEnd)) * text.size(), line.size() - offset);
+        if (repeatable && runLength > 1)
+        {
+            // ESC [ n b is 3 characters and the digits of n.
+            const auto repeats = runLength - 1;
+            size_t digits = 1;
+            for (auto n = repeats; n >= 10; n /= 10)
+            {
+                ++digits;
+            }
+
+            if (repeats > 3 + digits)
+            {
+                RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(line.substr(written, offset + 1 - written)));
+                RETURN_IF_FAILED(_RepeatCharacter(repeats));
+                written = offset + runLength;
+            }
+        }
+
+        offset += runLength;
+        it = runEnd;
+    }
+
+    if (written < line.size())
+    {
+        RETURN_IF_FAILED(VtEngine::_WriteTerminalUtf8(line.substr(written)));
+    }
+    return S_OK;
+}
+
 // Method Description:
 // - Updates the window's title string. Emits the VT sequence to SetWindowTitle.
 //      Because wintelnet does not understand these sequences by default, we
@@ -603,3 +743,414 @@ using namespace Microsoft::Console::Types;
 {
     return S_OK;
 }
+
+// Method Description:
+// - Enables or disables frame diffing. With frame diffing, we remember what
+//      we've sent for every cell of the viewport, so that spans that are
+//      painted again with the same contents can be skipped, and rows that
+//      only moved can be scrolled into place instead of being repainted.
+// Arguments:
+// - frameDiff: true to enable frame diffing.
+// Return Value:
+// - <none>
+void VtEngine::SetFrameDiff(const bool frameDiff) noexcept
+{
+    _frameDiff = frameDiff;
+    _InvalidateSentCells();
+}
+
+// Method Description:
+// - Enables or disables the compression of runs of the same character into
+//      REP sequences by _PaintUtf8BufferLine. Not every terminal supports
+//      REP, so this has to be asked for with the `--repeatCharacters` flag.
+// Arguments:
+// - repeatCharacters: true to write runs of the same character with REP.
+// Return Value:
+// - <none>
+void VtEngine::SetRepeatCharacters(const bool repeatCharacters) noexcept
+{
+    _repeatCharacters = repeatCharacters;
+}
+
+// Method Description:
+// - Forgets what we've sent so far, for when the terminal tells us that it
+//      doesn't display it any longer. The next frame paints everything that's
+//      invalid, even if it's what we've sent before.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::ForgetSentCells() noexcept
+{
+    _InvalidateSentCells();
+}
+
+// Method Description:
+// - Forgets everything we know about the terminal's viewport. This needs to be
+//      called whenever the terminal's contents change in a way we don't track
+//      cell by cell, like a clear, a resize or a verbatim write.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_InvalidateSentCells() noexcept
+{
+    try
+    {
+        if (_frameDiff)
+        {
+            const auto size = gsl::narrow_cast<size_t>(_lastViewport.Width()) * gsl::narrow_cast<size_t>(_lastViewport.Height());
+            _sentCells.assign(size, SentCell{});
+        }
+        else
+        {
+            _sentCells.clear();
+        }
+    }
+    catch (...)
+    {
+        // If we can't remember the cells, just don't diff any longer.
+        LOG_CAUGHT_EXCEPTION();
+        _frameDiff = false;
+        _sentCells.clear();
+    }
+}
+
+// Method Description:
+// - Hashes the text of a single cell. Both halves of a wide glyph share the
+//      same text, so the column within the glyph is hashed as well.
+// Arguments:
+// - text: the text of the glyph occupying the cell.
+// - column: the column of the cell within the glyph.
+// Return Value:
+// - The hash of the cell's text.
+size_t VtEngine::_HashCellText(const std::wstring_view text, const size_t column) noexcept
+{
+    til::hasher h;
+    h.write(text);
+    h.write(column);
+    return h.finalize();
+}
+
+// Method Description:
+// - Moves the remembered rows between top and bottom (inclusive) by delta
+//      rows, the same way the terminal moves them when we scroll. The rows
+//      that are revealed are unknown.
+// Arguments:
+// - top: the first row of the region that's scrolled.
+// - bottom: the last row of the region that's scrolled.
+// - delta: the number of rows to move by. Negative values move rows up.
+// Return Value:
+// - <none>
+void VtEngine::_ScrollSentCells(const short top, const short bottom, const short delta) noexcept
+{
+    const ptrdiff_t width = _lastViewport.Width();
+    if (_sentCells.empty() || delta == 0 || top < 0 || top > bottom || (bottom + 1) * width > gsl::narrow_cast<ptrdiff_t>(_sentCells.size()))
+    {
+        return;
+    }
+
+    const auto first = _sentCells.begin() + top * width;
+    const auto last = _sentCells.begin() + (bottom + 1) * width;
+    const auto distance = std::min<ptrdiff_t>(std::abs(delta), bottom - top + 1) * width;
+
+    if (delta < 0)
+    {
+        std::move(first + distance, last, first);
+        std::fill(last - distance, last, SentCell{});
+    }
+    else
+    {
+        std::move_backward(first, last - distance, last);
+        std::fill(first, first + distance, SentCell{});
+    }
+}
+
+// Method Description:
+// - Checks whether the terminal already displays the given span, with the
+//      attributes we're currently painting with.
+// Arguments:
+// - clusters: the text and column counts of the span.
+// - coord: the position of the span in the viewport.
+// - lineWrapped: true if the line wraps at the end of this span.
+// Return Value:
+// - true if painting the span would not change what the terminal shows.
+bool VtEngine::_IsSpanUnchanged(gsl::span<const Cluster> clusters, const COORD coord, const bool lineWrapped) const noexcept
+{
+    // Painting the span also does some bookkeeping in these cases: it creates
+    // the new bottom line or keeps a wrapped line wrapped, so we always do.
+    if (_sentCells.empty() ||
+        _clearedAllThisFrame ||
+        coord.Y < _virtualTop ||
+        (_newBottomLine && coord.Y == _lastViewport.BottomInclusive()) ||
+        (coord.X == 0 && _wrappedRow.has_value() && _wrappedRow.value() == coord.Y - 1))
+    {
+        return false;
+    }
+
+    const auto width = gsl::narrow_cast<size_t>(_lastViewport.Width());
+    if (coord.X < 0 || coord.Y < 0 || gsl::narrow_cast<size_t>(coord.Y) >= gsl::narrow_cast<size_t>(_lastViewport.Height()))
+    {
+        return false;
+    }
+
+    auto x = gsl::narrow_cast<size_t>(coord.X);
+    const auto rowStart = gsl::narrow_cast<size_t>(coord.Y) * width;
+    for (const auto& cluster : clusters)
+    {
+        const auto text = cluster.GetText();
+        for (size_t column = 0; column < cluster.GetColumns(); ++column, ++x)
+        {
+            if (x >= width)
+            {
+                return false;
+            }
+
+            const auto& cell = til::at(_sentCells, rowStart + x);
+            if (!cell.valid || cell.text != _HashCellText(text, column) || cell.attributes != _paintAttributes)
+            {
+                return false;
+            }
+        }
+    }
+
+    // The terminal needs to see us print into the last column to wrap.
+    return !(lineWrapped && x >= width);
+}
+
+// Method Description:
+// - Remembers that we've painted the given span with the attributes we're
+//      currently painting with.
+// Arguments:
+// - clusters: the text and column counts of the span.
+// - coord: the position of the span in the viewport.
+// Return Value:
+// - <none>
+void VtEngine::_RecordSentSpan(gsl::span<const Cluster> clusters, const COORD coord) noexcept
+{
+    const auto width = gsl::narrow_cast<size_t>(_lastViewport.Width());
+    if (_sentCells.empty() ||
+        coord.Y < _virtualTop ||
+        coord.X < 0 ||
+        coord.Y < 0 ||
+        gsl::narrow_cast<size_t>(coord.Y) >= gsl::narrow_cast<size_t>(_lastViewport.Height()))
+    {
+        return;
+    }
+
+    auto x = gsl::narrow_cast<size_t>(coord.X);
+    const auto rowStart = gsl::narrow_cast<size_t>(coord.Y) * width;
+    for (const auto& cluster : clusters)
+    {
+        const auto text = cluster.GetText();
+        for (size_t column = 0; column < cluster.GetColumns() && x < width; ++column, ++x)
+        {
+            auto& cell = til::at(_sentCells, rowStart + x);
+            cell.text = _HashCellText(text, column);
+            cell.attributes = _paintAttributes;
+            cell.valid = true;
+        }
+    }
+}
+
+// Method Description:
+// - Gives the engine a chance to look at the frame before it's painted. With
+//      frame diffing, rows that merely moved since the last frame are scrolled
+//      into place here, so they don't have to be painted again.
+// Arguments:
+// - info: the information about the frame.
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::PrepareRenderInfo(const RenderFrameInfo& info) noexcept
+try
+{
+    if (_frameDiff && info.renderData && !_clearedAllThisFrame)
+    {
+        RETURN_IF_FAILED(_ScrollShiftedRows(*info.renderData));
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Method Description:
+// - Looks for blocks of fully invalid rows, whose new contents are the rows we
+//      previously sent for them, shifted up or down by a few rows. Applications
+//      like editors and pagers scroll this way within a region of the screen
+//      (e.g. between a header and a status line), which we can't see through
+//      ScrollFrame. Such a block is shifted with DL/IL, after which only the
+//      rows that were revealed still need to be painted.
+// Arguments:
+// - renderData: the data the frame is rendered from.
+// Return Value:
+// - S_OK, else an appropriate HRESULT for failing to write.
+[[nodiscard]] HRESULT VtEngine::_ScrollShiftedRows(IRenderData& renderData)
+{
+    const auto view = renderData.GetViewport();
+    const til::CoordType width = _lastViewport.Width();
+    const til::CoordType height = _lastViewport.Height();
+    if (view.Width() != width ||
+        view.Height() != height ||
+        _invalidMap.size() != til::size{ width, height } ||
+        _sentCells.size() != gsl::narrow_cast<size_t>(width) * gsl::narrow_cast<size_t>(height))
+    {
+        return S_OK;
+    }
+
+    // Only rows that are invalid from edge to edge are candidates.
+    std::vector<bool> invalidRows(gsl::narrow_cast<size_t>(height), false);
+    for (const auto& rc : _invalidMap.runs())
+    {
+        if (rc.left == 0 && rc.right == width)
+        {
+            for (auto y = rc.top; y < rc.bottom; ++y)
+            {
+                invalidRows.at(y) = true;
+            }
+        }
+    }
+
+    // Gather the new contents and the hashes of the candidate rows. A hash of
+    // 0 marks a row that can't be compared, either because we don't know what
+    // we've sent, or because it's not a plain single width row.
+    const auto& buffer = renderData.GetTextBuffer();
+    std::vector<SentCell> newCells(_sentCells.size());
+    std::vector<size_t> newHashes(invalidRows.size(), 0);
+    std::vector<size_t> oldHashes(invalidRows.size(), 0);
+    const auto hashRow = [&](const std::vector<SentCell>& cells, const til::CoordType y) {
+        til::hasher h;
+        for (auto x = 0; x < width; ++x)
+        {
+            const auto& cell = cells.at(y * width + x);
+            if (!cell.valid)
+            {
+                return size_t{ 0 };
+            }
+            h.write(cell.text);
+            h.write(cell.attributes.GetLegacyAttributes());
+        }
+        return std::max<size_t>(h.finalize(), 1);
+    };
+
+    for (til::CoordType y = 0; y < height; ++y)
+    {
+        oldHashes.at(y) = hashRow(_sentCells, y);
+        if (!invalidRows.at(y) ||
+            buffer.GetLineRendition(gsl::narrow_cast<size_t>(view.Top() + y)) != LineRendition::SingleWidth)
+        {
+            continue;
+        }
+
+        auto it = buffer.GetCellLineDataAt({ view.Left(), gsl::narrow_cast<short>(view.Top() + y) });
+        if (it && it->DbcsAttr().IsTrailing())
+        {
+            continue;
+        }
+        for (auto x = 0; x < width && it; ++x, ++it)
+        {
+            auto& cell = newCells.at(y * width + x);
+            cell.text = _HashCellText(it->Chars(), it->DbcsAttr().IsTrailing() ? 1 : 0);
+            cell.attributes = it->TextAttr();
+            cell.valid = true;
+        }
+        newHashes.at(y) = hashRow(newCells, y);
+    }
+
+    const auto rowMatches = [&](const til::CoordType newRow, const til::CoordType oldRow) {
+        if (newHashes.at(newRow) == 0 || newHashes.at(newRow) != oldHashes.at(oldRow))
+        {
+            return false;
+        }
+        const auto newFirst = newCells.begin() + newRow * width;
+        const auto oldFirst = _sentCells.begin() + oldRow * width;
+        return std::equal(newFirst, newFirst + width, oldFirst, [](const SentCell& a, const SentCell& b) {
+            return a.valid && b.valid && a.text == b.text && a.attributes == b.attributes;
+        });
+    };
+
+    for (til::CoordType top = 0; top < height;)
+    {
+        if (!invalidRows.at(top))
+        {
+            ++top;
+            continue;
+        }
+
+        auto bottom = top;
+        while (bottom + 1 < height && invalidRows.at(bottom + 1))
+        {
+            ++bottom;
+        }
+        const auto length = bottom - top + 1;
+
+        // Moving the rows has to save more than just repainting the ones
+        // that didn't change at all.
+        til::CoordType unchanged = 0;
+        for (auto y = top; y <= bottom; ++y)
+        {
+            unchanged += rowMatches(y, y) ? 1 : 0;
+        }
+
+        for (til::CoordType n = 1; length - n >= MinimumScrolledRows; ++n)
+        {
+            const auto moved = length - n;
+            if (moved <= unchanged)
+            {
+                break;
+            }
+
+            auto up = true;
+            auto down = true;
+            for (auto y = top; y <= bottom - n && (up || down); ++y)
+            {
+                up = up && rowMatches(y, y + n);
+                down = down && rowMatches(y + n, y);
+            }
+
+            if (!up && !down)
+            {
+                continue;
+            }
+
+            // _MoveCursor has to take us to exactly these rows.
+            _wrappedRow = std::nullopt;
+            _delayedEolWrap = false;
+
+            const auto count = gsl::narrow_cast<short>(n);
+            const COORD blockTop{ 0, gsl::narrow_cast<short>(top) };
+            const COORD blockRest{ 0, gsl::narrow_cast<short>(bottom - n + 1) };
+
+            if (up)
+            {
+                // Delete the rows that scrolled off the top of the block, and
+                // if the block doesn't end at the bottom of the viewport, insert
+                // blank rows to keep the rows below it in place.
+                RETURN_IF_FAILED(_MoveCursor(blockTop));
+                RETURN_IF_FAILED(_DeleteLine(count));
+                if (bottom < height - 1)
+                {
+                    RETURN_IF_FAILED(_MoveCursor(blockRest));
+                    RETURN_IF_FAILED(_InsertLine(count));
+                }
+                _ScrollSentCells(blockTop.Y, gsl::narrow_cast<short>(bottom), gsl::narrow_cast<short>(-n));
+                _invalidMap.reset(til::rect{ 0, top, width, bottom - n + 1 });
+            }
+            else
+            {
+                if (bottom < height - 1)
+                {
+                    RETURN_IF_FAILED(_MoveCursor(blockRest));
+                    RETURN_IF_FAILED(_DeleteLine(count));
+                }
+                RETURN_IF_FAILED(_MoveCursor(blockTop));
+                RETURN_IF_FAILED(_InsertLine(count));
+                _ScrollSentCells(blockTop.Y, gsl::narrow_cast<short>(bottom), count);
+                _invalidMap.reset(til::rect{ 0, top + n, width, bottom + 1 });
+            }
+            break;
+        }
+
+        top = bottom + 1;
+    }
+
+    return S_OK;
+}
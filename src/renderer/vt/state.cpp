@@ -63,6 +63,25 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     // member is only defined when UNIT_TESTING is.
     _usingTestCallback = false;
 #endif
+
+    if (_hFile.get() != INVALID_HANDLE_VALUE)
+    {
+        _writerThread = std::thread{ [this]() { _WriterThread(); } };
+    }
+}
+
+VtEngine::~VtEngine()
+{
+    if (_writerThread.joinable())
+    {
+        {
+            const std::lock_guard lock{ _writerMutex };
+            _writerStopping = true;
+        }
+        _writerQueued.notify_one();
+        // The writer thread writes what's still queued before it exits.
+        _writerThread.join();
+    }
 }
 
 // Method Description:
@@ -98,6 +117,13 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     {
         _buffer.append(str);
 
+        // When output is being coalesced, don't let a single huge frame grow
+        // the buffer without bound. The rest of the frame is written later on.
+        if (_latencyBudget.count() > 0 && _buffer.size() >= MaxBufferedOutput)
+        {
+            return _Flush();
+        }
+
         return S_OK;
     }
     CATCH_RETURN();
@@ -115,11 +141,30 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 
     if (!_pipeBroken)
     {
-        bool fSuccess = !!WriteFile(_hFile.get(), _buffer.data(), gsl::narrow_cast<DWORD>(_buffer.size()), nullptr, nullptr);
+        std::string_view output{ _buffer };
+        if (_compressor && !_buffer.empty())
+        {
+            try
+            {
+                _compressedBuffer.clear();
+                _compressor->Compress(_buffer, _compressedBuffer);
+                output = _compressedBuffer;
+            }
+            catch (...)
+            {
+                // The terminal expects frames from now on, so we can't just
+                // write the output as is. Drop it, like a broken pipe would.
+                _buffer.clear();
+                return LOG_CAUGHT_EXCEPTION();
+            }
+        }
+
+        const auto hr = _QueueOutput(output);
+        _lastFlushSize = _buffer.size();
         _buffer.clear();
-        if (!fSuccess)
+        if (FAILED(hr))
         {
-            _exitResult = HRESULT_FROM_WIN32(GetLastError());
+            _exitResult = hr;
             _pipeBroken = true;
             if (_terminalOwner)
             {
@@ -132,6 +177,90 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     return S_OK;
 }
 
+// Method Description:
+// - Hands output over to the writer thread. This doesn't wait for the output
+//      to be written, unless we're tearing down.
+// Arguments:
+// - output: The output to write to the pipe.
+// Return Value:
+// - S_OK, or the error of an earlier write that failed, once the pipe has broken.
+[[nodiscard]] HRESULT VtEngine::_QueueOutput(const std::string_view output) noexcept
+try
+{
+    {
+        const std::lock_guard lock{ _writerMutex };
+        RETURN_IF_FAILED(_writerResult);
+        _queuedOutput.append(output);
+    }
+    _writerQueued.notify_one();
+
+    return _flushSynchronously ? _WaitForWriter(0) : S_OK;
+}
+CATCH_RETURN()
+
+// Method Description:
+// - Waits until no more than the given amount of output is waiting for the writer thread.
+//      With a maximum of 0, this waits until everything that was queued has been written.
+// Arguments:
+// - maxQueued: The number of bytes that may still be waiting.
+// Return Value:
+// - S_OK, or the error of a write that failed.
+[[nodiscard]] HRESULT VtEngine::_WaitForWriter(const size_t maxQueued) noexcept
+try
+{
+    std::unique_lock lock{ _writerMutex };
+    _writerWritten.wait(lock, [&]() {
+        return FAILED(_writerResult) || (_queuedOutput.size() <= maxQueued && (maxQueued != 0 || !_writerBusy));
+    });
+    return _writerResult;
+}
+CATCH_RETURN()
+
+// Method Description:
+// - The writer thread. It takes whatever output is queued in one go and writes it to the pipe.
+//      It exits once the engine is destroyed and everything that was queued is written,
+//      or once a write fails. The failure is reported by the next _Flush.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_WriterThread() noexcept
+{
+    std::unique_lock lock{ _writerMutex };
+    for (;;)
+    {
+        _writerQueued.wait(lock, [&]() { return _writerStopping || !_queuedOutput.empty(); });
+        if (_queuedOutput.empty())
+        {
+            return;
+        }
+
+        // Swapping the strings keeps the capacity of both of them,
+        // so that neither side has to allocate for the next frame.
+        _writingOutput.swap(_queuedOutput);
+        _queuedOutput.clear();
+        _writerBusy = true;
+        lock.unlock();
+        _writerWritten.notify_all();
+
+        const auto success = !!WriteFile(_hFile.get(), _writingOutput.data(), gsl::narrow_cast<DWORD>(_writingOutput.size()), nullptr, nullptr);
+        const auto error = success ? ERROR_SUCCESS : GetLastError();
+
+        lock.lock();
+        _writerBusy = false;
+        if (!success)
+        {
+            _writerResult = HRESULT_FROM_WIN32(error);
+            _queuedOutput.clear();
+        }
+        _writerWritten.notify_all();
+        if (!success)
+        {
+            return;
+        }
+    }
+}
+
 // Method Description:
 // - Wrapper for _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
@@ -227,6 +356,7 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
             hr = _ResizeWindow(newView.Width(), newView.Height());
         }
         _resized = true;
+        _InvalidateSentCells();
     }
 
     // See MSFT:19408543
@@ -423,6 +553,125 @@ void VtEngine::SetResizeQuirk(const bool resizeQuirk)
     _resizeQuirk = resizeQuirk;
 }
 
+// Method Description:
+// - Sets how long we may hold back output after a frame that wrote a lot of
+//   it, so that it's coalesced into fewer, larger writes to the pipe. This
+//   helps ConPTY sessions over slow or remote links, where every WriteFile
+//   has a noticeable cost.
+// Arguments:
+// - latencyBudget - the time to wait after bulk output. 0 disables coalescing.
+// Return Value:
+// - <none>
+void VtEngine::SetLatencyBudget(const std::chrono::milliseconds latencyBudget) noexcept
+{
+    _latencyBudget = latencyBudget;
+}
+
+// Method Description:
+// - Compresses everything we write to the pipe from now on. See
+//   ConptyCompression.hpp for the format. This must be called before anything
+//   was written, as the terminal only looks for compressed output at the start.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or an appropriate HRESULT if the compression API isn't available.
+//   The output isn't compressed then, which the terminal detects on its own.
+[[nodiscard]] HRESULT VtEngine::EnableOutputCompression() noexcept
+try
+{
+    _compressor = std::make_unique<Utils::ConptyCompression::Compressor>();
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Method Description:
+// - Starts passing the client's output through to the terminal. Until
+//   EndPassthrough is called, the changes made to the buffer aren't rendered,
+//   as the terminal makes them itself when it receives the same output.
+// - Anything that's pending must have been painted before calling this.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::BeginPassthrough() noexcept
+{
+    _inPassthrough = true;
+}
+
+// Method Description:
+// - Called when the client starts or ends a synchronized update (DECSET 2026).
+//   The renderer holds back frames until the update is complete, so the next
+//   frame we paint contains all of it. It's bracketed in the same sequences,
+//   so that the terminal doesn't present half of it either, if it happens to
+//   read the frame in several pieces.
+// Arguments:
+// - enabled - true at the start of an update, false at its end.
+// Return Value:
+// - <none>
+void VtEngine::SetSynchronizedOutput(const bool enabled) noexcept
+{
+    if (enabled)
+    {
+        _synchronizeNextFrame = true;
+    }
+}
+
+// Method Description:
+// - Ends passing the client's output through to the terminal, and writes that
+//   output to it. The terminal has interpreted the same sequences as we did,
+//   so what we remembered about its state (cursor, attributes, wrapping) is
+//   replaced with what we know now.
+// Arguments:
+// - str - the client's output
+// - cursor - the position of the cursor after processing it, relative to the viewport
+// - attributes - the current attributes after processing it
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to write.
+[[nodiscard]] HRESULT VtEngine::EndPassthrough(const std::wstring_view str, const COORD cursor, const TextAttribute& attributes) noexcept
+{
+    _inPassthrough = false;
+
+    _lastText = cursor;
+    _virtualTop = std::min(_virtualTop, cursor.Y);
+    _lastTextAttributes = attributes;
+    _wrappedRow = std::nullopt;
+    _delayedEolWrap = false;
+    _newBottomLine = false;
+    _deferredCursorPos = INVALID_COORDS;
+
+    // WriteTerminalW flushes, so that the output doesn't wait for the next frame.
+    return WriteTerminalW(str);
+}
+
+// Method Description:
+// - Blocks until the engine is able to render the next frame. With a latency
+//   budget and a previous frame that wasn't just interactive echo, this waits
+//   for the budget instead of the regular ~8ms, to give the client time to
+//   produce more output for the next frame.
+// - Before that, it waits for the writer thread if the terminal didn't keep up
+//   with the previous frames, so that the queued output doesn't grow without bound.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::WaitUntilCanRender() noexcept
+{
+    // This is called outside of the console lock, which makes it the
+    // place to wait for a terminal that doesn't keep up with our output.
+    if (_writerThread.joinable())
+    {
+        LOG_IF_FAILED(_WaitForWriter(MaxQueuedOutput));
+    }
+
+    if (_latencyBudget.count() > 0 && _lastFlushSize >= InteractiveFrameSize)
+    {
+        Sleep(gsl::narrow_cast<DWORD>(_latencyBudget.count()));
+        return;
+    }
+
+    RenderEngineBase::WaitUntilCanRender();
+}
+
 // Method Description:
 // - Manually emit a "Erase Scrollback" sequence to the connected terminal. We
 //   need to do this in certain cases that we've identified where we believe the
@@ -64,276 +64,181 @@ std::string toPrintableString(const std::string_view& inString)
     }
     return retval;
 }
-void RenderTracing::TraceString(const std::string_view& instr) const
+void RenderTracing::_TraceString(const std::string_view& instr) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const std::string _seq = toPrintableString(instr);
-        const char* const seq = _seq.c_str();
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceString",
-                          TraceLoggingUtf8String(seq),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-    UNREFERENCED_PARAMETER(instr);
-#endif UNIT_TESTING
+    const std::string _seq = toPrintableString(instr);
+    const char* const seq = _seq.c_str();
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceString",
+                      TraceLoggingUtf8String(seq),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TraceInvalidate(const til::rect& invalidRect) const
+void RenderTracing::_TraceInvalidate(const til::rect& invalidRect) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const auto invalidatedStr = invalidRect.to_string();
-        const auto invalidated = invalidatedStr.c_str();
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceInvalidate",
-                          TraceLoggingWideString(invalidated),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-    UNREFERENCED_PARAMETER(invalidRect);
-#endif UNIT_TESTING
+    const auto invalidatedStr = invalidRect.to_string();
+    const auto invalidated = invalidatedStr.c_str();
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceInvalidate",
+                      TraceLoggingWideString(invalidated),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TraceInvalidateAll(const til::rect& viewport) const
+void RenderTracing::_TraceInvalidateAll(const til::rect& viewport) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const auto invalidatedStr = viewport.to_string();
-        const auto invalidatedAll = invalidatedStr.c_str();
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceInvalidateAll",
-                          TraceLoggingWideString(invalidatedAll),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-    UNREFERENCED_PARAMETER(viewport);
-#endif UNIT_TESTING
+    const auto invalidatedStr = viewport.to_string();
+    const auto invalidatedAll = invalidatedStr.c_str();
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceInvalidateAll",
+                      TraceLoggingWideString(invalidatedAll),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TraceTriggerCircling(const bool newFrame) const
+void RenderTracing::_TraceTriggerCircling(const bool newFrame) const
 {
-#ifndef UNIT_TESTING
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
                       "VtEngine_TraceTriggerCircling",
                       TraceLoggingBool(newFrame),
                       TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
                       TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-#else
-    UNREFERENCED_PARAMETER(newFrame);
-#endif UNIT_TESTING
 }
 
-void RenderTracing::TraceInvalidateScroll(const til::point scroll) const
+void RenderTracing::_TraceInvalidateScroll(const til::point scroll) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+    const auto scrollDeltaStr = scroll.to_string();
+    const auto scrollDelta = scrollDeltaStr.c_str();
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceInvalidateScroll",
+                      TraceLoggingWideString(scrollDelta),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
+
+void RenderTracing::_TraceStartPaint(const bool quickReturn,
+                                     const til::pmr::bitmap& invalidMap,
+                                     const til::rect& lastViewport,
+                                     const til::point scrollDelt,
+                                     const bool cursorMoved,
+                                     const std::optional<short>& wrappedRow) const
+{
+    const auto invalidatedStr = invalidMap.to_string();
+    const auto invalidated = invalidatedStr.c_str();
+    const auto lastViewStr = lastViewport.to_string();
+    const auto lastView = lastViewStr.c_str();
+    const auto scrollDeltaStr = scrollDelt.to_string();
+    const auto scrollDelta = scrollDeltaStr.c_str();
+    if (wrappedRow.has_value())
     {
-        const auto scrollDeltaStr = scroll.to_string();
-        const auto scrollDelta = scrollDeltaStr.c_str();
         TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceInvalidateScroll",
+                          "VtEngine_TraceStartPaint",
+                          TraceLoggingBool(quickReturn),
+                          TraceLoggingWideString(invalidated),
+                          TraceLoggingWideString(lastView),
                           TraceLoggingWideString(scrollDelta),
+                          TraceLoggingBool(cursorMoved),
+                          TraceLoggingValue(wrappedRow.value()),
                           TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
                           TraceLoggingKeyword(TIL_KEYWORD_TRACE));
     }
-#else
-    UNREFERENCED_PARAMETER(scroll);
-#endif
-}
-
-void RenderTracing::TraceStartPaint(const bool quickReturn,
-                                    const til::pmr::bitmap& invalidMap,
-                                    const til::rect& lastViewport,
-                                    const til::point scrollDelt,
-                                    const bool cursorMoved,
-                                    const std::optional<short>& wrappedRow) const
-{
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
+    else
     {
-        const auto invalidatedStr = invalidMap.to_string();
-        const auto invalidated = invalidatedStr.c_str();
-        const auto lastViewStr = lastViewport.to_string();
-        const auto lastView = lastViewStr.c_str();
-        const auto scrollDeltaStr = scrollDelt.to_string();
-        const auto scrollDelta = scrollDeltaStr.c_str();
-        if (wrappedRow.has_value())
-        {
-            TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                              "VtEngine_TraceStartPaint",
-                              TraceLoggingBool(quickReturn),
-                              TraceLoggingWideString(invalidated),
-                              TraceLoggingWideString(lastView),
-                              TraceLoggingWideString(scrollDelta),
-                              TraceLoggingBool(cursorMoved),
-                              TraceLoggingValue(wrappedRow.value()),
-                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-        }
-        else
-        {
-            TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                              "VtEngine_TraceStartPaint",
-                              TraceLoggingBool(quickReturn),
-                              TraceLoggingWideString(invalidated),
-                              TraceLoggingWideString(lastView),
-                              TraceLoggingWideString(scrollDelta),
-                              TraceLoggingBool(cursorMoved),
-                              TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-        }
+        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                          "VtEngine_TraceStartPaint",
+                          TraceLoggingBool(quickReturn),
+                          TraceLoggingWideString(invalidated),
+                          TraceLoggingWideString(lastView),
+                          TraceLoggingWideString(scrollDelta),
+                          TraceLoggingBool(cursorMoved),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
     }
-#else
-    UNREFERENCED_PARAMETER(quickReturn);
-    UNREFERENCED_PARAMETER(invalidMap);
-    UNREFERENCED_PARAMETER(lastViewport);
-    UNREFERENCED_PARAMETER(scrollDelt);
-    UNREFERENCED_PARAMETER(cursorMoved);
-    UNREFERENCED_PARAMETER(wrappedRow);
-#endif UNIT_TESTING
 }
 
-void RenderTracing::TraceEndPaint() const
+void RenderTracing::_TraceEndPaint() const
 {
-#ifndef UNIT_TESTING
     TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
                       "VtEngine_TraceEndPaint",
                       TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
                       TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-#else
-#endif UNIT_TESTING
 }
 
-void RenderTracing::TraceLastText(const til::point lastTextPos) const
+void RenderTracing::_TraceLastText(const til::point lastTextPos) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const auto lastTextStr = lastTextPos.to_string();
-        const auto lastText = lastTextStr.c_str();
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceLastText",
-                          TraceLoggingWideString(lastText),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-    UNREFERENCED_PARAMETER(lastTextPos);
-#endif UNIT_TESTING
+    const auto lastTextStr = lastTextPos.to_string();
+    const auto lastText = lastTextStr.c_str();
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceLastText",
+                      TraceLoggingWideString(lastText),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TraceScrollFrame(const til::point scrollDeltaPos) const
+void RenderTracing::_TraceScrollFrame(const til::point scrollDeltaPos) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const auto scrollDeltaStr = scrollDeltaPos.to_string();
-        const auto scrollDelta = scrollDeltaStr.c_str();
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceScrollFrame",
-                          TraceLoggingWideString(scrollDelta),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-    UNREFERENCED_PARAMETER(scrollDeltaPos);
-#endif UNIT_TESTING
+    const auto scrollDeltaStr = scrollDeltaPos.to_string();
+    const auto scrollDelta = scrollDeltaStr.c_str();
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceScrollFrame",
+                      TraceLoggingWideString(scrollDelta),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TraceMoveCursor(const til::point lastTextPos, const til::point cursor) const
+void RenderTracing::_TraceMoveCursor(const til::point lastTextPos, const til::point cursor) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const auto lastTextStr = lastTextPos.to_string();
-        const auto lastText = lastTextStr.c_str();
+    const auto lastTextStr = lastTextPos.to_string();
+    const auto lastText = lastTextStr.c_str();
 
-        const auto cursorStr = cursor.to_string();
-        const auto cursorPos = cursorStr.c_str();
+    const auto cursorStr = cursor.to_string();
+    const auto cursorPos = cursorStr.c_str();
 
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceMoveCursor",
-                          TraceLoggingWideString(lastText),
-                          TraceLoggingWideString(cursorPos),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-    UNREFERENCED_PARAMETER(lastTextPos);
-    UNREFERENCED_PARAMETER(cursor);
-#endif UNIT_TESTING
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceMoveCursor",
+                      TraceLoggingWideString(lastText),
+                      TraceLoggingWideString(cursorPos),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TraceWrapped() const
+void RenderTracing::_TraceWrapped() const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const auto* const msg = "Wrapped instead of \\r\\n";
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceWrapped",
-                          TraceLoggingString(msg),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-#endif UNIT_TESTING
+    const auto* const msg = "Wrapped instead of \\r\\n";
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceWrapped",
+                      TraceLoggingString(msg),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TraceSetWrapped(const short wrappedRow) const
+void RenderTracing::_TraceSetWrapped(const short wrappedRow) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceSetWrapped",
-                          TraceLoggingValue(wrappedRow),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-    UNREFERENCED_PARAMETER(wrappedRow);
-#endif UNIT_TESTING
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceSetWrapped",
+                      TraceLoggingValue(wrappedRow),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TraceClearWrapped() const
+void RenderTracing::_TraceClearWrapped() const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const auto* const msg = "Cleared wrap state";
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TraceClearWrapped",
-                          TraceLoggingString(msg),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-#endif UNIT_TESTING
+    const auto* const msg = "Cleared wrap state";
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TraceClearWrapped",
+                      TraceLoggingString(msg),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
 
-void RenderTracing::TracePaintCursor(const til::point coordCursor) const
+void RenderTracing::_TracePaintCursor(const til::point coordCursor) const
 {
-#ifndef UNIT_TESTING
-    if (TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
-    {
-        const auto cursorPosString = coordCursor.to_string();
-        const auto cursorPos = cursorPosString.c_str();
-        TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
-                          "VtEngine_TracePaintCursor",
-                          TraceLoggingWideString(cursorPos),
-                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
-                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
-    }
-#else
-    UNREFERENCED_PARAMETER(coordCursor);
-#endif UNIT_TESTING
+    const auto cursorPosString = coordCursor.to_string();
+    const auto cursorPos = cursorPosString.c_str();
+    TraceLoggingWrite(g_hConsoleVtRendererTraceProvider,
+                      "VtEngine_TracePaintCursor",
+                      TraceLoggingWideString(cursorPos),
+                      TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                      TraceLoggingKeyword(TIL_KEYWORD_TRACE));
 }
@@ -7,6 +7,10 @@ Module Name:
 
 Abstract:
 - This module is used for recording tracing/debugging information to the telemetry ETW channel
+- The methods are called while painting every frame. They're inlined and
+  check whether anyone is listening first, so that the strings they log are
+  only ever formatted while a session has enabled the provider. Unit tests
+  never trace at all.
 --*/
 
 #pragma once
@@ -26,24 +30,152 @@ namespace Microsoft::Console::VirtualTerminal
     public:
         RenderTracing();
         ~RenderTracing();
-        void TraceString(const std::string_view& str) const;
-        void TraceInvalidate(const til::rect& view) const;
-        void TraceLastText(const til::point lastText) const;
-        void TraceScrollFrame(const til::point scrollDelta) const;
-        void TraceMoveCursor(const til::point lastText, const til::point cursor) const;
-        void TraceSetWrapped(const short wrappedRow) const;
-        void TraceClearWrapped() const;
-        void TraceWrapped() const;
-        void TracePaintCursor(const til::point coordCursor) const;
-        void TraceInvalidateAll(const til::rect& view) const;
-        void TraceTriggerCircling(const bool newFrame) const;
-        void TraceInvalidateScroll(const til::point scroll) const;
+
+        static bool IsEnabled() noexcept
+        {
+#ifndef UNIT_TESTING
+            return TraceLoggingProviderEnabled(g_hConsoleVtRendererTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+#else
+            return false;
+#endif
+        }
+
+        void TraceString(const std::string_view& str) const
+        {
+            if (IsEnabled())
+            {
+                _TraceString(str);
+            }
+        }
+
+        void TraceInvalidate(const til::rect& view) const
+        {
+            if (IsEnabled())
+            {
+                _TraceInvalidate(view);
+            }
+        }
+
+        void TraceLastText(const til::point lastText) const
+        {
+            if (IsEnabled())
+            {
+                _TraceLastText(lastText);
+            }
+        }
+
+        void TraceScrollFrame(const til::point scrollDelta) const
+        {
+            if (IsEnabled())
+            {
+                _TraceScrollFrame(scrollDelta);
+            }
+        }
+
+        void TraceMoveCursor(const til::point lastText, const til::point cursor) const
+        {
+            if (IsEnabled())
+            {
+                _TraceMoveCursor(lastText, cursor);
+            }
+        }
+
+        void TraceSetWrapped(const short wrappedRow) const
+        {
+            if (IsEnabled())
+            {
+                _TraceSetWrapped(wrappedRow);
+            }
+        }
+
+        void TraceClearWrapped() const
+        {
+            if (IsEnabled())
+            {
+                _TraceClearWrapped();
+            }
+        }
+
+        void TraceWrapped() const
+        {
+            if (IsEnabled())
+            {
+                _TraceWrapped();
+            }
+        }
+
+        void TracePaintCursor(const til::point coordCursor) const
+        {
+            if (IsEnabled())
+            {
+                _TracePaintCursor(coordCursor);
+            }
+        }
+
+        void TraceInvalidateAll(const til::rect& view) const
+        {
+            if (IsEnabled())
+            {
+                _TraceInvalidateAll(view);
+            }
+        }
+
+        void TraceTriggerCircling(const bool newFrame) const
+        {
+            if (IsEnabled())
+            {
+                _TraceTriggerCircling(newFrame);
+            }
+        }
+
+        void TraceInvalidateScroll(const til::point scroll) const
+        {
+            if (IsEnabled())
+            {
+                _TraceInvalidateScroll(scroll);
+            }
+        }
+
         void TraceStartPaint(const bool quickReturn,
                              const til::pmr::bitmap& invalidMap,
                              const til::rect& lastViewport,
                              const til::point scrollDelta,
                              const bool cursorMoved,
-                             const std::optional<short>& wrappedRow) const;
-        void TraceEndPaint() const;
+                             const std::optional<short>& wrappedRow) const
+        {
+            if (IsEnabled())
+            {
+                _TraceStartPaint(quickReturn, invalidMap, lastViewport, scrollDelta, cursorMoved, wrappedRow);
+            }
+        }
+
+        void TraceEndPaint() const
+        {
+            if (IsEnabled())
+            {
+                _TraceEndPaint();
+            }
+        }
+
+    private:
+        void _TraceString(const std::string_view& str) const;
+        void _TraceInvalidate(const til::rect& view) const;
+        void _TraceLastText(const til::point lastText) const;
+        void _TraceScrollFrame(const til::point scrollDelta) const;
+        void _TraceMoveCursor(const til::point lastText, const til::point cursor) const;
+        void _TraceSetWrapped(const short wrappedRow) const;
+        void _TraceClearWrapped() const;
+        void _TraceWrapped() const;
+        void _TracePaintCursor(const til::point coordCursor) const;
+        void _TraceInvalidateAll(const til::rect& view) const;
+        void _TraceTriggerCircling(const bool newFrame) const;
+        void _TraceInvalidateScroll(const til::point scroll) const;
+        void _TraceStartPaint(const bool quickReturn,
+                              const til::pmr::bitmap& invalidMap,
+                              const til::rect& lastViewport,
+                              const til::point scrollDelta,
+                              const bool cursorMoved,
+                              const std::optional<short>& wrappedRow) const;
+        void _TraceEndPaint() const;
     };
 }
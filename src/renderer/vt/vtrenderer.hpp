@@ -17,9 +17,11 @@ Author(s):
 
 #include "../inc/RenderEngineBase.hpp"
 #include "../../types/inc/Viewport.hpp"
+#include "../../types/inc/ConptyCompression.hpp"
 #include "tracing.hpp"
 #include <string>
 #include <functional>
+#include <condition_variable>
 
 // fwdecl unittest classes
 #ifdef UNIT_TESTING
@@ -45,6 +47,7 @@ namespace Microsoft::Console::Render
 
         VtEngine(_In_ wil::unique_hfile hPipe,
                  const Microsoft::Console::Types::Viewport initialViewport);
+        ~VtEngine() override;
 
         // IRenderEngine
         [[nodiscard]] HRESULT StartPaint() noexcept override;
@@ -56,6 +59,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT InvalidateSystem(const RECT* prcDirtyClient) noexcept override;
         [[nodiscard]] HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override;
         [[nodiscard]] HRESULT InvalidateAll() noexcept override;
+        [[nodiscard]] HRESULT InvalidateTitle(const std::wstring_view proposedTitle) noexcept override;
         [[nodiscard]] HRESULT InvalidateCircling(_Out_ bool* pForcePaint) noexcept override;
         [[nodiscard]] HRESULT PaintBackground() noexcept override;
         [[nodiscard]] HRESULT PaintBufferLine(gsl::span<const Cluster> clusters, COORD coord, bool fTrimLeft, bool lineWrapped) noexcept override;
@@ -69,6 +73,8 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT GetDirtyArea(gsl::span<const til::rect>& area) noexcept override;
         [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* pFontSize) noexcept override;
         [[nodiscard]] HRESULT IsGlyphWideByFont(std::wstring_view glyph, _Out_ bool* pResult) noexcept override;
+        [[nodiscard]] HRESULT PrepareRenderInfo(const RenderFrameInfo& info) noexcept override;
+        void WaitUntilCanRender() noexcept override;
 
         // VtEngine
         [[nodiscard]] HRESULT SuppressResizeRepaint() noexcept;
@@ -80,12 +86,22 @@ namespace Microsoft::Console::Render
         void BeginResizeRequest();
         void EndResizeRequest();
         void SetResizeQuirk(const bool resizeQuirk);
+        void SetLatencyBudget(const std::chrono::milliseconds latencyBudget) noexcept;
+        [[nodiscard]] HRESULT EnableOutputCompression() noexcept;
+        void SetFrameDiff(const bool frameDiff) noexcept;
+        void SetRepeatCharacters(const bool repeatCharacters) noexcept;
+        void ForgetSentCells() noexcept;
+        void BeginPassthrough() noexcept;
+        void SetSynchronizedOutput(const bool enabled) noexcept;
+        [[nodiscard]] virtual HRESULT EndPassthrough(const std::wstring_view str, const COORD cursor, const TextAttribute& attributes) noexcept;
         [[nodiscard]] virtual HRESULT ManuallyClearScrollback() noexcept;
         [[nodiscard]] HRESULT RequestWin32Input() noexcept;
 
     protected:
         wil::unique_hfile _hFile;
         std::string _buffer;
+        std::unique_ptr<Microsoft::Console::Utils::ConptyCompression::Compressor> _compressor;
+        std::string _compressedBuffer;
 
         std::string _formatBuffer;
         std::string _conversionBuffer;
@@ -126,10 +142,73 @@ namespace Microsoft::Console::Render
         bool _delayedEolWrap{ false };
 
         bool _resizeQuirk{ false };
+
+        // With a latency budget, frames that produced bulk output are followed
+        // by a longer pause, so that more of the output is coalesced into the
+        // next WriteFile. Frames smaller than InteractiveFrameSize (echoed keys,
+        // a blinking cursor) keep the regular pacing.
+        static constexpr size_t InteractiveFrameSize = 256;
+        static constexpr size_t MaxBufferedOutput = 64 * 1024;
+        std::chrono::milliseconds _latencyBudget{ 0 };
+        size_t _lastFlushSize{ 0 };
+
+        // The pipe is written by a thread of its own, so that a terminal that's
+        // slow to read doesn't stall the renderer (and the console lock it holds)
+        // in WriteFile. _Flush only queues the output of a frame, while the writer
+        // thread writes the previous one. WaitUntilCanRender holds the next frame
+        // back while more than MaxQueuedOutput is waiting, which bounds the memory.
+        static constexpr size_t MaxQueuedOutput = 4 * 1024 * 1024;
+        std::thread _writerThread;
+        std::mutex _writerMutex;
+        std::condition_variable _writerQueued; // the writer thread waits for output...
+        std::condition_variable _writerWritten; // ...and the renderer for the writer.
+        std::string _queuedOutput; // guarded by _writerMutex
+        std::string _writingOutput; // only used by the writer thread
+        bool _writerBusy{ false }; // guarded by _writerMutex
+        bool _writerStopping{ false }; // guarded by _writerMutex
+        HRESULT _writerResult{ S_OK }; // guarded by _writerMutex
+        // During teardown the process exits right after the last frame, so it's written synchronously.
+        bool _flushSynchronously{ false };
+
+        // While the client's output is passed through to the terminal as is,
+        // the changes it makes to our buffer must not be rendered a second time.
+        bool _inPassthrough{ false };
+
+        // The frame that contains a synchronized update of the client is
+        // bracketed in DECSET/DECRST 2026, for the terminal to present it at once.
+        bool _synchronizeNextFrame{ false };
+        bool _inSynchronizedFrame{ false };
+
+        // With frame diffing, we remember what each cell of the terminal's
+        // viewport shows, as far as we know. Spans that are painted again with
+        // the same contents are skipped, and rows that merely moved within a
+        // block of invalid rows are scrolled into place with DL/IL.
+        struct SentCell
+        {
+            size_t text{ 0 };
+            TextAttribute attributes{};
+            bool valid{ false };
+        };
+        static constexpr short MinimumScrolledRows = 2;
+        bool _frameDiff{ false };
+        std::vector<SentCell> _sentCells;
+        bool _repeatCharacters{ false };
+        TextAttribute _paintAttributes{};
+
+        void _InvalidateSentCells() noexcept;
+        void _ScrollSentCells(const short top, const short bottom, const short delta) noexcept;
+        bool _IsSpanUnchanged(gsl::span<const Cluster> clusters, const COORD coord, const bool lineWrapped) const noexcept;
+        void _RecordSentSpan(gsl::span<const Cluster> clusters, const COORD coord) noexcept;
+        [[nodiscard]] HRESULT _ScrollShiftedRows(IRenderData& renderData);
+        static size_t _HashCellText(const std::wstring_view text, const size_t column) noexcept;
+
         std::optional<TextColor> _newBottomLineBG{ std::nullopt };
 
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
+        [[nodiscard]] HRESULT _QueueOutput(const std::string_view output) noexcept;
+        [[nodiscard]] HRESULT _WaitForWriter(const size_t maxQueued) noexcept;
+        void _WriterThread() noexcept;
 
         template<typename S, typename... Args>
         [[nodiscard]] HRESULT _WriteFormatted(S&& format, Args&&... args)
@@ -148,12 +227,15 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _StartCursorBlinking() noexcept;
         [[nodiscard]] HRESULT _HideCursor() noexcept;
         [[nodiscard]] HRESULT _ShowCursor() noexcept;
+        [[nodiscard]] HRESULT _BeginSynchronizedUpdate() noexcept;
+        [[nodiscard]] HRESULT _EndSynchronizedUpdate() noexcept;
         [[nodiscard]] HRESULT _EraseLine() noexcept;
         [[nodiscard]] HRESULT _InsertDeleteLine(const short sLines, const bool fInsertLine) noexcept;
         [[nodiscard]] HRESULT _DeleteLine(const short sLines) noexcept;
         [[nodiscard]] HRESULT _InsertLine(const short sLines) noexcept;
         [[nodiscard]] HRESULT _CursorForward(const short chars) noexcept;
         [[nodiscard]] HRESULT _EraseCharacter(const short chars) noexcept;
+        [[nodiscard]] HRESULT _RepeatCharacter(const size_t count) noexcept;
         [[nodiscard]] HRESULT _CursorPosition(const COORD coord) noexcept;
         [[nodiscard]] HRESULT _CursorHome() noexcept;
         [[nodiscard]] HRESULT _ClearScreen() noexcept;
@@ -192,6 +274,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] virtual HRESULT _MoveCursor(const COORD coord) noexcept = 0;
         [[nodiscard]] HRESULT _RgbUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
         [[nodiscard]] HRESULT _16ColorUpdateDrawingBrushes(const TextAttribute& textAttributes) noexcept;
+        bool _IsGraphicsResetShorter(const TextAttribute& textAttributes) const noexcept;
 
         bool _WillWriteSingleChar() const;
 
@@ -201,6 +284,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _PaintUtf8BufferLine(gsl::span<const Cluster> const clusters,
                                                    const COORD coord,
                                                    const bool lineWrapped) noexcept;
+        [[nodiscard]] HRESULT _WriteBufferLineWithRepeats(gsl::span<const Cluster> const clusters, const size_t cch) noexcept;
 
         [[nodiscard]] HRESULT _PaintAsciiBufferLine(gsl::span<const Cluster> const clusters,
                                                     const COORD coord) noexcept;
@@ -10,6 +10,39 @@
 
 constexpr size_t structPacketDataSize = sizeof(_CONSOLE_API_MSG) - offsetof(_CONSOLE_API_MSG, Descriptor);
 
+// Routine Description:
+// - Resizes the buffer to the given size for the next message. Its previous contents are not preserved.
+// Arguments:
+// - size - Supplies the size of the payload in bytes.
+// Return Value:
+// - A pointer to the (uninitialized) payload storage.
+BYTE* ApiMessagePayloadBuffer::Prepare(const size_t size)
+{
+    _highWaterMark = std::max(_highWaterMark, size);
+
+    if (++_uses >= ShrinkInterval)
+    {
+        if (_storage.capacity() > ShrinkThreshold && (_storage.capacity() >> 1) > _highWaterMark)
+        {
+            _storage.clear();
+            _storage.shrink_to_fit();
+        }
+        _highWaterMark = size;
+        _uses = 0;
+    }
+
+    // The payload is about to be overwritten anyways. There's no need to zero it.
+    _storage.resize(size, boost::container::default_init);
+    return _storage.data();
+}
+
+// Routine Description:
+// - Marks the buffer as unused, while keeping its capacity around for the next message.
+void ApiMessagePayloadBuffer::Reset() noexcept
+{
+    _storage.clear();
+}
+
 _CONSOLE_API_MSG::_CONSOLE_API_MSG()
 {
     // A union cannot have more than one initializer,
@@ -31,6 +64,7 @@ _CONSOLE_API_MSG& _CONSOLE_API_MSG::operator=(const _CONSOLE_API_MSG& other)
     _pApiRoutines = other._pApiRoutines;
     _inputBuffer = other._inputBuffer;
     _outputBuffer = other._outputBuffer;
+    _receivedPacketSize = other._receivedPacketSize;
 
     // Since this struct uses anonymous unions and thus cannot
     // explicitly reference it, we have to a bit cheeky to copy it.
@@ -106,16 +140,23 @@ try
 
         const ULONG cbReadSize = Descriptor.InputSize - State.ReadOffset;
 
-        // If we were previously called with a huge buffer we have an equally large _inputBuffer.
-        // We shouldn't just keep this huge buffer around, if no one needs it anymore.
-        if (_inputBuffer.capacity() > 16 * 1024 && (_inputBuffer.capacity() >> 1) > cbReadSize)
+        _inputBuffer.Prepare(cbReadSize);
+
+        // Chatty apps tend to send lots of tiny messages. The input of those
+        // was copied into the packet by ReadIo() already, which saves us a round
+        // trip to the driver. This only holds for API calls however, as the raw
+        // I/O functions clear parts of the packet before reading their input.
+        const auto inlineInputSize = _receivedPacketSize > sizeof(Descriptor) ? _receivedPacketSize - sizeof(Descriptor) : 0;
+        if (Descriptor.Function == CONSOLE_IO_USER_DEFINED && Descriptor.InputSize <= inlineInputSize)
         {
-            _inputBuffer.shrink_to_fit();
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+            const auto inlineInput = reinterpret_cast<const BYTE*>(&Descriptor + 1);
+            memcpy(_inputBuffer.data(), inlineInput + State.ReadOffset, cbReadSize);
+        }
+        else
+        {
+            RETURN_IF_FAILED(ReadMessageInput(0, _inputBuffer.data(), cbReadSize));
         }
-
-        _inputBuffer.resize(cbReadSize);
-
-        RETURN_IF_FAILED(ReadMessageInput(0, _inputBuffer.data(), cbReadSize));
 
         State.InputBuffer = _inputBuffer.data();
         State.InputBufferSize = cbReadSize;
@@ -152,14 +193,7 @@ try
         ULONG cbWriteSize = Descriptor.OutputSize - State.WriteOffset;
         RETURN_IF_FAILED(ULongMult(cbWriteSize, cbFactor, &cbWriteSize));
 
-        // If we were previously called with a huge buffer we have an equally large _outputBuffer.
-        // We shouldn't just keep this huge buffer around, if no one needs it anymore.
-        if (_outputBuffer.capacity() > 16 * 1024 && (_outputBuffer.capacity() >> 1) > cbWriteSize)
-        {
-            _outputBuffer.shrink_to_fit();
-        }
-
-        _outputBuffer.resize(cbWriteSize);
+        _outputBuffer.Prepare(cbWriteSize);
 
         // 0 it out.
         std::fill_n(_outputBuffer.data(), _outputBuffer.size(), BYTE(0));
@@ -206,7 +240,7 @@ CATCH_RETURN();
 
     if (State.InputBuffer != nullptr)
     {
-        _inputBuffer.clear();
+        _inputBuffer.Reset();
         State.InputBuffer = nullptr;
         State.InputBufferSize = 0;
     }
@@ -224,7 +258,7 @@ CATCH_RETURN();
             LOG_IF_FAILED(_pDeviceComm->WriteOutput(&IoOperation));
         }
 
-        _outputBuffer.clear();
+        _outputBuffer.Reset();
         State.OutputBuffer = nullptr;
         State.OutputBufferSize = 0;
     }
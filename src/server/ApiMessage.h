@@ -25,6 +25,35 @@ class ConsoleHandleData;
 
 class IDeviceComm;
 
+// The storage for the input or output payload of a message.
+// The message of the IO thread is reused for every message it receives, and this
+// keeps its payload buffers around as large as the largest recent payload.
+// Bulk API calls like full-screen WriteConsoleOutputW redraws thus don't allocate
+// at all after the first one, even when interleaved with smaller calls.
+// A buffer is only shrunk once its high-water mark stayed well below its
+// capacity for a while, so that a single huge payload doesn't pin memory forever.
+class ApiMessagePayloadBuffer
+{
+public:
+    BYTE* Prepare(const size_t size);
+    void Reset() noexcept;
+
+    BYTE* data() noexcept { return _storage.data(); }
+    size_t size() const noexcept { return _storage.size(); }
+
+private:
+    static constexpr size_t ShrinkThreshold = 16 * 1024;
+    static constexpr uint32_t ShrinkInterval = 64;
+
+    boost::container::small_vector<BYTE, 128> _storage;
+    size_t _highWaterMark = 0;
+    uint32_t _uses = 0;
+
+#ifdef UNIT_TESTING
+    friend class ApiMessagePayloadBufferTests;
+#endif
+};
+
 typedef struct _CONSOLE_API_MSG
 {
     _CONSOLE_API_MSG();
@@ -62,10 +91,14 @@ typedef struct _CONSOLE_API_MSG
     IDeviceComm* _pDeviceComm{ nullptr };
     IApiRoutines* _pApiRoutines{ nullptr };
 
-    boost::container::small_vector<BYTE, 128> _inputBuffer;
-    boost::container::small_vector<BYTE, 128> _outputBuffer;
+    ApiMessagePayloadBuffer _inputBuffer;
+    ApiMessagePayloadBuffer _outputBuffer;
+
+    // The number of bytes of packet data the driver filled in, or 0 if unknown.
+    ULONG _receivedPacketSize{ 0 };
 
     // From here down is the actual packet data sent/received.
+    // The driver fills in the descriptor, followed by as much of the message's input as fits.
     CD_IO_DESCRIPTOR Descriptor;
     union
     {
@@ -85,6 +118,9 @@ typedef struct _CONSOLE_API_MSG
             } u;
         };
     };
+    // The rest of the input of messages that don't fit into the above, like the text
+    // of a WriteConsoleOutputCharacter call. See GetInputBuffer().
+    BYTE _inlineInput[1024];
     // End packet data
 
     // DO NOT PUT MORE FIELDS DOWN HERE.
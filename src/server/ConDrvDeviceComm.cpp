@@ -33,6 +33,9 @@ ConDrvDeviceComm::~ConDrvDeviceComm()
 
 // Routine Description:
 // - Retrieves a packet message from the driver representing the next action/activity that should be performed.
+// - The driver copies as much of the message's input as fits into the packet.
+//   The packet size we received is recorded, so that GetInputBuffer() can skip reading
+//   the input payload of small messages with another round trip to the driver.
 // Arguments:
 // - pCompletion - Optional completion structure from the previous activity (can be used in lieu of calling CompleteIo separately.)
 // - pMessage - A structure to hold the message data retrieved from the driver.
@@ -41,11 +44,14 @@ ConDrvDeviceComm::~ConDrvDeviceComm()
 [[nodiscard]] HRESULT ConDrvDeviceComm::ReadIo(_In_opt_ PCONSOLE_API_MSG const pReplyMsg,
                                                _Out_ CONSOLE_API_MSG* const pMessage) const
 {
+    DWORD cbWritten = 0;
     HRESULT hr = _CallIoctl(IOCTL_CONDRV_READ_IO,
                             pReplyMsg == nullptr ? nullptr : &pReplyMsg->Complete,
                             pReplyMsg == nullptr ? 0 : sizeof(pReplyMsg->Complete),
                             &pMessage->Descriptor,
-                            sizeof(CONSOLE_API_MSG) - FIELD_OFFSET(CONSOLE_API_MSG, Descriptor));
+                            sizeof(CONSOLE_API_MSG) - FIELD_OFFSET(CONSOLE_API_MSG, Descriptor),
+                            &cbWritten);
+    pMessage->_receivedPacketSize = SUCCEEDED(hr) ? cbWritten : 0;
 
     if (hr == HRESULT_FROM_WIN32(ERROR_IO_PENDING))
     {
@@ -128,16 +134,18 @@ ConDrvDeviceComm::~ConDrvDeviceComm()
 // - cbInBufferSize - The length in bytes of the optional input buffer.
 // - pOutBuffer - An optional buffer to send as output with the verb. Usage depends on the control code.
 // - cbOutBufferSize - The length in bytes of the optional output buffer.
+// - pcbWritten - Optionally receives the number of bytes written to the output buffer.
 // Return Value:
 // - HRESULT S_OK or suitable error.
 [[nodiscard]] HRESULT ConDrvDeviceComm::_CallIoctl(_In_ DWORD dwIoControlCode,
                                                    _In_reads_bytes_opt_(cbInBufferSize) PVOID pInBuffer,
                                                    _In_ DWORD cbInBufferSize,
                                                    _Out_writes_bytes_opt_(cbOutBufferSize) PVOID pOutBuffer,
-                                                   _In_ DWORD cbOutBufferSize) const
+                                                   _In_ DWORD cbOutBufferSize,
+                                                   _Out_opt_ DWORD* pcbWritten) const
 {
     // See: https://msdn.microsoft.com/en-us/library/windows/desktop/aa363216(v=vs.85).aspx
-    // Written is unused but cannot be nullptr because we aren't using overlapped.
+    // Written cannot be nullptr because we aren't using overlapped.
     DWORD cbWritten = 0;
     RETURN_IF_WIN32_BOOL_FALSE(DeviceIoControl(_Server.get(),
                                                dwIoControlCode,
@@ -148,6 +156,10 @@ ConDrvDeviceComm::~ConDrvDeviceComm()
                                                &cbWritten,
                                                nullptr));
 
+    if (pcbWritten)
+    {
+        *pcbWritten = cbWritten;
+    }
     return S_OK;
 }
 
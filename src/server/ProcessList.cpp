@@ -58,14 +58,20 @@ using namespace Microsoft::Console::Interactivity;
 
     try
     {
-        pProcessData = new ConsoleProcessHandle(dwProcessId,
-                                                dwThreadId,
-                                                ulProcessGroupId);
+        // The constructor is private to us, so make_unique can't be used.
+        std::unique_ptr<ConsoleProcessHandle> processData{ new ConsoleProcessHandle(dwProcessId,
+                                                                                    dwThreadId,
+                                                                                    ulProcessGroupId) };
 
         // Some applications, when reading the process list through the GetConsoleProcessList API, are expecting
         // the returned list of attached process IDs to be from newest to oldest.
         // As such, we have to put the newest process into the head of the list.
-        _processes.push_front(pProcessData);
+        _processes.push_front(processData.get());
+        auto removeOnFailure = wil::scope_exit([&]() { _processes.pop_front(); });
+        _processesById.emplace(dwProcessId, _processes.begin());
+        removeOnFailure.release();
+
+        pProcessData = processData.release();
 
         if (nullptr != ppProcessData)
         {
@@ -87,10 +93,12 @@ void ConsoleProcessList::FreeProcessData(_In_ ConsoleProcessHandle* const pProce
 {
     FAIL_FAST_IF(!(ServiceLocator::LocateGlobals().getConsoleInformation().IsConsoleLocked()));
 
-    // Assert that the item exists in the list. If it doesn't exist, the end/last will be returned.
-    FAIL_FAST_IF(!(_processes.cend() != std::find(_processes.cbegin(), _processes.cend(), pProcessData)));
+    // Assert that the item exists in the list.
+    const auto it = _processesById.find(pProcessData->dwProcessId);
+    FAIL_FAST_IF(it == _processesById.end() || *it->second != pProcessData);
 
-    _processes.remove(pProcessData);
+    _processes.erase(it->second);
+    _processesById.erase(it);
 
     delete pProcessData;
 }
@@ -104,31 +112,16 @@ void ConsoleProcessList::FreeProcessData(_In_ ConsoleProcessHandle* const pProce
 // - Pointer to the process handle information or nullptr if no match was found.
 ConsoleProcessHandle* ConsoleProcessList::FindProcessInList(const DWORD dwProcessId) const
 {
-    auto it = _processes.cbegin();
-
-    while (it != _processes.cend())
+    if (ROOT_PROCESS_ID != dwProcessId)
     {
-        ConsoleProcessHandle* const pProcessHandleRecord = *it;
-
-        if (ROOT_PROCESS_ID != dwProcessId)
-        {
-            if (pProcessHandleRecord->dwProcessId == dwProcessId)
-            {
-                return pProcessHandleRecord;
-            }
-        }
-        else
-        {
-            if (pProcessHandleRecord->fRootProcess)
-            {
-                return pProcessHandleRecord;
-            }
-        }
-
-        it = std::next(it);
+        const auto it = _processesById.find(dwProcessId);
+        return it != _processesById.end() ? *it->second : nullptr;
     }
 
-    return nullptr;
+    const auto it = std::find_if(_processes.cbegin(), _processes.cend(), [](const ConsoleProcessHandle* const pProcessHandleRecord) {
+        return pProcessHandleRecord->fRootProcess;
+    });
+    return it != _processes.cend() ? *it : nullptr;
 }
 
 // Routine Description:
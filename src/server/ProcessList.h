@@ -59,7 +59,10 @@ public:
     bool IsEmpty() const;
 
 private:
+    // The processes from newest to oldest, indexed by their process ID, as
+    // build tools are known to attach hundreds of processes to a console.
     std::list<ConsoleProcessHandle*> _processes;
+    std::unordered_map<DWORD, std::list<ConsoleProcessHandle*>::iterator> _processesById;
 
     void _ModifyProcessForegroundRights(const HANDLE hProcess, const bool fForeground) const;
 };
@@ -29,6 +29,7 @@ namespace Microsoft::Console::VirtualTerminal
 #pragma warning(pop)
 
         virtual bool WriteInput(std::deque<std::unique_ptr<IInputEvent>>& inputEvents) = 0;
+        virtual bool WriteInputRecords(const gsl::span<const INPUT_RECORD> records) = 0;
 
         virtual bool WriteCtrlKey(const KeyEvent& event) = 0;
 
@@ -36,6 +36,21 @@ bool InteractDispatch::WriteInput(std::deque<std::unique_ptr<IInputEvent>>& inpu
     return true;
 }
 
+// Method Description:
+// - Writes a batch of input records to the host, appending them to the end of
+//      the input buffer as they are. Like WriteInput, this never triggers a
+//      Ctrl-C interrupt in the client.
+// Arguments:
+// - records: the records to write
+// Return Value:
+// - True.
+bool InteractDispatch::WriteInputRecords(const gsl::span<const INPUT_RECORD> records)
+{
+    size_t written = 0;
+    _pConApi->WriteInputRecords(records, written);
+    return true;
+}
+
 // Method Description:
 // - Writes a key event to the host in a fashion that will enable the host to
 //   process special keys such as Ctrl-C or Ctrl+Break. The host will then
@@ -65,20 +65,7 @@ void AdaptDispatch::Print(const wchar_t wchPrintable)
 // - <none>
 void AdaptDispatch::PrintString(const std::wstring_view string)
 {
-    if (_termOutput.NeedToTranslate())
-    {
-        std::wstring buffer;
-        buffer.reserve(string.size());
-        for (auto& wch : string)
-        {
-            buffer.push_back(_termOutput.TranslateKey(wch));
-        }
-        _pConApi->PrintString(buffer);
-    }
-    else
-    {
-        _pConApi->PrintString(string);
-    }
+    _pConApi->PrintString(_termOutput.TranslateString(string, _translationBuffer));
 }
 
 // Routine Description:
@@ -554,6 +541,164 @@ bool AdaptDispatch::EraseCharacters(const size_t numChars)
     return true;
 }
 
+// Routine Description:
+// - Converts the rectangle of one of the rectangular area operations into buffer
+//     coordinates. The parameters are 1-based and relative to the page, or to the
+//     scrolling margins in origin mode, and are clamped to whichever applies.
+//     A bottom or right of 0 selects the bottom or right edge of that area.
+// Arguments:
+// - top, left, bottom, right - The boundaries of the rectangle (inclusive).
+// - csbiex - The current state of the screen buffer.
+// Return Value:
+// - The (inclusive) rectangle in buffer coordinates, or nullopt if it's empty.
+std::optional<SMALL_RECT> AdaptDispatch::_CalculateRectArea(const size_t top,
+                                                            const size_t left,
+                                                            const size_t bottom,
+                                                            const size_t right,
+                                                            const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex) const noexcept
+{
+    // srWindow is exclusive, hence the page height doesn't need a + 1.
+    const size_t pageHeight = std::max(csbiex.srWindow.Bottom - csbiex.srWindow.Top, 1);
+    const size_t pageWidth = std::max<SHORT>(csbiex.dwSize.X, 1);
+
+    size_t minRow = 0;
+    size_t maxRow = pageHeight - 1;
+    if (_isOriginModeRelative && _scrollMargins.Top < _scrollMargins.Bottom)
+    {
+        minRow = _scrollMargins.Top;
+        maxRow = _scrollMargins.Bottom;
+    }
+
+    const auto firstRow = std::clamp(minRow + top - 1, minRow, maxRow);
+    const auto lastRow = bottom ? std::clamp(minRow + bottom - 1, minRow, maxRow) : maxRow;
+    const auto firstColumn = std::min(left - 1, pageWidth - 1);
+    const auto lastColumn = right ? std::min(right - 1, pageWidth - 1) : pageWidth - 1;
+    if (firstRow > lastRow || firstColumn > lastColumn)
+    {
+        return std::nullopt;
+    }
+
+    SMALL_RECT rect;
+    rect.Top = gsl::narrow_cast<SHORT>(csbiex.srWindow.Top + firstRow);
+    rect.Bottom = gsl::narrow_cast<SHORT>(csbiex.srWindow.Top + lastRow);
+    rect.Left = gsl::narrow_cast<SHORT>(firstColumn);
+    rect.Right = gsl::narrow_cast<SHORT>(lastColumn);
+    return rect;
+}
+
+// Routine Description:
+// - DECCRA - Copies a rectangular area of the page to another position on the page.
+//     The copy is clipped to the edge of the page (or the margins in origin mode).
+//     We only support a single page, so the page numbers are ignored.
+// Arguments:
+// - top, left, bottom, right - The boundaries of the area to copy (inclusive).
+// - page - The page to copy from. Ignored.
+// - dstTop, dstLeft - The position to copy the area to.
+// - dstPage - The page to copy to. Ignored.
+// Return Value:
+// - True.
+bool AdaptDispatch::CopyRectangularArea(const size_t top,
+                                        const size_t left,
+                                        const size_t bottom,
+                                        const size_t right,
+                                        const size_t /*page*/,
+                                        const size_t dstTop,
+                                        const size_t dstLeft,
+                                        const size_t /*dstPage*/)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+
+    const auto source = _CalculateRectArea(top, left, bottom, right, csbiex);
+    // The destination extends as far as the page allows, the source is cut down to fit into it.
+    const auto target = _CalculateRectArea(dstTop, dstLeft, 0, 0, csbiex);
+    if (source && target)
+    {
+        auto clipped = *source;
+        clipped.Bottom = std::min(clipped.Bottom, gsl::narrow_cast<SHORT>(clipped.Top + target->Bottom - target->Top));
+        clipped.Right = std::min(clipped.Right, gsl::narrow_cast<SHORT>(clipped.Left + target->Right - target->Left));
+        _pConApi->CopyRectangle(clipped, { target->Left, target->Top });
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - DECFRA - Fills a rectangular area of the page with a character. The filled
+//     cells receive the currently selected attributes.
+// Arguments:
+// - ch - The decimal code of the character to fill the area with. Only printable
+//     characters of the GL and GR ranges are permitted, anything else is ignored.
+// - top, left, bottom, right - The boundaries of the area to fill (inclusive).
+// Return Value:
+// - True.
+bool AdaptDispatch::FillRectangularArea(const VTParameter ch, const size_t top, const size_t left, const size_t bottom, const size_t right)
+{
+    const auto charValue = ch.value_or(0);
+    if ((charValue < 32 || charValue > 126) && (charValue < 160 || charValue > 255))
+    {
+        return true;
+    }
+
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+
+    if (const auto rect = _CalculateRectArea(top, left, bottom, right, csbiex))
+    {
+        const auto fillChar = _termOutput.TranslateKey(gsl::narrow_cast<wchar_t>(charValue));
+        _pConApi->FillRectangle(*rect, fillChar, _pConApi->GetTextAttributes());
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - DECERA - Erases a rectangular area of the page, by replacing it with spaces.
+//     Like the other erase operations, this fills with the standard erase attributes.
+// Arguments:
+// - top, left, bottom, right - The boundaries of the area to erase (inclusive).
+// Return Value:
+// - True.
+bool AdaptDispatch::EraseRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+
+    if (const auto rect = _CalculateRectArea(top, left, bottom, right, csbiex))
+    {
+        auto eraseAttributes = _pConApi->GetTextAttributes();
+        eraseAttributes.SetStandardErase();
+        _pConApi->FillRectangle(*rect, L' ', eraseAttributes);
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - DECSERA - Erases the characters of a rectangular area of the page that aren't
+//     protected, without changing their attributes. As we don't support DECSCA,
+//     no character is protected and the whole area is erased.
+// Arguments:
+// - top, left, bottom, right - The boundaries of the area to erase (inclusive).
+// Return Value:
+// - True.
+bool AdaptDispatch::SelectiveEraseRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+
+    if (const auto rect = _CalculateRectArea(top, left, bottom, right, csbiex))
+    {
+        _pConApi->FillRectangle(*rect, L' ', std::nullopt);
+    }
+
+    return true;
+}
+
 // Routine Description:
 // - ED - Erases a portion of the current viewable area (viewport) of the console.
 // Arguments:
@@ -1057,6 +1202,9 @@ bool AdaptDispatch::_ModeParamsHelper(const DispatchTypes::ModeParams param, con
     case DispatchTypes::ModeParams::W32IM_Win32InputMode:
         success = EnableWin32InputMode(enable);
         break;
+    case DispatchTypes::ModeParams::SO_SynchronizedOutput:
+        success = EnableSynchronizedOutput(enable);
+        break;
     default:
         // If no functions to call, overall dispatch was a failure.
         success = false;
@@ -1822,6 +1970,9 @@ bool AdaptDispatch::HardReset()
     EnableSGRExtendedMouseMode(false);
     EnableAnyEventMouseMode(false);
 
+    // An update that's still in progress won't ever be completed.
+    EnableSynchronizedOutput(false);
+
     // Delete all current tab stops and reapply
     _ResetTabStops();
 
@@ -1912,13 +2063,10 @@ void AdaptDispatch::_EraseScrollback()
     // Typically a scroll operation should fill with standard erase attributes, but in
     // this case we need to use the default attributes, hence standardFillAttrs is false.
     _pConApi->ScrollRegion(scroll, std::nullopt, destination, false);
-    // Clear everything after the viewport.
-    const DWORD totalAreaBelow = csbiex.dwSize.X * (csbiex.dwSize.Y - height);
-    const COORD coordBelowStartPosition = { 0, height };
-    // Again we need to use the default attributes, hence standardFillAttrs is false.
-    _pConApi->FillRegion(coordBelowStartPosition, totalAreaBelow, L' ', false);
-    // Also reset the line rendition for all of the cleared rows.
-    _pConApi->ResetLineRenditionRange(height, csbiex.dwSize.Y);
+    // Clear everything after the viewport, which includes the line rendition of those rows.
+    // With a long scrollback, filling this area cell by cell would take a noticeable amount
+    // of time, which is why the rows are cleared in bulk. Again, this uses the default attributes.
+    _pConApi->ClearRowsBelow(height);
     // Move the viewport (CAN'T be done in one call with SetConsolescreenBufferInfoEx, because legacy)
     SMALL_RECT newViewport;
     newViewport.Left = screen.Left;
@@ -2041,6 +2189,23 @@ bool AdaptDispatch::EnableXtermBracketedPasteMode(const bool /*enabled*/) noexce
     return NoOp();
 }
 
+//Routine Description:
+// Synchronized output - While enabled, the application is in the middle of an
+//      update of the screen. The renderer holds back the frame until the update
+//      is complete (or it takes too long), so that it's presented at once.
+//      In conpty, the frame that contains the update is bracketed in the same
+//      sequences for the connected terminal, rather than passing them through
+//      on their own, which would get them out of order with the frame.
+//Arguments:
+// - enabled - true at the start of an update, false at its end.
+// Return value:
+// True.
+bool AdaptDispatch::EnableSynchronizedOutput(const bool enabled)
+{
+    _pConApi->SetSynchronizedOutput(enabled);
+    return true;
+}
+
 //Routine Description:
 // Set Cursor Style - Changes the cursor's style to match the given Dispatch
 //      cursor style. Unix styles are a combination of the shape and the blinking state.
@@ -47,6 +47,10 @@ namespace Microsoft::Console::VirtualTerminal
         bool EraseInDisplay(const DispatchTypes::EraseType eraseType) override; // ED
         bool EraseInLine(const DispatchTypes::EraseType eraseType) override; // EL
         bool EraseCharacters(const size_t numChars) override; // ECH
+        bool CopyRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right, const size_t page, const size_t dstTop, const size_t dstLeft, const size_t dstPage) override; // DECCRA
+        bool FillRectangularArea(const VTParameter ch, const size_t top, const size_t left, const size_t bottom, const size_t right) override; // DECFRA
+        bool EraseRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right) override; // DECERA
+        bool SelectiveEraseRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right) override; // DECSERA
         bool InsertCharacter(const size_t count) override; // ICH
         bool DeleteCharacter(const size_t count) override; // DCH
         bool SetGraphicsRendition(const VTParameters options) override; // SGR
@@ -105,6 +109,7 @@ namespace Microsoft::Console::VirtualTerminal
         bool EnableAnyEventMouseMode(const bool enabled) override; // ?1003
         bool EnableAlternateScroll(const bool enabled) override; // ?1007
         bool EnableXtermBracketedPasteMode(const bool enabled) noexcept override; // ?2004
+        bool EnableSynchronizedOutput(const bool enabled) override; // ?2026
         bool SetCursorStyle(const DispatchTypes::CursorStyle cursorStyle) override; // DECSCUSR
         bool SetCursorColor(const COLORREF cursorColor) override;
 
@@ -169,6 +174,11 @@ namespace Microsoft::Console::VirtualTerminal
         void _EraseScrollback();
         void _EraseAll();
         void _InsertDeleteHelper(const size_t count, const bool isInsert) const;
+        std::optional<SMALL_RECT> _CalculateRectArea(const size_t top,
+                                                     const size_t left,
+                                                     const size_t bottom,
+                                                     const size_t right,
+                                                     const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex) const noexcept;
         void _ScrollMovement(const ScrollDirection dir, const size_t distance) const;
 
         void _DoSetTopBottomScrollingMargins(const size_t topMargin,
@@ -193,6 +203,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         std::unique_ptr<ConGetSet> _pConApi;
         TerminalOutput _termOutput;
+        std::wstring _translationBuffer;
         std::unique_ptr<FontBuffer> _fontBuffer;
         std::optional<unsigned int> _initialCodePage;
 
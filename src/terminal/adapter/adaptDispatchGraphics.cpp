@@ -81,6 +81,31 @@ bool AdaptDispatch::SetGraphicsRendition(const VTParameters options)
     for (size_t i = 0; i < options.size(); i++)
     {
         const GraphicsOptions opt = options.at(i);
+
+        // The 8 and 16 color options make up most of the SGR sequences that applications
+        // write, so they're mapped directly onto the color table index. The ANSI order of
+        // the colors (black, red, green, yellow, blue, ...) matches the order of the table.
+        if (opt >= ForegroundBlack && opt <= ForegroundWhite)
+        {
+            attr.SetIndexedForeground(gsl::narrow_cast<BYTE>(opt - ForegroundBlack + TextColor::DARK_BLACK));
+            continue;
+        }
+        if (opt >= BackgroundBlack && opt <= BackgroundWhite)
+        {
+            attr.SetIndexedBackground(gsl::narrow_cast<BYTE>(opt - BackgroundBlack + TextColor::DARK_BLACK));
+            continue;
+        }
+        if (opt >= BrightForegroundBlack && opt <= BrightForegroundWhite)
+        {
+            attr.SetIndexedForeground(gsl::narrow_cast<BYTE>(opt - BrightForegroundBlack + TextColor::BRIGHT_BLACK));
+            continue;
+        }
+        if (opt >= BrightBackgroundBlack && opt <= BrightBackgroundWhite)
+        {
+            attr.SetIndexedBackground(gsl::narrow_cast<BYTE>(opt - BrightBackgroundBlack + TextColor::BRIGHT_BLACK));
+            continue;
+        }
+
         switch (opt)
         {
         case Off:
@@ -151,102 +176,6 @@ bool AdaptDispatch::SetGraphicsRendition(const VTParameters options)
         case NoOverline:
             attr.SetOverlined(false);
             break;
-        case ForegroundBlack:
-            attr.SetIndexedForeground(TextColor::DARK_BLACK);
-            break;
-        case ForegroundBlue:
-            attr.SetIndexedForeground(TextColor::DARK_BLUE);
-            break;
-        case ForegroundGreen:
-            attr.SetIndexedForeground(TextColor::DARK_GREEN);
-            break;
-        case ForegroundCyan:
-            attr.SetIndexedForeground(TextColor::DARK_CYAN);
-            break;
-        case ForegroundRed:
-            attr.SetIndexedForeground(TextColor::DARK_RED);
-            break;
-        case ForegroundMagenta:
-            attr.SetIndexedForeground(TextColor::DARK_MAGENTA);
-            break;
-        case ForegroundYellow:
-            attr.SetIndexedForeground(TextColor::DARK_YELLOW);
-            break;
-        case ForegroundWhite:
-            attr.SetIndexedForeground(TextColor::DARK_WHITE);
-            break;
-        case BackgroundBlack:
-            attr.SetIndexedBackground(TextColor::DARK_BLACK);
-            break;
-        case BackgroundBlue:
-            attr.SetIndexedBackground(TextColor::DARK_BLUE);
-            break;
-        case BackgroundGreen:
-            attr.SetIndexedBackground(TextColor::DARK_GREEN);
-            break;
-        case BackgroundCyan:
-            attr.SetIndexedBackground(TextColor::DARK_CYAN);
-            break;
-        case BackgroundRed:
-            attr.SetIndexedBackground(TextColor::DARK_RED);
-            break;
-        case BackgroundMagenta:
-            attr.SetIndexedBackground(TextColor::DARK_MAGENTA);
-            break;
-        case BackgroundYellow:
-            attr.SetIndexedBackground(TextColor::DARK_YELLOW);
-            break;
-        case BackgroundWhite:
-            attr.SetIndexedBackground(TextColor::DARK_WHITE);
-            break;
-        case BrightForegroundBlack:
-            attr.SetIndexedForeground(TextColor::BRIGHT_BLACK);
-            break;
-        case BrightForegroundBlue:
-            attr.SetIndexedForeground(TextColor::BRIGHT_BLUE);
-            break;
-        case BrightForegroundGreen:
-            attr.SetIndexedForeground(TextColor::BRIGHT_GREEN);
-            break;
-        case BrightForegroundCyan:
-            attr.SetIndexedForeground(TextColor::BRIGHT_CYAN);
-            break;
-        case BrightForegroundRed:
-            attr.SetIndexedForeground(TextColor::BRIGHT_RED);
-            break;
-        case BrightForegroundMagenta:
-            attr.SetIndexedForeground(TextColor::BRIGHT_MAGENTA);
-            break;
-        case BrightForegroundYellow:
-            attr.SetIndexedForeground(TextColor::BRIGHT_YELLOW);
-            break;
-        case BrightForegroundWhite:
-            attr.SetIndexedForeground(TextColor::BRIGHT_WHITE);
-            break;
-        case BrightBackgroundBlack:
-            attr.SetIndexedBackground(TextColor::BRIGHT_BLACK);
-            break;
-        case BrightBackgroundBlue:
-            attr.SetIndexedBackground(TextColor::BRIGHT_BLUE);
-            break;
-        case BrightBackgroundGreen:
-            attr.SetIndexedBackground(TextColor::BRIGHT_GREEN);
-            break;
-        case BrightBackgroundCyan:
-            attr.SetIndexedBackground(TextColor::BRIGHT_CYAN);
-            break;
-        case BrightBackgroundRed:
-            attr.SetIndexedBackground(TextColor::BRIGHT_RED);
-            break;
-        case BrightBackgroundMagenta:
-            attr.SetIndexedBackground(TextColor::BRIGHT_MAGENTA);
-            break;
-        case BrightBackgroundYellow:
-            attr.SetIndexedBackground(TextColor::BRIGHT_YELLOW);
-            break;
-        case BrightBackgroundWhite:
-            attr.SetIndexedBackground(TextColor::BRIGHT_WHITE);
-            break;
         case ForegroundExtended:
             i += _SetRgbColorsHelper(options.subspan(i + 1), attr, true);
             break;
@@ -51,12 +51,14 @@ namespace Microsoft::Console::VirtualTerminal
         virtual SHORT GetLineWidth(const size_t row) const = 0;
 
         virtual void WriteInput(std::deque<std::unique_ptr<IInputEvent>>& events, size_t& eventsWritten) = 0;
+        virtual void WriteInputRecords(const gsl::span<const INPUT_RECORD> records, size_t& eventsWritten) = 0;
         virtual void SetWindowInfo(const bool absolute, const SMALL_RECT& window) = 0;
 
         virtual bool SetInputMode(const TerminalInput::Mode mode, const bool enabled) = 0;
         virtual void SetParserMode(const StateMachine::Mode mode, const bool enabled) = 0;
         virtual bool GetParserMode(const StateMachine::Mode mode) const = 0;
         virtual void SetRenderMode(const RenderSettings::Mode mode, const bool enabled) = 0;
+        virtual void SetSynchronizedOutput(const bool enabled) = 0;
 
         virtual void SetAutoWrapMode(const bool wrapAtEOL) = 0;
 
@@ -105,6 +107,12 @@ namespace Microsoft::Console::VirtualTerminal
                                   const COORD destinationOrigin,
                                   const bool standardFillAttrs) = 0;
 
+        virtual void CopyRectangle(const SMALL_RECT source, const COORD targetOrigin) = 0;
+        virtual void FillRectangle(const SMALL_RECT fillRect,
+                                   const wchar_t fillChar,
+                                   const std::optional<TextAttribute> fillAttrs) = 0;
+        virtual void ClearRowsBelow(const size_t startRow) = 0;
+
         virtual void AddHyperlink(const std::wstring_view uri, const std::wstring_view params) const = 0;
         virtual void EndHyperlink() const = 0;
 
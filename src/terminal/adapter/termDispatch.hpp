@@ -74,6 +74,7 @@ public:
     bool EnableAnyEventMouseMode(const bool /*enabled*/) override { return false; } // ?1003
     bool EnableAlternateScroll(const bool /*enabled*/) override { return false; } // ?1007
     bool EnableXtermBracketedPasteMode(const bool /*enabled*/) override { return false; } // ?2004
+    bool EnableSynchronizedOutput(const bool /*enabled*/) override { return false; } // ?2026
     bool SetColorTableEntry(const size_t /*tableIndex*/, const DWORD /*color*/) override { return false; } // OSCColorTable
     bool SetDefaultForeground(const DWORD /*color*/) override { return false; } // OSCDefaultForeground
     bool SetDefaultBackground(const DWORD /*color*/) override { return false; } // OSCDefaultBackground
@@ -82,6 +83,11 @@ public:
     bool EraseInLine(const DispatchTypes::EraseType /* eraseType*/) override { return false; } // EL
     bool EraseCharacters(const size_t /*numChars*/) override { return false; } // ECH
 
+    bool CopyRectangularArea(const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/, const size_t /*page*/, const size_t /*dstTop*/, const size_t /*dstLeft*/, const size_t /*dstPage*/) override { return false; } // DECCRA
+    bool FillRectangularArea(const VTParameter /*ch*/, const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/) override { return false; } // DECFRA
+    bool EraseRectangularArea(const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/) override { return false; } // DECERA
+    bool SelectiveEraseRectangularArea(const size_t /*top*/, const size_t /*left*/, const size_t /*bottom*/, const size_t /*right*/) override { return false; } // DECSERA
+
     bool SetGraphicsRendition(const VTParameters /*options*/) override { return false; } // SGR
     bool SetLineRendition(const LineRendition /*rendition*/) override { return false; } // DECSWL, DECDWL, DECDHL
 
@@ -126,6 +132,8 @@ public:
 
     bool DoConEmuAction(const std::wstring_view /*string*/) override { return false; }
 
+    bool DoFinalTermAction(const std::wstring_view /*string*/) override { return false; }
+
     StringHandler DownloadDRCS(const size_t /*fontNumber*/,
                                const VTParameter /*startChar*/,
                                const DispatchTypes::DrcsEraseControl /*eraseControl*/,
@@ -20,6 +20,7 @@ TerminalOutput::TerminalOutput() noexcept
     _gsetTranslationTables.at(1) = Ascii;
     _gsetTranslationTables.at(2) = Ascii;
     _gsetTranslationTables.at(3) = Ascii;
+    _UpdateTranslationTable();
 }
 
 bool TerminalOutput::Designate94Charset(size_t gsetNumber, const VTID charset)
@@ -60,6 +61,7 @@ bool TerminalOutput::LockingShift(const size_t gsetNumber)
     {
         _glTranslationTable = {};
     }
+    _UpdateTranslationTable();
     return true;
 }
 
@@ -73,6 +75,7 @@ bool TerminalOutput::LockingShiftRight(const size_t gsetNumber)
     {
         _grTranslationTable = {};
     }
+    _UpdateTranslationTable();
     return true;
 }
 
@@ -122,20 +125,48 @@ wchar_t TerminalOutput::TranslateKey(const wchar_t wch) const noexcept
         }
         _ssTranslationTable = {};
     }
-    else
+    else if (wch < _translationTable.size())
     {
-        if (wch - 0x20u < _glTranslationTable.size())
-        {
-            wchFound = _glTranslationTable.at(wch - 0x20u);
-        }
-        else if (wch - 0xA0u < _grTranslationTable.size())
-        {
-            wchFound = _grTranslationTable.at(wch - 0xA0u);
-        }
+        wchFound = til::at(_translationTable, wch);
     }
     return wchFound;
 }
 
+// Routine Description:
+// - Translates a string of printable characters according to the active character sets.
+//   This is equivalent to calling TranslateKey for every character, but only
+//   costs a table lookup for each of them.
+// Arguments:
+// - string - the characters to translate
+// - buffer - storage for the translated characters. Its capacity is reused across calls.
+// Return Value:
+// - The translated string: either string itself, if there is nothing to translate, or a view of buffer.
+std::wstring_view TerminalOutput::TranslateString(const std::wstring_view string, std::wstring& buffer) const
+{
+    if (!NeedToTranslate() || string.empty())
+    {
+        return string;
+    }
+
+    buffer.resize(string.size());
+
+    size_t i = 0;
+    // A single shift only applies to the first character.
+    if (!_ssTranslationTable.empty())
+    {
+        til::at(buffer, 0) = TranslateKey(til::at(string, 0));
+        i = 1;
+    }
+
+    for (; i < string.size(); ++i)
+    {
+        const auto wch = til::at(string, i);
+        til::at(buffer, i) = wch < _translationTable.size() ? til::at(_translationTable, wch) : wch;
+    }
+
+    return buffer;
+}
+
 const std::wstring_view TerminalOutput::_LookupTranslationTable94(const VTID charset) const
 {
     // Note that the DRCS set can be designated with either a 94 or 96 sequence,
@@ -246,6 +277,15 @@ bool TerminalOutput::_SetTranslationTable(const size_t gsetNumber, const std::ws
     return LockingShift(_glSetNumber) && LockingShiftRight(_grSetNumber);
 }
 
+// Routine Description:
+// - Rebuilds the combined translation table after the GL or GR table changed.
+void TerminalOutput::_UpdateTranslationTable() noexcept
+{
+    std::iota(_translationTable.begin(), _translationTable.end(), L'\0');
+    std::copy_n(_glTranslationTable.begin(), _glTranslationTable.size(), _translationTable.begin() + 0x20);
+    std::copy_n(_grTranslationTable.begin(), _grTranslationTable.size(), _translationTable.begin() + 0xA0);
+}
+
 void TerminalOutput::_ReplaceDrcsTable(const std::wstring_view oldTable, const std::wstring_view newTable)
 {
     if (newTable.data() != oldTable.data())
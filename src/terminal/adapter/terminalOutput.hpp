@@ -26,6 +26,7 @@ namespace Microsoft::Console::VirtualTerminal
         TerminalOutput() noexcept;
 
         wchar_t TranslateKey(const wchar_t wch) const noexcept;
+        std::wstring_view TranslateString(const std::wstring_view string, std::wstring& buffer) const;
         bool Designate94Charset(const size_t gsetNumber, const VTID charset);
         bool Designate96Charset(const size_t gsetNumber, const VTID charset);
         void SetDrcs94Designation(const VTID charset);
@@ -41,6 +42,7 @@ namespace Microsoft::Console::VirtualTerminal
         const std::wstring_view _LookupTranslationTable96(const VTID charset) const;
         bool _SetTranslationTable(const size_t gsetNumber, const std::wstring_view translationTable);
         void _ReplaceDrcsTable(const std::wstring_view oldTable, const std::wstring_view newTable);
+        void _UpdateTranslationTable() noexcept;
 
         std::array<std::wstring_view, 4> _gsetTranslationTables;
         size_t _glSetNumber = 0;
@@ -51,5 +53,8 @@ namespace Microsoft::Console::VirtualTerminal
         boolean _grTranslationEnabled = false;
         VTID _drcsId = 0;
         std::wstring_view _drcsTranslationTable;
+        // The GL and GR tables combined into a single table covering U+0000 to U+00FF,
+        // so that strings can be translated with one lookup per character.
+        std::array<wchar_t, 256> _translationTable;
     };
 }
@@ -612,6 +612,44 @@ public:
         }
     }
 
+    TEST_METHOD(CoalescesMotionReports)
+    {
+        Log::Comment(L"Starting test...");
+        std::unique_ptr<TerminalInput> mouseInput = std::make_unique<TerminalInput>(s_MouseInputTestCallback);
+        const short noModifierKeys = 0;
+
+        mouseInput->SetInputMode(TerminalInput::Mode::SgrMouseEncoding, true);
+        mouseInput->SetInputMode(TerminalInput::Mode::AnyEventMouseTracking, true);
+        mouseInput->SetMotionCoalescing(true);
+
+        Log::Comment(L"Motion reports are held back, and only the latest one is kept");
+        s_pwszInputExpected = L"";
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 1, 1 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 2, 2 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 3, 3 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 3, 3 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        VERIFY_IS_TRUE(mouseInput->HasPendingMotion());
+
+        Log::Comment(L"A button press is written right away, after the pending motion report");
+        s_pwszInputExpected = L"\x1b[<35;4;4m\x1b[<0;4;4M";
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 3, 3 }, WM_LBUTTONDOWN, noModifierKeys, 0, {}));
+        VERIFY_IS_FALSE(mouseInput->HasPendingMotion());
+
+        Log::Comment(L"Flushing writes the pending motion report once");
+        s_pwszInputExpected = L"";
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 4, 4 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        s_pwszInputExpected = L"\x1b[<35;5;5m";
+        mouseInput->FlushPendingMotion();
+        VERIFY_IS_FALSE(mouseInput->HasPendingMotion());
+        s_pwszInputExpected = L"";
+        mouseInput->FlushPendingMotion();
+
+        Log::Comment(L"Disabling mouse tracking drops the pending motion report");
+        VERIFY_IS_TRUE(mouseInput->HandleMouse({ 5, 5 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        mouseInput->SetInputMode(TerminalInput::Mode::AnyEventMouseTracking, false);
+        VERIFY_IS_FALSE(mouseInput->HasPendingMotion());
+    }
+
     TEST_METHOD(AlternateScrollModeTests)
     {
         Log::Comment(L"Starting test...");
@@ -58,8 +58,9 @@ using namespace Microsoft::Console::VirtualTerminal;
 class TestGetSet final : public ConGetSet
 {
 public:
-    void PrintString(const std::wstring_view /*string*/) override
+    void PrintString(const std::wstring_view string) override
     {
+        _printed.append(string);
     }
 
     void GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_INFOEX& sbiex) const override
@@ -137,6 +138,13 @@ public:
         Log::Comment(L"SetRenderMode MOCK called...");
     }
 
+    void SetSynchronizedOutput(const bool enabled) override
+    {
+        Log::Comment(L"SetSynchronizedOutput MOCK called...");
+
+        _synchronizedOutput = enabled;
+    }
+
     void SetAutoWrapMode(const bool /*wrapAtEOL*/) override
     {
         Log::Comment(L"SetAutoWrapMode MOCK called...");
@@ -222,6 +230,16 @@ public:
         eventsWritten = _events.size();
     }
 
+    void WriteInputRecords(const gsl::span<const INPUT_RECORD> records, size_t& eventsWritten) override
+    {
+        Log::Comment(L"WriteInputRecords MOCK called...");
+
+        THROW_HR_IF(E_FAIL, !_writeInputResult);
+
+        auto events = IInputEvent::Create(records);
+        WriteInput(events, eventsWritten);
+    }
+
     void WriteControlInput(_In_ KeyEvent key) override
     {
         Log::Comment(L"WriteControlInput MOCK called...");
@@ -411,6 +429,30 @@ public:
         Log::Comment(L"ScrollRegion MOCK called...");
     }
 
+    void CopyRectangle(const SMALL_RECT source, const COORD targetOrigin) noexcept override
+    {
+        Log::Comment(L"CopyRectangle MOCK called...");
+
+        _copyRectangleSource = source;
+        _copyRectangleTarget = targetOrigin;
+    }
+
+    void FillRectangle(const SMALL_RECT fillRect,
+                       const wchar_t fillChar,
+                       const std::optional<TextAttribute> fillAttrs) noexcept override
+    {
+        Log::Comment(L"FillRectangle MOCK called...");
+
+        _fillRectangle = fillRect;
+        _fillRectangleChar = fillChar;
+        _fillRectangleAttrs = fillAttrs;
+    }
+
+    void ClearRowsBelow(const size_t /*startRow*/) noexcept override
+    {
+        Log::Comment(L"ClearRowsBelow MOCK called...");
+    }
+
     void UpdateSoftFont(const gsl::span<const uint16_t> /*bitPattern*/,
                         const SIZE cellSize,
                         const size_t /*centeringHint*/) noexcept override
@@ -604,6 +646,8 @@ public:
     unsigned int _expectedOutputCP = 0;
     bool _isPty = false;
 
+    std::wstring _printed;
+
     bool _setCursorVisibilityResult = false;
     bool _expectedCursorVisibility = false;
 
@@ -626,6 +670,7 @@ public:
     bool _setParserModeResult = false;
     StateMachine::Mode _expectedParserMode;
     bool _expectedParserModeEnabled = false;
+    bool _synchronizedOutput = false;
     bool _enableCursorBlinkingResult = false;
     bool _enable = false; // for cursor blinking
     bool _setScrollingRegionResult = false;
@@ -649,6 +694,12 @@ public:
 
     SIZE _expectedCellSize = {};
 
+    std::optional<SMALL_RECT> _copyRectangleSource;
+    COORD _copyRectangleTarget = { 0, 0 };
+    std::optional<SMALL_RECT> _fillRectangle;
+    wchar_t _fillRectangleChar = 0;
+    std::optional<TextAttribute> _fillRectangleAttrs;
+
 private:
     HANDLE _hCon;
 };
@@ -2515,6 +2566,68 @@ public:
         VERIFY_IS_TRUE(decdld(CellMatrix::Default, 0, FontSet::Size132x24, FontUsage::FullCell, bitmapOf6x18));
     }
 
+    TEST_METHOD(SynchronizedOutputModeTest)
+    {
+        Log::Comment(L"Test 1: start a synchronized update");
+        VERIFY_IS_TRUE(_pDispatch.get()->SetMode(DispatchTypes::SO_SynchronizedOutput));
+        VERIFY_IS_TRUE(_testGetSet->_synchronizedOutput);
+
+        Log::Comment(L"Test 2: end the update");
+        VERIFY_IS_TRUE(_pDispatch.get()->ResetMode(DispatchTypes::SO_SynchronizedOutput));
+        VERIFY_IS_FALSE(_testGetSet->_synchronizedOutput);
+    }
+
+    TEST_METHOD(RectangularAreaTests)
+    {
+        _testGetSet->PrepData();
+
+        // The expected rectangles are given relative to the top of the page.
+        const auto viewportTop = _testGetSet->_viewport.Top;
+        const auto pageRect = [=](const SHORT left, const SHORT top, const SHORT right, const SHORT bottom) {
+            return SMALL_RECT{ left, gsl::narrow_cast<SHORT>(viewportTop + top), right, gsl::narrow_cast<SHORT>(viewportTop + bottom) };
+        };
+
+        Log::Comment(L"Test 1: DECCRA copies the area to the target position");
+        VERIFY_IS_TRUE(_pDispatch.get()->CopyRectangularArea(2, 3, 4, 5, 1, 6, 7, 1));
+        VERIFY_ARE_EQUAL(pageRect(2, 1, 4, 3), _testGetSet->_copyRectangleSource.value());
+        VERIFY_ARE_EQUAL((COORD{ 6, gsl::narrow_cast<SHORT>(viewportTop + 5) }), _testGetSet->_copyRectangleTarget);
+
+        Log::Comment(L"Test 2: DECCRA clips the area to what fits at the target position");
+        VERIFY_IS_TRUE(_pDispatch.get()->CopyRectangularArea(1, 1, 10, 10, 1, 25, 95, 1));
+        VERIFY_ARE_EQUAL(pageRect(0, 0, 5, 4), _testGetSet->_copyRectangleSource.value());
+        VERIFY_ARE_EQUAL((COORD{ 94, gsl::narrow_cast<SHORT>(viewportTop + 24) }), _testGetSet->_copyRectangleTarget);
+
+        Log::Comment(L"Test 3: DECCRA ignores an empty area");
+        _testGetSet->_copyRectangleSource.reset();
+        VERIFY_IS_TRUE(_pDispatch.get()->CopyRectangularArea(5, 1, 4, 10, 1, 1, 1, 1));
+        VERIFY_IS_FALSE(_testGetSet->_copyRectangleSource.has_value());
+
+        Log::Comment(L"Test 4: DECFRA fills the area with the current attributes");
+        VERIFY_IS_TRUE(_pDispatch.get()->FillRectangularArea(42, 2, 3, 4, 5));
+        VERIFY_ARE_EQUAL(pageRect(2, 1, 4, 3), _testGetSet->_fillRectangle.value());
+        VERIFY_ARE_EQUAL(L'*', _testGetSet->_fillRectangleChar);
+        VERIFY_ARE_EQUAL(_testGetSet->_attribute, _testGetSet->_fillRectangleAttrs.value());
+
+        Log::Comment(L"Test 5: DECFRA ignores characters that aren't printable");
+        _testGetSet->_fillRectangle.reset();
+        VERIFY_IS_TRUE(_pDispatch.get()->FillRectangularArea(10, 2, 3, 4, 5));
+        VERIFY_IS_FALSE(_testGetSet->_fillRectangle.has_value());
+
+        Log::Comment(L"Test 6: DECERA defaults to the whole page and uses the standard erase attributes");
+        VERIFY_IS_TRUE(_pDispatch.get()->EraseRectangularArea(1, 1, 0, 0));
+        VERIFY_ARE_EQUAL(pageRect(0, 0, 99, 28), _testGetSet->_fillRectangle.value());
+        VERIFY_ARE_EQUAL(L' ', _testGetSet->_fillRectangleChar);
+        auto eraseAttributes = _testGetSet->_attribute;
+        eraseAttributes.SetStandardErase();
+        VERIFY_ARE_EQUAL(eraseAttributes, _testGetSet->_fillRectangleAttrs.value());
+
+        Log::Comment(L"Test 7: DECSERA clamps the area to the page and keeps the attributes");
+        VERIFY_IS_TRUE(_pDispatch.get()->SelectiveEraseRectangularArea(20, 90, 100, 200));
+        VERIFY_ARE_EQUAL(pageRect(89, 19, 99, 28), _testGetSet->_fillRectangle.value());
+        VERIFY_ARE_EQUAL(L' ', _testGetSet->_fillRectangleChar);
+        VERIFY_IS_FALSE(_testGetSet->_fillRectangleAttrs.has_value());
+    }
+
     TEST_METHOD(TogglingC1ParserMode)
     {
         Log::Comment(L"1. Accept C1 controls");
@@ -2548,6 +2661,31 @@ public:
         VERIFY_IS_TRUE(_pDispatch.get()->DesignateCodingSystem(DispatchTypes::CodingSystem::UTF8));
     }
 
+    TEST_METHOD(PrintStringTranslatesCharsets)
+    {
+        Log::Comment(L"1. Without a designation, the string is printed unchanged");
+        _pDispatch.get()->PrintString(L"lqk#");
+        VERIFY_ARE_EQUAL(L"lqk#", _testGetSet->_printed);
+
+        Log::Comment(L"2. DEC Special Graphics in G0 translates the whole string");
+        _testGetSet->_printed.clear();
+        VERIFY_IS_TRUE(_pDispatch.get()->Designate94Charset(0, VTID("0")));
+        _pDispatch.get()->PrintString(L"lqk#");
+        VERIFY_ARE_EQUAL(L"\u250C\u2500\u2510#", _testGetSet->_printed);
+
+        Log::Comment(L"3. A single shift only applies to the first character");
+        _testGetSet->_printed.clear();
+        VERIFY_IS_TRUE(_pDispatch.get()->Designate94Charset(2, VTID("A")));
+        VERIFY_IS_TRUE(_pDispatch.get()->SingleShift(2));
+        _pDispatch.get()->PrintString(L"#q#");
+        VERIFY_ARE_EQUAL(L"\u00A3\u2500#", _testGetSet->_printed);
+
+        Log::Comment(L"4. Characters outside of GL and GR are left alone");
+        _testGetSet->_printed.clear();
+        _pDispatch.get()->PrintString(L"\u00E9\u4E00q");
+        VERIFY_ARE_EQUAL(L"\u00E9\u4E00\u2500", _testGetSet->_printed);
+    }
+
 private:
     TestGetSet* _testGetSet; // non-ownership pointer
     std::unique_ptr<AdaptDispatch> _pDispatch;
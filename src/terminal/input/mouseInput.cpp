@@ -288,6 +288,39 @@ bool TerminalInput::IsTrackingMouseInput() const noexcept
     return _inputMode.any(Mode::DefaultMouseTracking, Mode::ButtonEventMouseTracking, Mode::AnyEventMouseTracking);
 }
 
+// Routine Description:
+// - Enables or disables the coalescing of mouse motion reports. While it's enabled,
+//   only the latest of a series of motion reports is written, when the owner
+//   calls FlushPendingMotion() or when any other input is written before that.
+//   Button presses, releases and wheel events are always written right away.
+// Arguments:
+// - enabled - true to coalesce motion reports
+// Return Value:
+// - <none>
+void TerminalInput::SetMotionCoalescing(const bool enabled) noexcept
+{
+    _coalesceMotion = enabled;
+}
+
+// Routine Description:
+// - Returns true if a mouse motion report is waiting for FlushPendingMotion().
+bool TerminalInput::HasPendingMotion() const noexcept
+{
+    return !_pendingMotion.empty();
+}
+
+// Routine Description:
+// - Writes the pending mouse motion report, if there is one.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void TerminalInput::FlushPendingMotion()
+{
+    std::deque<std::unique_ptr<IInputEvent>> inputEvents;
+    _WriteEvents(inputEvents);
+}
+
 // Routine Description:
 // - Attempt to handle the given mouse coordinates and windows button as a VT-style mouse event.
 //     If the event should be transmitted in the selected mouse mode, then we'll try and
@@ -403,7 +436,16 @@ bool TerminalInput::HandleMouse(const COORD position,
 
                 if (success)
                 {
-                    _SendInputSequence(sequence);
+                    if (isHover && _coalesceMotion)
+                    {
+                        // Intermediate positions are of no use to the application.
+                        // Only the latest one is written, when the owner flushes it.
+                        _pendingMotion = std::move(sequence);
+                    }
+                    else
+                    {
+                        _SendInputSequence(sequence);
+                    }
                     success = true;
                 }
                 if (_inputMode.any(Mode::ButtonEventMouseTracking, Mode::AnyEventMouseTracking))
@@ -555,7 +597,7 @@ bool TerminalInput::_ShouldSendAlternateScroll(const unsigned int button, const
 // - delta: The scroll wheel delta of the input event
 // Return value:
 // True iff the input sequence was sent successfully.
-bool TerminalInput::_SendAlternateScroll(const short delta) const noexcept
+bool TerminalInput::_SendAlternateScroll(const short delta) noexcept
 {
     if (delta > 0)
     {
@@ -259,6 +259,7 @@ void TerminalInput::SetInputMode(const Mode mode, const bool enabled) noexcept
         _inputMode.reset(Mode::DefaultMouseTracking, Mode::ButtonEventMouseTracking, Mode::AnyEventMouseTracking);
         _mouseInputState.lastPos = { -1, -1 };
         _mouseInputState.lastButton = 0;
+        _pendingMotion.clear();
     }
 
     // But if we're changing the encoding, we only clear out the other encoding modes
@@ -716,14 +717,14 @@ void TerminalInput::_SendChar(const wchar_t ch)
 // - wch - character to send to input paired with Esc
 // Return Value:
 // - None
-void TerminalInput::_SendEscapedInputSequence(const wchar_t wch) const
+void TerminalInput::_SendEscapedInputSequence(const wchar_t wch)
 {
     try
     {
         std::deque<std::unique_ptr<IInputEvent>> inputEvents;
         inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, L'\x1b', 0));
         inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
-        _pfnWriteEvents(inputEvents);
+        _WriteEvents(inputEvents);
     }
     catch (...)
     {
@@ -731,7 +732,7 @@ void TerminalInput::_SendEscapedInputSequence(const wchar_t wch) const
     }
 }
 
-void TerminalInput::_SendNullInputSequence(const DWORD controlKeyState) const
+void TerminalInput::_SendNullInputSequence(const DWORD controlKeyState)
 {
     try
     {
@@ -742,7 +743,7 @@ void TerminalInput::_SendNullInputSequence(const DWORD controlKeyState) const
                                                          0ui16,
                                                          L'\x0',
                                                          controlKeyState));
-        _pfnWriteEvents(inputEvents);
+        _WriteEvents(inputEvents);
     }
     catch (...)
     {
@@ -750,7 +751,7 @@ void TerminalInput::_SendNullInputSequence(const DWORD controlKeyState) const
     }
 }
 
-void TerminalInput::_SendInputSequence(const std::wstring_view sequence) const noexcept
+void TerminalInput::_SendInputSequence(const std::wstring_view sequence) noexcept
 {
     if (!sequence.empty())
     {
@@ -761,7 +762,7 @@ void TerminalInput::_SendInputSequence(const std::wstring_view sequence) const n
             {
                 inputEvents.push_back(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, wch, 0));
             }
-            _pfnWriteEvents(inputEvents);
+            _WriteEvents(inputEvents);
         }
         catch (...)
         {
@@ -770,6 +771,30 @@ void TerminalInput::_SendInputSequence(const std::wstring_view sequence) const n
     }
 }
 
+// Routine Description:
+// - Writes the given events to the input callback. A pending mouse motion report
+//   is written first, as part of the same write, to keep the input in order.
+// Arguments:
+// - inputEvents - the events to write
+// Return Value:
+// - <none>
+void TerminalInput::_WriteEvents(std::deque<std::unique_ptr<IInputEvent>>& inputEvents)
+{
+    if (!_pendingMotion.empty())
+    {
+        for (auto it = _pendingMotion.crbegin(); it != _pendingMotion.crend(); ++it)
+        {
+            inputEvents.push_front(std::make_unique<KeyEvent>(true, 1ui16, 0ui16, 0ui16, *it, 0));
+        }
+        _pendingMotion.clear();
+    }
+
+    if (!inputEvents.empty())
+    {
+        _pfnWriteEvents(inputEvents);
+    }
+}
+
 // Method Description:
 // - Synthesize a win32-input-mode sequence for the given keyevent.
 // Arguments:
@@ -73,6 +73,10 @@ namespace Microsoft::Console::VirtualTerminal
                          const MouseButtonState state);
 
         bool IsTrackingMouseInput() const noexcept;
+
+        void SetMotionCoalescing(const bool enabled) noexcept;
+        bool HasPendingMotion() const noexcept;
+        void FlushPendingMotion();
 #pragma endregion
 
 #pragma region MouseInputState Management
@@ -90,10 +94,16 @@ namespace Microsoft::Console::VirtualTerminal
         til::enumset<Mode> _inputMode{ Mode::Ansi };
         bool _forceDisableWin32InputMode{ false };
 
+        // With motion coalescing enabled, the latest mouse motion report is held
+        // back until FlushPendingMotion() or until any other input is written.
+        bool _coalesceMotion{ false };
+        std::wstring _pendingMotion;
+
         void _SendChar(const wchar_t ch);
-        void _SendNullInputSequence(const DWORD dwControlKeyState) const;
-        void _SendInputSequence(const std::wstring_view sequence) const noexcept;
-        void _SendEscapedInputSequence(const wchar_t wch) const;
+        void _SendNullInputSequence(const DWORD dwControlKeyState);
+        void _SendInputSequence(const std::wstring_view sequence) noexcept;
+        void _SendEscapedInputSequence(const wchar_t wch);
+        void _WriteEvents(std::deque<std::unique_ptr<IInputEvent>>& inputEvents);
         static std::wstring _GenerateWin32KeySequence(const KeyEvent& key);
 
 #pragma region MouseInputState Management
@@ -128,7 +138,7 @@ namespace Microsoft::Console::VirtualTerminal
                                                  const short delta);
 
         bool _ShouldSendAlternateScroll(const unsigned int button, const short delta) const noexcept;
-        bool _SendAlternateScroll(const short delta) const noexcept;
+        bool _SendAlternateScroll(const short delta) noexcept;
 
         static constexpr unsigned int s_GetPressedButton(const MouseButtonState state) noexcept;
 #pragma endregion
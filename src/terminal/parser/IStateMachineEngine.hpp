@@ -50,6 +50,10 @@ namespace Microsoft::Console::VirtualTerminal
 
         virtual bool ActionSs3Dispatch(const wchar_t wch, const VTParameters parameters) = 0;
 
+        // Called once all of the string given to StateMachine::ProcessString
+        // was processed, so that engines can hand on whatever they batched up.
+        virtual bool ActionEndOfString() = 0;
+
     protected:
         IStateMachineEngine() = default;
     };
@@ -114,6 +114,7 @@ InputStateMachineEngine::InputStateMachineEngine(std::unique_ptr<IInteractDispat
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionExecute(const wchar_t wch)
 {
+    _FlushPendingInput();
     return _DoControlCharacter(wch, false);
 }
 
@@ -218,6 +219,7 @@ bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 {
+    _FlushPendingInput();
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -235,6 +237,7 @@ bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPrint(const wchar_t wch)
 {
+    _FlushPendingInput();
     short vkey = 0;
     DWORD modifierState = 0;
     bool success = _GenerateKeyFromChar(wch, vkey, modifierState);
@@ -254,6 +257,7 @@ bool InputStateMachineEngine::ActionPrint(const wchar_t wch)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
 {
+    _FlushPendingInput();
     if (string.empty())
     {
         return true;
@@ -270,6 +274,7 @@ bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPassThroughString(const std::wstring_view string)
 {
+    _FlushPendingInput();
     if (_pDispatch->IsVtInputEnabled())
     {
         // Synthesize string into key events that we'll write to the buffer
@@ -297,6 +302,7 @@ bool InputStateMachineEngine::ActionPassThroughString(const std::wstring_view st
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionEscDispatch(const VTID id)
 {
+    _FlushPendingInput();
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -355,6 +361,18 @@ bool InputStateMachineEngine::ActionVt52EscDispatch(const VTID /*id*/, const VTP
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameters parameters)
 {
+    // Keys in win32-input-mode and mouse events make up nearly all of the input
+    // at high key repeat and mouse rates. They're queued up in _pendingInput as
+    // they are decoded, and written to the input buffer in a single batch once
+    // the string is processed. Anything else has to come after them.
+    const auto batched = id == CsiActionCodes::Win32KeyboardInput ||
+                         id == CsiActionCodes::MouseDown ||
+                         id == CsiActionCodes::MouseUp;
+    if (!batched)
+    {
+        _FlushPendingInput();
+    }
+
     // GH#4999 - If the client was in VT input mode, but we received a
     // win32-input-mode sequence, then _don't_ passthrough the sequence to the
     // client. It's impossibly unlikely that the client actually wanted
@@ -365,6 +383,7 @@ bool InputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameter
         _pfnFlushToInputQueue &&
         id != CsiActionCodes::Win32KeyboardInput)
     {
+        _FlushPendingInput();
         return _pfnFlushToInputQueue();
     }
 
@@ -427,11 +446,19 @@ bool InputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameter
         break;
     case CsiActionCodes::Win32KeyboardInput:
     {
-        // Use WriteCtrlKey here, even for keys that _aren't_ control keys,
-        // because that will take extra steps to make sure things like
-        // Ctrl+C, Ctrl+Break are handled correctly.
-        const auto key = _GenerateWin32Key(parameters);
-        success = _pDispatch->WriteCtrlKey(key);
+        const auto record = _GenerateWin32KeyRecord(parameters);
+        if (_IsControlKey(record.Event.KeyEvent))
+        {
+            // Use WriteCtrlKey for these, because that will take extra steps
+            // to make sure things like Ctrl+C, Ctrl+Break are handled correctly.
+            _FlushPendingInput();
+            success = _pDispatch->WriteCtrlKey(KeyEvent{ record.Event.KeyEvent });
+        }
+        else
+        {
+            _pendingInput.push_back(record);
+            success = true;
+        }
         break;
     }
     default:
@@ -468,6 +495,7 @@ IStateMachineEngine::StringHandler InputStateMachineEngine::ActionDcsDispatch(co
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionSs3Dispatch(const wchar_t wch, const VTParameters /*parameters*/)
 {
+    _FlushPendingInput();
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -512,6 +540,19 @@ bool InputStateMachineEngine::ActionIgnore() noexcept
     return true;
 }
 
+// Method Description:
+// - Triggers the EndOfString action to indicate that the whole string was
+//      processed. Writes the keys and mouse events that were queued up while
+//      processing it to the input buffer.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the input.
+bool InputStateMachineEngine::ActionEndOfString()
+{
+    return _FlushPendingInput();
+}
+
 // Method Description:
 // - Triggers the OscDispatch action to indicate that the listener should handle a control sequence.
 //   These sequences perform various API-type commands that can include many parameters.
@@ -728,10 +769,30 @@ bool InputStateMachineEngine::_WriteMouseEvent(const til::point uiPos, const DWO
     rgInput.Event.MouseEvent.dwControlKeyState = controlKeyState;
     rgInput.Event.MouseEvent.dwEventFlags = eventFlags;
 
-    // pack and write input record
     // 1 record - the modifiers don't get their own events
-    std::deque<std::unique_ptr<IInputEvent>> inputEvents = IInputEvent::Create(gsl::make_span(&rgInput, 1));
-    return _pDispatch->WriteInput(inputEvents);
+    // It's written along with the rest of the batch, see ActionEndOfString.
+    _pendingInput.push_back(rgInput);
+    return true;
+}
+
+// Method Description:
+// - Writes the keys and mouse events that were queued up in _pendingInput to
+//      the input buffer, in a single call. This has to happen before any other
+//      input is written, to keep the input in order.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the input (or there was none).
+bool InputStateMachineEngine::_FlushPendingInput()
+{
+    if (_pendingInput.empty())
+    {
+        return true;
+    }
+
+    // Clear the queue even if the write fails, so that the input isn't written twice.
+    const auto clear = wil::scope_exit([&]() noexcept { _pendingInput.clear(); });
+    return _pDispatch->WriteInputRecords(_pendingInput);
 }
 
 // Method Description:
@@ -1114,6 +1175,18 @@ bool InputStateMachineEngine::_GetWindowManipulationType(const gsl::span<const s
 // Return Value:
 // - The deserialized KeyEvent.
 KeyEvent InputStateMachineEngine::_GenerateWin32Key(const VTParameters parameters)
+{
+    return KeyEvent{ _GenerateWin32KeyRecord(parameters).Event.KeyEvent };
+}
+
+// Method Description:
+// - Decodes the parameters of a win32-input-mode sequence straight into the
+//      INPUT_RECORD they were serialized from.
+// Arguments:
+// - parameters: the list of numbers to parse into values for the record.
+// Return Value:
+// - The deserialized key event record.
+INPUT_RECORD InputStateMachineEngine::_GenerateWin32KeyRecord(const VTParameters parameters)
 {
     // Sequences are formatted as follows:
     //
@@ -1127,12 +1200,40 @@ KeyEvent InputStateMachineEngine::_GenerateWin32Key(const VTParameters parameter
     //      Cs: the value of dwControlKeyState - any number. If omitted, defaults to '0'.
     //      Rc: the value of wRepeatCount - any number. If omitted, defaults to '1'.
 
-    auto key = KeyEvent();
-    key.SetVirtualKeyCode(::base::saturated_cast<WORD>(parameters.at(0).value_or(0)));
-    key.SetVirtualScanCode(::base::saturated_cast<WORD>(parameters.at(1).value_or(0)));
-    key.SetCharData(::base::saturated_cast<wchar_t>(parameters.at(2).value_or(0)));
-    key.SetKeyDown(parameters.at(3).value_or(0));
-    key.SetActiveModifierKeys(::base::saturated_cast<DWORD>(parameters.at(4).value_or(0)));
-    key.SetRepeatCount(::base::saturated_cast<WORD>(parameters.at(5).value_or(1)));
-    return key;
+    INPUT_RECORD record{};
+    record.EventType = KEY_EVENT;
+    auto& key = record.Event.KeyEvent;
+    key.wVirtualKeyCode = ::base::saturated_cast<WORD>(parameters.at(0).value_or(0));
+    key.wVirtualScanCode = ::base::saturated_cast<WORD>(parameters.at(1).value_or(0));
+    key.uChar.UnicodeChar = ::base::saturated_cast<wchar_t>(parameters.at(2).value_or(0));
+    key.bKeyDown = parameters.at(3).value_or(0) != 0;
+    key.dwControlKeyState = ::base::saturated_cast<DWORD>(parameters.at(4).value_or(0));
+    key.wRepeatCount = ::base::saturated_cast<WORD>(parameters.at(5).value_or(1));
+    return record;
+}
+
+// Method Description:
+// - Checks whether the host might do something other than appending the given
+//      key to the input buffer, i.e. whether it needs to go through
+//      WriteCtrlKey. That's the case for Ctrl+C, Ctrl+Break, Ctrl+Esc and Alt+Esc.
+// Arguments:
+// - key: the key to check
+// Return Value:
+// - true iff the key has to be written with WriteCtrlKey.
+bool InputStateMachineEngine::_IsControlKey(const KEY_EVENT_RECORD& key) noexcept
+{
+    if (!key.bKeyDown || WI_AreAllFlagsClear(key.dwControlKeyState, CTRL_PRESSED | ALT_PRESSED))
+    {
+        return false;
+    }
+
+    switch (key.wVirtualKeyCode)
+    {
+    case 'C':
+    case VK_CANCEL:
+    case VK_ESCAPE:
+        return true;
+    default:
+        return false;
+    }
 }
@@ -158,6 +158,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionSs3Dispatch(const wchar_t wch, const VTParameters parameters) override;
 
+        bool ActionEndOfString() override;
+
         void SetFlushToInputQueueCallback(std::function<bool()> pfnFlushToInputQueue);
 
     private:
@@ -170,6 +172,10 @@ namespace Microsoft::Console::VirtualTerminal
         std::optional<std::chrono::steady_clock::time_point> _lastMouseClickTime{};
         std::optional<size_t> _lastMouseClickButton{};
 
+        // The win32-input-mode keys and mouse events of the current string.
+        // They're written to the input buffer all at once, see ActionEndOfString.
+        std::vector<INPUT_RECORD> _pendingInput;
+
         DWORD _GetCursorKeysModifierState(const VTParameters parameters, const VTID id) noexcept;
         DWORD _GetGenericKeysModifierState(const VTParameters parameters) noexcept;
         DWORD _GetSGRMouseModifierState(const size_t modifierParam) noexcept;
@@ -190,6 +196,7 @@ namespace Microsoft::Console::VirtualTerminal
         bool _WriteSingleKey(const wchar_t wch, const short vkey, const DWORD modifierState);
 
         bool _WriteMouseEvent(const til::point uiPos, const DWORD buttonState, const DWORD controlKeyState, const DWORD eventFlags);
+        bool _FlushPendingInput();
 
         void _GenerateWrappedSequence(const wchar_t wch,
                                       const short vkey,
@@ -205,6 +212,8 @@ namespace Microsoft::Console::VirtualTerminal
                                         unsigned int& function) const noexcept;
 
         KeyEvent _GenerateWin32Key(const VTParameters parameters);
+        INPUT_RECORD _GenerateWin32KeyRecord(const VTParameters parameters);
+        static bool _IsControlKey(const KEY_EVENT_RECORD& key) noexcept;
 
         bool _DoControlCharacter(const wchar_t wch, const bool writeAlt);
 
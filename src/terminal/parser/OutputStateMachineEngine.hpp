@@ -55,6 +55,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionSs3Dispatch(const wchar_t wch, const VTParameters parameters) noexcept override;
 
+        bool ActionEndOfString() noexcept override;
+
         void SetTerminalConnection(Microsoft::Console::Render::VtEngine* const pTtyConnection,
                                    std::function<bool()> pfnFlushToTerminal);
 
@@ -142,6 +144,10 @@ namespace Microsoft::Console::VirtualTerminal
             XT_PushSgr = VTID("#{"),
             XT_PopSgr = VTID("#}"),
             DECSCPP_SetColumnsPerPage = VTID("$|"),
+            DECCRA_CopyRectangularArea = VTID("$v"),
+            DECFRA_FillRectangularArea = VTID("$x"),
+            DECERA_EraseRectangularArea = VTID("$z"),
+            DECSERA_SelectiveEraseRectangularArea = VTID("${"),
         };
 
         enum DcsActionCodes : uint64_t
@@ -182,6 +188,7 @@ namespace Microsoft::Console::VirtualTerminal
             SetBackgroundColor = 11,
             SetCursorColor = 12,
             SetClipboard = 52,
+            FinalTermAction = 133,
             ResetForegroundColor = 110, // Not implemented
             ResetBackgroundColor = 111, // Not implemented
             ResetCursorColor = 112
@@ -0,0 +1,140 @@
+/*++
+Copyright (c) Microsoft Corporation.
+Licensed under the MIT license.
+
+Module Name:
+- BenchmarkConGetSet.hpp
+
+Abstract:
+- A ConGetSet without a console behind it, so that the cost of AdaptDispatch
+  can be measured on its own. It keeps track of just enough state (cursor,
+  attributes, modes) for the dispatch to take its regular code paths, and
+  drops all output.
+--*/
+
+#pragma once
+
+#include "../../adapter/conGetSet.hpp"
+
+namespace Microsoft::Console::VirtualTerminal
+{
+    class BenchmarkConGetSet final : public ConGetSet
+    {
+    public:
+        static constexpr SHORT Width = 120;
+        static constexpr SHORT Height = 30;
+        static constexpr SHORT BufferHeight = 9001;
+
+        void PrintString(const std::wstring_view /*string*/) override {}
+
+        void GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) const override
+        {
+            screenBufferInfo.dwSize = { Width, BufferHeight };
+            screenBufferInfo.dwCursorPosition = _cursorPosition;
+            screenBufferInfo.srWindow = { 0, 0, Width - 1, Height - 1 };
+            screenBufferInfo.dwMaximumWindowSize = { Width, Height };
+            screenBufferInfo.wAttributes = _attributes.GetLegacyAttributes();
+        }
+        void SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX& /*screenBufferInfo*/) override {}
+        void SetCursorPosition(const COORD position) override { _cursorPosition = position; }
+
+        bool IsVtInputEnabled() const override { return false; }
+
+        TextAttribute GetTextAttributes() const override { return _attributes; }
+        void SetTextAttributes(const TextAttribute& attrs) override { _attributes = attrs; }
+
+        void SetCurrentLineRendition(const LineRendition /*lineRendition*/) override {}
+        void ResetLineRenditionRange(const size_t /*startRow*/, const size_t /*endRow*/) override {}
+        SHORT GetLineWidth(const size_t /*row*/) const override { return Width; }
+
+        void WriteInput(std::deque<std::unique_ptr<IInputEvent>>& events, size_t& eventsWritten) override
+        {
+            eventsWritten = events.size();
+            events.clear();
+        }
+        void WriteInputRecords(const gsl::span<const INPUT_RECORD> records, size_t& eventsWritten) override
+        {
+            eventsWritten = records.size();
+        }
+        void SetWindowInfo(const bool /*absolute*/, const SMALL_RECT& /*window*/) override {}
+
+        bool SetInputMode(const TerminalInput::Mode /*mode*/, const bool /*enabled*/) override { return true; }
+        void SetParserMode(const StateMachine::Mode mode, const bool enabled) override { _parserMode.set(mode, enabled); }
+        bool GetParserMode(const StateMachine::Mode mode) const override { return _parserMode.test(mode); }
+        void SetRenderMode(const RenderSettings::Mode /*mode*/, const bool /*enabled*/) override {}
+        void SetSynchronizedOutput(const bool /*enabled*/) override {}
+
+        void SetAutoWrapMode(const bool /*wrapAtEOL*/) override {}
+
+        void SetCursorVisibility(const bool /*visible*/) override {}
+        bool EnableCursorBlinking(const bool /*enable*/) override { return true; }
+
+        void SetScrollingRegion(const SMALL_RECT& /*scrollMargins*/) override {}
+        void WarningBell() override {}
+        bool GetLineFeedMode() const override { return false; }
+        void LineFeed(const bool withReturn) override
+        {
+            _cursorPosition.Y = std::min<SHORT>(_cursorPosition.Y + 1, Height - 1);
+            if (withReturn)
+            {
+                _cursorPosition.X = 0;
+            }
+        }
+        void ReverseLineFeed() override { _cursorPosition.Y = std::max<SHORT>(_cursorPosition.Y - 1, 0); }
+        void SetWindowTitle(const std::wstring_view /*title*/) override {}
+        void UseAlternateScreenBuffer() override {}
+        void UseMainScreenBuffer() override {}
+
+        void EraseAll() override {}
+        void ClearBuffer() override {}
+        CursorType GetUserDefaultCursorStyle() const override { return CursorType::Legacy; }
+        void SetCursorStyle(const CursorType /*style*/) override {}
+        void WriteControlInput(const KeyEvent /*key*/) override {}
+        void RefreshWindow() override {}
+
+        void SetConsoleOutputCP(const unsigned int codepage) override { _codepage = codepage; }
+        unsigned int GetConsoleOutputCP() const override { return _codepage; }
+
+        bool ResizeWindow(const size_t /*width*/, const size_t /*height*/) override { return true; }
+        void SuppressResizeRepaint() override {}
+        bool IsConsolePty() const override { return false; }
+
+        void DeleteLines(const size_t /*count*/) override {}
+        void InsertLines(const size_t /*count*/) override {}
+
+        void MoveToBottom() override {}
+
+        COLORREF GetColorTableEntry(const size_t /*tableIndex*/) const override { return 0; }
+        bool SetColorTableEntry(const size_t /*tableIndex*/, const COLORREF /*color*/) override { return true; }
+        void SetColorAliasIndex(const ColorAlias /*alias*/, const size_t /*tableIndex*/) override {}
+
+        void FillRegion(const COORD /*startPosition*/,
+                        const size_t /*fillLength*/,
+                        const wchar_t /*fillChar*/,
+                        const bool /*standardFillAttrs*/) override {}
+
+        void ScrollRegion(const SMALL_RECT /*scrollRect*/,
+                          const std::optional<SMALL_RECT> /*clipRect*/,
+                          const COORD /*destinationOrigin*/,
+                          const bool /*standardFillAttrs*/) override {}
+
+        void CopyRectangle(const SMALL_RECT /*source*/, const COORD /*targetOrigin*/) override {}
+        void FillRectangle(const SMALL_RECT /*fillRect*/,
+                           const wchar_t /*fillChar*/,
+                           const std::optional<TextAttribute> /*fillAttrs*/) override {}
+        void ClearRowsBelow(const size_t /*startRow*/) override {}
+
+        void AddHyperlink(const std::wstring_view /*uri*/, const std::wstring_view /*params*/) const override {}
+        void EndHyperlink() const override {}
+
+        void UpdateSoftFont(const gsl::span<const uint16_t> /*bitPattern*/,
+                            const SIZE /*cellSize*/,
+                            const size_t /*centeringHint*/) override {}
+
+    private:
+        COORD _cursorPosition{ 0, 0 };
+        TextAttribute _attributes{};
+        til::enumset<StateMachine::Mode> _parserMode{ StateMachine::Mode::Ansi };
+        unsigned int _codepage{ CP_UTF8 };
+    };
+}
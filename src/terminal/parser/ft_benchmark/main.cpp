@@ -0,0 +1,281 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "BenchmarkConGetSet.hpp"
+#include "../stateMachine.hpp"
+#include "../OutputStateMachineEngine.hpp"
+#include "../../adapter/adaptDispatch.hpp"
+#include "../../adapter/termDispatch.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal;
+
+// Measures the throughput of the VT parser, either on its own (with a dispatch
+// that ignores everything) or together with AdaptDispatch (with a ConGetSet that
+// ignores everything). Each corpus is parsed repeatedly and the fastest pass is
+// reported, as that's the one the least disturbed by the rest of the system.
+
+namespace
+{
+    // Every generated corpus is about this large, so that it doesn't fit into the L2 cache.
+    constexpr size_t CorpusSize = 4 * 1024 * 1024;
+    // Every corpus is parsed for at least this long...
+    constexpr auto MinimumDuration = std::chrono::milliseconds{ 500 };
+    // ...and at least this many times.
+    constexpr size_t MinimumPasses = 5;
+
+    class NullDispatch final : public TermDispatch
+    {
+    public:
+        void Print(const wchar_t /*wchPrintable*/) override {}
+        void PrintString(const std::wstring_view /*string*/) override {}
+    };
+
+    struct Corpus
+    {
+        std::wstring name;
+        std::wstring text;
+    };
+
+    // A tiny deterministic PRNG (xorshift), so that every run parses the exact same corpora.
+    struct Random
+    {
+        uint32_t state = 0x12345678;
+
+        uint32_t operator()(const uint32_t bound) noexcept
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state % bound;
+        }
+    };
+
+    void AppendWord(std::wstring& text, Random& random)
+    {
+        const auto length = 2 + random(8);
+        for (uint32_t i = 0; i < length; ++i)
+        {
+            text.push_back(static_cast<wchar_t>(L'a' + random(26)));
+        }
+    }
+
+    // Plain text, like a log file or `cat` of a source file.
+    Corpus GenerateAscii()
+    {
+        Random random;
+        Corpus corpus{ L"ascii" };
+        while (corpus.text.size() < CorpusSize)
+        {
+            for (auto words = 3 + random(12); words > 0; --words)
+            {
+                AppendWord(corpus.text, random);
+                corpus.text.push_back(L' ');
+            }
+            corpus.text.append(L"\r\n");
+        }
+        return corpus;
+    }
+
+    // Colored output with an SGR every few characters, like `ls --color` or a compiler.
+    Corpus GenerateSgr()
+    {
+        Random random;
+        Corpus corpus{ L"sgr" };
+        while (corpus.text.size() < CorpusSize)
+        {
+            switch (random(5))
+            {
+            case 0:
+                corpus.text.append(fmt::format(L"\x1b[{}m", 30 + random(8)));
+                break;
+            case 1:
+                corpus.text.append(fmt::format(L"\x1b[1;{}m", 90 + random(8)));
+                break;
+            case 2:
+                corpus.text.append(fmt::format(L"\x1b[38;5;{}m", random(256)));
+                break;
+            case 3:
+                corpus.text.append(fmt::format(L"\x1b[38;2;{};{};{}m", random(256), random(256), random(256)));
+                break;
+            default:
+                corpus.text.append(L"\x1b[0m");
+                break;
+            }
+            AppendWord(corpus.text, random);
+            corpus.text.append(random(8) == 0 ? L"\x1b[m\r\n" : L" ");
+        }
+        return corpus;
+    }
+
+    // Full screen redraws, like vim scrolling through a file: cursor positioning,
+    // a colored line number, syntax highlighting and an erase for every line.
+    Corpus GenerateVimRedraw()
+    {
+        Random random;
+        Corpus corpus{ L"vim" };
+        for (size_t line = 1; corpus.text.size() < CorpusSize; ++line)
+        {
+            corpus.text.append(L"\x1b[?25l\x1b[H");
+            for (auto row = 1; row < BenchmarkConGetSet::Height; ++row)
+            {
+                corpus.text.append(fmt::format(L"\x1b[{};1H\x1b[33m{:>4} \x1b[m", row, line + row));
+                for (auto tokens = random(10); tokens > 0; --tokens)
+                {
+                    corpus.text.append(fmt::format(L"\x1b[38;5;{}m", random(256)));
+                    AppendWord(corpus.text, random);
+                    corpus.text.append(L"\x1b[m ");
+                }
+                corpus.text.append(L"\x1b[K");
+            }
+            corpus.text.append(fmt::format(L"\x1b[{};1H\x1b[7m-- INSERT --\x1b[m\x1b[K\x1b[{};{}H\x1b[?25h", BenchmarkConGetSet::Height, 1 + random(20), 6 + random(40)));
+        }
+        return corpus;
+    }
+
+    // Text outside of ASCII: CJK ideographs and emoji, which are surrogate pairs in UTF-16.
+    Corpus GenerateCjkAndEmoji()
+    {
+        Random random;
+        Corpus corpus{ L"cjk+emoji" };
+        while (corpus.text.size() < CorpusSize)
+        {
+            for (auto glyphs = 5 + random(30); glyphs > 0; --glyphs)
+            {
+                if (random(4) == 0)
+                {
+                    // U+1F600 - U+1F64F, Emoticons
+                    const auto codepoint = 0x1F600 + random(0x50) - 0x10000;
+                    corpus.text.push_back(static_cast<wchar_t>(0xD800 + (codepoint >> 10)));
+                    corpus.text.push_back(static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF)));
+                }
+                else
+                {
+                    // U+4E00 - U+9FFF, CJK Unified Ideographs
+                    corpus.text.push_back(static_cast<wchar_t>(0x4E00 + random(0x5200)));
+                }
+            }
+            corpus.text.append(L"\r\n");
+        }
+        return corpus;
+    }
+
+    // OSC 8 hyperlinks, like `ls --hyperlink` or a test runner linking to source files.
+    Corpus GenerateHyperlinks()
+    {
+        Random random;
+        Corpus corpus{ L"osc8" };
+        while (corpus.text.size() < CorpusSize)
+        {
+            const auto id = random(1000);
+            corpus.text.append(fmt::format(L"\x1b]8;id={};file:///home/user/src/project/file{}.cpp\x1b\\", id, id));
+            AppendWord(corpus.text, random);
+            corpus.text.append(L"\x1b]8;;\x1b\\ ");
+            AppendWord(corpus.text, random);
+            corpus.text.append(L"\r\n");
+        }
+        return corpus;
+    }
+
+    // Reads a recording, e.g. captured with `script` or from a ConPTY debug tap, as UTF-8.
+    Corpus ReadCorpus(const wchar_t* path)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND), !file);
+        const std::string bytes{ std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+
+        Corpus corpus{ path };
+        THROW_IF_FAILED(til::u8u16(bytes, corpus.text));
+        return corpus;
+    }
+
+    // Runs the corpus through a fresh state machine until MinimumDuration and MinimumPasses are reached.
+    // Returns the duration of the fastest pass.
+    std::chrono::nanoseconds Measure(const Corpus& corpus, const std::function<std::unique_ptr<ITermDispatch>()>& makeDispatch)
+    {
+        StateMachine machine{ std::make_unique<OutputStateMachineEngine>(makeDispatch()) };
+
+        // Parse everything once, to warm up the caches and allocate any buffers the parser keeps around.
+        machine.ProcessString(corpus.text);
+
+        auto fastest = std::chrono::nanoseconds::max();
+        std::chrono::nanoseconds total{ 0 };
+        for (size_t passes = 0; passes < MinimumPasses || total < MinimumDuration; ++passes)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            machine.ProcessString(corpus.text);
+            const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+            fastest = std::min(fastest, duration);
+            total += duration;
+        }
+        return fastest;
+    }
+
+    void Report(const Corpus& corpus, const wchar_t* dispatchName, const std::chrono::nanoseconds duration)
+    {
+        // Throughput is reported in terms of UTF-16 input, which is what the parser consumes.
+        const auto bytes = static_cast<double>(corpus.text.size() * sizeof(wchar_t));
+        const auto seconds = std::chrono::duration<double>(duration).count();
+        wprintf(L"%-12s %-8s %10.2f MB/s %8.3f ns/byte\r\n",
+                corpus.name.c_str(),
+                dispatchName,
+                bytes / seconds / (1024 * 1024),
+                static_cast<double>(duration.count()) / bytes);
+    }
+}
+
+void PrintUsage()
+{
+    wprintf(L"Usage: conterm.parser.benchmark.exe [<recording>...]\r\n");
+    wprintf(L"Without arguments, a set of generated corpora is measured. Recordings are read as UTF-8.\r\n");
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    std::vector<Corpus> corpora;
+    if (argc > 1)
+    {
+        if (wcscmp(argv[1], L"/?") == 0 || wcscmp(argv[1], L"-h") == 0)
+        {
+            PrintUsage();
+            return 0;
+        }
+
+        for (auto i = 1; i < argc; ++i)
+        {
+            corpora.emplace_back(ReadCorpus(argv[i]));
+        }
+    }
+    else
+    {
+        corpora.emplace_back(GenerateAscii());
+        corpora.emplace_back(GenerateSgr());
+        corpora.emplace_back(GenerateVimRedraw());
+        corpora.emplace_back(GenerateCjkAndEmoji());
+        corpora.emplace_back(GenerateHyperlinks());
+    }
+
+    const auto makeNullDispatch = []() -> std::unique_ptr<ITermDispatch> {
+        return std::make_unique<NullDispatch>();
+    };
+    const auto makeAdaptDispatch = []() -> std::unique_ptr<ITermDispatch> {
+        return std::make_unique<AdaptDispatch>(std::make_unique<BenchmarkConGetSet>());
+    };
+
+    for (const auto& corpus : corpora)
+    {
+        Report(corpus, L"null", Measure(corpus, makeNullDispatch));
+        Report(corpus, L"adapter", Measure(corpus, makeAdaptDispatch));
+    }
+
+    return 0;
+}
+catch (...)
+{
+    const auto hr = wil::ResultFromCaughtException();
+    wprintf(L"Failed with 0x%08x\r\n", hr);
+    return hr;
+}
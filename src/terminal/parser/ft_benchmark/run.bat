@@ -0,0 +1 @@
+%_NTTREE%\unittests\conterm.parser.benchmark.exe %*
\ No newline at end of file
@@ -7,6 +7,8 @@
 
 #include "ascii.hpp"
 
+#include "../../types/inc/AllocationTracking.hpp"
+
 using namespace Microsoft::Console::VirtualTerminal;
 
 //Takes ownership of the pEngine.
@@ -58,6 +60,86 @@ static constexpr bool _isNumericParamValue(const wchar_t wch) noexcept
 #pragma warning(push)
 #pragma warning(disable : 26497) // We don't use any of these "constexprable" functions in that fashion
 
+namespace
+{
+    // The classes of characters that the states below tell apart with more than a single comparison.
+    // They're looked up in a table, so that every state classifies a character with a single load.
+    // All characters at or above U+00A0 are ordinary printable characters and belong to no class.
+    enum CharClass : uint16_t
+    {
+        C0Code = 1 << 0, // 0x00 - 0x17, 0x19, 0x1C - 0x1F
+        C1ControlCharacter = 1 << 1, // 0x80 - 0x9F
+        Intermediate = 1 << 2, // 0x20 - 0x2F
+        CsiPrivateMarker = 1 << 3, // 0x3C - 0x3F
+        IntermediateInvalid = 1 << 4, // 0x30 - 0x3F
+        ParameterInvalid = 1 << 5, // 0x3A, 0x3C - 0x3F
+        OscInvalid = 1 << 6, // 0x00 - 0x17, 0x19, 0x1C - 0x1F
+        DcsPassThroughValid = 1 << 7, // 0x20 - 0x7E
+        ActionableFromGround = 1 << 8, // 0x00 - 0x1F, 0x7F - 0x9F
+    };
+
+    constexpr size_t CharClassTableSize = 0xA0;
+
+    constexpr std::array<uint16_t, CharClassTableSize> _buildCharClassTable() noexcept
+    {
+        std::array<uint16_t, CharClassTableSize> table{};
+        for (size_t wch = 0; wch < table.size(); ++wch)
+        {
+            uint16_t classes = 0;
+            if (wch <= AsciiChars::ETB || wch == AsciiChars::EM || (wch >= AsciiChars::FS && wch <= AsciiChars::US))
+            {
+                // The C0 codes other than CAN, SUB and ESC, which are handled in any state.
+                // OSC strings ignore exactly the same set of characters.
+                classes |= C0Code | OscInvalid;
+            }
+            if (wch >= 0x80 && wch <= 0x9F)
+            {
+                classes |= C1ControlCharacter;
+            }
+            if (wch >= L' ' && wch <= L'/')
+            {
+                classes |= Intermediate;
+            }
+            if (wch >= L'<' && wch <= L'?')
+            {
+                classes |= CsiPrivateMarker | ParameterInvalid;
+            }
+            if (wch == L':')
+            {
+                classes |= ParameterInvalid;
+            }
+            if (wch >= L'0' && wch <= L'?')
+            {
+                classes |= IntermediateInvalid;
+            }
+            if (wch >= AsciiChars::SPC && wch < AsciiChars::DEL)
+            {
+                classes |= DcsPassThroughValid;
+            }
+            if (wch <= AsciiChars::US || (wch >= AsciiChars::DEL && wch <= 0x9F))
+            {
+                classes |= ActionableFromGround;
+            }
+            table.at(wch) = classes;
+        }
+        return table;
+    }
+
+    constexpr auto s_charClasses = _buildCharClassTable();
+}
+
+// Routine Description:
+// - Determines if a character belongs to the given class (or any of the given classes).
+// Arguments:
+// - wch - Character to check.
+// - classes - CharClass flags to check for.
+// Return Value:
+// - True if it does. False if it doesn't.
+static constexpr bool _isCharClass(const wchar_t wch, const uint16_t classes) noexcept
+{
+    return wch < CharClassTableSize && (til::at(s_charClasses, wch) & classes) != 0;
+}
+
 // Routine Description:
 // - Determines if a character belongs to the C0 escape range.
 //   This is character sequences less than a space character (null, backspace, new line, etc.)
@@ -68,9 +150,7 @@ static constexpr bool _isNumericParamValue(const wchar_t wch) noexcept
 // - True if it is. False if it isn't.
 static constexpr bool _isC0Code(const wchar_t wch) noexcept
 {
-    return (wch >= AsciiChars::NUL && wch <= AsciiChars::ETB) ||
-           wch == AsciiChars::EM ||
-           (wch >= AsciiChars::FS && wch <= AsciiChars::US);
+    return _isCharClass(wch, C0Code);
 }
 
 // Routine Description:
@@ -95,7 +175,7 @@ static constexpr bool _isC0Code(const wchar_t wch) noexcept
 // - True if it is. False if it isn't.
 static constexpr bool _isC1ControlCharacter(const wchar_t wch) noexcept
 {
-    return (wch >= L'\x80' && wch <= L'\x9F');
+    return _isCharClass(wch, C1ControlCharacter);
 }
 
 // Routine Description:
@@ -121,7 +201,7 @@ static constexpr wchar_t _c1To7Bit(const wchar_t wch) noexcept
 // - True if it is. False if it isn't.
 static constexpr bool _isIntermediate(const wchar_t wch) noexcept
 {
-    return wch >= L' ' && wch <= L'/'; // 0x20 - 0x2F
+    return _isCharClass(wch, Intermediate); // 0x20 - 0x2F
 }
 
 // Routine Description:
@@ -179,7 +259,7 @@ static constexpr bool _isCsiIndicator(const wchar_t wch) noexcept
 // - True if it is. False if it isn't.
 static constexpr bool _isCsiPrivateMarker(const wchar_t wch) noexcept
 {
-    return wch == L'<' || wch == L'=' || wch == L'>' || wch == L'?'; // 0x3C - 0x3F
+    return _isCharClass(wch, CsiPrivateMarker); // 0x3C - 0x3F
 }
 
 // Routine Description:
@@ -202,7 +282,7 @@ static constexpr bool _isCsiInvalid(const wchar_t wch) noexcept
 static constexpr bool _isIntermediateInvalid(const wchar_t wch) noexcept
 {
     // 0x30 - 0x3F
-    return _isNumericParamValue(wch) || _isCsiInvalid(wch) || _isParameterDelimiter(wch) || _isCsiPrivateMarker(wch);
+    return _isCharClass(wch, IntermediateInvalid);
 }
 
 // Routine Description:
@@ -214,7 +294,7 @@ static constexpr bool _isIntermediateInvalid(const wchar_t wch) noexcept
 static constexpr bool _isParameterInvalid(const wchar_t wch) noexcept
 {
     // 0x3A, 0x3C - 0x3F
-    return _isCsiInvalid(wch) || _isCsiPrivateMarker(wch);
+    return _isCharClass(wch, ParameterInvalid);
 }
 
 // Routine Description:
@@ -288,9 +368,7 @@ static constexpr bool _isOscDelimiter(const wchar_t wch) noexcept
 // - True if it is. False if it isn't.
 static constexpr bool _isOscInvalid(const wchar_t wch) noexcept
 {
-    return wch <= L'\x17' ||
-           wch == L'\x19' ||
-           (wch >= L'\x1c' && wch <= L'\x1f');
+    return _isCharClass(wch, OscInvalid);
 }
 
 // Routine Description:
@@ -326,7 +404,7 @@ static constexpr bool _isDcsIndicator(const wchar_t wch) noexcept
 static constexpr bool _isDcsPassThroughValid(const wchar_t wch) noexcept
 {
     // 0x20 - 0x7E
-    return wch >= AsciiChars::SPC && wch < AsciiChars::DEL;
+    return _isCharClass(wch, DcsPassThroughValid);
 }
 
 // Routine Description:
@@ -374,7 +452,54 @@ static constexpr bool _isApcIndicator(const wchar_t wch) noexcept
 // - True if it is. False if it isn't.
 static constexpr bool _isActionableFromGround(const wchar_t wch) noexcept
 {
-    return (wch <= AsciiChars::US) || _isC1ControlCharacter(wch) || _isDelete(wch);
+    return _isCharClass(wch, ActionableFromGround);
+}
+
+// Routine Description:
+// - Finds the next character that's actionable from the ground state (see _isActionableFromGround).
+//   Everything before it can be printed as a single run.
+// Arguments:
+// - string - Characters to search.
+// - offset - Index of the first character to search.
+// Return Value:
+// - The index of the next actionable character, or the length of the string if there is none.
+static size_t _findActionableFromGround(const std::wstring_view string, size_t offset) noexcept
+{
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. Use span instead (bounds.1).
+#pragma warning(disable : 26490) // Don't use reinterpret_cast (type.1).
+#if _M_AMD64
+    // This checks 8 characters at a time for 0x00 - 0x1F and 0x7F - 0x9F. The comparisons are
+    // signed, which means that anything at or above U+8000 fails the lower bound of both ranges.
+    const auto c0Lower = _mm_set1_epi16(-1);
+    const auto c0Upper = _mm_set1_epi16(0x20);
+    const auto c1Lower = _mm_set1_epi16(0x7e);
+    const auto c1Upper = _mm_set1_epi16(0xa0);
+    for (; offset + 8 <= string.size(); offset += 8)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string.data() + offset));
+        const auto c0 = _mm_and_si128(_mm_cmpgt_epi16(chars, c0Lower), _mm_cmplt_epi16(chars, c0Upper));
+        const auto c1 = _mm_and_si128(_mm_cmpgt_epi16(chars, c1Lower), _mm_cmplt_epi16(chars, c1Upper));
+        const auto mask = _mm_movemask_epi8(_mm_or_si128(c0, c1));
+        if (mask != 0)
+        {
+            // Each character yields 2 bits in the mask.
+            unsigned long index;
+            _BitScanForward(&index, static_cast<unsigned long>(mask));
+            return offset + index / 2;
+        }
+    }
+#endif
+#pragma warning(pop)
+
+    for (; offset < string.size(); ++offset)
+    {
+        if (_isActionableFromGround(til::at(string, offset)))
+        {
+            break;
+        }
+    }
+    return offset;
 }
 
 #pragma warning(pop)
@@ -581,6 +706,20 @@ void StateMachine::_ActionIgnore() noexcept
     _trace.TraceOnAction(L"Ignore");
 }
 
+// Routine Description:
+// - Triggers the EndOfString action to indicate that the listener has been
+//   given all of the current string, e.g. to write the input it batched up.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_ActionEndOfString() noexcept
+{
+    _SafeExecute([=]() {
+        return _engine->ActionEndOfString();
+    });
+}
+
 // Routine Description:
 // - Triggers the end of a data string when a CAN, SUB, or ESC is seen.
 // Arguments:
@@ -1826,6 +1965,8 @@ bool StateMachine::FlushToTerminal() noexcept
 // - <none>
 void StateMachine::ProcessString(const std::wstring_view string)
 {
+    TRACK_ALLOCATIONS(Parser);
+
     size_t start = 0;
     size_t current = start;
 
@@ -1846,6 +1987,23 @@ void StateMachine::ProcessString(const std::wstring_view string)
             // If we're processing characters individually, send it to the state machine.
             ProcessCharacter(til::at(string, current));
             ++current;
+
+            // Parameters make up most of the length of a typical control sequence (e.g. SGR).
+            // Collect them right here instead of classifying them again one by one.
+            if (_state == VTStates::CsiParam)
+            {
+                current = _ProcessCsiParameters(string, current);
+            }
+            // Likewise, the payload of OSC and DCS strings (e.g. OSC 52 clipboard data or
+            // sixels) can be arbitrarily long and is best consumed in contiguous runs.
+            else if (_state == VTStates::OscString)
+            {
+                current = _ProcessOscString(string, current);
+            }
+            else if (_state == VTStates::DcsPassThrough)
+            {
+                current = _ProcessDcsPassThrough(string, current);
+            }
             if (_state == VTStates::Ground) // Then check if we're back at ground. If we are, the next character (pwchCurr)
             { //   is the start of the next run of characters that might be printable.
                 _processingIndividually = false;
@@ -1854,24 +2012,16 @@ void StateMachine::ProcessString(const std::wstring_view string)
         }
         else
         {
-            if (_isActionableFromGround(til::at(string, current))) // If the current char is the start of an escape sequence, or should be executed in ground state...
+            // Skip ahead to the next char that's the start of an escape sequence, or should be executed in ground state.
+            // Everything up to there will be printed as part of the current run.
+            current = _findActionableFromGround(string, current);
+            if (current < string.size())
             {
-                if (_runSize > 0)
-                {
-                    // Because the run above is composed INCLUDING current, we must
-                    // trim it off here since we just determined it's actionable
-                    // and only pass through everything before it.
-                    _runSize -= 1;
-                    _ActionPrintString(_CurrentRun()); // ... print all the chars leading up to it as part of the run...
-                }
+                _runSize = current - start;
+                _ActionPrintString(_CurrentRun()); // ... print all the chars leading up to it as part of the run...
 
                 _processingIndividually = true; // begin processing future characters individually...
                 start = current;
-                continue;
-            }
-            else
-            {
-                ++current; // Otherwise, add this char to the current run to be printed.
             }
         }
     }
@@ -1972,6 +2122,88 @@ void StateMachine::ProcessString(const std::wstring_view string)
             cachedSequence.append(run);
         }
     }
+
+    _ActionEndOfString();
+}
+
+// Routine Description:
+// - Collects the parameters of a control sequence, while in the CsiParam state.
+//   This is equivalent to passing each of the numeric characters and delimiters
+//   to ProcessCharacter, which would forward them to _ActionParam in this state.
+// Arguments:
+// - string - Characters to operate upon
+// - offset - Index of the next character to process
+// Return Value:
+// - The index of the first character that isn't part of the parameters.
+size_t StateMachine::_ProcessCsiParameters(const std::wstring_view string, size_t offset)
+{
+    for (; offset < string.size(); ++offset)
+    {
+        const auto wch = til::at(string, offset);
+        if (!_isNumericParamValue(wch) && !_isParameterDelimiter(wch))
+        {
+            break;
+        }
+
+        _trace.TraceCharInput(wch);
+        _ActionParam(wch);
+    }
+    return offset;
+}
+
+// Routine Description:
+// - Collects the contents of an OSC string, while in the OscString state.
+//   This appends the whole run of characters up to the next control character
+//   at once, which would otherwise be passed to _ActionOscPut one at a time.
+//   Control characters (which terminate the string or are ignored) are left
+//   for ProcessCharacter.
+// - _oscString retains its capacity across sequences, so that once it has grown
+//   to the size of the typical payload, collecting it doesn't allocate anymore.
+// Arguments:
+// - string - Characters to operate upon
+// - offset - Index of the next character to process
+// Return Value:
+// - The index of the first character that isn't part of the run.
+size_t StateMachine::_ProcessOscString(const std::wstring_view string, const size_t offset)
+{
+    const auto end = _findActionableFromGround(string, offset);
+    const auto run = string.substr(offset, end - offset);
+
+    _trace.AddSequenceTrace(run);
+    _oscString.append(run);
+    return end;
+}
+
+// Routine Description:
+// - Passes the data string of a DCS sequence to its handler, while in the DcsPassThrough state.
+//   This is equivalent to passing each of the printable characters to ProcessCharacter,
+//   but without classifying each of them again. Anything else is left for ProcessCharacter.
+// Arguments:
+// - string - Characters to operate upon
+// - offset - Index of the next character to process
+// Return Value:
+// - The index of the first character that wasn't passed to the handler.
+size_t StateMachine::_ProcessDcsPassThrough(const std::wstring_view string, size_t offset)
+{
+    const auto start = offset;
+    for (; offset < string.size(); ++offset)
+    {
+        const auto wch = til::at(string, offset);
+        if (!_isDcsPassThroughValid(wch))
+        {
+            break;
+        }
+
+        if (!_dcsStringHandler(wch))
+        {
+            _EnterDcsIgnore();
+            ++offset;
+            break;
+        }
+    }
+
+    _trace.AddSequenceTrace(string.substr(start, offset - start));
+    return offset;
 }
 
 // Routine Description:
@@ -32,6 +32,62 @@ namespace Microsoft::Console::VirtualTerminal
     // that number.
     constexpr size_t MAX_PARAMETER_COUNT = 32;
 
+    // The parameters of the sequence that is currently being parsed. Since their
+    // count is limited to MAX_PARAMETER_COUNT anyway, they're stored inline,
+    // so that parsing and dispatching a sequence never has to allocate.
+    class VTParameterStore
+    {
+    public:
+        bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        const VTParameter* data() const noexcept
+        {
+            return _values.data();
+        }
+
+        VTParameter at(const size_t index) const
+        {
+            THROW_HR_IF(E_BOUNDS, index >= _size);
+            return til::at(_values, index);
+        }
+
+        VTParameter& back() noexcept
+        {
+            return til::at(_values, _size - 1);
+        }
+
+        const VTParameter& back() const noexcept
+        {
+            return til::at(_values, _size - 1);
+        }
+
+        // Parameters beyond the capacity are dropped.
+        void push_back(const VTParameter parameter) noexcept
+        {
+            if (_size < _values.size())
+            {
+                til::at(_values, _size++) = parameter;
+            }
+        }
+
+        void clear() noexcept
+        {
+            _size = 0;
+        }
+
+    private:
+        std::array<VTParameter, MAX_PARAMETER_COUNT> _values{};
+        size_t _size{ 0 };
+    };
+
     class StateMachine final
     {
 #ifdef UNIT_TESTING
@@ -85,6 +141,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionClear();
         void _ActionIgnore() noexcept;
         void _ActionInterrupt();
+        void _ActionEndOfString() noexcept;
 
         void _EnterGround() noexcept;
         void _EnterEscape();
@@ -126,6 +183,9 @@ namespace Microsoft::Console::VirtualTerminal
         void _EventDcsPassThrough(const wchar_t wch);
         void _EventSosPmApcString(const wchar_t wch) noexcept;
 
+        size_t _ProcessCsiParameters(const std::wstring_view string, size_t offset);
+        size_t _ProcessOscString(const std::wstring_view string, size_t offset);
+        size_t _ProcessDcsPassThrough(const std::wstring_view string, size_t offset);
         void _AccumulateTo(const wchar_t wch, size_t& value) noexcept;
 
         template<typename TLambda>
@@ -179,7 +239,7 @@ namespace Microsoft::Console::VirtualTerminal
         }
 
         VTIDBuilder _identifier;
-        std::vector<VTParameter> _parameters;
+        VTParameterStore _parameters;
         bool _parameterLimitReached;
 
         std::wstring _oscString;
@@ -19,6 +19,8 @@ TRACELOGGING_DEFINE_PROVIDER(g_hConsoleVirtTermParserEventTraceProvider,
 
 using namespace Microsoft::Console::VirtualTerminal;
 
+thread_local TermTelemetry::LocalCounters TermTelemetry::s_local;
+
 #pragma warning(push)
 // Disable 4351 so we can initialize the arrays to 0 without a warning.
 #pragma warning(disable : 4351)
@@ -49,44 +51,82 @@ TermTelemetry::~TermTelemetry()
     CATCH_LOG()
 }
 
+// The counts of a thread that exits must not get lost.
+TermTelemetry::LocalCounters::~LocalCounters()
+{
+    TermTelemetry::Instance()._Flush(*this);
+}
+
 // Routine Description:
-// - Logs the usage of a particular VT100 code.
+// - Adds the counts of the calling thread to the totals right away, instead
+//   of waiting for FlushInterval events.
 //
 // Arguments:
-// - code - VT100 code.
+// - <none>
 // Return Value:
 // - <none>
-void TermTelemetry::Log(const Codes code) noexcept
+void TermTelemetry::Flush() noexcept
 {
-    // Initially we wanted to pass over a string (ex. "CUU") and use a dictionary data type to hold the counts.
-    // However we would have to search through the dictionary every time we called this method, so we decided
-    // to use an array which has very quick access times.
-    // The downside is we have to create an enum type, and then convert them to strings when we finally
-    // send out the telemetry, but the upside is we should have very good performance.
-    _uiTimesUsed[code]++;
-    _uiTimesUsedCurrent++;
+    _Flush(s_local);
 }
 
 // Routine Description:
-// - Logs a particular VT100 escape code failed or was unsupported.
+// - Adds the counts of a thread to the totals and resets them.
+// - If someone is listening for traces, the counts of this batch are also
+//   written as an event of their own. Unlike the final log, these show how
+//   the use of the sequences changes over time, which helps tuning.
 //
 // Arguments:
-// - code - VT100 code.
+// - local - the counters of the calling thread.
 // Return Value:
 // - <none>
-void TermTelemetry::LogFailed(const wchar_t wch) noexcept
+void TermTelemetry::_Flush(LocalCounters& local) noexcept
 {
-    if (wch > CHAR_MAX)
+    if (local.pending == 0)
     {
-        _uiTimesFailedOutsideRange++;
-        _uiTimesFailedOutsideRangeCurrent++;
+        return;
     }
-    else
+
+    if (TraceLoggingProviderEnabled(g_hConsoleVirtTermParserEventTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE))
     {
-        // Even though we pass over a wide character, we only care about the ASCII single byte character.
-        _uiTimesFailed[wch]++;
-        _uiTimesFailedCurrent++;
+        TraceLoggingWriteActivity(g_hConsoleVirtTermParserEventTraceProvider,
+                                  "ControlCodesSampled",
+                                  &_activityId,
+                                  NULL,
+                                  TraceLoggingUInt32Array(local.timesUsed, ARRAYSIZE(local.timesUsed), "Used"),
+                                  TraceLoggingUInt32Array(local.timesFailed, ARRAYSIZE(local.timesFailed), "Failed"),
+                                  TraceLoggingUInt32(local.timesFailedOutsideRange, "FailedOutsideRange"),
+                                  TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                                  TraceLoggingKeyword(TIL_KEYWORD_TRACE));
     }
+
+    unsigned int used = 0;
+    for (int n = 0; n < ARRAYSIZE(local.timesUsed); n++)
+    {
+        if (const auto count = std::exchange(local.timesUsed[n], 0u))
+        {
+            _uiTimesUsed[n].fetch_add(count, std::memory_order_relaxed);
+            used += count;
+        }
+    }
+
+    unsigned int failed = 0;
+    for (int n = 0; n < ARRAYSIZE(local.timesFailed); n++)
+    {
+        if (const auto count = std::exchange(local.timesFailed[n], 0u))
+        {
+            _uiTimesFailed[n].fetch_add(count, std::memory_order_relaxed);
+            failed += count;
+        }
+    }
+
+    const auto failedOutsideRange = std::exchange(local.timesFailedOutsideRange, 0u);
+    _uiTimesFailedOutsideRange.fetch_add(failedOutsideRange, std::memory_order_relaxed);
+
+    _uiTimesUsedCurrent.fetch_add(used, std::memory_order_relaxed);
+    _uiTimesFailedCurrent.fetch_add(failed, std::memory_order_relaxed);
+    _uiTimesFailedOutsideRangeCurrent.fetch_add(failedOutsideRange, std::memory_order_relaxed);
+    local.pending = 0;
 }
 
 // Routine Description:
@@ -98,9 +138,8 @@ void TermTelemetry::LogFailed(const wchar_t wch) noexcept
 // - total number.
 unsigned int TermTelemetry::GetAndResetTimesUsedCurrent() noexcept
 {
-    const auto temp = _uiTimesUsedCurrent;
-    _uiTimesUsedCurrent = 0;
-    return temp;
+    Flush();
+    return _uiTimesUsedCurrent.exchange(0, std::memory_order_relaxed);
 }
 
 // Routine Description:
@@ -112,9 +151,8 @@ unsigned int TermTelemetry::GetAndResetTimesUsedCurrent() noexcept
 // - total number.
 unsigned int TermTelemetry::GetAndResetTimesFailedCurrent() noexcept
 {
-    const auto temp = _uiTimesFailedCurrent;
-    _uiTimesFailedCurrent = 0;
-    return temp;
+    Flush();
+    return _uiTimesFailedCurrent.exchange(0, std::memory_order_relaxed);
 }
 
 // Routine Description:
@@ -126,9 +164,8 @@ unsigned int TermTelemetry::GetAndResetTimesFailedCurrent() noexcept
 // - total number.
 unsigned int TermTelemetry::GetAndResetTimesFailedOutsideRangeCurrent() noexcept
 {
-    const auto temp = _uiTimesFailedOutsideRangeCurrent;
-    _uiTimesFailedOutsideRangeCurrent = 0;
-    return temp;
+    Flush();
+    return _uiTimesFailedOutsideRangeCurrent.exchange(0, std::memory_order_relaxed);
 }
 
 // Routine Description:
@@ -168,31 +205,24 @@ void TermTelemetry::WriteFinalTraceLog() const
 {
     if (_fShouldWriteFinalLog)
     {
+        // TraceLogging needs plain values, so take a snapshot of the totals.
+        unsigned int timesUsed[NUMBER_OF_CODES];
+        unsigned int timesFailed[CHAR_MAX + 1];
+        const auto timesFailedOutsideRange = _uiTimesFailedOutsideRange.load(std::memory_order_relaxed);
+
         // Determine if we've logged any VT100 sequences at all.
-        bool fLoggedSequence = (_uiTimesFailedOutsideRange > 0);
+        bool fLoggedSequence = (timesFailedOutsideRange > 0);
 
-        if (!fLoggedSequence)
+        for (int n = 0; n < ARRAYSIZE(timesUsed); n++)
         {
-            for (int n = 0; n < ARRAYSIZE(_uiTimesUsed); n++)
-            {
-                if (_uiTimesUsed[n] > 0)
-                {
-                    fLoggedSequence = true;
-                    break;
-                }
-            }
+            timesUsed[n] = _uiTimesUsed[n].load(std::memory_order_relaxed);
+            fLoggedSequence |= timesUsed[n] > 0;
         }
 
-        if (!fLoggedSequence)
+        for (int n = 0; n < ARRAYSIZE(timesFailed); n++)
         {
-            for (int n = 0; n < ARRAYSIZE(_uiTimesFailed); n++)
-            {
-                if (_uiTimesFailed[n] > 0)
-                {
-                    fLoggedSequence = true;
-                    break;
-                }
-            }
+            timesFailed[n] = _uiTimesFailed[n].load(std::memory_order_relaxed);
+            fLoggedSequence |= timesFailed[n] > 0;
         }
 
         // Only send telemetry if we've logged some VT100 sequences.  This should help reduce the amount of unnecessary
@@ -206,82 +236,86 @@ void TermTelemetry::WriteFinalTraceLog() const
                                       "ControlCodesUsed",
                                       &_activityId,
                                       NULL,
-                                      TraceLoggingUInt32(_uiTimesUsed[CUU], "CUU"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CUD], "CUD"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CUF], "CUF"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CUB], "CUB"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CNL], "CNL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CPL], "CPL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CHA], "CHA"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CUP], "CUP"),
-                                      TraceLoggingUInt32(_uiTimesUsed[ED], "ED"),
-                                      TraceLoggingUInt32(_uiTimesUsed[EL], "EL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[SGR], "SGR"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECSC], "DECSC"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECRC], "DECRC"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECSET], "DECSET"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECRST], "DECRST"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECKPAM], "DECKPAM"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECKPNM], "DECKPNM"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DSR], "DSR"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DA], "DA"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DA2], "DA2"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DA3], "DA3"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECREQTPARM], "DECREQTPARM"),
-                                      TraceLoggingUInt32(_uiTimesUsed[VPA], "VPA"),
-                                      TraceLoggingUInt32(_uiTimesUsed[HPR], "HPR"),
-                                      TraceLoggingUInt32(_uiTimesUsed[VPR], "VPR"),
-                                      TraceLoggingUInt32(_uiTimesUsed[ICH], "ICH"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DCH], "DCH"),
-                                      TraceLoggingUInt32(_uiTimesUsed[IL], "IL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DL], "DL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[SU], "SU"),
-                                      TraceLoggingUInt32(_uiTimesUsed[SD], "SD"),
-                                      TraceLoggingUInt32(_uiTimesUsed[ANSISYSSC], "ANSISYSSC"),
-                                      TraceLoggingUInt32(_uiTimesUsed[ANSISYSRC], "ANSISYSRC"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECSTBM], "DECSTBM"),
-                                      TraceLoggingUInt32(_uiTimesUsed[NEL], "NEL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[IND], "IND"),
-                                      TraceLoggingUInt32(_uiTimesUsed[RI], "RI"),
-                                      TraceLoggingUInt32(_uiTimesUsed[OSCWT], "OscWindowTitle"),
-                                      TraceLoggingUInt32(_uiTimesUsed[HTS], "HTS"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CHT], "CHT"),
-                                      TraceLoggingUInt32(_uiTimesUsed[CBT], "CBT"),
-                                      TraceLoggingUInt32(_uiTimesUsed[TBC], "TBC"),
-                                      TraceLoggingUInt32(_uiTimesUsed[ECH], "ECH"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DesignateG0], "DesignateG0"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DesignateG1], "DesignateG1"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DesignateG2], "DesignateG2"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DesignateG3], "DesignateG3"),
-                                      TraceLoggingUInt32(_uiTimesUsed[LS2], "LS2"),
-                                      TraceLoggingUInt32(_uiTimesUsed[LS3], "LS3"),
-                                      TraceLoggingUInt32(_uiTimesUsed[LS1R], "LS1R"),
-                                      TraceLoggingUInt32(_uiTimesUsed[LS2R], "LS2R"),
-                                      TraceLoggingUInt32(_uiTimesUsed[LS3R], "LS3R"),
-                                      TraceLoggingUInt32(_uiTimesUsed[SS2], "SS2"),
-                                      TraceLoggingUInt32(_uiTimesUsed[SS3], "SS3"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DOCS], "DOCS"),
-                                      TraceLoggingUInt32(_uiTimesUsed[HVP], "HVP"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECSTR], "DECSTR"),
-                                      TraceLoggingUInt32(_uiTimesUsed[RIS], "RIS"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECSCUSR], "DECSCUSR"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DTTERM_WM], "DTTERM_WM"),
-                                      TraceLoggingUInt32(_uiTimesUsed[OSCCT], "OscColorTable"),
-                                      TraceLoggingUInt32(_uiTimesUsed[OSCSCC], "OscSetCursorColor"),
-                                      TraceLoggingUInt32(_uiTimesUsed[OSCRCC], "OscResetCursorColor"),
-                                      TraceLoggingUInt32(_uiTimesUsed[OSCFG], "OscForegroundColor"),
-                                      TraceLoggingUInt32(_uiTimesUsed[OSCBG], "OscBackgroundColor"),
-                                      TraceLoggingUInt32(_uiTimesUsed[OSCSCB], "OscSetClipboard"),
-                                      TraceLoggingUInt32(_uiTimesUsed[REP], "REP"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECAC1], "DECAC1"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECSWL], "DECSWL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECDWL], "DECDWL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECDHL], "DECDHL"),
-                                      TraceLoggingUInt32(_uiTimesUsed[DECALN], "DECALN"),
-                                      TraceLoggingUInt32(_uiTimesUsed[XTPUSHSGR], "XTPUSHSGR"),
-                                      TraceLoggingUInt32(_uiTimesUsed[XTPOPSGR], "XTPOPSGR"),
-                                      TraceLoggingUInt32Array(_uiTimesFailed, ARRAYSIZE(_uiTimesFailed), "Failed"),
-                                      TraceLoggingUInt32(_uiTimesFailedOutsideRange, "FailedOutsideRange"));
+                                      TraceLoggingUInt32(timesUsed[CUU], "CUU"),
+                                      TraceLoggingUInt32(timesUsed[CUD], "CUD"),
+                                      TraceLoggingUInt32(timesUsed[CUF], "CUF"),
+                                      TraceLoggingUInt32(timesUsed[CUB], "CUB"),
+                                      TraceLoggingUInt32(timesUsed[CNL], "CNL"),
+                                      TraceLoggingUInt32(timesUsed[CPL], "CPL"),
+                                      TraceLoggingUInt32(timesUsed[CHA], "CHA"),
+                                      TraceLoggingUInt32(timesUsed[CUP], "CUP"),
+                                      TraceLoggingUInt32(timesUsed[ED], "ED"),
+                                      TraceLoggingUInt32(timesUsed[EL], "EL"),
+                                      TraceLoggingUInt32(timesUsed[SGR], "SGR"),
+                                      TraceLoggingUInt32(timesUsed[DECSC], "DECSC"),
+                                      TraceLoggingUInt32(timesUsed[DECRC], "DECRC"),
+                                      TraceLoggingUInt32(timesUsed[DECSET], "DECSET"),
+                                      TraceLoggingUInt32(timesUsed[DECRST], "DECRST"),
+                                      TraceLoggingUInt32(timesUsed[DECKPAM], "DECKPAM"),
+                                      TraceLoggingUInt32(timesUsed[DECKPNM], "DECKPNM"),
+                                      TraceLoggingUInt32(timesUsed[DSR], "DSR"),
+                                      TraceLoggingUInt32(timesUsed[DA], "DA"),
+                                      TraceLoggingUInt32(timesUsed[DA2], "DA2"),
+                                      TraceLoggingUInt32(timesUsed[DA3], "DA3"),
+                                      TraceLoggingUInt32(timesUsed[DECREQTPARM], "DECREQTPARM"),
+                                      TraceLoggingUInt32(timesUsed[VPA], "VPA"),
+                                      TraceLoggingUInt32(timesUsed[HPR], "HPR"),
+                                      TraceLoggingUInt32(timesUsed[VPR], "VPR"),
+                                      TraceLoggingUInt32(timesUsed[ICH], "ICH"),
+                                      TraceLoggingUInt32(timesUsed[DCH], "DCH"),
+                                      TraceLoggingUInt32(timesUsed[IL], "IL"),
+                                      TraceLoggingUInt32(timesUsed[DL], "DL"),
+                                      TraceLoggingUInt32(timesUsed[SU], "SU"),
+                                      TraceLoggingUInt32(timesUsed[SD], "SD"),
+                                      TraceLoggingUInt32(timesUsed[ANSISYSSC], "ANSISYSSC"),
+                                      TraceLoggingUInt32(timesUsed[ANSISYSRC], "ANSISYSRC"),
+                                      TraceLoggingUInt32(timesUsed[DECSTBM], "DECSTBM"),
+                                      TraceLoggingUInt32(timesUsed[NEL], "NEL"),
+                                      TraceLoggingUInt32(timesUsed[IND], "IND"),
+                                      TraceLoggingUInt32(timesUsed[RI], "RI"),
+                                      TraceLoggingUInt32(timesUsed[OSCWT], "OscWindowTitle"),
+                                      TraceLoggingUInt32(timesUsed[HTS], "HTS"),
+                                      TraceLoggingUInt32(timesUsed[CHT], "CHT"),
+                                      TraceLoggingUInt32(timesUsed[CBT], "CBT"),
+                                      TraceLoggingUInt32(timesUsed[TBC], "TBC"),
+                                      TraceLoggingUInt32(timesUsed[ECH], "ECH"),
+                                      TraceLoggingUInt32(timesUsed[DesignateG0], "DesignateG0"),
+                                      TraceLoggingUInt32(timesUsed[DesignateG1], "DesignateG1"),
+                                      TraceLoggingUInt32(timesUsed[DesignateG2], "DesignateG2"),
+                                      TraceLoggingUInt32(timesUsed[DesignateG3], "DesignateG3"),
+                                      TraceLoggingUInt32(timesUsed[LS2], "LS2"),
+                                      TraceLoggingUInt32(timesUsed[LS3], "LS3"),
+                                      TraceLoggingUInt32(timesUsed[LS1R], "LS1R"),
+                                      TraceLoggingUInt32(timesUsed[LS2R], "LS2R"),
+                                      TraceLoggingUInt32(timesUsed[LS3R], "LS3R"),
+                                      TraceLoggingUInt32(timesUsed[SS2], "SS2"),
+                                      TraceLoggingUInt32(timesUsed[SS3], "SS3"),
+                                      TraceLoggingUInt32(timesUsed[DOCS], "DOCS"),
+                                      TraceLoggingUInt32(timesUsed[HVP], "HVP"),
+                                      TraceLoggingUInt32(timesUsed[DECSTR], "DECSTR"),
+                                      TraceLoggingUInt32(timesUsed[RIS], "RIS"),
+                                      TraceLoggingUInt32(timesUsed[DECSCUSR], "DECSCUSR"),
+                                      TraceLoggingUInt32(timesUsed[DTTERM_WM], "DTTERM_WM"),
+                                      TraceLoggingUInt32(timesUsed[OSCCT], "OscColorTable"),
+                                      TraceLoggingUInt32(timesUsed[OSCSCC], "OscSetCursorColor"),
+                                      TraceLoggingUInt32(timesUsed[OSCRCC], "OscResetCursorColor"),
+                                      TraceLoggingUInt32(timesUsed[OSCFG], "OscForegroundColor"),
+                                      TraceLoggingUInt32(timesUsed[OSCBG], "OscBackgroundColor"),
+                                      TraceLoggingUInt32(timesUsed[OSCSCB], "OscSetClipboard"),
+                                      TraceLoggingUInt32(timesUsed[REP], "REP"),
+                                      TraceLoggingUInt32(timesUsed[DECAC1], "DECAC1"),
+                                      TraceLoggingUInt32(timesUsed[DECSWL], "DECSWL"),
+                                      TraceLoggingUInt32(timesUsed[DECDWL], "DECDWL"),
+                                      TraceLoggingUInt32(timesUsed[DECDHL], "DECDHL"),
+                                      TraceLoggingUInt32(timesUsed[DECALN], "DECALN"),
+                                      TraceLoggingUInt32(timesUsed[XTPUSHSGR], "XTPUSHSGR"),
+                                      TraceLoggingUInt32(timesUsed[XTPOPSGR], "XTPOPSGR"),
+                                      TraceLoggingUInt32(timesUsed[DECCRA], "DECCRA"),
+                                      TraceLoggingUInt32(timesUsed[DECFRA], "DECFRA"),
+                                      TraceLoggingUInt32(timesUsed[DECERA], "DECERA"),
+                                      TraceLoggingUInt32(timesUsed[DECSERA], "DECSERA"),
+                                      TraceLoggingUInt32Array(timesFailed, ARRAYSIZE(timesFailed), "Failed"),
+                                      TraceLoggingUInt32(timesFailedOutsideRange, "FailedOutsideRange"));
         }
     }
 }
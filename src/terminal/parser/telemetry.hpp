@@ -7,6 +7,11 @@ Module Name:
 
 Abstract:
 - This module is used for recording all telemetry feedback from the console virtual terminal parser
+- Log() and LogFailed() are called for every sequence that's dispatched, so
+  they only count into counters of the calling thread, without any locks or
+  atomics. These are added to the shared totals every FlushInterval events,
+  and when the thread exits. The totals may thus lag behind by a few events
+  per thread, which doesn't matter for telemetry.
 */
 #pragma once
 
@@ -15,6 +20,7 @@ Abstract:
 #include <winmeta.h>
 #include <TraceLoggingProvider.h>
 #include "climits"
+#include <atomic>
 
 TRACELOGGING_DECLARE_PROVIDER(g_hConsoleVirtTermParserEventTraceProvider);
 
@@ -107,11 +113,41 @@ namespace Microsoft::Console::VirtualTerminal
             OSCSCB,
             XTPUSHSGR,
             XTPOPSGR,
+            DECCRA,
+            DECFRA,
+            DECERA,
+            DECSERA,
             // Only use this last enum as a count of the number of codes.
             NUMBER_OF_CODES
         };
-        void Log(const Codes code) noexcept;
-        void LogFailed(const wchar_t wch) noexcept;
+        void Log(const Codes code) noexcept
+        {
+            // Initially we wanted to pass over a string (ex. "CUU") and use a dictionary data type to hold the counts.
+            // However we would have to search through the dictionary every time we called this method, so we decided
+            // to use an array which has very quick access times.
+            // The downside is we have to create an enum type, and then convert them to strings when we finally
+            // send out the telemetry, but the upside is we should have very good performance.
+            auto& local = s_local;
+            local.timesUsed[code]++;
+            _CountPending(local);
+        }
+
+        void LogFailed(const wchar_t wch) noexcept
+        {
+            auto& local = s_local;
+            if (wch > CHAR_MAX)
+            {
+                local.timesFailedOutsideRange++;
+            }
+            else
+            {
+                // Even though we pass over a wide character, we only care about the ASCII single byte character.
+                local.timesFailed[wch]++;
+            }
+            _CountPending(local);
+        }
+
+        void Flush() noexcept;
         void SetShouldWriteFinalLog(const bool writeLog) noexcept;
         void SetActivityId(const GUID* activityId) noexcept;
         unsigned int GetAndResetTimesUsedCurrent() noexcept;
@@ -127,14 +163,41 @@ namespace Microsoft::Console::VirtualTerminal
         TermTelemetry& operator=(const TermTelemetry&) = delete;
         TermTelemetry& operator=(TermTelemetry&&) = delete;
 
+        // The counters of a single thread are added to the totals after this many events.
+        static constexpr unsigned int FlushInterval = 256;
+
+        struct LocalCounters
+        {
+            LocalCounters() = default;
+            ~LocalCounters();
+            LocalCounters(const LocalCounters&) = delete;
+            LocalCounters& operator=(const LocalCounters&) = delete;
+
+            unsigned int timesUsed[NUMBER_OF_CODES]{};
+            unsigned int timesFailed[CHAR_MAX + 1]{};
+            unsigned int timesFailedOutsideRange{ 0 };
+            unsigned int pending{ 0 };
+        };
+
+        void _CountPending(LocalCounters& local) noexcept
+        {
+            if (++local.pending >= FlushInterval)
+            {
+                _Flush(local);
+            }
+        }
+
+        void _Flush(LocalCounters& local) noexcept;
         void WriteFinalTraceLog() const;
 
-        unsigned int _uiTimesUsedCurrent;
-        unsigned int _uiTimesFailedCurrent;
-        unsigned int _uiTimesFailedOutsideRangeCurrent;
-        unsigned int _uiTimesUsed[NUMBER_OF_CODES];
-        unsigned int _uiTimesFailed[CHAR_MAX + 1];
-        unsigned int _uiTimesFailedOutsideRange;
+        static thread_local LocalCounters s_local;
+
+        std::atomic<unsigned int> _uiTimesUsedCurrent;
+        std::atomic<unsigned int> _uiTimesFailedCurrent;
+        std::atomic<unsigned int> _uiTimesFailedOutsideRangeCurrent;
+        std::atomic<unsigned int> _uiTimesUsed[NUMBER_OF_CODES];
+        std::atomic<unsigned int> _uiTimesFailed[CHAR_MAX + 1];
+        std::atomic<unsigned int> _uiTimesFailedOutsideRange;
         GUID _activityId;
 
         bool _fShouldWriteFinalLog;
@@ -8,6 +8,10 @@ Module Name:
 Abstract:
 - This module is used for recording tracing/debugging information to the telemetry ETW channel
 - The data is not automatically broadcast to telemetry backends.
+- The methods are called for every action of the state machine. They're
+  inlined and check whether anyone is listening first, so that none of their
+  arguments are prepared and no function is called unless a session has
+  enabled the provider at the verbose level.
 - NOTE: Many functions in this file appear to be copy/pastes. This is because the TraceLog documentation warns
         to not be "cute" in trying to reduce its macro usages with variables as it can cause unexpected behavior.
 */
@@ -34,19 +38,109 @@ namespace Microsoft::Console::VirtualTerminal
         // C-strings is more ergonomic instead and fits the need for
         // high performance in this particular code.
 
-        void TraceStateChange(_In_z_ const wchar_t* name) const noexcept;
-        void TraceOnAction(_In_z_ const wchar_t* name) const noexcept;
-        void TraceOnExecute(const wchar_t wch) const noexcept;
-        void TraceOnExecuteFromEscape(const wchar_t wch) const noexcept;
-        void TraceOnEvent(_In_z_ const wchar_t* name) const noexcept;
-        void TraceCharInput(const wchar_t wch);
+        static bool IsEnabled() noexcept
+        {
+            return TraceLoggingProviderEnabled(g_hConsoleVirtTermParserEventTraceProvider, WINEVENT_LEVEL_VERBOSE, TIL_KEYWORD_TRACE);
+        }
 
-        void AddSequenceTrace(const wchar_t wch);
-        void DispatchSequenceTrace(const bool fSuccess) noexcept;
-        void ClearSequenceTrace() noexcept;
-        void DispatchPrintRunTrace(const std::wstring_view& string) const;
+        void TraceStateChange(_In_z_ const wchar_t* name) const noexcept
+        {
+            if (IsEnabled())
+            {
+                _TraceStateChange(name);
+            }
+        }
+
+        void TraceOnAction(_In_z_ const wchar_t* name) const noexcept
+        {
+            if (IsEnabled())
+            {
+                _TraceOnAction(name);
+            }
+        }
+
+        void TraceOnExecute(const wchar_t wch) const noexcept
+        {
+            if (IsEnabled())
+            {
+                _TraceOnExecute(wch);
+            }
+        }
+
+        void TraceOnExecuteFromEscape(const wchar_t wch) const noexcept
+        {
+            if (IsEnabled())
+            {
+                _TraceOnExecuteFromEscape(wch);
+            }
+        }
+
+        void TraceOnEvent(_In_z_ const wchar_t* name) const noexcept
+        {
+            if (IsEnabled())
+            {
+                _TraceOnEvent(name);
+            }
+        }
+
+        void TraceCharInput(const wchar_t wch)
+        {
+            if (IsEnabled())
+            {
+                _TraceCharInput(wch);
+            }
+        }
+
+        void AddSequenceTrace(const wchar_t wch)
+        {
+            // Don't waste time storing this if no one is listening.
+            if (IsEnabled())
+            {
+                _sequenceTrace.push_back(wch);
+            }
+        }
+
+        void AddSequenceTrace(const std::wstring_view string)
+        {
+            // Don't waste time storing this if no one is listening.
+            if (IsEnabled())
+            {
+                _sequenceTrace.append(string);
+            }
+        }
+
+        void DispatchSequenceTrace(const bool fSuccess) noexcept
+        {
+            if (IsEnabled())
+            {
+                _DispatchSequenceTrace(fSuccess);
+            }
+            ClearSequenceTrace();
+        }
+
+        void ClearSequenceTrace() noexcept
+        {
+            _sequenceTrace.clear();
+        }
+
+        void DispatchPrintRunTrace(const std::wstring_view& string) const
+        {
+            if (IsEnabled())
+            {
+                _DispatchPrintRunTrace(string);
+            }
+        }
 
     private:
+        void _TraceStateChange(_In_z_ const wchar_t* name) const noexcept;
+        void _TraceOnAction(_In_z_ const wchar_t* name) const noexcept;
+        void _TraceOnExecute(const wchar_t wch) const noexcept;
+        void _TraceOnExecuteFromEscape(const wchar_t wch) const noexcept;
+        void _TraceOnEvent(_In_z_ const wchar_t* name) const noexcept;
+        void _TraceCharInput(const wchar_t wch);
+        void _DispatchSequenceTrace(const bool fSuccess) const noexcept;
+        void _DispatchPrintRunTrace(const std::wstring_view& string) const;
+
         std::wstring _sequenceTrace;
     };
 }
@@ -281,6 +281,7 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
 
     TEST_METHOD(TestWin32InputParsing);
     TEST_METHOD(TestWin32InputOptionals);
+    TEST_METHOD(TestWin32InputBatching);
 
     friend class TestInteractDispatch;
 };
@@ -324,6 +325,7 @@ public:
     TestInteractDispatch(_In_ std::function<void(std::deque<std::unique_ptr<IInputEvent>>&)> pfn,
                          _In_ TestState* testState);
     virtual bool WriteInput(_In_ std::deque<std::unique_ptr<IInputEvent>>& inputEvents) override;
+    virtual bool WriteInputRecords(const gsl::span<const INPUT_RECORD> records) override;
 
     virtual bool WriteCtrlKey(const KeyEvent& event) override;
     virtual bool WindowManipulation(const DispatchTypes::WindowManipulationType function,
@@ -354,6 +356,12 @@ bool TestInteractDispatch::WriteInput(_In_ std::deque<std::unique_ptr<IInputEven
     return true;
 }
 
+bool TestInteractDispatch::WriteInputRecords(const gsl::span<const INPUT_RECORD> records)
+{
+    auto inputEvents = IInputEvent::Create(records);
+    return WriteInput(inputEvents);
+}
+
 bool TestInteractDispatch::WriteCtrlKey(const KeyEvent& event)
 {
     VERIFY_IS_TRUE(_testState->_expectSendCtrlC);
@@ -1611,3 +1619,67 @@ void InputEngineTest::TestWin32InputOptionals()
         }
     }
 }
+
+void InputEngineTest::TestWin32InputBatching()
+{
+    std::vector<std::vector<INPUT_RECORD>> batches;
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        batches.emplace_back(IInputEvent::ToInputRecords(inEvents));
+    };
+
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    auto _stateMachine = std::make_unique<StateMachine>(std::move(inputEngine));
+    VERIFY_IS_NOT_NULL(_stateMachine);
+    testState._stateMachine = _stateMachine.get();
+
+    // Ctrl+C has to be written with WriteCtrlKey.
+    testState._expectSendCtrlC = true;
+    auto resetExpectSendCtrlC = wil::scope_exit([&]() { testState._expectSendCtrlC = false; });
+
+    Log::Comment(L"Keys and mouse events are written in one batch per string, "
+                 L"except for the keys that go through WriteCtrlKey.");
+    _stateMachine->ProcessString(L"\x1b[65;30;97;1;0;1_"
+                                 L"\x1b[65;30;97;0;0;1_"
+                                 L"\x1b[67;46;3;1;8;1_"
+                                 L"\x1b[67;46;3;0;8;1_"
+                                 L"\x1b[<0;2;3M");
+
+    VERIFY_ARE_EQUAL(3u, batches.size());
+
+    VERIFY_ARE_EQUAL(2u, batches.at(0).size());
+    for (const auto& record : batches.at(0))
+    {
+        VERIFY_ARE_EQUAL(KEY_EVENT, record.EventType);
+        VERIFY_ARE_EQUAL(65, record.Event.KeyEvent.wVirtualKeyCode);
+        VERIFY_ARE_EQUAL(30, record.Event.KeyEvent.wVirtualScanCode);
+        VERIFY_ARE_EQUAL(L'a', record.Event.KeyEvent.uChar.UnicodeChar);
+        VERIFY_ARE_EQUAL(1, record.Event.KeyEvent.wRepeatCount);
+    }
+    VERIFY_IS_TRUE(batches.at(0).at(0).Event.KeyEvent.bKeyDown);
+    VERIFY_IS_FALSE(batches.at(0).at(1).Event.KeyEvent.bKeyDown);
+
+    VERIFY_ARE_EQUAL(1u, batches.at(1).size());
+    VERIFY_ARE_EQUAL(KEY_EVENT, batches.at(1).at(0).EventType);
+    VERIFY_ARE_EQUAL(L'C', batches.at(1).at(0).Event.KeyEvent.wVirtualKeyCode);
+    VERIFY_IS_TRUE(batches.at(1).at(0).Event.KeyEvent.bKeyDown);
+    VERIFY_ARE_EQUAL(static_cast<DWORD>(LEFT_CTRL_PRESSED), batches.at(1).at(0).Event.KeyEvent.dwControlKeyState);
+
+    VERIFY_ARE_EQUAL(2u, batches.at(2).size());
+    VERIFY_ARE_EQUAL(KEY_EVENT, batches.at(2).at(0).EventType);
+    VERIFY_ARE_EQUAL(L'C', batches.at(2).at(0).Event.KeyEvent.wVirtualKeyCode);
+    VERIFY_IS_FALSE(batches.at(2).at(0).Event.KeyEvent.bKeyDown);
+    VERIFY_ARE_EQUAL(MOUSE_EVENT, batches.at(2).at(1).EventType);
+    VERIFY_ARE_EQUAL(static_cast<DWORD>(FROM_LEFT_1ST_BUTTON_PRESSED), batches.at(2).at(1).Event.MouseEvent.dwButtonState);
+    VERIFY_ARE_EQUAL((COORD{ 1, 2 }), batches.at(2).at(1).Event.MouseEvent.dwMousePosition);
+
+    Log::Comment(L"Any other input is written after the batched up events.");
+    batches.clear();
+    _stateMachine->ProcessString(L"\x1b[66;48;98;1;0;1_x");
+
+    VERIFY_ARE_EQUAL(2u, batches.size());
+    VERIFY_ARE_EQUAL(1u, batches.at(0).size());
+    VERIFY_ARE_EQUAL(L'b', batches.at(0).at(0).Event.KeyEvent.uChar.UnicodeChar);
+    VERIFY_IS_FALSE(batches.at(1).empty());
+    VERIFY_ARE_EQUAL(L'x', batches.at(1).at(0).Event.KeyEvent.uChar.UnicodeChar);
+}
@@ -1190,6 +1190,34 @@ public:
         return true;
     }
 
+    bool CopyRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right, const size_t page, const size_t dstTop, const size_t dstLeft, const size_t dstPage) override
+    {
+        _rectangularAreaOperation = L"DECCRA";
+        _rectangularAreaParameters = { top, left, bottom, right, page, dstTop, dstLeft, dstPage };
+        return true;
+    }
+
+    bool FillRectangularArea(const VTParameter ch, const size_t top, const size_t left, const size_t bottom, const size_t right) override
+    {
+        _rectangularAreaOperation = L"DECFRA";
+        _rectangularAreaParameters = { ch.value_or(0), top, left, bottom, right };
+        return true;
+    }
+
+    bool EraseRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right) override
+    {
+        _rectangularAreaOperation = L"DECERA";
+        _rectangularAreaParameters = { top, left, bottom, right };
+        return true;
+    }
+
+    bool SelectiveEraseRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right) override
+    {
+        _rectangularAreaOperation = L"DECSERA";
+        _rectangularAreaParameters = { top, left, bottom, right };
+        return true;
+    }
+
     bool SetGraphicsRendition(const VTParameters options) noexcept override
     try
     {
@@ -1541,6 +1569,8 @@ public:
     std::wstring _copyContent;
     std::wstring _uri;
     std::wstring _customId;
+    std::wstring _rectangularAreaOperation;
+    std::vector<size_t> _rectangularAreaParameters;
 
     static const size_t s_cMaxOptions = 16;
     static const size_t s_uiGraphicsCleared = UINT_MAX;
@@ -2133,6 +2163,49 @@ class StateMachineExternalTest final
         pDispatch->ClearState();
     }
 
+    TEST_METHOD(TestRectangularAreaOperations)
+    {
+        auto dispatch = std::make_unique<StatefulDispatch>();
+        auto pDispatch = dispatch.get();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"DECCRA with all of its parameters");
+        mach.ProcessString(L"\x1b[2;3;4;5;1;6;7;1$v");
+        VERIFY_ARE_EQUAL(L"DECCRA", pDispatch->_rectangularAreaOperation);
+        auto expected = std::vector<size_t>{ 2, 3, 4, 5, 1, 6, 7, 1 };
+        VERIFY_ARE_EQUAL(expected, pDispatch->_rectangularAreaParameters);
+        pDispatch->ClearState();
+
+        Log::Comment(L"An omitted bottom and right are passed on as 0, for the edge of the page");
+        mach.ProcessString(L"\x1b[$v");
+        VERIFY_ARE_EQUAL(L"DECCRA", pDispatch->_rectangularAreaOperation);
+        expected = std::vector<size_t>{ 1, 1, 0, 0, 1, 1, 1, 1 };
+        VERIFY_ARE_EQUAL(expected, pDispatch->_rectangularAreaParameters);
+        pDispatch->ClearState();
+
+        Log::Comment(L"DECFRA");
+        mach.ProcessString(L"\x1b[42;2;3;4;5$x");
+        VERIFY_ARE_EQUAL(L"DECFRA", pDispatch->_rectangularAreaOperation);
+        expected = std::vector<size_t>{ 42, 2, 3, 4, 5 };
+        VERIFY_ARE_EQUAL(expected, pDispatch->_rectangularAreaParameters);
+        pDispatch->ClearState();
+
+        Log::Comment(L"DECERA");
+        mach.ProcessString(L"\x1b[2;3;4;5$z");
+        VERIFY_ARE_EQUAL(L"DECERA", pDispatch->_rectangularAreaOperation);
+        expected = std::vector<size_t>{ 2, 3, 4, 5 };
+        VERIFY_ARE_EQUAL(expected, pDispatch->_rectangularAreaParameters);
+        pDispatch->ClearState();
+
+        Log::Comment(L"DECSERA");
+        mach.ProcessString(L"\x1b[;;4${");
+        VERIFY_ARE_EQUAL(L"DECSERA", pDispatch->_rectangularAreaOperation);
+        expected = std::vector<size_t>{ 1, 1, 4, 0 };
+        VERIFY_ARE_EQUAL(expected, pDispatch->_rectangularAreaParameters);
+        pDispatch->ClearState();
+    }
+
     void VerifyDispatchTypes(const gsl::span<const DispatchTypes::GraphicsOptions> expectedOptions,
                              const StatefulDispatch& dispatch)
     {
@@ -38,6 +38,8 @@ public:
         dcsId = 0;
         dcsParams.clear();
         dcsDataString.clear();
+        oscParameter = 0;
+        oscString.clear();
     }
 
     bool ActionExecute(const wchar_t wch) override
@@ -69,19 +71,23 @@ public:
     bool ActionIgnore() override { return true; };
 
     bool ActionOscDispatch(const wchar_t /* wch */,
-                           const size_t /* parameter */,
-                           const std::wstring_view /* string */) override
+                           const size_t parameter,
+                           const std::wstring_view string) override
     {
         if (pfnFlushToTerminal)
         {
             pfnFlushToTerminal();
             return true;
         }
+        oscParameter = parameter;
+        oscString = string;
         return true;
     };
 
     bool ActionSs3Dispatch(const wchar_t /* wch */, const VTParameters /* parameters */) override { return true; };
 
+    bool ActionEndOfString() override { return true; };
+
     // ActionCsiDispatch is the only method that's actually implemented.
     bool ActionCsiDispatch(const VTID id, const VTParameters parameters) override
     {
@@ -129,6 +135,10 @@ public:
     // Executed string.
     std::wstring executed;
 
+    // These will only be populated if ActionOscDispatch is called.
+    size_t oscParameter = 0;
+    std::wstring oscString;
+
     // These will only be populated if ActionDcsDispatch is called.
     uint64_t dcsId = 0;
     std::vector<size_t> dcsParams;
@@ -154,8 +164,10 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(PassThroughUnhandled);
     TEST_METHOD(RunStorageBeforeEscape);
     TEST_METHOD(BulkTextPrint);
+    TEST_METHOD(BulkTextPrintAroundControls);
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
 
+    TEST_METHOD(OscStringCollectedAcrossWrites);
     TEST_METHOD(DcsDataStringsReceivedByHandler);
 };
 
@@ -229,6 +241,36 @@ void StateMachineTest::BulkTextPrint()
     VERIFY_ARE_EQUAL(String(L"12345 Hello World"), String(engine.printed.c_str()));
 }
 
+void StateMachineTest::BulkTextPrintAroundControls()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // Runs of text are scanned for controls several characters at a time.
+    // Put controls at every offset within such a block, and right after it.
+    const std::wstring text{ L"0123456789abcdefghij" };
+    for (size_t offset = 0; offset <= 17; ++offset)
+    {
+        engine.ResetTestState();
+
+        auto input = text;
+        input.insert(offset, L"\r");
+        input.insert(offset + 3, L"\x1b[1;31;48;5;123m");
+        machine.ProcessString(input);
+
+        VERIFY_ARE_EQUAL(text, engine.printed);
+        VERIFY_ARE_EQUAL(L"\r", engine.executed);
+        VERIFY_ARE_EQUAL((std::vector<size_t>{ 1, 31, 48, 5, 123 }), engine.csiParams);
+    }
+
+    // Characters at or above U+8000 and those right outside of the C1 range are printable.
+    engine.ResetTestState();
+    machine.ProcessString(L"\x7e\xa0\x8000\xffff\x7e\xa0\x8000\xffff\x9f");
+    VERIFY_ARE_EQUAL(L"\x7e\xa0\x8000\xffff\x7e\xa0\x8000\xffff", engine.printed);
+}
+
 void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
 {
     auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
@@ -275,6 +317,32 @@ void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
     VERIFY_ARE_EQUAL(L"", engine.printed);
 }
 
+void StateMachineTest::OscStringCollectedAcrossWrites()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // The string is collected in runs between control characters, which are ignored (\x01),
+    // while DEL and everything else is part of the string.
+    machine.ProcessString(L"\x1b]52;c;SGVsbG8");
+    machine.ProcessString(L"gV29y\x01"
+                          L"bGQ\x7f=");
+    VERIFY_ARE_EQUAL(L"", engine.oscString); // nothing out yet
+    machine.ProcessString(L"=\x1b\\after");
+
+    VERIFY_ARE_EQUAL(52u, engine.oscParameter);
+    VERIFY_ARE_EQUAL(L"c;SGVsbG8gV29ybGQ\x7f==", engine.oscString);
+    VERIFY_ARE_EQUAL(L"after", engine.printed);
+
+    // The next string starts out empty again.
+    engine.ResetTestState();
+    machine.ProcessString(L"\x1b]0;title\x07");
+    VERIFY_ARE_EQUAL(0u, engine.oscParameter);
+    VERIFY_ARE_EQUAL(L"title", engine.oscString);
+}
+
 void StateMachineTest::DcsDataStringsReceivedByHandler()
 {
     BEGIN_TEST_METHOD_PROPERTIES()
@@ -625,6 +625,18 @@ class BitmapTests
         expectedSet.emplace_back(setZone);
         _checkBits(expectedSet, bitmap);
 
+        Log::Comment(L"Reset a rectangle of bits inside of it.");
+        // 1 1 0 0       |1 1|0 0
+        // 1 1 0 0  --\   0 0 0 0
+        // 1 1 0 0  --/  |1 1|0 0
+        // 0 0 0 0        0 0 0 0
+        bitmap.reset(til::rect{ til::point{ 0, 1 }, til::size{ 4, 1 } });
+
+        expectedSet.clear();
+        expectedSet.emplace_back(til::rect{ til::point{ 0, 0 }, til::size{ 2, 1 } });
+        expectedSet.emplace_back(til::rect{ til::point{ 0, 2 }, til::size{ 2, 1 } });
+        _checkBits(expectedSet, bitmap);
+
         Log::Comment(L"Reset all.");
         bitmap.reset_all();
 
@@ -962,6 +974,39 @@ class BitmapTests
         VERIFY_ARE_EQUAL(expected, actual);
     }
 
+    TEST_METHOD(RunsWhenFull)
+    {
+        // Wider than a block of the underlying bitset, so that rows don't start at block boundaries.
+        const til::size sz{ 100, 3 };
+        til::bitmap map{ sz };
+
+        Log::Comment(L"Set whole rows, which are contiguous in the bitset.");
+        map.set(til::rect{ 0, 1, 100, 3 });
+
+        std::vector<til::rect> expected;
+        expected.emplace_back(til::rect{ 0, 1, 100, 2 });
+        expected.emplace_back(til::rect{ 0, 2, 100, 3 });
+        VERIFY_ARE_EQUAL(expected, std::vector<til::rect>(map.runs().begin(), map.runs().end()));
+        _checkBits(expected, map);
+
+        Log::Comment(L"Filling the last row makes every row a single run.");
+        map.set(til::rect{ 0, 0, 100, 1 });
+        VERIFY_IS_TRUE(map.all());
+
+        expected.clear();
+        expected.emplace_back(til::rect{ 0, 0, 100, 1 });
+        expected.emplace_back(til::rect{ 0, 1, 100, 2 });
+        expected.emplace_back(til::rect{ 0, 2, 100, 3 });
+        VERIFY_ARE_EQUAL(expected, std::vector<til::rect>(map.runs().begin(), map.runs().end()));
+
+        Log::Comment(L"Resetting whole rows clears just those.");
+        map.reset(til::rect{ 0, 0, 100, 2 });
+
+        expected.erase(expected.begin(), expected.begin() + 2);
+        VERIFY_ARE_EQUAL(expected, std::vector<til::rect>(map.runs().begin(), map.runs().end()));
+        _checkBits(expected, map);
+    }
+
     TEST_METHOD(RunsWithPmr)
     {
         // This is a copy of the above test, but with a pmr::bitmap.
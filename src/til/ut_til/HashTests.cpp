@@ -0,0 +1,135 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+#include <til/hash.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class HashTests
+{
+    TEST_CLASS(HashTests);
+
+    static size_t _hash(const std::vector<uint8_t>& data, const size_t count, const size_t seed = 0)
+    {
+        til::hasher h{ seed };
+        h.write(data.data(), count);
+        return h.finalize();
+    }
+
+    // Every prefix of the same data takes a different path through hasher::write()
+    // (1-3, 4-16, 17-48 and more than 48 bytes), all of which have to see every byte.
+    static std::vector<uint8_t> _data()
+    {
+        std::vector<uint8_t> data(256);
+        uint32_t state = 0x12345678;
+        for (auto& b : data)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            b = static_cast<uint8_t>(state);
+        }
+        return data;
+    }
+
+    TEST_METHOD(IsDeterministic)
+    {
+        const auto data = _data();
+        for (size_t count = 0; count <= data.size(); ++count)
+        {
+            VERIFY_ARE_EQUAL(_hash(data, count), _hash(data, count));
+        }
+
+        VERIFY_ARE_EQUAL(til::hash(std::wstring{ L"foo" }), til::hash(std::wstring_view{ L"foo" }));
+        VERIFY_ARE_EQUAL(til::hash(0.0f), til::hash(-0.0f));
+    }
+
+    TEST_METHOD(DependsOnTheLengthAndTheSeed)
+    {
+        const auto data = _data();
+        std::unordered_set<size_t> hashes;
+        for (size_t count = 0; count <= data.size(); ++count)
+        {
+            VERIFY_IS_TRUE(hashes.emplace(_hash(data, count)).second);
+            VERIFY_IS_TRUE(hashes.emplace(_hash(data, count, 1)).second);
+        }
+
+        // Zeroes must not hash the same as fewer zeroes.
+        const std::vector<uint8_t> zeroes(64);
+        hashes.clear();
+        for (size_t count = 0; count <= zeroes.size(); ++count)
+        {
+            VERIFY_IS_TRUE(hashes.emplace(_hash(zeroes, count)).second);
+        }
+    }
+
+    TEST_METHOD(DependsOnEveryBit)
+    {
+        auto data = _data();
+        for (const size_t count : { 1, 2, 3, 4, 7, 8, 15, 16, 17, 48, 49, 96, 97, 255 })
+        {
+            const auto expected = _hash(data, count);
+            for (size_t i = 0; i < count * 8; ++i)
+            {
+                data[i / 8] ^= static_cast<uint8_t>(1 << (i % 8));
+                const auto actual = _hash(data, count);
+                data[i / 8] ^= static_cast<uint8_t>(1 << (i % 8));
+
+                if (actual == expected)
+                {
+                    VERIFY_FAIL(NoThrowString().Format(L"flipping bit %zu of %zu bytes didn't change the hash", i, count));
+                }
+            }
+        }
+    }
+
+    TEST_METHOD(WorksAsHashOfUnorderedMap)
+    {
+        std::unordered_map<std::wstring, int, til::hash_functor<std::wstring>> map;
+        map.emplace(L"https://example.com", 1);
+        map.emplace(L"https://example.org", 2);
+        VERIFY_ARE_EQUAL(1, map.at(L"https://example.com"));
+        VERIFY_ARE_EQUAL(2, map.at(L"https://example.org"));
+        VERIFY_ARE_EQUAL(0u, map.count(L"https://example.net"));
+    }
+
+    // Compares the throughput of til::hasher with the FNV-1a hash of std::hash.
+    // It's ignored by default, as it only logs its results. Run it with:
+    //   te.exe til.unit.tests.dll /name:HashTests::Benchmark /runIgnoredTests
+    BEGIN_TEST_METHOD(Benchmark)
+        TEST_METHOD_PROPERTY(L"Ignore", L"true")
+    END_TEST_METHOD()
+};
+
+void HashTests::Benchmark()
+{
+    const auto data = _data();
+
+    for (const size_t count : { 4, 16, 32, 64, 256 })
+    {
+        static constexpr size_t iterations = 1 << 20;
+        size_t sink = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            sink += _hash(data, count, i);
+        }
+        const auto mid = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            sink += std::_Fnv1a_append_bytes(i, data.data(), count);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto ns = [](const auto duration) {
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) / iterations;
+        };
+        Log::Comment(NoThrowString().Format(L"%3zu bytes: til::hasher %6.2f ns, FNV-1a %6.2f ns (%zx)", count, ns(mid - start), ns(end - mid), sink));
+    }
+}
@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class PmrTests
+{
+    TEST_CLASS(PmrTests);
+
+    // Counts the blocks the arena allocates from its upstream resource.
+    struct counting_resource : std::pmr::memory_resource
+    {
+        size_t allocations = 0;
+        size_t outstanding = 0;
+
+    private:
+        void* do_allocate(const size_t bytes, const size_t align) override
+        {
+            ++allocations;
+            ++outstanding;
+            return til::pmr::get_default_resource()->allocate(bytes, align);
+        }
+
+        void do_deallocate(void* const ptr, const size_t bytes, const size_t align) noexcept override
+        {
+            --outstanding;
+            til::pmr::get_default_resource()->deallocate(ptr, bytes, align);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    TEST_METHOD(AllocationsAreAlignedAndDistinct)
+    {
+        til::pmr::arena arena;
+
+        const auto a = static_cast<uint8_t*>(arena.allocate(3, 1));
+        const auto b = static_cast<uint8_t*>(arena.allocate(8, 8));
+        const auto c = static_cast<uint8_t*>(arena.allocate(64, 64));
+        const auto d = static_cast<uint8_t*>(arena.allocate(100000, 16));
+
+        VERIFY_ARE_EQUAL(0u, reinterpret_cast<uintptr_t>(b) % 8);
+        VERIFY_ARE_EQUAL(0u, reinterpret_cast<uintptr_t>(c) % 64);
+        VERIFY_ARE_EQUAL(0u, reinterpret_cast<uintptr_t>(d) % 16);
+        VERIFY_IS_TRUE(a + 3 <= b);
+        VERIFY_IS_TRUE(b + 8 <= c);
+
+        // All of the memory has to be usable.
+        memset(a, 1, 3);
+        memset(b, 2, 8);
+        memset(c, 3, 64);
+        memset(d, 4, 100000);
+        VERIFY_ARE_EQUAL(1, a[2]);
+        VERIFY_ARE_EQUAL(2, b[7]);
+        VERIFY_ARE_EQUAL(3, c[63]);
+    }
+
+    TEST_METHOD(ResetReusesTheMemory)
+    {
+        counting_resource upstream;
+        {
+            til::pmr::arena arena{ &upstream };
+
+            const auto first = arena.allocate(16, 8);
+            arena.reset();
+            VERIFY_ARE_EQUAL(first, arena.allocate(16, 8));
+            VERIFY_ARE_EQUAL(1u, upstream.allocations);
+        }
+        VERIFY_ARE_EQUAL(0u, upstream.outstanding);
+    }
+
+    TEST_METHOD(ResetCoalescesTheBlocksOfACycle)
+    {
+        counting_resource upstream;
+        {
+            til::pmr::arena arena{ &upstream };
+            std::pmr::vector<int> values{ &arena };
+
+            // A vector that grows allocates several times its final size in total.
+            const auto cycle = [&]() {
+                values = std::pmr::vector<int>{ &arena };
+                for (auto i = 0; i < 100000; ++i)
+                {
+                    values.emplace_back(i);
+                }
+                VERIFY_ARE_EQUAL(99999, values.back());
+            };
+
+            cycle();
+            VERIFY_IS_GREATER_THAN(upstream.allocations, 1u);
+
+            // The vector must not outlive the cycle that allocated it.
+            values = std::pmr::vector<int>{ &arena };
+            arena.reset();
+            const auto allocations = upstream.allocations;
+            VERIFY_ARE_EQUAL(1u, upstream.outstanding);
+
+            for (auto i = 0; i < 3; ++i)
+            {
+                cycle();
+                values = std::pmr::vector<int>{ &arena };
+                arena.reset();
+            }
+            VERIFY_ARE_EQUAL(allocations, upstream.allocations);
+        }
+        VERIFY_ARE_EQUAL(0u, upstream.outstanding);
+    }
+};
@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+#include <til/seqlock.h>
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class SeqlockTests
+{
+    TEST_CLASS(SeqlockTests);
+
+    struct Pair
+    {
+        uint64_t a;
+        uint64_t b;
+    };
+
+    TEST_METHOD(LoadsTheLastStoredValue)
+    {
+        til::seqlock<Pair> lock;
+        Pair value{ 1, 1 };
+
+        VERIFY_IS_TRUE(lock.try_load(value));
+        VERIFY_ARE_EQUAL(0u, value.a);
+        VERIFY_ARE_EQUAL(0u, value.b);
+
+        lock.store({ 1, 2 });
+        lock.store({ 3, 4 });
+        VERIFY_IS_TRUE(lock.try_load(value));
+        VERIFY_ARE_EQUAL(3u, value.a);
+        VERIFY_ARE_EQUAL(4u, value.b);
+    }
+
+    TEST_METHOD(NeverLoadsTornValues)
+    {
+        til::seqlock<Pair> lock;
+        std::atomic<bool> done{ false };
+
+        std::thread writer{ [&]() {
+            for (uint64_t i = 0; i < 1000000; ++i)
+            {
+                lock.store({ i, ~i });
+            }
+            done.store(true, std::memory_order_relaxed);
+        } };
+
+        size_t loads = 0;
+        while (!done.load(std::memory_order_relaxed))
+        {
+            Pair value;
+            if (lock.try_load(value))
+            {
+                ++loads;
+                if (value.a != ~value.b && (value.a | value.b) != 0)
+                {
+                    writer.join();
+                    VERIFY_FAIL(L"try_load() returned a torn value");
+                }
+            }
+        }
+
+        writer.join();
+        Log::Comment(NoThrowString().Format(L"%zu successful loads", loads));
+    }
+};
@@ -17,6 +17,7 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestAsciiRuns);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +192,45 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestAsciiRuns()
+{
+    // The leading ASCII run is converted 16 characters at a time,
+    // so test runs of all lengths around that, followed by non-ASCII.
+    for (size_t length = 0; length < 40; ++length)
+    {
+        std::string u8String;
+        std::wstring u16String;
+        for (size_t i = 0; i < length; ++i)
+        {
+            u8String.push_back(static_cast<char>(0x20 + i % 0x5f));
+            u16String.push_back(static_cast<wchar_t>(0x20 + i % 0x5f));
+        }
+
+        std::wstring u16Out;
+        VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out));
+        VERIFY_ARE_EQUAL(u16String, u16Out);
+
+        std::string u8Out;
+        VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+        VERIFY_ARE_EQUAL(u8String, u8Out);
+
+        // EURO SIGN, then more ASCII, which is converted by the platform.
+        u8String.append("\xE2\x82\xAC" "abcdefghijklmnopqrstuvwxyz");
+        u16String.append(L"\x20AC" L"abcdefghijklmnopqrstuvwxyz");
+
+        VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out));
+        VERIFY_ARE_EQUAL(u16String, u16Out);
+
+        VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out));
+        VERIFY_ARE_EQUAL(u8String, u8Out);
+
+        til::u8state u8State{};
+        VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out, u8State));
+        VERIFY_ARE_EQUAL(u16String, u16Out);
+
+        til::u16state u16State{};
+        VERIFY_SUCCEEDED(til::u16u8(u16String, u8Out, u16State));
+        VERIFY_ARE_EQUAL(u8String, u8Out);
+    }
+}
@@ -0,0 +1,171 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "BenchRenderData.hpp"
+
+#include <DefaultSettings.h>
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+BenchRenderData::BenchRenderData(const COORD viewportSize, const SHORT bufferHeight) :
+    _viewportSize{ viewportSize },
+    _bufferHeight{ bufferHeight },
+    _actualFont{ L"Consolas", 0, DEFAULT_FONT_WEIGHT, { 0, 14 }, CP_UTF8, false }
+{
+}
+
+// Method Description:
+// - Creates the text buffer. Like Terminal::Create, this happens after the
+//   Renderer was constructed, because the buffer notifies it of every change.
+// Arguments:
+// - renderTarget - the Renderer that paints this data
+void BenchRenderData::Create(IRenderTarget& renderTarget)
+{
+    _buffer = std::make_unique<TextBuffer>(COORD{ _viewportSize.X, _bufferHeight }, TextAttribute{}, 25u, renderTarget);
+}
+
+TextBuffer& BenchRenderData::Buffer() noexcept
+{
+    return *_buffer;
+}
+
+FontInfo& BenchRenderData::ActualFont() noexcept
+{
+    return _actualFont;
+}
+
+void BenchRenderData::SetViewportTop(const SHORT top) noexcept
+{
+    _viewportTop = top;
+}
+
+void BenchRenderData::SetCursor(const COORD position, const bool on) noexcept
+{
+    _cursorPosition = position;
+    _cursorOn = on;
+}
+
+void BenchRenderData::SetSelection(std::optional<SMALL_RECT> selection) noexcept
+{
+    _selection = selection;
+}
+
+#pragma region IBaseData
+
+Viewport BenchRenderData::GetViewport() noexcept
+{
+    return Viewport::FromDimensions({ 0, _viewportTop }, _viewportSize);
+}
+
+COORD BenchRenderData::GetTextBufferEndPosition() const noexcept
+{
+    return { gsl::narrow_cast<SHORT>(_viewportSize.X - 1), gsl::narrow_cast<SHORT>(_viewportTop + _viewportSize.Y - 1) };
+}
+
+const TextBuffer& BenchRenderData::GetTextBuffer() noexcept
+{
+    return *_buffer;
+}
+
+const FontInfo& BenchRenderData::GetFontInfo() noexcept
+{
+    return _actualFont;
+}
+
+gsl::span<const Viewport> BenchRenderData::GetSelectionRects() noexcept
+try
+{
+    _selectionRects.clear();
+    if (_selection)
+    {
+        _selectionRects.emplace_back(Viewport::FromInclusive(*_selection));
+    }
+    return _selectionRects;
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return {};
+}
+
+// The scenes run on the same thread as the Renderer, so there's nothing to lock.
+void BenchRenderData::LockConsole() noexcept
+{
+}
+
+void BenchRenderData::UnlockConsole() noexcept
+{
+}
+
+#pragma endregion
+
+#pragma region IRenderData
+
+COORD BenchRenderData::GetCursorPosition() const noexcept
+{
+    return _cursorPosition;
+}
+
+bool BenchRenderData::IsCursorVisible() const noexcept
+{
+    return true;
+}
+
+bool BenchRenderData::IsCursorOn() const noexcept
+{
+    return _cursorOn;
+}
+
+ULONG BenchRenderData::GetCursorHeight() const noexcept
+{
+    return 25;
+}
+
+CursorType BenchRenderData::GetCursorStyle() const noexcept
+{
+    return CursorType::Legacy;
+}
+
+ULONG BenchRenderData::GetCursorPixelWidth() const noexcept
+{
+    return 1;
+}
+
+bool BenchRenderData::IsCursorDoubleWidth() const
+{
+    return false;
+}
+
+gsl::span<const RenderOverlay> BenchRenderData::GetOverlays() const noexcept
+{
+    return {};
+}
+
+const bool BenchRenderData::IsGridLineDrawingAllowed() noexcept
+{
+    return true;
+}
+
+const std::wstring_view BenchRenderData::GetConsoleTitle() const noexcept
+{
+    return L"renderbench";
+}
+
+const std::wstring BenchRenderData::GetHyperlinkUri(uint16_t /*id*/) const noexcept
+{
+    return {};
+}
+
+const std::wstring BenchRenderData::GetHyperlinkCustomId(uint16_t /*id*/) const noexcept
+{
+    return {};
+}
+
+gsl::span<const size_t> BenchRenderData::GetPatternId(const COORD /*location*/) const noexcept
+{
+    return {};
+}
+
+#pragma endregion
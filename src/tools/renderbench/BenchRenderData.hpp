@@ -0,0 +1,70 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- BenchRenderData.hpp
+
+Abstract:
+- A synthetic IRenderData for renderbench: a text buffer with a viewport,
+  a cursor and a block selection that the scenes manipulate directly,
+  without a console or a terminal behind them.
+--*/
+
+#pragma once
+
+#include "../../renderer/inc/IRenderData.hpp"
+#include "../../renderer/inc/FontInfo.hpp"
+#include "../../buffer/out/textBuffer.hpp"
+
+class BenchRenderData final : public Microsoft::Console::Render::IRenderData
+{
+public:
+    BenchRenderData(const COORD viewportSize, const SHORT bufferHeight);
+
+    void Create(Microsoft::Console::Render::IRenderTarget& renderTarget);
+
+    TextBuffer& Buffer() noexcept;
+    FontInfo& ActualFont() noexcept;
+    void SetViewportTop(const SHORT top) noexcept;
+    void SetCursor(const COORD position, const bool on) noexcept;
+    void SetSelection(std::optional<SMALL_RECT> selection) noexcept;
+
+#pragma region IBaseData
+    Microsoft::Console::Types::Viewport GetViewport() noexcept override;
+    COORD GetTextBufferEndPosition() const noexcept override;
+    const TextBuffer& GetTextBuffer() noexcept override;
+    const FontInfo& GetFontInfo() noexcept override;
+    gsl::span<const Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept override;
+    void LockConsole() noexcept override;
+    void UnlockConsole() noexcept override;
+#pragma endregion
+
+#pragma region IRenderData
+    COORD GetCursorPosition() const noexcept override;
+    bool IsCursorVisible() const noexcept override;
+    bool IsCursorOn() const noexcept override;
+    ULONG GetCursorHeight() const noexcept override;
+    CursorType GetCursorStyle() const noexcept override;
+    ULONG GetCursorPixelWidth() const noexcept override;
+    bool IsCursorDoubleWidth() const override;
+    gsl::span<const Microsoft::Console::Render::RenderOverlay> GetOverlays() const noexcept override;
+    const bool IsGridLineDrawingAllowed() noexcept override;
+    const std::wstring_view GetConsoleTitle() const noexcept override;
+    const std::wstring GetHyperlinkUri(uint16_t id) const noexcept override;
+    const std::wstring GetHyperlinkCustomId(uint16_t id) const noexcept override;
+    gsl::span<const size_t> GetPatternId(const COORD location) const noexcept override;
+#pragma endregion
+
+private:
+    COORD _viewportSize;
+    SHORT _bufferHeight;
+    SHORT _viewportTop{ 0 };
+    std::unique_ptr<TextBuffer> _buffer;
+    FontInfo _actualFont;
+
+    COORD _cursorPosition{};
+    bool _cursorOn{ true };
+    std::optional<SMALL_RECT> _selection;
+    std::vector<Microsoft::Console::Types::Viewport> _selectionRects;
+};
@@ -0,0 +1,433 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// renderbench paints scripted scenes with each of our render engines and
+// measures the cost of every frame. See README.md for its usage.
+//
+// The scenes drive a Renderer with a BenchRenderData directly, without a
+// render thread: every frame is painted and presented synchronously, so that
+// it can be timed.
+
+#include "pch.h"
+#include "BenchRenderData.hpp"
+
+#include <DefaultSettings.h>
+#include <random>
+
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/gdi/gdirenderer.hpp"
+
+#if TIL_FEATURE_ATLASENGINE_ENABLED
+#include "../../renderer/atlas/AtlasEngine.h"
+#endif
+#if TIL_FEATURE_CONHOSTDXENGINE_ENABLED
+#include "../../renderer/dx/DxRenderer.hpp"
+#endif
+
+using namespace Microsoft::Console::Render;
+
+static constexpr COORD ViewportSize{ 120, 30 };
+// The scroll scene moves the viewport down by a row per frame through this many rows.
+static constexpr SHORT BufferHeight{ 1000 + ViewportSize.Y };
+
+// Every C++ allocation made by the engines goes through here, because they're
+// linked statically into renderbench. That's how allocations per frame are counted.
+static std::atomic<size_t> s_allocations{ 0 };
+
+// Allocation tracking builds replace operator new already. Their allocations
+// per frame are in the trace instead, and reported as 0 here.
+#ifndef ALLOCATION_TRACKING_BUILD
+void* __CRTDECL operator new(const size_t size)
+{
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto p = malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void __CRTDECL operator delete(void* const p) noexcept
+{
+    free(p);
+}
+#endif
+
+static LARGE_INTEGER _Now() noexcept
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now;
+}
+
+static double _SecondsBetween(const LARGE_INTEGER begin, const LARGE_INTEGER end) noexcept
+{
+    static const auto frequency = [] {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return static_cast<double>(f.QuadPart);
+    }();
+    return static_cast<double>(end.QuadPart - begin.QuadPart) / frequency;
+}
+
+// Return Value:
+// - The user and kernel time spent by the current thread, in 100ns units.
+static uint64_t _ThreadCpuTime() noexcept
+{
+    FILETIME creationTime, exitTime, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernel, &user))
+    {
+        return 0;
+    }
+    const auto ticks = [](const FILETIME& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    };
+    return ticks(kernel) + ticks(user);
+}
+
+#pragma region Scenes
+
+static void _WriteLine(TextBuffer& buffer, const SHORT y, const std::wstring_view text, const TextAttribute& attr = {})
+{
+    buffer.WriteLine(OutputCellIterator{ text, attr }, { 0, y });
+}
+
+// - Fills the whole buffer with plain text, which is where every scene starts from.
+static void _FillText(TextBuffer& buffer)
+{
+    static constexpr std::wstring_view sentence{ L"The quick brown fox jumps over the lazy dog. " };
+
+    std::wstring line;
+    for (SHORT y = 0; y < BufferHeight; ++y)
+    {
+        line = fmt::format(L"{:>5}: ", y);
+        while (line.size() < static_cast<size_t>(ViewportSize.X))
+        {
+            line.append(sentence);
+        }
+        line.resize(ViewportSize.X);
+        _WriteLine(buffer, y, line);
+    }
+}
+
+// - Moves the viewport down by a row, like a program that keeps printing lines.
+static void _SceneScroll(BenchRenderData& data, Renderer& renderer, const int frame)
+{
+    data.SetViewportTop(gsl::narrow_cast<SHORT>((frame + 1) % (BufferHeight - ViewportSize.Y + 1)));
+    renderer.TriggerScroll();
+}
+
+// - Changes a few cells in random places, like a TUI updating its widgets.
+static void _SceneCells(BenchRenderData& data, Renderer& /*renderer*/, const int /*frame*/)
+{
+    static std::minstd_rand rng{ 1 };
+
+    auto& buffer = data.Buffer();
+    for (auto i = 0; i < 64; ++i)
+    {
+        const auto value = rng();
+        TextAttribute attr;
+        attr.SetIndexedForeground256(gsl::narrow_cast<BYTE>(value >> 16));
+        const auto ch = gsl::narrow_cast<wchar_t>(L'!' + value % 94);
+        const COORD target{ gsl::narrow_cast<SHORT>(value % ViewportSize.X), gsl::narrow_cast<SHORT>((value >> 8) % ViewportSize.Y) };
+        buffer.Write(OutputCellIterator{ ch, attr, 1 }, target);
+    }
+}
+
+// - Replaces the viewport with a page of wide glyphs, alternating between CJK and emoji.
+static void _SceneWide(BenchRenderData& data, Renderer& /*renderer*/, const int frame)
+{
+    auto& buffer = data.Buffer();
+    std::wstring line;
+    for (SHORT y = 0; y < ViewportSize.Y; ++y)
+    {
+        line.clear();
+        for (auto x = 0; x < ViewportSize.X / 2; ++x)
+        {
+            if (frame & 1)
+            {
+                // U+1F600..U+1F64F, the emoticons, are all wide.
+                const auto codepoint = 0x1F600 + (x + y + frame) % 0x50;
+                line.push_back(gsl::narrow_cast<wchar_t>(0xD800 + ((codepoint - 0x10000) >> 10)));
+                line.push_back(gsl::narrow_cast<wchar_t>(0xDC00 + ((codepoint - 0x10000) & 0x3FF)));
+            }
+            else
+            {
+                line.push_back(gsl::narrow_cast<wchar_t>(0x4E00 + (x + y * ViewportSize.X + frame) % 0x5000));
+            }
+        }
+        _WriteLine(buffer, y, line);
+    }
+}
+
+// - Replaces the viewport with text where every cell has a different set of colors
+//   and attributes, which defeats batching of runs with the same attributes.
+static void _SceneAttributes(BenchRenderData& data, Renderer& /*renderer*/, const int frame)
+{
+    auto& buffer = data.Buffer();
+    for (SHORT y = 0; y < ViewportSize.Y; ++y)
+    {
+        for (SHORT x = 0; x < ViewportSize.X; ++x)
+        {
+            TextAttribute attr;
+            attr.SetIndexedForeground256(gsl::narrow_cast<BYTE>(x + y + frame));
+            attr.SetIndexedBackground256(gsl::narrow_cast<BYTE>(x * 7 + y * 3 + frame));
+            attr.SetIntense(x % 2 == 0);
+            attr.SetItalic(x % 3 == 0);
+            attr.SetUnderlined(x % 5 == 0);
+            const auto ch = gsl::narrow_cast<wchar_t>(L'a' + (x + frame) % 26);
+            buffer.Write(OutputCellIterator{ ch, attr, 1 }, { x, y });
+        }
+    }
+}
+
+// - Grows a block selection from the top left corner, like a mouse drag.
+static void _SceneSelection(BenchRenderData& data, Renderer& renderer, const int frame)
+{
+    const auto right = gsl::narrow_cast<SHORT>(frame % ViewportSize.X);
+    const auto bottom = gsl::narrow_cast<SHORT>(frame % ViewportSize.Y);
+    data.SetSelection(SMALL_RECT{ 0, 0, right, bottom });
+    renderer.TriggerSelection();
+}
+
+// - Toggles the cursor, which is all that's painted while it blinks.
+static void _SceneCursor(BenchRenderData& data, Renderer& renderer, const int frame)
+{
+    const COORD position{ 0, ViewportSize.Y - 1 };
+    data.SetCursor(position, frame % 2 == 0);
+    renderer.TriggerRedrawCursor(&position);
+}
+
+struct Scene
+{
+    std::wstring_view name;
+    void (*frame)(BenchRenderData& data, Renderer& renderer, const int frame);
+};
+
+static constexpr std::array<Scene, 6> Scenes{ {
+    { L"scroll", _SceneScroll },
+    { L"cells", _SceneCells },
+    { L"wide", _SceneWide },
+    { L"attributes", _SceneAttributes },
+    { L"selection", _SceneSelection },
+    { L"cursor", _SceneCursor },
+} };
+
+#pragma endregion
+
+#pragma region Engines
+
+struct Engine
+{
+    std::wstring_view name;
+    std::unique_ptr<IRenderEngine> (*create)();
+};
+
+static constexpr std::array Engines{
+    Engine{ L"gdi", []() -> std::unique_ptr<IRenderEngine> { return std::make_unique<GdiEngine>(); } },
+#if TIL_FEATURE_CONHOSTDXENGINE_ENABLED
+    Engine{ L"dx", []() -> std::unique_ptr<IRenderEngine> { return std::make_unique<DxEngine>(); } },
+#endif
+#if TIL_FEATURE_ATLASENGINE_ENABLED
+    Engine{ L"atlas", []() -> std::unique_ptr<IRenderEngine> { return std::make_unique<AtlasEngine>(); } },
+#endif
+};
+
+#pragma endregion
+
+static wil::unique_hwnd _CreateWindow()
+{
+    static const auto windowClass = [] {
+        WNDCLASSEXW wc{};
+        wc.cbSize = sizeof(wc);
+        wc.lpfnWndProc = DefWindowProcW;
+        wc.hInstance = GetModuleHandleW(nullptr);
+        wc.hCursor = LoadCursorW(nullptr, IDC_ARROW);
+        wc.lpszClassName = L"renderbench";
+        return RegisterClassExW(&wc);
+    }();
+    THROW_LAST_ERROR_IF(!windowClass);
+
+    wil::unique_hwnd hwnd{ CreateWindowExW(0, MAKEINTATOM(windowClass), L"renderbench", WS_OVERLAPPEDWINDOW | WS_VISIBLE, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, CW_USEDEFAULT, nullptr, nullptr, GetModuleHandleW(nullptr), nullptr) };
+    THROW_LAST_ERROR_IF(!hwnd);
+    return hwnd;
+}
+
+static void _PumpMessages() noexcept
+{
+    MSG msg;
+    while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE))
+    {
+        TranslateMessage(&msg);
+        DispatchMessageW(&msg);
+    }
+}
+
+// - Paints `frames` frames of every scene in `scenes` with the given engine,
+//   and prints one JSON object with the results per scene.
+static void _BenchmarkEngine(const Engine& engineInfo, const std::vector<const Scene*>& scenes, const int frames)
+{
+    const auto hwnd = _CreateWindow();
+    const auto engine = engineInfo.create();
+
+    const RenderSettings renderSettings;
+    BenchRenderData data{ ViewportSize, BufferHeight };
+    Renderer renderer{ renderSettings, &data, nullptr, 0, nullptr };
+    data.Create(renderer);
+
+    THROW_IF_FAILED(engine->SetHwnd(hwnd.get()));
+    THROW_IF_FAILED(engine->Enable());
+    renderer.AddRenderEngine(engine.get());
+
+    const FontInfoDesired desiredFont{ L"Consolas", 0, DEFAULT_FONT_WEIGHT, { 0, 14 }, CP_UTF8 };
+    renderer.TriggerFontChange(USER_DEFAULT_SCREEN_DPI, desiredFont, data.ActualFont());
+
+    // Size the window to fit the viewport exactly.
+    const auto cellSize = data.ActualFont().GetSize();
+    const SIZE pixels{ ViewportSize.X * cellSize.X, ViewportSize.Y * cellSize.Y };
+    RECT rect{ 0, 0, pixels.cx, pixels.cy };
+    THROW_IF_WIN32_BOOL_FALSE(AdjustWindowRectEx(&rect, WS_OVERLAPPEDWINDOW, FALSE, 0));
+    THROW_IF_WIN32_BOOL_FALSE(SetWindowPos(hwnd.get(), nullptr, 0, 0, rect.right - rect.left, rect.bottom - rect.top, SWP_NOMOVE | SWP_NOZORDER));
+    // GdiEngine gets its size from the window itself and doesn't implement this.
+    (void)engine->SetWindowSize(pixels);
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(frames);
+
+    for (const auto scene : scenes)
+    {
+        data.SetViewportTop(0);
+        data.SetCursor({ 0, 0 }, true);
+        data.SetSelection(std::nullopt);
+        _FillText(data.Buffer());
+        renderer.TriggerScroll();
+        renderer.TriggerSelection();
+        renderer.TriggerRedrawAll();
+        _PumpMessages();
+        renderer.WaitUntilCanRender();
+        LOG_IF_FAILED(renderer.PaintFrame());
+
+        frameTimes.clear();
+        double waitTime = 0;
+        uint64_t cpuTime = 0;
+        size_t allocations = 0;
+
+        for (auto frame = 0; frame < frames; ++frame)
+        {
+            _PumpMessages();
+            scene->frame(data, renderer, frame);
+
+            // The time spent waiting for the swap chain to accept another frame
+            // isn't part of the frame. It's the GPU (or vsync) holding us back.
+            const auto waitBegin = _Now();
+            renderer.WaitUntilCanRender();
+            const auto begin = _Now();
+            const auto cpuBegin = _ThreadCpuTime();
+            const auto allocationsBegin = s_allocations.load(std::memory_order_relaxed);
+
+            LOG_IF_FAILED(renderer.PaintFrame());
+
+            const auto end = _Now();
+            allocations += s_allocations.load(std::memory_order_relaxed) - allocationsBegin;
+            cpuTime += _ThreadCpuTime() - cpuBegin;
+            waitTime += _SecondsBetween(waitBegin, begin);
+            frameTimes.emplace_back(_SecondsBetween(begin, end) * 1e6);
+        }
+
+        std::sort(frameTimes.begin(), frameTimes.end());
+        const auto percentile = [&](const double p) {
+            return frameTimes.empty() ? 0.0 : frameTimes[std::min(frameTimes.size() - 1, static_cast<size_t>(p * frameTimes.size()))];
+        };
+
+        printf("{\"benchmark\":\"render\",\"engine\":\"%ls\",\"scene\":\"%ls\",\"frames\":%d,\"p50Microseconds\":%.1f,\"p90Microseconds\":%.1f,\"p99Microseconds\":%.1f,\"maxMicroseconds\":%.1f,\"cpuMicrosecondsPerFrame\":%.1f,\"waitMicrosecondsPerFrame\":%.1f,\"allocationsPerFrame\":%.1f}\n",
+               engineInfo.name.data(),
+               scene->name.data(),
+               frames,
+               percentile(0.5),
+               percentile(0.9),
+               percentile(0.99),
+               frameTimes.empty() ? 0.0 : frameTimes.back(),
+               static_cast<double>(cpuTime) / 10.0 / frames,
+               waitTime * 1e6 / frames,
+               static_cast<double>(allocations) / frames);
+        fflush(stdout);
+    }
+}
+
+static int _Usage()
+{
+    fprintf(stderr,
+            "usage:\n"
+            "  renderbench [--engine <name>] [--scene <name>] [--frames <count>]\n"
+            "\n"
+            "engines:");
+    for (const auto& engine : Engines)
+    {
+        fprintf(stderr, " %ls", engine.name.data());
+    }
+    fprintf(stderr, "\nscenes:");
+    for (const auto& scene : Scenes)
+    {
+        fprintf(stderr, " %ls", scene.name.data());
+    }
+    fprintf(stderr, "\n");
+    return 1;
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    std::wstring_view engineFilter;
+    std::wstring_view sceneFilter;
+    auto frames = 1000;
+
+    for (auto i = 1; i < argc; i += 2)
+    {
+        const std::wstring_view option{ argv[i] };
+        if (i + 1 >= argc)
+        {
+            return _Usage();
+        }
+        if (option == L"--engine")
+        {
+            engineFilter = argv[i + 1];
+        }
+        else if (option == L"--scene")
+        {
+            sceneFilter = argv[i + 1];
+        }
+        else if (option == L"--frames")
+        {
+            frames = std::max(1, _wtoi(argv[i + 1]));
+        }
+        else
+        {
+            return _Usage();
+        }
+    }
+
+    std::vector<const Scene*> scenes;
+    for (const auto& scene : Scenes)
+    {
+        if (sceneFilter.empty() || sceneFilter == scene.name)
+        {
+            scenes.emplace_back(&scene);
+        }
+    }
+
+    auto ran = false;
+    for (const auto& engine : Engines)
+    {
+        if (!scenes.empty() && (engineFilter.empty() || engineFilter == engine.name))
+        {
+            _BenchmarkEngine(engine, scenes, frames);
+            ran = true;
+        }
+    }
+    return ran ? 0 : _Usage();
+}
+catch (...)
+{
+    fprintf(stderr, "renderbench failed: 0x%08lx\n", static_cast<unsigned long>(wil::ResultFromCaughtException()));
+    return 1;
+}
@@ -0,0 +1,388 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// vtbench measures how fast VT output makes it through a pseudoconsole (our
+// conhost and the ConPTY output pipe), and how long it takes for a key that's
+// written into the input pipe to be echoed back. See README.md for its usage.
+//
+// The client side of each benchmark is vtbench itself, started in one of the
+// --client-* modes inside of the pseudoconsole.
+
+#include <windows.h>
+#include <wil/result.h>
+#include <wil/resource.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <conpty-static.h>
+
+static constexpr COORD PseudoConsoleSize{ 120, 30 };
+// The client of the latency benchmark writes this once it's ready to echo.
+static constexpr std::string_view ReadyMarker{ "vtbench-ready" };
+
+struct PseudoConsole
+{
+    wil::unique_hfile input;
+    wil::unique_hfile output;
+    HPCON hpc{ nullptr };
+    wil::unique_process_information client;
+
+    PseudoConsole() = default;
+    PseudoConsole(const PseudoConsole&) = delete;
+    PseudoConsole& operator=(const PseudoConsole&) = delete;
+
+    ~PseudoConsole()
+    {
+        Close();
+    }
+
+    // Closes the pseudoconsole, which waits for conhost to flush its output and exit.
+    // The output has to be drained in the meantime, or conhost can't finish writing it.
+    void Close()
+    {
+        if (hpc)
+        {
+            ConptyClosePseudoConsole(std::exchange(hpc, nullptr));
+        }
+    }
+};
+
+static LARGE_INTEGER _Now() noexcept
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now;
+}
+
+static double _SecondsBetween(const LARGE_INTEGER begin, const LARGE_INTEGER end) noexcept
+{
+    static const auto frequency = [] {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return static_cast<double>(f.QuadPart);
+    }();
+    return static_cast<double>(end.QuadPart - begin.QuadPart) / frequency;
+}
+
+static std::string _JsonString(const std::wstring_view str)
+{
+    std::string result{ "\"" };
+    for (const auto ch : str)
+    {
+        if (ch == L'"' || ch == L'\\')
+        {
+            result.push_back('\\');
+            result.push_back(static_cast<char>(ch));
+        }
+        else if (ch >= 0x20 && ch < 0x7f)
+        {
+            result.push_back(static_cast<char>(ch));
+        }
+        else
+        {
+            char escape[8];
+            sprintf_s(escape, "\\u%04x", static_cast<unsigned int>(ch));
+            result.append(escape);
+        }
+    }
+    result.push_back('"');
+    return result;
+}
+
+static std::wstring _ModulePath()
+{
+    std::wstring path;
+    THROW_IF_FAILED(wil::GetModuleFileNameW(nullptr, path));
+    return path;
+}
+
+// Creates a pseudoconsole and starts vtbench with the given arguments as its client.
+static void _Start(PseudoConsole& pty, const std::wstring& arguments)
+{
+    wil::unique_hfile inputRead, outputWrite;
+    THROW_IF_WIN32_BOOL_FALSE(CreatePipe(inputRead.addressof(), pty.input.addressof(), nullptr, 0));
+    THROW_IF_WIN32_BOOL_FALSE(CreatePipe(pty.output.addressof(), outputWrite.addressof(), nullptr, 0));
+    THROW_IF_FAILED(ConptyCreatePseudoConsole(PseudoConsoleSize, inputRead.get(), outputWrite.get(), 0, &pty.hpc));
+
+    SIZE_T size = 0;
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &size);
+    THROW_LAST_ERROR_IF(size == 0);
+
+    std::vector<std::byte> buffer(size);
+    STARTUPINFOEXW siEx{};
+    siEx.StartupInfo.cb = sizeof(siEx);
+    siEx.lpAttributeList = reinterpret_cast<PPROC_THREAD_ATTRIBUTE_LIST>(buffer.data());
+    THROW_IF_WIN32_BOOL_FALSE(InitializeProcThreadAttributeList(siEx.lpAttributeList, 1, 0, &size));
+    const auto deleteAttrList = wil::scope_exit([&] {
+        DeleteProcThreadAttributeList(siEx.lpAttributeList);
+    });
+    THROW_IF_WIN32_BOOL_FALSE(UpdateProcThreadAttribute(siEx.lpAttributeList, 0, PROC_THREAD_ATTRIBUTE_PSEUDOCONSOLE, pty.hpc, sizeof(pty.hpc), nullptr, nullptr));
+
+    auto commandline = L"\"" + _ModulePath() + L"\" " + arguments;
+    THROW_IF_WIN32_BOOL_FALSE(CreateProcessW(nullptr, commandline.data(), nullptr, nullptr, FALSE, EXTENDED_STARTUPINFO_PRESENT, nullptr, nullptr, &siEx.StartupInfo, &pty.client));
+}
+
+// Routine Description:
+// - Writes the contents of the given file to stdout `repetitions` times.
+static int _ClientWrite(const wchar_t* path, const int repetitions)
+{
+    wil::unique_hfile file{ CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    THROW_LAST_ERROR_IF(!file);
+
+    LARGE_INTEGER fileSize;
+    THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+    std::string contents(static_cast<size_t>(fileSize.QuadPart), '\0');
+    DWORD read = 0;
+    THROW_IF_WIN32_BOOL_FALSE(ReadFile(file.get(), contents.data(), static_cast<DWORD>(contents.size()), &read, nullptr));
+
+    const auto out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    GetConsoleMode(out, &mode);
+    SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING | DISABLE_NEWLINE_AUTO_RETURN);
+
+    for (auto i = 0; i < repetitions; ++i)
+    {
+        DWORD written = 0;
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(out, contents.data(), read, &written, nullptr));
+    }
+    return 0;
+}
+
+// Routine Description:
+// - Echoes every key it reads back to the start of the current line, until the input is closed.
+static int _ClientEcho()
+{
+    const auto in = GetStdHandle(STD_INPUT_HANDLE);
+    const auto out = GetStdHandle(STD_OUTPUT_HANDLE);
+    THROW_IF_WIN32_BOOL_FALSE(SetConsoleMode(in, 0));
+
+    DWORD written = 0;
+    THROW_IF_WIN32_BOOL_FALSE(WriteFile(out, ReadyMarker.data(), static_cast<DWORD>(ReadyMarker.size()), &written, nullptr));
+
+    for (;;)
+    {
+        wchar_t echo[2]{ L'\r' };
+        DWORD read = 0;
+        if (!ReadConsoleW(in, &echo[1], 1, &read, nullptr) || read == 0)
+        {
+            return 0;
+        }
+        THROW_IF_WIN32_BOOL_FALSE(WriteConsoleW(out, &echo[0], 2, &written, nullptr));
+    }
+}
+
+// Routine Description:
+// - Measures how long it takes for the given file to be written through the pseudoconsole.
+//   The time is taken from starting the client until the last byte of output was read.
+static void _BenchmarkThroughput(const wchar_t* path, const int repetitions)
+{
+    PseudoConsole pty;
+    const auto begin = _Now();
+    _Start(pty, L"--client-write \"" + std::wstring{ path } + L"\" " + std::to_wstring(repetitions));
+
+    uint64_t outputBytes = 0;
+    auto end = begin;
+    std::thread reader{ [&]() {
+        std::vector<char> buffer(128 * 1024);
+        DWORD read = 0;
+        while (ReadFile(pty.output.get(), buffer.data(), static_cast<DWORD>(buffer.size()), &read, nullptr) && read)
+        {
+            outputBytes += read;
+            end = _Now();
+        }
+    } };
+
+    WaitForSingleObject(pty.client.hProcess, INFINITE);
+    pty.Close();
+    reader.join();
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes{};
+    THROW_IF_WIN32_BOOL_FALSE(GetFileAttributesExW(path, GetFileExInfoStandard, &attributes));
+    const auto inputBytes = ((static_cast<uint64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow) * repetitions;
+    const auto seconds = _SecondsBetween(begin, end);
+
+    printf("{\"benchmark\":\"throughput\",\"corpus\":%s,\"repetitions\":%d,\"inputBytes\":%llu,\"outputBytes\":%llu,\"seconds\":%.6f,\"bytesPerSecond\":%.0f}\n",
+           _JsonString(path).c_str(),
+           repetitions,
+           inputBytes,
+           outputBytes,
+           seconds,
+           seconds > 0 ? static_cast<double>(inputBytes) / seconds : 0.0);
+}
+
+// Reads the output of a pseudoconsole, with escape sequences stripped, as they
+// contain digits and letters too (cursor positions, modes, the window title).
+class TextReader
+{
+public:
+    explicit TextReader(const PseudoConsole& pty) noexcept :
+        _pty{ pty }
+    {
+    }
+
+    // Routine Description:
+    // - Reads from the output pipe until `needle` shows up in the text,
+    //   and discards the text read so far.
+    void ReadUntil(const std::string_view needle)
+    {
+        char buffer[4096];
+        DWORD read = 0;
+        while (_text.find(needle) == std::string::npos)
+        {
+            THROW_IF_WIN32_BOOL_FALSE(ReadFile(_pty.output.get(), &buffer[0], sizeof(buffer), &read, nullptr));
+            for (DWORD i = 0; i < read; ++i)
+            {
+                _Parse(buffer[i]);
+            }
+        }
+        _text.clear();
+    }
+
+private:
+    enum class State
+    {
+        Ground,
+        Escape,
+        Csi,
+        Osc,
+        OscEscape,
+    };
+
+    void _Parse(const char ch)
+    {
+        switch (_state)
+        {
+        case State::Ground:
+            if (ch == '\x1b')
+            {
+                _state = State::Escape;
+            }
+            else if (static_cast<unsigned char>(ch) >= 0x20)
+            {
+                _text.push_back(ch);
+            }
+            break;
+        case State::Escape:
+            _state = ch == '[' ? State::Csi : ch == ']' ? State::Osc : State::Ground;
+            break;
+        case State::Csi:
+            if (ch >= 0x40 && ch <= 0x7e)
+            {
+                _state = State::Ground;
+            }
+            break;
+        case State::Osc:
+            if (ch == '\a')
+            {
+                _state = State::Ground;
+            }
+            else if (ch == '\x1b')
+            {
+                _state = State::OscEscape;
+            }
+            break;
+        default:
+            _state = State::Ground;
+            break;
+        }
+    }
+
+    const PseudoConsole& _pty;
+    State _state{ State::Ground };
+    std::string _text;
+};
+
+// Routine Description:
+// - Measures the time from writing a key into the input pipe until its echo arrives on the output pipe.
+static void _BenchmarkLatency(const int samples)
+{
+    PseudoConsole pty;
+    _Start(pty, L"--client-echo");
+    TextReader reader{ pty };
+    reader.ReadUntil(ReadyMarker);
+
+    std::vector<double> latencies;
+    latencies.reserve(samples);
+    for (auto i = 0; i < samples; ++i)
+    {
+        // The echo overwrites the previous one, so every key must differ from the
+        // previous one. Otherwise the cell wouldn't change and nothing would be painted.
+        const char key = static_cast<char>('0' + i % 10);
+        DWORD written = 0;
+        const auto begin = _Now();
+        THROW_IF_WIN32_BOOL_FALSE(WriteFile(pty.input.get(), &key, 1, &written, nullptr));
+        reader.ReadUntil({ &key, 1 });
+        latencies.emplace_back(_SecondsBetween(begin, _Now()) * 1e6);
+    }
+
+    std::thread drain{ [&]() {
+        char buffer[4096];
+        DWORD read = 0;
+        while (ReadFile(pty.output.get(), &buffer[0], sizeof(buffer), &read, nullptr) && read)
+        {
+        }
+    } };
+    pty.input.reset();
+    pty.Close();
+    drain.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](const double p) {
+        return latencies.empty() ? 0.0 : latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+    };
+
+    printf("{\"benchmark\":\"latency\",\"samples\":%d,\"p50Microseconds\":%.1f,\"p90Microseconds\":%.1f,\"p99Microseconds\":%.1f,\"maxMicroseconds\":%.1f}\n",
+           samples,
+           percentile(0.5),
+           percentile(0.9),
+           percentile(0.99),
+           latencies.empty() ? 0.0 : latencies.back());
+}
+
+static int _Usage()
+{
+    fprintf(stderr,
+            "usage:\n"
+            "  vtbench throughput <file> [<repetitions>]\n"
+            "  vtbench latency [<samples>]\n");
+    return 1;
+}
+
+int __cdecl wmain(int argc, wchar_t* argv[])
+try
+{
+    if (argc < 2)
+    {
+        return _Usage();
+    }
+
+    const std::wstring_view command{ argv[1] };
+    if (command == L"--client-write" && argc == 4)
+    {
+        return _ClientWrite(argv[2], _wtoi(argv[3]));
+    }
+    if (command == L"--client-echo")
+    {
+        return _ClientEcho();
+    }
+    if (command == L"throughput" && (argc == 3 || argc == 4))
+    {
+        _BenchmarkThroughput(argv[2], argc == 4 ? std::max(1, _wtoi(argv[3])) : 1);
+        return 0;
+    }
+    if (command == L"latency" && argc <= 3)
+    {
+        _BenchmarkLatency(argc == 3 ? std::max(1, _wtoi(argv[2])) : 1000);
+        return 0;
+    }
+    return _Usage();
+}
+catch (...)
+{
+    fprintf(stderr, "vtbench failed: 0x%08lx\n", static_cast<unsigned long>(wil::ResultFromCaughtException()));
+    return 1;
+}
@@ -0,0 +1,151 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/AllocationTracking.hpp"
+
+#ifdef ALLOCATION_TRACKING_BUILD
+
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
+
+#pragma warning(suppress : 26477) // We don't control tracelogging macros
+TRACELOGGING_DEFINE_PROVIDER(g_hConsoleAllocationsTraceProvider,
+                             "Microsoft.Windows.Console.Allocations",
+                             // tl:{b7e22f93-4eeb-5752-97fb-f402ac5d80a5}
+                             (0xb7e22f93, 0x4eeb, 0x5752, 0x97, 0xfb, 0xf4, 0x02, 0xac, 0x5d, 0x80, 0xa5));
+
+using namespace Microsoft::Console::AllocationTracking;
+
+static thread_local Scope* t_scope{ nullptr };
+static std::atomic<uint64_t> s_totalAllocations{ 0 };
+
+// This file is only linked into images that use TRACK_ALLOCATIONS, so the
+// provider lives exactly as long as the image that uses it.
+static const struct ProviderRegistration
+{
+    ProviderRegistration() noexcept
+    {
+        TraceLoggingRegister(g_hConsoleAllocationsTraceProvider);
+    }
+    ~ProviderRegistration()
+    {
+        TraceLoggingUnregister(g_hConsoleAllocationsTraceProvider);
+    }
+} s_registration;
+
+static constexpr const char* _SubsystemName(const Subsystem subsystem) noexcept
+{
+    switch (subsystem)
+    {
+    case Subsystem::Output:
+        return "Output";
+    case Subsystem::Parser:
+        return "Parser";
+    case Subsystem::Render:
+        return "Render";
+    case Subsystem::Input:
+        return "Input";
+    case Subsystem::Connection:
+        return "Connection";
+    default:
+        return "Unknown";
+    }
+}
+
+static void _Count(const size_t bytes) noexcept
+{
+    s_totalAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (const auto scope = t_scope)
+    {
+        scope->Add(bytes);
+    }
+}
+
+Scope::Scope(const Subsystem subsystem) noexcept :
+    _subsystem{ subsystem },
+    _parent{ t_scope },
+    _installed{ !_parent || _parent->_subsystem != subsystem }
+{
+    if (_installed)
+    {
+        t_scope = this;
+    }
+}
+
+Scope::~Scope()
+{
+    if (!_installed)
+    {
+        return;
+    }
+
+    t_scope = _parent;
+
+    if (_allocations)
+    {
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hConsoleAllocationsTraceProvider,
+                          "Allocations",
+                          TraceLoggingDescription("The allocations a subsystem made in one of its hot paths"),
+                          TraceLoggingString(_SubsystemName(_subsystem), "Subsystem"),
+                          TraceLoggingUInt64(_allocations, "Count"),
+                          TraceLoggingUInt64(_bytes, "Bytes"),
+                          TraceLoggingLevel(WINEVENT_LEVEL_VERBOSE),
+                          TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+    }
+}
+
+void Scope::Add(const size_t bytes) noexcept
+{
+    ++_allocations;
+    _bytes += bytes;
+}
+
+uint64_t Microsoft::Console::AllocationTracking::TotalAllocations() noexcept
+{
+    return s_totalAllocations.load(std::memory_order_relaxed);
+}
+
+// The CRT implements every other form of operator new (arrays, nothrow) on top
+// of these two, so they're all counted. operator delete has to be replaced
+// alongside, as the memory comes from malloc instead of the CRT's operator new.
+
+void* __CRTDECL operator new(const size_t size)
+{
+    _Count(size);
+    if (const auto p = malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void* __CRTDECL operator new(const size_t size, const std::align_val_t alignment)
+{
+    _Count(size);
+    if (const auto p = _aligned_malloc(size ? size : 1, static_cast<size_t>(alignment)))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void __CRTDECL operator delete(void* const p) noexcept
+{
+    free(p);
+}
+
+void __CRTDECL operator delete(void* const p, const std::align_val_t) noexcept
+{
+    _aligned_free(p);
+}
+
+#else
+
+uint64_t Microsoft::Console::AllocationTracking::TotalAllocations() noexcept
+{
+    return 0;
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "inc/CodepointWidthDetector.hpp"
+#include "inc/Utf16Parser.hpp"
 
 namespace
 {
@@ -321,6 +322,45 @@ namespace
         UnicodeRange{ 0xf0000, 0xffffd, CodepointWidth::Ambiguous },
         UnicodeRange{ 0x100000, 0x10fffd, CodepointWidth::Ambiguous },
     };
+
+    // The codepoints are split up into pages of 256. For each page, s_pageTable holds
+    // the range of entries of s_wideAndAmbiguousTable that overlap it. This lets every
+    // lookup search just the few ranges of its own page, instead of the entire table.
+    // It's built at compile time, so that regenerating the table above keeps it in sync.
+    constexpr unsigned int s_pageShift = 8;
+    constexpr size_t s_pageCount = 0x110000 >> s_pageShift;
+
+    struct PageRanges final
+    {
+        uint16_t begin;
+        uint16_t end;
+    };
+
+    constexpr std::array<PageRanges, s_pageCount> s_buildPageTable() noexcept
+    {
+        std::array<PageRanges, s_pageCount> pages{};
+        size_t begin = 0;
+        for (size_t page = 0; page < s_pageCount; ++page)
+        {
+            const auto first = static_cast<unsigned int>(page << s_pageShift);
+            const auto last = first + (1u << s_pageShift) - 1;
+
+            while (begin < s_wideAndAmbiguousTable.size() && s_wideAndAmbiguousTable[begin].upperBound < first)
+            {
+                ++begin;
+            }
+            auto end = begin;
+            while (end < s_wideAndAmbiguousTable.size() && s_wideAndAmbiguousTable[end].lowerBound <= last)
+            {
+                ++end;
+            }
+
+            pages[page] = PageRanges{ static_cast<uint16_t>(begin), static_cast<uint16_t>(end) };
+        }
+        return pages;
+    }
+
+    static constexpr auto s_pageTable = s_buildPageTable();
 }
 
 // Routine Description:
@@ -371,6 +411,13 @@ CodepointWidth CodepointWidthDetector::GetWidth(const std::wstring_view glyph) c
     }
     else
     {
+        // The glyph is either a surrogate pair or a whole grapheme cluster, which
+        // is as wide as its first codepoint, unless it asks for an emoji presentation.
+        const auto first = Utf16Parser::IsLeadingSurrogate(glyph[0]) && Utf16Parser::IsTrailingSurrogate(glyph[1]) ? 2u : 1u;
+        if (glyph.size() > first && glyph[first] == 0xFE0F)
+        {
+            return CodepointWidth::Wide;
+        }
         return _lookupGlyphWidthWithCache(glyph);
     }
 }
@@ -417,11 +464,20 @@ CodepointWidth CodepointWidthDetector::_lookupGlyphWidth(const std::wstring_view
     }
 
     const auto codepoint = _extractCodepoint(glyph);
-    const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
+    const auto page = codepoint >> s_pageShift;
+    if (page >= s_pageCount)
+    {
+        return CodepointWidth::Narrow;
+    }
+
+    const auto& ranges = til::at(s_pageTable, page);
+    const auto begin = s_wideAndAmbiguousTable.begin() + ranges.begin;
+    const auto end = s_wideAndAmbiguousTable.begin() + ranges.end;
+    const auto it = std::lower_bound(begin, end, codepoint);
 
     // For characters that are not _in_ the table, lower_bound will return the nearest item that is.
     // We must check its bounds to make sure that our hit was a true hit.
-    if (it != s_wideAndAmbiguousTable.end() && codepoint >= it->lowerBound && codepoint <= it->upperBound)
+    if (it != end && codepoint >= it->lowerBound && codepoint <= it->upperBound)
     {
         return it->width;
     }
@@ -476,14 +532,19 @@ CodepointWidth CodepointWidthDetector::_lookupGlyphWidthWithCache(const std::wst
 // - true if codepoint is wide or false if it is narrow
 bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyph) const
 {
-    const std::wstring findMe{ glyph };
+    // The cache is keyed by codepoint, which avoids allocating a string for every lookup.
+    // Glyphs of more than one codepoint are rare enough to just ask the fallback every time.
+    if (glyph.size() > 2 || (glyph.size() == 2 && !(Utf16Parser::IsLeadingSurrogate(glyph.front()) && Utf16Parser::IsTrailingSurrogate(glyph.back()))))
+    {
+        return _pfnFallbackMethod(glyph);
+    }
 
-    // TODO: Cache needs to be emptied when font changes.
-    const auto it = _fallbackCache.find(findMe);
+    const auto codepoint = _extractCodepoint(glyph);
+    const auto it = _fallbackCache.find(codepoint);
     if (it == _fallbackCache.end())
     {
         auto result = _pfnFallbackMethod(glyph);
-        _fallbackCache.insert_or_assign(findMe, result);
+        _fallbackCache.emplace(codepoint, result);
         return result;
     }
     else
@@ -495,12 +556,12 @@ bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyp
 // Routine Description:
 // - extract unicode codepoint from utf16 encoding
 // Arguments:
-// - glyph - the utf16 encoded codepoint convert
+// - glyph - the utf16 encoded codepoint convert. Only its first codepoint is extracted.
 // Return Value:
 // - the codepoint being stored
 unsigned int CodepointWidthDetector::_extractCodepoint(const std::wstring_view glyph) noexcept
 {
-    if (glyph.size() == 1)
+    if (glyph.size() == 1 || !Utf16Parser::IsLeadingSurrogate(glyph[0]) || !Utf16Parser::IsTrailingSurrogate(glyph[1]))
     {
         return static_cast<unsigned int>(glyph.front());
     }
@@ -201,7 +201,14 @@ void ColorFix::_ToRGB()
 // - The foreground color after performing any necessary changes to make it more perceivable
 COLORREF ColorFix::GetPerceivableColor(COLORREF fg, COLORREF bg)
 {
-    const ColorFix backLab(bg);
+    return GetPerceivableColor(fg, ColorFix{ bg });
+}
+
+// Method Description:
+// - Same as above, but for a background that has already been converted to Lab,
+//   for callers that adjust many foreground colors for the same background.
+COLORREF ColorFix::GetPerceivableColor(COLORREF fg, const ColorFix& backLab)
+{
     ColorFix frontLab(fg);
     const double de1 = _GetDeltaE(frontLab, backLab);
     if (de1 < gMinThreshold)
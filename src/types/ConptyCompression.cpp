@@ -0,0 +1,207 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/ConptyCompression.hpp"
+
+using namespace Microsoft::Console::Utils::ConptyCompression;
+
+namespace
+{
+    // We can't link with cabinet.lib, as the OS build of conhost doesn't.
+    wil::unique_hmodule LoadCabinet()
+    {
+        wil::unique_hmodule module{ LoadLibraryExW(L"cabinet.dll", nullptr, LOAD_LIBRARY_SEARCH_SYSTEM32) };
+        THROW_LAST_ERROR_IF(!module);
+        return module;
+    }
+
+    template<typename T>
+    T GetCabinetProc(const wil::unique_hmodule& module, const char* name)
+    {
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+        const auto proc = reinterpret_cast<T>(GetProcAddress(module.get(), name));
+        THROW_LAST_ERROR_IF(!proc);
+        return proc;
+    }
+
+    // XPRESS is by far the fastest of the algorithms and compresses VT well.
+    // COMPRESS_RAW leaves the framing to us, which keeps the frames small.
+    constexpr DWORD Algorithm = COMPRESS_ALGORITHM_XPRESS | COMPRESS_RAW;
+}
+
+// Constructor Description:
+// - Creates a compressor for the output of a conpty.
+// - Throws if the compression API isn't available.
+Compressor::Compressor() :
+    _module{ LoadCabinet() }
+{
+    const auto createCompressor = GetCabinetProc<decltype(&::CreateCompressor)>(_module, "CreateCompressor");
+    _closeCompressor = GetCabinetProc<decltype(&::CloseCompressor)>(_module, "CloseCompressor");
+    _compress = GetCabinetProc<decltype(&::Compress)>(_module, "Compress");
+    THROW_IF_WIN32_BOOL_FALSE(createCompressor(Algorithm, nullptr, &_compressor));
+}
+
+Compressor::~Compressor()
+{
+    if (_compressor)
+    {
+        _closeCompressor(_compressor);
+    }
+}
+
+// Method Description:
+// - Appends the given output, framed and compressed, to `out`. The very
+//   first call also emits the Magic that tells the terminal that the output
+//   is compressed.
+// Arguments:
+// - data - the output to compress
+// - out - the string to append the frames to
+// Return Value:
+// - <none>
+void Compressor::Compress(std::string_view data, std::string& out)
+{
+    if (!_wroteMagic)
+    {
+        out.append(Magic);
+        _wroteMagic = true;
+    }
+
+    while (!data.empty())
+    {
+        const auto frame = data.substr(0, MaxFrameSize);
+        _CompressFrame(frame, out);
+        data = data.substr(frame.size());
+    }
+}
+
+void Compressor::_CompressFrame(const std::string_view data, std::string& out)
+{
+    // Frames that can't be compressed to less than their size are sent as is.
+    // That's the case for tiny frames, like single key echoes, in particular.
+    SIZE_T compressedSize = 0;
+    if (data.size() >= MinCompressedSize)
+    {
+        _scratch.resize(data.size());
+        if (!_compress(_compressor, data.data(), data.size(), _scratch.data(), _scratch.size(), &compressedSize))
+        {
+            compressedSize = 0;
+        }
+    }
+
+    const auto stored = compressedSize == 0 || compressedSize >= data.size();
+    const auto payload = stored ? data : std::string_view{ _scratch.data(), compressedSize };
+
+    const FrameHeader header{ gsl::narrow_cast<uint32_t>(payload.size()), gsl::narrow_cast<uint32_t>(data.size()) };
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast (type.1).
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.append(payload);
+}
+
+// Constructor Description:
+// - Creates a decompressor for the output of a conpty.
+// - Throws if the compression API isn't available.
+Decompressor::Decompressor() :
+    _module{ LoadCabinet() }
+{
+    const auto createDecompressor = GetCabinetProc<decltype(&::CreateDecompressor)>(_module, "CreateDecompressor");
+    _closeDecompressor = GetCabinetProc<decltype(&::CloseDecompressor)>(_module, "CloseDecompressor");
+    _decompress = GetCabinetProc<decltype(&::Decompress)>(_module, "Decompress");
+    THROW_IF_WIN32_BOOL_FALSE(createDecompressor(Algorithm, nullptr, &_decompressor));
+}
+
+Decompressor::~Decompressor()
+{
+    if (_decompressor)
+    {
+        _closeDecompressor(_decompressor);
+    }
+}
+
+// Method Description:
+// - Consumes the next chunk read from the output pipe, and appends the output
+//   it decodes to `out`. Frames may be split across any number of chunks.
+// - If the output doesn't start with the Magic, the conpty didn't compress it,
+//   and all of it is appended to `out` as is.
+// - Throws if the output is corrupted.
+// Arguments:
+// - data - the chunk read from the pipe
+// - out - the string to append the output to
+// Return Value:
+// - <none>
+void Decompressor::Decompress(std::string_view data, std::string& out)
+{
+    while (!data.empty())
+    {
+        switch (_state)
+        {
+        case State::Magic:
+        {
+            const auto count = std::min(data.size(), Magic.size() - _pending.size());
+            _pending.append(data.substr(0, count));
+            data = data.substr(count);
+
+            if (Magic.substr(0, _pending.size()) != _pending)
+            {
+                _state = State::Passthrough;
+                out.append(_pending);
+                _pending.clear();
+            }
+            else if (_pending.size() == Magic.size())
+            {
+                _state = State::Header;
+                _pending.clear();
+            }
+            break;
+        }
+        case State::Header:
+        {
+            const auto count = std::min(data.size(), sizeof(_header) - _pending.size());
+            _pending.append(data.substr(0, count));
+            data = data.substr(count);
+
+            if (_pending.size() == sizeof(_header))
+            {
+                memcpy(&_header, _pending.data(), sizeof(_header));
+                _pending.clear();
+                THROW_HR_IF(E_UNEXPECTED, _header.size > MaxFrameSize || _header.compressedSize > _header.size || (_header.compressedSize == 0 && _header.size != 0));
+                _state = _header.size ? State::Payload : State::Header;
+            }
+            break;
+        }
+        case State::Payload:
+        {
+            const auto count = std::min<size_t>(data.size(), _header.compressedSize - _pending.size());
+            _pending.append(data.substr(0, count));
+            data = data.substr(count);
+
+            if (_pending.size() == _header.compressedSize)
+            {
+                _DecompressFrame(out);
+                _pending.clear();
+                _state = State::Header;
+            }
+            break;
+        }
+        default:
+            out.append(data);
+            return;
+        }
+    }
+}
+
+void Decompressor::_DecompressFrame(std::string& out)
+{
+    if (_header.compressedSize == _header.size)
+    {
+        out.append(_pending);
+        return;
+    }
+
+    const auto offset = out.size();
+    out.resize(offset + _header.size);
+
+    SIZE_T size = 0;
+    THROW_IF_WIN32_BOOL_FALSE(_decompress(_decompressor, _pending.data(), _pending.size(), out.data() + offset, _header.size, &size));
+    THROW_HR_IF(E_UNEXPECTED, size != _header.size);
+}
@@ -38,7 +38,9 @@ namespace Microsoft::Console::Types
         virtual const TextBuffer& GetTextBuffer() noexcept = 0;
         virtual const FontInfo& GetFontInfo() noexcept = 0;
 
-        virtual std::vector<Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept = 0;
+        // The rectangles are owned by the implementation. They're only valid
+        // until the next call, and only as long as the console stays locked.
+        virtual gsl::span<const Microsoft::Console::Types::Viewport> GetSelectionRects() noexcept = 0;
 
         virtual void LockConsole() noexcept = 0;
         virtual void UnlockConsole() noexcept = 0;
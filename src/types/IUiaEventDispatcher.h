@@ -21,7 +21,8 @@ namespace Microsoft::Console::Types
     {
     public:
         virtual void SignalSelectionChanged() = 0;
-        virtual void SignalTextChanged() = 0;
+        // changedRegion is the union of all regions of the viewport that changed since the last event.
+        virtual void SignalTextChanged(const SMALL_RECT changedRegion) = 0;
         virtual void SignalCursorChanged() = 0;
     };
 }
@@ -0,0 +1,148 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "inc/StartupTracing.hpp"
+
+#include <TraceLoggingProvider.h>
+#include <winmeta.h>
+#include <evntprov.h>
+
+#pragma warning(suppress : 26477) // We don't control tracelogging macros
+TRACELOGGING_DEFINE_PROVIDER(g_hTerminalStartupTraceProvider,
+                             "Microsoft.Windows.Terminal.Startup",
+                             // tl:{8821e9a7-bb1e-529a-72e9-9c03baab6d3e}
+                             (0x8821e9a7, 0xbb1e, 0x529a, 0x72, 0xe9, 0x9c, 0x03, 0xba, 0xab, 0x6d, 0x3e));
+
+using namespace Microsoft::Console::StartupTracing;
+
+// This file is only linked into images that use a Scope, so the
+// provider lives exactly as long as the image that uses it.
+static const struct ProviderRegistration
+{
+    ProviderRegistration() noexcept
+    {
+        TraceLoggingRegister(g_hTerminalStartupTraceProvider);
+    }
+    ~ProviderRegistration()
+    {
+        TraceLoggingUnregister(g_hTerminalStartupTraceProvider);
+    }
+} s_registration;
+
+static constexpr const char* _PhaseName(const Phase phase) noexcept
+{
+    switch (phase)
+    {
+    case Phase::AppHost:
+        return "AppHost";
+    case Phase::MonarchElection:
+        return "MonarchElection";
+    case Phase::LoadSettings:
+        return "LoadSettings";
+    case Phase::ProfileGenerator:
+        return "ProfileGenerator";
+    case Phase::CreateApp:
+        return "CreateApp";
+    case Phase::CreatePage:
+        return "CreatePage";
+    case Phase::StartupActions:
+        return "StartupActions";
+    case Phase::FirstConnection:
+        return "FirstConnection";
+    case Phase::FirstFrame:
+        return "FirstFrame";
+    default:
+        return "Unknown";
+    }
+}
+
+// Returns true only the first time it's called for the phase.
+static bool _ClaimFirst(const Phase phase) noexcept
+{
+    static std::atomic<uint32_t> s_claimed{ 0 };
+    const auto bit = 1u << static_cast<uint32_t>(phase);
+    return (s_claimed.fetch_or(bit, std::memory_order_relaxed) & bit) == 0;
+}
+
+// The time since the process was created, which is where the startup really begins.
+static uint64_t _MillisecondsSinceProcessStart() noexcept
+{
+    FILETIME creation{}, exit{}, kernel{}, user{};
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+    {
+        return 0;
+    }
+
+    FILETIME now{};
+    GetSystemTimePreciseAsFileTime(&now);
+
+    const auto ticks = [](const FILETIME& time) noexcept {
+        return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    // FILETIMEs count in units of 100ns.
+    return (ticks(now) - ticks(creation)) / 10000;
+}
+
+Scope::Scope(const Phase phase, const std::wstring_view detail) noexcept :
+    _phase{ phase }
+{
+    // The first time is claimed even if nobody is listening, or the events would be mislabeled once someone does.
+    if ((phase == Phase::FirstConnection || phase == Phase::FirstFrame) && !_ClaimFirst(phase))
+    {
+        return;
+    }
+    if (!TraceLoggingProviderEnabled(g_hTerminalStartupTraceProvider, WINEVENT_LEVEL_INFO, TIL_KEYWORD_TRACE))
+    {
+        return;
+    }
+
+    _active = true;
+    EventActivityIdControl(EVENT_ACTIVITY_CTRL_CREATE_ID, &_activityId);
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+    TraceLoggingWriteActivity(g_hTerminalStartupTraceProvider,
+                              "StartupPhase",
+                              &_activityId,
+                              nullptr,
+                              TraceLoggingDescription("A phase of the startup of the Terminal began"),
+                              TraceLoggingString(_PhaseName(phase), "Phase"),
+                              TraceLoggingCountedWideString(detail.data(), gsl::narrow_cast<ULONG>(detail.size()), "Detail"),
+                              TraceLoggingUInt64(_MillisecondsSinceProcessStart(), "SinceProcessStartMs"),
+                              TraceLoggingOpcode(WINEVENT_OPCODE_START),
+                              TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
+
+Scope::~Scope()
+{
+    Stop();
+}
+
+// Routine Description:
+// - Writes the stop event of the phase, for phases that end before the scope does.
+//   Only the first call has any effect.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void Scope::Stop() noexcept
+{
+    if (!_active)
+    {
+        return;
+    }
+    _active = false;
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446 26447) // We don't control TraceLoggingWrite
+    TraceLoggingWriteActivity(g_hTerminalStartupTraceProvider,
+                              "StartupPhase",
+                              &_activityId,
+                              nullptr,
+                              TraceLoggingDescription("A phase of the startup of the Terminal ended"),
+                              TraceLoggingString(_PhaseName(_phase), "Phase"),
+                              TraceLoggingUInt64(_MillisecondsSinceProcessStart(), "SinceProcessStartMs"),
+                              TraceLoggingOpcode(WINEVENT_OPCODE_STOP),
+                              TraceLoggingLevel(WINEVENT_LEVEL_INFO),
+                              TraceLoggingKeyword(TIL_KEYWORD_TRACE));
+}
@@ -130,6 +130,7 @@ try
     _pData = a._pData;
     _wordDelimiters = a._wordDelimiters;
     _blockRange = a._blockRange;
+    _wordBoundaries = a._wordBoundaries;
 
     UiaTracing::TextRange::Constructor(*this);
     return S_OK;
@@ -307,8 +308,8 @@ void UiaTextRangeBase::_expandToEnclosingUnit(TextUnit unit)
     else if (unit <= TextUnit_Word)
     {
         // expand to word
-        _start = buffer.GetWordStart(_start, _wordDelimiters, true, documentEnd);
-        _end = buffer.GetWordEnd(_start, _wordDelimiters, true, documentEnd);
+        _start = _getWordStart(buffer, _start, documentEnd.to_win32_coord());
+        _end = _getWordEnd(buffer, _start, documentEnd.to_win32_coord());
     }
     else if (unit <= TextUnit_Line)
     {
@@ -1520,9 +1521,9 @@ void UiaTextRangeBase::_moveEndpointByUnitWord(_In_ const int moveCount,
             {
                 success = false;
             }
-            else if (buffer.MoveToNextWord(nextPos, _wordDelimiters, documentEnd))
+            else if (const auto nextWordStart = _getWordBoundaries().NextWordStart(buffer, _wordDelimiters, nextPos, documentEnd.to_win32_coord()))
             {
-                resultPos = nextPos;
+                resultPos = *nextWordStart;
                 (*pAmountMoved)++;
             }
             else if (allowBottomExclusive)
@@ -1550,7 +1551,7 @@ void UiaTextRangeBase::_moveEndpointByUnitWord(_In_ const int moveCount,
                 // to the next branch and move to the previous word!
                 (*pAmountMoved)--;
             }
-            else if (buffer.MoveToPreviousWord(nextPos, _wordDelimiters))
+            else if (_moveToPreviousWord(buffer, nextPos))
             {
                 resultPos = nextPos;
                 (*pAmountMoved)--;
@@ -1578,9 +1579,9 @@ void UiaTextRangeBase::_moveEndpointByUnitWord(_In_ const int moveCount,
 // Return Value:
 // - true --> we were not at the beginning of the word, and we updated resultingPos to be so
 // - false --> otherwise (we're already at the beginning of the word)
-bool UiaTextRangeBase::_tryMoveToWordStart(const TextBuffer& buffer, const til::point documentEnd, COORD& resultingPos) const
+bool UiaTextRangeBase::_tryMoveToWordStart(const TextBuffer& buffer, const til::point documentEnd, COORD& resultingPos)
 {
-    const auto wordStart{ buffer.GetWordStart(resultingPos, _wordDelimiters, true, documentEnd) };
+    const auto wordStart{ _getWordStart(buffer, resultingPos, documentEnd.to_win32_coord()) };
     if (resultingPos != wordStart)
     {
         resultingPos = wordStart;
@@ -1589,6 +1590,224 @@ bool UiaTextRangeBase::_tryMoveToWordStart(const TextBuffer& buffer, const til::
     return false;
 }
 
+UiaWordBoundaryCache& UiaTextRangeBase::_getWordBoundaries()
+{
+    if (!_wordBoundaries)
+    {
+        _wordBoundaries = std::make_shared<UiaWordBoundaryCache>();
+    }
+    return *_wordBoundaries;
+}
+
+// Routine Description:
+// - The equivalent of TextBuffer::GetWordStart() in accessibility mode, but for the cached word boundaries.
+// Arguments:
+// - buffer - the text buffer we're operating on
+// - target - a COORD on the word you are currently on
+// - limit - the last possible position in the buffer that can be explored
+// Return Value:
+// - The COORD for the first character on the current/previous readable word (inclusive)
+COORD UiaTextRangeBase::_getWordStart(const TextBuffer& buffer, const COORD target, const COORD limit)
+{
+    const auto bufferSize{ buffer.GetSize() };
+    auto copy{ target };
+    if (target == bufferSize.Origin())
+    {
+        // can't expand left
+        return target;
+    }
+    else if (target == bufferSize.EndExclusive())
+    {
+        // GH#7664: Treat EndExclusive as EndInclusive so
+        // that it actually points to a space in the buffer
+        copy = { bufferSize.RightInclusive(), bufferSize.BottomInclusive() };
+    }
+    else if (bufferSize.CompareInBounds(target, limit, true) >= 0)
+    {
+        // if at/past the limit --> clamp to limit
+        copy = limit;
+    }
+
+    return _getWordBoundaries().PreviousWordStart(buffer, _wordDelimiters, copy).value_or(bufferSize.Origin());
+}
+
+// Routine Description:
+// - The equivalent of TextBuffer::GetWordEnd() in accessibility mode, but for the cached word boundaries.
+// Arguments:
+// - buffer - the text buffer we're operating on
+// - target - a COORD on the word you are currently on
+// - limit - the last possible position in the buffer that can be explored
+// Return Value:
+// - The COORD for the first character of the next readable word (exclusive end of the current one), or limit
+COORD UiaTextRangeBase::_getWordEnd(const TextBuffer& buffer, const COORD target, const COORD limit)
+{
+    if (buffer.GetSize().CompareInBounds(target, limit, true) >= 0)
+    {
+        return target;
+    }
+    return _getWordBoundaries().NextWordStart(buffer, _wordDelimiters, target, limit).value_or(limit);
+}
+
+// Routine Description:
+// - The equivalent of TextBuffer::MoveToPreviousWord(), but for the cached word boundaries.
+// Arguments:
+// - buffer - the text buffer we're operating on
+// - pos - a COORD on the word you are currently on
+// Return Value:
+// - true, if successfully updated pos. False, if we are unable to move (usually due to a buffer boundary)
+bool UiaTextRangeBase::_moveToPreviousWord(const TextBuffer& buffer, COORD& pos)
+{
+    const auto bufferSize{ buffer.GetSize() };
+
+    // move to the beginning of the current word
+    auto copy{ _getWordStart(buffer, pos, bufferSize.EndExclusive()) };
+
+    if (!bufferSize.DecrementInBounds(copy, true))
+    {
+        // can't move behind current word
+        return false;
+    }
+
+    // move to the beginning of the previous word
+    pos = _getWordStart(buffer, copy, bufferSize.EndExclusive());
+    return true;
+}
+
+// Routine Description:
+// - Finds the start of the first word after pos, the same way TextBuffer::MoveToNextWord() does.
+// Arguments:
+// - buffer - the text buffer we're operating on
+// - wordDelimiters - what characters are we considering for the separation of words
+// - pos - the position to start from
+// - limit - the exclusive end of the area that's searched
+// Return Value:
+// - The start of the next word, or nullopt if there's none before limit
+std::optional<COORD> UiaWordBoundaryCache::NextWordStart(const TextBuffer& buffer, const std::wstring_view wordDelimiters, const COORD pos, const COORD limit)
+{
+    _validate(buffer, wordDelimiters);
+
+    const auto bufferSize{ buffer.GetSize() };
+    if (bufferSize.CompareInBounds(pos, limit, true) >= 0)
+    {
+        return std::nullopt;
+    }
+
+    const auto lastRow = std::min<SHORT>(limit.Y, _size.Y - 1);
+    for (auto y = pos.Y; y <= lastRow; ++y)
+    {
+        std::optional<COORD> result;
+        if (y > pos.Y && _startsWithWord(buffer, y))
+        {
+            result = COORD{ 0, y };
+        }
+        else
+        {
+            const auto& wordStarts = _getRow(buffer, y).wordStarts;
+            const auto it = y == pos.Y ? std::upper_bound(wordStarts.begin(), wordStarts.end(), pos.X) : wordStarts.begin();
+            if (it != wordStarts.end())
+            {
+                result = COORD{ *it, y };
+            }
+        }
+
+        if (result)
+        {
+            if (bufferSize.CompareInBounds(*result, limit, true) >= 0)
+            {
+                return std::nullopt;
+            }
+            return result;
+        }
+    }
+
+    return std::nullopt;
+}
+
+// Routine Description:
+// - Finds the start of the word at or before pos, the same way TextBuffer::GetWordStart() does in accessibility mode.
+// Arguments:
+// - buffer - the text buffer we're operating on
+// - wordDelimiters - what characters are we considering for the separation of words
+// - pos - the position to start from. Must be within the buffer.
+// Return Value:
+// - The start of the word, or nullopt if there's no word at or before pos
+std::optional<COORD> UiaWordBoundaryCache::PreviousWordStart(const TextBuffer& buffer, const std::wstring_view wordDelimiters, const COORD pos)
+{
+    _validate(buffer, wordDelimiters);
+
+    for (auto y = pos.Y; y >= 0; --y)
+    {
+        const auto& wordStarts = _getRow(buffer, y).wordStarts;
+        const auto it = y == pos.Y ? std::upper_bound(wordStarts.begin(), wordStarts.end(), pos.X) : wordStarts.end();
+        if (it != wordStarts.begin())
+        {
+            return COORD{ *std::prev(it), y };
+        }
+        if (_startsWithWord(buffer, y))
+        {
+            return COORD{ 0, y };
+        }
+    }
+
+    return std::nullopt;
+}
+
+// Routine Description:
+// - Drops all cached rows if they were computed for a different buffer, buffer size or set of delimiters.
+void UiaWordBoundaryCache::_validate(const TextBuffer& buffer, const std::wstring_view wordDelimiters)
+{
+    const auto size{ buffer.GetSize().Dimensions() };
+    if (&buffer != _buffer || size != _size || wordDelimiters != _wordDelimiters)
+    {
+        _buffer = &buffer;
+        _size = size;
+        _wordDelimiters = wordDelimiters;
+        _rows.clear();
+        _rows.resize(size.Y);
+    }
+}
+
+// Routine Description:
+// - Returns the word boundaries of the given row, scanning it if it changed since it was last scanned.
+const UiaWordBoundaryCache::Row& UiaWordBoundaryCache::_getRow(const TextBuffer& buffer, const SHORT y)
+{
+    auto& entry{ til::at(_rows, y) };
+    const auto& row{ buffer.GetRowByOffset(y) };
+    if (!entry.valid || entry.revision != row.GetRevision())
+    {
+        const auto& classes{ buffer.GetDelimiterClasses(y, _wordDelimiters) };
+        auto previousIsRegular = false;
+
+        entry.wordStarts.clear();
+        for (SHORT x = 0; x < _size.X; ++x)
+        {
+            const auto isRegular = til::at(classes, x) == DelimiterClass::RegularChar;
+            if (x == 0)
+            {
+                entry.firstIsRegular = isRegular;
+            }
+            else if (isRegular && !previousIsRegular)
+            {
+                entry.wordStarts.push_back(x);
+            }
+            previousIsRegular = isRegular;
+        }
+
+        entry.lastIsRegular = previousIsRegular;
+        entry.revision = row.GetRevision();
+        entry.valid = true;
+    }
+    return entry;
+}
+
+// Routine Description:
+// - Words continue across row boundaries. A row thus only starts with a word if
+//   its first cell is a RegularChar and the last cell of the previous row isn't.
+bool UiaWordBoundaryCache::_startsWithWord(const TextBuffer& buffer, const SHORT y)
+{
+    return _getRow(buffer, y).firstIsRegular && (y == 0 || !_getRow(buffer, gsl::narrow_cast<SHORT>(y - 1)).lastIsRegular);
+}
+
 // Routine Description:
 // - moves the UTR's endpoint by moveCount times by line.
 // - if endpoints crossed, the degenerate range is created and both endpoints are moved
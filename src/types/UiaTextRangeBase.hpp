@@ -35,6 +35,37 @@ class UiaTextRangeTests;
 
 namespace Microsoft::Console::Types
 {
+    // Remembers where the (accessibility) words of the rows of a TextBuffer start,
+    // so that word navigation doesn't need to walk the buffer cell by cell
+    // again for every single step a screen reader takes.
+    // A row is only scanned again after its revision changed.
+    class UiaWordBoundaryCache
+    {
+    public:
+        std::optional<COORD> NextWordStart(const TextBuffer& buffer, const std::wstring_view wordDelimiters, const COORD pos, const COORD limit);
+        std::optional<COORD> PreviousWordStart(const TextBuffer& buffer, const std::wstring_view wordDelimiters, const COORD pos);
+
+    private:
+        struct Row
+        {
+            uint64_t revision = 0;
+            bool valid = false;
+            bool firstIsRegular = false;
+            bool lastIsRegular = false;
+            // The columns > 0 of RegularChars that follow a non-RegularChar.
+            std::vector<SHORT> wordStarts;
+        };
+
+        void _validate(const TextBuffer& buffer, const std::wstring_view wordDelimiters);
+        const Row& _getRow(const TextBuffer& buffer, const SHORT y);
+        bool _startsWithWord(const TextBuffer& buffer, const SHORT y);
+
+        const TextBuffer* _buffer = nullptr;
+        COORD _size{};
+        std::wstring _wordDelimiters;
+        std::vector<Row> _rows;
+    };
+
     class UiaTextRangeBase : public WRL::RuntimeClass<WRL::RuntimeClassFlags<WRL::ClassicCom | WRL::InhibitFtmBase>, ITextRangeProvider>, public IUiaTraceable
     {
     protected:
@@ -127,6 +158,10 @@ namespace Microsoft::Console::Types
 
         std::wstring _wordDelimiters{};
 
+        // Shared with all clones of this range, as screen readers
+        // tend to clone a range for every step they take.
+        std::shared_ptr<UiaWordBoundaryCache> _wordBoundaries;
+
         virtual void _TranslatePointToScreen(LPPOINT clientPoint) const = 0;
         virtual void _TranslatePointFromScreen(LPPOINT screenPoint) const = 0;
 
@@ -182,7 +217,11 @@ namespace Microsoft::Console::Types
 
         std::optional<bool> _verifyAttr(TEXTATTRIBUTEID attributeId, VARIANT val, const TextAttribute& attr) const;
         bool _initializeAttrQuery(TEXTATTRIBUTEID attributeId, VARIANT* pRetVal, const TextAttribute& attr) const;
-        bool _tryMoveToWordStart(const TextBuffer& buffer, const til::point documentEnd, COORD& resultingPos) const;
+        bool _tryMoveToWordStart(const TextBuffer& buffer, const til::point documentEnd, COORD& resultingPos);
+        UiaWordBoundaryCache& _getWordBoundaries();
+        COORD _getWordStart(const TextBuffer& buffer, const COORD target, const COORD limit);
+        COORD _getWordEnd(const TextBuffer& buffer, const COORD target, const COORD limit);
+        bool _moveToPreviousWord(const TextBuffer& buffer, COORD& pos);
 
         COORD _getInclusiveEnd() noexcept;
 
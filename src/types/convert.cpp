@@ -130,6 +130,61 @@
     return cchTarget;
 }
 
+// Routine Description:
+// - Determines whether the given codepage maps the bytes 0x00-0x7F to the
+//   code points U+0000-U+007F and back, and never uses them as a part of a
+//   multibyte sequence, except as the trail byte of a DBCS lead byte.
+// - In such codepages ASCII text can be widened and narrowed without asking
+//   MultiByteToWideChar or WideCharToMultiByte.
+// Arguments:
+// - codepage - Windows Code Page to check
+// Return Value:
+// - true if ASCII text doesn't need to be converted for this codepage.
+[[nodiscard]] bool IsAsciiCompatibleCodePage(const UINT codepage) noexcept
+{
+    switch (codepage)
+    {
+    case CP_UTF8:
+    case 20127: // US-ASCII
+    // The OEM codepages.
+    case 437:
+    case 737:
+    case 775:
+    case 850:
+    case 852:
+    case 855:
+    case 857:
+    case 858:
+    case 860:
+    case 861:
+    case 862:
+    case 863:
+    case 864:
+    case 865:
+    case 866:
+    case 869:
+    // The ANSI codepages, including the East Asian DBCS ones. Their lead bytes are all >= 0x81.
+    case 874:
+    case 932:
+    case 936:
+    case 949:
+    case 950:
+    case 1250:
+    case 1251:
+    case 1252:
+    case 1253:
+    case 1254:
+    case 1255:
+    case 1256:
+    case 1257:
+    case 1258:
+        return true;
+    default:
+        // ISO 8859-1 to ISO 8859-15
+        return codepage >= 28591 && codepage <= 28605;
+    }
+}
+
 // Routine Description:
 // - naively determines the width of a UCS2 encoded wchar
 // Arguments:
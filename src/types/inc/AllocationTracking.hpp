@@ -0,0 +1,67 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- AllocationTracking.hpp
+
+Abstract:
+- Counts the allocations made by the hot paths of each subsystem, in builds
+  with ALLOCATION_TRACKING_BUILD defined (msbuild /p:OpenConsoleAllocationTracking=true).
+  In any other build TRACK_ALLOCATIONS compiles to nothing.
+- TRACK_ALLOCATIONS(Subsystem) attributes every operator new on the current
+  thread to the given subsystem until the end of the enclosing scope. Scopes
+  nest: allocations are only attributed to the innermost one, and a scope
+  inside another one of the same subsystem just adds to its counts.
+- When a scope ends, the allocations it made are written to the
+  "Microsoft.Windows.Console.Allocations" TraceLogging provider, which is part
+  of ConsolePerf.wprp.
+- TotalAllocations() counts every allocation of the process instead, for
+  harnesses that need to compare the allocations of two runs (see the
+  performance mode of the Host.FuzzWrapper).
+- The tracking build replaces the global operator new of every image that
+  uses TRACK_ALLOCATIONS, so it mustn't be combined with another replacement.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::AllocationTracking
+{
+    enum class Subsystem : uint8_t
+    {
+        Output, // writes into a TextBuffer
+        Parser, // StateMachine dispatch
+        Render, // Renderer::PaintFrame
+        Input, // the InputBuffer
+        Connection, // reads of a terminal connection
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(const Subsystem subsystem) noexcept;
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void Add(const size_t bytes) noexcept;
+
+    private:
+        Subsystem _subsystem;
+        Scope* _parent;
+        bool _installed;
+        size_t _allocations{ 0 };
+        size_t _bytes{ 0 };
+    };
+
+    // The number of allocations all threads of the process made so far, in or outside of a Scope.
+    // Always 0, unless ALLOCATION_TRACKING_BUILD is defined.
+    uint64_t TotalAllocations() noexcept;
+}
+
+#ifdef ALLOCATION_TRACKING_BUILD
+#define TRACK_ALLOCATIONS(subsystem) \
+    const ::Microsoft::Console::AllocationTracking::Scope _allocationScope { ::Microsoft::Console::AllocationTracking::Subsystem::subsystem }
+#else
+#define TRACK_ALLOCATIONS(subsystem)
+#endif
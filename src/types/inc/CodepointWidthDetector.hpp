@@ -46,6 +46,7 @@ private:
     bool _checkFallbackViaCache(const std::wstring_view glyph) const;
     static unsigned int _extractCodepoint(const std::wstring_view glyph) noexcept;
 
-    mutable std::unordered_map<std::wstring, bool> _fallbackCache;
+    // Keyed by codepoint.
+    mutable std::unordered_map<unsigned int, bool> _fallbackCache;
     std::function<bool(std::wstring_view)> _pfnFallbackMethod;
 };
@@ -24,6 +24,7 @@ public:
     ColorFix(COLORREF color) noexcept;
 
     static COLORREF GetPerceivableColor(COLORREF fg, COLORREF bg);
+    static COLORREF GetPerceivableColor(COLORREF fg, const ColorFix& bg);
 
 #pragma warning(push)
     // CL will complain about the both nameless and anonymous struct.
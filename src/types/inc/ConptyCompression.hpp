@@ -0,0 +1,94 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ConptyCompression.hpp
+
+Abstract:
+- Compression of the output pipe of a conpty started with
+  PSEUDOCONSOLE_COMPRESS_OUTPUT, for terminals that tunnel the pipe across
+  process or machine boundaries.
+- The output starts with ConptyCompression::Magic, followed by frames. Every
+  frame is a FrameHeader followed by `compressedSize` bytes: the XPRESS
+  compressed output, or the output as is if `compressedSize == size`.
+- Frames are compressed independently, so that every flush of the conpty
+  reaches the terminal right away, without waiting for more output.
+- A terminal that asked for compression, but whose output doesn't start with
+  the magic, is talking to a conpty that doesn't support it. The
+  decompressor then passes the output through unchanged.
+--*/
+
+#pragma once
+
+#include <compressapi.h>
+
+namespace Microsoft::Console::Utils::ConptyCompression
+{
+    // A DCS string, so that it's ignored by anything that interprets it as VT.
+    inline constexpr std::string_view Magic{ "\x1bPzconpty-xpress;1\x1b\\" };
+
+    // Larger outputs are split into several frames.
+    inline constexpr size_t MaxFrameSize = 256 * 1024;
+    // Smaller outputs aren't worth compressing and are sent as is.
+    inline constexpr size_t MinCompressedSize = 64;
+
+    struct FrameHeader
+    {
+        uint32_t compressedSize;
+        uint32_t size;
+    };
+
+    class Compressor
+    {
+    public:
+        Compressor();
+        ~Compressor();
+        Compressor(const Compressor&) = delete;
+        Compressor& operator=(const Compressor&) = delete;
+
+        void Compress(std::string_view data, std::string& out);
+
+    private:
+        wil::unique_hmodule _module;
+        decltype(&::CloseCompressor) _closeCompressor{ nullptr };
+        decltype(&::Compress) _compress{ nullptr };
+        COMPRESSOR_HANDLE _compressor{ nullptr };
+
+        std::string _scratch;
+        bool _wroteMagic{ false };
+
+        void _CompressFrame(const std::string_view data, std::string& out);
+    };
+
+    class Decompressor
+    {
+    public:
+        Decompressor();
+        ~Decompressor();
+        Decompressor(const Decompressor&) = delete;
+        Decompressor& operator=(const Decompressor&) = delete;
+
+        void Decompress(std::string_view data, std::string& out);
+
+    private:
+        enum class State
+        {
+            Magic,
+            Header,
+            Payload,
+            Passthrough
+        };
+
+        wil::unique_hmodule _module;
+        decltype(&::CloseDecompressor) _closeDecompressor{ nullptr };
+        decltype(&::Decompress) _decompress{ nullptr };
+        DECOMPRESSOR_HANDLE _decompressor{ nullptr };
+
+        State _state{ State::Magic };
+        FrameHeader _header{};
+        std::string _pending;
+
+        void _DecompressFrame(std::string& out);
+    };
+}
@@ -0,0 +1,44 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- GraphemeParser.hpp
+
+Abstract:
+- Splits UTF-16 text into extended grapheme clusters, following the rules of
+  UAX #29 (https://www.unicode.org/reports/tr29/). A cluster is what a user
+  perceives as a single character, like a letter and its combining marks, a
+  flag made of two regional indicators or an emoji ZWJ sequence. The buffer
+  stores every cluster in a single cell (or two, if it's wide).
+- The break properties are looked up in a table that's generated by
+  tools\Generate-CodepointWidthsFromUCD.ps1 -GraphemeClusterBreaks.
+--*/
+
+#pragma once
+
+enum class GraphemeClusterBreak : uint8_t
+{
+    Other,
+    CR,
+    LF,
+    Control,
+    Extend,
+    ZWJ,
+    RegionalIndicator,
+    Prepend,
+    SpacingMark,
+    L,
+    V,
+    T,
+    LV,
+    LVT,
+    ExtendedPictographic,
+};
+
+class GraphemeParser final
+{
+public:
+    static std::wstring_view ParseNext(const std::wstring_view wstr) noexcept;
+    static GraphemeClusterBreak GetBreakProperty(const unsigned int codepoint) noexcept;
+};
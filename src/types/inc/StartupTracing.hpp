@@ -0,0 +1,55 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- StartupTracing.hpp
+
+Abstract:
+- Marks the phases of the startup of the Terminal, from the construction of
+  the AppHost to the first frame the Renderer paints, so that the time spent
+  in each of them can be told apart.
+- A Scope writes a start event for its phase to the
+  "Microsoft.Windows.Terminal.Startup" TraceLogging provider when it's
+  constructed, and the matching stop event when it's destroyed (or stopped).
+  Both events share an activity ID, so phases that overlap (like the profile
+  generators, which run concurrently) can still be told apart.
+- The phases named First* are only traced the first time they're entered in
+  a process. The others are traced every time, which includes settings
+  reloads and any further windows of the process.
+- Startup.wprp, next to Terminal.wprp, captures these events.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::StartupTracing
+{
+    enum class Phase : uint8_t
+    {
+        AppHost, // the construction of the AppHost
+        MonarchElection, // finding or becoming the monarch, see WindowManager
+        LoadSettings, // CascadiaSettings::LoadAll
+        ProfileGenerator, // a single dynamic profile generator, named in the detail
+        CreateApp, // the construction of the XAML App
+        CreatePage, // TerminalPage::Create
+        StartupActions, // the initial TerminalPage::ProcessStartupActions
+        FirstConnection, // the first ConptyConnection::Start
+        FirstFrame, // the first Renderer::PaintFrame, including its present
+    };
+
+    class Scope
+    {
+    public:
+        explicit Scope(const Phase phase, const std::wstring_view detail = {}) noexcept;
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void Stop() noexcept;
+
+    private:
+        Phase _phase;
+        GUID _activityId{};
+        bool _active{ false };
+    };
+}
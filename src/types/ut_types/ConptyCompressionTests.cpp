@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../inc/ConptyCompression.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Utils::ConptyCompression;
+
+class ConptyCompressionTests
+{
+    TEST_CLASS(ConptyCompressionTests);
+
+    TEST_METHOD(RoundTripsCompressedOutput)
+    {
+        Compressor compressor;
+        Decompressor decompressor;
+
+        std::string expected;
+        std::string compressed;
+        // Something that compresses well, in several frames...
+        for (auto i = 0; i < 2000; ++i)
+        {
+            const auto line = fmt::format("\x1b[{};1H\x1b[38;5;{}mline {}\x1b[m\x1b[K", i % 30 + 1, i % 256, i);
+            expected.append(line);
+            compressor.Compress(line, compressed);
+        }
+        // ...one that's larger than a frame...
+        const std::string large(MaxFrameSize + 100, 'x');
+        expected.append(large);
+        compressor.Compress(large, compressed);
+        // ...and one that's too small to bother.
+        expected.append("a");
+        compressor.Compress("a", compressed);
+
+        VERIFY_IS_LESS_THAN(compressed.size(), expected.size());
+        VERIFY_ARE_EQUAL(Magic, std::string_view{ compressed }.substr(0, Magic.size()));
+
+        // Frames may be split up arbitrarily by the pipe.
+        std::string actual;
+        std::string_view remaining{ compressed };
+        for (size_t chunk = 1; !remaining.empty(); chunk = chunk * 3 % 1021 + 1)
+        {
+            const auto part = remaining.substr(0, chunk);
+            decompressor.Decompress(part, actual);
+            remaining = remaining.substr(part.size());
+        }
+
+        VERIFY_ARE_EQUAL(std::string_view{ expected }, std::string_view{ actual });
+    }
+
+    TEST_METHOD(PassesThroughUncompressedOutput)
+    {
+        Decompressor decompressor;
+
+        // The output of a conpty that doesn't compress starts with anything
+        // but the magic, even if it's another DCS string.
+        std::string actual;
+        decompressor.Decompress("\x1bPz", actual);
+        decompressor.Decompress("q\x1b\\hello", actual);
+        decompressor.Decompress(" world", actual);
+
+        VERIFY_ARE_EQUAL(std::string_view{ "\x1bPzq\x1b\\hello world" }, std::string_view{ actual });
+    }
+
+    TEST_METHOD(RejectsCorruptFrames)
+    {
+        Decompressor decompressor;
+
+        std::string output{ Magic };
+        const FrameHeader header{ 1, 16 * 1024 * 1024 };
+        output.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::string actual;
+        VERIFY_THROWS_SPECIFIC(decompressor.Decompress(output, actual),
+                               wil::ResultException,
+                               [](wil::ResultException& e) { return e.GetErrorCode() == E_UNEXPECTED; });
+    }
+};
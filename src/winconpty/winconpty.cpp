@@ -62,6 +62,64 @@ static bool _HandleIsValid(HANDLE h) noexcept
     return (h != INVALID_HANDLE_VALUE) && (h != nullptr);
 }
 
+// Function Description:
+// - Returns whether the console host is built from the same sources as we are, and thus
+//   understands all the arguments we pass to it. An older inbox conhost would refuse to
+//   start if it got one it doesn't know.
+static bool _ConsoleHostIsOurs()
+{
+#if defined(__INSIDE_WINDOWS)
+    return true;
+#else
+    static const bool isOurs = std::filesystem::path{ _ConsoleHostPath() }.filename() == L"OpenConsole.exe";
+    return isOurs;
+#endif // __INSIDE_WINDOWS
+}
+
+// Function Description:
+// - Creates the signal pipe as a named pipe, so that the console host side can be opened
+//   with FILE_FLAG_OVERLAPPED. That way conhost reads it on its thread pool instead of
+//   keeping a thread blocked on it. Our side stays synchronous.
+// Arguments:
+// - conhostSide: Receives the inheritable, overlapped read end of the pipe.
+// - ourSide: Receives the write end of the pipe.
+// Return Value:
+// - S_OK if the pipe was created, otherwise an error.
+static HRESULT _CreateOverlappedSignalPipe(wil::unique_handle& conhostSide, wil::unique_handle& ourSide)
+{
+    static LONG pipeCount = 0;
+
+    wchar_t pipeName[64]{};
+    swprintf_s(pipeName,
+               ARRAYSIZE(pipeName),
+               L"\\\\.\\pipe\\conpty-%lu-%ld-signal",
+               GetCurrentProcessId(),
+               InterlockedIncrement(&pipeCount));
+
+    const auto server = CreateNamedPipeW(pipeName,
+                                         PIPE_ACCESS_OUTBOUND | FILE_FLAG_FIRST_PIPE_INSTANCE,
+                                         PIPE_TYPE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+                                         1,
+                                         4096,
+                                         4096,
+                                         0,
+                                         nullptr);
+    RETURN_LAST_ERROR_IF(server == INVALID_HANDLE_VALUE);
+    wil::unique_handle serverSide{ server };
+
+    SECURITY_ATTRIBUTES sa;
+    sa.nLength = sizeof(sa);
+    sa.bInheritHandle = TRUE;
+    sa.lpSecurityDescriptor = nullptr;
+
+    const auto client = CreateFileW(pipeName, GENERIC_READ, 0, &sa, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+    RETURN_LAST_ERROR_IF(client == INVALID_HANDLE_VALUE);
+
+    conhostSide.reset(client);
+    ourSide.reset(serverSide.release());
+    return S_OK;
+}
+
 HRESULT _CreatePseudoConsole(const HANDLE hToken,
                              const COORD size,
                              const HANDLE hInput,
@@ -90,23 +148,35 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
     sa.bInheritHandle = FALSE;
     sa.lpSecurityDescriptor = nullptr;
 
-    RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(signalPipeConhostSide.addressof(), signalPipeOurSide.addressof(), &sa, 0));
-    RETURN_IF_WIN32_BOOL_FALSE(SetHandleInformation(signalPipeConhostSide.get(), HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT));
+    // An anonymous pipe can't be read with overlapped I/O, so we only fall back to one
+    // if the console host wouldn't understand --overlappedSignal.
+    const bool bOverlappedSignal = _ConsoleHostIsOurs() &&
+                                   SUCCEEDED_LOG(_CreateOverlappedSignalPipe(signalPipeConhostSide, signalPipeOurSide));
+    if (!bOverlappedSignal)
+    {
+        RETURN_IF_WIN32_BOOL_FALSE(CreatePipe(signalPipeConhostSide.addressof(), signalPipeOurSide.addressof(), &sa, 0));
+        RETURN_IF_WIN32_BOOL_FALSE(SetHandleInformation(signalPipeConhostSide.get(), HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT));
+    }
 
     // GH4061: Ensure that the path to executable in the format is escaped so C:\Program.exe cannot collide with C:\Program Files
-    const wchar_t* pwszFormat = L"\"%s\" --headless %s%s%s--width %hu --height %hu --signal 0x%x --server 0x%x";
+    const wchar_t* pwszFormat = L"\"%s\" --headless %s%s%s%s%s--width %hu --height %hu --signal 0x%x --server 0x%x";
     // This is plenty of space to hold the formatted string
-    wchar_t cmd[MAX_PATH]{};
+    wchar_t cmd[MAX_PATH + 128]{};
     const BOOL bInheritCursor = (dwFlags & PSEUDOCONSOLE_INHERIT_CURSOR) == PSEUDOCONSOLE_INHERIT_CURSOR;
     const BOOL bResizeQuirk = (dwFlags & PSEUDOCONSOLE_RESIZE_QUIRK) == PSEUDOCONSOLE_RESIZE_QUIRK;
     const BOOL bWin32InputMode = (dwFlags & PSEUDOCONSOLE_WIN32_INPUT_MODE) == PSEUDOCONSOLE_WIN32_INPUT_MODE;
+    // An older inbox conhost wouldn't start with --compressOutput, so it gets uncompressed output.
+    // The terminal notices that by the missing magic at the start of the output. See ConptyCompression.hpp.
+    const BOOL bCompressOutput = _ConsoleHostIsOurs() && (dwFlags & PSEUDOCONSOLE_COMPRESS_OUTPUT) == PSEUDOCONSOLE_COMPRESS_OUTPUT;
     swprintf_s(cmd,
-               MAX_PATH,
+               ARRAYSIZE(cmd),
                pwszFormat,
                _ConsoleHostPath(),
                bInheritCursor ? L"--inheritcursor " : L"",
                bWin32InputMode ? L"--win32input " : L"",
                bResizeQuirk ? L"--resizeQuirk " : L"",
+               bCompressOutput ? L"--compressOutput " : L"",
+               bOverlappedSignal ? L"--overlappedSignal " : L"",
                size.X,
                size.Y,
                signalPipeConhostSide.get(),
@@ -252,6 +322,49 @@ HRESULT _ClearPseudoConsole(_In_ const PseudoConsole* const pPty)
     return fSuccess ? S_OK : HRESULT_FROM_WIN32(GetLastError());
 }
 
+// Function Description:
+// - Asks the conpty to paint a region of its viewport again
+// Arguments:
+// - hSignal: A signal pipe as returned by CreateConPty.
+// - region: The inclusive region to repaint, relative to the viewport.
+// Return Value:
+// - S_OK if the call succeeded, E_NOTIMPL if the console host doesn't
+//      understand framed messages, else an appropriate HRESULT for failing to
+//      write the repaint message to the pty.
+HRESULT _RepaintPseudoConsole(_In_ const PseudoConsole* const pPty, _In_ const SMALL_RECT region)
+{
+    if (pPty == nullptr || region.Left < 0 || region.Top < 0 || region.Left > region.Right || region.Top > region.Bottom)
+    {
+        return E_INVALIDARG;
+    }
+
+    // An older inbox conhost treats a signal it doesn't know as a fatal error
+    // and tears down the whole session, so we must not send it this one.
+    if (!_ConsoleHostIsOurs())
+    {
+        return E_NOTIMPL;
+    }
+
+#pragma pack(push, 1)
+    struct
+    {
+        unsigned short signal;
+        PtyMessageHeader header;
+        SMALL_RECT region;
+    } signalPacket;
+#pragma pack(pop)
+    signalPacket.signal = PTY_SIGNAL_MESSAGE;
+    signalPacket.header.version = PTY_MESSAGE_VERSION;
+    signalPacket.header.type = PTY_MESSAGE_REPAINT_REGION;
+    signalPacket.header.size = sizeof(signalPacket.region);
+    signalPacket.region = region;
+
+    // The packet is written at once, so that it can't be interleaved with
+    // other signals written from another thread.
+    const BOOL fSuccess = WriteFile(pPty->hSignal, &signalPacket, sizeof(signalPacket), nullptr, nullptr);
+    return fSuccess ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+}
+
 // Function Description:
 // - This closes each of the members of a PseudoConsole. It does not free the
 //      data associated with the PseudoConsole. This is helpful for testing,
@@ -423,6 +536,24 @@ extern "C" HRESULT WINAPI ConptyClearPseudoConsole(_In_ HPCON hPC)
     return hr;
 }
 
+// Function Description:
+// - Asks the conpty to paint the given region of its viewport again, without
+//   clearing or repainting the rest of it.
+// - This allows a terminal to resynchronize a part of its screen, for
+//   instance after it reflowed its own buffer for a resize.
+// - Fails with E_NOTIMPL if the console host is an inbox conhost that
+//   predates framed messages. Nothing is sent to it in that case.
+extern "C" HRESULT WINAPI ConptyRepaintPseudoConsole(_In_ HPCON hPC, _In_ SMALL_RECT region)
+{
+    const PseudoConsole* const pPty = (PseudoConsole*)hPC;
+    HRESULT hr = pPty == nullptr ? E_INVALIDARG : S_OK;
+    if (SUCCEEDED(hr))
+    {
+        hr = _RepaintPseudoConsole(pPty, region);
+    }
+    return hr;
+}
+
 // Function Description:
 // Closes the conpty and all associated state.
 // Client applications attached to the conpty will also behave as though the
@@ -19,12 +19,30 @@ typedef struct _PseudoConsole
 //      the signal pipe.
 #define PTY_SIGNAL_CLEAR_WINDOW (2u)
 #define PTY_SIGNAL_RESIZE_WINDOW (8u)
+// A framed message: the signal is followed by a PtyMessageHeader and
+//      `size` bytes of payload. Conhost skips messages it doesn't know and
+//      ignores fields appended to payloads by later versions, so new messages
+//      and fields can be sent to any conhost that understands this signal.
+#define PTY_SIGNAL_MESSAGE (16u)
+
+#define PTY_MESSAGE_VERSION (1u)
+// Payload: a SMALL_RECT, the inclusive region of the viewport to repaint.
+#define PTY_MESSAGE_REPAINT_REGION (1u)
+
+typedef struct _PtyMessageHeader
+{
+    unsigned short version;
+    unsigned short type;
+    unsigned long size;
+} PtyMessageHeader;
 
 // CreatePseudoConsole Flags
 // The other flag (PSEUDOCONSOLE_INHERIT_CURSOR) is actually defined in consoleapi.h in the OS repo
 // #define PSEUDOCONSOLE_INHERIT_CURSOR (0x1)
 #define PSEUDOCONSOLE_RESIZE_QUIRK (0x2)
 #define PSEUDOCONSOLE_WIN32_INPUT_MODE (0x4)
+// Ignored by an older inbox conhost, whose output stays uncompressed.
+#define PSEUDOCONSOLE_COMPRESS_OUTPUT (0x8)
 
 // Implementations of the various PseudoConsole functions.
 HRESULT _CreatePseudoConsole(const HANDLE hToken,
@@ -36,6 +54,7 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
 
 HRESULT _ResizePseudoConsole(_In_ const PseudoConsole* const pPty, _In_ const COORD size);
 HRESULT _ClearPseudoConsole(_In_ const PseudoConsole* const pPty);
+HRESULT _RepaintPseudoConsole(_In_ const PseudoConsole* const pPty, _In_ const SMALL_RECT region);
 void _ClosePseudoConsoleMembers(_In_ PseudoConsole* pPty);
 VOID _ClosePseudoConsole(_In_ PseudoConsole* pPty);
 
@@ -23,8 +23,15 @@
 # Invoke as ./Generate-xxx ucd.nounihan.flat.xml -Pack | Out-File -Encoding
 #           UTF-8 Temporary.cpp
 #
+# With -GraphemeClusterBreaks, it generates the s_graphemeClusterBreakTable of
+# src/types/GraphemeParser.cpp from the Grapheme_Cluster_Break and
+# Extended_Pictographic properties[3] instead. Overrides don't apply to it.
+# Generate both tables from the same UCD document, so that they agree on which
+# codepoints are assigned.
+#
 # [1]: https://www.unicode.org/Public/UCD/latest/ucdxml/
 # [2]: https://www.unicode.org/reports/tr42/
+# [3]: https://www.unicode.org/reports/tr29/
 
 [Diagnostics.CodeAnalysis.SuppressMessageAttribute('PSAvoidUsingPositionalParameters', '')]
 [Diagnostics.CodeAnalysis.SuppressMessageAttribute('PSUseProcessBlockForPipelineCommand', '')]
@@ -44,7 +51,8 @@ Param(
 
     [switch]$Pack, # Pack tightly based on width
     [switch]$NoOverrides, # Do not include overrides
-    [switch]$Full = $False # Include Narrow codepoints
+    [switch]$Full = $False, # Include Narrow codepoints
+    [switch]$GraphemeClusterBreaks # Generate the grapheme cluster break table instead
 )
 
 Enum CodepointWidth {
@@ -86,6 +94,29 @@ Function Get-UCDEntryWidth($entry) {
     [CodepointWidth]::Invalid
 }
 
+Function Get-UCDEntryGraphemeClusterBreak($entry) {
+    Switch($entry.GCB) {
+        "CR"  { "CR"; Return }
+        "LF"  { "LF"; Return }
+        "CN"  { "Control"; Return }
+        "EX"  { "Extend"; Return }
+        "ZWJ" { "ZWJ"; Return }
+        "RI"  { "RegionalIndicator"; Return }
+        "PP"  { "Prepend"; Return }
+        "SM"  { "SpacingMark"; Return }
+        "L"   { "L"; Return }
+        "V"   { "V"; Return }
+        "T"   { "T"; Return }
+        # LV and LVT are computed by GraphemeParser::GetBreakProperty instead,
+        # as they'd take up 399 entries for just 11172 Hangul syllables.
+    }
+    If ($entry.ExtPict -eq "Y") {
+        "ExtendedPictographic"
+        Return
+    }
+    $null
+}
+
 Function Get-UCDEntryFlags($entry) {
     If ($script:Pack) {
         # If we're "pack"ing entries, only the computed width matters for telling them apart
@@ -224,6 +255,34 @@ $UCDRepertoire = $InputObject.ucd.repertoire.ChildNodes | Sort-Object {
     }
 }
 
+If ($GraphemeClusterBreaks) {
+    $breakRanges = [System.Collections.Generic.List[Object]]::New(1024)
+    ForEach($v in $UCDRepertoire) {
+        $property = Get-UCDEntryGraphemeClusterBreak $v
+        If ($null -eq $property) {
+            Continue
+        }
+
+        $s, $e = Get-UCDEntryRange $v
+        $last = $breakRanges.Count -gt 0 ? $breakRanges[$breakRanges.Count - 1] : $null
+        If ($null -ne $last -and $last.Property -eq $property -and ($s - $last.End) -le 1) {
+            $last.End = $e
+            Continue
+        }
+        $breakRanges.Add([PSCustomObject]@{ Start = $s; End = $e; Property = $property })
+    }
+
+    "    // Generated by {0} -GraphemeClusterBreaks:{1}" -f $MyInvocation.MyCommand.Name, $GraphemeClusterBreaks
+    "    // on {0} (UTC) from {1}." -f (Get-Date -AsUTC), $InputObject.ucd.description
+    "    // Hangul syllables (LV and LVT) are left out, see GraphemeParser::GetBreakProperty."
+    "    static constexpr std::array<GraphemeRange, {0}> s_graphemeClusterBreakTable{{" -f $breakRanges.Count
+    ForEach($_ in $breakRanges) {
+    "        GraphemeRange{{ 0x{0:x}, 0x{1:x}, GraphemeClusterBreak::{2} }}," -f $_.Start, $_.End, $_.Property
+    }
+    "    };"
+    Return
+}
+
 If (-not $Full) {
     $UCDRepertoire = $UCDRepertoire | Where-Object {
         # Select everything Wide/Ambiguous/Full OR Emoji w/ Emoji Presentation